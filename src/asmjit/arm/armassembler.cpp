@@ -0,0 +1,1691 @@
+// [AsmJit]
+// Complete x86/x64 JIT and Remote Assembler for C++.
+//
+// [License]
+// Zlib - See LICENSE.md file in the package.
+
+// [Export]
+#define ASMJIT_EXPORTS
+
+// [Guard]
+#include "../asmjit_build.h"
+#if defined(ASMJIT_BUILD_ARM)
+
+// [Dependencies]
+#include "../base/cpuinfo.h"
+#include "../base/logging.h"
+#include "../base/misc_p.h"
+#include "../base/utils.h"
+#include "../arm/armassembler.h"
+#include "../arm/arminstimpl_p.h"
+#include "../arm/arminternal_p.h"
+
+// [Api-Begin]
+#include "../asmjit_apibegin.h"
+
+namespace asmjit {
+
+// ============================================================================
+// [Constants]
+// ============================================================================
+
+//! \internal
+//!
+//! Returned by `armGp...()` and `armVecId()` if the register can't be encoded
+//! at the given position. It's greater than any valid 5-bit id, so it's enough
+//! to check `(a | b | c) > 31` to validate more registers at once.
+enum { kArmInvalidId = 0xFFFFFFFFU };
+
+enum ArmOpCodeBits {
+  kArmOpCodeSf       = 0x80000000U,      // 64-bit operation (sf).
+  kArmOpCodeN        = 0x00400000U,      // N bit of bitfield and logical immediate.
+  kArmOpCodeFpD      = 0x00400000U,      // FP type is double precision.
+  kArmOpCodeLdStV    = 0x04000000U,      // Load/store of a vector register.
+  kArmOpCodeLdStOff  = 0x01000000U,      // Load/store with unsigned scaled offset.
+  kArmOpCodeLdStQ    = 0x00800000U       // Load/store of a 128-bit vector register (opc=1x).
+};
+
+// ============================================================================
+// [asmjit::ArmAssembler - Helpers]
+// ============================================================================
+
+//! Get the encoding of a GP register `op` at a position where 31 is ZR.
+static ASMJIT_INLINE uint32_t armGpZr(const Operand_& op) noexcept {
+  uint32_t id = op.getId();
+  return id < 31 ? id : id == ArmGp::kIdZr ? 31U : uint32_t(kArmInvalidId);
+}
+
+//! Get the encoding of a GP register `op` at a position where 31 is SP.
+static ASMJIT_INLINE uint32_t armGpSp(const Operand_& op) noexcept {
+  uint32_t id = op.getId();
+  return id <= 31 ? id : uint32_t(kArmInvalidId);
+}
+
+//! Get the encoding of a vector register `op`.
+static ASMJIT_INLINE uint32_t armVecId(const Operand_& op) noexcept {
+  uint32_t id = op.getId();
+  return id < 32 ? id : uint32_t(kArmInvalidId);
+}
+
+static ASMJIT_INLINE bool armIsGp(const Operand_& op) noexcept {
+  return ArmReg::isGpW(op) | ArmReg::isGpX(op);
+}
+
+static ASMJIT_INLINE bool armIsFp(const Operand_& op) noexcept {
+  return ArmReg::isVecS(op) | ArmReg::isVecD(op);
+}
+
+static ASMJIT_INLINE bool armSameReg(const Operand_& a, const Operand_& b) noexcept {
+  return b.isReg() && a.as<Reg>().getType() == b.as<Reg>().getType();
+}
+
+//! Get `sf` bit of a GP register `op`.
+static ASMJIT_INLINE uint32_t armSf(const Operand_& op) noexcept {
+  return ArmReg::isGpX(op) ? uint32_t(kArmOpCodeSf) : uint32_t(0);
+}
+
+//! Get FP type (bits 22-23) of a vector register `op`, S=0, D=1.
+static ASMJIT_INLINE uint32_t armFpType(const Operand_& op) noexcept {
+  return ArmReg::isVecD(op) ? uint32_t(kArmOpCodeFpD) : uint32_t(0);
+}
+
+// ============================================================================
+// [asmjit::ArmAssembler - Construction / Destruction]
+// ============================================================================
+
+ArmAssembler::ArmAssembler(CodeHolder* code) noexcept : Assembler() {
+  if (code)
+    code->attach(this);
+}
+ArmAssembler::~ArmAssembler() noexcept {}
+
+// ============================================================================
+// [asmjit::ArmAssembler - Events]
+// ============================================================================
+
+Error ArmAssembler::onAttach(CodeHolder* code) noexcept {
+  // Only AArch64 is supported.
+  uint32_t archType = code->getArchType();
+  if (archType != ArchInfo::kTypeA64)
+    return DebugUtils::errored(kErrorInvalidArch);
+
+  ASMJIT_PROPAGATE(Base::onAttach(code));
+
+  _nativeGpArray = armOpData.gpx;
+  _nativeGpReg = _nativeGpArray[0];
+  return kErrorOk;
+}
+
+Error ArmAssembler::onDetach(CodeHolder* code) noexcept {
+  return Base::onDetach(code);
+}
+
+// ============================================================================
+// [asmjit::ArmAssembler - Logical Immediate]
+// ============================================================================
+
+bool ArmAssembler::encodeLogicalImm(uint64_t imm, uint32_t width, uint32_t& out) noexcept {
+  ASMJIT_ASSERT(width == 32 || width == 64);
+
+  // Replicate a 32-bit immediate to make it a 64-bit pattern.
+  if (width == 32) {
+    imm &= 0xFFFFFFFFU;
+    imm |= imm << 32;
+  }
+
+  // All zeros and all ones can't be encoded.
+  if (imm == 0 || ~imm == 0)
+    return false;
+
+  // Find the smallest element size the immediate is a repetition of.
+  uint32_t size = 64;
+  while (size > 2) {
+    uint32_t half = size >> 1;
+    uint64_t mask = (uint64_t(1) << half) - 1;
+
+    if ((imm & mask) != ((imm >> half) & mask))
+      break;
+    size = half;
+  }
+
+  uint64_t eMask = size == 64 ? ~uint64_t(0) : (uint64_t(1) << size) - 1;
+  uint64_t e = imm & eMask;
+
+  // The element must be a rotated run of ones, rotate it right until there
+  // is a one at bit #0 and a zero at the top, then it must be `2^n - 1`.
+  uint32_t rot = 0;
+  while (rot < size && !((e & 1) && !(e >> (size - 1)))) {
+    e = ((e >> 1) | (e << (size - 1))) & eMask;
+    rot++;
+  }
+
+  if (rot == size || (e & (e + 1)) != 0)
+    return false;
+
+  uint32_t ones = 0;
+  while (e & 1) {
+    e >>= 1;
+    ones++;
+  }
+
+  // `rot` rotations right made the run start at bit #0, the encoding stores
+  // the rotation that produces the original element from the run.
+  uint32_t immr = (size - rot) & (size - 1);
+  uint32_t imms = ((~(size - 1) << 1) | (ones - 1)) & 0x3F;
+  uint32_t n = size == 64;
+
+  out = (n << 12) | (immr << 6) | imms;
+  return true;
+}
+
+// ============================================================================
+// [asmjit::ArmAssembler - Emit]
+// ============================================================================
+
+#define ENC_OPS1(OP0)                     ((Operand::kOp##OP0))
+#define ENC_OPS2(OP0, OP1)                ((Operand::kOp##OP0) + ((Operand::kOp##OP1) << 3))
+#define ENC_OPS3(OP0, OP1, OP2)           ((Operand::kOp##OP0) + ((Operand::kOp##OP1) << 3) + ((Operand::kOp##OP2) << 6))
+#define ENC_OPS4(OP0, OP1, OP2, OP3)      ((Operand::kOp##OP0) + ((Operand::kOp##OP1) << 3) + ((Operand::kOp##OP2) << 6) + ((Operand::kOp##OP3) << 9))
+
+Error ArmAssembler::_emit(uint32_t instId, const Operand_& o0, const Operand_& o1, const Operand_& o2, const Operand_& o3) {
+  Error err;
+
+  const Operand_* rmRel = nullptr; // Memory operand.
+  uint32_t opCode;                 // Instruction opcode.
+  uint32_t word = 0;               // Instruction word.
+
+  uint32_t rd, rn, rm, ra;         // Register ids.
+  uint32_t scale = 0;              // Load/store access size as a shift.
+  uint32_t litWord = 0;            // Load (literal) word, zero if not available.
+
+  uint32_t labelId = 0;            // Label to link with.
+  intptr_t relOffset = 0;          // Additional displacement of the label.
+
+  uint8_t* cursor = _bufferPtr;
+  uint32_t options = static_cast<uint32_t>(instId >= ArmInst::_kIdCount)     |
+                     static_cast<uint32_t>((size_t)(_bufferEnd - cursor) < 4) |
+                     getGlobalOptions() | getOptions();
+
+  const ArmInst* instData = ArmInstDB::instData + instId;
+
+  // Handle failure and rare cases first.
+  const uint32_t kErrorsAndSpecialCases =
+    CodeEmitter::kOptionMaybeFailureCase | // Error and buffer check.
+    CodeEmitter::kOptionStrictValidation ; // Strict validation.
+
+  // Signature of all 4 operands.
+  uint32_t isign4 = o0.getOp() + (o1.getOp() << 3) + (o2.getOp() << 6) + (o3.getOp() << 9);
+
+  if (ASMJIT_UNLIKELY(options & kErrorsAndSpecialCases)) {
+    // Don't do anything if we are in error state.
+    if (_lastError) return _lastError;
+
+    if (options & CodeEmitter::kOptionMaybeFailureCase) {
+      // Unknown instruction.
+      if (ASMJIT_UNLIKELY(instId >= ArmInst::_kIdCount))
+        goto InvalidArgument;
+
+      // Grow request, happens rarely.
+      if ((size_t)(_bufferEnd - cursor) < 4) {
+        err = _code->growBuffer(&_section->_buffer, 4);
+        if (ASMJIT_UNLIKELY(err)) goto Failed;
+
+        cursor = _bufferPtr;
+        options &= ~1;
+      }
+    }
+
+    // Strict validation.
+#if !defined(ASMJIT_DISABLE_VALIDATION)
+    if (options & CodeEmitter::kOptionStrictValidation) {
+      Operand_ opArray[4];
+
+      opArray[0].copyFrom(o0);
+      opArray[1].copyFrom(o1);
+      opArray[2].copyFrom(o2);
+      opArray[3].copyFrom(o3);
+
+      err = ArmInstImpl::validate(getArchType(), Inst::Detail(instId, options, _extraReg), opArray, 4);
+      if (ASMJIT_UNLIKELY(err)) goto Failed;
+
+#if !defined(ASMJIT_DISABLE_EXTENSIONS)
+      // Reject instructions the target CPU doesn't have.
+      if (_codeInfo.hasFeatures()) {
+        err = Inst::validateFeatures(getArchType(), Inst::Detail(instId, options, _extraReg), opArray, 4, _codeInfo.getFeatures());
+        if (ASMJIT_UNLIKELY(err)) goto Failed;
+      }
+#endif // !ASMJIT_DISABLE_EXTENSIONS
+    }
+#endif // !ASMJIT_DISABLE_VALIDATION
+  }
+
+  // --------------------------------------------------------------------------
+  // [Encoding Scope]
+  // --------------------------------------------------------------------------
+
+  opCode = instData->getOpCode();
+
+  switch (instData->getEncodingType()) {
+    case ArmInst::kEncodingNone:
+      goto EmitDone;
+
+    // ------------------------------------------------------------------------
+    // [Base]
+    // ------------------------------------------------------------------------
+
+    case ArmInst::kEncodingBaseOp:
+      if (isign4 == 0) {
+        word = opCode;
+        goto EmitWord;
+      }
+      break;
+
+    case ArmInst::kEncodingBaseImm16:
+      if (isign4 == ENC_OPS1(Imm)) {
+        uint64_t imm = o0.as<Imm>().getUInt64();
+        if (ASMJIT_UNLIKELY(imm > 0xFFFFU))
+          goto InvalidImmediate;
+
+        word = opCode | (static_cast<uint32_t>(imm) << 5);
+        goto EmitWord;
+      }
+      break;
+
+    case ArmInst::kEncodingBaseCmp:
+      // CMP|CMN Rn, Rm|#imm [, #shift] is SUBS|ADDS ZR, Rn, Rm|#imm [, #shift].
+      if (!armIsGp(o0))
+        break;
+
+      rd = 31;
+      rn = armGpSp(o0);
+
+      if (isign4 == ENC_OPS2(Reg, Imm)) {
+        rmRel = &o1;
+        goto EmitAddSubImm;
+      }
+
+      if (isign4 == ENC_OPS2(Reg, Reg) || isign4 == ENC_OPS3(Reg, Reg, Imm)) {
+        if (!armSameReg(o0, o1))
+          goto OperandSizeMismatch;
+
+        rm = armGpZr(o1);
+        rmRel = &o2;
+        goto EmitAddSubReg;
+      }
+      break;
+
+    case ArmInst::kEncodingBaseAddSub:
+      // ADD|SUB Rd|SP, Rn|SP, ... and ADDS|SUBS Rd, Rn|SP, ...
+      if (!armIsGp(o0) || !armSameReg(o0, o1))
+        break;
+
+      rd = (opCode & 0x20000000U) ? armGpZr(o0) : armGpSp(o0);
+      rn = armGpSp(o1);
+
+      if (isign4 == ENC_OPS3(Reg, Reg, Imm)) {
+        rmRel = &o2;
+        goto EmitAddSubImm;
+      }
+
+      if (isign4 == ENC_OPS3(Reg, Reg, Reg) || isign4 == ENC_OPS4(Reg, Reg, Reg, Imm)) {
+        if (!armSameReg(o0, o2))
+          goto OperandSizeMismatch;
+
+        rm = armGpZr(o2);
+        rmRel = &o3;
+        goto EmitAddSubReg;
+      }
+      break;
+
+    case ArmInst::kEncodingBaseTst:
+      // TST Rn, Rm|#imm [, #shift] is ANDS ZR, Rn, Rm|#imm [, #shift].
+      if (!armIsGp(o0))
+        break;
+
+      rd = 31;
+      rn = armGpZr(o0);
+
+      if (isign4 == ENC_OPS2(Reg, Imm)) {
+        rmRel = &o1;
+        goto EmitLogicalImm;
+      }
+
+      if (isign4 == ENC_OPS2(Reg, Reg) || isign4 == ENC_OPS3(Reg, Reg, Imm)) {
+        if (!armSameReg(o0, o1))
+          goto OperandSizeMismatch;
+
+        rm = armGpZr(o1);
+        rmRel = &o2;
+        goto EmitLogicalReg;
+      }
+      break;
+
+    case ArmInst::kEncodingBaseLogical:
+      if (!armIsGp(o0) || !armSameReg(o0, o1))
+        break;
+
+      rn = armGpZr(o1);
+
+      if (isign4 == ENC_OPS3(Reg, Reg, Imm)) {
+        // Only AND, ANDS, EOR, and ORR have an immediate form, ANDS can't use SP.
+        if (opCode & 0x00200000U)
+          goto InvalidImmediate;
+
+        rd = (opCode & 0x60000000U) == 0x60000000U ? armGpZr(o0) : armGpSp(o0);
+        rmRel = &o2;
+        goto EmitLogicalImm;
+      }
+
+      if (isign4 == ENC_OPS3(Reg, Reg, Reg) || isign4 == ENC_OPS4(Reg, Reg, Reg, Imm)) {
+        if (!armSameReg(o0, o2))
+          goto OperandSizeMismatch;
+
+        rd = armGpZr(o0);
+        rm = armGpZr(o2);
+        rmRel = &o3;
+        goto EmitLogicalReg;
+      }
+      break;
+
+    case ArmInst::kEncodingBaseMov:
+      if (isign4 == ENC_OPS2(Reg, Reg)) {
+        if (!armSameReg(o0, o1))
+          goto OperandSizeMismatch;
+
+        if (armIsGp(o0)) {
+          uint32_t sf = armSf(o0);
+
+          // MOV to/from SP is ADD Rd, Rn, #0, otherwise ORR Rd, ZR, Rm.
+          if (o0.getId() == ArmGp::kIdSp || o1.getId() == ArmGp::kIdSp) {
+            rd = armGpSp(o0);
+            rn = armGpSp(o1);
+            if (ASMJIT_UNLIKELY((rd | rn) > 31))
+              goto InvalidPhysId;
+
+            word = 0x11000000U | sf | (rn << 5) | rd;
+            goto EmitWord;
+          }
+
+          rd = armGpZr(o0);
+          rm = armGpZr(o1);
+          if (ASMJIT_UNLIKELY((rd | rm) > 31))
+            goto InvalidPhysId;
+
+          word = 0x2A0003E0U | sf | (rm << 16) | rd;
+          goto EmitWord;
+        }
+
+        rd = armVecId(o0);
+        rn = armVecId(o1);
+        if (ASMJIT_UNLIKELY((rd | rn) > 31))
+          goto InvalidPhysId;
+
+        // MOV Vd.16B, Vn.16B is ORR Vd.16B, Vn.16B, Vn.16B.
+        if (ArmReg::isVecV(o0))
+          word = 0x4EA01C00U | (rn << 16) | (rn << 5) | rd;
+        else
+          word = 0x1E204000U | armFpType(o0) | (rn << 5) | rd;
+        goto EmitWord;
+      }
+
+      if (isign4 == ENC_OPS2(Reg, Imm) && armIsGp(o0)) {
+        uint32_t sf = armSf(o0);
+        uint32_t width = sf ? 64 : 32;
+        uint64_t imm = o1.as<Imm>().getUInt64();
+
+        rd = armGpZr(o0);
+        if (ASMJIT_UNLIKELY(rd > 31))
+          goto InvalidPhysId;
+
+        if (width == 32)
+          imm &= 0xFFFFFFFFU;
+
+        // Try MOVZ and MOVN, both can only set one 16-bit halfword.
+        for (uint32_t i = 0; i < 2; i++) {
+          uint64_t v = i ? ~imm : imm;
+          if (width == 32)
+            v &= 0xFFFFFFFFU;
+
+          for (uint32_t hw = 0; hw < width / 16; hw++) {
+            if ((v & ~(uint64_t(0xFFFFU) << (hw * 16))) == 0) {
+              word = (i ? 0x12800000U : 0x52800000U) | sf | (hw << 21) |
+                     (static_cast<uint32_t>(v >> (hw * 16)) << 5) | rd;
+              goto EmitWord;
+            }
+          }
+        }
+
+        // Try ORR Rd, ZR, #imm.
+        uint32_t logicalImm;
+        if (encodeLogicalImm(imm, width, logicalImm)) {
+          word = 0x320003E0U | sf | (logicalImm << 10) | rd;
+          goto EmitWord;
+        }
+
+        // A sequence of MOVZ|MOVK is required, see `ArmInternal::emitMovImm()`.
+        goto InvalidImmediate;
+      }
+      break;
+
+    case ArmInst::kEncodingBaseMovWide:
+      if ((isign4 == ENC_OPS2(Reg, Imm) || isign4 == ENC_OPS3(Reg, Imm, Imm)) && armIsGp(o0)) {
+        uint32_t sf = armSf(o0);
+        uint64_t imm = o1.as<Imm>().getUInt64();
+        uint64_t shift = isign4 == ENC_OPS3(Reg, Imm, Imm) ? o2.as<Imm>().getUInt64() : uint64_t(0);
+
+        rd = armGpZr(o0);
+        if (ASMJIT_UNLIKELY(rd > 31))
+          goto InvalidPhysId;
+
+        if (ASMJIT_UNLIKELY(imm > 0xFFFFU || (shift & 0xF) != 0 || shift >= (sf ? 64U : 32U)))
+          goto InvalidImmediate;
+
+        word = opCode | sf | (static_cast<uint32_t>(shift >> 4) << 21) | (static_cast<uint32_t>(imm) << 5) | rd;
+        goto EmitWord;
+      }
+      break;
+
+    case ArmInst::kEncodingBaseShift:
+      if (!armIsGp(o0) || !armSameReg(o0, o1))
+        break;
+
+      rd = armGpZr(o0);
+      rn = armGpZr(o1);
+
+      if (isign4 == ENC_OPS3(Reg, Reg, Reg)) {
+        if (!armSameReg(o0, o2))
+          goto OperandSizeMismatch;
+
+        rm = armGpZr(o2);
+        if (ASMJIT_UNLIKELY((rd | rn | rm) > 31))
+          goto InvalidPhysId;
+
+        word = opCode | armSf(o0) | (rm << 16) | (rn << 5) | rd;
+        goto EmitWord;
+      }
+
+      if (isign4 == ENC_OPS3(Reg, Reg, Imm)) {
+        uint32_t sf = armSf(o0);
+        uint32_t nBit = sf ? uint32_t(kArmOpCodeN) : uint32_t(0);
+        uint32_t width = sf ? 64 : 32;
+        uint64_t s = o2.as<Imm>().getUInt64();
+
+        if (ASMJIT_UNLIKELY((rd | rn) > 31))
+          goto InvalidPhysId;
+
+        if (ASMJIT_UNLIKELY(s >= width))
+          goto InvalidImmediate;
+
+        uint32_t shift = static_cast<uint32_t>(s);
+        uint32_t immr, imms;
+
+        switch (instId) {
+          case ArmInst::kIdLsl:
+            // UBFM Rd, Rn, #(-shift MOD width), #(width - 1 - shift).
+            opCode = 0x53000000U;
+            immr = (width - shift) & (width - 1);
+            imms = width - 1 - shift;
+            break;
+
+          case ArmInst::kIdLsr:
+            // UBFM Rd, Rn, #shift, #(width - 1).
+            opCode = 0x53000000U;
+            immr = shift;
+            imms = width - 1;
+            break;
+
+          case ArmInst::kIdAsr:
+            // SBFM Rd, Rn, #shift, #(width - 1).
+            opCode = 0x13000000U;
+            immr = shift;
+            imms = width - 1;
+            break;
+
+          default:
+            // EXTR Rd, Rn, Rn, #shift.
+            word = 0x13800000U | sf | nBit | (rn << 16) | (shift << 10) | (rn << 5) | rd;
+            goto EmitWord;
+        }
+
+        word = opCode | sf | nBit | (immr << 16) | (imms << 10) | (rn << 5) | rd;
+        goto EmitWord;
+      }
+      break;
+
+    case ArmInst::kEncodingBaseExtend:
+      if (isign4 == ENC_OPS2(Reg, Reg) && armIsGp(o0) && ArmReg::isGpW(o1)) {
+        rd = armGpZr(o0);
+        rn = armGpZr(o1);
+        if (ASMJIT_UNLIKELY((rd | rn) > 31))
+          goto InvalidPhysId;
+
+        // SXTW has always 64-bit destination, UXTB and UXTH always 32-bit,
+        // SXTB and SXTH can have both.
+        if (instId == ArmInst::kIdSxtw) {
+          if (!ArmReg::isGpX(o0))
+            goto OperandSizeMismatch;
+        }
+        else if (instId == ArmInst::kIdUxtb || instId == ArmInst::kIdUxth) {
+          if (!ArmReg::isGpW(o0))
+            goto OperandSizeMismatch;
+        }
+        else if (ArmReg::isGpX(o0)) {
+          opCode |= kArmOpCodeSf | kArmOpCodeN;
+        }
+
+        word = opCode | (rn << 5) | rd;
+        goto EmitWord;
+      }
+      break;
+
+    case ArmInst::kEncodingBaseRR:
+      if (isign4 == ENC_OPS2(Reg, Reg) && armIsGp(o0)) {
+        if (!armSameReg(o0, o1))
+          goto OperandSizeMismatch;
+
+        rd = armGpZr(o0);
+        rn = armGpZr(o1);
+        if (ASMJIT_UNLIKELY((rd | rn) > 31))
+          goto InvalidPhysId;
+
+        // REV of a 64-bit register has `opc` 11 instead of 10.
+        uint32_t sf = armSf(o0);
+        if (sf && instId == ArmInst::kIdRev)
+          opCode |= 0x400U;
+
+        word = opCode | sf | (rn << 5) | rd;
+        goto EmitWord;
+      }
+      break;
+
+    case ArmInst::kEncodingBaseRRR:
+      if (isign4 == ENC_OPS3(Reg, Reg, Reg) && armIsGp(o0)) {
+        if (!armSameReg(o0, o1) || !armSameReg(o0, o2))
+          goto OperandSizeMismatch;
+
+        // SMULH and UMULH are 64-bit only, `sf` is part of their opcode.
+        uint32_t sf = armSf(o0);
+        if ((opCode & kArmOpCodeSf) && !sf)
+          goto OperandSizeMismatch;
+
+        rd = armGpZr(o0);
+        rn = armGpZr(o1);
+        rm = armGpZr(o2);
+        if (ASMJIT_UNLIKELY((rd | rn | rm) > 31))
+          goto InvalidPhysId;
+
+        word = opCode | sf | (rm << 16) | (rn << 5) | rd;
+        goto EmitWord;
+      }
+      break;
+
+    case ArmInst::kEncodingBaseRRRR:
+      if (isign4 == ENC_OPS4(Reg, Reg, Reg, Reg) && armIsGp(o0)) {
+        if (!armSameReg(o0, o1) || !armSameReg(o0, o2) || !armSameReg(o0, o3))
+          goto OperandSizeMismatch;
+
+        rd = armGpZr(o0);
+        rn = armGpZr(o1);
+        rm = armGpZr(o2);
+        ra = armGpZr(o3);
+        if (ASMJIT_UNLIKELY((rd | rn | rm | ra) > 31))
+          goto InvalidPhysId;
+
+        word = opCode | armSf(o0) | (rm << 16) | (ra << 10) | (rn << 5) | rd;
+        goto EmitWord;
+      }
+      break;
+
+    case ArmInst::kEncodingBaseNeg:
+      if (isign4 == ENC_OPS2(Reg, Reg) && armIsGp(o0)) {
+        if (!armSameReg(o0, o1))
+          goto OperandSizeMismatch;
+
+        rd = armGpZr(o0);
+        rm = armGpZr(o1);
+        if (ASMJIT_UNLIKELY((rd | rm) > 31))
+          goto InvalidPhysId;
+
+        word = opCode | armSf(o0) | (rm << 16) | rd;
+        goto EmitWord;
+      }
+      break;
+
+    case ArmInst::kEncodingBaseCSel:
+      if (isign4 == ENC_OPS4(Reg, Reg, Reg, Imm) && armIsGp(o0)) {
+        if (!armSameReg(o0, o1) || !armSameReg(o0, o2))
+          goto OperandSizeMismatch;
+
+        uint64_t cond = o3.as<Imm>().getUInt64();
+        if (ASMJIT_UNLIKELY(cond >= arm::kCondCount))
+          goto InvalidImmediate;
+
+        rd = armGpZr(o0);
+        rn = armGpZr(o1);
+        rm = armGpZr(o2);
+        if (ASMJIT_UNLIKELY((rd | rn | rm) > 31))
+          goto InvalidPhysId;
+
+        word = opCode | armSf(o0) | (rm << 16) | (static_cast<uint32_t>(cond) << 12) | (rn << 5) | rd;
+        goto EmitWord;
+      }
+      break;
+
+    case ArmInst::kEncodingBaseCSet:
+      if (isign4 == ENC_OPS2(Reg, Imm) && armIsGp(o0)) {
+        // CSET|CSETM Rd, cond is CSINC|CSINV Rd, ZR, ZR, invert(cond), AL and NV can't be used.
+        uint64_t cond = o1.as<Imm>().getUInt64();
+        if (ASMJIT_UNLIKELY(cond >= arm::kCondAL))
+          goto InvalidImmediate;
+
+        rd = armGpZr(o0);
+        if (ASMJIT_UNLIKELY(rd > 31))
+          goto InvalidPhysId;
+
+        word = opCode | armSf(o0) | (ArmInst::negateCond(static_cast<uint32_t>(cond)) << 12) | rd;
+        goto EmitWord;
+      }
+      break;
+
+    case ArmInst::kEncodingBaseLdSt:
+      if (isign4 == ENC_OPS2(Reg, Mem)) {
+        bool isLoad = (opCode & 0x00400000U) != 0;
+
+        if (armIsGp(o0)) {
+          // Size is 10 (W) or 11 (X), LDR (literal) has opc 00 (W) or 01 (X).
+          uint32_t sf = ArmReg::isGpX(o0);
+          scale = 2 + sf;
+          word = opCode | (scale << 30);
+          litWord = isLoad ? 0x18000000U | (sf << 30) : uint32_t(0);
+          rd = armGpZr(o0);
+        }
+        else if (o0.isReg() && o0.as<Reg>().isVec()) {
+          // Size is 10 (S), 11 (D), or 00 with opc 1x (Q).
+          if (ArmReg::isVecS(o0)) {
+            scale = 2;
+            word = opCode | kArmOpCodeLdStV | (2U << 30);
+            litWord = 0x1C000000U;
+          }
+          else if (ArmReg::isVecD(o0)) {
+            scale = 3;
+            word = opCode | kArmOpCodeLdStV | (3U << 30);
+            litWord = 0x5C000000U;
+          }
+          else if (ArmReg::isVecV(o0)) {
+            scale = 4;
+            word = opCode | kArmOpCodeLdStV | kArmOpCodeLdStQ;
+            litWord = 0x9C000000U;
+          }
+          else {
+            break;
+          }
+
+          if (!isLoad)
+            litWord = 0;
+          rd = armVecId(o0);
+        }
+        else {
+          break;
+        }
+
+        rmRel = &o1;
+        goto EmitLdSt;
+      }
+      break;
+
+    case ArmInst::kEncodingBaseLdStSized:
+      if (isign4 == ENC_OPS2(Reg, Mem) && armIsGp(o0)) {
+        // Access size is part of the opcode, LDRSB and LDRSH can sign-extend
+        // to both 32-bit (opc 11) and 64-bit (opc 10) register.
+        scale = opCode >> 30;
+        word = opCode;
+
+        if (instId == ArmInst::kIdLdrsw) {
+          if (!ArmReg::isGpX(o0))
+            goto OperandSizeMismatch;
+          litWord = 0x98000000U;
+        }
+        else if (instId == ArmInst::kIdLdrsb || instId == ArmInst::kIdLdrsh) {
+          if (ArmReg::isGpW(o0))
+            word |= 0x00400000U;
+        }
+        else if (!ArmReg::isGpW(o0)) {
+          goto OperandSizeMismatch;
+        }
+
+        rd = armGpZr(o0);
+        rmRel = &o1;
+        goto EmitLdSt;
+      }
+      break;
+
+    case ArmInst::kEncodingBaseLdpStp:
+      if (isign4 == ENC_OPS3(Reg, Reg, Mem)) {
+        if (!armSameReg(o0, o1))
+          goto OperandSizeMismatch;
+
+        if (armIsGp(o0)) {
+          // opc is 00 (W) or 10 (X).
+          uint32_t sf = ArmReg::isGpX(o0);
+          scale = 2 + sf;
+          word = opCode | (sf << 31);
+          rd = armGpZr(o0);
+          ra = armGpZr(o1);
+        }
+        else if (o0.isReg() && o0.as<Reg>().isVec()) {
+          // opc is 00 (S), 01 (D), or 10 (Q).
+          scale = ArmReg::isVecS(o0) ? 2U : ArmReg::isVecD(o0) ? 3U : 4U;
+          word = opCode | kArmOpCodeLdStV | ((scale - 2) << 30);
+          rd = armVecId(o0);
+          ra = armVecId(o1);
+        }
+        else {
+          break;
+        }
+
+        const ArmMem& m = o2.as<ArmMem>();
+        if (ASMJIT_UNLIKELY(!m.hasBaseReg() || m.hasIndex() || m.getBaseType() != ArmReg::kRegGpx))
+          goto InvalidAddress;
+
+        rn = m.getBaseId();
+        if (ASMJIT_UNLIKELY((rd | ra | rn) > 31))
+          goto InvalidPhysId;
+
+        int64_t off = m.getOffset();
+        if (ASMJIT_UNLIKELY((off & ((int64_t(1) << scale) - 1)) != 0 || !Utils::isIntN<7>(off >> scale)))
+          goto InvalidDisplacement;
+
+        // Addressing mode is post-index (01), offset (10), or pre-index (11).
+        uint32_t mode = m.isPostIndex() ? 0x00800000U :
+                        m.isPreIndex()  ? 0x01800000U : 0x01000000U;
+
+        word |= mode | ((static_cast<uint32_t>(off >> scale) & 0x7FU) << 15) | (ra << 10) | (rn << 5) | rd;
+        goto EmitWord;
+      }
+      break;
+
+    case ArmInst::kEncodingBaseAdr:
+      if (isign4 == ENC_OPS2(Reg, Label) && ArmReg::isGpX(o0)) {
+        rd = armGpZr(o0);
+        if (ASMJIT_UNLIKELY(rd > 31))
+          goto InvalidPhysId;
+
+        word = opCode | rd;
+        labelId = o1.getId();
+        goto EmitRel;
+      }
+      break;
+
+    case ArmInst::kEncodingBaseBranch:
+    case ArmInst::kEncodingBaseBranchCond:
+      if (isign4 == ENC_OPS1(Label)) {
+        word = opCode;
+        labelId = o0.getId();
+        goto EmitRel;
+      }
+      break;
+
+    case ArmInst::kEncodingBaseBranchReg:
+      if (isign4 == ENC_OPS1(Reg) && ArmReg::isGpX(o0)) {
+        rn = armGpZr(o0);
+        if (ASMJIT_UNLIKELY(rn > 30))
+          goto InvalidPhysId;
+
+        word = opCode | (rn << 5);
+        goto EmitWord;
+      }
+      break;
+
+    case ArmInst::kEncodingBaseRet:
+      if (isign4 == 0) {
+        word = opCode | (ArmGp::kIdLr << 5);
+        goto EmitWord;
+      }
+
+      if (isign4 == ENC_OPS1(Reg) && ArmReg::isGpX(o0)) {
+        rn = armGpZr(o0);
+        if (ASMJIT_UNLIKELY(rn > 30))
+          goto InvalidPhysId;
+
+        word = opCode | (rn << 5);
+        goto EmitWord;
+      }
+      break;
+
+    case ArmInst::kEncodingBaseCbz:
+      if (isign4 == ENC_OPS2(Reg, Label) && armIsGp(o0)) {
+        rd = armGpZr(o0);
+        if (ASMJIT_UNLIKELY(rd > 31))
+          goto InvalidPhysId;
+
+        word = opCode | armSf(o0) | rd;
+        labelId = o1.getId();
+        goto EmitRel;
+      }
+      break;
+
+    case ArmInst::kEncodingBaseTbz:
+      if (isign4 == ENC_OPS3(Reg, Imm, Label) && armIsGp(o0)) {
+        uint64_t bit = o1.as<Imm>().getUInt64();
+        if (ASMJIT_UNLIKELY(bit >= (ArmReg::isGpX(o0) ? 64U : 32U)))
+          goto InvalidImmediate;
+
+        rd = armGpZr(o0);
+        if (ASMJIT_UNLIKELY(rd > 31))
+          goto InvalidPhysId;
+
+        uint32_t b = static_cast<uint32_t>(bit);
+        word = opCode | ((b >> 5) << 31) | ((b & 0x1F) << 19) | rd;
+        labelId = o2.getId();
+        goto EmitRel;
+      }
+      break;
+
+    // ------------------------------------------------------------------------
+    // [FP]
+    // ------------------------------------------------------------------------
+
+    case ArmInst::kEncodingFpRR:
+      if (isign4 == ENC_OPS2(Reg, Reg) && armIsFp(o0)) {
+        if (!armSameReg(o0, o1))
+          goto OperandSizeMismatch;
+
+        rd = armVecId(o0);
+        rn = armVecId(o1);
+        if (ASMJIT_UNLIKELY((rd | rn) > 31))
+          goto InvalidPhysId;
+
+        word = opCode | armFpType(o0) | (rn << 5) | rd;
+        goto EmitWord;
+      }
+      break;
+
+    case ArmInst::kEncodingFpRRR:
+      if (isign4 == ENC_OPS3(Reg, Reg, Reg) && armIsFp(o0)) {
+        if (!armSameReg(o0, o1) || !armSameReg(o0, o2))
+          goto OperandSizeMismatch;
+
+        rd = armVecId(o0);
+        rn = armVecId(o1);
+        rm = armVecId(o2);
+        if (ASMJIT_UNLIKELY((rd | rn | rm) > 31))
+          goto InvalidPhysId;
+
+        word = opCode | armFpType(o0) | (rm << 16) | (rn << 5) | rd;
+        goto EmitWord;
+      }
+      break;
+
+    case ArmInst::kEncodingFpRRRR:
+      if (isign4 == ENC_OPS4(Reg, Reg, Reg, Reg) && armIsFp(o0)) {
+        if (!armSameReg(o0, o1) || !armSameReg(o0, o2) || !armSameReg(o0, o3))
+          goto OperandSizeMismatch;
+
+        rd = armVecId(o0);
+        rn = armVecId(o1);
+        rm = armVecId(o2);
+        ra = armVecId(o3);
+        if (ASMJIT_UNLIKELY((rd | rn | rm | ra) > 31))
+          goto InvalidPhysId;
+
+        word = opCode | armFpType(o0) | (rm << 16) | (ra << 10) | (rn << 5) | rd;
+        goto EmitWord;
+      }
+      break;
+
+    case ArmInst::kEncodingFpCmp:
+      if (!armIsFp(o0))
+        break;
+
+      rn = armVecId(o0);
+      if (isign4 == ENC_OPS2(Reg, Reg)) {
+        if (!armSameReg(o0, o1))
+          goto OperandSizeMismatch;
+
+        rm = armVecId(o1);
+        if (ASMJIT_UNLIKELY((rn | rm) > 31))
+          goto InvalidPhysId;
+
+        word = opCode | armFpType(o0) | (rm << 16) | (rn << 5);
+        goto EmitWord;
+      }
+
+      if (isign4 == ENC_OPS2(Reg, Imm)) {
+        // Only comparison with zero has an immediate form.
+        if (ASMJIT_UNLIKELY(o1.as<Imm>().getInt64() != 0))
+          goto InvalidImmediate;
+
+        if (ASMJIT_UNLIKELY(rn > 31))
+          goto InvalidPhysId;
+
+        word = opCode | armFpType(o0) | (rn << 5) | 0x8U;
+        goto EmitWord;
+      }
+      break;
+
+    case ArmInst::kEncodingFpCvt:
+      if (isign4 == ENC_OPS2(Reg, Reg) && armIsFp(o0) && armIsFp(o1)) {
+        // Conversion between the same types is not defined.
+        if (armSameReg(o0, o1))
+          goto InvalidInstruction;
+
+        rd = armVecId(o0);
+        rn = armVecId(o1);
+        if (ASMJIT_UNLIKELY((rd | rn) > 31))
+          goto InvalidPhysId;
+
+        word = opCode | armFpType(o1) | (static_cast<uint32_t>(ArmReg::isVecD(o0)) << 15) | (rn << 5) | rd;
+        goto EmitWord;
+      }
+      break;
+
+    case ArmInst::kEncodingFpCvtFromGp:
+      if (isign4 == ENC_OPS2(Reg, Reg) && armIsFp(o0) && armIsGp(o1)) {
+        rd = armVecId(o0);
+        rn = armGpZr(o1);
+        if (ASMJIT_UNLIKELY((rd | rn) > 31))
+          goto InvalidPhysId;
+
+        word = opCode | armSf(o1) | armFpType(o0) | (rn << 5) | rd;
+        goto EmitWord;
+      }
+      break;
+
+    case ArmInst::kEncodingFpCvtToGp:
+      if (isign4 == ENC_OPS2(Reg, Reg) && armIsGp(o0) && armIsFp(o1)) {
+        rd = armGpZr(o0);
+        rn = armVecId(o1);
+        if (ASMJIT_UNLIKELY((rd | rn) > 31))
+          goto InvalidPhysId;
+
+        word = opCode | armSf(o0) | armFpType(o1) | (rn << 5) | rd;
+        goto EmitWord;
+      }
+      break;
+
+    case ArmInst::kEncodingFpMov:
+      if (isign4 == ENC_OPS2(Reg, Reg)) {
+        if (armIsFp(o0) && armIsFp(o1)) {
+          if (!armSameReg(o0, o1))
+            goto OperandSizeMismatch;
+
+          rd = armVecId(o0);
+          rn = armVecId(o1);
+          if (ASMJIT_UNLIKELY((rd | rn) > 31))
+            goto InvalidPhysId;
+
+          word = opCode | armFpType(o0) | (rn << 5) | rd;
+          goto EmitWord;
+        }
+
+        // FMOV between GP and FP registers of the same size (W <-> S, X <-> D).
+        if (armIsGp(o0) && armIsFp(o1)) {
+          if (o0.getSize() != o1.getSize())
+            goto OperandSizeMismatch;
+
+          rd = armGpZr(o0);
+          rn = armVecId(o1);
+          word = ArmReg::isGpX(o0) ? 0x9E660000U : 0x1E260000U;
+        }
+        else if (armIsFp(o0) && armIsGp(o1)) {
+          if (o0.getSize() != o1.getSize())
+            goto OperandSizeMismatch;
+
+          rd = armVecId(o0);
+          rn = armGpZr(o1);
+          word = ArmReg::isGpX(o1) ? 0x9E670000U : 0x1E270000U;
+        }
+        else {
+          break;
+        }
+
+        if (ASMJIT_UNLIKELY((rd | rn) > 31))
+          goto InvalidPhysId;
+
+        word |= (rn << 5) | rd;
+        goto EmitWord;
+      }
+      break;
+  }
+  goto InvalidInstruction;
+
+  // --------------------------------------------------------------------------
+  // [Emit - AddSub]
+  // --------------------------------------------------------------------------
+
+EmitAddSubImm:
+  {
+    uint32_t sf = armSf(o0);
+    int64_t imm = rmRel->as<Imm>().getInt64();
+
+    // Negative immediate flips ADD <-> SUB.
+    if (imm < 0 && imm >= -int64_t(0xFFF000)) {
+      opCode ^= 0x40000000U;
+      imm = -imm;
+    }
+
+    uint32_t sh = 0;
+    if (imm < 0 || imm > 0xFFF) {
+      if (imm < 0 || (imm & 0xFFF) != 0 || imm > 0xFFF000)
+        goto InvalidImmediate;
+
+      imm >>= 12;
+      sh = 1;
+    }
+
+    if (ASMJIT_UNLIKELY((rd | rn) > 31))
+      goto InvalidPhysId;
+
+    word = opCode | sf | (sh << 22) | (static_cast<uint32_t>(imm) << 10) | (rn << 5) | rd;
+    goto EmitWord;
+  }
+
+EmitAddSubReg:
+  {
+    uint32_t sf = armSf(o0);
+    uint64_t shift = rmRel->isImm() ? rmRel->as<Imm>().getUInt64() : uint64_t(0);
+
+    if (ASMJIT_UNLIKELY((rd | rn | rm) > 31))
+      goto InvalidPhysId;
+
+    // Shifted register form can't use SP, extended register form is used
+    // instead (UXTW|UXTX), which limits the shift to 4.
+    uint32_t rdIsSp = (opCode & 0x20000000U) == 0 && rd == 31;
+    if (rdIsSp || rn == 31) {
+      if (ASMJIT_UNLIKELY(shift > 4))
+        goto InvalidImmediate;
+
+      uint32_t option = sf ? 3U : 2U;
+      word = (opCode & 0x60000000U) | 0x0B200000U | sf | (rm << 16) |
+             (option << 13) | (static_cast<uint32_t>(shift) << 10) | (rn << 5) | rd;
+      goto EmitWord;
+    }
+
+    if (ASMJIT_UNLIKELY(shift >= (sf ? 64U : 32U)))
+      goto InvalidImmediate;
+
+    word = (opCode & 0x60000000U) | 0x0B000000U | sf | (rm << 16) |
+           (static_cast<uint32_t>(shift) << 10) | (rn << 5) | rd;
+    goto EmitWord;
+  }
+
+  // --------------------------------------------------------------------------
+  // [Emit - Logical]
+  // --------------------------------------------------------------------------
+
+EmitLogicalImm:
+  {
+    uint32_t sf = armSf(o0);
+    uint32_t logicalImm;
+
+    if (ASMJIT_UNLIKELY((rd | rn) > 31))
+      goto InvalidPhysId;
+
+    if (!encodeLogicalImm(rmRel->as<Imm>().getUInt64(), sf ? 64 : 32, logicalImm))
+      goto InvalidImmediate;
+
+    word = (opCode & 0x60000000U) | 0x12000000U | sf | (logicalImm << 10) | (rn << 5) | rd;
+    goto EmitWord;
+  }
+
+EmitLogicalReg:
+  {
+    uint32_t sf = armSf(o0);
+    uint64_t shift = rmRel->isImm() ? rmRel->as<Imm>().getUInt64() : uint64_t(0);
+
+    if (ASMJIT_UNLIKELY((rd | rn | rm) > 31))
+      goto InvalidPhysId;
+
+    if (ASMJIT_UNLIKELY(shift >= (sf ? 64U : 32U)))
+      goto InvalidImmediate;
+
+    word = opCode | sf | (rm << 16) | (static_cast<uint32_t>(shift) << 10) | (rn << 5) | rd;
+    goto EmitWord;
+  }
+
+  // --------------------------------------------------------------------------
+  // [Emit - Load / Store]
+  // --------------------------------------------------------------------------
+
+EmitLdSt:
+  {
+    const ArmMem& m = rmRel->as<ArmMem>();
+
+    if (ASMJIT_UNLIKELY(rd > 31))
+      goto InvalidPhysId;
+
+    // LDR (literal) - PC relative load from a label.
+    if (m.hasBaseLabel()) {
+      if (ASMJIT_UNLIKELY(!litWord || m.hasIndex() || m.getMode() != ArmMem::kModeOffset))
+        goto InvalidAddress;
+
+      word = litWord | rd;
+      labelId = m.getBaseId();
+      relOffset = m.getOffsetLo32();
+      goto EmitRel;
+    }
+
+    if (ASMJIT_UNLIKELY(m.getBaseType() != ArmReg::kRegGpx))
+      goto InvalidAddress;
+
+    rn = m.getBaseId();
+    if (ASMJIT_UNLIKELY(rn > 31))
+      goto InvalidPhysId;
+
+    int64_t off = m.getOffset();
+
+    // Register offset - [Xn|SP, Xm|Wm {, LSL|SXTW #scale}].
+    if (m.hasIndex()) {
+      if (ASMJIT_UNLIKELY(m.getMode() != ArmMem::kModeOffset || off != 0))
+        goto InvalidAddress;
+
+      uint32_t option;
+      if (m.getIndexType() == ArmReg::kRegGpx)
+        option = 3; // LSL.
+      else if (m.getIndexType() == ArmReg::kRegGpw)
+        option = 6; // SXTW.
+      else
+        goto InvalidAddressIndex;
+
+      rm = m.getIndexId();
+      if (ASMJIT_UNLIKELY(rm > 30))
+        goto InvalidPhysId;
+
+      uint32_t shift = m.getShift();
+      if (ASMJIT_UNLIKELY(shift != 0 && shift != scale))
+        goto InvalidAddressScale;
+
+      word = (word & ~uint32_t(kArmOpCodeLdStOff)) | 0x00200800U | (rm << 16) |
+             (option << 13) | (static_cast<uint32_t>(shift != 0) << 12) | (rn << 5) | rd;
+      goto EmitWord;
+    }
+
+    // Pre-index and post-index - [Xn|SP, #simm9]! and [Xn|SP], #simm9.
+    if (m.getMode() != ArmMem::kModeOffset) {
+      if (ASMJIT_UNLIKELY(!Utils::isIntN<9>(off)))
+        goto InvalidDisplacement;
+
+      word = (word & ~uint32_t(kArmOpCodeLdStOff)) | ((static_cast<uint32_t>(off) & 0x1FFU) << 12) |
+             (m.isPreIndex() ? 0xC00U : 0x400U) | (rn << 5) | rd;
+      goto EmitWord;
+    }
+
+    // Unsigned offset scaled by the access size - [Xn|SP, #uimm12 << scale].
+    if (off >= 0 && (off & ((int64_t(1) << scale) - 1)) == 0 && (off >> scale) <= 0xFFF) {
+      word |= (static_cast<uint32_t>(off >> scale) << 10) | (rn << 5) | rd;
+      goto EmitWord;
+    }
+
+    // Unscaled offset (LDUR|STUR) - [Xn|SP, #simm9].
+    if (Utils::isIntN<9>(off)) {
+      word = (word & ~uint32_t(kArmOpCodeLdStOff)) | ((static_cast<uint32_t>(off) & 0x1FFU) << 12) | (rn << 5) | rd;
+      goto EmitWord;
+    }
+
+    goto InvalidDisplacement;
+  }
+
+  // --------------------------------------------------------------------------
+  // [Emit - Relative]
+  // --------------------------------------------------------------------------
+
+EmitRel:
+  {
+    LabelEntry* label = _code->getLabelEntry(labelId);
+    if (ASMJIT_UNLIKELY(!label))
+      goto InvalidLabel;
+
+    size_t offset = (size_t)(cursor - _bufferData);
+    Utils::writeU32uLE(cursor, word);
+
+    if (label->isBound()) {
+      // The displacement is a bit-field of the instruction, it's not possible
+      // to reach a label bound in another section.
+      if (ASMJIT_UNLIKELY(label->getSectionId() != _section->getId()))
+        goto InvalidDisplacement;
+
+      err = ArmInternal::patchRel(cursor, static_cast<intptr_t>(label->getOffset()) - static_cast<intptr_t>(offset) + relOffset);
+      if (ASMJIT_UNLIKELY(err)) goto Failed;
+    }
+    else {
+      // Chain with label, the link points to the instruction itself.
+      LabelLink* link = _code->newLabelLink(label, _section->getId(), offset, relOffset);
+      if (ASMJIT_UNLIKELY(!link))
+        goto NoHeapMemory;
+    }
+
+    cursor += 4;
+    goto EmitDone;
+  }
+
+  // --------------------------------------------------------------------------
+  // [Emit - Word]
+  // --------------------------------------------------------------------------
+
+EmitWord:
+  Utils::writeU32uLE(cursor, word);
+  cursor += 4;
+
+  // --------------------------------------------------------------------------
+  // [Done]
+  // --------------------------------------------------------------------------
+
+EmitDone:
+#if !defined(ASMJIT_DISABLE_LOGGING)
+  // Logging is a performance hit anyway, so make it the unlikely case. The
+  // logger filter is checked here so filtered instructions are not formatted.
+  if (ASMJIT_UNLIKELY(options & CodeEmitter::kOptionLoggingEnabled) && _code->_logger->isEnabled(Logger::kCategoryInst))
+    _emitLog(instId, options, o0, o1, o2, o3, 0, 0, cursor);
+#endif // !ASMJIT_DISABLE_LOGGING
+
+  if (ASMJIT_UNLIKELY(_code->_traceBuffer))
+    _emitTrace(instId, options, o0, o1, o2, o3, cursor);
+
+  if (ASMJIT_UNLIKELY(_code->_statsEnabled)) {
+    _code->_stats.instCount++;
+    _code->_stats.instSize += (uint64_t)(cursor - _bufferPtr);
+  }
+
+  resetOptions();
+  resetExtraReg();
+  resetInlineComment();
+
+  _bufferPtr = cursor;
+  return kErrorOk;
+
+  // --------------------------------------------------------------------------
+  // [Error Cases]
+  // --------------------------------------------------------------------------
+
+#define ERROR_HANDLER(ERROR)                \
+ERROR:                                      \
+  err = DebugUtils::errored(kError##ERROR); \
+  goto Failed;
+
+ERROR_HANDLER(NoHeapMemory)
+ERROR_HANDLER(InvalidArgument)
+ERROR_HANDLER(InvalidLabel)
+ERROR_HANDLER(InvalidInstruction)
+ERROR_HANDLER(InvalidPhysId)
+ERROR_HANDLER(InvalidAddress)
+ERROR_HANDLER(InvalidAddressIndex)
+ERROR_HANDLER(InvalidAddressScale)
+ERROR_HANDLER(InvalidDisplacement)
+ERROR_HANDLER(InvalidImmediate)
+ERROR_HANDLER(OperandSizeMismatch)
+
+Failed:
+  return _emitFailed(err, instId, options, o0, o1, o2, o3);
+}
+
+#undef ERROR_HANDLER
+#undef ENC_OPS4
+#undef ENC_OPS3
+#undef ENC_OPS2
+#undef ENC_OPS1
+
+// ============================================================================
+// [asmjit::ArmAssembler - Align]
+// ============================================================================
+
+Error ArmAssembler::align(uint32_t mode, uint32_t alignment) {
+#if !defined(ASMJIT_DISABLE_LOGGING)
+  if ((_globalOptions & kOptionLoggingEnabled) && _code->_logger->isEnabled(Logger::kCategoryData))
+    _code->_logger->logf("%s.align %u\n", _code->_logger->getIndentation(), alignment);
+#endif // !ASMJIT_DISABLE_LOGGING
+
+  if (mode >= kAlignCount)
+    return setLastError(DebugUtils::errored(kErrorInvalidArgument));
+
+  if (alignment <= 1)
+    return kErrorOk;
+
+  if (!Utils::isPowerOf2(alignment) || alignment > Globals::kMaxAlignment)
+    return setLastError(DebugUtils::errored(kErrorInvalidArgument));
+
+  size_t i = Utils::alignDiff<size_t>(getOffset(), alignment);
+  if (i == 0)
+    return kErrorOk;
+
+  if (getRemainingSpace() < i) {
+    Error err = _code->growBuffer(&_section->_buffer, i);
+    if (ASMJIT_UNLIKELY(err)) return setLastError(err);
+  }
+
+  if (ASMJIT_UNLIKELY(_code->_statsEnabled))
+    _code->_stats.alignSize += i;
+
+  uint8_t* cursor = _bufferPtr;
+  switch (mode) {
+    case kAlignCode: {
+      // Code is aligned by NOPs, an unaligned code offset is padded by zeros
+      // first, it can't be executed anyway.
+      size_t n = i & 3;
+      ::memset(cursor, 0, n);
+      for (; n < i; n += 4)
+        Utils::writeU32uLE(cursor + n, 0xD503201FU);
+      break;
+    }
+
+    case kAlignData:
+    case kAlignZero:
+      ::memset(cursor, 0, i);
+      break;
+  }
+
+  _bufferPtr = cursor + i;
+  return kErrorOk;
+}
+
+// ============================================================================
+// [asmjit::ArmAssembler - Test]
+// ============================================================================
+
+#if defined(ASMJIT_TEST)
+//! \internal
+//!
+//! Compare words emitted by `a` with `expected`, which were produced by the
+//! GNU/LLVM assembler from the same source.
+static void ArmAssembler_checkWords(ArmAssembler& a, const uint32_t* expected, size_t count, const char* group) {
+  EXPECT(a.getLastError() == kErrorOk,
+    "%s: assembler failed: %s", group, DebugUtils::errorAsString(a.getLastError()));
+  EXPECT(a.getOffset() == count * 4,
+    "%s: emitted %u bytes, expected %u", group, unsigned(a.getOffset()), unsigned(count * 4));
+
+  const uint8_t* data = a.getBufferData();
+  for (size_t i = 0; i < count; i++) {
+    uint32_t word = Utils::readU32uLE(data + i * 4);
+    EXPECT(word == expected[i],
+      "%s: instruction #%u encoded as 0x%08X, expected 0x%08X", group, unsigned(i), word, expected[i]);
+  }
+}
+
+UNIT(arm_assembler) {
+  using namespace arm;
+
+  CodeHolder code;
+  code.init(CodeInfo(ArchInfo::kTypeA64));
+  ArmAssembler a(&code);
+
+  INFO("Checking data-processing instructions");
+  {
+    static const uint32_t expected[] = {
+      0x8B020020U, // add x0, x1, x2
+      0x113FFC83U, // add w3, w4, #4095
+      0x91400420U, // add x0, x1, #1, lsl #12
+      0x8B020C20U, // add x0, x1, x2, lsl #3
+      0xD1002020U, // sub x0, x1, #8
+      0xD1002020U, // add x0, x1, #-8 -> sub x0, x1, #8
+      0x910043FFU, // add sp, sp, #16
+      0xD10083FFU, // sub sp, sp, #32
+      0x8B2163E0U, // add x0, sp, x1 (uxtx)
+      0xB1000420U, // adds x0, x1, #1
+      0x6B020020U, // subs w0, w1, w2
+      0xF100281FU, // cmp x0, #10
+      0x6B02003FU, // cmp w1, w2
+      0xB100041FU, // cmn x0, #1
+      0x72001C1FU, // tst w0, #0xFF
+      0x92403C20U, // and x0, x1, #0xFFFF
+      0x2A021020U, // orr w0, w1, w2, lsl #4
+      0xCA020020U, // eor x0, x1, x2
+      0x0A220020U, // bic w0, w1, w2
+      0xAA0103E0U, // mov x0, x1
+      0x9100001FU, // mov sp, x0
+      0x910003FDU, // mov x29, sp
+      0x52800000U, // mov w0, #0
+      0x92800000U, // mov x0, #-1
+      0x52A00020U, // mov w0, #0x10000
+      0xB2089FE0U, // mov x0, #0xFF00FF00FF00FF00
+      0xD2A24680U, // movz x0, #0x1234, lsl #16
+      0xF2F7DDE0U, // movk x0, #0xBEEF, lsl #48
+      0xD37DF020U, // lsl x0, x1, #3
+      0x531F7C20U, // lsr w0, w1, #31
+      0x937FFC20U, // asr x0, x1, #63
+      0x13812020U, // ror w0, w1, #8
+      0x9AC22020U, // lsl x0, x1, x2
+      0x93401C20U, // sxtb x0, w1
+      0x93407C20U, // sxtw x0, w1
+      0x53001C20U, // uxtb w0, w1
+      0x9B027C20U, // mul x0, x1, x2
+      0x1B020C20U, // madd w0, w1, w2, w3
+      0x9AC20C20U, // sdiv x0, x1, x2
+      0x9B427C20U, // smulh x0, x1, x2
+      0x4B0103E0U, // neg w0, w1
+      0xAA2103E0U, // mvn x0, x1
+      0x1A820020U, // csel w0, w1, w2, eq
+      0x1A9F07E0U, // cset w0, ne
+      0xDAC01020U, // clz x0, x1
+      0xDAC00C20U, // rev x0, x1
+      0x5AC00820U  // rev w0, w1
+    };
+
+    a.add(x0, x1, x2);
+    a.add(w3, w4, 4095);
+    a.add(x0, x1, 0x1000);
+    a.add(x0, x1, x2, 3);
+    a.sub(x0, x1, 8);
+    a.add(x0, x1, -8);
+    a.add(sp, sp, 16);
+    a.sub(sp, sp, 32);
+    a.add(x0, sp, x1);
+    a.adds(x0, x1, 1);
+    a.subs(w0, w1, w2);
+    a.cmp(x0, 10);
+    a.cmp(w1, w2);
+    a.cmn(x0, 1);
+    a.tst(w0, 0xFF);
+    a.and_(x0, x1, 0xFFFF);
+    a.orr(w0, w1, w2, 4);
+    a.eor(x0, x1, x2);
+    a.bic(w0, w1, w2);
+    a.mov(x0, x1);
+    a.mov(sp, x0);
+    a.mov(x29, sp);
+    a.mov(w0, 0);
+    a.mov(x0, -1);
+    a.mov(w0, 0x10000);
+    a.mov(x0, Imm(ASMJIT_UINT64_C(0xFF00FF00FF00FF00)));
+    a.movz(x0, 0x1234, 16);
+    a.movk(x0, 0xBEEF, 48);
+    a.lsl(x0, x1, 3);
+    a.lsr(w0, w1, 31);
+    a.asr(x0, x1, 63);
+    a.ror(w0, w1, 8);
+    a.lsl(x0, x1, x2);
+    a.sxtb(x0, w1);
+    a.sxtw(x0, w1);
+    a.uxtb(w0, w1);
+    a.mul(x0, x1, x2);
+    a.madd(w0, w1, w2, w3);
+    a.sdiv(x0, x1, x2);
+    a.smulh(x0, x1, x2);
+    a.neg(w0, w1);
+    a.mvn(x0, x1);
+    a.csel(w0, w1, w2, kCondEQ);
+    a.cset(w0, kCondNE);
+    a.clz(x0, x1);
+    a.rev(x0, x1);
+    a.rev(w0, w1);
+
+    ArmAssembler_checkWords(a, expected, ASMJIT_ARRAY_SIZE(expected), "data-processing");
+  }
+
+  INFO("Checking loads and stores of each addressing form");
+  {
+    static const uint32_t expected[] = {
+      0xF9400020U, // ldr x0, [x1]
+      0xB9400BE0U, // ldr w0, [sp, #8]
+      0xF97FFC20U, // ldr x0, [x1, #32760]
+      0xF85F8020U, // ldur x0, [x1, #-8]
+      0xF8403020U, // ldur x0, [x1, #3]
+      0xF8410C20U, // ldr x0, [x1, #16]!
+      0xF8410420U, // ldr x0, [x1], #16
+      0xF8626820U, // ldr x0, [x1, x2]
+      0xF8627820U, // ldr x0, [x1, x2, lsl #3]
+      0xB862C820U, // ldr w0, [x1, w2, sxtw]
+      0xB862D820U, // ldr w0, [x1, w2, sxtw #2]
+      0xF81F0FE0U, // str x0, [sp, #-16]!
+      0xB9000420U, // str w0, [x1, #4]
+      0x39000420U, // strb w0, [x1, #1]
+      0x79000420U, // strh w0, [x1, #2]
+      0x3943FC20U, // ldrb w0, [x1, #255]
+      0x79400420U, // ldrh w0, [x1, #2]
+      0xB9800420U, // ldrsw x0, [x1, #4]
+      0x39C00020U, // ldrsb w0, [x1]
+      0x39800020U, // ldrsb x0, [x1]
+      0x79800C20U, // ldrsh x0, [x1, #6]
+      0xA8C17BFDU, // ldp x29, x30, [sp], #16
+      0xA9BF7BFDU, // stp x29, x30, [sp, #-16]!
+      0xA90153F3U, // stp x19, x20, [sp, #16]
+      0x29410440U  // ldp w0, w1, [x2, #8]
+    };
+
+    a.setOffset(0);
+    a.ldr(x0, ptr(x1));
+    a.ldr(w0, ptr(sp, 8));
+    a.ldr(x0, ptr(x1, 32760));
+    a.ldr(x0, ptr(x1, -8));
+    a.ldr(x0, ptr(x1, 3));
+    a.ldr(x0, ptr_pre(x1, 16));
+    a.ldr(x0, ptr_post(x1, 16));
+    a.ldr(x0, ptr(x1, x2));
+    a.ldr(x0, ptr(x1, x2, 3));
+    a.ldr(w0, ptr(x1, w2));
+    a.ldr(w0, ptr(x1, w2, 2));
+    a.str(x0, ptr_pre(sp, -16));
+    a.str(w0, ptr(x1, 4));
+    a.strb(w0, ptr(x1, 1));
+    a.strh(w0, ptr(x1, 2));
+    a.ldrb(w0, ptr(x1, 255));
+    a.ldrh(w0, ptr(x1, 2));
+    a.ldrsw(x0, ptr(x1, 4));
+    a.ldrsb(w0, ptr(x1));
+    a.ldrsb(x0, ptr(x1));
+    a.ldrsh(x0, ptr(x1, 6));
+    a.ldp(x29, x30, ptr_post(sp, 16));
+    a.stp(x29, x30, ptr_pre(sp, -16));
+    a.stp(x19, x20, ptr(sp, 16));
+    a.ldp(w0, w1, ptr(x2, 8));
+
+    ArmAssembler_checkWords(a, expected, ASMJIT_ARRAY_SIZE(expected), "load/store");
+
+    INFO("Checking that unencodable addresses are rejected");
+    a.setOffset(0);
+    EXPECT(a.ldr(x0, ptr(x1, 0x10000)) == kErrorInvalidDisplacement);
+    a.resetLastError();
+    EXPECT(a.ldr(x0, ptr(x1, x2, 2)) == kErrorInvalidAddressScale);
+    a.resetLastError();
+    EXPECT(a.ldp(x0, x1, ptr(x2, 4)) == kErrorInvalidDisplacement);
+    a.resetLastError();
+  }
+
+  INFO("Checking branches and label fixups");
+  {
+    static const uint32_t expected[] = {
+      0x14000009U, // L0: b L1
+      0x54000101U, // b.ne L1
+      0x340000E0U, // cbz w0, L1
+      0xB50000C1U, // cbnz x1, L1
+      0x361800A0U, // tbz w0, #3, L1
+      0xB7400080U, // tbnz x0, #40, L1
+      0x94000003U, // bl L1
+      0x10000040U, // adr x0, L1
+      0x580000E1U, // ldr x1, L2
+      0x14000000U, // L1: b L1
+      0x54FFFEC0U, // b.eq L0
+      0xD61F0200U, // br x16
+      0xD63F0220U, // blr x17
+      0xD65F03C0U, // ret
+      0xD65F0020U, // ret x1
+      0xD503201FU  // L2: nop
+    };
+
+    a.setOffset(0);
+    Label L0 = a.newLabel();
+    Label L1 = a.newLabel();
+    Label L2 = a.newLabel();
+
+    // Forward references are patched when the label is bound, backward ones
+    // are encoded directly.
+    a.bind(L0);
+    a.b(L1);
+    a.b(kCondNE, L1);
+    a.cbz(w0, L1);
+    a.cbnz(x1, L1);
+    a.tbz(w0, Imm(3), L1);
+    a.tbnz(x0, Imm(40), L1);
+    a.bl(L1);
+    a.adr(x0, L1);
+    a.ldr(x1, ptr(L2));
+    a.bind(L1);
+    a.b(L1);
+    a.b(kCondEQ, L0);
+    a.br(x16);
+    a.blr(x17);
+    a.ret();
+    a.ret(x1);
+    a.bind(L2);
+    a.nop();
+
+    ArmAssembler_checkWords(a, expected, ASMJIT_ARRAY_SIZE(expected), "branch");
+  }
+
+  INFO("Checking FP/SIMD moves, loads, and stores");
+  {
+    static const uint32_t expected[] = {
+      0x1E604020U, // fmov d0, d1
+      0x1E204020U, // fmov s0, s1
+      0x9E660020U, // fmov x0, d1
+      0x9E670020U, // fmov d0, x1
+      0x1E260020U, // fmov w0, s1
+      0x1E270020U, // fmov s0, w1
+      0x4EA11C20U, // mov v0.16b, v1.16b
+      0xFD400400U, // ldr d0, [x0, #8]
+      0xBD0007E1U, // str s1, [sp, #4]
+      0x3DC00400U, // ldr q0, [x0, #16]
+      0x3C810400U, // str q0, [x0], #16
+      0xFC617800U, // ldr d0, [x0, x1, lsl #3]
+      0x6D4127E8U, // ldp d8, d9, [sp, #16]
+      0xADBF07E0U, // stp q0, q1, [sp, #-32]!
+      0x1E622820U, // fadd d0, d1, d2
+      0x1E22C020U, // fcvt d0, s1
+      0x1E620020U, // scvtf d0, w1
+      0x9E780020U, // fcvtzs x0, d1
+      0x1E602008U, // fcmp d0, #0.0
+      0x1E212000U  // fcmp s0, s1
+    };
+
+    a.setOffset(0);
+    a.fmov(d0, d1);
+    a.fmov(s0, s1);
+    a.fmov(x0, d1);
+    a.fmov(d0, x1);
+    a.fmov(w0, s1);
+    a.fmov(s0, w1);
+    a.mov(v0, v1);
+    a.ldr(d0, ptr(x0, 8));
+    a.str(s1, ptr(sp, 4));
+    a.ldr(v0, ptr(x0, 16));
+    a.str(v0, ptr_post(x0, 16));
+    a.ldr(d0, ptr(x0, x1, 3));
+    a.ldp(d8, d9, ptr(sp, 16));
+    a.stp(v0, v1, ptr_pre(sp, -32));
+    a.fadd(d0, d1, d2);
+    a.fcvt(d0, s1);
+    a.scvtf(d0, w1);
+    a.fcvtzs(x0, d1);
+    a.fcmp(d0, 0);
+    a.fcmp(s0, s1);
+
+    ArmAssembler_checkWords(a, expected, ASMJIT_ARRAY_SIZE(expected), "fp/simd");
+  }
+}
+#endif // ASMJIT_TEST
+
+} // asmjit namespace
+
+// [Api-End]
+#include "../asmjit_apiend.h"
+
+// [Guard]
+#endif // ASMJIT_BUILD_ARM
@@ -0,0 +1,93 @@
+// [AsmJit]
+// Complete x86/x64 JIT and Remote Assembler for C++.
+//
+// [License]
+// Zlib - See LICENSE.md file in the package.
+
+// [Guard]
+#ifndef _ASMJIT_ARM_ARMASSEMBLER_H
+#define _ASMJIT_ARM_ARMASSEMBLER_H
+
+// [Dependencies]
+#include "../base/assembler.h"
+#include "../base/utils.h"
+#include "../arm/armemitter.h"
+#include "../arm/armoperand.h"
+
+// [Api-Begin]
+#include "../asmjit_apibegin.h"
+
+namespace asmjit {
+
+//! \addtogroup asmjit_arm
+//! \{
+
+// ============================================================================
+// [asmjit::ArmAssembler]
+// ============================================================================
+
+//! ARM assembler.
+//!
+//! ARM assembler emits AArch64 (A64) machine-code into buffers managed by
+//! \ref CodeHolder. Every instruction is a single 32-bit word, labels are
+//! linked to the instruction itself and patched by `bind()`. AArch32 (A32
+//! and THUMB) is not supported, attaching to such `CodeHolder` fails.
+class ASMJIT_VIRTAPI ArmAssembler
+  : public Assembler,
+    public ArmEmitterExplicitT<ArmAssembler> {
+
+public:
+  typedef Assembler Base;
+
+  // --------------------------------------------------------------------------
+  // [Construction / Destruction]
+  // --------------------------------------------------------------------------
+
+  ASMJIT_API ArmAssembler(CodeHolder* code = nullptr) noexcept;
+  ASMJIT_API virtual ~ArmAssembler() noexcept;
+
+  // --------------------------------------------------------------------------
+  // [Compatibility]
+  // --------------------------------------------------------------------------
+
+  //! Explicit cast to `ArmEmitter`.
+  ASMJIT_INLINE ArmEmitter* asEmitter() noexcept { return reinterpret_cast<ArmEmitter*>(this); }
+  //! Explicit cast to `ArmEmitter` (const).
+  ASMJIT_INLINE const ArmEmitter* asEmitter() const noexcept { return reinterpret_cast<const ArmEmitter*>(this); }
+
+  //! Implicit cast to `ArmEmitter`.
+  ASMJIT_INLINE operator ArmEmitter&() noexcept { return *asEmitter(); }
+  //! Implicit cast to `ArmEmitter` (const).
+  ASMJIT_INLINE operator const ArmEmitter&() const noexcept { return *asEmitter(); }
+
+  // --------------------------------------------------------------------------
+  // [Events]
+  // --------------------------------------------------------------------------
+
+  ASMJIT_API Error onAttach(CodeHolder* code) noexcept override;
+  ASMJIT_API Error onDetach(CodeHolder* code) noexcept override;
+
+  // --------------------------------------------------------------------------
+  // [Code-Generation]
+  // --------------------------------------------------------------------------
+
+  using CodeEmitter::_emit;
+
+  ASMJIT_API Error _emit(uint32_t instId, const Operand_& o0, const Operand_& o1, const Operand_& o2, const Operand_& o3) override;
+  ASMJIT_API Error align(uint32_t mode, uint32_t alignment) override;
+
+  //! Encode a logical immediate `imm` of `width` bits (32 or 64) as used by
+  //! `and`, `orr`, `eor`, and `ands`. Returns true and stores `N:immr:imms`
+  //! (13 bits) to `out` if `imm` can be encoded.
+  ASMJIT_API static bool encodeLogicalImm(uint64_t imm, uint32_t width, uint32_t& out) noexcept;
+};
+
+//! \}
+
+} // asmjit namespace
+
+// [Api-End]
+#include "../asmjit_apiend.h"
+
+// [Guard]
+#endif // _ASMJIT_ARM_ARMASSEMBLER_H
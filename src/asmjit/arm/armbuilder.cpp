@@ -0,0 +1,137 @@
+// [AsmJit]
+// Complete x86/x64 JIT and Remote Assembler for C++.
+//
+// [License]
+// Zlib - See LICENSE.md file in the package.
+
+// [Export]
+#define ASMJIT_EXPORTS
+
+// [Guard]
+#include "../asmjit_build.h"
+#if defined(ASMJIT_BUILD_ARM) && !defined(ASMJIT_DISABLE_BUILDER)
+
+// [Dependencies]
+#include "../base/osutils.h"
+#include "../arm/armassembler.h"
+#include "../arm/armbuilder.h"
+
+// [Api-Begin]
+#include "../asmjit_apibegin.h"
+
+namespace asmjit {
+
+// ============================================================================
+// [asmjit::ArmBuilder - Construction / Destruction]
+// ============================================================================
+
+ArmBuilder::ArmBuilder(CodeHolder* code) noexcept : CodeBuilder() {
+  if (code)
+    code->attach(this);
+}
+ArmBuilder::~ArmBuilder() noexcept {}
+
+// ============================================================================
+// [asmjit::ArmBuilder - Events]
+// ============================================================================
+
+Error ArmBuilder::onAttach(CodeHolder* code) noexcept {
+  // Only AArch64 is supported.
+  uint32_t archType = code->getArchType();
+  if (archType != ArchInfo::kTypeA64)
+    return DebugUtils::errored(kErrorInvalidArch);
+
+  ASMJIT_PROPAGATE(Base::onAttach(code));
+
+  _nativeGpArray = armOpData.gpx;
+  _nativeGpReg = _nativeGpArray[0];
+  return kErrorOk;
+}
+
+// ============================================================================
+// [asmjit::ArmBuilder - Finalize]
+// ============================================================================
+
+Error ArmBuilder::finalize() {
+  if (_lastError) return _lastError;
+
+  Error err = runPasses();
+  if (ASMJIT_UNLIKELY(err)) return setLastError(err);
+
+  uint64_t startTime = hasStatsEnabled() ? OSUtils::getHighResTime() : uint64_t(0);
+
+  if (_code->_cgAsm) {
+    err = serialize(_code->_cgAsm);
+  }
+  else {
+    ArmAssembler a(_code);
+    err = serialize(&a);
+  }
+
+  if (hasStatsEnabled())
+    _serializeTime += OSUtils::getHighResTime() - startTime;
+  return err;
+}
+
+// ============================================================================
+// [asmjit::ArmBuilder - Inst]
+// ============================================================================
+
+Error ArmBuilder::_emit(uint32_t instId, const Operand_& o0, const Operand_& o1, const Operand_& o2, const Operand_& o3) {
+  return _emit(instId, o0, o1, o2, o3, _none, _none);
+}
+
+Error ArmBuilder::_emit(uint32_t instId, const Operand_& o0, const Operand_& o1, const Operand_& o2, const Operand_& o3, const Operand_& o4, const Operand_& o5) {
+  uint32_t options = getOptions() | getGlobalOptions();
+  const char* inlineComment = getInlineComment();
+
+  uint32_t opCount = static_cast<uint32_t>(!o0.isNone()) +
+                     static_cast<uint32_t>(!o1.isNone()) +
+                     static_cast<uint32_t>(!o2.isNone()) +
+                     static_cast<uint32_t>(!o3.isNone()) ;
+
+  // Count 5th and 6th operands.
+  if (!o4.isNone()) opCount = 5;
+  if (!o5.isNone()) opCount = 6;
+
+  // Don't do anything if we are in error state, the instruction is validated
+  // by the assembler when the nodes are serialized.
+  if (ASMJIT_UNLIKELY(options & kOptionMaybeFailureCase) && _lastError)
+    return _lastError;
+
+  resetOptions();
+  resetInlineComment();
+
+  Operand* opArray;
+  CBInst* node = static_cast<CBInst*>(_allocInstNode(sizeof(CBInst), opCount, &opArray));
+
+  if (ASMJIT_UNLIKELY(!node))
+    return setLastError(DebugUtils::errored(kErrorNoHeapMemory));
+
+  if (opCount > 0) opArray[0].copyFrom(o0);
+  if (opCount > 1) opArray[1].copyFrom(o1);
+  if (opCount > 2) opArray[2].copyFrom(o2);
+  if (opCount > 3) opArray[3].copyFrom(o3);
+  if (opCount > 4) opArray[4].copyFrom(o4);
+  if (opCount > 5) opArray[5].copyFrom(o5);
+
+  node = new(node) CBInst(this, instId, options, opArray, opCount);
+  node->_instDetail.extraReg = _extraReg;
+  _extraReg.reset();
+
+  if (inlineComment) {
+    inlineComment = static_cast<char*>(_cbDataZone.dup(inlineComment, ::strlen(inlineComment), true));
+    node->setInlineComment(inlineComment);
+  }
+
+  addNode(node);
+  return kErrorOk;
+}
+
+} // asmjit namespace
+
+// [Api-End]
+#include "../asmjit_apiend.h"
+
+// [Guard]
+#endif // ASMJIT_BUILD_ARM && !ASMJIT_DISABLE_BUILDER
@@ -0,0 +1,94 @@
+// [AsmJit]
+// Complete x86/x64 JIT and Remote Assembler for C++.
+//
+// [License]
+// Zlib - See LICENSE.md file in the package.
+
+// [Guard]
+#ifndef _ASMJIT_ARM_ARMBUILDER_H
+#define _ASMJIT_ARM_ARMBUILDER_H
+
+#include "../asmjit_build.h"
+#if !defined(ASMJIT_DISABLE_BUILDER)
+
+// [Dependencies]
+#include "../base/codebuilder.h"
+#include "../arm/armemitter.h"
+#include "../arm/armmisc.h"
+
+// [Api-Begin]
+#include "../asmjit_apibegin.h"
+
+namespace asmjit {
+
+//! \addtogroup asmjit_arm
+//! \{
+
+// ============================================================================
+// [asmjit::ArmBuilder]
+// ============================================================================
+
+//! Architecture-dependent \ref CodeBuilder targeting AArch64 (A64).
+class ASMJIT_VIRTAPI ArmBuilder
+  : public CodeBuilder,
+    public ArmEmitterExplicitT<ArmBuilder> {
+
+public:
+  ASMJIT_NONCOPYABLE(ArmBuilder)
+  typedef CodeBuilder Base;
+
+  // --------------------------------------------------------------------------
+  // [Construction / Destruction]
+  // --------------------------------------------------------------------------
+
+  //! Create a `ArmBuilder` instance.
+  ASMJIT_API ArmBuilder(CodeHolder* code = nullptr) noexcept;
+  //! Destroy the `ArmBuilder` instance.
+  ASMJIT_API ~ArmBuilder() noexcept;
+
+  // --------------------------------------------------------------------------
+  // [Compatibility]
+  // --------------------------------------------------------------------------
+
+  //! Explicit cast to `ArmEmitter`.
+  ASMJIT_INLINE ArmEmitter* asEmitter() noexcept { return reinterpret_cast<ArmEmitter*>(this); }
+  //! Explicit cast to `ArmEmitter` (const).
+  ASMJIT_INLINE const ArmEmitter* asEmitter() const noexcept { return reinterpret_cast<const ArmEmitter*>(this); }
+
+  //! Implicit cast to `ArmEmitter`.
+  ASMJIT_INLINE operator ArmEmitter&() noexcept { return *asEmitter(); }
+  //! Implicit cast to `ArmEmitter` (const).
+  ASMJIT_INLINE operator const ArmEmitter&() const noexcept { return *asEmitter(); }
+
+  // --------------------------------------------------------------------------
+  // [Events]
+  // --------------------------------------------------------------------------
+
+  ASMJIT_API virtual Error onAttach(CodeHolder* code) noexcept override;
+
+  // --------------------------------------------------------------------------
+  // [Code-Generation]
+  // --------------------------------------------------------------------------
+
+  ASMJIT_API virtual Error _emit(uint32_t instId, const Operand_& o0, const Operand_& o1, const Operand_& o2, const Operand_& o3) override;
+  ASMJIT_API virtual Error _emit(uint32_t instId, const Operand_& o0, const Operand_& o1, const Operand_& o2, const Operand_& o3, const Operand_& o4, const Operand_& o5) override;
+
+  // -------------------------------------------------------------------------
+  // [Finalize]
+  // -------------------------------------------------------------------------
+
+  //! Run all passes and serialize the nodes to the attached `ArmAssembler`,
+  //! or to a temporary one if there is no assembler attached.
+  ASMJIT_API virtual Error finalize() override;
+};
+
+//! \}
+
+} // asmjit namespace
+
+// [Api-End]
+#include "../asmjit_apiend.h"
+
+// [Guard]
+#endif // !ASMJIT_DISABLE_BUILDER
+#endif // _ASMJIT_ARM_ARMBUILDER_H
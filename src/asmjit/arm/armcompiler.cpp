@@ -0,0 +1,434 @@
+// [AsmJit]
+// Complete x86/x64 JIT and Remote Assembler for C++.
+//
+// [License]
+// Zlib - See LICENSE.md file in the package.
+
+// [Export]
+#define ASMJIT_EXPORTS
+
+// [Guard]
+#include "../asmjit_build.h"
+#if defined(ASMJIT_BUILD_ARM) && !defined(ASMJIT_DISABLE_COMPILER)
+
+// [Dependencies]
+#include "../base/osutils.h"
+#include "../base/utils.h"
+#include "../arm/armassembler.h"
+#include "../arm/armcompiler.h"
+#include "../arm/arminstimpl_p.h"
+#include "../arm/armregalloc_p.h"
+
+// [Api-Begin]
+#include "../asmjit_apibegin.h"
+
+namespace asmjit {
+
+// ============================================================================
+// [asmjit::ArmCompiler - Construction / Destruction]
+// ============================================================================
+
+ArmCompiler::ArmCompiler(CodeHolder* code) noexcept : CodeCompiler() {
+  if (code)
+    code->attach(this);
+}
+ArmCompiler::~ArmCompiler() noexcept {}
+
+// ============================================================================
+// [asmjit::ArmCompiler - Events]
+// ============================================================================
+
+Error ArmCompiler::onAttach(CodeHolder* code) noexcept {
+  // Only AArch64 is supported.
+  uint32_t archType = code->getArchType();
+  if (archType != ArchInfo::kTypeA64)
+    return DebugUtils::errored(kErrorInvalidArch);
+
+  ASMJIT_PROPAGATE(_cbPasses.willGrow(&_cbHeap, 1));
+  ASMJIT_PROPAGATE(Base::onAttach(code));
+
+  _nativeGpArray = armOpData.gpx;
+  _nativeGpReg = _nativeGpArray[0];
+
+  return addPassT<ArmRAPass>();
+}
+
+// ============================================================================
+// [asmjit::ArmCompiler - Finalize]
+// ============================================================================
+
+Error ArmCompiler::finalize() {
+  if (_lastError) return _lastError;
+
+  // Flush the global constant pool.
+  if (_globalConstPool) {
+    addNode(_globalConstPool);
+    _globalConstPool = nullptr;
+  }
+
+  Error err = runPasses();
+  if (ASMJIT_UNLIKELY(err)) return setLastError(err);
+
+  uint64_t startTime = hasStatsEnabled() ? OSUtils::getHighResTime() : uint64_t(0);
+
+  if (_code->_cgAsm) {
+    err = serialize(_code->_cgAsm);
+  }
+  else {
+    ArmAssembler a(_code);
+    err = serialize(&a);
+  }
+
+  if (hasStatsEnabled())
+    _serializeTime += OSUtils::getHighResTime() - startTime;
+  return err;
+}
+
+// ============================================================================
+// [asmjit::ArmCompiler - Inst]
+// ============================================================================
+
+//! \internal
+//!
+//! Get whether `instId` is a jump that ends a basic block. Calls (BL|BLR) and
+//! RET are not jumps from the register allocator's point of view.
+static ASMJIT_INLINE bool ArmCompiler_isJumpInst(uint32_t instId) noexcept {
+  return (instId >= ArmInst::kIdB && instId <= ArmInst::kIdB_vs) ||
+         instId == ArmInst::kIdBr   ||
+         instId == ArmInst::kIdCbnz ||
+         instId == ArmInst::kIdCbz  ||
+         instId == ArmInst::kIdTbnz ||
+         instId == ArmInst::kIdTbz  ;
+}
+
+Error ArmCompiler::_emit(uint32_t instId, const Operand_& o0, const Operand_& o1, const Operand_& o2, const Operand_& o3) {
+  return _emit(instId, o0, o1, o2, o3, _none, _none);
+}
+
+Error ArmCompiler::_emit(uint32_t instId, const Operand_& o0, const Operand_& o1, const Operand_& o2, const Operand_& o3, const Operand_& o4, const Operand_& o5) {
+  uint32_t options = getOptions() | getGlobalOptions();
+  const char* inlineComment = getInlineComment();
+
+  uint32_t opCount = static_cast<uint32_t>(!o0.isNone()) +
+                     static_cast<uint32_t>(!o1.isNone()) +
+                     static_cast<uint32_t>(!o2.isNone()) +
+                     static_cast<uint32_t>(!o3.isNone()) ;
+
+  // Count 5th and 6th operands.
+  if (!o4.isNone()) opCount = 5;
+  if (!o5.isNone()) opCount = 6;
+
+  // Handle failure and rare cases first.
+  const uint32_t kErrorsAndSpecialCases = kOptionMaybeFailureCase | // CodeEmitter is in error state.
+                                          kOptionStrictValidation ; // Strict validation.
+
+  if (ASMJIT_UNLIKELY(options & kErrorsAndSpecialCases)) {
+    // Don't do anything if we are in error state.
+    if (_lastError) return _lastError;
+
+#if !defined(ASMJIT_DISABLE_VALIDATION)
+    // Strict validation.
+    if (options & kOptionStrictValidation) {
+      Operand opArray[] = {
+        Operand(o0),
+        Operand(o1),
+        Operand(o2),
+        Operand(o3),
+        Operand(o4),
+        Operand(o5)
+      };
+
+      Inst::Detail instDetail(instId, options, _extraReg);
+      Error err = ArmInstImpl::validate(getArchType(), instDetail, opArray, opCount);
+
+#if !defined(ASMJIT_DISABLE_EXTENSIONS)
+      // Reject instructions the target CPU doesn't have.
+      if (!err && _codeInfo.hasFeatures())
+        err = Inst::validateFeatures(getArchType(), instDetail, opArray, opCount, _codeInfo.getFeatures());
+#endif // !ASMJIT_DISABLE_EXTENSIONS
+
+      if (err) {
+#if !defined(ASMJIT_DISABLE_LOGGING)
+        StringBuilderTmp<256> sb;
+        sb.appendString(DebugUtils::errorAsString(err));
+        sb.appendString(": ");
+        Logging::formatInstruction(sb, 0, this, getArchType(), instDetail, opArray, opCount);
+        return setLastError(err, sb.getData());
+#else
+        return setLastError(err);
+#endif
+      }
+
+      // Clear it as it must be enabled explicitly on assembler side.
+      options &= ~kOptionStrictValidation;
+    }
+#endif // ASMJIT_DISABLE_VALIDATION
+  }
+
+  resetOptions();
+  resetInlineComment();
+
+  Operand* opArray;
+  CBInst* node;
+
+  // decide between `CBInst` and `CBJump`.
+  bool isJump = ArmCompiler_isJumpInst(instId);
+  node = static_cast<CBInst*>(_allocInstNode(isJump ? sizeof(CBJump) : sizeof(CBInst), opCount, &opArray));
+
+  if (ASMJIT_UNLIKELY(!node))
+    return setLastError(DebugUtils::errored(kErrorNoHeapMemory));
+
+  if (opCount > 0) opArray[0].copyFrom(o0);
+  if (opCount > 1) opArray[1].copyFrom(o1);
+  if (opCount > 2) opArray[2].copyFrom(o2);
+  if (opCount > 3) opArray[3].copyFrom(o3);
+  if (opCount > 4) opArray[4].copyFrom(o4);
+  if (opCount > 5) opArray[5].copyFrom(o5);
+
+  if (isJump) {
+    CBJump* jNode = new(node) CBJump(this, instId, options, opArray, opCount);
+    CBLabel* jTarget = nullptr;
+
+    // The target label is always the last operand, BR has no label to follow.
+    if (!(options & kOptionUnfollow)) {
+      const Operand* label = opCount != 0 ? &opArray[opCount - 1] : nullptr;
+
+      // A label bound by `flush()` is outside of the node list.
+      if (label && label->isLabel() && !_code->isLabelBound(label->getId())) {
+        Error err = getCBLabel(&jTarget, static_cast<const Label&>(*label));
+        if (err) return setLastError(err);
+      }
+      else {
+        options |= kOptionUnfollow;
+      }
+    }
+    jNode->setOptions(options);
+
+    bool isUnconditional = instId == ArmInst::kIdB || instId == ArmInst::kIdBr;
+    jNode->orFlags(isUnconditional ? CBNode::kFlagIsJmp | CBNode::kFlagIsTaken : CBNode::kFlagIsJcc);
+    jNode->_target = jTarget;
+    jNode->_jumpNext = nullptr;
+
+    if (jTarget) {
+      jNode->_jumpNext = static_cast<CBJump*>(jTarget->_from);
+      jTarget->_from = jNode;
+      jTarget->addNumRefs();
+    }
+  }
+  else {
+    node = new(node) CBInst(this, instId, options, opArray, opCount);
+  }
+
+  node->_instDetail.extraReg = _extraReg;
+  _extraReg.reset();
+
+  if (inlineComment) {
+    inlineComment = static_cast<char*>(_cbDataZone.dup(inlineComment, ::strlen(inlineComment), true));
+    node->setInlineComment(inlineComment);
+  }
+
+  addNode(node);
+  return kErrorOk;
+}
+
+// ============================================================================
+// [asmjit::ArmCompiler - Test]
+// ============================================================================
+
+#if defined(ASMJIT_TEST)
+//! \internal
+//!
+//! Generate `int func(int a, int b)` that sums `b` copies of `a` in a loop
+//! and passes the result through a call of `callee(int, double)` that has
+//! to survive the call in a callee-saved register or in its home slot.
+static void ArmCompiler_generateTestFunc(ArmCompiler& cc, const Label& callee) {
+  cc.addFunc(FuncSignature2<int, int, int>(CallConv::kIdArm64));
+
+  ArmGp a = cc.newI32("a");
+  ArmGp b = cc.newI32("b");
+  ArmGp sum = cc.newI32("sum");
+  ArmVec d = cc.newVecD("d");
+  Label L_Loop = cc.newLabel();
+  Label L_Done = cc.newLabel();
+
+  cc.setArg(0, a);
+  cc.setArg(1, b);
+
+  cc.mov(sum, 0);
+  cc.cbz(b, L_Done);
+
+  cc.bind(L_Loop);
+  cc.add(sum, sum, a);
+  cc.subs(b, b, 1);
+  cc.b(arm::kCondNE, L_Loop);
+
+  cc.bind(L_Done);
+  cc.scvtf(d, sum);
+
+  CCFuncCall* call = cc.call(callee, FuncSignature2<int, int, double>(CallConv::kIdArm64));
+  call->setArg(0, sum);
+  call->setArg(1, d);
+  call->setRet(0, b);
+
+  cc.add(sum, sum, b);
+  cc.ret(sum);
+  cc.endFunc();
+}
+
+//! \internal
+//!
+//! Compile a function generated by `gen` and check that it encodes exactly to
+//! `expected`, which verifies the prolog, epilog and argument moves as well.
+static void ArmCompiler_checkFunc(void (*gen)(ArmCompiler&), const uint32_t* expected, size_t count, const char* name) {
+  CodeHolder code;
+  code.init(CodeInfo(ArchInfo::kTypeA64));
+
+  ArmCompiler cc(&code);
+  gen(cc);
+
+  Error err = cc.finalize();
+  EXPECT(err == kErrorOk,
+    "%s: finalize() failed: %s", name, DebugUtils::errorAsString(err));
+
+  const CodeBuffer& buf = code.getSectionEntry(0)->getBuffer();
+  EXPECT(buf.getLength() == count * 4,
+    "%s: emitted %u bytes, expected %u", name, unsigned(buf.getLength()), unsigned(count * 4));
+
+  for (size_t i = 0; i < count; i++) {
+    uint32_t actual = Utils::readU32uLE(buf.getData() + i * 4);
+    EXPECT(actual == expected[i],
+      "%s: instruction #%u encoded as 0x%08X, expected 0x%08X", name, unsigned(i), actual, expected[i]);
+  }
+}
+
+//! \internal
+//!
+//! `int func(int a, int b)` returning `b - a`, a leaf without a frame.
+static void ArmCompiler_generateLeaf(ArmCompiler& cc) {
+  cc.addFunc(FuncSignature2<int, int, int>(CallConv::kIdArm64));
+
+  ArmGp a = cc.newI32("a");
+  ArmGp b = cc.newI32("b");
+
+  cc.setArg(0, a);
+  cc.setArg(1, b);
+  cc.sub(b, b, a);
+  cc.ret(b);
+  cc.endFunc();
+}
+
+//! \internal
+//!
+//! `int func(int a0, ..., int a9)` returning `a8 + a9`, both are passed on
+//! the stack and must be loaded relative to SP.
+static void ArmCompiler_generateStackArgs(ArmCompiler& cc) {
+  cc.addFunc(FuncSignature10<int, int, int, int, int, int, int, int, int, int, int>(CallConv::kIdArm64));
+
+  ArmGp a8 = cc.newI32("a8");
+  ArmGp a9 = cc.newI32("a9");
+
+  cc.setArg(8, a8);
+  cc.setArg(9, a9);
+  cc.add(a8, a8, a9);
+  cc.ret(a8);
+  cc.endFunc();
+}
+
+//! \internal
+//!
+//! `int func(int a, int b)` returning `callee(b, a) + a`, the call swaps the
+//! argument registers and `a` has to survive it in a callee-saved register.
+static void ArmCompiler_generateCallSwap(ArmCompiler& cc) {
+  Label callee = cc.newLabel();
+  cc.addFunc(FuncSignature2<int, int, int>(CallConv::kIdArm64));
+
+  ArmGp a = cc.newI32("a");
+  ArmGp b = cc.newI32("b");
+  ArmGp r = cc.newI32("r");
+
+  cc.setArg(0, a);
+  cc.setArg(1, b);
+
+  CCFuncCall* call = cc.call(callee, FuncSignature2<int, int, int>(CallConv::kIdArm64));
+  call->setArg(0, b);
+  call->setArg(1, a);
+  call->setRet(0, r);
+
+  cc.add(r, r, a);
+  cc.ret(r);
+  cc.endFunc();
+
+  // The callee is outside of any function, so emit a plain RET instruction.
+  cc.bind(callee);
+  cc.emit(ArmInst::kIdRet);
+}
+
+UNIT(arm_compiler) {
+  CodeHolder code;
+  code.init(CodeInfo(ArchInfo::kTypeA64));
+
+  ArmCompiler cc(&code);
+
+  INFO("Checking that A64 functions compile");
+  CCFunc* callee = cc.addFunc(FuncSignature2<int, int, double>(CallConv::kIdArm64));
+  cc.ret();
+  cc.endFunc();
+
+  ArmCompiler_generateTestFunc(cc, callee->getLabel());
+
+  EXPECT(cc.finalize() == kErrorOk);
+  EXPECT(code.getSectionEntry(0)->getBuffer().getLength() != 0);
+
+  INFO("Checking the output of a leaf function");
+  static const uint32_t leafWords[] = {
+    0x4B000021, // sub w1, w1, w0
+    0x2A0103E0, // mov w0, w1
+    0xD65F03C0  // ret
+  };
+  ArmCompiler_checkFunc(ArmCompiler_generateLeaf, leafWords, ASMJIT_ARRAY_SIZE(leafWords), "leaf");
+
+  INFO("Checking the output of a function with stack arguments");
+  static const uint32_t stackArgsWords[] = {
+    0xB94003E0, // ldr w0, [sp]
+    0xB9400BE1, // ldr w1, [sp, #8]
+    0x0B010000, // add w0, w0, w1
+    0xD65F03C0  // ret
+  };
+  ArmCompiler_checkFunc(ArmCompiler_generateStackArgs, stackArgsWords, ASMJIT_ARRAY_SIZE(stackArgsWords), "stack args");
+
+  INFO("Checking the prolog, epilog and argument shuffle of a call");
+  static const uint32_t callSwapWords[] = {
+    0xA9BF7BFD, // stp x29, x30, [sp, #-16]!
+    0xF81F0FF3, // str x19, [sp, #-16]!
+    0xD10043FF, // sub sp, sp, #16
+    0xB90007E0, // str w0, [sp, #4]
+    0xB90003E1, // str w1, [sp]
+    0xB94003E0, // ldr w0, [sp]
+    0xB94007E1, // ldr w1, [sp, #4]
+    0x94000007, // bl callee
+    0xB94007F3, // ldr w19, [sp, #4]
+    0x0B130000, // add w0, w0, w19
+    0x910043FF, // add sp, sp, #16
+    0xF84107F3, // ldr x19, [sp], #16
+    0xA8C17BFD, // ldp x29, x30, [sp], #16
+    0xD65F03C0, // ret
+    0xD65F03C0  // callee: ret
+  };
+  ArmCompiler_checkFunc(ArmCompiler_generateCallSwap, callSwapWords, ASMJIT_ARRAY_SIZE(callSwapWords), "call swap");
+
+  INFO("Checking that A32 is rejected");
+  CodeHolder a32;
+  a32.init(CodeInfo(ArchInfo::kTypeA32));
+
+  ArmCompiler cc32;
+  EXPECT(a32.attach(&cc32) == kErrorInvalidArch);
+}
+#endif // ASMJIT_TEST
+
+} // asmjit namespace
+
+// [Api-End]
+#include "../asmjit_apiend.h"
+
+// [Guard]
+#endif // ASMJIT_BUILD_ARM && !ASMJIT_DISABLE_COMPILER
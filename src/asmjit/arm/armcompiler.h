@@ -0,0 +1,283 @@
+// [AsmJit]
+// Complete x86/x64 JIT and Remote Assembler for C++.
+//
+// [License]
+// Zlib - See LICENSE.md file in the package.
+
+// [Guard]
+#ifndef _ASMJIT_ARM_ARMCOMPILER_H
+#define _ASMJIT_ARM_ARMCOMPILER_H
+
+#include "../asmjit_build.h"
+#if !defined(ASMJIT_DISABLE_COMPILER)
+
+// [Dependencies]
+#include "../base/codecompiler.h"
+#include "../base/simdtypes.h"
+#include "../arm/armemitter.h"
+#include "../arm/armmisc.h"
+
+// [Api-Begin]
+#include "../asmjit_apibegin.h"
+
+namespace asmjit {
+
+//! \addtogroup asmjit_arm
+//! \{
+
+// ============================================================================
+// [asmjit::ArmCompiler]
+// ============================================================================
+
+//! Architecture-dependent \ref CodeCompiler targeting AArch64 (A64).
+//!
+//! Registers are allocated by a local register allocator, virtual registers
+//! live in registers within a basic block and in their home slots on the
+//! stack at block boundaries. Functions use AAPCS64 (`CallConv::kIdArm64`).
+class ASMJIT_VIRTAPI ArmCompiler
+  : public CodeCompiler,
+    public ArmEmitterExplicitT<ArmCompiler> {
+
+public:
+  ASMJIT_NONCOPYABLE(ArmCompiler)
+  typedef CodeCompiler Base;
+
+  // --------------------------------------------------------------------------
+  // [Construction / Destruction]
+  // --------------------------------------------------------------------------
+
+  //! Create a `ArmCompiler` instance.
+  ASMJIT_API ArmCompiler(CodeHolder* code = nullptr) noexcept;
+  //! Destroy the `ArmCompiler` instance.
+  ASMJIT_API ~ArmCompiler() noexcept;
+
+  // --------------------------------------------------------------------------
+  // [Compatibility]
+  // --------------------------------------------------------------------------
+
+  //! Explicit cast to `ArmEmitter`.
+  ASMJIT_INLINE ArmEmitter* asEmitter() noexcept { return reinterpret_cast<ArmEmitter*>(this); }
+  //! Explicit cast to `ArmEmitter` (const).
+  ASMJIT_INLINE const ArmEmitter* asEmitter() const noexcept { return reinterpret_cast<const ArmEmitter*>(this); }
+
+  //! Implicit cast to `ArmEmitter`.
+  ASMJIT_INLINE operator ArmEmitter&() noexcept { return *asEmitter(); }
+  //! Implicit cast to `ArmEmitter` (const).
+  ASMJIT_INLINE operator const ArmEmitter&() const noexcept { return *asEmitter(); }
+
+  // --------------------------------------------------------------------------
+  // [Events]
+  // --------------------------------------------------------------------------
+
+  ASMJIT_API virtual Error onAttach(CodeHolder* code) noexcept override;
+
+  // --------------------------------------------------------------------------
+  // [Code-Generation]
+  // --------------------------------------------------------------------------
+
+  ASMJIT_API virtual Error _emit(uint32_t instId, const Operand_& o0, const Operand_& o1, const Operand_& o2, const Operand_& o3) override;
+  ASMJIT_API virtual Error _emit(uint32_t instId, const Operand_& o0, const Operand_& o1, const Operand_& o2, const Operand_& o3, const Operand_& o4, const Operand_& o5) override;
+
+  // -------------------------------------------------------------------------
+  // [Finalize]
+  // -------------------------------------------------------------------------
+
+  ASMJIT_API virtual Error finalize() override;
+
+  // --------------------------------------------------------------------------
+  // [VirtReg]
+  // --------------------------------------------------------------------------
+
+#if !defined(ASMJIT_DISABLE_LOGGING)
+#define ASMJIT_NEW_REG(OUT, PARAM, NAME_FMT)            \
+  va_list ap;                                           \
+  va_start(ap, NAME_FMT);                               \
+  _newReg(OUT, PARAM, NAME_FMT, ap);                    \
+  va_end(ap)
+#else
+#define ASMJIT_NEW_REG(OUT, PARAM, NAME_FMT)            \
+  ASMJIT_UNUSED(NAME_FMT);                              \
+  _newReg(OUT, PARAM, nullptr)
+#endif
+
+#define ASMJIT_NEW_REG_USER(FUNC, REG)                  \
+  ASMJIT_INLINE REG FUNC(uint32_t typeId) {             \
+    REG reg(NoInit);                                    \
+    _newReg(reg, typeId, nullptr);                      \
+    return reg;                                         \
+  }                                                     \
+                                                        \
+  REG FUNC(uint32_t typeId, const char* nameFmt, ...) { \
+    REG reg(NoInit);                                    \
+    ASMJIT_NEW_REG(reg, typeId, nameFmt);               \
+    return reg;                                         \
+  }
+
+#define ASMJIT_NEW_REG_AUTO(FUNC, REG, TYPE_ID)         \
+  ASMJIT_INLINE REG FUNC() {                            \
+    REG reg(NoInit);                                    \
+    _newReg(reg, TYPE_ID, nullptr);                     \
+    return reg;                                         \
+  }                                                     \
+                                                        \
+  REG FUNC(const char* nameFmt, ...) {                  \
+    REG reg(NoInit);                                    \
+    ASMJIT_NEW_REG(reg, TYPE_ID, nameFmt);              \
+    return reg;                                         \
+  }
+
+  template<typename RegT>
+  ASMJIT_INLINE RegT newSimilarReg(const RegT& ref) {
+    RegT reg(NoInit);
+    _newReg(reg, ref, nullptr);
+    return reg;
+  }
+
+  template<typename RegT>
+  RegT newSimilarReg(const RegT& ref, const char* nameFmt, ...) {
+    RegT reg(NoInit);
+    ASMJIT_NEW_REG(reg, ref, nameFmt);
+    return reg;
+  }
+
+  ASMJIT_NEW_REG_USER(newReg    , ArmReg )
+  ASMJIT_NEW_REG_USER(newGpReg  , ArmGp  )
+  ASMJIT_NEW_REG_USER(newVecReg , ArmVec )
+
+  ASMJIT_NEW_REG_AUTO(newI8     , ArmGp  , TypeId::kI8     )
+  ASMJIT_NEW_REG_AUTO(newU8     , ArmGp  , TypeId::kU8     )
+  ASMJIT_NEW_REG_AUTO(newI16    , ArmGp  , TypeId::kI16    )
+  ASMJIT_NEW_REG_AUTO(newU16    , ArmGp  , TypeId::kU16    )
+  ASMJIT_NEW_REG_AUTO(newI32    , ArmGp  , TypeId::kI32    )
+  ASMJIT_NEW_REG_AUTO(newU32    , ArmGp  , TypeId::kU32    )
+  ASMJIT_NEW_REG_AUTO(newI64    , ArmGp  , TypeId::kI64    )
+  ASMJIT_NEW_REG_AUTO(newU64    , ArmGp  , TypeId::kU64    )
+  ASMJIT_NEW_REG_AUTO(newInt8   , ArmGp  , TypeId::kI8     )
+  ASMJIT_NEW_REG_AUTO(newUInt8  , ArmGp  , TypeId::kU8     )
+  ASMJIT_NEW_REG_AUTO(newInt16  , ArmGp  , TypeId::kI16    )
+  ASMJIT_NEW_REG_AUTO(newUInt16 , ArmGp  , TypeId::kU16    )
+  ASMJIT_NEW_REG_AUTO(newInt32  , ArmGp  , TypeId::kI32    )
+  ASMJIT_NEW_REG_AUTO(newUInt32 , ArmGp  , TypeId::kU32    )
+  ASMJIT_NEW_REG_AUTO(newInt64  , ArmGp  , TypeId::kI64    )
+  ASMJIT_NEW_REG_AUTO(newUInt64 , ArmGp  , TypeId::kU64    )
+  ASMJIT_NEW_REG_AUTO(newIntPtr , ArmGp  , TypeId::kIntPtr )
+  ASMJIT_NEW_REG_AUTO(newUIntPtr, ArmGp  , TypeId::kUIntPtr)
+
+  ASMJIT_NEW_REG_AUTO(newGpw    , ArmGp  , TypeId::kU32    )
+  ASMJIT_NEW_REG_AUTO(newGpx    , ArmGp  , TypeId::kU64    )
+  ASMJIT_NEW_REG_AUTO(newGpz    , ArmGp  , TypeId::kUIntPtr)
+  ASMJIT_NEW_REG_AUTO(newVecS   , ArmVec , TypeId::kF32x1  )
+  ASMJIT_NEW_REG_AUTO(newVecD   , ArmVec , TypeId::kF64x1  )
+  ASMJIT_NEW_REG_AUTO(newVecV   , ArmVec , TypeId::kI32x4  )
+
+#undef ASMJIT_NEW_REG_AUTO
+#undef ASMJIT_NEW_REG_USER
+#undef ASMJIT_NEW_REG
+
+  // --------------------------------------------------------------------------
+  // [Stack]
+  // --------------------------------------------------------------------------
+
+  //! Create a new memory chunk allocated on the current function's stack.
+  //!
+  //! NOTE: The alignment can't be greater than 16 bytes, the stack is never
+  //! aligned dynamically.
+  ASMJIT_INLINE ArmMem newStack(uint32_t size, uint32_t alignment, const char* name = nullptr) {
+    ArmMem m(NoInit);
+    _newStack(m, size, alignment, name);
+    return m;
+  }
+
+  // --------------------------------------------------------------------------
+  // [Const]
+  // --------------------------------------------------------------------------
+
+  //! Put data to a constant-pool and get a memory reference to it.
+  //!
+  //! The reference is a literal (based on a label), it's only accepted by
+  //! `ldr` and its variants.
+  ASMJIT_INLINE ArmMem newConst(uint32_t scope, const void* data, size_t size) {
+    ArmMem m(NoInit);
+    _newConst(m, scope, data, size);
+    return m;
+  }
+
+  //! Put a BYTE `val` to a constant-pool.
+  ASMJIT_INLINE ArmMem newByteConst(uint32_t scope, uint8_t val) noexcept { return newConst(scope, &val, 1); }
+  //! Put a WORD `val` to a constant-pool.
+  ASMJIT_INLINE ArmMem newWordConst(uint32_t scope, uint16_t val) noexcept { return newConst(scope, &val, 2); }
+  //! Put a DWORD `val` to a constant-pool.
+  ASMJIT_INLINE ArmMem newDWordConst(uint32_t scope, uint32_t val) noexcept { return newConst(scope, &val, 4); }
+  //! Put a QWORD `val` to a constant-pool.
+  ASMJIT_INLINE ArmMem newQWordConst(uint32_t scope, uint64_t val) noexcept { return newConst(scope, &val, 8); }
+
+  //! Put a WORD `val` to a constant-pool.
+  ASMJIT_INLINE ArmMem newInt16Const(uint32_t scope, int16_t val) noexcept { return newConst(scope, &val, 2); }
+  //! Put a WORD `val` to a constant-pool.
+  ASMJIT_INLINE ArmMem newUInt16Const(uint32_t scope, uint16_t val) noexcept { return newConst(scope, &val, 2); }
+  //! Put a DWORD `val` to a constant-pool.
+  ASMJIT_INLINE ArmMem newInt32Const(uint32_t scope, int32_t val) noexcept { return newConst(scope, &val, 4); }
+  //! Put a DWORD `val` to a constant-pool.
+  ASMJIT_INLINE ArmMem newUInt32Const(uint32_t scope, uint32_t val) noexcept { return newConst(scope, &val, 4); }
+  //! Put a QWORD `val` to a constant-pool.
+  ASMJIT_INLINE ArmMem newInt64Const(uint32_t scope, int64_t val) noexcept { return newConst(scope, &val, 8); }
+  //! Put a QWORD `val` to a constant-pool.
+  ASMJIT_INLINE ArmMem newUInt64Const(uint32_t scope, uint64_t val) noexcept { return newConst(scope, &val, 8); }
+
+  //! Put a SP-FP `val` to a constant-pool.
+  ASMJIT_INLINE ArmMem newFloatConst(uint32_t scope, float val) noexcept { return newConst(scope, &val, 4); }
+  //! Put a DP-FP `val` to a constant-pool.
+  ASMJIT_INLINE ArmMem newDoubleConst(uint32_t scope, double val) noexcept { return newConst(scope, &val, 8); }
+
+  //! Put a 128-bit `val` to a constant-pool.
+  ASMJIT_INLINE ArmMem newVecConst(uint32_t scope, const Data128& val) noexcept { return newConst(scope, &val, 16); }
+
+  // -------------------------------------------------------------------------
+  // [Instruction Options]
+  // -------------------------------------------------------------------------
+
+  //! Force the compiler to not follow the conditional or unconditional jump.
+  ASMJIT_INLINE ArmCompiler& unfollow() noexcept { _options |= kOptionUnfollow; return *this; }
+  //! Tell the compiler that the destination variable will be overwritten.
+  ASMJIT_INLINE ArmCompiler& overwrite() noexcept { _options |= kOptionOverwrite; return *this; }
+
+  // --------------------------------------------------------------------------
+  // [Emit]
+  // --------------------------------------------------------------------------
+
+  //! Call a function.
+  ASMJIT_INLINE CCFuncCall* call(const ArmGp& dst, const FuncSignature& sign) { return addCall(ArmInst::kIdBlr, dst, sign); }
+  //! \overload
+  ASMJIT_INLINE CCFuncCall* call(const Label& label, const FuncSignature& sign) { return addCall(ArmInst::kIdBl, label, sign); }
+  //! \overload
+  ASMJIT_INLINE CCFuncCall* call(const Imm& dst, const FuncSignature& sign) { return addCall(ArmInst::kIdBlr, dst, sign); }
+  //! \overload
+  ASMJIT_INLINE CCFuncCall* call(uint64_t dst, const FuncSignature& sign) { return addCall(ArmInst::kIdBlr, Imm(static_cast<int64_t>(dst)), sign); }
+
+  //! Tail call a function (release the function frame and jump), see \ref addTailCall().
+  ASMJIT_INLINE CCFuncCall* tailCall(const ArmGp& dst, const FuncSignature& sign) { return addTailCall(ArmInst::kIdBr, dst, sign); }
+  //! \overload
+  ASMJIT_INLINE CCFuncCall* tailCall(const Label& label, const FuncSignature& sign) { return addTailCall(ArmInst::kIdB, label, sign); }
+  //! \overload
+  ASMJIT_INLINE CCFuncCall* tailCall(const Imm& dst, const FuncSignature& sign) { return addTailCall(ArmInst::kIdBr, dst, sign); }
+  //! \overload
+  ASMJIT_INLINE CCFuncCall* tailCall(uint64_t dst, const FuncSignature& sign) { return addTailCall(ArmInst::kIdBr, Imm(static_cast<int64_t>(dst)), sign); }
+
+  //! Return.
+  ASMJIT_INLINE CCFuncRet* ret() { return addRet(Operand(), Operand()); }
+  //! \overload
+  ASMJIT_INLINE CCFuncRet* ret(const ArmGp& o0) { return addRet(o0, Operand()); }
+  //! \overload
+  ASMJIT_INLINE CCFuncRet* ret(const ArmVec& o0) { return addRet(o0, Operand()); }
+};
+
+//! \}
+
+} // asmjit namespace
+
+// [Api-End]
+#include "../asmjit_apiend.h"
+
+// [Guard]
+#endif // !ASMJIT_DISABLE_COMPILER
+#endif // _ASMJIT_ARM_ARMCOMPILER_H
@@ -0,0 +1,357 @@
+// [AsmJit]
+// Complete x86/x64 JIT and Remote Assembler for C++.
+//
+// [License]
+// Zlib - See LICENSE.md file in the package.
+
+// [Guard]
+#ifndef _ASMJIT_ARM_ARMEMITTER_H
+#define _ASMJIT_ARM_ARMEMITTER_H
+
+// [Dependencies]
+#include "../base/codeemitter.h"
+#include "../arm/arminst.h"
+#include "../arm/armoperand.h"
+
+// [Api-Begin]
+#include "../asmjit_apibegin.h"
+
+namespace asmjit {
+
+//! \addtogroup asmjit_arm
+//! \{
+
+// ============================================================================
+// [asmjit::ArmEmitterExplicitT]
+// ============================================================================
+
+#define ASMJIT_EMIT static_cast<This*>(this)->emit
+
+#define ASMJIT_INST_0x(NAME, ID) \
+  ASMJIT_INLINE Error NAME() { return ASMJIT_EMIT(ArmInst::kId##ID); }
+
+#define ASMJIT_INST_1x(NAME, ID, T0) \
+  ASMJIT_INLINE Error NAME(const T0& o0) { return ASMJIT_EMIT(ArmInst::kId##ID, o0); }
+
+#define ASMJIT_INST_1i(NAME, ID, T0) \
+  ASMJIT_INLINE Error NAME(const T0& o0) { return ASMJIT_EMIT(ArmInst::kId##ID, o0); } \
+  ASMJIT_INLINE Error NAME(int o0) { return ASMJIT_EMIT(ArmInst::kId##ID, Utils::asInt(o0)); } \
+  ASMJIT_INLINE Error NAME(unsigned int o0) { return ASMJIT_EMIT(ArmInst::kId##ID, Utils::asInt(o0)); } \
+  ASMJIT_INLINE Error NAME(int64_t o0) { return ASMJIT_EMIT(ArmInst::kId##ID, Utils::asInt(o0)); } \
+  ASMJIT_INLINE Error NAME(uint64_t o0) { return ASMJIT_EMIT(ArmInst::kId##ID, Utils::asInt(o0)); }
+
+#define ASMJIT_INST_1c(NAME, ID, CONV, T0) \
+  ASMJIT_INLINE Error NAME(uint32_t cc, const T0& o0) { return ASMJIT_EMIT(CONV(cc), o0); } \
+  ASMJIT_INLINE Error NAME##_eq(const T0& o0) { return ASMJIT_EMIT(ArmInst::kId##ID##_eq, o0); } \
+  ASMJIT_INLINE Error NAME##_ge(const T0& o0) { return ASMJIT_EMIT(ArmInst::kId##ID##_ge, o0); } \
+  ASMJIT_INLINE Error NAME##_gt(const T0& o0) { return ASMJIT_EMIT(ArmInst::kId##ID##_gt, o0); } \
+  ASMJIT_INLINE Error NAME##_hi(const T0& o0) { return ASMJIT_EMIT(ArmInst::kId##ID##_hi, o0); } \
+  ASMJIT_INLINE Error NAME##_hs(const T0& o0) { return ASMJIT_EMIT(ArmInst::kId##ID##_hs, o0); } \
+  ASMJIT_INLINE Error NAME##_le(const T0& o0) { return ASMJIT_EMIT(ArmInst::kId##ID##_le, o0); } \
+  ASMJIT_INLINE Error NAME##_lo(const T0& o0) { return ASMJIT_EMIT(ArmInst::kId##ID##_lo, o0); } \
+  ASMJIT_INLINE Error NAME##_ls(const T0& o0) { return ASMJIT_EMIT(ArmInst::kId##ID##_ls, o0); } \
+  ASMJIT_INLINE Error NAME##_lt(const T0& o0) { return ASMJIT_EMIT(ArmInst::kId##ID##_lt, o0); } \
+  ASMJIT_INLINE Error NAME##_mi(const T0& o0) { return ASMJIT_EMIT(ArmInst::kId##ID##_mi, o0); } \
+  ASMJIT_INLINE Error NAME##_ne(const T0& o0) { return ASMJIT_EMIT(ArmInst::kId##ID##_ne, o0); } \
+  ASMJIT_INLINE Error NAME##_pl(const T0& o0) { return ASMJIT_EMIT(ArmInst::kId##ID##_pl, o0); } \
+  ASMJIT_INLINE Error NAME##_vc(const T0& o0) { return ASMJIT_EMIT(ArmInst::kId##ID##_vc, o0); } \
+  ASMJIT_INLINE Error NAME##_vs(const T0& o0) { return ASMJIT_EMIT(ArmInst::kId##ID##_vs, o0); }
+
+#define ASMJIT_INST_2x(NAME, ID, T0, T1) \
+  ASMJIT_INLINE Error NAME(const T0& o0, const T1& o1) { return ASMJIT_EMIT(ArmInst::kId##ID, o0, o1); }
+
+#define ASMJIT_INST_2i(NAME, ID, T0, T1) \
+  ASMJIT_INLINE Error NAME(const T0& o0, const T1& o1) { return ASMJIT_EMIT(ArmInst::kId##ID, o0, o1); } \
+  ASMJIT_INLINE Error NAME(const T0& o0, int o1) { return ASMJIT_EMIT(ArmInst::kId##ID, o0, Utils::asInt(o1)); } \
+  ASMJIT_INLINE Error NAME(const T0& o0, unsigned int o1) { return ASMJIT_EMIT(ArmInst::kId##ID, o0, Utils::asInt(o1)); } \
+  ASMJIT_INLINE Error NAME(const T0& o0, int64_t o1) { return ASMJIT_EMIT(ArmInst::kId##ID, o0, Utils::asInt(o1)); } \
+  ASMJIT_INLINE Error NAME(const T0& o0, uint64_t o1) { return ASMJIT_EMIT(ArmInst::kId##ID, o0, Utils::asInt(o1)); }
+
+#define ASMJIT_INST_3x(NAME, ID, T0, T1, T2) \
+  ASMJIT_INLINE Error NAME(const T0& o0, const T1& o1, const T2& o2) { return ASMJIT_EMIT(ArmInst::kId##ID, o0, o1, o2); }
+
+#define ASMJIT_INST_3i(NAME, ID, T0, T1, T2) \
+  ASMJIT_INLINE Error NAME(const T0& o0, const T1& o1, const T2& o2) { return ASMJIT_EMIT(ArmInst::kId##ID, o0, o1, o2); } \
+  ASMJIT_INLINE Error NAME(const T0& o0, const T1& o1, int o2) { return ASMJIT_EMIT(ArmInst::kId##ID, o0, o1, Utils::asInt(o2)); } \
+  ASMJIT_INLINE Error NAME(const T0& o0, const T1& o1, unsigned int o2) { return ASMJIT_EMIT(ArmInst::kId##ID, o0, o1, Utils::asInt(o2)); } \
+  ASMJIT_INLINE Error NAME(const T0& o0, const T1& o1, int64_t o2) { return ASMJIT_EMIT(ArmInst::kId##ID, o0, o1, Utils::asInt(o2)); } \
+  ASMJIT_INLINE Error NAME(const T0& o0, const T1& o1, uint64_t o2) { return ASMJIT_EMIT(ArmInst::kId##ID, o0, o1, Utils::asInt(o2)); }
+
+#define ASMJIT_INST_3ii(NAME, ID, T0, T1, T2) \
+  ASMJIT_INLINE Error NAME(const T0& o0, const T1& o1, const T2& o2) { return ASMJIT_EMIT(ArmInst::kId##ID, o0, o1, o2); } \
+  ASMJIT_INLINE Error NAME(const T0& o0, int o1, int o2) { return ASMJIT_EMIT(ArmInst::kId##ID, o0, Imm(o1), Utils::asInt(o2)); }
+
+#define ASMJIT_INST_4x(NAME, ID, T0, T1, T2, T3) \
+  ASMJIT_INLINE Error NAME(const T0& o0, const T1& o1, const T2& o2, const T3& o3) { return ASMJIT_EMIT(ArmInst::kId##ID, o0, o1, o2, o3); }
+
+#define ASMJIT_INST_4i(NAME, ID, T0, T1, T2, T3) \
+  ASMJIT_INLINE Error NAME(const T0& o0, const T1& o1, const T2& o2, const T3& o3) { return ASMJIT_EMIT(ArmInst::kId##ID, o0, o1, o2, o3); } \
+  ASMJIT_INLINE Error NAME(const T0& o0, const T1& o1, const T2& o2, int o3) { return ASMJIT_EMIT(ArmInst::kId##ID, o0, o1, o2, Utils::asInt(o3)); } \
+  ASMJIT_INLINE Error NAME(const T0& o0, const T1& o1, const T2& o2, unsigned int o3) { return ASMJIT_EMIT(ArmInst::kId##ID, o0, o1, o2, Utils::asInt(o3)); } \
+  ASMJIT_INLINE Error NAME(const T0& o0, const T1& o1, const T2& o2, int64_t o3) { return ASMJIT_EMIT(ArmInst::kId##ID, o0, o1, o2, Utils::asInt(o3)); } \
+  ASMJIT_INLINE Error NAME(const T0& o0, const T1& o1, const T2& o2, uint64_t o3) { return ASMJIT_EMIT(ArmInst::kId##ID, o0, o1, o2, Utils::asInt(o3)); }
+
+//! ARM instructions, all operands are explicit as there are no implicit
+//! operands in AArch64 (excluding flags).
+//!
+//! Conditions (`csel`, `cset`, ...) are passed as immediates, see \ref
+//! arm::Cond. Shift amount of a register operand (`add`, `and_`, ...) is
+//! passed as the last immediate and is always LSL.
+template<typename This>
+struct ArmEmitterExplicitT {
+  // --------------------------------------------------------------------------
+  // [Accessors]
+  // --------------------------------------------------------------------------
+
+  //! Get a native (64-bit) GP register at index `id`.
+  ASMJIT_INLINE const ArmGp& gpzRef(uint32_t id) const noexcept {
+    ASMJIT_ASSERT(id < 32);
+    return static_cast<const ArmGp&>(static_cast<const This*>(this)->_nativeGpArray[id]);
+  }
+
+  //! Create a memory operand of which base register's id is `baseId`.
+  ASMJIT_INLINE ArmMem ptr_base(uint32_t baseId, int32_t off = 0, uint32_t size = 0) const noexcept {
+    return ArmMem(Init, ArmReg::kRegGpx, baseId, 0, 0, off, size, 0);
+  }
+
+  //! Create an `intptr_t` memory operand.
+  ASMJIT_INLINE ArmMem intptr_ptr(const ArmGp& base, int32_t offset = 0) const noexcept {
+    return ArmMem(base, offset, 8);
+  }
+  //! \overload
+  ASMJIT_INLINE ArmMem intptr_ptr(const ArmGp& base, const ArmGp& index, uint32_t shift = 0) const noexcept {
+    return ArmMem(base, index, shift, 8);
+  }
+  //! \overload
+  ASMJIT_INLINE ArmMem intptr_ptr(const Label& base, int32_t offset = 0) const noexcept {
+    return ArmMem(base, offset, 8);
+  }
+
+  // --------------------------------------------------------------------------
+  // [Embed]
+  // --------------------------------------------------------------------------
+
+  //! Add 8-bit integer data to the instruction stream.
+  ASMJIT_INLINE Error db(uint8_t x) { return static_cast<This*>(this)->embed(&x, 1); }
+  //! Add 16-bit integer data to the instruction stream.
+  ASMJIT_INLINE Error dw(uint16_t x) { return static_cast<This*>(this)->embed(&x, 2); }
+  //! Add 32-bit integer data to the instruction stream.
+  ASMJIT_INLINE Error dd(uint32_t x) { return static_cast<This*>(this)->embed(&x, 4); }
+  //! Add 64-bit integer data to the instruction stream.
+  ASMJIT_INLINE Error dq(uint64_t x) { return static_cast<This*>(this)->embed(&x, 8); }
+
+  //! Add 8-bit integer data to the instruction stream.
+  ASMJIT_INLINE Error dint8(int8_t x) { return static_cast<This*>(this)->embed(&x, sizeof(int8_t)); }
+  //! Add 8-bit integer data to the instruction stream.
+  ASMJIT_INLINE Error duint8(uint8_t x) { return static_cast<This*>(this)->embed(&x, sizeof(uint8_t)); }
+
+  //! Add 16-bit integer data to the instruction stream.
+  ASMJIT_INLINE Error dint16(int16_t x) { return static_cast<This*>(this)->embed(&x, sizeof(int16_t)); }
+  //! Add 16-bit integer data to the instruction stream.
+  ASMJIT_INLINE Error duint16(uint16_t x) { return static_cast<This*>(this)->embed(&x, sizeof(uint16_t)); }
+
+  //! Add 32-bit integer data to the instruction stream.
+  ASMJIT_INLINE Error dint32(int32_t x) { return static_cast<This*>(this)->embed(&x, sizeof(int32_t)); }
+  //! Add 32-bit integer data to the instruction stream.
+  ASMJIT_INLINE Error duint32(uint32_t x) { return static_cast<This*>(this)->embed(&x, sizeof(uint32_t)); }
+
+  //! Add 64-bit integer data to the instruction stream.
+  ASMJIT_INLINE Error dint64(int64_t x) { return static_cast<This*>(this)->embed(&x, sizeof(int64_t)); }
+  //! Add 64-bit integer data to the instruction stream.
+  ASMJIT_INLINE Error duint64(uint64_t x) { return static_cast<This*>(this)->embed(&x, sizeof(uint64_t)); }
+
+  //! Add float data to the instruction stream.
+  ASMJIT_INLINE Error dfloat(float x) { return static_cast<This*>(this)->embed(&x, sizeof(float)); }
+  //! Add double data to the instruction stream.
+  ASMJIT_INLINE Error ddouble(double x) { return static_cast<This*>(this)->embed(&x, sizeof(double)); }
+
+  //! Add data in a given structure instance to the instruction stream.
+  template<typename T>
+  ASMJIT_INLINE Error dstruct(const T& x) { return static_cast<This*>(this)->embed(&x, static_cast<uint32_t>(sizeof(T))); }
+
+  // --------------------------------------------------------------------------
+  // [Base Instructions]
+  // --------------------------------------------------------------------------
+
+  ASMJIT_INST_3x(adc, Adc, ArmGp, ArmGp, ArmGp)                               // A64
+  ASMJIT_INST_3x(adcs, Adcs, ArmGp, ArmGp, ArmGp)                             // A64
+  ASMJIT_INST_3x(add, Add, ArmGp, ArmGp, ArmGp)                               // A64
+  ASMJIT_INST_3i(add, Add, ArmGp, ArmGp, Imm)                                 // A64
+  ASMJIT_INST_4i(add, Add, ArmGp, ArmGp, ArmGp, Imm)                          // A64
+  ASMJIT_INST_3x(adds, Adds, ArmGp, ArmGp, ArmGp)                             // A64
+  ASMJIT_INST_3i(adds, Adds, ArmGp, ArmGp, Imm)                               // A64
+  ASMJIT_INST_4i(adds, Adds, ArmGp, ArmGp, ArmGp, Imm)                        // A64
+  ASMJIT_INST_2x(adr, Adr, ArmGp, Label)                                      // A64
+  ASMJIT_INST_3x(and_, And, ArmGp, ArmGp, ArmGp)                              // A64
+  ASMJIT_INST_3i(and_, And, ArmGp, ArmGp, Imm)                                // A64
+  ASMJIT_INST_4i(and_, And, ArmGp, ArmGp, ArmGp, Imm)                         // A64
+  ASMJIT_INST_3x(ands, Ands, ArmGp, ArmGp, ArmGp)                             // A64
+  ASMJIT_INST_3i(ands, Ands, ArmGp, ArmGp, Imm)                               // A64
+  ASMJIT_INST_4i(ands, Ands, ArmGp, ArmGp, ArmGp, Imm)                        // A64
+  ASMJIT_INST_3x(asr, Asr, ArmGp, ArmGp, ArmGp)                               // A64
+  ASMJIT_INST_3i(asr, Asr, ArmGp, ArmGp, Imm)                                 // A64
+  ASMJIT_INST_1x(b, B, Label)                                                 // A64
+  ASMJIT_INST_1c(b, B, ArmInst::condToBranch, Label)                          // A64
+  ASMJIT_INST_3x(bic, Bic, ArmGp, ArmGp, ArmGp)                               // A64
+  ASMJIT_INST_4i(bic, Bic, ArmGp, ArmGp, ArmGp, Imm)                          // A64
+  ASMJIT_INST_3x(bics, Bics, ArmGp, ArmGp, ArmGp)                             // A64
+  ASMJIT_INST_4i(bics, Bics, ArmGp, ArmGp, ArmGp, Imm)                        // A64
+  ASMJIT_INST_1x(bl, Bl, Label)                                               // A64
+  ASMJIT_INST_1x(blr, Blr, ArmGp)                                             // A64
+  ASMJIT_INST_1x(br, Br, ArmGp)                                               // A64
+  ASMJIT_INST_1i(brk, Brk, Imm)                                               // A64
+  ASMJIT_INST_2x(cbnz, Cbnz, ArmGp, Label)                                    // A64
+  ASMJIT_INST_2x(cbz, Cbz, ArmGp, Label)                                      // A64
+  ASMJIT_INST_2x(cls, Cls, ArmGp, ArmGp)                                      // A64
+  ASMJIT_INST_2x(clz, Clz, ArmGp, ArmGp)                                      // A64
+  ASMJIT_INST_2x(cmn, Cmn, ArmGp, ArmGp)                                      // A64
+  ASMJIT_INST_2i(cmn, Cmn, ArmGp, Imm)                                        // A64
+  ASMJIT_INST_3i(cmn, Cmn, ArmGp, ArmGp, Imm)                                 // A64
+  ASMJIT_INST_2x(cmp, Cmp, ArmGp, ArmGp)                                      // A64
+  ASMJIT_INST_2i(cmp, Cmp, ArmGp, Imm)                                        // A64
+  ASMJIT_INST_3i(cmp, Cmp, ArmGp, ArmGp, Imm)                                 // A64
+  ASMJIT_INST_4i(csel, Csel, ArmGp, ArmGp, ArmGp, Imm)                        // A64
+  ASMJIT_INST_2i(cset, Cset, ArmGp, Imm)                                      // A64
+  ASMJIT_INST_2i(csetm, Csetm, ArmGp, Imm)                                    // A64
+  ASMJIT_INST_4i(csinc, Csinc, ArmGp, ArmGp, ArmGp, Imm)                      // A64
+  ASMJIT_INST_4i(csinv, Csinv, ArmGp, ArmGp, ArmGp, Imm)                      // A64
+  ASMJIT_INST_4i(csneg, Csneg, ArmGp, ArmGp, ArmGp, Imm)                      // A64
+  ASMJIT_INST_3x(eon, Eon, ArmGp, ArmGp, ArmGp)                               // A64
+  ASMJIT_INST_4i(eon, Eon, ArmGp, ArmGp, ArmGp, Imm)                          // A64
+  ASMJIT_INST_3x(eor, Eor, ArmGp, ArmGp, ArmGp)                               // A64
+  ASMJIT_INST_3i(eor, Eor, ArmGp, ArmGp, Imm)                                 // A64
+  ASMJIT_INST_4i(eor, Eor, ArmGp, ArmGp, ArmGp, Imm)                          // A64
+  ASMJIT_INST_1i(hlt, Hlt, Imm)                                               // A64
+  ASMJIT_INST_3x(ldp, Ldp, ArmGp, ArmGp, ArmMem)                              // A64
+  ASMJIT_INST_2x(ldr, Ldr, ArmGp, ArmMem)                                     // A64
+  ASMJIT_INST_2x(ldrb, Ldrb, ArmGp, ArmMem)                                   // A64
+  ASMJIT_INST_2x(ldrh, Ldrh, ArmGp, ArmMem)                                   // A64
+  ASMJIT_INST_2x(ldrsb, Ldrsb, ArmGp, ArmMem)                                 // A64
+  ASMJIT_INST_2x(ldrsh, Ldrsh, ArmGp, ArmMem)                                 // A64
+  ASMJIT_INST_2x(ldrsw, Ldrsw, ArmGp, ArmMem)                                 // A64
+  ASMJIT_INST_3x(lsl, Lsl, ArmGp, ArmGp, ArmGp)                               // A64
+  ASMJIT_INST_3i(lsl, Lsl, ArmGp, ArmGp, Imm)                                 // A64
+  ASMJIT_INST_3x(lsr, Lsr, ArmGp, ArmGp, ArmGp)                               // A64
+  ASMJIT_INST_3i(lsr, Lsr, ArmGp, ArmGp, Imm)                                 // A64
+  ASMJIT_INST_4x(madd, Madd, ArmGp, ArmGp, ArmGp, ArmGp)                      // A64
+  ASMJIT_INST_3x(mneg, Mneg, ArmGp, ArmGp, ArmGp)                             // A64
+  ASMJIT_INST_2x(mov, Mov, ArmGp, ArmGp)                                      // A64
+  ASMJIT_INST_2i(mov, Mov, ArmGp, Imm)                                        // A64
+  ASMJIT_INST_2i(movk, Movk, ArmGp, Imm)                                      // A64
+  ASMJIT_INST_3ii(movk, Movk, ArmGp, Imm, Imm)                                // A64
+  ASMJIT_INST_2i(movn, Movn, ArmGp, Imm)                                      // A64
+  ASMJIT_INST_3ii(movn, Movn, ArmGp, Imm, Imm)                                // A64
+  ASMJIT_INST_2i(movz, Movz, ArmGp, Imm)                                      // A64
+  ASMJIT_INST_3ii(movz, Movz, ArmGp, Imm, Imm)                                // A64
+  ASMJIT_INST_4x(msub, Msub, ArmGp, ArmGp, ArmGp, ArmGp)                      // A64
+  ASMJIT_INST_3x(mul, Mul, ArmGp, ArmGp, ArmGp)                               // A64
+  ASMJIT_INST_2x(mvn, Mvn, ArmGp, ArmGp)                                      // A64
+  ASMJIT_INST_2x(neg, Neg, ArmGp, ArmGp)                                      // A64
+  ASMJIT_INST_2x(negs, Negs, ArmGp, ArmGp)                                    // A64
+  ASMJIT_INST_0x(nop, Nop)                                                    // A64
+  ASMJIT_INST_3x(orn, Orn, ArmGp, ArmGp, ArmGp)                               // A64
+  ASMJIT_INST_4i(orn, Orn, ArmGp, ArmGp, ArmGp, Imm)                          // A64
+  ASMJIT_INST_3x(orr, Orr, ArmGp, ArmGp, ArmGp)                               // A64
+  ASMJIT_INST_3i(orr, Orr, ArmGp, ArmGp, Imm)                                 // A64
+  ASMJIT_INST_4i(orr, Orr, ArmGp, ArmGp, ArmGp, Imm)                          // A64
+  ASMJIT_INST_2x(rbit, Rbit, ArmGp, ArmGp)                                    // A64
+  ASMJIT_INST_0x(ret, Ret)                                                    // A64
+  ASMJIT_INST_1x(ret, Ret, ArmGp)                                             // A64
+  ASMJIT_INST_2x(rev, Rev, ArmGp, ArmGp)                                      // A64
+  ASMJIT_INST_2x(rev16, Rev16, ArmGp, ArmGp)                                  // A64
+  ASMJIT_INST_3x(ror, Ror, ArmGp, ArmGp, ArmGp)                               // A64
+  ASMJIT_INST_3i(ror, Ror, ArmGp, ArmGp, Imm)                                 // A64
+  ASMJIT_INST_3x(sbc, Sbc, ArmGp, ArmGp, ArmGp)                               // A64
+  ASMJIT_INST_3x(sbcs, Sbcs, ArmGp, ArmGp, ArmGp)                             // A64
+  ASMJIT_INST_3x(sdiv, Sdiv, ArmGp, ArmGp, ArmGp)                             // A64
+  ASMJIT_INST_3x(smulh, Smulh, ArmGp, ArmGp, ArmGp)                           // A64
+  ASMJIT_INST_3x(stp, Stp, ArmGp, ArmGp, ArmMem)                              // A64
+  ASMJIT_INST_2x(str, Str, ArmGp, ArmMem)                                     // A64
+  ASMJIT_INST_2x(strb, Strb, ArmGp, ArmMem)                                   // A64
+  ASMJIT_INST_2x(strh, Strh, ArmGp, ArmMem)                                   // A64
+  ASMJIT_INST_3x(sub, Sub, ArmGp, ArmGp, ArmGp)                               // A64
+  ASMJIT_INST_3i(sub, Sub, ArmGp, ArmGp, Imm)                                 // A64
+  ASMJIT_INST_4i(sub, Sub, ArmGp, ArmGp, ArmGp, Imm)                          // A64
+  ASMJIT_INST_3x(subs, Subs, ArmGp, ArmGp, ArmGp)                             // A64
+  ASMJIT_INST_3i(subs, Subs, ArmGp, ArmGp, Imm)                               // A64
+  ASMJIT_INST_4i(subs, Subs, ArmGp, ArmGp, ArmGp, Imm)                        // A64
+  ASMJIT_INST_1i(svc, Svc, Imm)                                               // A64
+  ASMJIT_INST_2x(sxtb, Sxtb, ArmGp, ArmGp)                                    // A64
+  ASMJIT_INST_2x(sxth, Sxth, ArmGp, ArmGp)                                    // A64
+  ASMJIT_INST_2x(sxtw, Sxtw, ArmGp, ArmGp)                                    // A64
+  ASMJIT_INST_3x(tbnz, Tbnz, ArmGp, Imm, Label)                               // A64
+  ASMJIT_INST_3x(tbz, Tbz, ArmGp, Imm, Label)                                 // A64
+  ASMJIT_INST_2x(tst, Tst, ArmGp, ArmGp)                                      // A64
+  ASMJIT_INST_2i(tst, Tst, ArmGp, Imm)                                        // A64
+  ASMJIT_INST_3x(udiv, Udiv, ArmGp, ArmGp, ArmGp)                             // A64
+  ASMJIT_INST_3x(umulh, Umulh, ArmGp, ArmGp, ArmGp)                           // A64
+  ASMJIT_INST_2x(uxtb, Uxtb, ArmGp, ArmGp)                                    // A64
+  ASMJIT_INST_2x(uxth, Uxth, ArmGp, ArmGp)                                    // A64
+
+  // --------------------------------------------------------------------------
+  // [FP and Vector Instructions]
+  // --------------------------------------------------------------------------
+
+  ASMJIT_INST_2x(fabs, Fabs, ArmVec, ArmVec)                                  // A64
+  ASMJIT_INST_3x(fadd, Fadd, ArmVec, ArmVec, ArmVec)                          // A64
+  ASMJIT_INST_2x(fcmp, Fcmp, ArmVec, ArmVec)                                  // A64
+  ASMJIT_INST_2i(fcmp, Fcmp, ArmVec, Imm)                                     // A64
+  ASMJIT_INST_2x(fcvt, Fcvt, ArmVec, ArmVec)                                  // A64
+  ASMJIT_INST_2x(fcvtzs, Fcvtzs, ArmGp, ArmVec)                               // A64
+  ASMJIT_INST_2x(fcvtzu, Fcvtzu, ArmGp, ArmVec)                               // A64
+  ASMJIT_INST_3x(fdiv, Fdiv, ArmVec, ArmVec, ArmVec)                          // A64
+  ASMJIT_INST_4x(fmadd, Fmadd, ArmVec, ArmVec, ArmVec, ArmVec)                // A64
+  ASMJIT_INST_3x(fmax, Fmax, ArmVec, ArmVec, ArmVec)                          // A64
+  ASMJIT_INST_3x(fmin, Fmin, ArmVec, ArmVec, ArmVec)                          // A64
+  ASMJIT_INST_2x(fmov, Fmov, ArmVec, ArmVec)                                  // A64
+  ASMJIT_INST_2x(fmov, Fmov, ArmGp, ArmVec)                                   // A64
+  ASMJIT_INST_2x(fmov, Fmov, ArmVec, ArmGp)                                   // A64
+  ASMJIT_INST_4x(fmsub, Fmsub, ArmVec, ArmVec, ArmVec, ArmVec)                // A64
+  ASMJIT_INST_3x(fmul, Fmul, ArmVec, ArmVec, ArmVec)                          // A64
+  ASMJIT_INST_2x(fneg, Fneg, ArmVec, ArmVec)                                  // A64
+  ASMJIT_INST_2x(fsqrt, Fsqrt, ArmVec, ArmVec)                                // A64
+  ASMJIT_INST_3x(fsub, Fsub, ArmVec, ArmVec, ArmVec)                          // A64
+  ASMJIT_INST_3x(ldp, Ldp, ArmVec, ArmVec, ArmMem)                            // A64
+  ASMJIT_INST_2x(ldr, Ldr, ArmVec, ArmMem)                                    // A64
+  ASMJIT_INST_2x(mov, Mov, ArmVec, ArmVec)                                    // A64
+  ASMJIT_INST_2x(scvtf, Scvtf, ArmVec, ArmGp)                                 // A64
+  ASMJIT_INST_3x(stp, Stp, ArmVec, ArmVec, ArmMem)                            // A64
+  ASMJIT_INST_2x(str, Str, ArmVec, ArmMem)                                    // A64
+  ASMJIT_INST_2x(ucvtf, Ucvtf, ArmVec, ArmGp)                                 // A64
+};
+
+#undef ASMJIT_INST_0x
+#undef ASMJIT_INST_1x
+#undef ASMJIT_INST_1i
+#undef ASMJIT_INST_1c
+#undef ASMJIT_INST_2x
+#undef ASMJIT_INST_2i
+#undef ASMJIT_INST_3x
+#undef ASMJIT_INST_3i
+#undef ASMJIT_INST_3ii
+#undef ASMJIT_INST_4x
+#undef ASMJIT_INST_4i
+#undef ASMJIT_EMIT
+
+// ============================================================================
+// [asmjit::ArmEmitter]
+// ============================================================================
+
+//! ARM emitter.
+//!
+//! NOTE: This class cannot be created, you can only cast to it and use it as
+//! emitter that emits to either ArmAssembler, ArmBuilder, or ArmCompiler (use
+//! with caution with ArmCompiler as it expects virtual registers to be used).
+class ArmEmitter : public CodeEmitter, public ArmEmitterExplicitT<ArmEmitter> {
+  ASMJIT_NONCONSTRUCTIBLE(ArmEmitter)
+};
+
+//! \}
+
+} // asmjit namespace
+
+// [Api-End]
+#include "../asmjit_apiend.h"
+
+// [Guard]
+#endif // _ASMJIT_ARM_ARMEMITTER_H
@@ -0,0 +1,115 @@
+// [AsmJit]
+// Complete x86/x64 JIT and Remote Assembler for C++.
+//
+// [License]
+// Zlib - See LICENSE.md file in the package.
+
+// [Guard]
+#ifndef _ASMJIT_ARM_ARMGLOBALS_H
+#define _ASMJIT_ARM_ARMGLOBALS_H
+
+// [Dependencies]
+#include "../base/globals.h"
+
+// [Api-Begin]
+#include "../asmjit_apibegin.h"
+
+namespace asmjit {
+
+//! \addtogroup asmjit_arm
+//! \{
+
+// ============================================================================
+// [asmjit::armregs::]
+// ============================================================================
+
+//! ARM registers.
+namespace armregs {}
+
+// ============================================================================
+// [asmjit::armdefs::]
+// ============================================================================
+
+//! ARM definitions.
+namespace armdefs {
+
+// ============================================================================
+// [asmjit::armdefs::Cond]
+// ============================================================================
+
+//! Condition codes (AArch64).
+//!
+//! The value of each condition is the value encoded in instructions, the
+//! negated condition only differs in the lowest bit.
+ASMJIT_ENUM(Cond) {
+  kCondEQ               = 0x00U,         //!<         Z==1          (any_sign ==)
+  kCondNE               = 0x01U,         //!<         Z==0          (any_sign !=)
+  kCondCS               = 0x02U,         //!< C==1                  (unsigned >=)
+  kCondHS               = 0x02U,         //!< C==1                  (unsigned >=)
+  kCondCC               = 0x03U,         //!< C==0                  (unsigned < )
+  kCondLO               = 0x03U,         //!< C==0                  (unsigned < )
+  kCondMI               = 0x04U,         //!<                N==1   (is negative)
+  kCondPL               = 0x05U,         //!<                N==0   (is positive or zero)
+  kCondVS               = 0x06U,         //!<                V==1
+  kCondVC               = 0x07U,         //!<                V==0
+  kCondHI               = 0x08U,         //!< C==1 & Z==0           (unsigned > )
+  kCondLS               = 0x09U,         //!< C==0 | Z==1           (unsigned <=)
+  kCondGE               = 0x0AU,         //!<                N==V   (signed   >=)
+  kCondLT               = 0x0BU,         //!<                N!=V   (signed   < )
+  kCondGT               = 0x0CU,         //!<         Z==0 & N==V   (signed   > )
+  kCondLE               = 0x0DU,         //!<         Z==1 | N!=V   (signed   <=)
+  kCondAL               = 0x0EU,         //!< Always.
+  kCondNV               = 0x0FU,         //!< Always (behaves as AL).
+  kCondCount            = 0x10U,
+
+  // Simplified condition codes.
+  kCondSign             = kCondMI,       //!< Sign.
+  kCondNotSign          = kCondPL,       //!< Not Sign.
+
+  kCondOverflow         = kCondVS,       //!< Signed overflow.
+  kCondNotOverflow      = kCondVC,       //!< Not signed overflow.
+
+  kCondEqual            = kCondEQ,       //!< Equal      `a == b`.
+  kCondNotEqual         = kCondNE,       //!< Not Equal  `a != b`.
+
+  kCondSignedLT         = kCondLT,       //!< Signed     `a <  b`.
+  kCondSignedLE         = kCondLE,       //!< Signed     `a <= b`.
+  kCondSignedGT         = kCondGT,       //!< Signed     `a >  b`.
+  kCondSignedGE         = kCondGE,       //!< Signed     `a >= b`.
+
+  kCondUnsignedLT       = kCondLO,       //!< Unsigned   `a <  b`.
+  kCondUnsignedLE       = kCondLS,       //!< Unsigned   `a <= b`.
+  kCondUnsignedGT       = kCondHI,       //!< Unsigned   `a >  b`.
+  kCondUnsignedGE       = kCondHS,       //!< Unsigned   `a >= b`.
+
+  kCondZero             = kCondEQ,
+  kCondNotZero          = kCondNE,
+
+  kCondNegative         = kCondMI,
+  kCondPositive         = kCondPL
+};
+
+} // armdefs namespace
+
+// ============================================================================
+// [asmjit::arm::]
+// ============================================================================
+
+//! ARM constants, registers, and utilities.
+namespace arm {
+
+// Include all arm specific namespaces here.
+using namespace armdefs;
+using namespace armregs;
+
+} // arm namespace
+
+//! \}
+
+} // asmjit namespace
+
+// [Api-End]
+#include "../asmjit_apiend.h"
+
+// [Guard]
+#endif // _ASMJIT_ARM_ARMGLOBALS_H
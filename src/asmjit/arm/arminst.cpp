@@ -0,0 +1,362 @@
+// [AsmJit]
+// Complete x86/x64 JIT and Remote Assembler for C++.
+//
+// [License]
+// Zlib - See LICENSE.md file in the package.
+
+// ----------------------------------------------------------------------------
+// IMPORTANT: All tables enclosed by ${...} are generated from the instruction
+// list in `asmjit/tools/generate-arm.js`. Perform the following steps to
+// regenerate them:
+//
+//   1. Install node.js environment <https://nodejs.org>
+//   2. Go to asmjit/tools directory
+//   3. Install either asmdb package by executing `npm install asmdb` or get
+//      the latest asmdb from <https://github.com/asmjit/asmdb> and copy/link
+//      the `asmdb` directory to `asmjit/tools/asmdb` (required by
+//      `generate-base.js`).
+//   4. Execute `node generate-arm.js`
+//
+// Only the AArch64 (A64) subset used by `ArmAssembler` and `ArmCompiler` is
+// listed, add new instructions to the script, not to this file.
+// ----------------------------------------------------------------------------
+
+// [Export]
+#define ASMJIT_EXPORTS
+
+// [Guard]
+#include "../asmjit_build.h"
+#if defined(ASMJIT_BUILD_ARM)
+
+// [Dependencies]
+#include "../base/utils.h"
+#include "../arm/arminst.h"
+
+// [Api-Begin]
+#include "../asmjit_apibegin.h"
+
+namespace asmjit {
+
+// ============================================================================
+// [asmjit::ArmInst - InstData]
+// ============================================================================
+
+// Don't store `_nameDataIndex` if instruction names are disabled. Since some
+// APIs can use `_nameDataIndex` it's much safer if it's zero if it's not used.
+#if defined(ASMJIT_DISABLE_TEXT)
+# define NAME_DATA_INDEX(X) 0
+#else
+# define NAME_DATA_INDEX(X) X
+#endif
+
+// Defines an ARM instruction.
+#define INST(id, encoding, opcode0, nameDataIndex, commonDataIndex) { \
+  uint32_t(ArmInst::kEncoding##encoding),   \
+  uint32_t(NAME_DATA_INDEX(nameDataIndex)), \
+  uint32_t(commonDataIndex),                \
+  uint32_t(opcode0)                         \
+}
+const ArmInst ArmInstDB::instData[] = {
+  // <-------------+----------------+----------+-----+---+
+  //  Instruction  | Inst. Encoding |  OpCode  |NameX|ComX
+  // <-------------+----------------+----------+-----+---+
+  // ${instData:Begin}
+  INST(None    , None          , 0x00000000, 0   , 0  ),
+  INST(Adc     , BaseRRR       , 0x1A000000, 1   , 1  ),
+  INST(Adcs    , BaseRRR       , 0x3A000000, 5   , 1  ),
+  INST(Add     , BaseAddSub    , 0x11000000, 229 , 1  ),
+  INST(Adds    , BaseAddSub    , 0x31000000, 10  , 1  ),
+  INST(Adr     , BaseAdr       , 0x10000000, 15  , 1  ),
+  INST(And     , BaseLogical   , 0x0A000000, 19  , 1  ),
+  INST(Ands    , BaseLogical   , 0x6A000000, 23  , 1  ),
+  INST(Asr     , BaseShift     , 0x1AC02800, 28  , 1  ),
+  INST(B       , BaseBranch    , 0x14000000, 252 , 2  ),
+  INST(B_eq    , BaseBranchCond, 0x54000000, 32  , 3  ),
+  INST(B_ge    , BaseBranchCond, 0x5400000A, 37  , 3  ),
+  INST(B_gt    , BaseBranchCond, 0x5400000C, 42  , 3  ),
+  INST(B_hi    , BaseBranchCond, 0x54000008, 47  , 3  ),
+  INST(B_hs    , BaseBranchCond, 0x54000002, 52  , 3  ),
+  INST(B_le    , BaseBranchCond, 0x5400000D, 57  , 3  ),
+  INST(B_lo    , BaseBranchCond, 0x54000003, 62  , 3  ),
+  INST(B_ls    , BaseBranchCond, 0x54000009, 67  , 3  ),
+  INST(B_lt    , BaseBranchCond, 0x5400000B, 72  , 3  ),
+  INST(B_mi    , BaseBranchCond, 0x54000004, 77  , 3  ),
+  INST(B_ne    , BaseBranchCond, 0x54000001, 82  , 3  ),
+  INST(B_pl    , BaseBranchCond, 0x54000005, 87  , 3  ),
+  INST(B_vc    , BaseBranchCond, 0x54000007, 92  , 3  ),
+  INST(B_vs    , BaseBranchCond, 0x54000006, 97  , 3  ),
+  INST(Bic     , BaseLogical   , 0x0A200000, 102 , 1  ),
+  INST(Bics    , BaseLogical   , 0x6A200000, 106 , 1  ),
+  INST(Bl      , BaseBranch    , 0x94000000, 111 , 4  ),
+  INST(Blr     , BaseBranchReg , 0xD63F0000, 114 , 4  ),
+  INST(Br      , BaseBranchReg , 0xD61F0000, 118 , 2  ),
+  INST(Brk     , BaseImm16     , 0xD4200000, 121 , 5  ),
+  INST(Cbnz    , BaseCbz       , 0x35000000, 125 , 3  ),
+  INST(Cbz     , BaseCbz       , 0x34000000, 130 , 3  ),
+  INST(Cls     , BaseRR        , 0x5AC01400, 134 , 1  ),
+  INST(Clz     , BaseRR        , 0x5AC01000, 138 , 1  ),
+  INST(Cmn     , BaseCmp       , 0x31000000, 142 , 5  ),
+  INST(Cmp     , BaseCmp       , 0x71000000, 199 , 5  ),
+  INST(Csel    , BaseCSel      , 0x1A800000, 146 , 1  ),
+  INST(Cset    , BaseCSet      , 0x1A9F07E0, 151 , 1  ),
+  INST(Csetm   , BaseCSet      , 0x5A9F03E0, 156 , 1  ),
+  INST(Csinc   , BaseCSel      , 0x1A800400, 162 , 1  ),
+  INST(Csinv   , BaseCSel      , 0x5A800000, 168 , 1  ),
+  INST(Csneg   , BaseCSel      , 0x5A800400, 174 , 1  ),
+  INST(Eon     , BaseLogical   , 0x4A200000, 180 , 1  ),
+  INST(Eor     , BaseLogical   , 0x4A000000, 184 , 1  ),
+  INST(Fabs    , FpRR          , 0x1E20C000, 188 , 6  ),
+  INST(Fadd    , FpRRR         , 0x1E202800, 193 , 6  ),
+  INST(Fcmp    , FpCmp         , 0x1E202000, 198 , 7  ),
+  INST(Fcvt    , FpCvt         , 0x1E224000, 203 , 6  ),
+  INST(Fcvtzs  , FpCvtToGp     , 0x1E380000, 208 , 6  ),
+  INST(Fcvtzu  , FpCvtToGp     , 0x1E390000, 215 , 6  ),
+  INST(Fdiv    , FpRRR         , 0x1E201800, 222 , 6  ),
+  INST(Fmadd   , FpRRRR        , 0x1F000000, 227 , 6  ),
+  INST(Fmax    , FpRRR         , 0x1E204800, 233 , 6  ),
+  INST(Fmin    , FpRRR         , 0x1E205800, 238 , 6  ),
+  INST(Fmov    , FpMov         , 0x1E204000, 243 , 8  ),
+  INST(Fmsub   , FpRRRR        , 0x1F008000, 248 , 6  ),
+  INST(Fmul    , FpRRR         , 0x1E200800, 254 , 6  ),
+  INST(Fneg    , FpRR          , 0x1E214000, 259 , 6  ),
+  INST(Fsqrt   , FpRR          , 0x1E21C000, 264 , 6  ),
+  INST(Fsub    , FpRRR         , 0x1E203800, 270 , 6  ),
+  INST(Hlt     , BaseImm16     , 0xD4400000, 275 , 5  ),
+  INST(Ldp     , BaseLdpStp    , 0x28400000, 279 , 9  ),
+  INST(Ldr     , BaseLdSt      , 0x39400000, 283 , 1  ),
+  INST(Ldrb    , BaseLdStSized , 0x39400000, 287 , 1  ),
+  INST(Ldrh    , BaseLdStSized , 0x79400000, 292 , 1  ),
+  INST(Ldrsb   , BaseLdStSized , 0x39800000, 297 , 1  ),
+  INST(Ldrsh   , BaseLdStSized , 0x79800000, 303 , 1  ),
+  INST(Ldrsw   , BaseLdStSized , 0xB9800000, 309 , 1  ),
+  INST(Lsl     , BaseShift     , 0x1AC02000, 315 , 1  ),
+  INST(Lsr     , BaseShift     , 0x1AC02400, 319 , 1  ),
+  INST(Madd    , BaseRRRR      , 0x1B000000, 228 , 1  ),
+  INST(Mneg    , BaseRRR       , 0x1B00FC00, 323 , 1  ),
+  INST(Mov     , BaseMov       , 0x00000000, 244 , 10 ),
+  INST(Movk    , BaseMovWide   , 0x72800000, 328 , 11 ),
+  INST(Movn    , BaseMovWide   , 0x12800000, 333 , 1  ),
+  INST(Movz    , BaseMovWide   , 0x52800000, 338 , 1  ),
+  INST(Msub    , BaseRRRR      , 0x1B008000, 249 , 1  ),
+  INST(Mul     , BaseRRR       , 0x1B007C00, 255 , 1  ),
+  INST(Mvn     , BaseNeg       , 0x2A2003E0, 343 , 1  ),
+  INST(Neg     , BaseNeg       , 0x4B0003E0, 176 , 1  ),
+  INST(Negs    , BaseNeg       , 0x6B0003E0, 347 , 1  ),
+  INST(Nop     , BaseOp        , 0xD503201F, 352 , 0  ),
+  INST(Orn     , BaseLogical   , 0x2A200000, 356 , 1  ),
+  INST(Orr     , BaseLogical   , 0x2A000000, 360 , 1  ),
+  INST(Rbit    , BaseRR        , 0x5AC00000, 364 , 1  ),
+  INST(Ret     , BaseRet       , 0xD65F0000, 369 , 12 ),
+  INST(Rev     , BaseRR        , 0x5AC00800, 373 , 1  ),
+  INST(Rev16   , BaseRR        , 0x5AC00400, 377 , 1  ),
+  INST(Ror     , BaseShift     , 0x1AC02C00, 383 , 1  ),
+  INST(Sbc     , BaseRRR       , 0x5A000000, 387 , 1  ),
+  INST(Sbcs    , BaseRRR       , 0x7A000000, 391 , 1  ),
+  INST(Scvtf   , FpCvtFromGp   , 0x1E220000, 396 , 6  ),
+  INST(Sdiv    , BaseRRR       , 0x1AC00C00, 402 , 1  ),
+  INST(Smulh   , BaseRRR       , 0x9B407C00, 407 , 1  ),
+  INST(Stp     , BaseLdpStp    , 0x28000000, 413 , 13 ),
+  INST(Str     , BaseLdSt      , 0x39000000, 417 , 13 ),
+  INST(Strb    , BaseLdStSized , 0x39000000, 421 , 13 ),
+  INST(Strh    , BaseLdStSized , 0x79000000, 426 , 13 ),
+  INST(Sub     , BaseAddSub    , 0x51000000, 250 , 1  ),
+  INST(Subs    , BaseAddSub    , 0x71000000, 431 , 1  ),
+  INST(Svc     , BaseImm16     , 0xD4000001, 436 , 5  ),
+  INST(Sxtb    , BaseExtend    , 0x13001C00, 440 , 1  ),
+  INST(Sxth    , BaseExtend    , 0x13003C00, 445 , 1  ),
+  INST(Sxtw    , BaseExtend    , 0x93407C00, 450 , 1  ),
+  INST(Tbnz    , BaseTbz       , 0x37000000, 455 , 3  ),
+  INST(Tbz     , BaseTbz       , 0x36000000, 460 , 3  ),
+  INST(Tst     , BaseTst       , 0x6A000000, 464 , 5  ),
+  INST(Ucvtf   , FpCvtFromGp   , 0x1E230000, 468 , 6  ),
+  INST(Udiv    , BaseRRR       , 0x1AC00800, 474 , 1  ),
+  INST(Umulh   , BaseRRR       , 0x9BC07C00, 479 , 1  ),
+  INST(Uxtb    , BaseExtend    , 0x53001C00, 485 , 1  ),
+  INST(Uxth    , BaseExtend    , 0x53003C00, 490 , 1  )
+  // ${instData:End}
+};
+#undef NAME_DATA_INDEX
+#undef INST
+
+// ============================================================================
+// [asmjit::ArmInst - CommonData]
+// ============================================================================
+
+#define F(flag) ArmInst::kFlag##flag
+#define JUMP_TYPE(type) Inst::kJumpType##type
+// ${commonData:Begin}
+// ------------------- Automatically generated, do not edit -------------------
+const ArmInst::CommonData ArmInstDB::commonData[] = {
+  { 0                       , JUMP_TYPE(None)       , 0 }, // #0
+  { F(UseW)                 , JUMP_TYPE(None)       , 0 }, // #1
+  { F(UseR)                 , JUMP_TYPE(Direct)     , 0 }, // #2
+  { F(UseR)                 , JUMP_TYPE(Conditional), 0 }, // #3
+  { F(UseR)                 , JUMP_TYPE(Call)       , 0 }, // #4
+  { F(UseR)                 , JUMP_TYPE(None)       , 0 }, // #5
+  { F(UseW)|F(Fp)           , JUMP_TYPE(None)       , 0 }, // #6
+  { F(UseR)|F(Fp)           , JUMP_TYPE(None)       , 0 }, // #7
+  { F(UseW)|F(Move)|F(Fp)   , JUMP_TYPE(None)       , 0 }, // #8
+  { F(UseW)|F(UseW2)        , JUMP_TYPE(None)       , 0 }, // #9
+  { F(UseW)|F(Move)         , JUMP_TYPE(None)       , 0 }, // #10
+  { F(UseX)                 , JUMP_TYPE(None)       , 0 }, // #11
+  { F(UseR)                 , JUMP_TYPE(Return)     , 0 }, // #12
+  { F(UseR)|F(Store)        , JUMP_TYPE(None)       , 0 }  // #13
+};
+// ----------------------------------------------------------------------------
+// ${commonData:End}
+#undef JUMP_TYPE
+#undef F
+
+// ============================================================================
+// [asmjit::ArmInst - Utilities]
+// ============================================================================
+
+uint32_t ArmInst::condToBranch(uint32_t cond) noexcept {
+  static const uint16_t condToBranchTable[arm::kCondCount] = {
+    kIdB_eq, kIdB_ne, kIdB_hs, kIdB_lo, kIdB_mi, kIdB_pl, kIdB_vs, kIdB_vc,
+    kIdB_hi, kIdB_ls, kIdB_ge, kIdB_lt, kIdB_gt, kIdB_le, kIdB  , kIdB
+  };
+
+  ASMJIT_ASSERT(cond < arm::kCondCount);
+  return condToBranchTable[cond];
+}
+
+// ============================================================================
+// [asmjit::ArmInst - Id <-> Name]
+// ============================================================================
+
+#if !defined(ASMJIT_DISABLE_TEXT)
+// ${nameData:Begin}
+// ------------------- Automatically generated, do not edit -------------------
+const char ArmInstDB::nameData[] =
+  "\0" "adc\0" "adcs\0" "adds\0" "adr\0" "and\0" "ands\0" "asr\0" "b.eq\0"
+  "b.ge\0" "b.gt\0" "b.hi\0" "b.hs\0" "b.le\0" "b.lo\0" "b.ls\0" "b.lt\0"
+  "b.mi\0" "b.ne\0" "b.pl\0" "b.vc\0" "b.vs\0" "bic\0" "bics\0" "bl\0" "blr\0"
+  "br\0" "brk\0" "cbnz\0" "cbz\0" "cls\0" "clz\0" "cmn\0" "csel\0" "cset\0"
+  "csetm\0" "csinc\0" "csinv\0" "csneg\0" "eon\0" "eor\0" "fabs\0" "fadd\0"
+  "fcmp\0" "fcvt\0" "fcvtzs\0" "fcvtzu\0" "fdiv\0" "fmadd\0" "fmax\0" "fmin\0"
+  "fmov\0" "fmsub\0" "fmul\0" "fneg\0" "fsqrt\0" "fsub\0" "hlt\0" "ldp\0"
+  "ldr\0" "ldrb\0" "ldrh\0" "ldrsb\0" "ldrsh\0" "ldrsw\0" "lsl\0" "lsr\0"
+  "mneg\0" "movk\0" "movn\0" "movz\0" "mvn\0" "negs\0" "nop\0" "orn\0" "orr\0"
+  "rbit\0" "ret\0" "rev\0" "rev16\0" "ror\0" "sbc\0" "sbcs\0" "scvtf\0"
+  "sdiv\0" "smulh\0" "stp\0" "str\0" "strb\0" "strh\0" "subs\0" "svc\0"
+  "sxtb\0" "sxth\0" "sxtw\0" "tbnz\0" "tbz\0" "tst\0" "ucvtf\0" "udiv\0"
+  "umulh\0" "uxtb\0" "uxth";
+
+enum {
+  kArmInstMaxLength = 6,
+  kArmInstNameHashBuckets = 28,
+  kArmInstNameHashSize = 111
+};
+
+static const uint16_t ArmInstNameHashSeed[] = {
+  18, 4, 2, 0, 85, 308, 90, 0, 114, 517, 3, 7, 0, 0, 35, 1645, 53, 0, 27, 17,
+  28, 135, 812, 1, 61, 157, 1, 744
+};
+
+static const uint16_t ArmInstNameHashTable[] = {
+  108, 28, 91, 57, 39, 19, 105, 85, 90, 76, 53, 61, 83, 63, 4, 6, 96, 94, 50,
+  51, 25, 15, 44, 55, 23, 3, 30, 37, 77, 104, 88, 98, 78, 35, 29, 70, 102, 5,
+  58, 103, 80, 20, 56, 99, 45, 9, 92, 82, 107, 11, 95, 12, 74, 84, 110, 111,
+  71, 66, 54, 42, 13, 86, 62, 100, 106, 109, 18, 38, 75, 26, 27, 46, 31, 64,
+  68, 43, 40, 2, 48, 47, 22, 69, 87, 21, 60, 101, 34, 79, 33, 52, 97, 41, 16,
+  73, 7, 89, 36, 8, 49, 59, 32, 17, 10, 72, 14, 65, 24, 67, 1, 81, 93
+};
+// ----------------------------------------------------------------------------
+// ${nameData:End}
+
+//! \internal
+//!
+//! Hash an instruction name, must match `NameHash.hash()` in `generate-base.js`.
+static ASMJIT_INLINE uint32_t ArmInstNameHash(const char* name, size_t len) noexcept {
+  uint32_t hVal = 0x811C9DC5U;
+  for (size_t i = 0; i < len; i++)
+    hVal = (hVal ^ static_cast<uint8_t>(name[i])) * 0x01000193U;
+  return hVal;
+}
+
+//! \internal
+//!
+//! Mix a name hash with a bucket seed, must match `NameHash.mix()` in `generate-base.js`.
+static ASMJIT_INLINE uint32_t ArmInstNameMix(uint32_t hVal, uint32_t seed) noexcept {
+  hVal ^= seed;
+  hVal = (hVal ^ (hVal >> 16)) * 0x85EBCA6BU;
+  hVal = (hVal ^ (hVal >> 13)) * 0xC2B2AE35U;
+  return hVal ^ (hVal >> 16);
+}
+
+uint32_t ArmInst::getIdByName(const char* name, size_t len) noexcept {
+  if (ASMJIT_UNLIKELY(!name))
+    return Inst::kIdNone;
+
+  if (len == Globals::kInvalidIndex)
+    len = ::strlen(name);
+
+  if (ASMJIT_UNLIKELY(len == 0 || len > kArmInstMaxLength))
+    return Inst::kIdNone;
+
+  uint32_t hVal = ArmInstNameHash(name, len);
+  uint32_t seed = ArmInstNameHashSeed[hVal % kArmInstNameHashBuckets];
+  uint32_t id = ArmInstNameHashTable[ArmInstNameMix(hVal, seed) % kArmInstNameHashSize];
+
+  const char* nameData = ArmInstDB::nameData;
+  if (Utils::cmpInstName(nameData + ArmInstDB::instData[id].getNameDataIndex(), name, len) != 0)
+    return Inst::kIdNone;
+
+  return id;
+}
+
+const char* ArmInst::getNameById(uint32_t id) noexcept {
+  if (ASMJIT_UNLIKELY(id >= ArmInst::_kIdCount))
+    return nullptr;
+  return ArmInst::getInst(id).getName();
+}
+#else
+const char ArmInstDB::nameData[] = "";
+#endif // !ASMJIT_DISABLE_TEXT
+
+// ============================================================================
+// [asmjit::ArmInst - Test]
+// ============================================================================
+
+#if defined(ASMJIT_TEST) && !defined(ASMJIT_DISABLE_TEXT)
+UNIT(arm_inst_names) {
+  // All known instructions should be matched.
+  INFO("Matching all ARM instructions");
+  for (uint32_t a = 0; a < ArmInst::_kIdCount; a++) {
+    uint32_t b = ArmInst::getIdByName(ArmInst::getInst(a).getName());
+    EXPECT(a == b,
+      "Should match existing instruction \"%s\" {id:%u} != \"%s\" {id:%u}",
+        ArmInst::getInst(a).getName(), a,
+        ArmInst::getInst(b).getName(), b);
+  }
+
+  // Everything else should return `Inst::kIdNone`.
+  INFO("Trying to look-up instructions that don't exist");
+  EXPECT(ArmInst::getIdByName(nullptr)  == Inst::kIdNone, "Should return Inst::kIdNone for null input");
+  EXPECT(ArmInst::getIdByName("")       == Inst::kIdNone, "Should return Inst::kIdNone for empty string");
+  EXPECT(ArmInst::getIdByName("_")      == Inst::kIdNone, "Should return Inst::kIdNone for unknown instruction");
+  EXPECT(ArmInst::getIdByName("123xyz") == Inst::kIdNone, "Should return Inst::kIdNone for unknown instruction");
+  EXPECT(ArmInst::getIdByName("ad")     == Inst::kIdNone, "Should return Inst::kIdNone for a prefix of a known instruction");
+  EXPECT(ArmInst::getIdByName("addsx")  == Inst::kIdNone, "Should return Inst::kIdNone for a known instruction followed by junk");
+  EXPECT(ArmInst::getIdByName("ADD")    == Inst::kIdNone, "Should return Inst::kIdNone for an upper-case name");
+  EXPECT(ArmInst::getIdByName("b.")     == Inst::kIdNone, "Should return Inst::kIdNone for an incomplete condition");
+
+  INFO("Looking up instructions by name of a given length");
+  EXPECT(ArmInst::getIdByName("addsx", 4) == ArmInst::kIdAdds, "Should match a name limited by length");
+  EXPECT(ArmInst::getIdByName("b.eq") == ArmInst::kIdB_eq, "Should match a conditional branch");
+
+  INFO("Checking conditional branches");
+  EXPECT(ArmInst::condToBranch(arm::kCondEQ) == ArmInst::kIdB_eq);
+  EXPECT(ArmInst::condToBranch(arm::kCondUnsignedLT) == ArmInst::kIdB_lo);
+  EXPECT(ArmInst::condToBranch(arm::kCondAL) == ArmInst::kIdB);
+}
+#endif // ASMJIT_TEST && !ASMJIT_DISABLE_TEXT
+
+} // asmjit namespace
+
+// [Api-End]
+#include "../asmjit_apiend.h"
+
+// [Guard]
+#endif // ASMJIT_BUILD_ARM
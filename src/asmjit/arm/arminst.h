@@ -0,0 +1,349 @@
+// [AsmJit]
+// Complete x86/x64 JIT and Remote Assembler for C++.
+//
+// [License]
+// Zlib - See LICENSE.md file in the package.
+
+// [Guard]
+#ifndef _ASMJIT_ARM_ARMINST_H
+#define _ASMJIT_ARM_ARMINST_H
+
+// [Dependencies]
+#include "../base/inst.h"
+#include "../base/operand.h"
+#include "../base/utils.h"
+#include "../arm/armglobals.h"
+
+// [Api-Begin]
+#include "../asmjit_apibegin.h"
+
+namespace asmjit {
+
+//! \addtogroup asmjit_arm
+//! \{
+
+// ============================================================================
+// [asmjit::ArmInst]
+// ============================================================================
+
+//! ARM instruction data (AArch64).
+struct ArmInst {
+  //! Instruction id (AsmJit specific).
+  //!
+  //! Each instruction has a unique ID that is used as an index to AsmJit's
+  //! instruction table. Instructions are sorted alphabetically, a conditional
+  //! branch `b.cond` has an id `kIdB_cond`.
+  ASMJIT_ENUM(Id) {
+    // ${idData:Begin}
+    kIdNone = 0,
+    kIdAdc,                              // [A64]
+    kIdAdcs,                             // [A64]
+    kIdAdd,                              // [A64]
+    kIdAdds,                             // [A64]
+    kIdAdr,                              // [A64]
+    kIdAnd,                              // [A64]
+    kIdAnds,                             // [A64]
+    kIdAsr,                              // [A64]
+    kIdB,                                // [A64]
+    kIdB_eq,                             // [A64]
+    kIdB_ge,                             // [A64]
+    kIdB_gt,                             // [A64]
+    kIdB_hi,                             // [A64]
+    kIdB_hs,                             // [A64]
+    kIdB_le,                             // [A64]
+    kIdB_lo,                             // [A64]
+    kIdB_ls,                             // [A64]
+    kIdB_lt,                             // [A64]
+    kIdB_mi,                             // [A64]
+    kIdB_ne,                             // [A64]
+    kIdB_pl,                             // [A64]
+    kIdB_vc,                             // [A64]
+    kIdB_vs,                             // [A64]
+    kIdBic,                              // [A64]
+    kIdBics,                             // [A64]
+    kIdBl,                               // [A64]
+    kIdBlr,                              // [A64]
+    kIdBr,                               // [A64]
+    kIdBrk,                              // [A64]
+    kIdCbnz,                             // [A64]
+    kIdCbz,                              // [A64]
+    kIdCls,                              // [A64]
+    kIdClz,                              // [A64]
+    kIdCmn,                              // [A64]
+    kIdCmp,                              // [A64]
+    kIdCsel,                             // [A64]
+    kIdCset,                             // [A64]
+    kIdCsetm,                            // [A64]
+    kIdCsinc,                            // [A64]
+    kIdCsinv,                            // [A64]
+    kIdCsneg,                            // [A64]
+    kIdEon,                              // [A64]
+    kIdEor,                              // [A64]
+    kIdFabs,                             // [A64] {FP}
+    kIdFadd,                             // [A64] {FP}
+    kIdFcmp,                             // [A64] {FP}
+    kIdFcvt,                             // [A64] {FP}
+    kIdFcvtzs,                           // [A64] {FP}
+    kIdFcvtzu,                           // [A64] {FP}
+    kIdFdiv,                             // [A64] {FP}
+    kIdFmadd,                            // [A64] {FP}
+    kIdFmax,                             // [A64] {FP}
+    kIdFmin,                             // [A64] {FP}
+    kIdFmov,                             // [A64] {FP}
+    kIdFmsub,                            // [A64] {FP}
+    kIdFmul,                             // [A64] {FP}
+    kIdFneg,                             // [A64] {FP}
+    kIdFsqrt,                            // [A64] {FP}
+    kIdFsub,                             // [A64] {FP}
+    kIdHlt,                              // [A64]
+    kIdLdp,                              // [A64]
+    kIdLdr,                              // [A64]
+    kIdLdrb,                             // [A64]
+    kIdLdrh,                             // [A64]
+    kIdLdrsb,                            // [A64]
+    kIdLdrsh,                            // [A64]
+    kIdLdrsw,                            // [A64]
+    kIdLsl,                              // [A64]
+    kIdLsr,                              // [A64]
+    kIdMadd,                             // [A64]
+    kIdMneg,                             // [A64]
+    kIdMov,                              // [A64]
+    kIdMovk,                             // [A64]
+    kIdMovn,                             // [A64]
+    kIdMovz,                             // [A64]
+    kIdMsub,                             // [A64]
+    kIdMul,                              // [A64]
+    kIdMvn,                              // [A64]
+    kIdNeg,                              // [A64]
+    kIdNegs,                             // [A64]
+    kIdNop,                              // [A64]
+    kIdOrn,                              // [A64]
+    kIdOrr,                              // [A64]
+    kIdRbit,                             // [A64]
+    kIdRet,                              // [A64]
+    kIdRev,                              // [A64]
+    kIdRev16,                            // [A64]
+    kIdRor,                              // [A64]
+    kIdSbc,                              // [A64]
+    kIdSbcs,                             // [A64]
+    kIdScvtf,                            // [A64] {FP}
+    kIdSdiv,                             // [A64]
+    kIdSmulh,                            // [A64]
+    kIdStp,                              // [A64]
+    kIdStr,                              // [A64]
+    kIdStrb,                             // [A64]
+    kIdStrh,                             // [A64]
+    kIdSub,                              // [A64]
+    kIdSubs,                             // [A64]
+    kIdSvc,                              // [A64]
+    kIdSxtb,                             // [A64]
+    kIdSxth,                             // [A64]
+    kIdSxtw,                             // [A64]
+    kIdTbnz,                             // [A64]
+    kIdTbz,                              // [A64]
+    kIdTst,                              // [A64]
+    kIdUcvtf,                            // [A64] {FP}
+    kIdUdiv,                             // [A64]
+    kIdUmulh,                            // [A64]
+    kIdUxtb,                             // [A64]
+    kIdUxth,                             // [A64]
+    _kIdCount
+    // ${idData:End}
+  };
+
+  //! Instruction encodings, used by \ref ArmAssembler (AsmJit specific).
+  ASMJIT_ENUM(EncodingType) {
+    kEncodingNone = 0,                   //!< Never used.
+    kEncodingBaseOp,                     //!< Base [OP] (no operands).
+    kEncodingBaseImm16,                  //!< Base [OP] #imm16 (brk, hlt, svc).
+    kEncodingBaseAddSub,                 //!< Base add, adds, sub, subs.
+    kEncodingBaseCmp,                    //!< Base cmn, cmp.
+    kEncodingBaseLogical,                //!< Base and, ands, bic, bics, eon, eor, orn, orr.
+    kEncodingBaseTst,                    //!< Base tst.
+    kEncodingBaseMov,                    //!< Base mov (GP and VEC).
+    kEncodingBaseMovWide,                //!< Base movk, movn, movz.
+    kEncodingBaseShift,                  //!< Base asr, lsl, lsr, ror.
+    kEncodingBaseExtend,                 //!< Base sxtb, sxth, sxtw, uxtb, uxth.
+    kEncodingBaseRR,                     //!< Base cls, clz, rbit, rev, rev16.
+    kEncodingBaseRRR,                    //!< Base [OP] Rd, Rn, Rm.
+    kEncodingBaseRRRR,                   //!< Base [OP] Rd, Rn, Rm, Ra.
+    kEncodingBaseNeg,                    //!< Base mvn, neg, negs.
+    kEncodingBaseCSel,                   //!< Base csel, csinc, csinv, csneg.
+    kEncodingBaseCSet,                   //!< Base cset, csetm.
+    kEncodingBaseLdSt,                   //!< Base ldr, str (GP and VEC, size of the register).
+    kEncodingBaseLdStSized,              //!< Base ldrb, ldrh, ldrsb, ldrsh, ldrsw, strb, strh.
+    kEncodingBaseLdpStp,                 //!< Base ldp, stp (GP and VEC).
+    kEncodingBaseAdr,                    //!< Base adr.
+    kEncodingBaseBranch,                 //!< Base b, bl.
+    kEncodingBaseBranchCond,             //!< Base b.cond.
+    kEncodingBaseBranchReg,              //!< Base blr, br.
+    kEncodingBaseCbz,                    //!< Base cbnz, cbz.
+    kEncodingBaseTbz,                    //!< Base tbnz, tbz.
+    kEncodingBaseRet,                    //!< Base ret.
+    kEncodingFpRR,                       //!< FP [OP] Vd, Vn.
+    kEncodingFpRRR,                      //!< FP [OP] Vd, Vn, Vm.
+    kEncodingFpRRRR,                     //!< FP [OP] Vd, Vn, Vm, Va.
+    kEncodingFpCmp,                      //!< FP fcmp.
+    kEncodingFpCvt,                      //!< FP fcvt.
+    kEncodingFpCvtFromGp,                //!< FP scvtf, ucvtf.
+    kEncodingFpCvtToGp,                  //!< FP fcvtzs, fcvtzu.
+    kEncodingFpMov,                      //!< FP fmov.
+    _kEncodingCount                      //!< Count of instruction encodings.
+  };
+
+  //! Instruction flags.
+  ASMJIT_ENUM(Flags) {
+    kFlagNone             = 0x00000000U, //!< No flags.
+
+    kFlagUseR             = 0x00000002U, //!< 1st operand is R (read), read-only if `kFlagUseW` isn't set.
+    kFlagUseW             = 0x00000004U, //!< 1st operand is W (written), write-only if `kFlagUseR` isn't set.
+    kFlagUseX             = 0x00000006U, //!< 1st operand is X (read-write).
+    kFlagUseW2            = 0x00000008U, //!< 2nd operand is also W (written), used by LDP.
+
+    kFlagMove             = 0x00000010U, //!< Instruction is a move of a register or an immediate.
+    kFlagStore            = 0x00000020U, //!< Instruction stores to memory.
+    kFlagFp               = 0x00000040U  //!< Instruction operates on floating point or vector registers.
+  };
+
+  //! Common data - aggregated data that is shared across many instructions.
+  struct CommonData {
+    //! Get all instruction flags, see \ref ArmInst::Flags.
+    ASMJIT_INLINE uint32_t getFlags() const noexcept { return _flags; }
+    //! Get if the instruction has a `flag`, see \ref ArmInst::Flags.
+    ASMJIT_INLINE bool hasFlag(uint32_t flag) const noexcept { return (_flags & flag) != 0; }
+
+    //! Get if 1st operand is read-only.
+    ASMJIT_INLINE bool isUseR() const noexcept { return (getFlags() & kFlagUseX) == kFlagUseR; }
+    //! Get if 1st operand is write-only.
+    ASMJIT_INLINE bool isUseW() const noexcept { return (getFlags() & kFlagUseX) == kFlagUseW; }
+    //! Get if 1st operand is read-write.
+    ASMJIT_INLINE bool isUseX() const noexcept { return (getFlags() & kFlagUseX) == kFlagUseX; }
+    //! Get if 2nd operand is also written.
+    ASMJIT_INLINE bool isUseW2() const noexcept { return hasFlag(kFlagUseW2); }
+
+    //! Get if the instruction is a move.
+    ASMJIT_INLINE bool isMove() const noexcept { return hasFlag(kFlagMove); }
+    //! Get if the instruction stores to memory.
+    ASMJIT_INLINE bool isStore() const noexcept { return hasFlag(kFlagStore); }
+    //! Get if the instruction is a floating point instruction.
+    ASMJIT_INLINE bool isFp() const noexcept { return hasFlag(kFlagFp); }
+
+    //! Get if the instruction may or will jump (returns true also for calls and returns).
+    ASMJIT_INLINE bool doesJump() const noexcept { return _jumpType != Inst::kJumpTypeNone; }
+    ASMJIT_INLINE uint32_t getJumpType() const noexcept { return _jumpType; }
+
+    uint32_t _flags;                     //!< Instruction flags.
+    uint32_t _jumpType           : 3;    //!< Jump type, see `Inst::JumpType`.
+    uint32_t _reserved           : 29;   //!< \internal
+  };
+
+  // --------------------------------------------------------------------------
+  // [Accessors]
+  // --------------------------------------------------------------------------
+
+  //! Get instruction name (null terminated).
+  //!
+  //! NOTE: If AsmJit was compiled with `ASMJIT_DISABLE_TEXT` then this will
+  //! return an empty string (null terminated string of zero length).
+  ASMJIT_INLINE const char* getName() const noexcept;
+  //! Get index to `ArmInstDB::nameData` of this instruction.
+  //!
+  //! NOTE: If AsmJit was compiled with `ASMJIT_DISABLE_TEXT` then this will
+  //! always return zero.
+  ASMJIT_INLINE uint32_t getNameDataIndex() const noexcept { return _nameDataIndex; }
+
+  //! Get \ref CommonData of the instruction.
+  ASMJIT_INLINE const CommonData& getCommonData() const noexcept;
+  //! Get index to `ArmInstDB::commonData` of this instruction.
+  ASMJIT_INLINE uint32_t getCommonDataIndex() const noexcept { return _commonDataIndex; }
+
+  //! Get instruction encoding, see \ref EncodingType.
+  ASMJIT_INLINE uint32_t getEncodingType() const noexcept { return _encodingType; }
+  //! Get instruction's opcode, the base of the 32-bit instruction word.
+  ASMJIT_INLINE uint32_t getOpCode() const noexcept { return _opCode; }
+
+  //! Get if the instruction has a `flag`, see \ref Flags.
+  ASMJIT_INLINE bool hasFlag(uint32_t flag) const noexcept { return getCommonData().hasFlag(flag); }
+  //! Get instruction flags, see \ref Flags.
+  ASMJIT_INLINE uint32_t getFlags() const noexcept { return getCommonData().getFlags(); }
+  //! Get the jump type of the instruction, see \ref Inst::JumpType.
+  ASMJIT_INLINE uint32_t getJumpType() const noexcept { return getCommonData().getJumpType(); }
+
+  // --------------------------------------------------------------------------
+  // [Get]
+  // --------------------------------------------------------------------------
+
+  //! Get if the `instId` is defined (counts also Inst::kIdNone, which must be zero).
+  static ASMJIT_INLINE bool isDefinedId(uint32_t instId) noexcept { return instId < _kIdCount; }
+
+  //! Get instruction information based on the instruction `instId`.
+  //!
+  //! NOTE: `instId` has to be a valid instruction ID, it can't be greater than
+  //! or equal to `ArmInst::_kIdCount`. It asserts in debug mode.
+  static ASMJIT_INLINE const ArmInst& getInst(uint32_t instId) noexcept;
+
+  // --------------------------------------------------------------------------
+  // [Utilities]
+  // --------------------------------------------------------------------------
+
+  //! Get the equivalent of a negated condition code.
+  static ASMJIT_INLINE uint32_t negateCond(uint32_t cond) noexcept {
+    ASMJIT_ASSERT(cond < arm::kCondCount);
+    return cond ^ 1;
+  }
+
+  //! Translate a condition code `cond` to a "b.cond" instruction id, `b` is
+  //! returned for `kCondAL` and `kCondNV`.
+  ASMJIT_API static uint32_t condToBranch(uint32_t cond) noexcept;
+
+  // --------------------------------------------------------------------------
+  // [Id <-> Name]
+  // --------------------------------------------------------------------------
+
+#if !defined(ASMJIT_DISABLE_TEXT)
+  //! Get an instruction ID from a given instruction `name`.
+  //!
+  //! NOTE: Instruction name MUST BE in lowercase, otherwise there will be no
+  //! match. If there is an exact match the instruction id is returned, otherwise
+  //! `kInvalidInstId` (zero) is returned instead. The given `name` doesn't have
+  //! to be null-terminated if `len` is provided.
+  ASMJIT_API static uint32_t getIdByName(const char* name, size_t len = Globals::kInvalidIndex) noexcept;
+
+  //! Get an instruction name from a given instruction id `instId`.
+  ASMJIT_API static const char* getNameById(uint32_t instId) noexcept;
+#endif // !ASMJIT_DISABLE_TEXT
+
+  // --------------------------------------------------------------------------
+  // [Members]
+  // --------------------------------------------------------------------------
+
+  uint32_t _encodingType       : 8;      //!< Encoding type.
+  uint32_t _nameDataIndex      : 14;     //!< Index to `ArmInstDB::nameData` table.
+  uint32_t _commonDataIndex    : 10;     //!< Index to `ArmInstDB::commonData` table.
+  uint32_t _opCode;                      //!< Instruction's opcode.
+};
+
+//! ARM instruction data under a single namespace.
+struct ArmInstDB {
+  ASMJIT_API static const ArmInst instData[];
+  ASMJIT_API static const ArmInst::CommonData commonData[];
+  ASMJIT_API static const char nameData[];
+};
+
+ASMJIT_INLINE const ArmInst& ArmInst::getInst(uint32_t instId) noexcept {
+  ASMJIT_ASSERT(instId < ArmInst::_kIdCount);
+  return ArmInstDB::instData[instId];
+}
+
+ASMJIT_INLINE const char* ArmInst::getName() const noexcept { return &ArmInstDB::nameData[_nameDataIndex]; }
+ASMJIT_INLINE const ArmInst::CommonData& ArmInst::getCommonData() const noexcept { return ArmInstDB::commonData[_commonDataIndex]; }
+
+//! \}
+
+} // asmjit namespace
+
+// [Api-End]
+#include "../asmjit_apiend.h"
+
+// [Guard]
+#endif // _ASMJIT_ARM_ARMINST_H
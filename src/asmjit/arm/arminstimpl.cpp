@@ -0,0 +1,210 @@
+// [AsmJit]
+// Complete x86/x64 JIT and Remote Assembler for C++.
+//
+// [License]
+// Zlib - See LICENSE.md file in the package.
+
+// [Export]
+#define ASMJIT_EXPORTS
+
+// [Guard]
+#include "../asmjit_build.h"
+#if defined(ASMJIT_BUILD_ARM)
+
+// [Dependencies]
+#include "../base/cpuinfo.h"
+#include "../base/misc_p.h"
+#include "../base/utils.h"
+#include "../arm/arminstimpl_p.h"
+#include "../arm/armoperand.h"
+
+// [Api-Begin]
+#include "../asmjit_apibegin.h"
+
+namespace asmjit {
+
+// ============================================================================
+// [asmjit::ArmInstImpl - Validate]
+// ============================================================================
+
+#if !defined(ASMJIT_DISABLE_VALIDATION)
+//! \internal
+//!
+//! Validate a register of `rType` and `rId`, virtual registers are accepted
+//! as the validation is used by `ArmBuilder` and `ArmCompiler` as well.
+static ASMJIT_INLINE Error armValidateReg(uint32_t rType, uint32_t rId) noexcept {
+  if (ASMJIT_UNLIKELY(rType < ArmReg::kRegGpw || rType > ArmReg::kRegVecV))
+    return DebugUtils::errored(kErrorInvalidRegType);
+
+  if (Operand::isPackedId(rId))
+    return kErrorOk;
+
+  // Id 31 is SP, `kIdZr` is ZR, both are only valid for GP registers.
+  bool isGp = rType <= ArmReg::kRegGpx;
+  if (ASMJIT_UNLIKELY(isGp ? rId > 31 && rId != ArmGp::kIdZr : rId > 31))
+    return DebugUtils::errored(kErrorInvalidPhysId);
+
+  return kErrorOk;
+}
+
+ASMJIT_FAVOR_SIZE Error ArmInstImpl::validate(uint32_t archType, const Inst::Detail& detail, const Operand_* operands, uint32_t count) noexcept {
+  // Only AArch64 is implemented.
+  if (ASMJIT_UNLIKELY(archType != ArchInfo::kTypeA64))
+    return DebugUtils::errored(kErrorInvalidArch);
+
+  uint32_t instId = detail.instId;
+  if (ASMJIT_UNLIKELY(instId >= ArmInst::_kIdCount))
+    return DebugUtils::errored(kErrorInvalidArgument);
+
+  const ArmInst& inst = ArmInst::getInst(instId);
+  uint32_t regMask = 0;
+
+  for (uint32_t i = 0; i < count; i++) {
+    const Operand_& op = operands[i];
+
+    switch (op.getOp()) {
+      case Operand::kOpNone:
+        // There are no holes between operands.
+        for (uint32_t j = i + 1; j < count; j++)
+          if (ASMJIT_UNLIKELY(!operands[j].isNone()))
+            return DebugUtils::errored(kErrorInvalidInstruction);
+        i = count;
+        break;
+
+      case Operand::kOpReg: {
+        const Reg& reg = op.as<Reg>();
+        ASMJIT_PROPAGATE(armValidateReg(reg.getType(), reg.getId()));
+        regMask |= Utils::mask(reg.getType());
+        break;
+      }
+
+      case Operand::kOpMem: {
+        // Memory operand is based either on a label (literal) or on X|SP
+        // register, the index is always a GP register.
+        const ArmMem& m = op.as<ArmMem>();
+
+        if (m.hasBaseReg()) {
+          if (ASMJIT_UNLIKELY(m.getBaseType() != ArmReg::kRegGpx))
+            return DebugUtils::errored(kErrorInvalidAddress);
+          ASMJIT_PROPAGATE(armValidateReg(m.getBaseType(), m.getBaseId()));
+        }
+        else if (ASMJIT_UNLIKELY(!m.hasBaseLabel())) {
+          return DebugUtils::errored(kErrorInvalidAddress);
+        }
+
+        if (m.hasIndex()) {
+          if (ASMJIT_UNLIKELY(m.getIndexType() != ArmReg::kRegGpx && m.getIndexType() != ArmReg::kRegGpw))
+            return DebugUtils::errored(kErrorInvalidAddressIndex);
+          ASMJIT_PROPAGATE(armValidateReg(m.getIndexType(), m.getIndexId()));
+
+          if (ASMJIT_UNLIKELY(m.getMode() != ArmMem::kModeOffset))
+            return DebugUtils::errored(kErrorInvalidAddress);
+        }
+        break;
+      }
+
+      case Operand::kOpImm:
+      case Operand::kOpLabel:
+        break;
+
+      default:
+        return DebugUtils::errored(kErrorInvalidInstruction);
+    }
+  }
+
+  // Base instructions don't use vector registers, except of moves and loads
+  // and stores that have both GP and vector forms.
+  const uint32_t kVecMask = Utils::mask(ArmReg::kRegVecS, ArmReg::kRegVecD, ArmReg::kRegVecV);
+  if (!inst.getCommonData().isFp()) {
+    switch (inst.getEncodingType()) {
+      case ArmInst::kEncodingBaseMov:
+      case ArmInst::kEncodingBaseLdSt:
+      case ArmInst::kEncodingBaseLdpStp:
+        break;
+
+      default:
+        if (ASMJIT_UNLIKELY(regMask & kVecMask))
+          return DebugUtils::errored(kErrorInvalidInstruction);
+        break;
+    }
+  }
+  else {
+    // Only scalar FP registers are used by FP instructions.
+    if (ASMJIT_UNLIKELY(regMask & Utils::mask(ArmReg::kRegVecV)))
+      return DebugUtils::errored(kErrorInvalidInstruction);
+  }
+
+  return kErrorOk;
+}
+#endif
+
+// ============================================================================
+// [asmjit::ArmInstImpl - CheckFeatures]
+// ============================================================================
+
+#if !defined(ASMJIT_DISABLE_EXTENSIONS)
+ASMJIT_FAVOR_SIZE Error ArmInstImpl::checkFeatures(uint32_t archType, const Inst::Detail& detail, const Operand_* operands, uint32_t count, CpuFeatures& out) noexcept {
+  if (ASMJIT_UNLIKELY(archType != ArchInfo::kTypeA64))
+    return DebugUtils::errored(kErrorInvalidArch);
+
+  uint32_t instId = detail.instId;
+  if (ASMJIT_UNLIKELY(instId >= ArmInst::_kIdCount))
+    return DebugUtils::errored(kErrorInvalidArgument);
+
+  // All instructions are ARMv8, FP instructions and vector moves require
+  // 'Advanced SIMD', which is always present on AArch64 hosts that run
+  // a general purpose OS, but not on all of them.
+  out.reset();
+  out.add(CpuInfo::kArmFeatureV8);
+
+  bool usesVec = ArmInst::getInst(instId).getCommonData().isFp();
+  for (uint32_t i = 0; i < count; i++)
+    usesVec |= Reg::isVec(operands[i]);
+
+  if (usesVec)
+    out.add(CpuInfo::kArmFeatureASIMD);
+
+  return kErrorOk;
+}
+#endif
+
+// ============================================================================
+// [asmjit::ArmInstImpl - Test]
+// ============================================================================
+
+#if defined(ASMJIT_TEST) && !defined(ASMJIT_DISABLE_VALIDATION)
+UNIT(arm_inst_validation) {
+  Inst::Detail add(ArmInst::kIdAdd);
+  Inst::Detail fadd(ArmInst::kIdFadd);
+
+  Operand_ gp[3] = { arm::x0, arm::x1, arm::x2 };
+  Operand_ vec[3] = { arm::d0, arm::d1, arm::d2 };
+  Operand_ mix[3] = { arm::x0, arm::x1, arm::d2 };
+
+  INFO("Checking that only AArch64 is accepted");
+  EXPECT(ArmInstImpl::validate(ArchInfo::kTypeA64, add, gp, 3) == kErrorOk);
+  EXPECT(ArmInstImpl::validate(ArchInfo::kTypeA32, add, gp, 3) == kErrorInvalidArch);
+
+  INFO("Checking that GP and FP operands are not mixed");
+  EXPECT(ArmInstImpl::validate(ArchInfo::kTypeA64, add, mix, 3) == kErrorInvalidInstruction);
+  EXPECT(ArmInstImpl::validate(ArchInfo::kTypeA64, add, vec, 3) == kErrorInvalidInstruction);
+  EXPECT(ArmInstImpl::validate(ArchInfo::kTypeA64, fadd, vec, 3) == kErrorOk);
+
+  INFO("Checking memory operands");
+  Inst::Detail ldr(ArmInst::kIdLdr);
+  Operand_ m0[2] = { arm::x0, arm::ptr(arm::sp, 16) };
+  Operand_ m1[2] = { arm::x0, arm::ptr(arm::x1, arm::w2, 3) };
+  Operand_ m2[2] = { arm::x0, arm::ptr(arm::w1) };
+  EXPECT(ArmInstImpl::validate(ArchInfo::kTypeA64, ldr, m0, 2) == kErrorOk);
+  EXPECT(ArmInstImpl::validate(ArchInfo::kTypeA64, ldr, m1, 2) == kErrorOk);
+  EXPECT(ArmInstImpl::validate(ArchInfo::kTypeA64, ldr, m2, 2) == kErrorInvalidAddress);
+}
+#endif // ASMJIT_TEST && !ASMJIT_DISABLE_VALIDATION
+
+} // asmjit namespace
+
+// [Api-End]
+#include "../asmjit_apiend.h"
+
+// [Guard]
+#endif // ASMJIT_BUILD_ARM
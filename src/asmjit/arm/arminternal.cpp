@@ -0,0 +1,1048 @@
+// [AsmJit]
+// Complete x86/x64 JIT and Remote Assembler for C++.
+//
+// [License]
+// Zlib - See LICENSE.md file in the package.
+
+// [Export]
+#define ASMJIT_EXPORTS
+
+// [Guard]
+#include "../asmjit_build.h"
+#if defined(ASMJIT_BUILD_ARM)
+
+// [Dependencies]
+#include "../base/utils.h"
+#include "../arm/armassembler.h"
+#include "../arm/arminternal_p.h"
+
+// [Api-Begin]
+#include "../asmjit_apibegin.h"
+
+namespace asmjit {
+
+// ============================================================================
+// [asmjit::ArmInternal - Helpers]
+// ============================================================================
+
+static ASMJIT_INLINE uint32_t armVecTypeIdToRegType(uint32_t typeId) noexcept {
+  uint32_t size = TypeId::sizeOf(typeId);
+  return size <= 4 ? ArmReg::kRegVecS :
+         size <= 8 ? ArmReg::kRegVecD : ArmReg::kRegVecV;
+}
+
+//! \internal
+//!
+//! Registers that are never used to pass or shuffle arguments - IP0, IP1,
+//! the platform register, FP, LR, and SP.
+static ASMJIT_INLINE uint32_t armGpArchRegs() noexcept {
+  return Utils::bits(32) & ~Utils::mask(ArmGp::kIdIp0, ArmGp::kIdIp0 + 1, ArmGp::kIdPr,
+                                        ArmGp::kIdFp, ArmGp::kIdLr, ArmGp::kIdSp);
+}
+
+//! \internal
+//!
+//! Collect ids of all registers in `regs` to `ids`, returns their count.
+static ASMJIT_INLINE uint32_t armRegMaskToIds(uint32_t regs, uint8_t* ids) noexcept {
+  uint32_t n = 0;
+  for (uint32_t regId = 0; regs; regs >>= 1, regId++)
+    if (regs & 0x1)
+      ids[n++] = static_cast<uint8_t>(regId);
+  return n;
+}
+
+// ============================================================================
+// [asmjit::ArmFuncArgsContext]
+// ============================================================================
+
+// Used by both, `ArmInternal::argsToFrameInfo()` and `ArmInternal::allocArgs()`.
+//
+// It's a simplified `X86FuncArgsContext` - arguments passed by stack are
+// always loaded relative to SP, so there is no stack-arguments register, and
+// GP cycles are broken through IP0, which is never allocated.
+class ArmFuncArgsContext {
+public:
+  typedef FuncDetail::Value SrcArg;
+  typedef FuncArgsMapper::Value DstArg;
+
+  enum { kMaxVRegKinds = Globals::kMaxVRegKinds };
+
+  struct WorkData {
+    uint32_t archRegs;                   //!< Architecture provided and allocable regs.
+    uint32_t workRegs;                   //!< Registers that can be used by shuffler.
+    uint32_t usedRegs;                   //!< Only registers used to pass arguments.
+    uint32_t srcRegs;                    //!< Source registers that need shuffling.
+    uint32_t dstRegs;                    //!< Destination registers that need shuffling.
+    uint8_t numOps;                      //!< Number of operations to finish.
+    uint8_t numCycles;                   //!< Number of register cycles.
+    uint8_t numStackArgs;                //!< Number of stack loads.
+    uint8_t reserved[9];                 //!< Reserved (only used as padding).
+    uint8_t argIndex[32];                //!< Only valid if a corresponding bit in `userRegs` is true.
+  };
+
+  ArmFuncArgsContext() noexcept;
+  Error initWorkData(const FuncArgsMapper& args, const uint32_t* dirtyRegs) noexcept;
+
+  Error markDstRegsDirty(FuncFrameInfo& ffi) noexcept;
+  Error markRegsForCycles(FuncFrameInfo& ffi) noexcept;
+
+  // --------------------------------------------------------------------------
+  // [Members]
+  // --------------------------------------------------------------------------
+
+  WorkData _workData[kMaxVRegKinds];
+  bool _hasStackArgs;
+  bool _hasRegCycles;
+};
+
+ArmFuncArgsContext::ArmFuncArgsContext() noexcept {
+  ::memset(_workData, 0, sizeof(_workData));
+  _hasStackArgs = false;
+  _hasRegCycles = false;
+}
+
+ASMJIT_FAVOR_SIZE Error ArmFuncArgsContext::initWorkData(const FuncArgsMapper& args, const uint32_t* dirtyRegs) noexcept {
+  uint32_t i;
+  const FuncDetail& func = *args.getFuncDetail();
+
+  // Initialize WorkData::archRegs.
+  _workData[ArmReg::kKindGp ].archRegs = armGpArchRegs();
+  _workData[ArmReg::kKindVec].archRegs = Utils::bits(32);
+
+  // Initialize WorkData::workRegs.
+  for (i = 0; i < kMaxVRegKinds; i++)
+    _workData[i].workRegs = _workData[i].archRegs & (dirtyRegs[i] | ~func.getCallConv().getPreservedRegs(i));
+
+  // Build WorkData.
+  for (i = 0; i < kFuncArgCountLoHi; i++) {
+    const DstArg& dstArg = args.getArg(i);
+    if (!dstArg.isAssigned()) continue;
+
+    const SrcArg& srcArg = func.getArg(i);
+    if (ASMJIT_UNLIKELY(!srcArg.isAssigned()))
+      return DebugUtils::errored(kErrorInvalidState);
+
+    uint32_t dstRegType = dstArg.getRegType();
+    if (ASMJIT_UNLIKELY(dstRegType < ArmReg::kRegGpw || dstRegType >= ArmReg::kRegCount))
+      return DebugUtils::errored(kErrorInvalidRegType);
+
+    uint32_t dstRegKind = ArmReg::kindOf(dstRegType);
+    if (ASMJIT_UNLIKELY(dstRegKind >= kMaxVRegKinds))
+      return DebugUtils::errored(kErrorInvalidState);
+
+    WorkData& dstData = _workData[dstRegKind];
+    uint32_t dstRegId = dstArg.getRegId();
+    if (ASMJIT_UNLIKELY(dstRegId >= 32 || !(dstData.archRegs & Utils::mask(dstRegId))))
+      return DebugUtils::errored(kErrorInvalidPhysId);
+
+    uint32_t dstRegMask = Utils::mask(dstRegId);
+    if (ASMJIT_UNLIKELY(dstData.usedRegs & dstRegMask))
+      return DebugUtils::errored(kErrorOverlappedRegs);
+
+    dstData.usedRegs |= dstRegMask;
+    dstData.argIndex[dstRegId] = static_cast<uint8_t>(i);
+
+    if (srcArg.byReg()) {
+      uint32_t srcRegKind = ArmReg::kindOf(srcArg.getRegType());
+      uint32_t srcRegId = srcArg.getRegId();
+      uint32_t srcRegMask = Utils::mask(srcRegId);
+
+      if (dstRegKind == srcRegKind) {
+        // The best case, register is allocated where it is expected to be.
+        if (dstRegId == srcRegId && dstArg.getRegType() == srcArg.getRegType()) continue;
+        dstData.srcRegs |= srcRegMask;
+      }
+      else {
+        if (ASMJIT_UNLIKELY(srcRegKind >= kMaxVRegKinds))
+          return DebugUtils::errored(kErrorInvalidState);
+
+        WorkData& srcData = _workData[srcRegKind];
+        srcData.srcRegs |= srcRegMask;
+      }
+    }
+    else {
+      dstData.numStackArgs++;
+      _hasStackArgs = true;
+    }
+
+    dstData.numOps++;
+    dstData.dstRegs |= dstRegMask;
+  }
+
+  // Count register cycles, each cycle needs a temporary register to be
+  // resolved. A cycle is counted once, when it's reached from its lowest
+  // destination register.
+  for (i = 0; i < kMaxVRegKinds; i++) {
+    WorkData& wd = _workData[i];
+    uint32_t regsToCheck = wd.dstRegs;
+
+    while (regsToCheck) {
+      uint32_t startId = Utils::findFirstBit(regsToCheck);
+      uint32_t regId = startId;
+      regsToCheck ^= Utils::mask(startId);
+
+      for (uint32_t n = 0; n < 32; n++) {
+        const SrcArg& srcArg = func.getArg(wd.argIndex[regId]);
+        if (!srcArg.byReg() || ArmReg::kindOf(srcArg.getRegType()) != i)
+          break;
+
+        regId = srcArg.getRegId();
+        if (regId < startId || !(wd.dstRegs & Utils::mask(regId)))
+          break;
+
+        if (regId == startId) {
+          wd.numCycles++;
+          _hasRegCycles = true;
+          break;
+        }
+      }
+    }
+  }
+
+  return kErrorOk;
+}
+
+ASMJIT_FAVOR_SIZE Error ArmFuncArgsContext::markDstRegsDirty(FuncFrameInfo& ffi) noexcept {
+  for (uint32_t i = 0; i < kMaxVRegKinds; i++) {
+    WorkData& wd = _workData[i];
+    uint32_t regs = wd.usedRegs | wd.dstRegs;
+
+    wd.workRegs |= regs;
+    ffi.addDirtyRegs(i, regs);
+  }
+
+  return kErrorOk;
+}
+
+ASMJIT_FAVOR_SIZE Error ArmFuncArgsContext::markRegsForCycles(FuncFrameInfo& ffi) noexcept {
+  if (!_hasRegCycles)
+    return kErrorOk;
+
+  // GP cycles use IP0, pick a temporary register for vector cycles, which
+  // don't have any scratch register reserved.
+  WorkData& wd = _workData[ArmReg::kKindVec];
+  if (!wd.numCycles)
+    return kErrorOk;
+
+  // Initially, pick some clobbered or dirty register.
+  uint32_t workRegs = wd.workRegs;
+  uint32_t regs = workRegs & ~(wd.usedRegs | wd.dstRegs);
+
+  // If that didn't work out pick some register which is not in 'used'.
+  if (!regs) regs = workRegs & ~wd.usedRegs;
+
+  // If that didn't work out pick any other register that is allocable.
+  // This last resort case will, however, result in marking one more
+  // register dirty.
+  if (!regs) regs = wd.archRegs & ~workRegs;
+
+  if (ASMJIT_UNLIKELY(!regs))
+    return DebugUtils::errored(kErrorNoMorePhysRegs);
+
+  uint32_t regMask = Utils::mask(Utils::findFirstBit(regs));
+  wd.workRegs |= regMask;
+  ffi.addDirtyRegs(ArmReg::kKindVec, regMask);
+
+  return kErrorOk;
+}
+
+// ============================================================================
+// [asmjit::ArmInternal - CallConv]
+// ============================================================================
+
+ASMJIT_FAVOR_SIZE Error ArmInternal::initCallConv(CallConv& cc, uint32_t ccId) noexcept {
+  const uint32_t kKindGp  = ArmReg::kKindGp;
+  const uint32_t kKindVec = ArmReg::kKindVec;
+
+  switch (ccId) {
+    case CallConv::kIdArm64:
+      // AAPCS64 - X19..X28 and FP are callee-saved, only the low 64 bits of
+      // V8..V15 are callee-saved.
+      cc.setArchType(ArchInfo::kTypeA64);
+      cc.setFlags(CallConv::kFlagPassFloatsByVec);
+      cc.setNaturalStackAlignment(16);
+      cc.setPassedOrder(kKindGp, 0, 1, 2, 3, 4, 5, 6, 7);
+      cc.setPassedOrder(kKindVec, 0, 1, 2, 3, 4, 5, 6, 7);
+      cc.setPreservedRegs(kKindGp, (Utils::bits(29) & ~Utils::bits(19)) | Utils::mask(ArmGp::kIdFp, ArmGp::kIdSp));
+      cc.setPreservedRegs(kKindVec, Utils::bits(16) & ~Utils::bits(8));
+      break;
+
+    default:
+      // AArch32 calling conventions are not implemented.
+      return DebugUtils::errored(kErrorInvalidArgument);
+  }
+
+  cc.setId(ccId);
+  return kErrorOk;
+}
+
+// ============================================================================
+// [asmjit::ArmInternal - FuncDetail]
+// ============================================================================
+
+ASMJIT_FAVOR_SIZE Error ArmInternal::initFuncDetail(FuncDetail& func, const FuncSignature& sign, uint32_t gpSize) noexcept {
+  ASMJIT_UNUSED(sign);
+
+  const CallConv& cc = func.getCallConv();
+  uint32_t i;
+  uint32_t argCount = func.getArgCount();
+
+  if (func.getRetCount() != 0) {
+    uint32_t typeId = func._rets[0].getTypeId();
+
+    if (TypeId::isInt(typeId)) {
+      uint32_t regType = typeId <= TypeId::kU32 ? ArmReg::kRegGpw : ArmReg::kRegGpx;
+      func._rets[0].assignToReg(regType, 0);
+    }
+    else if (TypeId::isFloat(typeId) || TypeId::isVec(typeId)) {
+      if (ASMJIT_UNLIKELY(TypeId::sizeOf(typeId) > 16))
+        return DebugUtils::errored(kErrorInvalidTypeId);
+      func._rets[0].assignToReg(armVecTypeIdToRegType(typeId), 0);
+    }
+    else {
+      return DebugUtils::errored(kErrorInvalidTypeId);
+    }
+  }
+
+  // Arguments passed by stack start at SP of the caller, there is no return
+  // address on the stack. Each argument occupies at least 8 bytes.
+  uint32_t stackOffset = 0;
+  uint32_t gpzPos = 0;
+  uint32_t vecPos = 0;
+
+  for (i = 0; i < argCount; i++) {
+    FuncDetail::Value& arg = func._args[i];
+    uint32_t typeId = arg.getTypeId();
+
+    if (TypeId::isInt(typeId)) {
+      uint32_t regId = gpzPos < CallConv::kNumRegArgsPerKind ? uint32_t(cc._passedOrder[ArmReg::kKindGp].id[gpzPos]) : uint32_t(Globals::kInvalidRegId);
+      if (regId != 0xFF && regId != Globals::kInvalidRegId) {
+        uint32_t regType = typeId <= TypeId::kU32 ? ArmReg::kRegGpw : ArmReg::kRegGpx;
+        arg.assignToReg(regType, regId);
+        func.addUsedRegs(ArmReg::kKindGp, Utils::mask(regId));
+        gpzPos++;
+      }
+      else {
+        arg.assignToStack(stackOffset);
+        stackOffset += gpSize;
+      }
+      continue;
+    }
+
+    if (TypeId::isFloat(typeId) || TypeId::isVec(typeId)) {
+      uint32_t size = TypeId::sizeOf(typeId);
+      if (ASMJIT_UNLIKELY(size > 16))
+        return DebugUtils::errored(kErrorInvalidTypeId);
+
+      uint32_t regId = vecPos < CallConv::kNumRegArgsPerKind ? uint32_t(cc._passedOrder[ArmReg::kKindVec].id[vecPos]) : uint32_t(Globals::kInvalidRegId);
+      if (regId != 0xFF && regId != Globals::kInvalidRegId) {
+        arg.initReg(typeId, armVecTypeIdToRegType(typeId), regId);
+        func.addUsedRegs(ArmReg::kKindVec, Utils::mask(regId));
+        vecPos++;
+      }
+      else {
+        size = std::max<uint32_t>(size, gpSize);
+        stackOffset = Utils::alignTo(stackOffset, size);
+        arg.assignToStack(stackOffset);
+        stackOffset += size;
+      }
+      continue;
+    }
+
+    return DebugUtils::errored(kErrorInvalidTypeId);
+  }
+
+  func._argStackSize = Utils::alignTo<uint32_t>(stackOffset, 16);
+  return kErrorOk;
+}
+
+// ============================================================================
+// [asmjit::ArmInternal - FrameLayout]
+// ============================================================================
+
+ASMJIT_FAVOR_SIZE Error ArmInternal::initFrameLayout(FuncFrameLayout& layout, const FuncDetail& func, const FuncFrameInfo& ffi) noexcept {
+  layout.reset();
+
+  uint32_t kind;
+  uint32_t gpSize = 8;
+
+  // Calculate a bit-mask of all registers that must be saved & restored.
+  for (kind = 0; kind < Globals::kMaxVRegKinds; kind++)
+    layout._savedRegs[kind] = (ffi.getDirtyRegs(kind) & ~func.getPassedRegs(kind)) & func.getPreservedRegs(kind);
+
+  // FP and LR are saved together as a frame record, which is required if the
+  // function preserves the frame-pointer or calls other functions (LR).
+  uint32_t& gpSaved = layout._savedRegs[ArmReg::kKindGp];
+  gpSaved &= ~Utils::mask(ArmGp::kIdFp, ArmGp::kIdLr, ArmGp::kIdSp);
+
+  if (ffi.hasPreservedFP())
+    layout._preservedFP = true;
+
+  if (ffi.hasPreservedFP() || ffi.hasCalls() || (ffi.getDirtyRegs(ArmReg::kKindGp) & Utils::mask(ArmGp::kIdFp, ArmGp::kIdLr)))
+    gpSaved |= Utils::mask(ArmGp::kIdFp, ArmGp::kIdLr);
+
+  // Calculate the final stack alignment, SP must be always aligned to 16
+  // bytes and there is no dynamic stack alignment.
+  uint32_t stackAlignment =
+    std::max<uint32_t>(
+      std::max<uint32_t>(
+        ffi.getStackFrameAlignment(),
+        ffi.getCallFrameAlignment()),
+      func.getCallConv().getNaturalStackAlignment());
+
+  if (ASMJIT_UNLIKELY(stackAlignment > 16))
+    return DebugUtils::errored(kErrorInvalidArgument);
+  layout._stackAlignment = static_cast<uint8_t>(stackAlignment);
+
+  // Arguments passed by stack are always accessed through SP.
+  layout._stackBaseRegId = ArmGp::kIdSp;
+  layout._stackArgsRegId = ArmGp::kIdSp;
+
+  // Saved registers are stored in pairs by `stp`, a pair occupies 16 bytes.
+  // VEC registers are saved as D registers (AAPCS64 only preserves 64 bits).
+  layout._gpStackSize  = static_cast<uint16_t>(Utils::alignTo<uint32_t>(Utils::bitCount(gpSaved) * gpSize, 16));
+  layout._vecStackSize = static_cast<uint16_t>(Utils::alignTo<uint32_t>(Utils::bitCount(layout.getSavedRegs(ArmReg::kKindVec)) * 8, 16));
+
+  uint32_t v = 0;                        // The beginning of the stack frame, aligned to CallFrame alignment.
+  v += ffi._callFrameSize;               // Count '_callFrameSize'  <- This is used to call functions.
+  v  = Utils::alignTo(v, stackAlignment);// Align to function's SA
+
+  layout._stackBaseOffset = v;           // Store '_stackBaseOffset'<- Function's own stack starts here..
+  v += ffi._stackFrameSize;              // Count '_stackFrameSize' <- Function's own stack ends here.
+  v  = Utils::alignTo(v, 16);            // SP must be 16-byte aligned.
+
+  layout._stackAdjustment = v;           // Store '_stackAdjustment'<- SA used by 'sub sp, sp, SA' and 'add sp, sp, SA'.
+  layout._vecStackOffset = v;            // Store '_vecStackOffset' <- Functions VEC Save|Restore starts here.
+  v += layout._vecStackSize;             // Count '_vecStackSize'   <- Functions VEC Save|Restore ends here.
+
+  layout._gpStackOffset = v;             // Store '_gpStackOffset'  <- Functions GP Save|Restore starts here.
+  v += layout._gpStackSize;              // Count '_gpStackSize'    <- Functions GP Save|Restore ends here.
+
+  layout._stackArgsOffset = v;           // Store '_stackArgsOffset'<- Arguments passed by stack start here.
+  layout._stackSize = v;
+
+  return kErrorOk;
+}
+
+// ============================================================================
+// [asmjit::ArmInternal - ArgsToFrameInfo]
+// ============================================================================
+
+ASMJIT_FAVOR_SIZE Error ArmInternal::argsToFrameInfo(const FuncArgsMapper& args, FuncFrameInfo& ffi) noexcept {
+  ArmFuncArgsContext ctx;
+  ASMJIT_PROPAGATE(ctx.initWorkData(args, ffi._dirtyRegs));
+
+  ASMJIT_PROPAGATE(ctx.markDstRegsDirty(ffi));
+  ASMJIT_PROPAGATE(ctx.markRegsForCycles(ffi));
+  return kErrorOk;
+}
+
+// ============================================================================
+// [asmjit::ArmInternal - Emit Helpers]
+// ============================================================================
+
+ASMJIT_FAVOR_SIZE Error ArmInternal::emitMovImm(ArmEmitter* emitter, const ArmGp& dst, uint64_t imm) {
+  uint32_t width = dst.isGpX() ? 64 : 32;
+  uint32_t count = width / 16;
+
+  if (width == 32)
+    imm &= 0xFFFFFFFFU;
+
+  // Count halfwords that are not zero and that are not all ones.
+  uint32_t nonZero = 0;
+  uint32_t nonOnes = 0;
+
+  for (uint32_t i = 0; i < count; i++) {
+    uint32_t hw = static_cast<uint32_t>(imm >> (i * 16)) & 0xFFFFU;
+    nonZero += hw != 0;
+    nonOnes += hw != 0xFFFFU;
+  }
+
+  // `mov` handles MOVZ, MOVN, and ORR (logical immediate) forms.
+  uint32_t logicalImm;
+  if (nonZero <= 1 || nonOnes <= 1 || ArmAssembler::encodeLogicalImm(imm, width, logicalImm))
+    return emitter->mov(dst, imm);
+
+  // MOVZ|MOVN of the first halfword followed by MOVK of the others, MOVN is
+  // used if there is more all ones halfwords than zero ones.
+  bool useMovn = nonOnes < nonZero;
+  uint32_t skip = useMovn ? 0xFFFFU : 0x0000U;
+  bool first = true;
+
+  for (uint32_t i = 0; i < count; i++) {
+    uint32_t hw = static_cast<uint32_t>(imm >> (i * 16)) & 0xFFFFU;
+    if (hw == skip)
+      continue;
+
+    if (first) {
+      if (useMovn)
+        ASMJIT_PROPAGATE(emitter->movn(dst, Imm(hw ^ 0xFFFFU), Imm(i * 16)));
+      else
+        ASMJIT_PROPAGATE(emitter->movz(dst, Imm(hw), Imm(i * 16)));
+      first = false;
+    }
+    else {
+      ASMJIT_PROPAGATE(emitter->movk(dst, Imm(hw), Imm(i * 16)));
+    }
+  }
+
+  return kErrorOk;
+}
+
+ASMJIT_FAVOR_SIZE Error ArmInternal::emitAddImm(ArmEmitter* emitter, const ArmGp& dst, const ArmGp& src, int64_t imm) {
+  if (imm == 0) {
+    if (dst == src)
+      return kErrorOk;
+    return emitter->mov(dst, src);
+  }
+
+  uint32_t instId = imm < 0 ? ArmInst::kIdSub : ArmInst::kIdAdd;
+  uint64_t u = imm < 0 ? uint64_t(0) - static_cast<uint64_t>(imm) : static_cast<uint64_t>(imm);
+
+  // Single instruction, 12-bit immediate, optionally shifted by 12.
+  if (u <= 0xFFFU || (u <= 0xFFF000U && (u & 0xFFFU) == 0))
+    return emitter->emit(instId, dst, src, Imm(static_cast<int64_t>(u)));
+
+  // Two instructions, 24-bit immediate split into two 12-bit parts.
+  if (u <= 0xFFFFFFU) {
+    ASMJIT_PROPAGATE(emitter->emit(instId, dst, src, Imm(static_cast<int64_t>(u & 0xFFF000U))));
+    return emitter->emit(instId, dst, dst, Imm(static_cast<int64_t>(u & 0xFFFU)));
+  }
+
+  // Use IP0 as a scratch register.
+  ArmGp ip0 = ArmGp::fromTypeAndId(dst.getType(), ArmGp::kIdIp0);
+  ASMJIT_PROPAGATE(emitMovImm(emitter, ip0, u));
+  return emitter->emit(instId, dst, src, ip0);
+}
+
+ASMJIT_FAVOR_SIZE Error ArmInternal::emitRegMove(ArmEmitter* emitter,
+  const Operand_& dst_,
+  const Operand_& src_, uint32_t typeId, const char* comment) {
+
+  // Invalid or abstract TypeIds are not allowed.
+  ASMJIT_ASSERT(TypeId::isValid(typeId) && !TypeId::isAbstract(typeId));
+
+  Operand dst(dst_);
+  Operand src(src_);
+
+  uint32_t instId = Inst::kIdNone;
+  uint32_t size = TypeId::sizeOf(typeId);
+
+  // Register operand determines the instruction, the other one is either
+  // a register of the same type or a memory location (load or store).
+  Operand& reg = dst.isReg() ? dst : src;
+  if (!reg.isReg() || (dst.isMem() && src.isMem()))
+    return DebugUtils::errored(kErrorInvalidState);
+
+  if (TypeId::isInt(typeId)) {
+    // Use 32-bit registers for anything smaller than 64 bits, it doesn't
+    // have dependencies on the upper half.
+    reg.setSignature(size <= 4 ? ArmReg::signatureOfT<ArmReg::kRegGpw>()
+                               : ArmReg::signatureOfT<ArmReg::kRegGpx>());
+
+    if (dst.isMem())
+      instId = size == 1 ? ArmInst::kIdStrb : size == 2 ? ArmInst::kIdStrh : ArmInst::kIdStr;
+    else if (src.isMem())
+      instId = size == 1 ? ArmInst::kIdLdrb : size == 2 ? ArmInst::kIdLdrh : ArmInst::kIdLdr;
+    else {
+      src.setSignature(dst.getSignature());
+      instId = ArmInst::kIdMov;
+    }
+  }
+  else if (TypeId::isFloat(typeId) || TypeId::isVec(typeId)) {
+    if (ASMJIT_UNLIKELY(size > 16))
+      return DebugUtils::errored(kErrorInvalidState);
+
+    reg.setSignature(ArmReg::signatureOf(armVecTypeIdToRegType(typeId)));
+    if (dst.isMem())
+      instId = ArmInst::kIdStr;
+    else if (src.isMem())
+      instId = ArmInst::kIdLdr;
+    else {
+      src.setSignature(dst.getSignature());
+      instId = size <= 8 ? ArmInst::kIdFmov : ArmInst::kIdMov;
+    }
+  }
+
+  if (!instId)
+    return DebugUtils::errored(kErrorInvalidState);
+
+  // Stores take the source register first.
+  emitter->setInlineComment(comment);
+  if (dst.isMem())
+    return emitter->emit(instId, src, dst);
+  else
+    return emitter->emit(instId, dst, src);
+}
+
+ASMJIT_FAVOR_SIZE Error ArmInternal::emitArgMove(ArmEmitter* emitter,
+  const ArmReg& dst_, uint32_t dstTypeId,
+  const Operand_& src_, uint32_t srcTypeId, const char* comment) {
+
+  // Deduce optional `dstTypeId`, which may be `TypeId::kVoid` in some cases.
+  if (!dstTypeId) dstTypeId = armOpData.archRegs.regTypeToTypeId[dst_.getType()];
+
+  // Invalid or abstract TypeIds are not allowed.
+  ASMJIT_ASSERT(TypeId::isValid(dstTypeId) && !TypeId::isAbstract(dstTypeId));
+  ASMJIT_ASSERT(TypeId::isValid(srcTypeId) && !TypeId::isAbstract(srcTypeId));
+
+  ArmReg dst(dst_);
+  Operand src(src_);
+
+  uint32_t dstSize = TypeId::sizeOf(dstTypeId);
+  uint32_t srcSize = TypeId::sizeOf(srcTypeId);
+
+  const uint32_t kSgnW = ArmReg::signatureOfT<ArmReg::kRegGpw>();
+  const uint32_t kSgnX = ArmReg::signatureOfT<ArmReg::kRegGpx>();
+
+  uint32_t instId = Inst::kIdNone;
+  emitter->setInlineComment(comment);
+
+  if (TypeId::isInt(dstTypeId)) {
+    if (src.isMem()) {
+      // Sign extending loads of signed types, zero extending loads otherwise.
+      bool isSigned = srcTypeId == TypeId::kI8 || srcTypeId == TypeId::kI16 || srcTypeId == TypeId::kI32;
+      dst.setSignature(dstSize > 4 && (isSigned || srcSize > 4) ? kSgnX : kSgnW);
+
+      switch (srcSize) {
+        case 1 : instId = isSigned ? ArmInst::kIdLdrsb : ArmInst::kIdLdrb; break;
+        case 2 : instId = isSigned ? ArmInst::kIdLdrsh : ArmInst::kIdLdrh; break;
+        case 4 : instId = isSigned && dstSize > 4 ? ArmInst::kIdLdrsw : ArmInst::kIdLdr; break;
+        default: instId = ArmInst::kIdLdr; break;
+      }
+      return emitter->emit(instId, dst, src);
+    }
+
+    if (TypeId::isInt(srcTypeId)) {
+      uint32_t typeOp = (dstSize > 4 ? 0x100U : 0U) | srcTypeId;
+
+      switch (typeOp) {
+        case 0x000U | TypeId::kI8 : instId = ArmInst::kIdSxtb; dst.setSignature(kSgnW); break;
+        case 0x000U | TypeId::kI16: instId = ArmInst::kIdSxth; dst.setSignature(kSgnW); break;
+        case 0x100U | TypeId::kI8 : instId = ArmInst::kIdSxtb; dst.setSignature(kSgnX); break;
+        case 0x100U | TypeId::kI16: instId = ArmInst::kIdSxth; dst.setSignature(kSgnX); break;
+        case 0x100U | TypeId::kI32: instId = ArmInst::kIdSxtw; dst.setSignature(kSgnX); break;
+
+        // Zero extension, writing a W register clears the upper 32 bits.
+        case 0x000U | TypeId::kU8 :
+        case 0x100U | TypeId::kU8 : instId = ArmInst::kIdUxtb; dst.setSignature(kSgnW); break;
+        case 0x000U | TypeId::kU16:
+        case 0x100U | TypeId::kU16: instId = ArmInst::kIdUxth; dst.setSignature(kSgnW); break;
+
+        default:
+          instId = ArmInst::kIdMov;
+          dst.setSignature(std::min(srcSize, dstSize) <= 4 ? kSgnW : kSgnX);
+          src.setSignature(dst.getSignature());
+          return emitter->emit(instId, dst, src);
+      }
+
+      src.setSignature(kSgnW);
+      return emitter->emit(instId, dst, src);
+    }
+
+    if (TypeId::isFloat(srcTypeId) || TypeId::isVec(srcTypeId)) {
+      // Bit-cast from a VEC register, only 32-bit and 64-bit moves exist.
+      uint32_t size = std::min(srcSize, dstSize) <= 4 ? 4 : 8;
+      dst.setSignature(size == 4 ? kSgnW : kSgnX);
+      src.setSignature(ArmReg::signatureOf(size == 4 ? ArmReg::kRegVecS : ArmReg::kRegVecD));
+      return emitter->emit(ArmInst::kIdFmov, dst, src);
+    }
+
+    return DebugUtils::errored(kErrorInvalidState);
+  }
+
+  if (TypeId::isFloat(dstTypeId) || TypeId::isVec(dstTypeId)) {
+    uint32_t dstElement = TypeId::elementOf(dstTypeId);
+    uint32_t srcElement = TypeId::elementOf(srcTypeId);
+
+    // Scalar conversion between F32 and F64, load to the destination first
+    // if the source is in memory.
+    bool cvt = srcSize <= 8 && dstSize <= 8 &&
+               ((dstElement == TypeId::kF32 && srcElement == TypeId::kF64) ||
+                (dstElement == TypeId::kF64 && srcElement == TypeId::kF32));
+
+    if (cvt) {
+      uint32_t srcRegType = srcElement == TypeId::kF32 ? ArmReg::kRegVecS : ArmReg::kRegVecD;
+      uint32_t dstRegType = dstElement == TypeId::kF32 ? ArmReg::kRegVecS : ArmReg::kRegVecD;
+
+      if (src.isMem()) {
+        ArmReg tmp = ArmReg::fromTypeAndId(srcRegType, dst.getId());
+        ASMJIT_PROPAGATE(emitter->emit(ArmInst::kIdLdr, tmp, src));
+        src = tmp;
+      }
+      else {
+        src.setSignature(ArmReg::signatureOf(srcRegType));
+      }
+
+      dst.setSignature(ArmReg::signatureOf(dstRegType));
+      return emitter->emit(ArmInst::kIdFcvt, dst, src);
+    }
+
+    uint32_t size = std::min(srcSize, dstSize);
+    if (src.isMem()) {
+      dst.setSignature(ArmReg::signatureOf(size <= 4 ? ArmReg::kRegVecS : size <= 8 ? ArmReg::kRegVecD : ArmReg::kRegVecV));
+      return emitter->emit(ArmInst::kIdLdr, dst, src);
+    }
+
+    if (Reg::isGp(src)) {
+      // Bit-cast from a GP register.
+      size = size <= 4 ? 4 : 8;
+      dst.setSignature(ArmReg::signatureOf(size == 4 ? ArmReg::kRegVecS : ArmReg::kRegVecD));
+      src.setSignature(size == 4 ? kSgnW : kSgnX);
+      return emitter->emit(ArmInst::kIdFmov, dst, src);
+    }
+
+    if (Reg::isVec(src)) {
+      uint32_t sign = ArmReg::signatureOf(size <= 4 ? ArmReg::kRegVecS : size <= 8 ? ArmReg::kRegVecD : ArmReg::kRegVecV);
+      dst.setSignature(sign);
+      src.setSignature(sign);
+      return emitter->emit(size <= 8 ? ArmInst::kIdFmov : ArmInst::kIdMov, dst, src);
+    }
+  }
+
+  return DebugUtils::errored(kErrorInvalidState);
+}
+
+// ============================================================================
+// [asmjit::ArmInternal - Emit Prolog & Epilog]
+// ============================================================================
+
+ASMJIT_FAVOR_SIZE Error ArmInternal::emitProlog(ArmEmitter* emitter, const FuncFrameLayout& layout) {
+  uint32_t i, n;
+  uint8_t ids[32];
+
+  ArmGp sp = emitter->gpzRef(ArmGp::kIdSp);
+  ArmMem push = arm::ptr_pre(sp, -16);
+
+  uint32_t gpSaved = layout.getSavedRegs(ArmReg::kKindGp);
+  const uint32_t kFrameRecord = Utils::mask(ArmGp::kIdFp, ArmGp::kIdLr);
+
+  // Emit: 'stp x29, x30, [sp, #-16]!'
+  //       'mov x29, sp'.
+  if ((gpSaved & kFrameRecord) == kFrameRecord) {
+    gpSaved &= ~kFrameRecord;
+    ASMJIT_PROPAGATE(emitter->stp(arm::x29, arm::x30, push));
+    if (layout.hasPreservedFP())
+      ASMJIT_PROPAGATE(emitter->mov(arm::x29, sp));
+  }
+
+  // Emit: 'stp gp0, gp1, [sp, #-16]!' sequence.
+  n = armRegMaskToIds(gpSaved, ids);
+  for (i = 0; i < n; i += 2) {
+    if (i + 1 < n)
+      ASMJIT_PROPAGATE(emitter->stp(ArmGpX(ids[i]), ArmGpX(ids[i + 1]), push));
+    else
+      ASMJIT_PROPAGATE(emitter->str(ArmGpX(ids[i]), push));
+  }
+
+  // Emit: 'stp d0, d1, [sp, #-16]!' sequence.
+  n = armRegMaskToIds(layout.getSavedRegs(ArmReg::kKindVec), ids);
+  for (i = 0; i < n; i += 2) {
+    if (i + 1 < n)
+      ASMJIT_PROPAGATE(emitter->stp(ArmVecD(ids[i]), ArmVecD(ids[i + 1]), push));
+    else
+      ASMJIT_PROPAGATE(emitter->str(ArmVecD(ids[i]), push));
+  }
+
+  // Emit: 'sub sp, sp, StackAdjustment'.
+  if (layout.hasStackAdjustment())
+    ASMJIT_PROPAGATE(emitAddImm(emitter, sp, sp, -static_cast<int64_t>(layout.getStackAdjustment())));
+
+  return kErrorOk;
+}
+
+ASMJIT_FAVOR_SIZE Error ArmInternal::emitEpilog(ArmEmitter* emitter, const FuncFrameLayout& layout, bool tailCall) {
+  uint32_t i, n;
+  uint8_t ids[32];
+
+  ArmGp sp = emitter->gpzRef(ArmGp::kIdSp);
+  ArmMem pop = arm::ptr_post(sp, 16);
+
+  uint32_t gpSaved = layout.getSavedRegs(ArmReg::kKindGp);
+  const uint32_t kFrameRecord = Utils::mask(ArmGp::kIdFp, ArmGp::kIdLr);
+
+  // Emit: 'add sp, sp, StackAdjustment'.
+  if (layout.hasStackAdjustment())
+    ASMJIT_PROPAGATE(emitAddImm(emitter, sp, sp, static_cast<int64_t>(layout.getStackAdjustment())));
+
+  // Emit: 'ldp d0, d1, [sp], #16' sequence, in reverse order of the prolog.
+  n = armRegMaskToIds(layout.getSavedRegs(ArmReg::kKindVec), ids);
+  for (i = (n + 1) & ~1U; i; ) {
+    i -= 2;
+    if (i + 1 < n)
+      ASMJIT_PROPAGATE(emitter->ldp(ArmVecD(ids[i]), ArmVecD(ids[i + 1]), pop));
+    else
+      ASMJIT_PROPAGATE(emitter->ldr(ArmVecD(ids[i]), pop));
+  }
+
+  // Emit: 'ldp gp0, gp1, [sp], #16' sequence.
+  n = armRegMaskToIds(gpSaved & ~kFrameRecord, ids);
+  for (i = (n + 1) & ~1U; i; ) {
+    i -= 2;
+    if (i + 1 < n)
+      ASMJIT_PROPAGATE(emitter->ldp(ArmGpX(ids[i]), ArmGpX(ids[i + 1]), pop));
+    else
+      ASMJIT_PROPAGATE(emitter->ldr(ArmGpX(ids[i]), pop));
+  }
+
+  // Emit: 'ldp x29, x30, [sp], #16'.
+  if ((gpSaved & kFrameRecord) == kFrameRecord)
+    ASMJIT_PROPAGATE(emitter->ldp(arm::x29, arm::x30, pop));
+
+  // Tail call jumps to the callee instead of 'ret'.
+  if (tailCall)
+    return kErrorOk;
+
+  return emitter->ret();
+}
+
+// ============================================================================
+// [asmjit::ArmInternal - AllocArgs]
+// ============================================================================
+
+ASMJIT_FAVOR_SIZE Error ArmInternal::allocArgs(ArmEmitter* emitter, const FuncFrameLayout& layout, const FuncArgsMapper& args) {
+  typedef ArmFuncArgsContext::SrcArg SrcArg;
+  typedef ArmFuncArgsContext::DstArg DstArg;
+  typedef ArmFuncArgsContext::WorkData WorkData;
+  enum { kMaxVRegKinds = Globals::kMaxVRegKinds };
+
+  uint32_t i;
+  const FuncDetail& func = *args.getFuncDetail();
+
+  ArmFuncArgsContext ctx;
+  ASMJIT_PROPAGATE(ctx.initWorkData(args, layout._savedRegs));
+
+  // Free registers that can be used as temporaries and during shuffling,
+  // see `X86Internal::allocArgs()`, which uses the same algorithm.
+  uint32_t freeRegs[kMaxVRegKinds];
+  for (i = 0; i < kMaxVRegKinds; i++)
+    freeRegs[i] = ctx._workData[i].workRegs & ~ctx._workData[i].srcRegs;
+
+  // Current source register of each argument passed by register. It changes
+  // when a cycle is broken and the source is moved to a different register.
+  uint8_t srcRegIds[kFuncArgCountLoHi];
+  for (i = 0; i < kFuncArgCountLoHi; i++)
+    srcRegIds[i] = static_cast<uint8_t>(func.getArg(i).getRegId());
+
+  // Register-to-register moves form a parallel copy. Each iteration emits
+  // all moves that have their destination free, which in turn frees their
+  // sources. When nothing can be moved only cycles remain - one register of
+  // a cycle is moved to a temporary register (IP0 in case of GP registers)
+  // and the iteration continues.
+  for (;;) {
+    bool hasWork = false; // Do we have a work to do?
+    bool didWork = false; // If we did something...
+
+    uint32_t dstRegKind = kMaxVRegKinds;
+    do {
+      WorkData& wd = ctx._workData[--dstRegKind];
+      if (wd.numOps > wd.numStackArgs) {
+        hasWork = true;
+
+        uint32_t regsToDo = wd.dstRegs;
+        do {
+          ASMJIT_ASSERT(regsToDo != 0);
+          uint32_t dstRegId = Utils::findFirstBit(regsToDo);
+          uint32_t dstRegMask = Utils::mask(dstRegId);
+
+          uint32_t argIndex = wd.argIndex[dstRegId];
+          const DstArg& dstArg = args.getArg(argIndex);
+          const SrcArg& srcArg = func.getArg(argIndex);
+
+          if (srcArg.byReg() && (freeRegs[dstRegKind] & dstRegMask)) {
+            uint32_t srcRegType = srcArg.getRegType();
+            uint32_t srcRegKind = ArmReg::kindOf(srcRegType);
+            uint32_t srcRegId = srcRegIds[argIndex];
+
+            ArmReg dstReg(ArmReg::fromTypeAndId(dstArg.getRegType(), dstRegId));
+            ArmReg srcReg(ArmReg::fromTypeAndId(srcRegType, srcRegId));
+
+            ASMJIT_PROPAGATE(
+              emitArgMove(emitter,
+                dstReg, dstArg.getTypeId(),
+                srcReg, srcArg.getTypeId()));
+            freeRegs[dstRegKind] ^= dstRegMask;            // Make the DST reg occupied.
+            freeRegs[srcRegKind] |= Utils::mask(srcRegId); // Make the SRC reg free.
+
+            ASMJIT_ASSERT(wd.numOps >= 1);
+            wd.dstRegs ^= dstRegMask;
+            wd.numOps--;
+            didWork = true;
+          }
+
+          regsToDo ^= dstRegMask;
+        } while (regsToDo);
+      }
+    } while (dstRegKind);
+
+    if (!hasWork)
+      break;
+
+    if (didWork)
+      continue;
+
+    // Only cycles remain, move the source of one pending argument away.
+    dstRegKind = kMaxVRegKinds;
+    do {
+      WorkData& wd = ctx._workData[--dstRegKind];
+      if (wd.numOps <= wd.numStackArgs)
+        continue;
+
+      uint32_t regsToDo = wd.dstRegs;
+      while (regsToDo) {
+        uint32_t dstRegId = Utils::findFirstBit(regsToDo);
+        uint32_t dstRegMask = Utils::mask(dstRegId);
+        regsToDo ^= dstRegMask;
+
+        // Find the pending argument that uses `dstRegId` as its source.
+        uint32_t otherIndex = kFuncArgCountLoHi;
+        for (i = 0; i < kFuncArgCountLoHi; i++) {
+          const SrcArg& otherSrc = func.getArg(i);
+          const DstArg& otherDst = args.getArg(i);
+
+          if (!otherDst.isAssigned() || !otherSrc.byReg() || srcRegIds[i] != dstRegId ||
+              ArmReg::kindOf(otherSrc.getRegType()) != dstRegKind)
+            continue;
+
+          uint32_t otherKind = ArmReg::kindOf(otherDst.getRegType());
+          if (ctx._workData[otherKind].dstRegs & Utils::mask(otherDst.getRegId())) {
+            otherIndex = i;
+            break;
+          }
+        }
+
+        if (otherIndex == kFuncArgCountLoHi)
+          continue;
+
+        // Prefer registers not used by arguments, but a register that will
+        // be loaded from stack later is fine as well. IP0 is the last resort
+        // of GP registers, it's never allocated.
+        uint32_t tmpRegs = freeRegs[dstRegKind] & wd.workRegs & ~wd.usedRegs;
+        if (!tmpRegs)
+          tmpRegs = freeRegs[dstRegKind] & wd.workRegs & wd.dstRegs;
+        if (!tmpRegs && dstRegKind == ArmReg::kKindGp)
+          tmpRegs = Utils::mask(ArmGp::kIdIp0);
+
+        if (!tmpRegs)
+          continue;
+
+        // Move the whole register so no bits of the other argument are lost.
+        const SrcArg& otherSrc = func.getArg(otherIndex);
+        uint32_t tmpRegId = Utils::findFirstBit(tmpRegs);
+        uint32_t moveTypeId = dstRegKind == ArmReg::kKindGp ? TypeId::kI64 : TypeId::kI32x4;
+
+        ArmReg tmpReg(ArmReg::fromTypeAndId(otherSrc.getRegType(), tmpRegId));
+        ArmReg srcReg(ArmReg::fromTypeAndId(otherSrc.getRegType(), dstRegId));
+
+        ASMJIT_PROPAGATE(emitRegMove(emitter, tmpReg, srcReg, moveTypeId));
+        freeRegs[dstRegKind] = (freeRegs[dstRegKind] & ~Utils::mask(tmpRegId)) | dstRegMask;
+        srcRegIds[otherIndex] = static_cast<uint8_t>(tmpRegId);
+
+        didWork = true;
+        break;
+      }
+    } while (!didWork && dstRegKind);
+
+    if (!didWork)
+      return DebugUtils::errored(kErrorInvalidState);
+  }
+
+  // Load arguments passed by stack into registers.
+  if (ctx._hasStackArgs) {
+    ArmMem saBase = arm::ptr(emitter->gpzRef(layout.getStackArgsRegId()), static_cast<int32_t>(layout.getStackArgsOffset()));
+
+    uint32_t dstRegKind = kMaxVRegKinds;
+    do {
+      WorkData& wd = ctx._workData[--dstRegKind];
+      if (wd.numStackArgs) {
+        uint32_t regsToDo = wd.dstRegs;
+        do {
+          ASMJIT_ASSERT(regsToDo != 0);
+          ASMJIT_ASSERT(wd.numOps > 0);
+
+          uint32_t dstRegId = Utils::findFirstBit(regsToDo);
+          uint32_t dstRegMask = Utils::mask(dstRegId);
+
+          uint32_t argIndex = wd.argIndex[dstRegId];
+          const DstArg& dstArg = args.getArg(argIndex);
+          const SrcArg& srcArg = func.getArg(argIndex);
+
+          if (!srcArg.byStack() || !(freeRegs[dstRegKind] & dstRegMask))
+            return DebugUtils::errored(kErrorInvalidState);
+
+          ArmReg dstReg = ArmReg::fromTypeAndId(dstArg.getRegType(), dstRegId);
+          ArmMem srcMem = saBase.adjusted(srcArg.getStackOffset());
+
+          ASMJIT_PROPAGATE(
+            emitArgMove(emitter,
+              dstReg, dstArg.getTypeId(),
+              srcMem, srcArg.getTypeId()));
+
+          freeRegs[dstRegKind] ^= dstRegMask;
+          regsToDo ^= dstRegMask;
+          wd.numOps--;
+        } while (regsToDo);
+      }
+    } while (dstRegKind);
+  }
+
+  return kErrorOk;
+}
+
+// ============================================================================
+// [asmjit::ArmInternal - PatchRel]
+// ============================================================================
+
+Error ArmInternal::patchRel(uint8_t* p, intptr_t disp) noexcept {
+  uint32_t w = Utils::readU32uLE(p);
+
+  if ((w & 0x9F000000U) == 0x10000000U) {
+    // ADR - 21-bit byte displacement split to immlo (29..30) and immhi (5..23).
+    if (!Utils::isIntN<21>(disp))
+      return DebugUtils::errored(kErrorInvalidDisplacement);
+
+    uint32_t imm = static_cast<uint32_t>(disp) & 0x1FFFFFU;
+    w = (w & 0x9F00001FU) | ((imm & 0x3U) << 29) | ((imm >> 2) << 5);
+  }
+  else {
+    // All other displacements are in words.
+    if ((disp & 0x3) != 0)
+      return DebugUtils::errored(kErrorInvalidDisplacement);
+
+    intptr_t imm = disp >> 2;
+    if ((w & 0x7C000000U) == 0x14000000U) {
+      // B and BL - 26-bit displacement.
+      if (!Utils::isIntN<26>(imm))
+        return DebugUtils::errored(kErrorInvalidDisplacement);
+      w = (w & 0xFC000000U) | (static_cast<uint32_t>(imm) & 0x03FFFFFFU);
+    }
+    else if ((w & 0x7E000000U) == 0x36000000U) {
+      // TBZ and TBNZ - 14-bit displacement.
+      if (!Utils::isIntN<14>(imm))
+        return DebugUtils::errored(kErrorInvalidDisplacement);
+      w = (w & 0xFFF8001FU) | ((static_cast<uint32_t>(imm) & 0x3FFFU) << 5);
+    }
+    else if ((w & 0xFF000010U) == 0x54000000U ||
+             (w & 0x7E000000U) == 0x34000000U ||
+             (w & 0x3B000000U) == 0x18000000U) {
+      // B.cond, CBZ, CBNZ, and LDR (literal) - 19-bit displacement.
+      if (!Utils::isIntN<19>(imm))
+        return DebugUtils::errored(kErrorInvalidDisplacement);
+      w = (w & 0xFF00001FU) | ((static_cast<uint32_t>(imm) & 0x7FFFFU) << 5);
+    }
+    else {
+      return DebugUtils::errored(kErrorInvalidDisplacement);
+    }
+  }
+
+  Utils::writeU32uLE(p, w);
+  return kErrorOk;
+}
+
+} // asmjit namespace
+
+// [Api-End]
+#include "../asmjit_apiend.h"
+
+// [Guard]
+#endif // ASMJIT_BUILD_ARM
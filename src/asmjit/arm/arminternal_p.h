@@ -0,0 +1,92 @@
+// [AsmJit]
+// Complete x86/x64 JIT and Remote Assembler for C++.
+//
+// [License]
+// Zlib - See LICENSE.md file in the package.
+
+// [Guard]
+#ifndef _ASMJIT_ARM_ARMINTERNAL_P_H
+#define _ASMJIT_ARM_ARMINTERNAL_P_H
+
+#include "../asmjit_build.h"
+
+// [Dependencies]
+#include "../base/func.h"
+#include "../arm/armemitter.h"
+#include "../arm/armoperand.h"
+
+// [Api-Begin]
+#include "../asmjit_apibegin.h"
+
+namespace asmjit {
+
+//! \addtogroup asmjit_base
+//! \{
+
+// ============================================================================
+// [asmjit::ArmInternal]
+// ============================================================================
+
+//! \internal
+//!
+//! ARM utilities used at multiple places, not part of public API, not exported.
+struct ArmInternal {
+  //! Initialize `CallConv` to ARM specific calling convention.
+  static Error initCallConv(CallConv& cc, uint32_t ccId) noexcept;
+
+  //! Initialize `FuncDetail` to ARM specific function signature.
+  static Error initFuncDetail(FuncDetail& func, const FuncSignature& sign, uint32_t gpSize) noexcept;
+
+  //! Initialize `FuncFrameLayout` from ARM specific function detail and frame information.
+  static Error initFrameLayout(FuncFrameLayout& layout, const FuncDetail& func, const FuncFrameInfo& ffi) noexcept;
+
+  static Error argsToFrameInfo(const FuncArgsMapper& args, FuncFrameInfo& ffi) noexcept;
+
+  //! Emit function prolog.
+  static Error emitProlog(ArmEmitter* emitter, const FuncFrameLayout& layout);
+
+  //! Emit function epilog, without the final `ret` if `tailCall` is true.
+  static Error emitEpilog(ArmEmitter* emitter, const FuncFrameLayout& layout, bool tailCall = false);
+
+  //! Emit a pure move operation between two registers or the same type or
+  //! between a register and its home slot. This function does not handle
+  //! register conversion.
+  static Error emitRegMove(ArmEmitter* emitter,
+    const Operand_& dst_,
+    const Operand_& src_, uint32_t typeId, const char* comment = nullptr);
+
+  //! Emit move from a function argument (either register or stack) to a register.
+  //!
+  //! This function can handle the necessary conversion from one argument to
+  //! another, and from one register type to another, if it's possible.
+  static Error emitArgMove(ArmEmitter* emitter,
+    const ArmReg& dst_, uint32_t dstTypeId,
+    const Operand_& src_, uint32_t srcTypeId, const char* comment = nullptr);
+
+  //! Emit `mov` of any 64-bit immediate `imm` to a GP register `dst`, uses
+  //! a sequence of `movz|movn` and `movk` if `imm` can't be encoded by one
+  //! instruction.
+  static Error emitMovImm(ArmEmitter* emitter, const ArmGp& dst, uint64_t imm);
+
+  //! Add `imm` to `src` and store the result to `dst`, a scratch register
+  //! `IP0` is used if `imm` can't be encoded by `add` or `sub`.
+  static Error emitAddImm(ArmEmitter* emitter, const ArmGp& dst, const ArmGp& src, int64_t imm);
+
+  static Error allocArgs(ArmEmitter* emitter, const FuncFrameLayout& layout, const FuncArgsMapper& args);
+
+  //! Patch a PC relative displacement of an A64 instruction at `p`, `disp`
+  //! is in bytes and relative to the instruction itself. The displacement
+  //! field is recognized by the instruction (B, BL, B.cond, CBZ, CBNZ, TBZ,
+  //! TBNZ, ADR, and LDR literal).
+  static Error patchRel(uint8_t* p, intptr_t disp) noexcept;
+};
+
+//! \}
+
+} // asmjit namespace
+
+// [Api-End]
+#include "../asmjit_apiend.h"
+
+// [Guard]
+#endif // _ASMJIT_ARM_ARMINTERNAL_P_H
@@ -0,0 +1,221 @@
+// [AsmJit]
+// Complete x86/x64 JIT and Remote Assembler for C++.
+//
+// [License]
+// Zlib - See LICENSE.md file in the package.
+
+// [Export]
+#define ASMJIT_EXPORTS
+
+// [Guard]
+#include "../asmjit_build.h"
+#if defined(ASMJIT_BUILD_ARM) && !defined(ASMJIT_DISABLE_LOGGING)
+
+// [Dependencies]
+#include "../base/misc_p.h"
+#include "../arm/arminst.h"
+#include "../arm/armlogging_p.h"
+#include "../arm/armoperand.h"
+
+#if !defined(ASMJIT_DISABLE_COMPILER)
+#include "../base/codecompiler.h"
+#endif // !ASMJIT_DISABLE_COMPILER
+
+// [Api-Begin]
+#include "../asmjit_apibegin.h"
+
+namespace asmjit {
+
+// ============================================================================
+// [asmjit::ArmLogging - Format Operand]
+// ============================================================================
+
+ASMJIT_FAVOR_SIZE static Error ArmLogging_formatImm(StringBuilder& sb, uint32_t logOptions, int64_t val) noexcept {
+  ASMJIT_PROPAGATE(sb.appendChar('#'));
+
+  if ((logOptions & Logger::kOptionHexImmediate) != 0 && static_cast<uint64_t>(val) > 9)
+    return sb.appendFormat("0x%llX", static_cast<unsigned long long>(val));
+  else
+    return sb.appendInt(val, 10);
+}
+
+ASMJIT_FAVOR_SIZE Error ArmLogging::formatOperand(
+  StringBuilder& sb,
+  uint32_t logOptions,
+  const CodeEmitter* emitter,
+  uint32_t archType,
+  const Operand_& op) noexcept {
+
+  if (op.isReg())
+    return formatRegister(sb, logOptions, emitter, archType, op.as<Reg>().getType(), op.as<Reg>().getId());
+
+  if (op.isMem()) {
+    const ArmMem& m = op.as<ArmMem>();
+
+    // Literal, the label is the address.
+    if (m.hasBaseLabel())
+      return Logging::formatLabel(sb, logOptions, emitter, m.getBaseId());
+
+    ASMJIT_PROPAGATE(sb.appendChar('['));
+    if (m.isArgHome()) ASMJIT_PROPAGATE(sb.appendString("$"));
+    if (m.isRegHome()) ASMJIT_PROPAGATE(sb.appendString("&"));
+    ASMJIT_PROPAGATE(formatRegister(sb, logOptions, emitter, archType, m.getBaseType(), m.getBaseId()));
+
+    if (m.hasIndex()) {
+      ASMJIT_PROPAGATE(sb.appendString(", "));
+      ASMJIT_PROPAGATE(formatRegister(sb, logOptions, emitter, archType, m.getIndexType(), m.getIndexId()));
+
+      if (m.getIndexType() == ArmReg::kRegGpw)
+        ASMJIT_PROPAGATE(sb.appendString(m.hasShift() ? ", sxtw #" : ", sxtw"));
+      else if (m.hasShift())
+        ASMJIT_PROPAGATE(sb.appendString(", lsl #"));
+
+      if (m.hasShift())
+        ASMJIT_PROPAGATE(sb.appendUInt(m.getShift()));
+      return sb.appendChar(']');
+    }
+
+    int64_t off = m.getOffset();
+    if (m.isPostIndex()) {
+      ASMJIT_PROPAGATE(sb.appendString("], "));
+      return ArmLogging_formatImm(sb, logOptions, off);
+    }
+
+    if (off != 0) {
+      ASMJIT_PROPAGATE(sb.appendString(", "));
+      ASMJIT_PROPAGATE(ArmLogging_formatImm(sb, logOptions, off));
+    }
+
+    ASMJIT_PROPAGATE(sb.appendChar(']'));
+    if (m.isPreIndex())
+      ASMJIT_PROPAGATE(sb.appendChar('!'));
+    return kErrorOk;
+  }
+
+  if (op.isImm())
+    return ArmLogging_formatImm(sb, logOptions, op.as<Imm>().getInt64());
+
+  if (op.isLabel())
+    return Logging::formatLabel(sb, logOptions, emitter, op.getId());
+
+  return sb.appendString("<None>");
+}
+
+// ============================================================================
+// [asmjit::ArmLogging - Format Register]
+// ============================================================================
+
+ASMJIT_FAVOR_SIZE Error ArmLogging::formatRegister(
+  StringBuilder& sb,
+  uint32_t logOptions,
+  const CodeEmitter* emitter,
+  uint32_t archType,
+  uint32_t rType,
+  uint32_t rId) noexcept {
+
+  ASMJIT_UNUSED(logOptions);
+  ASMJIT_UNUSED(archType);
+
+  if (Operand::isPackedId(rId)) {
+#if !defined(ASMJIT_DISABLE_COMPILER)
+    if (emitter && emitter->getType() == CodeEmitter::kTypeCompiler) {
+      const CodeCompiler* cc = static_cast<const CodeCompiler*>(emitter);
+
+      if (cc->isVirtRegValid(rId)) {
+        VirtReg* vReg = cc->getVirtRegById(rId);
+        ASMJIT_ASSERT(vReg != nullptr);
+
+        const char* name = vReg->getName();
+        if (name && name[0] != '\0')
+          return sb.appendString(name);
+
+        ASMJIT_PROPAGATE(sb.appendChar('v'));
+        return sb.appendUInt(Operand::unpackId(rId));
+      }
+    }
+#endif // !ASMJIT_DISABLE_COMPILER
+
+    return sb.appendFormat("VirtReg<Type=%u Id=%u>", rType, rId);
+  }
+
+  switch (rType) {
+    case ArmReg::kRegGpw:
+      if (rId < 31) return sb.appendFormat("w%u", rId);
+      if (rId == ArmGp::kIdSp) return sb.appendString("wsp");
+      if (rId == ArmGp::kIdZr) return sb.appendString("wzr");
+      break;
+
+    case ArmReg::kRegGpx:
+      if (rId < 31) return sb.appendFormat("x%u", rId);
+      if (rId == ArmGp::kIdSp) return sb.appendString("sp");
+      if (rId == ArmGp::kIdZr) return sb.appendString("xzr");
+      break;
+
+    case ArmReg::kRegVecS: if (rId < 32) return sb.appendFormat("s%u", rId); break;
+    case ArmReg::kRegVecD: if (rId < 32) return sb.appendFormat("d%u", rId); break;
+    case ArmReg::kRegVecV: if (rId < 32) return sb.appendFormat("v%u.16b", rId); break;
+  }
+
+  return sb.appendFormat("PhysReg<Type=%u Id=%u>", rType, rId);
+}
+
+// ============================================================================
+// [asmjit::ArmLogging - Format Instruction]
+// ============================================================================
+
+ASMJIT_FAVOR_SIZE Error ArmLogging::formatInstruction(
+  StringBuilder& sb,
+  uint32_t logOptions,
+  const CodeEmitter* emitter,
+  uint32_t archType,
+  const Inst::Detail& detail, const Operand_* opArray, uint32_t opCount) noexcept {
+
+  uint32_t instId = detail.instId;
+
+  if (instId < ArmInst::_kIdCount)
+    ASMJIT_PROPAGATE(sb.appendString(ArmInst::getInst(instId).getName()));
+  else
+    ASMJIT_PROPAGATE(sb.appendFormat("<unknown id=#%u>", static_cast<unsigned int>(instId)));
+
+  // Condition of CSEL|CSET and shift amount of shifted register and MOVK|MOVN|MOVZ
+  // forms are immediates, format them the way they are written in assembly.
+  static const char armCondNames[] = "eq\0ne\0cs\0cc\0mi\0pl\0vs\0vc\0hi\0ls\0ge\0lt\0gt\0le\0al\0nv";
+  uint32_t condIndex = kInvalidValue;
+  uint32_t shiftIndex = kInvalidValue;
+
+  if (instId < ArmInst::_kIdCount) {
+    switch (ArmInst::getInst(instId).getEncodingType()) {
+      case ArmInst::kEncodingBaseCSel   : condIndex = 3; break;
+      case ArmInst::kEncodingBaseCSet   : condIndex = 1; break;
+      case ArmInst::kEncodingBaseAddSub :
+      case ArmInst::kEncodingBaseLogical: shiftIndex = opCount > 3 && opArray[2].isReg() ? uint32_t(3) : uint32_t(kInvalidValue); break;
+      case ArmInst::kEncodingBaseCmp    :
+      case ArmInst::kEncodingBaseTst    : shiftIndex = opCount > 2 && opArray[1].isReg() ? uint32_t(2) : uint32_t(kInvalidValue); break;
+      case ArmInst::kEncodingBaseMovWide: shiftIndex = 2; break;
+    }
+  }
+
+  for (uint32_t i = 0; i < opCount; i++) {
+    const Operand_& op = opArray[i];
+    if (op.isNone()) break;
+
+    ASMJIT_PROPAGATE(sb.appendString(i == 0 ? " " : ", "));
+
+    if (i == condIndex && op.isImm() && op.as<Imm>().getUInt64() < arm::kCondCount)
+      ASMJIT_PROPAGATE(sb.appendString(armCondNames + op.as<Imm>().getUInt32() * 3));
+    else if (i == shiftIndex && op.isImm())
+      ASMJIT_PROPAGATE(sb.appendFormat("lsl #%u", op.as<Imm>().getUInt32()));
+    else
+      ASMJIT_PROPAGATE(formatOperand(sb, logOptions, emitter, archType, op));
+  }
+
+  return kErrorOk;
+}
+
+} // asmjit namespace
+
+// [Api-End]
+#include "../asmjit_apiend.h"
+
+// [Guard]
+#endif // ASMJIT_BUILD_ARM && !ASMJIT_DISABLE_LOGGING
@@ -0,0 +1,325 @@
+// [AsmJit]
+// Complete x86/x64 JIT and Remote Assembler for C++.
+//
+// [License]
+// Zlib - See LICENSE.md file in the package.
+
+// [Guard]
+#ifndef _ASMJIT_ARM_ARMMISC_H
+#define _ASMJIT_ARM_ARMMISC_H
+
+// [Dependencies]
+#include "../arm/armoperand.h"
+
+// [Api-Begin]
+#include "../asmjit_apibegin.h"
+
+namespace asmjit {
+
+//! \addtogroup asmjit_arm
+//! \{
+
+// ============================================================================
+// [asmjit::ArmRegCount]
+// ============================================================================
+
+//! \internal
+//!
+//! ARM registers count.
+//!
+//! Used by `ArmCompiler`'s register allocator and data structures, the same
+//! way as `X86RegCount`. AArch64 has only GP and VEC register kinds, both
+//! having 32 registers, the remaining two counters are always zero.
+struct ArmRegCount {
+  // --------------------------------------------------------------------------
+  // [Zero]
+  // --------------------------------------------------------------------------
+
+  //! Reset all counters to zero.
+  ASMJIT_INLINE void reset() noexcept { _packed = 0; }
+
+  // --------------------------------------------------------------------------
+  // [Get]
+  // --------------------------------------------------------------------------
+
+  //! Get register count by a register `kind`.
+  ASMJIT_INLINE uint32_t get(uint32_t kind) const noexcept {
+    ASMJIT_ASSERT(kind < Globals::kMaxVRegKinds);
+
+    uint32_t shift = Utils::byteShiftOfDWordStruct(kind);
+    return (_packed >> shift) & static_cast<uint32_t>(0xFF);
+  }
+
+  //! Get Gp count.
+  ASMJIT_INLINE uint32_t getGp() const noexcept { return get(ArmReg::kKindGp); }
+  //! Get Vec count.
+  ASMJIT_INLINE uint32_t getVec() const noexcept { return get(ArmReg::kKindVec); }
+
+  // --------------------------------------------------------------------------
+  // [Set]
+  // --------------------------------------------------------------------------
+
+  //! Set register count by a register `kind`.
+  ASMJIT_INLINE void set(uint32_t kind, uint32_t n) noexcept {
+    ASMJIT_ASSERT(kind < Globals::kMaxVRegKinds);
+    ASMJIT_ASSERT(n <= 0xFF);
+
+    uint32_t shift = Utils::byteShiftOfDWordStruct(kind);
+    _packed = (_packed & ~static_cast<uint32_t>(0xFF << shift)) + (n << shift);
+  }
+
+  //! Set Gp count.
+  ASMJIT_INLINE void setGp(uint32_t n) noexcept { set(ArmReg::kKindGp, n); }
+  //! Set Vec count.
+  ASMJIT_INLINE void setVec(uint32_t n) noexcept { set(ArmReg::kKindVec, n); }
+
+  // --------------------------------------------------------------------------
+  // [Add]
+  // --------------------------------------------------------------------------
+
+  //! Add register count by a register `kind`.
+  ASMJIT_INLINE void add(uint32_t kind, uint32_t n = 1) noexcept {
+    ASMJIT_ASSERT(kind < Globals::kMaxVRegKinds);
+    ASMJIT_ASSERT(0xFF - static_cast<uint32_t>(_regs[kind]) >= n);
+
+    uint32_t shift = Utils::byteShiftOfDWordStruct(kind);
+    _packed += n << shift;
+  }
+
+  //! Add GP count.
+  ASMJIT_INLINE void addGp(uint32_t n) noexcept { add(ArmReg::kKindGp, n); }
+  //! Add Vec count.
+  ASMJIT_INLINE void addVec(uint32_t n) noexcept { add(ArmReg::kKindVec, n); }
+
+  // --------------------------------------------------------------------------
+  // [Misc]
+  // --------------------------------------------------------------------------
+
+  //! Build register indexes based on the given `count` of registers.
+  ASMJIT_INLINE void indexFromRegCount(const ArmRegCount& count) noexcept {
+    uint32_t x = static_cast<uint32_t>(count._regs[0]);
+    uint32_t y = static_cast<uint32_t>(count._regs[1]) + x;
+
+    ASMJIT_ASSERT(y <= 0xFF);
+    _packed = Utils::pack32_4x8(0, x, y, y);
+  }
+
+  // --------------------------------------------------------------------------
+  // [Members]
+  // --------------------------------------------------------------------------
+
+  union {
+    struct {
+      //! Count of GP registers.
+      uint8_t _gp;
+      //! Count of VEC registers.
+      uint8_t _vec;
+      //! \internal
+      uint8_t _reserved[2];
+    };
+
+    uint8_t _regs[4];
+    uint32_t _packed;
+  };
+};
+
+// ============================================================================
+// [asmjit::ArmRegMask]
+// ============================================================================
+
+//! \internal
+//!
+//! ARM registers mask.
+struct ArmRegMask {
+  // --------------------------------------------------------------------------
+  // [Reset]
+  // --------------------------------------------------------------------------
+
+  //! Reset all register masks to zero.
+  ASMJIT_INLINE void reset() noexcept {
+    _packed.reset();
+  }
+
+  // --------------------------------------------------------------------------
+  // [IsEmpty / Has]
+  // --------------------------------------------------------------------------
+
+  //! Get whether all register masks are zero (empty).
+  ASMJIT_INLINE bool isEmpty() const noexcept {
+    return _packed.isZero();
+  }
+
+  ASMJIT_INLINE bool has(uint32_t kind, uint32_t mask = 0xFFFFFFFFU) const noexcept {
+    ASMJIT_ASSERT(kind < Globals::kMaxVRegKinds);
+
+    switch (kind) {
+      case ArmReg::kKindGp : return (_gp  & mask) != 0;
+      case ArmReg::kKindVec: return (_vec & mask) != 0;
+    }
+
+    return false;
+  }
+
+  ASMJIT_INLINE bool hasGp(uint32_t mask = 0xFFFFFFFFU) const noexcept { return has(ArmReg::kKindGp, mask); }
+  ASMJIT_INLINE bool hasVec(uint32_t mask = 0xFFFFFFFFU) const noexcept { return has(ArmReg::kKindVec, mask); }
+
+  // --------------------------------------------------------------------------
+  // [Get]
+  // --------------------------------------------------------------------------
+
+  ASMJIT_INLINE uint32_t get(uint32_t kind) const noexcept {
+    ASMJIT_ASSERT(kind < Globals::kMaxVRegKinds);
+
+    switch (kind) {
+      case ArmReg::kKindGp : return _gp;
+      case ArmReg::kKindVec: return _vec;
+    }
+
+    return 0;
+  }
+
+  ASMJIT_INLINE uint32_t getGp() const noexcept { return get(ArmReg::kKindGp); }
+  ASMJIT_INLINE uint32_t getVec() const noexcept { return get(ArmReg::kKindVec); }
+
+  // --------------------------------------------------------------------------
+  // [Zero]
+  // --------------------------------------------------------------------------
+
+  ASMJIT_INLINE void zero(uint32_t kind) noexcept {
+    ASMJIT_ASSERT(kind < Globals::kMaxVRegKinds);
+
+    switch (kind) {
+      case ArmReg::kKindGp : _gp  = 0; break;
+      case ArmReg::kKindVec: _vec = 0; break;
+    }
+  }
+
+  ASMJIT_INLINE void zeroGp() noexcept { zero(ArmReg::kKindGp); }
+  ASMJIT_INLINE void zeroVec() noexcept { zero(ArmReg::kKindVec); }
+
+  // --------------------------------------------------------------------------
+  // [Set]
+  // --------------------------------------------------------------------------
+
+  ASMJIT_INLINE void set(const ArmRegMask& other) noexcept {
+    _packed = other._packed;
+  }
+
+  ASMJIT_INLINE void set(uint32_t kind, uint32_t mask) noexcept {
+    ASMJIT_ASSERT(kind < Globals::kMaxVRegKinds);
+
+    switch (kind) {
+      case ArmReg::kKindGp : _gp  = mask; break;
+      case ArmReg::kKindVec: _vec = mask; break;
+    }
+  }
+
+  ASMJIT_INLINE void setGp(uint32_t mask) noexcept { return set(ArmReg::kKindGp, mask); }
+  ASMJIT_INLINE void setVec(uint32_t mask) noexcept { return set(ArmReg::kKindVec, mask); }
+
+  // --------------------------------------------------------------------------
+  // [And]
+  // --------------------------------------------------------------------------
+
+  ASMJIT_INLINE void and_(const ArmRegMask& other) noexcept {
+    _packed.and_(other._packed);
+  }
+
+  ASMJIT_INLINE void and_(uint32_t kind, uint32_t mask) noexcept {
+    ASMJIT_ASSERT(kind < Globals::kMaxVRegKinds);
+
+    switch (kind) {
+      case ArmReg::kKindGp : _gp  &= mask; break;
+      case ArmReg::kKindVec: _vec &= mask; break;
+    }
+  }
+
+  ASMJIT_INLINE void andGp(uint32_t mask) noexcept { and_(ArmReg::kKindGp, mask); }
+  ASMJIT_INLINE void andVec(uint32_t mask) noexcept { and_(ArmReg::kKindVec, mask); }
+
+  // --------------------------------------------------------------------------
+  // [AndNot]
+  // --------------------------------------------------------------------------
+
+  ASMJIT_INLINE void andNot(const ArmRegMask& other) noexcept {
+    _packed.andNot(other._packed);
+  }
+
+  ASMJIT_INLINE void andNot(uint32_t kind, uint32_t mask) noexcept {
+    ASMJIT_ASSERT(kind < Globals::kMaxVRegKinds);
+
+    switch (kind) {
+      case ArmReg::kKindGp : _gp  &= ~mask; break;
+      case ArmReg::kKindVec: _vec &= ~mask; break;
+    }
+  }
+
+  ASMJIT_INLINE void andNotGp(uint32_t mask) noexcept { andNot(ArmReg::kKindGp, mask); }
+  ASMJIT_INLINE void andNotVec(uint32_t mask) noexcept { andNot(ArmReg::kKindVec, mask); }
+
+  // --------------------------------------------------------------------------
+  // [Or]
+  // --------------------------------------------------------------------------
+
+  ASMJIT_INLINE void or_(const ArmRegMask& other) noexcept {
+    _packed.or_(other._packed);
+  }
+
+  ASMJIT_INLINE void or_(uint32_t kind, uint32_t mask) noexcept {
+    ASMJIT_ASSERT(kind < Globals::kMaxVRegKinds);
+
+    switch (kind) {
+      case ArmReg::kKindGp : _gp  |= mask; break;
+      case ArmReg::kKindVec: _vec |= mask; break;
+    }
+  }
+
+  ASMJIT_INLINE void orGp(uint32_t mask) noexcept { return or_(ArmReg::kKindGp, mask); }
+  ASMJIT_INLINE void orVec(uint32_t mask) noexcept { return or_(ArmReg::kKindVec, mask); }
+
+  // --------------------------------------------------------------------------
+  // [Xor]
+  // --------------------------------------------------------------------------
+
+  ASMJIT_INLINE void xor_(const ArmRegMask& other) noexcept {
+    _packed.xor_(other._packed);
+  }
+
+  ASMJIT_INLINE void xor_(uint32_t kind, uint32_t mask) noexcept {
+    ASMJIT_ASSERT(kind < Globals::kMaxVRegKinds);
+
+    switch (kind) {
+      case ArmReg::kKindGp : _gp  ^= mask; break;
+      case ArmReg::kKindVec: _vec ^= mask; break;
+    }
+  }
+
+  ASMJIT_INLINE void xorGp(uint32_t mask) noexcept { xor_(ArmReg::kKindGp, mask); }
+  ASMJIT_INLINE void xorVec(uint32_t mask) noexcept { xor_(ArmReg::kKindVec, mask); }
+
+  // --------------------------------------------------------------------------
+  // [Members]
+  // --------------------------------------------------------------------------
+
+  union {
+    struct {
+      //! GP registers mask (32 bits).
+      uint32_t _gp;
+      //! VEC registers mask (32 bits).
+      uint32_t _vec;
+    };
+
+    //! Packed masks.
+    UInt64 _packed;
+  };
+};
+
+//! \}
+
+} // asmjit namespace
+
+// [Api-End]
+#include "../asmjit_apiend.h"
+
+// [Guard]
+#endif // _ASMJIT_ARM_ARMMISC_H
@@ -0,0 +1,113 @@
+// [AsmJit]
+// Complete x86/x64 JIT and Remote Assembler for C++.
+//
+// [License]
+// Zlib - See LICENSE.md file in the package.
+
+// [Export]
+#define ASMJIT_EXPORTS
+
+// [Guard]
+#include "../asmjit_build.h"
+#if defined(ASMJIT_BUILD_ARM)
+
+// [Dependencies]
+#include "../arm/armoperand.h"
+
+// [Api-Begin]
+#include "../asmjit_apibegin.h"
+
+namespace asmjit {
+
+// ============================================================================
+// [asmjit::ArmOperand - Test]
+// ============================================================================
+
+#if defined(ASMJIT_TEST)
+UNIT(arm_operand) {
+  Label L;
+
+  INFO("Checking basic properties of built-in ARM registers");
+  EXPECT(arm::gpw(0) == arm::w0);
+  EXPECT(arm::gpw(30) == arm::w30);
+  EXPECT(arm::gpx(0) == arm::x0);
+  EXPECT(arm::gpx(30) == arm::x30);
+  EXPECT(arm::gpx(ArmGp::kIdSp) == arm::sp);
+  EXPECT(arm::gpx(ArmGp::kIdZr) == arm::xzr);
+  EXPECT(arm::gpx(ArmGp::kIdFp) == arm::fp);
+  EXPECT(arm::gpx(ArmGp::kIdLr) == arm::lr);
+  EXPECT(arm::gpw(0) != arm::x0);
+  EXPECT(arm::gpx(1) != arm::x2);
+  EXPECT(arm::sp != arm::xzr);
+
+  INFO("Checking if arm::reg(...) matches built-in IDs");
+  EXPECT(arm::s(5) == arm::s5);
+  EXPECT(arm::d(5) == arm::d5);
+  EXPECT(arm::v(5) == arm::v5);
+
+  INFO("Checking GP register properties");
+  EXPECT(ArmGp().isReg() == false);
+  EXPECT(arm::w1.isReg() == true);
+  EXPECT(arm::w1.getId() == 1);
+  EXPECT(arm::w1.getSize() == 4);
+  EXPECT(arm::w1.getType() == ArmReg::kRegGpw);
+  EXPECT(arm::w1.getKind() == ArmReg::kKindGp);
+  EXPECT(arm::x2.getSize() == 8);
+  EXPECT(arm::x2.getType() == ArmReg::kRegGpx);
+  EXPECT(arm::x2.getKind() == ArmReg::kKindGp);
+  EXPECT(arm::x2.w() == arm::w2);
+  EXPECT(arm::w3.x() == arm::x3);
+  EXPECT(arm::sp.isSp() && arm::wsp.isSp() && arm::wzr.isZr());
+
+  INFO("Checking VEC register properties");
+  EXPECT(ArmVec().isReg() == false);
+  EXPECT(arm::s4.getSize() == 4);
+  EXPECT(arm::s4.getType() == ArmReg::kRegVecS);
+  EXPECT(arm::d4.getSize() == 8);
+  EXPECT(arm::d4.getType() == ArmReg::kRegVecD);
+  EXPECT(arm::v4.getSize() == 16);
+  EXPECT(arm::v4.getType() == ArmReg::kRegVecV);
+  EXPECT(arm::v4.getKind() == ArmReg::kKindVec);
+  EXPECT(arm::v4.isVec());
+  EXPECT(arm::s4.d() == arm::d4 && arm::d4.v() == arm::v4 && arm::v4.s() == arm::s4);
+
+  INFO("Checking if default constructed regs behave as expected");
+  EXPECT(ArmReg().isValid() == false);
+  EXPECT(ArmGp().isValid() == false);
+  EXPECT(ArmVec().isValid() == false);
+  EXPECT(ArmGpX().isValid() == false);
+  EXPECT(ArmVecV().isValid() == false);
+
+  INFO("Checking ArmMem operand");
+  ArmMem m;
+  EXPECT(m == ArmMem(),
+    "Two default constructed ArmMem operands must be equal");
+
+  m = arm::ptr(arm::x1, 16);
+  EXPECT(m.hasBaseReg() && m.getBaseId() == 1 && m.getOffsetLo32() == 16);
+  EXPECT(m.getMode() == ArmMem::kModeOffset && !m.hasIndex());
+  EXPECT(m.pre().isPreIndex() && m.post().isPostIndex());
+
+  m = arm::ptr_post(arm::sp, -32);
+  EXPECT(m.isPostIndex() && m.getBaseId() == ArmGp::kIdSp && m.getOffsetLo32() == -32);
+
+  m = arm::ptr(arm::x1, arm::x2, 3);
+  EXPECT(m.hasIndexReg() && m.getIndexId() == 2 && m.getShift() == 3);
+
+  ArmMem mL = arm::ptr(L);
+  EXPECT(mL.hasBase() == true,
+    "Memory constructed from Label must hasBase()");
+  EXPECT(mL.hasBaseReg() == false,
+    "Memory constructed from Label must not report hasBaseReg()");
+  EXPECT(mL.hasBaseLabel() == true,
+    "Memory constructed from Label must report hasBaseLabel()");
+}
+#endif // ASMJIT_TEST
+
+} // asmjit namespace
+
+// [Api-End]
+#include "../asmjit_apiend.h"
+
+// [Guard]
+#endif // ASMJIT_BUILD_ARM
@@ -0,0 +1,629 @@
+// [AsmJit]
+// Complete x86/x64 JIT and Remote Assembler for C++.
+//
+// [License]
+// Zlib - See LICENSE.md file in the package.
+
+// [Guard]
+#ifndef _ASMJIT_ARM_ARMOPERAND_H
+#define _ASMJIT_ARM_ARMOPERAND_H
+
+// [Dependencies]
+#include "../base/arch.h"
+#include "../base/operand.h"
+#include "../base/utils.h"
+#include "../arm/armglobals.h"
+
+// [Api-Begin]
+#include "../asmjit_apibegin.h"
+
+namespace asmjit {
+
+// ============================================================================
+// [Forward Declarations]
+// ============================================================================
+
+class ArmMem;
+class ArmReg;
+class ArmGp;
+class ArmGpW;
+class ArmGpX;
+class ArmVec;
+class ArmVecS;
+class ArmVecD;
+class ArmVecV;
+
+//! \addtogroup asmjit_arm
+//! \{
+
+// ============================================================================
+// [asmjit::ArmMem]
+// ============================================================================
+
+//! Memory operand (ARM).
+//!
+//! AArch64 addresses memory by a BASE register (or a label in case of a
+//! literal load) and either an immediate OFFSET or an INDEX register, which
+//! is shifted left by SHIFT. A 64-bit INDEX is used as is, a 32-bit INDEX is
+//! sign-extended (SXTW). The immediate OFFSET can also be used to update the
+//! BASE register before (pre-index) or after (post-index) the access.
+class ArmMem : public Mem {
+public:
+  //! Addressing mode.
+  ASMJIT_ENUM(Mode) {
+    kModeOffset               = 0,       //!< `[base, #offset]` or `[base, index, lsl #shift]`.
+    kModePreIndex             = 1,       //!< `[base, #offset]!`.
+    kModePostIndex            = 2        //!< `[base], #offset`.
+  };
+
+  //! Additional bits of operand's signature used by `ArmMem`.
+  ASMJIT_ENUM(AdditionalBits) {
+    kSignatureMemModeShift    = 17,
+    kSignatureMemModeBits     = 0x03U,
+    kSignatureMemModeMask     = kSignatureMemModeBits << kSignatureMemModeShift,
+
+    kSignatureMemShiftShift   = 19,
+    kSignatureMemShiftBits    = 0x07U,
+    kSignatureMemShiftMask    = kSignatureMemShiftBits << kSignatureMemShiftShift
+  };
+
+  // --------------------------------------------------------------------------
+  // [Construction / Destruction]
+  // --------------------------------------------------------------------------
+
+  //! Construct a default `ArmMem` operand, that points to [0].
+  ASMJIT_INLINE ArmMem() noexcept : Mem(NoInit) { reset(); }
+  ASMJIT_INLINE ArmMem(const ArmMem& other) noexcept : Mem(other) {}
+
+  ASMJIT_INLINE ArmMem(const Label& base, int32_t off, uint32_t size = 0, uint32_t flags = 0) noexcept : Mem(NoInit) {
+    uint32_t signature = (Label::kLabelTag << kSignatureMemBaseTypeShift ) |
+                         (size             << kSignatureSizeShift        ) ;
+
+    _init_packed_d0_d1(kOpMem | signature | flags, 0);
+    _mem.base = base.getId();
+    _mem.offsetLo32 = static_cast<uint32_t>(off);
+  }
+
+  ASMJIT_INLINE ArmMem(const Reg& base, int32_t off, uint32_t size = 0, uint32_t flags = 0) noexcept : Mem(NoInit) {
+    uint32_t signature = (base.getType()   << kSignatureMemBaseTypeShift ) |
+                         (size             << kSignatureSizeShift        ) ;
+
+    _init_packed_d0_d1(kOpMem | signature | flags, 0);
+    _mem.base = base.getId();
+    _mem.offsetLo32 = static_cast<uint32_t>(off);
+  }
+
+  ASMJIT_INLINE ArmMem(const Reg& base, const Reg& index, uint32_t shift, uint32_t size = 0, uint32_t flags = 0) noexcept : Mem(NoInit) {
+    ASMJIT_ASSERT(shift <= kSignatureMemShiftBits);
+    uint32_t signature = (base.getType()   << kSignatureMemBaseTypeShift ) |
+                         (index.getType()  << kSignatureMemIndexTypeShift) |
+                         (shift            << kSignatureMemShiftShift    ) |
+                         (size             << kSignatureSizeShift        ) ;
+
+    _init_packed_d0_d1(kOpMem | signature | flags, index.getId());
+    _mem.base = base.getId();
+    _mem.offsetLo32 = 0;
+  }
+
+  ASMJIT_INLINE ArmMem(const _Init& init,
+    uint32_t baseType, uint32_t baseId,
+    uint32_t indexType, uint32_t indexId,
+    int32_t off, uint32_t size, uint32_t flags) noexcept : Mem(init, baseType, baseId, indexType, indexId, off, size, flags) {}
+
+  explicit ASMJIT_INLINE ArmMem(const _NoInit&) noexcept : Mem(NoInit) {}
+
+  // --------------------------------------------------------------------------
+  // [ArmMem]
+  // --------------------------------------------------------------------------
+
+  //! Clone the memory operand.
+  ASMJIT_INLINE ArmMem clone() const noexcept { return ArmMem(*this); }
+
+  using Mem::setIndex;
+
+  ASMJIT_INLINE void setIndex(const Reg& index, uint32_t shift) noexcept {
+    setIndex(index);
+    setShift(shift);
+  }
+
+  //! Get the addressing mode, see \ref Mode.
+  ASMJIT_INLINE uint32_t getMode() const noexcept { return _getSignatureData(kSignatureMemModeBits, kSignatureMemModeShift); }
+  //! Set the addressing mode, see \ref Mode.
+  ASMJIT_INLINE void setMode(uint32_t mode) noexcept { _setSignatureData(mode, kSignatureMemModeBits, kSignatureMemModeShift); }
+  //! Reset the addressing mode to \ref kModeOffset.
+  ASMJIT_INLINE void resetMode() noexcept { _signature &= ~kSignatureMemModeMask; }
+
+  //! Get if the memory operand uses pre-index addressing.
+  ASMJIT_INLINE bool isPreIndex() const noexcept { return getMode() == kModePreIndex; }
+  //! Get if the memory operand uses post-index addressing.
+  ASMJIT_INLINE bool isPostIndex() const noexcept { return getMode() == kModePostIndex; }
+
+  //! Get if the memory operand has shift constant.
+  ASMJIT_INLINE bool hasShift() const noexcept { return _hasSignatureData(kSignatureMemShiftMask); }
+  //! Get the memory operand's shift constant.
+  ASMJIT_INLINE uint32_t getShift() const noexcept { return _getSignatureData(kSignatureMemShiftBits, kSignatureMemShiftShift); }
+  //! Set the memory operand's shift constant.
+  ASMJIT_INLINE void setShift(uint32_t shift) noexcept { _setSignatureData(shift, kSignatureMemShiftBits, kSignatureMemShiftShift); }
+  //! Reset the memory operand's shift constant to zero.
+  ASMJIT_INLINE void resetShift() noexcept { _signature &= ~kSignatureMemShiftMask; }
+
+  //! Get new memory operand adjusted by `off`.
+  ASMJIT_INLINE ArmMem adjusted(int64_t off) const noexcept {
+    ArmMem result(*this);
+    result.addOffset(off);
+    return result;
+  }
+
+  //! Get new memory operand that uses pre-index addressing.
+  ASMJIT_INLINE ArmMem pre() const noexcept {
+    ArmMem result(*this);
+    result.setMode(kModePreIndex);
+    return result;
+  }
+
+  //! Get new memory operand that uses post-index addressing.
+  ASMJIT_INLINE ArmMem post() const noexcept {
+    ArmMem result(*this);
+    result.setMode(kModePostIndex);
+    return result;
+  }
+
+  // --------------------------------------------------------------------------
+  // [Operator Overload]
+  // --------------------------------------------------------------------------
+
+  ASMJIT_INLINE ArmMem& operator=(const ArmMem& other) noexcept { copyFrom(other); return *this; }
+};
+
+// ============================================================================
+// [asmjit::ArmReg]
+// ============================================================================
+
+//! Register traits (ARM).
+//!
+//! Register traits contains information about a particular register type. It's
+//! used by asmjit to setup register information on-the-fly and to populate
+//! tables that contain register information (this way it's possible to change
+//! register types and kinds without having to reorder these tables).
+template<uint32_t RegType>
+struct ArmRegTraits {
+  enum {
+    kValid     = 0,                      //!< RegType is not valid by default.
+    kCount     = 0,                      //!< Count of registers (0 if none).
+    kTypeId    = TypeId::kVoid,          //!< Everything is void by default.
+
+    kType      = 0,                      //!< Zero type by default.
+    kKind      = 0,                      //!< Zero kind by default.
+    kSize      = 0,                      //!< No size by default.
+    kSignature = 0                       //!< No signature by default.
+  };
+};
+
+//! Register (ARM).
+class ArmReg : public Reg {
+public:
+  //! Register type.
+  //!
+  //! Don't change these constants; they are essential to some built-in tables.
+  ASMJIT_ENUM(RegType) {
+    kRegNone      = Reg::kRegNone,       //!< No register type or invalid register.
+
+    kRegGpw       = Reg::kRegGp32,       //!< 32-bit general purpose register (W).
+    kRegGpx       = Reg::kRegGp64,       //!< 64-bit general purpose register (X).
+    kRegVecS      = Reg::kRegVec32,      //!< 32-bit view of a vector register (S).
+    kRegVecD      = Reg::kRegVec64,      //!< 64-bit view of a vector register (D).
+    kRegVecV      = Reg::kRegVec128,     //!< 128-bit vector register (V or Q).
+    kRegCount                            //!< Count of register types.
+  };
+
+  //! Register kind.
+  ASMJIT_ENUM(Kind) {
+    kKindGp       = Reg::kKindGp,        //!< General purpose register kind.
+    kKindVec      = Reg::kKindVec,       //!< Vector register kind.
+    kKindCount                           //!< Count of all register kinds.
+  };
+
+  ASMJIT_DEFINE_ABSTRACT_REG(ArmReg, Reg)
+
+  //! Get if the register is a 32-bit GP register.
+  ASMJIT_INLINE bool isGpW() const noexcept { return hasSignature(signatureOf(kRegGpw)); }
+  //! Get if the register is a 64-bit GP register.
+  ASMJIT_INLINE bool isGpX() const noexcept { return hasSignature(signatureOf(kRegGpx)); }
+  //! Get if the register is a 32-bit view of a vector register.
+  ASMJIT_INLINE bool isVecS() const noexcept { return hasSignature(signatureOf(kRegVecS)); }
+  //! Get if the register is a 64-bit view of a vector register.
+  ASMJIT_INLINE bool isVecD() const noexcept { return hasSignature(signatureOf(kRegVecD)); }
+  //! Get if the register is a 128-bit vector register.
+  ASMJIT_INLINE bool isVecV() const noexcept { return hasSignature(signatureOf(kRegVecV)); }
+
+  template<uint32_t Type>
+  ASMJIT_INLINE void setArmRegT(uint32_t rId) noexcept {
+    setSignature(ArmRegTraits<Type>::kSignature);
+    setId(rId);
+  }
+
+  ASMJIT_INLINE void setTypeAndId(uint32_t rType, uint32_t rId) noexcept {
+    ASMJIT_ASSERT(rType < kRegCount);
+    setSignature(signatureOf(rType));
+    setId(rId);
+  }
+
+  static ASMJIT_INLINE uint32_t kindOf(uint32_t rType) noexcept;
+  template<uint32_t Type>
+  static ASMJIT_INLINE uint32_t kindOfT() noexcept { return ArmRegTraits<Type>::kKind; }
+
+  static ASMJIT_INLINE uint32_t signatureOf(uint32_t rType) noexcept;
+  template<uint32_t Type>
+  static ASMJIT_INLINE uint32_t signatureOfT() noexcept { return ArmRegTraits<Type>::kSignature; }
+
+  static ASMJIT_INLINE bool isGpW(const Operand_& op) noexcept { return op.as<ArmReg>().isGpW(); }
+  static ASMJIT_INLINE bool isGpX(const Operand_& op) noexcept { return op.as<ArmReg>().isGpX(); }
+  static ASMJIT_INLINE bool isVecS(const Operand_& op) noexcept { return op.as<ArmReg>().isVecS(); }
+  static ASMJIT_INLINE bool isVecD(const Operand_& op) noexcept { return op.as<ArmReg>().isVecD(); }
+  static ASMJIT_INLINE bool isVecV(const Operand_& op) noexcept { return op.as<ArmReg>().isVecV(); }
+
+  static ASMJIT_INLINE bool isGpW(const Operand_& op, uint32_t rId) noexcept { return isGpW(op) & (op.getId() == rId); }
+  static ASMJIT_INLINE bool isGpX(const Operand_& op, uint32_t rId) noexcept { return isGpX(op) & (op.getId() == rId); }
+  static ASMJIT_INLINE bool isVecS(const Operand_& op, uint32_t rId) noexcept { return isVecS(op) & (op.getId() == rId); }
+  static ASMJIT_INLINE bool isVecD(const Operand_& op, uint32_t rId) noexcept { return isVecD(op) & (op.getId() == rId); }
+  static ASMJIT_INLINE bool isVecV(const Operand_& op, uint32_t rId) noexcept { return isVecV(op) & (op.getId() == rId); }
+
+  // --------------------------------------------------------------------------
+  // [Memory Cast]
+  // --------------------------------------------------------------------------
+
+  //! Cast this variable to a memory operand of its size (home of the variable).
+  ASMJIT_INLINE ArmMem m(int32_t disp = 0) const noexcept {
+    return ArmMem(*this, disp, getSize(), Mem::kSignatureMemRegHomeFlag);
+  }
+};
+
+ASMJIT_DEFINE_REG_TRAITS(ArmRegTraits, ArmGp  , ArmReg::kRegGpw  , ArmReg::kKindGp , 4 , 32, TypeId::kI32   );
+ASMJIT_DEFINE_REG_TRAITS(ArmRegTraits, ArmGp  , ArmReg::kRegGpx  , ArmReg::kKindGp , 8 , 32, TypeId::kI64   );
+ASMJIT_DEFINE_REG_TRAITS(ArmRegTraits, ArmVec , ArmReg::kRegVecS , ArmReg::kKindVec, 4 , 32, TypeId::kF32x1 );
+ASMJIT_DEFINE_REG_TRAITS(ArmRegTraits, ArmVec , ArmReg::kRegVecD , ArmReg::kKindVec, 8 , 32, TypeId::kF64x1 );
+ASMJIT_DEFINE_REG_TRAITS(ArmRegTraits, ArmVec , ArmReg::kRegVecV , ArmReg::kKindVec, 16, 32, TypeId::kI32x4 );
+
+//! General purpose register (ARM).
+class ArmGp : public ArmReg {
+public:
+  ASMJIT_DEFINE_ABSTRACT_REG(ArmGp, ArmReg)
+
+  //! AArch64 physical id.
+  //!
+  //! NOTE: Encoding 31 is either SP or ZR depending on the instruction. AsmJit
+  //! uses id 31 for SP and `kIdZr` for ZR, the encoder uses the low 5 bits.
+  ASMJIT_ENUM(Id) {
+    kIdIp0 = 16, //!< Physical id of IP0 (X16), intra-procedure-call scratch register.
+    kIdIp1 = 17, //!< Physical id of IP1 (X17), intra-procedure-call scratch register.
+    kIdPr  = 18, //!< Physical id of the platform register (X18).
+    kIdFp  = 29, //!< Physical id of the frame pointer (X29).
+    kIdLr  = 30, //!< Physical id of the link register (X30).
+    kIdSp  = 31, //!< Physical id of SP|WSP registers.
+    kIdZr  = 63  //!< Physical id of XZR|WZR registers.
+  };
+
+  //! Get if the register is SP or WSP.
+  ASMJIT_INLINE bool isSp() const noexcept { return getId() == kIdSp; }
+  //! Get if the register is XZR or WZR.
+  ASMJIT_INLINE bool isZr() const noexcept { return getId() == kIdZr; }
+
+  //! Cast this register to 32-bit (W).
+  ASMJIT_INLINE ArmGpW w() const noexcept;
+  //! Cast this register to 64-bit (X).
+  ASMJIT_INLINE ArmGpX x() const noexcept;
+};
+
+//! Vector register (ARM).
+class ArmVec : public ArmReg {
+  ASMJIT_DEFINE_ABSTRACT_REG(ArmVec, ArmReg)
+
+  //! Cast this register to a 32-bit view (S).
+  ASMJIT_INLINE ArmVecS s() const noexcept;
+  //! Cast this register to a 64-bit view (D).
+  ASMJIT_INLINE ArmVecD d() const noexcept;
+  //! Cast this register to a 128-bit vector (V).
+  ASMJIT_INLINE ArmVecV v() const noexcept;
+};
+
+//! 32-bit GPW register (ARM).
+class ArmGpW : public ArmGp { ASMJIT_DEFINE_FINAL_REG(ArmGpW, ArmGp, ArmRegTraits<kRegGpw>) };
+//! 64-bit GPX register (ARM).
+class ArmGpX : public ArmGp { ASMJIT_DEFINE_FINAL_REG(ArmGpX, ArmGp, ArmRegTraits<kRegGpx>) };
+//! 32-bit view of a vector register (ARM).
+class ArmVecS : public ArmVec { ASMJIT_DEFINE_FINAL_REG(ArmVecS, ArmVec, ArmRegTraits<kRegVecS>) };
+//! 64-bit view of a vector register (ARM).
+class ArmVecD : public ArmVec { ASMJIT_DEFINE_FINAL_REG(ArmVecD, ArmVec, ArmRegTraits<kRegVecD>) };
+//! 128-bit vector register (ARM).
+class ArmVecV : public ArmVec { ASMJIT_DEFINE_FINAL_REG(ArmVecV, ArmVec, ArmRegTraits<kRegVecV>) };
+
+ASMJIT_INLINE ArmGpW ArmGp::w() const noexcept { return ArmGpW(getId()); }
+ASMJIT_INLINE ArmGpX ArmGp::x() const noexcept { return ArmGpX(getId()); }
+ASMJIT_INLINE ArmVecS ArmVec::s() const noexcept { return ArmVecS(getId()); }
+ASMJIT_INLINE ArmVecD ArmVec::d() const noexcept { return ArmVecD(getId()); }
+ASMJIT_INLINE ArmVecV ArmVec::v() const noexcept { return ArmVecV(getId()); }
+
+ASMJIT_DEFINE_TYPE_ID(ArmGpW , TypeId::kI32);
+ASMJIT_DEFINE_TYPE_ID(ArmGpX , TypeId::kI64);
+ASMJIT_DEFINE_TYPE_ID(ArmVecS, TypeId::kF32x1);
+ASMJIT_DEFINE_TYPE_ID(ArmVecD, TypeId::kF64x1);
+ASMJIT_DEFINE_TYPE_ID(ArmVecV, TypeId::kI32x4);
+
+// ============================================================================
+// [asmjit::ArmOpData]
+// ============================================================================
+
+struct ArmOpData {
+  // --------------------------------------------------------------------------
+  // [Signatures]
+  // --------------------------------------------------------------------------
+
+  //! Information about all architecture registers.
+  ArchRegs archRegs;
+
+  // --------------------------------------------------------------------------
+  // [Operands]
+  // --------------------------------------------------------------------------
+
+  // Prevent calling constructors of these registers when exporting.
+#if defined(ASMJIT_EXPORTS_ARM_OPERAND)
+# define ASMJIT_ARM_REG_DATA(REG) Operand_
+#else
+# define ASMJIT_ARM_REG_DATA(REG) REG
+#endif
+  ASMJIT_ARM_REG_DATA(ArmGp  ) gpw[32];
+  ASMJIT_ARM_REG_DATA(ArmGp  ) gpx[32];
+  ASMJIT_ARM_REG_DATA(ArmGp  ) zr[2];
+  ASMJIT_ARM_REG_DATA(ArmVec ) vecs[32];
+  ASMJIT_ARM_REG_DATA(ArmVec ) vecd[32];
+  ASMJIT_ARM_REG_DATA(ArmVec ) vecv[32];
+#undef ASMJIT_ARM_REG_DATA
+};
+ASMJIT_VARAPI const ArmOpData armOpData;
+
+// ... ArmReg methods that require `armOpData`.
+ASMJIT_INLINE uint32_t ArmReg::signatureOf(uint32_t rType) noexcept {
+  ASMJIT_ASSERT(rType <= Reg::kRegMax);
+  return armOpData.archRegs.regInfo[rType].getSignature();
+}
+
+ASMJIT_INLINE uint32_t ArmReg::kindOf(uint32_t rType) noexcept {
+  ASMJIT_ASSERT(rType <= Reg::kRegMax);
+  return armOpData.archRegs.regInfo[rType].getKind();
+}
+
+// ============================================================================
+// [asmjit::arm]
+// ============================================================================
+
+namespace arm {
+
+// ============================================================================
+// [asmjit::arm - Reg]
+// ============================================================================
+
+#if !defined(ASMJIT_EXPORTS_ARM_OPERAND)
+namespace {
+#define ASMJIT_ARM_PHYS_REG(TYPE, NAME, PROPERTY) \
+  static const TYPE& NAME = armOpData.PROPERTY
+
+ASMJIT_ARM_PHYS_REG(ArmGp  , w0  , gpw[0]);       //!< 32-bit GPW register.
+ASMJIT_ARM_PHYS_REG(ArmGp  , w1  , gpw[1]);       //!< 32-bit GPW register.
+ASMJIT_ARM_PHYS_REG(ArmGp  , w2  , gpw[2]);       //!< 32-bit GPW register.
+ASMJIT_ARM_PHYS_REG(ArmGp  , w3  , gpw[3]);       //!< 32-bit GPW register.
+ASMJIT_ARM_PHYS_REG(ArmGp  , w4  , gpw[4]);       //!< 32-bit GPW register.
+ASMJIT_ARM_PHYS_REG(ArmGp  , w5  , gpw[5]);       //!< 32-bit GPW register.
+ASMJIT_ARM_PHYS_REG(ArmGp  , w6  , gpw[6]);       //!< 32-bit GPW register.
+ASMJIT_ARM_PHYS_REG(ArmGp  , w7  , gpw[7]);       //!< 32-bit GPW register.
+ASMJIT_ARM_PHYS_REG(ArmGp  , w8  , gpw[8]);       //!< 32-bit GPW register.
+ASMJIT_ARM_PHYS_REG(ArmGp  , w9  , gpw[9]);       //!< 32-bit GPW register.
+ASMJIT_ARM_PHYS_REG(ArmGp  , w10 , gpw[10]);      //!< 32-bit GPW register.
+ASMJIT_ARM_PHYS_REG(ArmGp  , w11 , gpw[11]);      //!< 32-bit GPW register.
+ASMJIT_ARM_PHYS_REG(ArmGp  , w12 , gpw[12]);      //!< 32-bit GPW register.
+ASMJIT_ARM_PHYS_REG(ArmGp  , w13 , gpw[13]);      //!< 32-bit GPW register.
+ASMJIT_ARM_PHYS_REG(ArmGp  , w14 , gpw[14]);      //!< 32-bit GPW register.
+ASMJIT_ARM_PHYS_REG(ArmGp  , w15 , gpw[15]);      //!< 32-bit GPW register.
+ASMJIT_ARM_PHYS_REG(ArmGp  , w16 , gpw[16]);      //!< 32-bit GPW register.
+ASMJIT_ARM_PHYS_REG(ArmGp  , w17 , gpw[17]);      //!< 32-bit GPW register.
+ASMJIT_ARM_PHYS_REG(ArmGp  , w18 , gpw[18]);      //!< 32-bit GPW register.
+ASMJIT_ARM_PHYS_REG(ArmGp  , w19 , gpw[19]);      //!< 32-bit GPW register.
+ASMJIT_ARM_PHYS_REG(ArmGp  , w20 , gpw[20]);      //!< 32-bit GPW register.
+ASMJIT_ARM_PHYS_REG(ArmGp  , w21 , gpw[21]);      //!< 32-bit GPW register.
+ASMJIT_ARM_PHYS_REG(ArmGp  , w22 , gpw[22]);      //!< 32-bit GPW register.
+ASMJIT_ARM_PHYS_REG(ArmGp  , w23 , gpw[23]);      //!< 32-bit GPW register.
+ASMJIT_ARM_PHYS_REG(ArmGp  , w24 , gpw[24]);      //!< 32-bit GPW register.
+ASMJIT_ARM_PHYS_REG(ArmGp  , w25 , gpw[25]);      //!< 32-bit GPW register.
+ASMJIT_ARM_PHYS_REG(ArmGp  , w26 , gpw[26]);      //!< 32-bit GPW register.
+ASMJIT_ARM_PHYS_REG(ArmGp  , w27 , gpw[27]);      //!< 32-bit GPW register.
+ASMJIT_ARM_PHYS_REG(ArmGp  , w28 , gpw[28]);      //!< 32-bit GPW register.
+ASMJIT_ARM_PHYS_REG(ArmGp  , w29 , gpw[29]);      //!< 32-bit GPW register.
+ASMJIT_ARM_PHYS_REG(ArmGp  , w30 , gpw[30]);      //!< 32-bit GPW register.
+ASMJIT_ARM_PHYS_REG(ArmGp  , wsp , gpw[31]);      //!< 32-bit stack pointer.
+ASMJIT_ARM_PHYS_REG(ArmGp  , wzr , zr[0]);        //!< 32-bit zero register.
+
+ASMJIT_ARM_PHYS_REG(ArmGp  , x0  , gpx[0]);       //!< 64-bit GPX register.
+ASMJIT_ARM_PHYS_REG(ArmGp  , x1  , gpx[1]);       //!< 64-bit GPX register.
+ASMJIT_ARM_PHYS_REG(ArmGp  , x2  , gpx[2]);       //!< 64-bit GPX register.
+ASMJIT_ARM_PHYS_REG(ArmGp  , x3  , gpx[3]);       //!< 64-bit GPX register.
+ASMJIT_ARM_PHYS_REG(ArmGp  , x4  , gpx[4]);       //!< 64-bit GPX register.
+ASMJIT_ARM_PHYS_REG(ArmGp  , x5  , gpx[5]);       //!< 64-bit GPX register.
+ASMJIT_ARM_PHYS_REG(ArmGp  , x6  , gpx[6]);       //!< 64-bit GPX register.
+ASMJIT_ARM_PHYS_REG(ArmGp  , x7  , gpx[7]);       //!< 64-bit GPX register.
+ASMJIT_ARM_PHYS_REG(ArmGp  , x8  , gpx[8]);       //!< 64-bit GPX register.
+ASMJIT_ARM_PHYS_REG(ArmGp  , x9  , gpx[9]);       //!< 64-bit GPX register.
+ASMJIT_ARM_PHYS_REG(ArmGp  , x10 , gpx[10]);      //!< 64-bit GPX register.
+ASMJIT_ARM_PHYS_REG(ArmGp  , x11 , gpx[11]);      //!< 64-bit GPX register.
+ASMJIT_ARM_PHYS_REG(ArmGp  , x12 , gpx[12]);      //!< 64-bit GPX register.
+ASMJIT_ARM_PHYS_REG(ArmGp  , x13 , gpx[13]);      //!< 64-bit GPX register.
+ASMJIT_ARM_PHYS_REG(ArmGp  , x14 , gpx[14]);      //!< 64-bit GPX register.
+ASMJIT_ARM_PHYS_REG(ArmGp  , x15 , gpx[15]);      //!< 64-bit GPX register.
+ASMJIT_ARM_PHYS_REG(ArmGp  , x16 , gpx[16]);      //!< 64-bit GPX register.
+ASMJIT_ARM_PHYS_REG(ArmGp  , x17 , gpx[17]);      //!< 64-bit GPX register.
+ASMJIT_ARM_PHYS_REG(ArmGp  , x18 , gpx[18]);      //!< 64-bit GPX register.
+ASMJIT_ARM_PHYS_REG(ArmGp  , x19 , gpx[19]);      //!< 64-bit GPX register.
+ASMJIT_ARM_PHYS_REG(ArmGp  , x20 , gpx[20]);      //!< 64-bit GPX register.
+ASMJIT_ARM_PHYS_REG(ArmGp  , x21 , gpx[21]);      //!< 64-bit GPX register.
+ASMJIT_ARM_PHYS_REG(ArmGp  , x22 , gpx[22]);      //!< 64-bit GPX register.
+ASMJIT_ARM_PHYS_REG(ArmGp  , x23 , gpx[23]);      //!< 64-bit GPX register.
+ASMJIT_ARM_PHYS_REG(ArmGp  , x24 , gpx[24]);      //!< 64-bit GPX register.
+ASMJIT_ARM_PHYS_REG(ArmGp  , x25 , gpx[25]);      //!< 64-bit GPX register.
+ASMJIT_ARM_PHYS_REG(ArmGp  , x26 , gpx[26]);      //!< 64-bit GPX register.
+ASMJIT_ARM_PHYS_REG(ArmGp  , x27 , gpx[27]);      //!< 64-bit GPX register.
+ASMJIT_ARM_PHYS_REG(ArmGp  , x28 , gpx[28]);      //!< 64-bit GPX register.
+ASMJIT_ARM_PHYS_REG(ArmGp  , x29 , gpx[29]);      //!< 64-bit GPX register.
+ASMJIT_ARM_PHYS_REG(ArmGp  , x30 , gpx[30]);      //!< 64-bit GPX register.
+ASMJIT_ARM_PHYS_REG(ArmGp  , sp  , gpx[31]);      //!< 64-bit stack pointer.
+ASMJIT_ARM_PHYS_REG(ArmGp  , xzr , zr[1]);        //!< 64-bit zero register.
+ASMJIT_ARM_PHYS_REG(ArmGp  , fp  , gpx[29]);      //!< Frame pointer (alias of x29).
+ASMJIT_ARM_PHYS_REG(ArmGp  , lr  , gpx[30]);      //!< Link register (alias of x30).
+
+ASMJIT_ARM_PHYS_REG(ArmVec , s0  , vecs[0]);      //!< 32-bit view of a vector register.
+ASMJIT_ARM_PHYS_REG(ArmVec , s1  , vecs[1]);      //!< 32-bit view of a vector register.
+ASMJIT_ARM_PHYS_REG(ArmVec , s2  , vecs[2]);      //!< 32-bit view of a vector register.
+ASMJIT_ARM_PHYS_REG(ArmVec , s3  , vecs[3]);      //!< 32-bit view of a vector register.
+ASMJIT_ARM_PHYS_REG(ArmVec , s4  , vecs[4]);      //!< 32-bit view of a vector register.
+ASMJIT_ARM_PHYS_REG(ArmVec , s5  , vecs[5]);      //!< 32-bit view of a vector register.
+ASMJIT_ARM_PHYS_REG(ArmVec , s6  , vecs[6]);      //!< 32-bit view of a vector register.
+ASMJIT_ARM_PHYS_REG(ArmVec , s7  , vecs[7]);      //!< 32-bit view of a vector register.
+ASMJIT_ARM_PHYS_REG(ArmVec , s8  , vecs[8]);      //!< 32-bit view of a vector register.
+ASMJIT_ARM_PHYS_REG(ArmVec , s9  , vecs[9]);      //!< 32-bit view of a vector register.
+ASMJIT_ARM_PHYS_REG(ArmVec , s10 , vecs[10]);     //!< 32-bit view of a vector register.
+ASMJIT_ARM_PHYS_REG(ArmVec , s11 , vecs[11]);     //!< 32-bit view of a vector register.
+ASMJIT_ARM_PHYS_REG(ArmVec , s12 , vecs[12]);     //!< 32-bit view of a vector register.
+ASMJIT_ARM_PHYS_REG(ArmVec , s13 , vecs[13]);     //!< 32-bit view of a vector register.
+ASMJIT_ARM_PHYS_REG(ArmVec , s14 , vecs[14]);     //!< 32-bit view of a vector register.
+ASMJIT_ARM_PHYS_REG(ArmVec , s15 , vecs[15]);     //!< 32-bit view of a vector register.
+ASMJIT_ARM_PHYS_REG(ArmVec , s16 , vecs[16]);     //!< 32-bit view of a vector register.
+ASMJIT_ARM_PHYS_REG(ArmVec , s17 , vecs[17]);     //!< 32-bit view of a vector register.
+ASMJIT_ARM_PHYS_REG(ArmVec , s18 , vecs[18]);     //!< 32-bit view of a vector register.
+ASMJIT_ARM_PHYS_REG(ArmVec , s19 , vecs[19]);     //!< 32-bit view of a vector register.
+ASMJIT_ARM_PHYS_REG(ArmVec , s20 , vecs[20]);     //!< 32-bit view of a vector register.
+ASMJIT_ARM_PHYS_REG(ArmVec , s21 , vecs[21]);     //!< 32-bit view of a vector register.
+ASMJIT_ARM_PHYS_REG(ArmVec , s22 , vecs[22]);     //!< 32-bit view of a vector register.
+ASMJIT_ARM_PHYS_REG(ArmVec , s23 , vecs[23]);     //!< 32-bit view of a vector register.
+ASMJIT_ARM_PHYS_REG(ArmVec , s24 , vecs[24]);     //!< 32-bit view of a vector register.
+ASMJIT_ARM_PHYS_REG(ArmVec , s25 , vecs[25]);     //!< 32-bit view of a vector register.
+ASMJIT_ARM_PHYS_REG(ArmVec , s26 , vecs[26]);     //!< 32-bit view of a vector register.
+ASMJIT_ARM_PHYS_REG(ArmVec , s27 , vecs[27]);     //!< 32-bit view of a vector register.
+ASMJIT_ARM_PHYS_REG(ArmVec , s28 , vecs[28]);     //!< 32-bit view of a vector register.
+ASMJIT_ARM_PHYS_REG(ArmVec , s29 , vecs[29]);     //!< 32-bit view of a vector register.
+ASMJIT_ARM_PHYS_REG(ArmVec , s30 , vecs[30]);     //!< 32-bit view of a vector register.
+ASMJIT_ARM_PHYS_REG(ArmVec , s31 , vecs[31]);     //!< 32-bit view of a vector register.
+
+ASMJIT_ARM_PHYS_REG(ArmVec , d0  , vecd[0]);      //!< 64-bit view of a vector register.
+ASMJIT_ARM_PHYS_REG(ArmVec , d1  , vecd[1]);      //!< 64-bit view of a vector register.
+ASMJIT_ARM_PHYS_REG(ArmVec , d2  , vecd[2]);      //!< 64-bit view of a vector register.
+ASMJIT_ARM_PHYS_REG(ArmVec , d3  , vecd[3]);      //!< 64-bit view of a vector register.
+ASMJIT_ARM_PHYS_REG(ArmVec , d4  , vecd[4]);      //!< 64-bit view of a vector register.
+ASMJIT_ARM_PHYS_REG(ArmVec , d5  , vecd[5]);      //!< 64-bit view of a vector register.
+ASMJIT_ARM_PHYS_REG(ArmVec , d6  , vecd[6]);      //!< 64-bit view of a vector register.
+ASMJIT_ARM_PHYS_REG(ArmVec , d7  , vecd[7]);      //!< 64-bit view of a vector register.
+ASMJIT_ARM_PHYS_REG(ArmVec , d8  , vecd[8]);      //!< 64-bit view of a vector register.
+ASMJIT_ARM_PHYS_REG(ArmVec , d9  , vecd[9]);      //!< 64-bit view of a vector register.
+ASMJIT_ARM_PHYS_REG(ArmVec , d10 , vecd[10]);     //!< 64-bit view of a vector register.
+ASMJIT_ARM_PHYS_REG(ArmVec , d11 , vecd[11]);     //!< 64-bit view of a vector register.
+ASMJIT_ARM_PHYS_REG(ArmVec , d12 , vecd[12]);     //!< 64-bit view of a vector register.
+ASMJIT_ARM_PHYS_REG(ArmVec , d13 , vecd[13]);     //!< 64-bit view of a vector register.
+ASMJIT_ARM_PHYS_REG(ArmVec , d14 , vecd[14]);     //!< 64-bit view of a vector register.
+ASMJIT_ARM_PHYS_REG(ArmVec , d15 , vecd[15]);     //!< 64-bit view of a vector register.
+ASMJIT_ARM_PHYS_REG(ArmVec , d16 , vecd[16]);     //!< 64-bit view of a vector register.
+ASMJIT_ARM_PHYS_REG(ArmVec , d17 , vecd[17]);     //!< 64-bit view of a vector register.
+ASMJIT_ARM_PHYS_REG(ArmVec , d18 , vecd[18]);     //!< 64-bit view of a vector register.
+ASMJIT_ARM_PHYS_REG(ArmVec , d19 , vecd[19]);     //!< 64-bit view of a vector register.
+ASMJIT_ARM_PHYS_REG(ArmVec , d20 , vecd[20]);     //!< 64-bit view of a vector register.
+ASMJIT_ARM_PHYS_REG(ArmVec , d21 , vecd[21]);     //!< 64-bit view of a vector register.
+ASMJIT_ARM_PHYS_REG(ArmVec , d22 , vecd[22]);     //!< 64-bit view of a vector register.
+ASMJIT_ARM_PHYS_REG(ArmVec , d23 , vecd[23]);     //!< 64-bit view of a vector register.
+ASMJIT_ARM_PHYS_REG(ArmVec , d24 , vecd[24]);     //!< 64-bit view of a vector register.
+ASMJIT_ARM_PHYS_REG(ArmVec , d25 , vecd[25]);     //!< 64-bit view of a vector register.
+ASMJIT_ARM_PHYS_REG(ArmVec , d26 , vecd[26]);     //!< 64-bit view of a vector register.
+ASMJIT_ARM_PHYS_REG(ArmVec , d27 , vecd[27]);     //!< 64-bit view of a vector register.
+ASMJIT_ARM_PHYS_REG(ArmVec , d28 , vecd[28]);     //!< 64-bit view of a vector register.
+ASMJIT_ARM_PHYS_REG(ArmVec , d29 , vecd[29]);     //!< 64-bit view of a vector register.
+ASMJIT_ARM_PHYS_REG(ArmVec , d30 , vecd[30]);     //!< 64-bit view of a vector register.
+ASMJIT_ARM_PHYS_REG(ArmVec , d31 , vecd[31]);     //!< 64-bit view of a vector register.
+
+ASMJIT_ARM_PHYS_REG(ArmVec , v0  , vecv[0]);      //!< 128-bit vector register.
+ASMJIT_ARM_PHYS_REG(ArmVec , v1  , vecv[1]);      //!< 128-bit vector register.
+ASMJIT_ARM_PHYS_REG(ArmVec , v2  , vecv[2]);      //!< 128-bit vector register.
+ASMJIT_ARM_PHYS_REG(ArmVec , v3  , vecv[3]);      //!< 128-bit vector register.
+ASMJIT_ARM_PHYS_REG(ArmVec , v4  , vecv[4]);      //!< 128-bit vector register.
+ASMJIT_ARM_PHYS_REG(ArmVec , v5  , vecv[5]);      //!< 128-bit vector register.
+ASMJIT_ARM_PHYS_REG(ArmVec , v6  , vecv[6]);      //!< 128-bit vector register.
+ASMJIT_ARM_PHYS_REG(ArmVec , v7  , vecv[7]);      //!< 128-bit vector register.
+ASMJIT_ARM_PHYS_REG(ArmVec , v8  , vecv[8]);      //!< 128-bit vector register.
+ASMJIT_ARM_PHYS_REG(ArmVec , v9  , vecv[9]);      //!< 128-bit vector register.
+ASMJIT_ARM_PHYS_REG(ArmVec , v10 , vecv[10]);     //!< 128-bit vector register.
+ASMJIT_ARM_PHYS_REG(ArmVec , v11 , vecv[11]);     //!< 128-bit vector register.
+ASMJIT_ARM_PHYS_REG(ArmVec , v12 , vecv[12]);     //!< 128-bit vector register.
+ASMJIT_ARM_PHYS_REG(ArmVec , v13 , vecv[13]);     //!< 128-bit vector register.
+ASMJIT_ARM_PHYS_REG(ArmVec , v14 , vecv[14]);     //!< 128-bit vector register.
+ASMJIT_ARM_PHYS_REG(ArmVec , v15 , vecv[15]);     //!< 128-bit vector register.
+ASMJIT_ARM_PHYS_REG(ArmVec , v16 , vecv[16]);     //!< 128-bit vector register.
+ASMJIT_ARM_PHYS_REG(ArmVec , v17 , vecv[17]);     //!< 128-bit vector register.
+ASMJIT_ARM_PHYS_REG(ArmVec , v18 , vecv[18]);     //!< 128-bit vector register.
+ASMJIT_ARM_PHYS_REG(ArmVec , v19 , vecv[19]);     //!< 128-bit vector register.
+ASMJIT_ARM_PHYS_REG(ArmVec , v20 , vecv[20]);     //!< 128-bit vector register.
+ASMJIT_ARM_PHYS_REG(ArmVec , v21 , vecv[21]);     //!< 128-bit vector register.
+ASMJIT_ARM_PHYS_REG(ArmVec , v22 , vecv[22]);     //!< 128-bit vector register.
+ASMJIT_ARM_PHYS_REG(ArmVec , v23 , vecv[23]);     //!< 128-bit vector register.
+ASMJIT_ARM_PHYS_REG(ArmVec , v24 , vecv[24]);     //!< 128-bit vector register.
+ASMJIT_ARM_PHYS_REG(ArmVec , v25 , vecv[25]);     //!< 128-bit vector register.
+ASMJIT_ARM_PHYS_REG(ArmVec , v26 , vecv[26]);     //!< 128-bit vector register.
+ASMJIT_ARM_PHYS_REG(ArmVec , v27 , vecv[27]);     //!< 128-bit vector register.
+ASMJIT_ARM_PHYS_REG(ArmVec , v28 , vecv[28]);     //!< 128-bit vector register.
+ASMJIT_ARM_PHYS_REG(ArmVec , v29 , vecv[29]);     //!< 128-bit vector register.
+ASMJIT_ARM_PHYS_REG(ArmVec , v30 , vecv[30]);     //!< 128-bit vector register.
+ASMJIT_ARM_PHYS_REG(ArmVec , v31 , vecv[31]);     //!< 128-bit vector register.
+
+#undef ASMJIT_ARM_PHYS_REG
+} // anonymous namespace
+#endif // !ASMJIT_EXPORTS_ARM_OPERAND
+
+//! Create a 32-bit GPW register operand.
+static ASMJIT_INLINE ArmGpW gpw(uint32_t rId) noexcept { return ArmGpW(rId); }
+//! Create a 64-bit GPX register operand.
+static ASMJIT_INLINE ArmGpX gpx(uint32_t rId) noexcept { return ArmGpX(rId); }
+//! Create a 32-bit view of a vector register operand.
+static ASMJIT_INLINE ArmVecS s(uint32_t rId) noexcept { return ArmVecS(rId); }
+//! Create a 64-bit view of a vector register operand.
+static ASMJIT_INLINE ArmVecD d(uint32_t rId) noexcept { return ArmVecD(rId); }
+//! Create a 128-bit vector register operand.
+static ASMJIT_INLINE ArmVecV v(uint32_t rId) noexcept { return ArmVecV(rId); }
+
+// ============================================================================
+// [asmjit::arm - Ptr]
+// ============================================================================
+
+//! Create a `[base, #offset]` memory operand.
+static ASMJIT_INLINE ArmMem ptr(const ArmGp& base, int32_t offset = 0, uint32_t size = 0) noexcept {
+  return ArmMem(base, offset, size);
+}
+//! Create a `[base, index, lsl #shift]` memory operand.
+static ASMJIT_INLINE ArmMem ptr(const ArmGp& base, const ArmGp& index, uint32_t shift = 0, uint32_t size = 0) noexcept {
+  return ArmMem(base, index, shift, size);
+}
+//! Create a `[base, #offset]!` (pre-index) memory operand.
+static ASMJIT_INLINE ArmMem ptr_pre(const ArmGp& base, int32_t offset, uint32_t size = 0) noexcept {
+  return ArmMem(base, offset, size, ArmMem::kModePreIndex << ArmMem::kSignatureMemModeShift);
+}
+//! Create a `[base], #offset` (post-index) memory operand.
+static ASMJIT_INLINE ArmMem ptr_post(const ArmGp& base, int32_t offset, uint32_t size = 0) noexcept {
+  return ArmMem(base, offset, size, ArmMem::kModePostIndex << ArmMem::kSignatureMemModeShift);
+}
+//! Create a `label + offset` memory operand (PC relative literal).
+static ASMJIT_INLINE ArmMem ptr(const Label& base, int32_t offset = 0, uint32_t size = 0) noexcept {
+  return ArmMem(base, offset, size);
+}
+
+} // arm namespace
+
+//! \}
+
+} // asmjit namespace
+
+// [Api-End]
+#include "../asmjit_apiend.h"
+
+// [Guard]
+#endif // _ASMJIT_ARM_ARMOPERAND_H
@@ -0,0 +1,1646 @@
+// [AsmJit]
+// Complete x86/x64 JIT and Remote Assembler for C++.
+//
+// [License]
+// Zlib - See LICENSE.md file in the package.
+
+// [Export]
+#define ASMJIT_EXPORTS
+
+// [Guard]
+#include "../asmjit_build.h"
+#if defined(ASMJIT_BUILD_ARM) && !defined(ASMJIT_DISABLE_COMPILER)
+
+// [Dependencies]
+#include "../base/cpuinfo.h"
+#include "../base/utils.h"
+#include "../arm/armcompiler.h"
+#include "../arm/arminternal_p.h"
+#include "../arm/armregalloc_p.h"
+
+// [Api-Begin]
+#include "../asmjit_apibegin.h"
+
+namespace asmjit {
+
+// ============================================================================
+// [asmjit::ArmRAPass - Helpers]
+// ============================================================================
+
+//! \internal
+//!
+//! NZCV flags, the only special register tracked by `canRemoveDead()`.
+static const uint32_t ArmRAPass_kNZCV = 0x1U;
+
+//! \internal
+//!
+//! Get whether `vreg` is alive at a node that has `liveness`. Nodes that don't
+//! lead to a return have no liveness, everything is alive there.
+static ASMJIT_INLINE bool ArmRAPass_isLive(const RABits* liveness, const VirtReg* vreg) noexcept {
+  return !liveness || liveness->getBit(vreg->_raId) != 0;
+}
+
+//! \internal
+//!
+//! Get whether `vreg` is currently assigned to the register of `value`.
+static ASMJIT_INLINE bool ArmRAPass_isInReg(const VirtReg* vreg, const FuncDetail::Value& value) noexcept {
+  return vreg->getState() == VirtReg::kStateReg &&
+         vreg->getKind() == ArmReg::kindOf(value.getRegType()) &&
+         vreg->getPhysId() == value.getRegId();
+}
+
+//! \internal
+static ASMJIT_INLINE bool ArmRAPass_isCallInst(uint32_t instId) noexcept {
+  return instId == ArmInst::kIdBl || instId == ArmInst::kIdBlr;
+}
+
+// ============================================================================
+// [asmjit::ArmRAPass - Construction / Destruction]
+// ============================================================================
+
+ArmRAPass::ArmRAPass() noexcept : RAPass() {
+  _varMapToVaListOffset = ASMJIT_OFFSET_OF(ArmRAData, tiedArray);
+}
+ArmRAPass::~ArmRAPass() noexcept {}
+
+// ============================================================================
+// [asmjit::ArmRAPass - Interface]
+// ============================================================================
+
+Error ArmRAPass::process(Zone* zone) noexcept {
+  return Base::process(zone);
+}
+
+Error ArmRAPass::prepare(CCFunc* func) noexcept {
+  ASMJIT_PROPAGATE(Base::prepare(func));
+
+  // The allocator is local, there are no live-ranges or loops to build.
+  _linearScan = 0;
+  _globalAlloc = 0;
+
+  // X16|X17 are scratch registers used by calls and veneers, X18 is reserved
+  // by some platforms, and X29|X30|SP are never allocated.
+  ::memset(_gaRegs, 0, sizeof(_gaRegs));
+  _gaRegs[ArmReg::kKindGp ] = Utils::bits(16) | (Utils::bits(10) << 19);
+  _gaRegs[ArmReg::kKindVec] = 0xFFFFFFFFU;
+
+  ::memset(_occupied, 0, sizeof(_occupied));
+  ::memset(_physToVReg, 0, sizeof(_physToVReg));
+  _clobberedRegs.reset();
+
+  _varBaseRegId = Globals::kInvalidRegId; // Used by patcher.
+  _varBaseOffset = 0;                     // Used by patcher.
+
+  return kErrorOk;
+}
+
+// ============================================================================
+// [asmjit::ArmRAPass - Emit]
+// ============================================================================
+
+Error ArmRAPass::emitLoad(VirtReg* vReg, uint32_t id, const char* reason) {
+  const char* comment = nullptr;
+  if (_emitComments) {
+    _stringBuilder.setFormat("[%s] %s", reason, vReg->getName());
+    comment = _stringBuilder.getData();
+  }
+
+  _stats.loadCount += _statsEnabled;
+
+  ArmReg dst(ArmReg::fromSignature(vReg->getSignature(), id));
+  ArmMem src(getVarMem(vReg));
+  ASMJIT_PROPAGATE(ArmInternal::emitRegMove(reinterpret_cast<ArmEmitter*>(cc()), dst, src, vReg->getTypeId(), comment));
+  return addReportMove(CCFuncReport::kMoveLoad, vReg);
+}
+
+Error ArmRAPass::emitSave(VirtReg* vReg, uint32_t id, const char* reason) {
+  const char* comment = nullptr;
+  if (_emitComments) {
+    _stringBuilder.setFormat("[%s] %s", reason, vReg->getName());
+    comment = _stringBuilder.getData();
+  }
+
+  _stats.spillCount += _statsEnabled;
+
+  ArmMem dst(getVarMem(vReg));
+  ArmReg src(ArmReg::fromSignature(vReg->getSignature(), id));
+  ASMJIT_PROPAGATE(ArmInternal::emitRegMove(reinterpret_cast<ArmEmitter*>(cc()), dst, src, vReg->getTypeId(), comment));
+  return addReportMove(CCFuncReport::kMoveSpill, vReg);
+}
+
+// ============================================================================
+// [asmjit::ArmRAPass - Register Management]
+// ============================================================================
+
+Error ArmRAPass::spill(VirtReg* vreg, bool save, bool unuse, const char* reason) {
+  if (vreg->getState() != VirtReg::kStateReg)
+    return kErrorOk;
+
+  if (save && vreg->isModified()) {
+    ASMJIT_PROPAGATE(emitSave(vreg, vreg->getPhysId(), reason));
+    vreg->setModified(false);
+  }
+
+  if (unuse)
+    detach(vreg);
+  return kErrorOk;
+}
+
+Error ArmRAPass::saveLive(RABits* liveness, const char* reason) {
+  for (uint32_t kind = 0; kind < Globals::kMaxVRegKinds; kind++) {
+    uint32_t occupied = _occupied[kind];
+
+    while (occupied) {
+      uint32_t physId = Utils::findFirstBit(occupied);
+      occupied &= occupied - 1;
+
+      VirtReg* vreg = _physToVReg[kind][physId];
+      if (ArmRAPass_isLive(liveness, vreg))
+        ASMJIT_PROPAGATE(spill(vreg, true, false, reason));
+    }
+  }
+
+  return kErrorOk;
+}
+
+void ArmRAPass::detachAll() noexcept {
+  for (uint32_t kind = 0; kind < Globals::kMaxVRegKinds; kind++) {
+    uint32_t occupied = _occupied[kind];
+
+    while (occupied) {
+      uint32_t physId = Utils::findFirstBit(occupied);
+      occupied &= occupied - 1;
+      detach(_physToVReg[kind][physId]);
+    }
+  }
+}
+
+Error ArmRAPass::spillClobbered(const FuncDetail& fd, RABits* liveness, bool save) {
+  for (uint32_t kind = 0; kind < Globals::kMaxVRegKinds; kind++) {
+    uint32_t preserved = fd.getPreservedRegs(kind);
+    uint32_t occupied = _occupied[kind];
+
+    while (occupied) {
+      uint32_t physId = Utils::findFirstBit(occupied);
+      occupied &= occupied - 1;
+
+      // AAPCS64 only preserves the low 64 bits of V8..V15.
+      VirtReg* vreg = _physToVReg[kind][physId];
+      if ((preserved & Utils::mask(physId)) && !(kind == ArmReg::kKindVec && vreg->getRegSize() > 8))
+        continue;
+
+      ASMJIT_PROPAGATE(spill(vreg, save && ArmRAPass_isLive(liveness, vreg), true, "call"));
+    }
+  }
+
+  return kErrorOk;
+}
+
+Error ArmRAPass::allocReg(uint32_t kind, uint32_t exclude, RABits* liveness, uint32_t& physIdOut) {
+  uint32_t available = _gaRegs[kind] & ~exclude;
+  uint32_t free = available & ~_occupied[kind];
+
+  if (free) {
+    // Prefer callee-saved registers if the function calls others, they don't
+    // have to be spilled around calls, scratch registers otherwise as they
+    // don't have to be saved by the prolog.
+    uint32_t preserved = getFunc()->getDetail().getPreservedRegs(kind);
+    uint32_t preferred = getFunc()->getFrameInfo().hasCalls() ? free & preserved : free & ~preserved;
+
+    physIdOut = Utils::findFirstBit(preferred ? preferred : free);
+    return kErrorOk;
+  }
+
+  if (ASMJIT_UNLIKELY(!available))
+    return DebugUtils::errored(kErrorInvalidState);
+
+  // Reuse a register of a virtual register that is not alive anymore, spill
+  // the first one otherwise.
+  uint32_t candidates = available;
+  uint32_t physId = Utils::findFirstBit(available);
+
+  while (candidates) {
+    uint32_t id = Utils::findFirstBit(candidates);
+    candidates &= candidates - 1;
+
+    if (!ArmRAPass_isLive(liveness, _physToVReg[kind][id])) {
+      physId = id;
+      break;
+    }
+  }
+
+  VirtReg* vreg = _physToVReg[kind][physId];
+  ASMJIT_PROPAGATE(spill(vreg, ArmRAPass_isLive(liveness, vreg), true, "spill"));
+
+  physIdOut = physId;
+  return kErrorOk;
+}
+
+// ============================================================================
+// [asmjit::ArmRAPass - State]
+// ============================================================================
+
+// Registers are detached at every label, so there is no state to carry
+// between blocks and all these are no-ops.
+void ArmRAPass::loadState(RAState* src) {
+  ASMJIT_UNUSED(src);
+}
+
+RAState* ArmRAPass::saveState() {
+  return nullptr;
+}
+
+void ArmRAPass::switchState(RAState* src) {
+  ASMJIT_UNUSED(src);
+}
+
+void ArmRAPass::intersectStates(RAState* a, RAState* b) {
+  ASMJIT_UNUSED(a);
+  ASMJIT_UNUSED(b);
+}
+
+// ============================================================================
+// [asmjit::ArmRAPass - GetJccFlow / GetOppositeJccFlow]
+// ============================================================================
+
+//! \internal
+static ASMJIT_INLINE CBNode* ArmRAPass_getJccFlow(CBJump* jNode) {
+  if (jNode->isTaken())
+    return jNode->getTarget();
+  else
+    return jNode->getNext();
+}
+
+//! \internal
+static ASMJIT_INLINE CBNode* ArmRAPass_getOppositeJccFlow(CBJump* jNode) {
+  if (jNode->isTaken())
+    return jNode->getNext();
+  else
+    return jNode->getTarget();
+}
+
+// ============================================================================
+// [asmjit::ArmRAPass - Fetch]
+// ============================================================================
+
+Error ArmRAPass::fetch() {
+  CCFunc* func = getFunc();
+
+  CBNode* node_ = func;
+  CBNode* next = nullptr;
+  CBNode* stop = getStop();
+
+  TiedReg agTmp[80];
+
+  uint32_t position = 0;
+  ZoneList<CBNode*>::Link* jLink = nullptr;
+
+  // Global allocable registers.
+  uint32_t* gaRegs = _gaRegs;
+
+  // --------------------------------------------------------------------------
+  // [VI Macros]
+  // --------------------------------------------------------------------------
+
+#define RA_POPULATE(NODE) \
+  do { \
+    ArmRAData* raData = newRAData(0); \
+    if (!raData) goto NoMem; \
+    NODE->setPassData(raData); \
+  } while (0)
+
+#define RA_DECLARE() \
+  do { \
+    uint32_t tiedTotal = 0
+
+#define RA_FINALIZE(NODE) \
+    { \
+      ArmRAData* raData = newRAData(tiedTotal); \
+      if (!raData) goto NoMem; \
+      \
+      for (uint32_t _index = 0; _index < tiedTotal; _index++) { \
+        TiedReg* tied = &agTmp[_index]; \
+        \
+        tied->vreg->_tied = nullptr; \
+        raData->setTiedAt(_index, *tied); \
+      } \
+      NODE->setPassData(raData); \
+     } \
+  } while (0)
+
+#define RA_INSERT(REG, TIED, FLAGS, NEW_ALLOCABLE) \
+  do { \
+    ASMJIT_ASSERT(REG->_tied == nullptr); \
+    TIED = &agTmp[tiedTotal++]; \
+    TIED->init(REG, FLAGS, 0, NEW_ALLOCABLE); \
+    TIED->refCount++; \
+    REG->_tied = TIED; \
+    \
+    if (assignRAId(REG) != kErrorOk) goto NoMem; \
+  } while (0)
+
+#define RA_MERGE(REG, TIED, FLAGS, NEW_ALLOCABLE) \
+  do { \
+    TIED = REG->_tied; \
+    \
+    if (!TIED) { \
+      TIED = &agTmp[tiedTotal++]; \
+      TIED->init(REG, 0, 0, NEW_ALLOCABLE); \
+      REG->_tied = TIED; \
+      \
+      if (assignRAId(REG) != kErrorOk) goto NoMem; \
+    } \
+    \
+    TIED->flags |= FLAGS; \
+    TIED->refCount++; \
+  } while (0)
+
+  // --------------------------------------------------------------------------
+  // [Loop]
+  // --------------------------------------------------------------------------
+
+  do {
+_Do:
+    while (node_->hasPassData()) {
+_NextGroup:
+      if (!jLink)
+        jLink = _jccList.getFirst();
+      else
+        jLink = jLink->getNext();
+
+      if (!jLink) goto _Done;
+      node_ = ArmRAPass_getOppositeJccFlow(static_cast<CBJump*>(jLink->getValue()));
+    }
+
+    position++;
+
+    next = node_->getNext();
+    node_->setPosition(position);
+
+    switch (node_->getType()) {
+      // ----------------------------------------------------------------------
+      // [Align/Embed]
+      // ----------------------------------------------------------------------
+
+      case CBNode::kNodeAlign:
+      case CBNode::kNodeData:
+      default:
+        RA_POPULATE(node_);
+        break;
+
+      // ----------------------------------------------------------------------
+      // [Hint]
+      // ----------------------------------------------------------------------
+
+      case CBNode::kNodeHint: {
+        CCHint* node = static_cast<CCHint*>(node_);
+
+        // Registers are assigned when they are used, alloc-hints are ignored.
+        if (node->getHint() == CCHint::kHintAlloc) {
+          RA_POPULATE(node_);
+          break;
+        }
+
+        RA_DECLARE();
+        VirtReg* vreg = static_cast<VirtReg*>(node->getVReg());
+        TiedReg* tied;
+
+        uint32_t flags = 0;
+        switch (node->getHint()) {
+          case CCHint::kHintSpill       : flags = TiedReg::kRMem | TiedReg::kSpill; break;
+          case CCHint::kHintSave        : flags = TiedReg::kRMem                  ; break;
+          case CCHint::kHintSaveAndUnuse: flags = TiedReg::kRMem | TiedReg::kUnuse; break;
+          case CCHint::kHintUnuse       : flags = TiedReg::kUnuse                 ; break;
+        }
+        RA_INSERT(vreg, tied, flags, 0);
+
+        RA_FINALIZE(node_);
+        break;
+      }
+
+      // ----------------------------------------------------------------------
+      // [Label]
+      // ----------------------------------------------------------------------
+
+      case CBNode::kNodeLabel: {
+        RA_POPULATE(node_);
+        if (node_ == func->getExitNode()) {
+          ASMJIT_PROPAGATE(addReturningNode(node_));
+          goto _NextGroup;
+        }
+        break;
+      }
+
+      // ----------------------------------------------------------------------
+      // [Inst]
+      // ----------------------------------------------------------------------
+
+      case CBNode::kNodeInst: {
+        CBInst* node = static_cast<CBInst*>(node_);
+
+        uint32_t instId = node->getInstId();
+        uint32_t options = node->getOptions();
+
+        const Operand* opArray = node->getOpArray();
+        uint32_t opCount = node->getOpCount();
+
+        RA_DECLARE();
+        if (opCount) {
+          const ArmInst::CommonData& commonData = ArmInst::getInst(instId).getCommonData();
+
+          if (commonData.isFp())
+            node->orFlags(CBNode::kFlagIsFp);
+
+          for (uint32_t i = 0; i < opCount; i++) {
+            const Operand* op = &opArray[i];
+            VirtReg* vreg;
+            TiedReg* tied;
+
+            if (op->isVirtReg()) {
+              vreg = cc()->getVirtRegById(op->getId());
+              if (vreg->isFixed()) continue;
+
+              RA_MERGE(vreg, tied, 0, gaRegs[vreg->getKind()]);
+
+              // The first operand is the destination unless the instruction
+              // only reads it (stores, compares, and branches), the second one
+              // is also written by LDP. A write of a W|S|D view clears the
+              // upper part of the register, so it's always a full write.
+              uint32_t combinedFlags = TiedReg::kRReg;
+              if (i == 0) {
+                if (options & CodeEmitter::kOptionOverwrite)
+                  combinedFlags = TiedReg::kWReg;
+                else if (commonData.isUseW())
+                  combinedFlags = TiedReg::kWReg;
+                else if (commonData.isUseX())
+                  combinedFlags = TiedReg::kXReg;
+              }
+              else if (i == 1 && commonData.isUseW2()) {
+                combinedFlags = TiedReg::kWReg;
+              }
+              tied->flags |= combinedFlags;
+            }
+            else if (op->isMem()) {
+              const ArmMem* m = static_cast<const ArmMem*>(op);
+              node->setMemOpIndex(i);
+
+              if (m->hasBaseReg()) {
+                uint32_t id = m->getBaseId();
+                if (cc()->isVirtRegValid(id)) {
+                  vreg = cc()->getVirtRegById(id);
+                  if (!vreg->isStack() && !vreg->isFixed()) {
+                    RA_MERGE(vreg, tied, 0, gaRegs[vreg->getKind()]);
+                    if (m->isRegHome()) {
+                      // The home slot of the register is accessed directly.
+                      tied->flags |= TiedReg::kRMem | TiedReg::kWMem;
+                    }
+                    else {
+                      // Pre-index and post-index addressing writes the base back.
+                      tied->flags |= (m->isPreIndex() || m->isPostIndex()) ? TiedReg::kXReg : TiedReg::kRReg;
+                    }
+                  }
+                }
+              }
+
+              if (m->hasIndexReg()) {
+                uint32_t id = m->getIndexId();
+                if (cc()->isVirtRegValid(id)) {
+                  vreg = cc()->getVirtRegById(id);
+                  if (!vreg->isFixed()) {
+                    RA_MERGE(vreg, tied, 0, gaRegs[ArmReg::kKindGp]);
+                    tied->flags |= TiedReg::kRReg;
+                  }
+                }
+              }
+            }
+          }
+
+          // Calls emitted as plain instructions need a frame record for LR.
+          if (ArmRAPass_isCallInst(instId))
+            func->getFrameInfo().enableCalls();
+        }
+
+        RA_FINALIZE(node_);
+
+        // Handle conditional/unconditional jump.
+        if (node->isJmpOrJcc()) {
+          CBJump* jNode = static_cast<CBJump*>(node);
+          CBLabel* jTarget = jNode->getTarget();
+
+          // If this jump is unconditional we put next node to unreachable node
+          // list so we can eliminate possible dead code. We have to do this in
+          // all cases since we are unable to translate without fetch() step.
+          //
+          // We also advance our node pointer to the target node to simulate
+          // natural flow of the function.
+          if (jNode->isJmp()) {
+            if (next && !next->hasPassData())
+              ASMJIT_PROPAGATE(addUnreachableNode(next));
+
+            // Jump not followed.
+            if (!jTarget) {
+              ASMJIT_PROPAGATE(addReturningNode(jNode));
+              goto _NextGroup;
+            }
+
+            node_ = jTarget;
+            goto _Do;
+          }
+          else {
+            // Jump not followed.
+            if (!jTarget) break;
+
+            if (jTarget->hasPassData()) {
+              uint32_t jTargetPosition = jTarget->getPosition();
+
+              // Update CBNode::kFlagIsTaken to true if this is a conditional
+              // backward jump.
+              if (!jNode->isTaken() && jTargetPosition <= position)
+                jNode->orFlags(CBNode::kFlagIsTaken);
+            }
+            else if (next->hasPassData()) {
+              node_ = jTarget;
+              goto _Do;
+            }
+            else {
+              ASMJIT_PROPAGATE(addJccNode(jNode));
+              node_ = ArmRAPass_getJccFlow(jNode);
+              goto _Do;
+            }
+          }
+        }
+        break;
+      }
+
+      // ----------------------------------------------------------------------
+      // [Func-Entry]
+      // ----------------------------------------------------------------------
+
+      case CBNode::kNodeFunc: {
+        ASMJIT_ASSERT(node_ == func);
+
+        FuncDetail& fd = func->getDetail();
+        TiedReg* tied;
+
+        RA_DECLARE();
+        cc()->setCursor(node_);
+
+        uint32_t argCount = fd.getArgCount();
+        for (uint32_t i = 0; i < argCount; i++) {
+          const FuncDetail::Value& arg = fd.getArg(i);
+
+          VirtReg* vReg = func->getArg(i);
+          if (!vReg) continue;
+
+          // Overlapped function arguments.
+          if (vReg->_tied)
+            return DebugUtils::errored(kErrorOverlappedRegs);
+
+          ArmReg dstReg(ArmReg::fromSignature(vReg->getSignature(), vReg->getId()));
+
+          if (arg.byReg()) {
+            uint32_t aKind = ArmReg::kindOf(arg.getRegType());
+            uint32_t vKind = vReg->getKind();
+
+            if (aKind == vKind) {
+              RA_INSERT(vReg, tied, TiedReg::kWReg, 0);
+              tied->setOutPhysId(arg.getRegId());
+            }
+            else {
+              ArmReg rTmp = cc()->newReg(arg.getTypeId(), "arg%u", i);
+              VirtReg* vTmp = cc()->getVirtReg(rTmp);
+              if (!vTmp) goto NoMem;
+
+              RA_INSERT(vTmp, tied, TiedReg::kWReg, 0);
+              tied->setOutPhysId(arg.getRegId());
+
+              // Emit conversion after the prolog.
+              ASMJIT_PROPAGATE(
+                ArmInternal::emitArgMove(reinterpret_cast<ArmEmitter*>(cc()),
+                  dstReg, vReg->getTypeId(), rTmp, vTmp->getTypeId()));
+            }
+          }
+          else {
+            // Arguments passed by stack are loaded after the prolog, the
+            // offset is relative to the stack pointer at the function entry.
+            ArmMem aMem = arm::ptr(arm::sp, arg.getStackOffset());
+            aMem.setArgHome();
+
+            ASMJIT_PROPAGATE(
+              ArmInternal::emitArgMove(reinterpret_cast<ArmEmitter*>(cc()),
+                dstReg, vReg->getTypeId(), aMem, arg.getTypeId()));
+          }
+        }
+
+        RA_FINALIZE(node_);
+        next = node_->getNext();
+        break;
+      }
+
+      // ----------------------------------------------------------------------
+      // [End]
+      // ----------------------------------------------------------------------
+
+      case CBNode::kNodeSentinel: {
+        RA_POPULATE(node_);
+        ASMJIT_PROPAGATE(addReturningNode(node_));
+        goto _NextGroup;
+      }
+
+      // ----------------------------------------------------------------------
+      // [Func-Exit]
+      // ----------------------------------------------------------------------
+
+      case CBNode::kNodeFuncExit: {
+        CCFuncRet* node = static_cast<CCFuncRet*>(node_);
+        ASMJIT_PROPAGATE(addReturningNode(node));
+
+        RA_DECLARE();
+        for (uint32_t i = 0; i < 2; i++) {
+          Operand_* op = &node->_ret[i];
+          if (op->isVirtReg()) {
+            VirtReg* vreg = cc()->getVirtRegById(op->getId());
+            TiedReg* tied;
+            RA_MERGE(vreg, tied, TiedReg::kRReg, 0);
+          }
+        }
+        RA_FINALIZE(node_);
+
+        if (!next->hasPassData())
+          ASMJIT_PROPAGATE(addUnreachableNode(next));
+        goto _NextGroup;
+      }
+
+      // ----------------------------------------------------------------------
+      // [Func-Call]
+      // ----------------------------------------------------------------------
+
+      case CBNode::kNodeFuncCall: {
+        CCFuncCall* node = static_cast<CCFuncCall*>(node_);
+        FuncDetail& fd = node->getDetail();
+
+        Operand_* target = node->_opArray;
+        Operand_* args = node->_args;
+        Operand_* rets = node->_ret;
+
+        uint32_t i;
+        uint32_t argCount = fd.getArgCount();
+
+        // A tail call doesn't need a call frame.
+        uint32_t instId = node->getInstId();
+        if (instId != ArmInst::kIdB && instId != ArmInst::kIdBr) {
+          func->getFrameInfo().enableCalls();
+          func->getFrameInfo().mergeCallFrameSize(fd.getArgStackSize());
+        }
+
+        VirtReg* vreg;
+        TiedReg* tied;
+
+        RA_DECLARE();
+
+        // Function-call operand.
+        if (target->isVirtReg()) {
+          vreg = cc()->getVirtRegById(target->getId());
+          RA_MERGE(vreg, tied, TiedReg::kRReg | TiedReg::kRCall, 0);
+        }
+
+        // Function-call arguments, both passed by registers and by stack.
+        for (i = 0; i < argCount; i++) {
+          Operand_* op = &args[i];
+          if (!op->isVirtReg()) continue;
+
+          vreg = cc()->getVirtRegById(op->getId());
+          RA_MERGE(vreg, tied, TiedReg::kRReg | TiedReg::kRFunc, 0);
+        }
+
+        // Function-call returns.
+        for (i = 0; i < 2; i++) {
+          Operand_* op = &rets[i];
+          if (!op->isVirtReg()) continue;
+
+          vreg = cc()->getVirtRegById(op->getId());
+          RA_MERGE(vreg, tied, TiedReg::kWReg | TiedReg::kWFunc, 0);
+        }
+
+        RA_FINALIZE(node_);
+        break;
+      }
+    }
+
+    node_ = next;
+  } while (node_ != stop);
+
+_Done:
+  // Mark exit label and end node as fetched, otherwise they can be removed by
+  // `removeUnreachableCode()`, which could lead to a crash in some later step.
+  node_ = func->getEnd();
+  if (!node_->hasPassData()) {
+    CBLabel* fExit = func->getExitNode();
+    RA_POPULATE(fExit);
+    fExit->setPosition(++position);
+
+    RA_POPULATE(node_);
+    node_->setPosition(++position);
+  }
+  return kErrorOk;
+
+  // --------------------------------------------------------------------------
+  // [Failure]
+  // --------------------------------------------------------------------------
+
+NoMem:
+  return DebugUtils::errored(kErrorNoHeapMemory);
+
+#undef RA_MERGE
+#undef RA_INSERT
+#undef RA_FINALIZE
+#undef RA_DECLARE
+#undef RA_POPULATE
+}
+
+// ============================================================================
+// [asmjit::ArmRAPass - Coalesce]
+// ============================================================================
+
+bool ArmRAPass::isCopy(CBNode* node_, VirtReg** pDst, VirtReg** pSrc) {
+  if (node_->getType() != CBNode::kNodeInst)
+    return false;
+
+  CBInst* node = static_cast<CBInst*>(node_);
+  if (node->getOpCount() != 2 || (node->getOptions() & ~CodeEmitter::kOptionReservedMask) || node->hasExtraReg())
+    return false;
+
+  uint32_t instId = node->getInstId();
+  if (instId != ArmInst::kIdMov && instId != ArmInst::kIdFmov)
+    return false;
+
+  const Operand* opArray = node->getOpArray();
+  if (!opArray[0].isReg() || !opArray[1].isReg() ||
+      !Operand::isPackedId(opArray[0].getId()) ||
+      !Operand::isPackedId(opArray[1].getId()))
+    return false;
+
+  VirtReg* dst = cc()->getVirtRegById(opArray[0].getId());
+  VirtReg* src = cc()->getVirtRegById(opArray[1].getId());
+
+  // Both operands have to be used as a whole register of the same type.
+  if (dst->isFixed() || dst->isStack() || src->isFixed() || src->isStack() ||
+      dst->getTypeId() != src->getTypeId() ||
+      opArray[0].getSignature() != dst->getSignature() ||
+      opArray[1].getSignature() != src->getSignature())
+    return false;
+
+  *pDst = dst;
+  *pSrc = src;
+  return true;
+}
+
+// ============================================================================
+// [asmjit::ArmRAPass - Dead Code]
+// ============================================================================
+
+//! \internal
+//!
+//! Get NZCV flags read and written by `instId` and whether it has no effect
+//! other than writing its destination and flags.
+static bool ArmRAPass_getArithFlags(uint32_t instId, uint32_t& r, uint32_t& w) noexcept {
+  r = 0;
+  w = 0;
+
+  switch (instId) {
+    case ArmInst::kIdAdc:
+    case ArmInst::kIdSbc:
+    case ArmInst::kIdCsel:
+    case ArmInst::kIdCset:
+    case ArmInst::kIdCsetm:
+    case ArmInst::kIdCsinc:
+    case ArmInst::kIdCsinv:
+    case ArmInst::kIdCsneg:
+      r = ArmRAPass_kNZCV;
+      return true;
+
+    case ArmInst::kIdAdcs:
+    case ArmInst::kIdSbcs:
+      r = ArmRAPass_kNZCV;
+      w = ArmRAPass_kNZCV;
+      return true;
+
+    case ArmInst::kIdAdds:
+    case ArmInst::kIdAnds:
+    case ArmInst::kIdBics:
+    case ArmInst::kIdCmn:
+    case ArmInst::kIdCmp:
+    case ArmInst::kIdFcmp:
+    case ArmInst::kIdNegs:
+    case ArmInst::kIdSubs:
+    case ArmInst::kIdTst:
+      w = ArmRAPass_kNZCV;
+      return true;
+
+    case ArmInst::kIdAdd:
+    case ArmInst::kIdAnd:
+    case ArmInst::kIdAsr:
+    case ArmInst::kIdBic:
+    case ArmInst::kIdCls:
+    case ArmInst::kIdClz:
+    case ArmInst::kIdEon:
+    case ArmInst::kIdEor:
+    case ArmInst::kIdFabs:
+    case ArmInst::kIdFadd:
+    case ArmInst::kIdFcvt:
+    case ArmInst::kIdFcvtzs:
+    case ArmInst::kIdFcvtzu:
+    case ArmInst::kIdFdiv:
+    case ArmInst::kIdFmadd:
+    case ArmInst::kIdFmax:
+    case ArmInst::kIdFmin:
+    case ArmInst::kIdFmov:
+    case ArmInst::kIdFmsub:
+    case ArmInst::kIdFmul:
+    case ArmInst::kIdFneg:
+    case ArmInst::kIdFsqrt:
+    case ArmInst::kIdFsub:
+    case ArmInst::kIdLsl:
+    case ArmInst::kIdLsr:
+    case ArmInst::kIdMadd:
+    case ArmInst::kIdMneg:
+    case ArmInst::kIdMov:
+    case ArmInst::kIdMovk:
+    case ArmInst::kIdMovn:
+    case ArmInst::kIdMovz:
+    case ArmInst::kIdMsub:
+    case ArmInst::kIdMul:
+    case ArmInst::kIdMvn:
+    case ArmInst::kIdNeg:
+    case ArmInst::kIdOrn:
+    case ArmInst::kIdOrr:
+    case ArmInst::kIdRbit:
+    case ArmInst::kIdRev:
+    case ArmInst::kIdRev16:
+    case ArmInst::kIdRor:
+    case ArmInst::kIdScvtf:
+    case ArmInst::kIdSdiv:
+    case ArmInst::kIdSmulh:
+    case ArmInst::kIdSub:
+    case ArmInst::kIdSxtb:
+    case ArmInst::kIdSxth:
+    case ArmInst::kIdSxtw:
+    case ArmInst::kIdUcvtf:
+    case ArmInst::kIdUdiv:
+    case ArmInst::kIdUmulh:
+    case ArmInst::kIdUxtb:
+    case ArmInst::kIdUxth:
+      return true;
+
+    default:
+      // Loads, stores, branches, and system instructions.
+      r = 0xFFFFFFFFU;
+      return false;
+  }
+}
+
+bool ArmRAPass::canRemoveDead(CBNode* node_, uint32_t* flagsR, uint32_t* flagsW) {
+  // Nodes other than instructions may read anything.
+  *flagsR = 0xFFFFFFFFU;
+  *flagsW = 0;
+
+  if (node_->getType() != CBNode::kNodeInst || node_->isJmpOrJcc())
+    return false;
+
+  CBInst* node = static_cast<CBInst*>(node_);
+  if (!ArmRAPass_getArithFlags(node->getInstId(), *flagsR, *flagsW))
+    return false;
+
+  const Operand* opArray = node->getOpArray();
+  uint32_t opCount = node->getOpCount();
+
+  if (!opCount || node->hasExtraReg())
+    return false;
+
+  // Registers must be virtual, otherwise the node has effects that liveness
+  // of virtual registers doesn't describe.
+  for (uint32_t i = 0; i < opCount; i++) {
+    const Operand& op = opArray[i];
+    if (op.isReg()) {
+      if (!op.isVirtReg() || cc()->getVirtRegById(op.getId())->isFixed())
+        return false;
+    }
+    else if (!op.isImm()) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+// ============================================================================
+// [asmjit::ArmRAPass - Annotate]
+// ============================================================================
+
+Error ArmRAPass::annotate() {
+#if !defined(ASMJIT_DISABLE_LOGGING)
+  CCFunc* func = getFunc();
+
+  CBNode* node_ = func;
+  CBNode* end = func->getEnd();
+
+  Zone& dataZone = cc()->_cbDataZone;
+  StringBuilderTmp<256> sb;
+
+  uint32_t maxLen = 0;
+  while (node_ && node_ != end) {
+    if (!node_->hasInlineComment()) {
+      if (node_->getType() == CBNode::kNodeInst) {
+        CBInst* node = static_cast<CBInst*>(node_);
+        Logging::formatInstruction(
+          sb,
+          0,
+          cc(),
+          cc()->getArchType(),
+          node->getInstDetail(), node->getOpArray(), node->getOpCount());
+
+        node_->setInlineComment(
+          static_cast<char*>(dataZone.dup(sb.getData(), sb.getLength(), true)));
+        maxLen = std::max<uint32_t>(maxLen, static_cast<uint32_t>(sb.getLength()));
+
+        sb.clear();
+      }
+    }
+
+    node_ = node_->getNext();
+  }
+  _annotationLength = maxLen + 1;
+#endif // !ASMJIT_DISABLE_LOGGING
+
+  return kErrorOk;
+}
+
+Error ArmRAPass::formatInlineComment(StringBuilder& dst, CBNode* node) {
+#if !defined(ASMJIT_DISABLE_LOGGING)
+  if (node->getType() == CBNode::kNodeFunc) {
+    const CCFuncReport* report = static_cast<CCFunc*>(node)->getReport();
+    if (report) {
+      const uint32_t* live = report->maxLive;
+      const uint32_t* n = report->moveCount;
+
+      return dst.appendFormat(
+        "[RA] live gp=%u vec=%u | spill=%u load=%u remat=%u move=%u (switch=%u) | stack=%u",
+        live[ArmReg::kKindGp], live[ArmReg::kKindVec],
+        n[CCFuncReport::kMoveSpill], n[CCFuncReport::kMoveLoad], n[CCFuncReport::kMoveRemat], n[CCFuncReport::kMoveReg],
+        report->switchMoveCount,
+        report->stackSize);
+    }
+  }
+#endif // !ASMJIT_DISABLE_LOGGING
+
+  return Base::formatInlineComment(dst, node);
+}
+
+// ============================================================================
+// [asmjit::ArmRAPass - Translate - Inst]
+// ============================================================================
+
+//! \internal
+//!
+//! Assign physical registers to all virtual registers used by `node` and
+//! rewrite its operands.
+static Error ArmRAPass_translateInst(ArmRAPass* self, CBInst* node) {
+  ArmCompiler* cc = self->cc();
+
+  ArmRAData* raData = node->getPassData<ArmRAData>();
+  RABits* liveness = raData->liveness;
+
+  TiedReg* tiedArray = raData->getTiedArray();
+  uint32_t tiedTotal = raData->tiedTotal;
+
+  uint32_t instId = node->getInstId();
+  const ArmInst::CommonData& commonData = ArmInst::getInst(instId).getCommonData();
+
+  Operand* opArray = node->getOpArray();
+  uint32_t opCount = node->getOpCount();
+
+  uint32_t locked[Globals::kMaxVRegKinds] = { 0 };
+  uint32_t i, j;
+
+  cc->_setCursor(node->getPrev());
+
+  // Physical registers used by the instruction can't hold virtual registers.
+  for (i = 0; i < opCount; i++) {
+    const Operand& op = opArray[i];
+    uint32_t physIds[2] = { Globals::kInvalidRegId, Globals::kInvalidRegId };
+    uint32_t kind = ArmReg::kKindGp;
+    bool isWrite = false;
+
+    if (op.isReg() && !op.isVirtReg()) {
+      physIds[0] = op.getId();
+      kind = static_cast<const ArmReg&>(op).getKind();
+      isWrite = (i == 0 && !commonData.isUseR()) || (i == 1 && commonData.isUseW2());
+    }
+    else if (op.isMem()) {
+      const ArmMem& m = static_cast<const ArmMem&>(op);
+      if (m.hasBaseReg() && !m.isRegHome() && !cc->isVirtRegValid(m.getBaseId()))
+        physIds[0] = m.getBaseId();
+      if (m.hasIndexReg() && !cc->isVirtRegValid(m.getIndexId()))
+        physIds[1] = m.getIndexId();
+      isWrite = m.isPreIndex() || m.isPostIndex();
+    }
+
+    for (j = 0; j < 2; j++) {
+      uint32_t physId = physIds[j];
+      if (physId >= 32 || kind >= Globals::kMaxVRegKinds) continue;
+
+      VirtReg* vreg = self->_physToVReg[kind][physId];
+      if (vreg)
+        ASMJIT_PROPAGATE(self->spill(vreg, ArmRAPass_isLive(liveness, vreg), true, "evict"));
+
+      locked[kind] |= Utils::mask(physId);
+      if (isWrite && j == 0)
+        self->_clobberedRegs.or_(kind, Utils::mask(physId));
+    }
+  }
+
+  // Calls clobber everything that is not preserved by the callee.
+  bool isCall = ArmRAPass_isCallInst(instId);
+  const FuncDetail& fd = self->getFunc()->getDetail();
+
+  if (isCall)
+    ASMJIT_PROPAGATE(self->spillClobbered(fd, liveness, true));
+
+  // Registers whose home slot is accessed directly must be in memory, other
+  // registers that are already assigned keep their registers. Coalescing can
+  // rename operands so one virtual register can be tied more than once.
+  for (i = 0; i < tiedTotal; i++) {
+    VirtReg* vreg = tiedArray[i].vreg;
+    uint32_t flags = tiedArray[i].flags;
+
+    for (j = 0; j < i; j++)
+      if (tiedArray[j].vreg == vreg)
+        break;
+    if (j != i) continue;
+
+    for (j = i + 1; j < tiedTotal; j++)
+      if (tiedArray[j].vreg == vreg)
+        flags |= tiedArray[j].flags;
+
+    if (flags & (TiedReg::kRMem | TiedReg::kWMem))
+      ASMJIT_PROPAGATE(self->spill(vreg, true, true, "home"));
+    else if (vreg->getState() == VirtReg::kStateReg)
+      locked[vreg->getKind()] |= Utils::mask(vreg->getPhysId());
+  }
+
+  // Assign registers to the rest, values that are read are loaded.
+  for (i = 0; i < tiedTotal; i++) {
+    VirtReg* vreg = tiedArray[i].vreg;
+    uint32_t flags = 0;
+
+    for (j = 0; j < tiedTotal; j++)
+      if (tiedArray[j].vreg == vreg)
+        flags |= tiedArray[j].flags;
+
+    if (flags & (TiedReg::kRMem | TiedReg::kWMem))
+      continue;
+
+    if (vreg->getState() != VirtReg::kStateReg) {
+      uint32_t kind = vreg->getKind();
+      uint32_t physId;
+
+      ASMJIT_PROPAGATE(self->allocReg(kind, locked[kind], liveness, physId));
+      if (flags & TiedReg::kRReg)
+        ASMJIT_PROPAGATE(self->emitLoad(vreg, physId, "alloc"));
+
+      self->attach(vreg, physId, false);
+      locked[kind] |= Utils::mask(physId);
+    }
+
+    if (flags & TiedReg::kWReg)
+      vreg->setModified(true);
+  }
+
+  // Translate virtual registers into physical ones.
+  for (i = 0; i < opCount; i++) {
+    Operand_* op = &opArray[i];
+    if (op->isVirtReg()) {
+      VirtReg* vreg = cc->getVirtRegById(op->getId());
+      ASMJIT_ASSERT(vreg->getPhysId() != Globals::kInvalidRegId);
+      op->_reg.id = vreg->getPhysId();
+    }
+    else if (op->isMem()) {
+      ArmMem* m = static_cast<ArmMem*>(op);
+
+      if (m->hasBaseReg() && cc->isVirtRegValid(m->getBaseId())) {
+        VirtReg* vreg = cc->getVirtRegById(m->getBaseId());
+
+        if (m->isRegHome()) {
+          self->getVarCell(vreg);
+        }
+        else {
+          ASMJIT_ASSERT(vreg->getPhysId() != Globals::kInvalidRegId);
+          m->_setBase(m->getBaseType(), vreg->getPhysId());
+        }
+      }
+
+      if (m->hasIndexReg() && cc->isVirtRegValid(m->getIndexId())) {
+        VirtReg* vreg = cc->getVirtRegById(m->getIndexId());
+        ASMJIT_ASSERT(vreg->getPhysId() != Globals::kInvalidRegId);
+        m->_setIndex(m->getIndexType(), vreg->getPhysId());
+      }
+    }
+  }
+
+  // Virtual registers live in their home slots at labels, save everything
+  // that is alive at the target. Nothing is allocated after a jump.
+  if (node->isJmpOrJcc()) {
+    ASMJIT_PROPAGATE(self->saveLive(liveness, "jump"));
+    if (node->isJmp())
+      self->detachAll();
+  }
+
+  // Only the call target can be assigned to a scratch register at this point.
+  if (isCall)
+    ASMJIT_PROPAGATE(self->spillClobbered(fd, liveness, false));
+
+  return kErrorOk;
+}
+
+// ============================================================================
+// [asmjit::ArmRAPass - Translate - Call]
+// ============================================================================
+
+//! \internal
+//!
+//! Get a register or a home slot that holds the current value of `vreg`.
+static ASMJIT_INLINE Operand ArmRAPass_getVarOp(ArmRAPass* self, VirtReg* vreg) {
+  if (vreg->getState() == VirtReg::kStateReg)
+    return ArmReg::fromSignature(vreg->getSignature(), vreg->getPhysId());
+  else
+    return self->getVarMem(vreg);
+}
+
+//! \internal
+//!
+//! Move a function argument or return value `src` (virtual register or
+//! immediate) to a physical register `dst`.
+static Error ArmRAPass_moveToReg(ArmRAPass* self, const ArmReg& dst, uint32_t dstTypeId, const Operand_& src) {
+  ArmCompiler* cc = self->cc();
+  ArmEmitter* emitter = reinterpret_cast<ArmEmitter*>(cc);
+
+  if (src.isImm()) {
+    // Immediates are materialized in a GP register, IP0 is used if the
+    // destination is a VEC register.
+    uint32_t size = TypeId::sizeOf(dstTypeId);
+    uint32_t gpId = Reg::isGp(dst) ? dst.getId() : uint32_t(ArmGp::kIdIp0);
+
+    ArmGp gp = size <= 4 ? ArmGp(armOpData.gpw[gpId]) : ArmGp(armOpData.gpx[gpId]);
+    ASMJIT_PROPAGATE(ArmInternal::emitMovImm(emitter, gp, static_cast<const Imm&>(src).getUInt64()));
+
+    if (Reg::isGp(dst))
+      return kErrorOk;
+    return ArmInternal::emitArgMove(emitter, dst, dstTypeId, gp, size <= 4 ? TypeId::kU32 : TypeId::kU64);
+  }
+
+  if (!src.isVirtReg())
+    return DebugUtils::errored(kErrorInvalidState);
+
+  VirtReg* vreg = cc->getVirtRegById(src.getId());
+  Operand srcOp = ArmRAPass_getVarOp(self, vreg);
+
+  // Nothing to do if the value is already there.
+  if (srcOp.isReg() && vreg->getKind() == dst.getKind() && vreg->getPhysId() == dst.getId() && vreg->getTypeId() == dstTypeId)
+    return kErrorOk;
+
+  return ArmInternal::emitArgMove(emitter, dst, dstTypeId, srcOp, vreg->getTypeId());
+}
+
+//! \internal
+static Error ArmRAPass_translateCall(ArmRAPass* self, CCFuncCall* node) {
+  ArmCompiler* cc = self->cc();
+  ArmEmitter* emitter = reinterpret_cast<ArmEmitter*>(cc);
+
+  FuncDetail& fd = node->getDetail();
+  RABits* liveness = node->getPassData<RAData>()->liveness;
+
+  uint32_t instId = node->getInstId();
+  bool isTailCall = instId == ArmInst::kIdB || instId == ArmInst::kIdBr;
+
+  uint32_t i;
+  uint32_t argCount = fd.getArgCount();
+
+  cc->_setCursor(node->getPrev());
+
+  // Registers clobbered by the callee are saved and released first. Values
+  // of arguments are then either in callee-saved registers or in their home
+  // slots, so moving them to argument registers can't overwrite each other.
+  ASMJIT_PROPAGATE(self->spillClobbered(fd, liveness, true));
+
+  // Arguments passed by stack go through IP0 (GP) or V16 (VEC), which is a
+  // scratch register now.
+  for (i = 0; i < argCount; i++) {
+    const FuncDetail::Value& arg = fd.getArg(i);
+    const Operand_& op = node->_args[i];
+
+    if (arg.byReg() || op.isNone())
+      continue;
+
+    uint32_t typeId = arg.getTypeId();
+    ArmReg tmp = TypeId::isInt(typeId) ? ArmReg(arm::x16) : ArmReg(arm::v16);
+
+    ASMJIT_PROPAGATE(ArmRAPass_moveToReg(self, tmp, typeId, op));
+    ASMJIT_PROPAGATE(ArmInternal::emitRegMove(emitter, arm::ptr(arm::sp, arg.getStackOffset()), tmp, typeId));
+  }
+
+  for (i = 0; i < argCount; i++) {
+    const FuncDetail::Value& arg = fd.getArg(i);
+    const Operand_& op = node->_args[i];
+
+    if (!arg.byReg() || op.isNone())
+      continue;
+
+    ArmReg dst = ArmReg::fromTypeAndId(arg.getRegType(), arg.getRegId());
+    ASMJIT_PROPAGATE(ArmRAPass_moveToReg(self, dst, arg.getTypeId(), op));
+  }
+
+  // The target is moved to IP1 as the epilog of a tail call may restore
+  // callee-saved registers, and IP0 is used by large stack adjustments.
+  Operand_* target = node->_opArray;
+  if (target->isImm()) {
+    ASMJIT_PROPAGATE(ArmInternal::emitMovImm(emitter, arm::x17, static_cast<Imm*>(target)->getUInt64()));
+    target->copyFrom(arm::x17);
+  }
+  else if (target->isVirtReg()) {
+    VirtReg* vreg = cc->getVirtRegById(target->getId());
+    ASMJIT_PROPAGATE(ArmInternal::emitRegMove(emitter, arm::x17, ArmRAPass_getVarOp(self, vreg), TypeId::kU64));
+    target->copyFrom(arm::x17);
+  }
+
+  if (isTailCall)
+    return kErrorOk;
+
+  // Return values are assigned to their registers, converted if the virtual
+  // register is of a different kind.
+  cc->_setCursor(node);
+
+  for (i = 0; i < 2; i++) {
+    const Operand_& op = node->_ret[i];
+    if (!op.isVirtReg()) continue;
+
+    const FuncDetail::Value& ret = fd.getRet(i);
+    if (!ret.byReg()) continue;
+
+    VirtReg* vreg = cc->getVirtRegById(op.getId());
+    if (vreg->getState() == VirtReg::kStateReg)
+      self->detach(vreg);
+
+    uint32_t retKind = ArmReg::kindOf(ret.getRegType());
+    uint32_t retId = ret.getRegId();
+
+    if (vreg->getKind() == retKind) {
+      self->attach(vreg, retId, true);
+    }
+    else {
+      uint32_t kind = vreg->getKind();
+      uint32_t physId;
+
+      ASMJIT_PROPAGATE(self->allocReg(kind, 0, liveness, physId));
+      ASMJIT_PROPAGATE(
+        ArmInternal::emitArgMove(emitter,
+          ArmReg::fromSignature(vreg->getSignature(), physId), vreg->getTypeId(),
+          ArmReg::fromTypeAndId(ret.getRegType(), retId), ret.getTypeId()));
+      self->attach(vreg, physId, true);
+    }
+  }
+
+  return kErrorOk;
+}
+
+// ============================================================================
+// [asmjit::ArmRAPass - Translate - Ret]
+// ============================================================================
+
+//! \internal
+static Error ArmRAPass_translateRet(ArmRAPass* self, CCFuncRet* rNode, CBLabel* exitTarget) {
+  ArmCompiler* cc = self->cc();
+  CBNode* node = rNode->getNext();
+
+  // Move return values to their registers. The second value goes first if
+  // the first one would overwrite it, it's spilled if they overlap both ways.
+  FuncDetail& fd = self->getFunc()->getDetail();
+  uint32_t order[2] = { 0, 1 };
+
+  cc->_setCursor(rNode->getPrev());
+
+  if (rNode->_ret[0].isVirtReg() && rNode->_ret[1].isVirtReg()) {
+    VirtReg* v0 = cc->getVirtRegById(rNode->_ret[0].getId());
+    VirtReg* v1 = cc->getVirtRegById(rNode->_ret[1].getId());
+
+    bool firstOverwrites = ArmRAPass_isInReg(v1, fd.getRet(0));
+    bool secondOverwrites = ArmRAPass_isInReg(v0, fd.getRet(1));
+
+    if (firstOverwrites && secondOverwrites) {
+      ASMJIT_PROPAGATE(self->spill(v1, true, true, "ret"));
+    }
+    else if (firstOverwrites) {
+      order[0] = 1;
+      order[1] = 0;
+    }
+  }
+
+  for (uint32_t i = 0; i < 2; i++) {
+    const Operand_& op = rNode->_ret[order[i]];
+    if (!op.isVirtReg()) continue;
+
+    const FuncDetail::Value& ret = fd.getRet(order[i]);
+    ArmReg dst = ArmReg::fromTypeAndId(ret.getRegType(), ret.getRegId());
+    ASMJIT_PROPAGATE(ArmRAPass_moveToReg(self, dst, ret.getTypeId(), op));
+  }
+
+  // Decide whether to `b` or not in case we are next to the return label.
+  while (node) {
+    switch (node->getType()) {
+      // If we have found an exit label we just return, there is no need to
+      // emit jump to that.
+      case CBNode::kNodeLabel:
+        if (static_cast<CBLabel*>(node) == exitTarget)
+          return kErrorOk;
+        goto _EmitRet;
+
+      case CBNode::kNodeData:
+      case CBNode::kNodeInst:
+      case CBNode::kNodeFuncCall:
+      case CBNode::kNodeFuncExit:
+        goto _EmitRet;
+
+      // Continue iterating.
+      case CBNode::kNodeComment:
+      case CBNode::kNodeAlign:
+      case CBNode::kNodeHint:
+        break;
+
+      // Invalid node to be here.
+      case CBNode::kNodeFunc:
+        return DebugUtils::errored(kErrorInvalidState);
+
+      // We can't go forward from here.
+      case CBNode::kNodeSentinel:
+        return kErrorOk;
+    }
+
+    node = node->getNext();
+  }
+
+_EmitRet:
+  {
+    cc->_setCursor(rNode);
+    cc->b(exitTarget->getLabel());
+  }
+  return kErrorOk;
+}
+
+// ============================================================================
+// [asmjit::ArmRAPass - Translate - Hint]
+// ============================================================================
+
+//! \internal
+static Error ArmRAPass_translateHint(ArmRAPass* self, CCHint* node) {
+  ArmRAData* raData = node->getPassData<ArmRAData>();
+  if (!raData->tiedTotal)
+    return kErrorOk;
+
+  VirtReg* vreg = raData->getTiedAt(0)->vreg;
+  self->cc()->_setCursor(node->getPrev());
+
+  switch (node->getHint()) {
+    case CCHint::kHintSpill:
+    case CCHint::kHintSaveAndUnuse:
+      return self->spill(vreg, true, true, "spill");
+
+    case CCHint::kHintSave:
+      return self->spill(vreg, true, false, "save");
+
+    case CCHint::kHintUnuse:
+      return self->spill(vreg, false, true, "unuse");
+  }
+
+  return kErrorOk;
+}
+
+// ============================================================================
+// [asmjit::ArmRAPass - TranslatePrologEpilog]
+// ============================================================================
+
+//! \internal
+static Error ArmRAPass_prepareFuncFrame(ArmRAPass* self, CCFunc* func) {
+  FuncFrameInfo& ffi = func->getFrameInfo();
+
+  ArmRegMask& clobberedRegs = self->_clobberedRegs;
+
+  // Initialize dirty registers.
+  ffi.setDirtyRegs(ArmReg::kKindGp , clobberedRegs.get(ArmReg::kKindGp ));
+  ffi.setDirtyRegs(ArmReg::kKindVec, clobberedRegs.get(ArmReg::kKindVec));
+
+  // Initialize stack size & alignment.
+  ffi.setStackFrameSize(self->_memAllTotal);
+  ffi.setStackFrameAlignment(self->_memMaxAlign);
+
+  return kErrorOk;
+}
+
+//! \internal
+static Error ArmRAPass_patchFuncMem(ArmRAPass* self, CCFunc* func, CBNode* stop, FuncFrameLayout& layout) {
+  ArmCompiler* cc = self->cc();
+  CBNode* node = func;
+
+  do {
+    if (node->getType() == CBNode::kNodeInst) {
+      CBInst* iNode = static_cast<CBInst*>(node);
+
+      if (iNode->hasMemOp()) {
+        ArmMem* m = iNode->getMemOp<ArmMem>();
+
+        if (m->isArgHome()) {
+          m->addOffsetLo32(layout.getStackArgsOffset());
+          m->clearArgHome();
+        }
+
+        if (m->isRegHome() && Operand::isPackedId(m->getBaseId())) {
+          VirtReg* vreg = cc->getVirtRegById(m->getBaseId());
+          ASMJIT_ASSERT(vreg != nullptr);
+
+          RACell* cell = vreg->getMemCell();
+          ASMJIT_ASSERT(cell != nullptr);
+
+          m->_setBase(cc->_nativeGpReg.getType(), self->_varBaseRegId);
+          m->addOffsetLo32(self->_varBaseOffset + cell->offset);
+          m->clearRegHome();
+        }
+      }
+    }
+
+    node = node->getNext();
+  } while (node != stop);
+
+  return kErrorOk;
+}
+
+// ============================================================================
+// [asmjit::ArmRAPass - Translate - TailCall]
+// ============================================================================
+
+//! \internal
+//!
+//! Insert an epilog without `ret` before each tail call and remove the code
+//! that follows it up to the next label (the return), which is unreachable.
+static Error ArmRAPass_translateTailCalls(ArmRAPass* self, CCFunc* func, CBNode* stop, FuncFrameLayout& layout) {
+  ArmCompiler* cc = self->cc();
+  CBNode* node = func;
+
+  do {
+    if (node->getType() == CBNode::kNodeFuncCall) {
+      uint32_t instId = static_cast<CCFuncCall*>(node)->getInstId();
+
+      if (instId == ArmInst::kIdB || instId == ArmInst::kIdBr) {
+        cc->_setCursor(node->getPrev());
+        ASMJIT_PROPAGATE(ArmInternal::emitEpilog(reinterpret_cast<ArmEmitter*>(cc), layout, true));
+
+        CBNode* next = node->getNext();
+        while (next != stop) {
+          CBNode* after = next->getNext();
+
+          uint32_t type = next->getType();
+          if (type == CBNode::kNodeInst || type == CBNode::kNodeFuncExit || type == CBNode::kNodeHint)
+            cc->removeNode(next);
+          else if (type != CBNode::kNodeComment)
+            break;
+
+          next = after;
+        }
+      }
+    }
+
+    node = node->getNext();
+  } while (node != stop);
+
+  return kErrorOk;
+}
+
+// ============================================================================
+// [asmjit::ArmRAPass - Translate - Func]
+// ============================================================================
+
+Error ArmRAPass::translate() {
+  ArmCompiler* cc = this->cc();
+  CCFunc* func = getFunc();
+
+  // Flow. Virtual registers live in their home slots at labels, so the nodes
+  // are translated in their order and not by following jumps.
+  CBNode* node_ = func;
+  CBNode* next = nullptr;
+  CBNode* stop = getStop();
+
+  do {
+    next = node_->getNext();
+
+    if (node_->hasPassData()) {
+      RAData* raData = node_->getPassData<RAData>();
+
+      switch (node_->getType()) {
+        // --------------------------------------------------------------------
+        // [Label]
+        // --------------------------------------------------------------------
+
+        case CBNode::kNodeLabel: {
+          cc->_setCursor(node_->getPrev());
+          ASMJIT_PROPAGATE(saveLive(raData->liveness, "label"));
+          detachAll();
+          break;
+        }
+
+        // --------------------------------------------------------------------
+        // [Hint]
+        // --------------------------------------------------------------------
+
+        case CBNode::kNodeHint: {
+          ASMJIT_PROPAGATE(ArmRAPass_translateHint(this, static_cast<CCHint*>(node_)));
+          break;
+        }
+
+        // --------------------------------------------------------------------
+        // [Inst]
+        // --------------------------------------------------------------------
+
+        case CBNode::kNodeInst: {
+          ASMJIT_PROPAGATE(ArmRAPass_translateInst(this, static_cast<CBInst*>(node_)));
+          break;
+        }
+
+        // --------------------------------------------------------------------
+        // [Func-Entry]
+        // --------------------------------------------------------------------
+
+        case CBNode::kNodeFunc: {
+          ArmRAData* funcData = static_cast<ArmRAData*>(raData);
+          for (uint32_t i = 0; i < funcData->tiedTotal; i++) {
+            TiedReg* tied = funcData->getTiedAt(i);
+            if (tied->hasOutPhysId())
+              attach(tied->vreg, tied->outPhysId, true);
+          }
+          break;
+        }
+
+        // --------------------------------------------------------------------
+        // [Func-Call]
+        // --------------------------------------------------------------------
+
+        case CBNode::kNodeFuncCall: {
+          ASMJIT_PROPAGATE(ArmRAPass_translateCall(this, static_cast<CCFuncCall*>(node_)));
+          break;
+        }
+
+        // --------------------------------------------------------------------
+        // [Func-Exit]
+        // --------------------------------------------------------------------
+
+        case CBNode::kNodeFuncExit: {
+          ASMJIT_PROPAGATE(
+            ArmRAPass_translateRet(this, static_cast<CCFuncRet*>(node_), func->getExitNode()));
+          detachAll();
+          break;
+        }
+
+        default:
+          break;
+      }
+    }
+
+    node_ = next;
+  } while (node_ != stop);
+
+  detachAll();
+
+  ASMJIT_PROPAGATE(resolveCellOffsets());
+  ASMJIT_PROPAGATE(ArmRAPass_prepareFuncFrame(this, func));
+
+  FuncFrameLayout layout;
+  ASMJIT_PROPAGATE(layout.init(func->getDetail(), func->getFrameInfo()));
+
+  _varBaseRegId = layout._stackBaseRegId;
+  _varBaseOffset = layout._stackBaseOffset;
+
+  ASMJIT_PROPAGATE(ArmRAPass_patchFuncMem(this, func, stop, layout));
+  ASMJIT_PROPAGATE(ArmRAPass_translateTailCalls(this, func, stop, layout));
+
+  cc->_setCursor(func);
+  ASMJIT_PROPAGATE(FuncUtils::emitProlog(this->cc(), layout));
+
+  cc->_setCursor(func->getExitNode());
+  ASMJIT_PROPAGATE(FuncUtils::emitEpilog(this->cc(), layout));
+
+  return kErrorOk;
+}
+
+} // asmjit namespace
+
+// [Api-End]
+#include "../asmjit_apiend.h"
+
+// [Guard]
+#endif // ASMJIT_BUILD_ARM && !ASMJIT_DISABLE_COMPILER
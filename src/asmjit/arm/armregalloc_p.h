@@ -0,0 +1,257 @@
+// [AsmJit]
+// Complete x86/x64 JIT and Remote Assembler for C++.
+//
+// [License]
+// Zlib - See LICENSE.md file in the package.
+
+// [Guard]
+#ifndef _ASMJIT_ARM_ARMREGALLOC_P_H
+#define _ASMJIT_ARM_ARMREGALLOC_P_H
+
+#include "../asmjit_build.h"
+#if !defined(ASMJIT_DISABLE_COMPILER)
+
+// [Dependencies]
+#include "../base/codecompiler.h"
+#include "../base/regalloc_p.h"
+#include "../base/utils.h"
+#include "../arm/armcompiler.h"
+#include "../arm/armmisc.h"
+
+// [Api-Begin]
+#include "../asmjit_apibegin.h"
+
+namespace asmjit {
+
+//! \addtogroup asmjit_arm
+//! \{
+
+// ============================================================================
+// [asmjit::ArmRAData]
+// ============================================================================
+
+struct ArmRAData : public RAData {
+  ASMJIT_INLINE ArmRAData(uint32_t tiedTotal) noexcept : RAData(tiedTotal) {}
+
+  // --------------------------------------------------------------------------
+  // [Accessors]
+  // --------------------------------------------------------------------------
+
+  //! Get TiedReg array.
+  ASMJIT_INLINE TiedReg* getTiedArray() const noexcept {
+    return const_cast<TiedReg*>(tiedArray);
+  }
+
+  //! Get TiedReg at the specified `index`.
+  ASMJIT_INLINE TiedReg* getTiedAt(uint32_t index) const noexcept {
+    ASMJIT_ASSERT(index < tiedTotal);
+    return getTiedArray() + index;
+  }
+
+  ASMJIT_INLINE void setTiedAt(uint32_t index, TiedReg& tied) noexcept {
+    ASMJIT_ASSERT(index < tiedTotal);
+    tiedArray[index] = tied;
+  }
+
+  // --------------------------------------------------------------------------
+  // [Members]
+  // --------------------------------------------------------------------------
+
+  //! Linked registers.
+  TiedReg tiedArray[1];
+};
+
+// ============================================================================
+// [asmjit::ArmRAPass]
+// ============================================================================
+
+//! \internal
+//!
+//! ARM register allocator pipeline.
+//!
+//! The allocator is local, virtual registers are assigned to physical ones
+//! within a basic block and live in their home slots at block boundaries:
+//! modified registers that are alive are saved before each jump and label,
+//! and all registers are detached at labels. Liveness analysis, dead code
+//! removal and coalescing of copies are shared with other backends.
+class ArmRAPass : public RAPass {
+public:
+  ASMJIT_NONCOPYABLE(ArmRAPass)
+  typedef RAPass Base;
+
+  // --------------------------------------------------------------------------
+  // [Construction / Destruction]
+  // --------------------------------------------------------------------------
+
+  ArmRAPass() noexcept;
+  virtual ~ArmRAPass() noexcept;
+
+  // --------------------------------------------------------------------------
+  // [Interface]
+  // --------------------------------------------------------------------------
+
+  virtual Error process(Zone* zone) noexcept override;
+  virtual Error prepare(CCFunc* func) noexcept override;
+
+  // --------------------------------------------------------------------------
+  // [Accessors]
+  // --------------------------------------------------------------------------
+
+  //! Get compiler as `ArmCompiler`.
+  ASMJIT_INLINE ArmCompiler* cc() const noexcept { return static_cast<ArmCompiler*>(_cb); }
+  //! Get clobbered registers (global).
+  ASMJIT_INLINE uint32_t getClobberedRegs(uint32_t kind) noexcept { return _clobberedRegs.get(kind); }
+
+  // --------------------------------------------------------------------------
+  // [Helpers]
+  // --------------------------------------------------------------------------
+
+  ASMJIT_INLINE ArmRAData* newRAData(uint32_t tiedTotal) noexcept {
+    return new(_zone->alloc(sizeof(ArmRAData) + tiedTotal * sizeof(TiedReg))) ArmRAData(tiedTotal);
+  }
+
+  // --------------------------------------------------------------------------
+  // [Emit]
+  // --------------------------------------------------------------------------
+
+  // Tiny wrappers that call `ArmInternal::emit...()`.
+  Error emitLoad(VirtReg* vreg, uint32_t id, const char* reason);
+  Error emitSave(VirtReg* vreg, uint32_t id, const char* reason);
+
+  // --------------------------------------------------------------------------
+  // [Attach / Detach]
+  // --------------------------------------------------------------------------
+
+  //! Attach a physical register `physId` to `vreg`.
+  ASMJIT_INLINE void attach(VirtReg* vreg, uint32_t physId, bool modified) noexcept {
+    uint32_t kind = vreg->getKind();
+    ASMJIT_ASSERT(physId < 32 && _physToVReg[kind][physId] == nullptr);
+
+    vreg->setState(VirtReg::kStateReg);
+    vreg->setModified(modified);
+    vreg->setPhysId(physId);
+    vreg->addHomeId(physId);
+
+    _physToVReg[kind][physId] = vreg;
+    _occupied[kind] |= Utils::mask(physId);
+    _clobberedRegs.or_(kind, Utils::mask(physId));
+  }
+
+  //! Detach `vreg` from its physical register, the content is lost.
+  ASMJIT_INLINE void detach(VirtReg* vreg) noexcept {
+    uint32_t kind = vreg->getKind();
+    uint32_t physId = vreg->getPhysId();
+    ASMJIT_ASSERT(physId < 32 && _physToVReg[kind][physId] == vreg);
+
+    vreg->setState(VirtReg::kStateMem);
+    vreg->setModified(false);
+    vreg->resetPhysId();
+
+    _physToVReg[kind][physId] = nullptr;
+    _occupied[kind] &= ~Utils::mask(physId);
+  }
+
+  //! Save `vreg` to its home slot if it's modified and detach it if `unuse`
+  //! is true.
+  Error spill(VirtReg* vreg, bool save, bool unuse, const char* reason);
+
+  //! Save all modified registers that are alive according to `liveness`.
+  Error saveLive(RABits* liveness, const char* reason);
+  //! Detach all registers, they must be saved first by `saveLive()`.
+  void detachAll() noexcept;
+
+  //! Spill registers that are not preserved by a function of `fd`, values
+  //! that are alive according to `liveness` are saved if `save` is true.
+  Error spillClobbered(const FuncDetail& fd, RABits* liveness, bool save);
+
+  //! Allocate a physical register of `kind` that is not in `exclude`, spill
+  //! its current occupant if there is no free register.
+  Error allocReg(uint32_t kind, uint32_t exclude, RABits* liveness, uint32_t& physIdOut);
+
+  // --------------------------------------------------------------------------
+  // [State]
+  // --------------------------------------------------------------------------
+
+  // The allocator is local to basic blocks, there is no state to switch.
+  virtual void loadState(RAState* src) override;
+  virtual RAState* saveState() override;
+
+  virtual void switchState(RAState* src) override;
+  virtual void intersectStates(RAState* a, RAState* b) override;
+
+  // --------------------------------------------------------------------------
+  // [Memory]
+  // --------------------------------------------------------------------------
+
+  ASMJIT_INLINE ArmMem getVarMem(VirtReg* vreg) {
+    (void)getVarCell(vreg);
+    return ArmMem(Init,
+      cc()->_nativeGpReg.getType(), vreg->getId(),
+      Reg::kRegNone, kInvalidValue,
+      0, 0, Mem::kSignatureMemRegHomeFlag);
+  }
+
+  // --------------------------------------------------------------------------
+  // [Fetch]
+  // --------------------------------------------------------------------------
+
+  virtual Error fetch() override;
+
+  // --------------------------------------------------------------------------
+  // [Coalesce]
+  // --------------------------------------------------------------------------
+
+  virtual bool isCopy(CBNode* node, VirtReg** pDst, VirtReg** pSrc) override;
+
+  // --------------------------------------------------------------------------
+  // [Dead Code]
+  // --------------------------------------------------------------------------
+
+  virtual bool canRemoveDead(CBNode* node, uint32_t* flagsR, uint32_t* flagsW) override;
+
+  // --------------------------------------------------------------------------
+  // [Annotate]
+  // --------------------------------------------------------------------------
+
+  virtual Error annotate() override;
+  virtual Error formatInlineComment(StringBuilder& dst, CBNode* node) override;
+
+  // --------------------------------------------------------------------------
+  // [Translate]
+  // --------------------------------------------------------------------------
+
+  virtual Error translate() override;
+
+  // --------------------------------------------------------------------------
+  // [Members]
+  // --------------------------------------------------------------------------
+
+  //! Clobbered registers (for the whole function).
+  ArmRegMask _clobberedRegs;
+
+  //! Global allocable registers mask.
+  uint32_t _gaRegs[Globals::kMaxVRegKinds];
+  //! Registers currently assigned to virtual registers.
+  uint32_t _occupied[Globals::kMaxVRegKinds];
+  //! Virtual registers assigned to physical registers.
+  VirtReg* _physToVReg[Globals::kMaxVRegKinds][32];
+
+  //! Function variables base pointer (register).
+  uint8_t _varBaseRegId;
+  //! Function variables base offset.
+  int32_t _varBaseOffset;
+
+  //! Temporary string builder used for logging.
+  StringBuilderTmp<256> _stringBuilder;
+};
+
+//! \}
+
+} // asmjit namespace
+
+// [Api-End]
+#include "../asmjit_apiend.h"
+
+// [Guard]
+#endif // !ASMJIT_DISABLE_COMPILER
+#endif // _ASMJIT_ARM_ARMREGALLOC_P_H
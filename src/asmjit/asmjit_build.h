@@ -68,6 +68,7 @@
 //
 // AsmJit features are enabled by default.
 // #define ASMJIT_DISABLE_COMPILER   // Disable CodeCompiler (completely).
+// #define ASMJIT_DISABLE_COST_MODEL // Disable instruction cost tables.
 // #define ASMJIT_DISABLE_LOGGING    // Disable logging and formatting (completely).
 // #define ASMJIT_DISABLE_TEXT       // Disable everything that contains text
 //                                   // representation (instructions, errors, ...).
@@ -913,6 +914,10 @@ typedef unsigned __int64 uint64_t;
 # if (ASMJIT_ARCH_X86 || ASMJIT_ARCH_X64) && !defined(ASMJIT_BUILD_X86)
 #  define ASMJIT_BUILD_X86
 # endif // ASMJIT_ARCH_X86
+
+# if ASMJIT_ARCH_ARM64 && !defined(ASMJIT_BUILD_ARM)
+#  define ASMJIT_BUILD_ARM
+# endif // ASMJIT_ARCH_ARM64
 #endif // ASMJIT_BUILD_HOST
 
 #if ASMJIT_CC_MSC
@@ -17,15 +17,23 @@
 #include "./base/codeholder.h"
 #include "./base/constpool.h"
 #include "./base/cpuinfo.h"
+#include "./base/flowgraph.h"
 #include "./base/func.h"
 #include "./base/globals.h"
 #include "./base/inst.h"
+#include "./base/jitcache.h"
+#include "./base/jitconststore.h"
+#include "./base/jitpatch.h"
+#include "./base/jitperf.h"
+#include "./base/jittenant.h"
+#include "./base/jitunwind.h"
 #include "./base/logging.h"
 #include "./base/operand.h"
 #include "./base/osutils.h"
 #include "./base/runtime.h"
 #include "./base/simdtypes.h"
 #include "./base/string.h"
+#include "./base/tracing.h"
 #include "./base/utils.h"
 #include "./base/vmem.h"
 #include "./base/zone.h"
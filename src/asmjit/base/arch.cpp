@@ -14,6 +14,10 @@
 #include "../x86/x86operand.h"
 #endif // ASMJIT_BUILD_X86
 
+#if defined(ASMJIT_BUILD_ARM)
+#include "../arm/armoperand.h"
+#endif // ASMJIT_BUILD_ARM
+
 // [Api-Begin]
 #include "../asmjit_apibegin.h"
 
@@ -152,6 +156,73 @@ ASMJIT_FAVOR_SIZE Error ArchUtils::typeIdToRegInfo(uint32_t archType, uint32_t&
   }
 #endif // ASMJIT_BUILD_X86
 
+#if defined(ASMJIT_BUILD_ARM)
+  if (ArchInfo::isArmFamily(archType)) {
+    // Only AArch64 is supported at the moment.
+    if (ASMJIT_UNLIKELY(archType != ArchInfo::kTypeA64))
+      return DebugUtils::errored(kErrorInvalidArch);
+
+    // Passed RegType instead of TypeId?
+    if (typeId <= Reg::kRegMax)
+      typeId = armOpData.archRegs.regTypeToTypeId[typeId];
+
+    if (ASMJIT_UNLIKELY(!TypeId::isValid(typeId)))
+      return DebugUtils::errored(kErrorInvalidTypeId);
+
+    // First normalize architecture dependent types.
+    if (TypeId::isAbstract(typeId))
+      typeId = (typeId == TypeId::kIntPtr) ? TypeId::kI64 : TypeId::kU64;
+
+    uint32_t size = TypeId::sizeOf(typeId);
+    if (ASMJIT_UNLIKELY(!size))
+      return DebugUtils::errored(kErrorInvalidTypeId);
+
+    if (ASMJIT_UNLIKELY(typeId == TypeId::kF80))
+      return DebugUtils::errored(kErrorInvalidUseOfF80);
+
+    uint32_t regType = 0;
+
+    switch (typeId) {
+      // There are no 8-bit and 16-bit GP registers, W is used instead.
+      case TypeId::kI8:
+      case TypeId::kU8:
+      case TypeId::kI16:
+      case TypeId::kU16:
+      case TypeId::kI32:
+      case TypeId::kU32:
+        regType = ArmReg::kRegGpw;
+        break;
+
+      case TypeId::kI64:
+      case TypeId::kU64:
+        regType = ArmReg::kRegGpx;
+        break;
+
+      case TypeId::kF32:
+        typeId = TypeId::kF32x1;
+        regType = ArmReg::kRegVecS;
+        break;
+
+      case TypeId::kF64:
+        typeId = TypeId::kF64x1;
+        regType = ArmReg::kRegVecD;
+        break;
+
+      default:
+        if (ASMJIT_UNLIKELY(!TypeId::isVec(typeId) || size > 16))
+          return DebugUtils::errored(kErrorInvalidTypeId);
+
+        regType = size <= 4 ? ArmReg::kRegVecS :
+                  size <= 8 ? ArmReg::kRegVecD : ArmReg::kRegVecV;
+        break;
+    }
+
+    typeIdInOut = typeId;
+    regInfo._signature = armOpData.archRegs.regInfo[regType].getSignature();
+    return kErrorOk;
+  }
+#endif // ASMJIT_BUILD_ARM
+
   return DebugUtils::errored(kErrorInvalidArch);
 }
 
@@ -109,6 +109,9 @@ public:
   //! Get if the architecture is 64-bit.
   ASMJIT_INLINE bool is64Bit() const noexcept { return _gpSize == 8; }
 
+  //! Get architecture signature, which combines type, sub-type, and GP registers info.
+  ASMJIT_INLINE uint32_t getSignature() const noexcept { return _signature; }
+
   //! Get architecture type, see \ref Type.
   ASMJIT_INLINE uint32_t getType() const noexcept { return _type; }
 
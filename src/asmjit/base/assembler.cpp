@@ -13,6 +13,10 @@
 #include "../base/utils.h"
 #include "../base/vmem.h"
 
+#if defined(ASMJIT_BUILD_ARM)
+#include "../arm/arminternal_p.h"
+#endif // ASMJIT_BUILD_ARM
+
 // [Api-Begin]
 #include "../asmjit_apibegin.h"
 
@@ -29,7 +33,9 @@ Assembler::Assembler() noexcept
     _bufferEnd(nullptr),
     _bufferPtr(nullptr),
     _op4(),
-    _op5() {}
+    _op5(),
+    _trustedOptions(0),
+    _trusted(0) {}
 
 Assembler::~Assembler() noexcept {
   if (_code) sync();
@@ -60,12 +66,33 @@ Error Assembler::onDetach(CodeHolder* code) noexcept {
   _bufferEnd  = nullptr;
   _bufferPtr  = nullptr;
 
+  _trustedOptions = 0;
+  _trusted = 0;
+
   _op4.reset();
   _op5.reset();
 
   return Base::onDetach(code);
 }
 
+Error Assembler::onRecycle(CodeHolder* code) noexcept {
+  if (_trusted)
+    endTrusted();
+
+  // The buffer of the .text section is kept, but its length is zero now.
+  _section = code->_sections[0];
+  uint8_t* p = _section->_buffer._data;
+
+  _bufferData = p;
+  _bufferEnd  = p + _section->_buffer._capacity;
+  _bufferPtr  = p + _section->_buffer._length;
+
+  _op4.reset();
+  _op5.reset();
+
+  return Base::onRecycle(code);
+}
+
 // ============================================================================
 // [asmjit::Assembler - Code-Generation]
 // ============================================================================
@@ -139,6 +166,79 @@ Error Assembler::setOffset(size_t offset) {
   return kErrorOk;
 }
 
+Error Assembler::setSection(SectionEntry* section) {
+  if (_lastError) return _lastError;
+  if (ASMJIT_UNLIKELY(!_code))
+    return DebugUtils::errored(kErrorNotInitialized);
+
+  uint32_t id = section->getId();
+  if (ASMJIT_UNLIKELY(id >= _code->_sections.getLength() || _code->_sections[id] != section))
+    return setLastError(DebugUtils::errored(kErrorInvalidSection));
+
+  // The buffer was reserved only for the current section.
+  if (ASMJIT_UNLIKELY(_trusted))
+    return setLastError(DebugUtils::errored(kErrorInvalidState));
+
+#if !defined(ASMJIT_DISABLE_LOGGING)
+  if ((_globalOptions & kOptionLoggingEnabled) && _code->_logger->isEnabled(Logger::kCategoryData))
+    _code->_logger->logf(".section %s\n", section->getName());
+#endif // !ASMJIT_DISABLE_LOGGING
+
+  sync();
+
+  uint8_t* p = section->_buffer._data;
+  _section    = section;
+  _bufferData = p;
+  _bufferEnd  = p + section->_buffer._capacity;
+  _bufferPtr  = p + section->_buffer._length;
+
+  return kErrorOk;
+}
+
+// ============================================================================
+// [asmjit::Assembler - Trusted Mode]
+// ============================================================================
+
+//! \internal
+//!
+//! Space reserved per instruction, the same as checked by `_emit()`.
+static const size_t kAssemblerMaxInstSize = 16;
+
+Error Assembler::beginTrusted(size_t instCount) noexcept {
+  if (_lastError) return _lastError;
+  if (ASMJIT_UNLIKELY(!_code))
+    return DebugUtils::errored(kErrorNotInitialized);
+
+  if (ASMJIT_UNLIKELY(_trusted))
+    return setLastError(DebugUtils::errored(kErrorInvalidState));
+
+  size_t offset = getOffset();
+  if (ASMJIT_UNLIKELY(instCount > (IntTraits<size_t>::maxValue() - offset) / kAssemblerMaxInstSize))
+    return setLastError(DebugUtils::errored(kErrorNoHeapMemory));
+
+  Error err = _code->reserveBuffer(&_section->_buffer, offset + instCount * kAssemblerMaxInstSize);
+  if (ASMJIT_UNLIKELY(err))
+    return setLastError(err);
+
+  const uint32_t kSuspended = kOptionStrictValidation | kOptionLoggingEnabled;
+  _trustedOptions = _globalOptions & kSuspended;
+  _globalOptions &= ~kSuspended;
+  _trusted = 1;
+
+  return kErrorOk;
+}
+
+Error Assembler::endTrusted() noexcept {
+  if (ASMJIT_UNLIKELY(!_trusted))
+    return DebugUtils::errored(kErrorInvalidState);
+
+  _globalOptions |= _trustedOptions;
+  _trustedOptions = 0;
+  _trusted = 0;
+
+  return kErrorOk;
+}
+
 // ============================================================================
 // [asmjit::Assembler - Comment]
 // ============================================================================
@@ -147,7 +247,7 @@ Error Assembler::comment(const char* s, size_t len) {
   if (_lastError) return _lastError;
 
 #if !defined(ASMJIT_DISABLE_LOGGING)
-  if (_globalOptions & kOptionLoggingEnabled) {
+  if ((_globalOptions & kOptionLoggingEnabled) && _code->_logger->isEnabled(Logger::kCategoryComment, Logger::kLevelInfo)) {
     Logger* logger = _code->getLogger();
     logger->log(s, len);
     logger->log("\n", 1);
@@ -198,12 +298,13 @@ Error Assembler::bind(const Label& label) {
     return setLastError(DebugUtils::errored(kErrorLabelAlreadyBound));
 
 #if !defined(ASMJIT_DISABLE_LOGGING)
-  if (_globalOptions & kOptionLoggingEnabled) {
-    StringBuilderTmp<256> sb;
+  if ((_globalOptions & kOptionLoggingEnabled) && _code->_logger->isEnabled(Logger::kCategoryLabel)) {
+    StringBuilderTmp<Logging::kMaxLineLength> sb;
     if (le->hasName())
-      sb.setFormat("%s:", le->getName());
+      sb.appendString(le->getName());
     else
-      sb.setFormat("L%u:", Operand::unpackId(label.getId()));
+      Logging::formatLabel(sb, 0, this, label.getId());
+    sb.appendChar(':');
 
     size_t binSize = 0;
     if (!_code->_logger->hasOption(Logger::kOptionBinaryForm))
@@ -216,11 +317,14 @@ Error Assembler::bind(const Label& label) {
 
   Error err = kErrorOk;
   size_t pos = getOffset();
+  uint32_t sectionId = _section->getId();
 
-  LabelLink* link = le->_links;
-  LabelLink* prev = nullptr;
+  // Patch all links from the contiguous links array of the label.
+  LabelLink* links = le->_links;
+  uint32_t linkCount = le->_linkCount;
 
-  while (link) {
+  for (uint32_t i = 0; i < linkCount; i++) {
+    const LabelLink* link = &links[i];
     intptr_t offset = link->offset;
     uint32_t relocId = link->relocId;
 
@@ -228,6 +332,44 @@ Error Assembler::bind(const Label& label) {
       // Adjust relocation data.
       RelocEntry* re = _code->_relocations[relocId];
       re->_data += static_cast<uint64_t>(pos);
+      re->_targetSectionId = sectionId;
+    }
+#if defined(ASMJIT_BUILD_ARM)
+    else if (getArchInfo().isArmFamily()) {
+      // The displacement is a bit-field of the instruction, which `relocate()`
+      // can't patch, thus links across sections are not supported.
+      if (link->sectionId == sectionId) {
+        Error pErr = ArmInternal::patchRel(_bufferData + offset, static_cast<intptr_t>(pos) - offset + link->rel);
+        if (ASMJIT_UNLIKELY(pErr))
+          err = pErr;
+      }
+      else {
+        err = DebugUtils::errored(kErrorInvalidDisplacement);
+      }
+    }
+#endif // ASMJIT_BUILD_ARM
+    else if (link->sectionId != sectionId) {
+      // The link is in another section, its offset is not known until the
+      // sections are laid out, so the displacement is patched by `relocate()`.
+      uint8_t* data = _code->_sections[link->sectionId]->_buffer._data;
+      RelocEntry* re;
+
+      if (data[offset] != 4) {
+        err = DebugUtils::errored(kErrorInvalidDisplacement);
+      }
+      else {
+        Error rErr = _code->newRelocEntry(&re, RelocEntry::kTypeRelToRel, 4);
+        if (ASMJIT_UNLIKELY(rErr)) {
+          err = rErr;
+        }
+        else {
+          re->_sourceSectionId = link->sectionId;
+          re->_targetSectionId = sectionId;
+          re->_sourceOffset = static_cast<uint64_t>(offset);
+          re->_data = static_cast<uint64_t>(static_cast<int64_t>(static_cast<intptr_t>(pos) + link->rel));
+          Utils::writeI32u(data + offset, 0);
+        }
+      }
     }
     else {
       // Not using relocId, this means that we are overwriting a real
@@ -244,18 +386,12 @@ Error Assembler::bind(const Label& label) {
       else
         err = DebugUtils::errored(kErrorInvalidDisplacement);
     }
-
-    prev = link->prev;
-    _code->_unresolvedLabelsCount--;
-    _code->_baseHeap.release(link, sizeof(LabelLink));
-
-    link = prev;
   }
 
   // Set as bound.
-  le->_sectionId = _section->getId();
+  _code->_releaseLabelLinks(le);
+  le->_sectionId = sectionId;
   le->_offset = pos;
-  le->_links = nullptr;
   resetInlineComment();
 
   if (err != kErrorOk)
@@ -276,7 +412,7 @@ Error Assembler::embed(const void* data, uint32_t size) {
   _bufferPtr += size;
 
 #if !defined(ASMJIT_DISABLE_LOGGING)
-  if (_globalOptions & kOptionLoggingEnabled)
+  if ((_globalOptions & kOptionLoggingEnabled) && _code->_logger->isEnabled(Logger::kCategoryData))
     _code->_logger->logBinary(data, size);
 #endif // !ASMJIT_DISABLE_LOGGING
 
@@ -302,7 +438,7 @@ Error Assembler::embedLabel(const Label& label) {
   }
 
 #if !defined(ASMJIT_DISABLE_LOGGING)
-  if (_globalOptions & kOptionLoggingEnabled)
+  if ((_globalOptions & kOptionLoggingEnabled) && _code->_logger->isEnabled(Logger::kCategoryData))
     _code->_logger->logf(gpSize == 4 ? ".dd L%u\n" : ".dq L%u\n", Operand::unpackId(label.getId()));
 #endif // !ASMJIT_DISABLE_LOGGING
 
@@ -349,7 +485,7 @@ Error Assembler::embedConstPool(const Label& label, const ConstPool& pool) {
   pool.fill(p);
 
 #if !defined(ASMJIT_DISABLE_LOGGING)
-  if (_globalOptions & kOptionLoggingEnabled)
+  if ((_globalOptions & kOptionLoggingEnabled) && _code->_logger->isEnabled(Logger::kCategoryData))
     _code->_logger->logBinary(p, size);
 #endif // !ASMJIT_DISABLE_LOGGING
 
@@ -357,10 +493,86 @@ Error Assembler::embedConstPool(const Label& label, const ConstPool& pool) {
   return kErrorOk;
 }
 
+// ============================================================================
+// [asmjit::Assembler - Bulk Embedding]
+// ============================================================================
+
+Error Assembler::embedReserve(uint8_t** out, size_t size) noexcept {
+  *out = nullptr;
+  if (_lastError) return _lastError;
+  if (ASMJIT_UNLIKELY(!_code))
+    return DebugUtils::errored(kErrorNotInitialized);
+
+  if (getRemainingSpace() < size) {
+    Error err;
+    size_t offset = getOffset();
+
+    if (size >= Globals::kAllocThreshold) {
+      if (ASMJIT_UNLIKELY(size > IntTraits<size_t>::maxValue() - offset))
+        return setLastError(DebugUtils::errored(kErrorNoHeapMemory));
+      err = _code->reserveBuffer(&_section->_buffer, offset + size);
+    }
+    else {
+      err = _code->growBuffer(&_section->_buffer, size);
+    }
+
+    if (ASMJIT_UNLIKELY(err)) return setLastError(err);
+  }
+
+  *out = _bufferPtr;
+  return kErrorOk;
+}
+
+Error Assembler::embedCommit(size_t size) noexcept {
+  if (_lastError) return _lastError;
+
+  if (ASMJIT_UNLIKELY(size > getRemainingSpace()))
+    return setLastError(DebugUtils::errored(kErrorInvalidArgument));
+
+#if !defined(ASMJIT_DISABLE_LOGGING)
+  if ((_globalOptions & kOptionLoggingEnabled) && _code->_logger->isEnabled(Logger::kCategoryData))
+    _code->_logger->logBinary(_bufferPtr, size);
+#endif // !ASMJIT_DISABLE_LOGGING
+
+  _bufferPtr += size;
+  return kErrorOk;
+}
+
 // ============================================================================
 // [asmjit::Assembler - Emit-Helpers]
 // ============================================================================
 
+void Assembler::_emitTrace(
+  uint32_t instId, uint32_t options, const Operand_& o0, const Operand_& o1, const Operand_& o2, const Operand_& o3,
+  uint8_t* afterCursor) noexcept {
+
+  TraceRecord* record = _code->_traceBuffer->_newRecord();
+  if (ASMJIT_UNLIKELY(!record))
+    return;
+
+  record->instId = instId;
+  record->options = options;
+  record->offset = static_cast<uint32_t>((size_t)(_bufferPtr - _bufferData));
+  record->sectionId = static_cast<uint16_t>(_section->getId());
+  record->size = static_cast<uint8_t>((size_t)(afterCursor - _bufferPtr));
+  record->archType = static_cast<uint8_t>(getArchType());
+  record->extraReg.init(_extraReg);
+
+  record->operands[0].copyFrom(o0);
+  record->operands[1].copyFrom(o1);
+  record->operands[2].copyFrom(o2);
+  record->operands[3].copyFrom(o3);
+
+  if (options & kOptionOp4Op5Used) {
+    record->operands[4].copyFrom(_op4);
+    record->operands[5].copyFrom(_op5);
+  }
+  else {
+    record->operands[4].reset();
+    record->operands[5].reset();
+  }
+}
+
 #if !defined(ASMJIT_DISABLE_LOGGING)
 void Assembler::_emitLog(
   uint32_t instId, uint32_t options, const Operand_& o0, const Operand_& o1, const Operand_& o2, const Operand_& o3,
@@ -370,7 +582,7 @@ void Assembler::_emitLog(
   ASMJIT_ASSERT(logger != nullptr);
   ASMJIT_ASSERT(options & CodeEmitter::kOptionLoggingEnabled);
 
-  StringBuilderTmp<256> sb;
+  StringBuilderTmp<Logging::kMaxLineLength> sb;
   uint32_t logOptions = logger->getOptions();
 
   uint8_t* beforeCursor = _bufferPtr;
@@ -410,7 +622,7 @@ Error Assembler::_emitFailed(
   Error err,
   uint32_t instId, uint32_t options, const Operand_& o0, const Operand_& o1, const Operand_& o2, const Operand_& o3) {
 
-  StringBuilderTmp<256> sb;
+  StringBuilderTmp<Logging::kMaxLineLength> sb;
   sb.appendString(DebugUtils::errorAsString(err));
   sb.appendString(": ");
 
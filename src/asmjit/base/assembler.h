@@ -52,6 +52,7 @@ public:
 
   ASMJIT_API Error onAttach(CodeHolder* code) noexcept override;
   ASMJIT_API Error onDetach(CodeHolder* code) noexcept override;
+  ASMJIT_API Error onRecycle(CodeHolder* code) noexcept override;
 
   // --------------------------------------------------------------------------
   // [Code-Generation]
@@ -69,6 +70,16 @@ public:
   //! Called by \ref CodeHolder::sync().
   ASMJIT_API virtual void sync() noexcept;
 
+  //! Get the current section.
+  ASMJIT_INLINE SectionEntry* getSection() const noexcept { return _section; }
+  //! Switch to `section`, the code is emitted at the end of it.
+  //!
+  //! Labels can be bound and used in any section, a reference to a label
+  //! bound in another section is always encoded with a 32-bit displacement,
+  //! which is patched by `CodeHolder::relocate()`. Sections can't be changed
+  //! in trusted mode.
+  ASMJIT_API Error setSection(SectionEntry* section);
+
   //! Get the capacity of the current CodeBuffer.
   ASMJIT_INLINE size_t getBufferCapacity() const noexcept { return (size_t)(_bufferEnd - _bufferData); }
   //! Get the number of remaining bytes in the current CodeBuffer.
@@ -89,6 +100,29 @@ public:
   //! Get pointer in the CodeBuffer of the current section.
   ASMJIT_INLINE uint8_t* getBufferPtr() const noexcept { return _bufferPtr; }
 
+  // --------------------------------------------------------------------------
+  // [Trusted Mode]
+  // --------------------------------------------------------------------------
+
+  //! Get whether the assembler is in trusted mode, see \ref beginTrusted().
+  ASMJIT_INLINE bool isTrusted() const noexcept { return _trusted != 0; }
+
+  //! Reserve the CodeBuffer for `instCount` instructions and enter trusted mode.
+  //!
+  //! Trusted mode is designed for generators that emit pre-validated streams
+  //! of instructions. The buffer is reserved once (by using \ref
+  //! CodeHolder::reserveBuffer()) so no instruction has to grow it, and strict
+  //! validation and logging are suspended until \ref endTrusted() is called.
+  //! This means that `_emit()` only takes its fast path - a single branch that
+  //! checks for failure cases is all that remains before the encoding.
+  //!
+  //! The buffer check itself is still part of the failure-case branch, thus
+  //! emitting more than `instCount` instructions is safe, it only makes the
+  //! buffer grow again.
+  ASMJIT_API Error beginTrusted(size_t instCount) noexcept;
+  //! Leave trusted mode and restore the suspended global options.
+  ASMJIT_API Error endTrusted() noexcept;
+
   // --------------------------------------------------------------------------
   // [Code-Generation]
   // --------------------------------------------------------------------------
@@ -105,11 +139,39 @@ public:
   ASMJIT_API Error embedConstPool(const Label& label, const ConstPool& pool) override;
   ASMJIT_API Error comment(const char* s, size_t len = Globals::kInvalidIndex) override;
 
+  // --------------------------------------------------------------------------
+  // [Bulk Embedding]
+  // --------------------------------------------------------------------------
+
+  //! Reserve `size` bytes at the current position and store a pointer to
+  //! them in `out`.
+  //!
+  //! This is designed for embedding large tables - the data can be written
+  //! directly into the CodeBuffer (by `memcpy()` from a mapped file, `read()`,
+  //! a decompressor, etc...) without an intermediate copy. The reserved bytes
+  //! don't become part of the section until \ref embedCommit() is called and
+  //! the pointer stays valid only until the next call that can grow the
+  //! buffer. Large reservations (see `Globals::kAllocThreshold`) are allocated
+  //! exactly instead of by the regular growing strategy.
+  ASMJIT_API Error embedReserve(uint8_t** out, size_t size) noexcept;
+
+  //! Commit `size` bytes written to the memory returned by \ref embedReserve().
+  //!
+  //! Data can be streamed by committing less than reserved and reserving
+  //! again, `size` can't exceed the remaining space of the buffer.
+  ASMJIT_API Error embedCommit(size_t size) noexcept;
+
   // --------------------------------------------------------------------------
   // [Emit-Helpers]
   // --------------------------------------------------------------------------
 
 protected:
+  //! Add a record of the instruction `[_bufferPtr, afterCursor)` to the
+  //! attached \ref TraceBuffer.
+  void _emitTrace(
+    uint32_t instId, uint32_t options, const Operand_& o0, const Operand_& o1, const Operand_& o2, const Operand_& o3,
+    uint8_t* afterCursor) noexcept;
+
 #if !defined(ASMJIT_DISABLE_LOGGING)
   void _emitLog(
     uint32_t instId, uint32_t options, const Operand_& o0, const Operand_& o1, const Operand_& o2, const Operand_& o3,
@@ -141,6 +203,10 @@ public:
 
   Operand_ _op4;                         //!< 5th operand data, used only temporarily.
   Operand_ _op5;                         //!< 6th operand data, used only temporarily.
+
+  uint32_t _trustedOptions;              //!< Global options suspended by trusted mode.
+  uint8_t _trusted;                      //!< Trusted mode is active.
+  uint8_t _reservedAsm[3];               //!< \internal
 };
 
 //! \}
@@ -13,6 +13,7 @@
 
 // [Dependencies]
 #include "../base/codebuilder.h"
+#include "../base/osutils.h"
 
 // [Api-Begin]
 #include "../asmjit_apibegin.h"
@@ -28,6 +29,7 @@ CodeBuilder::CodeBuilder() noexcept
     _cbBaseZone(32768 - Zone::kZoneOverhead),
     _cbDataZone(16384 - Zone::kZoneOverhead),
     _cbPassZone(32768 - Zone::kZoneOverhead),
+    _cbInstZone(32768 - Zone::kZoneOverhead),
     _cbHeap(&_cbBaseZone),
     _cbPasses(),
     _cbLabels(),
@@ -35,7 +37,15 @@ CodeBuilder::CodeBuilder() noexcept
     _lastNode(nullptr),
     _cursor(nullptr),
     _position(0),
-    _nodeFlags(0) {}
+    _nodeFlags(0),
+    _statsEnabled(0),
+    _compactInsts(0),
+    _packedOps(0),
+    _hasPackedNodes(0),
+    _passesDone(0),
+    _serializeTime(0) {
+  _cbBaseZone.saveState(&_cbPassState);
+}
 CodeBuilder::~CodeBuilder() noexcept {}
 
 // ============================================================================
@@ -52,11 +62,16 @@ Error CodeBuilder::onDetach(CodeHolder* code) noexcept {
   _cbHeap.reset(&_cbBaseZone);
 
   _cbBaseZone.reset(false);
+  _cbBaseZone.saveState(&_cbPassState);
   _cbDataZone.reset(false);
   _cbPassZone.reset(false);
+  _cbInstZone.reset(false);
 
   _position = 0;
   _nodeFlags = 0;
+  _hasPackedNodes = 0;
+  _passesDone = 0;
+  _serializeTime = 0;
 
   _firstNode = nullptr;
   _lastNode = nullptr;
@@ -65,10 +80,171 @@ Error CodeBuilder::onDetach(CodeHolder* code) noexcept {
   return Base::onDetach(code);
 }
 
+Error CodeBuilder::onRecycle(CodeHolder* code) noexcept {
+  // Passes and the array that holds them were allocated by `_cbBaseZone`
+  // before `_cbPassState` was saved, so they survive `restoreState()`.
+  CBPass** passes = _cbPasses.getData();
+  size_t passCount = _cbPasses.getLength();
+
+  _cbPasses.reset();
+  _cbLabels.reset();
+
+  _cbBaseZone.restoreState(_cbPassState);
+  _cbDataZone.reset(false);
+  _cbPassZone.reset(false);
+  _cbInstZone.reset(false);
+  _cbHeap.recycle(&_cbBaseZone);
+
+  if (passCount) {
+    Error err = _cbPasses.willGrow(&_cbHeap, passCount);
+    if (ASMJIT_UNLIKELY(err))
+      return setLastError(err);
+
+    for (size_t i = 0; i < passCount; i++)
+      _cbPasses.appendUnsafe(passes[i]);
+  }
+
+  _position = 0;
+  _nodeFlags = 0;
+  _hasPackedNodes = 0;
+  _passesDone = 0;
+
+  _firstNode = nullptr;
+  _lastNode = nullptr;
+  _cursor = nullptr;
+
+  return Base::onRecycle(code);
+}
+
 // ============================================================================
 // [asmjit::CodeBuilder - Node-Factory]
 // ============================================================================
 
+//! \internal
+//!
+//! Number of operands stored in a compact instruction record.
+static const uint32_t CodeBuilder_kInstRecordOpCount = 4;
+
+//! \internal
+//!
+//! Size of a compact instruction record, fits any instruction node.
+static const size_t CodeBuilder_kInstRecordSize = sizeof(CBJump) + CodeBuilder_kInstRecordOpCount * sizeof(Operand);
+
+void* CodeBuilder::_allocInstNode(size_t nodeSize, uint32_t opCount, Operand** opArrayOut) noexcept {
+  if (!_compactInsts) {
+    uint8_t* p = _cbHeap.allocT<uint8_t>(nodeSize + opCount * sizeof(Operand));
+    *opArrayOut = reinterpret_cast<Operand*>(p + nodeSize);
+    return p;
+  }
+
+  ASMJIT_ASSERT(nodeSize <= sizeof(CBJump));
+  uint8_t* p = _cbInstZone.allocT<uint8_t>(CodeBuilder_kInstRecordSize);
+  if (ASMJIT_UNLIKELY(!p))
+    return nullptr;
+
+  // Extended operands live out of line, the record is not used by them.
+  Operand* opArray = reinterpret_cast<Operand*>(p + nodeSize);
+  if (opCount > CodeBuilder_kInstRecordOpCount) {
+    opArray = _cbDataZone.allocT<Operand>(opCount * sizeof(Operand));
+    if (ASMJIT_UNLIKELY(!opArray))
+      return nullptr;
+  }
+
+  *opArrayOut = opArray;
+  return p;
+}
+
+CBInst* CodeBuilder::_newPackedInstNode(uint32_t instId, uint32_t options, const Operand_* opArray, uint32_t opCount) noexcept {
+  ASMJIT_ASSERT(opCount <= CBInst::kMaxPackedOps);
+
+  // Packed operands are 8-byte aligned as `CBInst` is a multiple of 8 bytes.
+  size_t size = sizeof(CBInst) + opCount * sizeof(PackedOp);
+  uint8_t* p = _compactInsts ? _cbInstZone.allocT<uint8_t>(size) : _cbHeap.allocT<uint8_t>(size);
+
+  if (ASMJIT_UNLIKELY(!p))
+    return nullptr;
+
+  PackedOp* packedOps = reinterpret_cast<PackedOp*>(p + sizeof(CBInst));
+  for (uint32_t i = 0; i < opCount; i++)
+    packedOps[i].pack(opArray[i]);
+
+  // Packed operands are never memory operands, `_updateMemOp()` has nothing
+  // to find, so the node is constructed without them.
+  CBInst* node = new(p) CBInst(this, instId, options, nullptr, 0);
+  node->_opCount = static_cast<uint8_t>(opCount);
+  node->_packedOps = packedOps;
+  node->orFlags(CBNode::kFlagHasPackedOps);
+
+  _hasPackedNodes = 1;
+  return node;
+}
+
+Error CodeBuilder::setOps(CBInst* node, const Operand* opArray) noexcept {
+  uint32_t i;
+  uint32_t opCount = node->getOpCount();
+
+  if (node->hasPackedOps()) {
+    for (i = 0; i < opCount; i++)
+      if (!PackedOp::canPack(opArray[i]))
+        break;
+
+    if (i == opCount) {
+      PackedOp* packedOps = node->getPackedOps();
+      for (i = 0; i < opCount; i++)
+        packedOps[i].pack(opArray[i]);
+      return kErrorOk;
+    }
+
+    // Escape to full operands, the packed ones are abandoned.
+    Operand* dst = _cbDataZone.allocT<Operand>(opCount * sizeof(Operand));
+    if (ASMJIT_UNLIKELY(!dst))
+      return setLastError(DebugUtils::errored(kErrorNoHeapMemory));
+
+    node->_opArray = dst;
+    node->andNotFlags(CBNode::kFlagHasPackedOps);
+  }
+
+  Operand* dst = node->getOpArray();
+  if (dst != opArray) {
+    for (i = 0; i < opCount; i++)
+      dst[i].copyFrom(opArray[i]);
+  }
+
+  node->_updateMemOp();
+  return kErrorOk;
+}
+
+Error CodeBuilder::unpackOps(CBInst* node) noexcept {
+  if (!node->hasPackedOps())
+    return kErrorOk;
+
+  uint32_t opCount = node->getOpCount();
+  Operand* dst = _cbDataZone.allocT<Operand>(opCount * sizeof(Operand));
+
+  if (ASMJIT_UNLIKELY(!dst))
+    return setLastError(DebugUtils::errored(kErrorNoHeapMemory));
+
+  const PackedOp* packedOps = node->getPackedOps();
+  for (uint32_t i = 0; i < opCount; i++)
+    packedOps[i].unpack(dst[i]);
+
+  node->_opArray = dst;
+  node->andNotFlags(CBNode::kFlagHasPackedOps);
+  return kErrorOk;
+}
+
+Error CodeBuilder::unpackOps() noexcept {
+  if (!_hasPackedNodes)
+    return kErrorOk;
+
+  for (CBNode* node = _firstNode; node; node = node->getNext())
+    if (node->getType() == CBNode::kNodeInst)
+      ASMJIT_PROPAGATE(unpackOps(static_cast<CBInst*>(node)));
+
+  _hasPackedNodes = 0;
+  return kErrorOk;
+}
+
 Error CodeBuilder::getCBLabel(CBLabel** pOut, uint32_t id) noexcept {
   if (_lastError) return _lastError;
   ASMJIT_ASSERT(_code != nullptr);
@@ -141,6 +317,20 @@ CBConstPool* CodeBuilder::newConstPool() noexcept {
   return node;
 }
 
+CBJumpTable* CodeBuilder::newJumpTable(uint32_t size) noexcept {
+  CBJump** entries = nullptr;
+  if (size) {
+    entries = _cbHeap.allocT<CBJump*>(size * sizeof(CBJump*));
+    if (!entries) return nullptr;
+    ::memset(entries, 0, size * sizeof(CBJump*));
+  }
+
+  CBJumpTable* node = newNodeT<CBJumpTable>(entries, size);
+  if (!node || registerLabelNode(node) != kErrorOk)
+    return nullptr;
+  return node;
+}
+
 CBComment* CodeBuilder::newCommentNode(const char* s, size_t len) noexcept {
   if (s) {
     if (len == Globals::kInvalidIndex) len = ::strlen(s);
@@ -153,6 +343,10 @@ CBComment* CodeBuilder::newCommentNode(const char* s, size_t len) noexcept {
   return newNodeT<CBComment>(s);
 }
 
+CBSection* CodeBuilder::newSectionNode(SectionEntry* section) noexcept {
+  return newNodeT<CBSection>(section);
+}
+
 // ============================================================================
 // [asmjit::CodeBuilder - Code-Emitter]
 // ============================================================================
@@ -474,6 +668,26 @@ ASMJIT_FAVOR_SIZE Error CodeBuilder::addPass(CBPass* pass) noexcept {
   }
 
   ASMJIT_PROPAGATE(_cbPasses.append(&_cbHeap, pass));
+  _cbBaseZone.saveState(&_cbPassState);
+  pass->_cb = this;
+  return kErrorOk;
+}
+
+ASMJIT_FAVOR_SIZE Error CodeBuilder::insertPass(CBPass* pass, CBPass* before) noexcept {
+  if (!before)
+    return addPass(pass);
+
+  if (ASMJIT_UNLIKELY(pass == nullptr))
+    return DebugUtils::errored(kErrorNoHeapMemory);
+
+  if (ASMJIT_UNLIKELY(pass->_cb || before->_cb != this))
+    return DebugUtils::errored(kErrorInvalidState);
+
+  size_t index = _cbPasses.indexOf(before);
+  ASMJIT_ASSERT(index != Globals::kInvalidIndex);
+
+  ASMJIT_PROPAGATE(_cbPasses.insert(&_cbHeap, index, pass));
+  _cbBaseZone.saveState(&_cbPassState);
   pass->_cb = this;
   return kErrorOk;
 }
@@ -497,6 +711,77 @@ ASMJIT_FAVOR_SIZE Error CodeBuilder::deletePass(CBPass* pass) noexcept {
   return kErrorOk;
 }
 
+Error CodeBuilder::runPasses() noexcept {
+  Error err = kErrorOk;
+  ZoneVector<CBPass*>& passes = _cbPasses;
+
+  bool stats = hasStatsEnabled();
+  for (size_t i = 0, len = passes.getLength(); i < len; i++) {
+    CBPass* pass = passes[i];
+
+    if (_hasPackedNodes && !pass->acceptsPackedOps()) {
+      err = unpackOps();
+      if (err) break;
+    }
+
+    if (!stats) {
+      err = pass->process(&_cbPassZone);
+    }
+    else {
+      uint64_t startTime = OSUtils::getHighResTime();
+      err = pass->process(&_cbPassZone);
+
+      CBPassStats& passStats = pass->_stats;
+      passStats.runCount++;
+      passStats.totalTime += OSUtils::getHighResTime() - startTime;
+
+      uint64_t zoneBytes = _cbPassZone.getUsedSize();
+      if (passStats.zoneBytes < zoneBytes)
+        passStats.zoneBytes = zoneBytes;
+    }
+
+    _cbPassZone.reset();
+    if (err) break;
+  }
+
+  _cbPassZone.reset();
+  _passesDone = err == kErrorOk;
+  return err;
+}
+
+// ============================================================================
+// [asmjit::CodeBuilder - Statistics]
+// ============================================================================
+
+void CodeBuilder::resetStats() noexcept {
+  _serializeTime = 0;
+  for (size_t i = 0, len = _cbPasses.getLength(); i < len; i++)
+    _cbPasses[i]->resetStats();
+}
+
+Error CodeBuilder::dumpStats(StringBuilder& sb) const noexcept {
+  for (size_t i = 0, len = _cbPasses.getLength(); i < len; i++)
+    ASMJIT_PROPAGATE(_cbPasses[i]->dumpStats(sb));
+
+  ASMJIT_PROPAGATE(sb.appendFormat("[Serialize] %llu ns\n",
+    static_cast<unsigned long long>(_serializeTime)));
+  return kErrorOk;
+}
+
+#if !defined(ASMJIT_DISABLE_LOGGING)
+Error CodeBuilder::logStats(Logger* logger) const noexcept {
+  if (!logger && _code)
+    logger = _code->getLogger();
+
+  if (ASMJIT_UNLIKELY(!logger))
+    return DebugUtils::errored(kErrorInvalidState);
+
+  StringBuilderTmp<512> sb;
+  ASMJIT_PROPAGATE(dumpStats(sb));
+  return logger->log(sb);
+}
+#endif // !ASMJIT_DISABLE_LOGGING
+
 // ============================================================================
 // [asmjit::CodeBuilder - Serialization]
 // ============================================================================
@@ -505,76 +790,297 @@ Error CodeBuilder::serialize(CodeEmitter* dst) {
   Error err = kErrorOk;
   CBNode* node_ = getFirstNode();
 
-  do {
-    dst->setInlineComment(node_->getInlineComment());
+  while (node_) {
+    err = serializeNode(dst, node_);
+    if (err) break;
+    node_ = node_->getNext();
+  }
 
-    switch (node_->getType()) {
-      case CBNode::kNodeAlign: {
-        CBAlign* node = static_cast<CBAlign*>(node_);
-        err = dst->align(node->getMode(), node->getAlignment());
-        break;
-      }
+  return err;
+}
 
-      case CBNode::kNodeData: {
-        CBData* node = static_cast<CBData*>(node_);
-        err = dst->embed(node->getData(), node->getSize());
-        break;
-      }
+//! \internal
+//!
+//! Get the section of `a` that has the same id as `section`, which is the
+//! section itself if `a` is attached to the code the nodes were created for,
+//! or its copy made by `CodeBuilder::replay()`.
+static ASMJIT_INLINE SectionEntry* CodeBuilder_mapSection(Assembler* a, SectionEntry* section) noexcept {
+  const ZoneVector<SectionEntry*>& sections = a->getCode()->getSections();
+  uint32_t id = section->getId();
+  return id < sections.getLength() ? sections[id] : section;
+}
 
-      case CBNode::kNodeFunc:
-      case CBNode::kNodeLabel: {
-        CBLabel* node = static_cast<CBLabel*>(node_);
-        err = dst->bind(node->getLabel());
-        break;
-      }
+//! \internal
+//!
+//! Embed the jump table `node` at the current position of `dst`.
+static Error CodeBuilder_embedJumpTable(CodeEmitter* dst, CBJumpTable* node) {
+  ASMJIT_PROPAGATE(dst->align(kAlignData, dst->getGpSize()));
+  ASMJIT_PROPAGATE(dst->bind(node->getLabel()));
 
-      case CBNode::kNodeLabelData: {
-        CBLabelData* node = static_cast<CBLabelData*>(node_);
-        err = dst->embedLabel(node->getLabel());
-        break;
-      }
+  for (uint32_t i = 0, size = node->getSize(); i < size; i++)
+    ASMJIT_PROPAGATE(dst->embedLabel(node->getEntryLabel(i)));
+  return kErrorOk;
+}
+
+Error CodeBuilder::serializeNode(CodeEmitter* dst, CBNode* node_) {
+  Error err = kErrorOk;
+  dst->setInlineComment(node_->getInlineComment());
+
+  switch (node_->getType()) {
+    case CBNode::kNodeAlign: {
+      CBAlign* node = static_cast<CBAlign*>(node_);
+      err = dst->align(node->getMode(), node->getAlignment());
+      break;
+    }
 
-      case CBNode::kNodeConstPool: {
-        CBConstPool* node = static_cast<CBConstPool*>(node_);
+    case CBNode::kNodeData: {
+      CBData* node = static_cast<CBData*>(node_);
+      err = dst->embed(node->getData(), node->getSize());
+      break;
+    }
+
+    case CBNode::kNodeFunc:
+    case CBNode::kNodeLabel: {
+      CBLabel* node = static_cast<CBLabel*>(node_);
+      err = dst->bind(node->getLabel());
+      break;
+    }
+
+    case CBNode::kNodeLabelData: {
+      CBLabelData* node = static_cast<CBLabelData*>(node_);
+      err = dst->embedLabel(node->getLabel());
+      break;
+    }
+
+    case CBNode::kNodeConstPool: {
+      CBConstPool* node = static_cast<CBConstPool*>(node_);
+      SectionEntry* section = node->getSection();
+
+      if (section && dst->isAssembler()) {
+        // Embed the pool at the end of its section and continue where the
+        // code was emitted.
+        Assembler* a = static_cast<Assembler*>(dst);
+        SectionEntry* current = a->getSection();
+
+        err = a->setSection(CodeBuilder_mapSection(a, section));
+        if (err) break;
+
+        err = a->embedConstPool(node->getLabel(), node->getConstPool());
+        Error sErr = a->setSection(current);
+        if (!err) err = sErr;
+      }
+      else {
         err = dst->embedConstPool(node->getLabel(), node->getConstPool());
-        break;
       }
+      break;
+    }
 
-      case CBNode::kNodeInst:
-      case CBNode::kNodeFuncCall: {
-        CBInst* node = node_->as<CBInst>();
-        dst->setOptions(node->getOptions());
-        dst->setExtraReg(node->getExtraReg());
-        err = dst->emitOpArray(node->getInstId(), node->getOpArray(), node->getOpCount());
-        break;
+    case CBNode::kNodeJumpTable: {
+      CBJumpTable* node = static_cast<CBJumpTable*>(node_);
+      SectionEntry* section = node->getSection();
+
+      if (section && dst->isAssembler()) {
+        Assembler* a = static_cast<Assembler*>(dst);
+        SectionEntry* current = a->getSection();
+
+        err = a->setSection(CodeBuilder_mapSection(a, section));
+        if (err) break;
+
+        err = CodeBuilder_embedJumpTable(a, node);
+        Error sErr = a->setSection(current);
+        if (!err) err = sErr;
+      }
+      else {
+        err = CodeBuilder_embedJumpTable(dst, node);
       }
+      break;
+    }
 
-      case CBNode::kNodeComment: {
-        CBComment* node = static_cast<CBComment*>(node_);
-        err = dst->comment(node->getInlineComment());
-        break;
+    case CBNode::kNodeSection: {
+      CBSection* node = static_cast<CBSection*>(node_);
+      if (dst->isAssembler()) {
+        Assembler* a = static_cast<Assembler*>(dst);
+        err = a->setSection(CodeBuilder_mapSection(a, node->getSection()));
       }
+      break;
+    }
 
-      default:
+    case CBNode::kNodeInst:
+    case CBNode::kNodeFuncCall: {
+      // Case jumps only describe edges of a jump table.
+      if (node_->isCase())
         break;
+
+      CBInst* node = node_->as<CBInst>();
+      Operand opBuf[CBInst::kMaxPackedOps];
+
+      dst->setOptions(node->getOptions() & ~kOptionReservedMask);
+      dst->setExtraReg(node->getExtraReg());
+      err = dst->emitOpArray(node->getInstId(), node->getOpArray(opBuf), node->getOpCount());
+      break;
     }
 
-    if (err) break;
-    node_ = node_->getNext();
-  } while (node_);
+    case CBNode::kNodeComment: {
+      CBComment* node = static_cast<CBComment*>(node_);
+      err = dst->comment(node->getInlineComment());
+      break;
+    }
+
+    default:
+      break;
+  }
 
   return err;
 }
 
+Error CodeBuilder::flush() {
+  if (_lastError) return _lastError;
+  if (ASMJIT_UNLIKELY(!_code))
+    return DebugUtils::errored(kErrorNotInitialized);
+
+  ASMJIT_PROPAGATE(finalize());
+
+  // Everything has been serialized, release all nodes the same way as when
+  // the `CodeHolder` is recycled, but keep the code.
+  return onRecycle(_code);
+}
+
+// ============================================================================
+// [asmjit::CodeBuilder - Replay]
+// ============================================================================
+
+Error CodeBuilder::setPatchable(CBNode* node) noexcept {
+  if (ASMJIT_UNLIKELY(node->getType() != CBNode::kNodeInst && node->getType() != CBNode::kNodeFuncCall))
+    return DebugUtils::errored(kErrorInvalidArgument);
+
+  if (ASMJIT_UNLIKELY(_passesDone))
+    return DebugUtils::errored(kErrorInvalidState);
+
+  // Patches are written to the operands directly.
+  ASMJIT_PROPAGATE(unpackOps(static_cast<CBInst*>(node)));
+
+  node->orFlags(CBNode::kFlagIsPatchable);
+  return kErrorOk;
+}
+
+Error CodeBuilder::patchImm(CBInst* node, uint32_t index, int64_t value) noexcept {
+  if (ASMJIT_UNLIKELY(!node->hasFlag(CBNode::kFlagIsPatchable) || index >= node->getOpCount()))
+    return DebugUtils::errored(kErrorInvalidArgument);
+
+  Operand& op = node->getOpArray()[index];
+  if (ASMJIT_UNLIKELY(!op.isImm()))
+    return DebugUtils::errored(kErrorInvalidArgument);
+
+  op.as<Imm>().setInt64(value);
+  return kErrorOk;
+}
+
+Error CodeBuilder::patchMem(CBInst* node, uint32_t index, int64_t offset) noexcept {
+  if (ASMJIT_UNLIKELY(!node->hasFlag(CBNode::kFlagIsPatchable) || index >= node->getOpCount()))
+    return DebugUtils::errored(kErrorInvalidArgument);
+
+  Operand& op = node->getOpArray()[index];
+  if (ASMJIT_UNLIKELY(!op.isMem()))
+    return DebugUtils::errored(kErrorInvalidArgument);
+
+  op.as<Mem>().setOffset(offset);
+  return kErrorOk;
+}
+
+Error CodeBuilder::replay(CodeEmitter* dst) {
+  if (_lastError) return _lastError;
+  if (ASMJIT_UNLIKELY(!_code))
+    return DebugUtils::errored(kErrorNotInitialized);
+
+  if (ASMJIT_UNLIKELY(!_passesDone))
+    return DebugUtils::errored(kErrorInvalidState);
+
+  CodeHolder* src = _code;
+  CodeHolder* code = dst->getCode();
+
+  if (ASMJIT_UNLIKELY(!code || code == src))
+    return DebugUtils::errored(kErrorInvalidArgument);
+
+  if (ASMJIT_UNLIKELY(code->getArchType() != src->getArchType()))
+    return DebugUtils::errored(kErrorInvalidArch);
+
+  // Sections and labels are referenced by ids, they must be created in the
+  // same order, which requires a new `CodeHolder`.
+  if (ASMJIT_UNLIKELY(code->getSections().getLength() != 1 || code->getLabelsCount() != 0))
+    return DebugUtils::errored(kErrorInvalidState);
+
+  size_t i;
+  const ZoneVector<SectionEntry*>& sections = src->getSections();
+  for (i = 1; i < sections.getLength(); i++) {
+    const SectionEntry* section = sections[i];
+    SectionEntry* copy;
+    ASMJIT_PROPAGATE(code->newSection(&copy, section->getName(), Globals::kInvalidIndex, section->getFlags(), section->getAlignment()));
+  }
+
+  const ZoneVector<LabelEntry*>& labels = src->getLabelEntries();
+  for (i = 0; i < labels.getLength(); i++) {
+    const LabelEntry* label = labels[i];
+    uint32_t id;
+
+    if (label->getNameLength())
+      ASMJIT_PROPAGATE(code->newNamedLabelId(id, label->getName(), label->getNameLength(), label->getType(), label->getParentId()));
+    else
+      ASMJIT_PROPAGATE(code->newLabelId(id));
+  }
+
+  // Prologs and epilogs were emitted by the register allocator, only the
+  // operations they recorded remain.
+  const ZoneVector<UnwindOp>& unwindOps = src->getUnwindOps();
+  if (!unwindOps.isEmpty()) {
+    code->setUnwindEnabled(true);
+    for (i = 0; i < unwindOps.getLength(); i++) {
+      const UnwindOp& op = unwindOps[i];
+      ASMJIT_PROPAGATE(code->addUnwindOp(op.labelId, op.type, op.regId, op.value));
+    }
+  }
+
+  code->setGlobalHints(code->getGlobalHints() | src->getGlobalHints());
+  return serialize(dst);
+}
+
 // ============================================================================
 // [asmjit::CBPass]
 // ============================================================================
 
 CBPass::CBPass(const char* name) noexcept
   : _cb(nullptr),
-    _name(name) {}
+    _name(name),
+    _phaseNames(nullptr),
+    _phaseCount(0),
+    _acceptsPackedOps(0) { _stats.reset(); }
 CBPass::~CBPass() noexcept {}
 
+Error CBPass::dumpStats(StringBuilder& sb) const noexcept {
+  typedef unsigned long long ULL;
+  const CBPassStats& stats = _stats;
+
+  ASMJIT_PROPAGATE(sb.appendFormat("[%s] %llu ns (runs=%u funcs=%u nodes=%llu spills=%llu loads=%llu remats=%llu dead=%llu coalesced=%llu zone=%llu bytes)\n",
+    _name,
+    static_cast<ULL>(stats.totalTime),
+    stats.runCount,
+    stats.funcCount,
+    static_cast<ULL>(stats.nodeCount),
+    static_cast<ULL>(stats.spillCount),
+    static_cast<ULL>(stats.loadCount),
+    static_cast<ULL>(stats.rematCount),
+    static_cast<ULL>(stats.deadCount),
+    static_cast<ULL>(stats.coalesceCount),
+    static_cast<ULL>(stats.zoneBytes)));
+
+  for (uint32_t i = 0; i < _phaseCount; i++) {
+    ASMJIT_PROPAGATE(sb.appendFormat("  %-16s %llu ns\n",
+      _phaseNames[i],
+      static_cast<ULL>(stats.phaseTime[i])));
+  }
+
+  return kErrorOk;
+}
+
 } // asmjit namespace
 
 // [Api-End]
@@ -38,8 +38,10 @@ class CBConstPool;
 class CBData;
 class CBInst;
 class CBJump;
+class CBJumpTable;
 class CBLabel;
 class CBLabelData;
+class CBSection;
 class CBSentinel;
 
 //! \addtogroup asmjit_base
@@ -69,6 +71,7 @@ public:
 
   ASMJIT_API virtual Error onAttach(CodeHolder* code) noexcept override;
   ASMJIT_API virtual Error onDetach(CodeHolder* code) noexcept override;
+  ASMJIT_API virtual Error onRecycle(CodeHolder* code) noexcept override;
 
   // --------------------------------------------------------------------------
   // [Accessors]
@@ -108,6 +111,29 @@ public:
   template<typename T, typename P0, typename P1, typename P2>
   ASMJIT_INLINE T* newNodeT(P0 p0, P1 p1, P2 p2) noexcept { return new(_cbHeap.alloc(sizeof(T))) T(this, p0, p1, p2); }
 
+  //! \internal
+  //!
+  //! Allocate memory for an instruction node of `nodeSize` bytes (`CBInst` or
+  //! `CBJump`) having `opCount` operands and store the operand array to
+  //! `opArrayOut`. The node must be constructed by the caller.
+  ASMJIT_API void* _allocInstNode(size_t nodeSize, uint32_t opCount, Operand** opArrayOut) noexcept;
+
+  //! \internal
+  //!
+  //! Create a new \ref CBInst node that stores its `opCount` operands packed.
+  //! All operands must be packable, see `PackedOp::canPack()`.
+  ASMJIT_API CBInst* _newPackedInstNode(uint32_t instId, uint32_t options, const Operand_* opArray, uint32_t opCount) noexcept;
+
+  //! Store `opArray` to operands of `node`.
+  //!
+  //! Operands are packed again if `node` stores packed operands and all of them
+  //! can be packed, otherwise `node` is switched to full operands.
+  ASMJIT_API Error setOps(CBInst* node, const Operand* opArray) noexcept;
+  //! Switch `node` to full operands if it stores packed operands.
+  ASMJIT_API Error unpackOps(CBInst* node) noexcept;
+  //! Switch all nodes to full operands.
+  ASMJIT_API Error unpackOps() noexcept;
+
   ASMJIT_API Error registerLabelNode(CBLabel* node) noexcept;
   //! Get `CBLabel` by `id`.
   ASMJIT_API Error getCBLabel(CBLabel** pOut, uint32_t id) noexcept;
@@ -122,8 +148,12 @@ public:
   ASMJIT_API CBData* newDataNode(const void* data, uint32_t size) noexcept;
   //! Create a new \ref CBConstPool node.
   ASMJIT_API CBConstPool* newConstPool() noexcept;
+  //! Create a new \ref CBJumpTable node having `size` entries (all null).
+  ASMJIT_API CBJumpTable* newJumpTable(uint32_t size) noexcept;
   //! Create a new \ref CBComment node.
   ASMJIT_API CBComment* newCommentNode(const char* s, size_t len) noexcept;
+  //! Create a new \ref CBSection node that switches to `section`.
+  ASMJIT_API CBSection* newSectionNode(SectionEntry* section) noexcept;
 
   // --------------------------------------------------------------------------
   // [Code-Emitter]
@@ -177,22 +207,160 @@ public:
   template<typename T>
   ASMJIT_INLINE Error addPassT() noexcept { return addPass(newPassT<T>()); }
   template<typename T, typename P0>
-  ASMJIT_INLINE Error addPassT(P0 p0) noexcept { return addPass(newPassT<P0>(p0)); }
+  ASMJIT_INLINE Error addPassT(P0 p0) noexcept { return addPass(newPassT<T, P0>(p0)); }
   template<typename T, typename P0, typename P1>
-  ASMJIT_INLINE Error addPassT(P0 p0, P1 p1) noexcept { return addPass(newPassT<P0, P1>(p0, p1)); }
+  ASMJIT_INLINE Error addPassT(P0 p0, P1 p1) noexcept { return addPass(newPassT<T, P0, P1>(p0, p1)); }
+
+  template<typename T>
+  ASMJIT_INLINE Error insertPassT(CBPass* before) noexcept { return insertPass(newPassT<T>(), before); }
+  template<typename T, typename P0>
+  ASMJIT_INLINE Error insertPassT(CBPass* before, P0 p0) noexcept { return insertPass(newPassT<T, P0>(p0), before); }
 
   //! Get a `CBPass` by name.
   ASMJIT_API CBPass* getPassByName(const char* name) const noexcept;
   //! Add `pass` to the list of passes.
   ASMJIT_API Error addPass(CBPass* pass) noexcept;
+  //! Insert `pass` to the list of passes before `before`, or add it if `before` is null.
+  ASMJIT_API Error insertPass(CBPass* pass, CBPass* before) noexcept;
   //! Remove `pass` from the list of passes and delete it.
   ASMJIT_API Error deletePass(CBPass* pass) noexcept;
 
+  //! Run all passes, called by `finalize()` of the architecture-specific
+  //! builder or compiler.
+  ASMJIT_API Error runPasses() noexcept;
+
+  // --------------------------------------------------------------------------
+  // [Storage]
+  // --------------------------------------------------------------------------
+
+  //! Get whether instruction nodes use compact storage.
+  ASMJIT_INLINE bool hasCompactInstStorage() const noexcept { return _compactInsts != 0; }
+  //! Enable or disable compact storage of instruction nodes (disabled by default).
+  //!
+  //! Compact storage allocates each `CBInst` and `CBJump` node as a fixed-size
+  //! record, which fits `CBJump` and 4 operands, from a zone dedicated to
+  //! instructions. The records are stored contiguously in the order they were
+  //! emitted, so passes that walk the node list stream through memory instead
+  //! of chasing pointers interleaved with other data. Operands of instructions
+  //! having more than 4 operands are stored out of line. Nodes are still linked
+  //! in the node list, which stays the only way to walk them.
+  ASMJIT_INLINE void setCompactInstStorage(bool enabled) noexcept { _compactInsts = static_cast<uint8_t>(enabled); }
+
+  //! Get the zone used by compact instruction storage.
+  ASMJIT_INLINE Zone* getInstZone() noexcept { return &_cbInstZone; }
+
+  //! Get whether instruction nodes store their operands packed.
+  ASMJIT_INLINE bool hasPackedOpStorage() const noexcept { return _packedOps != 0; }
+  //! Enable or disable packed operand storage of instruction nodes (disabled by default).
+  //!
+  //! Packed storage stores each operand of an instruction as \ref PackedOp,
+  //! which takes 8 bytes instead of 16, if all its operands can be packed
+  //! (registers, labels, and 32-bit immediates). Instructions that use memory
+  //! operands or wider immediates, and jumps, store full operands. This saves
+  //! 8 bytes per operand of most instruction nodes.
+  //!
+  //! The register allocator and serializers unpack operands when they read
+  //! them and pack them back when they modify them. Other passes only see full
+  //! operands - `runPasses()` unpacks all nodes before the first pass that
+  //! doesn't handle packed operands (see `CBPass::acceptsPackedOps()`).
+  ASMJIT_INLINE void setPackedOpStorage(bool enabled) noexcept { _packedOps = static_cast<uint8_t>(enabled); }
+
+  // --------------------------------------------------------------------------
+  // [Statistics]
+  // --------------------------------------------------------------------------
+
+  //! Get whether passes and serialization collect statistics.
+  ASMJIT_INLINE bool hasStatsEnabled() const noexcept { return _statsEnabled != 0; }
+  //! Enable or disable statistics, see \ref CBPassStats (disabled by default).
+  ASMJIT_INLINE void setStatsEnabled(bool enabled) noexcept { _statsEnabled = static_cast<uint8_t>(enabled); }
+
+  //! Get time spent in `serialize()` by `finalize()` in nanoseconds.
+  ASMJIT_INLINE uint64_t getSerializeTime() const noexcept { return _serializeTime; }
+
+  //! Reset statistics of the builder and all of its passes.
+  ASMJIT_API void resetStats() noexcept;
+  //! Format statistics of the builder and all of its passes into `sb`.
+  ASMJIT_API Error dumpStats(StringBuilder& sb) const noexcept;
+
+#if !defined(ASMJIT_DISABLE_LOGGING)
+  //! Send statistics formatted by `dumpStats()` to `logger`, or to the logger
+  //! of the attached \ref CodeHolder if `logger` is null.
+  ASMJIT_API Error logStats(Logger* logger = nullptr) const noexcept;
+#endif // !ASMJIT_DISABLE_LOGGING
+
   // --------------------------------------------------------------------------
   // [Serialization]
   // --------------------------------------------------------------------------
 
+  //! Serialize all nodes to `dst`.
   ASMJIT_API virtual Error serialize(CodeEmitter* dst);
+  //! Serialize a single `node` to `dst`, used by `serialize()`.
+  ASMJIT_API Error serializeNode(CodeEmitter* dst, CBNode* node);
+
+  //! Serialize all nodes emitted so far by `finalize()` and release them.
+  //!
+  //! This is a streaming alternative to a single `finalize()` at the end,
+  //! which keeps all nodes alive until the very end. The code is appended to
+  //! the .text section of the attached \ref CodeHolder, and all nodes, their
+  //! data, and everything passes allocated are released afterwards (memory
+  //! is kept and reused by the next nodes), so the peak memory is bounded by
+  //! the code emitted between two `flush()` calls instead of the whole code.
+  //!
+  //! Labels stay valid after `flush()`, labels bound by it can still be used
+  //! by instructions that follow, but they are not part of the node list
+  //! anymore, so jumps to them are not followed by passes. Nodes returned by
+  //! the builder before `flush()` must not be used after it.
+  ASMJIT_API virtual Error flush();
+
+  // --------------------------------------------------------------------------
+  // [Replay]
+  // --------------------------------------------------------------------------
+
+  //! Mark instruction `node` patchable, see `replay()`.
+  //!
+  //! Must be called before `finalize()`, so passes leave immediate and memory
+  //! operands of `node` as they are (see \ref CBNode::kFlagIsPatchable).
+  ASMJIT_API Error setPatchable(CBNode* node) noexcept;
+
+  //! Patch the immediate operand at `index` of a patchable `node` to `value`.
+  ASMJIT_API Error patchImm(CBInst* node, uint32_t index, int64_t value) noexcept;
+  //! Patch the offset of the memory operand at `index` of a patchable `node`
+  //! to `offset` (the displacement, or the address if it has no base).
+  ASMJIT_API Error patchMem(CBInst* node, uint32_t index, int64_t offset) noexcept;
+
+  //! Get whether the nodes were processed by passes and can be replayed.
+  ASMJIT_INLINE bool canReplay() const noexcept { return _passesDone != 0; }
+
+  //! Serialize nodes processed by `finalize()` again to `dst`.
+  //!
+  //! Replay re-instantiates a finalized function with different constants
+  //! without creating nodes or virtual registers and without running passes,
+  //! the register allocator included, it only serializes the nodes again. The
+  //! constants are changed by `patchImm()` and `patchMem()` before each replay,
+  //! passes don't touch operands of patchable nodes, so the allocation never
+  //! depends on them. The patched value must be encodable by the instruction,
+  //! otherwise the replay fails with the error of the assembler.
+  //!
+  //! `dst` must be attached to a new \ref CodeHolder of the same architecture,
+  //! replay adds to it sections, labels, and unwind operations of the code
+  //! the builder is attached to, so the builder has to stay attached to it
+  //! and must not be changed, `flush()` ends the possibility to replay.
+  //!
+  //! ~~~
+  //! cc.mov(x, 1);
+  //! CBInst* k = cc.getCursor()->as<CBInst>();
+  //! cc.setPatchable(k);
+  //! ...
+  //! cc.finalize();
+  //!
+  //! CodeHolder code2;
+  //! code2.init(rt.getCodeInfo());
+  //! X86Assembler a(&code2);
+  //!
+  //! cc.patchImm(k, 1, 42);
+  //! cc.replay(&a);
+  //! ~~~
+  ASMJIT_API Error replay(CodeEmitter* dst);
 
   // --------------------------------------------------------------------------
   // [Members]
@@ -201,7 +369,9 @@ public:
   Zone _cbBaseZone;                      //!< Base zone used to allocate nodes and `CBPass`.
   Zone _cbDataZone;                      //!< Data zone used to allocate data and names.
   Zone _cbPassZone;                      //!< Zone passed to `CBPass::process()`.
+  Zone _cbInstZone;                      //!< Zone used by compact instruction storage.
   ZoneHeap _cbHeap;                      //!< ZoneHeap that uses `_cbBaseZone`.
+  Zone::State _cbPassState;              //!< State of `_cbBaseZone` after the last pass was added.
 
   ZoneVector<CBPass*> _cbPasses;         //!< Array of `CBPass` objects.
   ZoneVector<CBLabel*> _cbLabels;        //!< Maps label indexes to `CBLabel` nodes.
@@ -212,6 +382,44 @@ public:
 
   uint32_t _position;                    //!< Flow-id assigned to each new node.
   uint32_t _nodeFlags;                   //!< Flags assigned to each new node.
+
+  uint8_t _statsEnabled;                 //!< Whether to collect statistics.
+  uint8_t _compactInsts;                 //!< Whether instruction nodes use compact storage.
+  uint8_t _packedOps;                    //!< Whether instruction nodes store packed operands.
+  uint8_t _hasPackedNodes;               //!< Whether any node stores packed operands.
+  uint8_t _passesDone;                   //!< Whether passes processed the nodes, see `replay()`.
+  uint64_t _serializeTime;               //!< Time spent in `serialize()` called by `finalize()`.
+};
+
+// ============================================================================
+// [asmjit::CBPassStats]
+// ============================================================================
+
+//! Timing and counters collected by a \ref CBPass if the \ref CodeBuilder
+//! has statistics enabled, see \ref CodeBuilder::setStatsEnabled().
+//!
+//! Statistics accumulate over all `finalize()` calls until they are reset by
+//! \ref CodeBuilder::resetStats(). All times are in nanoseconds measured by
+//! \ref OSUtils::getHighResTime().
+struct CBPassStats {
+  enum {
+    //! Maximum number of phases a pass can report.
+    kMaxPhases = 8
+  };
+
+  ASMJIT_INLINE void reset() noexcept { ::memset(this, 0, sizeof(*this)); }
+
+  uint32_t runCount;                     //!< Number of times `CBPass::process()` was called.
+  uint32_t funcCount;                    //!< Number of functions processed (if the pass works on functions).
+  uint64_t totalTime;                    //!< Total time spent in `CBPass::process()`.
+  uint64_t nodeCount;                    //!< Number of nodes processed.
+  uint64_t spillCount;                   //!< Number of registers saved to memory (register allocation).
+  uint64_t loadCount;                    //!< Number of registers loaded from memory (register allocation).
+  uint64_t rematCount;                   //!< Number of registers rematerialized instead of loaded (register allocation).
+  uint64_t deadCount;                    //!< Number of dead instructions removed (register allocation).
+  uint64_t coalesceCount;                //!< Number of copies removed by coalescing (register allocation).
+  uint64_t zoneBytes;                    //!< Peak size of zone memory used by a single `process()` call.
+  uint64_t phaseTime[kMaxPhases];        //!< Time spent in each phase, see \ref CBPass::getPhaseName().
 };
 
 // ============================================================================
@@ -250,12 +458,41 @@ public:
   ASMJIT_INLINE const CodeBuilder* cb() const noexcept { return _cb; }
   ASMJIT_INLINE const char* getName() const noexcept { return _name; }
 
+  //! Get whether `process()` handles nodes that store packed operands, see
+  //! `CodeBuilder::setPackedOpStorage()`.
+  ASMJIT_INLINE bool acceptsPackedOps() const noexcept { return _acceptsPackedOps != 0; }
+
+  // --------------------------------------------------------------------------
+  // [Statistics]
+  // --------------------------------------------------------------------------
+
+  //! Get statistics collected by this pass.
+  ASMJIT_INLINE const CBPassStats& getStats() const noexcept { return _stats; }
+  //! Reset statistics collected by this pass.
+  ASMJIT_INLINE void resetStats() noexcept { _stats.reset(); }
+
+  //! Get the number of phases this pass reports in \ref CBPassStats::phaseTime.
+  ASMJIT_INLINE uint32_t getPhaseCount() const noexcept { return _phaseCount; }
+  //! Get the name of the phase `phase`.
+  ASMJIT_INLINE const char* getPhaseName(uint32_t phase) const noexcept {
+    ASMJIT_ASSERT(phase < _phaseCount);
+    return _phaseNames[phase];
+  }
+
+  //! Format statistics of this pass into `sb`.
+  ASMJIT_API virtual Error dumpStats(StringBuilder& sb) const noexcept;
+
   // --------------------------------------------------------------------------
   // [Members]
   // --------------------------------------------------------------------------
 
   CodeBuilder* _cb;                      //!< CodeBuilder this pass is assigned to.
   const char* _name;                     //!< Name of the pass.
+
+  const char* const* _phaseNames;        //!< Names of phases, set by the pass.
+  uint32_t _phaseCount;                  //!< Number of phases, at most `CBPassStats::kMaxPhases`.
+  uint32_t _acceptsPackedOps;            //!< Whether `process()` handles packed operands.
+  CBPassStats _stats;                    //!< Statistics.
 };
 
 // ============================================================================
@@ -290,6 +527,8 @@ public:
     kNodeConstPool  = 6,                 //!< Node is \ref CBConstPool.
     kNodeComment    = 7,                 //!< Node is \ref CBComment.
     kNodeSentinel   = 8,                 //!< Node is \ref CBSentinel.
+    kNodeJumpTable  = 9,                 //!< Node is \ref CBJumpTable.
+    kNodeSection    = 10,                //!< Node is \ref CBSection.
 
     // [CodeCompiler]
     kNodeFunc       = 16,                //!< Node is \ref CCFunc (considered as \ref CBLabel by \ref CodeBuilder).
@@ -332,7 +571,21 @@ public:
     kFlagIsSpecial = 0x0100,
 
     //! Whether the instruction is an FPU instruction.
-    kFlagIsFp = 0x0200
+    kFlagIsFp = 0x0200,
+
+    //! If the `CBJump` is an edge of a \ref CBJumpTable.
+    //!
+    //! The jump is never emitted, it's a conditional jump from the point of
+    //! view of passes and its target is stored in the table instead.
+    kFlagIsCase = 0x0400,
+
+    //! If the `CBInst` stores its operands packed, see \ref PackedOp.
+    kFlagHasPackedOps = 0x0800,
+
+    //! If the `CBInst` has operands patched by `CodeBuilder::patchImm()` or
+    //! `CodeBuilder::patchMem()`, passes must not rewrite, remove, or copy
+    //! its immediate and memory operands.
+    kFlagIsPatchable = 0x1000
   };
 
   // --------------------------------------------------------------------------
@@ -401,6 +654,8 @@ public:
   ASMJIT_INLINE bool isJmpOrJcc() const noexcept { return hasFlag(kFlagIsJmp | kFlagIsJcc); }
   //! Whether the `CBInst` node is a return.
   ASMJIT_INLINE bool isRet() const noexcept { return hasFlag(kFlagIsRet); }
+  //! Whether the `CBJump` node is an edge of a \ref CBJumpTable.
+  ASMJIT_INLINE bool isCase() const noexcept { return hasFlag(kFlagIsCase); }
 
   //! Get whether the node is `CBInst` and the instruction is special.
   ASMJIT_INLINE bool isSpecial() const noexcept { return hasFlag(kFlagIsSpecial); }
@@ -449,6 +704,48 @@ public:
   void* _passData;                       //!< Data used exclusively by the current `CBPass`.
 };
 
+// ============================================================================
+// [asmjit::PackedOp]
+// ============================================================================
+
+//! Operand packed into 8 bytes, used by packed operand storage of `CBInst`.
+//!
+//! Registers and labels are packed as their signature and id, immediates as
+//! their signature and a value that fits into a signed 32-bit integer. Memory
+//! operands and wider immediates can't be packed, an instruction having any
+//! of them stores all its operands as `Operand` (see `CBInst::hasPackedOps()`).
+struct PackedOp {
+  //! Get whether `op` can be packed.
+  static ASMJIT_INLINE bool canPack(const Operand_& op) noexcept {
+    if (op.isImm())
+      return op._imm.id == 0 && Utils::isInt32(op._imm.value.i64);
+    else
+      return !op.isMem() && op._packed[1].u64 == 0;
+  }
+
+  //! Pack `op`, which must be packable, see `canPack()`.
+  ASMJIT_INLINE void pack(const Operand_& op) noexcept {
+    ASMJIT_ASSERT(canPack(op));
+    signature = op._signature;
+    data = op.isImm() ? static_cast<uint32_t>(op._imm.value.u64) : op._any.id;
+  }
+
+  //! Unpack to `op`.
+  ASMJIT_INLINE void unpack(Operand_& op) const noexcept {
+    if ((signature & Operand::kSignatureOpMask) == (Operand::kOpImm << Operand::kSignatureOpShift)) {
+      op._init_packed_d0_d1(signature, 0);
+      op._imm.value.i64 = static_cast<int64_t>(static_cast<int32_t>(data));
+    }
+    else {
+      op._init_packed_d0_d1(signature, data);
+      op._init_packed_d2_d3(0, 0);
+    }
+  }
+
+  uint32_t signature;                    //!< Operand signature.
+  uint32_t data;                         //!< Register or label id, or 32-bit immediate value.
+};
+
 // ============================================================================
 // [asmjit::CBInst]
 // ============================================================================
@@ -460,6 +757,11 @@ class CBInst : public CBNode {
 public:
   ASMJIT_NONCOPYABLE(CBInst)
 
+  enum {
+    //! Maximum number of operands of an instruction that stores them packed.
+    kMaxPackedOps = 4
+  };
+
   // --------------------------------------------------------------------------
   // [Construction / Destruction]
   // --------------------------------------------------------------------------
@@ -523,9 +825,41 @@ public:
   //! Get operands count.
   ASMJIT_INLINE uint32_t getOpCount() const noexcept { return _opCount; }
   //! Get operands list.
-  ASMJIT_INLINE Operand* getOpArray() noexcept { return _opArray; }
+  //!
+  //! NOTE: Can only be called if the operands are not packed, see
+  //! `hasPackedOps()` and `CodeBuilder::unpackOps()`.
+  ASMJIT_INLINE Operand* getOpArray() noexcept {
+    ASMJIT_ASSERT(!hasPackedOps());
+    return _opArray;
+  }
   //! \overload
-  ASMJIT_INLINE const Operand* getOpArray() const noexcept { return _opArray; }
+  ASMJIT_INLINE const Operand* getOpArray() const noexcept {
+    ASMJIT_ASSERT(!hasPackedOps());
+    return _opArray;
+  }
+
+  //! Get operands list for reading, unpacked to `buf` if they are packed.
+  //!
+  //! The buffer must be able to hold `kMaxPackedOps` operands.
+  ASMJIT_INLINE const Operand* getOpArray(Operand* buf) const noexcept {
+    if (!hasPackedOps())
+      return _opArray;
+
+    for (uint32_t i = 0, opCount = getOpCount(); i < opCount; i++)
+      _packedOps[i].unpack(buf[i]);
+    return buf;
+  }
+
+  //! Get whether the operands are packed, see \ref PackedOp.
+  //!
+  //! Packed operands are read by `getOpArray(Operand* buf)` and modified by
+  //! `CodeBuilder::setOps()`.
+  ASMJIT_INLINE bool hasPackedOps() const noexcept { return hasFlag(kFlagHasPackedOps); }
+  //! Get packed operands (only valid if `hasPackedOps()` returns true).
+  ASMJIT_INLINE PackedOp* getPackedOps() const noexcept {
+    ASMJIT_ASSERT(hasPackedOps());
+    return _packedOps;
+  }
 
   //! Get whether the instruction contains a memory operand.
   ASMJIT_INLINE bool hasMemOp() const noexcept { return _memOpIndex != 0xFF; }
@@ -574,7 +908,11 @@ Update:
   Inst::Detail _instDetail;              //!< Instruction id, options, and extra register.
   uint8_t _memOpIndex;                   //!< \internal
   uint8_t _reserved[7];                  //!< \internal
-  Operand* _opArray;                     //!< Instruction operands.
+
+  union {
+    Operand* _opArray;                   //!< Instruction operands.
+    PackedOp* _packedOps;                //!< Instruction operands, packed (see `hasPackedOps()`).
+  };
 };
 
 // ============================================================================
@@ -827,7 +1165,8 @@ public:
   //! Create a new `CBConstPool` instance.
   ASMJIT_INLINE CBConstPool(CodeBuilder* cb, uint32_t id = kInvalidValue) noexcept
     : CBLabel(cb, id),
-      _constPool(&cb->_cbBaseZone) { _type = kNodeConstPool; }
+      _constPool(&cb->_cbBaseZone),
+      _section(nullptr) { _type = kNodeConstPool; }
 
   //! Destroy the `CBConstPool` instance (NEVER CALLED).
   ASMJIT_INLINE ~CBConstPool() noexcept {}
@@ -851,11 +1190,123 @@ public:
     return _constPool.add(data, size, dstOffset);
   }
 
+  //! Get the section the pool is embedded into, null if it's embedded in place.
+  ASMJIT_INLINE SectionEntry* getSection() const noexcept { return _section; }
+  //! Set the section the pool is embedded into by an \ref Assembler.
+  ASMJIT_INLINE void setSection(SectionEntry* section) noexcept { _section = section; }
+
   // --------------------------------------------------------------------------
   // [Members]
   // --------------------------------------------------------------------------
 
   ConstPool _constPool;
+  SectionEntry* _section;                //!< Target section, or null.
+};
+
+// ============================================================================
+// [asmjit::CBJumpTable]
+// ============================================================================
+
+//! Jump table (CodeBuilder).
+//!
+//! A table of absolute addresses of jump targets, the label of the node is
+//! bound to the first entry. Every entry refers to a \ref CBJump flagged as
+//! \ref CBNode::kFlagIsCase, which is placed before the indirect jump that
+//! reads the table. These jumps make the edges of the table visible to all
+//! passes (a register allocator can retarget them), the table is emitted by
+//! using their final targets.
+class CBJumpTable : public CBLabel {
+public:
+  ASMJIT_NONCOPYABLE(CBJumpTable)
+
+  // --------------------------------------------------------------------------
+  // [Construction / Destruction]
+  // --------------------------------------------------------------------------
+
+  //! Create a new `CBJumpTable` instance.
+  ASMJIT_INLINE CBJumpTable(CodeBuilder* cb, CBJump** entries, uint32_t size) noexcept
+    : CBLabel(cb),
+      _entries(entries),
+      _size(size),
+      _section(nullptr) { _type = kNodeJumpTable; }
+
+  //! Destroy the `CBJumpTable` instance (NEVER CALLED).
+  ASMJIT_INLINE ~CBJumpTable() noexcept {}
+
+  // --------------------------------------------------------------------------
+  // [Accessors]
+  // --------------------------------------------------------------------------
+
+  //! Get the number of entries.
+  ASMJIT_INLINE uint32_t getSize() const noexcept { return _size; }
+  //! Get the case jump of the entry `index`.
+  ASMJIT_INLINE CBJump* getEntry(uint32_t index) const noexcept {
+    ASMJIT_ASSERT(index < _size);
+    return _entries[index];
+  }
+  //! Set the case jump of the entry `index`.
+  ASMJIT_INLINE void setEntry(uint32_t index, CBJump* node) noexcept {
+    ASMJIT_ASSERT(index < _size);
+    _entries[index] = node;
+  }
+
+  //! Get the label the entry `index` jumps to.
+  ASMJIT_INLINE Label getEntryLabel(uint32_t index) const noexcept {
+    const CBJump* node = getEntry(index);
+    return static_cast<const Label&>(node->getOpArray()[node->getOpCount() - 1]);
+  }
+
+  //! Get the section the table is embedded into, null if it's embedded in place.
+  ASMJIT_INLINE SectionEntry* getSection() const noexcept { return _section; }
+  //! Set the section the table is embedded into by an \ref Assembler.
+  ASMJIT_INLINE void setSection(SectionEntry* section) noexcept { _section = section; }
+
+  // --------------------------------------------------------------------------
+  // [Members]
+  // --------------------------------------------------------------------------
+
+  CBJump** _entries;                     //!< Case jumps of all entries.
+  uint32_t _size;                        //!< Number of entries.
+  SectionEntry* _section;                //!< Target section, or null.
+};
+
+// ============================================================================
+// [asmjit::CBSection]
+// ============================================================================
+
+//! Section switch (CodeBuilder).
+//!
+//! An \ref Assembler emits all nodes that follow into the section, until
+//! another `CBSection` switches back, other emitters ignore it. It's used to
+//! move rarely executed code into a cold section.
+class CBSection : public CBNode {
+public:
+  ASMJIT_NONCOPYABLE(CBSection)
+
+  // --------------------------------------------------------------------------
+  // [Construction / Destruction]
+  // --------------------------------------------------------------------------
+
+  //! Create a new `CBSection` instance.
+  ASMJIT_INLINE CBSection(CodeBuilder* cb, SectionEntry* section) noexcept
+    : CBNode(cb, kNodeSection),
+      _section(section) {}
+
+  //! Destroy the `CBSection` instance (NEVER CALLED).
+  ASMJIT_INLINE ~CBSection() noexcept {}
+
+  // --------------------------------------------------------------------------
+  // [Accessors]
+  // --------------------------------------------------------------------------
+
+  //! Get the section.
+  ASMJIT_INLINE SectionEntry* getSection() const noexcept { return _section; }
+
+  // --------------------------------------------------------------------------
+  // [Members]
+  // --------------------------------------------------------------------------
+
+  SectionEntry* _section;                //!< Section.
 };
 
 // ============================================================================
@@ -16,6 +16,7 @@
 #include "../base/codecompiler.h"
 #include "../base/cpuinfo.h"
 #include "../base/logging.h"
+#include "../base/osutils.h"
 #include "../base/regalloc_p.h"
 #include "../base/utils.h"
 #include <stdarg.h>
@@ -31,6 +32,51 @@ namespace asmjit {
 
 static const char noName[1] = { '\0' };
 
+//! Maximum count of cached function details, the cache is cleared when full.
+static const uint32_t kCCFuncDetailCacheMaxSize = 256;
+
+// ============================================================================
+// [asmjit::CCFuncDetailEntry]
+// ============================================================================
+
+//! \internal
+//!
+//! Cached `FuncDetail` of a `FuncSignature`, `_customData` packs the calling
+//! convention, argument count, vararg index and return type of the signature.
+struct CCFuncDetailEntry : public ZoneHashNode {
+  uint8_t _args[kFuncArgCount];          //!< Argument types of the signature.
+  FuncDetail _detail;                    //!< Function detail initialized to the signature.
+};
+
+//! \internal
+//!
+//! Only used to lookup a `CCFuncDetailEntry` in `CodeCompiler::_funcDetailCache`.
+class CCFuncDetailBySignature {
+public:
+  ASMJIT_INLINE CCFuncDetailBySignature(const FuncSignature& sign) noexcept
+    : args(sign.getArgs()),
+      argCount(sign.getArgCount()),
+      header((sign.getCallConv()      ) |
+             (sign.getArgCount() <<  8) |
+             (sign.getVAIndex()  << 16) |
+             (sign.getRet()      << 24)) {
+
+    uint32_t h = header;
+    for (uint32_t i = 0; i < argCount; i++)
+      h = Utils::hashRound(h, args[i]);
+    hVal = h;
+  }
+
+  ASMJIT_INLINE bool matches(const CCFuncDetailEntry* entry) const noexcept {
+    return entry->_customData == header && (argCount == 0 || ::memcmp(entry->_args, args, argCount) == 0);
+  }
+
+  const uint8_t* args;
+  uint32_t argCount;
+  uint32_t header;
+  uint32_t hVal;
+};
+
 // ============================================================================
 // [asmjit::CCFuncCall - Arg / Ret]
 // ============================================================================
@@ -58,10 +104,15 @@ bool CCFuncCall::_setRet(uint32_t i, const Operand_& op) noexcept {
 CodeCompiler::CodeCompiler() noexcept
   : CodeBuilder(),
     _func(nullptr),
+    _raStrategy(kRAStrategyLocal),
     _vRegZone(4096 - Zone::kZoneOverhead),
     _vRegArray(),
     _localConstPool(nullptr),
-    _globalConstPool(nullptr) {
+    _globalConstPool(nullptr),
+    _constSection(nullptr),
+    _funcDetailZone(8192 - Zone::kZoneOverhead),
+    _funcDetailHeap(&_funcDetailZone),
+    _funcDetailCache(&_funcDetailHeap) {
 
   _type = kTypeCompiler;
 }
@@ -80,6 +131,7 @@ Error CodeCompiler::onDetach(CodeHolder* code) noexcept {
 
   _localConstPool = nullptr;
   _globalConstPool = nullptr;
+  _constSection = nullptr;
 
   _vRegArray.reset();
   _vRegZone.reset(false);
@@ -87,6 +139,69 @@ Error CodeCompiler::onDetach(CodeHolder* code) noexcept {
   return Base::onDetach(code);
 }
 
+Error CodeCompiler::onRecycle(CodeHolder* code) noexcept {
+  _func = nullptr;
+
+  _localConstPool = nullptr;
+  _globalConstPool = nullptr;
+  _constSection = nullptr;
+
+  // Must be reset before `CodeBuilder::onRecycle()` recycles `_cbHeap`.
+  _vRegArray.reset();
+  _vRegZone.reset(false);
+
+  return Base::onRecycle(code);
+}
+
+// ============================================================================
+// [asmjit::CodeCompiler - Serialization]
+// ============================================================================
+
+Error CodeCompiler::flush() {
+  if (_lastError) return _lastError;
+
+  // Passes can only process complete functions.
+  if (ASMJIT_UNLIKELY(_func))
+    return setLastError(DebugUtils::errored(kErrorInvalidState));
+
+  return Base::flush();
+}
+
+//! \internal
+struct CodeCompilerFinalizeJob {
+  CodeCompiler* const* compilers;
+  Error* errors;
+};
+
+static void ASMJIT_CDECL CodeCompiler_finalizeOne(void* data, size_t index) {
+  CodeCompilerFinalizeJob* job = static_cast<CodeCompilerFinalizeJob*>(data);
+  job->errors[index] = job->compilers[index]->finalize();
+}
+
+Error CodeCompiler::finalizeAll(CodeCompiler* const* compilers, size_t count, uint32_t threadCount) noexcept {
+  if (!count) return kErrorOk;
+
+  Error* errors = static_cast<Error*>(Internal::allocMemory(count * sizeof(Error)));
+  if (ASMJIT_UNLIKELY(!errors))
+    return DebugUtils::errored(kErrorNoHeapMemory);
+
+  CodeCompilerFinalizeJob job;
+  job.compilers = compilers;
+  job.errors = errors;
+  OSUtils::runParallel(CodeCompiler_finalizeOne, &job, count, threadCount);
+
+  Error err = kErrorOk;
+  for (size_t i = 0; i < count; i++) {
+    if (errors[i]) {
+      err = errors[i];
+      break;
+    }
+  }
+
+  Internal::releaseMemory(errors);
+  return err;
+}
+
 // ============================================================================
 // [asmjit::CodeCompiler - Node-Factory]
 // ============================================================================
@@ -123,7 +238,7 @@ CCFunc* CodeCompiler::newFunc(const FuncSignature& sign) noexcept {
     goto _NoMemory;
 
   // Function prototype.
-  err = func->getDetail().init(sign);
+  err = _initFuncDetail(func->getDetail(), sign);
   if (err != kErrorOk) {
     setLastError(err);
     return nullptr;
@@ -196,6 +311,47 @@ CBSentinel* CodeCompiler::endFunc() {
   return end;
 }
 
+Error CodeCompiler::_initFuncDetail(FuncDetail& detail, const FuncSignature& sign) noexcept {
+  if (ASMJIT_UNLIKELY(sign.getArgCount() > kFuncArgCount))
+    return DebugUtils::errored(kErrorInvalidArgument);
+
+  // Custom calling conventions are not part of the key, don't cache them.
+  if (sign.hasCustomCallConv())
+    return detail.init(sign);
+
+  CCFuncDetailBySignature key(sign);
+  CCFuncDetailEntry* entry = _funcDetailCache.get(key);
+
+  if (entry) {
+    ::memcpy(&detail, &entry->_detail, sizeof(FuncDetail));
+    return kErrorOk;
+  }
+
+  ASMJIT_PROPAGATE(detail.init(sign));
+
+  // Start over if the cache is full, signatures used by a single compiler
+  // are usually just a few.
+  if (_funcDetailCache.getSize() >= kCCFuncDetailCacheMaxSize) {
+    _funcDetailCache.reset(&_funcDetailHeap);
+    _funcDetailHeap.reset(&_funcDetailZone);
+    _funcDetailZone.reset(false);
+  }
+
+  // Failing to cache the detail is not an error.
+  entry = _funcDetailZone.allocT<CCFuncDetailEntry>();
+  if (ASMJIT_LIKELY(entry)) {
+    entry->_hashNext = nullptr;
+    entry->_hVal = key.hVal;
+    entry->_customData = key.header;
+    if (key.argCount)
+      ::memcpy(entry->_args, key.args, key.argCount);
+    ::memcpy(&entry->_detail, &detail, sizeof(FuncDetail));
+    _funcDetailCache.put(entry);
+  }
+
+  return kErrorOk;
+}
+
 // ============================================================================
 // [asmjit::CodeCompiler - Ret]
 // ============================================================================
@@ -232,7 +388,7 @@ CCFuncCall* CodeCompiler::newCall(uint32_t instId, const Operand_& o0, const Fun
   opArray[0].copyFrom(o0);
   new (node) CCFuncCall(this, instId, 0, opArray, 1);
 
-  if ((err = node->getDetail().init(sign)) != kErrorOk) {
+  if ((err = _initFuncDetail(node->getDetail(), sign)) != kErrorOk) {
     setLastError(err);
     return nullptr;
   }
@@ -258,6 +414,32 @@ CCFuncCall* CodeCompiler::addCall(uint32_t instId, const Operand_& o0, const Fun
   return static_cast<CCFuncCall*>(addNode(node));
 }
 
+CCFuncCall* CodeCompiler::addTailCall(uint32_t instId, const Operand_& o0, const FuncSignature& sign) noexcept {
+  CCFunc* func = getFunc();
+  if (ASMJIT_UNLIKELY(!func)) {
+    setLastError(DebugUtils::errored(kErrorInvalidState));
+    return nullptr;
+  }
+
+  CCFuncCall* node = newCall(instId, o0, sign);
+  if (!node) return nullptr;
+
+  // The callee can't use stack arguments as there is no call frame, and the
+  // current function can't pop its own as the callee returns instead of it.
+  const FuncDetail& fd = func->getDetail();
+  if (node->getDetail().getArgStackSize() != 0 ||
+      (fd.hasFlag(CallConv::kFlagCalleePopsStack) && fd.getArgStackSize() != 0)) {
+    setLastError(DebugUtils::errored(kErrorInvalidState));
+    return nullptr;
+  }
+
+  addNode(node);
+  if (!addRet(Operand(), Operand()))
+    return nullptr;
+
+  return node;
+}
+
 // ============================================================================
 // [asmjit::CodeCompiler - Vars]
 // ============================================================================
@@ -457,7 +639,9 @@ Error CodeCompiler::_newStack(Mem& out, uint32_t size, uint32_t alignment, const
 
 Error CodeCompiler::_newConst(Mem& out, uint32_t scope, const void* data, size_t size) {
   CBConstPool** pPool;
-  if (scope == kConstScopeLocal)
+  if (_constSection && (scope == kConstScopeLocal || scope == kConstScopeGlobal))
+    pPool = &_globalConstPool;
+  else if (scope == kConstScopeLocal)
     pPool = &_localConstPool;
   else if (scope == kConstScopeGlobal)
     pPool = &_globalConstPool;
@@ -468,6 +652,7 @@ Error CodeCompiler::_newConst(Mem& out, uint32_t scope, const void* data, size_t
     return setLastError(DebugUtils::errored(kErrorNoHeapMemory));
 
   CBConstPool* pool = *pPool;
+  pool->setSection(_constSection);
   size_t off;
 
   Error err = pool->add(data, size, off);
@@ -484,6 +669,21 @@ Error CodeCompiler::_newConst(Mem& out, uint32_t scope, const void* data, size_t
   return kErrorOk;
 }
 
+Error CodeCompiler::setConstSection(SectionEntry* section) {
+  if (_lastError) return _lastError;
+  if (ASMJIT_UNLIKELY(!_code))
+    return DebugUtils::errored(kErrorNotInitialized);
+
+  if (section) {
+    uint32_t id = section->getId();
+    if (ASMJIT_UNLIKELY(id >= _code->getSections().getLength() || _code->getSectionEntry(id) != section))
+      return setLastError(DebugUtils::errored(kErrorInvalidSection));
+  }
+
+  _constSection = section;
+  return kErrorOk;
+}
+
 Error CodeCompiler::alloc(Reg& reg) {
   if (!reg.isVirtReg()) return kErrorOk;
   return _hint(reg, CCHint::kHintAlloc, kInvalidValue);
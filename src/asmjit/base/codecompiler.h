@@ -33,6 +33,7 @@ struct VirtReg;
 struct TiedReg;
 struct RAState;
 struct RACell;
+struct CCFuncDetailEntry;
 
 //! \addtogroup asmjit_base
 //! \{
@@ -49,6 +50,33 @@ ASMJIT_ENUM(ConstScope) {
   kConstScopeGlobal = 1
 };
 
+// ============================================================================
+// [asmjit::RAStrategy]
+// ============================================================================
+
+//! Register allocation strategy used by `RAPass` (per \ref CCFunc or per
+//! \ref CodeCompiler).
+ASMJIT_ENUM(RAStrategy) {
+  //! Use the strategy of \ref CodeCompiler (only valid for \ref CCFunc).
+  kRAStrategyDefault = 0,
+  //! Local allocator that looks ahead to pick registers (the default). It
+  //! generates the best code, but its cost grows with the size of functions.
+  kRAStrategyLocal = 1,
+  //! Linear-scan heuristics built on top of live ranges computed from the
+  //! liveness analysis. When a register has to be freed the variable that
+  //! stays alive the longest is spilled instead of the first one found,
+  //! which reduces reloads in large functions with high register pressure.
+  kRAStrategyLinearScan = 2,
+  //! Global allocation built on top of linear-scan. Loops are found by their
+  //! back-edges and each variable gets a spill weight, which is the sum of
+  //! estimated frequencies of its uses (each loop level multiplies the
+  //! frequency by 8). The variable with the lowest weight is spilled first
+  //! and variables alive across a loop, but not used in it, are spilled in
+  //! the loop pre-header if the loop doesn't have enough registers, so the
+  //! loop itself never reloads them.
+  kRAStrategyGlobal = 3
+};
+
 // ============================================================================
 // [asmjit::VirtReg]
 // ============================================================================
@@ -126,6 +154,14 @@ struct VirtReg {
   //! Get whether the VirtReg is only memory allocated on the stack.
   ASMJIT_INLINE bool isStack() const noexcept { return static_cast<bool>(_isStack); }
 
+  //! Get whether the VirtReg is a constant recreated instead of loaded from memory.
+  //!
+  //! Only valid during register allocation, the instruction that recreates it
+  //! is available through `getMaterializeNode()`.
+  ASMJIT_INLINE bool isMaterialized() const noexcept { return static_cast<bool>(_isMaterialized); }
+  //! Get the instruction that writes the VirtReg, used to rematerialize it.
+  ASMJIT_INLINE CBNode* getMaterializeNode() const noexcept { return _materializeNode; }
+
   //! Get whether to save variable when it's unused (spill).
   ASMJIT_INLINE bool saveOnUnuse() const noexcept { return static_cast<bool>(_saveOnUnuse); }
 
@@ -168,12 +204,15 @@ struct VirtReg {
   uint32_t _raId;                        //!< Register allocator work-id (used by RAPass).
   int32_t _memOffset;                    //!< Home memory offset.
   uint32_t _homeMask;                    //!< Mask of all registers variable has been allocated to.
+  uint32_t _rangeEnd;                    //!< Last node position where the variable is alive (linear-scan).
+  uint32_t _spillWeight;                 //!< Sum of estimated frequencies of all uses (global).
 
   uint8_t _state;                        //!< Variable state (connected with actual `RAState)`.
   uint8_t _physId;                       //!< Actual register index (only used by `RAPass)`, during translate.
   uint8_t _modified;                     //!< Whether variable was changed (connected with actual `RAState)`.
 
   RACell* _memCell;                      //!< Home memory cell, used by `RAPass` (initially nullptr).
+  CBNode* _materializeNode;              //!< First node that writes the register, used by `RAPass` (initially nullptr).
 
   //! Temporary link to TiedReg* used by the `RAPass` used in
   //! various phases, but always set back to nullptr when finished.
@@ -252,6 +291,62 @@ public:
   uint32_t _value;
 };
 
+// ============================================================================
+// [asmjit::CCFuncReport]
+// ============================================================================
+
+//! Register allocation report of a \ref CCFunc (CodeCompiler).
+//!
+//! Filled by the register allocator if the compiler has statistics enabled,
+//! see \ref CodeBuilder::setStatsEnabled() and \ref CCFunc::getReport(). The
+//! report of a function is replaced each time the function is allocated.
+struct CCFuncReport {
+  //! Type of a \ref Move.
+  ASMJIT_ENUM(MoveType) {
+    kMoveSpill = 0,                      //!< Register saved to its memory home.
+    kMoveLoad  = 1,                      //!< Register loaded from its memory home.
+    kMoveRemat = 2,                      //!< Register rematerialized instead of loaded.
+    kMoveReg   = 3,                      //!< Register moved or swapped to another register.
+    kMoveCount = 4                       //!< Count of move types.
+  };
+
+  //! Move inserted by the register allocator.
+  struct Move {
+    CBNode* node;                        //!< Inserted instruction.
+    uint32_t vregId;                     //!< Id of the moved virtual register.
+    uint8_t type;                        //!< Type of the move, see \ref MoveType.
+    uint8_t atSwitch;                    //!< Whether the move was inserted by a state switch.
+    uint16_t reserved;                   //!< \internal
+  };
+
+  ASMJIT_INLINE void reset() noexcept {
+    ::memset(maxLive, 0, sizeof(maxLive));
+    ::memset(moveCount, 0, sizeof(moveCount));
+    switchMoveCount = 0;
+    varStackSize = 0;
+    stackSize = 0;
+    moves.clear();
+  }
+
+  //! Maximum count of virtual registers alive at once, per register kind.
+  uint32_t maxLive[Globals::kMaxVRegKinds];
+  //! Count of moves of each type, see \ref MoveType.
+  uint32_t moveCount[kMoveCount];
+  //! Count of moves of all types inserted by state switches, which join the
+  //! register assignments of two code paths (jumps and their targets).
+  uint32_t switchMoveCount;
+  //! Size of memory homes of spilled virtual registers.
+  uint32_t varStackSize;
+  //! Size of memory homes and stack memory of the function (without the call
+  //! frame and saved registers), as resolved by the register allocator.
+  uint32_t stackSize;
+  //! All moves in order of insertion.
+  //!
+  //! The nodes are valid until the compiler is reset, but passes running
+  //! after the register allocator may remove them from the node list.
+  ZoneVector<Move> moves;
+};
+
 // ============================================================================
 // [asmjit::CCFunc]
 // ============================================================================
@@ -275,7 +370,9 @@ public:
       _exitNode(nullptr),
       _end(nullptr),
       _args(nullptr),
-      _isFinished(false) {
+      _report(nullptr),
+      _isFinished(false),
+      _raStrategy(kRAStrategyDefault) {
 
     _type = kNodeFunc;
   }
@@ -334,6 +431,18 @@ public:
   ASMJIT_INLINE uint32_t getAttributes() const noexcept { return _frameInfo.getAttributes(); }
   ASMJIT_INLINE void addAttributes(uint32_t attrs) noexcept { _frameInfo.addAttributes(attrs); }
 
+  //! Get register allocation strategy of this function, see \ref RAStrategy.
+  ASMJIT_INLINE uint32_t getRAStrategy() const noexcept { return _raStrategy; }
+  //! Set register allocation strategy of this function, see \ref RAStrategy.
+  ASMJIT_INLINE void setRAStrategy(uint32_t strategy) noexcept {
+    ASMJIT_ASSERT(strategy <= kRAStrategyGlobal);
+    _raStrategy = static_cast<uint8_t>(strategy);
+  }
+
+  //! Get the register allocation report of this function, or null if the
+  //! function was not allocated with statistics enabled.
+  ASMJIT_INLINE const CCFuncReport* getReport() const noexcept { return _report; }
+
   // --------------------------------------------------------------------------
   // [Members]
   // --------------------------------------------------------------------------
@@ -345,9 +454,12 @@ public:
   CBSentinel* _end;                      //!< Function end.
 
   VirtReg** _args;                       //!< Arguments array as `VirtReg`.
+  CCFuncReport* _report;                 //!< Register allocation report or null.
 
   //! Function was finished by `Compiler::endFunc()`.
   uint8_t _isFinished;
+  //! Register allocation strategy, see \ref RAStrategy.
+  uint8_t _raStrategy;
 };
 
 // ============================================================================
@@ -576,6 +688,33 @@ public:
 
   ASMJIT_API virtual Error onAttach(CodeHolder* code) noexcept override;
   ASMJIT_API virtual Error onDetach(CodeHolder* code) noexcept override;
+  ASMJIT_API virtual Error onRecycle(CodeHolder* code) noexcept override;
+
+  // --------------------------------------------------------------------------
+  // [Serialization]
+  // --------------------------------------------------------------------------
+
+  //! Serialize all functions emitted so far and release them, see
+  //! `CodeBuilder::flush()`.
+  //!
+  //! Fails with `kErrorInvalidState` if a function is still open. Virtual
+  //! registers are released as well, so registers created before `flush()`
+  //! must not be used after it.
+  ASMJIT_API virtual Error flush() override;
+
+  //! Finalize `count` compilers on up to `threadCount` threads (zero means
+  //! the count of hardware threads), see \ref OSUtils::runParallel().
+  //!
+  //! Each compiler must be attached to its own `CodeHolder` - compilers share
+  //! no state, so register allocation and serialization of one compiler run
+  //! independently of others and the generated code is the same as if they
+  //! were finalized one by one. Use `JitRuntime::addBatch()` to relocate the
+  //! results into a single allocation. Error handlers of the compilers must
+  //! not throw.
+  //!
+  //! Returns the error of the first compiler (in the order of `compilers`)
+  //! that failed, or `kErrorOk`.
+  static ASMJIT_API Error finalizeAll(CodeCompiler* const* compilers, size_t count, uint32_t threadCount = 0) noexcept;
 
   // --------------------------------------------------------------------------
   // [Node-Factory]
@@ -602,6 +741,22 @@ public:
   //! Emit a sentinel that marks the end of the current function.
   ASMJIT_API CBSentinel* endFunc();
 
+  //! \internal
+  //!
+  //! Initialize `detail` to `sign`. Details are cached per signature, which
+  //! is fully described by its calling convention, return and argument types,
+  //! so functions and calls that share a signature only copy the cached one.
+  ASMJIT_API Error _initFuncDetail(FuncDetail& detail, const FuncSignature& sign) noexcept;
+
+  //! Get the default register allocation strategy, see \ref RAStrategy.
+  ASMJIT_INLINE uint32_t getRAStrategy() const noexcept { return _raStrategy; }
+  //! Set the default register allocation strategy used by functions that
+  //! don't specify their own, see \ref RAStrategy.
+  ASMJIT_INLINE void setRAStrategy(uint32_t strategy) noexcept {
+    ASMJIT_ASSERT(strategy >= kRAStrategyLocal && strategy <= kRAStrategyGlobal);
+    _raStrategy = strategy;
+  }
+
   // --------------------------------------------------------------------------
   // [Ret]
   // --------------------------------------------------------------------------
@@ -620,6 +775,14 @@ public:
   //! Add a new `CCFuncCall`.
   ASMJIT_API CCFuncCall* addCall(uint32_t instId, const Operand_& o0, const FuncSignature& sign) noexcept;
 
+  //! Add a new `CCFuncCall` that is a tail call (`instId` is a jump) followed
+  //! by `CCFuncRet`.
+  //!
+  //! The function frame is released before the jump, so the callee returns
+  //! directly to the caller of the current function. The callee must not use
+  //! stack arguments and must return what the current function returns.
+  ASMJIT_API CCFuncCall* addTailCall(uint32_t instId, const Operand_& o0, const FuncSignature& sign) noexcept;
+
   // --------------------------------------------------------------------------
   // [Args]
   // --------------------------------------------------------------------------
@@ -655,6 +818,25 @@ public:
   ASMJIT_API Error _newStack(Mem& out, uint32_t size, uint32_t alignment, const char* name);
   ASMJIT_API Error _newConst(Mem& out, uint32_t scope, const void* data, size_t size);
 
+  // --------------------------------------------------------------------------
+  // [Const]
+  // --------------------------------------------------------------------------
+
+  //! Get the section of constants, or null if constants are placed after the
+  //! code of their function (local) or after all functions (global).
+  ASMJIT_INLINE SectionEntry* getConstSection() const noexcept { return _constSection; }
+
+  //! Place all constants into `section` of the attached \ref CodeHolder, for
+  //! example a `.rodata` section created by `CodeHolder::newSection()`.
+  //!
+  //! Data is then not mixed with code. All constants use a single pool, which
+  //! is flushed at the end of the compilation, so identical constants used by
+  //! all functions of the CodeHolder are stored only once, regardless of their
+  //! \ref ConstScope. The section should be aligned to at least 64 bytes so
+  //! constants don't share cache lines with code. Pass null to place constants
+  //! into the code again.
+  ASMJIT_API Error setConstSection(SectionEntry* section);
+
   // --------------------------------------------------------------------------
   // [VirtReg]
   // --------------------------------------------------------------------------
@@ -718,12 +900,18 @@ public:
   // --------------------------------------------------------------------------
 
   CCFunc* _func;                         //!< Current function.
+  uint32_t _raStrategy;                  //!< Default register allocation strategy.
 
   Zone _vRegZone;                        //!< Allocates \ref VirtReg objects.
   ZoneVector<VirtReg*> _vRegArray;       //!< Stores array of \ref VirtReg pointers.
 
   CBConstPool* _localConstPool;          //!< Local constant pool, flushed at the end of each function.
   CBConstPool* _globalConstPool;         //!< Global constant pool, flushed at the end of the compilation.
+  SectionEntry* _constSection;           //!< Section of constant pools, or null.
+
+  Zone _funcDetailZone;                  //!< Allocates cached \ref FuncDetail entries.
+  ZoneHeap _funcDetailHeap;              //!< Allocates `_funcDetailCache` slots.
+  ZoneFlatHash<CCFuncDetailEntry> _funcDetailCache; //!< FuncSignature -> FuncDetail cache.
 };
 
 //! \}
@@ -88,6 +88,19 @@ Error CodeEmitter::onDetach(CodeHolder* code) noexcept {
   return kErrorOk;
 }
 
+Error CodeEmitter::onRecycle(CodeHolder* code) noexcept {
+  ASMJIT_UNUSED(code);
+
+  _finalized = false;
+  _lastError = kErrorOk;
+
+  _options = 0;
+  _extraReg.reset();
+  _inlineComment = nullptr;
+
+  return kErrorOk;
+}
+
 // ============================================================================
 // [asmjit::CodeEmitter - Code-Generation]
 // ============================================================================
@@ -171,7 +184,7 @@ Error CodeEmitter::commentf(const char* fmt, ...) {
   if (err) return err;
 
 #if !defined(ASMJIT_DISABLE_LOGGING)
-  if (_globalOptions & kOptionLoggingEnabled) {
+  if ((_globalOptions & kOptionLoggingEnabled) && _code->_logger->isEnabled(Logger::kCategoryComment, Logger::kLevelInfo)) {
     va_list ap;
     va_start(ap, fmt);
     err = _code->_logger->logv(fmt, ap);
@@ -189,7 +202,7 @@ Error CodeEmitter::commentv(const char* fmt, va_list ap) {
   if (err) return err;
 
 #if !defined(ASMJIT_DISABLE_LOGGING)
-  if (_globalOptions & kOptionLoggingEnabled)
+  if ((_globalOptions & kOptionLoggingEnabled) && _code->_logger->isEnabled(Logger::kCategoryComment, Logger::kLevelInfo))
     err = _code->_logger->logv(fmt, ap);
 #else
   ASMJIT_UNUSED(fmt);
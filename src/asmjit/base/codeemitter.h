@@ -77,7 +77,22 @@ public:
     //! This feature is disabled by default, because the only processor that
     //! used to take into consideration prediction hints was P4. Newer processors
     //! implement heuristics for branch prediction that ignores any static hints.
-    kHintPredictedJumps = 0x00000002U
+    kHintPredictedJumps = 0x00000002U,
+
+    //! Emit the shortest encoding if there is more than one equivalent.
+    //!
+    //! Default `false`.
+    //!
+    //! X86/X64 Specific
+    //! ----------------
+    //!
+    //! VEX2 prefix can only be used if the register encoded in ModRM.rm is
+    //! not an extended register (REX.B). If this hint is enabled the assembler
+    //! swaps sources of commutative instructions (see `X86Inst::isCommutative()`)
+    //! and uses the MR form of register-to-register moves when that avoids
+    //! VEX3. Short immediates, VEX2, and compressed disp8*N displacements are
+    //! always preferred and are not affected by this hint.
+    kHintShortestEncoding = 0x00000004U
   };
 
   //! CodeEmitter options that are merged with instruction options.
@@ -163,6 +178,11 @@ public:
   virtual Error onAttach(CodeHolder* code) noexcept = 0;
   //! Called after the \ref CodeEmitter was detached from the \ref CodeHolder.
   virtual Error onDetach(CodeHolder* code) noexcept = 0;
+  //! Called after the \ref CodeHolder was recycled, see `CodeHolder::recycle()`.
+  //!
+  //! The emitter stays attached and should drop everything it generated while
+  //! keeping memory it can reuse in the next round.
+  ASMJIT_API virtual Error onRecycle(CodeHolder* code) noexcept;
 
   // --------------------------------------------------------------------------
   // [Code-Generation]
@@ -9,6 +9,8 @@
 
 // [Dependencies]
 #include "../base/assembler.h"
+#include "../base/jittest_p.h"
+#include "../base/runtime.h"
 #include "../base/utils.h"
 #include "../base/vmem.h"
 
@@ -51,9 +53,13 @@ static void CodeHolder_resetInternal(CodeHolder* self, bool releaseMemory) noexc
   self->_globalOptions = 0;
   self->_logger = nullptr;
   self->_errorHandler = nullptr;
+  self->_traceBuffer = nullptr;
 
   self->_unresolvedLabelsCount = 0;
   self->_trampolinesSize = 0;
+  self->_statsEnabled = 0;
+  self->_unwindEnabled = 0;
+  self->_stats.reset();
 
   // Reset all sections.
   size_t numSections = self->_sections.getLength();
@@ -69,12 +75,28 @@ static void CodeHolder_resetInternal(CodeHolder* self, bool releaseMemory) noexc
   ZoneHeap* heap = &self->_baseHeap;
 
   self->_namedLabels.reset(heap);
+  self->_unwindOps.reset();
   self->_relocations.reset();
   self->_labels.reset();
   self->_sections.reset();
 
   heap->reset(&self->_baseZone);
   self->_baseZone.reset(releaseMemory);
+  self->_dataZone.reset(releaseMemory);
+}
+
+static Error CodeHolder_initDefaultSection(CodeHolder* self) noexcept {
+  // Create the default section and insert it to the `_sections` array.
+  ASMJIT_PROPAGATE(self->_sections.willGrow(&self->_baseHeap));
+
+  SectionEntry* se = self->_baseZone.allocZeroedT<SectionEntry>();
+  if (ASMJIT_UNLIKELY(!se))
+    return DebugUtils::errored(kErrorNoHeapMemory);
+
+  se->_flags = SectionEntry::kFlagExec | SectionEntry::kFlagConst;
+  se->_setDefaultName('.', 't', 'e', 'x', 't');
+  self->_sections.appendUnsafe(se);
+  return kErrorOk;
 }
 
 // ============================================================================
@@ -89,12 +111,15 @@ CodeHolder::CodeHolder() noexcept
     _cgAsm(nullptr),
     _logger(nullptr),
     _errorHandler(nullptr),
+    _traceBuffer(nullptr),
     _unresolvedLabelsCount(0),
     _trampolinesSize(0),
+    _statsEnabled(0),
+    _unwindEnabled(0),
     _baseZone(16384 - Zone::kZoneOverhead),
     _dataZone(16384 - Zone::kZoneOverhead),
     _baseHeap(&_baseZone),
-    _namedLabels(&_baseHeap) {}
+    _namedLabels(&_baseHeap) { _stats.reset(); }
 
 CodeHolder::~CodeHolder() noexcept {
   CodeHolder_resetInternal(this, true);
@@ -113,20 +138,7 @@ Error CodeHolder::init(const CodeInfo& info) noexcept {
   // If we are just initializing there should be no emitters attached).
   ASMJIT_ASSERT(_emitters == nullptr);
 
-  // Create the default section and insert it to the `_sections` array.
-  Error err = _sections.willGrow(&_baseHeap);
-  if (err == kErrorOk) {
-    SectionEntry* se = _baseZone.allocZeroedT<SectionEntry>();
-    if (ASMJIT_LIKELY(se)) {
-      se->_flags = SectionEntry::kFlagExec | SectionEntry::kFlagConst;
-      se->_setDefaultName('.', 't', 'e', 'x', 't');
-      _sections.appendUnsafe(se);
-    }
-    else {
-      err = DebugUtils::errored(kErrorNoHeapMemory);
-    }
-  }
-
+  Error err = CodeHolder_initDefaultSection(this);
   if (ASMJIT_UNLIKELY(err)) {
     _baseZone.reset(false);
     return err;
@@ -141,6 +153,69 @@ void CodeHolder::reset(bool releaseMemory) noexcept {
   CodeHolder_resetInternal(this, releaseMemory);
 }
 
+Error CodeHolder::recycle() noexcept {
+  if (ASMJIT_UNLIKELY(!isInitialized()))
+    return DebugUtils::errored(kErrorNotInitialized);
+
+  // Make sure the length of each buffer is up-to-date before it's cleared.
+  sync();
+
+  // Keep the buffer of the default section, release buffers of the others.
+  CodeBuffer buffer = _sections[0]->_buffer;
+  buffer._length = 0;
+
+  size_t numSections = _sections.getLength();
+  for (size_t i = 1; i < numSections; i++) {
+    SectionEntry* section = _sections[i];
+    if (section->_buffer.hasData() && !section->_buffer.isExternal())
+      Internal::releaseMemory(section->_buffer._data);
+  }
+
+  _unresolvedLabelsCount = 0;
+  _trampolinesSize = 0;
+
+  // Zone blocks are kept by `reset(false)`, dynamic blocks by `recycle()`.
+  ZoneHeap* heap = &_baseHeap;
+
+  _namedLabels.reset(heap);
+  _unwindOps.reset();
+  _relocations.reset();
+  _labels.reset();
+  _sections.reset();
+
+  _baseZone.reset(false);
+  _dataZone.reset(false);
+  heap->recycle(&_baseZone);
+
+  Error err = CodeHolder_initDefaultSection(this);
+  if (ASMJIT_UNLIKELY(err)) {
+    if (buffer.hasData() && !buffer.isExternal())
+      Internal::releaseMemory(buffer._data);
+    return err;
+  }
+  _sections[0]->_buffer = buffer;
+
+  // Notify all attached emitters, they have to drop everything that refers
+  // to labels and sections, which are gone now.
+  for (CodeEmitter* emitter = _emitters; emitter; emitter = emitter->_nextEmitter) {
+    Error eErr = emitter->onRecycle(this);
+    if (!err) err = eErr;
+  }
+
+  return err;
+}
+
+Error CodeHolder::reserve(size_t labelCount, size_t relocCount, size_t namedLabelCount) noexcept {
+  if (ASMJIT_UNLIKELY(!isInitialized()))
+    return DebugUtils::errored(kErrorNotInitialized);
+
+  ZoneHeap* heap = &_baseHeap;
+  ASMJIT_PROPAGATE(_labels.willGrow(heap, labelCount));
+  ASMJIT_PROPAGATE(_relocations.willGrow(heap, relocCount));
+  ASMJIT_PROPAGATE(_namedLabels.reserve(_namedLabels.getSize() + namedLabelCount));
+  return kErrorOk;
+}
+
 // ============================================================================
 // [asmjit::CodeHolder - Attach / Detach]
 // ============================================================================
@@ -238,10 +313,74 @@ void CodeHolder::sync() noexcept {
 
 size_t CodeHolder::getCodeSize() const noexcept {
   // Reflect all changes first.
-  const_cast<CodeHolder*>(this)->sync();
+  CodeHolder* self = const_cast<CodeHolder*>(this);
+  self->sync();
+
+  return self->layoutSections() + getTrampolinesSize();
+}
+
+size_t CodeHolder::getRelocatedSize(uint64_t rangeLo, uint64_t rangeHi) const noexcept {
+  size_t codeSize = getCodeSize();
+  if (!_trampolinesSize || !rangeHi)
+    return codeSize;
+
+  // The displacement is monotonic in the address of the code, so a target
+  // reachable from both ends of the range is reachable from all of it.
+  size_t trampolinesSize = 0;
+  size_t numRelocs = _relocations.getLength();
+  const RelocEntry* const* reArray = _relocations.getData();
+
+  for (size_t i = 0; i < numRelocs; i++) {
+    const RelocEntry* re = reArray[i];
+    if (re->getType() != RelocEntry::kTypeTrampoline)
+      continue;
+
+    uint64_t target = re->getData();
+    if (!Utils::isInt32(static_cast<int64_t>(target - rangeLo)) ||
+        !Utils::isInt32(static_cast<int64_t>(target - rangeHi)))
+      trampolinesSize += 8;
+  }
 
-  // TODO: Support sections.
-  return _sections[0]->_buffer._length + getTrampolinesSize();
+  return codeSize - _trampolinesSize + trampolinesSize;
+}
+
+// ============================================================================
+// [asmjit::CodeHolder - Global Information]
+// ============================================================================
+
+void CodeHolder::setGlobalHints(uint32_t hints) noexcept {
+  _globalHints = hints;
+
+  CodeEmitter* emitter = _emitters;
+  while (emitter) {
+    emitter->_globalHints = hints;
+    emitter = emitter->_nextEmitter;
+  }
+}
+
+void CodeHolder::setStrictValidation(bool enabled) noexcept {
+  uint32_t opt = 0;
+  if (enabled) opt = CodeEmitter::kOptionStrictValidation;
+
+  CodeHolder_setGlobalOption(this, CodeEmitter::kOptionStrictValidation, opt);
+}
+
+// ============================================================================
+// [asmjit::CodeHolder - Unwind]
+// ============================================================================
+
+Error CodeHolder::addUnwindOp(uint32_t labelId, uint32_t type, uint32_t regId, int32_t value) noexcept {
+  ASMJIT_PROPAGATE(_unwindOps.willGrow(&_baseHeap));
+
+  UnwindOp op;
+  op.labelId = labelId;
+  op.type = static_cast<uint8_t>(type);
+  op.regId = static_cast<uint8_t>(regId);
+  op.reserved = 0;
+  op.value = value;
+
+  _unwindOps.appendUnsafe(op);
+  return kErrorOk;
 }
 
 // ============================================================================
@@ -267,6 +406,20 @@ Error CodeHolder::setErrorHandler(ErrorHandler* handler) noexcept {
 // [asmjit::CodeHolder - Sections]
 // ============================================================================
 
+static void CodeHolder_updateAssemblerBuffer(CodeHolder* self, CodeBuffer* cb) noexcept {
+  // Update the `Assembler` pointers if attached. Maybe we should introduce an
+  // event for this, but since only one Assembler can be attached at a time it
+  // should not matter how these pointers are updated.
+  Assembler* a = self->_cgAsm;
+  if (a && &a->_section->_buffer == cb) {
+    size_t offset = a->getOffset();
+
+    a->_bufferData = cb->_data;
+    a->_bufferEnd  = cb->_data + cb->_capacity;
+    a->_bufferPtr  = cb->_data + offset;
+  }
+}
+
 static Error CodeHolder_reserveInternal(CodeHolder* self, CodeBuffer* cb, size_t n) noexcept {
   uint8_t* oldData = cb->_data;
   uint8_t* newData;
@@ -279,21 +432,17 @@ static Error CodeHolder_reserveInternal(CodeHolder* self, CodeBuffer* cb, size_t
   if (ASMJIT_UNLIKELY(!newData))
     return DebugUtils::errored(kErrorNoHeapMemory);
 
+  // The content of an external buffer has to be copied, the buffer is owned
+  // by the CodeHolder from now.
+  if (oldData && cb->isExternal()) {
+    ::memcpy(newData, oldData, cb->_length);
+    cb->_isExternal = false;
+  }
+
   cb->_data = newData;
   cb->_capacity = n;
 
-  // Update the `Assembler` pointers if attached. Maybe we should introduce an
-  // event for this, but since only one Assembler can be attached at a time it
-  // should not matter how these pointers are updated.
-  Assembler* a = self->_cgAsm;
-  if (a && &a->_section->_buffer == cb) {
-    size_t offset = a->getOffset();
-
-    a->_bufferData = newData;
-    a->_bufferEnd  = newData + n;
-    a->_bufferPtr  = newData + offset;
-  }
-
+  CodeHolder_updateAssemblerBuffer(self, cb);
   return kErrorOk;
 }
 
@@ -343,6 +492,82 @@ Error CodeHolder::growBuffer(CodeBuffer* cb, size_t n) noexcept {
   return CodeHolder_reserveInternal(this, cb, capacity - Globals::kAllocOverhead);
 }
 
+SectionEntry* CodeHolder::getSectionByName(const char* name, size_t nameLength) const noexcept {
+  if (nameLength == Globals::kInvalidIndex)
+    nameLength = ::strlen(name);
+
+  if (nameLength > SectionEntry::kMaxNameLength)
+    return nullptr;
+
+  for (size_t i = 0, count = _sections.getLength(); i < count; i++) {
+    SectionEntry* section = _sections[i];
+    if (::memcmp(section->_name, name, nameLength) == 0 && section->_name[nameLength] == '\0')
+      return section;
+  }
+
+  return nullptr;
+}
+
+Error CodeHolder::newSection(SectionEntry** sectionOut, const char* name, size_t nameLength, uint32_t flags, uint32_t alignment) noexcept {
+  *sectionOut = nullptr;
+
+  if (nameLength == Globals::kInvalidIndex)
+    nameLength = ::strlen(name);
+
+  if (ASMJIT_UNLIKELY(nameLength == 0 || nameLength > SectionEntry::kMaxNameLength || ::memchr(name, 0, nameLength)))
+    return DebugUtils::errored(kErrorInvalidSection);
+
+  if (alignment == 0)
+    alignment = 1;
+
+  if (ASMJIT_UNLIKELY(!Utils::isPowerOf2(alignment) || alignment > Globals::kMaxAlignment))
+    return DebugUtils::errored(kErrorInvalidArgument);
+
+  if (ASMJIT_UNLIKELY(getSectionByName(name, nameLength)))
+    return DebugUtils::errored(kErrorSectionAlreadyExists);
+
+  ASMJIT_PROPAGATE(_sections.willGrow(&_baseHeap));
+
+  SectionEntry* se = _baseZone.allocZeroedT<SectionEntry>();
+  if (ASMJIT_UNLIKELY(!se))
+    return DebugUtils::errored(kErrorNoHeapMemory);
+
+  se->_id = static_cast<uint32_t>(_sections.getLength());
+  se->_flags = flags;
+  se->_alignment = alignment;
+  ::memcpy(se->_name, name, nameLength);
+  _sections.appendUnsafe(se);
+
+  *sectionOut = se;
+  return kErrorOk;
+}
+
+size_t CodeHolder::layoutSections() noexcept {
+  size_t numSections = _sections.getLength();
+  uint64_t offset = 0;
+
+  // Hot sections first (in order of their creation), cold sections last.
+  for (uint32_t cold = 0; cold < 2; cold++) {
+    for (size_t i = 0; i < numSections; i++) {
+      SectionEntry* section = _sections[i];
+      if (section->hasFlag(SectionEntry::kFlagCold) != (cold != 0))
+        continue;
+
+      size_t size = std::max<size_t>(section->getPhysicalSize(), section->getVirtualSize());
+      if (i != 0 && size == 0) {
+        section->_offset = offset;
+        continue;
+      }
+
+      offset = Utils::alignTo<uint64_t>(offset, std::max<uint32_t>(section->getAlignment(), 1));
+      section->_offset = offset;
+      offset += size;
+    }
+  }
+
+  return static_cast<size_t>(offset);
+}
+
 Error CodeHolder::reserveBuffer(CodeBuffer* cb, size_t n) noexcept {
   size_t capacity = cb->getCapacity();
   if (n <= capacity) return kErrorOk;
@@ -356,6 +581,27 @@ Error CodeHolder::reserveBuffer(CodeBuffer* cb, size_t n) noexcept {
   return CodeHolder_reserveInternal(this, cb, n);
 }
 
+Error CodeHolder::setExternalBuffer(CodeBuffer* cb, void* data, size_t capacity, bool fixedSize) noexcept {
+  if (_cgAsm) _cgAsm->sync();
+
+  if (ASMJIT_UNLIKELY(cb->getLength() != 0))
+    return DebugUtils::errored(kErrorInvalidState);
+
+  if (ASMJIT_UNLIKELY(!data && capacity != 0))
+    return DebugUtils::errored(kErrorInvalidArgument);
+
+  if (cb->hasData() && !cb->isExternal())
+    Internal::releaseMemory(cb->_data);
+
+  cb->_data = static_cast<uint8_t*>(data);
+  cb->_capacity = capacity;
+  cb->_isExternal = data != nullptr;
+  cb->_isFixedSize = data != nullptr && fixedSize;
+
+  CodeHolder_updateAssemblerBuffer(this, cb);
+  return kErrorOk;
+}
+
 // ============================================================================
 // [asmjit::CodeHolder - Labels & Symbols]
 // ============================================================================
@@ -367,18 +613,22 @@ namespace {
 //! Only used to lookup a label from `_namedLabels`.
 class LabelByName {
 public:
-  ASMJIT_INLINE LabelByName(const char* name, size_t nameLength, uint32_t hVal) noexcept
+  ASMJIT_INLINE LabelByName(const char* name, size_t nameLength, uint32_t hVal, uint32_t parentId) noexcept
     : name(name),
-      nameLength(static_cast<uint32_t>(nameLength)) {}
+      nameLength(static_cast<uint32_t>(nameLength)),
+      hVal(hVal),
+      parentId(parentId) {}
 
   ASMJIT_INLINE bool matches(const LabelEntry* entry) const noexcept {
     return static_cast<uint32_t>(entry->getNameLength()) == nameLength &&
+           entry->getParentId() == parentId &&
            ::memcmp(entry->getName(), name, nameLength) == 0;
   }
 
   const char* name;
   uint32_t nameLength;
   uint32_t hVal;
+  uint32_t parentId;
 };
 
 // Returns a hash of `name` and fixes `nameLength` if it's `Globals::kInvalidIndex`.
@@ -407,11 +657,25 @@ static uint32_t CodeHolder_hashNameAndFixLen(const char* name, size_t& nameLengt
 } // anonymous namespace
 
 LabelLink* CodeHolder::newLabelLink(LabelEntry* le, uint32_t sectionId, size_t offset, intptr_t rel) noexcept {
-  LabelLink* link = _baseHeap.allocT<LabelLink>();
-  if (ASMJIT_UNLIKELY(!link)) return nullptr;
+  uint32_t count = le->_linkCount;
+  uint32_t capacity = LabelEntry::_getLinkCapacity(count);
+
+  // Grow the links array by doubling its capacity. Released arrays are pooled
+  // by `ZoneHeap` and reused by other labels.
+  if (count == capacity) {
+    uint32_t newCapacity = count ? capacity * 2 : uint32_t(LabelEntry::kMinLinkCapacity);
+    LabelLink* newLinks = static_cast<LabelLink*>(_baseHeap.alloc(newCapacity * sizeof(LabelLink)));
+    if (ASMJIT_UNLIKELY(!newLinks)) return nullptr;
+
+    if (count) {
+      ::memcpy(newLinks, le->_links, count * sizeof(LabelLink));
+      _baseHeap.release(le->_links, capacity * sizeof(LabelLink));
+    }
+    le->_links = newLinks;
+  }
 
-  link->prev = le->_links;
-  le->_links = link;
+  LabelLink* link = &le->_links[count];
+  le->_linkCount = count + 1;
 
   link->sectionId = sectionId;
   link->relocId = RelocEntry::kInvalidId;
@@ -422,6 +686,17 @@ LabelLink* CodeHolder::newLabelLink(LabelEntry* le, uint32_t sectionId, size_t o
   return link;
 }
 
+void CodeHolder::_releaseLabelLinks(LabelEntry* le) noexcept {
+  uint32_t count = le->_linkCount;
+  if (!count) return;
+
+  _baseHeap.release(le->_links, LabelEntry::_getLinkCapacity(count) * sizeof(LabelLink));
+  _unresolvedLabelsCount -= count;
+
+  le->_linkCount = 0;
+  le->_links = nullptr;
+}
+
 Error CodeHolder::newLabelId(uint32_t& idOut) noexcept {
   idOut = 0;
 
@@ -477,7 +752,7 @@ Error CodeHolder::newNamedLabelId(uint32_t& idOut, const char* name, size_t name
   // Don't allow to insert duplicates. Local labels allow duplicates that have
   // different id, this is already accomplished by having a different hashes
   // between the same label names having different parent labels.
-  LabelEntry* le = _namedLabels.get(LabelByName(name, nameLength, hVal));
+  LabelEntry* le = _namedLabels.get(LabelByName(name, nameLength, hVal, parentId));
   if (ASMJIT_UNLIKELY(le))
     return DebugUtils::errored(kErrorLabelAlreadyDefined);
 
@@ -497,7 +772,7 @@ Error CodeHolder::newNamedLabelId(uint32_t& idOut, const char* name, size_t name
   le->_hVal = hVal;
   le->_setId(id);
   le->_type = static_cast<uint8_t>(type);
-  le->_parentId = 0;
+  le->_parentId = parentId;
   le->_sectionId = SectionEntry::kInvalidId;
   le->_offset = 0;
 
@@ -511,8 +786,9 @@ Error CodeHolder::newNamedLabelId(uint32_t& idOut, const char* name, size_t name
     le->_name.setExternal(nameExternal, nameLength);
   }
 
+  if (ASMJIT_UNLIKELY(!_namedLabels.put(le)))
+    return DebugUtils::errored(kErrorNoHeapMemory);
   _labels.appendUnsafe(le);
-  _namedLabels.put(le);
 
   idOut = id;
   return err;
@@ -522,7 +798,10 @@ uint32_t CodeHolder::getLabelIdByName(const char* name, size_t nameLength, uint3
   uint32_t hVal = CodeHolder_hashNameAndFixLen(name, nameLength);
   if (ASMJIT_UNLIKELY(!nameLength)) return 0;
 
-  LabelEntry* le = _namedLabels.get(LabelByName(name, nameLength, hVal));
+  // Local labels are hashed together with their parent, see `newNamedLabelId()`.
+  hVal ^= parentId;
+
+  LabelEntry* le = _namedLabels.get(LabelByName(name, nameLength, hVal, parentId));
   return le ? le->getId() : static_cast<uint32_t>(0);
 }
 
@@ -561,9 +840,6 @@ Error CodeHolder::newRelocEntry(RelocEntry** dst, uint32_t type, uint32_t size)
 // TODO: This should go to Runtime as it's responsible for relocating the
 //       code, CodeHolder should just hold it.
 size_t CodeHolder::relocate(void* _dst, uint64_t baseAddress) const noexcept {
-  SectionEntry* section = _sections[0];
-  ASMJIT_ASSERT(section != nullptr);
-
   uint8_t* dst = static_cast<uint8_t*>(_dst);
   if (baseAddress == Globals::kNoBaseAddress)
     baseAddress = static_cast<uint64_t>((uintptr_t)dst);
@@ -572,12 +848,30 @@ size_t CodeHolder::relocate(void* _dst, uint64_t baseAddress) const noexcept {
   Logger* logger = getLogger();
 #endif // ASMJIT_DISABLE_LOGGING
 
-  size_t minCodeSize = section->getBuffer().getLength(); // Minimum code size.
   size_t maxCodeSize = getCodeSize();                    // Includes all possible trampolines.
+  size_t minCodeSize = maxCodeSize - getTrampolinesSize(); // Minimum code size.
 
-  // We will copy the exact size of the generated code. Extra code for trampolines
+  // We will copy the exact size of the generated code, `getCodeSize()` has
+  // already calculated the offset of each section. Extra code for trampolines
   // is generated on-the-fly by the relocator (this code doesn't exist at the moment).
-  ::memcpy(dst, section->_buffer._data, minCodeSize);
+  //
+  // If `dst` is the buffer of the first section (see `setExternalBuffer()`)
+  // the section is already in place and only the rest is cleared and copied.
+  size_t numSections = _sections.getLength();
+  size_t inPlaceSize = 0;
+
+  if (numSections && _sections[0]->_buffer._data == dst && _sections[0]->getOffset() == 0)
+    inPlaceSize = std::min<size_t>(_sections[0]->getPhysicalSize(), minCodeSize);
+
+  ::memset(dst + inPlaceSize, 0, minCodeSize - inPlaceSize);
+
+  for (size_t i = inPlaceSize ? 1 : 0; i < numSections; i++) {
+    const SectionEntry* section = _sections[i];
+    size_t size = section->getPhysicalSize();
+
+    if (size)
+      ::memcpy(dst + static_cast<size_t>(section->getOffset()), section->_buffer._data, size);
+  }
 
   // Trampoline offset from the beginning of dst/baseAddress.
   size_t trampOffset = minCodeSize;
@@ -586,6 +880,9 @@ size_t CodeHolder::relocate(void* _dst, uint64_t baseAddress) const noexcept {
   size_t numRelocs = _relocations.getLength();
   const RelocEntry* const* reArray = _relocations.getData();
 
+  bool isX64 = getArchType() == ArchInfo::kTypeX64;
+  size_t relocCount = 0;
+
   for (size_t i = 0; i < numRelocs; i++) {
     const RelocEntry* re = reArray[i];
 
@@ -593,13 +890,24 @@ size_t CodeHolder::relocate(void* _dst, uint64_t baseAddress) const noexcept {
     if (re->getType() == RelocEntry::kTypeNone)
       continue;
 
+    // Offsets are relative to the start of the source and target sections.
+    uint32_t sourceId = re->getSourceSectionId();
+    uint32_t targetId = re->getTargetSectionId();
+
+    if (ASMJIT_UNLIKELY((sourceId != SectionEntry::kInvalidId && sourceId >= numSections) ||
+                        (targetId != SectionEntry::kInvalidId && targetId >= numSections)))
+      return 0;
+
+    uint64_t sourceBase = sourceId != SectionEntry::kInvalidId ? _sections[sourceId]->getOffset() : uint64_t(0);
+    uint64_t targetBase = targetId != SectionEntry::kInvalidId ? _sections[targetId]->getOffset() : uint64_t(0);
+
     uint64_t ptr = re->getData();
-    size_t codeOffset = static_cast<size_t>(re->getSourceOffset());
+    size_t codeOffset = static_cast<size_t>(sourceBase + re->getSourceOffset());
 
     // Make sure that the `RelocEntry` is correct, we don't want to write
     // out of bounds in `dst`.
     if (ASMJIT_UNLIKELY(codeOffset + re->getSize() > maxCodeSize))
-      return DebugUtils::errored(kErrorInvalidRelocEntry);
+      return 0;
 
     // Whether to use trampoline, can be only used if relocation type is `kRelocTrampoline`.
     bool useTrampoline = false;
@@ -610,29 +918,43 @@ size_t CodeHolder::relocate(void* _dst, uint64_t baseAddress) const noexcept {
       }
 
       case RelocEntry::kTypeRelToAbs: {
-        ptr += baseAddress;
+        ptr += baseAddress + targetBase;
         break;
       }
 
       case RelocEntry::kTypeAbsToRel: {
-        ptr -= baseAddress + re->getSourceOffset() + re->getSize();
+        ptr -= baseAddress + codeOffset + re->getSize();
+
+        // A 64-bit `[RIP + REL32]` can't reach the target if it's too far.
+        if (re->getSize() == 4 && isX64 && !Utils::isInt32(static_cast<int64_t>(ptr)))
+          return 0;
         break;
       }
 
       case RelocEntry::kTypeTrampoline: {
         if (re->getSize() != 4)
-          return DebugUtils::errored(kErrorInvalidRelocEntry);
+          return 0;
 
-        ptr -= baseAddress + re->getSourceOffset() + re->getSize();
+        ptr -= baseAddress + codeOffset + re->getSize();
         if (!Utils::isInt32(static_cast<int64_t>(ptr))) {
-          ptr = (uint64_t)trampOffset - re->getSourceOffset() - re->getSize();
+          ptr = (uint64_t)trampOffset - codeOffset - re->getSize();
           useTrampoline = true;
         }
         break;
       }
 
+      case RelocEntry::kTypeRelToRel: {
+        // The data already contains the displacement addend, the same as
+        // `LabelLink::rel` - the source is the displacement itself.
+        if (re->getSize() != 4)
+          return 0;
+
+        ptr += targetBase - codeOffset;
+        break;
+      }
+
       default:
-        return DebugUtils::errored(kErrorInvalidRelocEntry);
+        return 0;
     }
 
     switch (re->getSize()) {
@@ -649,9 +971,11 @@ size_t CodeHolder::relocate(void* _dst, uint64_t baseAddress) const noexcept {
         break;
 
       default:
-        return DebugUtils::errored(kErrorInvalidRelocEntry);
+        return 0;
     }
 
+    relocCount++;
+
     // Handle the trampoline case.
     if (useTrampoline) {
       // Bytes that replace [REX, OPCODE] bytes.
@@ -667,7 +991,7 @@ size_t CodeHolder::relocate(void* _dst, uint64_t baseAddress) const noexcept {
         byte1 = x86EncodeMod(0, 4, 5);
       }
       else {
-        return DebugUtils::errored(kErrorInvalidRelocEntry);
+        return 0;
       }
 
       // Patch `jmp/call` instruction.
@@ -680,16 +1004,529 @@ size_t CodeHolder::relocate(void* _dst, uint64_t baseAddress) const noexcept {
       trampOffset += 8;
 
 #if !defined(ASMJIT_DISABLE_LOGGING)
-      if (logger)
+      if (logger && logger->isEnabled(Logger::kCategoryReloc))
         logger->logf("[reloc] dq 0x%016llX ; Trampoline\n", re->getData());
 #endif // !ASMJIT_DISABLE_LOGGING
     }
   }
 
+  if (_statsEnabled) {
+    _stats.relocCount += relocCount;
+    _stats.trampolineCount += (trampOffset - minCodeSize) / 8;
+    _stats.relocatedSize += trampOffset;
+  }
+
   // If there are no trampolines this is the same as `minCodeSize`.
   return trampOffset;
 }
 
+// ============================================================================
+// [asmjit::CodeHolder - Serialization]
+// ============================================================================
+
+//! \internal
+//!
+//! Blob header, followed by `sectionCount` sections, `labelCount` labels,
+//! `relocCount` relocations, label names, and section data. Label names and
+//! section data are padded to 8 bytes.
+struct CodeBlobHeader {
+  enum { kVersion = 1 };
+
+  char magic[8];                         //!< Magic, "AsmJitB\0".
+  uint32_t version;                      //!< Version, see `kVersion`.
+  uint32_t archSignature;                //!< Architecture signature, see \ref ArchInfo.
+  uint32_t packedMiscInfo;               //!< Stack alignment and calling conventions, see \ref CodeInfo.
+  uint32_t trampolinesSize;              //!< Size reserved for trampolines.
+  uint64_t baseAddress;                  //!< Base address.
+  uint32_t sectionCount;                 //!< Number of sections.
+  uint32_t labelCount;                   //!< Number of labels.
+  uint32_t relocCount;                   //!< Number of relocations.
+  uint32_t reserved;                     //!< Reserved, always zero.
+};
+
+//! \internal
+//!
+//! Section stored in a blob, see \ref SectionEntry.
+struct CodeBlobSection {
+  uint32_t flags;                        //!< Section flags.
+  uint32_t alignment;                    //!< Section alignment.
+  uint32_t virtualSize;                  //!< Virtual size.
+  char name[36];                         //!< Section name.
+  uint64_t dataOffset;                   //!< Offset of the section data in the blob.
+  uint64_t dataSize;                     //!< Size of the section data.
+};
+
+//! \internal
+//!
+//! Label stored in a blob, see \ref LabelEntry.
+struct CodeBlobLabel {
+  uint8_t type;                          //!< Label type.
+  uint8_t reserved[3];                   //!< Reserved, always zero.
+  uint32_t parentId;                     //!< Label parent id or zero.
+  uint32_t sectionId;                    //!< Section id or `SectionEntry::kInvalidId`.
+  uint32_t nameLength;                   //!< Length of the name, zero if the label has no name.
+  int64_t offset;                        //!< Label offset.
+  uint64_t nameOffset;                   //!< Offset of the null terminated name in the blob.
+};
+
+//! \internal
+//!
+//! Relocation stored in a blob, see \ref RelocEntry.
+struct CodeBlobReloc {
+  uint8_t type;                          //!< Type of the relocation.
+  uint8_t size;                          //!< Size of the relocation.
+  uint8_t reserved[2];                   //!< Reserved, always zero.
+  uint32_t sourceSectionId;              //!< Source section id.
+  uint32_t targetSectionId;              //!< Target section id.
+  uint32_t reserved2;                    //!< Reserved, always zero.
+  uint64_t sourceOffset;                 //!< Source offset.
+  uint64_t data;                         //!< Relocation data.
+};
+
+static const char CodeBlob_magic[8] = { 'A', 's', 'm', 'J', 'i', 't', 'B', '\0' };
+
+//! \internal
+//!
+//! Get the offset of label names, which follow all fixed-size records.
+static ASMJIT_INLINE size_t CodeBlob_getNamesOffset(size_t sectionCount, size_t labelCount, size_t relocCount) noexcept {
+  return sizeof(CodeBlobHeader) +
+         sectionCount * sizeof(CodeBlobSection) +
+         labelCount   * sizeof(CodeBlobLabel) +
+         relocCount   * sizeof(CodeBlobReloc);
+}
+
+static ASMJIT_INLINE bool CodeBlob_isSectionIdValid(uint32_t id, uint32_t sectionCount) noexcept {
+  return id < sectionCount || id == SectionEntry::kInvalidId;
+}
+
+size_t CodeHolder::getBlobSize() const noexcept {
+  // Reflect all changes first.
+  const_cast<CodeHolder*>(this)->sync();
+
+  size_t size = CodeBlob_getNamesOffset(_sections.getLength(), _labels.getLength(), _relocations.getLength());
+  size_t namesSize = 0;
+
+  for (size_t i = 0, count = _labels.getLength(); i < count; i++) {
+    const LabelEntry* le = _labels[i];
+    if (le->hasName())
+      namesSize += le->getNameLength() + 1;
+  }
+  size += Utils::alignTo<size_t>(namesSize, 8);
+
+  for (size_t i = 0, count = _sections.getLength(); i < count; i++)
+    size += Utils::alignTo<size_t>(_sections[i]->getBuffer().getLength(), 8);
+
+  return size;
+}
+
+Error CodeHolder::saveBlob(void* dst, size_t size) const noexcept {
+  if (ASMJIT_UNLIKELY(!isInitialized()))
+    return DebugUtils::errored(kErrorNotInitialized);
+
+  // Label links can't be resolved after the code was loaded.
+  if (ASMJIT_UNLIKELY(_unresolvedLabelsCount != 0))
+    return DebugUtils::errored(kErrorInvalidState);
+
+  size_t blobSize = getBlobSize();
+  if (ASMJIT_UNLIKELY(size < blobSize))
+    return DebugUtils::errored(kErrorInvalidArgument);
+
+  uint8_t* blob = static_cast<uint8_t*>(dst);
+  ::memset(blob, 0, blobSize);
+
+  size_t sectionCount = _sections.getLength();
+  size_t labelCount = _labels.getLength();
+  size_t relocCount = _relocations.getLength();
+
+  CodeBlobHeader* header = reinterpret_cast<CodeBlobHeader*>(blob);
+  ::memcpy(header->magic, CodeBlob_magic, sizeof(CodeBlob_magic));
+  header->version = CodeBlobHeader::kVersion;
+  header->archSignature = _codeInfo.getArchInfo().getSignature();
+  header->packedMiscInfo = _codeInfo._packedMiscInfo;
+  header->trampolinesSize = _trampolinesSize;
+  header->baseAddress = _codeInfo.getBaseAddress();
+  header->sectionCount = static_cast<uint32_t>(sectionCount);
+  header->labelCount = static_cast<uint32_t>(labelCount);
+  header->relocCount = static_cast<uint32_t>(relocCount);
+
+  CodeBlobSection* sections = reinterpret_cast<CodeBlobSection*>(header + 1);
+  CodeBlobLabel* labels = reinterpret_cast<CodeBlobLabel*>(sections + sectionCount);
+  CodeBlobReloc* relocs = reinterpret_cast<CodeBlobReloc*>(labels + labelCount);
+
+  size_t offset = CodeBlob_getNamesOffset(sectionCount, labelCount, relocCount);
+  for (size_t i = 0; i < labelCount; i++) {
+    const LabelEntry* le = _labels[i];
+    CodeBlobLabel& dl = labels[i];
+
+    dl.type = le->_type;
+    dl.parentId = le->_parentId;
+    dl.sectionId = le->_sectionId;
+    dl.offset = static_cast<int64_t>(le->_offset);
+
+    if (le->hasName()) {
+      size_t nameLength = le->getNameLength();
+      ::memcpy(blob + offset, le->getName(), nameLength);
+
+      dl.nameLength = static_cast<uint32_t>(nameLength);
+      dl.nameOffset = offset;
+      offset += nameLength + 1;
+    }
+  }
+  offset = Utils::alignTo<size_t>(offset, 8);
+
+  for (size_t i = 0; i < sectionCount; i++) {
+    const SectionEntry* se = _sections[i];
+    CodeBlobSection& ds = sections[i];
+
+    size_t length = se->getBuffer().getLength();
+    ds.flags = se->_flags;
+    ds.alignment = se->_alignment;
+    ds.virtualSize = se->_virtualSize;
+    ::memcpy(ds.name, se->_name, sizeof(ds.name));
+    ds.dataOffset = offset;
+    ds.dataSize = length;
+
+    if (length)
+      ::memcpy(blob + offset, se->getBuffer().getData(), length);
+    offset += Utils::alignTo<size_t>(length, 8);
+  }
+
+  for (size_t i = 0; i < relocCount; i++) {
+    const RelocEntry* re = _relocations[i];
+    CodeBlobReloc& dr = relocs[i];
+
+    dr.type = re->_type;
+    dr.size = re->_size;
+    dr.sourceSectionId = re->_sourceSectionId;
+    dr.targetSectionId = re->_targetSectionId;
+    dr.sourceOffset = re->_sourceOffset;
+    dr.data = re->_data;
+  }
+
+  ASMJIT_ASSERT(offset == blobSize);
+  return kErrorOk;
+}
+
+static Error CodeHolder_loadBlobInternal(CodeHolder* self, const uint8_t* blob, size_t size) noexcept {
+  const CodeBlobHeader* header = reinterpret_cast<const CodeBlobHeader*>(blob);
+  size_t sectionCount = header->sectionCount;
+  size_t labelCount = header->labelCount;
+  size_t relocCount = header->relocCount;
+
+  // Counts are 32-bit, so the offset can't overflow.
+  size_t namesOffset = CodeBlob_getNamesOffset(sectionCount, labelCount, relocCount);
+  if (ASMJIT_UNLIKELY(sectionCount == 0 || namesOffset > size))
+    return DebugUtils::errored(kErrorInvalidArgument);
+
+  const CodeBlobSection* sections = reinterpret_cast<const CodeBlobSection*>(header + 1);
+  const CodeBlobLabel* labels = reinterpret_cast<const CodeBlobLabel*>(sections + sectionCount);
+  const CodeBlobReloc* relocs = reinterpret_cast<const CodeBlobReloc*>(labels + labelCount);
+
+  ZoneHeap* heap = &self->_baseHeap;
+  ASMJIT_PROPAGATE(self->_sections.willGrow(heap, sectionCount));
+  ASMJIT_PROPAGATE(self->_labels.willGrow(heap, labelCount));
+  ASMJIT_PROPAGATE(self->_relocations.willGrow(heap, relocCount));
+  ASMJIT_PROPAGATE(self->_namedLabels.reserve(labelCount));
+
+  for (size_t i = 0; i < sectionCount; i++) {
+    const CodeBlobSection& ss = sections[i];
+    if (ASMJIT_UNLIKELY(ss.dataOffset < namesOffset || ss.dataOffset > size || ss.dataSize > size - ss.dataOffset))
+      return DebugUtils::errored(kErrorInvalidArgument);
+
+    SectionEntry* se = self->_baseZone.allocZeroedT<SectionEntry>();
+    if (ASMJIT_UNLIKELY(!se))
+      return DebugUtils::errored(kErrorNoHeapMemory);
+
+    se->_id = static_cast<uint32_t>(i);
+    se->_flags = ss.flags;
+    se->_alignment = ss.alignment;
+    se->_virtualSize = ss.virtualSize;
+    ::memcpy(se->_name, ss.name, sizeof(se->_name));
+    se->_name[sizeof(se->_name) - 1] = '\0';
+
+    // The buffer is never written as it's fixed-size and already full.
+    CodeBuffer& buffer = se->_buffer;
+    buffer._data = const_cast<uint8_t*>(blob + static_cast<size_t>(ss.dataOffset));
+    buffer._length = static_cast<size_t>(ss.dataSize);
+    buffer._capacity = buffer._length;
+    buffer._isExternal = true;
+    buffer._isFixedSize = true;
+
+    self->_sections.appendUnsafe(se);
+  }
+
+  for (size_t i = 0; i < labelCount; i++) {
+    const CodeBlobLabel& sl = labels[i];
+    if (ASMJIT_UNLIKELY(!CodeBlob_isSectionIdValid(sl.sectionId, header->sectionCount)))
+      return DebugUtils::errored(kErrorInvalidArgument);
+
+    LabelEntry* le = heap->allocZeroedT<LabelEntry>();
+    if (ASMJIT_UNLIKELY(!le))
+      return DebugUtils::errored(kErrorNoHeapMemory);
+
+    le->_setId(Operand::packId(static_cast<uint32_t>(i)));
+    le->_type = sl.type;
+    le->_parentId = sl.parentId;
+    le->_sectionId = sl.sectionId;
+    le->_offset = static_cast<intptr_t>(sl.offset);
+    self->_labels.appendUnsafe(le);
+
+    size_t nameLength = sl.nameLength;
+    if (!nameLength)
+      continue;
+
+    if (ASMJIT_UNLIKELY(sl.nameOffset < namesOffset || sl.nameOffset >= size || nameLength > Globals::kMaxLabelLength ||
+                        nameLength >= size - sl.nameOffset))
+      return DebugUtils::errored(kErrorInvalidArgument);
+
+    const char* name = reinterpret_cast<const char*>(blob + static_cast<size_t>(sl.nameOffset));
+    if (ASMJIT_UNLIKELY(name[nameLength] != '\0' || ::memchr(name, 0, nameLength) != nullptr))
+      return DebugUtils::errored(kErrorInvalidArgument);
+
+    uint32_t hVal = CodeHolder_hashNameAndFixLen(name, nameLength);
+
+    if (le->_type == Label::kTypeLocal)
+      hVal ^= le->_parentId;
+    le->_hVal = hVal;
+
+    // Names that don't fit into `LabelEntry` are not copied.
+    if (le->_name.mustEmbed(nameLength))
+      le->_name.setEmbedded(name, nameLength);
+    else
+      le->_name.setExternal(name, nameLength);
+
+    if (le->_type != Label::kTypeAnonymous && ASMJIT_UNLIKELY(!self->_namedLabels.put(le)))
+      return DebugUtils::errored(kErrorNoHeapMemory);
+  }
+
+  for (size_t i = 0; i < relocCount; i++) {
+    const CodeBlobReloc& sr = relocs[i];
+    if (ASMJIT_UNLIKELY(!CodeBlob_isSectionIdValid(sr.sourceSectionId, header->sectionCount) ||
+                        !CodeBlob_isSectionIdValid(sr.targetSectionId, header->sectionCount)))
+      return DebugUtils::errored(kErrorInvalidArgument);
+
+    RelocEntry* re = heap->allocZeroedT<RelocEntry>();
+    if (ASMJIT_UNLIKELY(!re))
+      return DebugUtils::errored(kErrorNoHeapMemory);
+
+    re->_id = static_cast<uint32_t>(i);
+    re->_type = sr.type;
+    re->_size = sr.size;
+    re->_sourceSectionId = sr.sourceSectionId;
+    re->_targetSectionId = sr.targetSectionId;
+    re->_sourceOffset = sr.sourceOffset;
+    re->_data = sr.data;
+    self->_relocations.appendUnsafe(re);
+  }
+
+  self->_trampolinesSize = header->trampolinesSize;
+  return kErrorOk;
+}
+
+Error CodeHolder::loadBlob(const void* data, size_t size) noexcept {
+  if (isInitialized())
+    return DebugUtils::errored(kErrorAlreadyInitialized);
+
+  const uint8_t* blob = static_cast<const uint8_t*>(data);
+  const CodeBlobHeader* header = reinterpret_cast<const CodeBlobHeader*>(blob);
+
+  if (ASMJIT_UNLIKELY(!Utils::isAligned<uintptr_t>((uintptr_t)blob, 8) ||
+                      size < sizeof(CodeBlobHeader) ||
+                      ::memcmp(header->magic, CodeBlob_magic, sizeof(CodeBlob_magic)) != 0 ||
+                      header->version != CodeBlobHeader::kVersion))
+    return DebugUtils::errored(kErrorInvalidArgument);
+
+  ArchInfo archInfo;
+  archInfo._signature = header->archSignature;
+  if (ASMJIT_UNLIKELY(archInfo.getType() == ArchInfo::kTypeNone))
+    return DebugUtils::errored(kErrorInvalidArgument);
+
+  Error err = CodeHolder_loadBlobInternal(this, blob, size);
+  if (ASMJIT_UNLIKELY(err)) {
+    CodeHolder_resetInternal(this, false);
+    return err;
+  }
+
+  _codeInfo._archInfo = archInfo;
+  _codeInfo._packedMiscInfo = header->packedMiscInfo;
+  _codeInfo._baseAddress = header->baseAddress;
+  return kErrorOk;
+}
+
+// ============================================================================
+// [asmjit::CodeHolder - Test]
+// ============================================================================
+
+#if defined(ASMJIT_TEST) && defined(ASMJIT_BUILD_X86) && (ASMJIT_ARCH_X86 || ASMJIT_ARCH_X64)
+// Alternates short (embedded) and long (external) label names.
+static void CodeHolder_formatTestName(char* buf, size_t size, uint32_t i) noexcept {
+  if (i & 1)
+    snprintf(buf, size, "sym_%u", i);
+  else
+    snprintf(buf, size, "a_very_long_symbol_name_that_is_not_embedded_%u", i);
+}
+
+UNIT(base_codeholder_named_labels) {
+  CodeHolder code;
+  code.init(CodeInfo(ArchInfo::kTypeHost));
+
+  uint32_t i;
+  uint32_t kCount = 20000;
+  char name[64];
+
+  EXPECT(code.reserve(kCount * 2, 0, kCount * 2) == kErrorOk);
+  size_t labelCapacity = code.getLabelEntries().getCapacity();
+  EXPECT(labelCapacity >= kCount * 2);
+
+  INFO("Creating %u global and %u local labels", kCount, kCount);
+  uint32_t parentId = 0;
+  for (i = 0; i < kCount; i++) {
+    uint32_t id;
+    CodeHolder_formatTestName(name, ASMJIT_ARRAY_SIZE(name), i);
+    EXPECT(code.newNamedLabelId(id, name, Globals::kInvalidIndex, Label::kTypeGlobal, 0) == kErrorOk,
+      "Failed to create label '%s'", name);
+    if (i == 0) parentId = id;
+    EXPECT(code.newNamedLabelId(id, name, Globals::kInvalidIndex, Label::kTypeLocal, parentId) == kErrorOk,
+      "Failed to create local label '%s'", name);
+  }
+
+  EXPECT(code.getLabelEntries().getCapacity() == labelCapacity,
+    "Labels array grew although it was reserved");
+
+  INFO("Looking up all labels by name");
+  for (i = 0; i < kCount; i++) {
+    CodeHolder_formatTestName(name, ASMJIT_ARRAY_SIZE(name), i);
+
+    uint32_t globalId = code.getLabelIdByName(name);
+    uint32_t localId = code.getLabelIdByName(name, Globals::kInvalidIndex, parentId);
+
+    EXPECT(globalId != 0 && localId != 0 && globalId != localId,
+      "Label '%s' not found", name);
+    EXPECT(code.getLabelEntry(globalId)->getType() == Label::kTypeGlobal);
+    EXPECT(code.getLabelEntry(localId)->getParentId() == parentId);
+  }
+
+  uint32_t id;
+  EXPECT(code.getLabelIdByName("sym_") == 0);
+  EXPECT(code.newNamedLabelId(id, "sym_1", Globals::kInvalidIndex, Label::kTypeGlobal, 0) == kErrorLabelAlreadyDefined);
+}
+
+UNIT(base_codeholder_external_buffer) {
+  JitRuntime rt;
+  CodeHolder code;
+  code.init(rt.getCodeInfo());
+
+  uint8_t storage[32];
+  CodeBuffer& buffer = code.getSectionEntry(0)->_buffer;
+
+  INFO("Emitting to an external buffer");
+  EXPECT(code.setExternalBuffer(&buffer, storage, sizeof(storage)) == kErrorOk);
+  EXPECT(buffer.getData() == storage && buffer.isExternal() && !buffer.isFixedSize());
+  EXPECT(code.reserveBuffer(&buffer, sizeof(storage)) == kErrorOk);
+
+  for (uint32_t i = 0; i < sizeof(storage); i++)
+    storage[i] = static_cast<uint8_t>(i);
+  buffer._length = sizeof(storage);
+  EXPECT(code.setExternalBuffer(&buffer, nullptr, 0) == kErrorInvalidState);
+
+  INFO("Relocating the external buffer in place");
+  EXPECT(code.relocate(storage) == sizeof(storage));
+  for (uint32_t i = 0; i < sizeof(storage); i++)
+    EXPECT(storage[i] == i, "Byte %u changed by relocate()", unsigned(i));
+
+  INFO("Copying the content when the external buffer grows");
+  EXPECT(code.growBuffer(&buffer, 1) == kErrorOk);
+  EXPECT(buffer.getData() != storage && !buffer.isExternal());
+  EXPECT(buffer.getLength() == sizeof(storage));
+  EXPECT(::memcmp(buffer.getData(), storage, sizeof(storage)) == 0);
+
+  INFO("Rejecting growth of a fixed-size external buffer");
+  buffer._length = 0;
+  EXPECT(code.setExternalBuffer(&buffer, storage, sizeof(storage), true) == kErrorOk);
+  buffer._length = sizeof(storage);
+  EXPECT(code.growBuffer(&buffer, 1) == kErrorCodeTooLarge);
+
+  buffer._length = 0;
+  EXPECT(code.setExternalBuffer(&buffer, nullptr, 0) == kErrorOk);
+  EXPECT(!buffer.hasData() && !buffer.isExternal() && !buffer.isFixedSize());
+}
+
+UNIT(base_codeholder_blob) {
+  typedef int (*Func)(void);
+  static const char longName[] = "label_with_a_name_longer_than_embedded";
+
+  JitRuntime rt;
+  CodeHolder code;
+
+  // mov eax, 42; ret; int3; int3; dp <address of the function>
+  uint32_t gpSize = rt.getCodeInfo().getArchInfo().getGpSize();
+  uint64_t zero = 0;
+
+  JitTest_initReturn(&code, rt, 42, 8);
+  X86Assembler(&code).embed(&zero, gpSize);
+
+  CodeBuffer& buffer = code.getSectionEntry(0)->_buffer;
+
+  uint32_t entryId, dataId;
+  EXPECT(code.newNamedLabelId(entryId, "entry", Globals::kInvalidIndex, Label::kTypeGlobal, 0) == kErrorOk &&
+         code.newNamedLabelId(dataId, longName, Globals::kInvalidIndex, Label::kTypeGlobal, 0) == kErrorOk,
+    "Failed to create labels");
+  code.getLabelEntry(entryId)->_sectionId = 0;
+  code.getLabelEntry(dataId)->_sectionId = 0;
+  code.getLabelEntry(dataId)->_offset = 8;
+
+  RelocEntry* re;
+  EXPECT(code.newRelocEntry(&re, RelocEntry::kTypeRelToAbs, gpSize) == kErrorOk,
+    "Failed to create a relocation");
+  re->_sourceSectionId = 0;
+  re->_targetSectionId = 0;
+  re->_sourceOffset = 8;
+  re->_data = 0;
+
+  INFO("Saving CodeHolder to a blob");
+  size_t blobSize = code.getBlobSize();
+  uint64_t blob[64];
+  EXPECT(blobSize <= sizeof(blob),
+    "Blob is too large (%u bytes)", static_cast<unsigned int>(blobSize));
+  EXPECT(code.saveBlob(blob, blobSize) == kErrorOk,
+    "Failed to save a blob");
+
+  INFO("Loading CodeHolder from a blob");
+  CodeHolder loaded;
+  EXPECT(loaded.loadBlob(blob, blobSize) == kErrorOk,
+    "Failed to load a blob");
+  EXPECT(loaded.getCodeInfo() == code.getCodeInfo(),
+    "Loaded code information doesn't match");
+  EXPECT(loaded.getSectionEntry(0)->getBuffer().getData() != buffer._data &&
+         loaded.getCodeSize() == code.getCodeSize(),
+    "Loaded section doesn't match");
+  EXPECT(loaded.getLabelIdByName("entry") == entryId &&
+         loaded.getLabelIdByName(longName) == dataId &&
+         loaded.getLabelOffset(dataId) == 8,
+    "Loaded labels don't match");
+  EXPECT(loaded.getRelocEntries().getLength() == 1,
+    "Loaded relocations don't match");
+
+  Func fn;
+  EXPECT(rt.add(&fn, &loaded) == kErrorOk,
+    "Failed to add the loaded code to the runtime");
+  EXPECT(fn() == 42,
+    "Function loaded from a blob returned a wrong value");
+
+  const uint8_t* p = reinterpret_cast<const uint8_t*>(fn) + 8;
+  uint64_t address = gpSize == 8 ? Utils::readU64u(p) : static_cast<uint64_t>(Utils::readU32u(p));
+  EXPECT(address == static_cast<uint64_t>((uintptr_t)fn),
+    "Relocation of the loaded code wasn't applied");
+  rt.release(fn);
+
+  INFO("Rejecting a corrupted blob");
+  loaded.reset();
+  reinterpret_cast<uint8_t*>(blob)[0] ^= 0xFF;
+  EXPECT(loaded.loadBlob(blob, blobSize) != kErrorOk && !loaded.isInitialized(),
+    "A corrupted blob shouldn't be loaded");
+}
+#endif // ASMJIT_TEST && ASMJIT_BUILD_X86 && (ASMJIT_ARCH_X86 || ASMJIT_ARCH_X64)
+
 } // asmjit namespace
 
 // [Api-End]
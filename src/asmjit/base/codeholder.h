@@ -10,10 +10,12 @@
 
 // [Dependencies]
 #include "../base/arch.h"
+#include "../base/cpuinfo.h"
 #include "../base/func.h"
 #include "../base/logging.h"
 #include "../base/operand.h"
 #include "../base/simdtypes.h"
+#include "../base/tracing.h"
 #include "../base/utils.h"
 #include "../base/zone.h"
 
@@ -100,7 +102,8 @@ public:
 // ============================================================================
 
 //! Basic information about a code (or target). It describes its architecture,
-//! code generation mode (or optimization level), and base address.
+//! code generation mode (or optimization level), base address, and optionally
+//! CPU features the code is allowed to use.
 class CodeInfo {
 public:
   // --------------------------------------------------------------------------
@@ -113,13 +116,15 @@ public:
       _cdeclCallConv(CallConv::kIdNone),
       _stdCallConv(CallConv::kIdNone),
       _fastCallConv(CallConv::kIdNone),
-      _baseAddress(Globals::kNoBaseAddress) {}
+      _baseAddress(Globals::kNoBaseAddress),
+      _features() {}
   ASMJIT_INLINE CodeInfo(const CodeInfo& other) noexcept { init(other); }
 
   explicit ASMJIT_INLINE CodeInfo(uint32_t archType, uint32_t archMode = 0, uint64_t baseAddress = Globals::kNoBaseAddress) noexcept
     : _archInfo(archType, archMode),
       _packedMiscInfo(0),
-      _baseAddress(baseAddress) {}
+      _baseAddress(baseAddress),
+      _features() {}
 
   // --------------------------------------------------------------------------
   // [Init / Reset]
@@ -133,12 +138,14 @@ public:
     _archInfo = other._archInfo;
     _packedMiscInfo = other._packedMiscInfo;
     _baseAddress = other._baseAddress;
+    _features = other._features;
   }
 
   ASMJIT_INLINE void init(uint32_t archType, uint32_t archMode = 0, uint64_t baseAddress = Globals::kNoBaseAddress) noexcept {
     _archInfo.init(archType, archMode);
     _packedMiscInfo = 0;
     _baseAddress = baseAddress;
+    _features.reset();
   }
 
   ASMJIT_INLINE void reset() noexcept {
@@ -148,6 +155,7 @@ public:
     _stdCallConv = CallConv::kIdNone;
     _fastCallConv = CallConv::kIdNone;
     _baseAddress = Globals::kNoBaseAddress;
+    _features.reset();
   }
 
   // --------------------------------------------------------------------------
@@ -193,6 +201,21 @@ public:
   ASMJIT_INLINE void setBaseAddress(uint64_t p) noexcept { _baseAddress = p; }
   ASMJIT_INLINE void resetBaseAddress() noexcept { _baseAddress = Globals::kNoBaseAddress; }
 
+  // --------------------------------------------------------------------------
+  // [Target Features]
+  // --------------------------------------------------------------------------
+
+  //! Get if the code targets a specific CPU model, in that case instructions
+  //! that require features not in \ref getFeatures() are rejected by emitters
+  //! that use `CodeEmitter::kOptionStrictValidation`.
+  ASMJIT_INLINE bool hasFeatures() const noexcept { return !_features.isEmpty(); }
+  //! Get CPU features the code is allowed to use (empty if not restricted).
+  ASMJIT_INLINE const CpuFeatures& getFeatures() const noexcept { return _features; }
+  //! Set CPU features the code is allowed to use.
+  ASMJIT_INLINE void setFeatures(const CpuFeatures& features) noexcept { _features = features; }
+  //! Reset CPU features, the code is not restricted to any CPU model.
+  ASMJIT_INLINE void resetFeatures() noexcept { _features.reset(); }
+
   // --------------------------------------------------------------------------
   // [Operator Overload]
   // --------------------------------------------------------------------------
@@ -218,6 +241,7 @@ public:
   };
 
   uint64_t _baseAddress;                 //!< Base address.
+  CpuFeatures _features;                 //!< Target CPU features (empty if not restricted).
 };
 
 // ============================================================================
@@ -256,18 +280,30 @@ struct CodeBuffer {
 // ============================================================================
 
 //! Section entry.
+//!
+//! The default section is `.text`, which always has id 0. Other sections are
+//! created by `CodeHolder::newSection()`, the usual ones are `.text.cold` for
+//! code that is rarely executed (error and slow paths) and `.rodata` for
+//! constants. All sections are copied into a single block by
+//! `CodeHolder::relocate()`, each aligned to its alignment, sections having
+//! `kFlagCold` are placed after all other sections.
 class SectionEntry {
 public:
   ASMJIT_ENUM(Id) {
     kInvalidId       = 0xFFFFFFFFU       //!< Invalid section id.
   };
 
+  ASMJIT_ENUM(Limits) {
+    kMaxNameLength   = 35                //!< Maximum length of a section name.
+  };
+
   //! Section flags.
   ASMJIT_ENUM(Flags) {
     kFlagExec        = 0x00000001U,      //!< Executable (.text sections).
     kFlagConst       = 0x00000002U,      //!< Read-only (.text and .data sections).
     kFlagZero        = 0x00000004U,      //!< Zero initialized by the loader (BSS).
     kFlagInfo        = 0x00000008U,      //!< Info / comment flag.
+    kFlagCold        = 0x00000010U,      //!< Cold code or data, placed after all other sections.
     kFlagImplicit    = 0x80000000U       //!< Section created implicitly (can be deleted by the Runtime).
   };
 
@@ -293,6 +329,12 @@ public:
   ASMJIT_INLINE uint32_t getAlignment() const noexcept { return _alignment; }
   ASMJIT_INLINE void setAlignment(uint32_t alignment) noexcept { _alignment = alignment; }
 
+  //! Get the offset of the section in the relocated code.
+  //!
+  //! The offset is calculated by `CodeHolder::layoutSections()`, which is
+  //! called by `CodeHolder::getCodeSize()` and `CodeHolder::relocate()`.
+  ASMJIT_INLINE uint64_t getOffset() const noexcept { return _offset; }
+
   ASMJIT_INLINE size_t getPhysicalSize() const noexcept { return _buffer.getLength(); }
 
   ASMJIT_INLINE size_t getVirtualSize() const noexcept { return _virtualSize; }
@@ -313,6 +355,7 @@ public:
     char _name[36];                      //!< Section name (max 35 characters, PE allows max 8).
     uint32_t _nameAsU32[36 / 4];         //!< Section name as `uint32_t[]` (only optimization).
   };
+  uint64_t _offset;                      //!< Offset of the section in the relocated code.
   CodeBuffer _buffer;                    //!< Code or data buffer.
 };
 
@@ -321,8 +364,10 @@ public:
 // ============================================================================
 
 //! Data structure used to link labels.
+//!
+//! Links of a label are stored in a contiguous array owned by its \ref
+//! LabelEntry, see \ref CodeHolder::newLabelLink().
 struct LabelLink {
-  LabelLink* prev;                       //!< Previous link (single-linked list).
   uint32_t sectionId;                    //!< Section id.
   uint32_t relocId;                      //!< Relocation id or RelocEntry::kInvalidId.
   size_t offset;                         //!< Label offset relative to the start of the section.
@@ -343,9 +388,9 @@ struct LabelLink {
 //!       local label that falls under a global label. This allows to define
 //!       many labels of the same name that have different parent (global) label.
 //!   * Offset - offset of the label bound by `Assembler`.
-//!   * Links - single-linked list that contains locations of code that has
-//!       to be patched when the label gets bound. Every use of unbound label
-//!       adds one link to `_links` list.
+//!   * Links - array that contains locations of code that has to be patched
+//!       when the label gets bound. Every use of unbound label appends one
+//!       link to the `_links` array.
 //!   * HVal - Hash value of label's name and optionally parentId.
 //!   * HashNext - Hash-table implementation detail.
 class LabelEntry : public ZoneHashNode {
@@ -392,6 +437,23 @@ public:
   //! Get the label offset (only useful if the label is bound).
   ASMJIT_INLINE intptr_t getOffset() const noexcept { return _offset; }
 
+  //! Get if the label has links (uses that wait for the label to be bound).
+  ASMJIT_INLINE bool hasLinks() const noexcept { return _linkCount != 0; }
+  //! Get the number of label links.
+  ASMJIT_INLINE uint32_t getLinkCount() const noexcept { return _linkCount; }
+  //! Get the label links.
+  ASMJIT_INLINE LabelLink* getLinks() const noexcept { return _links; }
+
+  //! \internal
+  //!
+  //! Get the capacity of the `_links` array holding `count` links. The array
+  //! grows by doubling, so the capacity is implied by the count and doesn't
+  //! have to be stored.
+  static ASMJIT_INLINE uint32_t _getLinkCapacity(uint32_t count) noexcept {
+    return count <= kMinLinkCapacity ? (count ? uint32_t(kMinLinkCapacity) : uint32_t(0))
+                                     : Utils::alignToPowerOf2(count);
+  }
+
   //! Get the hash-value of label's name and its parent label (if any).
   //!
   //! Label hash is calculated as `HASH(Name) ^ ParentId`. The hash function
@@ -407,14 +469,18 @@ public:
   // is roughly 16 bytes on 64-bit and 28 bytes on 32-bit architectures.
   enum { kNameBytes = 64 - (sizeof(ZoneHashNode) + 16 + sizeof(intptr_t) + sizeof(LabelLink*)) };
 
+  //! Capacity of the first `_links` array (fits a 96-byte \ref ZoneHeap slot
+  //! on 64-bit targets).
+  enum { kMinLinkCapacity = 4 };
+
   uint8_t _type;                         //!< Label type, see Label::Type.
   uint8_t _flags;                        //!< Must be zero.
   uint16_t _reserved16;                  //!< Reserved.
   uint32_t _parentId;                    //!< Label parent id or zero.
   uint32_t _sectionId;                   //!< Section id or `SectionEntry::kInvalidId`.
-  uint32_t _reserved32;                  //!< Reserved.
+  uint32_t _linkCount;                   //!< Count of label links.
   intptr_t _offset;                      //!< Label offset.
-  LabelLink* _links;                     //!< Label links.
+  LabelLink* _links;                     //!< Label links (array of `_linkCount` links).
   SmallString<kNameBytes> _name;         //!< Label name.
 };
 
@@ -434,7 +500,8 @@ struct RelocEntry {
     kTypeAbsToAbs    = 1,                //!< Relocate absolute to absolute.
     kTypeRelToAbs    = 2,                //!< Relocate relative to absolute.
     kTypeAbsToRel    = 3,                //!< Relocate absolute to relative.
-    kTypeTrampoline  = 4                 //!< Relocate absolute to relative or use trampoline.
+    kTypeTrampoline  = 4,                //!< Relocate absolute to relative or use trampoline.
+    kTypeRelToRel    = 5                 //!< Relocate relative to relative (between sections).
   };
 
   // ------------------------------------------------------------------------
@@ -466,6 +533,103 @@ struct RelocEntry {
   uint64_t _data;                        //!< Relocation data (target offset, target address, etc).
 };
 
+// ============================================================================
+// [asmjit::CodeStats]
+// ============================================================================
+
+//! Code-size and instruction-mix statistics.
+//!
+//! Collected by \ref CodeHolder if enabled by `CodeHolder::setStatsEnabled()`
+//! (instructions and alignment are counted by the attached \ref Assembler,
+//! relocations and trampolines by `CodeHolder::relocate()`) and aggregated by
+//! \ref JitRuntime when the code is added.
+struct CodeStats {
+  // --------------------------------------------------------------------------
+  // [Reset]
+  // --------------------------------------------------------------------------
+
+  //! Reset all counters.
+  ASMJIT_INLINE void reset() noexcept { ::memset(this, 0, sizeof(*this)); }
+
+  // --------------------------------------------------------------------------
+  // [Add]
+  // --------------------------------------------------------------------------
+
+  //! Add all counters of `other` to this one.
+  ASMJIT_INLINE void add(const CodeStats& other) noexcept {
+    moduleCount     += other.moduleCount;
+    instCount       += other.instCount;
+    instSize        += other.instSize;
+    prefixCount     += other.prefixCount;
+    rexCount        += other.rexCount;
+    vexCount        += other.vexCount;
+    evexCount       += other.evexCount;
+    rel8Count       += other.rel8Count;
+    rel32Count      += other.rel32Count;
+    alignSize       += other.alignSize;
+    relocCount      += other.relocCount;
+    trampolineCount += other.trampolineCount;
+    relocatedSize   += other.relocatedSize;
+  }
+
+  // --------------------------------------------------------------------------
+  // [Members]
+  // --------------------------------------------------------------------------
+
+  uint64_t moduleCount;                  //!< Count of modules (added by \ref JitRuntime).
+  uint64_t instCount;                    //!< Count of emitted instructions.
+  uint64_t instSize;                     //!< Size of emitted instructions in bytes.
+  uint64_t prefixCount;                  //!< Count of legacy prefixes (66, 67, F0, F2, F3, and segments).
+  uint64_t rexCount;                     //!< Count of instructions that use REX prefix.
+  uint64_t vexCount;                     //!< Count of instructions that use VEX (or XOP) prefix.
+  uint64_t evexCount;                    //!< Count of instructions that use EVEX prefix.
+  uint64_t rel8Count;                    //!< Count of jumps and calls with 8-bit displacement.
+  uint64_t rel32Count;                   //!< Count of jumps and calls with 32-bit displacement.
+  uint64_t alignSize;                    //!< Size of code alignment padding in bytes.
+  uint64_t relocCount;                   //!< Count of applied relocations.
+  uint64_t trampolineCount;              //!< Count of trampolines used by the relocator.
+  uint64_t relocatedSize;                //!< Size of the relocated code (including trampolines).
+};
+
+// ============================================================================
+// [asmjit::UnwindOp]
+// ============================================================================
+
+//! Stack frame operation recorded by `FuncUtils::emitProlog()` and
+//! `FuncUtils::emitEpilog()` if enabled by `CodeHolder::setUnwindEnabled()`.
+//!
+//! Each operation has a label bound right after the instruction that changed
+//! the frame (or at the first instruction for `kTypeFuncBegin` and
+//! `kTypeEpilogBegin`), so its offset is known once the code is emitted. A
+//! prolog is a sequence from `kTypeFuncBegin` to `kTypePrologEnd`, an epilog
+//! is a sequence from `kTypeEpilogBegin` to `kTypeEpilogEnd`, sequences are
+//! not necessarily recorded in the order of their offsets. \ref JitRuntime
+//! turns them into unwind information of the host, see \ref JitUnwind.
+struct UnwindOp {
+  //! Type of the operation.
+  ASMJIT_ENUM(Type) {
+    kTypeFuncBegin   = 0,                //!< Start of the function.
+    kTypePush        = 1,                //!< `push reg`.
+    kTypeSetFrame    = 2,                //!< `mov reg, sp`, `reg` is the frame pointer.
+    kTypeAlign       = 3,                //!< `and sp, -value`, `reg` holds the unaligned `sp` (or invalid).
+    kTypeAlloc       = 4,                //!< `sub sp, value`.
+    kTypeSaveSp      = 5,                //!< `mov [sp + value], reg`, saves the unaligned `sp`.
+    kTypeSaveVec     = 6,                //!< Vector `reg` saved at `[sp + value]`.
+    kTypePrologEnd   = 7,                //!< End of the prolog.
+    kTypeEpilogBegin = 8,                //!< Start of an epilog.
+    kTypeRestoreSp   = 9,                //!< `sp` points to saved registers, `value` is the distance to the caller's `sp`.
+    kTypeFree        = 10,               //!< `add sp, value`.
+    kTypePop         = 11,               //!< `pop reg`.
+    kTypeEpilogEnd   = 12                //!< End of an epilog (after `ret`, or before a tail jump).
+  };
+
+  uint32_t labelId;                      //!< Label bound at the position of the operation.
+  uint8_t type;                          //!< Type of the operation, see \ref Type.
+  uint8_t regId;                         //!< Register id (or `Globals::kInvalidRegId`).
+  uint16_t reserved;                     //!< \internal
+  int32_t value;                         //!< Value, depends on the type.
+};
+
 // ============================================================================
 // [asmjit::CodeHolder]
 // ============================================================================
@@ -502,6 +666,26 @@ public:
   //! Detach all code-generators attached and reset the \ref CodeHolder.
   ASMJIT_API void reset(bool releaseMemory = false) noexcept;
 
+  //! Reset the \ref CodeHolder to the state after `init()` while keeping all
+  //! attached \ref CodeEmitter instances, the code information, options,
+  //! logger, and error handler.
+  //!
+  //! All memory is kept, including zone blocks, dynamic blocks of containers
+  //! and the buffer of the default section, and attached emitters keep their
+  //! state as well (for example \ref CodeBuilder keeps all passes), so a loop
+  //! that generates code and calls `recycle()` doesn't allocate after the
+  //! first round. Each attached emitter is notified by `CodeEmitter::onRecycle()`.
+  ASMJIT_API Error recycle() noexcept;
+
+  //! Reserve storage for `labelCount` labels (`namedLabelCount` of them named)
+  //! and `relocCount` relocations.
+  //!
+  //! Should be called after `init()` or `recycle()` when the size of the code
+  //! is known in advance (for example when a module is regenerated), so the
+  //! containers don't have to grow and copy their content while the code is
+  //! emitted. The reservation is dropped by `reset()` and `recycle()`.
+  ASMJIT_API Error reserve(size_t labelCount, size_t relocCount, size_t namedLabelCount = 0) noexcept;
+
   // --------------------------------------------------------------------------
   // [Attach / Detach]
   // --------------------------------------------------------------------------
@@ -541,20 +725,34 @@ public:
   //! Get a static base-address (uint64_t).
   ASMJIT_INLINE uint64_t getBaseAddress() const noexcept { return _codeInfo.getBaseAddress(); }
 
+  //! Get if the code targets a specific CPU model.
+  ASMJIT_INLINE bool hasFeatures() const noexcept { return _codeInfo.hasFeatures(); }
+  //! Get CPU features the code is allowed to use, see \ref CodeInfo::getFeatures().
+  ASMJIT_INLINE const CpuFeatures& getFeatures() const noexcept { return _codeInfo.getFeatures(); }
+
   // --------------------------------------------------------------------------
   // [Global Information]
   // --------------------------------------------------------------------------
 
   //! Get global hints, internally propagated to all `CodeEmitter`s attached.
   ASMJIT_INLINE uint32_t getGlobalHints() const noexcept { return _globalHints; }
+  //! Set global hints and propagate them to all `CodeEmitter`s attached.
+  ASMJIT_API void setGlobalHints(uint32_t hints) noexcept;
   //! Get global options, internally propagated to all `CodeEmitter`s attached.
   ASMJIT_INLINE uint32_t getGlobalOptions() const noexcept { return _globalOptions; }
 
+  //! Enable or disable `CodeEmitter::kOptionStrictValidation` of all attached
+  //! `CodeEmitter`s. If the code targets a specific CPU model, see \ref
+  //! CodeInfo::hasFeatures(), instructions that require a feature the target
+  //! doesn't have are rejected by `kErrorMissingCpuFeature`.
+  ASMJIT_API void setStrictValidation(bool enabled) noexcept;
+
   // --------------------------------------------------------------------------
   // [Result Information]
   // --------------------------------------------------------------------------
 
-  //! Get the size code & data of all sections.
+  //! Get the size code & data of all sections, including alignment of
+  //! sections and all possible trampolines.
   ASMJIT_API size_t getCodeSize() const noexcept;
 
   //! Get size of all possible trampolines.
@@ -565,6 +763,63 @@ public:
   //! address directly).
   ASMJIT_INLINE size_t getTrampolinesSize() const noexcept { return _trampolinesSize; }
 
+  //! Get the size of the code relocated anywhere within `[rangeLo, rangeHi)`.
+  //!
+  //! Only trampolines of targets that can't be reached by `rel32` from every
+  //! address of the range are counted, so the result is the exact size that
+  //! `relocate()` returns for code placed within the range if each target is
+  //! either reachable from the whole range or from none of it, and an upper
+  //! bound otherwise. Returns `getCodeSize()` if `rangeHi` is zero.
+  ASMJIT_API size_t getRelocatedSize(uint64_t rangeLo = 0, uint64_t rangeHi = 0) const noexcept;
+
+  // --------------------------------------------------------------------------
+  // [Statistics]
+  // --------------------------------------------------------------------------
+
+  //! Get whether statistics are collected, see \ref CodeStats.
+  ASMJIT_INLINE bool isStatsEnabled() const noexcept { return _statsEnabled != 0; }
+  //! Enable or disable collecting statistics, disabled by default.
+  //!
+  //! Only code emitted while the statistics are enabled is counted, code of a
+  //! \ref CodeBuilder is counted when it's serialized into an \ref Assembler.
+  ASMJIT_INLINE void setStatsEnabled(bool enabled) noexcept { _statsEnabled = enabled; }
+
+  //! Get statistics collected so far.
+  ASMJIT_INLINE const CodeStats& getStats() const noexcept { return _stats; }
+  //! Reset statistics.
+  ASMJIT_INLINE void resetStats() noexcept { _stats.reset(); }
+
+  // --------------------------------------------------------------------------
+  // [Unwind]
+  // --------------------------------------------------------------------------
+
+  //! Get whether stack frame operations are recorded, see \ref UnwindOp.
+  ASMJIT_INLINE bool isUnwindEnabled() const noexcept { return _unwindEnabled != 0; }
+  //! Enable or disable recording of stack frame operations, disabled by default.
+  //!
+  //! Only prologs and epilogs emitted while enabled are recorded, each records
+  //! a few labels. \ref JitRuntime registers unwind information of recorded
+  //! functions, so debuggers, profilers, and C++ exceptions can walk through
+  //! their frames. Recorded operations are not saved by `saveBlob()`.
+  ASMJIT_INLINE void setUnwindEnabled(bool enabled) noexcept { _unwindEnabled = enabled; }
+
+  //! Get recorded stack frame operations.
+  ASMJIT_INLINE const ZoneVector<UnwindOp>& getUnwindOps() const noexcept { return _unwindOps; }
+  //! Record a stack frame operation of `type` at the position of `labelId`.
+  ASMJIT_API Error addUnwindOp(uint32_t labelId, uint32_t type, uint32_t regId = Globals::kInvalidRegId, int32_t value = 0) noexcept;
+
+  // --------------------------------------------------------------------------
+  // [Tracing]
+  // --------------------------------------------------------------------------
+
+  //! Get the attached \ref TraceBuffer (or null).
+  ASMJIT_INLINE TraceBuffer* getTraceBuffer() const noexcept { return _traceBuffer; }
+  //! Attach a \ref TraceBuffer that records each instruction emitted by the
+  //! attached \ref Assembler, or detach it if `traceBuffer` is null.
+  ASMJIT_INLINE void setTraceBuffer(TraceBuffer* traceBuffer) noexcept { _traceBuffer = traceBuffer; }
+  //! Detach the \ref TraceBuffer (does nothing if not attached).
+  ASMJIT_INLINE void resetTraceBuffer() noexcept { _traceBuffer = nullptr; }
+
   // --------------------------------------------------------------------------
   // [Logging & Error Handling]
   // --------------------------------------------------------------------------
@@ -598,10 +853,32 @@ public:
 
   //! Get a section entry of the given index.
   ASMJIT_INLINE SectionEntry* getSectionEntry(size_t index) const noexcept { return _sections[index]; }
+  //! Get a section entry of the given `name` or null if there is no such section.
+  ASMJIT_API SectionEntry* getSectionByName(const char* name, size_t nameLength = Globals::kInvalidIndex) const noexcept;
+
+  //! Create a new section of the given `name`, `flags`, and `alignment`.
+  //!
+  //! Returns `Error`, does not report error to \ref ErrorHandler.
+  ASMJIT_API Error newSection(SectionEntry** sectionOut, const char* name, size_t nameLength = Globals::kInvalidIndex, uint32_t flags = 0, uint32_t alignment = 1) noexcept;
+
+  //! Calculate offsets of all sections in the relocated code, see
+  //! \ref SectionEntry::getOffset(), and return the size of all sections
+  //! (without trampolines).
+  ASMJIT_API size_t layoutSections() noexcept;
 
   ASMJIT_API Error growBuffer(CodeBuffer* cb, size_t n) noexcept;
   ASMJIT_API Error reserveBuffer(CodeBuffer* cb, size_t n) noexcept;
 
+  //! Use a user-provided memory of `capacity` bytes as a content of `cb`.
+  //!
+  //! The buffer must be empty (the attached \ref Assembler is synced first).
+  //! The memory is not owned by the CodeHolder and must outlive it (or its
+  //! next `reset()`). If `fixedSize` is false and the emitted code doesn't fit,
+  //! the content is copied into a buffer owned by the CodeHolder, otherwise
+  //! `kErrorCodeTooLarge` is returned. Passing null `data` turns `cb` back into
+  //! an empty buffer that is owned by the CodeHolder.
+  ASMJIT_API Error setExternalBuffer(CodeBuffer* cb, void* data, size_t capacity, bool fixedSize = false) noexcept;
+
   // --------------------------------------------------------------------------
   // [Labels & Symbols]
   // --------------------------------------------------------------------------
@@ -621,8 +898,14 @@ public:
 
   //! Create a new label-link used to store information about yet unbound labels.
   //!
-  //! Returns `null` if the allocation failed.
+  //! The link is appended to the links array of `le`, which is reallocated
+  //! when full, so the returned pointer is only valid until the next link of
+  //! the same label is created. Returns `null` if the allocation failed.
   ASMJIT_API LabelLink* newLabelLink(LabelEntry* le, uint32_t sectionId, size_t offset, intptr_t rel) noexcept;
+  //! \internal
+  //!
+  //! Release links of `le` after they were resolved.
+  ASMJIT_API void _releaseLabelLinks(LabelEntry* le) noexcept;
 
   //! Get array of `LabelEntry*` records.
   ASMJIT_INLINE const ZoneVector<LabelEntry*>& getLabelEntries() const noexcept { return _labels; }
@@ -693,6 +976,9 @@ public:
 
   //! Relocate the code to `baseAddress` and copy it to `dst`.
   //!
+  //! All sections are copied at offsets calculated by `layoutSections()`,
+  //! trampolines follow the last section.
+  //!
   //! \param dst Contains the location where the relocated code should be
   //! copied. The pointer can be address returned by virtual memory allocator
   //! or any other address that has sufficient space.
@@ -703,12 +989,41 @@ public:
   //! \return The number bytes actually used. If the code emitter reserved
   //! space for possible trampolines, but didn't use it, the number of bytes
   //! used can actually be less than the expected worst case. Virtual memory
-  //! allocator can shrink the memory it allocated initially.
+  //! allocator can shrink the memory it allocated initially. Zero is returned
+  //! if a relocation entry is invalid or its target cannot be reached.
   //!
   //! A given buffer will be overwritten, to get the number of bytes required,
-  //! use `getCodeSize()`.
+  //! use `getCodeSize()`. If `dst` is the external buffer of the first section
+  //! (see `setExternalBuffer()`) and the section is placed at offset zero, its
+  //! content is relocated in place instead of being copied.
   ASMJIT_API size_t relocate(void* dst, uint64_t baseAddress = Globals::kNoBaseAddress) const noexcept;
 
+  // --------------------------------------------------------------------------
+  // [Serialization]
+  // --------------------------------------------------------------------------
+
+  //! Get the size of a blob created by `saveBlob()`.
+  ASMJIT_API size_t getBlobSize() const noexcept;
+
+  //! Save code information, sections, labels, and relocations into a blob,
+  //! `dst` must have at least `getBlobSize()` bytes.
+  //!
+  //! The blob contains everything needed by `relocate()` and \ref Runtime::add()
+  //! so the code can be loaded by `loadBlob()` in another process without
+  //! running the code generator again. The blob uses the native byte order and
+  //! all labels used by the code must be bound, otherwise `kErrorInvalidState`
+  //! is returned.
+  ASMJIT_API Error saveBlob(void* dst, size_t size) const noexcept;
+
+  //! Initialize the CodeHolder from a blob created by `saveBlob()`.
+  //!
+  //! The CodeHolder must not be initialized. Loading is zero-copy - section
+  //! buffers and long label names point to `data`, which must be aligned to
+  //! 8 bytes and must outlive the CodeHolder (or its next `reset()`), so it's
+  //! possible to load a blob of a memory-mapped file. Section buffers are
+  //! external and fixed-size, they cannot be modified by emitters.
+  ASMJIT_API Error loadBlob(const void* data, size_t size) noexcept;
+
   // --------------------------------------------------------------------------
   // [Members]
   // --------------------------------------------------------------------------
@@ -723,9 +1038,13 @@ public:
 
   Logger* _logger;                       //!< Attached \ref Logger, used by all consumers.
   ErrorHandler* _errorHandler;           //!< Attached \ref ErrorHandler.
+  TraceBuffer* _traceBuffer;             //!< Attached \ref TraceBuffer.
 
   uint32_t _unresolvedLabelsCount;       //!< Count of label references which were not resolved.
   uint32_t _trampolinesSize;             //!< Size of all possible trampolines.
+  uint32_t _statsEnabled;                //!< Statistics are collected.
+  uint32_t _unwindEnabled;               //!< Stack frame operations are recorded.
+  mutable CodeStats _stats;              //!< Statistics, updated also by `relocate()`.
 
   Zone _baseZone;                        //!< Base zone (used to allocate core structures).
   Zone _dataZone;                        //!< Data zone (used to allocate extra data like label names).
@@ -734,7 +1053,8 @@ public:
   ZoneVector<SectionEntry*> _sections;   //!< Section entries.
   ZoneVector<LabelEntry*> _labels;       //!< Label entries (each label is stored here).
   ZoneVector<RelocEntry*> _relocations;  //!< Relocation entries.
-  ZoneHash<LabelEntry> _namedLabels;     //!< Label name -> LabelEntry (only named labels).
+  ZoneVector<UnwindOp> _unwindOps;       //!< Recorded stack frame operations.
+  ZoneFlatHash<LabelEntry> _namedLabels; //!< Label name -> LabelEntry (only named labels).
 };
 
 //! \}
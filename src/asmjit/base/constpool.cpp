@@ -18,109 +18,114 @@
 
 namespace asmjit {
 
-// Binary tree code is based on Julienne Walker's "Andersson Binary Trees"
-// article and implementation. However, only three operations are implemented -
-// get, insert and traverse.
-
 // ============================================================================
-// [asmjit::ConstPool::Tree - Ops]
+// [asmjit::ConstPool - Hash]
 // ============================================================================
 
 //! \internal
 //!
-//! Remove left horizontal links.
-static ASMJIT_INLINE ConstPool::Node* ConstPoolTree_skewNode(ConstPool::Node* node) noexcept {
-  ConstPool::Node* link = node->_link[0];
-  uint32_t level = node->_level;
-
-  if (level != 0 && link && link->_level == level) {
-    node->_link[0] = link->_link[1];
-    link->_link[1] = node;
-
-    node = link;
+//! Hash `size` bytes of `data`, the size is part of the hash as the same data
+//! of different sizes are different constants.
+static ASMJIT_INLINE uint32_t ConstPool_hashData(const void* data, size_t size) noexcept {
+  const uint8_t* p = static_cast<const uint8_t*>(data);
+  uint32_t hVal = static_cast<uint32_t>(size);
+
+  if (size >= 4) {
+    for (size_t i = 0; i < size; i += 4)
+      hVal = Utils::hashRound(hVal, Utils::readU32u(p + i));
   }
-
-  return node;
-}
-
-//! \internal
-//!
-//! Remove consecutive horizontal links.
-static ASMJIT_INLINE ConstPool::Node* ConstPoolTree_splitNode(ConstPool::Node* node) noexcept {
-  ConstPool::Node* link = node->_link[1];
-  uint32_t level = node->_level;
-
-  if (level != 0 && link && link->_link[1] && link->_link[1]->_level == level) {
-    node->_link[1] = link->_link[0];
-    link->_link[0] = node;
-
-    node = link;
-    node->_level++;
+  else {
+    for (size_t i = 0; i < size; i++)
+      hVal = Utils::hashRound(hVal, p[i]);
   }
 
-  return node;
+  // Constants often differ only in a few low bits (consecutive values), which
+  // would form long clusters in a linearly probed table. Avalanche the hash so
+  // each input bit affects the low bits that are used to index the table.
+  hVal ^= hVal >> 16;
+  hVal *= 0x85EBCA6BU;
+  hVal ^= hVal >> 13;
+  hVal *= 0xC2B2AE35U;
+  hVal ^= hVal >> 16;
+  return hVal;
 }
 
-ConstPool::Node* ConstPool::Tree::get(const void* data) noexcept {
-  ConstPool::Node* node = _root;
-  size_t dataSize = _dataSize;
+static ASMJIT_INLINE ConstPool::Node* ConstPool_getNode(const ConstPool* self, const void* data, size_t size, uint32_t hVal) noexcept {
+  ConstPool::Node** table = self->_table;
+  if (!table) return nullptr;
 
-  while (node) {
-    int c = ::memcmp(node->getData(), data, dataSize);
-    if (c == 0)
-      return node;
-    node = node->_link[c < 0];
-  }
+  size_t mask = self->_tableMask;
+  size_t i = hVal & mask;
 
-  return nullptr;
-}
+  for (;;) {
+    ConstPool::Node* node = table[i];
+    if (!node) return nullptr;
 
-void ConstPool::Tree::put(ConstPool::Node* newNode) noexcept {
-  size_t dataSize = _dataSize;
-  _length++;
+    if (node->_hVal == hVal && node->_size == size && ::memcmp(node->getData(), data, size) == 0)
+      return node;
 
-  if (!_root) {
-    _root = newNode;
-    return;
+    i = (i + 1) & mask;
   }
+}
 
-  ConstPool::Node* node = _root;
-  ConstPool::Node* stack[kHeightLimit];
+static ASMJIT_INLINE void ConstPool_insertNode(ConstPool::Node** table, size_t mask, ConstPool::Node* node) noexcept {
+  size_t i = node->_hVal & mask;
+  while (table[i])
+    i = (i + 1) & mask;
+  table[i] = node;
+}
 
-  unsigned int top = 0;
-  unsigned int dir;
+//! \internal
+//!
+//! Make sure there is a space for one more node in the hash table, which is
+//! kept at most 75% full. The old table is not released, it's in the zone.
+static Error ConstPool_reserveNode(ConstPool* self) noexcept {
+  size_t capacity = self->_table ? self->_tableMask + 1 : size_t(0);
+  if ((self->_nodeCount + 1) * 4 <= capacity * 3)
+    return kErrorOk;
 
-  // Find a spot and save the stack.
-  for (;;) {
-    stack[top++] = node;
-    dir = ::memcmp(node->getData(), newNode->getData(), dataSize) < 0;
+  size_t newCapacity = capacity ? capacity * 2 : size_t(ConstPool::kInitialTableCapacity);
+  if (ASMJIT_UNLIKELY(newCapacity < capacity || newCapacity > (~static_cast<size_t>(0) / sizeof(ConstPool::Node*))))
+    return DebugUtils::errored(kErrorNoHeapMemory);
 
-    ConstPool::Node* link = node->_link[dir];
-    if (!link) break;
+  ConstPool::Node** newTable = self->_zone->allocZeroedT<ConstPool::Node*>(newCapacity * sizeof(ConstPool::Node*));
+  if (ASMJIT_UNLIKELY(!newTable))
+    return DebugUtils::errored(kErrorNoHeapMemory);
 
-    node = link;
+  size_t newMask = newCapacity - 1;
+  for (size_t i = 0; i < capacity; i++) {
+    ConstPool::Node* node = self->_table[i];
+    if (node) ConstPool_insertNode(newTable, newMask, node);
   }
 
-  // Link and rebalance.
-  node->_link[dir] = newNode;
-
-  while (top > 0) {
-    // Which child?
-    node = stack[--top];
-
-    if (top != 0) {
-      dir = stack[top - 1]->_link[1] == node;
-    }
-
-    node = ConstPoolTree_skewNode(node);
-    node = ConstPoolTree_splitNode(node);
+  self->_table = newTable;
+  self->_tableMask = newMask;
+  return kErrorOk;
+}
 
-    // Fix the parent.
-    if (top != 0)
-      stack[top - 1]->_link[dir] = node;
-    else
-      _root = node;
+//! \internal
+//!
+//! Create a new node and add it to the hash table, which must have a space
+//! reserved by `ConstPool_reserveNode()`.
+static ConstPool::Node* ConstPool_newNode(ConstPool* self, const void* data, size_t size, uint32_t hVal, size_t offset, bool shared) noexcept {
+  ConstPool::Node* node = self->_zone->allocT<ConstPool::Node>(sizeof(ConstPool::Node) + size);
+  if (ASMJIT_UNLIKELY(!node)) return nullptr;
+
+  node->_next = nullptr;
+  node->_hVal = hVal;
+  node->_size = static_cast<uint32_t>(size);
+  node->_shared = shared;
+  node->_offset = static_cast<uint32_t>(offset);
+  ::memcpy(node->getData(), data, size);
+
+  if (!shared) {
+    node->_next = self->_first;
+    self->_first = node;
   }
+
+  ConstPool_insertNode(self->_table, self->_tableMask, node);
+  self->_nodeCount++;
+  return node;
 }
 
 // ============================================================================
@@ -136,14 +141,13 @@ ConstPool::~ConstPool() noexcept {}
 
 void ConstPool::reset(Zone* zone) noexcept {
   _zone = zone;
+  _table = nullptr;
+  _tableMask = 0;
+  _nodeCount = 0;
+  _first = nullptr;
 
-  size_t dataSize = 1;
-  for (size_t i = 0; i < ASMJIT_ARRAY_SIZE(_tree); i++) {
-    _tree[i].reset();
-    _tree[i].setDataSize(dataSize);
+  for (size_t i = 0; i < ASMJIT_ARRAY_SIZE(_gaps); i++)
     _gaps[i] = nullptr;
-    dataSize <<= 1;
-  }
 
   _gapPool = nullptr;
   _size = 0;
@@ -213,36 +217,40 @@ static void ConstPool_addGap(ConstPool* self, size_t offset, size_t length) noex
 }
 
 Error ConstPool::add(const void* data, size_t size, size_t& dstOffset) noexcept {
-  size_t treeIndex;
+  size_t sizeIndex;
 
   if (size == 32)
-    treeIndex = kIndex32;
+    sizeIndex = kIndex32;
   else if (size == 16)
-    treeIndex = kIndex16;
+    sizeIndex = kIndex16;
   else if (size == 8)
-    treeIndex = kIndex8;
+    sizeIndex = kIndex8;
   else if (size == 4)
-    treeIndex = kIndex4;
+    sizeIndex = kIndex4;
   else if (size == 2)
-    treeIndex = kIndex2;
+    sizeIndex = kIndex2;
   else if (size == 1)
-    treeIndex = kIndex1;
+    sizeIndex = kIndex1;
   else
     return DebugUtils::errored(kErrorInvalidArgument);
 
-  ConstPool::Node* node = _tree[treeIndex].get(data);
+  uint32_t hVal = ConstPool_hashData(data, size);
+  ConstPool::Node* node = ConstPool_getNode(this, data, size, hVal);
+
   if (node) {
     dstOffset = node->_offset;
     return kErrorOk;
   }
 
+  ASMJIT_PROPAGATE(ConstPool_reserveNode(this));
+
   // Before incrementing the current offset try if there is a gap that can
   // be used for the requested data.
   size_t offset = ~static_cast<size_t>(0);
-  size_t gapIndex = treeIndex;
+  size_t gapIndex = sizeIndex;
 
   while (gapIndex != kIndexCount - 1) {
-    ConstPool::Gap* gap = _gaps[treeIndex];
+    ConstPool::Gap* gap = _gaps[sizeIndex];
 
     // Check if there is a gap.
     if (gap) {
@@ -250,7 +258,7 @@ Error ConstPool::add(const void* data, size_t size, size_t& dstOffset) noexcept
       size_t gapLength = gap->_length;
 
       // Destroy the gap for now.
-      _gaps[treeIndex] = gap->_next;
+      _gaps[sizeIndex] = gap->_next;
       ConstPool_freeGap(this, gap);
 
       offset = gapOffset;
@@ -278,11 +286,10 @@ Error ConstPool::add(const void* data, size_t size, size_t& dstOffset) noexcept
     _size += size;
   }
 
-  // Add the initial node to the right index.
-  node = ConstPool::Tree::_newNode(_zone, data, size, offset, false);
+  // Add the initial node.
+  node = ConstPool_newNode(this, data, size, hVal, offset, false);
   if (!node) return DebugUtils::errored(kErrorNoHeapMemory);
 
-  _tree[treeIndex].put(node);
   _alignment = std::max<size_t>(_alignment, size);
 
   dstOffset = offset;
@@ -295,49 +302,48 @@ Error ConstPool::add(const void* data, size_t size, size_t& dstOffset) noexcept
     size >>= 1;
     pCount <<= 1;
 
-    ASMJIT_ASSERT(treeIndex != 0);
-    treeIndex--;
+    ASMJIT_ASSERT(sizeIndex != 0);
+    sizeIndex--;
 
     const uint8_t* pData = static_cast<const uint8_t*>(data);
     for (size_t i = 0; i < pCount; i++, pData += size) {
-      node = _tree[treeIndex].get(pData);
-      if (node) continue;
+      hVal = ConstPool_hashData(pData, size);
+      if (ConstPool_getNode(this, pData, size, hVal)) continue;
 
-      node = ConstPool::Tree::_newNode(_zone, pData, size, offset + (i * size), true);
-      _tree[treeIndex].put(node);
+      // Shared constants are optional, nothing happens if they can't be added.
+      if (ConstPool_reserveNode(this) != kErrorOk ||
+          !ConstPool_newNode(this, pData, size, hVal, offset + (i * size), true))
+        return kErrorOk;
     }
   }
 
   return kErrorOk;
 }
 
-// ============================================================================
-// [asmjit::ConstPool - Reset]
-// ============================================================================
-
-struct ConstPoolFill {
-  ASMJIT_INLINE ConstPoolFill(uint8_t* dst, size_t dataSize) noexcept :
-    _dst(dst),
-    _dataSize(dataSize) {}
-
-  ASMJIT_INLINE void visit(const ConstPool::Node* node) noexcept {
-    if (!node->_shared)
-      ::memcpy(_dst + node->_offset, node->getData(), _dataSize);
+const void* ConstPool::getData(size_t offset, size_t size) const noexcept {
+  // Shared nodes are always a part of a bigger constant, so only the nodes
+  // that own their data have to be checked.
+  for (const ConstPool::Node* node = _first; node; node = node->_next) {
+    size_t nodeOffset = node->_offset;
+    if (offset >= nodeOffset && offset - nodeOffset + size <= node->_size)
+      return static_cast<const uint8_t*>(node->getData()) + (offset - nodeOffset);
   }
+  return nullptr;
+}
 
-  uint8_t* _dst;
-  size_t _dataSize;
-};
+// ============================================================================
+// [asmjit::ConstPool - Fill]
+// ============================================================================
 
 void ConstPool::fill(void* dst) const noexcept {
   // Clears possible gaps, asmjit should never emit garbage to the output.
   ::memset(dst, 0, _size);
 
-  ConstPoolFill filler(static_cast<uint8_t*>(dst), 1);
-  for (size_t i = 0; i < ASMJIT_ARRAY_SIZE(_tree); i++) {
-    _tree[i].iterate(filler);
-    filler._dataSize <<= 1;
-  }
+  // Shared nodes are not in the list, their data is already part of a bigger
+  // constant, and the order doesn't matter as each node knows its offset.
+  uint8_t* dstData = static_cast<uint8_t*>(dst);
+  for (const ConstPool::Node* node = _first; node; node = node->_next)
+    ::memcpy(dstData + node->_offset, node->getData(), node->_size);
 }
 
 // ============================================================================
@@ -502,6 +508,49 @@ UNIT(base_constpool) {
     EXPECT(offset == 32,
       "pool.getSize() - Expected offset returned to be 32");
   }
+
+  INFO("Checking if the pool is filled correctly");
+  {
+    pool.reset(&zone);
+    zone.reset();
+
+    uint32_t c4 = 0x11223344;
+    uint64_t c8 = ASMJIT_UINT64_C(0x5566778811223344);
+
+    size_t offset;
+    uint8_t dst[16];
+
+    pool.add(&c4, 4, offset);
+    EXPECT(offset == 0);
+
+    // The same data of a different size is a different constant.
+    pool.add(&c4, 2, offset);
+    EXPECT(offset == 4);
+
+    pool.add(&c8, 8, offset);
+    EXPECT(offset == 8);
+    EXPECT(pool.getSize() == 16);
+
+    pool.fill(dst);
+    EXPECT(Utils::readU32u(dst) == c4);
+    EXPECT(Utils::readU16u(dst + 4) == (c4 & 0xFFFF));
+    EXPECT(Utils::readU16u(dst + 6) == 0);
+    EXPECT(Utils::readU64u(dst + 8) == c8);
+  }
+
+  INFO("Checking if the data can be retrieved by offset");
+  {
+    uint32_t c4 = 0x11223344;
+    uint64_t c8 = ASMJIT_UINT64_C(0x5566778811223344);
+
+    EXPECT(Utils::readU32u(pool.getData(0, 4)) == c4);
+    EXPECT(Utils::readU32u(pool.getData(12, 4)) == 0x55667788);
+    EXPECT(Utils::readU64u(pool.getData(8, 8)) == c8);
+
+    // Gaps and ranges crossing two constants are not covered.
+    EXPECT(pool.getData(6, 2) == nullptr);
+    EXPECT(pool.getData(4, 8) == nullptr);
+  }
 }
 #endif // ASMJIT_TEST
 
@@ -29,6 +29,9 @@ public:
   ASMJIT_NONCOPYABLE(ConstPool)
 
   enum {
+    //! Initial capacity of the hash table.
+    kInitialTableCapacity = 64,
+
     kIndex1 = 0,
     kIndex2 = 1,
     kIndex4 = 2,
@@ -57,132 +60,19 @@ public:
 
   //! \internal
   //!
-  //! Zone-allocated const-pool node.
+  //! Zone-allocated const-pool node, followed by the data of the constant.
   struct Node {
     ASMJIT_INLINE void* getData() const noexcept {
       return static_cast<void*>(const_cast<ConstPool::Node*>(this) + 1);
     }
 
-    Node* _link[2];                      //!< Left/Right nodes.
-    uint32_t _level : 31;                //!< Horizontal level for balance.
+    Node* _next;                         //!< Next node filled by `fill()`, only used if not shared.
+    uint32_t _hVal;                      //!< Hash value of the data and its size.
+    uint32_t _size : 31;                 //!< Size of the data.
     uint32_t _shared : 1;                //!< If this constant is shared with another.
     uint32_t _offset;                    //!< Data offset from the beginning of the pool.
   };
 
-  // --------------------------------------------------------------------------
-  // [Tree]
-  // --------------------------------------------------------------------------
-
-  //! \internal
-  //!
-  //! Zone-allocated const-pool tree.
-  struct Tree {
-    enum {
-      //! Maximum tree height == log2(1 << 64).
-      kHeightLimit = 64
-    };
-
-    // --------------------------------------------------------------------------
-    // [Construction / Destruction]
-    // --------------------------------------------------------------------------
-
-    ASMJIT_INLINE Tree(size_t dataSize = 0) noexcept
-      : _root(nullptr),
-        _length(0),
-        _dataSize(dataSize) {}
-    ASMJIT_INLINE ~Tree() {}
-
-    // --------------------------------------------------------------------------
-    // [Reset]
-    // --------------------------------------------------------------------------
-
-    ASMJIT_INLINE void reset() noexcept {
-      _root = nullptr;
-      _length = 0;
-    }
-
-    // --------------------------------------------------------------------------
-    // [Accessors]
-    // --------------------------------------------------------------------------
-
-    ASMJIT_INLINE bool isEmpty() const noexcept { return _length == 0; }
-    ASMJIT_INLINE size_t getLength() const noexcept { return _length; }
-
-    ASMJIT_INLINE void setDataSize(size_t dataSize) noexcept {
-      ASMJIT_ASSERT(isEmpty());
-      _dataSize = dataSize;
-    }
-
-    // --------------------------------------------------------------------------
-    // [Ops]
-    // --------------------------------------------------------------------------
-
-    ASMJIT_API Node* get(const void* data) noexcept;
-    ASMJIT_API void put(Node* node) noexcept;
-
-    // --------------------------------------------------------------------------
-    // [Iterate]
-    // --------------------------------------------------------------------------
-
-    template<typename Visitor>
-    ASMJIT_INLINE void iterate(Visitor& visitor) const noexcept {
-      Node* node = const_cast<Node*>(_root);
-      if (!node) return;
-
-      Node* stack[kHeightLimit];
-      size_t top = 0;
-
-      for (;;) {
-        Node* left = node->_link[0];
-        if (left != nullptr) {
-          ASMJIT_ASSERT(top != kHeightLimit);
-          stack[top++] = node;
-
-          node = left;
-          continue;
-        }
-
-Visit:
-        visitor.visit(node);
-        node = node->_link[1];
-        if (node != nullptr)
-          continue;
-
-        if (top == 0)
-          return;
-
-        node = stack[--top];
-        goto Visit;
-      }
-    }
-
-    // --------------------------------------------------------------------------
-    // [Helpers]
-    // --------------------------------------------------------------------------
-
-    static ASMJIT_INLINE Node* _newNode(Zone* zone, const void* data, size_t size, size_t offset, bool shared) noexcept {
-      Node* node = zone->allocT<Node>(sizeof(Node) + size);
-      if (ASMJIT_UNLIKELY(!node)) return nullptr;
-
-      node->_link[0] = nullptr;
-      node->_link[1] = nullptr;
-      node->_level = 1;
-      node->_shared = shared;
-      node->_offset = static_cast<uint32_t>(offset);
-
-      ::memcpy(node->getData(), data, size);
-      return node;
-    }
-
-    // --------------------------------------------------------------------------
-    // [Members]
-    // --------------------------------------------------------------------------
-
-    Node* _root;                         //!< Root of the tree
-    size_t _length;                      //!< Length of the tree (count of nodes).
-    size_t _dataSize;                    //!< Size of the data.
-  };
-
   // --------------------------------------------------------------------------
   // [Construction / Destruction]
   // --------------------------------------------------------------------------
@@ -224,8 +114,16 @@ Visit:
   //! been already added. For example if you try to add 4-byte constant and then
   //! 8-byte constant having the same 4-byte pattern as the previous one, two
   //! independent slots will be generated by the pool.
+  //!
+  //! Constants are indexed by a hash table, so both adding a new constant and
+  //! finding an existing one take a constant time regardless of the size of
+  //! the pool.
   ASMJIT_API Error add(const void* data, size_t size, size_t& dstOffset) noexcept;
 
+  //! Get `size` bytes of constant data at `offset`, or null if the range is
+  //! not covered by a single constant added to the pool.
+  ASMJIT_API const void* getData(size_t offset, size_t size) const noexcept;
+
   // --------------------------------------------------------------------------
   // [Fill]
   // --------------------------------------------------------------------------
@@ -238,7 +136,10 @@ Visit:
   // --------------------------------------------------------------------------
 
   Zone* _zone;                           //!< Zone allocator.
-  Tree _tree[kIndexCount];               //!< Tree per size.
+  Node** _table;                         //!< Open-addressing hash table of all nodes.
+  size_t _tableMask;                     //!< Capacity of `_table` minus one (capacity is a power of 2).
+  size_t _nodeCount;                     //!< Count of nodes in `_table`.
+  Node* _first;                          //!< First node that is not shared (filled by `fill()`).
   Gap* _gaps[kIndexCount];               //!< Gaps per size.
   Gap* _gapPool;                         //!< Gaps pool
 
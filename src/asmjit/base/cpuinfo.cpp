@@ -385,6 +385,60 @@ L_Skip:
   d[0] = '\0';
 }
 
+//! \internal
+//!
+//! Read cache descriptors from a deterministic cache parameters leaf, which is
+//! either `0x4` (Intel) or `0x8000001D` (AMD), both use the same format.
+static void x86DetectCaches(CpuInfo* cpuInfo, uint32_t leaf) noexcept {
+  CpuIdResult regs;
+
+  for (uint32_t i = 0; i < 32 && cpuInfo->_cacheCount < CpuInfo::kMaxCaches; i++) {
+    x86CallCpuId(&regs, leaf, i);
+
+    uint32_t type = regs.eax & 0x1F;
+    if (type == CpuInfo::kCacheTypeNone)
+      break;
+
+    if (type > CpuInfo::kCacheTypeUnified)
+      continue;
+
+    uint32_t lineSize   = ((regs.ebx      ) & 0x0FFF) + 1;
+    uint32_t partitions = ((regs.ebx >> 12) & 0x03FF) + 1;
+    uint32_t ways       = ((regs.ebx >> 22) & 0x03FF) + 1;
+    uint32_t sets       = regs.ecx + 1;
+
+    CpuInfo::CacheInfo& cache = cpuInfo->_caches[cpuInfo->_cacheCount++];
+    cache._type     = static_cast<uint8_t>(type);
+    cache._level    = static_cast<uint8_t>((regs.eax >> 5) & 0x7);
+    cache._sharedBy = static_cast<uint16_t>(((regs.eax >> 14) & 0x0FFF) + 1);
+    cache._lineSize = lineSize;
+    cache._ways     = ways;
+    cache._size     = ways * partitions * lineSize * sets;
+  }
+}
+
+//! \internal
+//!
+//! Get number of hardware threads per core from an extended topology leaf,
+//! which is either `0x1F` (V2) or `0xB`. Returns zero if SMT level is missing.
+static uint32_t x86DetectThreadsPerCore(uint32_t leaf) noexcept {
+  CpuIdResult regs;
+
+  for (uint32_t i = 0; i < 8; i++) {
+    x86CallCpuId(&regs, leaf, i);
+
+    // Level type: 0 == Invalid, 1 == SMT, 2 == Core, ...
+    uint32_t levelType = (regs.ecx >> 8) & 0xFF;
+    if (levelType == 0)
+      break;
+
+    if (levelType == 1)
+      return regs.ebx & 0xFFFF;
+  }
+
+  return 0;
+}
+
 ASMJIT_FAVOR_SIZE static void x86DetectCpuInfo(CpuInfo* cpuInfo) noexcept {
   uint32_t i, maxId;
 
@@ -501,6 +555,7 @@ ASMJIT_FAVOR_SIZE static void x86DetectCpuInfo(CpuInfo* cpuInfo) noexcept {
     if (regs.ebx & 0x01000000U) cpuInfo->addFeature(CpuInfo::kX86FeatureCLWB);
     if (regs.ebx & 0x20000000U) cpuInfo->addFeature(CpuInfo::kX86FeatureSHA);
     if (regs.ecx & 0x00000001U) cpuInfo->addFeature(CpuInfo::kX86FeaturePREFETCHWT1);
+    if (regs.edx & 0x00000010U) cpuInfo->addFeature(CpuInfo::kX86FeatureFSRM);
 
     // TSX is supported if at least one of `HLE` and `RTM` is supported.
     if (regs.ebx & 0x00000810U) cpuInfo->addFeature(CpuInfo::kX86FeatureTSX);
@@ -532,6 +587,23 @@ ASMJIT_FAVOR_SIZE static void x86DetectCpuInfo(CpuInfo* cpuInfo) noexcept {
         if (regs.edx & 0x00000008U) cpuInfo->addFeature(CpuInfo::kX86FeatureAVX512_4FMAPS);
       }
     }
+
+    if (regs.edx & 0x00008000U) cpuInfo->_x86Data._hybrid = 1;
+  }
+
+  // --------------------------------------------------------------------------
+  // [CPUID EAX=0x4 / 0xB / 0x1F / 0x1A]
+  // --------------------------------------------------------------------------
+
+  if (maxId >= 0x4 && cpuInfo->getVendorId() != CpuInfo::kVendorAMD)
+    x86DetectCaches(cpuInfo, 0x4);
+
+  if (maxId >= 0xB)
+    cpuInfo->_threadsPerCore = x86DetectThreadsPerCore(maxId >= 0x1F ? 0x1F : 0xB);
+
+  if (maxId >= 0x1A && cpuInfo->_x86Data._hybrid) {
+    x86CallCpuId(&regs, 0x1A);
+    cpuInfo->_x86Data._coreType = regs.eax >> 24;
   }
 
   // --------------------------------------------------------------------------
@@ -557,6 +629,8 @@ ASMJIT_FAVOR_SIZE static void x86DetectCpuInfo(CpuInfo* cpuInfo) noexcept {
 
   // The highest EAX that we understand.
   uint32_t kHighestProcessedEAX = 0x80000008U;
+  uint32_t maxExtId = 0;
+  bool hasTopologyExt = false;
 
   // Several CPUID calls are required to get the whole branc string. It's easy
   // to copy one DWORD at a time instead of performing a byte copy.
@@ -567,6 +641,7 @@ ASMJIT_FAVOR_SIZE static void x86DetectCpuInfo(CpuInfo* cpuInfo) noexcept {
     x86CallCpuId(&regs, i);
     switch (i) {
       case 0x80000000U:
+        maxExtId = regs.eax;
         maxId = std::min<uint32_t>(regs.eax, kHighestProcessedEAX);
         break;
 
@@ -585,6 +660,8 @@ ASMJIT_FAVOR_SIZE static void x86DetectCpuInfo(CpuInfo* cpuInfo) noexcept {
                                             .addFeature(CpuInfo::kX86FeatureMMX2);
         if (regs.edx & 0x80000000U) cpuInfo->addFeature(CpuInfo::kX86Feature3DNOW);
 
+        if (regs.ecx & 0x00400000U) hasTopologyExt = true;
+
         if (cpuInfo->hasFeature(CpuInfo::kX86FeatureAVX)) {
           if (regs.ecx & 0x00000800U) cpuInfo->addFeature(CpuInfo::kX86FeatureXOP);
           if (regs.ecx & 0x00010000U) cpuInfo->addFeature(CpuInfo::kX86FeatureFMA4);
@@ -614,6 +691,11 @@ ASMJIT_FAVOR_SIZE static void x86DetectCpuInfo(CpuInfo* cpuInfo) noexcept {
     }
   } while (++i <= maxId);
 
+  // AMD provides cache descriptors by an extended leaf if TopologyExtensions
+  // are supported, leaf 0x4 is reserved on AMD.
+  if (cpuInfo->_cacheCount == 0 && hasTopologyExt && maxExtId >= 0x8000001DU)
+    x86DetectCaches(cpuInfo, 0x8000001DU);
+
   // Simplify CPU brand string by removing unnecessary spaces.
   x86SimplifyBrandString(cpuInfo->_brandString);
 }
@@ -653,6 +735,11 @@ ASMJIT_FAVOR_SIZE void CpuInfo::detect() noexcept {
 #endif // ASMJIT_ARCH_X86 || ASMJIT_ARCH_X64
 
   _hwThreadsCount = cpuDetectHWThreadsCount();
+
+  // Topology that wasn't detected is assumed to be one thread per core.
+  if (_threadsPerCore == 0)
+    _threadsPerCore = 1;
+  _coresCount = std::max<uint32_t>(_hwThreadsCount / _threadsPerCore, 1);
 }
 
 // ============================================================================
@@ -663,6 +750,8 @@ struct HostCpuInfo : public CpuInfo {
   ASMJIT_INLINE HostCpuInfo() noexcept : CpuInfo() { detect(); }
 };
 
+// Detection executes many CPUID instructions (some of them are very slow when
+// virtualized), so it's only done once and the result is shared process-wide.
 const CpuInfo& CpuInfo::getHost() noexcept {
   static HostCpuInfo host;
   return host;
@@ -56,6 +56,14 @@ public:
   //! Get all features as `BitWord` array (const).
   ASMJIT_INLINE const BitWord* getBits() const noexcept { return _bits; }
 
+  //! Get if no feature is present.
+  ASMJIT_INLINE bool isEmpty() const noexcept {
+    for (uint32_t i = 0; i < kNumBitWords; i++)
+      if (_bits[i] != 0)
+        return false;
+    return true;
+  }
+
   //! Get if feature `feature` is present.
   ASMJIT_INLINE bool has(uint32_t feature) const noexcept {
     ASMJIT_ASSERT(feature < kMaxFeatures);
@@ -118,6 +126,17 @@ public:
     kVendorVIA   = 3                     //!< VIA vendor.
   };
 
+  //! Cache type (matches the encoding used by X86 CPUID leaf 4).
+  ASMJIT_ENUM(CacheType) {
+    kCacheTypeNone        = 0,           //!< No cache.
+    kCacheTypeData        = 1,           //!< Data cache.
+    kCacheTypeInstruction = 2,           //!< Instruction cache.
+    kCacheTypeUnified     = 3            //!< Unified (data and instruction) cache.
+  };
+
+  //! Maximum number of cache descriptors stored in `CpuInfo`.
+  enum { kMaxCaches = 8 };
+
   //! ARM/ARM64 CPU features.
   ASMJIT_ENUM(ArmFeatures) {
     kArmFeatureV6 = 1,                   //!< ARMv6 instruction set.
@@ -222,10 +241,45 @@ public:
     kX86FeatureAVX512_VPOPCNTDQ,         //!< CPU has AVX512-VPOPCNTDQ (VPOPCNT[D|Q] instructions).
     kX86FeatureAVX512_4VNNIW,            //!< CPU has AVX512-VNNIW (vector NN instructions word variable precision).
     kX86FeatureAVX512_4FMAPS,            //!< CPU has AVX512-FMAPS (FMA packed single).
+    kX86FeatureFSRM,                     //!< CPU has FSRM (fast short REP MOVSB).
 
     kX86FeaturesCount                    //!< Count of X86/X64 CPU features.
   };
 
+  //! X86 core type of a hybrid processor (CPUID leaf 0x1A).
+  ASMJIT_ENUM(X86CoreType) {
+    kX86CoreTypeNone      = 0x00,        //!< Not a hybrid processor or unknown.
+    kX86CoreTypeAtom      = 0x20,        //!< Efficiency core (Intel Atom).
+    kX86CoreTypeCore      = 0x40         //!< Performance core (Intel Core).
+  };
+
+  // --------------------------------------------------------------------------
+  // [CacheInfo]
+  // --------------------------------------------------------------------------
+
+  //! Cache descriptor.
+  struct CacheInfo {
+    //! Get cache type, see \ref CacheType.
+    ASMJIT_INLINE uint32_t getType() const noexcept { return _type; }
+    //! Get cache level (1 is the closest to the core).
+    ASMJIT_INLINE uint32_t getLevel() const noexcept { return _level; }
+    //! Get maximum number of hardware threads sharing the cache.
+    ASMJIT_INLINE uint32_t getSharedBy() const noexcept { return _sharedBy; }
+    //! Get size of a cache line (in bytes).
+    ASMJIT_INLINE uint32_t getLineSize() const noexcept { return _lineSize; }
+    //! Get ways of associativity.
+    ASMJIT_INLINE uint32_t getWays() const noexcept { return _ways; }
+    //! Get cache size (in bytes).
+    ASMJIT_INLINE uint32_t getSize() const noexcept { return _size; }
+
+    uint8_t _type;                       //!< Cache type, see \ref CacheType.
+    uint8_t _level;                      //!< Cache level.
+    uint16_t _sharedBy;                  //!< Maximum number of hardware threads sharing the cache.
+    uint32_t _lineSize;                  //!< Cache line size (in bytes).
+    uint32_t _ways;                      //!< Ways of associativity.
+    uint32_t _size;                      //!< Cache size (in bytes).
+  };
+
   // --------------------------------------------------------------------------
   // [ArmInfo]
   // --------------------------------------------------------------------------
@@ -242,6 +296,8 @@ public:
     uint32_t _brandIndex;                //!< Brand index.
     uint32_t _flushCacheLineSize;        //!< Flush cache line size (in bytes).
     uint32_t _maxLogicalProcessors;      //!< Maximum number of addressable IDs for logical processors.
+    uint32_t _hybrid;                    //!< Processor has hybrid (performance and efficiency) cores.
+    uint32_t _coreType;                  //!< Core type of the detecting thread, see \ref X86CoreType.
   };
 
   // --------------------------------------------------------------------------
@@ -294,6 +350,27 @@ public:
     return _hwThreadsCount;
   }
 
+  //! Get number of physical cores (derived from hardware threads and SMT).
+  ASMJIT_INLINE uint32_t getCoresCount() const noexcept { return _coresCount; }
+  //! Get number of hardware threads per core (2 or more if SMT is enabled).
+  ASMJIT_INLINE uint32_t getThreadsPerCore() const noexcept { return _threadsPerCore; }
+
+  //! Get number of detected caches.
+  ASMJIT_INLINE uint32_t getCacheCount() const noexcept { return _cacheCount; }
+  //! Get cache descriptor at `index`.
+  ASMJIT_INLINE const CacheInfo& getCache(uint32_t index) const noexcept {
+    ASMJIT_ASSERT(index < _cacheCount);
+    return _caches[index];
+  }
+
+  //! Get size of the data (or unified) cache at `level`, zero if not known.
+  ASMJIT_INLINE uint32_t getDataCacheSize(uint32_t level) const noexcept {
+    for (uint32_t i = 0; i < _cacheCount; i++)
+      if (_caches[i]._level == level && _caches[i]._type != kCacheTypeInstruction)
+        return _caches[i]._size;
+    return 0;
+  }
+
   //! Get all CPU features.
   ASMJIT_INLINE const CpuFeatures& getFeatures() const noexcept { return _features; }
   //! Get whether CPU has a `feature`.
@@ -334,11 +411,28 @@ public:
     return _x86Data._maxLogicalProcessors;
   }
 
+  //! Get whether the processor has hybrid (performance and efficiency) cores.
+  ASMJIT_INLINE bool isX86Hybrid() const noexcept {
+    return _x86Data._hybrid != 0;
+  }
+
+  //! Get core type of the thread that detected the CPU, see \ref X86CoreType.
+  //!
+  //! NOTE: Only meaningful on hybrid processors, where the result depends on
+  //! the core the detection ran on - threads that need to know their own core
+  //! type should pin themselves and call `detect()` on a local `CpuInfo`.
+  ASMJIT_INLINE uint32_t getX86CoreType() const noexcept {
+    return _x86Data._coreType;
+  }
+
   // --------------------------------------------------------------------------
   // [Statics]
   // --------------------------------------------------------------------------
 
   //! Get the host CPU information.
+  //!
+  //! The host CPU is detected only once per process, the first call detects
+  //! it and all other calls return the cached result.
   ASMJIT_API static const CpuInfo& getHost() noexcept;
 
   // --------------------------------------------------------------------------
@@ -351,6 +445,10 @@ public:
   uint32_t _model;                       //!< CPU model ID.
   uint32_t _stepping;                    //!< CPU stepping.
   uint32_t _hwThreadsCount;              //!< Number of hardware threads.
+  uint32_t _coresCount;                  //!< Number of physical cores.
+  uint32_t _threadsPerCore;              //!< Number of hardware threads per core.
+  uint32_t _cacheCount;                  //!< Number of cache descriptors in `_caches`.
+  CacheInfo _caches[kMaxCaches];         //!< Cache descriptors (in the order reported by the CPU).
   CpuFeatures _features;                 //!< CPU features.
   char _vendorString[16];                //!< CPU vendor string.
   char _brandString[64];                 //!< CPU brand string.
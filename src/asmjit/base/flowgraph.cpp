@@ -0,0 +1,350 @@
+// [AsmJit]
+// Complete x86/x64 JIT and Remote Assembler for C++.
+//
+// [License]
+// Zlib - See LICENSE.md file in the package.
+
+// [Export]
+#define ASMJIT_EXPORTS
+
+// [Guard]
+#include "../asmjit_build.h"
+#if !defined(ASMJIT_DISABLE_BUILDER)
+
+// [Dependencies]
+#include "../base/flowgraph.h"
+
+// [Api-Begin]
+#include "../asmjit_apibegin.h"
+
+namespace asmjit {
+
+// ============================================================================
+// [asmjit::CBFlowGraph - Helpers]
+// ============================================================================
+
+static ASMJIT_INLINE bool CBFlowGraph_isLabel(const CBNode* node) noexcept {
+  return node->getType() == CBNode::kNodeLabel || node->getType() == CBNode::kNodeFunc;
+}
+
+static ASMJIT_INLINE bool CBFlowGraph_isReturn(const CBNode* node) noexcept {
+  return node->isRet() ||
+         node->getType() == CBNode::kNodeFuncExit ||
+         node->getType() == CBNode::kNodeSentinel;
+}
+
+static ASMJIT_INLINE bool CBFlowGraph_endsBlock(const CBNode* node) noexcept {
+  return node->isJmpOrJcc() || CBFlowGraph_isReturn(node);
+}
+
+static ASMJIT_INLINE CBBlock* CBFlowGraph_intersect(CBBlock* a, CBBlock* b) noexcept {
+  while (a != b) {
+    while (a->_rpoIndex > b->_rpoIndex) a = a->_idom;
+    while (b->_rpoIndex > a->_rpoIndex) b = b->_idom;
+  }
+  return a;
+}
+
+// ============================================================================
+// [asmjit::CBFlowGraph - Construction / Destruction]
+// ============================================================================
+
+CBFlowGraph::CBFlowGraph() noexcept { reset(); }
+CBFlowGraph::~CBFlowGraph() noexcept {}
+
+// ============================================================================
+// [asmjit::CBFlowGraph - Reset]
+// ============================================================================
+
+void CBFlowGraph::reset() noexcept {
+  _first = nullptr;
+  _stop = nullptr;
+
+  _blocks = nullptr;
+  _rpo = nullptr;
+  _labelMap = nullptr;
+
+  _blockCount = 0;
+  _rpoCount = 0;
+  _labelCount = 0;
+  _loopCount = 0;
+}
+
+// ============================================================================
+// [asmjit::CBFlowGraph - Build]
+// ============================================================================
+
+Error CBFlowGraph::build(CodeBuilder* cb, Zone* zone, CBNode* first, CBNode* stop) noexcept {
+  if (isBuilt() && _first == first && _stop == stop)
+    return kErrorOk;
+
+  reset();
+  if (!first || first == stop)
+    return DebugUtils::errored(kErrorInvalidArgument);
+
+  CBNode* node;
+  CBNode* prev;
+  uint32_t i, j;
+
+  // --------------------------------------------------------------------------
+  // [Blocks]
+  // --------------------------------------------------------------------------
+
+  uint32_t blockCount = 0;
+  prev = nullptr;
+
+  for (node = first; node != stop; node = node->getNext()) {
+    if (!prev || CBFlowGraph_endsBlock(prev) || CBFlowGraph_isLabel(node))
+      blockCount++;
+    prev = node;
+  }
+
+  uint32_t labelCount = static_cast<uint32_t>(cb->getCode()->getLabelsCount());
+
+  CBBlock* blocks = static_cast<CBBlock*>(zone->allocZeroed(blockCount * sizeof(CBBlock)));
+  CBBlock** rpo = zone->allocT<CBBlock*>(blockCount * sizeof(CBBlock*));
+  CBBlock** labelMap = static_cast<CBBlock**>(zone->allocZeroed((labelCount + 1) * sizeof(CBBlock*)));
+  uint32_t* scratch = zone->allocT<uint32_t>(blockCount * 3 * sizeof(uint32_t));
+
+  if (ASMJIT_UNLIKELY(!blocks || !rpo || !labelMap || !scratch))
+    return DebugUtils::errored(kErrorNoHeapMemory);
+
+  CBBlock* block = blocks - 1;
+  prev = nullptr;
+
+  for (node = first; node != stop; node = node->getNext()) {
+    if (!prev || CBFlowGraph_endsBlock(prev) || CBFlowGraph_isLabel(node)) {
+      block++;
+      block->_id = static_cast<uint32_t>(block - blocks);
+      block->_rpoIndex = kInvalidValue;
+      block->_first = node;
+
+      if (CBFlowGraph_isLabel(node)) {
+        size_t index = Operand::unpackId(static_cast<CBLabel*>(node)->getId());
+        if (index < labelCount)
+          labelMap[index] = block;
+      }
+    }
+
+    block->_last = node;
+    prev = node;
+  }
+
+  _first = first;
+  _stop = stop;
+  _blocks = blocks;
+  _rpo = rpo;
+  _labelMap = labelMap;
+  _blockCount = blockCount;
+  _labelCount = labelCount;
+
+  // --------------------------------------------------------------------------
+  // [Edges]
+  // --------------------------------------------------------------------------
+
+  uint32_t edgeCount = 0;
+  for (i = 0; i < blockCount; i++) {
+    block = &blocks[i];
+    node = block->_last;
+
+    if (node->isJmpOrJcc()) {
+      CBLabel* target = node->getType() == CBNode::kNodeInst ? static_cast<CBJump*>(node)->getTarget() : nullptr;
+      block->_succ[1] = target ? getBlockByLabel(target) : nullptr;
+    }
+    else if (CBFlowGraph_isReturn(node)) {
+      block->_flags |= CBBlock::kFlagReturns;
+    }
+
+    if (!node->isJmp() && !CBFlowGraph_isReturn(node) && i + 1 < blockCount)
+      block->_succ[0] = &blocks[i + 1];
+
+    for (j = 0; j < 2; j++)
+      if (block->_succ[j])
+        block->_succ[j]->_predCount++;
+  }
+
+  for (i = 0; i < blockCount; i++)
+    edgeCount += blocks[i]._predCount;
+
+  CBBlock** preds = zone->allocT<CBBlock*>((edgeCount + 1) * sizeof(CBBlock*));
+  if (ASMJIT_UNLIKELY(!preds))
+    return DebugUtils::errored(kErrorNoHeapMemory);
+
+  for (i = 0; i < blockCount; i++) {
+    blocks[i]._preds = preds;
+    preds += blocks[i]._predCount;
+    blocks[i]._predCount = 0;
+  }
+
+  for (i = 0; i < blockCount; i++) {
+    for (j = 0; j < 2; j++) {
+      CBBlock* succ = blocks[i]._succ[j];
+      if (succ)
+        succ->_preds[succ->_predCount++] = &blocks[i];
+    }
+  }
+
+  // --------------------------------------------------------------------------
+  // [Order]
+  // --------------------------------------------------------------------------
+
+  // Iterative DFS from the entry block, `rpo` is filled by the post-order
+  // from its end, so it becomes the reverse post-order.
+  uint32_t* stack = scratch;
+  uint32_t* stackIter = scratch + blockCount;
+  uint32_t sp = 0;
+  uint32_t rpoIndex = blockCount;
+
+  blocks[0]._flags |= CBBlock::kFlagReachable;
+  stack[0] = 0;
+  stackIter[0] = 0;
+
+  for (;;) {
+    block = &blocks[stack[sp]];
+
+    if (stackIter[sp] < 2) {
+      CBBlock* succ = block->_succ[stackIter[sp]++];
+      if (succ && !succ->isReachable()) {
+        succ->_flags |= CBBlock::kFlagReachable;
+        sp++;
+        stack[sp] = succ->_id;
+        stackIter[sp] = 0;
+      }
+      continue;
+    }
+
+    rpo[--rpoIndex] = block;
+    if (sp == 0) break;
+    sp--;
+  }
+
+  uint32_t rpoCount = blockCount - rpoIndex;
+  if (rpoIndex)
+    ::memmove(rpo, rpo + rpoIndex, rpoCount * sizeof(CBBlock*));
+
+  for (i = 0; i < rpoCount; i++)
+    rpo[i]->_rpoIndex = i;
+  _rpoCount = rpoCount;
+
+  // --------------------------------------------------------------------------
+  // [Dominators]
+  // --------------------------------------------------------------------------
+
+  // "A Simple, Fast Dominance Algorithm" by Cooper, Harvey, and Kennedy. The
+  // entry block temporarily dominates itself so the intersection terminates.
+  CBBlock* entry = rpo[0];
+  entry->_idom = entry;
+
+  bool changed;
+  do {
+    changed = false;
+    for (i = 1; i < rpoCount; i++) {
+      block = rpo[i];
+      CBBlock* idom = nullptr;
+
+      for (j = 0; j < block->_predCount; j++) {
+        CBBlock* pred = block->_preds[j];
+        if (!pred->_idom) continue;
+        idom = idom ? CBFlowGraph_intersect(pred, idom) : pred;
+      }
+
+      if (block->_idom != idom) {
+        block->_idom = idom;
+        changed = true;
+      }
+    }
+  } while (changed);
+  entry->_idom = nullptr;
+
+  // --------------------------------------------------------------------------
+  // [Loops]
+  // --------------------------------------------------------------------------
+
+  // Headers are processed in the reverse post-order, so an outer loop is
+  // processed before loops nested in it and the innermost header wins.
+  uint32_t* mark = scratch;
+  uint32_t* work = scratch + blockCount;
+  uint32_t* body = scratch + blockCount * 2;
+  ::memset(mark, 0, blockCount * sizeof(uint32_t));
+
+  for (i = 0; i < rpoCount; i++) {
+    CBBlock* header = rpo[i];
+    uint32_t stamp = i + 1;
+    uint32_t workCount = 0;
+    uint32_t bodyCount = 0;
+
+    mark[header->_id] = stamp;
+    body[bodyCount++] = header->_id;
+
+    for (j = 0; j < header->_predCount; j++) {
+      CBBlock* pred = header->_preds[j];
+      if (!pred->isReachable() || !dominates(header, pred)) continue;
+
+      header->_flags |= CBBlock::kFlagLoopHeader;
+      if (mark[pred->_id] != stamp) {
+        mark[pred->_id] = stamp;
+        work[workCount++] = pred->_id;
+        body[bodyCount++] = pred->_id;
+      }
+    }
+
+    if (!header->isLoopHeader())
+      continue;
+
+    while (workCount) {
+      block = &blocks[work[--workCount]];
+      for (j = 0; j < block->_predCount; j++) {
+        CBBlock* pred = block->_preds[j];
+        if (!pred->isReachable() || mark[pred->_id] == stamp) continue;
+
+        mark[pred->_id] = stamp;
+        work[workCount++] = pred->_id;
+        body[bodyCount++] = pred->_id;
+      }
+    }
+
+    header->_loopParent = header->_loopHeader;
+    for (j = 0; j < bodyCount; j++) {
+      block = &blocks[body[j]];
+      block->_loopDepth++;
+      block->_loopHeader = header;
+    }
+    _loopCount++;
+  }
+
+  return kErrorOk;
+}
+
+// ============================================================================
+// [asmjit::CBFlowGraph - Accessors]
+// ============================================================================
+
+CBBlock* CBFlowGraph::getBlockByLabel(const CBLabel* label) const noexcept {
+  size_t index = Operand::unpackId(label->getId());
+  return index < _labelCount ? _labelMap[index] : nullptr;
+}
+
+bool CBFlowGraph::dominates(const CBBlock* a, const CBBlock* b) const noexcept {
+  if (!a->isReachable() || !b->isReachable())
+    return false;
+
+  while (b && b->_rpoIndex >= a->_rpoIndex) {
+    if (b == a) return true;
+    b = b->_idom;
+  }
+  return false;
+}
+
+bool CBFlowGraph::isInLoop(const CBBlock* block, const CBBlock* header) const noexcept {
+  for (const CBBlock* h = block->_loopHeader; h; h = h->_loopParent)
+    if (h == header) return true;
+  return false;
+}
+
+} // asmjit namespace
+
+// [Api-End]
+#include "../asmjit_apiend.h"
+
+// [Guard]
+#endif // !ASMJIT_DISABLE_BUILDER
@@ -0,0 +1,231 @@
+// [AsmJit]
+// Complete x86/x64 JIT and Remote Assembler for C++.
+//
+// [License]
+// Zlib - See LICENSE.md file in the package.
+
+// [Guard]
+#ifndef _ASMJIT_BASE_FLOWGRAPH_H
+#define _ASMJIT_BASE_FLOWGRAPH_H
+
+#include "../asmjit_build.h"
+#if !defined(ASMJIT_DISABLE_BUILDER)
+
+// [Dependencies]
+#include "../base/codebuilder.h"
+
+// [Api-Begin]
+#include "../asmjit_apibegin.h"
+
+namespace asmjit {
+
+//! \addtogroup asmjit_base
+//! \{
+
+// ============================================================================
+// [asmjit::CBBlock]
+// ============================================================================
+
+//! Basic block of \ref CBFlowGraph.
+//!
+//! A block is a range of nodes `[getFirst(), getLast()]` that is only entered
+//! at its first node and only left at its last node.
+class CBBlock {
+public:
+  ASMJIT_NONCOPYABLE(CBBlock)
+
+  //! Block flags.
+  ASMJIT_ENUM(Flags) {
+    kFlagReachable  = 0x00000001U,       //!< Block is reachable from the entry block.
+    kFlagLoopHeader = 0x00000002U,       //!< Block is a target of a back-edge.
+    kFlagReturns    = 0x00000004U        //!< Block ends with a returning node.
+  };
+
+  // --------------------------------------------------------------------------
+  // [Accessors]
+  // --------------------------------------------------------------------------
+
+  //! Get the block index, blocks are indexed in the order of nodes.
+  ASMJIT_INLINE uint32_t getId() const noexcept { return _id; }
+  //! Get the index of the block in the reverse post-order, or `kInvalidValue` if unreachable.
+  ASMJIT_INLINE uint32_t getRPOIndex() const noexcept { return _rpoIndex; }
+  //! Get block flags, see \ref Flags.
+  ASMJIT_INLINE uint32_t getFlags() const noexcept { return _flags; }
+  //! Get whether the block has `flag`.
+  ASMJIT_INLINE bool hasFlag(uint32_t flag) const noexcept { return (_flags & flag) != 0; }
+
+  //! Get whether the block is reachable from the entry block.
+  ASMJIT_INLINE bool isReachable() const noexcept { return hasFlag(kFlagReachable); }
+  //! Get whether the block is a loop header.
+  ASMJIT_INLINE bool isLoopHeader() const noexcept { return hasFlag(kFlagLoopHeader); }
+
+  //! Get the first node of the block.
+  ASMJIT_INLINE CBNode* getFirst() const noexcept { return _first; }
+  //! Get the last node of the block.
+  ASMJIT_INLINE CBNode* getLast() const noexcept { return _last; }
+
+  //! Get the fall-through successor, or null.
+  ASMJIT_INLINE CBBlock* getFallThrough() const noexcept { return _succ[0]; }
+  //! Get the jump successor, or null.
+  ASMJIT_INLINE CBBlock* getJumpTarget() const noexcept { return _succ[1]; }
+  //! Get successor `i` (0 is the fall-through, 1 is the jump target), or null.
+  ASMJIT_INLINE CBBlock* getSuccessor(uint32_t i) const noexcept {
+    ASMJIT_ASSERT(i < 2);
+    return _succ[i];
+  }
+
+  //! Get the count of predecessors.
+  ASMJIT_INLINE uint32_t getPredecessorCount() const noexcept { return _predCount; }
+  //! Get predecessor at `i`.
+  ASMJIT_INLINE CBBlock* getPredecessor(uint32_t i) const noexcept {
+    ASMJIT_ASSERT(i < _predCount);
+    return _preds[i];
+  }
+
+  //! Get the immediate dominator, null for the entry block and unreachable blocks.
+  ASMJIT_INLINE CBBlock* getIDom() const noexcept { return _idom; }
+
+  //! Get the count of loops that contain the block.
+  ASMJIT_INLINE uint32_t getLoopDepth() const noexcept { return _loopDepth; }
+  //! Get the header of the innermost loop that contains the block, or null.
+  ASMJIT_INLINE CBBlock* getLoopHeader() const noexcept { return _loopHeader; }
+  //! Get the header of the loop that contains the loop of this header, or null.
+  ASMJIT_INLINE CBBlock* getLoopParent() const noexcept { return _loopParent; }
+
+  // --------------------------------------------------------------------------
+  // [Members]
+  // --------------------------------------------------------------------------
+
+  uint32_t _id;                          //!< Block index.
+  uint32_t _rpoIndex;                    //!< Index in the reverse post-order.
+  uint32_t _flags;                       //!< Block flags.
+  uint32_t _loopDepth;                   //!< Count of loops that contain the block.
+
+  CBNode* _first;                        //!< First node.
+  CBNode* _last;                         //!< Last node.
+
+  CBBlock* _succ[2];                     //!< Fall-through and jump successors.
+  CBBlock** _preds;                      //!< Predecessors.
+  uint32_t _predCount;                   //!< Count of predecessors.
+
+  CBBlock* _idom;                        //!< Immediate dominator.
+  CBBlock* _loopHeader;                  //!< Header of the innermost loop.
+  CBBlock* _loopParent;                  //!< Header of the enclosing loop (loop headers only).
+};
+
+// ============================================================================
+// [asmjit::CBFlowGraph]
+// ============================================================================
+
+//! Control flow graph of a range of \ref CodeBuilder nodes.
+//!
+//! The graph splits nodes into basic blocks, links them, and computes their
+//! reverse post-order, dominators, and natural loops:
+//!
+//!   - A block starts at a label (or \ref CCFunc), at the first node, and
+//!     after a jump or a returning node.
+//!   - Jumps are recognized by `CBNode::kFlagIsJmp` and `CBNode::kFlagIsJcc`
+//!     (set by \ref CodeCompiler), jumps without a known target only end the
+//!     block.
+//!   - `CBNode::kNodeFuncExit`, `CBNode::kNodeSentinel`, and nodes flagged by
+//!     `CBNode::kFlagIsRet` return, so their blocks have no successors.
+//!   - A back-edge is an edge to a block that dominates its source, all back
+//!     edges to the same header form a single loop.
+//!
+//! All data is allocated by the `Zone` passed to \ref build(), which must
+//! outlive the graph. The graph is cached, `build()` of the same range does
+//! nothing until \ref reset() is called, so passes can share a single graph
+//! as long as none of them changes the flow.
+class CBFlowGraph {
+public:
+  ASMJIT_NONCOPYABLE(CBFlowGraph)
+
+  // --------------------------------------------------------------------------
+  // [Construction / Destruction]
+  // --------------------------------------------------------------------------
+
+  ASMJIT_API CBFlowGraph() noexcept;
+  ASMJIT_API ~CBFlowGraph() noexcept;
+
+  // --------------------------------------------------------------------------
+  // [Reset]
+  // --------------------------------------------------------------------------
+
+  //! Reset the graph, the memory is released with the `Zone`.
+  ASMJIT_API void reset() noexcept;
+
+  // --------------------------------------------------------------------------
+  // [Build]
+  // --------------------------------------------------------------------------
+
+  //! Build the graph of nodes from `first` to `stop` (exclusive) of `cb`.
+  ASMJIT_API Error build(CodeBuilder* cb, Zone* zone, CBNode* first, CBNode* stop) noexcept;
+
+  // --------------------------------------------------------------------------
+  // [Accessors]
+  // --------------------------------------------------------------------------
+
+  //! Get whether the graph has been built.
+  ASMJIT_INLINE bool isBuilt() const noexcept { return _first != nullptr; }
+  //! Get the first node of the graph.
+  ASMJIT_INLINE CBNode* getFirst() const noexcept { return _first; }
+  //! Get the stop node of the graph (not part of it).
+  ASMJIT_INLINE CBNode* getStop() const noexcept { return _stop; }
+
+  //! Get the count of all blocks.
+  ASMJIT_INLINE uint32_t getBlockCount() const noexcept { return _blockCount; }
+  //! Get block at `i` (blocks are in the order of nodes).
+  ASMJIT_INLINE CBBlock* getBlock(uint32_t i) const noexcept {
+    ASMJIT_ASSERT(i < _blockCount);
+    return &_blocks[i];
+  }
+  //! Get the entry block, or null if the graph is empty.
+  ASMJIT_INLINE CBBlock* getEntryBlock() const noexcept { return _blockCount ? _blocks : nullptr; }
+
+  //! Get the count of reachable blocks.
+  ASMJIT_INLINE uint32_t getRPOCount() const noexcept { return _rpoCount; }
+  //! Get reachable block at `i` of the reverse post-order.
+  ASMJIT_INLINE CBBlock* getRPOBlock(uint32_t i) const noexcept {
+    ASMJIT_ASSERT(i < _rpoCount);
+    return _rpo[i];
+  }
+
+  //! Get the count of loops.
+  ASMJIT_INLINE uint32_t getLoopCount() const noexcept { return _loopCount; }
+
+  //! Get the block that starts at `label`, or null if it's not part of the graph.
+  ASMJIT_API CBBlock* getBlockByLabel(const CBLabel* label) const noexcept;
+
+  //! Get whether block `a` dominates block `b` (each block dominates itself).
+  ASMJIT_API bool dominates(const CBBlock* a, const CBBlock* b) const noexcept;
+
+  //! Get whether `block` is part of the loop of `header`.
+  ASMJIT_API bool isInLoop(const CBBlock* block, const CBBlock* header) const noexcept;
+
+  // --------------------------------------------------------------------------
+  // [Members]
+  // --------------------------------------------------------------------------
+
+  CBNode* _first;                        //!< First node.
+  CBNode* _stop;                         //!< Stop node.
+
+  CBBlock* _blocks;                      //!< Blocks in the order of nodes.
+  CBBlock** _rpo;                        //!< Reachable blocks in the reverse post-order.
+  CBBlock** _labelMap;                   //!< Blocks indexed by label ids.
+
+  uint32_t _blockCount;                  //!< Count of blocks.
+  uint32_t _rpoCount;                    //!< Count of reachable blocks.
+  uint32_t _labelCount;                  //!< Size of `_labelMap`.
+  uint32_t _loopCount;                   //!< Count of loops.
+};
+
+//! \}
+
+} // asmjit namespace
+
+// [Api-End]
+#include "../asmjit_apiend.h"
+
+// [Guard]
+#endif // !ASMJIT_DISABLE_BUILDER
+#endif // _ASMJIT_BASE_FLOWGRAPH_H
@@ -58,7 +58,10 @@ ASMJIT_FAVOR_SIZE Error FuncDetail::init(const FuncSignature& sign) {
   if (ASMJIT_UNLIKELY(argCount > kFuncArgCount))
     return DebugUtils::errored(kErrorInvalidArgument);
 
-  ASMJIT_PROPAGATE(cc.init(ccId));
+  if (sign.hasCustomCallConv())
+    cc = *sign.getCustomCallConv();
+  else
+    ASMJIT_PROPAGATE(cc.init(ccId));
 
   uint32_t gpSize = (cc.getArchType() == ArchInfo::kTypeX86) ? 4 : 8;
   uint32_t deabstractDelta = TypeId::deabstractDeltaOfSize(gpSize);
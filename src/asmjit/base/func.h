@@ -115,6 +115,8 @@ struct CallConv {
     kIdArm32SoftFP = 48,
     //! Modern calling convention, uses VFP registers to pass floating point arguments.
     kIdArm32HardFP = 49,
+    //! AArch64 calling convention (AAPCS64).
+    kIdArm64 = 50,
 
     // ------------------------------------------------------------------------
     // [Internal]
@@ -127,7 +129,7 @@ struct CallConv {
     _kIdX64End = 47,    //!< \internal
 
     _kIdArmStart = 48,  //!< \internal
-    _kIdArmEnd = 49,    //!< \internal
+    _kIdArmEnd = 50,    //!< \internal
 
     // ------------------------------------------------------------------------
     // [Host]
@@ -181,6 +183,11 @@ struct CallConv {
     kIdHostCDecl     = kIdHost, // Doesn't exist, redirected to host.
     kIdHostStdCall   = kIdHost, // Doesn't exist, redirected to host.
     kIdHostFastCall  = kIdHost  // Doesn't exist, redirected to host.
+#elif ASMJIT_ARCH_ARM64
+    kIdHost          = kIdArm64,
+    kIdHostCDecl     = kIdHost, // Doesn't exist, redirected to host.
+    kIdHostStdCall   = kIdHost, // Doesn't exist, redirected to host.
+    kIdHostFastCall  = kIdHost  // Doesn't exist, redirected to host.
 #else
 # error "[asmjit] Couldn't determine the target's calling convention."
 #endif
@@ -210,7 +217,8 @@ struct CallConv {
   //! Internal limits of AsmJit/CallConv.
   ASMJIT_ENUM(Limits) {
     kMaxVRegKinds        = Globals::kMaxVRegKinds,
-    kNumRegArgsPerKind   = 8
+    kNumRegArgsPerKind   = 16,
+    kNumRetRegsPerKind   = 2
   };
 
   //! Passed registers' order.
@@ -235,6 +243,7 @@ struct CallConv {
   ASMJIT_INLINE void reset() noexcept {
     ::memset(this, 0, sizeof(*this));
     ::memset(_passedOrder, 0xFF, sizeof(_passedOrder));
+    ::memset(_retOrder, 0xFF, sizeof(_retOrder));
   }
 
   // --------------------------------------------------------------------------
@@ -307,6 +316,8 @@ struct CallConv {
 
     _passedOrder[kind].packed[0] = p0;
     _passedOrder[kind].packed[1] = p1;
+    _passedOrder[kind].packed[2] = ASMJIT_PACK32_4x8(0xFF, 0xFF, 0xFF, 0xFF);
+    _passedOrder[kind].packed[3] = ASMJIT_PACK32_4x8(0xFF, 0xFF, 0xFF, 0xFF);
   }
 
   ASMJIT_INLINE void setPassedToNone(uint32_t kind) noexcept {
@@ -317,6 +328,26 @@ struct CallConv {
     _passedRegs[kind] = 0;
   }
 
+  //! Set up to `kNumRegArgsPerKind` registers of `kind` used to pass arguments.
+  //!
+  //! Unlike the other overload this makes it possible to pass more than 8
+  //! arguments of the same kind in registers, which is useful for custom
+  //! calling conventions used only by JIT-to-JIT calls.
+  ASMJIT_INLINE void setPassedOrder(uint32_t kind, const uint8_t* ids, uint32_t count) noexcept {
+    ASMJIT_ASSERT(kind < kMaxVRegKinds);
+    ASMJIT_ASSERT(count <= kNumRegArgsPerKind);
+
+    uint32_t regs = 0;
+    setPassedToNone(kind);
+
+    for (uint32_t i = 0; i < count; i++) {
+      ASMJIT_ASSERT(ids[i] < 32);
+      _passedOrder[kind].id[i] = ids[i];
+      regs |= 1U << ids[i];
+    }
+    _passedRegs[kind] = regs;
+  }
+
   ASMJIT_INLINE void setPassedOrder(uint32_t kind, uint32_t a0, uint32_t a1 = 0xFF, uint32_t a2 = 0xFF, uint32_t a3 = 0xFF, uint32_t a4 = 0xFF, uint32_t a5 = 0xFF, uint32_t a6 = 0xFF, uint32_t a7 = 0xFF) noexcept {
     ASMJIT_ASSERT(kind < kMaxVRegKinds);
 
@@ -347,6 +378,23 @@ struct CallConv {
     _preservedRegs[kind] = regs;
   }
 
+  //! Get registers of `kind` used to return a value, `0xFF` means the default
+  //! register defined by the ABI.
+  ASMJIT_INLINE const uint8_t* getRetOrder(uint32_t kind) const noexcept {
+    ASMJIT_ASSERT(kind < kMaxVRegKinds);
+    return _retOrder[kind];
+  }
+
+  //! Set registers of `kind` used to return a value, overriding the ABI.
+  //!
+  //! The second register is only used by values returned in two registers,
+  //! like 64-bit integers in 32-bit mode.
+  ASMJIT_INLINE void setRetOrder(uint32_t kind, uint32_t r0, uint32_t r1 = 0xFF) noexcept {
+    ASMJIT_ASSERT(kind < kMaxVRegKinds);
+    _retOrder[kind][0] = static_cast<uint8_t>(r0);
+    _retOrder[kind][1] = static_cast<uint8_t>(r1);
+  }
+
   // --------------------------------------------------------------------------
   // [Members]
   // --------------------------------------------------------------------------
@@ -363,6 +411,7 @@ struct CallConv {
   RegOrder _passedOrder[kMaxVRegKinds];  //!< Passed registers' order, per kind.
   uint32_t _passedRegs[kMaxVRegKinds];   //!< Mask of all passed registers, per kind.
   uint32_t _preservedRegs[kMaxVRegKinds];//!< Mask of all preserved registers, per kind.
+  uint8_t _retOrder[kMaxVRegKinds][kNumRetRegsPerKind]; //!< Return registers, per kind (0xFF if default).
 };
 
 // ============================================================================
@@ -419,6 +468,7 @@ struct FuncSignature {
     _vaIndex = kNoVarArgs;
     _ret = ret;
     _args = args;
+    _customCallConv = nullptr;
   }
 
   ASMJIT_INLINE void reset() noexcept {
@@ -432,6 +482,23 @@ struct FuncSignature {
   //! Get the function's calling convention.
   ASMJIT_INLINE uint32_t getCallConv() const noexcept { return _callConv; }
 
+  //! Get whether the function uses a custom calling convention.
+  ASMJIT_INLINE bool hasCustomCallConv() const noexcept { return _customCallConv != nullptr; }
+  //! Get the custom calling convention, or null.
+  ASMJIT_INLINE const CallConv* getCustomCallConv() const noexcept { return _customCallConv; }
+
+  //! Use a custom calling convention `cc` instead of the one given by id.
+  //!
+  //! The `cc` is usually initialized by `CallConv::init()` and then modified
+  //! (passed, returned and preserved registers), it must outlive the signature
+  //! and all \ref FuncDetail instances initialized from it are copies. Such
+  //! convention isn't ABI compatible, so it should only be used by JIT-to-JIT
+  //! calls where both the function and the call use the same signature.
+  ASMJIT_INLINE void setCustomCallConv(const CallConv* cc) noexcept {
+    _customCallConv = cc;
+    if (cc) _callConv = static_cast<uint8_t>(cc->getId());
+  }
+
   //! Get if the function has variable number of arguments (...).
   ASMJIT_INLINE bool hasVarArgs() const noexcept { return _vaIndex != kNoVarArgs; }
   //! Get the variable arguments (...) index, `kNoVarArgs` if none.
@@ -461,6 +528,7 @@ struct FuncSignature {
   uint8_t _vaIndex;                      //!< Index to a first vararg or `kNoVarArgs`.
   uint8_t _ret;                          //!< TypeId of a return value.
   const uint8_t* _args;                  //!< TypeIds of function arguments.
+  const CallConv* _customCallConv;       //!< Custom calling convention or null.
 };
 
 // ============================================================================
@@ -615,6 +683,7 @@ public:
   ASMJIT_INLINE void setCallConv(uint32_t ccId) noexcept {
     ASMJIT_ASSERT(ccId <= 0xFF);
     _callConv = static_cast<uint8_t>(ccId);
+    _customCallConv = nullptr;
   }
 
   //! Set the return type to `retType`.
@@ -1066,6 +1135,8 @@ struct FuncFrameLayout {
   ASMJIT_INLINE bool hasDsaSlotUsed() const noexcept { return static_cast<bool>(_dsaSlotUsed); }
   ASMJIT_INLINE bool hasAlignedVecSR() const noexcept { return static_cast<bool>(_alignedVecSR); }
   ASMJIT_INLINE bool hasDynamicAlignment() const noexcept { return static_cast<bool>(_dynamicAlignment); }
+  //! Get if the function keeps its stack in the red zone (stack offsets are negative).
+  ASMJIT_INLINE bool hasRedZoneUsed() const noexcept { return static_cast<bool>(_redZoneUsed); }
 
   ASMJIT_INLINE bool hasMmxCleanup() const noexcept { return static_cast<bool>(_mmxCleanup); }
   ASMJIT_INLINE bool hasAvxCleanup() const noexcept { return static_cast<bool>(_avxCleanup); }
@@ -1114,6 +1185,7 @@ struct FuncFrameLayout {
   uint32_t _dsaSlotUsed : 1;             //!< True if `_dsaSlot` contains a valid memory slot/offset.
   uint32_t _alignedVecSR : 1;            //!< Use instructions that perform aligned ops to save/restore XMM regs.
   uint32_t _dynamicAlignment : 1;        //!< Function must dynamically align the stack.
+  uint32_t _redZoneUsed : 1;             //!< Function stack is in the red zone (no stack adjustment).
 
   uint32_t _mmxCleanup : 1;              //!< Emit 'emms' in epilog (X86).
   uint32_t _avxCleanup : 1;              //!< Emit 'vzeroupper' in epilog (X86).
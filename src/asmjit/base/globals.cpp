@@ -78,6 +78,12 @@ static const char errorMessages[] =
   "No more physical registers\0"
   "Overlapped registers\0"
   "Overlapping register and arguments base-address register\0"
+  "File I/O failed\0"
+  "Invalid section\0"
+  "Section already exists\0"
+  "Invalid syntax\0"
+  "Missing CPU feature\0"
+  "Quota exceeded\0"
   "Unknown error\0";
 #endif // ASMJIT_DISABLE_TEXT
 
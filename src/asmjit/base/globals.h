@@ -221,6 +221,23 @@ ASMJIT_ENUM(ErrorCode) {
   //! Invalid register to hold stack arguments offset.
   kErrorOverlappingStackRegWithRegArg,
 
+  //! Reading or writing a file failed (\ref JitCache).
+  kErrorFileIo,
+
+  //! Invalid section or section name.
+  kErrorInvalidSection,
+  //! Section of the same name already exists.
+  kErrorSectionAlreadyExists,
+
+  //! Invalid syntax of a textual input (\ref X86Parser).
+  kErrorInvalidSyntax,
+
+  //! Code requires a CPU feature not present in its target feature set (\ref X86FuncDispatcher).
+  kErrorMissingCpuFeature,
+
+  //! Memory quota of a tenant exceeded (\ref JitTenant).
+  kErrorQuotaExceeded,
+
   //! Count of AsmJit error codes.
   kErrorCount
 };
@@ -9,7 +9,7 @@
 
 // [Guard]
 #include "../asmjit_build.h"
-#if defined(ASMJIT_BUILD_X86)
+#if defined(ASMJIT_BUILD_X86) || defined(ASMJIT_BUILD_ARM)
 
 // [Dependencies]
 #include "../base/arch.h"
@@ -66,6 +66,16 @@ Error Inst::checkFeatures(uint32_t archType, const Detail& detail, const Operand
 
   return DebugUtils::errored(kErrorInvalidArch);
 }
+
+Error Inst::validateFeatures(uint32_t archType, const Detail& detail, const Operand_* operands, uint32_t count, const CpuFeatures& features) noexcept {
+  CpuFeatures required;
+  ASMJIT_PROPAGATE(checkFeatures(archType, detail, operands, count, required));
+
+  if (ASMJIT_UNLIKELY(!features.hasAll(required)))
+    return DebugUtils::errored(kErrorMissingCpuFeature);
+
+  return kErrorOk;
+}
 #endif // !defined(ASMJIT_DISABLE_EXTENSIONS)
 
 } // asmjit namespace
@@ -74,4 +84,4 @@ Error Inst::checkFeatures(uint32_t archType, const Detail& detail, const Operand
 #include "../asmjit_apiend.h"
 
 // [Guard]
-#endif // ASMJIT_BUILD_X86
+#endif // ASMJIT_BUILD_X86 || ASMJIT_BUILD_ARM
@@ -94,6 +94,10 @@ struct Inst {
 #if !defined(ASMJIT_DISABLE_EXTENSIONS)
   //! Check CPU features required to execute the given instruction.
   ASMJIT_API static Error checkFeatures(uint32_t archType, const Detail& detail, const Operand_* operands, uint32_t count, CpuFeatures& out) noexcept;
+
+  //! Check that the given instruction only requires CPU features provided
+  //! by `features`, returns `kErrorMissingCpuFeature` if it doesn't.
+  ASMJIT_API static Error validateFeatures(uint32_t archType, const Detail& detail, const Operand_* operands, uint32_t count, const CpuFeatures& features) noexcept;
 #endif // !defined(ASMJIT_DISABLE_EXTENSIONS)
 };
 
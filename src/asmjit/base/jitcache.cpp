@@ -0,0 +1,462 @@
+// [AsmJit]
+// Complete x86/x64 JIT and Remote Assembler for C++.
+//
+// [License]
+// Zlib - See LICENSE.md file in the package.
+
+// [Export]
+#define ASMJIT_EXPORTS
+
+// [Dependencies]
+#include "../base/jitcache.h"
+#include "../base/jittest_p.h"
+#include "../base/utils.h"
+
+// [Api-Begin]
+#include "../asmjit_apibegin.h"
+
+namespace asmjit {
+
+// ============================================================================
+// [asmjit::JitCache - Format]
+// ============================================================================
+
+//! \internal
+//!
+//! Header of the cache file.
+struct JitCacheHeader {
+  char magic[8];                         //!< Magic, "AsmJitC\0".
+  uint32_t version;                      //!< Version, see `JitCache::kVersion`.
+  uint32_t archSignature;                //!< Architecture signature, see \ref ArchInfo.
+};
+
+//! \internal
+//!
+//! Record of a single entry, followed by the code (padded to 8 bytes) and
+//! `relocCount` relocations.
+struct JitCacheRecord {
+  uint64_t key;                          //!< Key of the entry.
+  uint64_t hash;                         //!< Hash of the content, see `JitCache::hashCode()`.
+  uint32_t codeSize;                     //!< Size of the code.
+  uint32_t trampolinesSize;              //!< Size reserved for trampolines.
+  uint32_t relocCount;                   //!< Number of relocations.
+  uint32_t reserved;                     //!< Reserved, always zero.
+};
+
+//! \internal
+//!
+//! Relocation stored in a record, see \ref RelocEntry.
+struct JitCacheReloc {
+  uint8_t type;                          //!< Type of the relocation.
+  uint8_t size;                          //!< Size of the relocation.
+  uint8_t reserved[6];                   //!< Reserved, always zero.
+  uint64_t sourceOffset;                 //!< Source offset.
+  uint64_t data;                         //!< Relocation data.
+};
+
+static const char JitCache_magic[8] = { 'A', 's', 'm', 'J', 'i', 't', 'C', '\0' };
+
+static ASMJIT_INLINE size_t JitCache_getRecordSize(const JitCacheRecord& record) noexcept {
+  return sizeof(JitCacheRecord) +
+         Utils::alignTo<size_t>(record.codeSize, 8) +
+         static_cast<size_t>(record.relocCount) * sizeof(JitCacheReloc);
+}
+
+//! \internal
+//!
+//! FNV-1a hash of `size` bytes of `data`.
+static ASMJIT_INLINE uint64_t JitCache_hashData(uint64_t hash, const void* data, size_t size) noexcept {
+  const uint8_t* p = static_cast<const uint8_t*>(data);
+  for (size_t i = 0; i < size; i++)
+    hash = (hash ^ p[i]) * ASMJIT_UINT64_C(0x100000001B3);
+  return hash;
+}
+
+template<typename T>
+static ASMJIT_INLINE uint64_t JitCache_hashValue(uint64_t hash, T value) noexcept {
+  return JitCache_hashData(hash, &value, sizeof(T));
+}
+
+// ============================================================================
+// [asmjit::JitCache - Construction / Destruction]
+// ============================================================================
+
+JitCache::JitCache(JitRuntime* runtime) noexcept
+  : _runtime(runtime),
+    _file(nullptr),
+    _data(nullptr),
+    _zone(8192 - Zone::kZoneOverhead),
+    _heap(&_zone),
+    _hitCount(0),
+    _missCount(0) {}
+
+JitCache::~JitCache() noexcept {
+  close();
+}
+
+// ============================================================================
+// [asmjit::JitCache - Open / Close]
+// ============================================================================
+
+Error JitCache::open(const char* fileName) noexcept {
+  close();
+
+  JitCacheHeader header;
+  ::memcpy(header.magic, JitCache_magic, sizeof(header.magic));
+  header.version = kVersion;
+  header.archSignature = _runtime->getCodeInfo().getArchInfo().getSignature();
+
+  // Read the whole file, all entries point to its content.
+  size_t size = 0;
+  size_t valid = 0;
+
+  FILE* file = ::fopen(fileName, "rb");
+  if (file) {
+    if (::fseek(file, 0, SEEK_END) == 0) {
+      long length = ::ftell(file);
+      if (length > 0 && ::fseek(file, 0, SEEK_SET) == 0) {
+        size = static_cast<size_t>(length);
+        _data = static_cast<uint8_t*>(Internal::allocMemory(size));
+
+        if (!_data) {
+          ::fclose(file);
+          return DebugUtils::errored(kErrorNoHeapMemory);
+        }
+
+        if (::fread(_data, 1, size, file) != size)
+          size = 0;
+      }
+    }
+    ::fclose(file);
+  }
+
+  if (size >= sizeof(JitCacheHeader) && ::memcmp(_data, &header, sizeof(JitCacheHeader)) == 0) {
+    valid = sizeof(JitCacheHeader);
+
+    // Stop at the first incomplete record, which can be the result of an
+    // interrupted `add()`.
+    while (size - valid >= sizeof(JitCacheRecord)) {
+      JitCacheRecord record;
+      ::memcpy(&record, _data + valid, sizeof(JitCacheRecord));
+
+      size_t recordSize = JitCache_getRecordSize(record);
+      if (recordSize > size - valid)
+        break;
+
+      Entry entry = { record.key, _data + valid };
+      Error err = _entries.append(&_heap, entry);
+      if (ASMJIT_UNLIKELY(err)) {
+        close();
+        return err;
+      }
+
+      valid += recordSize;
+    }
+  }
+
+  if (valid == size && valid != 0) {
+    _file = ::fopen(fileName, "ab");
+  }
+  else {
+    // The file doesn't exist, is not a cache file, or ends with an incomplete
+    // record - rewrite it with all valid records.
+    _file = ::fopen(fileName, "wb");
+    if (_file) {
+      if (valid == 0) {
+        if (::fwrite(&header, 1, sizeof(JitCacheHeader), _file) != sizeof(JitCacheHeader)) {
+          close();
+          return DebugUtils::errored(kErrorFileIo);
+        }
+      }
+      else if (::fwrite(_data, 1, valid, _file) != valid) {
+        close();
+        return DebugUtils::errored(kErrorFileIo);
+      }
+      ::fflush(_file);
+    }
+  }
+
+  if (!_file) {
+    close();
+    return DebugUtils::errored(kErrorFileIo);
+  }
+
+  return kErrorOk;
+}
+
+void JitCache::close() noexcept {
+  if (_file) {
+    ::fclose(_file);
+    _file = nullptr;
+  }
+
+  if (_data) {
+    Internal::releaseMemory(_data);
+    _data = nullptr;
+  }
+
+  _entries.reset();
+  _heap.reset(&_zone);
+  _zone.reset(true);
+}
+
+// ============================================================================
+// [asmjit::JitCache - Interface]
+// ============================================================================
+
+uint64_t JitCache::hashCode(const CodeHolder& code) noexcept {
+  const CodeBuffer& buffer = code.getSectionEntry(0)->getBuffer();
+  const ZoneVector<RelocEntry*>& relocations = code.getRelocEntries();
+
+  uint64_t hash = ASMJIT_UINT64_C(0xCBF29CE484222325);
+  hash = JitCache_hashValue<uint32_t>(hash, code.getArchInfo().getSignature());
+  hash = JitCache_hashValue<uint64_t>(hash, buffer.getLength());
+  hash = JitCache_hashData(hash, buffer.getData(), buffer.getLength());
+  hash = JitCache_hashValue<uint64_t>(hash, code.getTrampolinesSize());
+
+  for (size_t i = 0, count = relocations.getLength(); i < count; i++) {
+    const RelocEntry* re = relocations[i];
+    if (re->getType() == RelocEntry::kTypeNone)
+      continue;
+
+    hash = JitCache_hashValue<uint32_t>(hash, re->getType());
+    hash = JitCache_hashValue<uint32_t>(hash, re->getSize());
+    hash = JitCache_hashValue<uint64_t>(hash, re->getSourceOffset());
+    hash = JitCache_hashValue<uint64_t>(hash, re->getData());
+  }
+
+  return hash;
+}
+
+Error JitCache::_get(void** dst, uint64_t key) noexcept {
+  *dst = nullptr;
+
+  // The last entry of `key` wins, it was stored after the others.
+  const uint8_t* data = nullptr;
+  for (size_t i = _entries.getLength(); i != 0; i--) {
+    if (_entries[i - 1].key == key) {
+      data = _entries[i - 1].record;
+      break;
+    }
+  }
+
+  if (!data) {
+    _missCount++;
+    return kErrorOk;
+  }
+
+  JitCacheRecord record;
+  ::memcpy(&record, data, sizeof(JitCacheRecord));
+
+  const uint8_t* codeData = data + sizeof(JitCacheRecord);
+  const uint8_t* relocData = codeData + Utils::alignTo<size_t>(record.codeSize, 8);
+
+  // Rebuild the code in a `CodeHolder`, which is relocated by the runtime.
+  CodeHolder code;
+  ASMJIT_PROPAGATE(code.init(_runtime->getCodeInfo()));
+
+  CodeBuffer& buffer = code.getSectionEntry(0)->_buffer;
+  ASMJIT_PROPAGATE(code.reserveBuffer(&buffer, record.codeSize));
+
+  ::memcpy(buffer._data, codeData, record.codeSize);
+  buffer._length = record.codeSize;
+  code._trampolinesSize = record.trampolinesSize;
+
+  for (uint32_t i = 0; i < record.relocCount; i++) {
+    JitCacheReloc reloc;
+    ::memcpy(&reloc, relocData + i * sizeof(JitCacheReloc), sizeof(JitCacheReloc));
+
+    RelocEntry* re;
+    ASMJIT_PROPAGATE(code.newRelocEntry(&re, reloc.type, reloc.size));
+
+    re->_sourceSectionId = 0;
+    re->_targetSectionId = 0;
+    re->_sourceOffset = reloc.sourceOffset;
+    re->_data = reloc.data;
+  }
+
+  // A corrupted entry is a miss, the code will be stored again.
+  if (hashCode(code) != record.hash) {
+    _missCount++;
+    return kErrorOk;
+  }
+
+  ASMJIT_PROPAGATE(_runtime->add(dst, &code));
+  _hitCount++;
+  return kErrorOk;
+}
+
+Error JitCache::_add(void** dst, uint64_t key, CodeHolder* code) noexcept {
+  *dst = nullptr;
+
+  if (ASMJIT_UNLIKELY(!_file))
+    return DebugUtils::errored(kErrorNotInitialized);
+
+  if (ASMJIT_UNLIKELY(code->getArchInfo().getSignature() != _runtime->getCodeInfo().getArchInfo().getSignature()))
+    return DebugUtils::errored(kErrorInvalidArch);
+
+  if (ASMJIT_UNLIKELY(code->getUnresolvedLabelsCount() != 0))
+    return DebugUtils::errored(kErrorInvalidState);
+
+  size_t codeSize = code->getCodeSize();
+  if (ASMJIT_UNLIKELY(codeSize == 0))
+    return DebugUtils::errored(kErrorNoCodeGenerated);
+
+  // Only the first section is stored, other sections must be empty.
+  if (ASMJIT_UNLIKELY(codeSize != code->getSectionEntry(0)->getPhysicalSize() + code->getTrampolinesSize()))
+    return DebugUtils::errored(kErrorInvalidState);
+
+  const CodeBuffer& buffer = code->getSectionEntry(0)->getBuffer();
+  const ZoneVector<RelocEntry*>& relocations = code->getRelocEntries();
+
+  if (ASMJIT_UNLIKELY(buffer.getLength() > 0xFFFFFFFFU || code->getTrampolinesSize() > 0xFFFFFFFFU))
+    return DebugUtils::errored(kErrorCodeTooLarge);
+
+  JitCacheRecord record;
+  record.key = key;
+  record.hash = hashCode(*code);
+  record.codeSize = static_cast<uint32_t>(buffer.getLength());
+  record.trampolinesSize = static_cast<uint32_t>(code->getTrampolinesSize());
+  record.relocCount = 0;
+  record.reserved = 0;
+
+  size_t i;
+  size_t relocTotal = relocations.getLength();
+
+  for (i = 0; i < relocTotal; i++) {
+    const RelocEntry* re = relocations[i];
+    if (re->getType() == RelocEntry::kTypeNone)
+      continue;
+
+    // Only the first section is relocated by the runtime.
+    if (re->getSourceSectionId() != 0)
+      return DebugUtils::errored(kErrorInvalidRelocEntry);
+    record.relocCount++;
+  }
+
+  // Build the record in the zone, the entry points to it.
+  size_t recordSize = JitCache_getRecordSize(record);
+  uint8_t* data = static_cast<uint8_t*>(_zone.allocZeroed(recordSize));
+
+  if (ASMJIT_UNLIKELY(!data))
+    return DebugUtils::errored(kErrorNoHeapMemory);
+
+  ::memcpy(data, &record, sizeof(JitCacheRecord));
+  ::memcpy(data + sizeof(JitCacheRecord), buffer.getData(), record.codeSize);
+
+  uint8_t* relocData = data + sizeof(JitCacheRecord) + Utils::alignTo<size_t>(record.codeSize, 8);
+  for (i = 0; i < relocTotal; i++) {
+    const RelocEntry* re = relocations[i];
+    if (re->getType() == RelocEntry::kTypeNone)
+      continue;
+
+    JitCacheReloc reloc;
+    ::memset(&reloc, 0, sizeof(JitCacheReloc));
+
+    reloc.type = static_cast<uint8_t>(re->getType());
+    reloc.size = static_cast<uint8_t>(re->getSize());
+    reloc.sourceOffset = re->getSourceOffset();
+    reloc.data = re->getData();
+
+    ::memcpy(relocData, &reloc, sizeof(JitCacheReloc));
+    relocData += sizeof(JitCacheReloc);
+  }
+
+  Entry entry = { key, data };
+  ASMJIT_PROPAGATE(_entries.willGrow(&_heap));
+
+  if (::fwrite(data, 1, recordSize, _file) != recordSize || ::fflush(_file) != 0)
+    return DebugUtils::errored(kErrorFileIo);
+
+  _entries.appendUnsafe(entry);
+  return _runtime->add(dst, code);
+}
+
+// ============================================================================
+// [asmjit::JitCache - Test]
+// ============================================================================
+
+#if defined(ASMJIT_TEST) && defined(ASMJIT_BUILD_X86) && (ASMJIT_ARCH_X86 || ASMJIT_ARCH_X64)
+UNIT(base_jitcache) {
+  typedef int (*Func)(void);
+  static const char fileName[] = "asmjit_test_jitcache.tmp";
+
+  JitRuntime rt;
+  Func fn;
+
+  ::remove(fileName);
+
+  {
+    JitCache cache(&rt);
+    INFO("Creating a new cache file");
+    EXPECT(cache.open(fileName) == kErrorOk,
+      "Failed to create '%s'", fileName);
+    EXPECT(cache.getEntryCount() == 0,
+      "A new cache should be empty");
+
+    EXPECT(cache.get(&fn, 1) == kErrorOk && fn == nullptr,
+      "An empty cache shouldn't find any entry");
+
+    CodeHolder code;
+    JitTest_initReturn(&code, rt, 42);
+
+    INFO("Storing a function");
+    EXPECT(cache.add(&fn, 1, &code) == kErrorOk,
+      "Failed to add a function to the cache");
+    EXPECT(fn() == 42,
+      "Function added to the cache returned a wrong value");
+    rt.release(fn);
+
+    CodeHolder other;
+    JitTest_initReturn(&other, rt, 7);
+    EXPECT(cache.add(&fn, 2, &other) == kErrorOk,
+      "Failed to add a function to the cache");
+    rt.release(fn);
+
+    EXPECT(JitCache::hashCode(code) != JitCache::hashCode(other),
+      "Different code should have a different hash");
+  }
+
+  {
+    JitCache cache(&rt);
+    INFO("Reopening the cache file");
+    EXPECT(cache.open(fileName) == kErrorOk,
+      "Failed to open '%s'", fileName);
+    EXPECT(cache.getEntryCount() == 2,
+      "The cache should have 2 entries, not %u", static_cast<unsigned int>(cache.getEntryCount()));
+
+    EXPECT(cache.get(&fn, 2) == kErrorOk && fn != nullptr,
+      "Failed to get a function from the cache");
+    EXPECT(fn() == 7,
+      "Function restored from the cache returned a wrong value");
+    rt.release(fn);
+
+    EXPECT(cache.get(&fn, 3) == kErrorOk && fn == nullptr,
+      "The cache shouldn't find a function that was never stored");
+    EXPECT(cache.getHitCount() == 1 && cache.getMissCount() == 1,
+      "The cache should have 1 hit and 1 miss");
+  }
+
+  {
+    INFO("Discarding a file which is not a cache file");
+    FILE* file = ::fopen(fileName, "wb");
+    EXPECT(file != nullptr,
+      "Failed to open '%s'", fileName);
+    ::fputs("Not a cache file", file);
+    ::fclose(file);
+
+    JitCache cache(&rt);
+    EXPECT(cache.open(fileName) == kErrorOk,
+      "Failed to open '%s'", fileName);
+    EXPECT(cache.getEntryCount() == 0,
+      "The cache should be empty");
+  }
+
+  ::remove(fileName);
+}
+#endif // ASMJIT_TEST && ASMJIT_BUILD_X86 && (ASMJIT_ARCH_X86 || ASMJIT_ARCH_X64)
+
+} // asmjit namespace
+
+// [Api-End]
+#include "../asmjit_apiend.h"
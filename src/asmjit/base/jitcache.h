@@ -0,0 +1,165 @@
+// [AsmJit]
+// Complete x86/x64 JIT and Remote Assembler for C++.
+//
+// [License]
+// Zlib - See LICENSE.md file in the package.
+
+// [Guard]
+#ifndef _ASMJIT_BASE_JITCACHE_H
+#define _ASMJIT_BASE_JITCACHE_H
+
+// [Dependencies]
+#include "../base/runtime.h"
+#include "../base/zone.h"
+
+// [Api-Begin]
+#include "../asmjit_apibegin.h"
+
+namespace asmjit {
+
+//! \addtogroup asmjit_base
+//! \{
+
+// ============================================================================
+// [asmjit::JitCache]
+// ============================================================================
+
+//! Persistent code cache of a \ref JitRuntime.
+//!
+//! JitCache stores the code of a \ref CodeHolder before it's relocated, which
+//! is the content of its first section, the size reserved for trampolines, and
+//! all \ref RelocEntry records, into a file. A function stored by `add()` can
+//! be added to the runtime by `get()` in another process without generating
+//! it again, `get()` only copies the code and relocates it.
+//!
+//! Functions are identified by a 64-bit key provided by the user. The key
+//! must describe everything the generated code depends on (the
+//! generator and its version, CPU features used, etc...) as the cache cannot
+//! know it without generating the code. This includes absolute addresses
+//! used by the code, which usually change between processes, so only code
+//! that doesn't call or reference absolute addresses is position-independent
+//! enough to be cached safely.
+//!
+//! The file is bound to the architecture of the runtime, a file created for
+//! another architecture, or a file that is not a cache file, is discarded by
+//! `open()`. Each entry contains a hash of its content (see `hashCode()`),
+//! which is verified before the entry is used.
+//!
+//! ~~~
+//! JitRuntime rt;
+//! JitCache cache(&rt);
+//! cache.open("kernels.cache");
+//!
+//! Func fn;
+//! cache.get(&fn, key);
+//!
+//! if (!fn) {
+//!   CodeHolder code;
+//!   code.init(rt.getCodeInfo());
+//!   // ... generate code ...
+//!   cache.add(&fn, key, &code);
+//! }
+//! ~~~
+class JitCache {
+public:
+  ASMJIT_NONCOPYABLE(JitCache)
+
+  //! Cache file version.
+  enum { kVersion = 1 };
+
+  // --------------------------------------------------------------------------
+  // [Construction / Destruction]
+  // --------------------------------------------------------------------------
+
+  //! Create a new `JitCache` that adds functions to `runtime`.
+  ASMJIT_API JitCache(JitRuntime* runtime) noexcept;
+  //! Destroy the `JitCache`, closes the cache file. Functions added through
+  //! the cache are owned by the runtime and stay valid.
+  ASMJIT_API ~JitCache() noexcept;
+
+  // --------------------------------------------------------------------------
+  // [Open / Close]
+  // --------------------------------------------------------------------------
+
+  //! Open the cache file `fileName`, it's created if it doesn't exist.
+  ASMJIT_API Error open(const char* fileName) noexcept;
+  //! Close the cache file and forget all entries.
+  ASMJIT_API void close() noexcept;
+
+  //! Get if the cache file is open.
+  ASMJIT_INLINE bool isOpen() const noexcept { return _file != nullptr; }
+
+  // --------------------------------------------------------------------------
+  // [Accessors]
+  // --------------------------------------------------------------------------
+
+  //! Get the associated runtime.
+  ASMJIT_INLINE JitRuntime* getRuntime() const noexcept { return _runtime; }
+
+  //! Get the number of entries in the cache.
+  ASMJIT_INLINE size_t getEntryCount() const noexcept { return _entries.getLength(); }
+  //! Get the number of functions added by `get()`.
+  ASMJIT_INLINE size_t getHitCount() const noexcept { return _hitCount; }
+  //! Get the number of calls to `get()` that didn't find a valid entry.
+  ASMJIT_INLINE size_t getMissCount() const noexcept { return _missCount; }
+
+  // --------------------------------------------------------------------------
+  // [Interface]
+  // --------------------------------------------------------------------------
+
+  //! Add a function cached under `key` to the runtime.
+  //!
+  //! If the cache doesn't have a valid entry of `key` then `dst` is set to
+  //! null and `kErrorOk` is returned.
+  template<typename Func>
+  ASMJIT_INLINE Error get(Func* dst, uint64_t key) noexcept {
+    return _get(Internal::ptr_cast<void**, Func*>(dst), key);
+  }
+
+  //! Store `code` under `key` and add it to the runtime, like \ref Runtime::add().
+  //!
+  //! Nothing is added to the runtime if the code couldn't be stored.
+  template<typename Func>
+  ASMJIT_INLINE Error add(Func* dst, uint64_t key, CodeHolder* code) noexcept {
+    return _add(Internal::ptr_cast<void**, Func*>(dst), key, code);
+  }
+
+  ASMJIT_API Error _get(void** dst, uint64_t key) noexcept;
+  ASMJIT_API Error _add(void** dst, uint64_t key, CodeHolder* code) noexcept;
+
+  //! Get a hash of the code, trampolines size, and relocations of `code`.
+  ASMJIT_API static uint64_t hashCode(const CodeHolder& code) noexcept;
+
+  // --------------------------------------------------------------------------
+  // [Members]
+  // --------------------------------------------------------------------------
+
+  //! \internal
+  //!
+  //! Cache entry, points to its record in the cache file data or zone.
+  struct Entry {
+    uint64_t key;                        //!< Key of the entry.
+    const uint8_t* record;               //!< Record data.
+  };
+
+  JitRuntime* _runtime;                  //!< Runtime used to add functions.
+  FILE* _file;                           //!< Cache file opened for appending.
+  uint8_t* _data;                        //!< Content of the cache file read by `open()`.
+
+  Zone _zone;                            //!< Zone used by entries and new records.
+  ZoneHeap _heap;                        //!< ZoneHeap that uses `_zone`.
+  ZoneVector<Entry> _entries;            //!< Entries, in the order they were stored.
+
+  size_t _hitCount;                      //!< Number of hits.
+  size_t _missCount;                     //!< Number of misses.
+};
+
+//! \}
+
+} // asmjit namespace
+
+// [Api-End]
+#include "../asmjit_apiend.h"
+
+// [Guard]
+#endif // _ASMJIT_BASE_JITCACHE_H
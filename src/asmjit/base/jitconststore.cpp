@@ -0,0 +1,232 @@
+// [AsmJit]
+// Complete x86/x64 JIT and Remote Assembler for C++.
+//
+// [License]
+// Zlib - See LICENSE.md file in the package.
+
+// [Export]
+#define ASMJIT_EXPORTS
+
+// [Dependencies]
+#include "../base/jitconststore.h"
+#include "../base/utils.h"
+
+// [Api-Begin]
+#include "../asmjit_apibegin.h"
+
+namespace asmjit {
+
+// ============================================================================
+// [asmjit::JitConstStore - Helpers]
+// ============================================================================
+
+namespace {
+
+//! \internal
+//!
+//! Only used to lookup an entry from `_byData`.
+class JitConstByData {
+public:
+  ASMJIT_INLINE JitConstByData(const void* data, size_t size, uint32_t hVal) noexcept
+    : data(data),
+      size(size),
+      hVal(hVal) {}
+
+  ASMJIT_INLINE bool matches(const JitConstStore::Entry* entry) const noexcept {
+    return entry->_hVal == hVal && entry->size == size && ::memcmp(entry->rx, data, size) == 0;
+  }
+
+  const void* data;
+  size_t size;
+  uint32_t hVal;
+};
+
+//! \internal
+//!
+//! Only used to lookup an entry from `_byAddress`.
+class JitConstByAddress {
+public:
+  ASMJIT_INLINE JitConstByAddress(const void* p, uint32_t hVal) noexcept
+    : p(p),
+      hVal(hVal) {}
+
+  ASMJIT_INLINE bool matches(const JitConstStore::AddressNode* node) const noexcept {
+    return node->entry->rx == p;
+  }
+
+  const void* p;
+  uint32_t hVal;
+};
+
+static ASMJIT_INLINE uint32_t JitConstStore_hashData(const void* data, size_t size) noexcept {
+  const uint8_t* p = static_cast<const uint8_t*>(data);
+  uint32_t hVal = static_cast<uint32_t>(size);
+
+  for (size_t i = 0; i < size; i++)
+    hVal = Utils::hashRound(hVal, p[i]);
+  return hVal;
+}
+
+static ASMJIT_INLINE uint32_t JitConstStore_hashAddress(const void* p) noexcept {
+  // Constants are aligned to at least 32 bytes, drop the bits that are zero.
+  uint64_t x = static_cast<uint64_t>((uintptr_t)p) >> 5;
+  return static_cast<uint32_t>(x ^ (x >> 32));
+}
+
+} // anonymous namespace
+
+// ============================================================================
+// [asmjit::JitConstStore - Construction / Destruction]
+// ============================================================================
+
+JitConstStore::JitConstStore(JitRuntime* runtime) noexcept
+  : _runtime(runtime),
+    _zone(8192 - Zone::kZoneOverhead),
+    _heap(&_zone),
+    _byData(&_heap),
+    _byAddress(&_heap),
+    _size(0) {}
+
+JitConstStore::~JitConstStore() noexcept {
+  VMemMgr* memMgr = _runtime->getMemMgr();
+
+  for (uint32_t i = 0; i < _byData._bucketsCount; i++) {
+    ZoneHashNode* node = _byData._data[i];
+    while (node) {
+      memMgr->release(const_cast<uint8_t*>(static_cast<Entry*>(node)->rx));
+      node = node->_hashNext;
+    }
+  }
+
+  _byData.reset(nullptr);
+  _byAddress.reset(nullptr);
+}
+
+// ============================================================================
+// [asmjit::JitConstStore - Accessors]
+// ============================================================================
+
+uint32_t JitConstStore::getRefCount(const void* p) const noexcept {
+  AutoLock locked(_lock);
+
+  AddressNode* node = _byAddress.get(JitConstByAddress(p, JitConstStore_hashAddress(p)));
+  return node ? node->entry->refCount : static_cast<uint32_t>(0);
+}
+
+// ============================================================================
+// [asmjit::JitConstStore - Interface]
+// ============================================================================
+
+Error JitConstStore::intern(const void** dst, const void* data, size_t size) noexcept {
+  *dst = nullptr;
+
+  if (ASMJIT_UNLIKELY(size == 0))
+    return DebugUtils::errored(kErrorInvalidArgument);
+
+  uint32_t hVal = JitConstStore_hashData(data, size);
+  AutoLock locked(_lock);
+
+  Entry* entry = _byData.get(JitConstByData(data, size, hVal));
+  if (entry) {
+    if (ASMJIT_UNLIKELY(entry->refCount == IntTraits<uint32_t>::maxValue()))
+      return DebugUtils::errored(kErrorInvalidState);
+
+    entry->refCount++;
+    *dst = entry->rx;
+    return kErrorOk;
+  }
+
+  entry = _heap.allocZeroedT<Entry>();
+  if (ASMJIT_UNLIKELY(!entry))
+    return DebugUtils::errored(kErrorNoHeapMemory);
+
+  void* rx;
+  void* rw;
+
+  VMemMgr* memMgr = _runtime->getMemMgr();
+  if (ASMJIT_UNLIKELY(memMgr->allocDual(&rx, &rw, size) != kErrorOk)) {
+    _heap.release(entry, sizeof(Entry));
+    return DebugUtils::errored(kErrorNoVirtualMemory);
+  }
+
+  ::memcpy(rw, data, size);
+
+  entry->_hVal = hVal;
+  entry->rx = static_cast<const uint8_t*>(rx);
+  entry->size = size;
+  entry->refCount = 1;
+  entry->addressNode._hVal = JitConstStore_hashAddress(rx);
+  entry->addressNode.entry = entry;
+
+  _byData.put(entry);
+  _byAddress.put(&entry->addressNode);
+  _size += size;
+
+  *dst = rx;
+  return kErrorOk;
+}
+
+Error JitConstStore::release(const void* p) noexcept {
+  AutoLock locked(_lock);
+
+  AddressNode* node = _byAddress.get(JitConstByAddress(p, JitConstStore_hashAddress(p)));
+  if (ASMJIT_UNLIKELY(!node))
+    return DebugUtils::errored(kErrorInvalidArgument);
+
+  Entry* entry = node->entry;
+  if (--entry->refCount != 0)
+    return kErrorOk;
+
+  _byAddress.del(node);
+  _byData.del(entry);
+  _size -= entry->size;
+
+  Error err = _runtime->getMemMgr()->release(const_cast<uint8_t*>(entry->rx));
+  _heap.release(entry, sizeof(Entry));
+  return err;
+}
+
+// ============================================================================
+// [asmjit::JitConstStore - Test]
+// ============================================================================
+
+#if defined(ASMJIT_TEST)
+UNIT(base_jitconststore) {
+  static const uint32_t maskA[4] = { 0x80000000U, 0x80000000U, 0x80000000U, 0x80000000U };
+  static const uint32_t maskB[4] = { 0x7FFFFFFFU, 0x7FFFFFFFU, 0x7FFFFFFFU, 0x7FFFFFFFU };
+  uint32_t copyA[4] = { 0x80000000U, 0x80000000U, 0x80000000U, 0x80000000U };
+
+  JitRuntime rt;
+  JitConstStore store(&rt);
+
+  const void* a0;
+  const void* a1;
+  const void* b0;
+
+  INFO("Interning constants");
+  EXPECT(store.intern(&a0, maskA, sizeof(maskA)) == kErrorOk);
+  EXPECT(store.intern(&b0, maskB, sizeof(maskB)) == kErrorOk);
+  EXPECT(store.intern(&a1, copyA, sizeof(copyA)) == kErrorOk);
+
+  EXPECT(a0 == a1 && a0 != b0,
+    "Identical constants should share the same address");
+  EXPECT(::memcmp(a0, maskA, sizeof(maskA)) == 0,
+    "Interned constant has a wrong content");
+  EXPECT(Utils::isAligned<uintptr_t>((uintptr_t)a0, 32),
+    "Interned constant is not aligned");
+  EXPECT(store.getCount() == 2 && store.getSize() == 32);
+  EXPECT(store.getRefCount(a0) == 2 && store.getRefCount(b0) == 1);
+
+  INFO("Releasing constants");
+  EXPECT(store.release(a0) == kErrorOk && store.getRefCount(a0) == 1);
+  EXPECT(store.release(b0) == kErrorOk && store.getRefCount(b0) == 0);
+  EXPECT(store.getCount() == 1 && store.getSize() == 16);
+  EXPECT(store.release(b0) != kErrorOk,
+    "Released constant shouldn't be released again");
+}
+#endif // ASMJIT_TEST
+
+} // asmjit namespace
+
+// [Api-End]
+#include "../asmjit_apiend.h"
@@ -0,0 +1,141 @@
+// [AsmJit]
+// Complete x86/x64 JIT and Remote Assembler for C++.
+//
+// [License]
+// Zlib - See LICENSE.md file in the package.
+
+// [Guard]
+#ifndef _ASMJIT_BASE_JITCONSTSTORE_H
+#define _ASMJIT_BASE_JITCONSTSTORE_H
+
+// [Dependencies]
+#include "../base/osutils.h"
+#include "../base/runtime.h"
+#include "../base/zone.h"
+
+// [Api-Begin]
+#include "../asmjit_apibegin.h"
+
+namespace asmjit {
+
+//! \addtogroup asmjit_base
+//! \{
+
+// ============================================================================
+// [asmjit::JitConstStore]
+// ============================================================================
+
+//! Store of constants shared by all functions of a \ref JitRuntime.
+//!
+//! Constants embedded into functions by \ref ConstPool are duplicated in
+//! every function that uses them. JitConstStore interns constants instead -
+//! each unique constant is stored only once, in virtual memory allocated by
+//! the runtime's \ref VMemMgr, so it's usually close enough to the code to be
+//! addressed by `[rip + rel32]` in 64-bit mode. The assembler encodes a memory
+//! operand that points to an absolute address which doesn't fit into 32 bits
+//! this way, and `JitRuntime::add()` fails if the distance exceeds 2GB.
+//!
+//! Each constant is reference counted, `intern()` adds a reference and
+//! `release()` removes it, the memory of the constant is released with the
+//! last reference. All constants are released when the store is destroyed.
+//! The store is thread-safe.
+//!
+//! ~~~
+//! JitRuntime rt;
+//! JitConstStore store(&rt);
+//!
+//! static const uint8_t mask[16] = { ... };
+//! const void* p;
+//! store.intern(&p, mask, 16);
+//!
+//! // ... use `x86::ptr((uint64_t)(uintptr_t)p)` in the generated code ...
+//!
+//! rt.release(fn);
+//! store.release(p);
+//! ~~~
+class JitConstStore {
+public:
+  ASMJIT_NONCOPYABLE(JitConstStore)
+
+  // --------------------------------------------------------------------------
+  // [Construction / Destruction]
+  // --------------------------------------------------------------------------
+
+  //! Create a new `JitConstStore` that allocates memory from `runtime`.
+  ASMJIT_API JitConstStore(JitRuntime* runtime) noexcept;
+  //! Destroy the `JitConstStore` and release all constants.
+  ASMJIT_API ~JitConstStore() noexcept;
+
+  // --------------------------------------------------------------------------
+  // [Accessors]
+  // --------------------------------------------------------------------------
+
+  //! Get the associated runtime.
+  ASMJIT_INLINE JitRuntime* getRuntime() const noexcept { return _runtime; }
+
+  //! Get the number of unique constants stored.
+  ASMJIT_INLINE size_t getCount() const noexcept { return _byData.getSize(); }
+  //! Get the number of bytes used by all unique constants.
+  ASMJIT_INLINE size_t getSize() const noexcept { return _size; }
+
+  //! Get the number of references of the constant `p`, zero if `p` is not a
+  //! constant of the store.
+  ASMJIT_API uint32_t getRefCount(const void* p) const noexcept;
+
+  // --------------------------------------------------------------------------
+  // [Interface]
+  // --------------------------------------------------------------------------
+
+  //! Store `size` bytes of `data` and return its address in `dst`.
+  //!
+  //! If an identical constant already exists then its reference count is
+  //! increased and its address is returned. The constant is aligned to at
+  //! least 32 bytes (the minimum alignment of \ref VMemMgr allocations).
+  ASMJIT_API Error intern(const void** dst, const void* data, size_t size) noexcept;
+
+  //! Release a reference of the constant `p` returned by `intern()`.
+  ASMJIT_API Error release(const void* p) noexcept;
+
+  // --------------------------------------------------------------------------
+  // [Members]
+  // --------------------------------------------------------------------------
+
+  //! \internal
+  struct Entry;
+
+  //! \internal
+  //!
+  //! Node that maps the address of a constant to its \ref Entry.
+  struct AddressNode : public ZoneHashNode {
+    Entry* entry;                        //!< The entry.
+  };
+
+  //! \internal
+  //!
+  //! Constant, hashed by its content.
+  struct Entry : public ZoneHashNode {
+    const uint8_t* rx;                   //!< Executable (read) view of the constant.
+    size_t size;                         //!< Size of the constant.
+    uint32_t refCount;                   //!< Number of references.
+    AddressNode addressNode;             //!< Node of `_byAddress`.
+  };
+
+  JitRuntime* _runtime;                  //!< Runtime used to allocate memory.
+  mutable Lock _lock;                    //!< Lock of all members.
+
+  Zone _zone;                            //!< Zone used by entries.
+  ZoneHeap _heap;                        //!< ZoneHeap that uses `_zone`.
+  ZoneHash<Entry> _byData;               //!< Entries hashed by their content.
+  ZoneHash<AddressNode> _byAddress;      //!< Entries hashed by their address.
+  size_t _size;                          //!< Size of all constants.
+};
+
+//! \}
+
+} // asmjit namespace
+
+// [Api-End]
+#include "../asmjit_apiend.h"
+
+// [Guard]
+#endif // _ASMJIT_BASE_JITCONSTSTORE_H
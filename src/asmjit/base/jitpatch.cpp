@@ -0,0 +1,602 @@
+// [AsmJit]
+// Complete x86/x64 JIT and Remote Assembler for C++.
+//
+// [License]
+// Zlib - See LICENSE.md file in the package.
+
+// [Export]
+#define ASMJIT_EXPORTS
+
+// [Dependencies]
+#include "../base/jitpatch.h"
+#include "../base/jittest_p.h"
+#include "../base/utils.h"
+
+// [Api-Begin]
+#include "../asmjit_apibegin.h"
+
+namespace asmjit {
+
+// ============================================================================
+// [asmjit::JitPatcher - Helpers]
+// ============================================================================
+
+//! \internal
+//!
+//! Alignment of code copied by `JitPatcher::compact()`.
+static const size_t kJitPatchCodeAlignment = 16;
+
+//! \internal
+//!
+//! Get the size that a movable site occupies in a \ref JitPatchBlock.
+static ASMJIT_INLINE size_t JitPatcher_getFootprint(const JitPatchSite* site) noexcept {
+  return Utils::alignTo<size_t>(site->codeSize, kJitPatchCodeAlignment);
+}
+
+#if ASMJIT_ARCH_X86 || ASMJIT_ARCH_X64
+//! \internal
+//!
+//! Get whether `target` can be reached by `jmp rel32` of the stub at `rx`.
+static ASMJIT_INLINE bool JitPatcher_inDirectRange(const uint8_t* rx, const void* target) noexcept {
+  int64_t rel = static_cast<int64_t>((intptr_t)target) - static_cast<int64_t>((intptr_t)(rx + 5));
+  return Utils::isInt32(rel);
+}
+
+//! \internal
+//!
+//! Get the first 8 bytes of a direct stub - `jmp rel32` followed by `int3`s.
+static ASMJIT_INLINE uint64_t JitPatcher_directQWord(const uint8_t* rx, const void* target) noexcept {
+  uint32_t rel = static_cast<uint32_t>((uintptr_t)target - (uintptr_t)(rx + 5));
+  return ASMJIT_UINT64_C(0xCCCCCC0000000000) | (static_cast<uint64_t>(rel) << 8) | 0xE9U;
+}
+
+//! \internal
+//!
+//! Store `target` to the stub at `rw` by a single atomic store.
+static ASMJIT_INLINE void JitPatcher_patch(JitPatchSite* site, void* target) noexcept {
+  if (site->kind == JitPatchSite::kKindDirect) {
+    OSUtils::atomicStore(reinterpret_cast<volatile uint64_t*>(site->rw), JitPatcher_directQWord(site->rx, target));
+  }
+  else {
+#if ASMJIT_ARCH_X64
+    OSUtils::atomicStore(reinterpret_cast<volatile uint64_t*>(site->rw + 8), static_cast<uint64_t>((uintptr_t)target));
+#else
+    OSUtils::atomicStore(reinterpret_cast<volatile uint32_t*>(site->rw + 8), static_cast<uint32_t>((uintptr_t)target));
+#endif
+  }
+  site->target = target;
+}
+#endif // ASMJIT_ARCH_X86 || ASMJIT_ARCH_X64
+
+// ============================================================================
+// [asmjit::JitPatcher - Construction / Destruction]
+// ============================================================================
+
+JitPatcher::JitPatcher(JitRuntime* runtime) noexcept
+  : _runtime(runtime),
+    _sites(nullptr) {}
+
+JitPatcher::~JitPatcher() noexcept {
+  VMemMgr* memMgr = _runtime->getMemMgr();
+  JitListener* listener = _runtime->getListener();
+
+  JitPatchSite* site = _sites;
+  while (site) {
+    JitPatchSite* next = site->next;
+    JitPatchBlock* block = site->block;
+
+    if (block) {
+      if (listener)
+        listener->onRelease(site->target);
+
+      if (--block->liveCount == 0) {
+        memMgr->release(block->rx);
+        Internal::releaseMemory(block);
+      }
+    }
+
+    memMgr->release(site->rx);
+    Internal::releaseMemory(site);
+    site = next;
+  }
+}
+
+// ============================================================================
+// [asmjit::JitPatcher - Accessors]
+// ============================================================================
+
+size_t JitPatcher::getSiteCount() const noexcept {
+  AutoLock locked(_lock);
+
+  size_t count = 0;
+  for (JitPatchSite* site = _sites; site; site = site->next)
+    count++;
+  return count;
+}
+
+// ============================================================================
+// [asmjit::JitPatcher - Sites]
+// ============================================================================
+
+Error JitPatcher::newSite(JitPatchSite** out, void* target, uint32_t kind) noexcept {
+  *out = nullptr;
+
+#if ASMJIT_ARCH_X86 || ASMJIT_ARCH_X64
+  if (ASMJIT_UNLIKELY(kind > JitPatchSite::kKindIndirect))
+    return DebugUtils::errored(kErrorInvalidArgument);
+
+  JitPatchSite* site = static_cast<JitPatchSite*>(Internal::allocMemory(sizeof(JitPatchSite)));
+  if (ASMJIT_UNLIKELY(!site))
+    return DebugUtils::errored(kErrorNoHeapMemory);
+
+  void* rx;
+  void* rw;
+  VMemMgr* memMgr = _runtime->getMemMgr();
+
+  if (ASMJIT_UNLIKELY(memMgr->allocDual(&rx, &rw, JitPatchSite::kStubSize) != kErrorOk)) {
+    Internal::releaseMemory(site);
+    return DebugUtils::errored(kErrorNoVirtualMemory);
+  }
+
+  // Patching relies on 8-byte aligned stubs, guaranteed by `VMemMgr`.
+  ASMJIT_ASSERT(Utils::isAligned<uintptr_t>((uintptr_t)rx, 8));
+
+  site->rx = static_cast<uint8_t*>(rx);
+  site->rw = static_cast<uint8_t*>(rw);
+  site->target = target;
+  site->block = nullptr;
+  site->codeSize = 0;
+
+  if (kind == JitPatchSite::kKindAuto)
+    kind = JitPatcher_inDirectRange(site->rx, target) ? JitPatchSite::kKindDirect : JitPatchSite::kKindIndirect;
+
+  if (kind == JitPatchSite::kKindDirect && !JitPatcher_inDirectRange(site->rx, target)) {
+    memMgr->release(rx);
+    Internal::releaseMemory(site);
+    return DebugUtils::errored(kErrorInvalidDisplacement);
+  }
+  site->kind = kind;
+
+  uint8_t* p = site->rw;
+  ::memset(p, 0xCC, JitPatchSite::kStubSize);
+
+  if (kind == JitPatchSite::kKindDirect) {
+    Utils::writeU64u(p, JitPatcher_directQWord(site->rx, target));
+  }
+  else {
+    // jmp [slot] - RIP-relative in 64-bit mode, absolute in 32-bit mode.
+    p[0] = 0xFF;
+    p[1] = 0x25;
+#if ASMJIT_ARCH_X64
+    Utils::writeU32u(p + 2, 2);
+    Utils::writeU64u(p + 8, static_cast<uint64_t>((uintptr_t)target));
+#else
+    Utils::writeU32u(p + 2, static_cast<uint32_t>((uintptr_t)(site->rx + 8)));
+    Utils::writeU32u(p + 8, static_cast<uint32_t>((uintptr_t)target));
+#endif
+  }
+  _runtime->flush(site->rx, JitPatchSite::kStubSize);
+
+  AutoLock locked(_lock);
+  site->prev = nullptr;
+  site->next = _sites;
+  if (_sites) _sites->prev = site;
+  _sites = site;
+
+  *out = site;
+  return kErrorOk;
+#else
+  ASMJIT_UNUSED(target);
+  ASMJIT_UNUSED(kind);
+  return DebugUtils::errored(kErrorInvalidArch);
+#endif
+}
+
+Error JitPatcher::newMovableSite(JitPatchSite** out, CodeHolder* code, uint32_t kind) noexcept {
+  *out = nullptr;
+
+  // Only relocations between sections of the code keep it valid when moved.
+  const ZoneVector<RelocEntry*>& relocations = code->getRelocEntries();
+  for (size_t i = 0, count = relocations.getLength(); i < count; i++) {
+    uint32_t type = relocations[i]->getType();
+    if (type != RelocEntry::kTypeNone && type != RelocEntry::kTypeRelToRel)
+      return DebugUtils::errored(kErrorInvalidRelocEntry);
+  }
+
+  JitPatchBlock* block = static_cast<JitPatchBlock*>(Internal::allocMemory(sizeof(JitPatchBlock)));
+  if (ASMJIT_UNLIKELY(!block))
+    return DebugUtils::errored(kErrorNoHeapMemory);
+
+  void* p;
+  Error err = _runtime->_add(&p, code);
+  if (ASMJIT_UNLIKELY(err)) {
+    Internal::releaseMemory(block);
+    return err;
+  }
+
+  JitPatchSite* site;
+  err = newSite(&site, p, kind);
+  if (ASMJIT_UNLIKELY(err)) {
+    _runtime->release(p);
+    Internal::releaseMemory(block);
+    return err;
+  }
+
+  AutoLock locked(_lock);
+  site->codeSize = code->getCodeSize();
+
+  block->rx = static_cast<uint8_t*>(p);
+  block->size = JitPatcher_getFootprint(site);
+  block->liveSize = block->size;
+  block->liveCount = 1;
+  site->block = block;
+
+  *out = site;
+  return kErrorOk;
+}
+
+Error JitPatcher::retarget(JitPatchSite* site, void* target) noexcept {
+#if ASMJIT_ARCH_X86 || ASMJIT_ARCH_X64
+  AutoLock locked(_lock);
+
+  if (ASMJIT_UNLIKELY(site->block))
+    return DebugUtils::errored(kErrorInvalidState);
+
+  if (site->kind == JitPatchSite::kKindDirect && !JitPatcher_inDirectRange(site->rx, target))
+    return DebugUtils::errored(kErrorInvalidDisplacement);
+
+  JitPatcher_patch(site, target);
+  _runtime->flush(site->rx, JitPatchSite::kStubSize);
+  return kErrorOk;
+#else
+  ASMJIT_UNUSED(site);
+  ASMJIT_UNUSED(target);
+  return DebugUtils::errored(kErrorInvalidArch);
+#endif
+}
+
+Error JitPatcher::releaseSite(JitPatchSite* site) noexcept {
+  JitPatchBlock* releasedBlock = nullptr;
+
+  {
+    AutoLock locked(_lock);
+    if (site->prev)
+      site->prev->next = site->next;
+    else
+      _sites = site->next;
+
+    if (site->next)
+      site->next->prev = site->prev;
+
+    JitPatchBlock* block = site->block;
+    if (block) {
+      JitListener* listener = _runtime->getListener();
+      if (listener)
+        listener->onRelease(site->target);
+
+      block->liveSize -= JitPatcher_getFootprint(site);
+      if (--block->liveCount == 0)
+        releasedBlock = block;
+    }
+  }
+
+  Error err = _runtime->_releaseDeferred(site->rx, false);
+  if (releasedBlock) {
+    Error blockErr = _runtime->_releaseDeferred(releasedBlock->rx, false);
+    if (!err) err = blockErr;
+    Internal::releaseMemory(releasedBlock);
+  }
+
+  Internal::releaseMemory(site);
+  return err;
+}
+
+// ============================================================================
+// [asmjit::JitPatcher - Compaction]
+// ============================================================================
+
+Error JitPatcher::compact(size_t* movedCount) noexcept {
+  if (movedCount)
+    *movedCount = 0;
+
+#if ASMJIT_ARCH_X86 || ASMJIT_ARCH_X64
+  AutoLock locked(_lock);
+
+  JitPatchSite* site;
+  JitPatchBlock* firstBlock = nullptr;
+  bool singleBlock = true;
+  size_t totalSize = 0;
+
+  for (site = _sites; site; site = site->next) {
+    if (!site->block) continue;
+
+    if (!firstBlock)
+      firstBlock = site->block;
+    else if (site->block != firstBlock)
+      singleBlock = false;
+    totalSize += JitPatcher_getFootprint(site);
+  }
+
+  // Nothing to move or the code already fills a single block.
+  if (!firstBlock || (singleBlock && firstBlock->liveSize == firstBlock->size))
+    return kErrorOk;
+
+  VMemMgr* memMgr = _runtime->getMemMgr();
+  JitListener* listener = _runtime->getListener();
+
+  JitPatchBlock* newBlock = static_cast<JitPatchBlock*>(Internal::allocMemory(sizeof(JitPatchBlock)));
+  if (ASMJIT_UNLIKELY(!newBlock))
+    return DebugUtils::errored(kErrorNoHeapMemory);
+
+  void* rx;
+  void* rw;
+  if (ASMJIT_UNLIKELY(memMgr->allocDual(&rx, &rw, totalSize) != kErrorOk)) {
+    Internal::releaseMemory(newBlock);
+    return DebugUtils::errored(kErrorNoVirtualMemory);
+  }
+
+  // Copy the code first and patch the sites once all copies are visible.
+  uint8_t* newRx = static_cast<uint8_t*>(rx);
+  uint8_t* newRw = static_cast<uint8_t*>(rw);
+  size_t offset = 0;
+
+  ::memset(newRw, 0xCC, totalSize);
+  for (site = _sites; site; site = site->next) {
+    if (!site->block) continue;
+    if (site->kind == JitPatchSite::kKindDirect && !JitPatcher_inDirectRange(site->rx, newRx + offset)) continue;
+
+    ::memcpy(newRw + offset, site->target, site->codeSize);
+    offset += JitPatcher_getFootprint(site);
+  }
+
+  if (offset == 0) {
+    memMgr->release(rx);
+    Internal::releaseMemory(newBlock);
+    return kErrorOk;
+  }
+
+  if (offset < totalSize)
+    memMgr->shrink(rx, offset);
+  _runtime->flush(rx, offset);
+
+  Error err = kErrorOk;
+  size_t moved = 0;
+
+  offset = 0;
+  for (site = _sites; site; site = site->next) {
+    JitPatchBlock* oldBlock = site->block;
+    if (!oldBlock) continue;
+
+    uint8_t* target = newRx + offset;
+    if (site->kind == JitPatchSite::kKindDirect && !JitPatcher_inDirectRange(site->rx, target)) continue;
+
+    size_t footprint = JitPatcher_getFootprint(site);
+    if (listener)
+      listener->onRelease(site->target);
+
+    JitPatcher_patch(site, target);
+    _runtime->flush(site->rx, JitPatchSite::kStubSize);
+
+    if (listener)
+      listener->onAdd(target, site->codeSize, nullptr);
+
+    site->block = newBlock;
+    offset += footprint;
+    moved++;
+
+    oldBlock->liveSize -= footprint;
+    if (--oldBlock->liveCount == 0) {
+      // Other threads may still execute the old code.
+      Error blockErr = _runtime->_releaseDeferred(oldBlock->rx, false);
+      if (!err) err = blockErr;
+      Internal::releaseMemory(oldBlock);
+    }
+  }
+
+  newBlock->rx = newRx;
+  newBlock->size = offset;
+  newBlock->liveSize = offset;
+  newBlock->liveCount = moved;
+
+  if (movedCount)
+    *movedCount = moved;
+  return err;
+#else
+  return DebugUtils::errored(kErrorInvalidArch);
+#endif
+}
+
+// ============================================================================
+// [asmjit::JitPatcher - Test]
+// ============================================================================
+
+#if defined(ASMJIT_TEST) && defined(ASMJIT_BUILD_X86) && (ASMJIT_ARCH_X86 || ASMJIT_ARCH_X64)
+typedef int (*JitPatchTestFunc)(void);
+
+static void* JitPatchTest_add(JitRuntime& rt, uint32_t value) noexcept {
+  CodeHolder code;
+  JitTest_initReturn(&code, rt, value);
+
+  void* p;
+  return rt._add(&p, &code) == kErrorOk ? p : nullptr;
+}
+
+struct JitPatchTestCaller {
+  JitRuntime* runtime;
+  JitPatchSite* site;
+  volatile uint32_t stop;
+  uint32_t calls;
+  uint32_t invalid;
+};
+
+static void ASMJIT_CDECL JitPatchTest_caller(void* data) noexcept {
+  JitPatchTestCaller* self = static_cast<JitPatchTestCaller*>(data);
+  JitThread thread;
+  self->runtime->registerThread(&thread);
+
+  while (!OSUtils::atomicLoad(&self->stop)) {
+    int result = self->site->getEntryT<JitPatchTestFunc>()();
+    if (result != 1 && result != 2)
+      self->invalid++;
+    self->calls++;
+    self->runtime->quiescent(&thread);
+  }
+
+  self->runtime->unregisterThread(&thread);
+}
+
+UNIT(base_jitpatch) {
+  JitRuntime rt;
+  void* f1 = JitPatchTest_add(rt, 1);
+  void* f2 = JitPatchTest_add(rt, 2);
+  EXPECT(f1 != nullptr && f2 != nullptr);
+
+  JitPatcher patcher(&rt);
+
+  static const uint32_t kinds[] = { JitPatchSite::kKindDirect, JitPatchSite::kKindIndirect };
+  for (uint32_t i = 0; i < ASMJIT_ARRAY_SIZE(kinds); i++) {
+    INFO("Retargeting %s site", kinds[i] == JitPatchSite::kKindDirect ? "a direct" : "an indirect");
+
+    JitPatchSite* site;
+    EXPECT(patcher.newSite(&site, f1, kinds[i]) == kErrorOk);
+    EXPECT(site->getKind() == kinds[i]);
+    EXPECT(site->getEntryT<JitPatchTestFunc>()() == 1);
+
+    EXPECT(patcher.retarget(site, f2) == kErrorOk);
+    EXPECT(site->getTarget() == f2);
+    EXPECT(site->getEntryT<JitPatchTestFunc>()() == 2);
+
+    EXPECT(patcher.retarget(site, f1) == kErrorOk);
+    EXPECT(site->getEntryT<JitPatchTestFunc>()() == 1);
+  }
+  EXPECT(patcher.getSiteCount() == 2);
+
+  INFO("Retargeting a site while another thread calls it");
+  {
+    JitPatchTestCaller caller;
+    EXPECT(patcher.newSite(&caller.site, f1) == kErrorOk);
+    caller.runtime = &rt;
+    caller.stop = 0;
+    caller.calls = 0;
+    caller.invalid = 0;
+
+    Thread thread;
+    EXPECT(thread.start(JitPatchTest_caller, &caller) == kErrorOk);
+
+    for (uint32_t i = 0; i < 20000; i++)
+      patcher.retarget(caller.site, (i & 1) ? f1 : f2);
+
+    OSUtils::atomicStore(&caller.stop, 1);
+    thread.join();
+
+    EXPECT(caller.invalid == 0, "%u of %u calls returned an invalid value", caller.invalid, caller.calls);
+    EXPECT(patcher.releaseSite(caller.site) == kErrorOk);
+  }
+
+  INFO("Deferring the release of replaced code and stubs");
+  {
+    // The stub of the site released above isn't executed by any thread.
+    EXPECT(rt.reclaim() == 1);
+
+    JitThread self;
+    rt.registerThread(&self);
+
+    JitPatchSite* site;
+    void* f3 = JitPatchTest_add(rt, 3);
+    EXPECT(patcher.newSite(&site, f3) == kErrorOk);
+    EXPECT(patcher.retarget(site, f1) == kErrorOk);
+    EXPECT(rt.releaseDeferred(f3) == kErrorOk);
+    EXPECT(patcher.releaseSite(site) == kErrorOk);
+    EXPECT(patcher.getSiteCount() == 2);
+
+    EXPECT(rt.getDeferredCount() == 2);
+    EXPECT(rt.reclaim() == 0);
+
+    rt.quiescent(&self);
+    EXPECT(rt.reclaim() == 2);
+    rt.unregisterThread(&self);
+  }
+
+  rt.release(f1);
+  rt.release(f2);
+}
+
+UNIT(base_jitpatch_compact) {
+  enum { kCount = 8 };
+
+  JitRuntime rt;
+  JitPatcher patcher(&rt);
+
+  JitPatchSite* sites[kCount];
+  void* fillers[kCount];
+  uint32_t i;
+
+  INFO("Rejecting code that is not position-independent");
+  {
+    CodeHolder code;
+    JitTest_initReturn(&code, rt, 0);
+
+    RelocEntry* re;
+    EXPECT(code.newRelocEntry(&re, RelocEntry::kTypeAbsToRel, 4) == kErrorOk);
+
+    JitPatchSite* site;
+    EXPECT(patcher.newMovableSite(&site, &code) == kErrorInvalidRelocEntry);
+    EXPECT(site == nullptr);
+  }
+
+  INFO("Creating movable sites interleaved with other code");
+  for (i = 0; i < kCount; i++) {
+    CodeHolder code;
+    JitTest_initReturn(&code, rt, i + 100);
+
+    EXPECT(patcher.newMovableSite(&sites[i], &code) == kErrorOk);
+    EXPECT(sites[i]->isMovable());
+    EXPECT(sites[i]->getCodeSize() == 6);
+    EXPECT(patcher.retarget(sites[i], sites[i]->getTarget()) == kErrorInvalidState);
+
+    fillers[i] = JitPatchTest_add(rt, i);
+    EXPECT(fillers[i] != nullptr);
+  }
+
+  INFO("Compacting live code of sparsely used memory");
+  {
+    for (i = 0; i < kCount; i++)
+      rt.release(fillers[i]);
+
+    for (i = 0; i < kCount; i += 2)
+      EXPECT(patcher.releaseSite(sites[i]) == kErrorOk);
+
+    size_t moved;
+    EXPECT(patcher.compact(&moved) == kErrorOk);
+    EXPECT(moved == kCount / 2);
+
+    uintptr_t lo = ~uintptr_t(0);
+    for (i = 1; i < kCount; i += 2)
+      if ((uintptr_t)sites[i]->getTarget() < lo) lo = (uintptr_t)sites[i]->getTarget();
+
+    for (i = 1; i < kCount; i += 2) {
+      uintptr_t offset = (uintptr_t)sites[i]->getTarget() - lo;
+      EXPECT(offset < (kCount / 2) * 16 && (offset & 15) == 0, "Site #%u was not moved into a dense block", i);
+      EXPECT(sites[i]->getEntryT<JitPatchTestFunc>()() == int(i + 100));
+    }
+
+    // Nothing to gain, the code already fills a single block.
+    EXPECT(patcher.compact(&moved) == kErrorOk);
+    EXPECT(moved == 0);
+
+    EXPECT(patcher.releaseSite(sites[3]) == kErrorOk);
+    EXPECT(patcher.compact(&moved) == kErrorOk);
+    EXPECT(moved == kCount / 2 - 1);
+    EXPECT(sites[5]->getEntryT<JitPatchTestFunc>()() == 105);
+
+    // All old blocks and released stubs are freed once no thread executes them.
+    rt.reclaim();
+    EXPECT(rt.getDeferredCount() == 0);
+  }
+}
+#endif // ASMJIT_TEST && ASMJIT_BUILD_X86 && (ASMJIT_ARCH_X86 || ASMJIT_ARCH_X64)
+
+} // asmjit namespace
+
+// [Api-End]
+#include "../asmjit_apiend.h"
@@ -0,0 +1,213 @@
+// [AsmJit]
+// Complete x86/x64 JIT and Remote Assembler for C++.
+//
+// [License]
+// Zlib - See LICENSE.md file in the package.
+
+// [Guard]
+#ifndef _ASMJIT_BASE_JITPATCH_H
+#define _ASMJIT_BASE_JITPATCH_H
+
+// [Dependencies]
+#include "../base/runtime.h"
+
+// [Api-Begin]
+#include "../asmjit_apibegin.h"
+
+namespace asmjit {
+
+//! \addtogroup asmjit_base
+//! \{
+
+// ============================================================================
+// [asmjit::JitPatchBlock]
+// ============================================================================
+
+//! \internal
+//!
+//! Executable memory that holds code of movable sites, see
+//! `JitPatcher::newMovableSite()`.
+struct JitPatchBlock {
+  uint8_t* rx;                           //!< Executable address.
+  size_t size;                           //!< Size of the block.
+  size_t liveSize;                       //!< Size of code of sites that were not released.
+  size_t liveCount;                      //!< Count of sites that were not released.
+};
+
+// ============================================================================
+// [asmjit::JitPatchSite]
+// ============================================================================
+
+//! Patchable entry point created by \ref JitPatcher.
+//!
+//! The entry is a small stub in executable memory that jumps to the current
+//! target. Callers (and generated code) call \ref getEntry() instead of the
+//! target itself, so the target can be replaced while other threads run.
+struct JitPatchSite {
+  //! Kind of the site.
+  ASMJIT_ENUM(Kind) {
+    //! Direct if the target is within the range of `jmp rel32`, otherwise
+    //! indirect (only used by `JitPatcher::newSite()`).
+    kKindAuto     = 0,
+    //! `jmp rel32` - the fastest, but the target must be within 2GB.
+    kKindDirect   = 1,
+    //! `jmp [slot]` - any target, costs a load.
+    kKindIndirect = 2
+  };
+
+  //! Size of the stub in executable memory.
+  enum { kStubSize = 16 };
+
+  //! Get the entry point, the address to call.
+  ASMJIT_INLINE void* getEntry() const noexcept { return rx; }
+  //! \overload
+  template<typename Func>
+  ASMJIT_INLINE Func getEntryT() const noexcept { return ptr_as_func<Func>(rx); }
+
+  //! Get the kind of the site, see \ref Kind.
+  ASMJIT_INLINE uint32_t getKind() const noexcept { return kind; }
+  //! Get the current target.
+  ASMJIT_INLINE void* getTarget() const noexcept { return target; }
+
+  //! Get whether the site owns its code, which can be moved by `JitPatcher::compact()`.
+  ASMJIT_INLINE bool isMovable() const noexcept { return block != nullptr; }
+  //! Get the size of the code owned by the site (zero if not movable).
+  ASMJIT_INLINE size_t getCodeSize() const noexcept { return codeSize; }
+
+  uint8_t* rx;                           //!< Executable view of the stub.
+  uint8_t* rw;                           //!< Writable view of the stub.
+  void* target;                          //!< Current target.
+  uint32_t kind;                         //!< Kind, see \ref Kind.
+  JitPatchBlock* block;                  //!< Block that holds the code of a movable site.
+  size_t codeSize;                       //!< Size of the code of a movable site.
+  JitPatchSite* prev;                    //!< Previous site of \ref JitPatcher.
+  JitPatchSite* next;                    //!< Next site of \ref JitPatcher.
+};
+
+// ============================================================================
+// [asmjit::JitPatcher]
+// ============================================================================
+
+//! Patchable entry points (X86/X64).
+//!
+//! Each \ref JitPatchSite is a 16-byte stub aligned to 8 bytes, so the patched
+//! part of the stub (`jmp rel32` or the pointer slot of `jmp [slot]`) never
+//! crosses an 8-byte boundary and `retarget()` replaces it by a single atomic
+//! store (through the writable view if the runtime uses dual mapping). A
+//! thread that executes the stub concurrently sees either the old or the new
+//! jump, never a mix of both, and the instruction cache is flushed after the
+//! store. Retargeting of a site is serialized by the patcher.
+//!
+//! Replaced code can still be executed by threads that entered it before the
+//! site was retargeted, so it must be released by `JitRuntime::releaseDeferred()`,
+//! which frees it once all threads registered by `JitRuntime::registerThread()`
+//! passed a quiescent state. Stubs of released sites are deferred the same way:
+//!
+//! ~~~
+//! JitPatcher patcher(&rt);
+//! JitPatchSite* site;
+//! patcher.newSite(&site, tier1);
+//!
+//! // Worker threads.
+//! rt.registerThread(&self);
+//! for (;;) {
+//!   site->getEntryT<Func>()(...);
+//!   rt.quiescent(&self);
+//! }
+//!
+//! // Tier-up.
+//! patcher.retarget(site, tier2);
+//! rt.releaseDeferred(tier1);
+//! ~~~
+//!
+//! Movable sites created by `newMovableSite()` own position-independent code
+//! that `compact()` can copy into a single dense block after long periods of
+//! adding and releasing code left \ref VMemMgr chunks sparsely used. Sites are
+//! retargeted to the copies and the old blocks are released by the deferred
+//! release of the runtime, which unmaps chunks that become empty.
+//!
+//! The patcher is thread-safe. Sites that were not released are released when
+//! the patcher is destroyed, all threads must be stopped by then.
+class JitPatcher {
+public:
+  ASMJIT_NONCOPYABLE(JitPatcher)
+
+  // --------------------------------------------------------------------------
+  // [Construction / Destruction]
+  // --------------------------------------------------------------------------
+
+  //! Create a new `JitPatcher` that allocates stubs from `runtime`.
+  ASMJIT_API JitPatcher(JitRuntime* runtime) noexcept;
+  //! Destroy the `JitPatcher` and release all sites.
+  ASMJIT_API ~JitPatcher() noexcept;
+
+  // --------------------------------------------------------------------------
+  // [Accessors]
+  // --------------------------------------------------------------------------
+
+  //! Get the associated runtime.
+  ASMJIT_INLINE JitRuntime* getRuntime() const noexcept { return _runtime; }
+
+  //! Get the count of sites.
+  ASMJIT_API size_t getSiteCount() const noexcept;
+
+  // --------------------------------------------------------------------------
+  // [Sites]
+  // --------------------------------------------------------------------------
+
+  //! Create a new site that jumps to `target`.
+  //!
+  //! Fails with `kErrorInvalidDisplacement` if `kind` is `kKindDirect` and the
+  //! target is out of range of `jmp rel32`.
+  ASMJIT_API Error newSite(JitPatchSite** out, void* target, uint32_t kind = JitPatchSite::kKindAuto) noexcept;
+
+  //! Create a new movable site that owns the code of `code`.
+  //!
+  //! The code is relocated into memory allocated from the runtime and can be
+  //! moved by `compact()`, thus it must be position-independent - only
+  //! relocations between its own sections are allowed. Fails with
+  //! `kErrorInvalidRelocEntry` if the code references absolute addresses or
+  //! calls code outside of it by a relative displacement.
+  ASMJIT_API Error newMovableSite(JitPatchSite** out, CodeHolder* code, uint32_t kind = JitPatchSite::kKindAuto) noexcept;
+
+  //! Atomically change the target of `site`.
+  //!
+  //! Fails with `kErrorInvalidDisplacement` if the site is direct and the
+  //! target is out of its range, the site is not changed in that case. Fails
+  //! with `kErrorInvalidState` if the site is movable, as it owns its target.
+  ASMJIT_API Error retarget(JitPatchSite* site, void* target) noexcept;
+
+  //! Release `site`, its stub (and code if the site is movable) is released
+  //! by `JitRuntime::_releaseDeferred()` as other threads may still execute it.
+  ASMJIT_API Error releaseSite(JitPatchSite* site) noexcept;
+
+  // --------------------------------------------------------------------------
+  // [Compaction]
+  // --------------------------------------------------------------------------
+
+  //! Copy the code of all movable sites into a single block, retarget the
+  //! sites, and release the old blocks by `JitRuntime::_releaseDeferred()`.
+  //!
+  //! Does nothing if the code already fills a single block. Direct sites that
+  //! can't reach the new block keep their code. The count of moved sites is
+  //! stored to `movedCount` if not null.
+  ASMJIT_API Error compact(size_t* movedCount = nullptr) noexcept;
+
+  // --------------------------------------------------------------------------
+  // [Members]
+  // --------------------------------------------------------------------------
+
+  JitRuntime* _runtime;                  //!< Runtime used to allocate stubs.
+  mutable Lock _lock;                    //!< Lock of all members.
+  JitPatchSite* _sites;                  //!< All sites.
+};
+
+//! \}
+
+} // asmjit namespace
+
+// [Api-End]
+#include "../asmjit_apiend.h"
+
+// [Guard]
+#endif // _ASMJIT_BASE_JITPATCH_H
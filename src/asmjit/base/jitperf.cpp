@@ -0,0 +1,460 @@
+// [AsmJit]
+// Complete x86/x64 JIT and Remote Assembler for C++.
+//
+// [License]
+// Zlib - See LICENSE.md file in the package.
+
+// [Export]
+#define ASMJIT_EXPORTS
+
+// [Dependencies]
+#include "../base/jitperf.h"
+#include "../base/jittest_p.h"
+#include "../base/utils.h"
+
+#if ASMJIT_OS_POSIX
+# include <sys/mman.h>
+# include <unistd.h>
+#endif // ASMJIT_OS_POSIX
+
+#if ASMJIT_OS_LINUX
+# include <sys/syscall.h>
+#endif // ASMJIT_OS_LINUX
+
+// [Api-Begin]
+#include "../asmjit_apibegin.h"
+
+namespace asmjit {
+
+// ============================================================================
+// [asmjit::JitPerfListener - Format]
+// ============================================================================
+
+//! \internal
+//!
+//! Jitdump constants, see `tools/perf/Documentation/jitdump-specification.txt`
+//! in the Linux kernel tree.
+ASMJIT_ENUM(JitDumpConst) {
+  kJitDumpMagic         = 0x4A695444U,   //!< Magic, "JiTD" in native byte order.
+  kJitDumpVersion       = 1,             //!< Version of the format.
+
+  kJitDumpRecordLoad    = 0,             //!< JIT_CODE_LOAD record.
+  kJitDumpRecordClose   = 3              //!< JIT_CODE_CLOSE record.
+};
+
+//! \internal
+//!
+//! Header of the jitdump file.
+struct JitDumpHeader {
+  uint32_t magic;                        //!< Magic, `kJitDumpMagic`.
+  uint32_t version;                      //!< Version, `kJitDumpVersion`.
+  uint32_t totalSize;                    //!< Size of the header.
+  uint32_t elfMach;                      //!< ELF machine of the code (`EM_*`).
+  uint32_t reserved;                     //!< Reserved, must be zero.
+  uint32_t pid;                          //!< Process id.
+  uint64_t timestamp;                    //!< Time the file was created.
+  uint64_t flags;                        //!< Flags, must be zero.
+};
+
+//! \internal
+//!
+//! Header of each jitdump record.
+struct JitDumpRecord {
+  uint32_t id;                           //!< Record id.
+  uint32_t totalSize;                    //!< Size of the record including this header.
+  uint64_t timestamp;                    //!< Time the record was created.
+};
+
+//! \internal
+//!
+//! JIT_CODE_LOAD record, followed by the name (null terminated) and the code.
+struct JitDumpCodeLoad {
+  JitDumpRecord record;                  //!< Record header.
+  uint32_t pid;                          //!< Process id.
+  uint32_t tid;                          //!< Thread id.
+  uint64_t vma;                          //!< Virtual address of the code.
+  uint64_t codeAddr;                     //!< Address of the code (same as `vma`).
+  uint64_t codeSize;                     //!< Size of the code.
+  uint64_t codeIndex;                    //!< Unique index of the code.
+};
+
+//! \internal
+//!
+//! ELF machine of the host.
+static const uint32_t kJitDumpElfMach =
+  ASMJIT_ARCH_X64   ?  62 : // EM_X86_64
+  ASMJIT_ARCH_X86   ?   3 : // EM_386
+  ASMJIT_ARCH_ARM64 ? 183 : // EM_AARCH64
+  ASMJIT_ARCH_ARM32 ?  40 : // EM_ARM
+                        0 ; // EM_NONE
+
+// ============================================================================
+// [asmjit::JitPerfListener - Helpers]
+// ============================================================================
+
+#if ASMJIT_OS_POSIX
+static ASMJIT_INLINE uint32_t JitPerf_getTid() noexcept {
+#if ASMJIT_OS_LINUX
+  return static_cast<uint32_t>(::syscall(SYS_gettid));
+#else
+  return static_cast<uint32_t>(::getpid());
+#endif
+}
+
+//! \internal
+//!
+//! Get the end of a symbol that starts at `start` - either the next symbol
+//! of `code` or `end`.
+static uint64_t JitPerf_getSymbolEnd(const CodeHolder* code, uint64_t base, uint64_t start, uint64_t end) noexcept {
+  const ZoneVector<LabelEntry*>& labels = code->getLabelEntries();
+  for (size_t i = 0; i < labels.getLength(); i++) {
+    const LabelEntry* le = labels[i];
+    if (le->getType() != Label::kTypeGlobal || !le->isBound())
+      continue;
+
+    uint64_t address = base + code->getSectionEntry(le->getSectionId())->getOffset() + static_cast<uint64_t>(le->getOffset());
+    if (address > start && address < end)
+      end = address;
+  }
+  return end;
+}
+#endif // ASMJIT_OS_POSIX
+
+// ============================================================================
+// [asmjit::JitPerfListener - Construction / Destruction]
+// ============================================================================
+
+JitPerfListener::JitPerfListener() noexcept
+  : _options(0),
+    _perfMap(nullptr),
+    _jitDump(nullptr),
+    _jitDumpMarker(nullptr),
+    _jitDumpMarkerSize(0),
+    _functionCount(0) {}
+JitPerfListener::~JitPerfListener() noexcept { close(); }
+
+// ============================================================================
+// [asmjit::JitPerfListener - Open / Close]
+// ============================================================================
+
+//! \internal
+//!
+//! Close all files of `self`, the lock must be held.
+static void JitPerf_closeFiles(JitPerfListener* self) noexcept {
+#if ASMJIT_OS_POSIX
+  if (self->_perfMap) {
+    ::fclose(self->_perfMap);
+    self->_perfMap = nullptr;
+  }
+
+  if (self->_jitDump) {
+    if (self->_options & JitPerfListener::kOptionJitDump) {
+      JitDumpRecord record;
+      record.id = kJitDumpRecordClose;
+      record.totalSize = static_cast<uint32_t>(sizeof(JitDumpRecord));
+      record.timestamp = OSUtils::getHighResTime();
+      ::fwrite(&record, 1, sizeof(record), self->_jitDump);
+    }
+
+    ::fclose(self->_jitDump);
+    self->_jitDump = nullptr;
+  }
+
+  if (self->_jitDumpMarker) {
+    ::munmap(self->_jitDumpMarker, self->_jitDumpMarkerSize);
+    self->_jitDumpMarker = nullptr;
+    self->_jitDumpMarkerSize = 0;
+  }
+#endif // ASMJIT_OS_POSIX
+
+  self->_options = 0;
+}
+
+#if ASMJIT_OS_POSIX
+//! \internal
+//!
+//! Create the jitdump file `fileName` and map it, the lock must be held.
+static Error JitPerf_openJitDump(JitPerfListener* self, const char* fileName, uint32_t pid) noexcept {
+  self->_jitDump = ::fopen(fileName, "w+b");
+  if (ASMJIT_UNLIKELY(!self->_jitDump))
+    return DebugUtils::errored(kErrorFileIo);
+
+  // `perf record` only knows about the file through this mapping, it must
+  // be executable to be recorded, but it's never accessed.
+  size_t markerSize = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+  void* marker = ::mmap(nullptr, markerSize, PROT_READ | PROT_EXEC, MAP_PRIVATE, ::fileno(self->_jitDump), 0);
+  if (ASMJIT_UNLIKELY(marker == MAP_FAILED))
+    return DebugUtils::errored(kErrorFileIo);
+
+  self->_jitDumpMarker = marker;
+  self->_jitDumpMarkerSize = markerSize;
+
+  JitDumpHeader header;
+  header.magic = kJitDumpMagic;
+  header.version = kJitDumpVersion;
+  header.totalSize = static_cast<uint32_t>(sizeof(JitDumpHeader));
+  header.elfMach = kJitDumpElfMach;
+  header.reserved = 0;
+  header.pid = pid;
+  header.timestamp = OSUtils::getHighResTime();
+  header.flags = 0;
+
+  if (ASMJIT_UNLIKELY(::fwrite(&header, 1, sizeof(header), self->_jitDump) != sizeof(header)))
+    return DebugUtils::errored(kErrorFileIo);
+
+  ::fflush(self->_jitDump);
+  return kErrorOk;
+}
+#endif // ASMJIT_OS_POSIX
+
+Error JitPerfListener::open(uint32_t options, const char* dir) noexcept {
+  AutoLock locked(_lock);
+  JitPerf_closeFiles(this);
+
+#if ASMJIT_OS_POSIX
+  if (ASMJIT_UNLIKELY((options & ~uint32_t(kOptionPerfMap | kOptionJitDump)) != 0 || options == 0))
+    return DebugUtils::errored(kErrorInvalidArgument);
+
+  char fileName[1024];
+  uint32_t pid = static_cast<uint32_t>(::getpid());
+
+  if (options & kOptionPerfMap) {
+    ::snprintf(fileName, ASMJIT_ARRAY_SIZE(fileName), "/tmp/perf-%u.map", pid);
+    _perfMap = ::fopen(fileName, "a");
+    if (ASMJIT_UNLIKELY(!_perfMap))
+      return DebugUtils::errored(kErrorFileIo);
+  }
+
+  if (options & kOptionJitDump) {
+    int len = ::snprintf(fileName, ASMJIT_ARRAY_SIZE(fileName), "%s/jit-%u.dump", dir ? dir : "/tmp", pid);
+    Error err = (len < 0 || static_cast<size_t>(len) >= ASMJIT_ARRAY_SIZE(fileName))
+      ? DebugUtils::errored(kErrorInvalidArgument)
+      : JitPerf_openJitDump(this, fileName, pid);
+
+    if (ASMJIT_UNLIKELY(err)) {
+      JitPerf_closeFiles(this);
+      return err;
+    }
+  }
+
+  _options = options;
+  return kErrorOk;
+#else
+  ASMJIT_UNUSED(options);
+  ASMJIT_UNUSED(dir);
+  return DebugUtils::errored(kErrorFeatureNotEnabled);
+#endif // ASMJIT_OS_POSIX
+}
+
+void JitPerfListener::close() noexcept {
+  AutoLock locked(_lock);
+  JitPerf_closeFiles(this);
+}
+
+// ============================================================================
+// [asmjit::JitPerfListener - Interface]
+// ============================================================================
+
+//! \internal
+//!
+//! Write a symbol `name` of `[start, end)` to all open files.
+static void JitPerf_writeSymbol(JitPerfListener* self, uint64_t start, uint64_t end, const char* name) noexcept {
+#if ASMJIT_OS_POSIX
+  uint64_t size = end - start;
+
+  if (self->_perfMap) {
+    ::fprintf(self->_perfMap, "%llx %llx %s\n",
+      static_cast<unsigned long long>(start),
+      static_cast<unsigned long long>(size), name);
+  }
+
+  if (self->_jitDump) {
+    size_t nameSize = ::strlen(name) + 1;
+
+    JitDumpCodeLoad load;
+    load.record.id = kJitDumpRecordLoad;
+    load.record.totalSize = static_cast<uint32_t>(sizeof(JitDumpCodeLoad) + nameSize + size);
+    load.record.timestamp = OSUtils::getHighResTime();
+    load.pid = static_cast<uint32_t>(::getpid());
+    load.tid = JitPerf_getTid();
+    load.vma = start;
+    load.codeAddr = start;
+    load.codeSize = size;
+    load.codeIndex = self->_functionCount;
+
+    ::fwrite(&load, 1, sizeof(load), self->_jitDump);
+    ::fwrite(name, 1, nameSize, self->_jitDump);
+    ::fwrite(reinterpret_cast<const void*>(static_cast<uintptr_t>(start)), 1, static_cast<size_t>(size), self->_jitDump);
+  }
+#else
+  ASMJIT_UNUSED(self);
+  ASMJIT_UNUSED(start);
+  ASMJIT_UNUSED(end);
+  ASMJIT_UNUSED(name);
+#endif // ASMJIT_OS_POSIX
+}
+
+void JitPerfListener::onAdd(const void* p, size_t size, const CodeHolder* code) noexcept {
+#if ASMJIT_OS_POSIX
+  AutoLock locked(_lock);
+  if (!_options || size == 0)
+    return;
+
+  uint64_t base = static_cast<uint64_t>((uintptr_t)p);
+  uint64_t end = base + size;
+
+  // Code before the first named label.
+  uint64_t firstEnd = code ? JitPerf_getSymbolEnd(code, base, base, end) : end;
+  if (firstEnd > base) {
+    char name[32];
+    ::snprintf(name, ASMJIT_ARRAY_SIZE(name), "asmjit_func_%llu", static_cast<unsigned long long>(_functionCount));
+    JitPerf_writeSymbol(this, base, firstEnd, name);
+  }
+
+  // Named global labels.
+  if (code) {
+    const ZoneVector<LabelEntry*>& labels = code->getLabelEntries();
+    for (size_t i = 0; i < labels.getLength(); i++) {
+      const LabelEntry* le = labels[i];
+      if (le->getType() != Label::kTypeGlobal || !le->isBound())
+        continue;
+
+      const SectionEntry* section = code->getSectionEntry(le->getSectionId());
+      uint64_t sectionStart = base + section->getOffset();
+      uint64_t sectionEnd = sectionStart + section->getBuffer().getLength();
+
+      uint64_t start = sectionStart + static_cast<uint64_t>(le->getOffset());
+      uint64_t symbolEnd = JitPerf_getSymbolEnd(code, base, start, sectionEnd < end ? sectionEnd : end);
+
+      if (start >= base && start < symbolEnd)
+        JitPerf_writeSymbol(this, start, symbolEnd, le->getName());
+    }
+  }
+
+  if (_perfMap) ::fflush(_perfMap);
+  if (_jitDump) ::fflush(_jitDump);
+  _functionCount++;
+#else
+  ASMJIT_UNUSED(p);
+  ASMJIT_UNUSED(size);
+  ASMJIT_UNUSED(code);
+#endif // ASMJIT_OS_POSIX
+}
+
+void JitPerfListener::onRelease(const void* p) noexcept {
+  // Neither format can unload code, see the class documentation.
+  ASMJIT_UNUSED(p);
+}
+
+// ============================================================================
+// [asmjit::JitPerfListener - Test]
+// ============================================================================
+
+#if defined(ASMJIT_TEST) && defined(ASMJIT_BUILD_X86) && ASMJIT_OS_POSIX && (ASMJIT_ARCH_X86 || ASMJIT_ARCH_X64)
+static void JitPerfTest_init(CodeHolder& code, JitRuntime& rt) noexcept {
+  // f: mov eax, 1; ret
+  // g: mov eax, 2; ret
+  JitTest_initReturn(&code, rt, 1);
+  JitTest_emitReturn(&code, 2);
+
+  uint32_t id;
+  code.newNamedLabelId(id, "g", Globals::kInvalidIndex, Label::kTypeGlobal, 0);
+
+  LabelEntry* le = code.getLabelEntry(id);
+  le->_sectionId = 0;
+  le->_offset = 6;
+}
+
+UNIT(base_jitperf) {
+  typedef int (*Func)(void);
+
+  JitRuntime rt;
+  JitPerfListener perf;
+
+  uint32_t pid = static_cast<uint32_t>(::getpid());
+  char mapName[64];
+  char dumpName[64];
+
+  ::snprintf(mapName, ASMJIT_ARRAY_SIZE(mapName), "/tmp/perf-%u.map", pid);
+  ::snprintf(dumpName, ASMJIT_ARRAY_SIZE(dumpName), "./jit-%u.dump", pid);
+
+  INFO("Writing a perf map and a jitdump file");
+  EXPECT(perf.open(JitPerfListener::kOptionPerfMap | JitPerfListener::kOptionJitDump, ".") == kErrorOk,
+    "Failed to open perf files");
+  rt.setListener(&perf);
+
+  CodeHolder code;
+  JitPerfTest_init(code, rt);
+
+  Func fn;
+  EXPECT(rt.add(&fn, &code) == kErrorOk,
+    "Failed to add a function");
+  EXPECT(fn() == 1,
+    "Function returned a wrong value");
+  EXPECT(perf.getFunctionCount() == 1,
+    "Listener should be notified about 1 function");
+
+  rt.release(fn);
+  rt.setListener(nullptr);
+  perf.close();
+
+  INFO("Verifying the perf map");
+  {
+    FILE* file = ::fopen(mapName, "r");
+    EXPECT(file != nullptr,
+      "Failed to open '%s'", mapName);
+
+    char line[256];
+    char expected[256];
+    uint64_t base = static_cast<uint64_t>((uintptr_t)fn);
+
+    EXPECT(::fgets(line, sizeof(line), file) != nullptr);
+    ::snprintf(expected, sizeof(expected), "%llx 6 asmjit_func_0\n", static_cast<unsigned long long>(base));
+    EXPECT(::strcmp(line, expected) == 0,
+      "Unexpected perf map line '%s'", line);
+
+    EXPECT(::fgets(line, sizeof(line), file) != nullptr);
+    ::snprintf(expected, sizeof(expected), "%llx 6 g\n", static_cast<unsigned long long>(base + 6));
+    EXPECT(::strcmp(line, expected) == 0,
+      "Unexpected perf map line '%s'", line);
+
+    ::fclose(file);
+    ::remove(mapName);
+  }
+
+  INFO("Verifying the jitdump file");
+  {
+    FILE* file = ::fopen(dumpName, "rb");
+    EXPECT(file != nullptr,
+      "Failed to open '%s'", dumpName);
+
+    JitDumpHeader header;
+    EXPECT(::fread(&header, 1, sizeof(header), file) == sizeof(header));
+    EXPECT(header.magic == kJitDumpMagic && header.version == kJitDumpVersion && header.pid == pid,
+      "Invalid jitdump header");
+
+    uint32_t loads = 0;
+    JitDumpRecord record;
+
+    while (::fread(&record, 1, sizeof(record), file) == sizeof(record) && record.id == kJitDumpRecordLoad) {
+      EXPECT(record.totalSize == sizeof(JitDumpCodeLoad) + (loads == 0 ? 14 : 2) + 6,
+        "Invalid size of JIT_CODE_LOAD record");
+      ::fseek(file, static_cast<long>(record.totalSize - sizeof(record)), SEEK_CUR);
+      loads++;
+    }
+
+    EXPECT(loads == 2,
+      "Jitdump should contain 2 JIT_CODE_LOAD records, not %u", loads);
+    EXPECT(record.id == kJitDumpRecordClose,
+      "Jitdump should end with JIT_CODE_CLOSE record");
+
+    ::fclose(file);
+    ::remove(dumpName);
+  }
+}
+#endif // ASMJIT_TEST && ASMJIT_BUILD_X86 && ASMJIT_OS_POSIX && (ASMJIT_ARCH_X86 || ASMJIT_ARCH_X64)
+
+} // asmjit namespace
+
+// [Api-End]
+#include "../asmjit_apiend.h"
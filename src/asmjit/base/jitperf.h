@@ -0,0 +1,124 @@
+// [AsmJit]
+// Complete x86/x64 JIT and Remote Assembler for C++.
+//
+// [License]
+// Zlib - See LICENSE.md file in the package.
+
+// [Guard]
+#ifndef _ASMJIT_BASE_JITPERF_H
+#define _ASMJIT_BASE_JITPERF_H
+
+// [Dependencies]
+#include "../base/osutils.h"
+#include "../base/runtime.h"
+
+// [Api-Begin]
+#include "../asmjit_apibegin.h"
+
+namespace asmjit {
+
+//! \addtogroup asmjit_base
+//! \{
+
+// ============================================================================
+// [asmjit::JitPerfListener]
+// ============================================================================
+
+//! \ref JitListener that makes the generated code visible to Linux `perf`.
+//!
+//! Two formats are supported, they can be enabled together:
+//!
+//!   - `kOptionPerfMap` - appends `<address> <size> <name>` lines to
+//!     `/tmp/perf-<pid>.map`, which `perf report` reads to symbolize samples
+//!     that hit anonymous memory.
+//!
+//!   - `kOptionJitDump` - writes `<dir>/jit-<pid>.dump` in the jitdump format,
+//!     which also contains the code of each function. The file is mapped as
+//!     executable so `perf record -k mono` records its location, and
+//!     `perf inject --jit` then turns the dump into ELF images that can be
+//!     annotated like any other code.
+//!
+//! Each bound global label created by `CodeHolder::newNamedLabelId()` becomes
+//! a symbol that ends at the next such label or at the end of its section.
+//! Code not covered by a named label, usually the whole function, is named
+//! `asmjit_func_<n>`, where `n` counts added functions.
+//!
+//! Neither format has a record that unloads code, a range that is released
+//! and reused is resolved by `perf` to the function added last (jitdump
+//! records are timestamped).
+//!
+//! ~~~
+//! JitRuntime rt;
+//! JitPerfListener perf;
+//!
+//! perf.open(JitPerfListener::kOptionPerfMap | JitPerfListener::kOptionJitDump);
+//! rt.setListener(&perf);
+//! ~~~
+class ASMJIT_VIRTAPI JitPerfListener : public JitListener {
+public:
+  ASMJIT_NONCOPYABLE(JitPerfListener)
+
+  //! Output formats.
+  ASMJIT_ENUM(Options) {
+    kOptionPerfMap = 0x00000001U,        //!< Write `/tmp/perf-<pid>.map`.
+    kOptionJitDump = 0x00000002U         //!< Write `jit-<pid>.dump`.
+  };
+
+  // --------------------------------------------------------------------------
+  // [Construction / Destruction]
+  // --------------------------------------------------------------------------
+
+  //! Create a new `JitPerfListener`, nothing is written until `open()`.
+  ASMJIT_API JitPerfListener() noexcept;
+  //! Destroy the `JitPerfListener`, closes all files.
+  ASMJIT_API virtual ~JitPerfListener() noexcept;
+
+  // --------------------------------------------------------------------------
+  // [Open / Close]
+  // --------------------------------------------------------------------------
+
+  //! Open files of the formats specified by `options`.
+  //!
+  //! The perf map is always created in `/tmp` as that's where `perf` looks
+  //! for it. The jitdump file is created in `dir`, or `/tmp` if `dir` is null.
+  //! Returns `kErrorFeatureNotEnabled` if the host is not a POSIX system.
+  ASMJIT_API Error open(uint32_t options, const char* dir = nullptr) noexcept;
+  //! Close all files, the jitdump file is terminated by a close record.
+  ASMJIT_API void close() noexcept;
+
+  //! Get if any file is open.
+  ASMJIT_INLINE bool isOpen() const noexcept { return _options != 0; }
+  //! Get formats being written, see \ref Options.
+  ASMJIT_INLINE uint32_t getOptions() const noexcept { return _options; }
+  //! Get the number of functions written so far.
+  ASMJIT_INLINE uint64_t getFunctionCount() const noexcept { return _functionCount; }
+
+  // --------------------------------------------------------------------------
+  // [Interface]
+  // --------------------------------------------------------------------------
+
+  ASMJIT_API void onAdd(const void* p, size_t size, const CodeHolder* code) noexcept override;
+  ASMJIT_API void onRelease(const void* p) noexcept override;
+
+  // --------------------------------------------------------------------------
+  // [Members]
+  // --------------------------------------------------------------------------
+
+  Lock _lock;                            //!< Lock, the listener can be shared by threads.
+  uint32_t _options;                     //!< Formats being written.
+  FILE* _perfMap;                        //!< Perf map file.
+  FILE* _jitDump;                        //!< Jitdump file.
+  void* _jitDumpMarker;                  //!< Executable mapping of the jitdump file.
+  size_t _jitDumpMarkerSize;             //!< Size of `_jitDumpMarker`.
+  uint64_t _functionCount;               //!< Number of functions written.
+};
+
+//! \}
+
+} // asmjit namespace
+
+// [Api-End]
+#include "../asmjit_apiend.h"
+
+// [Guard]
+#endif // _ASMJIT_BASE_JITPERF_H
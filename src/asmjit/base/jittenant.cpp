@@ -0,0 +1,321 @@
+// [AsmJit]
+// Complete x86/x64 JIT and Remote Assembler for C++.
+//
+// [License]
+// Zlib - See LICENSE.md file in the package.
+
+// [Export]
+#define ASMJIT_EXPORTS
+
+// [Dependencies]
+#include "../base/jittenant.h"
+#include "../base/jittest_p.h"
+#include "../base/utils.h"
+
+// [Api-Begin]
+#include "../asmjit_apibegin.h"
+
+namespace asmjit {
+
+// ============================================================================
+// [asmjit::JitTenant - Construction / Destruction]
+// ============================================================================
+
+JitTenant::JitTenant(JitTenantRuntime* owner, uint64_t id, size_t quota) noexcept
+  : _owner(owner),
+    _shardNext(nullptr),
+    _id(id),
+    _quota(quota),
+    _funcCount(0),
+    _quotaFailCount(0) {}
+JitTenant::~JitTenant() noexcept {}
+
+// ============================================================================
+// [asmjit::JitTenant - Accessors]
+// ============================================================================
+
+size_t JitTenant::getQuota() const noexcept {
+  AutoLock locked(_lock);
+  return _quota;
+}
+
+void JitTenant::setQuota(size_t quota) noexcept {
+  AutoLock locked(_lock);
+  _quota = quota;
+}
+
+JitTenantStats JitTenant::getStats() const noexcept {
+  AutoLock locked(_lock);
+  JitTenantStats stats;
+
+  stats.tenantCount = 1;
+  stats.funcCount = _funcCount;
+  stats.allocatedBytes = _memMgr.getAllocatedBytes();
+  stats.usedBytes = _memMgr.getUsedBytes();
+  stats.quotaFailCount = _quotaFailCount;
+  return stats;
+}
+
+// ============================================================================
+// [asmjit::JitTenant - Interface]
+// ============================================================================
+
+Error JitTenant::_add(void** dst, CodeHolder* code) noexcept {
+  *dst = nullptr;
+
+  size_t codeSize = code->getRelocatedSize(_memMgr.getRangeLo(), _memMgr.getRangeHi());
+  if (ASMJIT_UNLIKELY(codeSize == 0))
+    return DebugUtils::errored(kErrorNoCodeGenerated);
+
+  AutoLock locked(_lock);
+
+  // Used bytes never exceed allocated bytes, reject what can't fit early.
+  if (ASMJIT_UNLIKELY(_quota && _memMgr.getUsedBytes() + codeSize > _quota)) {
+    _quotaFailCount++;
+    return DebugUtils::errored(kErrorQuotaExceeded);
+  }
+
+  void* p;
+  void* rw;
+
+  if (ASMJIT_UNLIKELY(_memMgr.allocDual(&p, &rw, codeSize, VMemMgr::kAllocFreeable) != kErrorOk))
+    return DebugUtils::errored(kErrorNoVirtualMemory);
+
+  // The allocation could have required a new chunk, which counts as well.
+  if (ASMJIT_UNLIKELY(_quota && _memMgr.getAllocatedBytes() > _quota)) {
+    _memMgr.release(p);
+    _quotaFailCount++;
+    return DebugUtils::errored(kErrorQuotaExceeded);
+  }
+
+  size_t relocSize = code->relocate(rw, static_cast<uint64_t>((uintptr_t)p));
+  if (ASMJIT_UNLIKELY(relocSize == 0)) {
+    _memMgr.release(p);
+    return DebugUtils::errored(kErrorInvalidState);
+  }
+
+  if (relocSize < codeSize)
+    _memMgr.shrink(p, relocSize);
+
+  flush(p, relocSize);
+  _funcCount++;
+
+  *dst = p;
+  return kErrorOk;
+}
+
+Error JitTenant::_release(void* p) noexcept {
+  AutoLock locked(_lock);
+  ASMJIT_PROPAGATE(_memMgr.release(p));
+
+  _funcCount--;
+  return kErrorOk;
+}
+
+size_t JitTenant::releaseAll() noexcept {
+  AutoLock locked(_lock);
+  size_t count = _funcCount;
+
+  _memMgr.reset();
+  _funcCount = 0;
+  return count;
+}
+
+// ============================================================================
+// [asmjit::JitTenantRuntime - Construction / Destruction]
+// ============================================================================
+
+JitTenantRuntime::JitTenantRuntime() noexcept {
+  for (uint32_t i = 0; i < kShardCount; i++) {
+    _shards[i].first = nullptr;
+    _shards[i].count = 0;
+  }
+}
+
+JitTenantRuntime::~JitTenantRuntime() noexcept {
+  for (uint32_t i = 0; i < kShardCount; i++) {
+    JitTenant* tenant = _shards[i].first;
+    while (tenant) {
+      JitTenant* next = tenant->_shardNext;
+      tenant->~JitTenant();
+      Internal::releaseMemory(tenant);
+      tenant = next;
+    }
+  }
+}
+
+// ============================================================================
+// [asmjit::JitTenantRuntime - Tenants]
+// ============================================================================
+
+Error JitTenantRuntime::newTenant(JitTenant** out, uint64_t id, size_t quota) noexcept {
+  *out = nullptr;
+
+  void* p = Internal::allocMemory(sizeof(JitTenant));
+  if (ASMJIT_UNLIKELY(!p))
+    return DebugUtils::errored(kErrorNoHeapMemory);
+
+  JitTenant* tenant = new(p) JitTenant(this, id, quota);
+  Shard& shard = _shards[getShardIndex(id)];
+
+  {
+    AutoLock locked(shard.lock);
+    JitTenant* existing = shard.first;
+
+    while (existing && existing->_id != id)
+      existing = existing->_shardNext;
+
+    if (!existing) {
+      tenant->_shardNext = shard.first;
+      shard.first = tenant;
+      shard.count++;
+
+      *out = tenant;
+      return kErrorOk;
+    }
+  }
+
+  tenant->~JitTenant();
+  Internal::releaseMemory(tenant);
+  return DebugUtils::errored(kErrorInvalidArgument);
+}
+
+Error JitTenantRuntime::deleteTenant(JitTenant* tenant) noexcept {
+  if (ASMJIT_UNLIKELY(!tenant || tenant->_owner != this))
+    return DebugUtils::errored(kErrorInvalidArgument);
+
+  Shard& shard = _shards[getShardIndex(tenant->_id)];
+
+  {
+    AutoLock locked(shard.lock);
+    JitTenant** pPrev = &shard.first;
+
+    while (*pPrev && *pPrev != tenant)
+      pPrev = &(*pPrev)->_shardNext;
+
+    if (ASMJIT_UNLIKELY(!*pPrev))
+      return DebugUtils::errored(kErrorInvalidArgument);
+
+    *pPrev = tenant->_shardNext;
+    shard.count--;
+  }
+
+  // Destroying `VMemMgr` releases all chunks of the tenant.
+  tenant->~JitTenant();
+  Internal::releaseMemory(tenant);
+  return kErrorOk;
+}
+
+JitTenant* JitTenantRuntime::getTenant(uint64_t id) const noexcept {
+  const Shard& shard = _shards[getShardIndex(id)];
+  AutoLock locked(shard.lock);
+
+  JitTenant* tenant = shard.first;
+  while (tenant && tenant->_id != id)
+    tenant = tenant->_shardNext;
+  return tenant;
+}
+
+size_t JitTenantRuntime::getTenantCount() const noexcept {
+  size_t count = 0;
+
+  for (uint32_t i = 0; i < kShardCount; i++) {
+    AutoLock locked(_shards[i].lock);
+    count += _shards[i].count;
+  }
+
+  return count;
+}
+
+JitTenantStats JitTenantRuntime::getStats() const noexcept {
+  JitTenantStats stats;
+  stats.reset();
+
+  for (uint32_t i = 0; i < kShardCount; i++) {
+    AutoLock locked(_shards[i].lock);
+    for (JitTenant* tenant = _shards[i].first; tenant; tenant = tenant->_shardNext)
+      stats.add(tenant->getStats());
+  }
+
+  return stats;
+}
+
+// ============================================================================
+// [asmjit::JitTenantRuntime - Test]
+// ============================================================================
+
+#if defined(ASMJIT_TEST) && defined(ASMJIT_BUILD_X86) && (ASMJIT_ARCH_X86 || ASMJIT_ARCH_X64)
+static void* JitTenantTest_add(JitTenant* tenant, uint32_t value, size_t size) noexcept {
+  CodeHolder code;
+  if (JitTest_initReturn(&code, *tenant, value, size) != kErrorOk)
+    return nullptr;
+
+  void* p = nullptr;
+  tenant->_add(&p, &code);
+  return p;
+}
+
+UNIT(base_jittenant) {
+  typedef int (*Func)(void);
+
+  // Quota of two chunks - a slab region of small functions and a single chunk
+  // of larger ones.
+  size_t quota = OSUtils::getVirtualMemoryInfo().pageGranularity * 2;
+
+  JitTenantRuntime rt;
+  JitTenant* a;
+  JitTenant* b;
+  JitTenant* c;
+
+  INFO("Creating tenants");
+  EXPECT(rt.newTenant(&a, 1) == kErrorOk);
+  EXPECT(rt.newTenant(&b, 2, quota) == kErrorOk);
+  EXPECT(rt.newTenant(&c, 2) == kErrorInvalidArgument && c == nullptr,
+    "Tenant of the same id shouldn't be created twice");
+  EXPECT(rt.getTenantCount() == 2);
+  EXPECT(rt.getTenant(1) == a && rt.getTenant(2) == b && rt.getTenant(3) == nullptr);
+
+  INFO("Adding code of tenants to separate memory");
+  void* fa = JitTenantTest_add(a, 100, 64);
+  void* fb = JitTenantTest_add(b, 200, 64);
+
+  EXPECT(fa != nullptr && fb != nullptr);
+  EXPECT(ptr_as_func<Func>(fa)() == 100 && ptr_as_func<Func>(fb)() == 200);
+  EXPECT(a->getMemMgr()->getAllocatedBytes() != 0 && b->getMemMgr()->getAllocatedBytes() != 0);
+
+  INFO("Enforcing the quota");
+  uint32_t added = 1;
+  while (JitTenantTest_add(b, 0, 1024))
+    added++;
+
+  JitTenantStats stats = b->getStats();
+  EXPECT(stats.funcCount == added && stats.quotaFailCount == 1);
+  EXPECT(added > 2 && stats.allocatedBytes <= quota,
+    "Tenant allocated %u bytes over its quota", unsigned(stats.allocatedBytes));
+  EXPECT(JitTenantTest_add(a, 300, 1024) != nullptr,
+    "Quota of one tenant shouldn't affect other tenants");
+  EXPECT(ptr_as_func<Func>(fb)() == 200);
+
+  stats = rt.getStats();
+  EXPECT(stats.tenantCount == 2 && stats.funcCount == added + 2 && stats.quotaFailCount == 1);
+
+  INFO("Releasing all code of a tenant");
+  EXPECT(b->releaseAll() == added);
+  EXPECT(b->getStats().funcCount == 0 && b->getMemMgr()->getAllocatedBytes() == 0);
+  EXPECT(ptr_as_func<Func>(fa)() == 100);
+
+  fb = JitTenantTest_add(b, 400, 64);
+  EXPECT(fb != nullptr && ptr_as_func<Func>(fb)() == 400);
+  EXPECT(b->release(fb) == kErrorOk && b->getStats().funcCount == 0);
+
+  INFO("Deleting tenants");
+  EXPECT(rt.deleteTenant(b) == kErrorOk);
+  EXPECT(rt.getTenant(2) == nullptr && rt.getTenantCount() == 1);
+  EXPECT(rt.getStats().funcCount == 2);
+}
+#endif // ASMJIT_TEST && ASMJIT_BUILD_X86 && (ASMJIT_ARCH_X86 || ASMJIT_ARCH_X64)
+
+} // asmjit namespace
+
+// [Api-End]
+#include "../asmjit_apiend.h"
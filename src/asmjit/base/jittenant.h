@@ -0,0 +1,233 @@
+// [AsmJit]
+// Complete x86/x64 JIT and Remote Assembler for C++.
+//
+// [License]
+// Zlib - See LICENSE.md file in the package.
+
+// [Guard]
+#ifndef _ASMJIT_BASE_JITTENANT_H
+#define _ASMJIT_BASE_JITTENANT_H
+
+// [Dependencies]
+#include "../base/osutils.h"
+#include "../base/runtime.h"
+#include "../base/vmem.h"
+
+// [Api-Begin]
+#include "../asmjit_apibegin.h"
+
+namespace asmjit {
+
+//! \addtogroup asmjit_base
+//! \{
+
+// ============================================================================
+// [Forward Declarations]
+// ============================================================================
+
+class JitTenantRuntime;
+
+// ============================================================================
+// [asmjit::JitTenantStats]
+// ============================================================================
+
+//! Statistics of a \ref JitTenant, or of all tenants of a \ref JitTenantRuntime.
+struct JitTenantStats {
+  ASMJIT_INLINE void reset() noexcept { ::memset(this, 0, sizeof(*this)); }
+
+  ASMJIT_INLINE void add(const JitTenantStats& other) noexcept {
+    tenantCount    += other.tenantCount;
+    funcCount      += other.funcCount;
+    allocatedBytes += other.allocatedBytes;
+    usedBytes      += other.usedBytes;
+    quotaFailCount += other.quotaFailCount;
+  }
+
+  size_t tenantCount;                    //!< Count of tenants.
+  size_t funcCount;                      //!< Count of functions added and not released.
+  size_t allocatedBytes;                 //!< Virtual memory allocated by tenants.
+  size_t usedBytes;                      //!< Virtual memory used by functions.
+  uint64_t quotaFailCount;               //!< Count of `add()` calls rejected by a quota.
+};
+
+// ============================================================================
+// [asmjit::JitTenant]
+// ============================================================================
+
+//! Runtime of a single tenant of \ref JitTenantRuntime.
+//!
+//! Each tenant has its own \ref VMemMgr, so its code never shares a chunk
+//! of virtual memory with other tenants and only its own threads contend on
+//! its lock. The virtual memory allocated by the tenant (including unused
+//! parts of its chunks) is limited by its quota, `add()` that would exceed
+//! it fails with `kErrorQuotaExceeded` without affecting other tenants.
+//!
+//! Tenants are created and destroyed by \ref JitTenantRuntime. Unlike
+//! \ref JitRuntime, a tenant doesn't register unwind tables, notify
+//! listeners, or defer releases.
+class ASMJIT_VIRTAPI JitTenant : public HostRuntime {
+public:
+  ASMJIT_NONCOPYABLE(JitTenant)
+
+  // --------------------------------------------------------------------------
+  // [Construction / Destruction]
+  // --------------------------------------------------------------------------
+
+  //! Create a tenant `id` of `owner`, use \ref JitTenantRuntime::newTenant().
+  ASMJIT_API JitTenant(JitTenantRuntime* owner, uint64_t id, size_t quota) noexcept;
+  //! Destroy the tenant and release all its code.
+  ASMJIT_API virtual ~JitTenant() noexcept;
+
+  // --------------------------------------------------------------------------
+  // [Accessors]
+  // --------------------------------------------------------------------------
+
+  //! Get the runtime that owns the tenant.
+  ASMJIT_INLINE JitTenantRuntime* getOwner() const noexcept { return _owner; }
+  //! Get the tenant id.
+  ASMJIT_INLINE uint64_t getId() const noexcept { return _id; }
+
+  //! Get the virtual memory manager of the tenant.
+  //!
+  //! It can be configured (dual mapping, address range) before the first
+  //! function is added.
+  ASMJIT_INLINE VMemMgr* getMemMgr() const noexcept { return const_cast<VMemMgr*>(&_memMgr); }
+
+  //! Get the quota in bytes, zero if unlimited.
+  ASMJIT_API size_t getQuota() const noexcept;
+  //! Set the quota in bytes, zero if unlimited.
+  //!
+  //! A quota lower than the memory already allocated only rejects new code.
+  ASMJIT_API void setQuota(size_t quota) noexcept;
+
+  //! Get the statistics of the tenant.
+  ASMJIT_API JitTenantStats getStats() const noexcept;
+
+  // --------------------------------------------------------------------------
+  // [Interface]
+  // --------------------------------------------------------------------------
+
+  ASMJIT_API Error _add(void** dst, CodeHolder* code) noexcept override;
+  ASMJIT_API Error _release(void* p) noexcept override;
+
+  //! Release all functions of the tenant at once and return their count.
+  //!
+  //! All chunks of the tenant are returned to the system, the cost depends
+  //! on their count, not on the count of functions. No thread can execute
+  //! code of the tenant anymore.
+  ASMJIT_API size_t releaseAll() noexcept;
+
+  // --------------------------------------------------------------------------
+  // [Members]
+  // --------------------------------------------------------------------------
+
+  JitTenantRuntime* _owner;              //!< Runtime that owns the tenant.
+  JitTenant* _shardNext;                 //!< Next tenant of the same shard.
+  uint64_t _id;                          //!< Tenant id.
+
+  mutable Lock _lock;                    //!< Lock of the quota and accounting.
+  size_t _quota;                         //!< Quota in bytes, zero if unlimited.
+  size_t _funcCount;                     //!< Count of functions.
+  uint64_t _quotaFailCount;              //!< Count of `add()` rejected by the quota.
+  VMemMgr _memMgr;                       //!< Virtual memory of the tenant.
+};
+
+// ============================================================================
+// [asmjit::JitTenantRuntime]
+// ============================================================================
+
+//! Runtime shared by many tenants of one process.
+//!
+//! A single \ref JitRuntime keeps code of all its users in the same chunks,
+//! so code released by one user fragments memory of everybody and all of
+//! them contend on a single lock. `JitTenantRuntime` gives each tenant its
+//! own \ref JitTenant instead, which is a \ref Runtime that can be passed to
+//! \ref CodeHolder::init() and used to add code. Tenants are registered in
+//! `kShardCount` shards by their id, so creating, destroying, and looking up
+//! tenants only locks a single shard.
+//!
+//! ~~~
+//! JitTenantRuntime rt;
+//! JitTenant* tenant;
+//! rt.newTenant(&tenant, connectionId, 16 * 1024 * 1024);
+//!
+//! CodeHolder code;
+//! code.init(tenant->getCodeInfo());
+//! // ... generate the code ...
+//! tenant->add(&fn, &code);                 // kErrorQuotaExceeded if over quota.
+//!
+//! // ... when the tenant disconnects ...
+//! rt.deleteTenant(tenant);                 // Releases all its code at once.
+//! ~~~
+//!
+//! The runtime doesn't reference count tenants - a tenant returned by
+//! `getTenant()` is valid until it's deleted by `deleteTenant()`.
+class JitTenantRuntime {
+public:
+  ASMJIT_NONCOPYABLE(JitTenantRuntime)
+
+  enum {
+    //! Log2 of the count of shards.
+    kShardShift = 4,
+    //! Count of shards.
+    kShardCount = 1 << kShardShift
+  };
+
+  // --------------------------------------------------------------------------
+  // [Construction / Destruction]
+  // --------------------------------------------------------------------------
+
+  //! Create a `JitTenantRuntime` without tenants.
+  ASMJIT_API JitTenantRuntime() noexcept;
+  //! Destroy the `JitTenantRuntime` and all its tenants.
+  ASMJIT_API ~JitTenantRuntime() noexcept;
+
+  // --------------------------------------------------------------------------
+  // [Tenants]
+  // --------------------------------------------------------------------------
+
+  //! Create a new tenant `id` with `quota` bytes of virtual memory (zero if
+  //! unlimited). Returns `kErrorInvalidArgument` if the tenant already exists.
+  ASMJIT_API Error newTenant(JitTenant** out, uint64_t id, size_t quota = 0) noexcept;
+  //! Delete `tenant` and release all its code, see \ref JitTenant::releaseAll().
+  ASMJIT_API Error deleteTenant(JitTenant* tenant) noexcept;
+
+  //! Get the tenant `id`, or null if it doesn't exist.
+  ASMJIT_API JitTenant* getTenant(uint64_t id) const noexcept;
+  //! Get the count of tenants.
+  ASMJIT_API size_t getTenantCount() const noexcept;
+
+  //! Get statistics of all tenants.
+  ASMJIT_API JitTenantStats getStats() const noexcept;
+
+  //! Get the shard of the tenant `id`.
+  static ASMJIT_INLINE uint32_t getShardIndex(uint64_t id) noexcept {
+    uint32_t hVal = static_cast<uint32_t>(id ^ (id >> 32)) * 0x9E3779B1U;
+    return hVal >> (32 - kShardShift);
+  }
+
+  // --------------------------------------------------------------------------
+  // [Members]
+  // --------------------------------------------------------------------------
+
+  //! \internal
+  //!
+  //! Tenants of a shard.
+  struct Shard {
+    mutable Lock lock;                   //!< Lock of the shard.
+    JitTenant* first;                    //!< First tenant.
+    size_t count;                        //!< Count of tenants.
+  };
+
+  Shard _shards[kShardCount];            //!< Shards.
+};
+
+//! \}
+
+} // asmjit namespace
+
+// [Api-End]
+#include "../asmjit_apiend.h"
+
+// [Guard]
+#endif // _ASMJIT_BASE_JITTENANT_H
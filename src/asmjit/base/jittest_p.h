@@ -0,0 +1,89 @@
+// [AsmJit]
+// Complete x86/x64 JIT and Remote Assembler for C++.
+//
+// [License]
+// Zlib - See LICENSE.md file in the package.
+
+// [Guard]
+#ifndef _ASMJIT_BASE_JITTEST_P_H
+#define _ASMJIT_BASE_JITTEST_P_H
+
+#include "../asmjit_build.h"
+#if defined(ASMJIT_TEST) && defined(ASMJIT_BUILD_X86) && (ASMJIT_ARCH_X86 || ASMJIT_ARCH_X64)
+
+// [Dependencies]
+#include "../base/codeholder.h"
+#include "../base/runtime.h"
+#include "../x86/x86assembler.h"
+
+// [Api-Begin]
+#include "../asmjit_apibegin.h"
+
+namespace asmjit {
+
+//! \addtogroup asmjit_base
+//! \{
+
+// ============================================================================
+// [asmjit::JitTest]
+// ============================================================================
+
+//! \internal
+//!
+//! Append `mov eax, value; ret` to the end of `code`, padded by `int3` to
+//! `size` bytes if the function is shorter. Used by unit tests of runtimes,
+//! which need small host functions they can call.
+static ASMJIT_INLINE Error JitTest_emitReturn(CodeHolder* code, uint32_t value, size_t size = 0) noexcept {
+  X86Assembler a(code);
+  size_t start = a.getOffset();
+
+  ASMJIT_PROPAGATE(a.mov(x86::eax, value));
+  ASMJIT_PROPAGATE(a.ret());
+
+  while (a.getOffset() - start < size)
+    ASMJIT_PROPAGATE(a.int3());
+  return kErrorOk;
+}
+
+//! \internal
+//!
+//! Initialize `code` for `runtime` and emit a function that returns `value`,
+//! see \ref JitTest_emitReturn().
+static ASMJIT_INLINE Error JitTest_initReturn(CodeHolder* code, const Runtime& runtime, uint32_t value, size_t size = 0) noexcept {
+  ASMJIT_PROPAGATE(code->init(runtime.getCodeInfo()));
+  return JitTest_emitReturn(code, value, size);
+}
+
+//! \internal
+//!
+//! Append `mov eax|rax, imm; ret` to the end of `code`, which returns its own
+//! address patched by an absolute relocation of `imm`. Used by unit tests of
+//! runtimes that relocate code to a different address than it's written to.
+static ASMJIT_INLINE Error JitTest_emitSelf(CodeHolder* code) noexcept {
+  X86Assembler a(code);
+  uint32_t gpSize = a.getGpSize();
+
+  // An immediate that doesn't fit 32 bits forces `mov rax, imm64`.
+  ASMJIT_PROPAGATE(a.mov(a.zax(), Imm(gpSize == 8 ? ASMJIT_UINT64_C(0x8000000000000000) : 0)));
+  size_t immOffset = a.getOffset() - gpSize;
+  ASMJIT_PROPAGATE(a.ret());
+
+  RelocEntry* re;
+  ASMJIT_PROPAGATE(code->newRelocEntry(&re, RelocEntry::kTypeRelToAbs, gpSize));
+  re->_sourceSectionId = 0;
+  re->_targetSectionId = 0;
+  re->_sourceOffset = immOffset;
+  re->_data = 0;
+  return kErrorOk;
+}
+
+//! \}
+
+} // asmjit namespace
+
+// [Api-End]
+#include "../asmjit_apiend.h"
+
+// [Guard]
+#endif // ASMJIT_TEST && ASMJIT_BUILD_X86 && (ASMJIT_ARCH_X86 || ASMJIT_ARCH_X64)
+#endif // _ASMJIT_BASE_JITTEST_P_H
@@ -0,0 +1,819 @@
+// [AsmJit]
+// Complete x86/x64 JIT and Remote Assembler for C++.
+//
+// [License]
+// Zlib - See LICENSE.md file in the package.
+
+// [Export]
+#define ASMJIT_EXPORTS
+
+// [Dependencies]
+#include "../base/jitunwind.h"
+#include "../base/utils.h"
+
+#if (ASMJIT_ARCH_X86 || ASMJIT_ARCH_X64) && ASMJIT_OS_LINUX && (ASMJIT_CC_GCC || ASMJIT_CC_CLANG)
+# define ASMJIT_UNWIND_DWARF
+# include "../x86/x86operand.h"
+// Provided by libgcc (libgcc_s), `begin` points to a zero terminated list of
+// CIE and FDE records (the content of `.eh_frame` section).
+extern "C" void __register_frame(void* begin);
+extern "C" void __deregister_frame(void* begin);
+#elif ASMJIT_ARCH_X64 && ASMJIT_OS_WINDOWS
+# define ASMJIT_UNWIND_WIN64
+#endif
+
+// [Api-Begin]
+#include "../asmjit_apibegin.h"
+
+namespace asmjit {
+
+// ============================================================================
+// [asmjit::JitUnwind - Writer]
+// ============================================================================
+
+//! \internal
+//!
+//! Writes the table, or only measures it if `_data` is null.
+struct JitUnwindWriter {
+  ASMJIT_INLINE JitUnwindWriter(uint8_t* data) noexcept
+    : _data(data),
+      _pos(0) {}
+
+  ASMJIT_INLINE void u8(uint32_t x) noexcept {
+    if (_data) _data[_pos] = static_cast<uint8_t>(x);
+    _pos += 1;
+  }
+
+  ASMJIT_INLINE void u16(uint32_t x) noexcept {
+    if (_data) Utils::writeU16u(_data + _pos, x);
+    _pos += 2;
+  }
+
+  ASMJIT_INLINE void u32(uint32_t x) noexcept {
+    if (_data) Utils::writeU32u(_data + _pos, x);
+    _pos += 4;
+  }
+
+  ASMJIT_INLINE void u32At(size_t pos, uint32_t x) noexcept {
+    if (_data) Utils::writeU32u(_data + pos, x);
+  }
+
+  ASMJIT_INLINE void ptr(uint64_t x) noexcept {
+#if ASMJIT_ARCH_64BIT
+    if (_data) Utils::writeU64u(_data + _pos, x);
+    _pos += 8;
+#else
+    u32(static_cast<uint32_t>(x));
+#endif
+  }
+
+  ASMJIT_INLINE void uleb(uint32_t x) noexcept {
+    do {
+      uint32_t b = x & 0x7F;
+      x >>= 7;
+      u8(x ? b | 0x80 : b);
+    } while (x);
+  }
+
+  ASMJIT_INLINE void sleb(int32_t x) noexcept {
+    for (;;) {
+      uint32_t b = static_cast<uint32_t>(x) & 0x7F;
+      x >>= 7;
+      if ((x == 0 && !(b & 0x40)) || (x == -1 && (b & 0x40))) {
+        u8(b);
+        break;
+      }
+      u8(b | 0x80);
+    }
+  }
+
+  ASMJIT_INLINE void align(size_t alignment) noexcept {
+    while (_pos & (alignment - 1))
+      u8(0);
+  }
+
+  uint8_t* _data;                        //!< Table data (or null when measuring).
+  size_t _pos;                           //!< Current position.
+};
+
+// ============================================================================
+// [asmjit::JitUnwind - Functions]
+// ============================================================================
+
+//! \internal
+//!
+//! Function described by a prolog of `UnwindOp`s, see `JitUnwind_initFunc()`.
+struct JitUnwindFunc {
+  uint32_t begin;                        //!< Index of `kTypeFuncBegin`.
+  uint32_t prologEnd;                    //!< Index of `kTypePrologEnd`.
+  uint64_t start;                        //!< Offset of the function.
+  uint64_t end;                          //!< Offset of the next function or the end of its section.
+};
+
+//! \internal
+//!
+//! Get the offset of the label `labelId` within the relocated code.
+static bool JitUnwind_getOffset(const CodeHolder* code, uint32_t labelId, uint64_t& out) noexcept {
+  LabelEntry* le = code->getLabelEntry(labelId);
+  if (!le || !le->isBound())
+    return false;
+
+  out = code->getSectionEntry(le->getSectionId())->getOffset() + static_cast<uint64_t>(le->getOffset());
+  return true;
+}
+
+//! \internal
+//!
+//! Get the index of the op of `type` that ends a sequence started at `index`.
+static bool JitUnwind_findEnd(const UnwindOp* ops, size_t count, uint32_t index, uint32_t type, uint32_t& out) noexcept {
+  for (size_t i = index + 1; i < count; i++) {
+    if (ops[i].type == type) {
+      out = static_cast<uint32_t>(i);
+      return true;
+    }
+    if (ops[i].type == UnwindOp::kTypeFuncBegin || ops[i].type == UnwindOp::kTypeEpilogBegin)
+      break;
+  }
+  return false;
+}
+
+//! \internal
+//!
+//! Initialize `func` of a prolog that starts at `index`. The function ends at
+//! the next function of the same section, or at the end of the section.
+static bool JitUnwind_initFunc(const CodeHolder* code, uint32_t index, JitUnwindFunc& func) noexcept {
+  const UnwindOp* ops = code->getUnwindOps().getData();
+  size_t count = code->getUnwindOps().getLength();
+
+  if (!JitUnwind_findEnd(ops, count, index, UnwindOp::kTypePrologEnd, func.prologEnd))
+    return false;
+
+  if (!JitUnwind_getOffset(code, ops[index].labelId, func.start))
+    return false;
+
+  const LabelEntry* le = code->getLabelEntry(ops[index].labelId);
+  const SectionEntry* section = code->getSectionEntry(le->getSectionId());
+
+  func.begin = index;
+  func.end = section->getOffset() + section->getBuffer().getLength();
+
+  for (size_t i = 0; i < count; i++) {
+    uint64_t offset;
+    if (ops[i].type == UnwindOp::kTypeFuncBegin &&
+        code->getLabelEntry(ops[i].labelId)->getSectionId() == le->getSectionId() &&
+        JitUnwind_getOffset(code, ops[i].labelId, offset) &&
+        offset > func.start && offset < func.end) {
+      func.end = offset;
+    }
+  }
+
+  return func.start < func.end;
+}
+
+//! \internal
+//!
+//! Find the first non-empty epilog of `func` that starts at or after
+//! `minOffset`. Epilogs are not recorded in the order of their offsets, for
+//! example the register allocator emits epilogs of tail calls first.
+static bool JitUnwind_nextEpilog(const CodeHolder* code, const JitUnwindFunc& func, uint64_t minOffset, uint32_t& begin, uint32_t& end) noexcept {
+  const UnwindOp* ops = code->getUnwindOps().getData();
+  size_t count = code->getUnwindOps().getLength();
+
+  uint64_t bestOffset = func.end;
+  bool found = false;
+
+  for (size_t i = 0; i < count; i++) {
+    uint64_t beginOffset, endOffset;
+    uint32_t endIndex;
+
+    if (ops[i].type != UnwindOp::kTypeEpilogBegin ||
+        !JitUnwind_getOffset(code, ops[i].labelId, beginOffset) ||
+        beginOffset < minOffset || beginOffset >= bestOffset ||
+        !JitUnwind_findEnd(ops, count, static_cast<uint32_t>(i), UnwindOp::kTypeEpilogEnd, endIndex) ||
+        !JitUnwind_getOffset(code, ops[endIndex].labelId, endOffset) ||
+        endOffset <= beginOffset || endOffset > func.end) {
+      continue;
+    }
+
+    begin = static_cast<uint32_t>(i);
+    end = endIndex;
+    bestOffset = beginOffset;
+    found = true;
+  }
+
+  return found;
+}
+
+// ============================================================================
+// [asmjit::JitUnwind - DWARF]
+// ============================================================================
+
+#if defined(ASMJIT_UNWIND_DWARF)
+//! \internal
+//!
+//! DWARF call frame instructions and expression operators.
+ASMJIT_ENUM(DwarfConst) {
+  kDwCfaAdvanceLoc       = 0x40,
+  kDwCfaOffset           = 0x80,
+  kDwCfaRestore          = 0xC0,
+  kDwCfaAdvanceLoc1      = 0x02,
+  kDwCfaAdvanceLoc2      = 0x03,
+  kDwCfaAdvanceLoc4      = 0x04,
+  kDwCfaRememberState    = 0x0A,
+  kDwCfaRestoreState     = 0x0B,
+  kDwCfaDefCfa           = 0x0C,
+  kDwCfaDefCfaRegister   = 0x0D,
+  kDwCfaDefCfaOffset     = 0x0E,
+  kDwCfaDefCfaExpression = 0x0F,
+
+  kDwOpDeref             = 0x06,
+  kDwOpPlusUConst        = 0x23,
+  kDwOpBreg0             = 0x70
+};
+
+//! \internal
+//!
+//! Size of general purpose registers and the return address.
+static const int32_t kDwarfGpSize = ASMJIT_ARCH_64BIT ? 8 : 4;
+//! \internal
+//!
+//! DWARF register of the return address.
+static const uint32_t kDwarfRaReg = ASMJIT_ARCH_64BIT ? 16 : 8;
+//! \internal
+//!
+//! CFA is computed by an expression, see `JitUnwindDwarfState::cfaReg`.
+static const uint32_t kDwarfCfaExpr = 0xFF;
+
+//! \internal
+//!
+//! Map X86 register id to DWARF register number.
+static ASMJIT_INLINE uint32_t JitUnwind_dwarfReg(uint32_t regId) noexcept {
+#if ASMJIT_ARCH_64BIT
+  static const uint8_t map[8] = { 0, 2, 1, 3, 7, 6, 4, 5 };
+  return regId < 8 ? map[regId] : regId;
+#else
+  return regId;
+#endif
+}
+
+//! \internal
+//!
+//! Tracks the canonical frame address (CFA), which is `sp` of the caller.
+struct JitUnwindDwarfState {
+  uint32_t cfaReg;                       //!< Register the CFA is relative to (or `kDwarfCfaExpr`).
+  int32_t cfaOffset;                     //!< Offset of the CFA from `cfaReg`.
+  uint32_t frameReg;                     //!< Frame pointer (or `kInvalidRegId`).
+  int32_t spOffset;                      //!< Distance from `sp` to the CFA.
+  bool spKnown;                          //!< `spOffset` is known (`sp` not aligned dynamically).
+};
+
+static bool JitUnwind_dwarfAdvance(JitUnwindWriter& w, uint64_t& loc, uint64_t offset) noexcept {
+  if (offset < loc)
+    return false;
+
+  uint64_t delta = offset - loc;
+  if (delta == 0)
+    return true;
+
+  if (delta < 0x40) {
+    w.u8(kDwCfaAdvanceLoc | static_cast<uint32_t>(delta));
+  }
+  else if (delta <= 0xFF) {
+    w.u8(kDwCfaAdvanceLoc1);
+    w.u8(static_cast<uint32_t>(delta));
+  }
+  else if (delta <= 0xFFFF) {
+    w.u8(kDwCfaAdvanceLoc2);
+    w.u16(static_cast<uint32_t>(delta));
+  }
+  else if (delta <= 0xFFFFFFFFU) {
+    w.u8(kDwCfaAdvanceLoc4);
+    w.u32(static_cast<uint32_t>(delta));
+  }
+  else {
+    return false;
+  }
+
+  loc = offset;
+  return true;
+}
+
+static ASMJIT_INLINE void JitUnwind_dwarfDefCfa(JitUnwindWriter& w, JitUnwindDwarfState& state, uint32_t regId, int32_t offset) noexcept {
+  state.cfaReg = regId;
+  state.cfaOffset = offset;
+
+  w.u8(kDwCfaDefCfa);
+  w.uleb(JitUnwind_dwarfReg(regId));
+  w.uleb(static_cast<uint32_t>(offset));
+}
+
+static ASMJIT_INLINE void JitUnwind_dwarfMoveSp(JitUnwindWriter& w, JitUnwindDwarfState& state, int32_t delta) noexcept {
+  state.spOffset += delta;
+  if (state.cfaReg == X86Gp::kIdSp) {
+    state.cfaOffset = state.spOffset;
+    w.u8(kDwCfaDefCfaOffset);
+    w.uleb(static_cast<uint32_t>(state.cfaOffset));
+  }
+}
+
+static bool JitUnwind_dwarfOp(JitUnwindWriter& w, JitUnwindDwarfState& state, const UnwindOp& op) noexcept {
+  switch (op.type) {
+    case UnwindOp::kTypePush:
+      if (!state.spKnown) return false;
+      JitUnwind_dwarfMoveSp(w, state, kDwarfGpSize);
+
+      // The register is saved at `CFA - spOffset`.
+      if (JitUnwind_dwarfReg(op.regId) >= 0x40) return false;
+      w.u8(kDwCfaOffset | JitUnwind_dwarfReg(op.regId));
+      w.uleb(static_cast<uint32_t>(state.spOffset / kDwarfGpSize));
+      return true;
+
+    case UnwindOp::kTypeSetFrame:
+      state.cfaReg = op.regId;
+      state.frameReg = op.regId;
+      w.u8(kDwCfaDefCfaRegister);
+      w.uleb(JitUnwind_dwarfReg(op.regId));
+      return true;
+
+    case UnwindOp::kTypeAlign:
+      state.spKnown = false;
+      if (state.cfaReg == X86Gp::kIdSp) {
+        // The unaligned `sp` was copied to `regId` before it was aligned.
+        if (op.regId == Globals::kInvalidRegId) return false;
+        JitUnwind_dwarfDefCfa(w, state, op.regId, state.spOffset);
+      }
+      return true;
+
+    case UnwindOp::kTypeAlloc:
+      if (state.spKnown)
+        JitUnwind_dwarfMoveSp(w, state, op.value);
+      return true;
+
+    case UnwindOp::kTypeSaveSp:
+      // The register that holds the unaligned `sp` can be reused by the body,
+      // the CFA is loaded from the stack slot instead: `[sp + value] + offset`.
+      if (state.cfaReg == op.regId && state.cfaReg != state.frameReg) {
+        JitUnwindWriter expr(nullptr);
+        expr.sleb(op.value);
+        expr.uleb(static_cast<uint32_t>(state.cfaOffset));
+
+        w.u8(kDwCfaDefCfaExpression);
+        w.uleb(static_cast<uint32_t>(expr._pos + 3));
+        w.u8(kDwOpBreg0 + JitUnwind_dwarfReg(X86Gp::kIdSp));
+        w.sleb(op.value);
+        w.u8(kDwOpDeref);
+        w.u8(kDwOpPlusUConst);
+        w.uleb(static_cast<uint32_t>(state.cfaOffset));
+        state.cfaReg = kDwarfCfaExpr;
+      }
+      return true;
+
+    case UnwindOp::kTypeRestoreSp:
+      state.spOffset = op.value;
+      state.spKnown = true;
+      if (state.cfaReg != X86Gp::kIdSp && state.cfaReg != state.frameReg)
+        JitUnwind_dwarfDefCfa(w, state, X86Gp::kIdSp, op.value);
+      return true;
+
+    case UnwindOp::kTypeFree:
+      if (!state.spKnown) return false;
+      JitUnwind_dwarfMoveSp(w, state, -op.value);
+      return true;
+
+    case UnwindOp::kTypePop:
+      if (!state.spKnown) return false;
+      if (state.cfaReg == op.regId) {
+        // Frame pointer restored, the CFA is relative to `sp` again.
+        state.spOffset -= kDwarfGpSize;
+        JitUnwind_dwarfDefCfa(w, state, X86Gp::kIdSp, state.spOffset);
+      }
+      else {
+        JitUnwind_dwarfMoveSp(w, state, -kDwarfGpSize);
+      }
+
+      if (JitUnwind_dwarfReg(op.regId) >= 0x40) return false;
+      w.u8(kDwCfaRestore | JitUnwind_dwarfReg(op.regId));
+      return true;
+
+    default:
+      // Vector registers are not callee-saved by any calling convention that
+      // uses DWARF unwinding.
+      return true;
+  }
+}
+
+static bool JitUnwind_dwarfOps(JitUnwindWriter& w, JitUnwindDwarfState& state, const CodeHolder* code, uint32_t first, uint32_t last, uint64_t& loc) noexcept {
+  const UnwindOp* ops = code->getUnwindOps().getData();
+
+  for (uint32_t i = first; i < last; i++) {
+    uint64_t offset;
+    if (!JitUnwind_getOffset(code, ops[i].labelId, offset) ||
+        !JitUnwind_dwarfAdvance(w, loc, offset) ||
+        !JitUnwind_dwarfOp(w, state, ops[i])) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+static void JitUnwind_dwarfCie(JitUnwindWriter& w) noexcept {
+  size_t start = w._pos;
+
+  w.u32(0);                              // Length (patched).
+  w.u32(0);                              // CIE id.
+  w.u8(1);                               // Version.
+  w.u8('z');                             // Augmentation "zR".
+  w.u8('R');
+  w.u8(0);
+  w.uleb(1);                             // Code alignment factor.
+  w.sleb(-kDwarfGpSize);                 // Data alignment factor.
+  w.u8(kDwarfRaReg);                     // Return address register.
+  w.uleb(1);                             // Augmentation data length.
+  w.u8(0);                               // FDE pointers are absolute (DW_EH_PE_absptr).
+
+  // At the entry the CFA is `sp + gpSize` and the return address is at CFA - gpSize.
+  w.u8(kDwCfaDefCfa);
+  w.uleb(JitUnwind_dwarfReg(X86Gp::kIdSp));
+  w.uleb(static_cast<uint32_t>(kDwarfGpSize));
+  w.u8(kDwCfaOffset | kDwarfRaReg);
+  w.uleb(1);
+
+  w.align(static_cast<size_t>(kDwarfGpSize));
+  w.u32At(start, static_cast<uint32_t>(w._pos - start - 4));
+}
+
+static bool JitUnwind_dwarfFde(JitUnwindWriter& w, size_t ciePos, const CodeHolder* code, const JitUnwindFunc& func, uint64_t address) noexcept {
+  const UnwindOp* ops = code->getUnwindOps().getData();
+  size_t start = w._pos;
+
+  w.u32(0);                              // Length (patched).
+  w.u32(static_cast<uint32_t>(w._pos - ciePos));
+  w.ptr(address + func.start);           // PC begin.
+  w.ptr(func.end - func.start);          // PC range.
+  w.uleb(0);                             // Augmentation data length.
+
+  JitUnwindDwarfState state;
+  state.cfaReg = X86Gp::kIdSp;
+  state.cfaOffset = kDwarfGpSize;
+  state.frameReg = Globals::kInvalidRegId;
+  state.spOffset = kDwarfGpSize;
+  state.spKnown = true;
+
+  uint64_t loc = func.start;
+  uint64_t minOffset;
+  uint32_t begin, end;
+
+  if (!JitUnwind_dwarfOps(w, state, code, func.begin + 1, func.prologEnd, loc) ||
+      !JitUnwind_getOffset(code, ops[func.prologEnd].labelId, minOffset)) {
+    w._pos = start;
+    return false;
+  }
+
+  // Each epilog is described between 'remember_state' and 'restore_state', so
+  // the code that follows it continues with the state of the function body.
+  while (JitUnwind_nextEpilog(code, func, minOffset, begin, end)) {
+    JitUnwindDwarfState saved = state;
+    uint64_t offset;
+
+    JitUnwind_getOffset(code, ops[begin].labelId, offset);
+    if (!JitUnwind_dwarfAdvance(w, loc, offset)) {
+      w._pos = start;
+      return false;
+    }
+    w.u8(kDwCfaRememberState);
+
+    if (!JitUnwind_dwarfOps(w, state, code, begin + 1, end, loc)) {
+      w._pos = start;
+      return false;
+    }
+
+    JitUnwind_getOffset(code, ops[end].labelId, minOffset);
+    if (!JitUnwind_dwarfAdvance(w, loc, minOffset)) {
+      w._pos = start;
+      return false;
+    }
+    w.u8(kDwCfaRestoreState);
+    state = saved;
+  }
+
+  w.align(static_cast<size_t>(kDwarfGpSize));
+  w.u32At(start, static_cast<uint32_t>(w._pos - start - 4));
+  return true;
+}
+
+//! \internal
+//!
+//! Write `.eh_frame` of all functions, returns its size, or zero if there
+//! is no function to describe.
+static size_t JitUnwind_dwarfTable(uint8_t* data, void* const* addresses, CodeHolder* const* codes, size_t count) noexcept {
+  JitUnwindWriter w(data);
+  JitUnwind_dwarfCie(w);
+
+  size_t fdeCount = 0;
+  for (size_t i = 0; i < count; i++) {
+    const CodeHolder* code = codes[i];
+    const UnwindOp* ops = code->getUnwindOps().getData();
+    size_t opCount = code->getUnwindOps().getLength();
+    uint64_t address = addresses ? static_cast<uint64_t>((uintptr_t)addresses[i]) : uint64_t(0);
+
+    for (size_t j = 0; j < opCount; j++) {
+      JitUnwindFunc func;
+      if (ops[j].type == UnwindOp::kTypeFuncBegin &&
+          JitUnwind_initFunc(code, static_cast<uint32_t>(j), func) &&
+          JitUnwind_dwarfFde(w, 0, code, func, address)) {
+        fdeCount++;
+      }
+    }
+  }
+
+  if (!fdeCount)
+    return 0;
+
+  // Zero terminator.
+  w.u32(0);
+  return w._pos;
+}
+#endif // ASMJIT_UNWIND_DWARF
+
+// ============================================================================
+// [asmjit::JitUnwind - Win64]
+// ============================================================================
+
+#if defined(ASMJIT_UNWIND_WIN64)
+//! \internal
+//!
+//! Unwind operations of `UNWIND_CODE`.
+ASMJIT_ENUM(Win64UnwindConst) {
+  kUwopPushNonVol   = 0,
+  kUwopAllocLarge   = 1,
+  kUwopAllocSmall   = 2,
+  kUwopSetFpReg     = 3,
+  kUwopSaveXmm128   = 8,
+  kUwopSaveXmm128Far = 9,
+
+  //! Maximum count of `UNWIND_CODE` slots.
+  kUwMaxSlots       = 255
+};
+
+//! \internal
+//!
+//! `UNWIND_INFO` of a single function.
+struct JitUnwindWin64Info {
+  uint32_t prologSize;                   //!< Size of the prolog.
+  uint32_t frameReg;                     //!< Frame register (or zero).
+  uint32_t slotCount;                    //!< Count of `UNWIND_CODE` slots.
+  uint16_t slots[kUwMaxSlots + 1];       //!< `UNWIND_CODE` slots (in reverse order).
+
+  ASMJIT_INLINE uint32_t getSize() const noexcept {
+    return 4 + Utils::alignTo<uint32_t>(slotCount, 2) * 2;
+  }
+};
+
+//! \internal
+//!
+//! Encode the prolog of `func`, returns false if it can't be described.
+static bool JitUnwind_win64Info(const CodeHolder* code, const JitUnwindFunc& func, JitUnwindWin64Info& info) noexcept {
+  const UnwindOp* ops = code->getUnwindOps().getData();
+
+  // Slots are collected in the order of the prolog and reversed at the end,
+  // each operation is a group of 1-3 slots whose order must be kept.
+  uint16_t slots[kUwMaxSlots + 3];
+  uint8_t groups[kUwMaxSlots + 3];
+  uint32_t slotCount = 0;
+  uint32_t groupCount = 0;
+
+  info.frameReg = 0;
+
+  for (uint32_t i = func.begin + 1; i <= func.prologEnd; i++) {
+    const UnwindOp& op = ops[i];
+    uint64_t offset;
+
+    if (!JitUnwind_getOffset(code, op.labelId, offset) || offset - func.start > 0xFF)
+      return false;
+
+    uint32_t codeOffset = static_cast<uint32_t>(offset - func.start);
+    uint32_t first = slotCount;
+    uint32_t value = static_cast<uint32_t>(op.value);
+
+    if (slotCount > kUwMaxSlots)
+      return false;
+
+    switch (op.type) {
+      case UnwindOp::kTypePush:
+        slots[slotCount++] = static_cast<uint16_t>(codeOffset | (kUwopPushNonVol << 8) | (op.regId << 12));
+        break;
+
+      case UnwindOp::kTypeSetFrame:
+        info.frameReg = op.regId;
+        slots[slotCount++] = static_cast<uint16_t>(codeOffset | (kUwopSetFpReg << 8));
+        break;
+
+      case UnwindOp::kTypeAlloc:
+        if (value == 0) break;
+        if (value & 7) return false;
+
+        if (value <= 128) {
+          slots[slotCount++] = static_cast<uint16_t>(codeOffset | (kUwopAllocSmall << 8) | (((value - 8) / 8) << 12));
+        }
+        else if (value <= 0x7FFF8) {
+          slots[slotCount++] = static_cast<uint16_t>(codeOffset | (kUwopAllocLarge << 8));
+          slots[slotCount++] = static_cast<uint16_t>(value / 8);
+        }
+        else {
+          slots[slotCount++] = static_cast<uint16_t>(codeOffset | (kUwopAllocLarge << 8) | (1 << 12));
+          slots[slotCount++] = static_cast<uint16_t>(value & 0xFFFF);
+          slots[slotCount++] = static_cast<uint16_t>(value >> 16);
+        }
+        break;
+
+      case UnwindOp::kTypeSaveVec:
+        // The offset is relative to the frame register if used, which points
+        // above the saved registers in AsmJit's frame.
+        if (info.frameReg || op.regId > 15 || (value & 15)) return false;
+
+        if (value / 16 <= 0xFFFF) {
+          slots[slotCount++] = static_cast<uint16_t>(codeOffset | (kUwopSaveXmm128 << 8) | (op.regId << 12));
+          slots[slotCount++] = static_cast<uint16_t>(value / 16);
+        }
+        else {
+          slots[slotCount++] = static_cast<uint16_t>(codeOffset | (kUwopSaveXmm128Far << 8) | (op.regId << 12));
+          slots[slotCount++] = static_cast<uint16_t>(value & 0xFFFF);
+          slots[slotCount++] = static_cast<uint16_t>(value >> 16);
+        }
+        break;
+
+      case UnwindOp::kTypePrologEnd:
+        info.prologSize = codeOffset;
+        break;
+
+      case UnwindOp::kTypeAlign:
+      case UnwindOp::kTypeSaveSp:
+        // Dynamic stack alignment can't be described by `UNWIND_INFO`.
+        return false;
+
+      default:
+        break;
+    }
+
+    if (slotCount != first)
+      groups[groupCount++] = static_cast<uint8_t>(slotCount - first);
+  }
+
+  if (slotCount > kUwMaxSlots)
+    return false;
+
+  // Reverse the order of groups, the last operation of the prolog comes first.
+  uint32_t src = slotCount;
+  uint32_t dst = 0;
+
+  while (groupCount) {
+    uint32_t n = groups[--groupCount];
+    src -= n;
+    for (uint32_t k = 0; k < n; k++)
+      info.slots[dst++] = slots[src + k];
+  }
+
+  info.slotCount = slotCount;
+  return true;
+}
+
+//! \internal
+//!
+//! Write `RUNTIME_FUNCTION` array followed by `UNWIND_INFO` of each function,
+//! returns the size of the table and the count of functions in `fnCount`.
+static size_t JitUnwind_win64Table(uint8_t* data, uint64_t tableAddress, uint64_t base, void* const* addresses, CodeHolder* const* codes, size_t count, size_t& fnCount) noexcept {
+  JitUnwindWin64Info info;
+  size_t i, j;
+
+  // Count functions first, their `RUNTIME_FUNCTION` entries come first.
+  fnCount = 0;
+  for (i = 0; i < count; i++) {
+    const CodeHolder* code = codes[i];
+    const UnwindOp* ops = code->getUnwindOps().getData();
+    size_t opCount = code->getUnwindOps().getLength();
+
+    for (j = 0; j < opCount; j++) {
+      JitUnwindFunc func;
+      if (ops[j].type == UnwindOp::kTypeFuncBegin &&
+          JitUnwind_initFunc(code, static_cast<uint32_t>(j), func) &&
+          JitUnwind_win64Info(code, func, info)) {
+        fnCount++;
+      }
+    }
+  }
+
+  if (!fnCount)
+    return 0;
+
+  JitUnwindWriter w(data);
+  size_t fnPos = 0;
+  size_t infoPos = fnCount * 12;
+
+  for (i = 0; i < count; i++) {
+    const CodeHolder* code = codes[i];
+    const UnwindOp* ops = code->getUnwindOps().getData();
+    size_t opCount = code->getUnwindOps().getLength();
+    uint64_t address = addresses ? static_cast<uint64_t>((uintptr_t)addresses[i]) : base;
+
+    for (j = 0; j < opCount; j++) {
+      JitUnwindFunc func;
+      if (ops[j].type != UnwindOp::kTypeFuncBegin ||
+          !JitUnwind_initFunc(code, static_cast<uint32_t>(j), func) ||
+          !JitUnwind_win64Info(code, func, info)) {
+        continue;
+      }
+
+      // RUNTIME_FUNCTION.
+      w._pos = fnPos;
+      w.u32(static_cast<uint32_t>(address + func.start - base));
+      w.u32(static_cast<uint32_t>(address + func.end - base));
+      w.u32(static_cast<uint32_t>(tableAddress + infoPos - base));
+      fnPos = w._pos;
+
+      // UNWIND_INFO.
+      w._pos = infoPos;
+      w.u8(1);
+      w.u8(info.prologSize);
+      w.u8(info.slotCount);
+      w.u8(info.frameReg);
+      for (uint32_t k = 0; k < info.slotCount; k++)
+        w.u16(info.slots[k]);
+      w.align(4);
+      infoPos = w._pos;
+    }
+  }
+
+  return infoPos;
+}
+#endif // ASMJIT_UNWIND_WIN64
+
+// ============================================================================
+// [asmjit::JitUnwind - Interface]
+// ============================================================================
+
+size_t JitUnwind::getTableSize(CodeHolder* const* codes, size_t count) noexcept {
+  size_t i;
+  for (i = 0; i < count; i++)
+    if (!codes[i]->getUnwindOps().isEmpty())
+      break;
+
+  if (i == count)
+    return 0;
+
+#if defined(ASMJIT_UNWIND_DWARF)
+  return JitUnwind_dwarfTable(nullptr, nullptr, codes, count);
+#elif defined(ASMJIT_UNWIND_WIN64)
+  size_t fnCount;
+  return JitUnwind_win64Table(nullptr, 0, 0, nullptr, codes, count, fnCount);
+#else
+  return 0;
+#endif
+}
+
+Error JitUnwind::addTable(void* tableRx, void* tableRw, size_t size, void* base, void* const* addresses, CodeHolder* const* codes, size_t count) noexcept {
+#if defined(ASMJIT_UNWIND_DWARF)
+  ASMJIT_UNUSED(base);
+
+  if (ASMJIT_UNLIKELY(JitUnwind_dwarfTable(static_cast<uint8_t*>(tableRw), addresses, codes, count) != size))
+    return DebugUtils::errored(kErrorInvalidState);
+
+  __register_frame(tableRx);
+  return kErrorOk;
+#elif defined(ASMJIT_UNWIND_WIN64)
+  size_t fnCount;
+  uint64_t tableAddress = static_cast<uint64_t>((uintptr_t)tableRx);
+  uint64_t baseAddress = static_cast<uint64_t>((uintptr_t)base);
+
+  if (ASMJIT_UNLIKELY(JitUnwind_win64Table(static_cast<uint8_t*>(tableRw), tableAddress, baseAddress, addresses, codes, count, fnCount) != size))
+    return DebugUtils::errored(kErrorInvalidState);
+
+  if (!::RtlAddFunctionTable(static_cast<PRUNTIME_FUNCTION>(tableRx), static_cast<DWORD>(fnCount), static_cast<DWORD64>(baseAddress)))
+    return DebugUtils::errored(kErrorInvalidState);
+  return kErrorOk;
+#else
+  ASMJIT_UNUSED(tableRx);
+  ASMJIT_UNUSED(tableRw);
+  ASMJIT_UNUSED(size);
+  ASMJIT_UNUSED(base);
+  ASMJIT_UNUSED(addresses);
+  ASMJIT_UNUSED(codes);
+  ASMJIT_UNUSED(count);
+  return DebugUtils::errored(kErrorFeatureNotEnabled);
+#endif
+}
+
+void JitUnwind::removeTable(void* tableRx) noexcept {
+#if defined(ASMJIT_UNWIND_DWARF)
+  __deregister_frame(tableRx);
+#elif defined(ASMJIT_UNWIND_WIN64)
+  ::RtlDeleteFunctionTable(static_cast<PRUNTIME_FUNCTION>(tableRx));
+#else
+  ASMJIT_UNUSED(tableRx);
+#endif
+}
+
+} // asmjit namespace
+
+// [Api-End]
+#include "../asmjit_apiend.h"
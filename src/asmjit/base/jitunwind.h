@@ -0,0 +1,80 @@
+// [AsmJit]
+// Complete x86/x64 JIT and Remote Assembler for C++.
+//
+// [License]
+// Zlib - See LICENSE.md file in the package.
+
+// [Guard]
+#ifndef _ASMJIT_BASE_JITUNWIND_H
+#define _ASMJIT_BASE_JITUNWIND_H
+
+// [Dependencies]
+#include "../base/codeholder.h"
+
+// [Api-Begin]
+#include "../asmjit_apibegin.h"
+
+namespace asmjit {
+
+//! \addtogroup asmjit_base
+//! \{
+
+// ============================================================================
+// [asmjit::JitUnwind]
+// ============================================================================
+
+//! Unwind information of functions added to \ref JitRuntime.
+//!
+//! The information is built from \ref UnwindOp records of each \ref CodeHolder
+//! that had `CodeHolder::setUnwindEnabled()` set while its prologs and epilogs
+//! were emitted, nothing has to be described by hand:
+//!
+//!   - Linux (X86 and X64) - `.eh_frame` with a CIE and a FDE (DWARF CFI) of
+//!     each function, registered by `__register_frame()` of libgcc, so C++
+//!     exceptions and `_Unwind_Backtrace()` walk through the generated code.
+//!
+//!   - Windows (X64) - `RUNTIME_FUNCTION` and `UNWIND_INFO` of each function,
+//!     registered by `RtlAddFunctionTable()`. Functions that realign the stack
+//!     dynamically, and functions that save vector registers and preserve the
+//!     frame pointer, can't be described by `UNWIND_INFO` and are skipped.
+//!
+//! The table is stored in the same allocation as the code, right after it,
+//! and all functions of the allocation share it, so `JitRuntime::addBatch()`
+//! registers a single table for the whole batch. Registration is costly, as
+//! both libgcc and Windows insert each table into a global structure that is
+//! locked and searched by every unwind, that's why it's done per allocation
+//! and not per function. Other hosts don't support unwind information, the
+//! table size is always zero there.
+struct JitUnwind {
+  enum {
+    //! Alignment of the table.
+    kTableAlignment = 8
+  };
+
+  //! Get the size of the table of `count` functions stored in `codes`, zero
+  //! if none of them has unwind information or the host doesn't support it.
+  //!
+  //! Sections of each code must be laid out (see `CodeHolder::layoutSections()`).
+  ASMJIT_API static size_t getTableSize(CodeHolder* const* codes, size_t count) noexcept;
+
+  //! Build the table of `count` functions stored in `codes` and register it.
+  //!
+  //! The table is written to `tableRw` and registered at `tableRx`, which is
+  //! its executable address, `size` must match `getTableSize()`. The code of
+  //! `codes[i]` is relocated at `addresses[i]`, all functions and the table
+  //! are within the allocation that starts at `base`.
+  ASMJIT_API static Error addTable(void* tableRx, void* tableRw, size_t size, void* base, void* const* addresses, CodeHolder* const* codes, size_t count) noexcept;
+
+  //! Unregister the table registered at `tableRx` by `addTable()`.
+  ASMJIT_API static void removeTable(void* tableRx) noexcept;
+};
+
+//! \}
+
+} // asmjit namespace
+
+// [Api-End]
+#include "../asmjit_apiend.h"
+
+// [Guard]
+#endif // _ASMJIT_BASE_JITUNWIND_H
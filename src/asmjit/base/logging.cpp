@@ -46,6 +46,9 @@ namespace asmjit {
 
 Logger::Logger() noexcept {
   _options = 0;
+  _categories = kCategoryAll;
+  _level = kLevelTrace;
+  _enabled = 1;
   ::memset(_indentation, 0, ASMJIT_ARRAY_SIZE(_indentation));
 }
 Logger::~Logger() noexcept {}
@@ -106,6 +109,12 @@ Error Logger::logBinary(const void* data, size_t size) noexcept {
   return kErrorOk;
 }
 
+Error Logger::_logLazy(FormatFunc func, void* data) noexcept {
+  StringBuilderTmp<Logging::kMaxLineLength> sb;
+  ASMJIT_PROPAGATE(func(sb, data));
+  return log(sb);
+}
+
 // ============================================================================
 // [asmjit::Logger - Indentation]
 // ============================================================================
@@ -156,16 +165,111 @@ Error StringLogger::_log(const char* buf, size_t len) noexcept {
   return _stringBuilder.appendString(buf, len);
 }
 
+// ============================================================================
+// [asmjit::RingLogger - Construction / Destruction]
+// ============================================================================
+
+RingLogger::RingLogger(size_t capacity) noexcept
+  : _data(nullptr),
+    _capacity(0),
+    _total(0) {
+
+  if (capacity) {
+    _data = static_cast<char*>(Internal::allocMemory(capacity));
+    if (_data) _capacity = capacity;
+  }
+}
+
+RingLogger::~RingLogger() noexcept {
+  if (_data)
+    Internal::releaseMemory(_data);
+}
+
+// ============================================================================
+// [asmjit::RingLogger - Accessors]
+// ============================================================================
+
+size_t RingLogger::copyTo(char* dst, size_t size) const noexcept {
+  size_t length = getLength();
+  if (size > length)
+    size = length;
+
+  if (!size)
+    return 0;
+
+  // Copy the newest `size` bytes, `end` is the position after the newest byte.
+  size_t end = static_cast<size_t>(_total % _capacity);
+  size_t start = end >= size ? end - size : end + _capacity - size;
+
+  size_t first = std::min(size, _capacity - start);
+  ::memcpy(dst, _data + start, first);
+  ::memcpy(dst + first, _data, size - first);
+  return size;
+}
+
+Error RingLogger::getContent(StringBuilder& sb) const noexcept {
+  size_t length = getLength();
+  if (!length)
+    return kErrorOk;
+
+  char* dst = sb.prepare(StringBuilder::kStringOpAppend, length);
+
+  if (ASMJIT_UNLIKELY(!dst))
+    return DebugUtils::errored(kErrorNoHeapMemory);
+
+  copyTo(dst, length);
+  return kErrorOk;
+}
+
+// ============================================================================
+// [asmjit::RingLogger - Logging]
+// ============================================================================
+
+Error RingLogger::_log(const char* buf, size_t len) noexcept {
+  if (len == Globals::kInvalidIndex)
+    len = strlen(buf);
+
+  size_t capacity = _capacity;
+  if (ASMJIT_UNLIKELY(!capacity))
+    return kErrorOk;
+
+  _total += len;
+
+  // Only the last `capacity` bytes can be kept.
+  if (len > capacity) {
+    buf += len - capacity;
+    len = capacity;
+  }
+
+  // Position of `buf` so that its last byte is stored right before `end`.
+  size_t end = static_cast<size_t>(_total % capacity);
+  size_t start = end >= len ? end - len : end + capacity - len;
+
+  size_t first = std::min(len, capacity - start);
+  ::memcpy(_data + start, buf, first);
+  ::memcpy(_data, buf + first, len - first);
+  return kErrorOk;
+}
+
 // ============================================================================
 // [asmjit::Logging]
 // ============================================================================
 
+static ASMJIT_INLINE Error Logging_formatLabelId(StringBuilder& sb, uint32_t labelId) noexcept {
+  ASMJIT_PROPAGATE(sb.appendChar('L'));
+  return sb.appendUInt(Operand::unpackId(labelId));
+}
+
 Error Logging::formatLabel(
   StringBuilder& sb,
   uint32_t logOptions,
   const CodeEmitter* emitter,
   uint32_t labelId) noexcept {
 
+  // Offline formatting (see `TraceBuffer`) has no emitter to resolve names.
+  if (!emitter || !emitter->getCode())
+    return Logging_formatLabelId(sb, labelId);
+
   const LabelEntry* le = emitter->getCode()->getLabelEntry(labelId);
   if (ASMJIT_UNLIKELY(!le))
     return sb.appendFormat("InvalidLabel[Id=%u]", static_cast<unsigned int>(labelId));
@@ -178,7 +282,7 @@ Error Logging::formatLabel(
       if (ASMJIT_UNLIKELY(!pe))
         ASMJIT_PROPAGATE(sb.appendFormat("InvalidLabel[Id=%u]", static_cast<unsigned int>(labelId)));
       else if (ASMJIT_UNLIKELY(!pe->hasName()))
-        ASMJIT_PROPAGATE(sb.appendFormat("L%u", Operand::unpackId(parentId)));
+        ASMJIT_PROPAGATE(Logging_formatLabelId(sb, parentId));
       else
         ASMJIT_PROPAGATE(sb.appendString(pe->getName()));
 
@@ -187,7 +291,7 @@ Error Logging::formatLabel(
     return sb.appendString(le->getName());
   }
   else {
-    return sb.appendFormat("L%u", Operand::unpackId(labelId));
+    return Logging_formatLabelId(sb, labelId);
   }
 }
 
@@ -200,11 +304,13 @@ Error Logging::formatRegister(
   uint32_t regId) noexcept {
 
 #if defined(ASMJIT_BUILD_X86)
-  return X86Logging::formatRegister(sb, logOptions, emitter, archType, regType, regId);
+  if (ArchInfo::isX86Family(archType))
+    return X86Logging::formatRegister(sb, logOptions, emitter, archType, regType, regId);
 #endif // ASMJIT_BUILD_X86
 
 #if defined(ASMJIT_BUILD_ARM)
-  return ArmLogging::formatRegister(sb, logOptions, emitter, archType, regType, regId);
+  if (ArchInfo::isArmFamily(archType))
+    return ArmLogging::formatRegister(sb, logOptions, emitter, archType, regType, regId);
 #endif // ASMJIT_BUILD_ARM
 
   return kErrorInvalidArch;
@@ -218,11 +324,13 @@ Error Logging::formatOperand(
   const Operand_& op) noexcept {
 
 #if defined(ASMJIT_BUILD_X86)
-  return X86Logging::formatOperand(sb, logOptions, emitter, archType, op);
+  if (ArchInfo::isX86Family(archType))
+    return X86Logging::formatOperand(sb, logOptions, emitter, archType, op);
 #endif // ASMJIT_BUILD_X86
 
 #if defined(ASMJIT_BUILD_ARM)
-  return ArmLogging::formatOperand(sb, logOptions, emitter, archType, op);
+  if (ArchInfo::isArmFamily(archType))
+    return ArmLogging::formatOperand(sb, logOptions, emitter, archType, op);
 #endif // ASMJIT_BUILD_ARM
 
   return kErrorInvalidArch;
@@ -236,11 +344,13 @@ Error Logging::formatInstruction(
   const Inst::Detail& detail, const Operand_* opArray, uint32_t opCount) noexcept {
 
 #if defined(ASMJIT_BUILD_X86)
-  return X86Logging::formatInstruction(sb, logOptions, emitter, archType, detail, opArray, opCount);
+  if (ArchInfo::isX86Family(archType))
+    return X86Logging::formatInstruction(sb, logOptions, emitter, archType, detail, opArray, opCount);
 #endif // ASMJIT_BUILD_X86
 
 #if defined(ASMJIT_BUILD_ARM)
-  return ArmLogging::formatInstruction(sb, logOptions, emitter, archType, detail, opArray, opCount);
+  if (ArchInfo::isArmFamily(archType))
+    return ArmLogging::formatInstruction(sb, logOptions, emitter, archType, detail, opArray, opCount);
 #endif // ASMJIT_BUILD_ARM
 
   return kErrorInvalidArch;
@@ -360,22 +470,30 @@ Error Logging::formatNode(
   const CodeBuilder* cb,
   const CBNode* node_) noexcept {
 
-  if (node_->hasPosition())
-    ASMJIT_PROPAGATE(sb.appendFormat("<%04u> ", node_->getPosition()));
+  if (node_->hasPosition()) {
+    ASMJIT_PROPAGATE(sb.appendChar('<'));
+    ASMJIT_PROPAGATE(sb.appendUInt(node_->getPosition(), 10, 4));
+    ASMJIT_PROPAGATE(sb.appendString("> ", 2));
+  }
 
   switch (node_->getType()) {
     case CBNode::kNodeInst: {
       const CBInst* node = node_->as<CBInst>();
+      Operand opBuf[CBInst::kMaxPackedOps];
+
+      if (node->isCase())
+        ASMJIT_PROPAGATE(sb.appendString("[case] "));
       ASMJIT_PROPAGATE(
         Logging::formatInstruction(sb, logOptions, cb,
           cb->getArchType(),
-          node->getInstDetail(), node->getOpArray(), node->getOpCount()));
+          node->getInstDetail(), node->getOpArray(opBuf), node->getOpCount()));
       break;
     }
 
     case CBNode::kNodeLabel: {
       const CBLabel* node = node_->as<CBLabel>();
-      ASMJIT_PROPAGATE(sb.appendFormat("L%u:", Operand::unpackId(node->getId())));
+      ASMJIT_PROPAGATE(Logging_formatLabelId(sb, node->getId()));
+      ASMJIT_PROPAGATE(sb.appendChar(':'));
       break;
     }
 
@@ -405,6 +523,19 @@ Error Logging::formatNode(
       break;
     }
 
+    case CBNode::kNodeJumpTable: {
+      const CBJumpTable* node = node_->as<CBJumpTable>();
+      ASMJIT_PROPAGATE(Logging_formatLabelId(sb, node->getId()));
+      ASMJIT_PROPAGATE(sb.appendFormat(": .jumptable (%u entries)", node->getSize()));
+      break;
+    }
+
+    case CBNode::kNodeSection: {
+      const CBSection* node = node_->as<CBSection>();
+      ASMJIT_PROPAGATE(sb.appendFormat(".section %s", node->getSection()->getName()));
+      break;
+    }
+
 #if !defined(ASMJIT_DISABLE_COMPILER)
     case CBNode::kNodeFunc: {
       const CCFunc* node = node_->as<CCFunc>();
@@ -488,6 +619,76 @@ Error Logging::formatLine(StringBuilder& sb, const uint8_t* binData, size_t binL
   return sb.appendChar('\n');
 }
 
+// ============================================================================
+// [asmjit::Logging - Test]
+// ============================================================================
+
+#if defined(ASMJIT_TEST)
+static Error Logging_testFormat(StringBuilder& sb, void* data) {
+  (*static_cast<uint32_t*>(data))++;
+  return sb.appendString("lazy\n");
+}
+
+UNIT(base_logging) {
+  INFO("Checking RingLogger");
+  {
+    RingLogger logger(8);
+    char buf[16];
+
+    EXPECT(logger.getCapacity() == 8);
+    EXPECT(logger.copyTo(buf, sizeof(buf)) == 0);
+
+    logger.log("abc");
+    EXPECT(logger.copyTo(buf, sizeof(buf)) == 3 && ::memcmp(buf, "abc", 3) == 0);
+
+    logger.log("defgh");
+    logger.log("ijk");
+    EXPECT(logger.getLength() == 8);
+    EXPECT(logger.getTotalLength() == 11);
+    EXPECT(logger.copyTo(buf, sizeof(buf)) == 8 && ::memcmp(buf, "defghijk", 8) == 0);
+    EXPECT(logger.copyTo(buf, 3) == 3 && ::memcmp(buf, "ijk", 3) == 0,
+      "Only the newest output must be copied to a smaller buffer");
+
+    logger.log("0123456789XY");
+    EXPECT(logger.copyTo(buf, sizeof(buf)) == 8 && ::memcmp(buf, "456789XY", 8) == 0);
+
+    StringBuilder sb;
+    EXPECT(logger.getContent(sb) == kErrorOk);
+    EXPECT(sb.eq("456789XY"));
+
+    logger.clear();
+    EXPECT(logger.getLength() == 0);
+  }
+
+  INFO("Checking Logger filter");
+  {
+    StringLogger logger;
+    uint32_t count = 0;
+
+    EXPECT(logger.isEnabled(Logger::kCategoryInst));
+    EXPECT(logger.logLazy(Logger::kCategoryComment, Logger::kLevelInfo, Logging_testFormat, &count) == kErrorOk);
+    EXPECT(count == 1);
+
+    logger.setLevel(Logger::kLevelInfo);
+    EXPECT(!logger.isEnabled(Logger::kCategoryInst));
+    EXPECT(logger.logLazy(Logger::kCategoryComment, Logger::kLevelTrace, Logging_testFormat, &count) == kErrorOk);
+    EXPECT(count == 1, "Filtered messages must not be formatted");
+
+    logger.setLevel(Logger::kLevelTrace);
+    logger.setCategories(Logger::kCategoryAll & ~Logger::kCategoryComment);
+    EXPECT(logger.isEnabled(Logger::kCategoryInst));
+    EXPECT(!logger.isEnabled(Logger::kCategoryComment, Logger::kLevelInfo));
+
+    logger.setCategories(Logger::kCategoryAll);
+    logger.setEnabled(false);
+    EXPECT(!logger.isEnabled(Logger::kCategoryInst));
+    EXPECT(logger.logLazy(Logger::kCategoryInst, Logger::kLevelTrace, Logging_testFormat, &count) == kErrorOk);
+    EXPECT(count == 1);
+    EXPECT(::strcmp(logger.getString(), "lazy\n") == 0);
+  }
+}
+#endif // ASMJIT_TEST
+
 } // asmjit namespace
 
 // [Api-End]
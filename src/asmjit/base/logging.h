@@ -45,9 +45,17 @@ class CBNode;
 //! subsystem. When reimplementing use `Logger::_log()` method to log into
 //! a custom stream.
 //!
-//! There are two \ref Logger implementations offered by AsmJit:
+//! There are three \ref Logger implementations offered by AsmJit:
 //!   - \ref FileLogger - allows to log into a `FILE*` stream.
 //!   - \ref StringLogger - logs into a \ref StringBuilder.
+//!   - \ref RingLogger - keeps only the most recent output in a fixed buffer.
+//!
+//! Each message AsmJit logs has a \ref Category and a \ref Level. Emitters
+//! check \ref isEnabled() before formatting a message, so a logger that
+//! filters everything out (see \ref setEnabled(), \ref setCategories(), and
+//! \ref setLevel()) costs only the check. The filter is evaluated when the
+//! code is emitted by an \ref Assembler (a \ref CodeBuilder is logged when
+//! it's serialized), so it can be toggled to log only selected ranges.
 class ASMJIT_VIRTAPI Logger {
 public:
   ASMJIT_NONCOPYABLE(Logger)
@@ -64,6 +72,25 @@ public:
     kOptionHexDisplacement = 0x00000008  //! Output displacements in hexadecimal form.
   };
 
+  //! Logger categories.
+  ASMJIT_ENUM(Category) {
+    kCategoryInst          = 0x00000001, //!< Instructions.
+    kCategoryLabel         = 0x00000002, //!< Bound labels.
+    kCategoryData          = 0x00000004, //!< Data, alignment, and sections.
+    kCategoryComment       = 0x00000008, //!< Comments.
+    kCategoryReloc         = 0x00000010, //!< Relocations.
+    kCategoryAll           = 0x0000001F  //!< All categories.
+  };
+
+  //! Logger levels.
+  ASMJIT_ENUM(Level) {
+    kLevelTrace            = 0,          //!< Emitted code (instructions, labels, data, relocations).
+    kLevelInfo             = 1           //!< Comments and other annotations.
+  };
+
+  //! Function that formats a message lazily, see \ref logLazy().
+  typedef Error (*FormatFunc)(StringBuilder& sb, void* data);
+
   // --------------------------------------------------------------------------
   // [Construction / Destruction]
   // --------------------------------------------------------------------------
@@ -92,6 +119,38 @@ public:
   //! Log binary data.
   ASMJIT_API Error logBinary(const void* data, size_t size) noexcept;
 
+  //! Log a message formatted by `func` only if the logger accepts `category`
+  //! and `level`, see \ref isEnabled().
+  ASMJIT_INLINE Error logLazy(uint32_t category, uint32_t level, FormatFunc func, void* data) noexcept {
+    return isEnabled(category, level) ? _logLazy(func, data) : Error(kErrorOk);
+  }
+  //! Format a message by `func` and log it (no filtering).
+  ASMJIT_API Error _logLazy(FormatFunc func, void* data) noexcept;
+
+  // --------------------------------------------------------------------------
+  // [Filter]
+  // --------------------------------------------------------------------------
+
+  //! Get whether the logger accepts messages of `category` and `level`.
+  ASMJIT_INLINE bool isEnabled(uint32_t category, uint32_t level = kLevelTrace) const noexcept {
+    return _enabled && (_categories & category) != 0 && level >= _level;
+  }
+
+  //! Get whether the logger is enabled.
+  ASMJIT_INLINE bool isEnabled() const noexcept { return _enabled != 0; }
+  //! Enable or disable the logger, enabled by default.
+  ASMJIT_INLINE void setEnabled(bool enabled) noexcept { _enabled = enabled; }
+
+  //! Get accepted categories, see \ref Category.
+  ASMJIT_INLINE uint32_t getCategories() const noexcept { return _categories; }
+  //! Set accepted categories, see \ref Category (all by default).
+  ASMJIT_INLINE void setCategories(uint32_t categories) noexcept { _categories = categories; }
+
+  //! Get the minimum accepted level, see \ref Level.
+  ASMJIT_INLINE uint32_t getLevel() const noexcept { return _level; }
+  //! Set the minimum accepted level, see \ref Level (`kLevelTrace` by default).
+  ASMJIT_INLINE void setLevel(uint32_t level) noexcept { _level = level; }
+
   // --------------------------------------------------------------------------
   // [Options]
   // --------------------------------------------------------------------------
@@ -120,6 +179,12 @@ public:
 
   //! Options, see \ref LoggerOption.
   uint32_t _options;
+  //! Accepted categories, see \ref Category.
+  uint32_t _categories;
+  //! Minimum accepted level, see \ref Level.
+  uint32_t _level;
+  //! Whether the logger is enabled.
+  uint32_t _enabled;
 
   //! Indentation.
   char _indentation[12];
@@ -217,6 +282,73 @@ public:
   StringBuilder _stringBuilder;
 };
 
+// ============================================================================
+// [asmjit::RingLogger]
+// ============================================================================
+
+//! Logger that keeps only the most recent output in a fixed-size buffer.
+//!
+//! The buffer is allocated once by the constructor, logging never allocates
+//! and overwrites the oldest output when the buffer is full. It's intended to
+//! stay attached in production to provide the last generated code for crash
+//! diagnostics, \ref copyTo() can be called from a crash handler.
+class ASMJIT_VIRTAPI RingLogger : public Logger {
+public:
+  ASMJIT_NONCOPYABLE(RingLogger)
+
+  enum {
+    //! Default capacity of the buffer.
+    kDefaultCapacity = 16384
+  };
+
+  // --------------------------------------------------------------------------
+  // [Construction / Destruction]
+  // --------------------------------------------------------------------------
+
+  //! Create a new `RingLogger` that keeps the last `capacity` bytes.
+  ASMJIT_API RingLogger(size_t capacity = kDefaultCapacity) noexcept;
+  //! Destroy the `RingLogger`.
+  ASMJIT_API virtual ~RingLogger() noexcept;
+
+  // --------------------------------------------------------------------------
+  // [Accessors]
+  // --------------------------------------------------------------------------
+
+  //! Get the capacity of the buffer (zero if it couldn't be allocated).
+  ASMJIT_INLINE size_t getCapacity() const noexcept { return _capacity; }
+  //! Get the length of the kept output.
+  ASMJIT_INLINE size_t getLength() const noexcept { return _total < _capacity ? static_cast<size_t>(_total) : _capacity; }
+  //! Get the length of all output logged since the last `clear()`.
+  ASMJIT_INLINE uint64_t getTotalLength() const noexcept { return _total; }
+
+  //! Clear the buffer.
+  ASMJIT_INLINE void clear() noexcept { _total = 0; }
+
+  //! Copy the kept output (oldest first) to `dst` of `size` bytes and return
+  //! the number of bytes copied. If `dst` is too small the newest output is
+  //! copied. Doesn't allocate and doesn't null-terminate.
+  ASMJIT_API size_t copyTo(char* dst, size_t size) const noexcept;
+  //! Append the kept output (oldest first) to `sb`.
+  ASMJIT_API Error getContent(StringBuilder& sb) const noexcept;
+
+  // --------------------------------------------------------------------------
+  // [Logging]
+  // --------------------------------------------------------------------------
+
+  ASMJIT_API Error _log(const char* buf, size_t len = Globals::kInvalidIndex) noexcept override;
+
+  // --------------------------------------------------------------------------
+  // [Members]
+  // --------------------------------------------------------------------------
+
+  //! Buffer.
+  char* _data;
+  //! Capacity of the buffer.
+  size_t _capacity;
+  //! Length of all output logged since the last `clear()`.
+  uint64_t _total;
+};
+
 // ============================================================================
 // [asmjit::Logging]
 // ============================================================================
@@ -265,7 +397,10 @@ struct Logging {
     // single instruction.
     kMaxCommentLength = 512,
     kMaxInstLength = 40,
-    kMaxBinaryLength = 26
+    kMaxBinaryLength = 26,
+    // Capacity of stack buffers used to format a single line, which fits an
+    // indentation, instruction, its binary form, and a comment.
+    kMaxLineLength = 1024
   };
 
   static Error formatLine(
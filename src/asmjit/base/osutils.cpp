@@ -8,16 +8,23 @@
 #define ASMJIT_EXPORTS
 
 // [Dependencies]
+#include "../base/cpuinfo.h"
 #include "../base/osutils.h"
 #include "../base/utils.h"
 
 #if ASMJIT_OS_POSIX
 # include <sys/types.h>
 # include <sys/mman.h>
+# include <errno.h>
+# include <fcntl.h>
 # include <time.h>
 # include <unistd.h>
 #endif // ASMJIT_OS_POSIX
 
+#if ASMJIT_OS_LINUX
+# include <sys/syscall.h>
+#endif // ASMJIT_OS_LINUX
+
 #if ASMJIT_OS_MAC
 # include <mach/mach_time.h>
 #endif // ASMJIT_OS_MAC
@@ -39,6 +46,54 @@ namespace asmjit {
 // [asmjit::OSUtils - Virtual Memory]
 // ============================================================================
 
+//! \internal
+//!
+//! Count of addresses probed by an allocation restricted to a range.
+static const uint32_t kOSUtilsRangeProbeCount = 64;
+
+//! \internal
+//!
+//! Get the `i`-th address probed by an allocation of `size` bytes restricted
+//! to `[lo, hi)`. Probing starts in the middle of the range and alternates
+//! outwards. Returns false if the address is outside of the range.
+static bool OSUtils_getProbeAddress(uint64_t lo, uint64_t hi, size_t size, size_t granularity, uint32_t i, uint64_t* out) noexcept {
+  uint64_t mask = ~static_cast<uint64_t>(granularity - 1);
+  uint64_t first = (lo + granularity - 1) & mask;
+
+  if (first < lo || hi <= first || hi - first < size)
+    return false;
+
+  uint64_t last = (hi - size) & mask;
+  uint64_t step = ((last - first) / kOSUtilsRangeProbeCount) & mask;
+  uint64_t middle = (first + (last - first) / 2) & mask;
+
+  if (step == 0)
+    step = granularity;
+
+  uint64_t delta = static_cast<uint64_t>((i + 1) / 2) * step;
+  uint64_t addr;
+
+  if (i & 1) {
+    if (middle - first < delta) return false;
+    addr = middle - delta;
+  }
+  else {
+    if (last - middle < delta) return false;
+    addr = middle + delta;
+  }
+
+  *out = addr;
+  return true;
+}
+
+//! \internal
+//!
+//! Get whether `[p, p + size)` is within `[lo, hi)`.
+static ASMJIT_INLINE bool OSUtils_isInRange(const void* p, size_t size, uint64_t lo, uint64_t hi) noexcept {
+  uint64_t addr = static_cast<uint64_t>((uintptr_t)p);
+  return addr >= lo && addr <= hi && hi - addr >= size;
+}
+
 // Windows specific implementation using `VirtualAllocEx` and `VirtualFree`.
 #if ASMJIT_OS_WINDOWS
 static ASMJIT_NOINLINE const VMemInfo& OSUtils_GetVMemInfo() noexcept {
@@ -50,6 +105,7 @@ static ASMJIT_NOINLINE const VMemInfo& OSUtils_GetVMemInfo() noexcept {
 
     vmi.pageSize = Utils::alignToPowerOf2<uint32_t>(info.dwPageSize);
     vmi.pageGranularity = info.dwAllocationGranularity;
+    vmi.largePageSize = ::GetLargePageMinimum();
     vmi.hCurrentProcess = ::GetCurrentProcess();
   }
 
@@ -58,15 +114,16 @@ static ASMJIT_NOINLINE const VMemInfo& OSUtils_GetVMemInfo() noexcept {
 
 VMemInfo OSUtils::getVirtualMemoryInfo() noexcept { return OSUtils_GetVMemInfo(); }
 
-void* OSUtils::allocVirtualMemory(size_t size, size_t* allocated, uint32_t flags) noexcept {
-  return allocProcessMemory(static_cast<HANDLE>(0), size, allocated, flags);
+void* OSUtils::allocVirtualMemory(size_t size, size_t* allocated, uint32_t flags, uint64_t rangeLo, uint64_t rangeHi, uint32_t* pageType) noexcept {
+  return allocProcessMemory(static_cast<HANDLE>(0), size, allocated, flags, rangeLo, rangeHi, pageType);
 }
 
 Error OSUtils::releaseVirtualMemory(void* p, size_t size) noexcept {
   return releaseProcessMemory(static_cast<HANDLE>(0), p, size);
 }
 
-void* OSUtils::allocProcessMemory(HANDLE hProcess, size_t size, size_t* allocated, uint32_t flags) noexcept {
+void* OSUtils::allocProcessMemory(HANDLE hProcess, size_t size, size_t* allocated, uint32_t flags, uint64_t rangeLo, uint64_t rangeHi, uint32_t* pageType) noexcept {
+  if (pageType) *pageType = kVMPageRegular;
   if (size == 0)
     return nullptr;
 
@@ -86,6 +143,36 @@ void* OSUtils::allocProcessMemory(HANDLE hProcess, size_t size, size_t* allocate
   else
     protectFlags |= (flags & kVMWritable) ? PAGE_READWRITE : PAGE_READONLY;
 
+  // `VirtualAllocEx` fails if the requested address is not free, so probe
+  // addresses within the range until it succeeds.
+  if (rangeHi) {
+    for (uint32_t i = 0; i < kOSUtilsRangeProbeCount; i++) {
+      uint64_t addr;
+      if (!OSUtils_getProbeAddress(rangeLo, rangeHi, alignedSize, vmi.pageGranularity, i, &addr))
+        continue;
+
+      LPVOID mNear = ::VirtualAllocEx(hProcess, (LPVOID)(uintptr_t)addr, alignedSize, MEM_COMMIT | MEM_RESERVE, protectFlags);
+      if (mNear) {
+        if (allocated) *allocated = alignedSize;
+        return mNear;
+      }
+    }
+    return nullptr;
+  }
+
+  // Large pages require `SeLockMemoryPrivilege`, fallback to regular pages if
+  // the allocation fails.
+  if ((flags & kVMLargePages) && vmi.largePageSize) {
+    size_t largeSize = Utils::alignTo(size, vmi.largePageSize);
+    LPVOID mLarge = ::VirtualAllocEx(hProcess, nullptr, largeSize, MEM_COMMIT | MEM_RESERVE | MEM_LARGE_PAGES, protectFlags);
+
+    if (mLarge) {
+      if (allocated) *allocated = largeSize;
+      if (pageType) *pageType = kVMPageLarge;
+      return mLarge;
+    }
+  }
+
   LPVOID mBase = ::VirtualAllocEx(hProcess, nullptr, alignedSize, MEM_COMMIT | MEM_RESERVE, protectFlags);
   if (ASMJIT_UNLIKELY(!mBase)) return nullptr;
 
@@ -103,6 +190,108 @@ Error OSUtils::releaseProcessMemory(HANDLE hProcess, void* p, size_t size) noexc
 
   return kErrorOk;
 }
+
+Error OSUtils::allocDualMapping(size_t size, size_t* allocated, void** rx, void** rw, uint64_t rangeLo, uint64_t rangeHi) noexcept {
+  *rx = nullptr;
+  *rw = nullptr;
+
+  if (size == 0)
+    return DebugUtils::errored(kErrorInvalidArgument);
+
+  const VMemInfo& vmi = OSUtils_GetVMemInfo();
+  size_t alignedSize = Utils::alignTo(size, vmi.pageGranularity);
+
+  uint64_t size64 = static_cast<uint64_t>(alignedSize);
+  HANDLE hMapping = ::CreateFileMappingW(INVALID_HANDLE_VALUE, nullptr,
+    PAGE_EXECUTE_READWRITE | SEC_COMMIT,
+    static_cast<DWORD>(size64 >> 32), static_cast<DWORD>(size64 & 0xFFFFFFFFU), nullptr);
+
+  if (ASMJIT_UNLIKELY(!hMapping))
+    return DebugUtils::errored(kErrorNoVirtualMemory);
+
+  void* rwPtr = ::MapViewOfFile(hMapping, FILE_MAP_READ | FILE_MAP_WRITE, 0, 0, alignedSize);
+  void* rxPtr = nullptr;
+
+  if (rangeHi) {
+    for (uint32_t i = 0; i < kOSUtilsRangeProbeCount && !rxPtr; i++) {
+      uint64_t addr;
+      if (OSUtils_getProbeAddress(rangeLo, rangeHi, alignedSize, vmi.pageGranularity, i, &addr))
+        rxPtr = ::MapViewOfFileEx(hMapping, FILE_MAP_READ | FILE_MAP_EXECUTE, 0, 0, alignedSize, (LPVOID)(uintptr_t)addr);
+    }
+  }
+  else {
+    rxPtr = ::MapViewOfFile(hMapping, FILE_MAP_READ | FILE_MAP_EXECUTE, 0, 0, alignedSize);
+  }
+
+  // Views keep the section object alive.
+  ::CloseHandle(hMapping);
+
+  if (ASMJIT_UNLIKELY(!rwPtr || !rxPtr)) {
+    if (rwPtr) ::UnmapViewOfFile(rwPtr);
+    if (rxPtr) ::UnmapViewOfFile(rxPtr);
+    return DebugUtils::errored(kErrorNoVirtualMemory);
+  }
+
+  *rx = rxPtr;
+  *rw = rwPtr;
+
+  if (allocated) *allocated = alignedSize;
+  return kErrorOk;
+}
+
+Error OSUtils::releaseDualMapping(void* rx, void* rw, size_t size) noexcept {
+  ASMJIT_UNUSED(size);
+
+  bool ok = true;
+  if (rx && !::UnmapViewOfFile(rx)) ok = false;
+  if (rw && rw != rx && !::UnmapViewOfFile(rw)) ok = false;
+
+  if (ASMJIT_UNLIKELY(!ok))
+    return DebugUtils::errored(kErrorInvalidState);
+
+  return kErrorOk;
+}
+
+Error OSUtils::createSharedMemory(size_t size, size_t* allocated, intptr_t* handle) noexcept {
+  *handle = 0;
+  if (size == 0)
+    return DebugUtils::errored(kErrorInvalidArgument);
+
+  const VMemInfo& vmi = OSUtils_GetVMemInfo();
+  size_t alignedSize = Utils::alignTo(size, vmi.pageGranularity);
+
+  uint64_t size64 = static_cast<uint64_t>(alignedSize);
+  HANDLE hMapping = ::CreateFileMappingW(INVALID_HANDLE_VALUE, nullptr,
+    PAGE_EXECUTE_READWRITE | SEC_COMMIT,
+    static_cast<DWORD>(size64 >> 32), static_cast<DWORD>(size64 & 0xFFFFFFFFU), nullptr);
+
+  if (ASMJIT_UNLIKELY(!hMapping))
+    return DebugUtils::errored(kErrorNoVirtualMemory);
+
+  *handle = reinterpret_cast<intptr_t>(hMapping);
+  if (allocated) *allocated = alignedSize;
+  return kErrorOk;
+}
+
+Error OSUtils::closeSharedMemory(intptr_t handle) noexcept {
+  if (ASMJIT_UNLIKELY(!::CloseHandle(reinterpret_cast<HANDLE>(handle))))
+    return DebugUtils::errored(kErrorInvalidState);
+  return kErrorOk;
+}
+
+void* OSUtils::mapSharedMemory(intptr_t handle, size_t size, uint32_t flags) noexcept {
+  DWORD access = FILE_MAP_READ;
+  if (flags & kVMWritable) access |= FILE_MAP_WRITE;
+  if (flags & kVMExecutable) access |= FILE_MAP_EXECUTE;
+  return ::MapViewOfFile(reinterpret_cast<HANDLE>(handle), access, 0, 0, size);
+}
+
+Error OSUtils::unmapSharedMemory(void* p, size_t size) noexcept {
+  ASMJIT_UNUSED(size);
+  if (ASMJIT_UNLIKELY(!::UnmapViewOfFile(p)))
+    return DebugUtils::errored(kErrorInvalidState);
+  return kErrorOk;
+}
 #endif // ASMJIT_OS_WINDOWS
 
 // Posix specific implementation using `mmap()` and `munmap()`.
@@ -119,14 +308,123 @@ static const VMemInfo& OSUtils_GetVMemInfo() noexcept {
     size_t pageSize = ::getpagesize();
     vmi.pageSize = pageSize;
     vmi.pageGranularity = std::max<size_t>(pageSize, 65536);
+#if ASMJIT_OS_LINUX && (ASMJIT_ARCH_X86 || ASMJIT_ARCH_X64 || ASMJIT_ARCH_ARM64)
+    // Default huge page size of X86/X64 and ARM64 (4kB granule) Linux kernels.
+    vmi.largePageSize = 2 * 1024 * 1024;
+#endif
   }
   return vmi;
 };
 
 VMemInfo OSUtils::getVirtualMemoryInfo() noexcept { return OSUtils_GetVMemInfo(); }
 
-void* OSUtils::allocVirtualMemory(size_t size, size_t* allocated, uint32_t flags) noexcept {
+#if ASMJIT_OS_LINUX && defined(MADV_HUGEPAGE)
+//! \internal
+//!
+//! Get whether memory advised by `MADV_HUGEPAGE` can be backed by transparent
+//! huge pages, which is not the case if they are disabled by the system (the
+//! advice succeeds anyway). The result is cached: 0 - unknown, 1 - no, 2 - yes.
+static bool OSUtils_isTransparentHugePageEnabled() noexcept {
+  static volatile uint32_t cached;
+  uint32_t state = OSUtils::atomicLoad(&cached);
+
+  if (!state) {
+    char buf[64];
+    ssize_t n = -1;
+
+    int fd = ::open("/sys/kernel/mm/transparent_hugepage/enabled", O_RDONLY);
+    if (fd >= 0) {
+      n = ::read(fd, buf, sizeof(buf) - 1);
+      ::close(fd);
+    }
+
+    // The selected mode is in brackets, e.g. "always [madvise] never".
+    if (n > 0) buf[n] = '\0';
+    state = (n > 0 && !::strstr(buf, "[never]")) ? 2 : 1;
+    OSUtils::atomicStore(&cached, state);
+  }
+
+  return state == 2;
+}
+#endif // ASMJIT_OS_LINUX && MADV_HUGEPAGE
+
+//! \internal
+//!
+//! Allocate virtual memory backed by huge pages (Linux), the pages that were
+//! actually used are stored in `pageType`.
+static void* OSUtils_allocHugePages(size_t size, int protection, uint32_t* pageType) noexcept {
+#if ASMJIT_OS_LINUX
   const VMemInfo& vmi = OSUtils_GetVMemInfo();
+  size_t hugeSize = vmi.largePageSize;
+
+# if defined(MAP_HUGETLB)
+  // Explicit huge pages, only succeeds if the system has reserved them.
+  void* mbase = ::mmap(nullptr, size, protection, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+  if (mbase != MAP_FAILED) {
+    *pageType = OSUtils::kVMPageLarge;
+    return mbase;
+  }
+# endif // MAP_HUGETLB
+
+# if defined(MADV_HUGEPAGE)
+  // Transparent huge pages - reserve more to align the region to the huge page
+  // size, trim the rest, and advise the kernel to back the region by huge pages.
+  size_t reserved = size + hugeSize;
+  uint8_t* raw = static_cast<uint8_t*>(::mmap(nullptr, reserved, protection, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+  if (raw == MAP_FAILED)
+    return nullptr;
+
+  uint8_t* aligned = reinterpret_cast<uint8_t*>(Utils::alignTo<uintptr_t>((uintptr_t)raw, hugeSize));
+  size_t head = (size_t)(aligned - raw);
+  size_t tail = reserved - head - size;
+
+  if (head) ::munmap(raw, head);
+  if (tail) ::munmap(aligned + size, tail);
+
+  bool advised = ::madvise(aligned, size, MADV_HUGEPAGE) == 0;
+  *pageType = advised && OSUtils_isTransparentHugePageEnabled() ? OSUtils::kVMPageTransparent : OSUtils::kVMPageRegular;
+  return aligned;
+# else
+  ASMJIT_UNUSED(hugeSize);
+  ASMJIT_UNUSED(pageType);
+  return nullptr;
+# endif // MADV_HUGEPAGE
+#else
+  ASMJIT_UNUSED(size);
+  ASMJIT_UNUSED(protection);
+  ASMJIT_UNUSED(pageType);
+  return nullptr;
+#endif // ASMJIT_OS_LINUX
+}
+
+//! \internal
+//!
+//! Map `size` bytes within `[rangeLo, rangeHi)` by passing probed addresses
+//! as a hint to `mmap()`, which only uses the hint if the address is free.
+static void* OSUtils_mmapInRange(size_t size, int protection, int flags, int fd, uint64_t rangeLo, uint64_t rangeHi) noexcept {
+  const VMemInfo& vmi = OSUtils_GetVMemInfo();
+
+  for (uint32_t i = 0; i < kOSUtilsRangeProbeCount; i++) {
+    uint64_t addr;
+    if (!OSUtils_getProbeAddress(rangeLo, rangeHi, size, vmi.pageGranularity, i, &addr))
+      continue;
+
+    void* p = ::mmap((void*)(uintptr_t)addr, size, protection, flags, fd, 0);
+    if (p == MAP_FAILED)
+      continue;
+
+    if (OSUtils_isInRange(p, size, rangeLo, rangeHi))
+      return p;
+    ::munmap(p, size);
+  }
+
+  return MAP_FAILED;
+}
+
+void* OSUtils::allocVirtualMemory(size_t size, size_t* allocated, uint32_t flags, uint64_t rangeLo, uint64_t rangeHi, uint32_t* pageType) noexcept {
+  const VMemInfo& vmi = OSUtils_GetVMemInfo();
+  uint32_t actualPageType = kVMPageRegular;
+  if (pageType) *pageType = kVMPageRegular;
 
   size_t alignedSize = Utils::alignTo<size_t>(size, vmi.pageSize);
   int protection = PROT_READ;
@@ -134,6 +432,25 @@ void* OSUtils::allocVirtualMemory(size_t size, size_t* allocated, uint32_t flags
   if (flags & kVMWritable  ) protection |= PROT_WRITE;
   if (flags & kVMExecutable) protection |= PROT_EXEC;
 
+  if (rangeHi) {
+    void* mNear = OSUtils_mmapInRange(alignedSize, protection, MAP_PRIVATE | MAP_ANONYMOUS, -1, rangeLo, rangeHi);
+    if (ASMJIT_UNLIKELY(mNear == MAP_FAILED)) return nullptr;
+
+    if (allocated) *allocated = alignedSize;
+    return mNear;
+  }
+
+  if ((flags & kVMLargePages) && vmi.largePageSize) {
+    size_t largeSize = Utils::alignTo<size_t>(size, vmi.largePageSize);
+    void* mLarge = OSUtils_allocHugePages(largeSize, protection, &actualPageType);
+
+    if (mLarge) {
+      if (allocated) *allocated = largeSize;
+      if (pageType) *pageType = actualPageType;
+      return mLarge;
+    }
+  }
+
   void* mbase = ::mmap(nullptr, alignedSize, protection, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
   if (ASMJIT_UNLIKELY(mbase == MAP_FAILED)) return nullptr;
 
@@ -147,6 +464,134 @@ Error OSUtils::releaseVirtualMemory(void* p, size_t size) noexcept {
 
   return kErrorOk;
 }
+
+//! \internal
+//!
+//! Create an anonymous file descriptor that can be mapped multiple times.
+static int OSUtils_openAnonymousFile() noexcept {
+#if ASMJIT_OS_LINUX && defined(SYS_memfd_create)
+  // MFD_CLOEXEC is 1, it's not defined by older C libraries.
+  int fd = static_cast<int>(::syscall(SYS_memfd_create, "asmjit", 1));
+  if (fd >= 0)
+    return fd;
+#endif // ASMJIT_OS_LINUX
+
+  // Fallback to a POSIX shared memory object that is unlinked immediately.
+  // Each attempt takes a unique id, the name can only exist if it was left
+  // by another process of the same pid, so retry with a fresh id on EEXIST.
+  static volatile uint32_t shmCounter;
+  char name[64];
+
+  for (uint32_t attempt = 0; attempt < 100; attempt++) {
+    uint32_t id = OSUtils::atomicAdd(&shmCounter, 1);
+    snprintf(name, ASMJIT_ARRAY_SIZE(name), "/asmjit-%u-%u",
+      static_cast<unsigned int>(::getpid()), static_cast<unsigned int>(id));
+
+    int fd = ::shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd >= 0) {
+      ::shm_unlink(name);
+      return fd;
+    }
+
+    if (errno != EEXIST)
+      break;
+  }
+
+  return -1;
+}
+
+Error OSUtils::allocDualMapping(size_t size, size_t* allocated, void** rx, void** rw, uint64_t rangeLo, uint64_t rangeHi) noexcept {
+  *rx = nullptr;
+  *rw = nullptr;
+
+  if (size == 0)
+    return DebugUtils::errored(kErrorInvalidArgument);
+
+  const VMemInfo& vmi = OSUtils_GetVMemInfo();
+  size_t alignedSize = Utils::alignTo<size_t>(size, vmi.pageSize);
+
+  int fd = OSUtils_openAnonymousFile();
+  if (ASMJIT_UNLIKELY(fd < 0))
+    return DebugUtils::errored(kErrorNoVirtualMemory);
+
+  if (ASMJIT_UNLIKELY(::ftruncate(fd, static_cast<off_t>(alignedSize)) != 0)) {
+    ::close(fd);
+    return DebugUtils::errored(kErrorNoVirtualMemory);
+  }
+
+  void* rwPtr = ::mmap(nullptr, alignedSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  void* rxPtr = rangeHi ? OSUtils_mmapInRange(alignedSize, PROT_READ | PROT_EXEC, MAP_SHARED, fd, rangeLo, rangeHi)
+                        : ::mmap(nullptr, alignedSize, PROT_READ | PROT_EXEC, MAP_SHARED, fd, 0);
+
+  // Mappings keep the file alive.
+  ::close(fd);
+
+  if (ASMJIT_UNLIKELY(rwPtr == MAP_FAILED || rxPtr == MAP_FAILED)) {
+    if (rwPtr != MAP_FAILED) ::munmap(rwPtr, alignedSize);
+    if (rxPtr != MAP_FAILED) ::munmap(rxPtr, alignedSize);
+    return DebugUtils::errored(kErrorNoVirtualMemory);
+  }
+
+  *rx = rxPtr;
+  *rw = rwPtr;
+
+  if (allocated) *allocated = alignedSize;
+  return kErrorOk;
+}
+
+Error OSUtils::releaseDualMapping(void* rx, void* rw, size_t size) noexcept {
+  bool ok = true;
+  if (rx && ::munmap(rx, size) != 0) ok = false;
+  if (rw && rw != rx && ::munmap(rw, size) != 0) ok = false;
+
+  if (ASMJIT_UNLIKELY(!ok))
+    return DebugUtils::errored(kErrorInvalidState);
+
+  return kErrorOk;
+}
+
+Error OSUtils::createSharedMemory(size_t size, size_t* allocated, intptr_t* handle) noexcept {
+  *handle = -1;
+  if (size == 0)
+    return DebugUtils::errored(kErrorInvalidArgument);
+
+  const VMemInfo& vmi = OSUtils_GetVMemInfo();
+  size_t alignedSize = Utils::alignTo<size_t>(size, vmi.pageSize);
+
+  int fd = OSUtils_openAnonymousFile();
+  if (ASMJIT_UNLIKELY(fd < 0))
+    return DebugUtils::errored(kErrorNoVirtualMemory);
+
+  if (ASMJIT_UNLIKELY(::ftruncate(fd, static_cast<off_t>(alignedSize)) != 0)) {
+    ::close(fd);
+    return DebugUtils::errored(kErrorNoVirtualMemory);
+  }
+
+  *handle = static_cast<intptr_t>(fd);
+  if (allocated) *allocated = alignedSize;
+  return kErrorOk;
+}
+
+Error OSUtils::closeSharedMemory(intptr_t handle) noexcept {
+  if (ASMJIT_UNLIKELY(::close(static_cast<int>(handle)) != 0))
+    return DebugUtils::errored(kErrorInvalidState);
+  return kErrorOk;
+}
+
+void* OSUtils::mapSharedMemory(intptr_t handle, size_t size, uint32_t flags) noexcept {
+  int protection = PROT_READ;
+  if (flags & kVMWritable) protection |= PROT_WRITE;
+  if (flags & kVMExecutable) protection |= PROT_EXEC;
+
+  void* p = ::mmap(nullptr, size, protection, MAP_SHARED, static_cast<int>(handle), 0);
+  return p != MAP_FAILED ? p : static_cast<void*>(nullptr);
+}
+
+Error OSUtils::unmapSharedMemory(void* p, size_t size) noexcept {
+  if (ASMJIT_UNLIKELY(::munmap(p, size) != 0))
+    return DebugUtils::errored(kErrorInvalidState);
+  return kErrorOk;
+}
 #endif // ASMJIT_OS_POSIX
 
 // ============================================================================
@@ -222,6 +667,217 @@ uint32_t OSUtils::getTickCount() noexcept {
 uint32_t OSUtils::getTickCount() noexcept { return 0; }
 #endif
 
+// ============================================================================
+// [asmjit::OSUtils - GetHighResTime]
+// ============================================================================
+
+#if ASMJIT_OS_WINDOWS
+uint64_t OSUtils::getHighResTime() noexcept {
+  static volatile uint64_t _hiResFreq;
+
+  LARGE_INTEGER now;
+  if (!::QueryPerformanceCounter(&now))
+    return uint64_t(::GetTickCount()) * 1000000U;
+
+  uint64_t freq = _hiResFreq;
+  if (ASMJIT_UNLIKELY(freq == 0)) {
+    LARGE_INTEGER qpf;
+    if (!::QueryPerformanceFrequency(&qpf) || qpf.QuadPart <= 0)
+      return uint64_t(::GetTickCount()) * 1000000U;
+
+    freq = static_cast<uint64_t>(qpf.QuadPart);
+    _hiResFreq = freq;
+  }
+
+  // Split the conversion to not overflow when the counter is large.
+  uint64_t t = static_cast<uint64_t>(now.QuadPart);
+  return (t / freq) * 1000000000U + ((t % freq) * 1000000000U) / freq;
+}
+#elif ASMJIT_OS_MAC
+uint64_t OSUtils::getHighResTime() noexcept {
+  static mach_timebase_info_data_t _machTime;
+
+  if (ASMJIT_UNLIKELY(_machTime.denom == 0) && mach_timebase_info(&_machTime) != KERN_SUCCESS)
+    return 0;
+
+  uint64_t t = mach_absolute_time();
+  if (_machTime.numer != _machTime.denom)
+    t = t * _machTime.numer / _machTime.denom;
+  return t;
+}
+#elif defined(_POSIX_MONOTONIC_CLOCK) && _POSIX_MONOTONIC_CLOCK >= 0
+uint64_t OSUtils::getHighResTime() noexcept {
+  struct timespec ts;
+
+  if (ASMJIT_UNLIKELY(clock_gettime(CLOCK_MONOTONIC, &ts) != 0))
+    return 0;
+
+  return uint64_t(ts.tv_sec) * 1000000000U + uint64_t(ts.tv_nsec);
+}
+#else
+#error "[asmjit] OSUtils::getHighResTime() is not implemented for your target OS."
+uint64_t OSUtils::getHighResTime() noexcept { return 0; }
+#endif
+
+// ============================================================================
+// [asmjit::Thread]
+// ============================================================================
+
+#if ASMJIT_OS_WINDOWS
+static DWORD WINAPI Thread_entry(LPVOID arg) noexcept {
+  Thread* self = static_cast<Thread*>(arg);
+  self->_func(self->_data);
+  return 0;
+}
+
+Error Thread::start(Func func, void* data) noexcept {
+  ASMJIT_ASSERT(!_started);
+  _func = func;
+  _data = data;
+
+  _handle = ::CreateThread(nullptr, 0, Thread_entry, this, 0, nullptr);
+  if (!_handle)
+    return DebugUtils::errored(kErrorInvalidState);
+
+  _started = true;
+  return kErrorOk;
+}
+
+void Thread::join() noexcept {
+  if (!_started) return;
+  ::WaitForSingleObject(_handle, INFINITE);
+  ::CloseHandle(_handle);
+  _started = false;
+}
+#else
+static void* Thread_entry(void* arg) noexcept {
+  Thread* self = static_cast<Thread*>(arg);
+  self->_func(self->_data);
+  return nullptr;
+}
+
+Error Thread::start(Func func, void* data) noexcept {
+  ASMJIT_ASSERT(!_started);
+  _func = func;
+  _data = data;
+
+  if (::pthread_create(&_handle, nullptr, Thread_entry, this) != 0)
+    return DebugUtils::errored(kErrorInvalidState);
+
+  _started = true;
+  return kErrorOk;
+}
+
+void Thread::join() noexcept {
+  if (!_started) return;
+  ::pthread_join(_handle, nullptr);
+  _started = false;
+}
+#endif
+
+// ============================================================================
+// [asmjit::OSUtils - Parallel]
+// ============================================================================
+
+//! \internal
+//!
+//! Maximum count of threads started by `OSUtils::runParallel()`.
+static const uint32_t kOSUtilsMaxParallelThreads = 64;
+
+//! \internal
+struct OSUtilsParallelJob {
+  OSUtils::ParallelFunc func;
+  void* data;
+  size_t count;
+  size_t next;
+  Lock lock;
+};
+
+static void ASMJIT_CDECL OSUtils_runParallelWorker(void* data) noexcept {
+  OSUtilsParallelJob* job = static_cast<OSUtilsParallelJob*>(data);
+  for (;;) {
+    size_t index;
+    {
+      AutoLock locked(job->lock);
+      index = job->next;
+      if (index >= job->count) return;
+      job->next = index + 1;
+    }
+    job->func(job->data, index);
+  }
+}
+
+void OSUtils::runParallel(ParallelFunc func, void* data, size_t count, uint32_t threadCount) noexcept {
+  if (!threadCount)
+    threadCount = CpuInfo::getHost().getHwThreadsCount();
+
+  if (threadCount > kOSUtilsMaxParallelThreads)
+    threadCount = kOSUtilsMaxParallelThreads;
+
+  if (static_cast<size_t>(threadCount) > count)
+    threadCount = static_cast<uint32_t>(count);
+
+  OSUtilsParallelJob job;
+  job.func = func;
+  job.data = data;
+  job.count = count;
+  job.next = 0;
+
+  // The calling thread is one of the threads.
+  Thread threads[kOSUtilsMaxParallelThreads];
+  uint32_t started = 0;
+
+  while (started + 1 < threadCount && threads[started].start(OSUtils_runParallelWorker, &job) == kErrorOk)
+    started++;
+
+  OSUtils_runParallelWorker(&job);
+
+  for (uint32_t i = 0; i < started; i++)
+    threads[i].join();
+}
+
+// ============================================================================
+// [asmjit::OSUtils - Test]
+// ============================================================================
+
+#if defined(ASMJIT_TEST)
+static void ASMJIT_CDECL OSUtils_testParallelFunc(void* data, size_t index) {
+  static_cast<uint32_t*>(data)[index] += static_cast<uint32_t>(index) + 1;
+}
+
+UNIT(base_osutils_parallel) {
+  uint32_t items[1000];
+  uint32_t i;
+
+  for (uint32_t threadCount = 0; threadCount <= 8; threadCount += 4) {
+    INFO("Checking that each item is processed once (%u threads)", threadCount);
+    ::memset(items, 0, sizeof(items));
+    OSUtils::runParallel(OSUtils_testParallelFunc, items, ASMJIT_ARRAY_SIZE(items), threadCount);
+
+    for (i = 0; i < ASMJIT_ARRAY_SIZE(items); i++)
+      EXPECT(items[i] == i + 1, "Item #%u processed incorrectly", i);
+  }
+
+  OSUtils::runParallel(OSUtils_testParallelFunc, nullptr, 0, 4);
+}
+
+static void ASMJIT_CDECL OSUtils_testAtomicAddFunc(void* data, size_t index) {
+  OSUtils::atomicAdd(static_cast<volatile uint32_t*>(data), static_cast<uint32_t>(index) + 1);
+}
+
+UNIT(base_osutils_atomic) {
+  volatile uint32_t counter = 0;
+
+  INFO("Checking that concurrent atomicAdd() doesn't lose updates");
+  OSUtils::runParallel(OSUtils_testAtomicAddFunc, const_cast<uint32_t*>(&counter), 10000, 8);
+  EXPECT(counter == 10000 * 10001 / 2,
+    "Counter is %u, expected %u", counter, 10000U * 10001U / 2U);
+
+  EXPECT(OSUtils::atomicAdd(&counter, 1) == 10000 * 10001 / 2,
+    "atomicAdd() should return the previous value");
+}
+#endif // ASMJIT_TEST
+
 } // asmjit namespace
 
 // [Api-End]
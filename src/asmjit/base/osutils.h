@@ -11,6 +11,10 @@
 // [Dependencies]
 #include "../base/globals.h"
 
+#if ASMJIT_CC_MSC
+# include <intrin.h>
+#endif // ASMJIT_CC_MSC
+
 // [Api-Begin]
 #include "../asmjit_apibegin.h"
 
@@ -30,6 +34,7 @@ struct VMemInfo {
 #endif // ASMJIT_OS_WINDOWS
   size_t pageSize;                       //!< Virtual memory page size.
   size_t pageGranularity;                //!< Virtual memory page granularity.
+  size_t largePageSize;                  //!< Large (huge) page size or 0 if not supported (allocations may still fall back to regular pages).
 };
 
 // ============================================================================
@@ -53,7 +58,8 @@ struct VMemInfo {
 //! OSUtils also provide a function `getTickCount()` that can be used for
 //! benchmarking purposes. It's similar to Windows-only `GetTickCount()`, but
 //! it's cross-platform and tries to be the most reliable platform specific
-//! calls to make the result usable.
+//! calls to make the result usable. If 1ms resolution is not enough use
+//! `getHighResTime()`, which returns a monotonic time in nanoseconds.
 struct OSUtils {
   // --------------------------------------------------------------------------
   // [Virtual Memory]
@@ -62,19 +68,69 @@ struct OSUtils {
   //! Virtual memory flags.
   ASMJIT_ENUM(VMFlags) {
     kVMWritable   = 0x00000001U,         //!< Virtual memory is writable.
-    kVMExecutable = 0x00000002U          //!< Virtual memory is executable.
+    kVMExecutable = 0x00000002U,         //!< Virtual memory is executable.
+    kVMLargePages = 0x00000004U          //!< Prefer large (huge) pages, see \ref VMemInfo::largePageSize.
+  };
+
+  //! Pages that back virtual memory, reported by \ref allocVirtualMemory().
+  ASMJIT_ENUM(VMPageType) {
+    kVMPageRegular     = 0,              //!< Regular pages, see \ref VMemInfo::pageSize.
+    kVMPageLarge       = 1,              //!< Explicit large pages (MAP_HUGETLB or MEM_LARGE_PAGES).
+    kVMPageTransparent = 2,              //!< Regular pages advised to be merged into transparent huge pages.
+    kVMPageTypeCount   = 3               //!< Count of page types.
   };
 
   ASMJIT_API static VMemInfo getVirtualMemoryInfo() noexcept;
 
   //! Allocate virtual memory.
-  ASMJIT_API static void* allocVirtualMemory(size_t size, size_t* allocated, uint32_t flags) noexcept;
+  //!
+  //! If `kVMLargePages` is specified and large pages are supported then the
+  //! `size` is aligned to `VMemInfo::largePageSize` and the memory is aligned
+  //! to it as well. Explicit large pages are tried first (MAP_HUGETLB on Linux,
+  //! MEM_LARGE_PAGES on Windows), Linux falls back to transparent huge pages
+  //! and other systems fall back to regular pages silently. The pages that
+  //! were actually used are stored in `pageType` (see \ref VMPageType).
+  //!
+  //! If `rangeHi` is non-zero the memory is allocated within `[rangeLo, rangeHi)`
+  //! (large pages are not used in that case) by probing free addresses of the
+  //! range. Returns null if no free address was found.
+  ASMJIT_API static void* allocVirtualMemory(size_t size, size_t* allocated, uint32_t flags, uint64_t rangeLo = 0, uint64_t rangeHi = 0, uint32_t* pageType = nullptr) noexcept;
   //! Release virtual memory previously allocated by \ref allocVirtualMemory().
   ASMJIT_API static Error releaseVirtualMemory(void* p, size_t size) noexcept;
 
+  //! Allocate virtual memory mapped twice - `rx` view is readable and
+  //! executable and `rw` view is readable and writable. Both views share the
+  //! same physical pages, so the code written through `rw` can be executed
+  //! through `rx` without ever having pages that are writable and executable.
+  //!
+  //! This uses anonymous shared memory (`memfd_create()` or `shm_open()`) on
+  //! POSIX and a section object (`CreateFileMapping()`) on Windows. If
+  //! `rangeHi` is non-zero the `rx` view is mapped within `[rangeLo, rangeHi)`,
+  //! see \ref allocVirtualMemory().
+  ASMJIT_API static Error allocDualMapping(size_t size, size_t* allocated, void** rx, void** rw, uint64_t rangeLo = 0, uint64_t rangeHi = 0) noexcept;
+  //! Release virtual memory previously allocated by \ref allocDualMapping().
+  ASMJIT_API static Error releaseDualMapping(void* rx, void* rw, size_t size) noexcept;
+
+  //! Create an anonymous shared memory object of at least `size` bytes that
+  //! can be mapped by \ref mapSharedMemory() in this and other processes.
+  //!
+  //! The `handle` is a file descriptor on POSIX (`memfd_create()` on Linux,
+  //! `shm_open()` elsewhere, created with close-on-exec) and a section object
+  //! `HANDLE` on Windows. It's up to the user to pass it to another process
+  //! (`SCM_RIGHTS` or `DuplicateHandle()`).
+  ASMJIT_API static Error createSharedMemory(size_t size, size_t* allocated, intptr_t* handle) noexcept;
+  //! Close `handle` created by \ref createSharedMemory(), existing mappings
+  //! stay valid.
+  ASMJIT_API static Error closeSharedMemory(intptr_t handle) noexcept;
+  //! Map `size` bytes of a shared memory `handle`, it's always readable and
+  //! `flags` can add `kVMWritable` and `kVMExecutable`. Returns null on failure.
+  ASMJIT_API static void* mapSharedMemory(intptr_t handle, size_t size, uint32_t flags) noexcept;
+  //! Unmap memory previously mapped by \ref mapSharedMemory().
+  ASMJIT_API static Error unmapSharedMemory(void* p, size_t size) noexcept;
+
 #if ASMJIT_OS_WINDOWS
   //! Allocate virtual memory of `hProcess` (Windows).
-  ASMJIT_API static void* allocProcessMemory(HANDLE hProcess, size_t size, size_t* allocated, uint32_t flags) noexcept;
+  ASMJIT_API static void* allocProcessMemory(HANDLE hProcess, size_t size, size_t* allocated, uint32_t flags, uint64_t rangeLo = 0, uint64_t rangeHi = 0, uint32_t* pageType = nullptr) noexcept;
 
   //! Release virtual memory of `hProcess` (Windows).
   ASMJIT_API static Error releaseProcessMemory(HANDLE hProcess, void* p, size_t size) noexcept;
@@ -86,6 +142,84 @@ struct OSUtils {
 
   //! Get the current CPU tick count, used for benchmarking (1ms resolution).
   ASMJIT_API static uint32_t getTickCount() noexcept;
+
+  //! Get a monotonic time in nanoseconds, used for benchmarking and by
+  //! \ref CodeBuilder statistics.
+  //!
+  //! The value has no defined origin, only a difference between two values
+  //! is meaningful. The real resolution depends on the OS, but it's always
+  //! much better than the resolution of `getTickCount()`.
+  ASMJIT_API static uint64_t getHighResTime() noexcept;
+
+  // --------------------------------------------------------------------------
+  // [Parallel]
+  // --------------------------------------------------------------------------
+
+  //! Function called by \ref runParallel() for each item.
+  typedef void (ASMJIT_CDECL* ParallelFunc)(void* data, size_t index);
+
+  //! Call `func(data, index)` for each `index` in `[0, count)` on up to
+  //! `threadCount` threads, the calling thread included (zero means the count
+  //! of hardware threads). Items are taken in order by whichever thread is
+  //! free, the function returns after all items were processed.
+  //!
+  //! If a thread can't be started its items are processed by the remaining
+  //! threads, so all items are processed even if no thread could be started.
+  ASMJIT_API static void runParallel(ParallelFunc func, void* data, size_t count, uint32_t threadCount = 0) noexcept;
+
+  // --------------------------------------------------------------------------
+  // [Atomic]
+  // --------------------------------------------------------------------------
+
+  //! \internal
+  //!
+  //! Load `*p` with acquire semantics.
+  static ASMJIT_INLINE uint32_t atomicLoad(const volatile uint32_t* p) noexcept {
+#if ASMJIT_CC_MSC
+    return static_cast<uint32_t>(_InterlockedCompareExchange((volatile long*)p, 0, 0));
+#else
+    return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+#endif
+  }
+
+  //! \internal
+  //!
+  //! Add `x` to `*p` atomically and return the previous value.
+  static ASMJIT_INLINE uint32_t atomicAdd(volatile uint32_t* p, uint32_t x) noexcept {
+#if ASMJIT_CC_MSC
+    return static_cast<uint32_t>(_InterlockedExchangeAdd((volatile long*)p, static_cast<long>(x)));
+#else
+    return __atomic_fetch_add(p, x, __ATOMIC_ACQ_REL);
+#endif
+  }
+
+  //! \internal
+  //!
+  //! Store `x` to `*p` with release semantics.
+  static ASMJIT_INLINE void atomicStore(volatile uint32_t* p, uint32_t x) noexcept {
+#if ASMJIT_CC_MSC
+    _InterlockedExchange((volatile long*)p, static_cast<long>(x));
+#else
+    __atomic_store_n(p, x, __ATOMIC_RELEASE);
+#endif
+  }
+
+  //! \internal
+  //!
+  //! Store `x` to an 8-byte aligned `*p` by a single store with release
+  //! semantics (also on 32-bit targets).
+  static ASMJIT_INLINE void atomicStore(volatile uint64_t* p, uint64_t x) noexcept {
+#if ASMJIT_CC_MSC
+    int64_t old = *(volatile int64_t*)p;
+    for (;;) {
+      int64_t prev = _InterlockedCompareExchange64((volatile int64_t*)p, static_cast<int64_t>(x), old);
+      if (prev == old) break;
+      old = prev;
+    }
+#else
+    __atomic_store_n(p, x, __ATOMIC_RELEASE);
+#endif
+  }
 };
 
 // ============================================================================
@@ -112,6 +246,8 @@ struct Lock {
 
   //! Lock.
   ASMJIT_INLINE void lock() noexcept { EnterCriticalSection(&_handle); }
+  //! Try to lock without blocking, returns true if the lock was acquired.
+  ASMJIT_INLINE bool tryLock() noexcept { return TryEnterCriticalSection(&_handle) != 0; }
   //! Unlock.
   ASMJIT_INLINE void unlock() noexcept { LeaveCriticalSection(&_handle); }
 #endif // ASMJIT_OS_WINDOWS
@@ -130,6 +266,8 @@ struct Lock {
 
   //! Lock.
   ASMJIT_INLINE void lock() noexcept { pthread_mutex_lock(&_handle); }
+  //! Try to lock without blocking, returns true if the lock was acquired.
+  ASMJIT_INLINE bool tryLock() noexcept { return pthread_mutex_trylock(&_handle) == 0; }
   //! Unlock.
   ASMJIT_INLINE void unlock() noexcept { pthread_mutex_unlock(&_handle); }
 #endif // ASMJIT_OS_POSIX
@@ -167,6 +305,88 @@ struct AutoLock {
   Lock& _target;
 };
 
+// ============================================================================
+// [asmjit::CondVar]
+// ============================================================================
+
+//! \internal
+//!
+//! Condition variable used together with \ref Lock.
+struct CondVar {
+  ASMJIT_NONCOPYABLE(CondVar)
+
+#if ASMJIT_OS_WINDOWS
+  typedef CONDITION_VARIABLE Handle;
+
+  //! Create a new `CondVar` instance.
+  ASMJIT_INLINE CondVar() noexcept { InitializeConditionVariable(&_handle); }
+  //! Destroy the `CondVar` instance.
+  ASMJIT_INLINE ~CondVar() noexcept {}
+
+  //! Unlock `lock`, wait until signaled, and lock `lock` again.
+  ASMJIT_INLINE void wait(Lock& lock) noexcept { SleepConditionVariableCS(&_handle, &lock._handle, INFINITE); }
+  //! Wake up one waiting thread.
+  ASMJIT_INLINE void signal() noexcept { WakeConditionVariable(&_handle); }
+  //! Wake up all waiting threads.
+  ASMJIT_INLINE void broadcast() noexcept { WakeAllConditionVariable(&_handle); }
+#endif // ASMJIT_OS_WINDOWS
+
+#if ASMJIT_OS_POSIX
+  typedef pthread_cond_t Handle;
+
+  //! Create a new `CondVar` instance.
+  ASMJIT_INLINE CondVar() noexcept { pthread_cond_init(&_handle, nullptr); }
+  //! Destroy the `CondVar` instance.
+  ASMJIT_INLINE ~CondVar() noexcept { pthread_cond_destroy(&_handle); }
+
+  //! Unlock `lock`, wait until signaled, and lock `lock` again.
+  ASMJIT_INLINE void wait(Lock& lock) noexcept { pthread_cond_wait(&_handle, &lock._handle); }
+  //! Wake up one waiting thread.
+  ASMJIT_INLINE void signal() noexcept { pthread_cond_signal(&_handle); }
+  //! Wake up all waiting threads.
+  ASMJIT_INLINE void broadcast() noexcept { pthread_cond_broadcast(&_handle); }
+#endif // ASMJIT_OS_POSIX
+
+  //! Native handle.
+  Handle _handle;
+};
+
+// ============================================================================
+// [asmjit::Thread]
+// ============================================================================
+
+//! \internal
+//!
+//! Thread that runs a single function, must be joined before destroyed.
+struct Thread {
+  ASMJIT_NONCOPYABLE(Thread)
+
+  //! Function run by the thread.
+  typedef void (ASMJIT_CDECL* Func)(void* data);
+
+#if ASMJIT_OS_WINDOWS
+  typedef HANDLE Handle;
+#else
+  typedef pthread_t Handle;
+#endif
+
+  ASMJIT_INLINE Thread() noexcept : _func(nullptr), _data(nullptr), _started(false) {}
+  ASMJIT_INLINE ~Thread() noexcept { ASMJIT_ASSERT(!_started); }
+
+  //! Get whether the thread was started and not joined yet.
+  ASMJIT_INLINE bool isStarted() const noexcept { return _started; }
+
+  //! Start the thread that calls `func(data)`.
+  ASMJIT_API Error start(Func func, void* data) noexcept;
+  //! Wait until the thread ends.
+  ASMJIT_API void join() noexcept;
+
+  Func _func;                            //!< Function run by the thread.
+  void* _data;                           //!< Data passed to `_func`.
+  Handle _handle;                        //!< Native handle.
+  bool _started;                         //!< Whether the thread was started.
+};
+
 //! \}
 
 } // asmjit namespace
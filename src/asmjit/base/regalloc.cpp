@@ -15,6 +15,13 @@
 #include "../base/regalloc_p.h"
 #include "../base/utils.h"
 
+#if ASMJIT_ARCH_X64 || (ASMJIT_ARCH_X86 && (defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)))
+# define ASMJIT_RA_USE_SSE2 1
+# include <emmintrin.h>
+#else
+# define ASMJIT_RA_USE_SSE2 0
+#endif
+
 // [Api-Begin]
 #include "../asmjit_apibegin.h"
 
@@ -24,9 +31,40 @@ namespace asmjit {
 // [asmjit::RAPass - Construction / Destruction]
 // ============================================================================
 
+static const char* const RAPass_phaseNames[RAPass::kPhaseCount] = {
+  "Fetch",
+  "Unreachable",
+  "Liveness",
+  "Coalesce",
+  "LiveRanges",
+  "Annotate",
+  "Translate"
+};
+
+// Slot sizes of `RAPass::_heap`. Vectors used by the pass grow by doubling,
+// so they need power of 2 slots above 512 bytes, which the default table
+// leaves to dynamic blocks, while RAData (VarMap + TiedReg array) needs fine
+// granularity below.
+static const uint32_t RAPass_heapSlotSizes[] = {
+  32, 64, 96, 128, 160, 192, 256, 320, 384, 512, 768, 1024, 1536, 2048
+};
+
 RAPass::RAPass() noexcept :
   CBPass("RA"),
-  _varMapToVaListOffset(0) {}
+  _varMapToVaListOffset(0),
+  _inSwitch(0),
+  _report(nullptr) {
+
+  _phaseNames = RAPass_phaseNames;
+  _phaseCount = kPhaseCount;
+
+  Error err = ZoneHeap::initSlotTable(&_heapSlots,
+    RAPass_heapSlotSizes, static_cast<uint32_t>(ASMJIT_ARRAY_SIZE(RAPass_heapSlotSizes)));
+  ASMJIT_ASSERT(err == kErrorOk);
+  ASMJIT_UNUSED(err);
+
+  _heap.setSlotTable(&_heapSlots);
+}
 RAPass::~RAPass() noexcept {}
 
 // ============================================================================
@@ -37,6 +75,7 @@ Error RAPass::process(Zone* zone) noexcept {
   _zone = zone;
   _heap.reset(zone);
   _emitComments = (cb()->getGlobalOptions() & CodeEmitter::kOptionLoggingEnabled) != 0;
+  _statsEnabled = cb()->hasStatsEnabled();
 
   Error err = kErrorOk;
   CBNode* node = cc()->getFirstNode();
@@ -63,30 +102,84 @@ Error RAPass::process(Zone* zone) noexcept {
 }
 
 Error RAPass::compile(CCFunc* func) noexcept {
+  uint64_t time = 0;
+  if (_statsEnabled) {
+    CBNode* node = func;
+    CBNode* stop = func->getEnd()->getNext();
+
+    uint64_t nodeCount = 0;
+    do {
+      nodeCount++;
+      node = node->getNext();
+    } while (node != stop);
+
+    _stats.funcCount++;
+    _stats.nodeCount += nodeCount;
+    time = OSUtils::getHighResTime();
+  }
+
   ASMJIT_PROPAGATE(prepare(func));
 
   Error err;
   do {
     err = fetch();
     if (err) break;
+    statsPhase(kPhaseFetch, time);
 
     err = removeUnreachableCode();
     if (err) break;
+    statsPhase(kPhaseUnreachable, time);
 
     err = livenessAnalysis();
     if (err) break;
+    statsPhase(kPhaseLiveness, time);
+
+    err = coalesce();
+    if (err) break;
+
+    if (_report) {
+      err = reportPressure();
+      if (err) break;
+    }
+    statsPhase(kPhaseCoalesce, time);
+
+    if (_linearScan) {
+      err = buildLiveRanges();
+      if (err) break;
+
+      if (_globalAlloc) {
+        err = buildLoops();
+        if (err) break;
+      }
+      statsPhase(kPhaseLiveRanges, time);
+    }
 
 #if !defined(ASMJIT_DISABLE_LOGGING)
     if (cc()->getGlobalOptions() & CodeEmitter::kOptionLoggingEnabled) {
       err = annotate();
       if (err) break;
+      statsPhase(kPhaseAnnotate, time);
     }
 #endif // !ASMJIT_DISABLE_LOGGING
 
     err = translate();
+    if (err || !_report) break;
+
+    _report->varStackSize = _memVarTotal;
+    _report->stackSize = _memAllTotal;
+
+#if !defined(ASMJIT_DISABLE_LOGGING)
+    if (_emitComments) {
+      StringBuilderTmp<256> sb;
+      err = formatInlineComment(sb, func);
+      if (err) break;
+      func->setInlineComment(static_cast<char*>(cc()->_cbDataZone.dup(sb.getData(), sb.getLength(), true)));
+    }
+#endif // !ASMJIT_DISABLE_LOGGING
   } while (false);
 
   cleanup();
+  statsPhase(kPhaseTranslate, time);
 
   // We alter the compiler cursor, because it doesn't make sense to reference
   // it after compilation - some nodes may disappear and it's forbidden to add
@@ -101,9 +194,17 @@ Error RAPass::prepare(CCFunc* func) noexcept {
   _func = func;
   _stop = end->getNext();
 
+  uint32_t strategy = func->getRAStrategy();
+  if (strategy == kRAStrategyDefault)
+    strategy = cc()->getRAStrategy();
+  _linearScan = strategy == kRAStrategyLinearScan || strategy == kRAStrategyGlobal;
+  _globalAlloc = strategy == kRAStrategyGlobal;
+
   _unreachableList.reset();
   _returningList.reset();
   _jccList.reset();
+  _loops = nullptr;
+  _cfg.reset();
   _contextVd.reset();
 
   _memVarCells = nullptr;
@@ -124,6 +225,26 @@ Error RAPass::prepare(CCFunc* func) noexcept {
   _memAllTotal = 0;
   _annotationLength = 12;
 
+  _inSwitch = 0;
+  _report = nullptr;
+
+  // The report is allocated once per function and kept by it, it's reused if
+  // the function is allocated again.
+  if (_statsEnabled) {
+    CCFuncReport* report = func->_report;
+    if (!report) {
+      report = cc()->_cbDataZone.allocT<CCFuncReport>();
+      if (ASMJIT_UNLIKELY(!report))
+        return DebugUtils::errored(kErrorNoHeapMemory);
+
+      new(report) CCFuncReport();
+      func->_report = report;
+    }
+
+    report->reset();
+    _report = report;
+  }
+
   return kErrorOk;
 }
 
@@ -135,6 +256,8 @@ void RAPass::cleanup() noexcept {
     VirtReg* vreg = virtArray[i];
     vreg->_raId = kInvalidValue;
     vreg->resetPhysId();
+    vreg->_isMaterialized = false;
+    vreg->_materializeNode = nullptr;
   }
 
   _contextVd.reset();
@@ -175,13 +298,15 @@ RACell* RAPass::_newVarCell(VirtReg* vreg) {
     cell = static_cast<RACell*>(_zone->alloc(sizeof(RACell)));
     if (!cell) goto _NoMemory;
 
+    // Home slots of vectors wider than 16 bytes are saved and restored by
+    // unaligned moves, so they don't force dynamic stack alignment.
     cell->next = _memVarCells;
     cell->offset = 0;
     cell->size = size;
-    cell->alignment = size;
+    cell->alignment = std::min<uint32_t>(size, 16);
 
     _memVarCells = cell;
-    _memMaxAlign = std::max<uint32_t>(_memMaxAlign, size);
+    _memMaxAlign = std::max<uint32_t>(_memMaxAlign, cell->alignment);
     _memVarTotal += size;
 
     switch (size) {
@@ -352,12 +477,79 @@ Error RAPass::removeUnreachableCode() {
 // ============================================================================
 
 //! \internal
-struct LivenessTarget {
-  LivenessTarget* prev;  //!< Previous target.
-  CBLabel* node;         //!< Target node.
-  CBJump* from;          //!< Jumped from.
+//!
+//! Basic block used by liveness analysis.
+//!
+//! A block starts at a label, at the function node, or after a jump and ends
+//! before the next label or jump. Its bit-vectors point to a single slab of
+//! cache-line aligned memory shared by all blocks.
+struct RALiveBlock {
+  enum {
+    kFlagReachable = 0x1,                //!< Block reaches a returning node.
+    kFlagQueued    = 0x2                 //!< Block is in the worklist.
+  };
+
+  CBNode* first;                         //!< First node of the block.
+  CBNode* last;                          //!< Last node of the block.
+  uint32_t succ[2];                      //!< Fall-through and jump successors.
+  uint32_t predIndex;                    //!< First predecessor in the predecessor array.
+  uint32_t flags;                        //!< Block flags.
+
+  uintptr_t* gen;                        //!< Variables read before written in the block.
+  uintptr_t* kill;                       //!< Variables written (write-only) in the block.
+  uintptr_t* in;                         //!< Variables live at the block entry.
+  uintptr_t* out;                        //!< Variables live at the block exit.
 };
 
+// Bit-vectors of blocks are padded to a cache line, which makes SSE2 kernels
+// simple as they never have to handle a tail.
+static const uint32_t kRALiveAlignment = 64;
+static const uint32_t kRALiveNoBlock = 0xFFFFFFFFU;
+
+//! \internal
+//!
+//! `dst |= src`.
+static ASMJIT_INLINE void RALive_or(uintptr_t* dst, const uintptr_t* src, uint32_t stride) noexcept {
+#if ASMJIT_RA_USE_SSE2
+  for (uint32_t i = 0; i < stride; i += 16 / RABits::kEntitySize) {
+    __m128i a = _mm_load_si128(reinterpret_cast<const __m128i*>(dst + i));
+    __m128i b = _mm_load_si128(reinterpret_cast<const __m128i*>(src + i));
+    _mm_store_si128(reinterpret_cast<__m128i*>(dst + i), _mm_or_si128(a, b));
+  }
+#else
+  for (uint32_t i = 0; i < stride; i++)
+    dst[i] |= src[i];
+#endif
+}
+
+//! \internal
+//!
+//! `in = gen | (out & ~kill)`, returns `true` if `in` has changed.
+static ASMJIT_INLINE bool RALive_update(uintptr_t* in, const uintptr_t* gen, const uintptr_t* out, const uintptr_t* kill, uint32_t stride) noexcept {
+#if ASMJIT_RA_USE_SSE2
+  __m128i changed = _mm_setzero_si128();
+  for (uint32_t i = 0; i < stride; i += 16 / RABits::kEntitySize) {
+    __m128i x = _mm_load_si128(reinterpret_cast<const __m128i*>(in   + i));
+    __m128i g = _mm_load_si128(reinterpret_cast<const __m128i*>(gen  + i));
+    __m128i o = _mm_load_si128(reinterpret_cast<const __m128i*>(out  + i));
+    __m128i k = _mm_load_si128(reinterpret_cast<const __m128i*>(kill + i));
+
+    __m128i y = _mm_or_si128(g, _mm_andnot_si128(k, o));
+    changed = _mm_or_si128(changed, _mm_xor_si128(x, y));
+    _mm_store_si128(reinterpret_cast<__m128i*>(in + i), y);
+  }
+  return _mm_movemask_epi8(_mm_cmpeq_epi8(changed, _mm_setzero_si128())) != 0xFFFF;
+#else
+  uintptr_t changed = 0;
+  for (uint32_t i = 0; i < stride; i++) {
+    uintptr_t y = gen[i] | (out[i] & ~kill[i]);
+    changed |= in[i] ^ y;
+    in[i] = y;
+  }
+  return changed != 0;
+#endif
+}
+
 Error RAPass::livenessAnalysis() {
   uint32_t bLen = static_cast<uint32_t>(
     ((_contextVd.getLength() + RABits::kEntityBits - 1) / RABits::kEntityBits));
@@ -367,169 +559,754 @@ Error RAPass::livenessAnalysis() {
     return kErrorOk;
 
   CCFunc* func = getFunc();
-  CBJump* from = nullptr;
+  CBNode* stop = _stop;
+
+  CBNode* node;
+  CBNode* prev;
+
+  size_t varMapToVaListOffset = _varMapToVaListOffset;
+  uint32_t i, b, blockCount = 0, edgeCount = 0;
+
+  // --------------------------------------------------------------------------
+  // [Blocks]
+  // --------------------------------------------------------------------------
+
+  // Assign block ids. Nodes without pass-data are unreachable and they also
+  // interrupt the flow, so the next reachable node must start a new block.
+  prev = nullptr;
+  for (node = func; node != stop; node = node->getNext()) {
+    if (!node->hasPassData()) {
+      prev = nullptr;
+      continue;
+    }
 
-  LivenessTarget* ltCur = nullptr;
-  LivenessTarget* ltUnused = nullptr;
+    if (!prev || prev->isJmpOrJcc() || node->getType() == CBNode::kNodeLabel)
+      blockCount++;
 
-  ZoneList<CBNode*>::Link* retPtr = _returningList.getFirst();
-  ASMJIT_ASSERT(retPtr != nullptr);
+    node->getPassData<RAData>()->blockId = blockCount - 1;
+    prev = node;
+  }
 
-  CBNode* node = retPtr->getValue();
-  RAData* wd;
+  uint32_t stride = Utils::alignTo<uint32_t>(bLen, kRALiveAlignment / RABits::kEntitySize);
+  size_t slabSize = static_cast<size_t>(blockCount) * 4 * stride * RABits::kEntitySize;
 
-  size_t varMapToVaListOffset = _varMapToVaListOffset;
+  RALiveBlock* blocks = _zone->allocT<RALiveBlock>(blockCount * sizeof(RALiveBlock));
+  uint32_t* scratch = _zone->allocT<uint32_t>(blockCount * 4 * sizeof(uint32_t));
+  uint8_t* slab = static_cast<uint8_t*>(_zone->alloc(slabSize + kRALiveAlignment));
   RABits* bCur = newBits(bLen);
-  if (ASMJIT_UNLIKELY(!bCur)) goto NoMem;
 
-  // Allocate bits for code visited first time.
-Visit:
-  for (;;) {
-    wd = node->getPassData<RAData>();
-    if (wd->liveness) {
-      if (bCur->_addBitsDelSource(wd->liveness, bCur, bLen))
-        goto Patch;
-      else
-        goto Done;
+  if (ASMJIT_UNLIKELY(!blocks || !scratch || !slab || !bCur))
+    return DebugUtils::errored(kErrorNoHeapMemory);
+
+  slab = Utils::alignTo<uint8_t*>(slab, kRALiveAlignment);
+  ::memset(slab, 0, slabSize);
+
+  for (b = 0; b < blockCount; b++) {
+    RALiveBlock& block = blocks[b];
+    uintptr_t* bits = reinterpret_cast<uintptr_t*>(slab) + static_cast<size_t>(b) * 4 * stride;
+
+    block.first = nullptr;
+    block.last = nullptr;
+    block.succ[0] = kRALiveNoBlock;
+    block.succ[1] = kRALiveNoBlock;
+    block.predIndex = 0;
+    block.flags = 0;
+
+    block.gen  = bits;
+    block.kill = bits + stride;
+    block.in   = bits + stride * 2;
+    block.out  = bits + stride * 3;
+  }
+
+  // Link blocks, compute successors. A label that follows an unconditional
+  // jump is only reachable through jumps.
+  prev = nullptr;
+  for (node = func; node != stop; node = node->getNext()) {
+    if (!node->hasPassData()) {
+      prev = nullptr;
+      continue;
     }
 
-    RABits* bTmp = copyBits(bCur, bLen);
-    if (!bTmp) goto NoMem;
+    b = node->getPassData<RAData>()->blockId;
+    RALiveBlock& block = blocks[b];
 
-    wd = node->getPassData<RAData>();
-    wd->liveness = bTmp;
+    if (!block.first) {
+      block.first = node;
+      if (prev && !prev->isJmp()) {
+        blocks[b - 1].succ[0] = b;
+        edgeCount++;
+      }
+    }
+    block.last = node;
 
-    uint32_t tiedTotal = wd->tiedTotal;
-    TiedReg* tiedArray = reinterpret_cast<TiedReg*>(((uint8_t*)wd) + varMapToVaListOffset);
+    if (node->isJmpOrJcc()) {
+      CBLabel* target = static_cast<CBJump*>(node)->getTarget();
+      if (target && target->hasPassData()) {
+        block.succ[1] = target->getPassData<RAData>()->blockId;
+        edgeCount++;
+      }
+    }
 
-    for (uint32_t i = 0; i < tiedTotal; i++) {
-      TiedReg* tied = &tiedArray[i];
-      VirtReg* vreg = tied->vreg;
+    prev = node;
+  }
 
-      uint32_t flags = tied->flags;
-      uint32_t raId = vreg->_raId;
+  // Build predecessor lists, stored in a single array indexed by `predIndex`.
+  uint32_t* preds = _zone->allocT<uint32_t>((edgeCount + 1) * sizeof(uint32_t));
+  if (ASMJIT_UNLIKELY(!preds))
+    return DebugUtils::errored(kErrorNoHeapMemory);
 
-      if ((flags & TiedReg::kWAll) && !(flags & TiedReg::kRAll)) {
-        // Write-Only.
-        bTmp->setBit(raId);
-        bCur->delBit(raId);
+  uint32_t* predCount = scratch;
+  ::memset(predCount, 0, blockCount * sizeof(uint32_t));
+
+  for (b = 0; b < blockCount; b++)
+    for (i = 0; i < 2; i++)
+      if (blocks[b].succ[i] != kRALiveNoBlock)
+        predCount[blocks[b].succ[i]]++;
+
+  for (b = 0, i = 0; b < blockCount; b++) {
+    blocks[b].predIndex = i;
+    i += predCount[b];
+    predCount[b] = blocks[b].predIndex;
+  }
+
+  for (b = 0; b < blockCount; b++)
+    for (i = 0; i < 2; i++)
+      if (blocks[b].succ[i] != kRALiveNoBlock)
+        preds[predCount[blocks[b].succ[i]]++] = b;
+
+  // --------------------------------------------------------------------------
+  // [Gen / Kill]
+  // --------------------------------------------------------------------------
+
+  for (b = 0; b < blockCount; b++) {
+    RALiveBlock& block = blocks[b];
+    RABits* gen = reinterpret_cast<RABits*>(block.gen);
+    RABits* kill = reinterpret_cast<RABits*>(block.kill);
+
+    node = block.last;
+    for (;;) {
+      RAData* wd = node->getPassData<RAData>();
+      uint32_t tiedTotal = wd->tiedTotal;
+      TiedReg* tiedArray = reinterpret_cast<TiedReg*>(((uint8_t*)wd) + varMapToVaListOffset);
+
+      for (i = 0; i < tiedTotal; i++) {
+        TiedReg* tied = &tiedArray[i];
+        uint32_t flags = tied->flags;
+        uint32_t raId = tied->vreg->_raId;
+
+        if ((flags & TiedReg::kWAll) && !(flags & TiedReg::kRAll)) {
+          // Write-Only.
+          gen->delBit(raId);
+          kill->setBit(raId);
+        }
+        else {
+          // Read-Only or Read/Write.
+          gen->setBit(raId);
+        }
       }
-      else {
-        // Read-Only or Read/Write.
+
+      if (node == block.first) break;
+      node = node->getPrev();
+    }
+  }
+
+  // --------------------------------------------------------------------------
+  // [Order]
+  // --------------------------------------------------------------------------
+
+  // Only blocks that reach a returning node are analyzed, which is the same
+  // set of nodes the liveness was always computed for. The order is a reverse
+  // post-order of the reversed CFG (DFS that starts at returning nodes and
+  // follows predecessors), which is the natural order for backward problems.
+  uint32_t* order = scratch;                   // Post-order, reused later as a worklist.
+  uint32_t* stack = scratch + blockCount;      // DFS stack of blocks.
+  uint32_t* stackIter = scratch + blockCount * 2; // DFS stack of predecessor indexes.
+  uint32_t orderCount = 0;
+
+  for (ZoneList<CBNode*>::Link* link = _returningList.getFirst(); link; link = link->getNext()) {
+    CBNode* retNode = link->getValue();
+    if (!retNode->hasPassData()) continue;
+
+    b = retNode->getPassData<RAData>()->blockId;
+    if (blocks[b].flags & RALiveBlock::kFlagReachable) continue;
+
+    uint32_t sp = 0;
+    blocks[b].flags |= RALiveBlock::kFlagReachable;
+    stack[0] = b;
+    stackIter[0] = blocks[b].predIndex;
+
+    for (;;) {
+      uint32_t cur = stack[sp];
+      uint32_t end = cur + 1 < blockCount ? blocks[cur + 1].predIndex : edgeCount;
+
+      if (stackIter[sp] < end) {
+        uint32_t p = preds[stackIter[sp]++];
+        if (!(blocks[p].flags & RALiveBlock::kFlagReachable)) {
+          blocks[p].flags |= RALiveBlock::kFlagReachable;
+          sp++;
+          stack[sp] = p;
+          stackIter[sp] = blocks[p].predIndex;
+        }
+        continue;
+      }
+
+      order[orderCount++] = cur;
+      if (sp == 0) break;
+      sp--;
+    }
+  }
+
+  // --------------------------------------------------------------------------
+  // [Fixpoint]
+  // --------------------------------------------------------------------------
+
+  // The worklist is a FIFO ring seeded by all reachable blocks in the reverse
+  // post-order. The ring has one more slot than there are blocks so it never
+  // becomes full as each block can only be queued once.
+  uint32_t* queue = stack;
+  uint32_t queueSize = blockCount + 1;
+  uint32_t qHead = 0;
+  uint32_t qTail = 0;
+
+  for (i = orderCount; i != 0; i--) {
+    b = order[i - 1];
+    blocks[b].flags |= RALiveBlock::kFlagQueued;
+    queue[qTail++] = b;
+  }
+
+  while (qHead != qTail) {
+    b = queue[qHead];
+    if (++qHead == queueSize) qHead = 0;
+
+    RALiveBlock& block = blocks[b];
+    block.flags &= ~RALiveBlock::kFlagQueued;
+
+    for (i = 0; i < 2; i++)
+      if (block.succ[i] != kRALiveNoBlock)
+        RALive_or(block.out, blocks[block.succ[i]].in, stride);
+
+    if (!RALive_update(block.in, block.gen, block.out, block.kill, stride))
+      continue;
+
+    uint32_t pEnd = b + 1 < blockCount ? blocks[b + 1].predIndex : edgeCount;
+    for (i = block.predIndex; i < pEnd; i++) {
+      uint32_t p = preds[i];
+      if ((blocks[p].flags & (RALiveBlock::kFlagReachable | RALiveBlock::kFlagQueued)) != RALiveBlock::kFlagReachable)
+        continue;
+
+      blocks[p].flags |= RALiveBlock::kFlagQueued;
+      queue[qTail] = p;
+      if (++qTail == queueSize) qTail = 0;
+    }
+  }
+
+  // --------------------------------------------------------------------------
+  // [Nodes]
+  // --------------------------------------------------------------------------
+
+  // Each node gets variables live after it combined with variables it uses,
+  // dead nodes are removed (see `canRemoveDead()`).
+  for (i = 0; i < orderCount; i++) {
+    RALiveBlock& block = blocks[order[i]];
+    ::memcpy(bCur->data, block.out, bLen * RABits::kEntitySize);
+
+    uint32_t flagsLive = 0xFFFFFFFFU;
+    node = block.last;
+
+    for (;;) {
+      RAData* wd = node->getPassData<RAData>();
+      CBNode* prevNode = node->getPrev();
+      bool isFirst = node == block.first;
+
+      uint32_t tiedTotal = wd->tiedTotal;
+      TiedReg* tiedArray = reinterpret_cast<TiedReg*>(((uint8_t*)wd) + varMapToVaListOffset);
+
+      uint32_t j;
+      uint32_t flagsR, flagsW;
+
+      if (canRemoveDead(node, &flagsR, &flagsW) && !(flagsW & flagsLive)) {
+        bool writes = flagsW != 0;
+        bool dead = true;
+
+        for (j = 0; j < tiedTotal; j++) {
+          if (tiedArray[j].flags & TiedReg::kWAll) {
+            writes = true;
+            dead &= !bCur->getBit(tiedArray[j].vreg->_raId);
+          }
+        }
+
+        if (writes && dead) {
+          cc()->removeNode(node);
+          _stats.deadCount += _statsEnabled;
+
+          if (isFirst) break;
+          node = prevNode;
+          continue;
+        }
+      }
+
+      RABits* bTmp = copyBits(bCur, bLen);
+      if (ASMJIT_UNLIKELY(!bTmp))
+        return DebugUtils::errored(kErrorNoHeapMemory);
+      wd->liveness = bTmp;
+
+      for (j = 0; j < tiedTotal; j++) {
+        TiedReg* tied = &tiedArray[j];
+        uint32_t flags = tied->flags;
+        uint32_t raId = tied->vreg->_raId;
+
         bTmp->setBit(raId);
-        bCur->setBit(raId);
+        if ((flags & TiedReg::kWAll) && !(flags & TiedReg::kRAll))
+          bCur->delBit(raId);
+        else
+          bCur->setBit(raId);
+      }
+
+      flagsLive = (flagsLive & ~flagsW) | flagsR;
+
+      if (isFirst) break;
+      node = prevNode;
+    }
+  }
+
+  return kErrorOk;
+}
+
+// ============================================================================
+// [asmjit::RAPass - Live Ranges]
+// ============================================================================
+
+Error RAPass::buildLiveRanges() {
+  VirtReg** virtArray = _contextVd.getData();
+  uint32_t virtCount = static_cast<uint32_t>(_contextVd.getLength());
+  uint32_t bLen = (virtCount + RABits::kEntityBits - 1) / RABits::kEntityBits;
+
+  uint32_t i;
+  for (i = 0; i < virtCount; i++)
+    virtArray[i]->_rangeEnd = 0;
+
+  for (CBNode* node = getFunc(); node != _stop; node = node->getNext()) {
+    RAData* wd = node->getPassData<RAData>();
+    if (!wd || !wd->liveness) continue;
+
+    uint32_t position = node->getPosition();
+    const uintptr_t* data = wd->liveness->data;
+
+    for (i = 0; i < bLen; i++) {
+      for (uint32_t shift = 0; shift < RABits::kEntityBits; shift += 32) {
+        uint32_t bits = static_cast<uint32_t>(data[i] >> shift);
+        uint32_t base = i * RABits::kEntityBits + shift;
+
+        while (bits) {
+          VirtReg* vreg = virtArray[base + Utils::findFirstBit(bits)];
+          bits &= bits - 1;
+
+          if (vreg->_rangeEnd < position)
+            vreg->_rangeEnd = position;
+        }
       }
     }
+  }
+
+  return kErrorOk;
+}
+
+// ============================================================================
+// [asmjit::RAPass - Loops]
+// ============================================================================
+
+Error RAPass::buildLoops() {
+  VirtReg** virtArray = _contextVd.getData();
+  uint32_t virtCount = static_cast<uint32_t>(_contextVd.getLength());
+  uint32_t bLen = (virtCount + RABits::kEntityBits - 1) / RABits::kEntityBits;
+
+  uint32_t i;
+  for (i = 0; i < virtCount; i++)
+    virtArray[i]->_spillWeight = 0;
+
+  CBFlowGraph& cfg = _cfg;
+  ASMJIT_PROPAGATE(cfg.build(cc(), _zone, getFunc(), _stop));
+
+  for (uint32_t b = 0; b < cfg.getRPOCount(); b++) {
+    CBBlock* block = cfg.getRPOBlock(b);
+    uint32_t depth = block->getLoopDepth();
+
+    // Create `RALoop` of each header, headers precede blocks of their loops.
+    if (block->isLoopHeader()) {
+      RAData* hd = block->getFirst()->getPassData<RAData>();
+      if (hd) {
+        RALoop* loop = _zone->allocZeroedT<RALoop>();
+        RABits* used = newBits(bLen);
+        if (ASMJIT_UNLIKELY(!loop || !used))
+          return DebugUtils::errored(kErrorNoHeapMemory);
+
+        loop->next = _loops;
+        loop->block = block;
+        loop->used = used;
+
+        hd->loop = loop;
+        _loops = loop;
+      }
+    }
+
+    // Saturate at 8^4, which can't overflow even in huge functions.
+    uint32_t frequency = 1U << (std::min<uint32_t>(depth, 4) * 3);
+
+    CBNode* node = block->getFirst();
+    CBNode* last = block->getLast();
+
+    for (;;) {
+      RAData* wd = node->getPassData<RAData>();
+      if (wd) {
+        uint32_t tiedTotal = wd->tiedTotal;
+        TiedReg* tiedArray = reinterpret_cast<TiedReg*>(((uint8_t*)wd) + _varMapToVaListOffset);
+
+        for (i = 0; i < tiedTotal; i++)
+          tiedArray[i].vreg->_spillWeight += frequency;
+
+        if (depth && wd->liveness) {
+          // Count live variables of each kind, shared by all loops of the block.
+          uint32_t pressure[Globals::kMaxVRegKinds] = { 0 };
+          const uintptr_t* data = wd->liveness->data;
 
-    if (node->getType() == CBNode::kNodeLabel)
-      goto Target;
+          for (i = 0; i < bLen; i++) {
+            for (uint32_t shift = 0; shift < RABits::kEntityBits; shift += 32) {
+              uint32_t bits = static_cast<uint32_t>(data[i] >> shift);
+              uint32_t base = i * RABits::kEntityBits + shift;
 
-    if (node == func)
-      goto Done;
+              while (bits) {
+                VirtReg* vreg = virtArray[base + Utils::findFirstBit(bits)];
+                bits &= bits - 1;
 
-    ASMJIT_ASSERT(node->getPrev());
-    node = node->getPrev();
+                uint32_t kind = vreg->getKind();
+                if (kind < Globals::kMaxVRegKinds)
+                  pressure[kind]++;
+              }
+            }
+          }
+
+          for (CBBlock* header = block->getLoopHeader(); header; header = header->getLoopParent()) {
+            RAData* hd = header->getFirst()->getPassData<RAData>();
+            RALoop* loop = hd ? hd->loop : static_cast<RALoop*>(nullptr);
+            if (!loop) continue;
+
+            for (i = 0; i < tiedTotal; i++)
+              loop->used->setBit(tiedArray[i].vreg->_raId);
+
+            for (uint32_t kind = 0; kind < Globals::kMaxVRegKinds; kind++)
+              loop->pressure[kind] = std::max<uint32_t>(loop->pressure[kind], pressure[kind]);
+          }
+        }
+      }
+
+      if (node == last) break;
+      node = node->getNext();
+    }
   }
 
-  // Patch already generated liveness bits.
-Patch:
-  for (;;) {
-    ASMJIT_ASSERT(node->hasPassData());
-    ASMJIT_ASSERT(node->getPassData<RAData>()->liveness != nullptr);
+  return kErrorOk;
+}
 
-    RABits* bNode = node->getPassData<RAData>()->liveness;
-    if (!bNode->_addBitsDelSource(bCur, bLen)) goto Done;
-    if (node->getType() == CBNode::kNodeLabel) goto Target;
+// ============================================================================
+// [asmjit::RAPass - Coalesce]
+// ============================================================================
 
-    if (node == func) goto Done;
-    node = node->getPrev();
+static ASMJIT_INLINE void RAPass_renameOperand(Operand_& op, uint32_t from, uint32_t to) noexcept {
+  if (op.isReg()) {
+    if (op.getId() == from)
+      static_cast<Reg&>(op).setId(to);
+  }
+  else if (op.isMem()) {
+    Mem& m = static_cast<Mem&>(op);
+    if (m.hasBaseReg() && m.getBaseId() == from)
+      m._setBase(m.getBaseType(), to);
+    if (m.hasIndexReg() && m.getIndexId() == from)
+      m._setIndex(m.getIndexType(), to);
   }
+}
 
-Target:
-  if (static_cast<CBLabel*>(node)->getNumRefs() != 0) {
-    // Push a new LivenessTarget onto the stack if needed.
-    if (!ltCur || ltCur->node != node) {
-      // Allocate a new LivenessTarget object (from pool or zone).
-      LivenessTarget* ltTmp = ltUnused;
+//! \internal
+//!
+//! Rename `from` to `to` in all operands and registers referenced by `node`.
+static void RAPass_renameNode(CBNode* node, VirtReg* from, VirtReg* to) noexcept {
+  uint32_t fromId = from->getId();
+  uint32_t toId = to->getId();
+  uint32_t i;
+
+  switch (node->getType()) {
+    case CBNode::kNodeFuncCall: {
+      CCFuncCall* call = static_cast<CCFuncCall*>(node);
+      uint32_t argCount = call->getDetail().getArgCount();
+
+      for (i = 0; i < argCount; i++)
+        RAPass_renameOperand(call->_args[i], fromId, toId);
+      for (i = 0; i < 2; i++)
+        RAPass_renameOperand(call->_ret[i], fromId, toId);
+      ASMJIT_FALLTHROUGH;
+    }
 
-      if (ltTmp) {
-        ltUnused = ltUnused->prev;
+    case CBNode::kNodeInst: {
+      CBInst* inst = static_cast<CBInst*>(node);
+      uint32_t opCount = inst->getOpCount();
+
+      if (inst->hasPackedOps()) {
+        // Packed operands are never memory operands, only registers can match.
+        PackedOp* packedOps = inst->getPackedOps();
+        for (i = 0; i < opCount; i++) {
+          Operand op;
+          packedOps[i].unpack(op);
+          if (op.isReg() && op.getId() == fromId)
+            packedOps[i].data = toId;
+        }
       }
       else {
-        ltTmp = _zone->allocT<LivenessTarget>(
-          sizeof(LivenessTarget) - sizeof(RABits) + bLen * sizeof(uintptr_t));
-        if (!ltTmp) goto NoMem;
+        Operand* opArray = inst->getOpArray();
+        for (i = 0; i < opCount; i++)
+          RAPass_renameOperand(opArray[i], fromId, toId);
       }
 
-      // Initialize and make current - ltTmp->from will be set later on.
-      ltTmp->prev = ltCur;
-      ltTmp->node = static_cast<CBLabel*>(node);
-      ltCur = ltTmp;
+      if (inst->hasExtraReg() && inst->getExtraReg().getId() == fromId)
+        inst->getExtraReg().init(inst->getExtraReg().getSignature(), toId);
+      break;
+    }
 
-      from = static_cast<CBLabel*>(node)->getFrom();
-      ASMJIT_ASSERT(from != nullptr);
+    case CBNode::kNodeFunc: {
+      CCFunc* func = static_cast<CCFunc*>(node);
+      uint32_t argCount = func->getArgCount();
+
+      for (i = 0; i < argCount; i++)
+        if (func->_args[i] == from)
+          func->_args[i] = to;
+      break;
     }
-    else {
-      from = ltCur->from;
-      goto JumpNext;
+
+    case CBNode::kNodeFuncExit: {
+      CCFuncRet* ret = static_cast<CCFuncRet*>(node);
+      for (i = 0; i < 2; i++)
+        RAPass_renameOperand(ret->_ret[i], fromId, toId);
+      break;
     }
 
-    // Visit/Patch.
-    do {
-      ltCur->from = from;
-      bCur->copyBits(node->getPassData<RAData>()->liveness, bLen);
+    case CBNode::kNodePushArg: {
+      CCPushArg* arg = static_cast<CCPushArg*>(node);
+      if (arg->_src == from) arg->_src = to;
+      if (arg->_cvt == from) arg->_cvt = to;
+      break;
+    }
 
-      if (!from->getPassData<RAData>()->liveness) {
-        node = from;
-        goto Visit;
-      }
+    case CBNode::kNodeHint: {
+      CCHint* hint = static_cast<CCHint*>(node);
+      if (hint->_vreg == from)
+        hint->_vreg = to;
+      break;
+    }
 
-      // Issue #25: Moved 'JumpNext' here since it's important to patch
-      // code again if there are more live variables than before.
-JumpNext:
-      if (bCur->delBits(from->getPassData<RAData>()->liveness, bLen)) {
-        node = from;
-        goto Patch;
-      }
+    default:
+      break;
+  }
+}
 
-      from = from->getJumpNext();
-    } while (from);
+Error RAPass::coalesce() {
+  uint32_t virtCount = static_cast<uint32_t>(_contextVd.getLength());
+  uint32_t bLen = (virtCount + RABits::kEntityBits - 1) / RABits::kEntityBits;
 
-    // Pop the current LivenessTarget from the stack.
-    {
-      LivenessTarget* ltTmp = ltCur;
-      ltCur = ltCur->prev;
-      ltTmp->prev = ltUnused;
-      ltUnused = ltTmp;
+  if (bLen == 0)
+    return kErrorOk;
+
+  size_t varMapToVaListOffset = _varMapToVaListOffset;
+
+  CBNode* node;
+  VirtReg* dst;
+  VirtReg* src;
+  uint32_t i, j;
+
+  // Nodes are indexed in their order. Nodes that don't lead to a return have
+  // no liveness, copies can only be checked if no such node uses a register.
+  ZoneVector<CBNode*> nodes;
+  uint32_t copyCount = 0;
+
+  for (node = getFunc(); node != _stop; node = node->getNext()) {
+    RAData* wd = node->getPassData<RAData>();
+    if (!wd) continue;
+
+    if (!wd->liveness) {
+      if (wd->tiedTotal) return kErrorOk;
+      continue;
     }
+
+    ASMJIT_PROPAGATE(nodes.append(&_heap, node));
+    copyCount += isCopy(node, &dst, &src);
   }
 
-  bCur->copyBits(node->getPassData<RAData>()->liveness, bLen);
-  node = node->getPrev();
-  if (node->isJmp() || !node->hasPassData()) goto Done;
+  if (copyCount == 0)
+    return kErrorOk;
+
+  // Range of node indexes where each register is alive, only nodes in this
+  // range have to be checked for interference and renamed.
+  uint32_t nodeCount = static_cast<uint32_t>(nodes.getLength());
+  uint32_t* rangeFirst = _zone->allocT<uint32_t>(virtCount * 2 * sizeof(uint32_t));
+  if (ASMJIT_UNLIKELY(!rangeFirst))
+    return DebugUtils::errored(kErrorNoHeapMemory);
+
+  uint32_t* rangeLast = rangeFirst + virtCount;
+  for (i = 0; i < virtCount; i++) {
+    rangeFirst[i] = kInvalidValue;
+    rangeLast[i] = 0;
+  }
 
-  wd = node->getPassData<RAData>();
-  if (!wd->liveness) goto Visit;
-  if (bCur->delBits(wd->liveness, bLen)) goto Patch;
+  for (j = 0; j < nodeCount; j++) {
+    const uintptr_t* data = nodes[j]->getPassData<RAData>()->liveness->data;
 
-Done:
-  if (ltCur) {
-    node = ltCur->node;
-    from = ltCur->from;
+    for (i = 0; i < bLen; i++) {
+      for (uint32_t shift = 0; shift < RABits::kEntityBits; shift += 32) {
+        uint32_t bits = static_cast<uint32_t>(data[i] >> shift);
+        uint32_t base = i * RABits::kEntityBits + shift;
 
-    goto JumpNext;
+        while (bits) {
+          uint32_t raId = base + Utils::findFirstBit(bits);
+          bits &= bits - 1;
+
+          if (rangeFirst[raId] == kInvalidValue)
+            rangeFirst[raId] = j;
+          rangeLast[raId] = j;
+        }
+      }
+    }
   }
 
-  retPtr = retPtr->getNext();
-  if (retPtr) {
-    node = retPtr->getValue();
-    goto Visit;
+  uint32_t removed = 0;
+  for (uint32_t c = 0; c < nodeCount; c++) {
+    if (!isCopy(nodes[c], &dst, &src) || dst == src)
+      continue;
+
+    uint32_t dstId = dst->_raId;
+    uint32_t srcId = src->_raId;
+
+    uint32_t first = std::max(rangeFirst[dstId], rangeFirst[srcId]);
+    uint32_t last = std::min(rangeLast[dstId], rangeLast[srcId]);
+
+    bool interfere = false;
+    for (j = first; j <= last && first != kInvalidValue; j++) {
+      RABits* liveness = nodes[j]->getPassData<RAData>()->liveness;
+      if (!liveness->getBit(dstId) || !liveness->getBit(srcId))
+        continue;
+
+      VirtReg* a;
+      VirtReg* b;
+      if (isCopy(nodes[j], &a, &b) && ((a == dst && b == src) || (a == src && b == dst)))
+        continue;
+
+      interfere = true;
+      break;
+    }
+
+    if (interfere)
+      continue;
+
+    // Rename `dst` to `src`, `dst` is not referenced by any node afterwards.
+    first = rangeFirst[dstId];
+    last = rangeLast[dstId];
+
+    for (j = first; j <= last && first != kInvalidValue; j++) {
+      node = nodes[j];
+
+      RAData* wd = node->getPassData<RAData>();
+      RABits* liveness = wd->liveness;
+
+      if (!liveness->getBit(dstId))
+        continue;
+
+      liveness->delBit(dstId);
+      liveness->setBit(srcId);
+
+      TiedReg* tiedArray = reinterpret_cast<TiedReg*>(((uint8_t*)wd) + varMapToVaListOffset);
+      for (i = 0; i < wd->tiedTotal; i++)
+        if (tiedArray[i].vreg == dst)
+          tiedArray[i].vreg = src;
+
+      RAPass_renameNode(node, dst, src);
+    }
+
+    rangeFirst[srcId] = std::min(rangeFirst[srcId], rangeFirst[dstId]);
+    rangeLast[srcId] = std::max(rangeLast[srcId], rangeLast[dstId]);
+    rangeFirst[dstId] = kInvalidValue;
+    rangeLast[dstId] = 0;
+
+    // The register has more writes now, it can't be rematerialized.
+    src->_isMaterialized = false;
+    src->_homeMask |= dst->_homeMask;
+    removed++;
+  }
+
+  // Remove copies that became moves to itself.
+  if (removed) {
+    for (j = 0; j < nodeCount; j++) {
+      node = nodes[j];
+      if (isCopy(node, &dst, &src) && dst == src) {
+        cc()->removeNode(node);
+        _stats.coalesceCount += _statsEnabled;
+      }
+    }
+  }
+
+  return kErrorOk;
+}
+
+// ============================================================================
+// [asmjit::RAPass - Report]
+// ============================================================================
+
+Error RAPass::reportPressure() {
+  VirtReg** virtArray = _contextVd.getData();
+  uint32_t virtCount = static_cast<uint32_t>(_contextVd.getLength());
+  uint32_t bLen = (virtCount + RABits::kEntityBits - 1) / RABits::kEntityBits;
+
+  uint32_t* maxLive = _report->maxLive;
+  uint32_t i;
+
+  for (CBNode* node = getFunc(); node != _stop; node = node->getNext()) {
+    RAData* wd = node->getPassData<RAData>();
+    if (!wd || !wd->liveness) continue;
+
+    uint32_t live[Globals::kMaxVRegKinds] = { 0 };
+    const uintptr_t* data = wd->liveness->data;
+
+    for (i = 0; i < bLen; i++) {
+      for (uint32_t shift = 0; shift < RABits::kEntityBits; shift += 32) {
+        uint32_t bits = static_cast<uint32_t>(data[i] >> shift);
+        uint32_t base = i * RABits::kEntityBits + shift;
+
+        while (bits) {
+          VirtReg* vreg = virtArray[base + Utils::findFirstBit(bits)];
+          bits &= bits - 1;
+
+          uint32_t kind = vreg->getKind();
+          if (kind < Globals::kMaxVRegKinds && !vreg->isStack())
+            live[kind]++;
+        }
+      }
+    }
+
+    for (uint32_t kind = 0; kind < Globals::kMaxVRegKinds; kind++)
+      maxLive[kind] = std::max<uint32_t>(maxLive[kind], live[kind]);
   }
 
   return kErrorOk;
+}
+
+Error RAPass::_addReportMove(uint32_t type, VirtReg* vreg) noexcept {
+  ASMJIT_ASSERT(type < CCFuncReport::kMoveCount);
+
+  CCFuncReport::Move move;
+  move.node = cc()->getCursor();
+  move.vregId = vreg->getId();
+  move.type = static_cast<uint8_t>(type);
+  move.atSwitch = _inSwitch;
+  move.reserved = 0;
 
-NoMem:
-  return DebugUtils::errored(kErrorNoHeapMemory);
+  _report->moveCount[type]++;
+  _report->switchMoveCount += _inSwitch;
+  return _report->moves.append(&cc()->_cbHeap, move);
 }
 
 // ============================================================================
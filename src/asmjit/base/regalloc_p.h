@@ -13,6 +13,8 @@
 
 // [Dependencies]
 #include "../base/codecompiler.h"
+#include "../base/flowgraph.h"
+#include "../base/osutils.h"
 #include "../base/zone.h"
 
 // [Api-Begin]
@@ -287,6 +289,18 @@ struct RACell {
   uint32_t alignment;                    //!< Cell alignment.
 };
 
+// ============================================================================
+// [asmjit::RALoop]
+// ============================================================================
+
+//! Loop of \ref RAPass::_cfg, which starts at a label (global allocation only).
+struct RALoop {
+  RALoop* next;                          //!< Next loop (in \ref RAPass::_loops).
+  CBBlock* block;                        //!< Loop header.
+  RABits* used;                          //!< Variables used by nodes of the loop.
+  uint32_t pressure[Globals::kMaxVRegKinds]; //!< Maximum count of live variables of each kind.
+};
+
 // ============================================================================
 // [asmjit::RAData]
 // ============================================================================
@@ -296,11 +310,15 @@ struct RAData {
   ASMJIT_INLINE RAData(uint32_t tiedTotal) noexcept
     : liveness(nullptr),
       state(nullptr),
-      tiedTotal(tiedTotal) {}
+      loop(nullptr),
+      tiedTotal(tiedTotal),
+      blockId(0) {}
 
   RABits* liveness;                      //!< Liveness bits (populated by liveness-analysis).
   RAState* state;                        //!< Optional saved \ref RAState.
+  RALoop* loop;                          //!< Loop starting at this node (global allocation only).
   uint32_t tiedTotal;                    //!< Total count of \ref TiedReg regs.
+  uint32_t blockId;                      //!< Basic block index (used by liveness-analysis).
 };
 
 // ============================================================================
@@ -323,6 +341,18 @@ public:
 
   typedef void (ASMJIT_CDECL* TraceNodeFunc)(RAPass* self, CBNode* node_, const char* prefix);
 
+  //! Phases reported in \ref CBPassStats::phaseTime.
+  ASMJIT_ENUM(Phase) {
+    kPhaseFetch       = 0,               //!< `prepare()` and `fetch()`.
+    kPhaseUnreachable = 1,               //!< `removeUnreachableCode()`.
+    kPhaseLiveness    = 2,               //!< `livenessAnalysis()`.
+    kPhaseCoalesce    = 3,               //!< `coalesce()`.
+    kPhaseLiveRanges  = 4,               //!< `buildLiveRanges()` and `buildLoops()` (linear-scan only).
+    kPhaseAnnotate    = 5,               //!< `annotate()` (logging only).
+    kPhaseTranslate   = 6,               //!< `translate()` and `cleanup()`.
+    kPhaseCount       = 7                //!< Count of phases.
+  };
+
   // --------------------------------------------------------------------------
   // [Construction / Destruction]
   // --------------------------------------------------------------------------
@@ -348,6 +378,20 @@ public:
   //! succeeded or failed.
   virtual void cleanup() noexcept;
 
+  // --------------------------------------------------------------------------
+  // [Statistics]
+  // --------------------------------------------------------------------------
+
+  //! Add time elapsed since `time` to `phase` and update `time` to now (only
+  //! if the statistics are enabled).
+  ASMJIT_INLINE void statsPhase(uint32_t phase, uint64_t& time) noexcept {
+    if (!_statsEnabled) return;
+
+    uint64_t now = OSUtils::getHighResTime();
+    _stats.phaseTime[phase] += now - time;
+    time = now;
+  }
+
   // --------------------------------------------------------------------------
   // [Accessors]
   // --------------------------------------------------------------------------
@@ -486,21 +530,89 @@ public:
 
   //! Perform variable liveness analysis.
   //!
-  //! Analysis phase iterates over nodes in reverse order and generates a bit
-  //! array describing variables that are alive at every node in the function.
-  //! When the analysis start all variables are assumed dead. When a read or
-  //! read/write operations of a variable is detected the variable becomes
-  //! alive; when only write operation is detected the variable becomes dead.
+  //! Analysis phase generates a bit array describing variables that are alive
+  //! at every node in the function. When the analysis start all variables are
+  //! assumed dead. When a read or read/write operations of a variable is
+  //! detected the variable becomes alive; when only write operation is detected
+  //! the variable becomes dead.
   //!
-  //! When a label is found all jumps to that label are followed and analysis
-  //! repeats until all variables are resolved.
+  //! Nodes are split into basic blocks first, then live-in and live-out sets
+  //! of all blocks are solved by a worklist that runs in reverse post-order,
+  //! and finally each block is walked once to generate liveness of its nodes.
+  //!
+  //! The last walk also removes dead code - nodes accepted by `canRemoveDead()`
+  //! that write at least one register or flag, but none of them is read later.
+  //! Registers read by a removed node are not made alive by it, so chains of
+  //! dead nodes within a block are removed at once. Flags are tracked within
+  //! the block only and considered alive at its end.
   virtual Error livenessAnalysis();
 
+  //! Get whether `node` has no effect other than writing virtual registers
+  //! it uses and flags, so it can be removed if all of them are dead. Flags
+  //! read by `node` and flags it always overwrites are stored to `flagsR` and
+  //! `flagsW`, all bits set in `flagsR` means the node can read any flag.
+  virtual bool canRemoveDead(CBNode* node, uint32_t* flagsR, uint32_t* flagsW) = 0;
+
+  //! Compute the end of the live range of each variable (linear-scan only).
+  //!
+  //! The end is the highest position of a node where the variable is alive,
+  //! positions are assigned by `fetch()` in flow order, so variables alive
+  //! across a loop span the whole loop.
+  virtual Error buildLiveRanges();
+
+  //! Find loops and compute spill weights of variables (global only).
+  //!
+  //! Loops are natural loops of \ref CBFlowGraph built from the function. The
+  //! frequency of a node is estimated as `8^depth`, where `depth` is the
+  //! count of loops that contain it, and the spill weight of a variable is
+  //! the sum of frequencies of all nodes that use it. Each loop also gets
+  //! variables it uses and its register pressure, so the backend can spill
+  //! variables that are only alive across the loop in its pre-header.
+  virtual Error buildLoops();
+
+  // --------------------------------------------------------------------------
+  // [Coalesce]
+  // --------------------------------------------------------------------------
+
+  //! Get whether `node` copies a virtual register to another one of the same
+  //! type, and store the destination and source to `pDst` and `pSrc`.
+  virtual bool isCopy(CBNode* node, VirtReg** pDst, VirtReg** pSrc) = 0;
+
+  //! Merge virtual registers connected by a copy if they don't interfere.
+  //!
+  //! Two registers interfere if both are alive at a node, which is not a copy
+  //! between them. The destination of each copy that doesn't interfere with
+  //! its source is renamed to the source in all nodes, operands, and liveness
+  //! bits, and the copy, which became a move to itself, is removed. Nothing
+  //! is coalesced if the liveness is not known at every node.
+  virtual Error coalesce();
+
+  // --------------------------------------------------------------------------
+  // [Report]
+  // --------------------------------------------------------------------------
+
+  //! Compute \ref CCFuncReport::maxLive of the report being collected from
+  //! liveness of all nodes, called after `coalesce()`.
+  virtual Error reportPressure();
+
+  //! Add a move of `vreg` of `type` (see \ref CCFuncReport::MoveType) to the
+  //! report being collected (if any). The move must be the compiler cursor.
+  ASMJIT_INLINE Error addReportMove(uint32_t type, VirtReg* vreg) noexcept {
+    if (!_report) return kErrorOk;
+    return _addReportMove(type, vreg);
+  }
+
+  Error _addReportMove(uint32_t type, VirtReg* vreg) noexcept;
+
   // --------------------------------------------------------------------------
   // [Annotate]
   // --------------------------------------------------------------------------
 
   virtual Error annotate() = 0;
+
+  //! Format the inline comment of `node` into `dst`, extended by liveness of
+  //! all variables. The backend formats the report of a function node (see
+  //! \ref CCFunc::getReport()), which is its comment after `translate()`.
   virtual Error formatInlineComment(StringBuilder& dst, CBNode* node);
 
   // --------------------------------------------------------------------------
@@ -516,6 +628,7 @@ public:
 
   Zone* _zone;                           //!< Zone passed to `process()`.
   ZoneHeap _heap;                        //!< ZoneHeap that uses `_zone`.
+  ZoneHeap::SlotTable _heapSlots;        //!< Slot sizes used by `_heap`.
 
   CCFunc* _func;                         //!< Function being processed.
   CBNode* _stop;                         //!< Stop node.
@@ -529,10 +642,17 @@ public:
   uint32_t _varMapToVaListOffset;
 
   uint8_t _emitComments;                 //!< Whether to emit comments.
+  uint8_t _linearScan;                   //!< Whether to use linear-scan heuristics, see \ref RAStrategy.
+  uint8_t _globalAlloc;                  //!< Whether to use global allocation, see \ref RAStrategy.
+  uint8_t _statsEnabled;                 //!< Whether to collect statistics, see \ref CBPassStats.
+  uint8_t _inSwitch;                     //!< Whether moves are inserted by a state switch.
+  CCFuncReport* _report;                 //!< Report being collected or null, see \ref CCFuncReport.
 
   ZoneList<CBNode*> _unreachableList;     //!< Unreachable nodes.
   ZoneList<CBNode*> _returningList;       //!< Returning nodes.
   ZoneList<CBNode*> _jccList;             //!< Jump nodes.
+  CBFlowGraph _cfg;                      //!< Control flow graph (global allocation only).
+  RALoop* _loops;                        //!< Loops (global allocation only).
 
   ZoneVector<VirtReg*> _contextVd;       //!< All variables used by the current function.
   RACell* _memVarCells;                  //!< Memory used to spill variables.
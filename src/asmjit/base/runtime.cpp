@@ -10,6 +10,8 @@
 // [Dependencies]
 #include "../base/assembler.h"
 #include "../base/cpuinfo.h"
+#include "../base/jittest_p.h"
+#include "../base/jitunwind.h"
 #include "../base/runtime.h"
 
 // [Api-Begin]
@@ -18,12 +20,22 @@
 namespace asmjit {
 
 static ASMJIT_INLINE void hostFlushInstructionCache(const void* p, size_t size) noexcept {
-  // Only useful on non-x86 architectures.
+  // Only useful on non-x86 architectures, x86 keeps instruction cache coherent.
 #if !ASMJIT_ARCH_X86 && !ASMJIT_ARCH_X64
 # if ASMJIT_OS_WINDOWS
   // Windows has a built-in support in kernel32.dll.
-  ::FlushInstructionCache(_memMgr.getProcessHandle(), p, size);
-# endif // ASMJIT_OS_WINDOWS
+  ::FlushInstructionCache(::GetCurrentProcess(), p, size);
+# elif ASMJIT_CC_GCC || ASMJIT_CC_CLANG
+  // Cleans data cache to the point of unification and invalidates instruction
+  // cache of the range (DC CVAU + IC IVAU + DSB/ISB on AArch64). `p` must be
+  // the executable address, writing through a dual-mapped RW view is fine as
+  // both views share the same physical lines.
+  char* start = static_cast<char*>(const_cast<void*>(p));
+  __builtin___clear_cache(start, start + size);
+# else
+  ASMJIT_UNUSED(p);
+  ASMJIT_UNUSED(size);
+# endif
 #else
   ASMJIT_UNUSED(p);
   ASMJIT_UNUSED(size);
@@ -96,51 +108,1431 @@ void HostRuntime::flush(const void* p, size_t size) noexcept {
   hostFlushInstructionCache(p, size);
 }
 
+// ============================================================================
+// [asmjit::JitListener - Construction / Destruction]
+// ============================================================================
+
+JitListener::JitListener() noexcept {}
+JitListener::~JitListener() noexcept {}
+
 // ============================================================================
 // [asmjit::JitRuntime - Construction / Destruction]
 // ============================================================================
 
-JitRuntime::JitRuntime() noexcept {}
-JitRuntime::~JitRuntime() noexcept {}
+static void JitRuntime_notifyRelease(JitRuntime* self, void* p) noexcept;
+
+JitRuntime::JitRuntime() noexcept
+  : _listener(nullptr),
+    _threads(nullptr),
+    _deferred(nullptr),
+    _deferredCount(0),
+    _epoch(1),
+    _queueHead(nullptr),
+    _queueSeq(0),
+    _workers(nullptr),
+    _workerCount(0),
+    _stopping(false),
+    _unwindZone(4096 - Zone::kZoneOverhead),
+    _unwindHeap(&_unwindZone),
+    _unwindTables(&_unwindHeap),
+    _batches(&_unwindHeap) { _stats.reset(); }
+JitRuntime::~JitRuntime() noexcept {
+  stopWorkers();
+
+  // No thread can execute the code anymore, free all deferred releases.
+  Deferred* d = _deferred;
+  while (d) {
+    Deferred* next = d->next;
+    if (d->notify)
+      JitRuntime_notifyRelease(this, d->p);
+    _memMgr.release(d->p);
+    Internal::releaseMemory(d);
+    d = next;
+  }
+
+  // Unregister tables of functions that were not released (including the
+  // deferred ones above), the memory is released by `VMemMgr`.
+  for (uint32_t i = 0; i < _unwindTables._capacity; i++) {
+    UnwindEntry* entry = static_cast<UnwindEntry*>(_unwindTables._data[i].node);
+    if (entry)
+      JitUnwind::removeTable(entry->table);
+  }
+}
+
+// ============================================================================
+// [asmjit::JitRuntime - Statistics]
+// ============================================================================
+
+static ASMJIT_INLINE void JitRuntime_addStats(JitRuntime* self, const CodeHolder* code) noexcept {
+  if (!code->isStatsEnabled())
+    return;
+
+  AutoLock locked(self->_statsLock);
+  self->_stats.add(code->getStats());
+  self->_stats.moduleCount++;
+}
+
+CodeStats JitRuntime::getStats() const noexcept {
+  AutoLock locked(_statsLock);
+  return _stats;
+}
+
+void JitRuntime::resetStats() noexcept {
+  AutoLock locked(_statsLock);
+  _stats.reset();
+}
+
+// ============================================================================
+// [asmjit::JitRuntime - Unwind]
+// ============================================================================
+
+//! \internal
+//!
+//! Key used to find an unwind table or a batch of an allocation.
+struct JitRuntimeUnwindKey {
+  ASMJIT_INLINE JitRuntimeUnwindKey(const void* p) noexcept
+    : p(p),
+      hVal(static_cast<uint32_t>((uintptr_t)p >> 4)) {}
+
+  ASMJIT_INLINE bool matches(const JitRuntime::UnwindEntry* entry) const noexcept { return entry->p == p; }
+  ASMJIT_INLINE bool matches(const JitRuntime::BatchEntry* entry) const noexcept { return entry->p == p; }
+
+  const void* p;
+  uint32_t hVal;
+};
+
+//! \internal
+//!
+//! Build and register the unwind table of `count` functions relocated at
+//! `addresses` within an allocation that starts at `p` (and `rw`), the table
+//! is stored at `tableOffset`.
+static Error JitRuntime_addUnwind(JitRuntime* self, void* p, void* rw, size_t tableOffset, size_t tableSize, void* const* addresses, CodeHolder* const* codes, size_t count) noexcept {
+  void* tableRx = static_cast<uint8_t*>(p) + tableOffset;
+  void* tableRw = static_cast<uint8_t*>(rw) + tableOffset;
+
+  AutoLock locked(self->_unwindLock);
+  JitRuntime::UnwindEntry* entry = self->_unwindHeap.allocT<JitRuntime::UnwindEntry>();
+  if (ASMJIT_UNLIKELY(!entry))
+    return DebugUtils::errored(kErrorNoHeapMemory);
+
+  Error err = JitUnwind::addTable(tableRx, tableRw, tableSize, p, addresses, codes, count);
+  if (ASMJIT_UNLIKELY(err)) {
+    self->_unwindHeap.release(entry, sizeof(JitRuntime::UnwindEntry));
+    return err;
+  }
+
+  entry->_hashNext = nullptr;
+  entry->_hVal = JitRuntimeUnwindKey(p).hVal;
+  entry->_customData = 0;
+  entry->p = p;
+  entry->table = tableRx;
+
+  if (ASMJIT_UNLIKELY(!self->_unwindTables.put(entry))) {
+    JitUnwind::removeTable(tableRx);
+    self->_unwindHeap.release(entry, sizeof(JitRuntime::UnwindEntry));
+    return DebugUtils::errored(kErrorNoHeapMemory);
+  }
+
+  return kErrorOk;
+}
+
+//! \internal
+//!
+//! Unregister the unwind table of `p`, if any, before `p` is released.
+static void JitRuntime_removeUnwind(JitRuntime* self, void* p) noexcept {
+  AutoLock locked(self->_unwindLock);
+  if (!self->_unwindTables.getSize())
+    return;
+
+  JitRuntime::UnwindEntry* entry = self->_unwindTables.get(JitRuntimeUnwindKey(p));
+  if (!entry)
+    return;
+
+  self->_unwindTables.del(entry);
+  JitUnwind::removeTable(entry->table);
+  self->_unwindHeap.release(entry, sizeof(JitRuntime::UnwindEntry));
+}
+
+// ============================================================================
+// [asmjit::JitRuntime - Listener]
+// ============================================================================
+
+static ASMJIT_INLINE size_t JitRuntime_getBatchEntrySize(size_t count) noexcept {
+  return sizeof(JitRuntime::BatchEntry) + (count - 1) * sizeof(void*);
+}
+
+//! \internal
+//!
+//! Remember addresses of `count` functions of a batch that starts at `p`.
+static Error JitRuntime_addBatchEntry(JitRuntime* self, void* p, void* const* addresses, size_t count) noexcept {
+  AutoLock locked(self->_unwindLock);
+  JitRuntime::BatchEntry* entry = static_cast<JitRuntime::BatchEntry*>(
+    self->_unwindHeap.alloc(JitRuntime_getBatchEntrySize(count)));
+
+  if (ASMJIT_UNLIKELY(!entry))
+    return DebugUtils::errored(kErrorNoHeapMemory);
+
+  entry->_hashNext = nullptr;
+  entry->_hVal = JitRuntimeUnwindKey(p).hVal;
+  entry->_customData = 0;
+  entry->p = p;
+  entry->count = count;
+  ::memcpy(entry->addresses, addresses, count * sizeof(void*));
+
+  if (ASMJIT_UNLIKELY(!self->_batches.put(entry))) {
+    self->_unwindHeap.release(entry, JitRuntime_getBatchEntrySize(count));
+    return DebugUtils::errored(kErrorNoHeapMemory);
+  }
+
+  return kErrorOk;
+}
+
+//! \internal
+//!
+//! Notify the listener about the release of an allocation at `p`, which is
+//! done for each of its functions if `p` is a batch added by `addBatch()`.
+static void JitRuntime_notifyRelease(JitRuntime* self, void* p) noexcept {
+  JitRuntime::BatchEntry* entry = nullptr;
+  {
+    AutoLock locked(self->_unwindLock);
+    if (self->_batches.getSize()) {
+      entry = self->_batches.get(JitRuntimeUnwindKey(p));
+      if (entry)
+        self->_batches.del(entry);
+    }
+  }
+
+  JitListener* listener = self->getListener();
+  if (!entry) {
+    if (listener)
+      listener->onRelease(p);
+    return;
+  }
+
+  if (listener) {
+    for (size_t i = 0; i < entry->count; i++)
+      listener->onRelease(entry->addresses[i]);
+  }
+
+  AutoLock locked(self->_unwindLock);
+  self->_unwindHeap.release(entry, JitRuntime_getBatchEntrySize(entry->count));
+}
+
+size_t JitRuntime::getUnwindTableCount() const noexcept {
+  AutoLock locked(_unwindLock);
+  return _unwindTables.getSize();
+}
 
 // ============================================================================
 // [asmjit::JitRuntime - Interface]
 // ============================================================================
 
 Error JitRuntime::_add(void** dst, CodeHolder* code) noexcept {
-  size_t codeSize = code->getCodeSize();
+  // Don't reserve trampolines that are never used within the address range
+  // of `VMemMgr`, so the memory doesn't have to be shrunk after relocation.
+  size_t codeSize = code->getRelocatedSize(_memMgr.getRangeLo(), _memMgr.getRangeHi());
   if (ASMJIT_UNLIKELY(codeSize == 0)) {
     *dst = nullptr;
     return DebugUtils::errored(kErrorNoCodeGenerated);
   }
 
-  void* p = _memMgr.alloc(codeSize, getAllocType());
-  if (ASMJIT_UNLIKELY(!p)) {
+  // The unwind table (if any) follows the code.
+  size_t tableSize = JitUnwind::getTableSize(&code, 1);
+  size_t allocSize = codeSize;
+  if (tableSize)
+    allocSize = Utils::alignTo<size_t>(codeSize, JitUnwind::kTableAlignment) + tableSize;
+
+  void* p;
+  void* rw;
+
+  if (ASMJIT_UNLIKELY(_memMgr.allocDual(&p, &rw, allocSize, getAllocType()) != kErrorOk)) {
     *dst = nullptr;
     return DebugUtils::errored(kErrorNoVirtualMemory);
   }
 
-  // Relocate the code and release the unused memory back to `VMemMgr`.
-  size_t relocSize = code->relocate(p);
+  // Relocate the code through its writable view (the same as `p` if the
+  // `VMemMgr` doesn't use dual mapping) and release the unused memory back
+  // to `VMemMgr`.
+  size_t relocSize = code->relocate(rw, static_cast<uint64_t>((uintptr_t)p));
   if (ASMJIT_UNLIKELY(relocSize == 0)) {
     *dst = nullptr;
     _memMgr.release(p);
     return DebugUtils::errored(kErrorInvalidState);
   }
 
-  if (relocSize < codeSize)
-    _memMgr.shrink(p, relocSize);
+  size_t usedSize = relocSize;
+  if (tableSize) {
+    size_t tableOffset = Utils::alignTo<size_t>(relocSize, JitUnwind::kTableAlignment);
+    Error err = JitRuntime_addUnwind(this, p, rw, tableOffset, tableSize, &p, &code, 1);
 
-  flush(p, relocSize);
+    if (ASMJIT_UNLIKELY(err)) {
+      *dst = nullptr;
+      _memMgr.release(p);
+      return err;
+    }
+    usedSize = tableOffset + tableSize;
+  }
+
+  if (usedSize < allocSize)
+    _memMgr.shrink(p, usedSize);
+
+  flush(p, usedSize);
   *dst = p;
+  JitRuntime_addStats(this, code);
 
+  if (_listener)
+    _listener->onAdd(p, relocSize, code);
   return kErrorOk;
 }
 
 Error JitRuntime::_release(void* p) noexcept {
+  if (p)
+    JitRuntime_notifyRelease(this, p);
+
+  JitRuntime_removeUnwind(this, p);
   return _memMgr.release(p);
 }
 
+// ============================================================================
+// [asmjit::JitRuntime - Batch]
+// ============================================================================
+
+//! \internal
+//!
+//! Alignment of each function within a batch.
+static const size_t kJitRuntimeBatchAlignment = 32;
+
+Error JitRuntime::addBatch(void** dst, CodeHolder* const* codes, size_t count) noexcept {
+  size_t i;
+  for (i = 0; i < count; i++)
+    dst[i] = nullptr;
+
+  if (ASMJIT_UNLIKELY(count == 0))
+    return DebugUtils::errored(kErrorInvalidArgument);
+
+  // Compute the maximum size of the batch, including trampolines that may be
+  // used within the address range of `VMemMgr`, and the unwind table of all
+  // functions, which follows the last one.
+  size_t totalSize = 0;
+  size_t tableSize = JitUnwind::getTableSize(codes, count);
+
+  for (i = 0; i < count; i++) {
+    size_t codeSize = codes[i]->getRelocatedSize(_memMgr.getRangeLo(), _memMgr.getRangeHi());
+    if (ASMJIT_UNLIKELY(codeSize == 0))
+      return DebugUtils::errored(kErrorNoCodeGenerated);
+
+    size_t alignedSize = Utils::alignTo<size_t>(codeSize, kJitRuntimeBatchAlignment);
+    if (ASMJIT_UNLIKELY(alignedSize < codeSize || totalSize + alignedSize < totalSize))
+      return DebugUtils::errored(kErrorCodeTooLarge);
+    totalSize += alignedSize;
+  }
+
+  if (ASMJIT_UNLIKELY(totalSize + tableSize < totalSize))
+    return DebugUtils::errored(kErrorCodeTooLarge);
+  totalSize += tableSize;
+
+  void* p;
+  void* rw;
+
+  if (ASMJIT_UNLIKELY(_memMgr.allocDual(&p, &rw, totalSize, getAllocType()) != kErrorOk))
+    return DebugUtils::errored(kErrorNoVirtualMemory);
+
+  // Relocate all functions, each one starts right after the previous one.
+  size_t offset = 0;
+  for (i = 0; i < count; i++) {
+    uint8_t* fnRx = static_cast<uint8_t*>(p) + offset;
+    uint8_t* fnRw = static_cast<uint8_t*>(rw) + offset;
+
+    size_t relocSize = codes[i]->relocate(fnRw, static_cast<uint64_t>((uintptr_t)fnRx));
+    if (ASMJIT_UNLIKELY(relocSize == 0)) {
+      _memMgr.release(p);
+      for (size_t j = 0; j < i; j++)
+        dst[j] = nullptr;
+      return DebugUtils::errored(kErrorInvalidState);
+    }
+
+    dst[i] = fnRx;
+    offset += Utils::alignTo<size_t>(relocSize, kJitRuntimeBatchAlignment);
+  }
+
+  // A single table describes all functions of the batch.
+  size_t usedSize = offset;
+  if (tableSize) {
+    Error err = JitRuntime_addUnwind(this, p, rw, offset, tableSize, dst, codes, count);
+    if (ASMJIT_UNLIKELY(err)) {
+      _memMgr.release(p);
+      for (i = 0; i < count; i++)
+        dst[i] = nullptr;
+      return err;
+    }
+    usedSize += tableSize;
+  }
+
+  if (usedSize < totalSize)
+    _memMgr.shrink(p, usedSize);
+
+  flush(p, usedSize);
+
+  // Only `dst[0]` is released, remember the others to notify the listener.
+  if (_listener) {
+    Error err = JitRuntime_addBatchEntry(this, p, dst, count);
+    if (ASMJIT_UNLIKELY(err)) {
+      JitRuntime_removeUnwind(this, p);
+      _memMgr.release(p);
+      for (i = 0; i < count; i++)
+        dst[i] = nullptr;
+      return err;
+    }
+  }
+
+  for (i = 0; i < count; i++)
+    JitRuntime_addStats(this, codes[i]);
+
+  if (_listener) {
+    for (i = 0; i < count; i++) {
+      size_t fnSize = (i + 1 < count ? static_cast<uint8_t*>(dst[i + 1]) : static_cast<uint8_t*>(p) + offset) - static_cast<uint8_t*>(dst[i]);
+      _listener->onAdd(dst[i], fnSize, codes[i]);
+    }
+  }
+  return kErrorOk;
+}
+
+// ============================================================================
+// [asmjit::JitRuntime - In-Place]
+// ============================================================================
+
+Error JitRuntime::allocInPlace(CodeHolder* code, size_t size) noexcept {
+  if (ASMJIT_UNLIKELY(!code->isInitialized() || code->getSections().isEmpty()))
+    return DebugUtils::errored(kErrorNotInitialized);
+
+  if (ASMJIT_UNLIKELY(size == 0))
+    return DebugUtils::errored(kErrorInvalidArgument);
+
+  code->sync();
+  CodeBuffer* cb = &code->getSectionEntry(0)->_buffer;
+  if (ASMJIT_UNLIKELY(code->hasBaseAddress() || cb->getLength() != 0))
+    return DebugUtils::errored(kErrorInvalidState);
+
+  void* p;
+  void* rw;
+
+  if (ASMJIT_UNLIKELY(_memMgr.allocDual(&p, &rw, size, getAllocType()) != kErrorOk))
+    return DebugUtils::errored(kErrorNoVirtualMemory);
+
+  Error err = code->setExternalBuffer(cb, rw, size, true);
+  if (ASMJIT_UNLIKELY(err)) {
+    _memMgr.release(p);
+    return err;
+  }
+
+  code->_codeInfo.setBaseAddress(static_cast<uint64_t>((uintptr_t)p));
+  return kErrorOk;
+}
+
+Error JitRuntime::_addInPlace(void** dst, CodeHolder* code) noexcept {
+  *dst = nullptr;
+
+  if (ASMJIT_UNLIKELY(!code->hasBaseAddress() || code->getSections().isEmpty()))
+    return DebugUtils::errored(kErrorInvalidState);
+
+  SectionEntry* text = code->getSectionEntry(0);
+  CodeBuffer& cb = text->_buffer;
+
+  if (ASMJIT_UNLIKELY(!cb.isExternal() || !cb.isFixedSize()))
+    return DebugUtils::errored(kErrorInvalidState);
+
+  void* p = reinterpret_cast<void*>(static_cast<uintptr_t>(code->getBaseAddress()));
+  uint8_t* rw = cb._data;
+  size_t capacity = cb._capacity;
+
+  // Other sections and trampolines follow `.text`, which must stay at offset
+  // zero so it doesn't have to be moved.
+  uint64_t base = static_cast<uint64_t>((uintptr_t)p);
+  size_t codeSize = code->getRelocatedSize(base, base + capacity);
+
+  Error err = kErrorOk;
+  size_t relocSize = 0;
+
+  if (ASMJIT_UNLIKELY(codeSize == 0))
+    err = kErrorNoCodeGenerated;
+  else if (ASMJIT_UNLIKELY(codeSize > capacity))
+    err = kErrorCodeTooLarge;
+  else if (ASMJIT_UNLIKELY(text->getOffset() != 0))
+    err = kErrorInvalidState;
+  else if (ASMJIT_UNLIKELY((relocSize = code->relocate(rw, base)) == 0))
+    err = kErrorInvalidState;
+
+  if (ASMJIT_UNLIKELY(err)) {
+    _memMgr.release(p);
+    return DebugUtils::errored(err);
+  }
+
+  if (relocSize < capacity)
+    _memMgr.shrink(p, relocSize);
+
+  flush(p, relocSize);
+  *dst = p;
+  JitRuntime_addStats(this, code);
+
+  if (_listener)
+    _listener->onAdd(p, relocSize, code);
+  return kErrorOk;
+}
+
+// ============================================================================
+// [asmjit::JitRuntime - Deferred Release]
+// ============================================================================
+
+void JitRuntime::registerThread(JitThread* thread) noexcept {
+  AutoLock locked(_deferredLock);
+
+  OSUtils::atomicStore(&thread->epoch, _epoch);
+  thread->next = _threads;
+  _threads = thread;
+}
+
+void JitRuntime::unregisterThread(JitThread* thread) noexcept {
+  AutoLock locked(_deferredLock);
+
+  JitThread** pPrev = &_threads;
+  while (*pPrev && *pPrev != thread)
+    pPrev = &(*pPrev)->next;
+
+  if (*pPrev) {
+    *pPrev = thread->next;
+    thread->next = nullptr;
+  }
+}
+
+Error JitRuntime::_releaseDeferred(void* p, bool notify) noexcept {
+  if (!p) return kErrorOk;
+
+  Deferred* d = static_cast<Deferred*>(Internal::allocMemory(sizeof(Deferred)));
+  if (ASMJIT_UNLIKELY(!d))
+    return DebugUtils::errored(kErrorNoHeapMemory);
+
+  size_t count;
+  {
+    AutoLock locked(_deferredLock);
+
+    d->p = p;
+    d->epoch = _epoch;
+    d->notify = notify;
+    d->next = _deferred;
+    _deferred = d;
+    count = ++_deferredCount;
+
+    // A thread that reports a quiescent state from now on can't execute `p`.
+    OSUtils::atomicStore(&_epoch, _epoch + 1);
+  }
+
+  if (count >= kDeferredReclaimThreshold)
+    reclaim();
+  return kErrorOk;
+}
+
+size_t JitRuntime::reclaim() noexcept {
+  Deferred* released = nullptr;
+  size_t count = 0;
+
+  {
+    AutoLock locked(_deferredLock);
+
+    // The oldest epoch observed by registered threads, wrap-around safe.
+    uint32_t minEpoch = _epoch;
+    for (JitThread* thread = _threads; thread; thread = thread->next) {
+      uint32_t epoch = OSUtils::atomicLoad(&thread->epoch);
+      if (static_cast<int32_t>(epoch - minEpoch) < 0)
+        minEpoch = epoch;
+    }
+
+    Deferred** pPrev = &_deferred;
+    while (*pPrev) {
+      Deferred* d = *pPrev;
+      if (static_cast<int32_t>(minEpoch - d->epoch) > 0) {
+        *pPrev = d->next;
+        d->next = released;
+        released = d;
+        count++;
+      }
+      else {
+        pPrev = &d->next;
+      }
+    }
+    _deferredCount -= count;
+  }
+
+  // Free in chunks, each under a single lock of `VMemMgr`.
+  enum { kChunkSize = 64 };
+  void* chunk[kChunkSize];
+
+  while (released) {
+    size_t n = 0;
+    do {
+      Deferred* next = released->next;
+      if (released->notify) {
+        JitRuntime_notifyRelease(this, released->p);
+        JitRuntime_removeUnwind(this, released->p);
+      }
+
+      chunk[n++] = released->p;
+      Internal::releaseMemory(released);
+      released = next;
+    } while (released && n < kChunkSize);
+
+    _memMgr.releaseMany(chunk, n);
+  }
+
+  return count;
+}
+
+size_t JitRuntime::getDeferredCount() const noexcept {
+  AutoLock locked(_deferredLock);
+  return _deferredCount;
+}
+
+// ============================================================================
+// [asmjit::JitRuntime - Background Compilation]
+// ============================================================================
+
+static void ASMJIT_CDECL JitRuntime_worker(void* data) noexcept {
+  JitRuntime* self = static_cast<JitRuntime*>(data);
+
+  for (;;) {
+    JitTask* task;
+    {
+      AutoLock locked(self->_queueLock);
+      while (!self->_queueHead && !self->_stopping)
+        self->_queueCond.wait(self->_queueLock);
+
+      if (self->_stopping)
+        return;
+
+      task = self->_queueHead;
+      self->_queueHead = task->_next;
+      task->_next = nullptr;
+      OSUtils::atomicStore(&task->_status, JitTask::kStatusRunning);
+    }
+
+    void* func = nullptr;
+    Error err;
+    {
+      CodeHolder code;
+      err = code.init(self->getCodeInfo());
+      if (!err) err = task->_generate(&code, task->_data);
+      if (!err) err = self->_add(&func, &code);
+    }
+
+    AutoLock locked(self->_queueLock);
+    task->_func = func;
+    task->_error = err;
+    OSUtils::atomicStore(&task->_status, err ? JitTask::kStatusFailed : JitTask::kStatusDone);
+    self->_doneCond.broadcast();
+  }
+}
+
+Error JitRuntime::startWorkers(uint32_t count) noexcept {
+  if (ASMJIT_UNLIKELY(!count))
+    return DebugUtils::errored(kErrorInvalidArgument);
+
+  if (ASMJIT_UNLIKELY(_workers))
+    return DebugUtils::errored(kErrorInvalidState);
+
+  Thread* workers = static_cast<Thread*>(Internal::allocMemory(count * sizeof(Thread)));
+  if (ASMJIT_UNLIKELY(!workers))
+    return DebugUtils::errored(kErrorNoHeapMemory);
+
+  _stopping = false;
+  _workers = workers;
+
+  Error err = kErrorOk;
+  for (uint32_t i = 0; i < count; i++) {
+    new(&workers[i]) Thread();
+    err = workers[i].start(JitRuntime_worker, this);
+
+    if (ASMJIT_UNLIKELY(err)) {
+      workers[i].~Thread();
+      break;
+    }
+    _workerCount++;
+  }
+
+  if (ASMJIT_UNLIKELY(err))
+    stopWorkers();
+  return err;
+}
+
+void JitRuntime::stopWorkers() noexcept {
+  if (!_workers)
+    return;
+
+  {
+    AutoLock locked(_queueLock);
+    _stopping = true;
+
+    JitTask* task = _queueHead;
+    while (task) {
+      JitTask* next = task->_next;
+      task->_next = nullptr;
+      OSUtils::atomicStore(&task->_status, JitTask::kStatusCancelled);
+      task = next;
+    }
+
+    _queueHead = nullptr;
+    _queueCond.broadcast();
+    _doneCond.broadcast();
+  }
+
+  for (uint32_t i = 0; i < _workerCount; i++) {
+    _workers[i].join();
+    _workers[i].~Thread();
+  }
+
+  Internal::releaseMemory(_workers);
+  _workers = nullptr;
+  _workerCount = 0;
+}
+
+Error JitRuntime::submit(JitTask* task) noexcept {
+  AutoLock locked(_queueLock);
+
+  if (ASMJIT_UNLIKELY(!_workerCount || _stopping))
+    return DebugUtils::errored(kErrorInvalidState);
+
+  uint32_t status = task->getStatus();
+  if (ASMJIT_UNLIKELY(status == JitTask::kStatusQueued || status == JitTask::kStatusRunning))
+    return DebugUtils::errored(kErrorInvalidState);
+
+  task->_func = nullptr;
+  task->_error = kErrorOk;
+  task->_seq = _queueSeq++;
+
+  // Keep the queue ordered by priority, tasks of the same priority are FIFO.
+  JitTask** pPrev = &_queueHead;
+  while (*pPrev && (*pPrev)->_priority >= task->_priority)
+    pPrev = &(*pPrev)->_next;
+
+  task->_next = *pPrev;
+  *pPrev = task;
+
+  OSUtils::atomicStore(&task->_status, JitTask::kStatusQueued);
+  _queueCond.signal();
+  return kErrorOk;
+}
+
+bool JitRuntime::cancel(JitTask* task) noexcept {
+  AutoLock locked(_queueLock);
+
+  if (task->getStatus() != JitTask::kStatusQueued)
+    return false;
+
+  JitTask** pPrev = &_queueHead;
+  while (*pPrev != task)
+    pPrev = &(*pPrev)->_next;
+
+  *pPrev = task->_next;
+  task->_next = nullptr;
+  OSUtils::atomicStore(&task->_status, JitTask::kStatusCancelled);
+  _doneCond.broadcast();
+  return true;
+}
+
+Error JitRuntime::wait(JitTask* task) noexcept {
+  AutoLock locked(_queueLock);
+
+  while (!task->isFinished()) {
+    if (task->getStatus() == JitTask::kStatusIdle)
+      return DebugUtils::errored(kErrorInvalidState);
+    _doneCond.wait(_queueLock);
+  }
+
+  return task->getError();
+}
+
+size_t JitRuntime::getQueuedCount() const noexcept {
+  AutoLock locked(_queueLock);
+
+  size_t count = 0;
+  for (JitTask* task = _queueHead; task; task = task->_next)
+    count++;
+  return count;
+}
+
+// ============================================================================
+// [asmjit::JitRuntime - Arena]
+// ============================================================================
+
+Error JitRuntime::_addToArena(void** dst, CodeHolder* code, VMemArena* arena) noexcept {
+  ASMJIT_ASSERT(arena->getMemMgr() == &_memMgr);
+
+  size_t codeSize = code->getRelocatedSize(_memMgr.getRangeLo(), _memMgr.getRangeHi());
+  if (ASMJIT_UNLIKELY(codeSize == 0)) {
+    *dst = nullptr;
+    return DebugUtils::errored(kErrorNoCodeGenerated);
+  }
+
+  void* p;
+  void* rw;
+
+  if (ASMJIT_UNLIKELY(arena->allocDual(&p, &rw, codeSize) != kErrorOk)) {
+    *dst = nullptr;
+    return DebugUtils::errored(kErrorNoVirtualMemory);
+  }
+
+  size_t relocSize = code->relocate(rw, static_cast<uint64_t>((uintptr_t)p));
+  if (ASMJIT_UNLIKELY(relocSize == 0)) {
+    *dst = nullptr;
+    arena->release(p);
+    return DebugUtils::errored(kErrorInvalidState);
+  }
+
+  if (relocSize < codeSize)
+    arena->shrink(p, relocSize);
+
+  flush(p, relocSize);
+  *dst = p;
+  JitRuntime_addStats(this, code);
+
+  if (_listener)
+    _listener->onAdd(p, relocSize, code);
+  return kErrorOk;
+}
+
+Error JitRuntime::_releaseFromArena(void* p, VMemArena* arena) noexcept {
+  if (_listener && p)
+    _listener->onRelease(p);
+  return arena->release(p);
+}
+
+// ============================================================================
+// [asmjit::RemoteRuntime - Construction / Destruction]
+// ============================================================================
+
+RemoteRuntime::RemoteRuntime(const CodeInfo& codeInfo) noexcept
+  : _handle(-1),
+    _local(nullptr),
+    _size(0),
+    _usedSize(0),
+    _remoteBase(0),
+    _zone(4096 - Zone::kZoneOverhead),
+    _heap(&_zone) {
+
+  _runtimeType = kRuntimeRemote;
+  _codeInfo = codeInfo;
+}
+
+RemoteRuntime::~RemoteRuntime() noexcept {
+  reset();
+}
+
+// ============================================================================
+// [asmjit::RemoteRuntime - Init / Reset]
+// ============================================================================
+
+Error RemoteRuntime::init(size_t size) noexcept {
+  if (ASMJIT_UNLIKELY(isInitialized()))
+    return DebugUtils::errored(kErrorAlreadyInitialized);
+
+  intptr_t handle;
+  size_t allocated;
+  ASMJIT_PROPAGATE(OSUtils::createSharedMemory(size, &allocated, &handle));
+
+  void* local = OSUtils::mapSharedMemory(handle, allocated, OSUtils::kVMWritable);
+  if (ASMJIT_UNLIKELY(!local)) {
+    OSUtils::closeSharedMemory(handle);
+    return DebugUtils::errored(kErrorNoVirtualMemory);
+  }
+
+  _handle = handle;
+  _local = static_cast<uint8_t*>(local);
+  _size = allocated;
+  return kErrorOk;
+}
+
+void RemoteRuntime::reset() noexcept {
+  if (!isInitialized())
+    return;
+
+  OSUtils::unmapSharedMemory(_local, _size);
+  OSUtils::closeSharedMemory(_handle);
+
+  _handle = -1;
+  _local = nullptr;
+  _size = 0;
+  _usedSize = 0;
+  _remoteBase = 0;
+
+  _blocks.reset();
+  _heap.reset(&_zone);
+  _zone.reset(true);
+}
+
+// ============================================================================
+// [asmjit::RemoteRuntime - Accessors]
+// ============================================================================
+
+Error RemoteRuntime::setRemoteBase(uint64_t base) noexcept {
+  AutoLock locked(_lock);
+  if (ASMJIT_UNLIKELY(!_blocks.isEmpty()))
+    return DebugUtils::errored(kErrorInvalidState);
+
+  _remoteBase = base;
+  return kErrorOk;
+}
+
+// ============================================================================
+// [asmjit::RemoteRuntime - Target]
+// ============================================================================
+
+Error RemoteRuntime::mapExecutable(intptr_t handle, size_t size, void** p) noexcept {
+  *p = OSUtils::mapSharedMemory(handle, size, OSUtils::kVMExecutable);
+  if (ASMJIT_UNLIKELY(!*p))
+    return DebugUtils::errored(kErrorNoVirtualMemory);
+  return kErrorOk;
+}
+
+Error RemoteRuntime::unmapExecutable(void* p, size_t size) noexcept {
+  return OSUtils::unmapSharedMemory(p, size);
+}
+
+// ============================================================================
+// [asmjit::RemoteRuntime - Interface]
+// ============================================================================
+
+// Returns the index of the first block having `offset` greater than or equal
+// to the given `offset`.
+static size_t RemoteRuntime_lowerBound(const ZoneVector<RemoteRuntime::Block>& blocks, size_t offset) noexcept {
+  size_t lo = 0;
+  size_t hi = blocks.getLength();
+
+  while (lo < hi) {
+    size_t mid = (lo + hi) / 2;
+    if (blocks[mid].offset < offset)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  return lo;
+}
+
+Error RemoteRuntime::_add(void** dst, CodeHolder* code) noexcept {
+  *dst = nullptr;
+
+  if (ASMJIT_UNLIKELY(!isInitialized() || !_remoteBase))
+    return DebugUtils::errored(kErrorInvalidState);
+
+  if (ASMJIT_UNLIKELY(code->getArchType() != getArchType()))
+    return DebugUtils::errored(kErrorInvalidArch);
+
+  size_t codeSize = code->getRelocatedSize(_remoteBase, _remoteBase + _size);
+  if (ASMJIT_UNLIKELY(codeSize == 0))
+    return DebugUtils::errored(kErrorNoCodeGenerated);
+
+  AutoLock locked(_lock);
+  codeSize = Utils::alignTo<size_t>(codeSize, kAlignment);
+
+  // First fit - find the first gap between used blocks large enough.
+  size_t count = _blocks.getLength();
+  size_t index = 0;
+  size_t offset = 0;
+
+  while (index < count) {
+    const Block& block = _blocks[index];
+    if (block.offset - offset >= codeSize)
+      break;
+    offset = block.offset + block.size;
+    index++;
+  }
+
+  if (ASMJIT_UNLIKELY(_size - offset < codeSize))
+    return DebugUtils::errored(kErrorNoVirtualMemory);
+
+  size_t relocSize = code->relocate(_local + offset, _remoteBase + offset);
+  if (ASMJIT_UNLIKELY(relocSize == 0))
+    return DebugUtils::errored(kErrorInvalidState);
+
+  Block block;
+  block.offset = offset;
+  block.size = Utils::alignTo<size_t>(relocSize, kAlignment);
+  ASMJIT_PROPAGATE(_blocks.insert(&_heap, index, block));
+
+  _usedSize += block.size;
+  *dst = reinterpret_cast<void*>(static_cast<uintptr_t>(_remoteBase + offset));
+  return kErrorOk;
+}
+
+Error RemoteRuntime::_release(void* p) noexcept {
+  AutoLock locked(_lock);
+
+  uint64_t offset = static_cast<uint64_t>((uintptr_t)p) - _remoteBase;
+  if (ASMJIT_UNLIKELY(!isInitialized() || offset >= _size))
+    return DebugUtils::errored(kErrorInvalidArgument);
+
+  size_t index = RemoteRuntime_lowerBound(_blocks, static_cast<size_t>(offset));
+  if (ASMJIT_UNLIKELY(index >= _blocks.getLength() || _blocks[index].offset != offset))
+    return DebugUtils::errored(kErrorInvalidArgument);
+
+  _usedSize -= _blocks[index].size;
+  _blocks.removeAt(index);
+  return kErrorOk;
+}
+
+// ============================================================================
+// [asmjit::JitRuntime - Test]
+// ============================================================================
+
+#if defined(ASMJIT_TEST) && defined(ASMJIT_BUILD_X86) && (ASMJIT_ARCH_X86 || ASMJIT_ARCH_X64)
+struct JitRuntimeTestTask {
+  JitTask task;
+  uint32_t value;
+
+  ASMJIT_INLINE JitRuntimeTestTask(JitTask::GenerateFunc generate, uint32_t value, int32_t priority = 0) noexcept
+    : task(generate, this, priority),
+      value(value) {}
+};
+
+struct JitRuntimeTestGate {
+  Lock lock;
+  CondVar cond;
+  bool released;
+  uint32_t order[8];
+  uint32_t orderCount;
+};
+
+static JitRuntimeTestGate* JitRuntimeTest_gate;
+
+static Error ASMJIT_CDECL JitRuntimeTest_generate(CodeHolder* code, void* data) {
+  JitRuntimeTestTask* self = static_cast<JitRuntimeTestTask*>(data);
+  JitRuntimeTestGate* gate = JitRuntimeTest_gate;
+
+  if (gate) {
+    AutoLock locked(gate->lock);
+    while (!gate->released)
+      gate->cond.wait(gate->lock);
+    gate->order[gate->orderCount++] = self->value;
+  }
+
+  return JitTest_emitReturn(code, self->value);
+}
+
+static Error ASMJIT_CDECL JitRuntimeTest_fail(CodeHolder* code, void* data) {
+  ASMJIT_UNUSED(code);
+  ASMJIT_UNUSED(data);
+  return DebugUtils::errored(kErrorInvalidArgument);
+}
+
+UNIT(base_jitruntime_tasks) {
+  typedef int (*Func)(void);
+  JitRuntime rt;
+  uint32_t i;
+
+  INFO("Checking that tasks can't be submitted without workers");
+  {
+    JitRuntimeTestTask t(JitRuntimeTest_generate, 1);
+    EXPECT(rt.submit(&t.task) == kErrorInvalidState);
+    EXPECT(t.task.getStatus() == JitTask::kStatusIdle);
+    EXPECT(rt.wait(&t.task) == kErrorInvalidState);
+  }
+
+  INFO("Compiling tasks on multiple workers");
+  {
+    EXPECT(rt.startWorkers(3) == kErrorOk);
+    EXPECT(rt.getWorkerCount() == 3);
+    EXPECT(rt.startWorkers(1) == kErrorInvalidState);
+
+    JitRuntimeTestTask* tasks[16];
+    for (i = 0; i < 16; i++) {
+      tasks[i] = new JitRuntimeTestTask(JitRuntimeTest_generate, i * 3);
+      EXPECT(rt.submit(&tasks[i]->task) == kErrorOk);
+    }
+
+    for (i = 0; i < 16; i++) {
+      EXPECT(rt.wait(&tasks[i]->task) == kErrorOk);
+      EXPECT(tasks[i]->task.getStatus() == JitTask::kStatusDone);
+
+      Func fn = tasks[i]->task.getFuncT<Func>();
+      EXPECT(fn != nullptr && fn() == int(i * 3), "Task #%u returned a wrong value", i);
+      rt.release(fn);
+      delete tasks[i];
+    }
+
+    JitRuntimeTestTask failing(JitRuntimeTest_fail, 0);
+    EXPECT(rt.submit(&failing.task) == kErrorOk);
+    EXPECT(rt.wait(&failing.task) == kErrorInvalidArgument);
+    EXPECT(failing.task.getStatus() == JitTask::kStatusFailed);
+    EXPECT(failing.task.getFunc() == nullptr);
+    rt.stopWorkers();
+  }
+
+  INFO("Checking priorities and cancellation");
+  {
+    JitRuntimeTestGate gate;
+    gate.released = false;
+    gate.orderCount = 0;
+    JitRuntimeTest_gate = &gate;
+
+    EXPECT(rt.startWorkers(1) == kErrorOk);
+
+    // The worker blocks on the first task until the gate is released.
+    JitRuntimeTestTask first(JitRuntimeTest_generate, 1);
+    EXPECT(rt.submit(&first.task) == kErrorOk);
+    while (first.task.getStatus() != JitTask::kStatusRunning)
+      continue;
+
+    JitRuntimeTestTask low(JitRuntimeTest_generate, 2, 0);
+    JitRuntimeTestTask mid(JitRuntimeTest_generate, 3, 5);
+    JitRuntimeTestTask high(JitRuntimeTest_generate, 4, 10);
+    JitRuntimeTestTask low2(JitRuntimeTest_generate, 5, 0);
+
+    EXPECT(rt.submit(&low.task) == kErrorOk);
+    EXPECT(rt.submit(&mid.task) == kErrorOk);
+    EXPECT(rt.submit(&high.task) == kErrorOk);
+    EXPECT(rt.submit(&low2.task) == kErrorOk);
+    EXPECT(rt.submit(&low2.task) == kErrorInvalidState);
+    EXPECT(rt.getQueuedCount() == 4);
+
+    EXPECT(rt.cancel(&mid.task) == true);
+    EXPECT(rt.cancel(&mid.task) == false);
+    EXPECT(rt.cancel(&first.task) == false);
+    EXPECT(mid.task.getStatus() == JitTask::kStatusCancelled);
+    EXPECT(mid.task.getFunc() == nullptr);
+
+    {
+      AutoLock locked(gate.lock);
+      gate.released = true;
+      gate.cond.broadcast();
+    }
+
+    EXPECT(rt.wait(&low2.task) == kErrorOk);
+    EXPECT(rt.wait(&first.task) == kErrorOk);
+    EXPECT(rt.wait(&high.task) == kErrorOk);
+    EXPECT(rt.wait(&low.task) == kErrorOk);
+
+    EXPECT(gate.orderCount == 4);
+    EXPECT(gate.order[0] == 1 && gate.order[1] == 4 && gate.order[2] == 2 && gate.order[3] == 5,
+      "Tasks compiled in a wrong order");
+
+    rt.release(first.task.getFunc());
+    rt.release(low.task.getFunc());
+    rt.release(high.task.getFunc());
+    rt.release(low2.task.getFunc());
+
+    JitRuntimeTest_gate = nullptr;
+  }
+
+  INFO("Checking that stopping workers cancels queued tasks");
+  {
+    JitRuntimeTestGate gate;
+    gate.released = false;
+    gate.orderCount = 0;
+    JitRuntimeTest_gate = &gate;
+
+    JitRuntimeTestTask first(JitRuntimeTest_generate, 1);
+    JitRuntimeTestTask queued(JitRuntimeTest_generate, 2);
+
+    EXPECT(rt.submit(&first.task) == kErrorOk);
+    while (first.task.getStatus() != JitTask::kStatusRunning)
+      continue;
+    EXPECT(rt.submit(&queued.task) == kErrorOk);
+
+    {
+      AutoLock locked(gate.lock);
+      gate.released = true;
+      gate.cond.broadcast();
+    }
+
+    // The running task is finished, the queued one may be compiled or cancelled.
+    rt.stopWorkers();
+    EXPECT(first.task.getStatus() == JitTask::kStatusDone);
+    EXPECT(queued.task.getStatus() == JitTask::kStatusDone || queued.task.getStatus() == JitTask::kStatusCancelled);
+
+    rt.release(first.task.getFunc());
+    rt.release(queued.task.getFunc());
+    JitRuntimeTest_gate = nullptr;
+  }
+}
+
+struct JitRuntimeTestListener : public JitListener {
+  JitRuntimeTestListener() noexcept : added(0), released(0) {}
+
+  virtual void onAdd(const void* p, size_t size, const CodeHolder* code) noexcept {
+    ASMJIT_UNUSED(p);
+    ASMJIT_UNUSED(size);
+    ASMJIT_UNUSED(code);
+    added++;
+  }
+  virtual void onRelease(const void* p) noexcept {
+    ASMJIT_UNUSED(p);
+    released++;
+  }
+
+  uint32_t added;
+  uint32_t released;
+};
+
+static void* JitRuntimeTest_add(JitRuntime& rt, uint32_t value) noexcept {
+  JitRuntimeTestTask t(JitRuntimeTest_generate, value);
+  CodeHolder code;
+  code.init(rt.getCodeInfo());
+
+  void* p = nullptr;
+  if (JitRuntimeTest_generate(&code, &t) == kErrorOk)
+    rt._add(&p, &code);
+  return p;
+}
+
+UNIT(base_jitruntime_deferred) {
+  typedef int (*Func)(void);
+  JitRuntime rt;
+  JitRuntimeTestListener listener;
+  rt.setListener(&listener);
+  uint32_t i;
+
+  INFO("Deferring releases until registered threads are quiescent");
+  {
+    JitThread a;
+    JitThread b;
+    rt.registerThread(&a);
+    rt.registerThread(&b);
+
+    Func f1 = ptr_as_func<Func>(JitRuntimeTest_add(rt, 1));
+    Func f2 = ptr_as_func<Func>(JitRuntimeTest_add(rt, 2));
+    EXPECT(f1 != nullptr && f2 != nullptr);
+
+    EXPECT(rt.releaseDeferred(f1) == kErrorOk);
+    EXPECT(rt.getDeferredCount() == 1);
+    EXPECT(rt.reclaim() == 0);
+    EXPECT(f1() == 1);
+
+    rt.quiescent(&a);
+    EXPECT(rt.releaseDeferred(f2) == kErrorOk);
+    EXPECT(rt.reclaim() == 0);
+
+    rt.quiescent(&b);
+    EXPECT(rt.reclaim() == 1);
+    EXPECT(listener.released == 1);
+    EXPECT(rt.getDeferredCount() == 1);
+
+    rt.quiescent(&a);
+    EXPECT(rt.reclaim() == 1);
+    EXPECT(listener.released == 2);
+
+    rt.unregisterThread(&a);
+    rt.unregisterThread(&b);
+  }
+
+  INFO("Reclaiming automatically after %u deferred releases", unsigned(JitRuntime::kDeferredReclaimThreshold));
+  {
+    for (i = 0; i < JitRuntime::kDeferredReclaimThreshold - 1; i++) {
+      EXPECT(rt.releaseDeferred(JitRuntimeTest_add(rt, i)) == kErrorOk);
+      EXPECT(rt.getDeferredCount() == i + 1);
+    }
+
+    EXPECT(rt.releaseDeferred(JitRuntimeTest_add(rt, i)) == kErrorOk);
+    EXPECT(rt.getDeferredCount() == 0);
+    EXPECT(rt.getMemMgr()->getUsedBytes() == 0);
+  }
+
+  INFO("Releasing deferred code when the runtime is destroyed");
+  {
+    JitRuntime rt2;
+    JitThread a;
+    rt2.registerThread(&a);
+    EXPECT(rt2.releaseDeferred(JitRuntimeTest_add(rt2, 1)) == kErrorOk);
+    EXPECT(rt2.reclaim() == 0);
+    rt2.unregisterThread(&a);
+  }
+
+  rt.setListener(nullptr);
+}
+
+UNIT(base_remoteruntime) {
+  typedef void* (*Func)(void);
+
+  JitRuntime host;
+  RemoteRuntime rt(host.getCodeInfo());
+
+  CodeHolder code;
+  code.init(rt.getCodeInfo());
+  EXPECT(JitTest_emitSelf(&code) == kErrorOk);
+
+  void* fn;
+  EXPECT(rt.getRuntimeType() == Runtime::kRuntimeRemote);
+  EXPECT(rt._add(&fn, &code) == kErrorInvalidState,
+    "RemoteRuntime::add() must fail if not initialized");
+
+  INFO("Creating a shared region and mapping it executable as the target");
+  EXPECT(rt.init(65536) == kErrorOk);
+  EXPECT(rt.getSize() >= 65536);
+  EXPECT(rt._add(&fn, &code) == kErrorInvalidState,
+    "RemoteRuntime::add() must fail without a remote base");
+
+  void* target;
+  EXPECT(RemoteRuntime::mapExecutable(rt.getHandle(), rt.getSize(), &target) == kErrorOk);
+  EXPECT(rt.setRemoteBase(static_cast<uint64_t>((uintptr_t)target)) == kErrorOk);
+
+  INFO("Relocating code for the target");
+  void* fn0;
+  void* fn1;
+  EXPECT(rt._add(&fn0, &code) == kErrorOk);
+  EXPECT(rt._add(&fn1, &code) == kErrorOk);
+  EXPECT(fn0 == target);
+  EXPECT(static_cast<uint8_t*>(fn1) == static_cast<uint8_t*>(target) + RemoteRuntime::kAlignment);
+  EXPECT(rt.toLocal(fn1) == static_cast<uint8_t*>(rt._local) + RemoteRuntime::kAlignment);
+  EXPECT(rt.getUsedSize() == RemoteRuntime::kAlignment * 2);
+
+  EXPECT(ptr_as_func<Func>(fn0)() == fn0, "Code relocated to the remote base returned invalid address");
+  EXPECT(ptr_as_func<Func>(fn1)() == fn1, "Code relocated to the remote base returned invalid address");
+  EXPECT(rt.setRemoteBase(0) == kErrorInvalidState);
+
+  INFO("Releasing code and reusing the gap");
+  EXPECT(rt._release(fn0) == kErrorOk);
+  EXPECT(rt._release(fn0) == kErrorInvalidArgument);
+  EXPECT(rt._release(static_cast<uint8_t*>(fn1) + 1) == kErrorInvalidArgument);
+
+  EXPECT(rt._add(&fn, &code) == kErrorOk);
+  EXPECT(fn == fn0);
+  EXPECT(ptr_as_func<Func>(fn)() == fn);
+
+  EXPECT(rt._release(fn) == kErrorOk);
+  EXPECT(rt._release(fn1) == kErrorOk);
+  EXPECT(rt.getUsedSize() == 0);
+
+  EXPECT(RemoteRuntime::unmapExecutable(target, rt.getSize()) == kErrorOk);
+  rt.reset();
+  EXPECT(!rt.isInitialized());
+}
+
+UNIT(base_jitruntime_batch) {
+  typedef int (*Func)(void);
+  enum { kCount = 4 };
+
+  static const size_t sizes[kCount] = { 0, 40, 0, 70 };
+
+  JitRuntime rt;
+  VMemMgr* memMgr = rt.getMemMgr();
+
+  CodeHolder codes[kCount];
+  CodeHolder* codePtrs[kCount];
+  void* fns[kCount];
+  uint32_t i;
+
+  for (i = 0; i < kCount; i++) {
+    JitTest_initReturn(&codes[i], rt, i + 1, sizes[i]);
+    codePtrs[i] = &codes[i];
+  }
+
+  INFO("Adding functions contiguously in a single allocation");
+  EXPECT(rt.addBatch(fns, codePtrs, kCount) == kErrorOk);
+  for (i = 0; i < kCount; i++) {
+    EXPECT(ptr_as_func<Func>(fns[i])() == int(i + 1),
+      "Function %u of the batch returned a wrong value", i);
+    EXPECT(Utils::isAligned<uintptr_t>((uintptr_t)fns[i], kJitRuntimeBatchAlignment));
+
+    if (i > 0) {
+      size_t prevSize = Utils::alignTo<size_t>(codes[i - 1].getCodeSize(), kJitRuntimeBatchAlignment);
+      EXPECT(static_cast<uint8_t*>(fns[i]) == static_cast<uint8_t*>(fns[i - 1]) + prevSize,
+        "Function %u of the batch doesn't follow the previous one", i);
+    }
+  }
+  EXPECT(memMgr->getUsedBytes() != 0);
+
+  INFO("Releasing the whole batch by its first function");
+  EXPECT(rt.release(fns[0]) == kErrorOk);
+  EXPECT(memMgr->getUsedBytes() == 0,
+    "Releasing the first function should release the whole batch");
+
+  INFO("Notifying the listener about each function of the batch");
+  {
+    JitRuntimeTestListener listener;
+    rt.setListener(&listener);
+
+    EXPECT(rt.addBatch(fns, codePtrs, kCount) == kErrorOk);
+    EXPECT(listener.added == kCount,
+      "The listener was notified about %u functions, expected %u", listener.added, unsigned(kCount));
+
+    EXPECT(rt.release(fns[0]) == kErrorOk);
+    EXPECT(listener.released == listener.added,
+      "The listener was notified about %u releases of %u functions", listener.released, listener.added);
+
+    EXPECT(rt.addBatch(fns, codePtrs, kCount) == kErrorOk);
+    EXPECT(rt.releaseDeferred(fns[0]) == kErrorOk);
+    EXPECT(rt.reclaim() == 1);
+    EXPECT(listener.released == listener.added,
+      "The listener was notified about %u deferred releases of %u functions", listener.released, listener.added);
+
+    rt.setListener(nullptr);
+    EXPECT(memMgr->getUsedBytes() == 0);
+  }
+
+  INFO("Cleaning up if a function fails to relocate part-way through the batch");
+  // The relocation of the third function points out of its code, so the
+  // batch fails after the first two functions were already relocated.
+  RelocEntry* re;
+  EXPECT(codes[2].newRelocEntry(&re, RelocEntry::kTypeRelToAbs, 4) == kErrorOk);
+  re->_sourceSectionId = 0;
+  re->_targetSectionId = 0;
+  re->_sourceOffset = 4096;
+
+  EXPECT(rt.addBatch(fns, codePtrs, kCount) == kErrorInvalidState);
+  for (i = 0; i < kCount; i++)
+    EXPECT(fns[i] == nullptr, "Function %u of a failed batch should be null", i);
+  EXPECT(memMgr->getUsedBytes() == 0,
+    "A failed batch shouldn't keep any memory allocated");
+
+  INFO("Rejecting a batch with an empty function");
+  codes[2].reset();
+  codes[2].init(rt.getCodeInfo());
+
+  EXPECT(rt.addBatch(fns, codePtrs, kCount) == kErrorNoCodeGenerated);
+  for (i = 0; i < kCount; i++)
+    EXPECT(fns[i] == nullptr, "Function %u of a failed batch should be null", i);
+  EXPECT(memMgr->getUsedBytes() == 0);
+}
+
+UNIT(base_jitruntime_inplace) {
+  typedef void* (*Func)(void);
+
+  for (uint32_t dualMapping = 0; dualMapping < 2; dualMapping++) {
+    JitRuntime rt;
+    if (dualMapping && rt.setDualMapping(true) != kErrorOk)
+      continue;
+
+    INFO("Emitting code in place (dual mapping %s)", dualMapping ? "on" : "off");
+    CodeHolder code;
+    EXPECT(rt.allocInPlace(&code, 256) == kErrorNotInitialized);
+
+    code.init(rt.getCodeInfo());
+    EXPECT(rt.allocInPlace(&code, 256) == kErrorOk);
+    EXPECT(rt.allocInPlace(&code, 256) == kErrorInvalidState);
+    EXPECT(code.hasBaseAddress());
+
+    CodeBuffer& buffer = code.getSectionEntry(0)->_buffer;
+    EXPECT(buffer.isExternal() && buffer.isFixedSize());
+    EXPECT(buffer.getCapacity() == 256);
+
+    uint8_t* rw = buffer.getData();
+    EXPECT(JitTest_emitSelf(&code) == kErrorOk);
+    EXPECT(buffer.getData() == rw, "The code must be emitted to the executable memory");
+    EXPECT(code.growBuffer(&buffer, 256) == kErrorCodeTooLarge);
+
+    void* fn;
+    EXPECT(rt.addInPlace(&fn, &code) == kErrorOk);
+    EXPECT(fn == reinterpret_cast<void*>(static_cast<uintptr_t>(code.getBaseAddress())));
+    EXPECT(ptr_as_func<Func>(fn)() == fn, "Code relocated in place returned invalid address");
+    EXPECT(rt.release(fn) == kErrorOk);
+
+    INFO("Releasing the memory if the code cannot be added");
+    code.reset();
+    code.init(rt.getCodeInfo());
+    EXPECT(rt.allocInPlace(&code, 64) == kErrorOk);
+    EXPECT(rt.addInPlace(&fn, &code) == kErrorNoCodeGenerated);
+    EXPECT(fn == nullptr);
+    EXPECT(rt.getMemMgr()->getUsedBytes() == 0);
+  }
+}
+#endif // ASMJIT_TEST && ASMJIT_BUILD_X86 && (ASMJIT_ARCH_X86 || ASMJIT_ARCH_X64)
+
 } // asmjit namespace
 
 // [Api-End]
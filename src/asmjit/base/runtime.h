@@ -142,6 +142,158 @@ public:
   ASMJIT_API virtual void flush(const void* p, size_t size) noexcept;
 };
 
+// ============================================================================
+// [asmjit::JitListener]
+// ============================================================================
+
+//! Listener of functions added to and released from a \ref JitRuntime.
+//!
+//! Used by tools that have to know where the generated code lives, like
+//! profilers and debuggers (see \ref JitPerfListener). The listener can be
+//! called from multiple threads if the runtime is shared.
+class ASMJIT_VIRTAPI JitListener {
+public:
+  ASMJIT_NONCOPYABLE(JitListener)
+
+  // --------------------------------------------------------------------------
+  // [Construction / Destruction]
+  // --------------------------------------------------------------------------
+
+  //! Create a `JitListener` instance.
+  ASMJIT_API JitListener() noexcept;
+  //! Destroy the `JitListener` instance.
+  ASMJIT_API virtual ~JitListener() noexcept;
+
+  // --------------------------------------------------------------------------
+  // [Interface]
+  // --------------------------------------------------------------------------
+
+  //! Called after `code` has been relocated to `p` and the instruction cache
+  //! flushed, `size` is the size of the relocated code. The `code` is null if
+  //! existing code was moved to `p` (see `JitPatcher::compact()`).
+  virtual void onAdd(const void* p, size_t size, const CodeHolder* code) noexcept = 0;
+
+  //! Called before `p` (the address returned by `add()`) is released.
+  virtual void onRelease(const void* p) noexcept = 0;
+};
+
+// ============================================================================
+// [asmjit::JitTask]
+// ============================================================================
+
+//! Background compilation task, see `JitRuntime::submit()`.
+//!
+//! The task holds a generator callback that is called by a worker thread of
+//! \ref JitRuntime with a \ref CodeHolder initialized to the runtime's
+//! CodeInfo. The generator emits and finalizes the code, the worker adds it
+//! to the runtime and publishes the function, so a requester can keep running
+//! its slow path and poll \ref getFunc() without ever blocking:
+//!
+//! ~~~
+//! static Error ASMJIT_CDECL generate(CodeHolder* code, void* data) {
+//!   X86Compiler cc(code);
+//!   ...
+//!   return cc.finalize();
+//! }
+//!
+//! JitTask task(generate, data, 10);
+//! rt.submit(&task);
+//!
+//! // Later, on a hot path.
+//! Func fn = task.getFuncT<Func>();
+//! if (fn) fn(...); else interpret(...);
+//! ~~~
+//!
+//! The compiled function is owned by the caller and must be released by
+//! `JitRuntime::release()`. A task can be submitted again once finished.
+class JitTask {
+public:
+  ASMJIT_NONCOPYABLE(JitTask)
+
+  //! Generator, emits the code into `code`.
+  typedef Error (ASMJIT_CDECL* GenerateFunc)(CodeHolder* code, void* data);
+
+  //! Status of the task.
+  ASMJIT_ENUM(Status) {
+    kStatusIdle      = 0,                //!< Not submitted.
+    kStatusQueued    = 1,                //!< Waiting in the queue.
+    kStatusRunning   = 2,                //!< Being compiled by a worker.
+    kStatusDone      = 3,                //!< Compiled, \ref getFunc() is valid.
+    kStatusFailed    = 4,                //!< Failed, see \ref getError().
+    kStatusCancelled = 5                 //!< Cancelled before it was compiled.
+  };
+
+  // --------------------------------------------------------------------------
+  // [Construction / Destruction]
+  // --------------------------------------------------------------------------
+
+  //! Create a new `JitTask` that calls `generate(code, data)`, tasks with a
+  //! higher `priority` are compiled first.
+  ASMJIT_INLINE JitTask(GenerateFunc generate, void* data, int32_t priority = 0) noexcept
+    : _generate(generate),
+      _data(data),
+      _priority(priority),
+      _status(kStatusIdle),
+      _error(kErrorOk),
+      _func(nullptr),
+      _next(nullptr),
+      _seq(0) {}
+
+  //! Destroy the `JitTask`, it must not be queued or running.
+  ASMJIT_INLINE ~JitTask() noexcept {
+    ASMJIT_ASSERT(getStatus() != kStatusQueued && getStatus() != kStatusRunning);
+  }
+
+  // --------------------------------------------------------------------------
+  // [Accessors]
+  // --------------------------------------------------------------------------
+
+  //! Get the task status, see \ref Status. It's safe to call from any thread.
+  ASMJIT_INLINE uint32_t getStatus() const noexcept { return OSUtils::atomicLoad(&_status); }
+  //! Get whether the task is finished (done, failed, or cancelled).
+  ASMJIT_INLINE bool isFinished() const noexcept { return getStatus() >= kStatusDone; }
+
+  //! Get the compiled function or null if it's not ready (never blocks).
+  ASMJIT_INLINE void* getFunc() const noexcept { return getStatus() == kStatusDone ? _func : nullptr; }
+  //! \overload
+  template<typename Func>
+  ASMJIT_INLINE Func getFuncT() const noexcept { return ptr_as_func<Func>(getFunc()); }
+
+  //! Get the error of a failed task.
+  ASMJIT_INLINE Error getError() const noexcept { return getStatus() == kStatusFailed ? _error : Error(kErrorOk); }
+
+  //! Get the priority.
+  ASMJIT_INLINE int32_t getPriority() const noexcept { return _priority; }
+  //! Set the priority, only allowed if the task is not queued or running.
+  ASMJIT_INLINE void setPriority(int32_t priority) noexcept { _priority = priority; }
+
+  // --------------------------------------------------------------------------
+  // [Members]
+  // --------------------------------------------------------------------------
+
+  GenerateFunc _generate;                //!< Generator.
+  void* _data;                           //!< Data passed to the generator.
+  int32_t _priority;                     //!< Priority.
+  volatile uint32_t _status;             //!< Status, see \ref Status.
+  Error _error;                          //!< Error of a failed task.
+  void* _func;                           //!< Compiled function.
+  JitTask* _next;                        //!< Next task in the queue.
+  uint64_t _seq;                         //!< Submission order, used to keep FIFO order of the same priority.
+};
+
+// ============================================================================
+// [asmjit::JitThread]
+// ============================================================================
+
+//! Thread that executes code of a \ref JitRuntime, see
+//! `JitRuntime::registerThread()`.
+struct JitThread {
+  ASMJIT_INLINE JitThread() noexcept : epoch(0), next(nullptr) {}
+
+  volatile uint32_t epoch;               //!< The last epoch observed by the thread.
+  JitThread* next;                       //!< Next registered thread.
+};
+
 // ============================================================================
 // [asmjit::JitRuntime]
 // ============================================================================
@@ -172,6 +324,55 @@ public:
   //! Get the virtual memory manager.
   ASMJIT_INLINE VMemMgr* getMemMgr() const noexcept { return const_cast<VMemMgr*>(&_memMgr); }
 
+  //! Get whether the runtime uses dual-mapped (W^X) virtual memory.
+  ASMJIT_INLINE bool getDualMapping() const noexcept { return _memMgr.getDualMapping(); }
+  //! Set whether the runtime should use dual-mapped (W^X) virtual memory.
+  //!
+  //! The code is relocated through a writable view and the executable view is
+  //! returned by `add()`. It must be set before any function is added, see
+  //! \ref VMemMgr::setDualMapping().
+  ASMJIT_INLINE Error setDualMapping(bool val) noexcept { return _memMgr.setDualMapping(val); }
+
+  //! Get whether the runtime allocates the code in large (huge) pages.
+  ASMJIT_INLINE bool getLargePages() const noexcept { return _memMgr.getLargePages(); }
+  //! Set whether the runtime should allocate the code in large (huge) pages.
+  //!
+  //! It must be set before any function is added, see \ref VMemMgr::setLargePages().
+  ASMJIT_INLINE Error setLargePages(bool val) noexcept { return _memMgr.setLargePages(val); }
+
+  //! Allocate the code within `distance` bytes of `p`, so calls to functions
+  //! near `p` don't need trampolines. It must be set before any function is
+  //! added, see \ref VMemMgr::setNearAddress().
+  ASMJIT_INLINE Error setNearAddress(const void* p, size_t distance = VMemMgr::kDefaultNearDistance) noexcept {
+    return _memMgr.setNearAddress(p, distance);
+  }
+
+  //! Get the listener notified about added and released functions.
+  ASMJIT_INLINE JitListener* getListener() const noexcept { return _listener; }
+  //! Set the listener notified about added and released functions (can be null).
+  //!
+  //! The listener must outlive the runtime or be reset before it's destroyed.
+  ASMJIT_INLINE void setListener(JitListener* listener) noexcept { _listener = listener; }
+
+  //! Get the count of registered unwind tables, see \ref JitUnwind.
+  //!
+  //! Unwind information is registered by `add()` and `addBatch()` for each
+  //! \ref CodeHolder that has `CodeHolder::setUnwindEnabled()` set, a batch
+  //! has a single table, and unregistered when the function is released.
+  ASMJIT_API size_t getUnwindTableCount() const noexcept;
+
+  // --------------------------------------------------------------------------
+  // [Statistics]
+  // --------------------------------------------------------------------------
+
+  //! Get statistics aggregated from all added \ref CodeHolder instances that
+  //! have statistics enabled, see `CodeHolder::setStatsEnabled()`.
+  //!
+  //! Returns a copy, it's safe to call while other threads add code.
+  ASMJIT_API CodeStats getStats() const noexcept;
+  //! Reset aggregated statistics.
+  ASMJIT_API void resetStats() noexcept;
+
   // --------------------------------------------------------------------------
   // [Interface]
   // --------------------------------------------------------------------------
@@ -179,12 +380,358 @@ public:
   ASMJIT_API Error _add(void** dst, CodeHolder* code) noexcept override;
   ASMJIT_API Error _release(void* p) noexcept override;
 
+  // --------------------------------------------------------------------------
+  // [Arena]
+  // --------------------------------------------------------------------------
+
+  //! Like `add()`, but allocates the memory from a thread-local `arena`, which
+  //! must be bound to this runtime's memory manager (see \ref getMemMgr()).
+  //!
+  //! The allocation doesn't lock the \ref VMemMgr unless the arena runs out
+  //! of space. The function must be released by `releaseFromArena()`.
+  template<typename Func>
+  ASMJIT_INLINE Error addToArena(Func* dst, CodeHolder* code, VMemArena* arena) noexcept {
+    return _addToArena(Internal::ptr_cast<void**, Func*>(dst), code, arena);
+  }
+
+  template<typename Func>
+  ASMJIT_INLINE Error releaseFromArena(Func dst, VMemArena* arena) noexcept {
+    return _releaseFromArena(Internal::ptr_cast<void*, Func>(dst), arena);
+  }
+
+  ASMJIT_API Error _addToArena(void** dst, CodeHolder* code, VMemArena* arena) noexcept;
+  ASMJIT_API Error _releaseFromArena(void* p, VMemArena* arena) noexcept;
+
+  // --------------------------------------------------------------------------
+  // [Batch]
+  // --------------------------------------------------------------------------
+
+  //! Add `count` functions stored in `codes` at once.
+  //!
+  //! All functions are laid out contiguously in a single allocation, which
+  //! means that the \ref VMemMgr is locked only once, and the instruction
+  //! cache is flushed only once for the whole batch. The address of each
+  //! function is stored in `dst` at the same index as its \ref CodeHolder.
+  //!
+  //! The batch is a single allocation - it must be released as a whole by
+  //! passing `dst[0]` to `release()`; other functions of the batch must not
+  //! be released individually. If any function fails to relocate then no
+  //! memory is allocated and all `dst` entries are set to null.
+  //!
+  //! The \ref JitListener is notified about each function of the batch, and
+  //! when the batch is released, about the release of each one of them.
+  ASMJIT_API Error addBatch(void** dst, CodeHolder* const* codes, size_t count) noexcept;
+
+  // --------------------------------------------------------------------------
+  // [In-Place]
+  // --------------------------------------------------------------------------
+
+  //! Allocate `size` bytes of executable memory and use its writable view as
+  //! a fixed-size buffer of the `.text` section of `code` (zero-copy).
+  //!
+  //! The `code` must be initialized, its `.text` section must be empty and it
+  //! must not have a base address, which is set to the executable address of
+  //! the memory. Emitters should be attached after this call so they know the
+  //! base address. Emitting more than `size` bytes to `.text` fails with
+  //! `kErrorCodeTooLarge`. The code must be finalized by `addInPlace()`, or the
+  //! memory released by passing `code->getBaseAddress()` to `release()`.
+  ASMJIT_API Error allocInPlace(CodeHolder* code, size_t size) noexcept;
+
+  //! Like `add()`, but relocates the code allocated by `allocInPlace()` in
+  //! place instead of copying it, other sections (if any) and trampolines
+  //! are copied after `.text`. The function is released by `release()`.
+  //!
+  //! If failed the memory is released and `code` must be reset before it's
+  //! used again.
+  template<typename Func>
+  ASMJIT_INLINE Error addInPlace(Func* dst, CodeHolder* code) noexcept {
+    return _addInPlace(Internal::ptr_cast<void**, Func*>(dst), code);
+  }
+
+  ASMJIT_API Error _addInPlace(void** dst, CodeHolder* code) noexcept;
+
+  // --------------------------------------------------------------------------
+  // [Deferred Release]
+  // --------------------------------------------------------------------------
+
+  enum {
+    //! Count of deferred releases that triggers `reclaim()`.
+    kDeferredReclaimThreshold = 64
+  };
+
+  //! Register `thread` as a thread that executes code of this runtime.
+  //!
+  //! Code released by `releaseDeferred()` is not freed until all registered
+  //! threads report a quiescent state by `quiescent()`.
+  ASMJIT_API void registerThread(JitThread* thread) noexcept;
+  //! Unregister `thread`, it must not execute code of this runtime anymore.
+  ASMJIT_API void unregisterThread(JitThread* thread) noexcept;
+
+  //! Report that `thread` doesn't execute any code of this runtime now, for
+  //! example between two requests (lock-free).
+  ASMJIT_INLINE void quiescent(JitThread* thread) noexcept {
+    OSUtils::atomicStore(&thread->epoch, OSUtils::atomicLoad(&_epoch));
+  }
+
+  //! Release `p` once no registered thread can execute it anymore.
+  //!
+  //! Unlike `release()`, which frees the memory immediately, the function is
+  //! queued and freed by `reclaim()` after all threads registered by
+  //! `registerThread()` passed a quiescent state. Every
+  //! `kDeferredReclaimThreshold` deferred releases call `reclaim()`.
+  template<typename Func>
+  ASMJIT_INLINE Error releaseDeferred(Func p) noexcept {
+    return _releaseDeferred(Internal::ptr_cast<void*, Func>(p), true);
+  }
+
+  //! Free all deferred releases that can't be executed anymore, under a single
+  //! lock of the \ref VMemMgr. Returns the count of freed allocations.
+  ASMJIT_API size_t reclaim() noexcept;
+  //! Get the count of deferred releases that were not freed yet.
+  ASMJIT_API size_t getDeferredCount() const noexcept;
+
+  //! \internal
+  //!
+  //! Defer the release of `p`, `notify` is false for memory that was not
+  //! added by `add()` (the \ref JitListener is not notified about it).
+  ASMJIT_API Error _releaseDeferred(void* p, bool notify) noexcept;
+
+  // --------------------------------------------------------------------------
+  // [Background Compilation]
+  // --------------------------------------------------------------------------
+
+  //! Start `count` worker threads that compile submitted \ref JitTask's.
+  //!
+  //! Fails with `kErrorInvalidState` if workers were already started.
+  ASMJIT_API Error startWorkers(uint32_t count = 1) noexcept;
+  //! Stop all workers, cancel all queued tasks, and wait for tasks that are
+  //! being compiled. Called by the destructor.
+  ASMJIT_API void stopWorkers() noexcept;
+  //! Get the count of worker threads.
+  ASMJIT_INLINE uint32_t getWorkerCount() const noexcept { return _workerCount; }
+
+  //! Submit `task` to be compiled by a worker.
+  //!
+  //! Fails with `kErrorInvalidState` if no workers were started or if `task`
+  //! is already queued or running.
+  ASMJIT_API Error submit(JitTask* task) noexcept;
+  //! Cancel `task` if it's still queued, returns true if it was cancelled.
+  //! A task that is already being compiled is not interrupted.
+  ASMJIT_API bool cancel(JitTask* task) noexcept;
+  //! Block until `task` is finished and return its error.
+  ASMJIT_API Error wait(JitTask* task) noexcept;
+  //! Get the count of queued tasks.
+  ASMJIT_API size_t getQueuedCount() const noexcept;
+
   // --------------------------------------------------------------------------
   // [Members]
   // --------------------------------------------------------------------------
 
   //! Virtual memory manager.
   VMemMgr _memMgr;
+  //! Listener of added and released functions.
+  JitListener* _listener;
+  //! Lock that protects `_stats`.
+  mutable Lock _statsLock;
+  //! Statistics aggregated from added code.
+  CodeStats _stats;
+
+  //! \internal
+  //!
+  //! Deferred release.
+  struct Deferred {
+    void* p;                             //!< Executable address.
+    uint32_t epoch;                      //!< Epoch when it was released.
+    bool notify;                         //!< Notify the listener when it's freed.
+    Deferred* next;                      //!< Next deferred release.
+  };
+
+  //! Lock that protects registered threads and deferred releases.
+  mutable Lock _deferredLock;
+  //! Registered threads.
+  JitThread* _threads;
+  //! Deferred releases (the newest first).
+  Deferred* _deferred;
+  //! Count of deferred releases.
+  size_t _deferredCount;
+  //! Current epoch, incremented by each deferred release.
+  volatile uint32_t _epoch;
+
+  //! Lock that protects the task queue.
+  mutable Lock _queueLock;
+  //! Signaled when a task is queued or workers should stop.
+  CondVar _queueCond;
+  //! Signaled when a task is finished.
+  CondVar _doneCond;
+  //! First task of the queue (ordered by priority and submission).
+  JitTask* _queueHead;
+  //! Submission counter.
+  uint64_t _queueSeq;
+  //! Worker threads.
+  Thread* _workers;
+  //! Count of worker threads.
+  uint32_t _workerCount;
+  //! Whether workers should stop.
+  bool _stopping;
+
+  //! \internal
+  //!
+  //! Unwind table registered for an allocation, see \ref JitUnwind.
+  struct UnwindEntry : public ZoneHashNode {
+    void* p;                             //!< Executable address returned by `add()`.
+    void* table;                         //!< Executable address of the table.
+  };
+
+  //! \internal
+  //!
+  //! Functions of a batch added by `addBatch()` while a listener was set, the
+  //! listener is notified about the release of each one.
+  struct BatchEntry : public ZoneHashNode {
+    void* p;                             //!< Executable address of the batch.
+    size_t count;                        //!< Count of functions.
+    void* addresses[1];                  //!< Address of each function.
+  };
+
+  //! Lock that protects unwind tables and batches.
+  mutable Lock _unwindLock;
+  //! Zone used by `_unwindHeap`.
+  Zone _unwindZone;
+  //! Heap of unwind and batch entries, `_unwindTables`, and `_batches`.
+  ZoneHeap _unwindHeap;
+  //! Registered unwind tables (executable address -> entry).
+  ZoneFlatHash<UnwindEntry> _unwindTables;
+  //! Batches reported to the listener (executable address -> entry).
+  ZoneFlatHash<BatchEntry> _batches;
+};
+
+// ============================================================================
+// [asmjit::RemoteRuntime]
+// ============================================================================
+
+//! Runtime that relocates code for another process (out-of-process JIT).
+//!
+//! The code is generated and relocated in this process into a shared memory
+//! region created by `init()` and mapped only writable here. The target
+//! process maps the same region executable (see `mapExecutable()`) and tells
+//! the runtime where by `setRemoteBase()`, so the compilation (and its
+//! crashes) never happens in the process that executes the code:
+//!
+//! ~~~
+//! // Compiler process.
+//! RemoteRuntime rt(codeInfo);              // CodeInfo of the target process.
+//! rt.init(16 * 1024 * 1024);
+//! sendHandle(worker, rt.getHandle());      // SCM_RIGHTS or DuplicateHandle().
+//! rt.setRemoteBase(receiveAddress(worker));
+//!
+//! void* fn;                                // Only valid in the worker.
+//! rt.add(&fn, &code);
+//!
+//! // Worker process.
+//! void* base;
+//! RemoteRuntime::mapExecutable(handle, size, &base);
+//! sendAddress(compiler, base);
+//! ~~~
+//!
+//! Absolute addresses embedded in the code (calls to functions, data) must be
+//! valid in the target process. The runtime can't flush the instruction cache
+//! of the target, which has to call `HostRuntime::flush()` (or equivalent) on
+//! architectures that need it before executing new code.
+class ASMJIT_VIRTAPI RemoteRuntime : public Runtime {
+public:
+  ASMJIT_NONCOPYABLE(RemoteRuntime)
+
+  enum {
+    //! Alignment of each function in the region.
+    kAlignment = 64
+  };
+
+  //! Range of the region used by a function.
+  struct Block {
+    size_t offset;                       //!< Offset in the region.
+    size_t size;                         //!< Size (aligned to `kAlignment`).
+  };
+
+  // --------------------------------------------------------------------------
+  // [Construction / Destruction]
+  // --------------------------------------------------------------------------
+
+  //! Create a `RemoteRuntime` that generates code described by `codeInfo`.
+  ASMJIT_API explicit RemoteRuntime(const CodeInfo& codeInfo) noexcept;
+  //! Destroy the `RemoteRuntime`, it unmaps and closes the region.
+  ASMJIT_API virtual ~RemoteRuntime() noexcept;
+
+  // --------------------------------------------------------------------------
+  // [Init / Reset]
+  // --------------------------------------------------------------------------
+
+  //! Get whether the region has been created by `init()`.
+  ASMJIT_INLINE bool isInitialized() const noexcept { return _local != nullptr; }
+
+  //! Create a shared memory region of at least `size` bytes.
+  ASMJIT_API Error init(size_t size) noexcept;
+  //! Unmap and close the region, all functions added become invalid.
+  ASMJIT_API void reset() noexcept;
+
+  // --------------------------------------------------------------------------
+  // [Accessors]
+  // --------------------------------------------------------------------------
+
+  //! Get the OS handle of the region (file descriptor or section `HANDLE`).
+  ASMJIT_INLINE intptr_t getHandle() const noexcept { return _handle; }
+  //! Get the size of the region (aligned to a page size).
+  ASMJIT_INLINE size_t getSize() const noexcept { return _size; }
+  //! Get the number of bytes used by functions.
+  ASMJIT_INLINE size_t getUsedSize() const noexcept { return _usedSize; }
+
+  //! Get the address of the region in the target process, zero if not set.
+  ASMJIT_INLINE uint64_t getRemoteBase() const noexcept { return _remoteBase; }
+  //! Set the address of the region in the target process.
+  //!
+  //! Relocated code depends on it, so it can only be changed if the runtime
+  //! has no functions, returns `kErrorInvalidState` otherwise.
+  ASMJIT_API Error setRemoteBase(uint64_t base) noexcept;
+
+  //! Translate `remote` (address returned by `add()`) to the writable view of
+  //! this process, returns null if it's outside of the region.
+  ASMJIT_INLINE void* toLocal(const void* remote) const noexcept {
+    uint64_t offset = static_cast<uint64_t>((uintptr_t)remote) - _remoteBase;
+    return _remoteBase && offset < _size ? static_cast<void*>(_local + static_cast<size_t>(offset)) : static_cast<void*>(nullptr);
+  }
+
+  // --------------------------------------------------------------------------
+  // [Target]
+  // --------------------------------------------------------------------------
+
+  //! Map the region `handle` of `size` bytes readable and executable, called
+  //! by the target process.
+  ASMJIT_API static Error mapExecutable(intptr_t handle, size_t size, void** p) noexcept;
+  //! Unmap the region mapped by `mapExecutable()`.
+  ASMJIT_API static Error unmapExecutable(void* p, size_t size) noexcept;
+
+  // --------------------------------------------------------------------------
+  // [Interface]
+  // --------------------------------------------------------------------------
+
+  //! Relocate `code` for the target process, `dst` receives the address of
+  //! the function in the target process.
+  ASMJIT_API Error _add(void** dst, CodeHolder* code) noexcept override;
+  //! Release `p` returned by `add()`, it must not be executed anymore.
+  ASMJIT_API Error _release(void* p) noexcept override;
+
+  // --------------------------------------------------------------------------
+  // [Members]
+  // --------------------------------------------------------------------------
+
+  Lock _lock;                            //!< Lock that guards the allocator.
+  intptr_t _handle;                      //!< OS handle of the shared memory.
+  uint8_t* _local;                       //!< Writable view of the region (this process).
+  size_t _size;                          //!< Size of the region.
+  size_t _usedSize;                      //!< Bytes used by functions.
+  uint64_t _remoteBase;                  //!< Address of the region in the target process.
+
+  Zone _zone;                            //!< Zone used by `_heap`.
+  ZoneHeap _heap;                        //!< ZoneHeap used by `_blocks`.
+  ZoneVector<Block> _blocks;             //!< Used blocks sorted by offset.
 };
 
 //! \}
@@ -192,6 +192,12 @@ Error StringBuilder::_opChars(uint32_t op, char c, size_t n) noexcept {
 
 static const char StringBuilder_numbers[] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ";
 
+// Pairs of decimal digits "00" to "99", used to convert two digits at a time.
+static const char StringBuilder_digitPairs[] =
+  "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+  "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+  "8081828384858687888990919293949596979899";
+
 Error StringBuilder::_opNumber(uint32_t op, uint64_t i, uint32_t base, size_t width, uint32_t flags) noexcept {
   if (base < 2 || base > 36)
     base = 10;
@@ -221,13 +227,49 @@ Error StringBuilder::_opNumber(uint32_t op, uint64_t i, uint32_t base, size_t wi
   // [Number]
   // --------------------------------------------------------------------------
 
-  do {
-    uint64_t d = i / base;
-    uint64_t r = i % base;
+  // Decimal and hexadecimal numbers are formatted by logging, so they avoid
+  // the generic 64-bit division by a variable `base`.
+  if (base == 16) {
+    do {
+      *--p = StringBuilder_numbers[static_cast<uint32_t>(i) & 0xF];
+      i >>= 4;
+    } while (i);
+  }
+  else if (base == 10) {
+    while (i > 0xFFFFFFFFU) {
+      uint32_t r = static_cast<uint32_t>(i % 100);
+      i /= 100;
+
+      p -= 2;
+      ::memcpy(p, StringBuilder_digitPairs + r * 2, 2);
+    }
+
+    uint32_t x = static_cast<uint32_t>(i);
+    while (x >= 100) {
+      uint32_t r = x % 100;
+      x /= 100;
+
+      p -= 2;
+      ::memcpy(p, StringBuilder_digitPairs + r * 2, 2);
+    }
+
+    if (x >= 10) {
+      p -= 2;
+      ::memcpy(p, StringBuilder_digitPairs + x * 2, 2);
+    }
+    else {
+      *--p = static_cast<char>('0' + x);
+    }
+  }
+  else {
+    do {
+      uint64_t d = i / base;
+      uint64_t r = i % base;
 
-    *--p = StringBuilder_numbers[r];
-    i = d;
-  } while (i);
+      *--p = StringBuilder_numbers[r];
+      i = d;
+    } while (i);
+  }
 
   size_t numberLength = (size_t)(buf + ASMJIT_ARRAY_SIZE(buf) - p);
 
@@ -347,6 +389,49 @@ bool StringBuilder::eq(const char* str, size_t len) const noexcept {
   }
 }
 
+// ============================================================================
+// [asmjit::StringBuilder - Test]
+// ============================================================================
+
+#if defined(ASMJIT_TEST)
+UNIT(base_string) {
+  StringBuilder sb;
+
+  INFO("Checking number formatting");
+  static const uint64_t values[] = {
+    0, 7, 10, 99, 100, 12345, 4294967295U, ASMJIT_UINT64_C(4294967296),
+    ASMJIT_UINT64_C(18446744073709551615)
+  };
+
+  for (uint32_t i = 0; i < ASMJIT_ARRAY_SIZE(values); i++) {
+    char expected[64];
+    uint64_t v = values[i];
+
+    sb.clear();
+    sb.appendUInt(v);
+    snprintf(expected, ASMJIT_ARRAY_SIZE(expected), "%llu", static_cast<unsigned long long>(v));
+    EXPECT(sb.eq(expected), "appendUInt(%s) returned '%s'", expected, sb.getData());
+
+    sb.clear();
+    sb.appendUInt(v, 16);
+    snprintf(expected, ASMJIT_ARRAY_SIZE(expected), "%llX", static_cast<unsigned long long>(v));
+    EXPECT(sb.eq(expected), "appendUInt(%s, 16) returned '%s'", expected, sb.getData());
+  }
+
+  sb.clear();
+  sb.appendInt(-1234567);
+  EXPECT(sb.eq("-1234567"));
+
+  sb.clear();
+  sb.appendUInt(42, 10, 4);
+  EXPECT(sb.eq("0042"));
+
+  sb.clear();
+  sb.appendUInt(255, 2);
+  EXPECT(sb.eq("11111111"));
+}
+#endif // ASMJIT_TEST
+
 } // asmjit namespace
 
 // [Api-End]
@@ -0,0 +1,85 @@
+// [AsmJit]
+// Complete x86/x64 JIT and Remote Assembler for C++.
+//
+// [License]
+// Zlib - See LICENSE.md file in the package.
+
+// [Export]
+#define ASMJIT_EXPORTS
+
+// [Dependencies]
+#include "../base/inst.h"
+#include "../base/logging.h"
+#include "../base/tracing.h"
+#include "../base/utils.h"
+
+// [Api-Begin]
+#include "../asmjit_apibegin.h"
+
+namespace asmjit {
+
+// ============================================================================
+// [asmjit::TraceBuffer - Construction / Destruction]
+// ============================================================================
+
+TraceBuffer::TraceBuffer(size_t capacity) noexcept
+  : _records(nullptr),
+    _capacity(0),
+    _total(0) {
+
+  if (capacity) {
+    capacity = Utils::alignToPowerOf2<size_t>(capacity);
+    _records = static_cast<TraceRecord*>(Internal::allocMemory(capacity * sizeof(TraceRecord)));
+    if (_records) _capacity = capacity;
+  }
+}
+
+TraceBuffer::~TraceBuffer() noexcept {
+  if (_records)
+    Internal::releaseMemory(_records);
+}
+
+// ============================================================================
+// [asmjit::TraceBuffer - Accessors]
+// ============================================================================
+
+size_t TraceBuffer::copyTo(TraceRecord* dst, size_t count) const noexcept {
+  size_t kept = getCount();
+  if (count > kept)
+    count = kept;
+
+  for (size_t i = 0; i < count; i++)
+    dst[i] = getRecord(kept - count + i);
+  return count;
+}
+
+// ============================================================================
+// [asmjit::TraceBuffer - Format]
+// ============================================================================
+
+#if !defined(ASMJIT_DISABLE_LOGGING)
+Error TraceBuffer::format(StringBuilder& sb, uint32_t logOptions, const CodeEmitter* emitter) const noexcept {
+  for (size_t i = 0, count = getCount(); i < count; i++) {
+    ASMJIT_PROPAGATE(formatRecord(sb, logOptions, emitter, getRecord(i)));
+    ASMJIT_PROPAGATE(sb.appendChar('\n'));
+  }
+  return kErrorOk;
+}
+
+Error TraceBuffer::formatRecord(StringBuilder& sb, uint32_t logOptions, const CodeEmitter* emitter, const TraceRecord& record) noexcept {
+  ASMJIT_PROPAGATE(sb.appendFormat("%u:%08X %2u  ",
+    static_cast<unsigned int>(record.sectionId),
+    static_cast<unsigned int>(record.offset),
+    static_cast<unsigned int>(record.size)));
+
+  return Logging::formatInstruction(
+    sb, logOptions,
+    emitter, record.archType,
+    Inst::Detail(record.instId, record.options, record.extraReg), record.operands, TraceRecord::kMaxOpCount);
+}
+#endif // !ASMJIT_DISABLE_LOGGING
+
+} // asmjit namespace
+
+// [Api-End]
+#include "../asmjit_apiend.h"
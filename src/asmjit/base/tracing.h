@@ -0,0 +1,155 @@
+// [AsmJit]
+// Complete x86/x64 JIT and Remote Assembler for C++.
+//
+// [License]
+// Zlib - See LICENSE.md file in the package.
+
+// [Guard]
+#ifndef _ASMJIT_BASE_TRACING_H
+#define _ASMJIT_BASE_TRACING_H
+
+// [Dependencies]
+#include "../base/operand.h"
+#include "../base/string.h"
+
+// [Api-Begin]
+#include "../asmjit_apibegin.h"
+
+namespace asmjit {
+
+//! \addtogroup asmjit_base
+//! \{
+
+// ============================================================================
+// [Forward Declarations]
+// ============================================================================
+
+class CodeEmitter;
+
+// ============================================================================
+// [asmjit::TraceRecord]
+// ============================================================================
+
+//! Binary record of a single emitted instruction, see \ref TraceBuffer.
+//!
+//! The record is a plain structure that can be copied or written to a file
+//! as is and formatted later by \ref TraceBuffer::formatRecord().
+struct TraceRecord {
+  enum {
+    //! Maximum count of operands of a record.
+    kMaxOpCount = 6
+  };
+
+  uint32_t instId;                       //!< Instruction id.
+  uint32_t options;                      //!< Instruction options.
+  uint32_t offset;                       //!< Offset of the instruction in its section.
+  uint16_t sectionId;                    //!< Section id.
+  uint8_t size;                          //!< Size of the encoded instruction.
+  uint8_t archType;                      //!< Architecture type, see \ref ArchInfo::Type.
+  RegOnly extraReg;                      //!< Extra register (AVX-512 mask or REP counter).
+  Operand_ operands[kMaxOpCount];        //!< Operands (unused operands are none).
+};
+
+// ============================================================================
+// [asmjit::TraceBuffer]
+// ============================================================================
+
+//! Binary trace of emitted instructions.
+//!
+//! When attached to \ref CodeHolder by `CodeHolder::setTraceBuffer()` the
+//! \ref Assembler stores a \ref TraceRecord of each emitted instruction into
+//! the buffer - raw operands, options, and offsets, nothing is formatted. The
+//! buffer is allocated once by the constructor and keeps the most recent
+//! `getCapacity()` records, so it can stay attached in production. Records
+//! are formatted into text offline by \ref format() (requires logging).
+//!
+//! The buffer is not thread-safe, use one per thread. It can be attached to
+//! any number of `CodeHolder`s used by that thread.
+class TraceBuffer {
+public:
+  ASMJIT_NONCOPYABLE(TraceBuffer)
+
+  enum {
+    //! Default capacity of the buffer, in records.
+    kDefaultCapacity = 4096
+  };
+
+  // --------------------------------------------------------------------------
+  // [Construction / Destruction]
+  // --------------------------------------------------------------------------
+
+  //! Create a new `TraceBuffer` that keeps the last `capacity` records (the
+  //! capacity is rounded up to a power of 2).
+  ASMJIT_API TraceBuffer(size_t capacity = kDefaultCapacity) noexcept;
+  //! Destroy the `TraceBuffer`.
+  ASMJIT_API ~TraceBuffer() noexcept;
+
+  // --------------------------------------------------------------------------
+  // [Accessors]
+  // --------------------------------------------------------------------------
+
+  //! Get the capacity of the buffer in records (zero if it couldn't be allocated).
+  ASMJIT_INLINE size_t getCapacity() const noexcept { return _capacity; }
+  //! Get the count of kept records.
+  ASMJIT_INLINE size_t getCount() const noexcept { return _total < _capacity ? static_cast<size_t>(_total) : _capacity; }
+  //! Get the count of all records added since the last `clear()`.
+  ASMJIT_INLINE uint64_t getTotalCount() const noexcept { return _total; }
+
+  //! Get the kept record at `index`, records are ordered from the oldest.
+  ASMJIT_INLINE const TraceRecord& getRecord(size_t index) const noexcept {
+    ASMJIT_ASSERT(index < getCount());
+    return _records[static_cast<size_t>(_total - getCount() + index) & (_capacity - 1)];
+  }
+
+  //! Clear the buffer.
+  ASMJIT_INLINE void clear() noexcept { _total = 0; }
+
+  //! Copy up to `count` newest records (oldest first) to `dst` and return the
+  //! count of records copied.
+  ASMJIT_API size_t copyTo(TraceRecord* dst, size_t count) const noexcept;
+
+  // --------------------------------------------------------------------------
+  // [Add]
+  // --------------------------------------------------------------------------
+
+  //! Get a record to be filled, overwrites the oldest one if the buffer is
+  //! full. Returns null if the buffer has no capacity.
+  ASMJIT_INLINE TraceRecord* _newRecord() noexcept {
+    if (ASMJIT_UNLIKELY(!_capacity))
+      return nullptr;
+    return &_records[static_cast<size_t>(_total++) & (_capacity - 1)];
+  }
+
+  // --------------------------------------------------------------------------
+  // [Format]
+  // --------------------------------------------------------------------------
+
+#if !defined(ASMJIT_DISABLE_LOGGING)
+  //! Format all kept records, one instruction per line.
+  //!
+  //! Label names are resolved by `emitter` if given, otherwise labels are
+  //! formatted by their ids.
+  ASMJIT_API Error format(StringBuilder& sb, uint32_t logOptions = 0, const CodeEmitter* emitter = nullptr) const noexcept;
+
+  //! Format a single `record` (without a new line), see \ref format().
+  static ASMJIT_API Error formatRecord(StringBuilder& sb, uint32_t logOptions, const CodeEmitter* emitter, const TraceRecord& record) noexcept;
+#endif // !ASMJIT_DISABLE_LOGGING
+
+  // --------------------------------------------------------------------------
+  // [Members]
+  // --------------------------------------------------------------------------
+
+  TraceRecord* _records;                 //!< Records.
+  size_t _capacity;                      //!< Capacity of `_records` (power of 2).
+  uint64_t _total;                       //!< Count of records added since the last `clear()`.
+};
+
+//! \}
+
+} // asmjit namespace
+
+// [Api-End]
+#include "../asmjit_apiend.h"
+
+// [Guard]
+#endif // _ASMJIT_BASE_TRACING_H
@@ -244,6 +244,17 @@ namespace Utils {
       return sizeof(T) <= 2 || UnsignedType(x) <= UnsignedType(2147483647U);
   }
 
+  //! Get whether the given integer `x` can be casted to an `N`-bit signed integer (ARM specific).
+  template<uint32_t N, typename T>
+  static ASMJIT_INLINE bool isIntN(T x) noexcept {
+    typedef typename IntTraits<T>::UnsignedType UnsignedType;
+
+    if (IntTraits<T>::kIsSigned)
+      return inInterval<int64_t>(int64_t(x), -(int64_t(1) << (N - 1)), (int64_t(1) << (N - 1)) - 1);
+    else
+      return uint64_t(UnsignedType(x)) <= (uint64_t(1) << (N - 1)) - 1;
+  }
+
   //! Get whether the given integer `x` can be casted to a 4-bit unsigned integer.
   template<typename T>
   static ASMJIT_INLINE bool isUInt4(T x) noexcept {
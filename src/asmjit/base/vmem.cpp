@@ -51,6 +51,12 @@
 //
 // These bits show that there are 12 allocated blocks (X) of 64 bytes, so total
 // size allocated is 768 bytes. Maximum count of continuous memory is 12 * 64.
+//
+// Small allocations (up to 256 bytes, which is the size of most JIT'd stubs)
+// bypass nodes and bit arrays completely. They are served by slab pages of
+// 4kB, each page serves a single size-class (32, 64, 128 or 256 bytes) and
+// keeps a small bit-set of free slots. Slab pages are found by address through
+// a hash table, so both alloc and release of small functions are O(1).
 
 namespace asmjit {
 
@@ -101,6 +107,8 @@ static void _SetBits(size_t* buf, size_t index, size_t len) noexcept {
 typedef VMemMgr::RbNode RbNode;
 typedef VMemMgr::MemNode MemNode;
 typedef VMemMgr::PermanentNode PermanentNode;
+typedef VMemMgr::SlabPage SlabPage;
+typedef VMemMgr::SlabRegion SlabRegion;
 
 // ============================================================================
 // [asmjit::VMemMgr::RbNode]
@@ -193,6 +201,8 @@ struct VMemMgr::MemNode : public RbNode {
 
     baUsed = other->baUsed;
     baCont = other->baCont;
+    rwDelta = other->rwDelta;
+    pageType = other->pageType;
   }
 
   // Get available space.
@@ -209,6 +219,8 @@ struct VMemMgr::MemNode : public RbNode {
 
   size_t* baUsed;        // Contains bits about used blocks       (0 = unused, 1 = used).
   size_t* baCont;        // Contains bits about continuous blocks (0 = stop  , 1 = continue).
+  intptr_t rwDelta;      // Difference between RW and RX views (dual mapping).
+  uint32_t pageType;     // Pages that back the virtual memory (`OSUtils::VMPageType`).
 };
 
 // ============================================================================
@@ -224,30 +236,119 @@ struct VMemMgr::PermanentNode {
 
   PermanentNode* prev;   // Pointer to prev chunk or nullptr.
   uint8_t* mem;          // Base pointer (virtual memory address).
+  intptr_t rwDelta;      // Difference between RW and RX views (dual mapping).
   size_t size;           // Count of bytes allocated.
   size_t used;           // Count of bytes used.
+  uint32_t pageType;     // Pages that back the virtual memory (`OSUtils::VMPageType`).
+};
+
+// ============================================================================
+// [asmjit::VMemMgr::SlabPage / SlabRegion]
+// ============================================================================
+
+//! \internal
+enum {
+  kSlabMaxSlots = VMemMgr::kSlabPageSize / VMemMgr::kSlabMinSize,
+  kSlabBitWords = kSlabMaxSlots / 32
+};
+
+//! \internal
+//!
+//! Slab page - `kSlabPageSize` bytes of virtual memory split into slots of
+//! the same size-class. Like `MemNode` it's kept outside of the virtual memory.
+struct VMemMgr::SlabPage {
+  SlabPage* prev;        // Prev page in a partial or free list.
+  SlabPage* next;        // Next page in a partial or free list.
+  SlabRegion* region;    // Region this page belongs to.
+  uint8_t* mem;          // Virtual memory address.
+
+  uint32_t classId;      // Size-class of this page or `kInvalidValue` if free.
+  uint32_t slotSize;     // Size of a slot.
+  uint32_t slotCount;    // Count of slots.
+  uint32_t usedCount;    // Count of used slots.
+  uint32_t bits[kSlabBitWords]; // Free slots (1 = free, 0 = used).
+};
+
+//! \internal
+//!
+//! Slab region - a single virtual memory allocation split into slab pages.
+struct VMemMgr::SlabRegion {
+  SlabRegion* prev;      // Prev region.
+  SlabRegion* next;      // Next region.
+  uint8_t* mem;          // Virtual memory address.
+  intptr_t rwDelta;      // Difference between RW and RX views (dual mapping).
+  size_t size;           // Size of the virtual memory.
+  uint32_t pageType;     // Pages that back the virtual memory (`OSUtils::VMPageType`).
+  uint32_t pageCount;    // Count of pages.
+  uint32_t usedPages;    // Count of pages used by a size-class.
+  SlabPage pages[1];     // Pages (variable length).
 };
 
 // ============================================================================
 // [asmjit::VMemMgr - Private]
 // ============================================================================
 
+//! \internal
+//!
+//! Scoped lock that records lock statistics of `VMemMgr`. The lock is tried
+//! first, so the uncontended path costs the same as `AutoLock`.
+struct VMemMgrAutoLock {
+  ASMJIT_NONCOPYABLE(VMemMgrAutoLock)
+
+  ASMJIT_INLINE VMemMgrAutoLock(VMemMgr* self) noexcept : _self(self) {
+    if (ASMJIT_UNLIKELY(!self->_lock.tryLock())) {
+      uint64_t startTime = OSUtils::getHighResTime();
+      self->_lock.lock();
+      self->_lockContendedCount++;
+      self->_lockWaitTime += OSUtils::getHighResTime() - startTime;
+    }
+    self->_lockCount++;
+  }
+  ASMJIT_INLINE ~VMemMgrAutoLock() noexcept { _self->_lock.unlock(); }
+
+  VMemMgr* _self;
+};
+
 //! \internal
 //!
 //! Helper to avoid `#ifdef`s in the code.
-ASMJIT_INLINE uint8_t* vMemMgrAllocVMem(VMemMgr* self, size_t size, size_t* vSize) noexcept {
+//!
+//! Stores the difference between the writable and executable view of the
+//! allocated memory into `rwDelta` (zero if dual mapping is not enabled) and
+//! the pages that back it into `pageType`.
+ASMJIT_INLINE uint8_t* vMemMgrAllocVMem(VMemMgr* self, size_t size, size_t* vSize, intptr_t* rwDelta, uint32_t* pageType) noexcept {
+  *rwDelta = 0;
+  *pageType = OSUtils::kVMPageRegular;
+
+  if (self->_dualMapping) {
+    void* rx;
+    void* rw;
+
+    if (OSUtils::allocDualMapping(size, vSize, &rx, &rw, self->_rangeLo, self->_rangeHi) != kErrorOk)
+      return nullptr;
+
+    *rwDelta = (intptr_t)((uintptr_t)rw - (uintptr_t)rx);
+    return static_cast<uint8_t*>(rx);
+  }
+
   uint32_t flags = OSUtils::kVMWritable | OSUtils::kVMExecutable;
+  if (self->_largePages)
+    flags |= OSUtils::kVMLargePages;
+
 #if !ASMJIT_OS_WINDOWS
-  return static_cast<uint8_t*>(OSUtils::allocVirtualMemory(size, vSize, flags));
+  return static_cast<uint8_t*>(OSUtils::allocVirtualMemory(size, vSize, flags, self->_rangeLo, self->_rangeHi, pageType));
 #else
-  return static_cast<uint8_t*>(OSUtils::allocProcessMemory(self->_hProcess, size, vSize, flags));
+  return static_cast<uint8_t*>(OSUtils::allocProcessMemory(self->_hProcess, size, vSize, flags, self->_rangeLo, self->_rangeHi, pageType));
 #endif
 }
 
 //! \internal
 //!
 //! Helper to avoid `#ifdef`s in the code.
-ASMJIT_INLINE Error vMemMgrReleaseVMem(VMemMgr* self, void* p, size_t vSize) noexcept {
+ASMJIT_INLINE Error vMemMgrReleaseVMem(VMemMgr* self, void* p, size_t vSize, intptr_t rwDelta) noexcept {
+  if (self->_dualMapping)
+    return OSUtils::releaseDualMapping(p, static_cast<uint8_t*>(p) + rwDelta, vSize);
+
 #if !ASMJIT_OS_WINDOWS
   return OSUtils::releaseVirtualMemory(p, vSize);
 #else
@@ -269,7 +370,10 @@ static bool vMemMgrCheckTree(VMemMgr* self) noexcept {
 //! Returns set-up `MemNode*` or nullptr if allocation failed.
 static MemNode* vMemMgrCreateNode(VMemMgr* self, size_t size, size_t density) noexcept {
   size_t vSize;
-  uint8_t* vmem = vMemMgrAllocVMem(self, size, &vSize);
+  intptr_t rwDelta;
+  uint32_t pageType;
+
+  uint8_t* vmem = vMemMgrAllocVMem(self, size, &vSize, &rwDelta, &pageType);
   if (!vmem) return nullptr;
 
   size_t blocks = (vSize / density);
@@ -280,7 +384,7 @@ static MemNode* vMemMgrCreateNode(VMemMgr* self, size_t size, size_t density) no
 
   // Out of memory.
   if (!node || !data) {
-    vMemMgrReleaseVMem(self, vmem, vSize);
+    vMemMgrReleaseVMem(self, vmem, vSize, rwDelta);
     if (node) Internal::releaseMemory(node);
     if (data) Internal::releaseMemory(data);
     return nullptr;
@@ -305,6 +409,8 @@ static MemNode* vMemMgrCreateNode(VMemMgr* self, size_t size, size_t density) no
   ::memset(data, 0, bsize * 2);
   node->baUsed = reinterpret_cast<size_t*>(data);
   node->baCont = reinterpret_cast<size_t*>(data + bsize);
+  node->rwDelta = rwDelta;
+  node->pageType = pageType;
 
   return node;
 }
@@ -515,13 +621,13 @@ static MemNode* vMemMgrFindNodeByPtr(VMemMgr* self, uint8_t* mem) noexcept {
   return node;
 }
 
-static void* vMemMgrAllocPermanent(VMemMgr* self, size_t vSize) noexcept {
+static void* vMemMgrAllocPermanent(VMemMgr* self, size_t vSize, intptr_t* rwDelta) noexcept {
   static const size_t permanentAlignment = 32;
   static const size_t permanentNodeSize  = 32768;
 
   vSize = Utils::alignTo<size_t>(vSize, permanentAlignment);
 
-  AutoLock locked(self->_lock);
+  VMemMgrAutoLock locked(self);
   PermanentNode* node = self->_permanent;
 
   // Try to find space in allocated chunks.
@@ -536,7 +642,7 @@ static void* vMemMgrAllocPermanent(VMemMgr* self, size_t vSize) noexcept {
     node = static_cast<PermanentNode*>(Internal::allocMemory(sizeof(PermanentNode)));
     if (!node) return nullptr;
 
-    node->mem = vMemMgrAllocVMem(self, nodeSize, &node->size);
+    node->mem = vMemMgrAllocVMem(self, nodeSize, &node->size, &node->rwDelta, &node->pageType);
     if (!node->mem) {
       Internal::releaseMemory(node);
       return nullptr;
@@ -553,12 +659,351 @@ static void* vMemMgrAllocPermanent(VMemMgr* self, size_t vSize) noexcept {
   // Update Statistics.
   node->used += vSize;
   self->_usedBytes += vSize;
+  self->_allocCount++;
 
-  // Code can be null to only reserve space for code.
+  *rwDelta = node->rwDelta;
   return static_cast<void*>(result);
 }
 
-static void* vMemMgrAllocFreeable(VMemMgr* self, size_t vSize) noexcept {
+// ============================================================================
+// [asmjit::VMemMgr - Slabs]
+// ============================================================================
+
+//! \internal
+//!
+//! Get the size-class of `size` (size must be non-zero and `<= kSlabMaxSize`).
+static ASMJIT_INLINE uint32_t vMemMgrSlabClassOf(size_t size) noexcept {
+  uint32_t classId = 0;
+  size_t classSize = VMemMgr::kSlabMinSize;
+
+  while (classSize < size) {
+    classSize <<= 1;
+    classId++;
+  }
+
+  return classId;
+}
+
+static ASMJIT_INLINE uint32_t vMemMgrSlabHashOf(const void* p) noexcept {
+  uintptr_t key = (uintptr_t)p / VMemMgr::kSlabPageSize;
+  return static_cast<uint32_t>(key * 2654435761U);
+}
+
+//! \internal
+//!
+//! Find a slab page that contains `p` (O(1) on average).
+static ASMJIT_INLINE SlabPage* vMemMgrSlabFind(VMemMgr* self, const void* p) noexcept {
+  if (!self->_slabHash)
+    return nullptr;
+
+  uint8_t* mem = (uint8_t*)((uintptr_t)p & ~(uintptr_t)(VMemMgr::kSlabPageSize - 1));
+  uint32_t mask = self->_slabHashMask;
+  uint32_t i = vMemMgrSlabHashOf(mem) & mask;
+
+  for (;;) {
+    SlabPage* page = self->_slabHash[i];
+    if (!page || page->mem == mem)
+      return page;
+    i = (i + 1) & mask;
+  }
+}
+
+static bool vMemMgrSlabHashInsert(VMemMgr* self, SlabPage* page) noexcept {
+  // Keep the load factor below 50%.
+  uint32_t capacity = self->_slabHash ? self->_slabHashMask + 1 : 0;
+  if ((self->_slabHashCount + 1) * 2 > capacity) {
+    uint32_t newCapacity = capacity ? capacity * 2 : 64;
+    SlabPage** newHash = static_cast<SlabPage**>(Internal::allocMemory(newCapacity * sizeof(SlabPage*)));
+
+    if (ASMJIT_UNLIKELY(!newHash))
+      return false;
+
+    ::memset(newHash, 0, newCapacity * sizeof(SlabPage*));
+    for (uint32_t i = 0; i < capacity; i++) {
+      SlabPage* other = self->_slabHash[i];
+      if (!other) continue;
+
+      uint32_t j = vMemMgrSlabHashOf(other->mem) & (newCapacity - 1);
+      while (newHash[j])
+        j = (j + 1) & (newCapacity - 1);
+      newHash[j] = other;
+    }
+
+    if (self->_slabHash)
+      Internal::releaseMemory(self->_slabHash);
+
+    self->_slabHash = newHash;
+    self->_slabHashMask = newCapacity - 1;
+  }
+
+  uint32_t mask = self->_slabHashMask;
+  uint32_t i = vMemMgrSlabHashOf(page->mem) & mask;
+
+  while (self->_slabHash[i])
+    i = (i + 1) & mask;
+
+  self->_slabHash[i] = page;
+  self->_slabHashCount++;
+  return true;
+}
+
+static void vMemMgrSlabHashRemove(VMemMgr* self, SlabPage* page) noexcept {
+  uint32_t mask = self->_slabHashMask;
+  uint32_t i = vMemMgrSlabHashOf(page->mem) & mask;
+
+  while (self->_slabHash[i] != page)
+    i = (i + 1) & mask;
+
+  // Backward-shift deletion, keeps the probe sequences valid without tombstones.
+  uint32_t j = i;
+  for (;;) {
+    self->_slabHash[i] = nullptr;
+
+    for (;;) {
+      j = (j + 1) & mask;
+
+      SlabPage* other = self->_slabHash[j];
+      if (!other) {
+        self->_slabHashCount--;
+        return;
+      }
+
+      uint32_t k = vMemMgrSlabHashOf(other->mem) & mask;
+      // Move `other` to `i` if its home slot `k` is not in the range (i, j].
+      if (i <= j ? (i < k && k <= j) : (i < k || k <= j))
+        continue;
+
+      self->_slabHash[i] = other;
+      i = j;
+      break;
+    }
+  }
+}
+
+static ASMJIT_INLINE void vMemMgrSlabLink(SlabPage** list, SlabPage* page) noexcept {
+  SlabPage* next = *list;
+
+  page->prev = nullptr;
+  page->next = next;
+
+  if (next) next->prev = page;
+  *list = page;
+}
+
+static ASMJIT_INLINE void vMemMgrSlabUnlink(SlabPage** list, SlabPage* page) noexcept {
+  SlabPage* prev = page->prev;
+  SlabPage* next = page->next;
+
+  if (prev)
+    prev->next = next;
+  else
+    *list = next;
+
+  if (next) next->prev = prev;
+
+  page->prev = nullptr;
+  page->next = nullptr;
+}
+
+//! \internal
+//!
+//! Release `region` and its virtual memory.
+static void vMemMgrSlabReleaseRegion(VMemMgr* self, SlabRegion* region, bool keepVirtualMemory) noexcept {
+  if (!keepVirtualMemory)
+    vMemMgrReleaseVMem(self, region->mem, region->size, region->rwDelta);
+
+  self->_allocatedBytes -= region->size;
+  Internal::releaseMemory(region);
+}
+
+//! \internal
+//!
+//! Create a new slab region and add all its pages to the free list.
+static bool vMemMgrSlabNewRegion(VMemMgr* self) noexcept {
+  size_t vSize;
+  intptr_t rwDelta;
+  uint32_t pageType;
+
+  uint8_t* vmem = vMemMgrAllocVMem(self, self->_blockSize, &vSize, &rwDelta, &pageType);
+  if (ASMJIT_UNLIKELY(!vmem))
+    return false;
+
+  uint32_t pageCount = static_cast<uint32_t>(vSize / VMemMgr::kSlabPageSize);
+  SlabRegion* region = static_cast<SlabRegion*>(
+    Internal::allocMemory(sizeof(SlabRegion) + (pageCount - 1) * sizeof(SlabPage)));
+
+  if (ASMJIT_UNLIKELY(!region)) {
+    vMemMgrReleaseVMem(self, vmem, vSize, rwDelta);
+    return false;
+  }
+
+  region->mem = vmem;
+  region->rwDelta = rwDelta;
+  region->size = vSize;
+  region->pageType = pageType;
+  region->pageCount = pageCount;
+  region->usedPages = 0;
+
+  uint32_t i;
+  for (i = 0; i < pageCount; i++) {
+    SlabPage* page = &region->pages[i];
+    page->region = region;
+    page->mem = vmem + i * VMemMgr::kSlabPageSize;
+    page->classId = kInvalidValue;
+
+    if (ASMJIT_UNLIKELY(!vMemMgrSlabHashInsert(self, page))) {
+      while (i)
+        vMemMgrSlabHashRemove(self, &region->pages[--i]);
+      vMemMgrReleaseVMem(self, vmem, vSize, rwDelta);
+      Internal::releaseMemory(region);
+      return false;
+    }
+  }
+
+  for (i = pageCount; i; i--)
+    vMemMgrSlabLink(&self->_slabFree, &region->pages[i - 1]);
+
+  region->prev = nullptr;
+  region->next = self->_slabRegions;
+  if (region->next) region->next->prev = region;
+  self->_slabRegions = region;
+
+  self->_allocatedBytes += vSize;
+  return true;
+}
+
+//! \internal
+//!
+//! Allocate a slot of `classId` size-class. Must be called with lock held.
+static void* vMemMgrSlabAlloc(VMemMgr* self, uint32_t classId, intptr_t* rwDelta) noexcept {
+  SlabPage* page = self->_slabPartial[classId];
+
+  if (!page) {
+    if (!self->_slabFree && !vMemMgrSlabNewRegion(self))
+      return nullptr;
+
+    // Assign a free page to the size-class.
+    page = self->_slabFree;
+    vMemMgrSlabUnlink(&self->_slabFree, page);
+
+    uint32_t slotSize = static_cast<uint32_t>(VMemMgr::kSlabMinSize) << classId;
+    uint32_t slotCount = VMemMgr::kSlabPageSize / slotSize;
+
+    page->classId = classId;
+    page->slotSize = slotSize;
+    page->slotCount = slotCount;
+    page->usedCount = 0;
+
+    for (uint32_t i = 0; i < kSlabBitWords; i++) {
+      uint32_t n = std::min<uint32_t>(slotCount - std::min<uint32_t>(slotCount, i * 32), 32);
+      page->bits[i] = n == 32 ? 0xFFFFFFFFU : (1U << n) - 1;
+    }
+
+    page->region->usedPages++;
+    vMemMgrSlabLink(&self->_slabPartial[classId], page);
+  }
+
+  uint32_t w = 0;
+  while (page->bits[w] == 0)
+    w++;
+
+  uint32_t bit = Utils::findFirstBit(page->bits[w]);
+  uint32_t slot = w * 32 + bit;
+
+  page->bits[w] &= ~(1U << bit);
+  if (++page->usedCount == page->slotCount)
+    vMemMgrSlabUnlink(&self->_slabPartial[classId], page);
+
+  self->_usedBytes += page->slotSize;
+
+  *rwDelta = page->region->rwDelta;
+  return page->mem + slot * page->slotSize;
+}
+
+//! \internal
+//!
+//! Release a slot `p` of a slab `page`. Must be called with lock held.
+static Error vMemMgrSlabRelease(VMemMgr* self, SlabPage* page, void* p) noexcept {
+  uint32_t classId = page->classId;
+  size_t offset = (size_t)(static_cast<uint8_t*>(p) - page->mem);
+
+  if (ASMJIT_UNLIKELY(classId == kInvalidValue || offset % page->slotSize != 0))
+    return DebugUtils::errored(kErrorInvalidArgument);
+
+  uint32_t slot = static_cast<uint32_t>(offset / page->slotSize);
+  uint32_t mask = 1U << (slot % 32);
+
+  if (ASMJIT_UNLIKELY(page->bits[slot / 32] & mask))
+    return DebugUtils::errored(kErrorInvalidArgument);
+
+  if (page->usedCount == page->slotCount)
+    vMemMgrSlabLink(&self->_slabPartial[classId], page);
+
+  page->bits[slot / 32] |= mask;
+  page->usedCount--;
+  self->_usedBytes -= page->slotSize;
+
+  if (page->usedCount == 0) {
+    // Return the page to the free list, it can be used by any size-class.
+    vMemMgrSlabUnlink(&self->_slabPartial[classId], page);
+    page->classId = kInvalidValue;
+    vMemMgrSlabLink(&self->_slabFree, page);
+
+    // Release the region if it's completely unused, but always keep at least
+    // one region to not thrash when a single stub is added and released.
+    SlabRegion* region = page->region;
+    if (--region->usedPages == 0 && (region->prev || region->next)) {
+      for (uint32_t i = 0; i < region->pageCount; i++) {
+        vMemMgrSlabUnlink(&self->_slabFree, &region->pages[i]);
+        vMemMgrSlabHashRemove(self, &region->pages[i]);
+      }
+
+      if (region->prev)
+        region->prev->next = region->next;
+      else
+        self->_slabRegions = region->next;
+
+      if (region->next)
+        region->next->prev = region->prev;
+
+      vMemMgrSlabReleaseRegion(self, region, false);
+    }
+  }
+
+  return kErrorOk;
+}
+
+//! \internal
+//!
+//! Release all slab regions.
+static void vMemMgrSlabReset(VMemMgr* self, bool keepVirtualMemory) noexcept {
+  SlabRegion* region = self->_slabRegions;
+
+  while (region) {
+    SlabRegion* next = region->next;
+    for (uint32_t i = 0; i < region->pageCount; i++) {
+      SlabPage* page = &region->pages[i];
+      if (page->classId != kInvalidValue)
+        self->_usedBytes -= page->usedCount * page->slotSize;
+    }
+    vMemMgrSlabReleaseRegion(self, region, keepVirtualMemory);
+    region = next;
+  }
+
+  if (self->_slabHash)
+    Internal::releaseMemory(self->_slabHash);
+
+  for (uint32_t i = 0; i < VMemMgr::kSlabClassCount; i++)
+    self->_slabPartial[i] = nullptr;
+
+  self->_slabFree = nullptr;
+  self->_slabRegions = nullptr;
+  self->_slabHash = nullptr;
+  self->_slabHashMask = 0;
+  self->_slabHashCount = 0;
+}
+
+static void* vMemMgrAllocFreeable(VMemMgr* self, size_t vSize, intptr_t* rwDelta) noexcept {
   // Current index.
   size_t i;
 
@@ -571,7 +1016,17 @@ static void* vMemMgrAllocFreeable(VMemMgr* self, size_t vSize) noexcept {
   if (vSize == 0)
     return nullptr;
 
-  AutoLock locked(self->_lock);
+  VMemMgrAutoLock locked(self);
+
+  // Small allocations are served by slabs, fallback to nodes on failure.
+  if (vSize <= VMemMgr::kSlabMaxSize) {
+    void* p = vMemMgrSlabAlloc(self, vMemMgrSlabClassOf(vSize), rwDelta);
+    if (p) {
+      self->_allocCount++;
+      return p;
+    }
+  }
+
   MemNode* node = self->_optimal;
   minVSize = self->_blockSize;
 
@@ -675,11 +1130,14 @@ L_Found:
     node->used += u;
     node->largestBlock = 0;
     self->_usedBytes += u;
+    self->_allocCount++;
   }
 
   // And return pointer to allocated memory.
   uint8_t* result = node->mem + i * node->density;
   ASMJIT_ASSERT(result >= node->mem && result <= node->mem + node->size - vSize);
+
+  *rwDelta = node->rwDelta;
   return result;
 }
 
@@ -689,13 +1147,15 @@ L_Found:
 //! virtual memory allocated unless `keepVirtualMemory` is true (and this is
 //! only used when writing data to a remote process).
 static void vMemMgrReset(VMemMgr* self, bool keepVirtualMemory) noexcept {
+  vMemMgrSlabReset(self, keepVirtualMemory);
+
   MemNode* node = self->_first;
 
   while (node) {
     MemNode* next = node->next;
 
     if (!keepVirtualMemory)
-      vMemMgrReleaseVMem(self, node->mem, node->size);
+      vMemMgrReleaseVMem(self, node->mem, node->size, node->rwDelta);
 
     Internal::releaseMemory(node->baUsed);
     Internal::releaseMemory(node);
@@ -734,6 +1194,13 @@ VMemMgr::VMemMgr(HANDLE hProcess) noexcept {
   _allocatedBytes = 0;
   _usedBytes = 0;
 
+  _allocCount = 0;
+  _releaseCount = 0;
+
+  _lockCount = 0;
+  _lockContendedCount = 0;
+  _lockWaitTime = 0;
+
   _root = nullptr;
   _first = nullptr;
   _last = nullptr;
@@ -741,6 +1208,19 @@ VMemMgr::VMemMgr(HANDLE hProcess) noexcept {
 
   _permanent = nullptr;
   _keepVirtualMemory = false;
+  _dualMapping = false;
+  _largePages = false;
+  _rangeLo = 0;
+  _rangeHi = 0;
+
+  for (uint32_t i = 0; i < kSlabClassCount; i++)
+    _slabPartial[i] = nullptr;
+
+  _slabFree = nullptr;
+  _slabRegions = nullptr;
+  _slabHash = nullptr;
+  _slabHashMask = 0;
+  _slabHashCount = 0;
 }
 
 VMemMgr::~VMemMgr() noexcept {
@@ -764,22 +1244,228 @@ void VMemMgr::reset() noexcept {
   vMemMgrReset(this, false);
 }
 
+// ============================================================================
+// [asmjit::VMemMgr - Lock Statistics]
+// ============================================================================
+
+void VMemMgr::resetLockStats() noexcept {
+  AutoLock locked(_lock);
+
+  _lockCount = 0;
+  _lockContendedCount = 0;
+  _lockWaitTime = 0;
+}
+
+// ============================================================================
+// [asmjit::VMemMgr - Statistics]
+// ============================================================================
+
+//! \internal
+//!
+//! Get the largest count of contiguous unused blocks of `node`.
+static size_t vMemMgrGetLargestFreeRun(const VMemMgr::MemNode* node) noexcept {
+  size_t blocks = node->blocks;
+  size_t cont = 0;
+  size_t maxCont = 0;
+
+  for (size_t i = 0; i < blocks; i += kBitsPerEntity) {
+    size_t ubits = node->baUsed[i / kBitsPerEntity];
+    size_t max = std::min<size_t>(kBitsPerEntity, blocks - i);
+
+    // Fast path for completely used or unused words.
+    if (ubits == ~(size_t)0) {
+      maxCont = std::max<size_t>(maxCont, cont);
+      cont = 0;
+      continue;
+    }
+
+    if (ubits == 0) {
+      cont += max;
+      continue;
+    }
+
+    for (size_t j = 0; j < max; j++) {
+      if (ubits & ((size_t)1 << j)) {
+        maxCont = std::max<size_t>(maxCont, cont);
+        cont = 0;
+      }
+      else {
+        cont++;
+      }
+    }
+  }
+
+  return std::max<size_t>(maxCont, cont);
+}
+
+VMemStats VMemMgr::getStats() const noexcept {
+  AutoLock locked(const_cast<Lock&>(_lock));
+
+  VMemStats stats;
+  stats.reset();
+  stats.time = OSUtils::getHighResTime();
+
+  stats.allocatedBytes = _allocatedBytes;
+  stats.usedBytes = _usedBytes;
+
+  for (MemNode* node = _first; node; node = node->next) {
+    stats.chunkCount++;
+    stats.chunkBytes += node->size;
+    stats.chunkUsedBytes += node->used;
+    stats.pageBytes[node->pageType] += node->size;
+    stats.largestFreeRun = std::max<size_t>(stats.largestFreeRun, vMemMgrGetLargestFreeRun(node) * node->density);
+
+    size_t bucket = static_cast<size_t>((static_cast<uint64_t>(node->used) * VMemStats::kOccupancyBucketCount) / node->size);
+    stats.chunkOccupancy[std::min<size_t>(bucket, VMemStats::kOccupancyBucketCount - 1)]++;
+  }
+
+  for (SlabRegion* region = _slabRegions; region; region = region->next) {
+    stats.slabRegionCount++;
+    stats.slabBytes += region->size;
+    stats.pageBytes[region->pageType] += region->size;
+
+    for (uint32_t i = 0; i < region->pageCount; i++) {
+      const SlabPage& page = region->pages[i];
+      if (page.classId != kInvalidValue)
+        stats.slabUsedBytes += static_cast<size_t>(page.usedCount) * page.slotSize;
+    }
+  }
+
+  for (PermanentNode* node = _permanent; node; node = node->prev) {
+    stats.permanentChunkCount++;
+    stats.permanentBytes += node->size;
+    stats.permanentUsedBytes += node->used;
+    stats.pageBytes[node->pageType] += node->size;
+  }
+
+  stats.allocCount = _allocCount;
+  stats.releaseCount = _releaseCount;
+
+  stats.lockCount = _lockCount;
+  stats.lockContendedCount = _lockContendedCount;
+  stats.lockWaitTime = _lockWaitTime;
+  return stats;
+}
+
+// ============================================================================
+// [asmjit::VMemMgr - Dual Mapping]
+// ============================================================================
+
+Error VMemMgr::setDualMapping(bool val) noexcept {
+  AutoLock locked(_lock);
+
+  if (_dualMapping == val)
+    return kErrorOk;
+
+  if (_first || _permanent || _slabRegions)
+    return DebugUtils::errored(kErrorInvalidState);
+
+#if ASMJIT_OS_WINDOWS
+  if (val && _hProcess != OSUtils::getVirtualMemoryInfo().hCurrentProcess)
+    return DebugUtils::errored(kErrorInvalidArgument);
+#endif // ASMJIT_OS_WINDOWS
+
+  _dualMapping = val;
+  return kErrorOk;
+}
+
+// ============================================================================
+// [asmjit::VMemMgr - Address Range]
+// ============================================================================
+
+Error VMemMgr::setAddressRange(uint64_t lo, uint64_t hi) noexcept {
+  AutoLock locked(_lock);
+
+  if (_first || _permanent || _slabRegions)
+    return DebugUtils::errored(kErrorInvalidState);
+
+  if (hi && hi <= lo)
+    return DebugUtils::errored(kErrorInvalidArgument);
+
+  _rangeLo = hi ? lo : 0;
+  _rangeHi = hi;
+  return kErrorOk;
+}
+
+Error VMemMgr::setNearAddress(const void* p, size_t distance) noexcept {
+#if ASMJIT_ARCH_64BIT
+  uint64_t addr = static_cast<uint64_t>((uintptr_t)p);
+  uint64_t lo = addr > distance ? addr - distance : 0;
+  uint64_t hi = addr + distance;
+
+  // Don't wrap around the address space.
+  if (hi < addr) hi = ~static_cast<uint64_t>(0);
+  return setAddressRange(lo, hi);
+#else
+  // Every address is within the range of 32-bit displacement.
+  ASMJIT_UNUSED(p);
+  ASMJIT_UNUSED(distance);
+  return kErrorOk;
+#endif
+}
+
+// ============================================================================
+// [asmjit::VMemMgr - Large Pages]
+// ============================================================================
+
+Error VMemMgr::setLargePages(bool val) noexcept {
+  AutoLock locked(_lock);
+
+  if (_largePages == val)
+    return kErrorOk;
+
+  if (_first || _permanent || _slabRegions)
+    return DebugUtils::errored(kErrorInvalidState);
+
+  VMemInfo vm = OSUtils::getVirtualMemoryInfo();
+  if (val && !vm.largePageSize)
+    return DebugUtils::errored(kErrorFeatureNotEnabled);
+
+  _largePages = val;
+  _blockSize = val ? std::max<size_t>(vm.largePageSize, vm.pageGranularity) : vm.pageGranularity;
+  return kErrorOk;
+}
+
 // ============================================================================
 // [asmjit::VMemMgr - Alloc / Release]
 // ============================================================================
 
 void* VMemMgr::alloc(size_t size, uint32_t type) noexcept {
+  intptr_t rwDelta;
   if (type == kAllocPermanent)
-    return vMemMgrAllocPermanent(this, size);
+    return vMemMgrAllocPermanent(this, size, &rwDelta);
   else
-    return vMemMgrAllocFreeable(this, size);
+    return vMemMgrAllocFreeable(this, size, &rwDelta);
 }
 
-Error VMemMgr::release(void* p) noexcept {
-  if (!p) return kErrorOk;
+Error VMemMgr::allocDual(void** rx, void** rw, size_t size, uint32_t type) noexcept {
+  intptr_t rwDelta;
+  void* p = (type == kAllocPermanent) ? vMemMgrAllocPermanent(this, size, &rwDelta)
+                                      : vMemMgrAllocFreeable(this, size, &rwDelta);
 
-  AutoLock locked(_lock);
-  MemNode* node = vMemMgrFindNodeByPtr(this, static_cast<uint8_t*>(p));
+  if (ASMJIT_UNLIKELY(!p)) {
+    *rx = nullptr;
+    *rw = nullptr;
+    return DebugUtils::errored(kErrorNoVirtualMemory);
+  }
+
+  *rx = p;
+  *rw = static_cast<uint8_t*>(p) + rwDelta;
+  return kErrorOk;
+}
+
+//! \internal
+//!
+//! Release `p`, the lock must be held by the caller.
+static Error vMemMgrReleaseLocked(VMemMgr* self, void* p) noexcept {
+  SlabPage* page = vMemMgrSlabFind(self, p);
+  if (page) {
+    Error err = vMemMgrSlabRelease(self, page, p);
+    if (!err) self->_releaseCount++;
+    return err;
+  }
+
+  MemNode* node = vMemMgrFindNodeByPtr(self, static_cast<uint8_t*>(p));
   if (!node) return DebugUtils::errored(kErrorInvalidArgument);
 
   size_t offset = (size_t)((uint8_t*)p - (uint8_t*)node->mem);
@@ -818,12 +1504,12 @@ Error VMemMgr::release(void* p) noexcept {
   // If the freed block is fully allocated node then it's needed to
   // update 'optimal' pointer in memory manager.
   if (node->used == node->size) {
-    MemNode* cur = _optimal;
+    MemNode* cur = self->_optimal;
 
     do {
       cur = cur->prev;
       if (cur == node) {
-        _optimal = node;
+        self->_optimal = node;
         break;
       }
     } while (cur);
@@ -835,36 +1521,63 @@ Error VMemMgr::release(void* p) noexcept {
     node->largestBlock = cont;
 
   node->used -= cont;
-  _usedBytes -= cont;
+  self->_usedBytes -= cont;
+  self->_releaseCount++;
 
   // If page is empty, we can free it.
   if (node->used == 0) {
     // Free memory associated with node (this memory is not accessed
     // anymore so it's safe).
-    vMemMgrReleaseVMem(this, node->mem, node->size);
+    vMemMgrReleaseVMem(self, node->mem, node->size, node->rwDelta);
     Internal::releaseMemory(node->baUsed);
 
     node->baUsed = nullptr;
     node->baCont = nullptr;
 
     // Statistics.
-    _allocatedBytes -= node->size;
+    self->_allocatedBytes -= node->size;
 
     // Remove node. This function can return different node than
     // passed into, but data is copied into previous node if needed.
-    Internal::releaseMemory(vMemMgrRemoveNode(this, node));
-    ASMJIT_ASSERT(vMemMgrCheckTree(this));
+    Internal::releaseMemory(vMemMgrRemoveNode(self, node));
+    ASMJIT_ASSERT(vMemMgrCheckTree(self));
   }
 
   return kErrorOk;
 }
 
+Error VMemMgr::release(void* p) noexcept {
+  if (!p) return kErrorOk;
+
+  VMemMgrAutoLock locked(this);
+  return vMemMgrReleaseLocked(this, p);
+}
+
+Error VMemMgr::releaseMany(void* const* list, size_t count) noexcept {
+  Error err = kErrorOk;
+  if (!count) return err;
+
+  VMemMgrAutoLock locked(this);
+  for (size_t i = 0; i < count; i++) {
+    if (!list[i]) continue;
+
+    Error e = vMemMgrReleaseLocked(this, list[i]);
+    if (e && !err) err = e;
+  }
+  return err;
+}
+
 Error VMemMgr::shrink(void* p, size_t used) noexcept {
   if (!p) return kErrorOk;
   if (used == 0)
     return release(p);
 
-  AutoLock locked(_lock);
+  VMemMgrAutoLock locked(this);
+
+  // Slab slots have a fixed size, there is nothing to shrink.
+  if (vMemMgrSlabFind(this, p))
+    return kErrorOk;
+
   MemNode* node = vMemMgrFindNodeByPtr(this, (uint8_t*)p);
   if (!node) return DebugUtils::errored(kErrorInvalidArgument);
 
@@ -937,6 +1650,238 @@ _EnterFreeLoop:
   return kErrorOk;
 }
 
+// ============================================================================
+// [asmjit::VMemArena - Construction / Destruction]
+// ============================================================================
+
+VMemArena::VMemArena(VMemMgr* memMgr, size_t chunkSize) noexcept
+  : _memMgr(memMgr),
+    _current(nullptr),
+    _chunks(nullptr),
+    _chunkCount(0),
+    _chunkCapacity(0),
+    _chunkSize(Utils::alignTo<size_t>(chunkSize ? chunkSize : size_t(kDefaultChunkSize), kAllocAlignment)) {}
+
+VMemArena::~VMemArena() noexcept {
+  reset();
+  Internal::releaseMemory(_chunks);
+}
+
+// ============================================================================
+// [asmjit::VMemArena - Reset]
+// ============================================================================
+
+void VMemArena::reset() noexcept {
+  size_t count = _chunkCount;
+
+  for (size_t i = 0; i < count; i++) {
+    Chunk* chunk = _chunks[i];
+    _memMgr->release(chunk->mem);
+    Internal::releaseMemory(chunk);
+  }
+
+  _current = nullptr;
+  _chunkCount = 0;
+}
+
+// ============================================================================
+// [asmjit::VMemArena - Chunks]
+// ============================================================================
+
+//! \internal
+//!
+//! Get the index of the first chunk whose address is greater than `p`.
+static ASMJIT_INLINE size_t vMemArenaUpperBound(const VMemArena* self, const uint8_t* p) noexcept {
+  VMemArena::Chunk* const* chunks = self->_chunks;
+  size_t lo = 0;
+  size_t hi = self->_chunkCount;
+
+  while (lo < hi) {
+    size_t mid = (lo + hi) / 2;
+    if (chunks[mid]->mem <= p)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+
+  return lo;
+}
+
+//! \internal
+//!
+//! Find the chunk that contains `p` and its index in `_chunks`.
+static ASMJIT_INLINE VMemArena::Chunk* vMemArenaFindChunk(const VMemArena* self, const uint8_t* p, size_t* indexOut) noexcept {
+  size_t i = vMemArenaUpperBound(self, p);
+  if (i == 0)
+    return nullptr;
+
+  VMemArena::Chunk* chunk = self->_chunks[--i];
+  if (p >= chunk->mem + chunk->size)
+    return nullptr;
+
+  *indexOut = i;
+  return chunk;
+}
+
+//! \internal
+//!
+//! Insert `chunk` to `_chunks`, which is kept sorted by address.
+static Error vMemArenaInsertChunk(VMemArena* self, VMemArena::Chunk* chunk) noexcept {
+  if (self->_chunkCount == self->_chunkCapacity) {
+    size_t capacity = self->_chunkCapacity ? self->_chunkCapacity * 2 : size_t(16);
+    void* chunks = Internal::reallocMemory(self->_chunks, capacity * sizeof(VMemArena::Chunk*));
+
+    if (ASMJIT_UNLIKELY(!chunks))
+      return DebugUtils::errored(kErrorNoHeapMemory);
+
+    self->_chunks = static_cast<VMemArena::Chunk**>(chunks);
+    self->_chunkCapacity = capacity;
+  }
+
+  size_t i = vMemArenaUpperBound(self, chunk->mem);
+  ::memmove(self->_chunks + i + 1, self->_chunks + i, (self->_chunkCount - i) * sizeof(VMemArena::Chunk*));
+
+  self->_chunks[i] = chunk;
+  self->_chunkCount++;
+  return kErrorOk;
+}
+
+//! \internal
+//!
+//! Remove the chunk at `index` and release it back to `VMemMgr`.
+static void vMemArenaRemoveChunk(VMemArena* self, size_t index) noexcept {
+  VMemArena::Chunk* chunk = self->_chunks[index];
+  ::memmove(self->_chunks + index, self->_chunks + index + 1, (self->_chunkCount - index - 1) * sizeof(VMemArena::Chunk*));
+  self->_chunkCount--;
+
+  if (self->_current == chunk)
+    self->_current = nullptr;
+
+  self->_memMgr->release(chunk->mem);
+  Internal::releaseMemory(chunk);
+}
+
+// ============================================================================
+// [asmjit::VMemArena - Alloc / Release]
+// ============================================================================
+
+void* VMemArena::alloc(size_t size) noexcept {
+  void* rx;
+  void* rw;
+
+  allocDual(&rx, &rw, size);
+  return rx;
+}
+
+Error VMemArena::allocDual(void** rx, void** rw, size_t size) noexcept {
+  *rx = nullptr;
+  *rw = nullptr;
+
+  size = Utils::alignTo<size_t>(size, kAllocAlignment);
+  if (ASMJIT_UNLIKELY(size == 0))
+    return DebugUtils::errored(kErrorInvalidArgument);
+
+  // Large allocations go directly to `VMemMgr`.
+  if (size > _chunkSize / 2)
+    return _memMgr->allocDual(rx, rw, size);
+
+  Chunk* chunk = _current;
+  if (!chunk || chunk->size - chunk->offset < size) {
+    // Retire the current chunk if it's not used anymore, it would never be
+    // released otherwise as `release()` is the only place that frees chunks.
+    if (chunk && chunk->count == 0) {
+      size_t index = 0;
+      vMemArenaFindChunk(this, chunk->mem, &index);
+      vMemArenaRemoveChunk(this, index);
+    }
+
+    chunk = static_cast<Chunk*>(Internal::allocMemory(sizeof(Chunk)));
+    if (ASMJIT_UNLIKELY(!chunk))
+      return DebugUtils::errored(kErrorNoHeapMemory);
+
+    void* chunkRx;
+    void* chunkRw;
+
+    Error err = _memMgr->allocDual(&chunkRx, &chunkRw, _chunkSize);
+    if (ASMJIT_UNLIKELY(err)) {
+      Internal::releaseMemory(chunk);
+      return err;
+    }
+
+    chunk->mem = static_cast<uint8_t*>(chunkRx);
+    chunk->rwDelta = (intptr_t)((uintptr_t)chunkRw - (uintptr_t)chunkRx);
+    chunk->size = _chunkSize;
+    chunk->offset = 0;
+    chunk->lastOffset = 0;
+    chunk->count = 0;
+
+    err = vMemArenaInsertChunk(this, chunk);
+    if (ASMJIT_UNLIKELY(err)) {
+      _memMgr->release(chunkRx);
+      Internal::releaseMemory(chunk);
+      return err;
+    }
+
+    _current = chunk;
+  }
+
+  uint8_t* result = chunk->mem + chunk->offset;
+  chunk->lastOffset = chunk->offset;
+  chunk->offset += size;
+  chunk->count++;
+
+  *rx = result;
+  *rw = result + chunk->rwDelta;
+  return kErrorOk;
+}
+
+Error VMemArena::release(void* p) noexcept {
+  if (!p) return kErrorOk;
+
+  size_t index = 0;
+  Chunk* chunk = vMemArenaFindChunk(this, static_cast<uint8_t*>(p), &index);
+
+  if (!chunk)
+    return _memMgr->release(p);
+
+  if (ASMJIT_UNLIKELY(chunk->count == 0))
+    return DebugUtils::errored(kErrorInvalidArgument);
+
+  if (--chunk->count == 0) {
+    if (chunk == _current) {
+      // The current chunk is kept and reused from the beginning.
+      chunk->offset = 0;
+      chunk->lastOffset = 0;
+    }
+    else {
+      vMemArenaRemoveChunk(this, index);
+    }
+  }
+
+  return kErrorOk;
+}
+
+Error VMemArena::shrink(void* p, size_t used) noexcept {
+  if (!p) return kErrorOk;
+  if (used == 0)
+    return release(p);
+
+  size_t index = 0;
+  Chunk* chunk = vMemArenaFindChunk(this, static_cast<uint8_t*>(p), &index);
+
+  if (!chunk)
+    return _memMgr->shrink(p, used);
+
+  size_t offset = (size_t)(static_cast<uint8_t*>(p) - chunk->mem);
+  if (chunk == _current && offset == chunk->lastOffset) {
+    size_t end = offset + Utils::alignTo<size_t>(used, kAllocAlignment);
+    if (end < chunk->offset)
+      chunk->offset = end;
+  }
+
+  return kErrorOk;
+}
+
 // ============================================================================
 // [asmjit::VMem - Test]
 // ============================================================================
@@ -1072,6 +2017,340 @@ UNIT(base_vmem) {
   Internal::releaseMemory(a);
   Internal::releaseMemory(b);
 }
+UNIT(base_vmem_arena) {
+  VMemMgr memmgr;
+  VMemArena arena(&memmgr, 4096);
+
+  INFO("Arena alloc/shrink/release");
+  uint8_t* a = static_cast<uint8_t*>(arena.alloc(100));
+  uint8_t* b = static_cast<uint8_t*>(arena.alloc(200));
+
+  EXPECT(a != nullptr && b != nullptr,
+    "Couldn't allocate memory from VMemArena");
+  EXPECT(b == a + 128,
+    "VMemArena should allocate contiguously");
+
+  EXPECT(arena.shrink(b, 10) == kErrorOk,
+    "Failed to shrink %p", b);
+  uint8_t* c = static_cast<uint8_t*>(arena.alloc(64));
+  EXPECT(c == b + 64,
+    "VMemArena should reuse the shrunk tail");
+
+  EXPECT(memmgr.getUsedBytes() == 4096,
+    "VMemArena should use a single chunk");
+
+  uint8_t* big = static_cast<uint8_t*>(arena.alloc(8192));
+  EXPECT(big != nullptr,
+    "Couldn't allocate a large block from VMemArena");
+  EXPECT(arena.release(big) == kErrorOk,
+    "Failed to release a large block %p", big);
+
+  EXPECT(arena.release(a) == kErrorOk, "Failed to free %p", a);
+  EXPECT(arena.release(b) == kErrorOk, "Failed to free %p", b);
+  EXPECT(arena.release(c) == kErrorOk, "Failed to free %p", c);
+
+  EXPECT(arena.alloc(64) == a,
+    "VMemArena should reuse an empty chunk");
+
+  INFO("Arena chunk retirement");
+  for (int i = 0; i < 1000; i++) {
+    void* p = arena.alloc(static_cast<size_t>((i % 7) + 1) * 100);
+    EXPECT(p != nullptr,
+      "Couldn't allocate memory from VMemArena");
+    if (i & 1) arena.release(p);
+  }
+  VMemTest_stats(memmgr);
+
+  arena.reset();
+  EXPECT(memmgr.getUsedBytes() == 0,
+    "VMemArena::reset() should release all chunks");
+  EXPECT(arena.getChunkCount() == 0,
+    "VMemArena::reset() should release all chunks");
+
+  INFO("Arena release from many partially used chunks");
+  enum { kChunkCount = 64, kPerChunk = 4096 / 1024 };
+  void* ptrs[kChunkCount * kPerChunk];
+  uint32_t i;
+
+  for (i = 0; i < kChunkCount * kPerChunk; i++) {
+    ptrs[i] = arena.alloc(1024);
+    EXPECT(ptrs[i] != nullptr,
+      "Couldn't allocate memory from VMemArena");
+  }
+  EXPECT(arena.getChunkCount() == kChunkCount,
+    "VMemArena should use %u chunks, not %u", unsigned(kChunkCount), unsigned(arena.getChunkCount()));
+
+  // Release one allocation of each chunk first, then the rest in a shuffled
+  // order, each chunk must be returned once its last allocation is released.
+  for (i = 0; i < kChunkCount; i++)
+    EXPECT(arena.release(ptrs[i * kPerChunk]) == kErrorOk, "Failed to free %p", ptrs[i * kPerChunk]);
+  EXPECT(arena.getChunkCount() == kChunkCount);
+
+  for (i = 0; i < kChunkCount * kPerChunk; i++) {
+    uint32_t j = (i * 97) % (kChunkCount * kPerChunk);
+    if (j % kPerChunk == 0) continue;
+    EXPECT(arena.release(ptrs[j]) == kErrorOk, "Failed to free %p", ptrs[j]);
+  }
+
+  EXPECT(arena.getChunkCount() == 1,
+    "VMemArena should keep only the current chunk, not %u", unsigned(arena.getChunkCount()));
+  EXPECT(memmgr.getUsedBytes() == 4096);
+}
+UNIT(base_vmem_dual) {
+  VMemMgr memmgr;
+
+  INFO("Dual mapping (RX + RW views)");
+  EXPECT(memmgr.setDualMapping(true) == kErrorOk,
+    "Failed to enable dual mapping");
+
+  void* rx;
+  void* rw;
+
+  EXPECT(memmgr.allocDual(&rx, &rw, 1000) == kErrorOk,
+    "Couldn't allocate dual-mapped virtual memory");
+  EXPECT(rx != rw,
+    "Dual-mapped memory should have distinct RX and RW views");
+
+  ::memset(rw, 0xCC, 1000);
+  EXPECT(static_cast<uint8_t*>(rx)[999] == 0xCC,
+    "Data written through RW view should be visible through RX view");
+
+  EXPECT(memmgr.setDualMapping(false) == kErrorInvalidState,
+    "Dual mapping can't be changed after memory has been allocated");
+
+  EXPECT(memmgr.release(rx) == kErrorOk,
+    "Failed to free %p", rx);
+}
+UNIT(base_vmem_slab) {
+  VMemMgr memmgr;
+
+  INFO("Slab alloc/free test");
+  enum { kSlabCount = 10000 };
+
+  void** a = (void**)Internal::allocMemory(sizeof(void*) * kSlabCount);
+  EXPECT(a != nullptr,
+    "Couldn't allocate %u bytes on heap", kSlabCount * sizeof(void*));
+
+  size_t i;
+  size_t used = 0;
+
+  for (i = 0; i < kSlabCount; i++) {
+    size_t size = (i % VMemMgr::kSlabMaxSize) + 1;
+    size_t classSize = VMemMgr::kSlabMinSize;
+    while (classSize < size) classSize <<= 1;
+
+    a[i] = memmgr.alloc(size);
+    EXPECT(a[i] != nullptr,
+      "Couldn't allocate %u bytes of virtual memory", static_cast<unsigned int>(size));
+    EXPECT(Utils::isAligned<size_t>((size_t)a[i], classSize),
+      "Slab allocation %p is not aligned to its size-class %u", a[i], static_cast<unsigned int>(classSize));
+
+    ::memset(a[i], static_cast<int>(i & 0xFF), size);
+    used += classSize;
+  }
+
+  EXPECT(memmgr.getUsedBytes() == used,
+    "Used bytes (%u) don't match the sum of size-classes (%u)",
+    static_cast<unsigned int>(memmgr.getUsedBytes()), static_cast<unsigned int>(used));
+  VMemTest_stats(memmgr);
+
+  for (i = 0; i < kSlabCount; i += 2) {
+    EXPECT(memmgr.release(a[i]) == kErrorOk,
+      "Failed to free %p", a[i]);
+  }
+
+  for (i = 1; i < kSlabCount; i += 2) {
+    size_t size = (i % VMemMgr::kSlabMaxSize) + 1;
+    EXPECT(static_cast<uint8_t*>(a[i])[size - 1] == static_cast<uint8_t>(i & 0xFF),
+      "Pattern (%p) doesn't match", a[i]);
+    EXPECT(memmgr.release(a[i]) == kErrorOk,
+      "Failed to free %p", a[i]);
+  }
+
+  EXPECT(memmgr.getUsedBytes() == 0,
+    "All slab memory should be released");
+  VMemTest_stats(memmgr);
+
+  Internal::releaseMemory(a);
+}
+// Whether the system reserves explicit huge pages, assumed if it's unknown.
+static bool VMemTest_hasReservedHugePages() noexcept {
+#if ASMJIT_OS_LINUX
+  FILE* f = ::fopen("/proc/sys/vm/nr_hugepages", "r");
+  if (!f) return true;
+
+  unsigned long count = 1;
+  if (::fscanf(f, "%lu", &count) != 1)
+    count = 1;
+  ::fclose(f);
+  return count != 0;
+#else
+  return true;
+#endif
+}
+
+UNIT(base_vmem_largepages) {
+  VMemMgr memmgr;
+  VMemInfo vm = OSUtils::getVirtualMemoryInfo();
+
+  INFO("Large page size: %u", static_cast<unsigned int>(vm.largePageSize));
+  if (!vm.largePageSize) {
+    EXPECT(memmgr.setLargePages(true) == kErrorFeatureNotEnabled,
+      "Large pages should not be enabled if they are not supported");
+    return;
+  }
+
+  EXPECT(memmgr.setLargePages(true) == kErrorOk,
+    "Failed to enable large pages");
+
+  void* p = memmgr.alloc(1000);
+  EXPECT(p != nullptr,
+    "Couldn't allocate 1000 bytes of virtual memory");
+  EXPECT(memmgr.getAllocatedBytes() >= vm.largePageSize,
+    "Large pages should increase the block size");
+
+  ::memset(p, 0, 1000);
+  EXPECT(memmgr.setLargePages(false) == kErrorInvalidState,
+    "Large pages can't be changed after memory has been allocated");
+
+  INFO("Reporting the pages that actually back the memory");
+  VMemStats stats = memmgr.getStats();
+  INFO("Regular: %u, Large: %u, Transparent: %u",
+    static_cast<unsigned int>(stats.pageBytes[OSUtils::kVMPageRegular]),
+    static_cast<unsigned int>(stats.pageBytes[OSUtils::kVMPageLarge]),
+    static_cast<unsigned int>(stats.pageBytes[OSUtils::kVMPageTransparent]));
+
+  EXPECT(stats.pageBytes[OSUtils::kVMPageRegular] +
+         stats.pageBytes[OSUtils::kVMPageLarge] +
+         stats.pageBytes[OSUtils::kVMPageTransparent] == stats.chunkBytes + stats.slabBytes + stats.permanentBytes,
+    "All virtual memory should be reported by the pages that back it");
+
+  if (!VMemTest_hasReservedHugePages())
+    EXPECT(stats.pageBytes[OSUtils::kVMPageLarge] == 0,
+      "Explicit large pages are not reserved, the fallback should be reported");
+
+  EXPECT(memmgr.release(p) == kErrorOk,
+    "Failed to free %p", p);
+
+  INFO("Falling back to regular pages when dual mapping is enabled");
+  VMemMgr dual;
+  EXPECT(dual.setLargePages(true) == kErrorOk);
+  EXPECT(dual.setDualMapping(true) == kErrorOk);
+
+  p = dual.alloc(1000);
+  EXPECT(p != nullptr,
+    "Couldn't allocate 1000 bytes of dual mapped virtual memory");
+
+  stats = dual.getStats();
+  EXPECT(stats.pageBytes[OSUtils::kVMPageRegular] == stats.chunkBytes + stats.slabBytes + stats.permanentBytes,
+    "Dual mapped memory should be reported as regular pages");
+
+  EXPECT(dual.release(p) == kErrorOk,
+    "Failed to free %p", p);
+}
+
+#if ASMJIT_ARCH_64BIT
+static int VMemTest_anchor;
+
+static bool VMemTest_isNear(const void* p, const void* anchor, size_t distance) noexcept {
+  uintptr_t a = (uintptr_t)p;
+  uintptr_t b = (uintptr_t)anchor;
+  return (a > b ? a - b : b - a) <= distance;
+}
+
+UNIT(base_vmem_near) {
+  INFO("Allocating virtual memory near %p", (void*)&VMemTest_anchor);
+  {
+    VMemMgr memmgr;
+    EXPECT(memmgr.setNearAddress(&VMemTest_anchor) == kErrorOk);
+    EXPECT(memmgr.hasAddressRange());
+
+    void* a = memmgr.alloc(1000);
+    void* b = memmgr.alloc(64);
+    void* c = memmgr.alloc(64, VMemMgr::kAllocPermanent);
+
+    EXPECT(a != nullptr && b != nullptr && c != nullptr,
+      "Couldn't allocate virtual memory near %p", (void*)&VMemTest_anchor);
+    EXPECT(VMemTest_isNear(a, &VMemTest_anchor, VMemMgr::kDefaultNearDistance) &&
+           VMemTest_isNear(b, &VMemTest_anchor, VMemMgr::kDefaultNearDistance) &&
+           VMemTest_isNear(c, &VMemTest_anchor, VMemMgr::kDefaultNearDistance),
+      "Virtual memory allocated out of range");
+
+    EXPECT(memmgr.setNearAddress(nullptr) == kErrorInvalidState,
+      "The range can't be changed after memory has been allocated");
+
+    memmgr.release(a);
+    memmgr.release(b);
+  }
+
+  INFO("Allocating dual-mapped virtual memory near %p", (void*)&VMemTest_anchor);
+  {
+    VMemMgr memmgr;
+    EXPECT(memmgr.setDualMapping(true) == kErrorOk);
+    EXPECT(memmgr.setNearAddress(&VMemTest_anchor) == kErrorOk);
+
+    void* rx;
+    void* rw;
+    EXPECT(memmgr.allocDual(&rx, &rw, 1000) == kErrorOk);
+    EXPECT(VMemTest_isNear(rx, &VMemTest_anchor, VMemMgr::kDefaultNearDistance));
+    memmgr.release(rx);
+  }
+
+  VMemMgr memmgr;
+  EXPECT(memmgr.setAddressRange(4096, 4096) == kErrorInvalidArgument);
+}
+#endif // ASMJIT_ARCH_64BIT
+
+UNIT(base_vmem_stats) {
+  VMemMgr memmgr;
+  VMemStats stats = memmgr.getStats();
+
+  EXPECT(stats.chunkCount == 0 && stats.allocatedBytes == 0 && stats.allocCount == 0,
+    "Stats of an empty VMemMgr should be zero");
+
+  INFO("Collecting statistics of chunk, slab, and permanent allocations");
+  void* chunk[4];
+  void* slab[2];
+  size_t i;
+
+  for (i = 0; i < 4; i++)
+    chunk[i] = memmgr.alloc(1024);
+  for (i = 0; i < 2; i++)
+    slab[i] = memmgr.alloc(64);
+  EXPECT(memmgr.alloc(100, VMemMgr::kAllocPermanent) != nullptr);
+
+  stats = memmgr.getStats();
+  EXPECT(stats.chunkCount == 1);
+  EXPECT(stats.chunkUsedBytes == 4096);
+  EXPECT(stats.largestFreeRun == stats.chunkBytes - 4096);
+  EXPECT(stats.chunkOccupancy[0] == 1);
+  EXPECT(stats.slabRegionCount == 1);
+  EXPECT(stats.slabUsedBytes == 128);
+  EXPECT(stats.permanentChunkCount == 1);
+  EXPECT(stats.permanentUsedBytes == 128);
+  EXPECT(stats.usedBytes == stats.chunkUsedBytes + stats.slabUsedBytes + stats.permanentUsedBytes);
+  EXPECT(stats.allocCount == 7);
+  EXPECT(stats.getFragmentation() == 0.0);
+
+  INFO("Reporting the largest free run and fragmentation");
+  EXPECT(memmgr.release(chunk[1]) == kErrorOk);
+  stats = memmgr.getStats();
+  EXPECT(stats.largestFreeRun == stats.chunkBytes - 4096);
+  EXPECT(stats.getFragmentation() > 0.0);
+
+  EXPECT(memmgr.release(chunk[3]) == kErrorOk);
+  EXPECT(memmgr.release(slab[0]) == kErrorOk);
+  stats = memmgr.getStats();
+  EXPECT(stats.largestFreeRun == stats.chunkBytes - 3072);
+  EXPECT(stats.chunkUsedBytes == 2048);
+  EXPECT(stats.slabUsedBytes == 64);
+  EXPECT(stats.releaseCount == 3);
+
+  memmgr.release(chunk[0]);
+  memmgr.release(chunk[2]);
+  memmgr.release(slab[1]);
+  EXPECT(memmgr.getStats().chunkCount == 0);
+}
 #endif // ASMJIT_TEST
 
 } // asmjit namespace
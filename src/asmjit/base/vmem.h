@@ -20,6 +20,66 @@ namespace asmjit {
 //! \addtogroup asmjit_base
 //! \{
 
+// ============================================================================
+// [asmjit::VMemStats]
+// ============================================================================
+
+//! Snapshot of \ref VMemMgr statistics, see `VMemMgr::getStats()`.
+//!
+//! Counters (allocations, releases, and lock statistics) are cumulative, so
+//! rates are computed from the difference of two snapshots divided by the
+//! difference of their `time`.
+struct VMemStats {
+  enum {
+    //! Count of buckets of `chunkOccupancy`.
+    kOccupancyBucketCount = 8
+  };
+
+  //! Reset all statistics to zero.
+  ASMJIT_INLINE void reset() noexcept { ::memset(this, 0, sizeof(*this)); }
+
+  //! Get the ratio of free bytes in chunks that can't hold an allocation of
+  //! `largestFreeRun` bytes, from 0 (no fragmentation) to 1.
+  ASMJIT_INLINE double getFragmentation() const noexcept {
+    size_t free = chunkBytes - chunkUsedBytes;
+    return free ? 1.0 - static_cast<double>(largestFreeRun) / static_cast<double>(free) : 0.0;
+  }
+
+  uint64_t time;                         //!< Time of the snapshot (`OSUtils::getHighResTime()`).
+
+  size_t allocatedBytes;                 //!< Virtual memory of chunks and slabs (`VMemMgr::getAllocatedBytes()`).
+  size_t usedBytes;                      //!< Bytes used by all allocations (`VMemMgr::getUsedBytes()`).
+
+  size_t chunkCount;                     //!< Count of chunks of freeable memory.
+  size_t chunkBytes;                     //!< Size of all chunks.
+  size_t chunkUsedBytes;                 //!< Bytes used in chunks.
+  size_t largestFreeRun;                 //!< Largest contiguous free space in a single chunk.
+  //! Histogram of chunk occupancy - bucket `i` counts chunks that have between
+  //! `i / kOccupancyBucketCount` and `(i + 1) / kOccupancyBucketCount` of their
+  //! bytes used (full chunks are counted by the last bucket).
+  size_t chunkOccupancy[kOccupancyBucketCount];
+
+  size_t slabRegionCount;                //!< Count of slab regions.
+  size_t slabBytes;                      //!< Size of all slab regions.
+  size_t slabUsedBytes;                  //!< Bytes used by slab allocations.
+
+  size_t permanentChunkCount;            //!< Count of chunks of permanent memory.
+  size_t permanentBytes;                 //!< Size of all permanent chunks.
+  size_t permanentUsedBytes;             //!< Bytes used by permanent allocations.
+
+  //! Virtual memory of chunks, slabs, and permanent chunks by the pages that
+  //! actually back it, indexed by \ref OSUtils::VMPageType. Large pages fall
+  //! back to transparent huge pages or regular pages if they can't be used.
+  size_t pageBytes[OSUtils::kVMPageTypeCount];
+
+  uint64_t allocCount;                   //!< Count of successful allocations.
+  uint64_t releaseCount;                 //!< Count of successful releases.
+
+  uint64_t lockCount;                    //!< See `VMemMgr::getLockCount()`.
+  uint64_t lockContendedCount;           //!< See `VMemMgr::getLockContendedCount()`.
+  uint64_t lockWaitTime;                 //!< See `VMemMgr::getLockWaitTime()`.
+};
+
 // ============================================================================
 // [asmjit::VMemMgr]
 // ============================================================================
@@ -36,6 +96,26 @@ public:
     kAllocPermanent = 1
   };
 
+  //! Default distance of `setNearAddress()`.
+  //!
+  //! Code allocated within 1GB of an address can reach anything within 1GB of
+  //! the same address by a 32-bit displacement.
+  ASMJIT_ENUM(NearDefs) {
+    kDefaultNearDistance = 0x40000000
+  };
+
+  //! \internal
+  ASMJIT_ENUM(SlabDefs) {
+    //! Count of slab size-classes.
+    kSlabClassCount = 4,
+    //! Minimum size-class of a slab (and also alignment).
+    kSlabMinSize = 32,
+    //! Maximum size-class of a slab.
+    kSlabMaxSize = 256,
+    //! Size of a single slab page, must be a power of 2.
+    kSlabPageSize = 4096
+  };
+
   // --------------------------------------------------------------------------
   // [Construction / Destruction]
   // --------------------------------------------------------------------------
@@ -93,6 +173,93 @@ public:
   //! \sa \ref getKeepVirtualMemory.
   ASMJIT_INLINE void setKeepVirtualMemory(bool val) noexcept { _keepVirtualMemory = val; }
 
+  //! Get whether the virtual memory is dual-mapped (W^X).
+  //!
+  //! \sa \ref setDualMapping.
+  ASMJIT_INLINE bool getDualMapping() const noexcept { return _dualMapping; }
+  //! Set whether the virtual memory should be dual-mapped (W^X).
+  //!
+  //! When enabled each chunk of virtual memory is mapped twice - once as
+  //! [Read, Execute] and once as [Read, Write], so there are no pages that
+  //! are both writable and executable. Use `allocDual()` to get both views.
+  //! The pointer returned by `alloc()` and accepted by `release()` and
+  //! `shrink()` is always the executable one.
+  //!
+  //! The mode can only be changed when no memory has been allocated by the
+  //! `VMemMgr`, `kErrorInvalidState` is returned otherwise. Dual mapping is
+  //! not supported when allocating memory of a remote process.
+  ASMJIT_API Error setDualMapping(bool val) noexcept;
+
+  //! Get whether the virtual memory is allocated in large (huge) pages.
+  ASMJIT_INLINE bool getLargePages() const noexcept { return _largePages; }
+  //! Set whether to allocate the virtual memory in large (huge) pages.
+  //!
+  //! When enabled, the block size of the `VMemMgr` is increased to the large
+  //! page size (see \ref VMemInfo::largePageSize) and each block is allocated
+  //! with \ref OSUtils::kVMLargePages, which reduces iTLB misses when a lot of
+  //! code is resident. If large pages are not available the OS silently falls
+  //! back to regular pages, so enabling this option is always safe. The pages
+  //! that actually back the memory are reported by \ref VMemStats::pageBytes.
+  //!
+  //! Large pages are not used together with dual mapping. The mode can only
+  //! be changed when no memory has been allocated, `kErrorInvalidState` is
+  //! returned otherwise. `kErrorFeatureNotEnabled` is returned if the OS
+  //! doesn't support large pages at all.
+  ASMJIT_API Error setLargePages(bool val) noexcept;
+
+  //! Get whether the virtual memory is allocated within an address range.
+  ASMJIT_INLINE bool hasAddressRange() const noexcept { return _rangeHi != 0; }
+  //! Get the lowest address of the virtual memory (if restricted).
+  ASMJIT_INLINE uint64_t getRangeLo() const noexcept { return _rangeLo; }
+  //! Get the end of the address range of the virtual memory (if restricted).
+  ASMJIT_INLINE uint64_t getRangeHi() const noexcept { return _rangeHi; }
+
+  //! Allocate the virtual memory (executable view if dual-mapped) within
+  //! `[lo, hi)`, or anywhere if `hi` is zero.
+  //!
+  //! Free addresses of the range are probed when a new chunk is needed, and
+  //! allocations fail if the range has no free space. Large pages are not used
+  //! within a range. The range can only be changed when no memory has been
+  //! allocated, `kErrorInvalidState` is returned otherwise.
+  ASMJIT_API Error setAddressRange(uint64_t lo, uint64_t hi) noexcept;
+
+  //! Allocate the virtual memory within `distance` bytes of `p`.
+  //!
+  //! Calls from JIT code to functions near `p` (for example functions of the
+  //! host executable) can then be relocated to a direct `call rel32` instead
+  //! of a trampoline. Does nothing on 32-bit targets where every address is
+  //! within the range of `rel32`. See \ref setAddressRange().
+  ASMJIT_API Error setNearAddress(const void* p, size_t distance = kDefaultNearDistance) noexcept;
+
+  // --------------------------------------------------------------------------
+  // [Lock Statistics]
+  // --------------------------------------------------------------------------
+
+  //! Get how many times `alloc()`, `allocDual()`, `release()`, and `shrink()`
+  //! acquired the lock.
+  //!
+  //! Lock statistics are updated while the lock is held, so they are only
+  //! exact when read while no other thread uses the `VMemMgr`.
+  ASMJIT_INLINE uint64_t getLockCount() const noexcept { return _lockCount; }
+  //! Get how many times the lock was already held by another thread.
+  ASMJIT_INLINE uint64_t getLockContendedCount() const noexcept { return _lockContendedCount; }
+  //! Get the time spent waiting for the lock held by another thread in nanoseconds.
+  ASMJIT_INLINE uint64_t getLockWaitTime() const noexcept { return _lockWaitTime; }
+
+  //! Reset lock statistics.
+  ASMJIT_API void resetLockStats() noexcept;
+
+  // --------------------------------------------------------------------------
+  // [Statistics]
+  // --------------------------------------------------------------------------
+
+  //! Get a snapshot of statistics, see \ref VMemStats.
+  //!
+  //! The snapshot is consistent, it's taken under the lock (which is not
+  //! counted by lock statistics). Its cost is proportional to the count of
+  //! chunks and slab regions, so it's cheap enough to be taken periodically.
+  ASMJIT_API VMemStats getStats() const noexcept;
+
   // --------------------------------------------------------------------------
   // [Alloc / Release]
   // --------------------------------------------------------------------------
@@ -102,9 +269,24 @@ public:
   //! Note that if you are implementing your own virtual memory manager then you
   //! can quitly ignore type of allocation. This is mainly for AsmJit to memory
   //! manager that allocated memory will be never freed.
+  //!
+  //! Freeable allocations of up to `kSlabMaxSize` bytes are served by size-class
+  //! slabs (32, 64, 128, and 256 bytes) with O(1) alloc and release. Such
+  //! allocation is aligned to its size-class.
   ASMJIT_API void* alloc(size_t size, uint32_t type = kAllocFreeable) noexcept;
+  //! Allocate a `size` bytes of virtual memory and return both its executable
+  //! `rx` and writable `rw` views.
+  //!
+  //! If dual mapping is not enabled then both `rx` and `rw` point to the same
+  //! memory.
+  ASMJIT_API Error allocDual(void** rx, void** rw, size_t size, uint32_t type = kAllocFreeable) noexcept;
   //! Free previously allocated memory at a given `address`.
   ASMJIT_API Error release(void* p) noexcept;
+  //! Free `count` allocations in `list` (null entries are skipped) under a
+  //! single lock acquisition.
+  //!
+  //! All allocations are released even if some fail, returns the first error.
+  ASMJIT_API Error releaseMany(void* const* list, size_t count) noexcept;
   //! Free extra memory allocated with `p`.
   ASMJIT_API Error shrink(void* p, size_t used) noexcept;
 
@@ -120,16 +302,29 @@ public:
   size_t _blockSize;                     //!< Default block size.
   size_t _blockDensity;                  //!< Default block density.
   bool _keepVirtualMemory;               //!< Keep virtual memory after destroyed.
+  bool _dualMapping;                     //!< Map virtual memory twice (RX and RW).
+  bool _largePages;                      //!< Allocate virtual memory in large pages.
+  uint64_t _rangeLo;                     //!< Lowest address of virtual memory.
+  uint64_t _rangeHi;                     //!< End of the address range of virtual memory (zero if any).
 
   size_t _allocatedBytes;                //!< How many bytes are currently allocated.
   size_t _usedBytes;                     //!< How many bytes are currently used.
 
+  uint64_t _allocCount;                  //!< How many allocations succeeded.
+  uint64_t _releaseCount;                //!< How many releases succeeded.
+
+  uint64_t _lockCount;                   //!< How many times the lock was acquired.
+  uint64_t _lockContendedCount;          //!< How many times the lock was contended.
+  uint64_t _lockWaitTime;                //!< Time spent waiting for a contended lock.
+
   //! \internal
   //! \{
 
   struct RbNode;
   struct MemNode;
   struct PermanentNode;
+  struct SlabPage;
+  struct SlabRegion;
 
   // Memory nodes root.
   MemNode* _root;
@@ -140,9 +335,122 @@ public:
   // Permanent memory.
   PermanentNode* _permanent;
 
+  // Slab pages that have at least one free slot, per size-class.
+  SlabPage* _slabPartial[kSlabClassCount];
+  // Slab pages that are not used by any size-class.
+  SlabPage* _slabFree;
+  // Slab regions (virtual memory the slab pages are carved from).
+  SlabRegion* _slabRegions;
+  // Open-addressing hash table that maps slab page addresses to `SlabPage`.
+  SlabPage** _slabHash;
+  uint32_t _slabHashMask;
+  uint32_t _slabHashCount;
+
   //! \}
 };
 
+// ============================================================================
+// [asmjit::VMemArena]
+// ============================================================================
+
+//! Thread-local arena that sub-allocates virtual memory from `VMemMgr` chunks.
+//!
+//! `VMemMgr` serializes all allocations on a single lock and performs a
+//! red-black tree lookup on every `release()`. `VMemArena` is designed to be
+//! owned by a single thread - it obtains large chunks from `VMemMgr` and then
+//! serves allocations from them without taking any lock. The `VMemMgr` is
+//! only touched when the current chunk runs out of space or when a chunk
+//! becomes completely unused.
+//!
+//! The arena doesn't reuse holes within a chunk; a chunk is returned to the
+//! `VMemMgr` as soon as all allocations made from it are released. Chunks
+//! are kept sorted by their address, so `release()` and `shrink()` find the
+//! chunk of an allocation by a binary search. Memory allocated by an arena
+//! must be released by the same arena (and thread).
+class VMemArena {
+public:
+  ASMJIT_NONCOPYABLE(VMemArena)
+
+  ASMJIT_ENUM(Defs) {
+    //! Default size of a chunk obtained from `VMemMgr`.
+    kDefaultChunkSize = 65536,
+    //! Alignment of each allocation (matches `VMemMgr` block density).
+    kAllocAlignment = 64
+  };
+
+  // --------------------------------------------------------------------------
+  // [Construction / Destruction]
+  // --------------------------------------------------------------------------
+
+  //! Create a new `VMemArena` bound to `memMgr`.
+  //!
+  //! If `chunkSize` is zero then `kDefaultChunkSize` is used.
+  ASMJIT_API VMemArena(VMemMgr* memMgr, size_t chunkSize = 0) noexcept;
+  //! Destroy the `VMemArena` and release all chunks back to `VMemMgr`.
+  ASMJIT_API ~VMemArena() noexcept;
+
+  // --------------------------------------------------------------------------
+  // [Reset]
+  // --------------------------------------------------------------------------
+
+  //! Release all chunks back to `VMemMgr`. All memory allocated by the arena
+  //! is invalidated.
+  ASMJIT_API void reset() noexcept;
+
+  // --------------------------------------------------------------------------
+  // [Accessors]
+  // --------------------------------------------------------------------------
+
+  //! Get the `VMemMgr` the arena allocates chunks from.
+  ASMJIT_INLINE VMemMgr* getMemMgr() const noexcept { return _memMgr; }
+  //! Get the size of a single chunk.
+  ASMJIT_INLINE size_t getChunkSize() const noexcept { return _chunkSize; }
+  //! Get the count of chunks obtained from `VMemMgr`.
+  ASMJIT_INLINE size_t getChunkCount() const noexcept { return _chunkCount; }
+
+  // --------------------------------------------------------------------------
+  // [Alloc / Release]
+  // --------------------------------------------------------------------------
+
+  //! Allocate `size` bytes of virtual memory.
+  //!
+  //! Allocations larger than half of the chunk size are forwarded to `VMemMgr`.
+  ASMJIT_API void* alloc(size_t size) noexcept;
+  //! Allocate `size` bytes of virtual memory and return both its executable
+  //! `rx` and writable `rw` views, see \ref VMemMgr::allocDual().
+  ASMJIT_API Error allocDual(void** rx, void** rw, size_t size) noexcept;
+  //! Release memory previously allocated by `alloc()`.
+  ASMJIT_API Error release(void* p) noexcept;
+  //! Shrink the last allocation `p` to `used` bytes.
+  //!
+  //! Only the most recent allocation of the current chunk can be shrunk, in
+  //! any other case the call succeeds, but the memory is not reclaimed.
+  ASMJIT_API Error shrink(void* p, size_t used) noexcept;
+
+  // --------------------------------------------------------------------------
+  // [Members]
+  // --------------------------------------------------------------------------
+
+  //! \internal
+  //!
+  //! Chunk obtained from `VMemMgr`.
+  struct Chunk {
+    uint8_t* mem;                        //!< Virtual memory address.
+    intptr_t rwDelta;                    //!< Difference between RW and RX views.
+    size_t size;                         //!< Size of the chunk.
+    size_t offset;                       //!< Bump offset (first unused byte).
+    size_t lastOffset;                   //!< Offset of the most recent allocation.
+    size_t count;                        //!< Count of live allocations.
+  };
+
+  VMemMgr* _memMgr;                      //!< Memory manager that owns the chunks.
+  Chunk* _current;                       //!< Chunk used by new allocations.
+  Chunk** _chunks;                       //!< All chunks sorted by their address.
+  size_t _chunkCount;                    //!< Count of chunks.
+  size_t _chunkCapacity;                 //!< Capacity of `_chunks`.
+  size_t _chunkSize;                     //!< Default chunk size.
+};
+
 //! \}
 
 } // asmjit namespace
@@ -19,6 +19,9 @@ namespace asmjit {
 //! Zero size block used by `Zone` that doesn't have any memory allocated.
 static const Zone::Block Zone_zeroBlock = { nullptr, nullptr, 0, { 0 } };
 
+//! Default block pool used by new zones, see `ZoneBlockPool::setDefault()`.
+static ZoneBlockPool* ZoneBlockPool_default = nullptr;
+
 static ASMJIT_INLINE uint32_t Zone_getAlignmentOffsetFromAlignment(uint32_t x) noexcept {
   switch (x) {
     default: return 0;
@@ -41,6 +44,7 @@ Zone::Zone(uint32_t blockSize, uint32_t blockAlignment) noexcept
   : _ptr(nullptr),
     _end(nullptr),
     _block(const_cast<Zone::Block*>(&Zone_zeroBlock)),
+    _blockPool(ZoneBlockPool_default),
     _blockSize(blockSize),
     _blockAlignmentShift(Zone_getAlignmentOffsetFromAlignment(blockAlignment)) {}
 
@@ -52,6 +56,13 @@ Zone::~Zone() noexcept {
 // [asmjit::Zone - Reset]
 // ============================================================================
 
+static ASMJIT_INLINE void Zone_releaseBlock(Zone* self, Zone::Block* block) noexcept {
+  if (self->_blockPool)
+    self->_blockPool->release(block, sizeof(Zone::Block) + block->size);
+  else
+    Internal::releaseMemory(block);
+}
+
 void Zone::reset(bool releaseMemory) noexcept {
   Block* cur = _block;
 
@@ -65,14 +76,14 @@ void Zone::reset(bool releaseMemory) noexcept {
     Block* next = cur->next;
     do {
       Block* prev = cur->prev;
-      Internal::releaseMemory(cur);
+      Zone_releaseBlock(this, cur);
       cur = prev;
     } while (cur);
 
     cur = next;
     while (cur) {
       next = cur->next;
-      Internal::releaseMemory(cur);
+      Zone_releaseBlock(this, cur);
       cur = next;
     }
 
@@ -90,6 +101,40 @@ void Zone::reset(bool releaseMemory) noexcept {
   }
 }
 
+// ============================================================================
+// [asmjit::Zone - Accessors]
+// ============================================================================
+
+size_t Zone::getUsedSize() const noexcept {
+  const Block* cur = _block;
+  if (cur == &Zone_zeroBlock)
+    return 0;
+
+  size_t size = (size_t)(_ptr - cur->data);
+  while ((cur = cur->prev) != nullptr)
+    size += cur->size;
+  return size;
+}
+
+// ============================================================================
+// [asmjit::Zone - State]
+// ============================================================================
+
+void Zone::restoreState(const State& state) noexcept {
+  Block* block = state.block;
+
+  // Nothing was allocated when the state was saved.
+  if (block == &Zone_zeroBlock) {
+    reset(false);
+    return;
+  }
+
+  ASMJIT_ASSERT(state.ptr >= block->data && state.ptr <= block->data + block->size);
+  _ptr = state.ptr;
+  _end = block->data + block->size;
+  _block = block;
+}
+
 // ============================================================================
 // [asmjit::Zone - Alloc]
 // ============================================================================
@@ -125,7 +170,18 @@ void* Zone::_alloc(size_t size) noexcept {
     return nullptr;
 
   blockSize += blockAlignment;
-  Block* newBlock = static_cast<Block*>(Internal::allocMemory(sizeof(Block) + blockSize));
+  Block* newBlock;
+
+  if (_blockPool) {
+    // The pool can return a larger block, use all of it.
+    size_t allocatedSize;
+    newBlock = static_cast<Block*>(_blockPool->alloc(sizeof(Block) + blockSize, allocatedSize));
+    if (ASMJIT_LIKELY(newBlock))
+      blockSize = allocatedSize - sizeof(Block);
+  }
+  else {
+    newBlock = static_cast<Block*>(Internal::allocMemory(sizeof(Block) + blockSize));
+  }
 
   if (ASMJIT_UNLIKELY(!newBlock))
     return nullptr;
@@ -193,6 +249,166 @@ char* Zone::sformat(const char* fmt, ...) noexcept {
   return static_cast<char*>(dup(buf, len));
 }
 
+// [asmjit::ZoneBlockPool - Construction / Destruction]
+// ============================================================================
+
+//! \internal
+//!
+//! Scoped lock that does nothing if the pool is not thread-safe.
+struct ZoneBlockPoolAutoLock {
+  ASMJIT_NONCOPYABLE(ZoneBlockPoolAutoLock)
+
+  ASMJIT_INLINE ZoneBlockPoolAutoLock(ZoneBlockPool* self) noexcept : _self(self) {
+    if (self->_threadSafe) self->_lock.lock();
+  }
+  ASMJIT_INLINE ~ZoneBlockPoolAutoLock() noexcept {
+    if (_self->_threadSafe) _self->_lock.unlock();
+  }
+
+  ZoneBlockPool* _self;
+};
+
+ZoneBlockPool::ZoneBlockPool(bool threadSafe, size_t maxCachedSize) noexcept
+  : _threadSafe(static_cast<uint8_t>(threadSafe)),
+    _maxCachedSize(maxCachedSize),
+    _cachedSize(0),
+    _peakCachedSize(0),
+    _hitCount(0),
+    _missCount(0) {
+  for (uint32_t i = 0; i < kClassCount; i++)
+    _blocks[i] = nullptr;
+}
+
+ZoneBlockPool::~ZoneBlockPool() noexcept {
+  trim(0);
+}
+
+// ============================================================================
+// [asmjit::ZoneBlockPool - Global]
+// ============================================================================
+
+ZoneBlockPool* ZoneBlockPool::getGlobal() noexcept {
+  static ZoneBlockPool pool(true);
+  return &pool;
+}
+
+ZoneBlockPool* ZoneBlockPool::getDefault() noexcept {
+  return ZoneBlockPool_default;
+}
+
+void ZoneBlockPool::setDefault(ZoneBlockPool* pool) noexcept {
+  ZoneBlockPool_default = pool;
+}
+
+// ============================================================================
+// [asmjit::ZoneBlockPool - Accessors]
+// ============================================================================
+
+void ZoneBlockPool::setMaxCachedSize(size_t size) noexcept {
+  {
+    ZoneBlockPoolAutoLock locked(this);
+    _maxCachedSize = size;
+  }
+  trim(size);
+}
+
+// ============================================================================
+// [asmjit::ZoneBlockPool - Alloc / Release]
+// ============================================================================
+
+//! \internal
+//!
+//! Get the size class of a block of `size` bytes, `kClassCount` if the block
+//! is too large to be pooled.
+static ASMJIT_INLINE uint32_t ZoneBlockPool_getClass(size_t size) noexcept {
+  uint32_t index = 0;
+  size_t classSize = static_cast<size_t>(1) << ZoneBlockPool::kMinBlockShift;
+
+  while (classSize < size && index < ZoneBlockPool::kClassCount) {
+    classSize <<= 1;
+    index++;
+  }
+  return index;
+}
+
+void* ZoneBlockPool::alloc(size_t size, size_t& allocatedSize) noexcept {
+  uint32_t index = ZoneBlockPool_getClass(size);
+  if (index < kClassCount) {
+    size = static_cast<size_t>(1) << (index + kMinBlockShift);
+
+    ZoneBlockPoolAutoLock locked(this);
+    CachedBlock* block = _blocks[index];
+
+    if (block) {
+      _blocks[index] = block->next;
+      _cachedSize -= size;
+      _hitCount++;
+
+      allocatedSize = size;
+      return static_cast<void*>(block);
+    }
+
+    _missCount++;
+  }
+
+  void* p = Internal::allocMemory(size);
+  allocatedSize = p ? size : static_cast<size_t>(0);
+  return p;
+}
+
+void ZoneBlockPool::release(void* p, size_t size) noexcept {
+  ASMJIT_ASSERT(p != nullptr);
+
+  // Only blocks that have exactly the size of their class were allocated
+  // through the cache, other ones were allocated by `malloc()` directly.
+  uint32_t index = ZoneBlockPool_getClass(size);
+  if (index < kClassCount && size == (static_cast<size_t>(1) << (index + kMinBlockShift))) {
+    ZoneBlockPoolAutoLock locked(this);
+
+    if (_cachedSize + size <= _maxCachedSize) {
+      CachedBlock* block = static_cast<CachedBlock*>(p);
+      block->next = _blocks[index];
+      _blocks[index] = block;
+
+      _cachedSize += size;
+      _peakCachedSize = std::max(_peakCachedSize, _cachedSize);
+      return;
+    }
+  }
+
+  Internal::releaseMemory(p);
+}
+
+void ZoneBlockPool::trim(size_t size) noexcept {
+  CachedBlock* toRelease = nullptr;
+
+  {
+    ZoneBlockPoolAutoLock locked(this);
+
+    // Release the largest blocks first.
+    uint32_t index = kClassCount;
+    while (_cachedSize > size && index) {
+      index--;
+      size_t classSize = static_cast<size_t>(1) << (index + kMinBlockShift);
+
+      while (_cachedSize > size && _blocks[index]) {
+        CachedBlock* block = _blocks[index];
+        _blocks[index] = block->next;
+        _cachedSize -= classSize;
+
+        block->next = toRelease;
+        toRelease = block;
+      }
+    }
+  }
+
+  while (toRelease) {
+    CachedBlock* next = toRelease->next;
+    Internal::releaseMemory(toRelease);
+    toRelease = next;
+  }
+}
+
 // ============================================================================
 // [asmjit::ZoneHeap - Helpers]
 // ============================================================================
@@ -211,18 +427,86 @@ static bool ZoneHeap_hasDynamicBlock(ZoneHeap* self, ZoneHeap::DynamicBlock* blo
 // [asmjit::ZoneHeap - Init / Reset]
 // ============================================================================
 
+static void ZoneHeap_releaseBlocks(ZoneHeap::DynamicBlock* block) noexcept {
+  while (block) {
+    ZoneHeap::DynamicBlock* next = block->next;
+    Internal::releaseMemory(block);
+    block = next;
+  }
+}
+
 void ZoneHeap::reset(Zone* zone) noexcept {
   // Free dynamic blocks.
+  ZoneHeap_releaseBlocks(_dynamicBlocks);
+  ZoneHeap_releaseBlocks(_spareBlocks);
+
+  // Zero the entire class and initialize to the given `zone`, but keep the
+  // configuration.
+  const SlotTable* slotTable = _slotTable;
+  Stats* stats = _stats;
+
+  ::memset(this, 0, sizeof(*this));
+  _zone = zone;
+  _slotTable = slotTable;
+  _stats = stats;
+}
+
+void ZoneHeap::recycle(Zone* zone) noexcept {
+  // Move all dynamic blocks to spare blocks.
+  DynamicBlock* spare = _spareBlocks;
   DynamicBlock* block = _dynamicBlocks;
+
   while (block) {
     DynamicBlock* next = block->next;
-    Internal::releaseMemory(block);
+    block->prev = nullptr;
+    block->next = spare;
+    if (spare) spare->prev = block;
+    spare = block;
     block = next;
   }
 
-  // Zero the entire class and initialize to the given `zone`.
+  const SlotTable* slotTable = _slotTable;
+  Stats* stats = _stats;
+
   ::memset(this, 0, sizeof(*this));
   _zone = zone;
+  _spareBlocks = spare;
+  _slotTable = slotTable;
+  _stats = stats;
+}
+
+// ============================================================================
+// [asmjit::ZoneHeap - Slot Table]
+// ============================================================================
+
+Error ZoneHeap::initSlotTable(SlotTable* table, const uint32_t* sizes, uint32_t count) noexcept {
+  if (ASMJIT_UNLIKELY(!count || count > kMaxSlots))
+    return DebugUtils::errored(kErrorInvalidArgument);
+
+  uint32_t prev = 0;
+  for (uint32_t i = 0; i < count; i++) {
+    uint32_t size = sizes[i];
+    if (ASMJIT_UNLIKELY(size <= prev || size > kMaxSlotSize || (size % kBlockAlignment) != 0))
+      return DebugUtils::errored(kErrorInvalidArgument);
+    prev = size;
+  }
+
+  ::memset(table, 0, sizeof(*table));
+  table->count = count;
+  table->maxSize = prev;
+
+  uint32_t slot = 0;
+  for (uint32_t i = 0; i < count; i++)
+    table->sizes[i] = sizes[i];
+
+  for (uint32_t i = 0; i < prev / kBlockAlignment; i++) {
+    // Index `i` covers sizes up to `(i + 1) * kBlockAlignment`.
+    while (sizes[slot] < (i + 1) * kBlockAlignment)
+      slot++;
+    table->index[i] = static_cast<uint8_t>(slot);
+  }
+
+  return kErrorOk;
 }
 
 // ============================================================================
@@ -234,17 +518,26 @@ void* ZoneHeap::_alloc(size_t size, size_t& allocatedSize) noexcept {
 
   // We use our memory pool only if the requested block is of a reasonable size.
   uint32_t slot;
+  Stats* stats = _stats;
+
   if (_getSlotIndex(size, slot, allocatedSize)) {
     // Slot reuse.
     uint8_t* p = reinterpret_cast<uint8_t*>(_slots[slot]);
+    if (stats)
+      stats->wastedBytes += allocatedSize - size;
     size = allocatedSize;
 
     if (p) {
       _slots[slot] = reinterpret_cast<Slot*>(p)->next;
+      if (stats)
+        stats->slotHits[slot]++;
       //printf("ALLOCATED %p of size %d (SLOT %d)\n", p, int(size), slot);
       return p;
     }
 
+    if (stats)
+      stats->slotMisses[slot]++;
+
     // So use Zone to allocate a new chunk for us. But before we use it, we
     // check if there is enough room for the new chunk in zone, and if not,
     // we redistribute the remaining memory in Zone's current block into slots.
@@ -259,21 +552,45 @@ void* ZoneHeap::_alloc(size_t size, size_t& allocatedSize) noexcept {
     }
     else {
       // Distribute the remaining memory to suitable slots.
-      if (remain >= kLoGranularity) {
-        do {
-          size_t distSize = std::min<size_t>(remain, kLoMaxSize);
-          uint32_t distSlot = static_cast<uint32_t>((distSize - kLoGranularity) / kLoGranularity);
-          ASMJIT_ASSERT(distSlot < kLoCount);
-
+      const SlotTable* table = _slotTable;
+      if (!table) {
+        if (remain >= kLoGranularity) {
+          do {
+            size_t distSize = std::min<size_t>(remain, kLoMaxSize);
+            uint32_t distSlot = static_cast<uint32_t>((distSize - kLoGranularity) / kLoGranularity);
+            ASMJIT_ASSERT(distSlot < kLoCount);
+
+            reinterpret_cast<Slot*>(p)->next = _slots[distSlot];
+            _slots[distSlot] = reinterpret_cast<Slot*>(p);
+
+            p += distSize;
+            remain -= distSize;
+          } while (remain >= kLoGranularity);
+          zone->setCursor(p);
+        }
+      }
+      else {
+        // Like the default slots prefer small chunks, but use the smallest
+        // slot if all slots are larger than `kLoMaxSize`.
+        size_t distMax = std::max<size_t>(kLoMaxSize, table->sizes[0]);
+        while (remain >= table->sizes[0]) {
+          uint32_t distSlot = table->count - 1;
+          while (table->sizes[distSlot] > std::min(remain, distMax))
+            distSlot--;
+
+          size_t distSize = table->sizes[distSlot];
           reinterpret_cast<Slot*>(p)->next = _slots[distSlot];
           _slots[distSlot] = reinterpret_cast<Slot*>(p);
 
           p += distSize;
           remain -= distSize;
-        } while (remain >= kLoGranularity);
+        }
         zone->setCursor(p);
       }
 
+      if (stats)
+        stats->wastedBytes += remain;
+
       p = static_cast<uint8_t*>(zone->_alloc(size));
       if (ASMJIT_UNLIKELY(!p)) {
         allocatedSize = 0;
@@ -292,14 +609,55 @@ void* ZoneHeap::_alloc(size_t size, size_t& allocatedSize) noexcept {
     if (ASMJIT_UNLIKELY(overhead >= ~static_cast<size_t>(0) - size))
       return nullptr;
 
-    void* p = Internal::allocMemory(size + overhead);
-    if (ASMJIT_UNLIKELY(!p)) {
-      allocatedSize = 0;
-      return nullptr;
+    size_t blockSize = size + overhead;
+    DynamicBlock* block = nullptr;
+
+    if (stats) {
+      stats->dynamicBytes += size;
+      stats->maxDynamicSize = std::max(stats->maxDynamicSize, size);
+    }
+
+    // Reuse the smallest spare block that fits, but don't waste more than a
+    // half of it.
+    DynamicBlock* spare = _spareBlocks;
+    while (spare) {
+      if (spare->size >= blockSize && spare->size / 2 <= blockSize && (!block || spare->size < block->size))
+        block = spare;
+      spare = spare->next;
+    }
+
+    void* p;
+    if (block) {
+      DynamicBlock* prev = block->prev;
+      DynamicBlock* next = block->next;
+
+      if (prev)
+        prev->next = next;
+      else
+        _spareBlocks = next;
+
+      if (next)
+        next->prev = prev;
+      p = block;
+
+      if (stats)
+        stats->dynamicReuses++;
+    }
+    else {
+      p = Internal::allocMemory(blockSize);
+      if (ASMJIT_UNLIKELY(!p)) {
+        allocatedSize = 0;
+        return nullptr;
+      }
+
+      block = static_cast<DynamicBlock*>(p);
+      block->size = blockSize;
+
+      if (stats)
+        stats->dynamicAllocs++;
     }
 
     // Link as first in `_dynamicBlocks` double-linked list.
-    DynamicBlock* block = static_cast<DynamicBlock*>(p);
     DynamicBlock* next = _dynamicBlocks;
 
     if (next)
@@ -348,7 +706,12 @@ void ZoneHeap::_releaseDynamic(void* p, size_t size) noexcept {
   if (next)
     next->prev = prev;
 
-  Internal::releaseMemory(block);
+  // Keep the block for reuse, all spare blocks are released by `reset()`.
+  DynamicBlock* spare = _spareBlocks;
+  block->prev = nullptr;
+  block->next = spare;
+  if (spare) spare->prev = block;
+  _spareBlocks = block;
 }
 
 // ============================================================================
@@ -368,19 +731,14 @@ Error ZoneVectorBase::_grow(ZoneHeap* heap, size_t sizeOfT, size_t n) noexcept {
     return kErrorOk;
 
   // ZoneVector is used as an array to hold short-lived data structures used
-  // during code generation. The growing strategy is simple - use small capacity
-  // at the beginning (very good for ZoneHeap) and then grow quicker to prevent
-  // successive reallocations.
-  if (capacity < 4)
-    capacity = 4;
-  else if (capacity < 8)
-    capacity = 8;
-  else if (capacity < 16)
-    capacity = 16;
-  else if (capacity < 64)
-    capacity = 64;
-  else if (capacity < 256)
-    capacity = 256;
+  // during code generation. Start with the smallest ZoneHeap slot and double
+  // the capacity, so a small vector moves through only a few pooled slot
+  // sizes (`_reserve()` fills the rest of each slot) before it needs a dynamic
+  // block. Large vectors keep doubling up to `kAllocThreshold` and then grow
+  // linearly to not waste too much memory.
+  size_t minCapacity = std::max<size_t>(ZoneHeap::kLoGranularity / sizeOfT, 4);
+  if (capacity < minCapacity)
+    capacity = minCapacity;
 
   while (capacity < after) {
     if (capacity < threshold)
@@ -818,6 +1176,7 @@ ZoneHashNode* ZoneHashBase::_del(ZoneHashNode* node) noexcept {
   while (p) {
     if (p == node) {
       *pPrev = p->_hashNext;
+      _size--;
       return node;
     }
 
@@ -828,6 +1187,136 @@ ZoneHashNode* ZoneHashBase::_del(ZoneHashNode* node) noexcept {
   return nullptr;
 }
 
+// ============================================================================
+// [asmjit::ZoneFlatHashBase - Reset]
+// ============================================================================
+
+void ZoneFlatHashBase::reset(ZoneHeap* heap) noexcept {
+  if (_data)
+    _heap->release(_data, static_cast<size_t>(_capacity) * sizeof(Slot));
+
+  _heap = heap;
+  _size = 0;
+  _capacity = 0;
+  _shift = 32;
+  _data = nullptr;
+}
+
+// ============================================================================
+// [asmjit::ZoneFlatHashBase - Rehash]
+// ============================================================================
+
+Error ZoneFlatHashBase::_rehash(uint32_t newCapacity) noexcept {
+  ASMJIT_ASSERT(isInitialized());
+  ASMJIT_ASSERT(Utils::isPowerOf2(newCapacity));
+  ASMJIT_ASSERT(newCapacity > _size);
+
+  Slot* oldData = _data;
+  Slot* newData = static_cast<Slot*>(
+    _heap->allocZeroed(static_cast<size_t>(newCapacity) * sizeof(Slot)));
+
+  if (ASMJIT_UNLIKELY(!newData))
+    return DebugUtils::errored(kErrorNoHeapMemory);
+
+  uint32_t oldCapacity = _capacity;
+  uint32_t newMask = newCapacity - 1;
+
+  _capacity = newCapacity;
+  _shift = 32 - Utils::findFirstBit(newCapacity);
+  _data = newData;
+
+  for (uint32_t i = 0; i < oldCapacity; i++) {
+    const Slot& slot = oldData[i];
+    if (!slot.node)
+      continue;
+
+    uint32_t j = _indexOf(slot.hVal);
+    while (newData[j].node)
+      j = (j + 1) & newMask;
+    newData[j] = slot;
+  }
+
+  if (oldData)
+    _heap->release(oldData, static_cast<size_t>(oldCapacity) * sizeof(Slot));
+  return kErrorOk;
+}
+
+// ============================================================================
+// [asmjit::ZoneFlatHashBase - Reserve]
+// ============================================================================
+
+Error ZoneFlatHashBase::reserve(size_t n) noexcept {
+  // Must match the load factor used by `_put()`.
+  if (n * 2 <= _capacity)
+    return kErrorOk;
+
+  if (ASMJIT_UNLIKELY(n > 0x40000000U))
+    return DebugUtils::errored(kErrorNoHeapMemory);
+
+  uint32_t newCapacity = Utils::alignToPowerOf2(std::max<uint32_t>(static_cast<uint32_t>(n) * 2, kMinCapacity));
+  return _rehash(newCapacity);
+}
+
+// ============================================================================
+// [asmjit::ZoneFlatHashBase - Ops]
+// ============================================================================
+
+ZoneHashNode* ZoneFlatHashBase::_put(ZoneHashNode* node) noexcept {
+  // Keep the table at most half full so probe sequences stay short.
+  if ((_size + 1) * 2 > _capacity) {
+    uint32_t newCapacity = _capacity ? _capacity * 2 : static_cast<uint32_t>(kMinCapacity);
+    if (ASMJIT_UNLIKELY(newCapacity <= _capacity || _rehash(newCapacity) != kErrorOk))
+      return nullptr;
+  }
+
+  uint32_t mask = _capacity - 1;
+  uint32_t i = _indexOf(node->_hVal);
+
+  while (_data[i].node)
+    i = (i + 1) & mask;
+
+  _data[i].hVal = node->_hVal;
+  _data[i].node = node;
+  _size++;
+  return node;
+}
+
+ZoneHashNode* ZoneFlatHashBase::_del(ZoneHashNode* node) noexcept {
+  if (!_capacity)
+    return nullptr;
+
+  uint32_t mask = _capacity - 1;
+  uint32_t i = _indexOf(node->_hVal);
+
+  for (;;) {
+    if (!_data[i].node)
+      return nullptr;
+    if (_data[i].node == node)
+      break;
+    i = (i + 1) & mask;
+  }
+
+  // Backward-shift deletion - move every following slot that would no longer
+  // be reachable from its home slot into the hole, so no tombstones are needed.
+  uint32_t j = i;
+  for (;;) {
+    j = (j + 1) & mask;
+    if (!_data[j].node)
+      break;
+
+    uint32_t home = _indexOf(_data[j].hVal);
+    if (((j - home) & mask) >= ((j - i) & mask)) {
+      _data[i] = _data[j];
+      i = j;
+    }
+  }
+
+  _data[i].hVal = 0;
+  _data[i].node = nullptr;
+  _size--;
+  return node;
+}
+
 // ============================================================================
 // [asmjit::Zone - Test]
 // ============================================================================
@@ -861,6 +1350,169 @@ UNIT(base_zonevector) {
   EXPECT(vec.isEmpty() == false);
   EXPECT(vec.getLength() == static_cast<size_t>(kMax));
   EXPECT(vec.indexOf(kMax - 1) == static_cast<size_t>(kMax - 1));
+
+  INFO("ZoneVector<int>::insert()");
+  vec.clear();
+  for (i = 0; i < 4; i++)
+    EXPECT(vec.append(&heap, i) == kErrorOk);
+  EXPECT(vec.insert(&heap, 1, 100) == kErrorOk);
+  EXPECT(vec.getLength() == 5);
+  EXPECT(vec[0] == 0 && vec[1] == 100 && vec[2] == 1 && vec[3] == 2 && vec[4] == 3);
+
+  INFO("ZoneVector<int>::append(items, count)");
+  int items[100];
+  for (i = 0; i < 100; i++)
+    items[i] = i + 1000;
+
+  vec.clear();
+  EXPECT(vec.append(&heap, items, 0) == kErrorOk);
+  EXPECT(vec.isEmpty());
+  EXPECT(vec.append(&heap, items, 100) == kErrorOk);
+  EXPECT(vec.getLength() == 100);
+  EXPECT(vec.willGrow(&heap, 10) == kErrorOk);
+  vec.appendUnsafe(items, 10);
+  EXPECT(vec.getLength() == 110);
+  for (i = 0; i < 110; i++)
+    EXPECT(vec[i] == items[i % 100], "Invalid item at %d", i);
+
+  INFO("ZoneVector<int> growth starts at the smallest ZoneHeap slot");
+  ZoneVector<int> small;
+  EXPECT(small.append(&heap, 0) == kErrorOk);
+  EXPECT(small.getCapacity() * sizeof(int) == 32);
+  small.release(&heap);
+}
+
+UNIT(base_zone_recycle) {
+  Zone zone(8096 - Zone::kZoneOverhead);
+  ZoneHeap heap(&zone);
+
+  INFO("Zone::saveState() and Zone::restoreState()");
+  Zone::State state;
+  zone.saveState(&state);
+  zone.restoreState(state);
+  EXPECT(zone.getUsedSize() == 0);
+
+  void* a = zone.alloc(64);
+  zone.saveState(&state);
+  void* b = zone.alloc(64);
+  for (int i = 0; i < 1000; i++)
+    EXPECT(zone.alloc(64) != nullptr);
+
+  zone.restoreState(state);
+  EXPECT(a != nullptr);
+  EXPECT(zone.alloc(64) == b);
+
+  INFO("ZoneHeap::recycle() keeps dynamic blocks");
+  ZoneVector<int> vec;
+  for (int i = 0; i < 100000; i++)
+    EXPECT(vec.append(&heap, i) == kErrorOk);
+
+  int* data = vec.getData();
+  vec.reset();
+  zone.reset(false);
+  heap.recycle(&zone);
+
+  EXPECT(vec.willGrow(&heap, 100000) == kErrorOk);
+  EXPECT(vec.getData() == data);
+}
+
+UNIT(base_zoneheap_slots) {
+  Zone zone(8096 - Zone::kZoneOverhead);
+  ZoneHeap heap(&zone);
+  ZoneHeap::Stats stats;
+
+  stats.reset();
+  heap.setStats(&stats);
+
+  INFO("ZoneHeap statistics of the default slots");
+  size_t allocatedSize;
+  void* p = heap.alloc(40, allocatedSize);
+  EXPECT(p != nullptr && allocatedSize == 64);
+  EXPECT(stats.slotMisses[1] == 1 && stats.slotHits[1] == 0);
+  EXPECT(stats.wastedBytes == 24);
+
+  heap.release(p, allocatedSize);
+  EXPECT(heap.alloc(64) == p);
+  EXPECT(stats.slotHits[1] == 1);
+
+  p = heap.alloc(1000);
+  EXPECT(p != nullptr);
+  EXPECT(stats.dynamicAllocs == 1 && stats.dynamicBytes == 1000 && stats.maxDynamicSize == 1000);
+  heap.release(p, 1000);
+
+  EXPECT(heap.alloc(1000) != nullptr);
+  EXPECT(stats.dynamicAllocs == 1 && stats.dynamicReuses == 1);
+
+  INFO("ZoneHeap::initSlotTable()");
+  static const uint32_t invalidSizes[] = { 32, 32 };
+  static const uint32_t unalignedSizes[] = { 32, 48 };
+  static const uint32_t sizes[] = { 64, 1024, 2048 };
+
+  ZoneHeap::SlotTable table;
+  EXPECT(ZoneHeap::initSlotTable(&table, invalidSizes, 2) == kErrorInvalidArgument);
+  EXPECT(ZoneHeap::initSlotTable(&table, unalignedSizes, 2) == kErrorInvalidArgument);
+  EXPECT(ZoneHeap::initSlotTable(&table, sizes, 0) == kErrorInvalidArgument);
+  EXPECT(ZoneHeap::initSlotTable(&table, sizes, 3) == kErrorOk);
+  EXPECT(table.maxSize == 2048);
+
+  INFO("ZoneHeap with a custom slot table");
+  zone.reset(false);
+  heap.reset(&zone);
+  heap.setSlotTable(&table);
+  EXPECT(heap.getSlotTable() == &table);
+  EXPECT(heap.getStats() == &stats);
+  stats.reset();
+
+  p = heap.alloc(1000, allocatedSize);
+  EXPECT(p != nullptr && allocatedSize == 1024);
+  EXPECT(stats.slotMisses[1] == 1 && stats.dynamicAllocs == 0);
+  heap.release(p, allocatedSize);
+  EXPECT(heap.alloc(600) == p);
+  EXPECT(stats.slotHits[1] == 1);
+
+  EXPECT(heap.alloc(1, allocatedSize) != nullptr && allocatedSize == 64);
+  EXPECT(heap.alloc(2049) != nullptr);
+  EXPECT(stats.dynamicAllocs == 1);
+
+  // Exhaust several zone blocks, the tail of each is distributed to slots.
+  for (uint32_t i = 0; i < 64; i++)
+    EXPECT(heap.alloc(2048) != nullptr);
+  EXPECT(stats.slotMisses[2] == 64);
+  EXPECT(stats.wastedBytes < 64 * 64);
+}
+
+UNIT(base_zone_blockpool) {
+  ZoneBlockPool pool(false, 65536);
+
+  INFO("ZoneBlockPool is used by Zone::_alloc() and Zone::reset(true)");
+  {
+    Zone zone(8192 - Zone::kZoneOverhead);
+    zone.setBlockPool(&pool);
+
+    for (int i = 0; i < 100; i++)
+      EXPECT(zone.alloc(1024) != nullptr);
+
+    EXPECT(pool.getMissCount() > 0);
+    EXPECT(pool.getCachedSize() == 0);
+  }
+  EXPECT(pool.getCachedSize() == 65536);
+  EXPECT(pool.getPeakCachedSize() == 65536);
+
+  INFO("ZoneBlockPool serves blocks from its cache");
+  {
+    Zone zone(8192 - Zone::kZoneOverhead);
+    zone.setBlockPool(&pool);
+
+    EXPECT(zone.alloc(1024) != nullptr);
+    EXPECT(pool.getHitCount() == 1);
+    EXPECT(pool.getCachedSize() == 65536 - 8192);
+  }
+
+  INFO("ZoneBlockPool::trim()");
+  pool.trim(8192);
+  EXPECT(pool.getCachedSize() <= 8192);
+  pool.trim();
+  EXPECT(pool.getCachedSize() == 0);
 }
 
 UNIT(base_ZoneBitVector) {
@@ -954,6 +1606,60 @@ UNIT(base_zonestack) {
   }
   EXPECT(stack.isEmpty());
 }
+
+namespace {
+struct ZoneFlatHashTestKey {
+  ASMJIT_INLINE ZoneFlatHashTestKey(uint32_t key) noexcept
+    : hVal(key & 0xFF),
+      key(key) {}
+
+  ASMJIT_INLINE bool matches(const ZoneHashNode* node) const noexcept {
+    return node->_customData == key;
+  }
+
+  uint32_t hVal;
+  uint32_t key;
+};
+} // anonymous namespace
+
+UNIT(base_zoneflathash) {
+  Zone zone(8096 - Zone::kZoneOverhead);
+  ZoneHeap heap(&zone);
+  ZoneFlatHash<ZoneHashNode> hash(&heap);
+
+  uint32_t i;
+  uint32_t kMax = 5000;
+
+  // Only 256 distinct hashes, so most lookups have to compare several slots.
+  ZoneHashNode* nodes = heap.allocT<ZoneHashNode>(kMax * sizeof(ZoneHashNode));
+  EXPECT(nodes != nullptr);
+
+  INFO("ZoneFlatHash::put()");
+  EXPECT(hash.get(ZoneFlatHashTestKey(0)) == nullptr);
+  for (i = 0; i < kMax; i++) {
+    nodes[i]._hVal = i & 0xFF;
+    nodes[i]._customData = i;
+    EXPECT(hash.put(&nodes[i]) == &nodes[i]);
+  }
+  EXPECT(hash.getSize() == kMax);
+  EXPECT(hash.getCapacity() >= kMax * 2);
+
+  INFO("ZoneFlatHash::get()");
+  for (i = 0; i < kMax; i++)
+    EXPECT(hash.get(ZoneFlatHashTestKey(i)) == &nodes[i], "Node %u not found", i);
+  EXPECT(hash.get(ZoneFlatHashTestKey(kMax)) == nullptr);
+
+  INFO("ZoneFlatHash::del()");
+  for (i = 0; i < kMax; i += 2)
+    EXPECT(hash.del(&nodes[i]) == &nodes[i]);
+  EXPECT(hash.getSize() == kMax / 2);
+
+  for (i = 0; i < kMax; i++) {
+    ZoneHashNode* node = hash.get(ZoneFlatHashTestKey(i));
+    EXPECT(node == ((i & 1) ? &nodes[i] : static_cast<ZoneHashNode*>(nullptr)),
+      "Node %u has invalid state after del()", i);
+  }
+}
 #endif // ASMJIT_TEST
 
 } // asmjit namespace
@@ -9,6 +9,7 @@
 #define _ASMJIT_BASE_ZONE_H
 
 // [Dependencies]
+#include "../base/osutils.h"
 #include "../base/utils.h"
 
 // [Api-Begin]
@@ -19,6 +20,11 @@ namespace asmjit {
 //! \addtogroup asmjit_base
 //! \{
 
+// [Forward Declarations]
+// ============================================================================
+
+class ZoneBlockPool;
+
 // ============================================================================
 // [asmjit::Zone]
 // ============================================================================
@@ -64,6 +70,9 @@ public:
   //! It's not required, but it's good practice to set `blockSize` to a
   //! reasonable value that depends on the usage of `Zone`. Greater block sizes
   //! are generally safer and perform better than unreasonably low values.
+  //!
+  //! The `Zone` uses `ZoneBlockPool::getDefault()` to allocate its blocks,
+  //! which is null by default (blocks are allocated by libc `malloc()`).
   ASMJIT_API Zone(uint32_t blockSize, uint32_t blockAlignment = 0) noexcept;
 
   //! Destroy the `Zone` instance.
@@ -87,10 +96,47 @@ public:
 
   //! Get the default block size.
   ASMJIT_INLINE uint32_t getBlockSize() const noexcept { return _blockSize; }
+  //! Get the block pool used to allocate blocks, null if blocks are allocated
+  //! by libc `malloc()`.
+  ASMJIT_INLINE ZoneBlockPool* getBlockPool() const noexcept { return _blockPool; }
+  //! Set the block pool used to allocate blocks.
+  //!
+  //! Can only be called when the `Zone` has no blocks, it's either new or it
+  //! was reset by `reset(true)`.
+  ASMJIT_INLINE void setBlockPool(ZoneBlockPool* pool) noexcept {
+    ASMJIT_ASSERT(_ptr == nullptr);
+    _blockPool = pool;
+  }
   //! Get the default block alignment.
   ASMJIT_INLINE uint32_t getBlockAlignment() const noexcept { return (uint32_t)1 << _blockAlignmentShift; }
   //! Get remaining size of the current block.
   ASMJIT_INLINE size_t getRemainingSize() const noexcept { return (size_t)(_end - _ptr); }
+  //! Get the number of bytes allocated since the last `reset()`, including
+  //! alignment padding and unused tails of all blocks before the current one.
+  ASMJIT_API size_t getUsedSize() const noexcept;
+
+  // --------------------------------------------------------------------------
+  // [State]
+  // --------------------------------------------------------------------------
+
+  //! Zone state, see \ref saveState() and \ref restoreState().
+  struct State {
+    uint8_t* ptr;                        //!< Saved `Zone::_ptr`.
+    Block* block;                        //!< Saved `Zone::_block`.
+  };
+
+  //! Save the current state of the zone to `state`.
+  ASMJIT_INLINE void saveState(State* state) const noexcept {
+    state->ptr = _ptr;
+    state->block = _block;
+  }
+
+  //! Restore the zone to `state` previously saved by `saveState()`.
+  //!
+  //! Memory allocated before the state was saved stays valid, everything
+  //! allocated after is invalidated. Blocks are kept and reused by following
+  //! allocations, like `reset(false)` does.
+  ASMJIT_API void restoreState(const State& state) noexcept;
 
   //! Get the current zone cursor (dangerous).
   //!
@@ -225,6 +271,7 @@ public:
   uint8_t* _ptr;                         //!< Pointer in the current block's buffer.
   uint8_t* _end;                         //!< End of the current block's buffer.
   Block* _block;                         //!< Current block.
+  ZoneBlockPool* _blockPool;             //!< Block pool, null if not used.
 
 #if ASMJIT_ARCH_64BIT
   uint32_t _blockSize;                   //!< Default size of a newly allocated block.
@@ -235,6 +282,122 @@ public:
 #endif
 };
 
+// [asmjit::ZoneBlockPool]
+// ============================================================================
+
+//! Cache of zone blocks shared by multiple \ref Zone instances.
+//!
+//! Each \ref Zone allocates its blocks by libc `malloc()` and releases them
+//! by `reset(true)` or when destroyed, which turns short-lived zones into a
+//! malloc/free storm when many code generators are created and destroyed by
+//! multiple threads. A `ZoneBlockPool` keeps released blocks in power-of-2
+//! size classes and gives them to the next zone that needs a block of the
+//! same class. Blocks not fitting into any class are allocated by `malloc()`.
+//!
+//! The pool keeps at most `getMaxCachedSize()` bytes (high-water mark), any
+//! block released above it is returned to the system. A pool created with
+//! `threadSafe` set to false doesn't lock and can be used as a per-thread
+//! pool, either set to zones explicitly by `Zone::setBlockPool()` or as a
+//! default pool of zones created by a single thread.
+//!
+//! All zones that use a pool must be destroyed (or reset by `reset(true)`)
+//! before the pool is destroyed.
+class ZoneBlockPool {
+public:
+  ASMJIT_NONCOPYABLE(ZoneBlockPool)
+
+  enum {
+    kMinBlockShift = 12,                 //!< Size of the smallest class (4kB).
+    kMaxBlockShift = 18,                 //!< Size of the largest class (256kB).
+    kClassCount = kMaxBlockShift - kMinBlockShift + 1
+  };
+
+  //! Default high-water mark of cached blocks (4MB).
+  static const size_t kDefaultMaxCachedSize = 4 * 1024 * 1024;
+
+  // --------------------------------------------------------------------------
+  // [Construction / Destruction]
+  // --------------------------------------------------------------------------
+
+  //! Create a new `ZoneBlockPool`.
+  ASMJIT_API ZoneBlockPool(bool threadSafe = true, size_t maxCachedSize = kDefaultMaxCachedSize) noexcept;
+  //! Destroy the `ZoneBlockPool` and release all cached blocks.
+  ASMJIT_API ~ZoneBlockPool() noexcept;
+
+  // --------------------------------------------------------------------------
+  // [Global]
+  // --------------------------------------------------------------------------
+
+  //! Get the global, thread-safe, `ZoneBlockPool` instance.
+  ASMJIT_API static ZoneBlockPool* getGlobal() noexcept;
+
+  //! Get the pool used by zones created from now on (null by default).
+  ASMJIT_API static ZoneBlockPool* getDefault() noexcept;
+  //! Set the pool used by zones created from now on, for example
+  //! `ZoneBlockPool::setDefault(ZoneBlockPool::getGlobal())`.
+  //!
+  //! Existing zones keep using the pool they were created with. This should
+  //! be called before other threads start creating zones.
+  ASMJIT_API static void setDefault(ZoneBlockPool* pool) noexcept;
+
+  // --------------------------------------------------------------------------
+  // [Accessors]
+  // --------------------------------------------------------------------------
+
+  //! Get whether the pool is thread-safe.
+  ASMJIT_INLINE bool isThreadSafe() const noexcept { return _threadSafe != 0; }
+
+  //! Get the high-water mark of cached blocks, in bytes.
+  ASMJIT_INLINE size_t getMaxCachedSize() const noexcept { return _maxCachedSize; }
+  //! Set the high-water mark of cached blocks, in bytes. Blocks above `size`
+  //! are released immediately.
+  ASMJIT_API void setMaxCachedSize(size_t size) noexcept;
+
+  //! Get the size of all blocks currently cached, in bytes.
+  ASMJIT_INLINE size_t getCachedSize() const noexcept { return _cachedSize; }
+  //! Get the largest size of cached blocks seen since the pool was created.
+  ASMJIT_INLINE size_t getPeakCachedSize() const noexcept { return _peakCachedSize; }
+
+  //! Get the number of allocations served from the cache.
+  ASMJIT_INLINE uint64_t getHitCount() const noexcept { return _hitCount; }
+  //! Get the number of allocations passed to `malloc()`.
+  ASMJIT_INLINE uint64_t getMissCount() const noexcept { return _missCount; }
+
+  // --------------------------------------------------------------------------
+  // [Alloc / Release]
+  // --------------------------------------------------------------------------
+
+  //! Allocate a block of at least `size` bytes, the size of the returned block
+  //! is stored to `allocatedSize` and must be passed to `release()`.
+  ASMJIT_API void* alloc(size_t size, size_t& allocatedSize) noexcept;
+  //! Release a block previously returned by `alloc()`.
+  ASMJIT_API void release(void* p, size_t size) noexcept;
+
+  //! Release cached blocks to the system until at most `size` bytes remain
+  //! cached, `trim()` releases all of them.
+  ASMJIT_API void trim(size_t size = 0) noexcept;
+
+  // --------------------------------------------------------------------------
+  // [Members]
+  // --------------------------------------------------------------------------
+
+  //! \internal
+  //!
+  //! Cached block, linked by its first pointer.
+  struct CachedBlock {
+    CachedBlock* next;                   //!< Next cached block of the same class.
+  };
+
+  Lock _lock;                            //!< Lock, used only if `_threadSafe`.
+  uint8_t _threadSafe;                   //!< The pool is thread-safe.
+  size_t _maxCachedSize;                 //!< Maximum size of cached blocks (high-water mark).
+  size_t _cachedSize;                    //!< Size of all cached blocks.
+  size_t _peakCachedSize;                //!< Peak size of cached blocks.
+  uint64_t _hitCount;                    //!< Allocations served from the cache.
+  uint64_t _missCount;                   //!< Allocations passed to `malloc()`.
+  CachedBlock* _blocks[kClassCount];     //!< Cached blocks, per size class.
+};
+
 // ============================================================================
 // [asmjit::ZoneHeap]
 // ============================================================================
@@ -273,7 +436,37 @@ class ZoneHeap {
     kHiMaxSize = kLoMaxSize + kHiGranularity * kHiCount,
 
     //! Alignment of every pointer returned by `alloc()`.
-    kBlockAlignment = kLoGranularity
+    kBlockAlignment = kLoGranularity,
+
+    //! Maximum number of slots (the default table uses `kLoCount + kHiCount`).
+    kMaxSlots = 16,
+    //! Maximum size of a slot of a custom \ref SlotTable.
+    kMaxSlotSize = 4096
+  };
+
+  //! Table of slot sizes used instead of the default lo/hi granularity slots,
+  //! see \ref initSlotTable() and \ref setSlotTable().
+  struct SlotTable {
+    uint32_t count;                      //!< Count of slots.
+    uint32_t maxSize;                    //!< Size of the largest slot.
+    uint32_t sizes[kMaxSlots];           //!< Size of each slot, ascending.
+    uint8_t index[kMaxSlotSize / kBlockAlignment]; //!< `(size - 1) / kBlockAlignment` -> slot.
+  };
+
+  //! ZoneHeap statistics, collected only if attached by \ref setStats().
+  //!
+  //! Counters are only incremented, so the same `Stats` can be attached to
+  //! multiple heaps to aggregate them.
+  struct Stats {
+    ASMJIT_INLINE void reset() noexcept { ::memset(this, 0, sizeof(*this)); }
+
+    size_t slotHits[kMaxSlots];          //!< Allocations served by a released chunk of the slot.
+    size_t slotMisses[kMaxSlots];        //!< Allocations of the slot carved from the `Zone`.
+    size_t dynamicAllocs;                //!< Dynamic blocks allocated by `malloc()`.
+    size_t dynamicReuses;                //!< Dynamic blocks reused from spare blocks.
+    size_t dynamicBytes;                 //!< Bytes requested by dynamic allocations.
+    size_t maxDynamicSize;               //!< Largest dynamic allocation requested.
+    size_t wastedBytes;                  //!< Slot rounding and zone tails too small for any slot.
   };
 
   //! Single-linked list used to store unused chunks.
@@ -288,6 +481,7 @@ class ZoneHeap {
   struct DynamicBlock {
     DynamicBlock* prev;
     DynamicBlock* next;
+    size_t size;                         //!< Size of the whole block, including overhead.
   };
 
   // --------------------------------------------------------------------------
@@ -325,6 +519,15 @@ class ZoneHeap {
   //! keeps the `ZoneHeap` in an uninitialized state, if `zone` is null.
   ASMJIT_API void reset(Zone* zone = nullptr) noexcept;
 
+  //! Reset this `ZoneHeap` like `reset(zone)`, but keep all dynamic blocks
+  //! for reuse by following allocations instead of releasing them.
+  //!
+  //! All memory previously allocated by the `ZoneHeap` is invalidated. This
+  //! is used to recycle containers that are regenerated over and over, so
+  //! they don't allocate after the first round (the `zone` should be reset
+  //! or restored by the caller).
+  ASMJIT_API void recycle(Zone* zone) noexcept;
+
   // --------------------------------------------------------------------------
   // [Accessors]
   // --------------------------------------------------------------------------
@@ -332,6 +535,38 @@ class ZoneHeap {
   //! Get the `Zone` the `ZoneHeap` is using, or null if it's not initialized.
   ASMJIT_INLINE Zone* getZone() const noexcept { return _zone; }
 
+  //! Get the slot table, null if the default lo/hi granularity slots are used.
+  ASMJIT_INLINE const SlotTable* getSlotTable() const noexcept { return _slotTable; }
+  //! Use slot sizes of `table`, or the default slots if `table` is null.
+  //!
+  //! The table is only referenced, so it must outlive the heap. It can only
+  //! be changed if the heap has no allocated memory (after `reset()` or
+  //! `recycle()`), because `release()` maps sizes to slots through it. The
+  //! table is kept by `reset()` and `recycle()`.
+  ASMJIT_INLINE void setSlotTable(const SlotTable* table) noexcept {
+    ::memset(_slots, 0, sizeof(_slots));
+    _slotTable = table;
+  }
+
+  //! Get statistics attached by `setStats()`, or null.
+  ASMJIT_INLINE Stats* getStats() const noexcept { return _stats; }
+  //! Attach `stats` to be updated by allocations (or detach them if null).
+  //!
+  //! Statistics are kept by `reset()` and `recycle()`, they are reset only
+  //! by `Stats::reset()`.
+  ASMJIT_INLINE void setStats(Stats* stats) noexcept { _stats = stats; }
+
+  // --------------------------------------------------------------------------
+  // [Slot Table]
+  // --------------------------------------------------------------------------
+
+  //! Initialize `table` from `count` slot `sizes`.
+  //!
+  //! Sizes must be ascending multiples of `kBlockAlignment` not greater than
+  //! `kMaxSlotSize`, and at most `kMaxSlots` of them can be used. Returns
+  //! `kErrorInvalidArgument` if they are not.
+  static ASMJIT_API Error initSlotTable(SlotTable* table, const uint32_t* sizes, uint32_t count) noexcept;
+
   // --------------------------------------------------------------------------
   // [Utilities]
   // --------------------------------------------------------------------------
@@ -341,8 +576,17 @@ class ZoneHeap {
   //! Get the slot index to be used for `size`. Returns `true` if a valid slot
   //! has been written to `slot` and `allocatedSize` has been filled with slot
   //! exact size (`allocatedSize` can be equal or slightly greater than `size`).
-  static ASMJIT_INLINE bool _getSlotIndex(size_t size, uint32_t& slot) noexcept {
+  ASMJIT_INLINE bool _getSlotIndex(size_t size, uint32_t& slot) const noexcept {
     ASMJIT_ASSERT(size > 0);
+    const SlotTable* table = _slotTable;
+
+    if (ASMJIT_UNLIKELY(table)) {
+      if (size > table->maxSize)
+        return false;
+      slot = table->index[(size - 1) / kBlockAlignment];
+      return true;
+    }
+
     if (size > kHiMaxSize)
       return false;
 
@@ -355,8 +599,18 @@ class ZoneHeap {
   }
 
   //! \overload
-  static ASMJIT_INLINE bool _getSlotIndex(size_t size, uint32_t& slot, size_t& allocatedSize) noexcept {
+  ASMJIT_INLINE bool _getSlotIndex(size_t size, uint32_t& slot, size_t& allocatedSize) const noexcept {
     ASMJIT_ASSERT(size > 0);
+    const SlotTable* table = _slotTable;
+
+    if (ASMJIT_UNLIKELY(table)) {
+      if (size > table->maxSize)
+        return false;
+      slot = table->index[(size - 1) / kBlockAlignment];
+      allocatedSize = table->sizes[slot];
+      return true;
+    }
+
     if (size > kHiMaxSize)
       return false;
 
@@ -449,8 +703,11 @@ class ZoneHeap {
   // --------------------------------------------------------------------------
 
   Zone* _zone;                           //!< Zone used to allocate memory that fits into slots.
-  Slot* _slots[kLoCount + kHiCount];     //!< Indexed slots containing released memory.
+  Slot* _slots[kMaxSlots];               //!< Indexed slots containing released memory.
   DynamicBlock* _dynamicBlocks;          //!< Dynamic blocks for larger allocations (no slots).
+  DynamicBlock* _spareBlocks;            //!< Dynamic blocks released or recycled, kept for reuse.
+  const SlotTable* _slotTable;           //!< Custom slot sizes, null if default.
+  Stats* _stats;                         //!< Statistics, null if not collected.
 };
 
 // ============================================================================
@@ -685,7 +942,7 @@ public:
       ASMJIT_PROPAGATE(grow(heap, 1));
 
     T* dst = static_cast<T*>(_data) + index;
-    ::memmove(dst + 1, dst, _length - index);
+    ::memmove(dst + 1, dst, (_length - index) * sizeof(T));
     ::memcpy(dst, &item, sizeof(T));
 
     _length++;
@@ -703,17 +960,27 @@ public:
     return kErrorOk;
   }
 
-  Error concat(ZoneHeap* heap, const ZoneVector<T>& other) noexcept {
-    size_t count = other._length;
+  //! Append `count` items starting at `items` to the vector.
+  //!
+  //! Grows the vector at most once, use it instead of calling `append()` in
+  //! a loop when the number of items is known. `items` must not point into
+  //! this vector.
+  Error append(ZoneHeap* heap, const T* items, size_t count) noexcept {
     if (_capacity - _length < count)
       ASMJIT_PROPAGATE(grow(heap, count));
 
-    ::memcpy(static_cast<T*>(_data) + _length, other._data, count * sizeof(T));
+    if (count)
+      ::memcpy(static_cast<T*>(_data) + _length, items, count * sizeof(T));
 
     _length += count;
     return kErrorOk;
   }
 
+  //! Concatenate all items of `other` at the end of the vector.
+  ASMJIT_INLINE Error concat(ZoneHeap* heap, const ZoneVector<T>& other) noexcept {
+    return append(heap, static_cast<const T*>(other._data), other._length);
+  }
+
   //! Prepend `item` to the vector (unsafe case).
   //!
   //! Can only be used together with `willGrow()`. If `willGrow(N)` returns
@@ -742,15 +1009,22 @@ public:
     _length++;
   }
 
-  //! Concatenate all items of `other` at the end of the vector.
-  ASMJIT_INLINE void concatUnsafe(const ZoneVector<T>& other) noexcept {
-    size_t count = other._length;
+  //! Append `count` items starting at `items` to the vector (unsafe case).
+  //!
+  //! Can only be used together with `willGrow(count)`.
+  ASMJIT_INLINE void appendUnsafe(const T* items, size_t count) noexcept {
     ASMJIT_ASSERT(_capacity - _length >= count);
 
-    ::memcpy(static_cast<T*>(_data) + _length, other._data, count * sizeof(T));
+    if (count)
+      ::memcpy(static_cast<T*>(_data) + _length, items, count * sizeof(T));
     _length += count;
   }
 
+  //! Concatenate all items of `other` at the end of the vector.
+  ASMJIT_INLINE void concatUnsafe(const ZoneVector<T>& other) noexcept {
+    appendUnsafe(static_cast<const T*>(other._data), other._length);
+  }
+
   //! Get index of `val` or `kInvalidIndex` if not found.
   ASMJIT_INLINE size_t indexOf(const T& val) const noexcept {
     const T* data = static_cast<const T*>(_data);
@@ -774,7 +1048,7 @@ public:
 
     T* data = static_cast<T*>(_data) + i;
     _length--;
-    ::memmove(data, data + 1, _length - i);
+    ::memmove(data, data + 1, (_length - i) * sizeof(T));
   }
 
   //! Swap this pod-vector with `other`.
@@ -1318,6 +1592,127 @@ public:
   ASMJIT_INLINE Node* del(Node* node) noexcept { return static_cast<Node*>(_del(node)); }
 };
 
+// ============================================================================
+// [asmjit::ZoneFlatHashBase]
+// ============================================================================
+
+//! Open-addressing counterpart of \ref ZoneHashBase.
+//!
+//! Nodes are not chained, each slot stores a copy of the node's hash next to
+//! the node pointer, so a lookup scans a contiguous run of slots and touches
+//! a node only if its hash matches the key's hash. Nodes still inherit from
+//! \ref ZoneHashNode, but `_hashNext` is not used.
+class ZoneFlatHashBase {
+public:
+  ASMJIT_NONCOPYABLE(ZoneFlatHashBase)
+
+  enum {
+    kMinCapacity = 16                    //!< Capacity of the first allocated table.
+  };
+
+  //! Slot of the table, empty if `node` is null.
+  struct Slot {
+    uint32_t hVal;                       //!< Copy of `node->_hVal`.
+    ZoneHashNode* node;                  //!< Node, null if the slot is empty.
+  };
+
+  // --------------------------------------------------------------------------
+  // [Construction / Destruction]
+  // --------------------------------------------------------------------------
+
+  ASMJIT_INLINE ZoneFlatHashBase(ZoneHeap* heap) noexcept {
+    _heap = heap;
+    _size = 0;
+    _capacity = 0;
+    _shift = 32;
+    _data = nullptr;
+  }
+  ASMJIT_INLINE ~ZoneFlatHashBase() noexcept { reset(nullptr); }
+
+  // --------------------------------------------------------------------------
+  // [Reset]
+  // --------------------------------------------------------------------------
+
+  ASMJIT_INLINE bool isInitialized() const noexcept { return _heap != nullptr; }
+  ASMJIT_API void reset(ZoneHeap* heap) noexcept;
+
+  // --------------------------------------------------------------------------
+  // [Accessors]
+  // --------------------------------------------------------------------------
+
+  //! Get a `ZoneHeap` attached to this container.
+  ASMJIT_INLINE ZoneHeap* getHeap() const noexcept { return _heap; }
+
+  ASMJIT_INLINE size_t getSize() const noexcept { return _size; }
+  ASMJIT_INLINE uint32_t getCapacity() const noexcept { return _capacity; }
+
+  //! Get the home slot of `hVal` (Fibonacci hashing, uses the high bits of
+  //! the product so weak hashes still spread over the whole table).
+  ASMJIT_INLINE uint32_t _indexOf(uint32_t hVal) const noexcept {
+    return static_cast<uint32_t>((hVal * 0x9E3779B1U) >> _shift);
+  }
+
+  // --------------------------------------------------------------------------
+  // [Ops]
+  // --------------------------------------------------------------------------
+
+  //! Grow the table so `n` nodes can be inserted without rehashing.
+  ASMJIT_API Error reserve(size_t n) noexcept;
+
+  ASMJIT_API Error _rehash(uint32_t newCapacity) noexcept;
+  ASMJIT_API ZoneHashNode* _put(ZoneHashNode* node) noexcept;
+  ASMJIT_API ZoneHashNode* _del(ZoneHashNode* node) noexcept;
+
+  // --------------------------------------------------------------------------
+  // [Members]
+  // --------------------------------------------------------------------------
+
+  ZoneHeap* _heap;                       //!< ZoneHeap used to allocate data.
+  size_t _size;                          //!< Count of records inserted into the hash table.
+  uint32_t _capacity;                    //!< Count of slots (zero or a power of 2).
+  uint32_t _shift;                       //!< Shift used by `_indexOf()`, `32 - log2(_capacity)`.
+  Slot* _data;                           //!< Slots.
+};
+
+// ============================================================================
+// [asmjit::ZoneFlatHash<Node>]
+// ============================================================================
+
+//! Open-addressing hash table having the same interface as \ref ZoneHash.
+//!
+//! Linear probing is used and the table is kept at most half full. Unlike
+//! `ZoneHash::put()` the `put()` can fail (returns null) if the table had to
+//! grow and the allocation failed.
+template<typename Node>
+class ZoneFlatHash : public ZoneFlatHashBase {
+public:
+  explicit ASMJIT_INLINE ZoneFlatHash(ZoneHeap* heap = nullptr) noexcept
+    : ZoneFlatHashBase(heap) {}
+  ASMJIT_INLINE ~ZoneFlatHash() noexcept {}
+
+  template<typename Key>
+  ASMJIT_INLINE Node* get(const Key& key) const noexcept {
+    if (ASMJIT_UNLIKELY(!_capacity))
+      return nullptr;
+
+    uint32_t mask = _capacity - 1;
+    uint32_t i = _indexOf(key.hVal);
+
+    for (;;) {
+      const Slot& slot = _data[i];
+      if (!slot.node)
+        return nullptr;
+
+      if (slot.hVal == key.hVal && key.matches(static_cast<Node*>(slot.node)))
+        return static_cast<Node*>(slot.node);
+      i = (i + 1) & mask;
+    }
+  }
+
+  ASMJIT_INLINE Node* put(Node* node) noexcept { return static_cast<Node*>(_put(node)); }
+  ASMJIT_INLINE Node* del(Node* node) noexcept { return static_cast<Node*>(_del(node)); }
+};
+
 //! \}
 
 } // asmjit namespace
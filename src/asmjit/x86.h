@@ -12,12 +12,25 @@
 #include "./base.h"
 
 #include "./x86/x86assembler.h"
+#include "./x86/x86blocklayout.h"
 #include "./x86/x86builder.h"
 #include "./x86/x86compiler.h"
+#include "./x86/x86decoder.h"
+#include "./x86/x86dispatch.h"
 #include "./x86/x86emitter.h"
 #include "./x86/x86inst.h"
+#include "./x86/x86jumprelax.h"
+#include "./x86/x86loop.h"
+#include "./x86/x86loopalign.h"
 #include "./x86/x86misc.h"
 #include "./x86/x86operand.h"
+#include "./x86/x86parser.h"
+#include "./x86/x86peephole.h"
+#include "./x86/x86scheduler.h"
+#include "./x86/x86staticemitter.h"
+#include "./x86/x86template.h"
+#include "./x86/x86valuenumber.h"
+#include "./x86/x86vzeroupper.h"
 
 // [Guard]
 #endif // _ASMJIT_X86_H
@@ -15,9 +15,13 @@
 #include "../base/cpuinfo.h"
 #include "../base/logging.h"
 #include "../base/misc_p.h"
+#include "../base/runtime.h"
 #include "../base/utils.h"
 #include "../x86/x86assembler.h"
+#include "../x86/x86decoder.h"
+#include "../x86/x86instimpl_p.h"
 #include "../x86/x86logging_p.h"
+#include "../x86/x86staticemitter.h"
 
 // [Api-Begin]
 #include "../asmjit_apibegin.h"
@@ -304,6 +308,49 @@ static ASMJIT_INLINE int64_t x86SignExtend32To64(int64_t imm) noexcept {
   return static_cast<int64_t>(static_cast<int32_t>(imm & 0xFFFFFFFF));
 }
 
+//! Count instruction `[start, end)` in `stats`, see \ref CodeStats.
+//!
+//! Called only if statistics are enabled, so it's kept out of `_emit()`.
+static ASMJIT_NOINLINE void x86CollectStats(CodeStats& stats, uint32_t archType, const uint8_t* start, const uint8_t* end, bool isRelJump) noexcept {
+  const uint8_t* p = start;
+
+  stats.instCount++;
+  stats.instSize += (uint64_t)(end - start);
+
+  for (; p != end; p++) {
+    uint32_t b = p[0];
+    if (b != 0x66 && b != 0x67 && b != 0xF0 && b != 0xF2 && b != 0xF3 &&
+        b != 0x2E && b != 0x36 && b != 0x3E && b != 0x26 && b != 0x64 && b != 0x65)
+      break;
+    stats.prefixCount++;
+  }
+
+  if (p != end) {
+    uint32_t b = p[0];
+    bool is64Bit = archType == ArchInfo::kTypeX64;
+
+    // In 32-bit mode VEX, XOP, and EVEX prefixes alias LDS, LES, POP, and
+    // BOUND, they are only prefixes if the next byte has a register ModR/M.
+    bool isVexLike = p + 1 != end && (is64Bit || (p[1] & 0xC0) == 0xC0);
+
+    if (is64Bit && (b & 0xF0) == kX86ByteRex)
+      stats.rexCount++;
+    else if ((b == kX86ByteVex2 || b == kX86ByteVex3) && isVexLike)
+      stats.vexCount++;
+    else if (b == kX86ByteXop3 && p + 1 != end && (p[1] & 0x1F) >= 8)
+      stats.vexCount++;
+    else if (b == kX86ByteEvex && isVexLike)
+      stats.evexCount++;
+  }
+
+  if (isRelJump) {
+    if (end - start <= 3)
+      stats.rel8Count++;
+    else
+      stats.rel32Count++;
+  }
+}
+
 //! Get `O` field of `opCode`.
 static ASMJIT_INLINE uint32_t x86ExtractO(uint32_t opCode) noexcept {
   return (opCode >> X86Inst::kOpCode_O_Shift) & 0x07;
@@ -356,6 +403,7 @@ static ASMJIT_INLINE uint32_t x86EncodeSib(uint32_t s, uint32_t i, uint32_t b) n
 // ============================================================================
 
 X86Assembler::X86Assembler(CodeHolder* code) noexcept : Assembler() {
+  _validationCache.reset();
   if (code)
     code->attach(this);
 }
@@ -582,8 +630,16 @@ Error X86Assembler::_emit(uint32_t instId, const Operand_& o0, const Operand_& o
         opArray[5].reset();
       }
 
-      err = Inst::validate(getArchType(), Inst::Detail(instId, options, _extraReg), opArray, 6);
+      err = X86InstImpl::validate(getArchType(), Inst::Detail(instId, options, _extraReg), opArray, 6, &_validationCache);
       if (ASMJIT_UNLIKELY(err)) goto Failed;
+
+#if !defined(ASMJIT_DISABLE_EXTENSIONS)
+      // Reject instructions the target CPU doesn't have.
+      if (_codeInfo.hasFeatures()) {
+        err = Inst::validateFeatures(getArchType(), Inst::Detail(instId, options, _extraReg), opArray, 6, _codeInfo.getFeatures());
+        if (ASMJIT_UNLIKELY(err)) goto Failed;
+      }
+#endif // !ASMJIT_DISABLE_EXTENSIONS
     }
 #endif // !ASMJIT_DISABLE_VALIDATION
 
@@ -2923,8 +2979,14 @@ CaseVexRmi:
 CaseVexRvm:
       if (isign3 == ENC_OPS3(Reg, Reg, Reg)) {
 CaseVexRvm_R:
-        opReg = x86PackRegAndVvvvv(o0.getId(), o1.getId());
+        opReg = o1.getId();
         rbReg = o2.getId();
+
+        // Move an extended register from ModRM.rm to VVVVV to make VEX2 possible.
+        if ((_globalHints & kHintShortestEncoding) && (rbReg & 0x18) == 0x08 && (opReg & 0x18) == 0x00 && X86Inst::isCommutative(instId))
+          Utils::swap(opReg, rbReg);
+
+        opReg = x86PackRegAndVvvvv(o0.getId(), opReg);
         goto EmitVexEvexR;
       }
 
@@ -3116,6 +3178,16 @@ CaseVexRvm_R:
       if (isign3 == ENC_OPS2(Reg, Reg)) {
         opReg = o0.getId();
         rbReg = o1.getId();
+
+        // Use the MR form if that moves an extended register out of ModRM.rm.
+        if (!(options & X86Inst::kOptionModMR)) {
+          if (!(_globalHints & kHintShortestEncoding) || (rbReg & 0x18) != 0x08 || (opReg & 0x18) != 0x00)
+            goto EmitVexEvexR;
+        }
+
+        opCode &= X86Inst::kOpCode_LL_Mask;
+        opCode |= commonData->getAltOpCode();
+        Utils::swap(opReg, rbReg);
         goto EmitVexEvexR;
       }
 
@@ -3788,8 +3860,30 @@ EmitModSib:
           }
         }
 
-        if (ASMJIT_UNLIKELY(!absoluteValid))
-          goto InvalidAddress64Bit;
+        if (!absoluteValid) {
+          if (ASMJIT_UNLIKELY(baseAddress != Globals::kNoBaseAddress || preferAbsolute))
+            goto InvalidAddress64Bit;
+
+          // The base address is not known yet, emit [RIP+REL32] and let the
+          // relocator calculate it. It fails if the address is too far.
+          if (ASMJIT_UNLIKELY(_code->_relocations.willGrow(&_code->_baseHeap) != kErrorOk))
+            goto NoHeapMemory;
+
+          err = _code->newRelocEntry(&re, RelocEntry::kTypeAbsToRel, 4);
+          if (ASMJIT_UNLIKELY(err)) goto Failed;
+
+          EMIT_BYTE(x86EncodeMod(0, opReg, 5));
+
+          re->_sourceSectionId = _section->getId();
+          re->_sourceOffset = static_cast<uint64_t>((uintptr_t)(cursor - _bufferData));
+          re->_data = static_cast<int64_t>(rmRel->as<X86Mem>().getOffset()) - static_cast<int64_t>(imLen);
+
+          EMIT_32(0);
+          if (imLen != 0)
+            goto EmitImm;
+          else
+            goto EmitDone;
+        }
 
         EMIT_BYTE(x86EncodeMod(0, opReg, 4));
         EMIT_BYTE(x86EncodeSib(0, 4, 5));
@@ -3820,6 +3914,7 @@ EmitModSib_LabelRip_X86:
 
           if (label->isBound()) {
             // Bound label.
+            re->_targetSectionId = label->getSectionId();
             re->_data += static_cast<uint64_t>(label->getOffset());
             EMIT_32(0);
           }
@@ -3836,6 +3931,7 @@ EmitModSib_LabelRip_X86:
           if (ASMJIT_UNLIKELY(err)) goto Failed;
 
           re->_sourceSectionId = _section->getId();
+          re->_targetSectionId = _section->getId();
           re->_sourceOffset = static_cast<uint64_t>((uintptr_t)(cursor - _bufferData));
           re->_data = re->_sourceOffset + static_cast<uint64_t>(static_cast<int64_t>(relOffset));
           EMIT_32(0);
@@ -3849,13 +3945,13 @@ EmitModSib_LabelRip_X86:
           if (!label) goto InvalidLabel;
 
           relOffset -= (4 + imLen);
-          if (label->isBound()) {
+          if (label->isBound() && label->getSectionId() == _section->getId()) {
             // Bound label.
             relOffset += label->getOffset() - static_cast<int32_t>((intptr_t)(cursor - _bufferData));
             EMIT_32(static_cast<int32_t>(relOffset));
           }
           else {
-            // Non-bound label.
+            // Non-bound label or a label bound in another section.
             relSize = 4;
             goto EmitRel;
           }
@@ -4279,13 +4375,13 @@ EmitJmpCall:
       label = _code->getLabelEntry(rmRel->as<Label>());
       if (!label) goto InvalidLabel;
 
-      if (label->isBound()) {
+      if (label->isBound() && label->getSectionId() == _section->getId()) {
         // Bound label.
         rel32 = static_cast<uint32_t>((static_cast<uint64_t>(label->getOffset()) - ip - inst32Size) & 0xFFFFFFFFU);
         goto EmitJmpCallRel;
       }
       else {
-        // Non-bound label.
+        // Non-bound label or a label bound in another section.
         if (opCode8 && (!opCode || (options & X86Inst::kOptionShortForm))) {
           EMIT_BYTE(opCode8);
           relOffset = -1;
@@ -4417,24 +4513,42 @@ EmitJmpCallRel:
 
 EmitRel:
   {
-    ASMJIT_ASSERT(!label->isBound());
     ASMJIT_ASSERT(relSize == 1 || relSize == 4);
-
-    // Chain with label.
     size_t offset = (size_t)(cursor - _bufferData);
-    LabelLink* link = _code->newLabelLink(label, _section->getId(), offset, relOffset);
 
-    if (ASMJIT_UNLIKELY(!link))
-      goto NoHeapMemory;
+    if (label->isBound()) {
+      // Label bound in another section, patched by the relocator.
+      ASMJIT_ASSERT(label->getSectionId() != _section->getId());
+      ASMJIT_ASSERT(re == nullptr);
 
-    if (re)
-      link->relocId = re->getId();
+      if (ASMJIT_UNLIKELY(relSize != 4))
+        goto InvalidDisplacement;
+
+      err = _code->newRelocEntry(&re, RelocEntry::kTypeRelToRel, 4);
+      if (ASMJIT_UNLIKELY(err)) goto Failed;
+
+      re->_sourceSectionId = _section->getId();
+      re->_targetSectionId = label->getSectionId();
+      re->_sourceOffset = static_cast<uint64_t>(offset);
+      re->_data = static_cast<uint64_t>(static_cast<int64_t>(label->getOffset() + relOffset));
+      EMIT_32(0);
+    }
+    else {
+      // Chain with label.
+      LabelLink* link = _code->newLabelLink(label, _section->getId(), offset, relOffset);
+
+      if (ASMJIT_UNLIKELY(!link))
+        goto NoHeapMemory;
 
-    // Emit label size as dummy data.
-    if (relSize == 1)
-      EMIT_BYTE(0x01);
-    else // if (relSize == 4)
-      EMIT_32(0x04040404);
+      if (re)
+        link->relocId = re->getId();
+
+      // Emit label size as dummy data.
+      if (relSize == 1)
+        EMIT_BYTE(0x01);
+      else // if (relSize == 4)
+        EMIT_32(0x04040404);
+    }
   }
 
   if (imLen == 0)
@@ -4480,11 +4594,20 @@ EmitImm:
 
 EmitDone:
 #if !defined(ASMJIT_DISABLE_LOGGING)
-  // Logging is a performance hit anyway, so make it the unlikely case.
-  if (ASMJIT_UNLIKELY(options & CodeEmitter::kOptionLoggingEnabled))
+  // Logging is a performance hit anyway, so make it the unlikely case. The
+  // logger filter is checked here so filtered instructions are not formatted.
+  if (ASMJIT_UNLIKELY(options & CodeEmitter::kOptionLoggingEnabled) && _code->_logger->isEnabled(Logger::kCategoryInst))
     _emitLog(instId, options, o0, o1, o2, o3, relSize, imLen, cursor);
 #endif // !ASMJIT_DISABLE_LOGGING
 
+  if (ASMJIT_UNLIKELY(_code->_traceBuffer))
+    _emitTrace(instId, options, o0, o1, o2, o3, cursor);
+
+  if (ASMJIT_UNLIKELY(_code->_statsEnabled)) {
+    bool isRelJump = instData->getCommonData().doesJump() && (o0.isLabel() || o0.isImm());
+    x86CollectStats(_code->_stats, getArchType(), _bufferPtr, cursor, isRelJump);
+  }
+
   resetOptions();
   resetExtraReg();
   resetInlineComment();
@@ -4530,9 +4653,74 @@ Failed:
 // [asmjit::X86Assembler - Align]
 // ============================================================================
 
+// Multi-byte NOPs recommended by Intel 64 and IA-32 Architectures Optimization
+// Reference Manual, sequences longer than 9 bytes use additional prefixes.
+enum { kX86MaxNopSize = 11 };
+static const uint8_t x86NopData[kX86MaxNopSize][kX86MaxNopSize] = {
+  { 0x90 },
+  { 0x66, 0x90 },
+  { 0x0F, 0x1F, 0x00 },
+  { 0x0F, 0x1F, 0x40, 0x00 },
+  { 0x0F, 0x1F, 0x44, 0x00, 0x00 },
+  { 0x66, 0x0F, 0x1F, 0x44, 0x00, 0x00 },
+  { 0x0F, 0x1F, 0x80, 0x00, 0x00, 0x00, 0x00 },
+  { 0x0F, 0x1F, 0x84, 0x00, 0x00, 0x00, 0x00, 0x00 },
+  { 0x66, 0x0F, 0x1F, 0x84, 0x00, 0x00, 0x00, 0x00, 0x00 },
+  { 0x66, 0x2E, 0x0F, 0x1F, 0x84, 0x00, 0x00, 0x00, 0x00, 0x00 },
+  { 0x66, 0x66, 0x2E, 0x0F, 0x1F, 0x84, 0x00, 0x00, 0x00, 0x00, 0x00 }
+};
+
+void X86Assembler::fillNop(void* dst, size_t size) noexcept {
+  uint8_t* p = static_cast<uint8_t*>(dst);
+
+  while (size >= kX86MaxNopSize) {
+    ::memcpy(p, x86NopData[kX86MaxNopSize - 1], kX86MaxNopSize);
+    p += kX86MaxNopSize;
+    size -= kX86MaxNopSize;
+  }
+
+  if (size)
+    ::memcpy(p, x86NopData[size - 1], size);
+}
+
+//! \internal
+//!
+//! Emit `size` bytes of padding used by `mode` at the current position.
+static Error X86Assembler_pad(X86Assembler* self, uint32_t mode, size_t size) {
+  CodeHolder* code = self->_code;
+  if (self->getRemainingSpace() < size) {
+    Error err = code->growBuffer(&self->_section->_buffer, size);
+    if (ASMJIT_UNLIKELY(err)) return self->setLastError(err);
+  }
+
+  if (ASMJIT_UNLIKELY(code->_statsEnabled))
+    code->_stats.alignSize += size;
+
+  uint8_t* cursor = self->_bufferPtr;
+  switch (mode) {
+    case kAlignCode:
+      if (self->getGlobalHints() & CodeEmitter::kHintOptimizedAlign)
+        X86Assembler::fillNop(cursor, size);
+      else
+        ::memset(cursor, 0x90, size);
+      break;
+
+    case kAlignData:
+      ::memset(cursor, 0xCC, size);
+      break;
+
+    case kAlignZero:
+      ::memset(cursor, 0x00, size);
+      break;
+  }
+
+  self->_bufferPtr = cursor + size;
+  return kErrorOk;
+}
+
 Error X86Assembler::align(uint32_t mode, uint32_t alignment) {
 #if !defined(ASMJIT_DISABLE_LOGGING)
-  if (_globalOptions & kOptionLoggingEnabled)
+  if ((_globalOptions & kOptionLoggingEnabled) && _code->_logger->isEnabled(Logger::kCategoryData))
     _code->_logger->logf("%s.align %u\n", _code->_logger->getIndentation(), alignment);
 #endif // !ASMJIT_DISABLE_LOGGING
 
@@ -4545,68 +4733,591 @@ Error X86Assembler::align(uint32_t mode, uint32_t alignment) {
   if (!Utils::isPowerOf2(alignment) || alignment > Globals::kMaxAlignment)
     return setLastError(DebugUtils::errored(kErrorInvalidArgument));
 
-  uint32_t i = static_cast<uint32_t>(Utils::alignDiff<size_t>(getOffset(), alignment));
+  size_t i = Utils::alignDiff<size_t>(getOffset(), alignment);
   if (i == 0)
     return kErrorOk;
 
-  if (getRemainingSpace() < i) {
-    Error err = _code->growBuffer(&_section->_buffer, i);
-    if (ASMJIT_UNLIKELY(err)) return setLastError(err);
+  return X86Assembler_pad(this, mode, i);
+}
+
+Error X86Assembler::pad(uint32_t mode, size_t size) {
+  if (_lastError) return _lastError;
+
+#if !defined(ASMJIT_DISABLE_LOGGING)
+  if ((_globalOptions & kOptionLoggingEnabled) && _code->_logger->isEnabled(Logger::kCategoryData))
+    _code->_logger->logf("%s.pad %u\n", _code->_logger->getIndentation(), static_cast<unsigned int>(size));
+#endif // !ASMJIT_DISABLE_LOGGING
+
+  if (mode >= kAlignCount)
+    return setLastError(DebugUtils::errored(kErrorInvalidArgument));
+
+  if (size == 0)
+    return kErrorOk;
+
+  return X86Assembler_pad(this, mode, size);
+}
+
+// ============================================================================
+// [asmjit::X86Assembler - Test]
+// ============================================================================
+
+#if defined(ASMJIT_TEST) && (ASMJIT_ARCH_X86 || ASMJIT_ARCH_X64)
+UNIT(x86_assembler_sections) {
+  using namespace x86;
+  typedef int (*Func)(void);
+
+  JitRuntime rt;
+  CodeHolder code;
+  code.init(rt.getCodeInfo());
+  X86Assembler a(&code);
+
+  SectionEntry* cold;
+  SectionEntry* rodata;
+  SectionEntry* dummy;
+
+  INFO("Creating sections");
+  EXPECT(code.newSection(&cold, ".text.cold", Globals::kInvalidIndex,
+    SectionEntry::kFlagExec | SectionEntry::kFlagConst | SectionEntry::kFlagCold, 16) == kErrorOk);
+  EXPECT(code.newSection(&rodata, ".rodata", Globals::kInvalidIndex, SectionEntry::kFlagConst, 16) == kErrorOk);
+  EXPECT(code.newSection(&dummy, ".rodata") == kErrorSectionAlreadyExists,
+    "Sections must have unique names");
+  EXPECT(code.getSectionByName(".text.cold") == cold);
+
+  Label L_Slow = a.newLabel();
+  Label L_Done = a.newLabel();
+  Label L_Const = a.newLabel();
+
+  // Reference labels bound later in other sections (label links).
+  a.mov(eax, dword_ptr(L_Const));
+  a.cmp(eax, 100);
+  a.jne(L_Slow);
+  a.bind(L_Done);
+  a.ret();
+
+  // Reference a label already bound in another section.
+  a.setSection(cold);
+  a.bind(L_Slow);
+  a.add(eax, 1);
+  a.jmp(L_Done);
+
+  a.setSection(rodata);
+  a.bind(L_Const);
+  a.dint32(42);
+
+  INFO("Relocating sections");
+  EXPECT(a.getLastError() == kErrorOk,
+    "Assembler failed: %s", DebugUtils::errorAsString(a.getLastError()));
+
+  Func fn;
+  EXPECT(rt.add(&fn, &code) == kErrorOk);
+  EXPECT(rodata->getOffset() >= code.getSectionEntry(0)->getPhysicalSize() &&
+         cold->getOffset() >= rodata->getOffset() + rodata->getPhysicalSize() &&
+         (cold->getOffset() & 15) == 0,
+    "Cold section must be placed after all other sections");
+  EXPECT(fn() == 43,
+    "Function spanning multiple sections returned a wrong value");
+  rt.release(fn);
+}
+#endif // ASMJIT_TEST && (ASMJIT_ARCH_X86 || ASMJIT_ARCH_X64)
+
+#if defined(ASMJIT_TEST) && (ASMJIT_ARCH_X86 || ASMJIT_ARCH_X64)
+UNIT(x86_assembler_label_links) {
+  using namespace x86;
+  typedef int (*Func)(void);
+
+  JitRuntime rt;
+  CodeHolder code;
+  code.init(rt.getCodeInfo());
+  X86Assembler a(&code);
+
+  Label L_Mid = a.newLabel();
+  Label L_Done = a.newLabel();
+  uint32_t i, n = 37;
+
+  // Mix short and near forward jumps, the first one is the only one taken.
+  a.mov(eax, 7);
+  for (i = 0; i < n; i++) {
+    if (i & 1)
+      a.short_().jmp(L_Mid);
+    else
+      a.jmp(L_Done);
   }
 
-  uint8_t* cursor = _bufferPtr;
-  uint8_t pattern = 0x00;
+  INFO("Checking links of unbound labels");
+  EXPECT(code.getLabelEntry(L_Done)->getLinkCount() == (n + 1) / 2);
+  EXPECT(code.getLabelEntry(L_Mid)->getLinkCount() == n / 2);
+  EXPECT(code.getUnresolvedLabelsCount() == n);
 
-  switch (mode) {
-    case kAlignCode: {
-      if (_globalHints & kHintOptimizedAlign) {
-        // Intel 64 and IA-32 Architectures Software Developer's Manual - Volume 2B (NOP).
-        enum { kMaxNopSize = 9 };
-
-        static const uint8_t nopData[kMaxNopSize][kMaxNopSize] = {
-          { 0x90 },
-          { 0x66, 0x90 },
-          { 0x0F, 0x1F, 0x00 },
-          { 0x0F, 0x1F, 0x40, 0x00 },
-          { 0x0F, 0x1F, 0x44, 0x00, 0x00 },
-          { 0x66, 0x0F, 0x1F, 0x44, 0x00, 0x00 },
-          { 0x0F, 0x1F, 0x80, 0x00, 0x00, 0x00, 0x00 },
-          { 0x0F, 0x1F, 0x84, 0x00, 0x00, 0x00, 0x00, 0x00 },
-          { 0x66, 0x0F, 0x1F, 0x84, 0x00, 0x00, 0x00, 0x00, 0x00 }
-        };
-
-        do {
-          uint32_t n = std::min<uint32_t>(i, kMaxNopSize);
-          const uint8_t* src = nopData[n - 1];
-
-          i -= n;
-          do {
-            EMIT_BYTE(*src++);
-          } while (--n);
-        } while (i);
-      }
-
-      pattern = 0x90;
-      break;
+  a.bind(L_Mid);
+  EXPECT(!code.getLabelEntry(L_Mid)->hasLinks());
+  EXPECT(code.getUnresolvedLabelsCount() == (n + 1) / 2);
+
+  a.mov(eax, 1);
+  a.bind(L_Done);
+  a.ret();
+
+  EXPECT(!code.getLabelEntry(L_Done)->hasLinks());
+  EXPECT(code.getUnresolvedLabelsCount() == 0);
+  EXPECT(a.getLastError() == kErrorOk,
+    "Assembler failed: %s", DebugUtils::errorAsString(a.getLastError()));
+
+  Func fn;
+  EXPECT(rt.add(&fn, &code) == kErrorOk);
+  EXPECT(fn() == 7);
+  rt.release(fn);
+}
+#endif // ASMJIT_TEST && (ASMJIT_ARCH_X86 || ASMJIT_ARCH_X64)
+
+#if defined(ASMJIT_TEST) && (ASMJIT_ARCH_X86 || ASMJIT_ARCH_X64)
+UNIT(x86_assembler_stats) {
+  using namespace x86;
+  typedef int (*Func)(void);
+
+  INFO("Checking instruction-mix statistics");
+  {
+    CodeHolder code;
+    code.init(CodeInfo(ArchInfo::kTypeX64));
+    code.setStatsEnabled(true);
+
+    X86Assembler a(&code);
+    Label L_Back = a.newLabel();
+    Label L_Fwd = a.newLabel();
+
+    a.mov(rax, rbx);
+    a.mov(ax, bx);
+    a.vaddps(xmm0, xmm1, xmm2);
+    a.vaddps(zmm0, zmm1, zmm2);
+    a.bind(L_Back);
+    a.jmp(L_Back);
+    a.jmp(L_Fwd);
+    a.align(kAlignCode, 16);
+    a.bind(L_Fwd);
+    a.ret();
+
+    const CodeStats& stats = code.getStats();
+    EXPECT(stats.instCount == 7);
+    EXPECT(stats.instSize + stats.alignSize == a.getOffset());
+    EXPECT(stats.alignSize != 0);
+    EXPECT(stats.prefixCount == 1);
+    EXPECT(stats.rexCount == 1);
+    EXPECT(stats.vexCount == 1);
+    EXPECT(stats.evexCount == 1);
+    EXPECT(stats.rel8Count == 1);
+    EXPECT(stats.rel32Count == 1);
+  }
+
+  INFO("Checking that disabled statistics are not collected");
+  {
+    CodeHolder code;
+    code.init(CodeInfo(ArchInfo::kTypeX64));
+
+    X86Assembler a(&code);
+    a.mov(rax, rbx);
+    EXPECT(code.getStats().instCount == 0);
+  }
+
+  INFO("Checking statistics aggregated by JitRuntime");
+  {
+    JitRuntime rt;
+    Func fn[2];
+
+    for (uint32_t i = 0; i < 2; i++) {
+      CodeHolder code;
+      code.init(rt.getCodeInfo());
+      code.setStatsEnabled(i == 0);
+
+      X86Assembler a(&code);
+      a.mov(eax, 1);
+      a.ret();
+
+      EXPECT(rt.add(&fn[i], &code) == kErrorOk);
+      EXPECT(fn[i]() == 1);
     }
 
-    case kAlignData:
-      pattern = 0xCC;
-      break;
+    CodeStats stats = rt.getStats();
+    EXPECT(stats.moduleCount == 1,
+      "Only code with statistics enabled must be aggregated");
+    EXPECT(stats.instCount == 2);
+    EXPECT(stats.relocatedSize == stats.instSize);
 
-    case kAlignZero:
-      // Pattern already set to zero.
-      break;
+    rt.resetStats();
+    EXPECT(rt.getStats().moduleCount == 0);
+
+    rt.release(fn[0]);
+    rt.release(fn[1]);
+  }
+}
+#endif // ASMJIT_TEST && (ASMJIT_ARCH_X86 || ASMJIT_ARCH_X64)
+
+#if defined(ASMJIT_TEST) && !defined(ASMJIT_DISABLE_LOGGING)
+UNIT(x86_assembler_log_filter) {
+  using namespace x86;
+
+  StringLogger logger;
+  CodeHolder code;
+  code.init(CodeInfo(ArchInfo::kTypeX64));
+  code.setLogger(&logger);
+
+  X86Assembler a(&code);
+  Label L = a.newLabel();
+
+  INFO("Checking that a disabled logger doesn't log");
+  logger.setEnabled(false);
+  a.mov(rax, rbx);
+  a.comment("hidden");
+  EXPECT(logger.getLength() == 0);
+
+  INFO("Checking that only enabled categories are logged");
+  logger.setEnabled(true);
+  logger.setCategories(Logger::kCategoryLabel | Logger::kCategoryComment);
+  a.bind(L);
+  a.add(rax, rcx);
+  a.comment("visible");
+  EXPECT(::strstr(logger.getString(), "L0:") != nullptr);
+  EXPECT(::strstr(logger.getString(), "visible") != nullptr);
+  EXPECT(::strstr(logger.getString(), "add") == nullptr);
+
+  INFO("Checking that the level is honored");
+  logger.clearString();
+  logger.setCategories(Logger::kCategoryAll);
+  logger.setLevel(Logger::kLevelInfo);
+  a.sub(rax, rcx);
+  a.comment("info");
+  EXPECT(::strstr(logger.getString(), "sub") == nullptr);
+  EXPECT(::strstr(logger.getString(), "info") != nullptr);
+
+  logger.setLevel(Logger::kLevelTrace);
+  a.xor_(rax, rcx);
+  EXPECT(::strstr(logger.getString(), "xor rax, rcx") != nullptr);
+  EXPECT(a.getLastError() == kErrorOk);
+}
+#endif // ASMJIT_TEST && !ASMJIT_DISABLE_LOGGING
+
+#if defined(ASMJIT_TEST)
+UNIT(x86_assembler_trace) {
+  using namespace x86;
+
+  TraceBuffer trace(3);
+  EXPECT(trace.getCapacity() == 4);
+
+  CodeHolder code;
+  code.init(CodeInfo(ArchInfo::kTypeX64));
+  code.setTraceBuffer(&trace);
+
+  X86Assembler a(&code);
+  Label L = a.newLabel();
+
+  INFO("Checking recorded instructions");
+  a.mov(rax, rbx);
+  a.bind(L);
+  a.add(eax, dword_ptr(rcx, rdx, 2, 16));
+  a.jmp(L);
+
+  EXPECT(trace.getCount() == 3);
+  EXPECT(trace.getRecord(0).instId == X86Inst::kIdMov);
+  EXPECT(trace.getRecord(0).offset == 0);
+  EXPECT(trace.getRecord(0).size == 3);
+  EXPECT(trace.getRecord(1).instId == X86Inst::kIdAdd);
+  EXPECT(trace.getRecord(1).offset == 3);
+  EXPECT(trace.getRecord(1).operands[1].isMem());
+  EXPECT(trace.getRecord(2).operands[0].isLabel());
+  EXPECT(trace.getRecord(2).operands[1].isNone());
+
+  INFO("Checking that the oldest records are overwritten");
+  a.nop();
+  a.ret();
+  EXPECT(trace.getCount() == 4);
+  EXPECT(trace.getTotalCount() == 5);
+  EXPECT(trace.getRecord(0).instId == X86Inst::kIdAdd);
+  EXPECT(trace.getRecord(3).instId == X86Inst::kIdRet);
+
+  TraceRecord records[2];
+  EXPECT(trace.copyTo(records, 2) == 2);
+  EXPECT(records[0].instId == X86Inst::kIdNop && records[1].instId == X86Inst::kIdRet);
+
+#if !defined(ASMJIT_DISABLE_LOGGING)
+  INFO("Checking offline formatting");
+  StringBuilder sb;
+  EXPECT(trace.format(sb) == kErrorOk);
+  EXPECT(::strstr(sb.getData(), "add eax, dword [rcx+rdx*4+16]") != nullptr,
+    "Unexpected trace:\n%s", sb.getData());
+  EXPECT(::strstr(sb.getData(), "jmp L0") != nullptr,
+    "Unexpected trace:\n%s", sb.getData());
+#endif // !ASMJIT_DISABLE_LOGGING
+
+  code.resetTraceBuffer();
+  a.nop();
+  EXPECT(trace.getTotalCount() == 5);
+}
+#endif // ASMJIT_TEST
+
+#if defined(ASMJIT_TEST)
+static bool X86Assembler_sameCode(const CodeHolder& a, const CodeHolder& b) noexcept {
+  const CodeBuffer& aBuf = a.getSectionEntry(0)->getBuffer();
+  const CodeBuffer& bBuf = b.getSectionEntry(0)->getBuffer();
+  return aBuf.getLength() == bBuf.getLength() && ::memcmp(aBuf.getData(), bBuf.getData(), aBuf.getLength()) == 0;
+}
+
+#if ASMJIT_ARCH_X64
+static int ASMJIT_CDECL X86AssemblerTest_answer() { return 42; }
+
+UNIT(x86_assembler_near_call) {
+  typedef int (*Func)(void);
+  void* target = (void*)X86AssemblerTest_answer;
+
+  JitRuntime rt;
+  EXPECT(rt.setNearAddress(target) == kErrorOk);
+
+  CodeHolder code;
+  code.init(rt.getCodeInfo());
+
+  X86Assembler a(&code);
+  a.sub(x86::rsp, 8);
+  a.call(imm_ptr(target));
+  a.add(x86::rsp, 8);
+  a.ret();
+  EXPECT(code.getTrampolinesSize() == 8);
+
+  // The target is reachable from the whole range, so no trampoline is needed.
+  EXPECT(code.getRelocatedSize() == code.getCodeSize());
+  EXPECT(code.getRelocatedSize(rt.getMemMgr()->getRangeLo(), rt.getMemMgr()->getRangeHi()) == code.getCodeSize() - 8);
+
+  Func fn;
+  EXPECT(rt.add(&fn, &code) == kErrorOk);
+  EXPECT(fn() == 42);
+
+  // [REX] E8 rel32 - direct call, not patched to use the trampoline.
+  const uint8_t* p = reinterpret_cast<const uint8_t*>(fn);
+  EXPECT(p[5] == 0xE8, "The call should not use a trampoline");
+  rt.release(fn);
+}
+#endif // ASMJIT_ARCH_X64
+
+UNIT(x86_assembler_static_emitter) {
+  using namespace x86;
+
+  static const int32_t immValues[] = { 0, 1, -1, 127, 128, -128, -129, 0x7FFFFFFF, -0x7FFFFFFF - 1 };
+  static const uint32_t archTypes[] = { ArchInfo::kTypeX86, ArchInfo::kTypeX64 };
+
+  for (uint32_t archIndex = 0; archIndex < ASMJIT_ARRAY_SIZE(archTypes); archIndex++) {
+    uint32_t archType = archTypes[archIndex];
+    uint32_t regCount = archType == ArchInfo::kTypeX64 ? 16 : 8;
+
+    INFO("Checking that inline encoding matches X86Assembler (%s)", archType == ArchInfo::kTypeX64 ? "X64" : "X86");
+    CodeHolder code1;
+    CodeHolder code2;
+    code1.init(CodeInfo(archType));
+    code2.init(CodeInfo(archType));
+
+    X86Assembler a1(&code1);
+    X86Assembler a2(&code2);
+    X86StaticEmitter s(&a1);
+
+    for (uint32_t i = 0; i < regCount; i++) {
+      for (uint32_t j = 0; j < regCount; j++) {
+        s.add(gpd(i), gpd(j)); a2.add(gpd(i), gpd(j));
+        s.cmp(gpd(i), gpd(j)); a2.cmp(gpd(i), gpd(j));
+        s.mov(gpd(i), gpd(j)); a2.mov(gpd(i), gpd(j));
+        s.test(gpd(i), gpd(j)); a2.test(gpd(i), gpd(j));
+
+        if (archType == ArchInfo::kTypeX64) {
+          s.sbb(gpq(i), gpq(j)); a2.sbb(gpq(i), gpq(j));
+          s.xor_(gpq(i), gpq(j)); a2.xor_(gpq(i), gpq(j));
+          s.mov(gpq(i), gpq(j)); a2.mov(gpq(i), gpq(j));
+        }
+      }
+
+      for (uint32_t k = 0; k < ASMJIT_ARRAY_SIZE(immValues); k++) {
+        int32_t imm = immValues[k];
+        s.adc(gpd(i), imm); a2.adc(gpd(i), imm);
+        s.and_(gpd(i), imm); a2.and_(gpd(i), imm);
+        s.or_(gpd(i), imm); a2.or_(gpd(i), imm);
+
+        if (archType == ArchInfo::kTypeX64) {
+          s.sub(gpq(i), imm); a2.sub(gpq(i), imm);
+          s.cmp(gpq(i), imm); a2.cmp(gpq(i), imm);
+        }
+      }
+    }
+
+    EXPECT(a1.getLastError() == kErrorOk && a2.getLastError() == kErrorOk);
+    EXPECT(X86Assembler_sameCode(code1, code2),
+      "Inline encoding differs from X86Assembler");
   }
 
-  while (i) {
-    EMIT_BYTE(pattern);
-    i--;
+  INFO("Checking that registers the architecture doesn't have are rejected");
+  {
+    CodeHolder code;
+    code.init(CodeInfo(ArchInfo::kTypeX86));
+
+    X86Assembler a(&code);
+    X86StaticEmitter s(&a);
+    EXPECT(s.add(gpq(0), gpq(1)) != kErrorOk);
+    EXPECT(a.getOffset() == 0);
   }
 
-  _bufferPtr = cursor;
-  return kErrorOk;
+#if !defined(ASMJIT_DISABLE_LOGGING)
+  INFO("Checking that instrumented instructions take the generic path");
+  {
+    StringLogger logger;
+    CodeHolder code;
+    code.init(CodeInfo(ArchInfo::kTypeX64));
+    code.setLogger(&logger);
+
+    X86Assembler a(&code);
+    X86StaticEmitter s(&a);
+    EXPECT(!s.canEmitInline());
+    EXPECT(s.sub(gpq(9), 16) == kErrorOk);
+    EXPECT(::strstr(logger.getString(), "sub r9, 16") != nullptr,
+      "Unexpected log:\n%s", logger.getString());
+  }
+#endif // !ASMJIT_DISABLE_LOGGING
+}
+#endif // ASMJIT_TEST
+
+#if defined(ASMJIT_TEST) && !defined(ASMJIT_DISABLE_VALIDATION) && !defined(ASMJIT_DISABLE_EXTENSIONS)
+UNIT(x86_assembler_target_features) {
+  using namespace x86;
+
+  CpuFeatures sse2;
+  sse2.add(CpuInfo::kX86FeatureSSE).add(CpuInfo::kX86FeatureSSE2);
+
+  CpuFeatures avx(sse2);
+  avx.add(CpuInfo::kX86FeatureAVX);
+
+  INFO("Checking that instructions outside of the target are rejected");
+  {
+    CodeInfo ci(ArchInfo::kTypeX64);
+    ci.setFeatures(sse2);
+
+    CodeHolder code;
+    code.init(ci);
+    code.setStrictValidation(true);
+    EXPECT(code.hasFeatures());
+
+    X86Assembler a(&code);
+    EXPECT(a.paddd(xmm0, xmm1) == kErrorOk);
+    EXPECT(a.vpaddd(xmm0, xmm1, xmm2) == kErrorMissingCpuFeature,
+      "VPADDD must be rejected by a target without AVX");
+  }
+
+  INFO("Checking that instructions inside of the target are accepted");
+  {
+    CodeInfo ci(ArchInfo::kTypeX64);
+    ci.setFeatures(avx);
+
+    CodeHolder code;
+    code.init(ci);
+    code.setStrictValidation(true);
+
+    X86Assembler a(&code);
+    EXPECT(a.vpaddd(xmm0, xmm1, xmm2) == kErrorOk);
+    EXPECT(a.vpaddd(ymm0, ymm1, ymm2) == kErrorMissingCpuFeature,
+      "256-bit VPADDD must be rejected by a target without AVX2");
+  }
+
+  INFO("Checking that features are not checked without strict validation");
+  {
+    CodeInfo ci(ArchInfo::kTypeX64);
+    ci.setFeatures(sse2);
+
+    CodeHolder code;
+    code.init(ci);
+
+    X86Assembler a(&code);
+    EXPECT(a.vpaddd(xmm0, xmm1, xmm2) == kErrorOk);
+  }
+}
+#endif // ASMJIT_TEST && !ASMJIT_DISABLE_VALIDATION && !ASMJIT_DISABLE_EXTENSIONS
+
+#if defined(ASMJIT_TEST)
+UNIT(x86_assembler_embed_and_pad) {
+  INFO("Checking streamed embedding by embedReserve() and embedCommit()");
+  {
+    CodeHolder code;
+    code.init(CodeInfo(ArchInfo::kTypeX64));
+    X86Assembler a(&code);
+
+    uint8_t* p;
+    uint32_t i, total = 0;
+
+    for (i = 0; i < 4; i++) {
+      size_t chunk = 5000 * (i + 1);
+      EXPECT(a.embedReserve(&p, chunk * 2) == kErrorOk);
+      ::memset(p, static_cast<int>(i + 1), chunk);
+      EXPECT(a.embedCommit(chunk) == kErrorOk);
+      total += static_cast<uint32_t>(chunk);
+    }
+
+    EXPECT(a.getOffset() == total);
+    EXPECT(a.getBufferData()[0] == 1 && a.getBufferData()[total - 1] == 4);
+    EXPECT(a.embedCommit(a.getRemainingSpace() + 1) == kErrorInvalidArgument);
+  }
+
+  INFO("Checking that large reservations are allocated exactly");
+  {
+    CodeHolder code;
+    code.init(CodeInfo(ArchInfo::kTypeX64));
+    X86Assembler a(&code);
+
+    uint8_t* p;
+    size_t size = Globals::kAllocThreshold + 4096;
+
+    a.ret();
+    EXPECT(a.embedReserve(&p, size) == kErrorOk);
+    EXPECT(a.getRemainingSpace() == size);
+    ::memset(p, 0xAB, size);
+    EXPECT(a.embedCommit(size) == kErrorOk);
+    EXPECT(a.getOffset() == size + 1);
+  }
+
+  INFO("Checking NOP padding by pad() and align()");
+  {
+    CodeHolder code;
+    code.init(CodeInfo(ArchInfo::kTypeX64));
+    code.setGlobalHints(CodeEmitter::kHintOptimizedAlign);
+    X86Assembler a(&code);
+
+    EXPECT(a.pad(kAlignCode, 40) == kErrorOk);
+    a.ret();
+    EXPECT(a.align(kAlignCode, 64) == kErrorOk);
+    EXPECT(a.getOffset() == 64);
+
+    // Padding must be a stream of NOPs, each as long as possible.
+    static const uint32_t expected[] = { 11, 11, 11, 7, 1, 11, 11 };
+    const uint8_t* data = a.getBufferData();
+    size_t offset = 0;
+
+    for (uint32_t i = 0; i < ASMJIT_ARRAY_SIZE(expected); i++) {
+      uint32_t len = X86Decoder::getLength(ArchInfo::kTypeX64, data + offset, 64 - offset);
+      EXPECT(len == expected[i],
+        "Instruction #%u has length %u, expected %u", i, len, expected[i]);
+      offset += len;
+    }
+
+    // 23 bytes of alignment are split to 11 + 11 + 1.
+    EXPECT(data[63] == 0x90);
+
+    EXPECT(a.pad(kAlignZero, 3) == kErrorOk);
+    EXPECT(a.pad(kAlignData, 2) == kErrorOk);
+
+    data = a.getBufferData();
+    EXPECT(data[64] == 0x00 && data[66] == 0x00 && data[67] == 0xCC && data[68] == 0xCC);
+    EXPECT(a.pad(kAlignCount, 1) == kErrorInvalidArgument);
+  }
+
+  INFO("Checking single-byte NOP padding without kHintOptimizedAlign");
+  {
+    CodeHolder code;
+    code.init(CodeInfo(ArchInfo::kTypeX64));
+    X86Assembler a(&code);
+
+    EXPECT(a.pad(kAlignCode, 13) == kErrorOk);
+    for (uint32_t i = 0; i < 13; i++)
+      EXPECT(a.getBufferData()[i] == 0x90);
+  }
 }
+#endif // ASMJIT_TEST
 
 } // asmjit namespace
 
@@ -83,6 +83,20 @@ public:
 
   ASMJIT_API Error _emit(uint32_t instId, const Operand_& o0, const Operand_& o1, const Operand_& o2, const Operand_& o3) override;
   ASMJIT_API Error align(uint32_t mode, uint32_t alignment) override;
+
+  //! Emit `size` bytes of the padding `align(mode, ...)` would use, without
+  //! aligning anything (see \ref AlignMode).
+  ASMJIT_API Error pad(uint32_t mode, size_t size);
+
+  //! Fill `size` bytes at `dst` by the longest multi-byte NOPs (up to 11
+  //! bytes each), the result is always a valid instruction stream.
+  ASMJIT_API static void fillNop(void* dst, size_t size) noexcept;
+
+  // --------------------------------------------------------------------------
+  // [Members]
+  // --------------------------------------------------------------------------
+
+  X86Inst::ValidationCache _validationCache; //!< Signatures that passed strict validation.
 };
 
 //! \}
@@ -0,0 +1,639 @@
+// [AsmJit]
+// Complete x86/x64 JIT and Remote Assembler for C++.
+//
+// [License]
+// Zlib - See LICENSE.md file in the package.
+
+// [Export]
+#define ASMJIT_EXPORTS
+
+// [Guard]
+#include "../asmjit_build.h"
+#if defined(ASMJIT_BUILD_X86) && !defined(ASMJIT_DISABLE_COMPILER)
+
+// [Dependencies]
+#include "../base/flowgraph.h"
+#include "../x86/x86blocklayout.h"
+#include "../x86/x86inst.h"
+#include "../x86/x86operand.h"
+
+// [Api-Begin]
+#include "../asmjit_apibegin.h"
+
+namespace asmjit {
+
+// ============================================================================
+// [asmjit::X86BlockLayout - Helpers]
+// ============================================================================
+
+//! \internal
+//!
+//! Flags clobbered by counters.
+static const uint32_t X86BlockLayout_kArithFlags =
+  x86::kSpecialReg_FLAGS_CF | x86::kSpecialReg_FLAGS_PF |
+  x86::kSpecialReg_FLAGS_AF | x86::kSpecialReg_FLAGS_ZF |
+  x86::kSpecialReg_FLAGS_SF | x86::kSpecialReg_FLAGS_OF;
+
+//! \internal
+//!
+//! Maximum number of nodes visited by `X86BlockLayout_isFlagsDead()`.
+static const uint32_t X86BlockLayout_kMaxLookAhead = 32;
+
+//! \internal
+//!
+//! Place of a counter, it's inserted after `after`.
+struct X86CounterPos {
+  CBNode* after;                         //!< Node the counter is inserted after.
+  size_t index;                          //!< Index of the counter.
+};
+
+static ASMJIT_INLINE bool X86BlockLayout_isLabel(const CBNode* node) noexcept {
+  return node->getType() == CBNode::kNodeLabel || node->getType() == CBNode::kNodeFunc;
+}
+
+//! \internal
+//!
+//! Get the first function at or after `node`, or null.
+static ASMJIT_INLINE CCFunc* X86BlockLayout_nextFunc(CBNode* node) noexcept {
+  while (node && node->getType() != CBNode::kNodeFunc)
+    node = node->getNext();
+  return static_cast<CCFunc*>(node);
+}
+
+//! \internal
+//!
+//! Get if arithmetic flags are overwritten before they are read by the code
+//! that starts at `node`. Unconditional jumps are followed to their target,
+//! flags are considered live after any other jump.
+static bool X86BlockLayout_isFlagsDead(const CBNode* node) noexcept {
+  uint32_t flags = X86BlockLayout_kArithFlags;
+
+  for (uint32_t i = 0; node && i < X86BlockLayout_kMaxLookAhead; node = node->getNext(), i++) {
+    switch (node->getType()) {
+      case CBNode::kNodeComment:
+      case CBNode::kNodeAlign:
+      case CBNode::kNodeLabel:
+        continue;
+
+      // Flags are not preserved by calls and returns.
+      case CBNode::kNodeFuncCall:
+      case CBNode::kNodeFuncExit:
+      case CBNode::kNodeSentinel:
+        return true;
+
+      case CBNode::kNodeInst: {
+        if (node->isCase())
+          return false;
+
+        uint32_t instId = static_cast<const CBInst*>(node)->getInstId();
+        const X86Inst& inst = X86Inst::getInst(instId);
+        const X86Inst::OperationData& operationData = inst.getOperationData();
+
+        if (operationData.getSpecialRegsR() & flags)
+          return false;
+
+        flags &= ~operationData.getSpecialRegsW();
+        if (!flags || instId == X86Inst::kIdRet)
+          return true;
+
+        // The label is skipped by the next iteration.
+        if (node->isJmp() && static_cast<const CBJump*>(node)->getTarget()) {
+          node = static_cast<const CBJump*>(node)->getTarget();
+          continue;
+        }
+
+        if (inst.getCommonData().doesJump())
+          return false;
+        continue;
+      }
+
+      default:
+        return false;
+    }
+  }
+
+  return false;
+}
+
+//! \internal
+//!
+//! Get if the function `[first, stop)` can be reordered. Case jumps must stay
+//! in front of their indirect jump, and code that already switches sections
+//! was laid out by the user.
+static bool X86BlockLayout_canReorder(const CBNode* first, const CBNode* stop) noexcept {
+  for (const CBNode* node = first; node != stop; node = node->getNext()) {
+    if (node->isCase() || node->getType() == CBNode::kNodeJumpTable || node->getType() == CBNode::kNodeSection)
+      return false;
+  }
+  return true;
+}
+
+//! \internal
+//!
+//! Get the `jcc` that jumps if `instId` doesn't, or `X86Inst::kIdNone`.
+static uint32_t X86BlockLayout_invertJcc(uint32_t instId) noexcept {
+  switch (instId) {
+    case X86Inst::kIdJa:    return X86Inst::kIdJbe;
+    case X86Inst::kIdJae:   return X86Inst::kIdJb;
+    case X86Inst::kIdJb:    return X86Inst::kIdJae;
+    case X86Inst::kIdJbe:   return X86Inst::kIdJa;
+    case X86Inst::kIdJc:    return X86Inst::kIdJnc;
+    case X86Inst::kIdJe:    return X86Inst::kIdJne;
+    case X86Inst::kIdJg:    return X86Inst::kIdJle;
+    case X86Inst::kIdJge:   return X86Inst::kIdJl;
+    case X86Inst::kIdJl:    return X86Inst::kIdJge;
+    case X86Inst::kIdJle:   return X86Inst::kIdJg;
+    case X86Inst::kIdJna:   return X86Inst::kIdJa;
+    case X86Inst::kIdJnae:  return X86Inst::kIdJae;
+    case X86Inst::kIdJnb:   return X86Inst::kIdJb;
+    case X86Inst::kIdJnbe:  return X86Inst::kIdJbe;
+    case X86Inst::kIdJnc:   return X86Inst::kIdJc;
+    case X86Inst::kIdJne:   return X86Inst::kIdJe;
+    case X86Inst::kIdJng:   return X86Inst::kIdJg;
+    case X86Inst::kIdJnge:  return X86Inst::kIdJge;
+    case X86Inst::kIdJnl:   return X86Inst::kIdJl;
+    case X86Inst::kIdJnle:  return X86Inst::kIdJle;
+    case X86Inst::kIdJno:   return X86Inst::kIdJo;
+    case X86Inst::kIdJnp:   return X86Inst::kIdJp;
+    case X86Inst::kIdJns:   return X86Inst::kIdJs;
+    case X86Inst::kIdJnz:   return X86Inst::kIdJz;
+    case X86Inst::kIdJo:    return X86Inst::kIdJno;
+    case X86Inst::kIdJp:    return X86Inst::kIdJnp;
+    case X86Inst::kIdJpe:   return X86Inst::kIdJpo;
+    case X86Inst::kIdJpo:   return X86Inst::kIdJpe;
+    case X86Inst::kIdJs:    return X86Inst::kIdJns;
+    case X86Inst::kIdJz:    return X86Inst::kIdJnz;
+    default: return X86Inst::kIdNone;
+  }
+}
+
+//! \internal
+//!
+//! Make `node` jump to `target`.
+static void X86BlockLayout_retarget(CBJump* node, CBLabel* target) noexcept {
+  CBLabel* current = node->_target;
+  if (current) {
+    CBJump** pPrev = &current->_from;
+    while (*pPrev) {
+      if (*pPrev == node) {
+        *pPrev = node->_jumpNext;
+        current->subNumRefs();
+        break;
+      }
+      pPrev = &(*pPrev)->_jumpNext;
+    }
+  }
+
+  node->getOpArray()[0] = target->getLabel();
+  node->_target = target;
+  node->_jumpNext = target->_from;
+  target->_from = node;
+  target->addNumRefs();
+}
+
+//! \internal
+//!
+//! Get the label `block` starts with, a new label is inserted if it has none.
+static CBLabel* X86BlockLayout_getLabel(CodeBuilder* cb, CBBlock* block) noexcept {
+  CBNode* first = block->getFirst();
+  if (X86BlockLayout_isLabel(first))
+    return static_cast<CBLabel*>(first);
+
+  CBLabel* label = cb->newLabelNode();
+  if (ASMJIT_UNLIKELY(!label))
+    return nullptr;
+
+  cb->addBefore(label, first);
+  block->_first = label;
+  return label;
+}
+
+static ASMJIT_INLINE void X86BlockLayout_link(CodeBuilder* cb, CBNode* prev, CBNode* node) noexcept {
+  if (prev)
+    prev->_next = node;
+  else
+    cb->_firstNode = node;
+  node->_prev = prev;
+}
+
+// ============================================================================
+// [asmjit::X86EdgeCounterPass - Construction / Destruction]
+// ============================================================================
+
+X86EdgeCounterPass::X86EdgeCounterPass(uint64_t* counters, size_t capacity) noexcept
+  : CBPass("EdgeCounter"),
+    _counters(counters),
+    _capacity(counters ? capacity : size_t(0)),
+    _counterCount(0),
+    _insertedCount(0) {}
+X86EdgeCounterPass::~X86EdgeCounterPass() noexcept {}
+
+// ============================================================================
+// [asmjit::X86EdgeCounterPass - Process]
+// ============================================================================
+
+Error X86EdgeCounterPass::process(Zone* zone) noexcept {
+  CodeBuilder* cb = _cb;
+  ZoneHeap heap(zone);
+  ZoneVector<X86CounterPos> positions;
+
+  _counterCount = 0;
+  _insertedCount = 0;
+
+  for (CCFunc* func = X86BlockLayout_nextFunc(cb->getFirstNode()); func; func = X86BlockLayout_nextFunc(func->getEnd()->getNext())) {
+    CBFlowGraph cfg;
+    ASMJIT_PROPAGATE(cfg.build(cb, zone, func, func->getEnd()->getNext()));
+
+    uint32_t blockCount = cfg.getBlockCount();
+    size_t base = _counterCount;
+
+    _counterCount += static_cast<size_t>(blockCount) * 2;
+    if (_counterCount > _capacity)
+      continue;
+
+    for (uint32_t i = 0; i < blockCount; i++) {
+      CBBlock* block = cfg.getBlock(i);
+      CBNode* first = block->getFirst();
+      CBNode* last = block->getLast();
+
+      _counters[base + i * 2    ] = kCounterUnknown;
+      _counters[base + i * 2 + 1] = kCounterUnknown;
+
+      // Count entries at the first position where flags are dead, a block
+      // that doesn't start with a label starts after a jump.
+      CBNode* pos = X86BlockLayout_isLabel(first) ? first : first->getPrev();
+      for (;;) {
+        CBNode* next = pos->getNext();
+        if (X86BlockLayout_isFlagsDead(next)) {
+          X86CounterPos counter = { pos, base + i * 2 };
+          ASMJIT_PROPAGATE(positions.append(&heap, counter));
+          break;
+        }
+
+        if (pos == last || next == last)
+          break;
+        pos = next;
+      }
+
+      // Count the fall-through of a conditional jump between the jump and the
+      // label of the next block, so jumps to the label are not counted.
+      if (last->isJcc() && !last->isCase() && i + 1 < blockCount &&
+          X86BlockLayout_isLabel(cfg.getBlock(i + 1)->getFirst()) &&
+          X86BlockLayout_isFlagsDead(last->getNext())) {
+        X86CounterPos counter = { last, base + i * 2 + 1 };
+        ASMJIT_PROPAGATE(positions.append(&heap, counter));
+      }
+    }
+  }
+
+  CBNode* oldCursor = cb->getCursor();
+  bool is64Bit = cb->is64Bit();
+
+  for (size_t i = 0, count = positions.getLength(); i < count; i++) {
+    const X86CounterPos& counter = positions[i];
+    uint64_t address = static_cast<uint64_t>((uintptr_t)(_counters + counter.index));
+
+    _counters[counter.index] = 0;
+    cb->_setCursor(counter.after);
+
+    if (is64Bit) {
+      ASMJIT_PROPAGATE(cb->emit(X86Inst::kIdAdd, x86::qword_ptr(address), Imm(1)));
+    }
+    else {
+      ASMJIT_PROPAGATE(cb->emit(X86Inst::kIdAdd, x86::dword_ptr(address), Imm(1)));
+      ASMJIT_PROPAGATE(cb->emit(X86Inst::kIdAdc, x86::dword_ptr(address + 4), Imm(0)));
+    }
+
+    _insertedCount++;
+  }
+
+  cb->_setCursor(oldCursor);
+  return kErrorOk;
+}
+
+// ============================================================================
+// [asmjit::X86BlockLayoutPass - Construction / Destruction]
+// ============================================================================
+
+X86BlockLayoutPass::X86BlockLayoutPass(const uint64_t* counters, size_t count) noexcept
+  : CBPass("BlockLayout"),
+    _counters(counters),
+    _count(counters ? count : size_t(0)),
+    _movedCount(0),
+    _coldCount(0),
+    _invertedCount(0) {}
+X86BlockLayoutPass::~X86BlockLayoutPass() noexcept {}
+
+// ============================================================================
+// [asmjit::X86BlockLayoutPass - Process]
+// ============================================================================
+
+//! \internal
+//!
+//! Count of executions of a block or an edge used to order blocks.
+static ASMJIT_INLINE uint64_t X86BlockLayout_getWeight(uint64_t count) noexcept {
+  return count != X86EdgeCounterPass::kCounterUnknown ? count : uint64_t(0);
+}
+
+//! \internal
+//!
+//! Get the block `block` falls through to.
+//!
+//! The register allocator doesn't emit anything for a `CCFuncRet` followed by
+//! the exit label, so after it a block that ends with `CCFuncRet` falls through
+//! to the next block, which is the exit label or a `jmp` to it.
+static ASMJIT_INLINE CBBlock* X86BlockLayout_getFallThrough(const CBFlowGraph& cfg, const CBBlock* block) noexcept {
+  uint32_t id = block->getId();
+  if (block->getLast()->getType() == CBNode::kNodeFuncExit && id + 1 < cfg.getBlockCount())
+    return cfg.getBlock(id + 1);
+  return block->getFallThrough();
+}
+
+static Error X86BlockLayout_processFunc(X86BlockLayoutPass* self, Zone* zone, CBFlowGraph& cfg, size_t base) noexcept {
+  const uint64_t kUnknown = X86EdgeCounterPass::kCounterUnknown;
+
+  CodeBuilder* cb = self->_cb;
+  uint32_t n = cfg.getBlockCount();
+  uint32_t i;
+
+  // The entry block and the last block never move.
+  if (n < 3)
+    return kErrorOk;
+
+  uint64_t* blockCounts = zone->allocT<uint64_t>(n * 3 * sizeof(uint64_t));
+  uint32_t* seq = zone->allocT<uint32_t>(n * 2 * sizeof(uint32_t));
+  uint8_t* placed = static_cast<uint8_t*>(zone->allocZeroed(n));
+
+  if (ASMJIT_UNLIKELY(!blockCounts || !seq || !placed))
+    return DebugUtils::errored(kErrorNoHeapMemory);
+
+  uint64_t* fallCounts = blockCounts + n;
+  uint64_t* jumpCounts = fallCounts + n;
+  uint32_t* nextOf = seq + n;
+
+  // --------------------------------------------------------------------------
+  // [Counts]
+  // --------------------------------------------------------------------------
+
+  for (i = 0; i < n; i++) {
+    size_t index = base + i * 2;
+    blockCounts[i] = index < self->_count ? self->_counters[index] : kUnknown;
+  }
+
+  // Nothing to do if the function was not executed.
+  if (blockCounts[0] == 0 || blockCounts[0] == kUnknown)
+    return kErrorOk;
+
+  for (i = 0; i < n; i++) {
+    CBBlock* block = cfg.getBlock(i);
+    CBBlock* fall = X86BlockLayout_getFallThrough(cfg, block);
+    CBNode* last = block->getLast();
+
+    fallCounts[i] = kUnknown;
+    jumpCounts[i] = kUnknown;
+
+    if (fall) {
+      if (last->isJcc()) {
+        size_t index = X86BlockLayout_isLabel(fall->getFirst()) ? base + i * 2 + 1 : base + fall->getId() * 2;
+        fallCounts[i] = index < self->_count ? self->_counters[index] : kUnknown;
+      }
+      else {
+        fallCounts[i] = blockCounts[i];
+      }
+    }
+
+    if (block->getJumpTarget()) {
+      if (!last->isJcc())
+        jumpCounts[i] = blockCounts[i];
+      else if (blockCounts[i] != kUnknown && fallCounts[i] != kUnknown)
+        jumpCounts[i] = blockCounts[i] > fallCounts[i] ? blockCounts[i] - fallCounts[i] : uint64_t(0);
+    }
+  }
+
+  // --------------------------------------------------------------------------
+  // [Order]
+  // --------------------------------------------------------------------------
+
+  // Blocks that were never executed go to the cold section.
+  #define IS_COLD(id) ((id) != 0 && (id) != n - 1 && blockCounts[id] == 0)
+
+  uint32_t hotCount = 0;
+  uint32_t cur = 0;
+  uint32_t scan = 1;
+
+  placed[0] = 1;
+  placed[n - 1] = 1;
+  seq[hotCount++] = 0;
+
+  for (;;) {
+    CBBlock* block = cfg.getBlock(cur);
+    CBBlock* fall = X86BlockLayout_getFallThrough(cfg, block);
+    uint32_t next = kInvalidValue;
+    uint64_t best = 0;
+
+    // Continue with the most frequent successor, the fall-through on ties.
+    for (uint32_t j = 0; j < 2; j++) {
+      CBBlock* succ = j == 0 ? fall : block->getJumpTarget();
+      if (!succ || placed[succ->getId()] || IS_COLD(succ->getId()))
+        continue;
+
+      uint64_t weight = X86BlockLayout_getWeight(j == 0 ? fallCounts[cur] : jumpCounts[cur]);
+      if (next == kInvalidValue || weight > best) {
+        next = succ->getId();
+        best = weight;
+      }
+    }
+
+    // Otherwise continue with the first block that was not placed yet.
+    if (next == kInvalidValue) {
+      while (scan < n && (placed[scan] || IS_COLD(scan)))
+        scan++;
+
+      if (scan == n)
+        break;
+      next = scan;
+    }
+
+    placed[next] = 1;
+    seq[hotCount++] = next;
+    cur = next;
+  }
+
+  uint32_t coldCount = 0;
+  for (i = 1; i < n - 1; i++)
+    if (IS_COLD(i))
+      seq[hotCount + coldCount++] = i;
+  seq[hotCount + coldCount] = n - 1;
+
+  #undef IS_COLD
+
+  uint32_t movedCount = 0;
+  for (i = 0; i < n; i++)
+    if (seq[i] != i)
+      movedCount++;
+
+  if (!movedCount && !coldCount)
+    return kErrorOk;
+
+  // Blocks that follow each other in their section, the last hot block is
+  // followed by the last block as the cold blocks are in another section.
+  for (i = 0; i < n; i++)
+    nextOf[i] = kInvalidValue;
+
+  for (i = 0; i + 1 < hotCount; i++)
+    nextOf[seq[i]] = seq[i + 1];
+  nextOf[seq[hotCount - 1]] = n - 1;
+
+  for (i = hotCount; i + 1 < hotCount + coldCount; i++)
+    nextOf[seq[i]] = seq[i + 1];
+
+  // --------------------------------------------------------------------------
+  // [Labels]
+  // --------------------------------------------------------------------------
+
+  // A fall-through that doesn't follow its block anymore needs a label.
+  for (i = 0; i < n; i++) {
+    CBBlock* fall = X86BlockLayout_getFallThrough(cfg, cfg.getBlock(i));
+    if (fall && fall->getId() != nextOf[i] && !X86BlockLayout_getLabel(cb, fall))
+      return DebugUtils::errored(kErrorNoHeapMemory);
+  }
+
+  // --------------------------------------------------------------------------
+  // [Relink]
+  // --------------------------------------------------------------------------
+
+  CBSection* coldNode = nullptr;
+  CBSection* textNode = nullptr;
+
+  if (coldCount) {
+    CodeHolder* code = cb->getCode();
+    SectionEntry* cold = code->getSectionByName(".text.cold");
+
+    if (!cold)
+      ASMJIT_PROPAGATE(code->newSection(&cold, ".text.cold", Globals::kInvalidIndex,
+        SectionEntry::kFlagExec | SectionEntry::kFlagConst | SectionEntry::kFlagCold, 16));
+
+    coldNode = cb->newSectionNode(cold);
+    textNode = cb->newSectionNode(code->getSectionEntry(0));
+
+    if (ASMJIT_UNLIKELY(!coldNode || !textNode))
+      return DebugUtils::errored(kErrorNoHeapMemory);
+  }
+
+  CBNode* prev = cfg.getBlock(0)->getFirst()->getPrev();
+  CBNode* stop = cfg.getBlock(n - 1)->getLast()->getNext();
+
+  for (i = 0; i < n; i++) {
+    CBBlock* block = cfg.getBlock(seq[i]);
+
+    if (coldCount && i == hotCount) {
+      X86BlockLayout_link(cb, prev, coldNode);
+      prev = coldNode;
+    }
+
+    if (coldCount && i == hotCount + coldCount) {
+      X86BlockLayout_link(cb, prev, textNode);
+      prev = textNode;
+    }
+
+    X86BlockLayout_link(cb, prev, block->getFirst());
+    prev = block->getLast();
+  }
+
+  prev->_next = stop;
+  if (stop)
+    stop->_prev = prev;
+  else
+    cb->_lastNode = prev;
+
+  // --------------------------------------------------------------------------
+  // [Jumps]
+  // --------------------------------------------------------------------------
+
+  CBNode* oldCursor = cb->getCursor();
+
+  for (i = 0; i < n; i++) {
+    CBBlock* block = cfg.getBlock(i);
+    CBBlock* fall = X86BlockLayout_getFallThrough(cfg, block);
+    CBBlock* target = block->getJumpTarget();
+    CBNode* last = block->getLast();
+    uint32_t next = nextOf[i];
+
+    if (last->isJmp()) {
+      // A jump to the next block is not needed.
+      if (target && target->getId() == next) {
+        if (oldCursor == last)
+          oldCursor = last->getPrev();
+        cb->removeNode(last);
+      }
+      continue;
+    }
+
+    if (!fall || fall->getId() == next)
+      continue;
+
+    CBLabel* label = static_cast<CBLabel*>(fall->getFirst());
+    if (last->isJcc() && target && target->getId() == next) {
+      uint32_t instId = X86BlockLayout_invertJcc(static_cast<CBJump*>(last)->getInstId());
+      if (instId != X86Inst::kIdNone) {
+        CBJump* jump = static_cast<CBJump*>(last);
+        uint32_t options = jump->getOptions();
+        uint32_t hints = options & (X86Inst::kOptionTaken | X86Inst::kOptionNotTaken);
+
+        // The likely direction is inverted too.
+        if (hints == X86Inst::kOptionTaken || hints == X86Inst::kOptionNotTaken)
+          options ^= X86Inst::kOptionTaken | X86Inst::kOptionNotTaken;
+
+        jump->setInstId(instId);
+        jump->setOptions(options & ~X86Inst::kOptionShortForm);
+        X86BlockLayout_retarget(jump, label);
+
+        self->_invertedCount++;
+        continue;
+      }
+    }
+
+    cb->_setCursor(last);
+    ASMJIT_PROPAGATE(cb->emit(X86Inst::kIdJmp, label->getLabel()));
+  }
+
+  cb->_setCursor(oldCursor);
+
+  self->_movedCount += movedCount;
+  self->_coldCount += coldCount;
+  return kErrorOk;
+}
+
+Error X86BlockLayoutPass::process(Zone* zone) noexcept {
+  CodeBuilder* cb = _cb;
+  size_t base = 0;
+
+  _movedCount = 0;
+  _coldCount = 0;
+  _invertedCount = 0;
+
+  CCFunc* func = X86BlockLayout_nextFunc(cb->getFirstNode());
+  while (func) {
+    CBNode* stop = func->getEnd()->getNext();
+
+    CBFlowGraph cfg;
+    ASMJIT_PROPAGATE(cfg.build(cb, zone, func, stop));
+
+    // Counters are numbered the same way as by `X86EdgeCounterPass`.
+    if (X86BlockLayout_canReorder(func, stop))
+      ASMJIT_PROPAGATE(X86BlockLayout_processFunc(this, zone, cfg, base));
+
+    base += static_cast<size_t>(cfg.getBlockCount()) * 2;
+    func = X86BlockLayout_nextFunc(stop);
+  }
+
+  return kErrorOk;
+}
+
+} // asmjit namespace
+
+// [Api-End]
+#include "../asmjit_apiend.h"
+
+// [Guard]
+#endif // ASMJIT_BUILD_X86 && !ASMJIT_DISABLE_COMPILER
@@ -0,0 +1,189 @@
+// [AsmJit]
+// Complete x86/x64 JIT and Remote Assembler for C++.
+//
+// [License]
+// Zlib - See LICENSE.md file in the package.
+
+// [Guard]
+#ifndef _ASMJIT_X86_X86BLOCKLAYOUT_H
+#define _ASMJIT_X86_X86BLOCKLAYOUT_H
+
+#include "../asmjit_build.h"
+#if !defined(ASMJIT_DISABLE_COMPILER)
+
+// [Dependencies]
+#include "../base/codecompiler.h"
+
+// [Api-Begin]
+#include "../asmjit_apibegin.h"
+
+namespace asmjit {
+
+//! \addtogroup asmjit_x86
+//! \{
+
+// ============================================================================
+// [asmjit::X86EdgeCounterPass]
+// ============================================================================
+
+//! Pass that inserts execution counters into the code.
+//!
+//! Blocks of each function are numbered by \ref CBFlowGraph in the order of
+//! nodes, and each block `i` of the function gets two 64-bit counters in an
+//! array owned by the caller, at `base + i * 2` and `base + i * 2 + 1`, where
+//! `base` is the sum of counters of all previous functions:
+//!
+//!   - The first counter is incremented each time the block is entered.
+//!   - The second counter is incremented each time a block that ends with a
+//!     conditional jump falls through to a block that starts with a label.
+//!     Other fall-through edges are counted by the first counter of their
+//!     target, as it can't be entered otherwise.
+//!
+//! Counters are `add [counter], 1` (`add` + `adc` in 32-bit mode), which
+//! clobbers flags, so a counter is placed at the first position of the block
+//! where flags are written before they are read. A counter that can't be
+//! placed this way is set to \ref kCounterUnknown, all other counters are
+//! zeroed by `process()`. In 64-bit mode counters are addressed by
+//! `[rip + rel32]`, so the array must be within 2GB of the code, memory
+//! allocated by `VMemMgr` of the runtime the code is added to works.
+//!
+//! The counters are consumed by \ref X86BlockLayoutPass when the same code is
+//! generated again. Both passes must see the same nodes, so they have to be
+//! added at the same place, right after `X86Compiler` was attached, which
+//! adds its register allocator pass:
+//!
+//! ~~~
+//! X86Compiler cc(&code);
+//! cc.addPassT<X86EdgeCounterPass>(counters, capacity);
+//! ~~~
+class ASMJIT_VIRTAPI X86EdgeCounterPass : public CBPass {
+public:
+  ASMJIT_NONCOPYABLE(X86EdgeCounterPass)
+  typedef CBPass Base;
+
+  //! Value of a counter that is not counted.
+  static const uint64_t kCounterUnknown = ~static_cast<uint64_t>(0);
+
+  // --------------------------------------------------------------------------
+  // [Construction / Destruction]
+  // --------------------------------------------------------------------------
+
+  //! Create a new `X86EdgeCounterPass` that uses `capacity` counters of the
+  //! `counters` array.
+  ASMJIT_API X86EdgeCounterPass(uint64_t* counters, size_t capacity) noexcept;
+  ASMJIT_API virtual ~X86EdgeCounterPass() noexcept;
+
+  // --------------------------------------------------------------------------
+  // [Interface]
+  // --------------------------------------------------------------------------
+
+  ASMJIT_API virtual Error process(Zone* zone) noexcept override;
+
+  // --------------------------------------------------------------------------
+  // [Accessors]
+  // --------------------------------------------------------------------------
+
+  //! Get the counters array.
+  ASMJIT_INLINE uint64_t* getCounters() const noexcept { return _counters; }
+  //! Get the capacity of the counters array.
+  ASMJIT_INLINE size_t getCapacity() const noexcept { return _capacity; }
+
+  //! Get the number of counters required by the last `process()`.
+  //!
+  //! Functions whose counters don't fit into the capacity are not counted.
+  ASMJIT_INLINE size_t getCounterCount() const noexcept { return _counterCount; }
+  //! Get the number of counters inserted by the last `process()`.
+  ASMJIT_INLINE uint32_t getInsertedCount() const noexcept { return _insertedCount; }
+
+  // --------------------------------------------------------------------------
+  // [Members]
+  // --------------------------------------------------------------------------
+
+  uint64_t* _counters;                   //!< Counters array.
+  size_t _capacity;                      //!< Capacity of the counters array.
+  size_t _counterCount;                  //!< Counters required by the last `process()`.
+  uint32_t _insertedCount;               //!< Counters inserted by the last `process()`.
+};
+
+// ============================================================================
+// [asmjit::X86BlockLayoutPass]
+// ============================================================================
+
+//! Pass that reorders blocks by counters collected by \ref X86EdgeCounterPass.
+//!
+//! Blocks of each function are placed so the more frequent successor follows
+//! its block, starting at the entry block and always continuing with the most
+//! frequent edge that leads to a block that was not placed yet:
+//!
+//!   - A conditional jump whose target is placed after it is inverted and
+//!     jumps to its former fall-through block instead.
+//!   - A `jmp` or a fall-through to a block that is not placed after it is
+//!     replaced by a `jmp`, a `jmp` to the next block is removed.
+//!   - Blocks that were never executed are moved into the `.text.cold`
+//!     section (created if it doesn't exist) by \ref CBSection nodes, so they
+//!     don't share cache lines with the hot code.
+//!
+//! The entry block stays first and the block that ends the function stays
+//! last. Functions that were not executed, and functions that use jump
+//! tables, are not changed. Cold code switches back to the `.text` section,
+//! which is the only section functions can be generated into.
+//!
+//! The pass must be added at the same place as \ref X86EdgeCounterPass was
+//! when the counters were collected:
+//!
+//! ~~~
+//! X86Compiler cc(&code);
+//! cc.addPassT<X86BlockLayoutPass>(counters, count);
+//! ~~~
+class ASMJIT_VIRTAPI X86BlockLayoutPass : public CBPass {
+public:
+  ASMJIT_NONCOPYABLE(X86BlockLayoutPass)
+  typedef CBPass Base;
+
+  // --------------------------------------------------------------------------
+  // [Construction / Destruction]
+  // --------------------------------------------------------------------------
+
+  //! Create a new `X86BlockLayoutPass` that uses `count` counters of the
+  //! `counters` array.
+  ASMJIT_API X86BlockLayoutPass(const uint64_t* counters, size_t count) noexcept;
+  ASMJIT_API virtual ~X86BlockLayoutPass() noexcept;
+
+  // --------------------------------------------------------------------------
+  // [Interface]
+  // --------------------------------------------------------------------------
+
+  ASMJIT_API virtual Error process(Zone* zone) noexcept override;
+
+  // --------------------------------------------------------------------------
+  // [Accessors]
+  // --------------------------------------------------------------------------
+
+  //! Get the number of blocks moved by the last `process()`.
+  ASMJIT_INLINE uint32_t getMovedCount() const noexcept { return _movedCount; }
+  //! Get the number of blocks moved into the cold section by the last `process()`.
+  ASMJIT_INLINE uint32_t getColdCount() const noexcept { return _coldCount; }
+  //! Get the number of conditional jumps inverted by the last `process()`.
+  ASMJIT_INLINE uint32_t getInvertedCount() const noexcept { return _invertedCount; }
+
+  // --------------------------------------------------------------------------
+  // [Members]
+  // --------------------------------------------------------------------------
+
+  const uint64_t* _counters;             //!< Counters array.
+  size_t _count;                         //!< Number of counters.
+  uint32_t _movedCount;                  //!< Blocks moved by the last `process()`.
+  uint32_t _coldCount;                   //!< Blocks moved into the cold section by the last `process()`.
+  uint32_t _invertedCount;               //!< Jumps inverted by the last `process()`.
+};
+
+//! \}
+
+} // asmjit namespace
+
+// [Api-End]
+#include "../asmjit_apiend.h"
+
+// [Guard]
+#endif // !ASMJIT_DISABLE_COMPILER
+#endif // _ASMJIT_X86_X86BLOCKLAYOUT_H
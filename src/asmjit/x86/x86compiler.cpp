@@ -12,8 +12,12 @@
 #if defined(ASMJIT_BUILD_X86) && !defined(ASMJIT_DISABLE_COMPILER)
 
 // [Dependencies]
+#include "../base/osutils.h"
+#include "../base/runtime.h"
 #include "../base/utils.h"
 #include "../x86/x86compiler.h"
+#include "../x86/x86instimpl_p.h"
+#include "../x86/x86internal_p.h"
 #include "../x86/x86regalloc_p.h"
 
 // [Api-Begin]
@@ -26,6 +30,7 @@ namespace asmjit {
 // ============================================================================
 
 X86Compiler::X86Compiler(CodeHolder* code) noexcept : CodeCompiler() {
+  _validationCache.reset();
   if (code)
     code->attach(this);
 }
@@ -65,27 +70,29 @@ Error X86Compiler::finalize() {
     _globalConstPool = nullptr;
   }
 
-  Error err = kErrorOk;
-  ZoneVector<CBPass*>& passes = _cbPasses;
-
-  for (size_t i = 0, len = passes.getLength(); i < len; i++) {
-    CBPass* pass = passes[i];
-    err = pass->process(&_cbPassZone);
-    _cbPassZone.reset();
-    if (err) break;
-  }
-
-  _cbPassZone.reset();
+  Error err = runPasses();
   if (ASMJIT_UNLIKELY(err)) return setLastError(err);
 
+  uint64_t startTime = hasStatsEnabled() ? OSUtils::getHighResTime() : uint64_t(0);
+
   // TODO: There must be possibility to attach more assemblers, this is not so nice.
   if (_code->_cgAsm) {
-    return serialize(_code->_cgAsm);
+    err = serialize(_code->_cgAsm);
   }
   else {
     X86Assembler a(_code);
-    return serialize(&a);
+    err = serialize(&a);
   }
+
+  if (hasStatsEnabled())
+    _serializeTime += OSUtils::getHighResTime() - startTime;
+  return err;
+}
+
+Error X86Compiler::serialize(CodeEmitter* dst) {
+  if (dst->isAssembler() && ArchInfo::isX86Family(dst->getArchType()))
+    return X86Internal::serialize(this, static_cast<X86Assembler*>(dst));
+  return Base::serialize(dst);
 }
 
 // ============================================================================
@@ -97,6 +104,72 @@ static ASMJIT_INLINE bool isJumpInst(uint32_t instId) noexcept {
          (instId >= X86Inst::kIdLoop && instId <= X86Inst::kIdLoopne) ;
 }
 
+//! \internal
+//!
+//! Get the element size if the memory operand at `opArray[memIndex]` refers to
+//! a splat constant of `CodeCompiler`'s constant pool that can be replaced by
+//! AVX-512 embedded broadcast {1toN}, zero otherwise.
+static uint32_t X86Compiler_getBroadcastSize(const X86Compiler* self, uint32_t instId, uint32_t options, const Operand_* const* opArray, uint32_t opCount, uint32_t& memIndex) noexcept {
+  if ((options & X86Inst::kOption1ToX) || !X86Inst::isDefinedId(instId))
+    return 0;
+
+  uint32_t i;
+  const X86Mem* m = nullptr;
+
+  // Broadcast operand is never the destination.
+  for (i = 1; i < opCount; i++) {
+    if (opArray[i]->isMem()) {
+      m = &opArray[i]->as<X86Mem>();
+      memIndex = i;
+      break;
+    }
+  }
+
+  if (!m || !m->hasBaseLabel() || m->hasIndex())
+    return 0;
+
+  uint32_t size = m->getSize();
+  if (size != 16 && size != 32)
+    return 0;
+
+  const CBConstPool* pool = nullptr;
+  if (self->_localConstPool && self->_localConstPool->getId() == m->getBaseId())
+    pool = self->_localConstPool;
+  else if (self->_globalConstPool && self->_globalConstPool->getId() == m->getBaseId())
+    pool = self->_globalConstPool;
+  else
+    return 0;
+
+  const X86Inst::CommonData& commonData = X86Inst::getInst(instId).getCommonData();
+  if (!commonData.hasAvx512B32() && !commonData.hasAvx512B64())
+    return 0;
+
+  // Broadcast requires EVEX, don't turn VEX encodable instructions into EVEX
+  // ones unless the instruction uses ZMM|K registers or a {k} mask anyway.
+  bool isEvex = self->getExtraReg().isValid() || (options & X86Inst::kOptionEvex);
+  for (i = 0; i < opCount && !isEvex; i++) {
+    if (opArray[i]->isReg()) {
+      const X86Reg& reg = opArray[i]->as<X86Reg>();
+      isEvex = reg.isZmm() || reg.isK();
+    }
+  }
+
+  if (!isEvex)
+    return 0;
+
+  const uint8_t* data = static_cast<const uint8_t*>(
+    pool->getConstPool().getData(static_cast<uint32_t>(m->getOffsetLo32()), size));
+  if (!data)
+    return 0;
+
+  uint32_t elementSize = commonData.hasAvx512B32() ? 4 : 8;
+  for (i = elementSize; i < size; i += elementSize)
+    if (::memcmp(data, data + i, elementSize) != 0)
+      return 0;
+
+  return elementSize;
+}
+
 Error X86Compiler::_emit(uint32_t instId, const Operand_& o0, const Operand_& o1, const Operand_& o2, const Operand_& o3) {
   uint32_t options = getOptions() | getGlobalOptions();
   const char* inlineComment = getInlineComment();
@@ -106,6 +179,22 @@ Error X86Compiler::_emit(uint32_t instId, const Operand_& o0, const Operand_& o1
                      static_cast<uint32_t>(!o2.isNone()) +
                      static_cast<uint32_t>(!o3.isNone()) ;
 
+  // Fold a splat constant into AVX-512 embedded broadcast, it loads only one
+  // element instead of the whole vector (the constant stays in the pool).
+  if ((_localConstPool || _globalConstPool) && opCount >= 2) {
+    const Operand_* srcArray[] = { &o0, &o1, &o2, &o3 };
+    uint32_t memIndex = 0;
+    uint32_t elementSize = X86Compiler_getBroadcastSize(this, instId, options, srcArray, opCount, memIndex);
+
+    if (ASMJIT_UNLIKELY(elementSize)) {
+      Operand opArray[] = { Operand(o0), Operand(o1), Operand(o2), Operand(o3) };
+      opArray[memIndex].as<X86Mem>().setSize(elementSize);
+
+      addOptions(X86Inst::kOption1ToX);
+      return _emit(instId, opArray[0], opArray[1], opArray[2], opArray[3]);
+    }
+  }
+
   // Handle failure and rare cases first.
   const uint32_t kErrorsAndSpecialCases = kOptionMaybeFailureCase | // CodeEmitter is in error state.
                                           kOptionStrictValidation ; // Strict validation.
@@ -125,7 +214,13 @@ Error X86Compiler::_emit(uint32_t instId, const Operand_& o0, const Operand_& o1
       };
 
       Inst::Detail instDetail(instId, options, _extraReg);
-      Error err = Inst::validate(getArchType(), instDetail, opArray, opCount);
+      Error err = X86InstImpl::validate(getArchType(), instDetail, opArray, opCount, &_validationCache);
+
+#if !defined(ASMJIT_DISABLE_EXTENSIONS)
+      // Reject instructions the target CPU doesn't have.
+      if (!err && _codeInfo.hasFeatures())
+        err = Inst::validateFeatures(getArchType(), instDetail, opArray, opCount, _codeInfo.getFeatures());
+#endif // !ASMJIT_DISABLE_EXTENSIONS
 
       if (err) {
 #if !defined(ASMJIT_DISABLE_LOGGING)
@@ -150,8 +245,8 @@ Error X86Compiler::_emit(uint32_t instId, const Operand_& o0, const Operand_& o1
 
   // decide between `CBInst` and `CBJump`.
   if (isJumpInst(instId)) {
-    CBJump* node = _cbHeap.allocT<CBJump>(sizeof(CBJump) + opCount * sizeof(Operand));
-    Operand* opArray = reinterpret_cast<Operand*>(reinterpret_cast<uint8_t*>(node) + sizeof(CBJump));
+    Operand* opArray;
+    CBJump* node = static_cast<CBJump*>(_allocInstNode(sizeof(CBJump), opCount, &opArray));
 
     if (ASMJIT_UNLIKELY(!node))
       return setLastError(DebugUtils::errored(kErrorNoHeapMemory));
@@ -167,7 +262,8 @@ Error X86Compiler::_emit(uint32_t instId, const Operand_& o0, const Operand_& o1
 
     CBLabel* jTarget = nullptr;
     if (!(options & kOptionUnfollow)) {
-      if (opArray[0].isLabel()) {
+      // A label bound by `flush()` is outside of the node list.
+      if (opArray[0].isLabel() && !_code->isLabelBound(opArray[0].getId())) {
         Error err = getCBLabel(&jTarget, static_cast<Label&>(opArray[0]));
         if (err) return setLastError(err);
       }
@@ -202,18 +298,35 @@ Error X86Compiler::_emit(uint32_t instId, const Operand_& o0, const Operand_& o1
     return kErrorOk;
   }
   else {
-    CBInst* node = _cbHeap.allocT<CBInst>(sizeof(CBInst) + opCount * sizeof(Operand));
-    Operand* opArray = reinterpret_cast<Operand*>(reinterpret_cast<uint8_t*>(node) + sizeof(CBInst));
+    CBInst* node;
+
+    if (_packedOps && PackedOp::canPack(o0) && PackedOp::canPack(o1) &&
+                      PackedOp::canPack(o2) && PackedOp::canPack(o3)) {
+      Operand_ opArray[4];
+      opArray[0].copyFrom(o0);
+      opArray[1].copyFrom(o1);
+      opArray[2].copyFrom(o2);
+      opArray[3].copyFrom(o3);
+
+      node = _newPackedInstNode(instId, options, opArray, opCount);
+      if (ASMJIT_UNLIKELY(!node))
+        return setLastError(DebugUtils::errored(kErrorNoHeapMemory));
+    }
+    else {
+      Operand* opArray;
+      node = static_cast<CBInst*>(_allocInstNode(sizeof(CBInst), opCount, &opArray));
 
-    if (ASMJIT_UNLIKELY(!node))
-      return setLastError(DebugUtils::errored(kErrorNoHeapMemory));
+      if (ASMJIT_UNLIKELY(!node))
+        return setLastError(DebugUtils::errored(kErrorNoHeapMemory));
 
-    if (opCount > 0) opArray[0].copyFrom(o0);
-    if (opCount > 1) opArray[1].copyFrom(o1);
-    if (opCount > 2) opArray[2].copyFrom(o2);
-    if (opCount > 3) opArray[3].copyFrom(o3);
+      if (opCount > 0) opArray[0].copyFrom(o0);
+      if (opCount > 1) opArray[1].copyFrom(o1);
+      if (opCount > 2) opArray[2].copyFrom(o2);
+      if (opCount > 3) opArray[3].copyFrom(o3);
+
+      node = new(node) CBInst(this, instId, options, opArray, opCount);
+    }
 
-    node = new(node) CBInst(this, instId, options, opArray, opCount);
     node->_instDetail.extraReg = _extraReg;
     _extraReg.reset();
 
@@ -261,7 +374,13 @@ Error X86Compiler::_emit(uint32_t instId, const Operand_& o0, const Operand_& o1
       };
 
       Inst::Detail instDetail(instId, options, _extraReg);
-      Error err = Inst::validate(getArchType(), instDetail, opArray, opCount);
+      Error err = X86InstImpl::validate(getArchType(), instDetail, opArray, opCount, &_validationCache);
+
+#if !defined(ASMJIT_DISABLE_EXTENSIONS)
+      // Reject instructions the target CPU doesn't have.
+      if (!err && _codeInfo.hasFeatures())
+        err = Inst::validateFeatures(getArchType(), instDetail, opArray, opCount, _codeInfo.getFeatures());
+#endif // !ASMJIT_DISABLE_EXTENSIONS
 
       if (err) {
 #if !defined(ASMJIT_DISABLE_LOGGING)
@@ -286,8 +405,8 @@ Error X86Compiler::_emit(uint32_t instId, const Operand_& o0, const Operand_& o1
 
   // decide between `CBInst` and `CBJump`.
   if (isJumpInst(instId)) {
-    CBJump* node = _cbHeap.allocT<CBJump>(sizeof(CBJump) + opCount * sizeof(Operand));
-    Operand* opArray = reinterpret_cast<Operand*>(reinterpret_cast<uint8_t*>(node) + sizeof(CBJump));
+    Operand* opArray;
+    CBJump* node = static_cast<CBJump*>(_allocInstNode(sizeof(CBJump), opCount, &opArray));
 
     if (ASMJIT_UNLIKELY(!node))
       return setLastError(DebugUtils::errored(kErrorNoHeapMemory));
@@ -305,7 +424,8 @@ Error X86Compiler::_emit(uint32_t instId, const Operand_& o0, const Operand_& o1
 
     CBLabel* jTarget = nullptr;
     if (!(options & kOptionUnfollow)) {
-      if (opArray[0].isLabel()) {
+      // A label bound by `flush()` is outside of the node list.
+      if (opArray[0].isLabel() && !_code->isLabelBound(opArray[0].getId())) {
         Error err = getCBLabel(&jTarget, static_cast<Label&>(opArray[0]));
         if (err) return setLastError(err);
       }
@@ -340,8 +460,8 @@ Error X86Compiler::_emit(uint32_t instId, const Operand_& o0, const Operand_& o1
     return kErrorOk;
   }
   else {
-    CBInst* node = _cbHeap.allocT<CBInst>(sizeof(CBInst) + opCount * sizeof(Operand));
-    Operand* opArray = reinterpret_cast<Operand*>(reinterpret_cast<uint8_t*>(node) + sizeof(CBInst));
+    Operand* opArray;
+    CBInst* node = static_cast<CBInst*>(_allocInstNode(sizeof(CBInst), opCount, &opArray));
 
     if (ASMJIT_UNLIKELY(!node))
       return setLastError(DebugUtils::errored(kErrorNoHeapMemory));
@@ -367,6 +487,1084 @@ Error X86Compiler::_emit(uint32_t instId, const Operand_& o0, const Operand_& o1
   }
 }
 
+// ============================================================================
+// [asmjit::X86Compiler - Inline]
+// ============================================================================
+
+//! \internal
+//!
+//! Maps virtual registers and labels of an inlined function to their copies.
+struct X86InlineMap {
+  uint32_t* vRegIds;                     //!< Copies of virtual registers.
+  uint32_t vRegCount;                    //!< Number of virtual registers before inlining.
+  uint32_t* labelIds;                    //!< Copies of labels.
+  uint32_t labelCount;                   //!< Number of labels before inlining.
+};
+
+static Error X86Compiler_mapVirtReg(X86Compiler* self, X86InlineMap& map, uint32_t& id) noexcept {
+  if (!Operand::isPackedId(id))
+    return kErrorOk;
+
+  uint32_t index = Operand::unpackId(id);
+  if (index >= map.vRegCount)
+    return kErrorOk;
+
+  uint32_t mapped = map.vRegIds[index];
+  if (mapped == kInvalidValue) {
+    VirtReg* src = self->getVirtRegById(id);
+    if (src->isFixed()) {
+      mapped = id;
+    }
+    else {
+      VirtReg* dst = self->newVirtReg(src->getTypeId(), src->getSignature(), src->getName());
+      if (ASMJIT_UNLIKELY(!dst))
+        return DebugUtils::errored(kErrorNoHeapMemory);
+
+      dst->_size = src->_size;
+      dst->_alignment = src->_alignment;
+      dst->_priority = src->_priority;
+      dst->_isStack = src->_isStack;
+      dst->_saveOnUnuse = src->_saveOnUnuse;
+      mapped = dst->getId();
+    }
+    map.vRegIds[index] = mapped;
+  }
+
+  id = mapped;
+  return kErrorOk;
+}
+
+static Error X86Compiler_mapLabel(X86Compiler* self, X86InlineMap& map, uint32_t& id) noexcept {
+  uint32_t index = Operand::unpackId(id);
+  if (index >= map.labelCount)
+    return kErrorOk;
+
+  uint32_t mapped = map.labelIds[index];
+  if (mapped == kInvalidValue) {
+    Label label = self->newLabel();
+    if (ASMJIT_UNLIKELY(!label.isValid()))
+      return DebugUtils::errored(kErrorNoHeapMemory);
+
+    mapped = label.getId();
+    map.labelIds[index] = mapped;
+  }
+
+  id = mapped;
+  return kErrorOk;
+}
+
+static Error X86Compiler_mapOperand(X86Compiler* self, X86InlineMap& map, Operand_& op) noexcept {
+  if (op.isReg()) {
+    ASMJIT_PROPAGATE(X86Compiler_mapVirtReg(self, map, op._reg.id));
+  }
+  else if (op.isMem()) {
+    X86Mem& m = static_cast<X86Mem&>(op);
+    if (m.hasBaseLabel())
+      ASMJIT_PROPAGATE(X86Compiler_mapLabel(self, map, m._mem.base));
+    else if (m.hasBaseReg())
+      ASMJIT_PROPAGATE(X86Compiler_mapVirtReg(self, map, m._mem.base));
+
+    if (m.hasIndexReg())
+      ASMJIT_PROPAGATE(X86Compiler_mapVirtReg(self, map, m._mem.index));
+  }
+  else if (op.isLabel()) {
+    ASMJIT_PROPAGATE(X86Compiler_mapLabel(self, map, op._label.id));
+  }
+  return kErrorOk;
+}
+
+//! \internal
+//!
+//! Emit a move of `src` to `dst`, both of `typeId`.
+static Error X86Compiler_emitInlineMove(X86Compiler* self, const Operand_& dst, const Operand_& src, uint32_t typeId, const char* comment) noexcept {
+  if (src.isImm()) {
+    if (!TypeId::isInt(typeId))
+      return DebugUtils::errored(kErrorInvalidArgument);
+    self->setInlineComment(comment);
+    return self->emit(X86Inst::kIdMov, dst, src);
+  }
+
+  bool avxEnabled = TypeId::sizeOf(typeId) > 16 || self->getCodeInfo().getFeatures().has(CpuInfo::kX86FeatureAVX);
+  return X86Internal::emitRegMove(reinterpret_cast<X86Emitter*>(self), dst, src, typeId, avxEnabled, comment);
+}
+
+Error X86Compiler::inlineFunc(CCFunc* func, const Operand_* args, uint32_t argCount, const Operand_* rets, uint32_t retCount) {
+  if (ASMJIT_UNLIKELY(_lastError))
+    return _lastError;
+
+  // The inlined function must be complete and can't be the current one.
+  if (ASMJIT_UNLIKELY(!getFunc() || !func || func == getFunc() || !func->getExitNode() || !func->getExitNode()->getPrev()))
+    return setLastError(DebugUtils::errored(kErrorInvalidState));
+
+  if (ASMJIT_UNLIKELY(argCount != func->getArgCount() || retCount > 2))
+    return setLastError(DebugUtils::errored(kErrorInvalidArgument));
+
+  Zone zone(8096 - Zone::kZoneOverhead);
+  X86InlineMap map;
+
+  map.vRegCount = static_cast<uint32_t>(_vRegArray.getLength());
+  map.labelCount = static_cast<uint32_t>(_code->getLabelsCount());
+  map.vRegIds = zone.allocT<uint32_t>(map.vRegCount * sizeof(uint32_t) + 1);
+  map.labelIds = zone.allocT<uint32_t>(map.labelCount * sizeof(uint32_t) + 1);
+
+  if (ASMJIT_UNLIKELY(!map.vRegIds || !map.labelIds))
+    return setLastError(DebugUtils::errored(kErrorNoHeapMemory));
+
+  ::memset(map.vRegIds, 0xFF, map.vRegCount * sizeof(uint32_t));
+  ::memset(map.labelIds, 0xFF, map.labelCount * sizeof(uint32_t));
+
+  Error err = kErrorOk;
+  uint32_t i;
+
+  // Returning from the inlined function jumps to `end`.
+  Label end = newLabel();
+  map.labelIds[Operand::unpackId(func->getExitLabel().getId())] = end.getId();
+
+  // Move arguments to copies of the function's arguments.
+  for (i = 0; i < argCount; i++) {
+    VirtReg* vreg = func->getArg(i);
+    if (!vreg) continue;
+
+    uint32_t id = vreg->getId();
+    if ((err = X86Compiler_mapVirtReg(this, map, id)) != kErrorOk ||
+        (err = X86Compiler_emitInlineMove(this, Reg::fromSignature(vreg->getSignature(), id), args[i], vreg->getTypeId(), "[Inline] Arg")) != kErrorOk)
+      return setLastError(err);
+  }
+
+  CBNode* stop = func->getExitNode();
+  for (CBNode* node = func->getNext(); node != stop; node = node->getNext()) {
+    switch (node->getType()) {
+      case CBNode::kNodeInst: {
+        CBInst* inst = static_cast<CBInst*>(node);
+        Operand ops[6];
+        uint32_t opCount = inst->getOpCount();
+        const Operand* opArray = inst->getOpArray(ops);
+
+        // Jump tables are placed after the function and can't be copied.
+        if (inst->isCase()) {
+          err = DebugUtils::errored(kErrorInvalidState);
+          break;
+        }
+
+        for (i = 0; i < opCount; i++) {
+          ops[i].copyFrom(opArray[i]);
+          if ((err = X86Compiler_mapOperand(this, map, ops[i])) != kErrorOk)
+            return setLastError(err);
+        }
+
+        if (inst->hasExtraReg()) {
+          RegOnly extraReg(inst->getExtraReg());
+          if ((err = X86Compiler_mapVirtReg(this, map, extraReg._id)) != kErrorOk)
+            return setLastError(err);
+          setExtraReg(extraReg);
+        }
+
+        addOptions(inst->getOptions() & ~kOptionReservedMask);
+        setInlineComment(inst->getInlineComment());
+        err = _emit(inst->getInstId(), ops[0], ops[1], ops[2], ops[3], ops[4], ops[5]);
+        break;
+      }
+
+      case CBNode::kNodeLabel: {
+        Label label(static_cast<CBLabel*>(node)->getLabel());
+        if ((err = X86Compiler_mapLabel(this, map, label._label.id)) == kErrorOk)
+          err = bind(label);
+        break;
+      }
+
+      case CBNode::kNodeData: {
+        CBData* data = static_cast<CBData*>(node);
+        err = embed(data->getData(), data->getSize());
+        break;
+      }
+
+      case CBNode::kNodeAlign: {
+        CBAlign* align = static_cast<CBAlign*>(node);
+        err = this->align(align->getMode(), align->getAlignment());
+        break;
+      }
+
+      case CBNode::kNodeComment: {
+        err = comment(node->getInlineComment());
+        break;
+      }
+
+      case CBNode::kNodeHint: {
+        // Hints are only informative.
+        break;
+      }
+
+      case CBNode::kNodeFuncCall: {
+        CCFuncCall* src = static_cast<CCFuncCall*>(node);
+        Operand target(src->getTarget());
+
+        if ((err = X86Compiler_mapOperand(this, map, target)) != kErrorOk)
+          break;
+
+        CCFuncCall* call = _cbHeap.allocT<CCFuncCall>(sizeof(CCFuncCall) + sizeof(Operand));
+        uint32_t callArgCount = src->getDetail().getArgCount();
+        Operand* callArgs = callArgCount ? static_cast<Operand*>(_cbHeap.alloc(callArgCount * sizeof(Operand))) : nullptr;
+
+        if (ASMJIT_UNLIKELY(!call || (callArgCount && !callArgs))) {
+          err = DebugUtils::errored(kErrorNoHeapMemory);
+          break;
+        }
+
+        Operand* opArray = reinterpret_cast<Operand*>(reinterpret_cast<uint8_t*>(call) + sizeof(CCFuncCall));
+        opArray[0].copyFrom(target);
+
+        new(call) CCFuncCall(this, src->getInstId(), src->getOptions(), opArray, 1);
+        call->_funcDetail = src->_funcDetail;
+        call->_args = callArgs;
+
+        for (i = 0; i < callArgCount && !err; i++) {
+          callArgs[i].copyFrom(src->getArg(i));
+          err = X86Compiler_mapOperand(this, map, callArgs[i]);
+        }
+
+        for (i = 0; i < 2 && !err; i++) {
+          call->_ret[i].copyFrom(src->_ret[i]);
+          err = X86Compiler_mapOperand(this, map, call->_ret[i]);
+        }
+
+        if (!err)
+          addNode(call);
+        break;
+      }
+
+      case CBNode::kNodeFuncExit: {
+        CCFuncRet* ret = static_cast<CCFuncRet*>(node);
+
+        for (i = 0; i < retCount && !err; i++) {
+          Operand src(i == 0 ? ret->getFirst() : ret->getSecond());
+          if (!src.isVirtReg() || rets[i].isNone()) continue;
+
+          uint32_t typeId = getVirtRegById(src.getId())->getTypeId();
+          if ((err = X86Compiler_mapOperand(this, map, src)) == kErrorOk)
+            err = X86Compiler_emitInlineMove(this, rets[i], src, typeId, "[Inline] Ret");
+        }
+
+        if (!err && node->getNext() != stop)
+          err = jmp(end);
+        break;
+      }
+
+      default:
+        err = DebugUtils::errored(kErrorInvalidState);
+        break;
+    }
+
+    if (ASMJIT_UNLIKELY(err))
+      return setLastError(err);
+  }
+
+  return bind(end);
+}
+
+// ============================================================================
+// [asmjit::X86Compiler - Switch]
+// ============================================================================
+
+//! \internal
+//!
+//! Minimum number of cases lowered to a jump table.
+static const uint32_t X86Switch_kMinTableCases = 4;
+
+//! \internal
+//!
+//! Maximum ratio of jump table entries to cases, entries of missing keys jump
+//! to the default target.
+static const uint32_t X86Switch_kMaxTableRatio = 3;
+
+//! \internal
+//!
+//! Maximum number of jump table entries.
+static const uint32_t X86Switch_kMaxTableSize = 65536;
+
+//! \internal
+//!
+//! Maximum number of cases compared sequentially by a leaf of the binary search.
+static const uint32_t X86Switch_kMaxLinearCases = 3;
+
+//! \internal
+struct X86SwitchCase {
+  int32_t key;                           //!< Key of the case.
+  uint32_t labelId;                      //!< Id of the target label.
+};
+
+static bool X86Switch_lessByKey(const X86SwitchCase& a, const X86SwitchCase& b) noexcept { return a.key < b.key; }
+static bool X86Switch_lessByLabel(const X86SwitchCase& a, const X86SwitchCase& b) noexcept { return a.labelId < b.labelId; }
+
+//! \internal
+//!
+//! Create a case jump to `labelId` that describes an edge of a jump table.
+static Error X86Compiler_newCaseJump(X86Compiler* self, CBJump** out, uint32_t labelId) noexcept {
+  // A label bound by `flush()` has no node the jump could be linked with.
+  if (ASMJIT_UNLIKELY(self->getCode()->isLabelBound(labelId)))
+    return DebugUtils::errored(kErrorInvalidLabel);
+
+  CBLabel* target;
+  ASMJIT_PROPAGATE(self->getCBLabel(&target, labelId));
+
+  Operand* opArray;
+  CBJump* node = static_cast<CBJump*>(self->_allocInstNode(sizeof(CBJump), 1, &opArray));
+  if (ASMJIT_UNLIKELY(!node))
+    return DebugUtils::errored(kErrorNoHeapMemory);
+
+  opArray[0] = Label(labelId);
+  new(node) CBJump(self, X86Inst::kIdJmp, 0, opArray, 1);
+  node->orFlags(CBNode::kFlagIsJcc | CBNode::kFlagIsCase);
+
+  node->_target = target;
+  node->_jumpNext = target->_from;
+  target->_from = node;
+  target->addNumRefs();
+
+  *out = node;
+  return kErrorOk;
+}
+
+//! \internal
+//!
+//! Emit a binary search of `index` in `cases` sorted by key.
+static Error X86Compiler_emitSwitchTree(X86Compiler* self, const X86Gp& index, const X86SwitchCase* cases, uint32_t count, const Label& defaultTarget) {
+  if (count <= X86Switch_kMaxLinearCases) {
+    for (uint32_t i = 0; i < count; i++) {
+      ASMJIT_PROPAGATE(self->cmp(index, cases[i].key));
+      ASMJIT_PROPAGATE(self->je(Label(cases[i].labelId)));
+    }
+    return self->jmp(defaultTarget);
+  }
+
+  uint32_t mid = count / 2;
+  Label L_Right = self->newLabel();
+
+  ASMJIT_PROPAGATE(self->cmp(index, cases[mid].key));
+  ASMJIT_PROPAGATE(self->je(Label(cases[mid].labelId)));
+  ASMJIT_PROPAGATE(self->jg(L_Right));
+  ASMJIT_PROPAGATE(X86Compiler_emitSwitchTree(self, index, cases, mid, defaultTarget));
+
+  ASMJIT_PROPAGATE(self->bind(L_Right));
+  return X86Compiler_emitSwitchTree(self, index, cases + mid + 1, count - mid - 1, defaultTarget);
+}
+
+//! \internal
+//!
+//! Emit a bounds check and an indirect jump through a table of `range` entries
+//! indexed by `index - cases[0].key`.
+static Error X86Compiler_emitSwitchTable(X86Compiler* self, const X86Gp& index, X86SwitchCase* cases, uint32_t count, uint32_t range, const Label& defaultTarget) {
+  CCFunc* func = self->getFunc();
+  CBJumpTable* table = self->newJumpTable(range);
+  if (ASMJIT_UNLIKELY(!table))
+    return DebugUtils::errored(kErrorNoHeapMemory);
+
+  table->setSection(self->getConstSection());
+  int32_t minKey = cases[0].key;
+
+  X86Gp idx = self->newUIntPtr("switch.idx");
+  X86Gp base = self->newIntPtr("switch.table");
+
+  // Writing a 32-bit register zero extends it, so `idx` can index the table.
+  ASMJIT_PROPAGATE(self->mov(idx.r32(), index));
+  if (minKey != 0)
+    ASMJIT_PROPAGATE(self->sub(idx.r32(), minKey));
+  ASMJIT_PROPAGATE(self->cmp(idx.r32(), Imm(range - 1)));
+  ASMJIT_PROPAGATE(self->ja(defaultTarget));
+  ASMJIT_PROPAGATE(self->lea(base, x86::ptr(table->getLabel())));
+
+  // Create a case jump for each distinct target, they must immediately
+  // precede the indirect jump so all targets see the same register state.
+  uint32_t i = 0;
+  std::sort(cases, cases + count, X86Switch_lessByLabel);
+
+  while (i < count) {
+    CBJump* node;
+    ASMJIT_PROPAGATE(X86Compiler_newCaseJump(self, &node, cases[i].labelId));
+    self->addNode(node);
+
+    uint32_t labelId = cases[i].labelId;
+    do {
+      table->setEntry(static_cast<uint32_t>(cases[i].key - minKey), node);
+    } while (++i < count && cases[i].labelId == labelId);
+  }
+
+  if (count < range) {
+    CBJump* node;
+    ASMJIT_PROPAGATE(X86Compiler_newCaseJump(self, &node, defaultTarget.getId()));
+    self->addNode(node);
+
+    for (i = 0; i < range; i++)
+      if (!table->getEntry(i))
+        table->setEntry(i, node);
+  }
+
+  uint32_t gpSize = self->getGpSize();
+  ASMJIT_PROPAGATE(self->jmp(x86::ptr(base, idx, Utils::findFirstBit(gpSize), 0, gpSize)));
+
+  // Place the table after the function, it's never executed.
+  CBNode* prev = self->setCursor(func->getEnd()->getPrev());
+  self->addNode(table);
+  self->_setCursor(prev);
+  return kErrorOk;
+}
+
+Error X86Compiler::switch_(const X86Gp& index, const int32_t* keys, const Label* targets, uint32_t count, const Label& defaultTarget) {
+  if (ASMJIT_UNLIKELY(_lastError))
+    return _lastError;
+
+  if (ASMJIT_UNLIKELY(!getFunc()))
+    return setLastError(DebugUtils::errored(kErrorInvalidState));
+
+  if (ASMJIT_UNLIKELY(count && (!keys || !targets)))
+    return setLastError(DebugUtils::errored(kErrorInvalidArgument));
+
+  if (count == 0)
+    return jmp(defaultTarget);
+
+  Zone zone(8096 - Zone::kZoneOverhead);
+  X86SwitchCase* cases = zone.allocT<X86SwitchCase>(count * sizeof(X86SwitchCase));
+  if (ASMJIT_UNLIKELY(!cases))
+    return setLastError(DebugUtils::errored(kErrorNoHeapMemory));
+
+  uint32_t i;
+  for (i = 0; i < count; i++) {
+    cases[i].key = keys[i];
+    cases[i].labelId = targets[i].getId();
+  }
+
+  std::sort(cases, cases + count, X86Switch_lessByKey);
+  for (i = 1; i < count; i++)
+    if (ASMJIT_UNLIKELY(cases[i - 1].key == cases[i].key))
+      return setLastError(DebugUtils::errored(kErrorInvalidArgument));
+
+  X86Gp index32 = index.r32();
+  uint64_t range = static_cast<uint64_t>(static_cast<int64_t>(cases[count - 1].key) - cases[0].key) + 1;
+
+  Error err;
+  if (count >= X86Switch_kMinTableCases &&
+      range <= static_cast<uint64_t>(count) * X86Switch_kMaxTableRatio &&
+      range <= X86Switch_kMaxTableSize) {
+    err = X86Compiler_emitSwitchTable(this, index32, cases, count, static_cast<uint32_t>(range), defaultTarget);
+  }
+  else {
+    err = X86Compiler_emitSwitchTree(this, index32, cases, count, defaultTarget);
+  }
+
+  if (ASMJIT_UNLIKELY(err))
+    return setLastError(err);
+  return kErrorOk;
+}
+
+// ============================================================================
+// [asmjit::X86Compiler - Memory]
+// ============================================================================
+
+//! \internal
+//!
+//! Maximum size of memory copied, filled, or compared inline.
+static const uint32_t X86MemInline_kMaxSize = 256;
+
+//! \internal
+//!
+//! Maximum number of chunks loaded before they are stored.
+static const uint32_t X86MemInline_kBatchSize = 4;
+
+//! \internal
+struct X86MemChunk {
+  uint32_t offset;                       //!< Offset of the chunk.
+  uint32_t size;                         //!< Size of the chunk (1, 2, 4, 8, 16, or 32 bytes).
+};
+
+//! \internal
+//!
+//! Instructions available to expand memory functions.
+struct X86MemInline {
+  uint32_t gpSize;                       //!< Size of the widest GP chunk.
+  uint32_t vecSize;                      //!< Size of the widest vector chunk (0 if SIMD is not used).
+  bool avx;                              //!< Use VEX encoded vector instructions.
+  bool erms;                             //!< `rep movsb` and `rep stosb` are fast for large sizes.
+  bool fsrm;                             //!< `rep movsb` and `rep stosb` are fast for short sizes.
+};
+
+static void X86MemInline_init(X86Compiler* self, X86MemInline& mi, bool isCompare) noexcept {
+  // Code not restricted to a CPU model runs on the host.
+  const CodeInfo& codeInfo = self->getCodeInfo();
+  const CpuFeatures& features = codeInfo.hasFeatures() ? codeInfo.getFeatures() : CpuInfo::getHost().getFeatures();
+
+  mi.gpSize = self->getGpSize();
+  mi.avx = features.has(CpuInfo::kX86FeatureAVX);
+
+  // 256-bit compares require AVX2, 256-bit moves only AVX.
+  if (mi.avx && features.has(isCompare ? CpuInfo::kX86FeatureAVX2 : CpuInfo::kX86FeatureAVX))
+    mi.vecSize = 32;
+  else if (mi.gpSize == 8 || features.has(CpuInfo::kX86FeatureSSE2))
+    mi.vecSize = 16;
+  else
+    mi.vecSize = 0;
+
+  mi.erms = features.has(CpuInfo::kX86FeatureERMS);
+  mi.fsrm = features.has(CpuInfo::kX86FeatureFSRM);
+}
+
+//! \internal
+//!
+//! Split `size` bytes into chunks of the same size, the widest that fits. The
+//! last chunk overlaps the previous one if `size` is not a multiple of it.
+static uint32_t X86MemInline_split(const X86MemInline& mi, X86MemChunk* chunks, uint32_t size) noexcept {
+  ASMJIT_ASSERT(size != 0);
+
+  uint32_t chunkSize = mi.vecSize && size >= mi.vecSize ? mi.vecSize :
+                       mi.vecSize && size >= 16         ? uint32_t(16) : mi.gpSize;
+  while (chunkSize > size)
+    chunkSize >>= 1;
+
+  uint32_t count = 0;
+  uint32_t offset = 0;
+
+  for (; offset + chunkSize <= size; offset += chunkSize) {
+    chunks[count].offset = offset;
+    chunks[count].size = chunkSize;
+    count++;
+  }
+
+  if (offset != size) {
+    chunks[count].offset = size - chunkSize;
+    chunks[count].size = chunkSize;
+    count++;
+  }
+
+  return count;
+}
+
+//! \internal
+//!
+//! Create a register that holds a chunk of `size` bytes.
+static Operand X86MemInline_newReg(X86Compiler* self, uint32_t size, const char* name) noexcept {
+  if (size == 32)
+    return self->newYmm(name);
+  else if (size == 16)
+    return self->newXmm(name);
+  else if (size == 8)
+    return self->newUInt64(name);
+  else
+    return self->newUInt32(name);
+}
+
+//! \internal
+//!
+//! Get the id of a move of a chunk of `size` bytes, loads of 1 and 2 bytes
+//! zero extend.
+static uint32_t X86MemInline_movId(const X86MemInline& mi, uint32_t size, bool isLoad, bool isAligned) noexcept {
+  if (size >= 16) {
+    if (mi.avx)
+      return isAligned ? X86Inst::kIdVmovdqa : X86Inst::kIdVmovdqu;
+    else
+      return isAligned ? X86Inst::kIdMovdqa : X86Inst::kIdMovdqu;
+  }
+
+  return isLoad && size <= 2 ? X86Inst::kIdMovzx : X86Inst::kIdMov;
+}
+
+//! \internal
+//!
+//! Get a view of the GP register `reg` stored to a chunk of `size` bytes.
+static Operand X86MemInline_storeReg(const Operand& reg, uint32_t size) noexcept {
+  if (size >= 8)
+    return reg;
+
+  const X86Gp& gp = reg.as<X86Gp>();
+  if (size == 1)
+    return gp.r8();
+  else if (size == 2)
+    return gp.r16();
+  else
+    return gp.r32();
+}
+
+static ASMJIT_INLINE bool X86MemInline_isAligned(const X86MemChunk& chunk, uint32_t alignment) noexcept {
+  return chunk.size >= 16 && alignment >= chunk.size && (chunk.offset & (chunk.size - 1)) == 0;
+}
+
+static ASMJIT_INLINE X86Mem X86MemInline_ptr(const X86Gp& base, const X86MemChunk& chunk) noexcept {
+  return x86::ptr(base, static_cast<int32_t>(chunk.offset), chunk.size);
+}
+
+//! \internal
+//!
+//! Call `func` of the C library.
+static Error X86MemInline_call(X86Compiler* self, const Imm& func, const FuncSignature& sign, const Operand_* args, const X86Gp* ret) noexcept {
+  CCFuncCall* call = self->call(func, sign);
+  if (ASMJIT_UNLIKELY(!call))
+    return DebugUtils::errored(kErrorNoHeapMemory);
+
+  for (uint32_t i = 0; i < sign.getArgCount(); i++)
+    call->_setArg(i, args[i]);
+
+  if (ret)
+    call->setRet(0, *ret);
+  return kErrorOk;
+}
+
+//! \internal
+//!
+//! Emit `rep movsb` from `src`, or `rep stosb` of `src` if `isFill`, of `size` bytes.
+static Error X86MemInline_rep(X86Compiler* self, const X86Gp& dst, const Operand_& src, const Operand_& size, bool isFill) noexcept {
+  X86Gp d = self->newUIntPtr("mem.dst");
+  X86Gp n = self->newUIntPtr("mem.count");
+
+  // All registers of `rep` are clobbered.
+  ASMJIT_PROPAGATE(self->mov(d, dst));
+  ASMJIT_PROPAGATE(self->emit(X86Inst::kIdMov, n, size));
+
+  if (!isFill) {
+    X86Gp s = self->newUIntPtr("mem.src");
+    ASMJIT_PROPAGATE(self->mov(s, src.as<X86Gp>()));
+    return self->rep(n).movs(x86::byte_ptr(d), x86::byte_ptr(s));
+  }
+  else {
+    X86Gp v = self->newUInt32("mem.value");
+    ASMJIT_PROPAGATE(self->emit(X86Inst::kIdMov, v, src));
+    return self->rep(n).stos(x86::byte_ptr(d), v.r8());
+  }
+}
+
+static Error X86MemInline_copy(X86Compiler* self, const X86MemInline& mi, const X86Gp& dst, const X86Gp& src, uint32_t size, uint32_t alignment) noexcept {
+  X86MemChunk chunks[X86MemInline_kMaxSize / 4 + 1];
+  uint32_t count = X86MemInline_split(mi, chunks, size);
+
+  if (chunks[0].size == 32)
+    self->getFunc()->getFrameInfo().enableAvxCleanup();
+
+  for (uint32_t i = 0; i < count; i += X86MemInline_kBatchSize) {
+    uint32_t n = count - i < X86MemInline_kBatchSize ? count - i : X86MemInline_kBatchSize;
+    Operand regs[X86MemInline_kBatchSize];
+    uint32_t j;
+
+    for (j = 0; j < n; j++) {
+      const X86MemChunk& chunk = chunks[i + j];
+      uint32_t instId = X86MemInline_movId(mi, chunk.size, true, X86MemInline_isAligned(chunk, alignment));
+
+      regs[j] = X86MemInline_newReg(self, chunk.size, "memcpy.tmp");
+      ASMJIT_PROPAGATE(self->emit(instId, regs[j], X86MemInline_ptr(src, chunk)));
+    }
+
+    for (j = 0; j < n; j++) {
+      const X86MemChunk& chunk = chunks[i + j];
+      uint32_t instId = X86MemInline_movId(mi, chunk.size, false, X86MemInline_isAligned(chunk, alignment));
+
+      Operand reg = chunk.size >= 16 ? regs[j] : X86MemInline_storeReg(regs[j], chunk.size);
+      ASMJIT_PROPAGATE(self->emit(instId, X86MemInline_ptr(dst, chunk), reg));
+    }
+  }
+
+  return kErrorOk;
+}
+
+static Error X86MemInline_fill(X86Compiler* self, const X86MemInline& mi, const X86Gp& dst, uint32_t value, uint32_t size, uint32_t alignment) noexcept {
+  X86MemChunk chunks[X86MemInline_kMaxSize / 4 + 1];
+  uint32_t count = X86MemInline_split(mi, chunks, size);
+  uint32_t chunkSize = chunks[0].size;
+
+  uint64_t pattern = static_cast<uint64_t>(value & 0xFFU) * ASMJIT_UINT64_C(0x0101010101010101);
+  Operand reg;
+
+  // Chunks of up to 4 bytes are stored as immediates, 8-byte chunks need a
+  // register unless they are zero, vectors are broadcast from a register.
+  if (chunkSize >= 16) {
+    X86Xmm xmm;
+
+    if (chunkSize == 32) {
+      X86Ymm ymm = self->newYmm("memset.pattern");
+      self->getFunc()->getFrameInfo().enableAvxCleanup();
+
+      xmm = ymm.xmm();
+      reg = ymm;
+    }
+    else {
+      xmm = self->newXmm("memset.pattern");
+      reg = xmm;
+    }
+
+    if (pattern == 0) {
+      if (mi.avx)
+        ASMJIT_PROPAGATE(self->emit(X86Inst::kIdVxorps, reg, reg, reg));
+      else
+        ASMJIT_PROPAGATE(self->xorps(xmm, xmm));
+    }
+    else {
+      X86Gp gp = self->newUInt32("memset.value");
+      ASMJIT_PROPAGATE(self->mov(gp, static_cast<uint32_t>(pattern)));
+
+      if (mi.avx) {
+        ASMJIT_PROPAGATE(self->vmovd(xmm, gp));
+        ASMJIT_PROPAGATE(self->vpshufd(xmm, xmm, 0));
+        if (chunkSize == 32)
+          ASMJIT_PROPAGATE(self->vinsertf128(reg.as<X86Ymm>(), reg.as<X86Ymm>(), xmm, 1));
+      }
+      else {
+        ASMJIT_PROPAGATE(self->movd(xmm, gp));
+        ASMJIT_PROPAGATE(self->pshufd(xmm, xmm, 0));
+      }
+    }
+  }
+  else if (chunkSize == 8 && pattern != 0) {
+    X86Gp gp = self->newUInt64("memset.value");
+    ASMJIT_PROPAGATE(self->mov(gp, pattern));
+    reg = gp;
+  }
+
+  for (uint32_t i = 0; i < count; i++) {
+    const X86MemChunk& chunk = chunks[i];
+    X86Mem m = X86MemInline_ptr(dst, chunk);
+
+    if (chunk.size >= 16) {
+      uint32_t instId = X86MemInline_movId(mi, chunk.size, false, X86MemInline_isAligned(chunk, alignment));
+      ASMJIT_PROPAGATE(self->emit(instId, m, reg));
+    }
+    else if (chunk.size == 8 && pattern != 0) {
+      ASMJIT_PROPAGATE(self->mov(m, reg.as<X86Gp>()));
+    }
+    else {
+      ASMJIT_PROPAGATE(self->mov(m, Imm(static_cast<int32_t>(static_cast<uint32_t>(pattern)))));
+    }
+  }
+
+  return kErrorOk;
+}
+
+static Error X86MemInline_compare(X86Compiler* self, const X86MemInline& mi, const X86Gp& result, const X86Gp& a, const X86Gp& b, uint32_t size) noexcept {
+  X86MemChunk chunks[X86MemInline_kMaxSize / 4 + 1];
+  uint32_t count = X86MemInline_split(mi, chunks, size);
+  bool isVec = chunks[0].size >= 16;
+
+  if (chunks[0].size == 32)
+    self->getFunc()->getFrameInfo().enableAvxCleanup();
+
+  // `d` is the mask of differing bits or bytes of the first chunk that
+  // differs, starting at `offset`.
+  X86Gp d = self->newUIntPtr("memcmp.diff");
+  X86Gp t = self->newUIntPtr("memcmp.tmp");
+  X86Gp offset = self->newUIntPtr("memcmp.offset");
+
+  Label L_Diff = self->newLabel();
+  Label L_Done = self->newLabel();
+
+  for (uint32_t i = 0; i < count; i++) {
+    const X86MemChunk& chunk = chunks[i];
+
+    if (isVec) {
+      Operand va = X86MemInline_newReg(self, chunk.size, "memcmp.a");
+      uint32_t mask = chunk.size == 32 ? 0xFFFFFFFFU : 0xFFFFU;
+
+      if (mi.avx) {
+        ASMJIT_PROPAGATE(self->emit(X86Inst::kIdVmovdqu, va, X86MemInline_ptr(a, chunk)));
+        ASMJIT_PROPAGATE(self->emit(X86Inst::kIdVpcmpeqb, va, va, X86MemInline_ptr(b, chunk)));
+        ASMJIT_PROPAGATE(self->emit(X86Inst::kIdVpmovmskb, d.r32(), va));
+      }
+      else {
+        // Legacy SSE requires aligned memory operands.
+        X86Xmm vb = self->newXmm("memcmp.b");
+        ASMJIT_PROPAGATE(self->movdqu(va.as<X86Xmm>(), X86MemInline_ptr(a, chunk)));
+        ASMJIT_PROPAGATE(self->movdqu(vb, X86MemInline_ptr(b, chunk)));
+        ASMJIT_PROPAGATE(self->pcmpeqb(va.as<X86Xmm>(), vb));
+        ASMJIT_PROPAGATE(self->pmovmskb(d.r32(), va.as<X86Xmm>()));
+      }
+
+      ASMJIT_PROPAGATE(self->mov(offset.r32(), chunk.offset));
+      ASMJIT_PROPAGATE(self->xor_(d.r32(), Imm(static_cast<int32_t>(mask))));
+    }
+    else {
+      X86Gp dc = chunk.size == 8 ? d : d.r32();
+      X86Gp tc = chunk.size == 8 ? t : t.r32();
+      uint32_t instId = X86MemInline_movId(mi, chunk.size, true, false);
+
+      ASMJIT_PROPAGATE(self->emit(instId, dc, X86MemInline_ptr(a, chunk)));
+      ASMJIT_PROPAGATE(self->emit(instId, tc, X86MemInline_ptr(b, chunk)));
+      ASMJIT_PROPAGATE(self->mov(offset.r32(), chunk.offset));
+      ASMJIT_PROPAGATE(self->xor_(dc, tc));
+    }
+
+    ASMJIT_PROPAGATE(self->jnz(L_Diff));
+  }
+
+  ASMJIT_PROPAGATE(self->xor_(result.r32(), result.r32()));
+  ASMJIT_PROPAGATE(self->jmp(L_Done));
+
+  // The result is the difference of the first differing bytes.
+  ASMJIT_PROPAGATE(self->bind(L_Diff));
+  ASMJIT_PROPAGATE(self->bsf(d, d));
+  if (!isVec)
+    ASMJIT_PROPAGATE(self->shr(d, 3));
+  ASMJIT_PROPAGATE(self->add(d, offset));
+  ASMJIT_PROPAGATE(self->movzx(result.r32(), x86::byte_ptr(a, d)));
+  ASMJIT_PROPAGATE(self->movzx(t.r32(), x86::byte_ptr(b, d)));
+  ASMJIT_PROPAGATE(self->sub(result.r32(), t.r32()));
+
+  return self->bind(L_Done);
+}
+
+Error X86Compiler::inlineMemcpy(const X86Gp& dst, const X86Gp& src, size_t size, uint32_t alignment) {
+  if (ASMJIT_UNLIKELY(_lastError))
+    return _lastError;
+
+  if (ASMJIT_UNLIKELY(!getFunc()))
+    return setLastError(DebugUtils::errored(kErrorInvalidState));
+
+  if (ASMJIT_UNLIKELY(!Utils::isPowerOf2(alignment)))
+    return setLastError(DebugUtils::errored(kErrorInvalidArgument));
+
+  if (size == 0)
+    return kErrorOk;
+
+  X86MemInline mi;
+  X86MemInline_init(this, mi, false);
+
+  Error err;
+  Imm sizeImm(static_cast<int64_t>(size));
+
+  if (size <= X86MemInline_kMaxSize) {
+    err = X86MemInline_copy(this, mi, dst, src, static_cast<uint32_t>(size), alignment);
+  }
+  else if (mi.erms) {
+    err = X86MemInline_rep(this, dst, src, sizeImm, false);
+  }
+  else {
+    Operand args[3] = { dst, src, sizeImm };
+    err = X86MemInline_call(this, imm_ptr(::memcpy), FuncSignature3<void*, void*, const void*, size_t>(CallConv::kIdHost), args, nullptr);
+  }
+
+  if (ASMJIT_UNLIKELY(err))
+    return setLastError(err);
+  return kErrorOk;
+}
+
+Error X86Compiler::inlineMemcpy(const X86Gp& dst, const X86Gp& src, const X86Gp& size) {
+  if (ASMJIT_UNLIKELY(_lastError))
+    return _lastError;
+
+  if (ASMJIT_UNLIKELY(!getFunc()))
+    return setLastError(DebugUtils::errored(kErrorInvalidState));
+
+  X86MemInline mi;
+  X86MemInline_init(this, mi, false);
+
+  Error err;
+  if (mi.fsrm) {
+    err = X86MemInline_rep(this, dst, src, size, false);
+  }
+  else {
+    Operand args[3] = { dst, src, size };
+    err = X86MemInline_call(this, imm_ptr(::memcpy), FuncSignature3<void*, void*, const void*, size_t>(CallConv::kIdHost), args, nullptr);
+  }
+
+  if (ASMJIT_UNLIKELY(err))
+    return setLastError(err);
+  return kErrorOk;
+}
+
+Error X86Compiler::inlineMemset(const X86Gp& dst, uint32_t value, size_t size, uint32_t alignment) {
+  if (ASMJIT_UNLIKELY(_lastError))
+    return _lastError;
+
+  if (ASMJIT_UNLIKELY(!getFunc()))
+    return setLastError(DebugUtils::errored(kErrorInvalidState));
+
+  if (ASMJIT_UNLIKELY(!Utils::isPowerOf2(alignment)))
+    return setLastError(DebugUtils::errored(kErrorInvalidArgument));
+
+  if (size == 0)
+    return kErrorOk;
+
+  X86MemInline mi;
+  X86MemInline_init(this, mi, false);
+
+  Error err;
+  Imm valueImm(static_cast<int32_t>(value & 0xFFU));
+  Imm sizeImm(static_cast<int64_t>(size));
+
+  if (size <= X86MemInline_kMaxSize) {
+    err = X86MemInline_fill(this, mi, dst, value, static_cast<uint32_t>(size), alignment);
+  }
+  else if (mi.erms) {
+    err = X86MemInline_rep(this, dst, valueImm, sizeImm, true);
+  }
+  else {
+    Operand args[3] = { dst, valueImm, sizeImm };
+    err = X86MemInline_call(this, imm_ptr(::memset), FuncSignature3<void*, void*, int, size_t>(CallConv::kIdHost), args, nullptr);
+  }
+
+  if (ASMJIT_UNLIKELY(err))
+    return setLastError(err);
+  return kErrorOk;
+}
+
+Error X86Compiler::inlineMemset(const X86Gp& dst, const X86Gp& value, const X86Gp& size) {
+  if (ASMJIT_UNLIKELY(_lastError))
+    return _lastError;
+
+  if (ASMJIT_UNLIKELY(!getFunc()))
+    return setLastError(DebugUtils::errored(kErrorInvalidState));
+
+  X86MemInline mi;
+  X86MemInline_init(this, mi, false);
+
+  Error err;
+  if (mi.fsrm) {
+    err = X86MemInline_rep(this, dst, value.r32(), size, true);
+  }
+  else {
+    Operand args[3] = { dst, value.r32(), size };
+    err = X86MemInline_call(this, imm_ptr(::memset), FuncSignature3<void*, void*, int, size_t>(CallConv::kIdHost), args, nullptr);
+  }
+
+  if (ASMJIT_UNLIKELY(err))
+    return setLastError(err);
+  return kErrorOk;
+}
+
+Error X86Compiler::inlineMemcmp(const X86Gp& result, const X86Gp& a, const X86Gp& b, size_t size) {
+  if (ASMJIT_UNLIKELY(_lastError))
+    return _lastError;
+
+  if (ASMJIT_UNLIKELY(!getFunc()))
+    return setLastError(DebugUtils::errored(kErrorInvalidState));
+
+  X86MemInline mi;
+  X86MemInline_init(this, mi, true);
+
+  Error err;
+  if (size == 0) {
+    err = xor_(result.r32(), result.r32());
+  }
+  else if (size <= X86MemInline_kMaxSize) {
+    err = X86MemInline_compare(this, mi, result, a, b, static_cast<uint32_t>(size));
+  }
+  else {
+    X86Gp ret = result.r32();
+    Operand args[3] = { a, b, Imm(static_cast<int64_t>(size)) };
+    err = X86MemInline_call(this, imm_ptr(::memcmp), FuncSignature3<int, const void*, const void*, size_t>(CallConv::kIdHost), args, &ret);
+  }
+
+  if (ASMJIT_UNLIKELY(err))
+    return setLastError(err);
+  return kErrorOk;
+}
+
+Error X86Compiler::inlineMemcmp(const X86Gp& result, const X86Gp& a, const X86Gp& b, const X86Gp& size) {
+  if (ASMJIT_UNLIKELY(_lastError))
+    return _lastError;
+
+  if (ASMJIT_UNLIKELY(!getFunc()))
+    return setLastError(DebugUtils::errored(kErrorInvalidState));
+
+  // `repe cmpsb` is slower than the C library at all sizes.
+  X86Gp ret = result.r32();
+  Operand args[3] = { a, b, size };
+
+  Error err = X86MemInline_call(this, imm_ptr(::memcmp), FuncSignature3<int, const void*, const void*, size_t>(CallConv::kIdHost), args, &ret);
+  if (ASMJIT_UNLIKELY(err))
+    return setLastError(err);
+  return kErrorOk;
+}
+
+// ============================================================================
+// [asmjit::X86Compiler - Test]
+// ============================================================================
+
+#if defined(ASMJIT_TEST) && (ASMJIT_ARCH_X86 || ASMJIT_ARCH_X64)
+// Generate `int func(int x)` that returns `x * k + (0 + 1 + ... + k)`.
+static void X86Compiler_generateTestFunc(X86Compiler& cc, int k) noexcept {
+  cc.addFunc(FuncSignature1<int, int>(CallConv::kIdHost));
+
+  X86Gp x = cc.newInt32("x");
+  X86Gp acc = cc.newInt32("acc");
+  X86Gp i = cc.newInt32("i");
+  Label L_Loop = cc.newLabel();
+  Label L_Done = cc.newLabel();
+
+  cc.setArg(0, x);
+  cc.imul(acc, x, k);
+  cc.xor_(i, i);
+
+  cc.bind(L_Loop);
+  cc.cmp(i, k);
+  cc.jg(L_Done);
+  cc.add(acc, i);
+  cc.inc(i);
+  cc.jmp(L_Loop);
+
+  cc.bind(L_Done);
+  cc.ret(acc);
+  cc.endFunc();
+}
+
+UNIT(x86_compiler_finalize_all) {
+  enum { kCount = 24 };
+
+  JitRuntime rt;
+  CodeHolder serialCode[kCount];
+  CodeHolder parallelCode[kCount];
+  X86Compiler serialCc[kCount];
+  X86Compiler parallelCc[kCount];
+  CodeCompiler* compilers[kCount];
+
+  for (int k = 0; k < kCount; k++) {
+    serialCode[k].init(rt.getCodeInfo());
+    serialCode[k].attach(&serialCc[k]);
+    X86Compiler_generateTestFunc(serialCc[k], k);
+
+    parallelCode[k].init(rt.getCodeInfo());
+    parallelCode[k].attach(&parallelCc[k]);
+    X86Compiler_generateTestFunc(parallelCc[k], k);
+    compilers[k] = &parallelCc[k];
+  }
+
+  INFO("Checking that parallel finalization generates the same code");
+  for (int k = 0; k < kCount; k++)
+    EXPECT(serialCc[k].finalize() == kErrorOk);
+  EXPECT(CodeCompiler::finalizeAll(compilers, kCount, 4) == kErrorOk);
+
+  for (int k = 0; k < kCount; k++) {
+    const CodeBuffer& a = serialCode[k].getSectionEntry(0)->getBuffer();
+    const CodeBuffer& b = parallelCode[k].getSectionEntry(0)->getBuffer();
+    EXPECT(a.getLength() == b.getLength() && ::memcmp(a.getData(), b.getData(), a.getLength()) == 0,
+      "Function #%d differs", k);
+  }
+
+  INFO("Checking the generated functions");
+  typedef int (*Func)(int);
+  CodeHolder* codes[kCount];
+  void* funcs[kCount];
+
+  for (int k = 0; k < kCount; k++)
+    codes[k] = &parallelCode[k];
+  EXPECT(rt.addBatch(funcs, codes, kCount) == kErrorOk);
+
+  for (int k = 0; k < kCount; k++) {
+    int result = ptr_as_func<Func>(funcs[k])(3);
+    int expected = 3 * k + k * (k + 1) / 2;
+    EXPECT(result == expected, "Function #%d returned %d, expected %d", k, result, expected);
+  }
+  rt.release(funcs[0]);
+
+  INFO("Checking that the error of the first failed compiler is returned");
+  {
+    CodeHolder code;
+    code.init(rt.getCodeInfo());
+
+    X86Compiler cc(&code);
+    X86Compiler detached;
+    X86Compiler_generateTestFunc(cc, 1);
+
+    // `serialCc[0]` is already finalized, so it fails as well.
+    CodeCompiler* list[3] = { &cc, &detached, &serialCc[0] };
+    Error err = CodeCompiler::finalizeAll(list, 3, 2);
+    EXPECT(err != kErrorOk && err == detached.getLastError());
+    EXPECT(CodeCompiler::finalizeAll(nullptr, 0) == kErrorOk);
+  }
+}
+#endif // ASMJIT_TEST && (ASMJIT_ARCH_X86 || ASMJIT_ARCH_X64)
+
 } // asmjit namespace
 
 // [Api-End]
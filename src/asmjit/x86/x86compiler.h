@@ -80,6 +80,10 @@ public:
 
   ASMJIT_API virtual Error finalize() override;
 
+  //! Serialize all nodes to `dst`, uses a specialized serializer if `dst` is
+  //! an `X86Assembler`.
+  ASMJIT_API virtual Error serialize(CodeEmitter* dst) override;
+
   // --------------------------------------------------------------------------
   // [VirtReg]
   // --------------------------------------------------------------------------
@@ -269,6 +273,73 @@ public:
   //! \overload
   ASMJIT_INLINE CCFuncCall* call(uint64_t dst, const FuncSignature& sign) { return addCall(X86Inst::kIdCall, Imm(dst), sign); }
 
+  //! Inline `func`, which was built by this compiler, at the current position.
+  //!
+  //! The body of `func` is copied with new virtual registers and labels,
+  //! `args` are moved to copies of its arguments and values returned by its
+  //! `ret()` are moved to `rets`. There is no call, registers are allocated
+  //! over the result as a whole. `func` stays in the node list and is still
+  //! compiled, remove it by `removeNodes(func, func->getEnd())` if it's not
+  //! needed. Nested function calls are copied, other function nodes (const
+  //! pools) are not supported.
+  ASMJIT_API Error inlineFunc(CCFunc* func, const Operand_* args, uint32_t argCount, const Operand_* rets = nullptr, uint32_t retCount = 0);
+
+  //! Jump to `targets[i]` if `index` equals `keys[i]`, or to `defaultTarget`
+  //! if it equals none of the `count` keys.
+  //!
+  //! `index` is compared as a signed 32-bit integer and the keys must be
+  //! unique. Dense keys are lowered to a bounds check and an indirect jump
+  //! through a \ref CBJumpTable, which is placed into \ref getConstSection()
+  //! or after the function if there is no such section. Sparse keys are
+  //! lowered to a binary search by `cmp` and `jcc`. Registers are allocated
+  //! consistently for all targets in both cases. A function that contains a
+  //! jump table can't be inlined by \ref inlineFunc().
+  ASMJIT_API Error switch_(const X86Gp& index, const int32_t* keys, const Label* targets, uint32_t count, const Label& defaultTarget);
+
+  //! Copy `size` bytes from `[src]` to `[dst]`, the memory must not overlap.
+  //!
+  //! Sizes up to 256 bytes are copied by unrolled loads and stores of the
+  //! widest registers that fit, the last one overlaps the previous one if the
+  //! size is not a multiple of it. Vectors are used if the target has SSE2
+  //! (AVX for 32-byte chunks), with aligned moves if both pointers are aligned
+  //! to `alignment`. Larger sizes are copied by `rep movsb` if the target has
+  //! ERMS, or by a call of `::memcpy()`.
+  //!
+  //! Features of the target are \ref CodeInfo::getFeatures(), or features of
+  //! the host CPU if the code is not restricted to a CPU model. Calls of the C
+  //! library are only valid in code that runs in this process.
+  ASMJIT_API Error inlineMemcpy(const X86Gp& dst, const X86Gp& src, size_t size, uint32_t alignment = 1);
+  //! Copy `size` bytes, not known at compile time, from `[src]` to `[dst]` by
+  //! `rep movsb` if the target has FSRM, or by a call of `::memcpy()`.
+  ASMJIT_API Error inlineMemcpy(const X86Gp& dst, const X86Gp& src, const X86Gp& size);
+
+  //! Fill `size` bytes at `[dst]` by the low byte of `value`, expanded like
+  //! \ref inlineMemcpy() with `rep stosb` or `::memset()` for large sizes.
+  ASMJIT_API Error inlineMemset(const X86Gp& dst, uint32_t value, size_t size, uint32_t alignment = 1);
+  //! Fill `size` bytes at `[dst]` by the low byte of `value`, neither known at
+  //! compile time, by `rep stosb` if the target has FSRM, or by `::memset()`.
+  ASMJIT_API Error inlineMemset(const X86Gp& dst, const X86Gp& value, const X86Gp& size);
+
+  //! Compare `size` bytes at `[a]` and `[b]` and store a negative value, zero,
+  //! or a positive value to `result` like `::memcmp()`.
+  //!
+  //! Sizes up to 256 bytes are compared by unrolled loads like \ref
+  //! inlineMemcpy() (32-byte chunks require AVX2) that exit at the first chunk
+  //! that differs, the result is the difference of its first differing bytes.
+  //! Larger sizes call `::memcmp()`.
+  ASMJIT_API Error inlineMemcmp(const X86Gp& result, const X86Gp& a, const X86Gp& b, size_t size);
+  //! Compare `size` bytes, not known at compile time, by a call of `::memcmp()`.
+  ASMJIT_API Error inlineMemcmp(const X86Gp& result, const X86Gp& a, const X86Gp& b, const X86Gp& size);
+
+  //! Tail call a function (release the function frame and jump), see \ref addTailCall().
+  ASMJIT_INLINE CCFuncCall* tailCall(const X86Gp& dst, const FuncSignature& sign) { return addTailCall(X86Inst::kIdJmp, dst, sign); }
+  //! \overload
+  ASMJIT_INLINE CCFuncCall* tailCall(const Label& label, const FuncSignature& sign) { return addTailCall(X86Inst::kIdJmp, label, sign); }
+  //! \overload
+  ASMJIT_INLINE CCFuncCall* tailCall(const Imm& dst, const FuncSignature& sign) { return addTailCall(X86Inst::kIdJmp, dst, sign); }
+  //! \overload
+  ASMJIT_INLINE CCFuncCall* tailCall(uint64_t dst, const FuncSignature& sign) { return addTailCall(X86Inst::kIdJmp, Imm(dst), sign); }
+
   //! Return.
   ASMJIT_INLINE CCFuncRet* ret() { return addRet(Operand(), Operand()); }
   //! \overload
@@ -279,6 +350,12 @@ public:
   ASMJIT_INLINE CCFuncRet* ret(const X86Xmm& o0) { return addRet(o0, Operand()); }
   //! \overload
   ASMJIT_INLINE CCFuncRet* ret(const X86Xmm& o0, const X86Xmm& o1) { return addRet(o0, o1); }
+
+  // --------------------------------------------------------------------------
+  // [Members]
+  // --------------------------------------------------------------------------
+
+  X86Inst::ValidationCache _validationCache; //!< Signatures that passed strict validation.
 };
 
 //! \}
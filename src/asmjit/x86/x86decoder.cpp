@@ -0,0 +1,1668 @@
+// [AsmJit]
+// Complete x86/x64 JIT and Remote Assembler for C++.
+//
+// [License]
+// Zlib - See LICENSE.md file in the package.
+
+// [Export]
+#define ASMJIT_EXPORTS
+
+// [Guard]
+#include "../asmjit_build.h"
+#if defined(ASMJIT_BUILD_X86)
+
+// [Dependencies]
+#include "../base/misc_p.h"
+#include "../base/utils.h"
+#include "../x86/x86decoder.h"
+#include "../x86/x86inst.h"
+
+// [Api-Begin]
+#include "../asmjit_apibegin.h"
+
+namespace asmjit {
+
+// ============================================================================
+// [asmjit::X86Decoder - Opcode Tables]
+// ============================================================================
+
+//! \internal
+//!
+//! Opcode flags used by the length decoder.
+ASMJIT_ENUM(X86DecoderOpFlags) {
+  kX86DecoderImmNone    = 0x00,          //!< No immediate.
+  kX86DecoderImm8       = 0x01,          //!< 8-bit immediate.
+  kX86DecoderImm16      = 0x02,          //!< 16-bit immediate.
+  kX86DecoderImm32      = 0x03,          //!< 32-bit immediate.
+  kX86DecoderImmZ       = 0x04,          //!< 16-bit or 32-bit immediate (by operand size).
+  kX86DecoderImmV       = 0x05,          //!< 16-bit, 32-bit, or 64-bit immediate (by operand size).
+  kX86DecoderImmEnter   = 0x06,          //!< 16-bit and 8-bit immediate (ENTER).
+  kX86DecoderImmFar     = 0x07,          //!< Far pointer (selector and 16-bit or 32-bit offset).
+  kX86DecoderImmGrp3b   = 0x08,          //!< 8-bit immediate only if ModR/M.reg is TEST (F6).
+  kX86DecoderImmGrp3z   = 0x09,          //!< Z immediate only if ModR/M.reg is TEST (F7).
+  kX86DecoderImmMoffs   = 0x0A,          //!< Memory offset (by address size).
+  kX86DecoderImmRel8    = 0x0B,          //!< 8-bit relative displacement.
+  kX86DecoderImmRelZ    = 0x0C,          //!< 16-bit or 32-bit relative displacement.
+  kX86DecoderImmMask    = 0x0F,          //!< Mask of all immediate kinds.
+
+  kX86DecoderModRM      = 0x10,          //!< Opcode is followed by ModR/M byte.
+  kX86DecoderPrefix     = 0x20,          //!< Legacy prefix (not an opcode).
+  kX86DecoderEscape     = 0x40           //!< Escape to another opcode map.
+};
+
+//! \internal
+//!
+//! Opcode maps, also used as a part of the index key.
+ASMJIT_ENUM(X86DecoderMap) {
+  kX86DecoderMap00      = 0,             //!< One-byte opcodes.
+  kX86DecoderMap0F      = 1,             //!< 0F opcodes (also VEX|EVEX.mm=1).
+  kX86DecoderMap0F38    = 2,             //!< 0F38 opcodes (also VEX|EVEX.mm=2).
+  kX86DecoderMap0F3A    = 3,             //!< 0F3A opcodes (also VEX|EVEX.mm=3).
+  kX86DecoderMap0F01    = 4,             //!< 0F01 opcodes indexed by ModR/M (AsmJit specific).
+  kX86DecoderMapXop8    = 5,             //!< XOP.M8 opcodes.
+  kX86DecoderMapXop9    = 6,             //!< XOP.M9 opcodes.
+  kX86DecoderMapXopA    = 7,             //!< XOP.MA opcodes.
+  kX86DecoderMapCount   = 8              //!< Count of opcode maps.
+};
+
+//! \internal
+ASMJIT_ENUM(X86DecoderEncoding) {
+  kX86DecoderLegacy     = 0,             //!< Legacy encoding (optional REX).
+  kX86DecoderVex2       = 1,             //!< 2-byte VEX prefix (C5).
+  kX86DecoderVex3       = 2,             //!< 3-byte VEX prefix (C4).
+  kX86DecoderXop        = 3,             //!< XOP prefix (8F).
+  kX86DecoderEvex       = 4              //!< EVEX prefix (62).
+};
+
+//! \internal
+ASMJIT_ENUM(X86DecoderPrefixFlags) {
+  kX86DecoderPrefix66   = 0x01,          //!< Operand-size override.
+  kX86DecoderPrefix67   = 0x02,          //!< Address-size override.
+  kX86DecoderPrefixLock = 0x04           //!< LOCK prefix.
+};
+
+//! \internal
+//!
+//! Places in the instruction encoding that can provide an operand.
+ASMJIT_ENUM(X86DecoderSlot) {
+  kX86DecoderSlotR      = 0x0001,        //!< ModR/M.reg.
+  kX86DecoderSlotM      = 0x0002,        //!< ModR/M.rm (register or memory).
+  kX86DecoderSlotV      = 0x0004,        //!< VEX|EVEX.vvvv.
+  kX86DecoderSlotO      = 0x0008,        //!< Register encoded in opcode.
+  kX86DecoderSlotIs4    = 0x0010,        //!< Register encoded in imm8[7:4].
+  kX86DecoderSlotI      = 0x0020,        //!< Immediate.
+  kX86DecoderSlotI2     = 0x0040,        //!< Second immediate (ENTER, EXTRQ, INSERTQ).
+  kX86DecoderSlotRel    = 0x0080,        //!< Relative displacement.
+  kX86DecoderSlotMoffs  = 0x0100         //!< Memory offset.
+};
+
+//! \internal
+//!
+//! Special values of `X86DecoderState::memBase` and `memIndex`.
+ASMJIT_ENUM(X86DecoderMemReg) {
+  kX86DecoderMemRip     = 0xFE,          //!< RIP (base only).
+  kX86DecoderMemNone    = 0xFF           //!< No register.
+};
+
+template<uint32_t C>
+struct X86DecoderMap00_T {
+  enum {
+    kIsPrefix = C == 0x26 || C == 0x2E || C == 0x36 || C == 0x3E ||
+                (C >= 0x64 && C <= 0x67) || C == 0xF0 || C == 0xF2 || C == 0xF3,
+    kIsAlu    = C < 0x40 && (C & 0x07) < 0x06,
+
+    kValue = kIsPrefix                                     ? kX86DecoderPrefix                        :
+             C == 0x0F                                     ? kX86DecoderEscape                        :
+             kIsAlu && (C & 0x07) <  0x04                  ? kX86DecoderModRM                         :
+             kIsAlu && (C & 0x07) == 0x04                  ? kX86DecoderImm8                          :
+             kIsAlu && (C & 0x07) == 0x05                  ? kX86DecoderImmZ                          :
+             C == 0x62 || C == 0x63                        ? kX86DecoderModRM                         :
+             C == 0x68                                     ? kX86DecoderImmZ                          :
+             C == 0x69                                     ? kX86DecoderModRM | kX86DecoderImmZ       :
+             C == 0x6A                                     ? kX86DecoderImm8                          :
+             C == 0x6B                                     ? kX86DecoderModRM | kX86DecoderImm8       :
+             C >= 0x70 && C <= 0x7F                        ? kX86DecoderImmRel8                       :
+             C == 0x80 || C == 0x82 || C == 0x83           ? kX86DecoderModRM | kX86DecoderImm8       :
+             C == 0x81                                     ? kX86DecoderModRM | kX86DecoderImmZ       :
+             C >= 0x84 && C <= 0x8F                        ? kX86DecoderModRM                         :
+             C == 0x9A || C == 0xEA                        ? kX86DecoderImmFar                        :
+             C >= 0xA0 && C <= 0xA3                        ? kX86DecoderImmMoffs                      :
+             C == 0xA8                                     ? kX86DecoderImm8                          :
+             C == 0xA9                                     ? kX86DecoderImmZ                          :
+             C >= 0xB0 && C <= 0xB7                        ? kX86DecoderImm8                          :
+             C >= 0xB8 && C <= 0xBF                        ? kX86DecoderImmV                          :
+             C == 0xC0 || C == 0xC1 || C == 0xC6           ? kX86DecoderModRM | kX86DecoderImm8       :
+             C == 0xC2 || C == 0xCA                        ? kX86DecoderImm16                         :
+             C == 0xC4 || C == 0xC5                        ? kX86DecoderModRM                         :
+             C == 0xC7                                     ? kX86DecoderModRM | kX86DecoderImmZ       :
+             C == 0xC8                                     ? kX86DecoderImmEnter                      :
+             C == 0xCD || C == 0xD4 || C == 0xD5           ? kX86DecoderImm8                          :
+             C >= 0xE4 && C <= 0xE7                        ? kX86DecoderImm8                          :
+             C >= 0xD0 && C <= 0xD3                        ? kX86DecoderModRM                         :
+             C >= 0xD8 && C <= 0xDF                        ? kX86DecoderModRM                         :
+             (C >= 0xE0 && C <= 0xE3) || C == 0xEB         ? kX86DecoderImmRel8                       :
+             C == 0xE8 || C == 0xE9                        ? kX86DecoderImmRelZ                       :
+             C == 0xF6                                     ? kX86DecoderModRM | kX86DecoderImmGrp3b   :
+             C == 0xF7                                     ? kX86DecoderModRM | kX86DecoderImmGrp3z   :
+             C == 0xFE || C == 0xFF                        ? kX86DecoderModRM                         : 0
+  };
+};
+
+template<uint32_t C>
+struct X86DecoderMap0F_T {
+  enum {
+    kNoModRM = (C >= 0x04 && C <= 0x0C) || C == 0x0E || (C >= 0x30 && C <= 0x37) || C == 0x77 ||
+               (C >= 0xA0 && C <= 0xA2) || (C >= 0xA8 && C <= 0xAA) || (C >= 0xC8 && C <= 0xCF),
+    kHasImm8 = C == 0x0F || (C >= 0x70 && C <= 0x73) || C == 0xA4 || C == 0xAC || C == 0xBA ||
+               C == 0xC2 || (C >= 0xC4 && C <= 0xC6),
+
+    kValue = C == 0x38 || C == 0x3A                        ? kX86DecoderEscape                        :
+             C >= 0x80 && C <= 0x8F                        ? kX86DecoderImmRelZ                       :
+             kNoModRM                                      ? 0                                        :
+             kHasImm8                                      ? kX86DecoderModRM | kX86DecoderImm8       : kX86DecoderModRM
+  };
+};
+
+static const uint8_t x86DecoderMap00[256] = {
+  ASMJIT_TABLE_T_256(X86DecoderMap00_T, kValue, 0)
+};
+
+static const uint8_t x86DecoderMap0F[256] = {
+  ASMJIT_TABLE_T_256(X86DecoderMap0F_T, kValue, 0)
+};
+
+//! \internal
+//!
+//! Get opcode flags of a VEX, XOP, or EVEX encoded instruction.
+static ASMJIT_INLINE uint32_t X86Decoder_getVexFlags(uint32_t map, uint32_t op) noexcept {
+  switch (map) {
+    case kX86DecoderMap0F:
+      if (op == 0x77)
+        return 0;
+      if ((op >= 0x70 && op <= 0x73) || op == 0xC2 || (op >= 0xC4 && op <= 0xC6))
+        return kX86DecoderModRM | kX86DecoderImm8;
+      return kX86DecoderModRM;
+
+    case kX86DecoderMap0F38:
+    case kX86DecoderMapXop9:
+      return kX86DecoderModRM;
+
+    case kX86DecoderMapXopA:
+      return kX86DecoderModRM | kX86DecoderImm32;
+
+    default:
+      return kX86DecoderModRM | kX86DecoderImm8;
+  }
+}
+
+// ============================================================================
+// [asmjit::X86Decoder - State]
+// ============================================================================
+
+//! \internal
+//!
+//! Instruction split into its fields by `X86Decoder_parse()`.
+struct X86DecoderState {
+  const uint8_t* data;                   //!< Instruction data.
+  uint32_t size;                         //!< Instruction size.
+  uint32_t is64;                         //!< Decoding 64-bit code.
+  uint32_t encoding;                     //!< Encoding, see \ref X86DecoderEncoding.
+  uint32_t map;                          //!< Opcode map, see \ref X86DecoderMap.
+  uint32_t opCode;                       //!< Opcode byte.
+  uint32_t prefixes;                     //!< Legacy prefixes, see \ref X86DecoderPrefixFlags.
+  uint32_t rep;                          //!< The last REP prefix (F2 or F3) or zero.
+  uint32_t segment;                      //!< Segment override (segment register id) or zero.
+  uint32_t rex;                          //!< REX prefix or zero.
+  uint32_t slots;                        //!< Operand slots, see \ref X86DecoderSlot.
+
+  uint32_t w;                            //!< REX|VEX|EVEX.W.
+  uint32_t r;                            //!< REX|VEX|EVEX.R (not inverted).
+  uint32_t x;                            //!< REX|VEX|EVEX.X (not inverted).
+  uint32_t b;                            //!< REX|VEX|EVEX.B (not inverted).
+  uint32_t rHi;                          //!< EVEX.R' (not inverted).
+  uint32_t vHi;                          //!< EVEX.V' (not inverted).
+  uint32_t vvvv;                         //!< VEX|EVEX.vvvv (not inverted).
+  uint32_t ll;                           //!< VEX.L|EVEX.L'L.
+  uint32_t z;                            //!< EVEX.z.
+  uint32_t bcst;                         //!< EVEX.b.
+  uint32_t aaa;                          //!< EVEX.aaa.
+
+  uint32_t modRM;                        //!< ModR/M byte.
+  uint32_t mod;                          //!< ModR/M.mod.
+  uint32_t reg;                          //!< ModR/M.reg (extended by R and R').
+  uint32_t rm;                           //!< ModR/M.rm (extended by B and X), register form only.
+  uint32_t addrSize;                     //!< Address size in bytes.
+  uint32_t hasSib;                       //!< SIB byte is present.
+  uint32_t sibIndex;                     //!< SIB.index (extended by X), used by VSIB.
+  uint32_t memBase;                      //!< Memory base, see \ref X86DecoderMemReg.
+  uint32_t memIndex;                     //!< Memory index, see \ref X86DecoderMemReg.
+  uint32_t memShift;                     //!< Memory index shift.
+  int32_t disp;                          //!< Displacement (sign extended).
+  uint32_t dispSize;                     //!< Displacement size.
+
+  uint64_t imm;                          //!< Immediate (zero extended).
+  uint32_t immSize;                      //!< Immediate size.
+  uint32_t imm2;                         //!< Second immediate.
+  int32_t rel;                           //!< Relative displacement (sign extended).
+  uint64_t moffs;                        //!< Memory offset.
+};
+
+static ASMJIT_INLINE uint64_t X86Decoder_readU(const uint8_t* p, uint32_t size) noexcept {
+  uint64_t value = 0;
+  for (uint32_t i = 0; i < size; i++)
+    value |= static_cast<uint64_t>(p[i]) << (i * 8);
+  return value;
+}
+
+static ASMJIT_INLINE int64_t X86Decoder_signExtend(uint64_t value, uint32_t size) noexcept {
+  uint32_t shift = 64 - size * 8;
+  return static_cast<int64_t>(value << shift) >> shift;
+}
+
+//! \internal
+//!
+//! Split the instruction at `data` into `X86DecoderState`, returns its size
+//! or zero if the instruction is truncated or invalid.
+static uint32_t X86Decoder_parse(X86DecoderState& s, uint32_t archType, const uint8_t* data, size_t size) noexcept {
+  ::memset(&s, 0, sizeof(X86DecoderState));
+
+  const uint32_t is64 = archType == ArchInfo::kTypeX64;
+  const uint8_t* p = data;
+  const uint8_t* end = data + (size < 15 ? size : size_t(15));
+
+  s.data = data;
+  s.is64 = is64;
+
+  // Legacy prefixes and REX.
+  uint32_t c;
+  for (;;) {
+    if (ASMJIT_UNLIKELY(p == end)) return 0;
+    c = *p;
+
+    if (x86DecoderMap00[c] & kX86DecoderPrefix) {
+      switch (c) {
+        case 0x26: s.segment = X86Seg::kIdEs; break;
+        case 0x2E: s.segment = X86Seg::kIdCs; break;
+        case 0x36: s.segment = X86Seg::kIdSs; break;
+        case 0x3E: s.segment = X86Seg::kIdDs; break;
+        case 0x64: s.segment = X86Seg::kIdFs; break;
+        case 0x65: s.segment = X86Seg::kIdGs; break;
+        case 0x66: s.prefixes |= kX86DecoderPrefix66; break;
+        case 0x67: s.prefixes |= kX86DecoderPrefix67; break;
+        case 0xF0: s.prefixes |= kX86DecoderPrefixLock; break;
+        default  : s.rep = c; break;
+      }
+
+      // REX is only valid if it immediately precedes the opcode.
+      s.rex = 0;
+      p++;
+      continue;
+    }
+
+    // FWAIT followed by a FPU instruction is encoded as a single instruction
+    // by AsmJit (like FSTSW, which is FWAIT + FNSTSW), REX can follow FWAIT.
+    if (c == 0x9B) {
+      const uint8_t* q = p + 1;
+      if (is64 && q != end && (q[0] & 0xF0) == 0x40) q++;
+
+      if (q != end && (q[0] == 0xD9 || q[0] == 0xDB || q[0] == 0xDD || q[0] == 0xDF)) {
+        s.rex = 0;
+        p++;
+        continue;
+      }
+    }
+
+    if (is64 && (c & 0xF0) == 0x40) {
+      s.rex = c;
+      p++;
+      continue;
+    }
+    break;
+  }
+
+  if (s.rex) {
+    s.w = (s.rex >> 3) & 1;
+    s.r = (s.rex >> 2) & 1;
+    s.x = (s.rex >> 1) & 1;
+    s.b = (s.rex     ) & 1;
+  }
+
+  // Opcode.
+  uint32_t flags;
+  c = *p++;
+
+  bool isVex = false;
+  if ((c == 0xC4 || c == 0xC5 || c == 0x62) && p != end)
+    isVex = is64 || (p[0] & 0xC0) == 0xC0;
+  else if (c == 0x8F && p != end)
+    isVex = (p[0] & 0x1F) >= 8;
+
+  if (isVex) {
+    uint32_t pSize = c == 0xC5 ? 1 : c == 0x62 ? 3 : 2;
+    if (ASMJIT_UNLIKELY((size_t)(end - p) <= pSize)) return 0;
+
+    uint32_t b1 = p[0];
+    if (c == 0xC5) {
+      s.encoding = kX86DecoderVex2;
+      s.map = kX86DecoderMap0F;
+      s.r = ((b1 >> 7) & 1) ^ 1;
+      s.vvvv = ((b1 >> 3) & 0xF) ^ 0xF;
+      s.ll = (b1 >> 2) & 1;
+    }
+    else {
+      uint32_t b2 = p[1];
+      uint32_t mm = b1 & 0x1F;
+
+      s.r = ((b1 >> 7) & 1) ^ 1;
+      s.x = ((b1 >> 6) & 1) ^ 1;
+      s.b = ((b1 >> 5) & 1) ^ 1;
+      s.w = (b2 >> 7) & 1;
+      s.vvvv = ((b2 >> 3) & 0xF) ^ 0xF;
+
+      if (c == 0x62) {
+        uint32_t b3 = p[2];
+        mm = b1 & 0x0F;
+
+        s.encoding = kX86DecoderEvex;
+        s.rHi = ((b1 >> 4) & 1) ^ 1;
+        s.vHi = ((b3 >> 3) & 1) ^ 1;
+        s.ll = (b3 >> 5) & 3;
+        s.z = (b3 >> 7) & 1;
+        s.bcst = (b3 >> 4) & 1;
+        s.aaa = b3 & 7;
+
+        if (ASMJIT_UNLIKELY(mm < 1 || mm > 3 || (b2 & 0x04) == 0)) return 0;
+        s.map = mm;
+      }
+      else {
+        s.ll = (b2 >> 2) & 1;
+        if (c == 0xC4) {
+          if (ASMJIT_UNLIKELY(mm < 1 || mm > 3)) return 0;
+          s.encoding = kX86DecoderVex3;
+          s.map = mm;
+        }
+        else {
+          if (ASMJIT_UNLIKELY(mm < 8 || mm > 10)) return 0;
+          s.encoding = kX86DecoderXop;
+          s.map = kX86DecoderMapXop8 + (mm - 8);
+        }
+      }
+    }
+
+    // Only 8 registers are addressable in 32-bit mode.
+    if (!is64) {
+      s.r = s.x = s.b = 0;
+      s.rHi = s.vHi = 0;
+      s.vvvv &= 0x7;
+    }
+
+    p += pSize;
+    c = *p++;
+    flags = X86Decoder_getVexFlags(s.map, c);
+  }
+  else if (c == 0x0F) {
+    if (ASMJIT_UNLIKELY(p == end)) return 0;
+    c = *p++;
+
+    if (c == 0x38 || c == 0x3A) {
+      s.map = c == 0x38 ? kX86DecoderMap0F38 : kX86DecoderMap0F3A;
+      flags = c == 0x38 ? kX86DecoderModRM : kX86DecoderModRM | kX86DecoderImm8;
+
+      if (ASMJIT_UNLIKELY(p == end)) return 0;
+      c = *p++;
+    }
+    else {
+      s.map = kX86DecoderMap0F;
+      flags = x86DecoderMap0F[c];
+    }
+  }
+  else {
+    s.map = kX86DecoderMap00;
+    flags = x86DecoderMap00[c];
+  }
+  s.opCode = c;
+
+  // ModR/M, SIB, and displacement.
+  if (flags & kX86DecoderModRM) {
+    if (ASMJIT_UNLIKELY(p == end)) return 0;
+    uint32_t modRM = *p++;
+
+    s.slots |= kX86DecoderSlotR | kX86DecoderSlotM;
+    s.modRM = modRM;
+    s.mod = modRM >> 6;
+    s.reg = ((modRM >> 3) & 7) | (s.r << 3) | (s.rHi << 4);
+    s.memBase = kX86DecoderMemNone;
+    s.memIndex = kX86DecoderMemNone;
+
+    uint32_t rm = modRM & 7;
+    if (s.mod == 3) {
+      s.rm = rm | (s.b << 3) | (s.encoding == kX86DecoderEvex ? s.x << 4 : 0);
+    }
+    else if (!is64 && (s.prefixes & kX86DecoderPrefix67)) {
+      // 16-bit addressing.
+      static const uint8_t base16[8] = { 3, 3, 5, 5, 6, 7, 5, 3 };
+      static const uint8_t index16[8] = { 6, 7, 6, 7, kX86DecoderMemNone, kX86DecoderMemNone, kX86DecoderMemNone, kX86DecoderMemNone };
+
+      s.addrSize = 2;
+      if (s.mod == 0 && rm == 6) {
+        s.dispSize = 2;
+      }
+      else {
+        s.memBase = base16[rm];
+        s.memIndex = index16[rm];
+        s.dispSize = s.mod == 1 ? 1 : s.mod == 2 ? 2 : 0;
+      }
+    }
+    else {
+      s.addrSize = is64 ? ((s.prefixes & kX86DecoderPrefix67) ? 4 : 8) : 4;
+      s.dispSize = s.mod == 1 ? 1 : s.mod == 2 ? 4 : 0;
+
+      if (rm == 4) {
+        if (ASMJIT_UNLIKELY(p == end)) return 0;
+        uint32_t sib = *p++;
+        uint32_t base = sib & 7;
+
+        s.hasSib = 1;
+        s.sibIndex = ((sib >> 3) & 7) | (s.x << 3);
+        s.memShift = sib >> 6;
+
+        if (s.sibIndex != 4)
+          s.memIndex = s.sibIndex;
+
+        if (base == 5 && s.mod == 0)
+          s.dispSize = 4;
+        else
+          s.memBase = base | (s.b << 3);
+      }
+      else if (rm == 5 && s.mod == 0) {
+        s.dispSize = 4;
+        if (is64) s.memBase = kX86DecoderMemRip;
+      }
+      else {
+        s.memBase = rm | (s.b << 3);
+      }
+    }
+
+    if (s.dispSize) {
+      if (ASMJIT_UNLIKELY((size_t)(end - p) < s.dispSize)) return 0;
+      s.disp = static_cast<int32_t>(X86Decoder_signExtend(X86Decoder_readU(p, s.dispSize), s.dispSize));
+      p += s.dispSize;
+    }
+  }
+  else if (s.encoding == kX86DecoderLegacy) {
+    s.slots |= kX86DecoderSlotO;
+  }
+
+  if (s.encoding != kX86DecoderLegacy)
+    s.slots |= kX86DecoderSlotV;
+
+  // Immediate, relative displacement, or memory offset.
+  uint32_t opSize16 = (s.prefixes & kX86DecoderPrefix66) != 0 && s.encoding == kX86DecoderLegacy;
+  uint32_t immSize = 0;
+  uint32_t imm2Size = 0;
+  uint32_t relSize = 0;
+  uint32_t moffsSize = 0;
+  uint32_t skipSize = 0;
+
+  uint32_t immKind = flags & kX86DecoderImmMask;
+  if (s.map == kX86DecoderMap00 && s.opCode == 0xC7 && s.modRM == 0xF8)
+    immKind = kX86DecoderImmRelZ; // XBEGIN.
+
+  switch (immKind) {
+    case kX86DecoderImm8   : immSize = 1; break;
+    case kX86DecoderImm16  : immSize = 2; break;
+    case kX86DecoderImm32  : immSize = 4; break;
+    case kX86DecoderImmZ   : immSize = opSize16 ? 2 : 4; break;
+    case kX86DecoderImmV   : immSize = s.w ? 8 : opSize16 ? 2 : 4; break;
+    case kX86DecoderImmEnter: immSize = 2; imm2Size = 1; break;
+    case kX86DecoderImmGrp3b: immSize = ((s.modRM >> 3) & 7) < 2 ? 1 : 0; break;
+    case kX86DecoderImmGrp3z: immSize = ((s.modRM >> 3) & 7) < 2 ? (opSize16 ? 2 : 4) : 0; break;
+    case kX86DecoderImmRel8: relSize = 1; break;
+    case kX86DecoderImmRelZ: relSize = (!is64 && opSize16) ? 2 : 4; break;
+
+    case kX86DecoderImmFar:
+      if (ASMJIT_UNLIKELY(is64)) return 0;
+      skipSize = opSize16 ? 4 : 6;
+      break;
+
+    case kX86DecoderImmMoffs:
+      if (is64)
+        moffsSize = (s.prefixes & kX86DecoderPrefix67) ? 4 : 8;
+      else
+        moffsSize = (s.prefixes & kX86DecoderPrefix67) ? 2 : 4;
+      break;
+  }
+
+  // Rotate and shift by one (D0, D1) has an implicit immediate.
+  if (s.map == kX86DecoderMap00 && s.encoding == kX86DecoderLegacy && (s.opCode == 0xD0 || s.opCode == 0xD1)) {
+    s.imm = 1;
+    s.immSize = 1;
+    s.slots |= kX86DecoderSlotI;
+  }
+
+  // EXTRQ and INSERTQ (SSE4A) have two 8-bit immediates.
+  if (s.map == kX86DecoderMap0F && s.opCode == 0x78 && s.encoding == kX86DecoderLegacy &&
+      ((s.prefixes & kX86DecoderPrefix66) || s.rep == 0xF2)) {
+    immSize = 1;
+    imm2Size = 1;
+  }
+
+  uint32_t remain = static_cast<uint32_t>((size_t)(end - p));
+  if (ASMJIT_UNLIKELY(remain < immSize + imm2Size + relSize + moffsSize + skipSize)) return 0;
+
+  if (immSize) {
+    s.imm = X86Decoder_readU(p, immSize);
+    s.immSize = immSize;
+    s.slots |= kX86DecoderSlotI;
+    if (immSize == 1 && (s.encoding == kX86DecoderVex2 || s.encoding == kX86DecoderVex3 || s.encoding == kX86DecoderXop))
+      s.slots |= kX86DecoderSlotIs4;
+    p += immSize;
+  }
+
+  if (imm2Size) {
+    s.imm2 = static_cast<uint32_t>(X86Decoder_readU(p, imm2Size));
+    s.slots |= kX86DecoderSlotI2;
+    p += imm2Size;
+  }
+
+  if (relSize) {
+    s.rel = static_cast<int32_t>(X86Decoder_signExtend(X86Decoder_readU(p, relSize), relSize));
+    s.slots |= kX86DecoderSlotRel;
+    p += relSize;
+  }
+
+  if (moffsSize) {
+    s.moffs = X86Decoder_readU(p, moffsSize);
+    s.addrSize = moffsSize;
+    s.slots |= kX86DecoderSlotMoffs;
+    p += moffsSize;
+  }
+
+  p += skipSize;
+  s.size = static_cast<uint32_t>((size_t)(p - data));
+  return s.size;
+}
+
+// ============================================================================
+// [asmjit::X86Decoder - Index]
+// ============================================================================
+
+#if !defined(ASMJIT_DISABLE_VALIDATION)
+//! \internal
+static const uint32_t kX86DecoderKeyCount = kX86DecoderMapCount * 256;
+
+static ASMJIT_INLINE uint32_t X86Decoder_makeKey(uint32_t map, uint32_t op) noexcept {
+  return (map << 8) | (op & 0xFF);
+}
+
+//! \internal
+//!
+//! Get the decoder map of an opcode stored in `X86Inst` database.
+static ASMJIT_INLINE uint32_t X86Decoder_getOpCodeMap(uint32_t opCode, bool isVex) noexcept {
+  uint32_t mm = (opCode & X86Inst::kOpCode_MM_Mask) >> X86Inst::kOpCode_MM_Shift;
+  if (isVex) {
+    if (mm & 0x08)
+      return kX86DecoderMapXop8 + (mm & 0x3);
+    return mm & 0x3;
+  }
+  return mm & 0x7;
+}
+
+//! \internal
+//!
+//! Get all index keys of the instruction `instId`, returns the count of keys.
+static uint32_t X86Decoder_getKeys(uint32_t instId, uint32_t* keys) noexcept {
+  const X86Inst& inst = X86Inst::getInst(instId);
+  uint32_t encoding = inst.getEncodingType();
+  uint32_t count = 0;
+
+  // FPU instructions use a 2-byte opcode that doesn't follow MM field.
+  if (encoding >= X86Inst::kEncodingFpuOp && encoding <= X86Inst::kEncodingFpuStsw) {
+    if (encoding == X86Inst::kEncodingFpuOp) {
+      keys[count++] = X86Decoder_makeKey(kX86DecoderMap00, (inst.getMainOpCode() & X86Inst::kOpCode_FPU_2B_Mask) >> X86Inst::kOpCode_FPU_2B_Shift);
+    }
+    else {
+      for (uint32_t op = 0xD8; op <= 0xDF; op++)
+        keys[count++] = X86Decoder_makeKey(kX86DecoderMap00, op);
+    }
+    return count;
+  }
+
+  if (encoding == X86Inst::kEncodingExt3dNow) {
+    keys[count++] = X86Decoder_makeKey(kX86DecoderMap0F, 0x0F);
+    return count;
+  }
+
+  bool isVex = inst.isVex() || inst.isEvex();
+  uint32_t mainOpCode = inst.getMainOpCode();
+  keys[count++] = X86Decoder_makeKey(X86Decoder_getOpCodeMap(mainOpCode, isVex), mainOpCode);
+
+  if (inst.hasAltOpCode()) {
+    uint32_t altOpCode = inst.getAltOpCode();
+    keys[count++] = X86Decoder_makeKey(X86Decoder_getOpCodeMap(altOpCode, isVex), altOpCode);
+  }
+
+  // Opcodes the assembler derives from the main opcode (short forms and
+  // immediate forms) that are not covered by `byte & ~1` and `byte & ~7`.
+  static const uint16_t arithKeys[] = { 0x080 };
+  static const uint16_t rotKeys[] = { 0x0C0 };
+  static const uint16_t testKeys[] = { 0x0A8 };
+  static const uint16_t xchgKeys[] = { 0x090 };
+  static const uint16_t movKeys[] = { 0x088, 0x0A0, 0x0B0, 0x0B8, 0x0C6, 0x120 };
+  static const uint16_t pushKeys[] = { 0x068, 0x006, 0x00E, 0x016, 0x01E, 0x1A0, 0x1A8 };
+  static const uint16_t popKeys[] = { 0x007, 0x017, 0x01F, 0x1A1, 0x1A9 };
+  static const uint16_t imulKeys[] = { 0x069, 0x06B, 0x1AF };
+  static const uint16_t intKeys[] = { 0x0CC };
+  static const uint16_t jmpKeys[] = { 0x0E9 };
+  static const uint16_t callKeys[] = { 0x0E8 };
+  static const uint16_t movqKeys[] = { 0x1D6 };
+
+  const uint16_t* extra = nullptr;
+  uint32_t extraCount = 0;
+
+#define ASMJIT_EXTRA_KEYS(ENCODING, KEYS) \
+  case X86Inst::kEncoding##ENCODING: extra = KEYS; extraCount = ASMJIT_ARRAY_SIZE(KEYS); break
+
+  switch (encoding) {
+    ASMJIT_EXTRA_KEYS(X86Arith  , arithKeys);
+    ASMJIT_EXTRA_KEYS(X86Rot    , rotKeys  );
+    ASMJIT_EXTRA_KEYS(X86Test   , testKeys );
+    ASMJIT_EXTRA_KEYS(X86Xchg   , xchgKeys );
+    ASMJIT_EXTRA_KEYS(X86Mov    , movKeys  );
+    ASMJIT_EXTRA_KEYS(X86Push   , pushKeys );
+    ASMJIT_EXTRA_KEYS(X86Pop    , popKeys  );
+    ASMJIT_EXTRA_KEYS(X86Imul   , imulKeys );
+    ASMJIT_EXTRA_KEYS(X86Int    , intKeys  );
+    ASMJIT_EXTRA_KEYS(X86Jmp    , jmpKeys  );
+    ASMJIT_EXTRA_KEYS(X86Call   , callKeys );
+    ASMJIT_EXTRA_KEYS(ExtMovq   , movqKeys );
+    ASMJIT_EXTRA_KEYS(VexMovdMovq, movqKeys);
+  }
+
+#undef ASMJIT_EXTRA_KEYS
+
+  for (uint32_t i = 0; i < extraCount; i++)
+    keys[count++] = extra[i];
+  return count;
+}
+
+//! \internal
+//!
+//! Build the index of instruction ids by opcode. The first `kX86DecoderKeyCount + 1`
+//! entries are offsets of buckets, which follow.
+static uint16_t* X86Decoder_buildIndex() noexcept {
+  uint32_t keys[16];
+  uint32_t counts[kX86DecoderKeyCount];
+  ::memset(counts, 0, sizeof(counts));
+
+  uint32_t total = 0;
+  for (uint32_t instId = 1; instId < X86Inst::_kIdCount; instId++) {
+    uint32_t keyCount = X86Decoder_getKeys(instId, keys);
+    for (uint32_t i = 0; i < keyCount; i++)
+      counts[keys[i]]++;
+    total += keyCount;
+  }
+
+  uint32_t headerSize = kX86DecoderKeyCount + 1;
+  uint16_t* index = static_cast<uint16_t*>(Internal::allocMemory((headerSize + total) * sizeof(uint16_t)));
+  if (ASMJIT_UNLIKELY(!index)) return nullptr;
+
+  uint32_t offset = headerSize;
+  for (uint32_t key = 0; key < kX86DecoderKeyCount; key++) {
+    index[key] = static_cast<uint16_t>(offset);
+    offset += counts[key];
+    counts[key] = index[key];
+  }
+  index[kX86DecoderKeyCount] = static_cast<uint16_t>(offset);
+
+  for (uint32_t instId = 1; instId < X86Inst::_kIdCount; instId++) {
+    uint32_t keyCount = X86Decoder_getKeys(instId, keys);
+    for (uint32_t i = 0; i < keyCount; i++)
+      index[counts[keys[i]]++] = static_cast<uint16_t>(instId);
+  }
+
+  return index;
+}
+
+// ============================================================================
+// [asmjit::X86Decoder - Operands]
+// ============================================================================
+
+//! \internal
+static const uint32_t kX86DecoderMaxCandidates = 256;
+//! \internal
+static const uint32_t kX86DecoderMaxVariants = 32;
+//! \internal
+//!
+//! Maximum number of encodings tried per instruction, prevents blowups of
+//! instructions that have many operand combinations.
+static const uint32_t kX86DecoderMaxEmits = 16384;
+
+static ASMJIT_INLINE uint32_t X86Decoder_getRegFlag(uint32_t rType) noexcept {
+  switch (rType) {
+    case X86Reg::kRegGpbLo: return X86Inst::kOpGpbLo;
+    case X86Reg::kRegGpbHi: return X86Inst::kOpGpbHi;
+    case X86Reg::kRegGpw  : return X86Inst::kOpGpw;
+    case X86Reg::kRegGpd  : return X86Inst::kOpGpd;
+    case X86Reg::kRegGpq  : return X86Inst::kOpGpq;
+    case X86Reg::kRegXmm  : return X86Inst::kOpXmm;
+    case X86Reg::kRegYmm  : return X86Inst::kOpYmm;
+    case X86Reg::kRegZmm  : return X86Inst::kOpZmm;
+    case X86Reg::kRegSeg  : return X86Inst::kOpSeg;
+    case X86Reg::kRegFp   : return X86Inst::kOpFp;
+    case X86Reg::kRegMm   : return X86Inst::kOpMm;
+    case X86Reg::kRegK    : return X86Inst::kOpK;
+    case X86Reg::kRegBnd  : return X86Inst::kOpBnd;
+    case X86Reg::kRegCr   : return X86Inst::kOpCr;
+    case X86Reg::kRegDr   : return X86Inst::kOpDr;
+    default:
+      return 0;
+  }
+}
+
+//! \internal
+//!
+//! Get register types allowed by `opFlags` ordered by preference, which is
+//! based on operand size and vector length of the decoded instruction.
+static uint32_t X86Decoder_getRegTypes(const X86DecoderState& s, uint32_t opFlags, uint8_t* out) noexcept {
+  uint32_t gpFirst = s.w ? X86Reg::kRegGpq : (s.prefixes & kX86DecoderPrefix66) ? X86Reg::kRegGpw : X86Reg::kRegGpd;
+  uint32_t vecFirst = X86Reg::kRegXmm + (s.ll < 2 ? s.ll : 2);
+
+  // EVEX.L'L is a rounding control if EVEX.b is set in register form.
+  if (s.encoding == kX86DecoderEvex && s.bcst && s.mod == 3)
+    vecFirst = X86Reg::kRegZmm;
+
+  const uint8_t order[] = {
+    static_cast<uint8_t>(gpFirst),
+    X86Reg::kRegGpd, X86Reg::kRegGpq, X86Reg::kRegGpw, X86Reg::kRegGpbLo, X86Reg::kRegGpbHi,
+    static_cast<uint8_t>(vecFirst),
+    X86Reg::kRegXmm, X86Reg::kRegYmm, X86Reg::kRegZmm,
+    X86Reg::kRegMm, X86Reg::kRegK, X86Reg::kRegFp, X86Reg::kRegSeg, X86Reg::kRegCr, X86Reg::kRegDr, X86Reg::kRegBnd
+  };
+
+  uint32_t count = 0;
+  uint32_t seen = 0;
+
+  for (uint32_t i = 0; i < ASMJIT_ARRAY_SIZE(order); i++) {
+    uint32_t rType = order[i];
+    if ((opFlags & X86Decoder_getRegFlag(rType)) && !(seen & Utils::mask(rType))) {
+      seen |= Utils::mask(rType);
+      out[count++] = static_cast<uint8_t>(rType);
+    }
+  }
+  return count;
+}
+
+//! \internal
+//!
+//! Make a register of `rType` from a hardware id `hwId`, fails if the id
+//! cannot be encoded in the decoded mode.
+static bool X86Decoder_makeReg(const X86DecoderState& s, uint32_t rType, uint32_t hwId, Operand_& out) noexcept {
+  uint32_t gpCount = s.is64 ? 16 : 8;
+  uint32_t vecCount = s.is64 ? (s.encoding == kX86DecoderEvex ? 32 : 16) : 8;
+  uint32_t id = hwId;
+
+  switch (rType) {
+    case X86Reg::kRegGpbLo:
+      if (hwId >= gpCount || (hwId >= 4 && hwId < 8 && (!s.is64 || !s.rex))) return false;
+      break;
+
+    case X86Reg::kRegGpbHi:
+      if (hwId < 4 || hwId >= 8 || s.rex) return false;
+      id = hwId - 4;
+      break;
+
+    case X86Reg::kRegGpw:
+    case X86Reg::kRegGpd:
+      if (hwId >= gpCount) return false;
+      break;
+
+    case X86Reg::kRegGpq:
+      if (!s.is64 || hwId >= 16) return false;
+      break;
+
+    case X86Reg::kRegXmm:
+    case X86Reg::kRegYmm:
+    case X86Reg::kRegZmm:
+      if (hwId >= vecCount) return false;
+      break;
+
+    case X86Reg::kRegSeg:
+      if (hwId >= 6) return false;
+      id = hwId + 1;
+      break;
+
+    case X86Reg::kRegBnd:
+      if (hwId >= 4) return false;
+      break;
+
+    case X86Reg::kRegCr:
+    case X86Reg::kRegDr:
+      if (hwId >= gpCount) return false;
+      break;
+
+    default:
+      if (hwId >= 8) return false;
+      break;
+  }
+
+  X86Reg reg;
+  reg.setTypeAndId(rType, id);
+  out.copyFrom(reg);
+  return true;
+}
+
+//! \internal
+//!
+//! Make a memory operand from ModR/M and SIB fields, `vecType` is the type of
+//! a VSIB index or zero, `cdShift` is the EVEX compressed displacement shift.
+static bool X86Decoder_makeMem(const X86DecoderState& s, uint32_t vecType, uint32_t cdShift, uint32_t size, Operand_& out) noexcept {
+  uint32_t gpType = s.addrSize == 8 ? X86Reg::kRegGpq :
+                    s.addrSize == 4 ? X86Reg::kRegGpd : X86Reg::kRegGpw;
+
+  int32_t disp = s.disp;
+  if (s.dispSize == 1)
+    disp = static_cast<int32_t>(static_cast<uint32_t>(disp) << cdShift);
+
+  X86Reg index;
+  if (vecType) {
+    if (!s.hasSib) return false;
+    index.setTypeAndId(vecType, s.sibIndex | (s.vHi << 4));
+  }
+  else if (s.memIndex != kX86DecoderMemNone) {
+    index.setTypeAndId(gpType, s.memIndex);
+  }
+
+  X86Mem mem;
+  if (s.memBase == kX86DecoderMemRip) {
+    mem = x86::ptr(x86::rip, disp, size);
+  }
+  else if (s.memBase == kX86DecoderMemNone) {
+    uint64_t addr = s.addrSize == 8 ? static_cast<uint64_t>(static_cast<int64_t>(disp)) :
+                    s.addrSize == 4 ? static_cast<uint64_t>(static_cast<uint32_t>(disp)) :
+                                      static_cast<uint64_t>(static_cast<uint16_t>(disp));
+    uint32_t flags = s.is64 ? static_cast<uint32_t>(Mem::kSignatureMemAbs) : 0;
+
+    if (index.isReg())
+      mem = X86Mem(addr, index, s.memShift, size, flags);
+    else
+      mem = X86Mem(addr, size, flags);
+  }
+  else {
+    X86Reg base;
+    base.setTypeAndId(gpType, s.memBase);
+
+    if (index.isReg())
+      mem = X86Mem(base, index, s.memShift, disp, size);
+    else
+      mem = X86Mem(base, disp, size);
+  }
+
+  if (s.segment)
+    mem.setSegmentId(s.segment);
+
+  out.copyFrom(mem);
+  return true;
+}
+
+//! \internal
+//!
+//! Get memory sizes allowed by `memFlags`, zero (any size) is always last.
+//! All sizes are returned if `memFlags` doesn't restrict the size, which is
+//! the case of implicit memory operands of string instructions.
+static uint32_t X86Decoder_getMemSizes(uint32_t memFlags, uint8_t* out) noexcept {
+  static const uint8_t sizes[] = { 1, 2, 4, 6, 8, 10, 16, 32, 64, 128 };
+  const uint32_t kSizeMask = Utils::bits(ASMJIT_ARRAY_SIZE(sizes));
+
+  if (!(memFlags & kSizeMask))
+    memFlags |= kSizeMask;
+
+  uint32_t count = 0;
+  for (uint32_t i = 0; i < ASMJIT_ARRAY_SIZE(sizes); i++)
+    if (memFlags & Utils::mask(i))
+      out[count++] = sizes[i];
+
+  out[count++] = 0;
+  return count;
+}
+
+//! \internal
+//!
+//! Get VSIB index types allowed by `memFlags`.
+static uint32_t X86Decoder_getVsibTypes(uint32_t memFlags, uint8_t* out) noexcept {
+  uint32_t count = 0;
+  uint32_t seen = 0;
+
+  for (uint32_t i = 0; i < 3; i++) {
+    uint32_t mask = (X86Inst::kMemOpVm32x | X86Inst::kMemOpVm64x) << i;
+    if ((memFlags & mask) && !(seen & Utils::mask(i))) {
+      seen |= Utils::mask(i);
+      out[count++] = static_cast<uint8_t>(X86Reg::kRegXmm + i);
+    }
+  }
+  return count;
+}
+
+// ============================================================================
+// [asmjit::X86Decoder - Match]
+// ============================================================================
+
+//! \internal
+//!
+//! State of matching a single instruction signature against decoded fields.
+struct X86DecoderMatch {
+  const X86DecoderState* s;              //!< Decoded fields.
+  X86Assembler* a;                       //!< Assembler used to verify the encoding.
+  uint32_t instId;                       //!< Candidate instruction id.
+  uint32_t is3dNow;                      //!< Candidate is a 3DNOW instruction (imm8 is opcode).
+  uint32_t opCount;                      //!< Count of operands to match.
+  uint32_t used;                         //!< Slots used by operands matched so far.
+  uint32_t relIndex;                     //!< Index of a relative operand or `kInvalidIndex`.
+  uint32_t emitCount;                    //!< Count of encodings tried.
+  uint32_t variantCount;                 //!< Count of option variants.
+  uint32_t variants[kX86DecoderMaxVariants];
+  RegOnly extraReg;                      //!< Extra register (AVX-512 {k}).
+  const X86Inst::OSignature* ops[6];     //!< Operand signatures to match.
+  Operand_ opArray[6];                   //!< Operands being matched.
+
+  uint32_t options;                      //!< Matched options.
+  RegOnly matchedExtraReg;               //!< Matched extra register.
+};
+
+static bool X86Decoder_matchOp(X86DecoderMatch& m, uint32_t i) noexcept;
+
+//! \internal
+static const uint32_t kX86DecoderGpFlags = X86Inst::kOpGpbLo | X86Inst::kOpGpbHi | X86Inst::kOpGpw | X86Inst::kOpGpd | X86Inst::kOpGpq;
+
+//! \internal
+//!
+//! Encode operands matched so far with all option variants and compare the
+//! result with the decoded bytes.
+static bool X86Decoder_matchEmit(X86DecoderMatch& m) noexcept {
+  const X86DecoderState& s = *m.s;
+
+  // Every field that is not an opcode extension has to be consumed.
+  uint32_t unused = s.slots & ~m.used;
+  if (unused & (kX86DecoderSlotRel | kX86DecoderSlotMoffs | kX86DecoderSlotI2))
+    return false;
+
+  if ((unused & kX86DecoderSlotI) && !(m.used & kX86DecoderSlotIs4) && !m.is3dNow)
+    return false;
+
+  if ((unused & kX86DecoderSlotV) && (s.vvvv & 0xF) != 0)
+    return false;
+
+  X86Assembler* a = m.a;
+  for (uint32_t i = 0; i < m.variantCount; i++) {
+    if (++m.emitCount > kX86DecoderMaxEmits)
+      return false;
+
+    uint32_t options = m.variants[i];
+    RegOnly extraReg = m.extraReg;
+
+    // REP prefix uses an explicit counter register.
+    if ((options & (X86Inst::kOptionRep | X86Inst::kOptionRepnz)) && extraReg.isNone()) {
+      X86Reg zcx;
+      zcx.setTypeAndId(s.addrSize == 2 ? X86Reg::kRegGpw :
+                       s.is64 && s.addrSize != 4 ? X86Reg::kRegGpq : X86Reg::kRegGpd, X86Gp::kIdCx);
+      extraReg.init(zcx);
+    }
+
+    a->setOffset(0);
+    a->setOptions(options | (m.relIndex == kInvalidValue ? CodeEmitter::kOptionStrictValidation : 0));
+
+    if (extraReg.isValid())
+      a->setExtraReg(extraReg);
+    else
+      a->resetExtraReg();
+
+    Error err = a->_emitOpArray(m.instId, m.opArray, m.opCount);
+    if (err) {
+      a->resetLastError();
+      continue;
+    }
+
+    if (a->getOffset() == s.size && ::memcmp(a->getBufferData(), s.data, s.size) == 0) {
+      m.options = options;
+      m.matchedExtraReg = extraReg;
+      return true;
+    }
+  }
+
+  return false;
+}
+
+static ASMJIT_INLINE bool X86Decoder_matchNext(X86DecoderMatch& m, uint32_t i, uint32_t slot) noexcept {
+  m.used |= slot;
+  if (X86Decoder_matchOp(m, i + 1))
+    return true;
+
+  m.used &= ~slot;
+  return false;
+}
+
+static ASMJIT_INLINE bool X86Decoder_isFree(const X86DecoderMatch& m, uint32_t slot) noexcept {
+  return (m.s->slots & slot) != 0 && (m.used & slot) == 0;
+}
+
+//! \internal
+//!
+//! Match the operand `i` against all slots it can be encoded in.
+static bool X86Decoder_matchOp(X86DecoderMatch& m, uint32_t i) noexcept {
+  if (i == m.opCount)
+    return X86Decoder_matchEmit(m);
+
+  if (m.emitCount > kX86DecoderMaxEmits)
+    return false;
+
+  const X86DecoderState& s = *m.s;
+  const X86Inst::OSignature& op = *m.ops[i];
+  uint32_t opFlags = op.flags;
+  Operand_& out = m.opArray[i];
+
+  // Registers.
+  if (opFlags & X86Inst::kOpAllRegs) {
+    uint8_t types[16];
+    uint32_t typeCount = X86Decoder_getRegTypes(s, opFlags, types);
+
+    static const uint32_t regSlots[] = {
+      kX86DecoderSlotR, kX86DecoderSlotM, kX86DecoderSlotV, kX86DecoderSlotO, kX86DecoderSlotIs4
+    };
+
+    for (uint32_t slotIndex = 0; slotIndex < ASMJIT_ARRAY_SIZE(regSlots); slotIndex++) {
+      uint32_t slot = regSlots[slotIndex];
+      if (!X86Decoder_isFree(m, slot) || (slot == kX86DecoderSlotM && s.mod != 3))
+        continue;
+
+      uint32_t hwId;
+      switch (slot) {
+        case kX86DecoderSlotR  : hwId = s.reg; break;
+        case kX86DecoderSlotM  : hwId = s.rm; break;
+        case kX86DecoderSlotV  : hwId = s.vvvv | (s.vHi << 4); break;
+        case kX86DecoderSlotO  : hwId = (s.opCode & 7) | (s.b << 3); break;
+        default                : hwId = static_cast<uint32_t>(s.imm >> 4) & (s.is64 ? 0xF : 0x7); break;
+      }
+
+      for (uint32_t t = 0; t < typeCount; t++) {
+        if (!X86Decoder_makeReg(s, types[t], hwId, out))
+          continue;
+
+        uint32_t id = out.getId();
+        if (op.regMask && (id >= 8 || !(op.regMask & Utils::mask(id))))
+          continue;
+
+        if (X86Decoder_matchNext(m, i, slot))
+          return true;
+      }
+    }
+
+    // Fixed register that is not encoded (like AL in `in al, dx`). Short
+    // forms of legacy instructions without ModR/M use the accumulator.
+    uint32_t fixedMask = op.regMask;
+    if (!fixedMask && !(s.slots & kX86DecoderSlotM) && s.encoding == kX86DecoderLegacy && (opFlags & kX86DecoderGpFlags))
+      fixedMask = 0x01;
+
+    if (fixedMask) {
+      for (uint32_t id = 0; id < 8; id++) {
+        if (!(fixedMask & Utils::mask(id)))
+          continue;
+
+        for (uint32_t t = 0; t < typeCount; t++) {
+          uint32_t rType = types[t];
+          if ((rType == X86Reg::kRegGpq && !s.is64) || (rType == X86Reg::kRegSeg && id == 0))
+            continue;
+
+          X86Reg reg;
+          reg.setTypeAndId(rType, id);
+          out.copyFrom(reg);
+
+          if (X86Decoder_matchOp(m, i + 1))
+            return true;
+        }
+      }
+    }
+  }
+
+  // Memory.
+  if (opFlags & (X86Inst::kOpMem | X86Inst::kOpVm)) {
+    uint8_t sizes[16];
+    uint32_t sizeCount = X86Decoder_getMemSizes(op.memFlags, sizes);
+
+    if (X86Decoder_isFree(m, kX86DecoderSlotM) && s.mod != 3) {
+      uint8_t vecTypes[4];
+      uint32_t vecTypeCount = 1;
+      vecTypes[0] = 0;
+
+      if (opFlags & X86Inst::kOpVm) {
+        vecTypeCount = X86Decoder_getVsibTypes(op.memFlags, vecTypes);
+        sizeCount = 1;
+        sizes[0] = 0;
+      }
+
+      // EVEX compressed displacement depends on the instruction, try all.
+      uint32_t cdShiftCount = (s.encoding == kX86DecoderEvex && s.dispSize == 1 && s.disp != 0) ? 7 : 1;
+
+      for (uint32_t v = 0; v < vecTypeCount; v++) {
+        for (uint32_t cdShift = 0; cdShift < cdShiftCount; cdShift++) {
+          for (uint32_t j = 0; j < sizeCount; j++) {
+            if (!X86Decoder_makeMem(s, vecTypes[v], cdShift, sizes[j], out))
+              continue;
+
+            if (X86Decoder_matchNext(m, i, kX86DecoderSlotM))
+              return true;
+          }
+        }
+      }
+    }
+
+    if (X86Decoder_isFree(m, kX86DecoderSlotMoffs) && (opFlags & X86Inst::kOpMem)) {
+      for (uint32_t j = 0; j < sizeCount; j++) {
+        X86Mem mem(s.moffs, sizes[j], s.is64 ? static_cast<uint32_t>(Mem::kSignatureMemAbs) : 0);
+        if (s.segment)
+          mem.setSegmentId(s.segment);
+        out.copyFrom(mem);
+
+        if (X86Decoder_matchNext(m, i, kX86DecoderSlotMoffs))
+          return true;
+      }
+    }
+
+    // Fixed memory base (like [zsi] and [zdi] of string instructions).
+    if (op.regMask && (opFlags & X86Inst::kOpMem)) {
+      uint32_t addrSize = s.addrSize ? s.addrSize : s.is64 ? ((s.prefixes & kX86DecoderPrefix67) ? 4 : 8)
+                                                          : ((s.prefixes & kX86DecoderPrefix67) ? 2 : 4);
+      uint32_t gpType = addrSize == 8 ? X86Reg::kRegGpq :
+                        addrSize == 4 ? X86Reg::kRegGpd : X86Reg::kRegGpw;
+
+      for (uint32_t id = 0; id < 8; id++) {
+        if (!(op.regMask & Utils::mask(id)))
+          continue;
+
+        X86Reg base;
+        base.setTypeAndId(gpType, id);
+
+        for (uint32_t j = 0; j < sizeCount; j++) {
+          X86Mem mem(base, 0, sizes[j]);
+          if (s.segment)
+            mem.setSegmentId(s.segment);
+          out.copyFrom(mem);
+
+          if (X86Decoder_matchOp(m, i + 1))
+            return true;
+        }
+      }
+    }
+  }
+
+  // Immediates.
+  if (opFlags & X86Inst::kOpAllImm) {
+    if (X86Decoder_isFree(m, kX86DecoderSlotI)) {
+      uint64_t zext = s.imm;
+      int64_t sext = X86Decoder_signExtend(s.imm, s.immSize);
+
+      // The low 4 bits of Is4 byte are a separate immediate (VPERMIL2PS).
+      if (m.used & kX86DecoderSlotIs4) {
+        zext &= 0xF;
+        sext = static_cast<int64_t>(zext);
+      }
+
+      out.copyFrom(Imm(sext));
+      if (X86Decoder_matchNext(m, i, kX86DecoderSlotI))
+        return true;
+
+      if (static_cast<uint64_t>(sext) != zext) {
+        out.copyFrom(Imm(static_cast<int64_t>(zext)));
+        if (X86Decoder_matchNext(m, i, kX86DecoderSlotI))
+          return true;
+      }
+    }
+
+    if (X86Decoder_isFree(m, kX86DecoderSlotI2)) {
+      out.copyFrom(Imm(static_cast<int64_t>(s.imm2)));
+      if (X86Decoder_matchNext(m, i, kX86DecoderSlotI2))
+        return true;
+    }
+  }
+
+  // Relative displacement, encoded as a target relative to the instruction.
+  if ((opFlags & (X86Inst::kOpRel8 | X86Inst::kOpRel32)) && X86Decoder_isFree(m, kX86DecoderSlotRel)) {
+    out.copyFrom(Imm(static_cast<int64_t>(s.size) + s.rel));
+    m.relIndex = i;
+
+    if (X86Decoder_matchNext(m, i, kX86DecoderSlotRel))
+      return true;
+    m.relIndex = kInvalidValue;
+  }
+
+  return false;
+}
+
+//! \internal
+//!
+//! Prepare option variants of the candidate instruction `inst`.
+static void X86Decoder_initVariants(X86DecoderMatch& m, const X86Inst& inst) noexcept {
+  const X86DecoderState& s = *m.s;
+  const X86Inst::CommonData& commonData = inst.getCommonData();
+
+  uint32_t base = 0;
+  m.extraReg.reset();
+
+  switch (s.encoding) {
+    case kX86DecoderVex3:
+      base |= X86Inst::kOptionVex3;
+      break;
+
+    case kX86DecoderEvex:
+      base |= X86Inst::kOptionEvex;
+      if (s.z) base |= X86Inst::kOptionZMask;
+      if (s.bcst && s.mod != 3) base |= X86Inst::kOption1ToX;
+      if (s.aaa) {
+        X86Reg k;
+        k.setTypeAndId(X86Reg::kRegK, s.aaa);
+        m.extraReg.init(k);
+      }
+      break;
+
+    case kX86DecoderLegacy:
+      if (s.rex) base |= X86Inst::kOptionRex;
+      break;
+  }
+
+  if (s.prefixes & kX86DecoderPrefixLock)
+    base |= X86Inst::kOptionLock;
+
+  uint32_t repVariants[3];
+  uint32_t repCount = 0;
+
+  repVariants[repCount++] = 0;
+  if (s.rep == 0xF3) {
+    if (commonData.hasFlag(X86Inst::kFlagRep)) repVariants[repCount++] = X86Inst::kOptionRep;
+    if (commonData.hasFlag(X86Inst::kFlagXRelease)) repVariants[repCount++] = X86Inst::kOptionXRelease;
+  }
+  else if (s.rep == 0xF2) {
+    if (commonData.hasFlag(X86Inst::kFlagRepnz)) repVariants[repCount++] = X86Inst::kOptionRepnz;
+    if (commonData.hasFlag(X86Inst::kFlagXAcquire)) repVariants[repCount++] = X86Inst::kOptionXAcquire;
+  }
+
+  uint32_t formVariants[6];
+  uint32_t formCount = 0;
+
+  formVariants[formCount++] = 0;
+  if (s.slots & (kX86DecoderSlotI | kX86DecoderSlotRel))
+    formVariants[formCount++] = X86Inst::kOptionLongForm;
+
+  if (s.slots & kX86DecoderSlotRel) {
+    if (s.segment == X86Seg::kIdCs) formVariants[formCount++] = X86Inst::kOptionNotTaken;
+    if (s.segment == X86Seg::kIdDs) formVariants[formCount++] = X86Inst::kOptionTaken;
+  }
+
+  uint32_t modVariants[2];
+  uint32_t modCount = 0;
+
+  modVariants[modCount++] = 0;
+  if ((s.slots & kX86DecoderSlotM) && s.mod == 3)
+    modVariants[modCount++] = X86Inst::kOptionModMR;
+
+  uint32_t evexVariants[2];
+  uint32_t evexCount = 0;
+
+  if (s.encoding == kX86DecoderEvex && s.bcst && s.mod == 3) {
+    evexVariants[evexCount++] = X86Inst::kOptionER | (s.ll << 21);
+    evexVariants[evexCount++] = X86Inst::kOptionSAE;
+  }
+  else {
+    evexVariants[evexCount++] = 0;
+  }
+
+  m.variantCount = 0;
+  for (uint32_t i = 0; i < repCount; i++)
+    for (uint32_t j = 0; j < formCount; j++)
+      for (uint32_t k = 0; k < modCount; k++)
+        for (uint32_t l = 0; l < evexCount; l++)
+          if (m.variantCount < kX86DecoderMaxVariants)
+            m.variants[m.variantCount++] = base | repVariants[i] | formVariants[j] | modVariants[k] | evexVariants[l];
+}
+
+//! \internal
+//!
+//! Try to match the candidate `instId` against decoded fields.
+static bool X86Decoder_matchInst(X86DecoderMatch& m, uint32_t archType, uint32_t instId) noexcept {
+  const X86Inst& inst = X86Inst::getInst(instId);
+  const X86Inst::CommonData& commonData = inst.getCommonData();
+  const X86DecoderState& s = *m.s;
+
+  // The encoding space must match.
+  if (s.encoding == kX86DecoderLegacy) {
+    if (commonData.isVex() || commonData.isEvex())
+      return false;
+  }
+  else if (s.encoding == kX86DecoderEvex) {
+    if (!commonData.isEvex())
+      return false;
+  }
+  else {
+    if (!commonData.isVex())
+      return false;
+  }
+
+  m.instId = instId;
+  m.is3dNow = inst.getEncodingType() == X86Inst::kEncodingExt3dNow;
+  X86Decoder_initVariants(m, inst);
+
+  uint32_t archMask = archType == ArchInfo::kTypeX64 ? X86Inst::kArchMaskX64 : X86Inst::kArchMaskX86;
+  const X86Inst::ISignature* iSig = commonData.getISignatureData();
+  const X86Inst::ISignature* iEnd = commonData.getISignatureEnd();
+
+  // Implicit operands are tried omitted first as that's how they are usually
+  // written, some instructions (like MUL or DIV) don't encode without them.
+  for (uint32_t withImplicit = 0; withImplicit < 2; withImplicit++) {
+    for (const X86Inst::ISignature* sig = iSig; sig != iEnd; sig++) {
+      if (!(sig->archMask & archMask))
+        continue;
+
+      if (withImplicit && !sig->implicit)
+        continue;
+
+      uint32_t opCount = 0;
+      for (uint32_t i = 0; i < sig->opCount; i++) {
+        const X86Inst::OSignature* op = X86InstDB::oSignatureData + sig->operands[i];
+        if (!withImplicit && (op->flags & X86Inst::kOpImplicit))
+          continue;
+        m.ops[opCount++] = op;
+      }
+
+      m.opCount = opCount;
+      m.used = 0;
+      m.relIndex = kInvalidValue;
+
+      if (X86Decoder_matchOp(m, 0))
+        return true;
+
+      if (m.emitCount > kX86DecoderMaxEmits)
+        return false;
+    }
+  }
+
+  // Instructions without any signature have no operands.
+  if (iSig == iEnd) {
+    m.opCount = 0;
+    m.used = 0;
+    m.relIndex = kInvalidValue;
+    return X86Decoder_matchOp(m, 0);
+  }
+
+  return false;
+}
+#endif // !ASMJIT_DISABLE_VALIDATION
+
+// ============================================================================
+// [asmjit::X86DecodeHandler - Construction / Destruction]
+// ============================================================================
+
+X86DecodeHandler::X86DecodeHandler() noexcept {}
+X86DecodeHandler::~X86DecodeHandler() noexcept {}
+
+// ============================================================================
+// [asmjit::X86Decoder - Construction / Destruction]
+// ============================================================================
+
+X86Decoder::X86Decoder(uint32_t archType) noexcept
+  : _archType(archType),
+    _errorOffset(0),
+    _index(nullptr),
+    _code(),
+    _assembler() {
+
+  if (_code.init(CodeInfo(archType, 0, 0)) == kErrorOk)
+    _code.attach(&_assembler);
+}
+
+X86Decoder::~X86Decoder() noexcept {
+  if (_index)
+    Internal::releaseMemory(_index);
+}
+
+// ============================================================================
+// [asmjit::X86Decoder - Length]
+// ============================================================================
+
+uint32_t X86Decoder::getLength(uint32_t archType, const void* data, size_t size) noexcept {
+  X86DecoderState s;
+  return X86Decoder_parse(s, archType, static_cast<const uint8_t*>(data), size);
+}
+
+// ============================================================================
+// [asmjit::X86Decoder - Decode]
+// ============================================================================
+
+Error X86Decoder::decode(X86DecodedInst& out, const void* data, size_t size, uint64_t address) noexcept {
+  out.reset();
+  out.address = address;
+
+  X86DecoderState s;
+  uint32_t len = X86Decoder_parse(s, _archType, static_cast<const uint8_t*>(data), size);
+
+  if (ASMJIT_UNLIKELY(!len))
+    return DebugUtils::errored(kErrorInvalidInstruction);
+  out.size = len;
+
+#if !defined(ASMJIT_DISABLE_VALIDATION)
+  if (ASMJIT_UNLIKELY(!_assembler.isInitialized()))
+    return DebugUtils::errored(kErrorNotInitialized);
+
+  if (!_index) {
+    _index = X86Decoder_buildIndex();
+    if (ASMJIT_UNLIKELY(!_index))
+      return DebugUtils::errored(kErrorNoHeapMemory);
+  }
+
+  // Collect candidates, the assembler may derive the encoded opcode from the
+  // one stored in the database by adding a register id or an operation size.
+  uint32_t keys[4];
+  uint32_t keyCount = 0;
+
+  keys[keyCount++] = X86Decoder_makeKey(s.map, s.opCode);
+  if ((s.opCode & ~1U) != s.opCode)
+    keys[keyCount++] = X86Decoder_makeKey(s.map, s.opCode & ~1U);
+  if ((s.opCode & ~7U) != (s.opCode & ~1U))
+    keys[keyCount++] = X86Decoder_makeKey(s.map, s.opCode & ~7U);
+  if (s.map == kX86DecoderMap0F && s.opCode == 0x01 && (s.slots & kX86DecoderSlotM))
+    keys[keyCount++] = X86Decoder_makeKey(kX86DecoderMap0F01, s.modRM);
+
+  uint32_t candidates[kX86DecoderMaxCandidates];
+  uint32_t candidateCount = 0;
+
+  for (uint32_t k = 0; k < keyCount; k++) {
+    uint32_t start = _index[keys[k]];
+    uint32_t end = _index[keys[k] + 1];
+
+    for (uint32_t i = start; i < end && candidateCount < kX86DecoderMaxCandidates; i++) {
+      uint32_t instId = _index[i];
+      uint32_t j = 0;
+
+      // Insert sorted by id so aliases are resolved to the same instruction.
+      while (j < candidateCount && candidates[j] < instId)
+        j++;
+
+      if (j < candidateCount && candidates[j] == instId)
+        continue;
+
+      for (uint32_t n = candidateCount; n > j; n--)
+        candidates[n] = candidates[n - 1];
+
+      candidates[j] = instId;
+      candidateCount++;
+    }
+  }
+
+  X86DecoderMatch m;
+  m.s = &s;
+  m.a = &_assembler;
+  m.emitCount = 0;
+
+  for (uint32_t i = 0; i < candidateCount; i++) {
+    if (!X86Decoder_matchInst(m, _archType, candidates[i]))
+      continue;
+
+    uint32_t opCount = m.opCount;
+    for (uint32_t j = 0; j < opCount; j++)
+      out.operands[j].copyFrom(m.opArray[j]);
+
+    // Relative operand is reported as an absolute target.
+    if (m.relIndex != kInvalidValue)
+      out.operands[m.relIndex].as<Imm>().setUInt64(address + static_cast<uint64_t>(static_cast<int64_t>(len) + s.rel));
+
+    out.opCount = opCount;
+    out.detail.instId = m.instId;
+    out.detail.options = m.options & ~static_cast<uint32_t>(CodeEmitter::kOptionReservedMask);
+    out.detail.extraReg = m.matchedExtraReg;
+    return kErrorOk;
+  }
+
+  _assembler.resetOptions();
+  _assembler.resetExtraReg();
+  return DebugUtils::errored(kErrorInvalidInstruction);
+#else
+  return DebugUtils::errored(kErrorFeatureNotEnabled);
+#endif
+}
+
+Error X86Decoder::decodeAll(X86DecodeHandler* handler, const void* data, size_t size, uint64_t address) noexcept {
+  const uint8_t* p = static_cast<const uint8_t*>(data);
+  size_t offset = 0;
+
+  X86DecodedInst inst;
+  _errorOffset = 0;
+
+  while (offset < size) {
+    Error err = decode(inst, p + offset, size - offset, address + offset);
+    if (!err && handler)
+      err = handler->handleInst(inst);
+
+    if (ASMJIT_UNLIKELY(err)) {
+      _errorOffset = offset;
+      return err;
+    }
+
+    offset += inst.size;
+  }
+
+  return kErrorOk;
+}
+
+// ============================================================================
+// [asmjit::X86Decoder - Test]
+// ============================================================================
+
+#if defined(ASMJIT_TEST)
+//! \internal
+//!
+//! Decode handler that counts decoded instructions.
+struct X86DecoderTestHandler : public X86DecodeHandler {
+  X86DecoderTestHandler() noexcept : count(0) {}
+  virtual Error handleInst(const X86DecodedInst& inst) noexcept { count++; return kErrorOk; }
+
+  uint32_t count;
+};
+
+UNIT(x86_decoder) {
+  using namespace x86;
+
+  INFO("Decoding length of instructions");
+  {
+    static const uint8_t ret[] = { 0xC3 };
+    static const uint8_t lea[] = { 0x48, 0x8D, 0x44, 0x8B, 0x10 };
+    static const uint8_t movAbs[] = { 0x48, 0xB8, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08 };
+    static const uint8_t movImm16[] = { 0x66, 0xC7, 0x00, 0x34, 0x12 };
+    static const uint8_t vaddps[] = { 0x62, 0xF1, 0x74, 0x48, 0x58, 0x44, 0x24, 0x01 };
+
+    EXPECT(X86Decoder::getLength(ArchInfo::kTypeX64, ret, sizeof(ret)) == 1);
+    EXPECT(X86Decoder::getLength(ArchInfo::kTypeX64, lea, sizeof(lea)) == 5);
+    EXPECT(X86Decoder::getLength(ArchInfo::kTypeX64, movAbs, sizeof(movAbs)) == 10);
+    EXPECT(X86Decoder::getLength(ArchInfo::kTypeX64, movImm16, sizeof(movImm16)) == 5);
+    EXPECT(X86Decoder::getLength(ArchInfo::kTypeX64, vaddps, sizeof(vaddps)) == 8);
+
+    // Truncated instructions.
+    EXPECT(X86Decoder::getLength(ArchInfo::kTypeX64, lea, 4) == 0);
+    EXPECT(X86Decoder::getLength(ArchInfo::kTypeX64, movAbs, 9) == 0);
+  }
+
+#if !defined(ASMJIT_DISABLE_VALIDATION)
+  INFO("Decoding instructions and operands");
+  {
+    X86Decoder decoder(ArchInfo::kTypeX64);
+    X86DecodedInst inst;
+
+    static const uint8_t lea[] = { 0x48, 0x8D, 0x44, 0x8B, 0x10 };
+    EXPECT(decoder.decode(inst, lea, sizeof(lea), 0x1000) == kErrorOk);
+    EXPECT(inst.getInstId() == X86Inst::kIdLea);
+    EXPECT(inst.size == 5);
+    EXPECT(inst.opCount == 2);
+    EXPECT(inst.operands[0] == rax);
+    EXPECT(inst.operands[1].isMem());
+    EXPECT(inst.operands[1].as<X86Mem>().getBaseId() == X86Gp::kIdBx);
+    EXPECT(inst.operands[1].as<X86Mem>().getIndexId() == X86Gp::kIdCx);
+    EXPECT(inst.operands[1].as<X86Mem>().getShift() == 2);
+    EXPECT(inst.operands[1].as<X86Mem>().getOffsetLo32() == 16);
+
+    // Relative displacement is reported as an absolute target.
+    static const uint8_t jmp[] = { 0xE9, 0x00, 0x01, 0x00, 0x00 };
+    EXPECT(decoder.decode(inst, jmp, sizeof(jmp), 0x1000) == kErrorOk);
+    EXPECT(inst.getInstId() == X86Inst::kIdJmp);
+    EXPECT(inst.opCount == 1);
+    EXPECT(inst.operands[0].isImm());
+    EXPECT(inst.operands[0].as<Imm>().getUInt64() == 0x1105);
+
+    // AVX-512 with a compressed displacement and a write mask.
+    static const uint8_t vaddps[] = { 0x62, 0xF1, 0x74, 0x49, 0x58, 0x44, 0x24, 0x01 };
+    EXPECT(decoder.decode(inst, vaddps, sizeof(vaddps), 0) == kErrorOk);
+    EXPECT(inst.getInstId() == X86Inst::kIdVaddps);
+    EXPECT(inst.opCount == 3);
+    EXPECT(inst.operands[0] == zmm0);
+    EXPECT(inst.operands[1] == zmm1);
+    EXPECT(inst.operands[2].as<X86Mem>().getOffsetLo32() == 64);
+    EXPECT(inst.detail.extraReg.getId() == 1);
+
+    // Truncated instruction.
+    EXPECT(decoder.decode(inst, lea, 3, 0) == kErrorInvalidInstruction);
+  }
+
+  INFO("Decoding code generated by X86Assembler");
+  {
+    CodeHolder code;
+    code.init(CodeInfo(ArchInfo::kTypeX64));
+
+    X86Assembler a(&code);
+    Label L = a.newLabel();
+
+    a.bind(L);
+    a.push(rbx);
+    a.mov(r10d, dword_ptr(rsp, rcx, 1, -8));
+    a.add(qword_ptr(rip, 0x40), 1);
+    a.shl(eax, 1);
+    a.movsb();
+    a.long_().jnz(L);
+    a.vpcmpd(k1, zmm2, zmm3, 4);
+    a._1tox().vfmadd231ps(xmm1, xmm2, dword_ptr(rax));
+    a.fstsw(ax);
+    a.pop(rbx);
+    a.ret();
+    code.sync();
+
+    X86Decoder decoder(ArchInfo::kTypeX64);
+    X86DecoderTestHandler handler;
+
+    EXPECT(decoder.decodeAll(&handler, code.getSectionEntry(0)->getBuffer()) == kErrorOk);
+    EXPECT(handler.count == 11);
+  }
+#endif // !ASMJIT_DISABLE_VALIDATION
+}
+#endif // ASMJIT_TEST
+
+} // asmjit namespace
+
+// [Api-End]
+#include "../asmjit_apiend.h"
+
+// [Guard]
+#endif // ASMJIT_BUILD_X86
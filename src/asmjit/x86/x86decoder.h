@@ -0,0 +1,202 @@
+// [AsmJit]
+// Complete x86/x64 JIT and Remote Assembler for C++.
+//
+// [License]
+// Zlib - See LICENSE.md file in the package.
+
+// [Guard]
+#ifndef _ASMJIT_X86_X86DECODER_H
+#define _ASMJIT_X86_X86DECODER_H
+
+// [Dependencies]
+#include "../base/codeholder.h"
+#include "../base/inst.h"
+#include "../x86/x86assembler.h"
+#include "../x86/x86operand.h"
+
+// [Api-Begin]
+#include "../asmjit_apibegin.h"
+
+namespace asmjit {
+
+//! \addtogroup asmjit_x86
+//! \{
+
+// ============================================================================
+// [asmjit::X86DecodedInst]
+// ============================================================================
+
+//! X86/X64 instruction decoded by \ref X86Decoder.
+struct X86DecodedInst {
+  // --------------------------------------------------------------------------
+  // [Construction / Reset]
+  // --------------------------------------------------------------------------
+
+  ASMJIT_INLINE X86DecodedInst() noexcept { reset(); }
+
+  ASMJIT_INLINE void reset() noexcept {
+    address = 0;
+    size = 0;
+    opCount = 0;
+    detail = Inst::Detail();
+
+    for (uint32_t i = 0; i < ASMJIT_ARRAY_SIZE(operands); i++)
+      operands[i].reset();
+  }
+
+  // --------------------------------------------------------------------------
+  // [Accessors]
+  // --------------------------------------------------------------------------
+
+  //! Get the instruction id, `X86Inst::kIdNone` if only the size is known.
+  ASMJIT_INLINE uint32_t getInstId() const noexcept { return detail.instId; }
+
+  // --------------------------------------------------------------------------
+  // [Members]
+  // --------------------------------------------------------------------------
+
+  uint64_t address;                      //!< Address of the instruction.
+  uint32_t size;                         //!< Size of the instruction in bytes.
+  uint32_t opCount;                      //!< Count of operands in `operands`.
+  Inst::Detail detail;                   //!< Instruction id, options, and extra register.
+  Operand operands[6];                   //!< Instruction operands.
+};
+
+// ============================================================================
+// [asmjit::X86DecodeHandler]
+// ============================================================================
+
+//! Handler that receives instructions decoded by \ref X86Decoder::decodeAll().
+class ASMJIT_VIRTAPI X86DecodeHandler {
+public:
+  // --------------------------------------------------------------------------
+  // [Construction / Destruction]
+  // --------------------------------------------------------------------------
+
+  //! Create a new `X86DecodeHandler` instance.
+  ASMJIT_API X86DecodeHandler() noexcept;
+  //! Destroy the `X86DecodeHandler` instance.
+  ASMJIT_API virtual ~X86DecodeHandler() noexcept;
+
+  // --------------------------------------------------------------------------
+  // [Interface]
+  // --------------------------------------------------------------------------
+
+  //! Called for each decoded instruction, decoding stops if an error is returned.
+  virtual Error handleInst(const X86DecodedInst& inst) noexcept = 0;
+};
+
+// ============================================================================
+// [asmjit::X86Decoder]
+// ============================================================================
+
+//! X86/X64 machine code decoder.
+//!
+//! The decoder provides two levels of decoding:
+//!
+//!   - \ref getLength() is a fast table-driven length decoder that only walks
+//!     prefixes, opcode, ModR/M, SIB, displacement, and immediate. It doesn't
+//!     need any state and can be used to split a code range into instructions,
+//!     for example to map profiler samples back to instruction boundaries.
+//!
+//!   - \ref decode() decodes an instruction into `Inst::Detail` and operands.
+//!     Candidate instructions are selected by opcode from the `X86Inst` database
+//!     and each candidate is verified by encoding it again by `X86Assembler`.
+//!     An instruction is only reported if its encoding matches the decoded bytes
+//!     exactly, which makes the decoder a round-trip check of the assembler. The
+//!     returned options contain the encoding options (like `kOptionModMR` or
+//!     `kOptionLongForm`) needed to produce the same bytes again.
+//!
+//! Decoding of instructions requires validation data, it's not available if
+//! `ASMJIT_DISABLE_VALIDATION` is defined (the length decoder still works).
+//!
+//! \code
+//! X86Decoder decoder(ArchInfo::kTypeX64);
+//! X86DecodedInst inst;
+//!
+//! const uint8_t code[] = { 0x48, 0x8D, 0x44, 0x8B, 0x10 };
+//! if (decoder.decode(inst, code, sizeof(code), 0x1000) == kErrorOk) {
+//!   // inst.getInstId() == X86Inst::kIdLea, inst.size == 5,
+//!   // inst.operands[0] == rax, inst.operands[1] == [rbx + rcx * 4 + 16].
+//! }
+//! \endcode
+class X86Decoder {
+public:
+  ASMJIT_NONCOPYABLE(X86Decoder)
+
+  // --------------------------------------------------------------------------
+  // [Construction / Destruction]
+  // --------------------------------------------------------------------------
+
+  //! Create a new `X86Decoder` that decodes `archType` code.
+  ASMJIT_API explicit X86Decoder(uint32_t archType = ArchInfo::kTypeHost) noexcept;
+  //! Destroy the `X86Decoder`.
+  ASMJIT_API ~X86Decoder() noexcept;
+
+  // --------------------------------------------------------------------------
+  // [Accessors]
+  // --------------------------------------------------------------------------
+
+  //! Get the architecture type of decoded code.
+  ASMJIT_INLINE uint32_t getArchType() const noexcept { return _archType; }
+  //! Get the offset (from the start of the decoded range) of the instruction
+  //! that failed to decode in the last call to \ref decodeAll().
+  ASMJIT_INLINE size_t getErrorOffset() const noexcept { return _errorOffset; }
+
+  // --------------------------------------------------------------------------
+  // [Length]
+  // --------------------------------------------------------------------------
+
+  //! Get the length of the instruction at `data` (at most `size` bytes are
+  //! read), returns zero if the instruction is truncated or invalid.
+  ASMJIT_API static uint32_t getLength(uint32_t archType, const void* data, size_t size) noexcept;
+
+  // --------------------------------------------------------------------------
+  // [Decode]
+  // --------------------------------------------------------------------------
+
+  //! Decode a single instruction at `data` located at `address` into `out`.
+  //!
+  //! Returns `kErrorInvalidInstruction` if the instruction is not known or
+  //! cannot be encoded by AsmJit the same way. The `out.size` is still valid
+  //! in that case if the length of the instruction could be decoded.
+  ASMJIT_API Error decode(X86DecodedInst& out, const void* data, size_t size, uint64_t address) noexcept;
+
+  //! Decode all instructions in `[data, data + size)` located at `address`
+  //! and pass them to `handler`, which can be null to only check that the
+  //! whole range decodes. On failure the offset of the instruction is
+  //! available through \ref getErrorOffset().
+  ASMJIT_API Error decodeAll(X86DecodeHandler* handler, const void* data, size_t size, uint64_t address) noexcept;
+
+  //! Decode all instructions in `buffer` that is going to be relocated to
+  //! `address`.
+  ASMJIT_INLINE Error decodeAll(X86DecodeHandler* handler, const CodeBuffer& buffer, uint64_t address = 0) noexcept {
+    return decodeAll(handler, buffer.getData(), buffer.getLength(), address);
+  }
+
+  //! Decode all instructions in a range of code that was already relocated,
+  //! like a function returned by `JitRuntime::add()`.
+  ASMJIT_INLINE Error decodeAll(X86DecodeHandler* handler, const void* data, size_t size) noexcept {
+    return decodeAll(handler, data, size, static_cast<uint64_t>((uintptr_t)data));
+  }
+
+  // --------------------------------------------------------------------------
+  // [Members]
+  // --------------------------------------------------------------------------
+
+  uint32_t _archType;                    //!< Architecture type.
+  size_t _errorOffset;                   //!< Offset of the last error in `decodeAll()`.
+  uint16_t* _index;                      //!< Instruction ids indexed by opcode (lazily built).
+  CodeHolder _code;                      //!< Code used to verify decoded instructions.
+  X86Assembler _assembler;               //!< Assembler used to verify decoded instructions.
+};
+
+//! \}
+
+} // asmjit namespace
+
+// [Api-End]
+#include "../asmjit_apiend.h"
+
+// [Guard]
+#endif // _ASMJIT_X86_X86DECODER_H
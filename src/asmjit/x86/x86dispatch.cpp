@@ -0,0 +1,311 @@
+// [AsmJit]
+// Complete x86/x64 JIT and Remote Assembler for C++.
+//
+// [License]
+// Zlib - See LICENSE.md file in the package.
+
+// [Export]
+#define ASMJIT_EXPORTS
+
+// [Guard]
+#include "../asmjit_build.h"
+#if defined(ASMJIT_BUILD_X86) && !defined(ASMJIT_DISABLE_COMPILER)
+
+// [Dependencies]
+#include "../base/inst.h"
+#include "../x86/x86dispatch.h"
+#include "../x86/x86inst.h"
+
+// [Api-Begin]
+#include "../asmjit_apibegin.h"
+
+namespace asmjit {
+
+// ============================================================================
+// [asmjit::X86FuncDispatcher - Tiers]
+// ============================================================================
+
+//! \internal
+//!
+//! Features added by each standard tier, zero terminated.
+static const uint8_t x86DispatchTierData[] = {
+  // kTierSSE2.
+  CpuInfo::kX86FeatureI486, CpuInfo::kX86FeatureCMOV, CpuInfo::kX86FeatureCMPXCHG8B,
+  CpuInfo::kX86FeatureRDTSC, CpuInfo::kX86FeatureCLFLUSH, CpuInfo::kX86FeatureFXSR,
+  CpuInfo::kX86FeatureMMX, CpuInfo::kX86FeatureMMX2, CpuInfo::kX86FeatureSSE,
+  CpuInfo::kX86FeatureSSE2, 0,
+
+  // kTierSSE4_1.
+  CpuInfo::kX86FeatureSSE3, CpuInfo::kX86FeatureSSSE3, CpuInfo::kX86FeatureSSE4_1, 0,
+
+  // kTierAVX2.
+  CpuInfo::kX86FeatureSSE4_2, CpuInfo::kX86FeaturePOPCNT, CpuInfo::kX86FeatureAVX,
+  CpuInfo::kX86FeatureAVX2, CpuInfo::kX86FeatureFMA, CpuInfo::kX86FeatureF16C,
+  CpuInfo::kX86FeatureBMI, CpuInfo::kX86FeatureBMI2, CpuInfo::kX86FeatureLZCNT,
+  CpuInfo::kX86FeatureMOVBE, 0,
+
+  // kTierAVX512.
+  CpuInfo::kX86FeatureAVX512_F, CpuInfo::kX86FeatureAVX512_CDI, CpuInfo::kX86FeatureAVX512_BW,
+  CpuInfo::kX86FeatureAVX512_DQ, CpuInfo::kX86FeatureAVX512_VL, 0
+};
+
+// ============================================================================
+// [asmjit::X86FuncDispatcher - Construction / Destruction]
+// ============================================================================
+
+X86FuncDispatcher::X86FuncDispatcher(JitRuntime* runtime) noexcept
+  : _runtime(runtime),
+    _hostFeatures(CpuInfo::getHost().getFeatures()),
+    _versionCount(0),
+    _selectedIndex(kInvalidValue),
+    _errorIndex(kInvalidValue),
+    _errorInstId(X86Inst::kIdNone) {}
+
+X86FuncDispatcher::X86FuncDispatcher(JitRuntime* runtime, const CpuFeatures& hostFeatures) noexcept
+  : _runtime(runtime),
+    _hostFeatures(hostFeatures),
+    _versionCount(0),
+    _selectedIndex(kInvalidValue),
+    _errorIndex(kInvalidValue),
+    _errorInstId(X86Inst::kIdNone) {}
+
+X86FuncDispatcher::~X86FuncDispatcher() noexcept {}
+
+// ============================================================================
+// [asmjit::X86FuncDispatcher - Versions]
+// ============================================================================
+
+Error X86FuncDispatcher::addVersion(const CpuFeatures& features) noexcept {
+  if (ASMJIT_UNLIKELY(_versionCount >= kMaxVersions))
+    return DebugUtils::errored(kErrorInvalidState);
+
+  _versions[_versionCount++].init(features);
+  return kErrorOk;
+}
+
+Error X86FuncDispatcher::addTier(uint32_t tier) noexcept {
+  CpuFeatures features;
+  ASMJIT_PROPAGATE(getTierFeatures(tier, features));
+  return addVersion(features);
+}
+
+void X86FuncDispatcher::resetVersions() noexcept {
+  _versionCount = 0;
+  _selectedIndex = kInvalidValue;
+}
+
+Error X86FuncDispatcher::getTierFeatures(uint32_t tier, CpuFeatures& out) noexcept {
+  out.reset();
+  if (ASMJIT_UNLIKELY(tier >= kTierCount))
+    return DebugUtils::errored(kErrorInvalidArgument);
+
+  const uint8_t* p = x86DispatchTierData;
+  for (uint32_t i = 0; i <= tier; i++) {
+    while (*p)
+      out.add(*p++);
+    p++;
+  }
+
+  return kErrorOk;
+}
+
+// ============================================================================
+// [asmjit::X86FuncDispatcher - Generate]
+// ============================================================================
+
+Error X86FuncDispatcher::checkFeatures(const CodeBuilder* cb, const CpuFeatures& features, uint32_t* instIdOut) noexcept {
+#if !defined(ASMJIT_DISABLE_EXTENSIONS)
+  uint32_t archType = cb->getArchType();
+  CpuFeatures required;
+
+  for (const CBNode* node = cb->getFirstNode(); node; node = node->getNext()) {
+    if (node->getType() != CBNode::kNodeInst)
+      continue;
+
+    const CBInst* inst = static_cast<const CBInst*>(node);
+    Operand opBuf[CBInst::kMaxPackedOps];
+    ASMJIT_PROPAGATE(Inst::checkFeatures(archType, inst->getInstDetail(), inst->getOpArray(opBuf), inst->getOpCount(), required));
+
+    if (!features.hasAll(required)) {
+      if (instIdOut) *instIdOut = inst->getInstId();
+      return DebugUtils::errored(kErrorMissingCpuFeature);
+    }
+  }
+#else
+  ASMJIT_UNUSED(cb);
+  ASMJIT_UNUSED(features);
+#endif // !ASMJIT_DISABLE_EXTENSIONS
+
+  if (instIdOut) *instIdOut = X86Inst::kIdNone;
+  return kErrorOk;
+}
+
+Error X86FuncDispatcher::_generate(void** dst, GenerateFunc generator, void* data) noexcept {
+  *dst = nullptr;
+
+  _selectedIndex = kInvalidValue;
+  _errorIndex = kInvalidValue;
+  _errorInstId = X86Inst::kIdNone;
+
+  // Select the last version the host can execute.
+  uint32_t selectedIndex = kInvalidValue;
+  for (uint32_t i = 0; i < _versionCount; i++)
+    if (_hostFeatures.hasAll(_versions[i]))
+      selectedIndex = i;
+
+  if (ASMJIT_UNLIKELY(selectedIndex == kInvalidValue))
+    return DebugUtils::errored(kErrorMissingCpuFeature);
+
+  // Generate all versions, not only the selected one, so each version is
+  // verified regardless of the machine it's generated on.
+  for (uint32_t i = 0; i < _versionCount; i++) {
+    // Let the compiler pick encodings of its own moves by the version's
+    // features, for example VEX encoded spills in AVX versions.
+    CodeInfo codeInfo(_runtime->getCodeInfo());
+    codeInfo.setFeatures(_versions[i]);
+
+    CodeHolder code;
+    Error err = code.init(codeInfo);
+
+    if (!err) {
+      X86Compiler cc(&code);
+      err = generator(&cc, _versions[i], data);
+
+      if (!err) err = checkFeatures(&cc, _versions[i], &_errorInstId);
+      if (!err) err = cc.finalize();
+      if (!err && i == selectedIndex) err = _runtime->add(dst, &code);
+    }
+
+    if (ASMJIT_UNLIKELY(err)) {
+      if (*dst) {
+        _runtime->release(*dst);
+        *dst = nullptr;
+      }
+
+      _errorIndex = i;
+      return err;
+    }
+  }
+
+  _selectedIndex = selectedIndex;
+  return kErrorOk;
+}
+
+// ============================================================================
+// [asmjit::X86FuncDispatcher - Test]
+// ============================================================================
+
+#if defined(ASMJIT_TEST) && (ASMJIT_ARCH_X86 || ASMJIT_ARCH_X64)
+//! \internal
+//!
+//! Generate `int f(int a, int b)` returning `a + b` (+100 if AVX2 is enabled).
+static Error X86FuncDispatcherTest_add(X86Compiler* cc, const CpuFeatures& features, void* data) {
+  cc->addFunc(FuncSignature2<int, int, int>(CallConv::kIdHost));
+
+  X86Gp a = cc->newI32("a");
+  X86Gp b = cc->newI32("b");
+
+  cc->setArg(0, a);
+  cc->setArg(1, b);
+  cc->add(a, b);
+
+  if (features.has(CpuInfo::kX86FeatureAVX2)) {
+    X86Ymm v = cc->newYmm("v");
+    cc->vmovd(v.xmm(), a);
+    cc->vpbroadcastd(v, v.xmm());
+    cc->vmovd(a, v.xmm());
+    cc->add(a, 100);
+  }
+
+  // Deliberately use AVX2 in every version if asked to.
+  if (data) {
+    X86Ymm v = cc->newYmm("v");
+    cc->vpxor(v, v, v);
+  }
+
+  cc->ret(a);
+  cc->endFunc();
+  return kErrorOk;
+}
+
+UNIT(x86_dispatch) {
+  typedef int (*Func)(int, int);
+  JitRuntime rt;
+
+  INFO("Building standard tiers");
+  {
+    CpuFeatures sse2, avx2;
+    EXPECT(X86FuncDispatcher::getTierFeatures(X86FuncDispatcher::kTierSSE2, sse2) == kErrorOk);
+    EXPECT(X86FuncDispatcher::getTierFeatures(X86FuncDispatcher::kTierAVX2, avx2) == kErrorOk);
+
+    EXPECT(sse2.has(CpuInfo::kX86FeatureSSE2) && !sse2.has(CpuInfo::kX86FeatureSSE4_1));
+    EXPECT(avx2.has(CpuInfo::kX86FeatureSSE4_1) && avx2.has(CpuInfo::kX86FeatureAVX2));
+    EXPECT(avx2.hasAll(sse2) && !sse2.hasAll(avx2));
+    EXPECT(X86FuncDispatcher::getTierFeatures(X86FuncDispatcher::kTierCount, sse2) == kErrorInvalidArgument);
+  }
+
+  INFO("Selecting a version by host features");
+  {
+    CpuFeatures host;
+    X86FuncDispatcher::getTierFeatures(X86FuncDispatcher::kTierSSE4_1, host);
+
+    X86FuncDispatcher dispatcher(&rt, host);
+    dispatcher.addTier(X86FuncDispatcher::kTierSSE2);
+    dispatcher.addTier(X86FuncDispatcher::kTierSSE4_1);
+    dispatcher.addTier(X86FuncDispatcher::kTierAVX2);
+
+    Func fn;
+    EXPECT(dispatcher.generate(&fn, X86FuncDispatcherTest_add, nullptr) == kErrorOk);
+    EXPECT(dispatcher.getSelectedIndex() == 1,
+      "Expected version 1 to be selected, not %u", dispatcher.getSelectedIndex());
+    EXPECT(fn(1, 2) == 3);
+    rt.release(fn);
+  }
+
+  const CpuFeatures& hostFeatures = CpuInfo::getHost().getFeatures();
+  if (hostFeatures.has(CpuInfo::kX86FeatureAVX2) && hostFeatures.has(CpuInfo::kX86FeatureFMA)) {
+    INFO("Selecting the AVX2 version on the host");
+
+    X86FuncDispatcher dispatcher(&rt);
+    dispatcher.addTier(X86FuncDispatcher::kTierSSE2);
+    dispatcher.addTier(X86FuncDispatcher::kTierAVX2);
+
+    Func fn;
+    EXPECT(dispatcher.generate(&fn, X86FuncDispatcherTest_add, nullptr) == kErrorOk);
+    EXPECT(dispatcher.getSelectedIndex() == 1);
+    EXPECT(fn(1, 2) == 103);
+    rt.release(fn);
+  }
+
+  INFO("Rejecting a version that uses a feature outside of its tier");
+  {
+    X86FuncDispatcher dispatcher(&rt, hostFeatures);
+    dispatcher.addTier(X86FuncDispatcher::kTierSSE2);
+
+    Func fn;
+    EXPECT(dispatcher.generate(&fn, X86FuncDispatcherTest_add, &rt) == kErrorMissingCpuFeature);
+    EXPECT(fn == nullptr);
+    EXPECT(dispatcher.getErrorIndex() == 0);
+    EXPECT(dispatcher.getErrorInstId() == X86Inst::kIdVpxor);
+  }
+
+  INFO("Failing if the host doesn't support any version");
+  {
+    CpuFeatures host;
+    X86FuncDispatcher dispatcher(&rt, host);
+    dispatcher.addTier(X86FuncDispatcher::kTierSSE2);
+
+    Func fn;
+    EXPECT(dispatcher.generate(&fn, X86FuncDispatcherTest_add, nullptr) == kErrorMissingCpuFeature);
+    EXPECT(fn == nullptr);
+  }
+}
+#endif // ASMJIT_TEST && (ASMJIT_ARCH_X86 || ASMJIT_ARCH_X64)
+
+} // asmjit namespace
+
+// [Api-End]
+#include "../asmjit_apiend.h"
+
+// [Guard]
+#endif // ASMJIT_BUILD_X86 && !ASMJIT_DISABLE_COMPILER
@@ -0,0 +1,187 @@
+// [AsmJit]
+// Complete x86/x64 JIT and Remote Assembler for C++.
+//
+// [License]
+// Zlib - See LICENSE.md file in the package.
+
+// [Guard]
+#ifndef _ASMJIT_X86_X86DISPATCH_H
+#define _ASMJIT_X86_X86DISPATCH_H
+
+#include "../asmjit_build.h"
+#if !defined(ASMJIT_DISABLE_COMPILER)
+
+// [Dependencies]
+#include "../base/cpuinfo.h"
+#include "../base/runtime.h"
+#include "../x86/x86compiler.h"
+
+// [Api-Begin]
+#include "../asmjit_apibegin.h"
+
+namespace asmjit {
+
+//! \addtogroup asmjit_x86
+//! \{
+
+// ============================================================================
+// [asmjit::X86FuncDispatcher]
+// ============================================================================
+
+//! Generates a function once per CPU feature tier and picks the best version
+//! the host can execute.
+//!
+//! Versions are added from the least to the most capable feature set, either
+//! as a standard \ref Tier or as any `CpuFeatures`. \ref generate() calls the
+//! generator for every version with an `X86Compiler` and the feature set the
+//! version targets, so a generator bug that uses an instruction outside of
+//! the tier is found on any machine, not only on the machine that would run
+//! that version. Each instruction is verified by `Inst::checkFeatures()`
+//! before the code is finalized, a version that uses a feature outside of its
+//! set fails with `kErrorMissingCpuFeature`.
+//!
+//! Only the selected version, the last one whose features are all provided by
+//! the host, is added to the runtime. There is no dispatch stub, the returned
+//! pointer is the generated function itself, so calls don't pay for dispatch.
+//!
+//! ~~~
+//! static Error generateKernel(X86Compiler* cc, const CpuFeatures& features, void* data) {
+//!   cc->addFunc(FuncSignature2<void, float*, size_t>());
+//!   if (features.has(CpuInfo::kX86FeatureAVX2)) {
+//!     // ... AVX2 code ...
+//!   }
+//!   else {
+//!     // ... SSE4.1 code ...
+//!   }
+//!   cc->endFunc();
+//!   return kErrorOk;
+//! }
+//!
+//! JitRuntime rt;
+//! X86FuncDispatcher dispatcher(&rt);
+//!
+//! dispatcher.addTier(X86FuncDispatcher::kTierSSE4_1);
+//! dispatcher.addTier(X86FuncDispatcher::kTierAVX2);
+//! dispatcher.addTier(X86FuncDispatcher::kTierAVX512);
+//!
+//! KernelFunc fn;
+//! Error err = dispatcher.generate(&fn, generateKernel, nullptr);
+//! ~~~
+class X86FuncDispatcher {
+public:
+  ASMJIT_NONCOPYABLE(X86FuncDispatcher)
+
+  //! Standard feature tiers, each includes all features of the previous one.
+  ASMJIT_ENUM(Tier) {
+    kTierSSE2      = 0,                  //!< Baseline X64 (SSE2).
+    kTierSSE4_1    = 1,                  //!< SSE3, SSSE3, and SSE4.1.
+    kTierAVX2      = 2,                  //!< AVX2, FMA, F16C, BMI, BMI2, LZCNT, MOVBE, POPCNT, and SSE4.2.
+    kTierAVX512    = 3,                  //!< AVX512-F, CDI, BW, DQ, and VL.
+    kTierCount     = 4                   //!< Count of standard tiers.
+  };
+
+  //! Maximum number of versions.
+  enum { kMaxVersions = 8 };
+
+  //! Generator of a single version, emits the function into `cc` that
+  //! targets `features`.
+  typedef Error (*GenerateFunc)(X86Compiler* cc, const CpuFeatures& features, void* data);
+
+  // --------------------------------------------------------------------------
+  // [Construction / Destruction]
+  // --------------------------------------------------------------------------
+
+  //! Create a new `X86FuncDispatcher` that adds the selected version to
+  //! `runtime`, versions are selected by features of the host CPU.
+  ASMJIT_API X86FuncDispatcher(JitRuntime* runtime) noexcept;
+  //! Create a new `X86FuncDispatcher` that selects versions by `hostFeatures`.
+  ASMJIT_API X86FuncDispatcher(JitRuntime* runtime, const CpuFeatures& hostFeatures) noexcept;
+  //! Destroy the `X86FuncDispatcher`, the generated function is owned by the
+  //! runtime and stays valid.
+  ASMJIT_API ~X86FuncDispatcher() noexcept;
+
+  // --------------------------------------------------------------------------
+  // [Accessors]
+  // --------------------------------------------------------------------------
+
+  //! Get the associated runtime.
+  ASMJIT_INLINE JitRuntime* getRuntime() const noexcept { return _runtime; }
+  //! Get features used to select the version.
+  ASMJIT_INLINE const CpuFeatures& getHostFeatures() const noexcept { return _hostFeatures; }
+
+  //! Get the number of versions.
+  ASMJIT_INLINE uint32_t getVersionCount() const noexcept { return _versionCount; }
+  //! Get features of the version `index`.
+  ASMJIT_INLINE const CpuFeatures& getVersionFeatures(uint32_t index) const noexcept {
+    ASMJIT_ASSERT(index < _versionCount);
+    return _versions[index];
+  }
+
+  //! Get the index of the version selected by the last \ref generate(), or
+  //! `kInvalidValue` if no version was selected.
+  ASMJIT_INLINE uint32_t getSelectedIndex() const noexcept { return _selectedIndex; }
+  //! Get the index of the version that failed in the last \ref generate().
+  ASMJIT_INLINE uint32_t getErrorIndex() const noexcept { return _errorIndex; }
+  //! Get the id of the instruction that failed the feature check in the last
+  //! \ref generate(), `X86Inst::kIdNone` if there is none.
+  ASMJIT_INLINE uint32_t getErrorInstId() const noexcept { return _errorInstId; }
+
+  // --------------------------------------------------------------------------
+  // [Versions]
+  // --------------------------------------------------------------------------
+
+  //! Add a version that targets `features`.
+  ASMJIT_API Error addVersion(const CpuFeatures& features) noexcept;
+  //! Add a version that targets a standard `tier`, see \ref Tier.
+  ASMJIT_API Error addTier(uint32_t tier) noexcept;
+  //! Remove all versions.
+  ASMJIT_API void resetVersions() noexcept;
+
+  //! Get features of a standard `tier` into `out`.
+  ASMJIT_API static Error getTierFeatures(uint32_t tier, CpuFeatures& out) noexcept;
+
+  // --------------------------------------------------------------------------
+  // [Generate]
+  // --------------------------------------------------------------------------
+
+  //! Generate all versions by `generator` and add the selected one to the
+  //! runtime, its address is stored in `dst`.
+  //!
+  //! Returns `kErrorMissingCpuFeature` if a version uses a feature outside of
+  //! its set, or if the host doesn't support any version.
+  template<typename Func>
+  ASMJIT_INLINE Error generate(Func* dst, GenerateFunc generator, void* data) noexcept {
+    return _generate(Internal::ptr_cast<void**, Func*>(dst), generator, data);
+  }
+
+  ASMJIT_API Error _generate(void** dst, GenerateFunc generator, void* data) noexcept;
+
+  //! Check that all instructions of `cb` only use `features`.
+  //!
+  //! On failure `kErrorMissingCpuFeature` is returned and the id of the first
+  //! instruction that doesn't fit is stored in `instIdOut`.
+  ASMJIT_API static Error checkFeatures(const CodeBuilder* cb, const CpuFeatures& features, uint32_t* instIdOut = nullptr) noexcept;
+
+  // --------------------------------------------------------------------------
+  // [Members]
+  // --------------------------------------------------------------------------
+
+  JitRuntime* _runtime;                  //!< Runtime the selected version is added to.
+  CpuFeatures _hostFeatures;             //!< Features used to select the version.
+  uint32_t _versionCount;                //!< Number of versions.
+  uint32_t _selectedIndex;               //!< Index of the selected version.
+  uint32_t _errorIndex;                  //!< Index of the version that failed.
+  uint32_t _errorInstId;                 //!< Instruction that failed the feature check.
+  CpuFeatures _versions[kMaxVersions];   //!< Features of each version.
+};
+
+//! \}
+
+} // asmjit namespace
+
+// [Api-End]
+#include "../asmjit_apiend.h"
+
+// [Guard]
+#endif // !ASMJIT_DISABLE_COMPILER
+#endif // _ASMJIT_X86_X86DISPATCH_H
@@ -401,6 +401,11 @@ public:
   //! Force 4-byte EVEX prefix (AVX512+).
   ASMJIT_INLINE This& evex() noexcept { return _addOptions(X86Inst::kOptionEvex); }
 
+  //! Use AVX-512 op-mask `kreg` {k} for the next instruction (AVX512+).
+  ASMJIT_INLINE This& k(const X86KReg& kreg) noexcept {
+    static_cast<This*>(this)->_extraReg.init(kreg);
+    return *static_cast<This*>(this);
+  }
   //! Use zeroing instead of merging (AVX512+).
   ASMJIT_INLINE This& z() noexcept { return _addOptions(X86Inst::kOptionZMask); }
   //! Broadcast one element to all other elements (AVX512+).
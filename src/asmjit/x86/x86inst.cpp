@@ -1236,8 +1236,8 @@ const X86Inst X86InstDB::instData[] = {
   INST(Vpbroadcastw    , VexRm_Lx           , V(660F38,79,_,x,0,0,1,T1S), 0                         , 0 , 0 , 6291, 400, 138, 0 ),
   INST(Vpclmulqdq      , VexRvmi            , V(660F3A,44,_,0,I,_,_,_  ), 0                         , 0 , 0 , 6304, 310, 140, 47),
   INST(Vpcmov          , VexRvrmRvmr_Lx     , V(XOP_M8,A2,_,x,x,_,_,_  ), 0                         , 0 , 0 , 6315, 326, 132, 0 ),
-  INST(Vpcmpb          , VexRvm_Lx          , V(660F3A,3F,_,x,_,0,4,FVM), 0                         , 0 , 0 , 6322, 401, 122, 0 ),
-  INST(Vpcmpd          , VexRvm_Lx          , V(660F3A,1F,_,x,_,0,4,FV ), 0                         , 0 , 0 , 6329, 402, 120, 0 ),
+  INST(Vpcmpb          , VexRvmi_Lx         , V(660F3A,3F,_,x,_,0,4,FVM), 0                         , 0 , 0 , 6322, 401, 122, 0 ),
+  INST(Vpcmpd          , VexRvmi_Lx         , V(660F3A,1F,_,x,_,0,4,FV ), 0                         , 0 , 0 , 6329, 402, 120, 0 ),
   INST(Vpcmpeqb        , VexRvm_Lx          , V(660F00,74,_,x,I,I,4,FV ), 0                         , 0 , 0 , 6336, 403, 137, 48),
   INST(Vpcmpeqd        , VexRvm_Lx          , V(660F00,76,_,x,I,0,4,FVM), 0                         , 0 , 0 , 6345, 404, 125, 48),
   INST(Vpcmpeqq        , VexRvm_Lx          , V(660F38,29,_,x,I,1,4,FVM), 0                         , 0 , 0 , 6354, 405, 125, 48),
@@ -1250,12 +1250,12 @@ const X86Inst X86InstDB::instData[] = {
   INST(Vpcmpgtw        , VexRvm_Lx          , V(660F00,65,_,x,I,I,4,FV ), 0                         , 0 , 0 , 6421, 403, 137, 48),
   INST(Vpcmpistri      , VexRmi             , V(660F3A,63,_,0,I,_,_,_  ), 0                         , 0 , 0 , 6430, 408, 141, 49),
   INST(Vpcmpistrm      , VexRmi             , V(660F3A,62,_,0,I,_,_,_  ), 0                         , 0 , 0 , 6441, 409, 141, 49),
-  INST(Vpcmpq          , VexRvm_Lx          , V(660F3A,1F,_,x,_,1,4,FV ), 0                         , 0 , 0 , 6452, 410, 120, 0 ),
-  INST(Vpcmpub         , VexRvm_Lx          , V(660F3A,3E,_,x,_,0,4,FVM), 0                         , 0 , 0 , 6459, 401, 122, 0 ),
-  INST(Vpcmpud         , VexRvm_Lx          , V(660F3A,1E,_,x,_,0,4,FV ), 0                         , 0 , 0 , 6467, 402, 120, 0 ),
-  INST(Vpcmpuq         , VexRvm_Lx          , V(660F3A,1E,_,x,_,1,4,FV ), 0                         , 0 , 0 , 6475, 410, 120, 0 ),
-  INST(Vpcmpuw         , VexRvm_Lx          , V(660F3A,3E,_,x,_,1,4,FVM), 0                         , 0 , 0 , 6483, 410, 122, 0 ),
-  INST(Vpcmpw          , VexRvm_Lx          , V(660F3A,3F,_,x,_,1,4,FVM), 0                         , 0 , 0 , 6491, 410, 122, 0 ),
+  INST(Vpcmpq          , VexRvmi_Lx         , V(660F3A,1F,_,x,_,1,4,FV ), 0                         , 0 , 0 , 6452, 410, 120, 0 ),
+  INST(Vpcmpub         , VexRvmi_Lx         , V(660F3A,3E,_,x,_,0,4,FVM), 0                         , 0 , 0 , 6459, 401, 122, 0 ),
+  INST(Vpcmpud         , VexRvmi_Lx         , V(660F3A,1E,_,x,_,0,4,FV ), 0                         , 0 , 0 , 6467, 402, 120, 0 ),
+  INST(Vpcmpuq         , VexRvmi_Lx         , V(660F3A,1E,_,x,_,1,4,FV ), 0                         , 0 , 0 , 6475, 410, 120, 0 ),
+  INST(Vpcmpuw         , VexRvmi_Lx         , V(660F3A,3E,_,x,_,1,4,FVM), 0                         , 0 , 0 , 6483, 410, 122, 0 ),
+  INST(Vpcmpw          , VexRvmi_Lx         , V(660F3A,3F,_,x,_,1,4,FVM), 0                         , 0 , 0 , 6491, 410, 122, 0 ),
   INST(Vpcomb          , VexRvmi            , V(XOP_M8,CC,_,0,0,_,_,_  ), 0                         , 0 , 0 , 6498, 310, 132, 0 ),
   INST(Vpcomd          , VexRvmi            , V(XOP_M8,CE,_,0,0,_,_,_  ), 0                         , 0 , 0 , 6505, 310, 132, 0 ),
   INST(Vpcompressd     , VexMr_Lx           , V(660F38,8B,_,x,_,0,2,T1S), 0                         , 0 , 0 , 6512, 279, 120, 0 ),
@@ -2751,45 +2751,158 @@ const char X86InstDB::nameData[] =
   "xtest";
 
 enum {
-  kX86InstMaxLength = 16
+  kX86InstMaxLength = 16,
+  kX86InstNameHashBuckets = 359,
+  kX86InstNameHashSize = 1435
 };
 
-struct InstNameAZ {
-  uint16_t start;
-  uint16_t end;
+static const uint16_t X86InstNameHashSeed[] = {
+  0, 3, 88, 0, 122, 12, 29, 0, 253, 0, 61, 0, 0, 6, 224, 35, 41, 11, 0, 23, 25,
+  16, 4, 7, 100, 2, 280, 0, 1, 10, 9, 41, 4, 91, 72, 1, 1, 30, 0, 34, 18, 39,
+  121, 21, 204, 2, 4, 1, 0, 0, 86, 49, 180, 0, 6, 18, 25, 41, 0, 119, 10, 53,
+  22, 31, 86, 0, 370, 228, 8, 0, 7, 246, 4, 1, 33, 60, 43, 52, 4, 128, 0, 1,
+  188, 38, 17, 22, 152, 6, 0, 312, 50, 18, 13, 106, 25, 39, 4, 0, 3, 34, 0,
+  465, 22, 22, 163, 2, 0, 3, 0, 118, 411, 96, 0, 103, 1, 0, 19, 9, 13, 219, 0,
+  75, 0, 105, 677, 3, 123, 135, 3, 30, 12, 28, 48, 0, 9, 4, 0, 0, 11, 377, 420,
+  143, 1, 288, 28, 2, 3, 26, 2, 0, 23, 757, 147, 10, 20, 180, 395, 70, 152,
+  306, 23, 4, 11, 8, 51, 0, 192, 157, 249, 168, 6, 23, 7, 26, 72, 82, 40, 562,
+  161, 268, 0, 14, 238, 0, 19, 316, 5, 53, 6, 24, 169, 12, 38, 13, 0, 17, 1,
+  1150, 52, 86, 5, 65, 3, 715, 48, 149, 770, 35, 265, 26, 38, 323, 0, 34, 0,
+  29, 69, 219, 232, 423, 14, 4, 54, 3, 53, 34, 19, 2, 347, 756, 352, 1, 72, 4,
+  7, 0, 8, 241, 0, 32, 131, 277, 19, 0, 99, 0, 75, 20, 37, 94, 236, 362, 329,
+  42, 38, 106, 120, 13, 72, 88, 64, 269, 161, 102, 40, 6, 403, 113, 18, 133,
+  123, 145, 703, 113, 27, 6, 299, 4, 1157, 372, 88, 0, 238, 13, 35, 197, 1,
+  163, 70, 760, 75, 26, 3, 652, 1694, 325, 595, 946, 7, 1301, 5, 578, 2, 7, 78,
+  0, 48, 128, 46, 13, 2, 374, 65, 10, 29, 636, 20, 2134, 369, 222, 169, 0, 192,
+  499, 1357, 5, 708, 1119, 72, 174, 5, 421, 3296, 3, 213, 22, 1572, 2749, 2,
+  140, 395, 472, 3278, 0, 2233, 2255, 538, 27, 63, 164, 1527, 10, 201, 953,
+  103, 1008, 98, 1205, 30
 };
 
-static const InstNameAZ X86InstNameAZ[26] = {
-  { X86Inst::kIdAaa       , X86Inst::kIdArpl       + 1 },
-  { X86Inst::kIdBextr     , X86Inst::kIdBzhi       + 1 },
-  { X86Inst::kIdCall      , X86Inst::kIdCwde       + 1 },
-  { X86Inst::kIdDaa       , X86Inst::kIdDpps       + 1 },
-  { X86Inst::kIdEmms      , X86Inst::kIdExtrq      + 1 },
-  { X86Inst::kIdF2xm1     , X86Inst::kIdFyl2xp1    + 1 },
-  { X86Inst::kIdNone      , X86Inst::kIdNone       + 1 },
-  { X86Inst::kIdHaddpd    , X86Inst::kIdHsubps     + 1 },
-  { X86Inst::kIdIdiv      , X86Inst::kIdIretw      + 1 },
-  { X86Inst::kIdJa        , X86Inst::kIdJz         + 1 },
-  { X86Inst::kIdKaddb     , X86Inst::kIdKxorw      + 1 },
-  { X86Inst::kIdLahf      , X86Inst::kIdLzcnt      + 1 },
-  { X86Inst::kIdMaskmovdqu, X86Inst::kIdMwait      + 1 },
-  { X86Inst::kIdNeg       , X86Inst::kIdNot        + 1 },
-  { X86Inst::kIdOr        , X86Inst::kIdOuts       + 1 },
-  { X86Inst::kIdPabsb     , X86Inst::kIdPxor       + 1 },
-  { X86Inst::kIdNone      , X86Inst::kIdNone       + 1 },
-  { X86Inst::kIdRcl       , X86Inst::kIdRsqrtss    + 1 },
-  { X86Inst::kIdSahf      , X86Inst::kIdSysret64   + 1 },
-  { X86Inst::kIdT1mskc    , X86Inst::kIdTzmsk      + 1 },
-  { X86Inst::kIdUcomisd   , X86Inst::kIdUnpcklps   + 1 },
-  { X86Inst::kIdV4fmaddps , X86Inst::kIdVzeroupper + 1 },
-  { X86Inst::kIdWbinvd    , X86Inst::kIdWrmsr      + 1 },
-  { X86Inst::kIdXabort    , X86Inst::kIdXtest      + 1 },
-  { X86Inst::kIdNone      , X86Inst::kIdNone       + 1 },
-  { X86Inst::kIdNone      , X86Inst::kIdNone       + 1 }
+static const uint16_t X86InstNameHashTable[] = {
+  1045, 426, 529, 95, 908, 191, 130, 867, 1366, 907, 487, 1317, 614, 784, 981,
+  1091, 7, 267, 746, 145, 730, 631, 1271, 859, 1031, 185, 1406, 1420, 868, 984,
+  171, 800, 272, 1087, 36, 367, 886, 455, 1206, 1257, 969, 1326, 67, 134, 114,
+  1213, 524, 1218, 314, 1333, 160, 34, 661, 1000, 366, 279, 1313, 690, 980,
+  962, 175, 1349, 1196, 1081, 965, 1358, 411, 45, 855, 1413, 405, 973, 688, 31,
+  758, 1377, 174, 129, 604, 1001, 123, 941, 499, 1168, 43, 431, 597, 459, 200,
+  71, 173, 26, 461, 207, 206, 1094, 1407, 566, 1148, 749, 515, 765, 477, 1023,
+  1019, 617, 111, 1410, 188, 186, 157, 352, 1293, 1132, 986, 905, 1117, 846,
+  424, 738, 21, 553, 172, 474, 1009, 988, 942, 1422, 179, 509, 609, 230, 874,
+  692, 510, 985, 1418, 1357, 301, 75, 670, 232, 1053, 1037, 733, 96, 454, 1121,
+  605, 76, 1217, 1093, 1305, 544, 801, 343, 1170, 506, 1089, 1135, 890, 993,
+  556, 305, 196, 9, 924, 582, 1179, 392, 155, 1173, 698, 578, 49, 275, 520,
+  1172, 1004, 333, 977, 227, 42, 342, 1138, 1295, 971, 1273, 697, 79, 810, 667,
+  1016, 384, 222, 148, 1034, 141, 547, 920, 811, 452, 326, 1086, 383, 40, 1321,
+  277, 656, 1416, 516, 1231, 152, 1236, 577, 1369, 1216, 932, 1363, 815, 168,
+  1423, 521, 57, 86, 138, 1066, 479, 1388, 453, 1396, 883, 287, 1237, 1411, 66,
+  1306, 508, 970, 646, 725, 987, 271, 528, 624, 408, 97, 839, 921, 8, 734, 143,
+  1227, 950, 934, 1131, 574, 192, 92, 823, 118, 1267, 473, 1341, 575, 400,
+  1415, 795, 1391, 522, 776, 538, 1154, 580, 445, 332, 1157, 588, 409, 1058,
+  1275, 861, 1372, 457, 966, 803, 472, 280, 181, 297, 385, 928, 726, 310, 467,
+  590, 824, 893, 1250, 832, 386, 1419, 876, 1359, 606, 740, 560, 1134, 1028,
+  30, 195, 54, 828, 1097, 504, 72, 28, 154, 63, 1162, 372, 767, 68, 1052, 1355,
+  968, 787, 1392, 645, 124, 1371, 959, 1428, 1214, 1332, 20, 1222, 1260, 348,
+  706, 486, 204, 1182, 33, 1364, 723, 535, 1159, 1286, 1215, 903, 281, 896,
+  1261, 190, 1078, 422, 60, 439, 773, 199, 540, 1253, 1211, 336, 482, 1015,
+  1169, 265, 594, 719, 107, 183, 1187, 999, 843, 1107, 1208, 358, 1199, 410,
+  293, 1100, 992, 1324, 595, 925, 349, 1368, 820, 671, 652, 447, 1065, 807,
+  686, 1424, 638, 137, 889, 718, 247, 759, 286, 377, 1123, 440, 1279, 1314,
+  808, 998, 161, 675, 878, 1328, 378, 1226, 65, 495, 44, 856, 456, 1219, 163,
+  1269, 1322, 838, 327, 220, 84, 394, 1382, 1228, 573, 1342, 1336, 468, 1146,
+  61, 1238, 1024, 176, 827, 1203, 322, 1345, 769, 935, 797, 353, 397, 1029,
+  1056, 1095, 549, 268, 1412, 551, 215, 1223, 355, 1294, 240, 434, 1315, 1386,
+  852, 1409, 995, 1038, 330, 1403, 841, 662, 1376, 29, 916, 122, 1417, 341,
+  1335, 633, 1429, 1198, 90, 198, 153, 940, 469, 115, 478, 1074, 906, 496, 37,
+  826, 1200, 911, 1298, 109, 334, 58, 710, 483, 1096, 785, 1013, 1340, 365,
+  1225, 14, 6, 892, 770, 1239, 50, 651, 927, 640, 753, 406, 834, 244, 77, 315,
+  1233, 142, 877, 1434, 194, 1191, 1263, 1114, 619, 1149, 156, 388, 612, 1337,
+  350, 625, 778, 1395, 47, 729, 819, 101, 256, 335, 147, 39, 1, 1042, 421, 736,
+  1103, 672, 1057, 4, 991, 446, 87, 1020, 444, 1192, 158, 1003, 427, 243, 786,
+  1408, 24, 246, 12, 73, 471, 960, 127, 476, 419, 665, 359, 1384, 1063, 1139,
+  93, 581, 395, 1362, 1144, 530, 260, 1195, 644, 1248, 269, 1108, 379, 311,
+  1320, 298, 739, 866, 1421, 202, 1374, 976, 344, 414, 955, 164, 131, 720, 850,
+  396, 208, 611, 533, 1026, 623, 1181, 1112, 435, 1234, 946, 953, 534, 1373,
+  149, 885, 132, 490, 816, 796, 81, 714, 373, 511, 441, 329, 32, 1383, 592,
+  621, 259, 1312, 1327, 705, 756, 1202, 1400, 825, 684, 237, 1378, 110, 211,
+  615, 860, 1268, 1291, 1163, 368, 772, 673, 449, 201, 389, 853, 187, 554,
+  1288, 1167, 91, 494, 1370, 1040, 460, 391, 717, 1379, 1145, 814, 813, 517,
+  967, 1143, 742, 380, 1079, 357, 463, 1044, 1128, 484, 989, 755, 1221, 500,
+  576, 818, 1104, 1030, 957, 245, 1083, 812, 552, 78, 231, 947, 978, 390, 565,
+  10, 1394, 264, 766, 346, 151, 591, 798, 780, 80, 1152, 1059, 1351, 842, 711,
+  239, 363, 997, 1287, 303, 1246, 557, 125, 641, 1343, 762, 771, 996, 425, 393,
+  704, 1278, 600, 1346, 745, 1249, 1043, 1381, 568, 926, 616, 596, 1425, 982,
+  587, 17, 923, 1224, 963, 1390, 221, 18, 904, 15, 1360, 954, 1119, 830, 848,
+  250, 961, 501, 1010, 527, 757, 212, 1242, 653, 914, 1380, 266, 1281, 550,
+  603, 340, 19, 722, 309, 184, 1402, 83, 525, 643, 420, 177, 1067, 470, 628,
+  1350, 55, 930, 1210, 436, 241, 1180, 763, 546, 1330, 1232, 1229, 1076, 902,
+  936, 442, 290, 3, 1207, 1164, 288, 370, 312, 1431, 356, 727, 1426, 284, 219,
+  663, 104, 804, 1251, 1039, 775, 979, 85, 1259, 862, 1082, 1435, 1041, 1334,
+  1073, 347, 1061, 302, 209, 1241, 541, 399, 1189, 635, 1122, 38, 1397, 401,
+  513, 1125, 676, 458, 669, 949, 543, 844, 1300, 683, 1254, 990, 1205, 608,
+  1098, 1165, 1142, 915, 1272, 217, 1033, 589, 1235, 105, 585, 1062, 1339, 253,
+  1185, 262, 416, 1399, 139, 74, 701, 1025, 840, 894, 251, 1276, 735, 133,
+  1176, 1433, 1118, 88, 792, 1055, 900, 938, 974, 1021, 1301, 313, 261, 789,
+  891, 716, 1027, 255, 863, 922, 702, 413, 1101, 64, 1256, 693, 1344, 1116,
+  754, 760, 1140, 1347, 273, 899, 747, 737, 875, 895, 150, 709, 1308, 610, 276,
+  994, 112, 223, 700, 1147, 166, 1282, 721, 748, 235, 880, 216, 248, 180, 929,
+  1113, 782, 108, 607, 1184, 1304, 1049, 805, 1110, 480, 1120, 724, 462, 117,
+  558, 466, 225, 1105, 1127, 437, 629, 627, 572, 1427, 398, 214, 1099, 682,
+  679, 492, 1092, 919, 99, 1389, 659, 433, 933, 972, 475, 491, 1080, 505, 822,
+  873, 559, 159, 744, 481, 647, 1008, 351, 1126, 338, 169, 295, 1404, 1047,
+  912, 708, 1160, 681, 226, 387, 48, 790, 1316, 1318, 1283, 362, 602, 1266,
+  258, 1109, 654, 339, 571, 126, 135, 639, 1243, 485, 944, 563, 531, 774, 1051,
+  1175, 307, 1252, 294, 1115, 35, 666, 649, 793, 707, 229, 837, 11, 89, 1064,
+  579, 52, 1022, 1136, 687, 62, 713, 1398, 193, 100, 835, 51, 593, 781, 695,
+  1090, 428, 1212, 25, 1354, 1048, 23, 858, 197, 1323, 931, 1299, 1171, 1186,
+  423, 518, 788, 46, 779, 274, 308, 1166, 503, 1161, 680, 1247, 82, 898, 375,
+  16, 869, 658, 228, 1201, 884, 381, 236, 1197, 318, 233, 618, 1414, 1177,
+  1194, 53, 1387, 956, 685, 1319, 162, 121, 300, 1072, 1220, 304, 1244, 270,
+  144, 732, 120, 1367, 1296, 567, 507, 94, 945, 562, 404, 668, 234, 296, 847,
+  102, 913, 836, 98, 1077, 140, 369, 1156, 857, 570, 1325, 901, 632, 205, 106,
+  417, 254, 1036, 1046, 519, 536, 1005, 1151, 361, 620, 872, 407, 845, 1137,
+  345, 918, 752, 1050, 282, 328, 1262, 821, 678, 238, 637, 1375, 116, 626,
+  1274, 1265, 664, 1011, 1280, 291, 1178, 5, 764, 677, 285, 1018, 354, 1303,
+  917, 829, 203, 324, 542, 777, 802, 1141, 178, 317, 382, 59, 1430, 1307, 1309,
+  319, 1245, 1155, 119, 715, 488, 465, 1188, 958, 376, 1204, 761, 41, 691,
+  1017, 1088, 937, 870, 879, 1302, 252, 523, 1035, 689, 1153, 864, 1174, 854,
+  806, 210, 539, 1329, 218, 263, 1285, 1356, 1264, 599, 584, 1084, 1401, 1290,
+  1014, 1348, 1209, 289, 696, 634, 1133, 146, 1240, 1130, 464, 374, 768, 13,
+  630, 1331, 699, 56, 429, 650, 799, 1032, 498, 657, 415, 418, 751, 1190, 182,
+  882, 1270, 1102, 278, 887, 1071, 70, 1012, 1297, 283, 1361, 1385, 170, 1129,
+  849, 514, 1124, 613, 881, 1310, 939, 1111, 1006, 555, 1069, 943, 622, 731,
+  1054, 655, 299, 69, 316, 561, 964, 292, 897, 321, 451, 703, 794, 1352, 103,
+  489, 583, 1284, 1075, 1258, 189, 1193, 1311, 728, 694, 1277, 430, 165, 1255,
+  569, 1158, 331, 537, 948, 323, 438, 871, 1150, 1338, 443, 983, 833, 564, 532,
+  674, 402, 412, 1106, 360, 783, 1068, 601, 831, 1289, 642, 1353, 448, 320,
+  851, 1060, 128, 952, 817, 167, 337, 1393, 888, 636, 526, 1230, 502, 1405,
+  548, 791, 364, 2, 1070, 648, 242, 113, 136, 22, 403, 545, 497, 1292, 586,
+  1007, 306, 493, 224, 257, 371, 660, 325, 975, 512, 1183, 743, 750, 1432, 865,
+  951, 432, 450, 27, 213, 712, 909, 598, 809, 1365, 910, 741, 249, 1002, 1085
 };
 // ----------------------------------------------------------------------------
 // ${nameData:End}
 
+//! \internal
+//!
+//! Hash an instruction name, must match `NameHash.hash()` in `generate-base.js`.
+static ASMJIT_INLINE uint32_t X86InstNameHash(const char* name, size_t len) noexcept {
+  uint32_t hVal = 0x811C9DC5U;
+  for (size_t i = 0; i < len; i++)
+    hVal = (hVal ^ static_cast<uint8_t>(name[i])) * 0x01000193U;
+  return hVal;
+}
+
+//! \internal
+//!
+//! Mix a name hash with a bucket seed, must match `NameHash.mix()` in `generate-base.js`.
+static ASMJIT_INLINE uint32_t X86InstNameMix(uint32_t hVal, uint32_t seed) noexcept {
+  hVal ^= seed;
+  hVal = (hVal ^ (hVal >> 16)) * 0x85EBCA6BU;
+  hVal = (hVal ^ (hVal >> 13)) * 0xC2B2AE35U;
+  return hVal ^ (hVal >> 16);
+}
+
 uint32_t X86Inst::getIdByName(const char* name, size_t len) noexcept {
   if (ASMJIT_UNLIKELY(!name))
     return Inst::kIdNone;
@@ -2800,37 +2913,17 @@ uint32_t X86Inst::getIdByName(const char* name, size_t len) noexcept {
   if (ASMJIT_UNLIKELY(len == 0 || len > kX86InstMaxLength))
     return Inst::kIdNone;
 
-  uint32_t prefix = static_cast<uint32_t>(name[0]) - 'a';
-  if (ASMJIT_UNLIKELY(prefix > 'z' - 'a'))
-    return Inst::kIdNone;
-
-  uint32_t index = X86InstNameAZ[prefix].start;
-  if (ASMJIT_UNLIKELY(!index))
-    return Inst::kIdNone;
+  // Minimal perfect hash - the bucket's seed selects a slot that is unique to
+  // the name, so a single compare tells whether the name is known.
+  uint32_t hVal = X86InstNameHash(name, len);
+  uint32_t seed = X86InstNameHashSeed[hVal % kX86InstNameHashBuckets];
+  uint32_t id = X86InstNameHashTable[X86InstNameMix(hVal, seed) % kX86InstNameHashSize];
 
   const char* nameData = X86InstDB::nameData;
-  const X86Inst* instData = X86InstDB::instData;
-
-  const X86Inst* base = instData + index;
-  const X86Inst* end  = instData + X86InstNameAZ[prefix].end;
-
-  for (size_t lim = (size_t)(end - base); lim != 0; lim >>= 1) {
-    const X86Inst* cur = base + (lim >> 1);
-    int result = Utils::cmpInstName(nameData + cur[0].getNameDataIndex(), name, len);
-
-    if (result < 0) {
-      base = cur + 1;
-      lim--;
-      continue;
-    }
-
-    if (result > 0)
-      continue;
-
-    return static_cast<uint32_t>((size_t)(cur - instData));
-  }
+  if (Utils::cmpInstName(nameData + X86InstDB::instData[id].getNameDataIndex(), name, len) != 0)
+    return Inst::kIdNone;
 
-  return Inst::kIdNone;
+  return id;
 }
 
 const char* X86Inst::getNameById(uint32_t id) noexcept {
@@ -3642,6 +3735,622 @@ const X86Inst::ISignature X86InstDB::iSignatureData[] = {
 // ${signatureData:End}
 #endif // !ASMJIT_DISABLE_VALIDATION
 
+// ============================================================================
+// [asmjit::X86Inst - Cost]
+// ============================================================================
+
+#if !defined(ASMJIT_DISABLE_COST_MODEL)
+// ${costData:Begin}
+// ------------------- Automatically generated, do not edit -------------------
+const X86Inst::Cost X86InstDB::costData[] = {
+  { 1 , 1 , 25   }, // #0
+  { 6 , 1 , 50   }, // #1
+  { 5 , 1 , 50   }, // #2
+  { 6 , 2 , 100  }, // #3
+  { 7 , 3 , 100  }, // #4
+  { 7 , 2 , 100  }, // #5
+  { 4 , 1 , 50   }, // #6
+  { 1 , 1 , 100  }, // #7
+  { 1 , 1 , 50   }, // #8
+  { 3 , 1 , 100  }, // #9
+  { 8 , 1 , 100  }, // #10
+  { 7 , 1 , 100  }, // #11
+  { 7 , 1 , 50   }, // #12
+  { 4 , 1 , 100  }, // #13
+  { 3 , 1 , 50   }, // #14
+  { 10, 1 , 100  }, // #15
+  { 9 , 1 , 100  }, // #16
+  { 10, 1 , 50   }, // #17
+  { 8 , 1 , 50   }, // #18
+  { 11, 1 , 50   }, // #19
+  { 12, 1 , 50   }, // #20
+  { 13, 1 , 700  }, // #21
+  { 11, 1 , 300  }, // #22
+  { 10, 1 , 300  }, // #23
+  { 19, 1 , 700  }, // #24
+  { 17, 1 , 300  }, // #25
+  { 20, 1 , 1400 }, // #26
+  { 14, 1 , 400  }, // #27
+  { 13, 1 , 400  }, // #28
+  { 26, 1 , 1400 }, // #29
+  { 20, 1 , 400  }, // #30
+  { 14, 1 , 700  }, // #31
+  { 11, 1 , 700  }, // #32
+  { 12, 1 , 300  }, // #33
+  { 14, 1 , 500  }, // #34
+  { 21, 1 , 700  }, // #35
+  { 17, 1 , 700  }, // #36
+  { 18, 1 , 300  }, // #37
+  { 21, 1 , 500  }, // #38
+  { 20, 1 , 800  }, // #39
+  { 16, 1 , 800  }, // #40
+  { 18, 1 , 600  }, // #41
+  { 27, 1 , 800  }, // #42
+  { 22, 1 , 800  }, // #43
+  { 24, 1 , 600  }, // #44
+  { 11, 1 , 100  }, // #45
+  { 1 , 1 , 33   }, // #46
+  { 5 , 1 , 100  }, // #47
+  { 10, 2 , 100  }, // #48
+  { 16, 2 , 100  }  // #49
+};
+
+#define FORM(F) X86Inst::kCostForm##F
+const X86Inst::CostEntry X86InstDB::costEntryData[] = {
+  { X86Inst::kIdAdd             , FORM(RR), 0, { 0 , 0 , 0 , 0  } },
+  { X86Inst::kIdAdd             , FORM(RM), 0, { 1 , 2 , 1 , 2  } },
+  { X86Inst::kIdAdd             , FORM(MR), 0, { 3 , 3 , 3 , 3  } },
+  { X86Inst::kIdAddpd           , FORM(RR), 0, { 13, 9 , 6 , 14 } },
+  { X86Inst::kIdAddpd           , FORM(RM), 0, { 15, 16, 17, 17 } },
+  { X86Inst::kIdAddps           , FORM(RR), 0, { 13, 9 , 6 , 14 } },
+  { X86Inst::kIdAddps           , FORM(RM), 0, { 15, 16, 17, 17 } },
+  { X86Inst::kIdAddsd           , FORM(RR), 0, { 13, 9 , 6 , 14 } },
+  { X86Inst::kIdAddsd           , FORM(RM), 0, { 15, 16, 17, 17 } },
+  { X86Inst::kIdAddss           , FORM(RR), 0, { 13, 9 , 6 , 14 } },
+  { X86Inst::kIdAddss           , FORM(RM), 0, { 15, 16, 17, 17 } },
+  { X86Inst::kIdAnd             , FORM(RR), 0, { 0 , 0 , 0 , 0  } },
+  { X86Inst::kIdAnd             , FORM(RM), 0, { 1 , 2 , 1 , 2  } },
+  { X86Inst::kIdAnd             , FORM(MR), 0, { 3 , 3 , 3 , 3  } },
+  { X86Inst::kIdCmp             , FORM(RR), 0, { 0 , 0 , 0 , 0  } },
+  { X86Inst::kIdCmp             , FORM(RM), 0, { 1 , 2 , 1 , 2  } },
+  { X86Inst::kIdCvtdq2ps        , FORM(RR), 0, { 13, 9 , 6 , 13 } },
+  { X86Inst::kIdCvtdq2ps        , FORM(RM), 0, { 45, 16, 17, 45 } },
+  { X86Inst::kIdCvtps2dq        , FORM(RR), 0, { 13, 9 , 6 , 13 } },
+  { X86Inst::kIdCvtps2dq        , FORM(RM), 0, { 45, 16, 17, 45 } },
+  { X86Inst::kIdCvttps2dq       , FORM(RR), 0, { 13, 9 , 6 , 13 } },
+  { X86Inst::kIdCvttps2dq       , FORM(RM), 0, { 45, 16, 17, 45 } },
+  { X86Inst::kIdDec             , FORM(RR), 0, { 0 , 0 , 0 , 0  } },
+  { X86Inst::kIdDec             , FORM(RM), 0, { 1 , 2 , 1 , 2  } },
+  { X86Inst::kIdDec             , FORM(MR), 0, { 4 , 4 , 4 , 5  } },
+  { X86Inst::kIdDivpd           , FORM(RR), 0, { 26, 26, 27, 28 } },
+  { X86Inst::kIdDivpd           , FORM(RM), 0, { 29, 29, 30, 30 } },
+  { X86Inst::kIdDivps           , FORM(RR), 0, { 21, 21, 22, 23 } },
+  { X86Inst::kIdDivps           , FORM(RM), 0, { 24, 24, 25, 25 } },
+  { X86Inst::kIdDivsd           , FORM(RR), 0, { 26, 26, 27, 28 } },
+  { X86Inst::kIdDivsd           , FORM(RM), 0, { 29, 29, 30, 30 } },
+  { X86Inst::kIdDivss           , FORM(RR), 0, { 21, 21, 22, 23 } },
+  { X86Inst::kIdDivss           , FORM(RM), 0, { 24, 24, 25, 25 } },
+  { X86Inst::kIdImul            , FORM(RR), 0, { 9 , 9 , 9 , 9  } },
+  { X86Inst::kIdImul            , FORM(RM), 0, { 10, 11, 10, 11 } },
+  { X86Inst::kIdInc             , FORM(RR), 0, { 0 , 0 , 0 , 0  } },
+  { X86Inst::kIdInc             , FORM(RM), 0, { 1 , 2 , 1 , 2  } },
+  { X86Inst::kIdInc             , FORM(MR), 0, { 4 , 4 , 4 , 5  } },
+  { X86Inst::kIdLea             , FORM(RM), 0, { 8 , 8 , 8 , 0  } },
+  { X86Inst::kIdLzcnt           , FORM(RR), 0, { 9 , 9 , 9 , 0  } },
+  { X86Inst::kIdLzcnt           , FORM(RM), 0, { 10, 11, 10, 2  } },
+  { X86Inst::kIdMaxpd           , FORM(RR), 0, { 13, 9 , 6 , 8  } },
+  { X86Inst::kIdMaxpd           , FORM(RM), 0, { 15, 16, 17, 18 } },
+  { X86Inst::kIdMaxps           , FORM(RR), 0, { 13, 9 , 6 , 8  } },
+  { X86Inst::kIdMaxps           , FORM(RM), 0, { 15, 16, 17, 18 } },
+  { X86Inst::kIdMaxsd           , FORM(RR), 0, { 13, 9 , 6 , 8  } },
+  { X86Inst::kIdMaxsd           , FORM(RM), 0, { 15, 16, 17, 18 } },
+  { X86Inst::kIdMaxss           , FORM(RR), 0, { 13, 9 , 6 , 8  } },
+  { X86Inst::kIdMaxss           , FORM(RM), 0, { 15, 16, 17, 18 } },
+  { X86Inst::kIdMinpd           , FORM(RR), 0, { 13, 9 , 6 , 8  } },
+  { X86Inst::kIdMinpd           , FORM(RM), 0, { 15, 16, 17, 18 } },
+  { X86Inst::kIdMinps           , FORM(RR), 0, { 13, 9 , 6 , 8  } },
+  { X86Inst::kIdMinps           , FORM(RM), 0, { 15, 16, 17, 18 } },
+  { X86Inst::kIdMinsd           , FORM(RR), 0, { 13, 9 , 6 , 8  } },
+  { X86Inst::kIdMinsd           , FORM(RM), 0, { 15, 16, 17, 18 } },
+  { X86Inst::kIdMinss           , FORM(RR), 0, { 13, 9 , 6 , 8  } },
+  { X86Inst::kIdMinss           , FORM(RM), 0, { 15, 16, 17, 18 } },
+  { X86Inst::kIdMov             , FORM(RR), 0, { 0 , 0 , 0 , 0  } },
+  { X86Inst::kIdMov             , FORM(RM), 0, { 2 , 6 , 2 , 6  } },
+  { X86Inst::kIdMov             , FORM(MR), 0, { 7 , 7 , 7 , 7  } },
+  { X86Inst::kIdMovapd          , FORM(RR), 0, { 0 , 0 , 0 , 0  } },
+  { X86Inst::kIdMovapd          , FORM(RM), 0, { 12, 1 , 1 , 12 } },
+  { X86Inst::kIdMovapd          , FORM(MR), 0, { 7 , 7 , 7 , 7  } },
+  { X86Inst::kIdMovaps          , FORM(RR), 0, { 0 , 0 , 0 , 0  } },
+  { X86Inst::kIdMovaps          , FORM(RM), 0, { 12, 1 , 1 , 12 } },
+  { X86Inst::kIdMovaps          , FORM(MR), 0, { 7 , 7 , 7 , 7  } },
+  { X86Inst::kIdMovdqa          , FORM(RR), 0, { 0 , 0 , 0 , 0  } },
+  { X86Inst::kIdMovdqa          , FORM(RM), 0, { 12, 1 , 1 , 12 } },
+  { X86Inst::kIdMovdqa          , FORM(MR), 0, { 7 , 7 , 7 , 7  } },
+  { X86Inst::kIdMovdqu          , FORM(RR), 0, { 0 , 0 , 0 , 0  } },
+  { X86Inst::kIdMovdqu          , FORM(RM), 0, { 12, 1 , 1 , 12 } },
+  { X86Inst::kIdMovdqu          , FORM(MR), 0, { 7 , 7 , 7 , 7  } },
+  { X86Inst::kIdMovupd          , FORM(RR), 0, { 0 , 0 , 0 , 0  } },
+  { X86Inst::kIdMovupd          , FORM(RM), 0, { 12, 1 , 1 , 12 } },
+  { X86Inst::kIdMovupd          , FORM(MR), 0, { 7 , 7 , 7 , 7  } },
+  { X86Inst::kIdMovups          , FORM(RR), 0, { 0 , 0 , 0 , 0  } },
+  { X86Inst::kIdMovups          , FORM(RM), 0, { 12, 1 , 1 , 12 } },
+  { X86Inst::kIdMovups          , FORM(MR), 0, { 7 , 7 , 7 , 7  } },
+  { X86Inst::kIdMulpd           , FORM(RR), 0, { 2 , 2 , 6 , 14 } },
+  { X86Inst::kIdMulpd           , FORM(RM), 0, { 19, 19, 17, 17 } },
+  { X86Inst::kIdMulps           , FORM(RR), 0, { 2 , 2 , 6 , 14 } },
+  { X86Inst::kIdMulps           , FORM(RM), 0, { 19, 19, 17, 17 } },
+  { X86Inst::kIdMulsd           , FORM(RR), 0, { 2 , 2 , 6 , 14 } },
+  { X86Inst::kIdMulsd           , FORM(RM), 0, { 19, 19, 17, 17 } },
+  { X86Inst::kIdMulss           , FORM(RR), 0, { 2 , 2 , 6 , 14 } },
+  { X86Inst::kIdMulss           , FORM(RM), 0, { 19, 19, 17, 17 } },
+  { X86Inst::kIdNeg             , FORM(RR), 0, { 0 , 0 , 0 , 0  } },
+  { X86Inst::kIdNeg             , FORM(RM), 0, { 1 , 2 , 1 , 2  } },
+  { X86Inst::kIdNeg             , FORM(MR), 0, { 4 , 4 , 4 , 5  } },
+  { X86Inst::kIdNot             , FORM(RR), 0, { 0 , 0 , 0 , 0  } },
+  { X86Inst::kIdNot             , FORM(RM), 0, { 1 , 2 , 1 , 2  } },
+  { X86Inst::kIdNot             , FORM(MR), 0, { 4 , 4 , 4 , 5  } },
+  { X86Inst::kIdOr              , FORM(RR), 0, { 0 , 0 , 0 , 0  } },
+  { X86Inst::kIdOr              , FORM(RM), 0, { 1 , 2 , 1 , 2  } },
+  { X86Inst::kIdOr              , FORM(MR), 0, { 3 , 3 , 3 , 3  } },
+  { X86Inst::kIdPaddb           , FORM(RR), 0, { 8 , 8 , 46, 0  } },
+  { X86Inst::kIdPaddb           , FORM(RM), 0, { 18, 12, 12, 18 } },
+  { X86Inst::kIdPaddd           , FORM(RR), 0, { 8 , 8 , 46, 0  } },
+  { X86Inst::kIdPaddd           , FORM(RM), 0, { 18, 12, 12, 18 } },
+  { X86Inst::kIdPaddq           , FORM(RR), 0, { 8 , 8 , 46, 0  } },
+  { X86Inst::kIdPaddq           , FORM(RM), 0, { 18, 12, 12, 18 } },
+  { X86Inst::kIdPaddw           , FORM(RR), 0, { 8 , 8 , 46, 0  } },
+  { X86Inst::kIdPaddw           , FORM(RM), 0, { 18, 12, 12, 18 } },
+  { X86Inst::kIdPand            , FORM(RR), 0, { 8 , 8 , 46, 0  } },
+  { X86Inst::kIdPand            , FORM(RM), 0, { 18, 12, 12, 18 } },
+  { X86Inst::kIdPandn           , FORM(RR), 0, { 8 , 8 , 46, 0  } },
+  { X86Inst::kIdPandn           , FORM(RM), 0, { 18, 12, 12, 18 } },
+  { X86Inst::kIdPcmpeqb         , FORM(RR), 0, { 8 , 8 , 46, 0  } },
+  { X86Inst::kIdPcmpeqb         , FORM(RM), 0, { 18, 12, 12, 18 } },
+  { X86Inst::kIdPcmpeqd         , FORM(RR), 0, { 8 , 8 , 46, 0  } },
+  { X86Inst::kIdPcmpeqd         , FORM(RM), 0, { 18, 12, 12, 18 } },
+  { X86Inst::kIdPcmpeqw         , FORM(RR), 0, { 8 , 8 , 46, 0  } },
+  { X86Inst::kIdPcmpeqw         , FORM(RM), 0, { 18, 12, 12, 18 } },
+  { X86Inst::kIdPcmpgtb         , FORM(RR), 0, { 8 , 8 , 46, 0  } },
+  { X86Inst::kIdPcmpgtb         , FORM(RM), 0, { 18, 12, 12, 18 } },
+  { X86Inst::kIdPcmpgtd         , FORM(RR), 0, { 8 , 8 , 46, 0  } },
+  { X86Inst::kIdPcmpgtd         , FORM(RM), 0, { 18, 12, 12, 18 } },
+  { X86Inst::kIdPcmpgtw         , FORM(RR), 0, { 8 , 8 , 46, 0  } },
+  { X86Inst::kIdPcmpgtw         , FORM(RM), 0, { 18, 12, 12, 18 } },
+  { X86Inst::kIdPmaddwd         , FORM(RR), 0, { 47, 47, 2 , 9  } },
+  { X86Inst::kIdPmaddwd         , FORM(RM), 0, { 45, 45, 19, 15 } },
+  { X86Inst::kIdPmuldq          , FORM(RR), 0, { 47, 47, 2 , 9  } },
+  { X86Inst::kIdPmuldq          , FORM(RM), 0, { 45, 45, 19, 15 } },
+  { X86Inst::kIdPmulhuw         , FORM(RR), 0, { 47, 47, 2 , 9  } },
+  { X86Inst::kIdPmulhuw         , FORM(RM), 0, { 45, 45, 19, 15 } },
+  { X86Inst::kIdPmulhw          , FORM(RR), 0, { 47, 47, 2 , 9  } },
+  { X86Inst::kIdPmulhw          , FORM(RM), 0, { 45, 45, 19, 15 } },
+  { X86Inst::kIdPmulld          , FORM(RR), 0, { 48, 48, 48, 13 } },
+  { X86Inst::kIdPmulld          , FORM(RM), 0, { 49, 49, 49, 45 } },
+  { X86Inst::kIdPmullw          , FORM(RR), 0, { 47, 47, 2 , 9  } },
+  { X86Inst::kIdPmullw          , FORM(RM), 0, { 45, 45, 19, 15 } },
+  { X86Inst::kIdPmuludq         , FORM(RR), 0, { 47, 47, 2 , 9  } },
+  { X86Inst::kIdPmuludq         , FORM(RM), 0, { 45, 45, 19, 15 } },
+  { X86Inst::kIdPopcnt          , FORM(RR), 0, { 9 , 9 , 9 , 0  } },
+  { X86Inst::kIdPopcnt          , FORM(RM), 0, { 10, 11, 10, 2  } },
+  { X86Inst::kIdPor             , FORM(RR), 0, { 8 , 8 , 46, 0  } },
+  { X86Inst::kIdPor             , FORM(RM), 0, { 18, 12, 12, 18 } },
+  { X86Inst::kIdPshufb          , FORM(RR), 0, { 7 , 7 , 7 , 8  } },
+  { X86Inst::kIdPshufb          , FORM(RM), 0, { 10, 11, 11, 18 } },
+  { X86Inst::kIdPshufd          , FORM(RR), 0, { 7 , 7 , 7 , 8  } },
+  { X86Inst::kIdPshufd          , FORM(RM), 0, { 10, 11, 11, 18 } },
+  { X86Inst::kIdPsubb           , FORM(RR), 0, { 8 , 8 , 46, 0  } },
+  { X86Inst::kIdPsubb           , FORM(RM), 0, { 18, 12, 12, 18 } },
+  { X86Inst::kIdPsubd           , FORM(RR), 0, { 8 , 8 , 46, 0  } },
+  { X86Inst::kIdPsubd           , FORM(RM), 0, { 18, 12, 12, 18 } },
+  { X86Inst::kIdPsubq           , FORM(RR), 0, { 8 , 8 , 46, 0  } },
+  { X86Inst::kIdPsubq           , FORM(RM), 0, { 18, 12, 12, 18 } },
+  { X86Inst::kIdPsubw           , FORM(RR), 0, { 8 , 8 , 46, 0  } },
+  { X86Inst::kIdPsubw           , FORM(RM), 0, { 18, 12, 12, 18 } },
+  { X86Inst::kIdPunpckhbw       , FORM(RR), 0, { 7 , 7 , 7 , 8  } },
+  { X86Inst::kIdPunpckhbw       , FORM(RM), 0, { 10, 11, 11, 18 } },
+  { X86Inst::kIdPunpckhdq       , FORM(RR), 0, { 7 , 7 , 7 , 8  } },
+  { X86Inst::kIdPunpckhdq       , FORM(RM), 0, { 10, 11, 11, 18 } },
+  { X86Inst::kIdPunpckhqdq      , FORM(RR), 0, { 7 , 7 , 7 , 8  } },
+  { X86Inst::kIdPunpckhqdq      , FORM(RM), 0, { 10, 11, 11, 18 } },
+  { X86Inst::kIdPunpckhwd       , FORM(RR), 0, { 7 , 7 , 7 , 8  } },
+  { X86Inst::kIdPunpckhwd       , FORM(RM), 0, { 10, 11, 11, 18 } },
+  { X86Inst::kIdPunpcklbw       , FORM(RR), 0, { 7 , 7 , 7 , 8  } },
+  { X86Inst::kIdPunpcklbw       , FORM(RM), 0, { 10, 11, 11, 18 } },
+  { X86Inst::kIdPunpckldq       , FORM(RR), 0, { 7 , 7 , 7 , 8  } },
+  { X86Inst::kIdPunpckldq       , FORM(RM), 0, { 10, 11, 11, 18 } },
+  { X86Inst::kIdPunpcklqdq      , FORM(RR), 0, { 7 , 7 , 7 , 8  } },
+  { X86Inst::kIdPunpcklqdq      , FORM(RM), 0, { 10, 11, 11, 18 } },
+  { X86Inst::kIdPunpcklwd       , FORM(RR), 0, { 7 , 7 , 7 , 8  } },
+  { X86Inst::kIdPunpcklwd       , FORM(RM), 0, { 10, 11, 11, 18 } },
+  { X86Inst::kIdPxor            , FORM(RR), 0, { 8 , 8 , 46, 0  } },
+  { X86Inst::kIdPxor            , FORM(RM), 0, { 18, 12, 12, 18 } },
+  { X86Inst::kIdRol             , FORM(RR), 0, { 8 , 8 , 8 , 0  } },
+  { X86Inst::kIdRol             , FORM(RM), 0, { 1 , 2 , 1 , 2  } },
+  { X86Inst::kIdRor             , FORM(RR), 0, { 8 , 8 , 8 , 0  } },
+  { X86Inst::kIdRor             , FORM(RM), 0, { 1 , 2 , 1 , 2  } },
+  { X86Inst::kIdSar             , FORM(RR), 0, { 8 , 8 , 8 , 0  } },
+  { X86Inst::kIdSar             , FORM(RM), 0, { 1 , 2 , 1 , 2  } },
+  { X86Inst::kIdShl             , FORM(RR), 0, { 8 , 8 , 8 , 0  } },
+  { X86Inst::kIdShl             , FORM(RM), 0, { 1 , 2 , 1 , 2  } },
+  { X86Inst::kIdShr             , FORM(RR), 0, { 8 , 8 , 8 , 0  } },
+  { X86Inst::kIdShr             , FORM(RM), 0, { 1 , 2 , 1 , 2  } },
+  { X86Inst::kIdShufpd          , FORM(RR), 0, { 7 , 7 , 7 , 8  } },
+  { X86Inst::kIdShufpd          , FORM(RM), 0, { 10, 11, 11, 18 } },
+  { X86Inst::kIdShufps          , FORM(RR), 0, { 7 , 7 , 7 , 8  } },
+  { X86Inst::kIdShufps          , FORM(RM), 0, { 10, 11, 11, 18 } },
+  { X86Inst::kIdSqrtpd          , FORM(RR), 0, { 39, 40, 41, 39 } },
+  { X86Inst::kIdSqrtpd          , FORM(RM), 0, { 42, 43, 44, 42 } },
+  { X86Inst::kIdSqrtps          , FORM(RR), 0, { 31, 32, 33, 34 } },
+  { X86Inst::kIdSqrtps          , FORM(RM), 0, { 35, 36, 37, 38 } },
+  { X86Inst::kIdSqrtsd          , FORM(RR), 0, { 39, 40, 41, 39 } },
+  { X86Inst::kIdSqrtsd          , FORM(RM), 0, { 42, 43, 44, 42 } },
+  { X86Inst::kIdSqrtss          , FORM(RR), 0, { 31, 32, 33, 34 } },
+  { X86Inst::kIdSqrtss          , FORM(RM), 0, { 35, 36, 37, 38 } },
+  { X86Inst::kIdSub             , FORM(RR), 0, { 0 , 0 , 0 , 0  } },
+  { X86Inst::kIdSub             , FORM(RM), 0, { 1 , 2 , 1 , 2  } },
+  { X86Inst::kIdSub             , FORM(MR), 0, { 3 , 3 , 3 , 3  } },
+  { X86Inst::kIdSubpd           , FORM(RR), 0, { 13, 9 , 6 , 14 } },
+  { X86Inst::kIdSubpd           , FORM(RM), 0, { 15, 16, 17, 17 } },
+  { X86Inst::kIdSubps           , FORM(RR), 0, { 13, 9 , 6 , 14 } },
+  { X86Inst::kIdSubps           , FORM(RM), 0, { 15, 16, 17, 17 } },
+  { X86Inst::kIdSubsd           , FORM(RR), 0, { 13, 9 , 6 , 14 } },
+  { X86Inst::kIdSubsd           , FORM(RM), 0, { 15, 16, 17, 17 } },
+  { X86Inst::kIdSubss           , FORM(RR), 0, { 13, 9 , 6 , 14 } },
+  { X86Inst::kIdSubss           , FORM(RM), 0, { 15, 16, 17, 17 } },
+  { X86Inst::kIdTest            , FORM(RR), 0, { 0 , 0 , 0 , 0  } },
+  { X86Inst::kIdTest            , FORM(RM), 0, { 1 , 2 , 1 , 2  } },
+  { X86Inst::kIdTzcnt           , FORM(RR), 0, { 9 , 9 , 9 , 0  } },
+  { X86Inst::kIdTzcnt           , FORM(RM), 0, { 10, 11, 10, 2  } },
+  { X86Inst::kIdUnpckhpd        , FORM(RR), 0, { 7 , 7 , 7 , 8  } },
+  { X86Inst::kIdUnpckhpd        , FORM(RM), 0, { 10, 11, 11, 18 } },
+  { X86Inst::kIdUnpckhps        , FORM(RR), 0, { 7 , 7 , 7 , 8  } },
+  { X86Inst::kIdUnpckhps        , FORM(RM), 0, { 10, 11, 11, 18 } },
+  { X86Inst::kIdUnpcklpd        , FORM(RR), 0, { 7 , 7 , 7 , 8  } },
+  { X86Inst::kIdUnpcklpd        , FORM(RM), 0, { 10, 11, 11, 18 } },
+  { X86Inst::kIdUnpcklps        , FORM(RR), 0, { 7 , 7 , 7 , 8  } },
+  { X86Inst::kIdUnpcklps        , FORM(RM), 0, { 10, 11, 11, 18 } },
+  { X86Inst::kIdVaddpd          , FORM(RR), 0, { 13, 9 , 6 , 14 } },
+  { X86Inst::kIdVaddpd          , FORM(RM), 0, { 15, 16, 17, 17 } },
+  { X86Inst::kIdVaddps          , FORM(RR), 0, { 13, 9 , 6 , 14 } },
+  { X86Inst::kIdVaddps          , FORM(RM), 0, { 15, 16, 17, 17 } },
+  { X86Inst::kIdVaddsd          , FORM(RR), 0, { 13, 9 , 6 , 14 } },
+  { X86Inst::kIdVaddsd          , FORM(RM), 0, { 15, 16, 17, 17 } },
+  { X86Inst::kIdVaddss          , FORM(RR), 0, { 13, 9 , 6 , 14 } },
+  { X86Inst::kIdVaddss          , FORM(RM), 0, { 15, 16, 17, 17 } },
+  { X86Inst::kIdVcvtdq2ps       , FORM(RR), 0, { 13, 9 , 6 , 13 } },
+  { X86Inst::kIdVcvtdq2ps       , FORM(RM), 0, { 45, 16, 17, 45 } },
+  { X86Inst::kIdVcvtps2dq       , FORM(RR), 0, { 13, 9 , 6 , 13 } },
+  { X86Inst::kIdVcvtps2dq       , FORM(RM), 0, { 45, 16, 17, 45 } },
+  { X86Inst::kIdVcvttps2dq      , FORM(RR), 0, { 13, 9 , 6 , 13 } },
+  { X86Inst::kIdVcvttps2dq      , FORM(RM), 0, { 45, 16, 17, 45 } },
+  { X86Inst::kIdVdivpd          , FORM(RR), 0, { 26, 26, 27, 28 } },
+  { X86Inst::kIdVdivpd          , FORM(RM), 0, { 29, 29, 30, 30 } },
+  { X86Inst::kIdVdivps          , FORM(RR), 0, { 21, 21, 22, 23 } },
+  { X86Inst::kIdVdivps          , FORM(RM), 0, { 24, 24, 25, 25 } },
+  { X86Inst::kIdVdivsd          , FORM(RR), 0, { 26, 26, 27, 28 } },
+  { X86Inst::kIdVdivsd          , FORM(RM), 0, { 29, 29, 30, 30 } },
+  { X86Inst::kIdVdivss          , FORM(RR), 0, { 21, 21, 22, 23 } },
+  { X86Inst::kIdVdivss          , FORM(RM), 0, { 24, 24, 25, 25 } },
+  { X86Inst::kIdVfmadd132pd     , FORM(RR), 0, { 2 , 2 , 6 , 2  } },
+  { X86Inst::kIdVfmadd132pd     , FORM(RM), 0, { 20, 19, 17, 20 } },
+  { X86Inst::kIdVfmadd132ps     , FORM(RR), 0, { 2 , 2 , 6 , 2  } },
+  { X86Inst::kIdVfmadd132ps     , FORM(RM), 0, { 20, 19, 17, 20 } },
+  { X86Inst::kIdVfmadd132sd     , FORM(RR), 0, { 2 , 2 , 6 , 2  } },
+  { X86Inst::kIdVfmadd132sd     , FORM(RM), 0, { 20, 19, 17, 20 } },
+  { X86Inst::kIdVfmadd132ss     , FORM(RR), 0, { 2 , 2 , 6 , 2  } },
+  { X86Inst::kIdVfmadd132ss     , FORM(RM), 0, { 20, 19, 17, 20 } },
+  { X86Inst::kIdVfmadd213pd     , FORM(RR), 0, { 2 , 2 , 6 , 2  } },
+  { X86Inst::kIdVfmadd213pd     , FORM(RM), 0, { 20, 19, 17, 20 } },
+  { X86Inst::kIdVfmadd213ps     , FORM(RR), 0, { 2 , 2 , 6 , 2  } },
+  { X86Inst::kIdVfmadd213ps     , FORM(RM), 0, { 20, 19, 17, 20 } },
+  { X86Inst::kIdVfmadd213sd     , FORM(RR), 0, { 2 , 2 , 6 , 2  } },
+  { X86Inst::kIdVfmadd213sd     , FORM(RM), 0, { 20, 19, 17, 20 } },
+  { X86Inst::kIdVfmadd213ss     , FORM(RR), 0, { 2 , 2 , 6 , 2  } },
+  { X86Inst::kIdVfmadd213ss     , FORM(RM), 0, { 20, 19, 17, 20 } },
+  { X86Inst::kIdVfmadd231pd     , FORM(RR), 0, { 2 , 2 , 6 , 2  } },
+  { X86Inst::kIdVfmadd231pd     , FORM(RM), 0, { 20, 19, 17, 20 } },
+  { X86Inst::kIdVfmadd231ps     , FORM(RR), 0, { 2 , 2 , 6 , 2  } },
+  { X86Inst::kIdVfmadd231ps     , FORM(RM), 0, { 20, 19, 17, 20 } },
+  { X86Inst::kIdVfmadd231sd     , FORM(RR), 0, { 2 , 2 , 6 , 2  } },
+  { X86Inst::kIdVfmadd231sd     , FORM(RM), 0, { 20, 19, 17, 20 } },
+  { X86Inst::kIdVfmadd231ss     , FORM(RR), 0, { 2 , 2 , 6 , 2  } },
+  { X86Inst::kIdVfmadd231ss     , FORM(RM), 0, { 20, 19, 17, 20 } },
+  { X86Inst::kIdVfmsub132pd     , FORM(RR), 0, { 2 , 2 , 6 , 2  } },
+  { X86Inst::kIdVfmsub132pd     , FORM(RM), 0, { 20, 19, 17, 20 } },
+  { X86Inst::kIdVfmsub132ps     , FORM(RR), 0, { 2 , 2 , 6 , 2  } },
+  { X86Inst::kIdVfmsub132ps     , FORM(RM), 0, { 20, 19, 17, 20 } },
+  { X86Inst::kIdVfmsub132sd     , FORM(RR), 0, { 2 , 2 , 6 , 2  } },
+  { X86Inst::kIdVfmsub132sd     , FORM(RM), 0, { 20, 19, 17, 20 } },
+  { X86Inst::kIdVfmsub132ss     , FORM(RR), 0, { 2 , 2 , 6 , 2  } },
+  { X86Inst::kIdVfmsub132ss     , FORM(RM), 0, { 20, 19, 17, 20 } },
+  { X86Inst::kIdVfmsub213pd     , FORM(RR), 0, { 2 , 2 , 6 , 2  } },
+  { X86Inst::kIdVfmsub213pd     , FORM(RM), 0, { 20, 19, 17, 20 } },
+  { X86Inst::kIdVfmsub213ps     , FORM(RR), 0, { 2 , 2 , 6 , 2  } },
+  { X86Inst::kIdVfmsub213ps     , FORM(RM), 0, { 20, 19, 17, 20 } },
+  { X86Inst::kIdVfmsub213sd     , FORM(RR), 0, { 2 , 2 , 6 , 2  } },
+  { X86Inst::kIdVfmsub213sd     , FORM(RM), 0, { 20, 19, 17, 20 } },
+  { X86Inst::kIdVfmsub213ss     , FORM(RR), 0, { 2 , 2 , 6 , 2  } },
+  { X86Inst::kIdVfmsub213ss     , FORM(RM), 0, { 20, 19, 17, 20 } },
+  { X86Inst::kIdVfmsub231pd     , FORM(RR), 0, { 2 , 2 , 6 , 2  } },
+  { X86Inst::kIdVfmsub231pd     , FORM(RM), 0, { 20, 19, 17, 20 } },
+  { X86Inst::kIdVfmsub231ps     , FORM(RR), 0, { 2 , 2 , 6 , 2  } },
+  { X86Inst::kIdVfmsub231ps     , FORM(RM), 0, { 20, 19, 17, 20 } },
+  { X86Inst::kIdVfmsub231sd     , FORM(RR), 0, { 2 , 2 , 6 , 2  } },
+  { X86Inst::kIdVfmsub231sd     , FORM(RM), 0, { 20, 19, 17, 20 } },
+  { X86Inst::kIdVfmsub231ss     , FORM(RR), 0, { 2 , 2 , 6 , 2  } },
+  { X86Inst::kIdVfmsub231ss     , FORM(RM), 0, { 20, 19, 17, 20 } },
+  { X86Inst::kIdVfnmadd132pd    , FORM(RR), 0, { 2 , 2 , 6 , 2  } },
+  { X86Inst::kIdVfnmadd132pd    , FORM(RM), 0, { 20, 19, 17, 20 } },
+  { X86Inst::kIdVfnmadd132ps    , FORM(RR), 0, { 2 , 2 , 6 , 2  } },
+  { X86Inst::kIdVfnmadd132ps    , FORM(RM), 0, { 20, 19, 17, 20 } },
+  { X86Inst::kIdVfnmadd132sd    , FORM(RR), 0, { 2 , 2 , 6 , 2  } },
+  { X86Inst::kIdVfnmadd132sd    , FORM(RM), 0, { 20, 19, 17, 20 } },
+  { X86Inst::kIdVfnmadd132ss    , FORM(RR), 0, { 2 , 2 , 6 , 2  } },
+  { X86Inst::kIdVfnmadd132ss    , FORM(RM), 0, { 20, 19, 17, 20 } },
+  { X86Inst::kIdVfnmadd213pd    , FORM(RR), 0, { 2 , 2 , 6 , 2  } },
+  { X86Inst::kIdVfnmadd213pd    , FORM(RM), 0, { 20, 19, 17, 20 } },
+  { X86Inst::kIdVfnmadd213ps    , FORM(RR), 0, { 2 , 2 , 6 , 2  } },
+  { X86Inst::kIdVfnmadd213ps    , FORM(RM), 0, { 20, 19, 17, 20 } },
+  { X86Inst::kIdVfnmadd213sd    , FORM(RR), 0, { 2 , 2 , 6 , 2  } },
+  { X86Inst::kIdVfnmadd213sd    , FORM(RM), 0, { 20, 19, 17, 20 } },
+  { X86Inst::kIdVfnmadd213ss    , FORM(RR), 0, { 2 , 2 , 6 , 2  } },
+  { X86Inst::kIdVfnmadd213ss    , FORM(RM), 0, { 20, 19, 17, 20 } },
+  { X86Inst::kIdVfnmadd231pd    , FORM(RR), 0, { 2 , 2 , 6 , 2  } },
+  { X86Inst::kIdVfnmadd231pd    , FORM(RM), 0, { 20, 19, 17, 20 } },
+  { X86Inst::kIdVfnmadd231ps    , FORM(RR), 0, { 2 , 2 , 6 , 2  } },
+  { X86Inst::kIdVfnmadd231ps    , FORM(RM), 0, { 20, 19, 17, 20 } },
+  { X86Inst::kIdVfnmadd231sd    , FORM(RR), 0, { 2 , 2 , 6 , 2  } },
+  { X86Inst::kIdVfnmadd231sd    , FORM(RM), 0, { 20, 19, 17, 20 } },
+  { X86Inst::kIdVfnmadd231ss    , FORM(RR), 0, { 2 , 2 , 6 , 2  } },
+  { X86Inst::kIdVfnmadd231ss    , FORM(RM), 0, { 20, 19, 17, 20 } },
+  { X86Inst::kIdVfnmsub132pd    , FORM(RR), 0, { 2 , 2 , 6 , 2  } },
+  { X86Inst::kIdVfnmsub132pd    , FORM(RM), 0, { 20, 19, 17, 20 } },
+  { X86Inst::kIdVfnmsub132ps    , FORM(RR), 0, { 2 , 2 , 6 , 2  } },
+  { X86Inst::kIdVfnmsub132ps    , FORM(RM), 0, { 20, 19, 17, 20 } },
+  { X86Inst::kIdVfnmsub132sd    , FORM(RR), 0, { 2 , 2 , 6 , 2  } },
+  { X86Inst::kIdVfnmsub132sd    , FORM(RM), 0, { 20, 19, 17, 20 } },
+  { X86Inst::kIdVfnmsub132ss    , FORM(RR), 0, { 2 , 2 , 6 , 2  } },
+  { X86Inst::kIdVfnmsub132ss    , FORM(RM), 0, { 20, 19, 17, 20 } },
+  { X86Inst::kIdVfnmsub213pd    , FORM(RR), 0, { 2 , 2 , 6 , 2  } },
+  { X86Inst::kIdVfnmsub213pd    , FORM(RM), 0, { 20, 19, 17, 20 } },
+  { X86Inst::kIdVfnmsub213ps    , FORM(RR), 0, { 2 , 2 , 6 , 2  } },
+  { X86Inst::kIdVfnmsub213ps    , FORM(RM), 0, { 20, 19, 17, 20 } },
+  { X86Inst::kIdVfnmsub213sd    , FORM(RR), 0, { 2 , 2 , 6 , 2  } },
+  { X86Inst::kIdVfnmsub213sd    , FORM(RM), 0, { 20, 19, 17, 20 } },
+  { X86Inst::kIdVfnmsub213ss    , FORM(RR), 0, { 2 , 2 , 6 , 2  } },
+  { X86Inst::kIdVfnmsub213ss    , FORM(RM), 0, { 20, 19, 17, 20 } },
+  { X86Inst::kIdVfnmsub231pd    , FORM(RR), 0, { 2 , 2 , 6 , 2  } },
+  { X86Inst::kIdVfnmsub231pd    , FORM(RM), 0, { 20, 19, 17, 20 } },
+  { X86Inst::kIdVfnmsub231ps    , FORM(RR), 0, { 2 , 2 , 6 , 2  } },
+  { X86Inst::kIdVfnmsub231ps    , FORM(RM), 0, { 20, 19, 17, 20 } },
+  { X86Inst::kIdVfnmsub231sd    , FORM(RR), 0, { 2 , 2 , 6 , 2  } },
+  { X86Inst::kIdVfnmsub231sd    , FORM(RM), 0, { 20, 19, 17, 20 } },
+  { X86Inst::kIdVfnmsub231ss    , FORM(RR), 0, { 2 , 2 , 6 , 2  } },
+  { X86Inst::kIdVfnmsub231ss    , FORM(RM), 0, { 20, 19, 17, 20 } },
+  { X86Inst::kIdVmaxpd          , FORM(RR), 0, { 13, 9 , 6 , 8  } },
+  { X86Inst::kIdVmaxpd          , FORM(RM), 0, { 15, 16, 17, 18 } },
+  { X86Inst::kIdVmaxps          , FORM(RR), 0, { 13, 9 , 6 , 8  } },
+  { X86Inst::kIdVmaxps          , FORM(RM), 0, { 15, 16, 17, 18 } },
+  { X86Inst::kIdVmaxsd          , FORM(RR), 0, { 13, 9 , 6 , 8  } },
+  { X86Inst::kIdVmaxsd          , FORM(RM), 0, { 15, 16, 17, 18 } },
+  { X86Inst::kIdVmaxss          , FORM(RR), 0, { 13, 9 , 6 , 8  } },
+  { X86Inst::kIdVmaxss          , FORM(RM), 0, { 15, 16, 17, 18 } },
+  { X86Inst::kIdVminpd          , FORM(RR), 0, { 13, 9 , 6 , 8  } },
+  { X86Inst::kIdVminpd          , FORM(RM), 0, { 15, 16, 17, 18 } },
+  { X86Inst::kIdVminps          , FORM(RR), 0, { 13, 9 , 6 , 8  } },
+  { X86Inst::kIdVminps          , FORM(RM), 0, { 15, 16, 17, 18 } },
+  { X86Inst::kIdVminsd          , FORM(RR), 0, { 13, 9 , 6 , 8  } },
+  { X86Inst::kIdVminsd          , FORM(RM), 0, { 15, 16, 17, 18 } },
+  { X86Inst::kIdVminss          , FORM(RR), 0, { 13, 9 , 6 , 8  } },
+  { X86Inst::kIdVminss          , FORM(RM), 0, { 15, 16, 17, 18 } },
+  { X86Inst::kIdVmovapd         , FORM(RR), 0, { 0 , 0 , 0 , 0  } },
+  { X86Inst::kIdVmovapd         , FORM(RM), 0, { 12, 1 , 1 , 12 } },
+  { X86Inst::kIdVmovapd         , FORM(MR), 0, { 7 , 7 , 7 , 7  } },
+  { X86Inst::kIdVmovaps         , FORM(RR), 0, { 0 , 0 , 0 , 0  } },
+  { X86Inst::kIdVmovaps         , FORM(RM), 0, { 12, 1 , 1 , 12 } },
+  { X86Inst::kIdVmovaps         , FORM(MR), 0, { 7 , 7 , 7 , 7  } },
+  { X86Inst::kIdVmovdqa         , FORM(RR), 0, { 0 , 0 , 0 , 0  } },
+  { X86Inst::kIdVmovdqa         , FORM(RM), 0, { 12, 1 , 1 , 12 } },
+  { X86Inst::kIdVmovdqa         , FORM(MR), 0, { 7 , 7 , 7 , 7  } },
+  { X86Inst::kIdVmovdqu         , FORM(RR), 0, { 0 , 0 , 0 , 0  } },
+  { X86Inst::kIdVmovdqu         , FORM(RM), 0, { 12, 1 , 1 , 12 } },
+  { X86Inst::kIdVmovdqu         , FORM(MR), 0, { 7 , 7 , 7 , 7  } },
+  { X86Inst::kIdVmovupd         , FORM(RR), 0, { 0 , 0 , 0 , 0  } },
+  { X86Inst::kIdVmovupd         , FORM(RM), 0, { 12, 1 , 1 , 12 } },
+  { X86Inst::kIdVmovupd         , FORM(MR), 0, { 7 , 7 , 7 , 7  } },
+  { X86Inst::kIdVmovups         , FORM(RR), 0, { 0 , 0 , 0 , 0  } },
+  { X86Inst::kIdVmovups         , FORM(RM), 0, { 12, 1 , 1 , 12 } },
+  { X86Inst::kIdVmovups         , FORM(MR), 0, { 7 , 7 , 7 , 7  } },
+  { X86Inst::kIdVmulpd          , FORM(RR), 0, { 2 , 2 , 6 , 14 } },
+  { X86Inst::kIdVmulpd          , FORM(RM), 0, { 19, 19, 17, 17 } },
+  { X86Inst::kIdVmulps          , FORM(RR), 0, { 2 , 2 , 6 , 14 } },
+  { X86Inst::kIdVmulps          , FORM(RM), 0, { 19, 19, 17, 17 } },
+  { X86Inst::kIdVmulsd          , FORM(RR), 0, { 2 , 2 , 6 , 14 } },
+  { X86Inst::kIdVmulsd          , FORM(RM), 0, { 19, 19, 17, 17 } },
+  { X86Inst::kIdVmulss          , FORM(RR), 0, { 2 , 2 , 6 , 14 } },
+  { X86Inst::kIdVmulss          , FORM(RM), 0, { 19, 19, 17, 17 } },
+  { X86Inst::kIdVpaddb          , FORM(RR), 0, { 8 , 8 , 46, 0  } },
+  { X86Inst::kIdVpaddb          , FORM(RM), 0, { 18, 12, 12, 18 } },
+  { X86Inst::kIdVpaddd          , FORM(RR), 0, { 8 , 8 , 46, 0  } },
+  { X86Inst::kIdVpaddd          , FORM(RM), 0, { 18, 12, 12, 18 } },
+  { X86Inst::kIdVpaddq          , FORM(RR), 0, { 8 , 8 , 46, 0  } },
+  { X86Inst::kIdVpaddq          , FORM(RM), 0, { 18, 12, 12, 18 } },
+  { X86Inst::kIdVpaddw          , FORM(RR), 0, { 8 , 8 , 46, 0  } },
+  { X86Inst::kIdVpaddw          , FORM(RM), 0, { 18, 12, 12, 18 } },
+  { X86Inst::kIdVpand           , FORM(RR), 0, { 8 , 8 , 46, 0  } },
+  { X86Inst::kIdVpand           , FORM(RM), 0, { 18, 12, 12, 18 } },
+  { X86Inst::kIdVpandn          , FORM(RR), 0, { 8 , 8 , 46, 0  } },
+  { X86Inst::kIdVpandn          , FORM(RM), 0, { 18, 12, 12, 18 } },
+  { X86Inst::kIdVpcmpeqb        , FORM(RR), 0, { 8 , 8 , 46, 0  } },
+  { X86Inst::kIdVpcmpeqb        , FORM(RM), 0, { 18, 12, 12, 18 } },
+  { X86Inst::kIdVpcmpeqd        , FORM(RR), 0, { 8 , 8 , 46, 0  } },
+  { X86Inst::kIdVpcmpeqd        , FORM(RM), 0, { 18, 12, 12, 18 } },
+  { X86Inst::kIdVpcmpeqw        , FORM(RR), 0, { 8 , 8 , 46, 0  } },
+  { X86Inst::kIdVpcmpeqw        , FORM(RM), 0, { 18, 12, 12, 18 } },
+  { X86Inst::kIdVpcmpgtb        , FORM(RR), 0, { 8 , 8 , 46, 0  } },
+  { X86Inst::kIdVpcmpgtb        , FORM(RM), 0, { 18, 12, 12, 18 } },
+  { X86Inst::kIdVpcmpgtd        , FORM(RR), 0, { 8 , 8 , 46, 0  } },
+  { X86Inst::kIdVpcmpgtd        , FORM(RM), 0, { 18, 12, 12, 18 } },
+  { X86Inst::kIdVpcmpgtw        , FORM(RR), 0, { 8 , 8 , 46, 0  } },
+  { X86Inst::kIdVpcmpgtw        , FORM(RM), 0, { 18, 12, 12, 18 } },
+  { X86Inst::kIdVpmaddwd        , FORM(RR), 0, { 47, 47, 2 , 9  } },
+  { X86Inst::kIdVpmaddwd        , FORM(RM), 0, { 45, 45, 19, 15 } },
+  { X86Inst::kIdVpmuldq         , FORM(RR), 0, { 47, 47, 2 , 9  } },
+  { X86Inst::kIdVpmuldq         , FORM(RM), 0, { 45, 45, 19, 15 } },
+  { X86Inst::kIdVpmulhuw        , FORM(RR), 0, { 47, 47, 2 , 9  } },
+  { X86Inst::kIdVpmulhuw        , FORM(RM), 0, { 45, 45, 19, 15 } },
+  { X86Inst::kIdVpmulhw         , FORM(RR), 0, { 47, 47, 2 , 9  } },
+  { X86Inst::kIdVpmulhw         , FORM(RM), 0, { 45, 45, 19, 15 } },
+  { X86Inst::kIdVpmulld         , FORM(RR), 0, { 48, 48, 48, 13 } },
+  { X86Inst::kIdVpmulld         , FORM(RM), 0, { 49, 49, 49, 45 } },
+  { X86Inst::kIdVpmullw         , FORM(RR), 0, { 47, 47, 2 , 9  } },
+  { X86Inst::kIdVpmullw         , FORM(RM), 0, { 45, 45, 19, 15 } },
+  { X86Inst::kIdVpmuludq        , FORM(RR), 0, { 47, 47, 2 , 9  } },
+  { X86Inst::kIdVpmuludq        , FORM(RM), 0, { 45, 45, 19, 15 } },
+  { X86Inst::kIdVpor            , FORM(RR), 0, { 8 , 8 , 46, 0  } },
+  { X86Inst::kIdVpor            , FORM(RM), 0, { 18, 12, 12, 18 } },
+  { X86Inst::kIdVpshufb         , FORM(RR), 0, { 7 , 7 , 7 , 8  } },
+  { X86Inst::kIdVpshufb         , FORM(RM), 0, { 10, 11, 11, 18 } },
+  { X86Inst::kIdVpshufd         , FORM(RR), 0, { 7 , 7 , 7 , 8  } },
+  { X86Inst::kIdVpshufd         , FORM(RM), 0, { 10, 11, 11, 18 } },
+  { X86Inst::kIdVpsubb          , FORM(RR), 0, { 8 , 8 , 46, 0  } },
+  { X86Inst::kIdVpsubb          , FORM(RM), 0, { 18, 12, 12, 18 } },
+  { X86Inst::kIdVpsubd          , FORM(RR), 0, { 8 , 8 , 46, 0  } },
+  { X86Inst::kIdVpsubd          , FORM(RM), 0, { 18, 12, 12, 18 } },
+  { X86Inst::kIdVpsubq          , FORM(RR), 0, { 8 , 8 , 46, 0  } },
+  { X86Inst::kIdVpsubq          , FORM(RM), 0, { 18, 12, 12, 18 } },
+  { X86Inst::kIdVpsubw          , FORM(RR), 0, { 8 , 8 , 46, 0  } },
+  { X86Inst::kIdVpsubw          , FORM(RM), 0, { 18, 12, 12, 18 } },
+  { X86Inst::kIdVpunpckhbw      , FORM(RR), 0, { 7 , 7 , 7 , 8  } },
+  { X86Inst::kIdVpunpckhbw      , FORM(RM), 0, { 10, 11, 11, 18 } },
+  { X86Inst::kIdVpunpckhdq      , FORM(RR), 0, { 7 , 7 , 7 , 8  } },
+  { X86Inst::kIdVpunpckhdq      , FORM(RM), 0, { 10, 11, 11, 18 } },
+  { X86Inst::kIdVpunpckhqdq     , FORM(RR), 0, { 7 , 7 , 7 , 8  } },
+  { X86Inst::kIdVpunpckhqdq     , FORM(RM), 0, { 10, 11, 11, 18 } },
+  { X86Inst::kIdVpunpckhwd      , FORM(RR), 0, { 7 , 7 , 7 , 8  } },
+  { X86Inst::kIdVpunpckhwd      , FORM(RM), 0, { 10, 11, 11, 18 } },
+  { X86Inst::kIdVpunpcklbw      , FORM(RR), 0, { 7 , 7 , 7 , 8  } },
+  { X86Inst::kIdVpunpcklbw      , FORM(RM), 0, { 10, 11, 11, 18 } },
+  { X86Inst::kIdVpunpckldq      , FORM(RR), 0, { 7 , 7 , 7 , 8  } },
+  { X86Inst::kIdVpunpckldq      , FORM(RM), 0, { 10, 11, 11, 18 } },
+  { X86Inst::kIdVpunpcklqdq     , FORM(RR), 0, { 7 , 7 , 7 , 8  } },
+  { X86Inst::kIdVpunpcklqdq     , FORM(RM), 0, { 10, 11, 11, 18 } },
+  { X86Inst::kIdVpunpcklwd      , FORM(RR), 0, { 7 , 7 , 7 , 8  } },
+  { X86Inst::kIdVpunpcklwd      , FORM(RM), 0, { 10, 11, 11, 18 } },
+  { X86Inst::kIdVpxor           , FORM(RR), 0, { 8 , 8 , 46, 0  } },
+  { X86Inst::kIdVpxor           , FORM(RM), 0, { 18, 12, 12, 18 } },
+  { X86Inst::kIdVshufpd         , FORM(RR), 0, { 7 , 7 , 7 , 8  } },
+  { X86Inst::kIdVshufpd         , FORM(RM), 0, { 10, 11, 11, 18 } },
+  { X86Inst::kIdVshufps         , FORM(RR), 0, { 7 , 7 , 7 , 8  } },
+  { X86Inst::kIdVshufps         , FORM(RM), 0, { 10, 11, 11, 18 } },
+  { X86Inst::kIdVsqrtpd         , FORM(RR), 0, { 39, 40, 41, 39 } },
+  { X86Inst::kIdVsqrtpd         , FORM(RM), 0, { 42, 43, 44, 42 } },
+  { X86Inst::kIdVsqrtps         , FORM(RR), 0, { 31, 32, 33, 34 } },
+  { X86Inst::kIdVsqrtps         , FORM(RM), 0, { 35, 36, 37, 38 } },
+  { X86Inst::kIdVsqrtsd         , FORM(RR), 0, { 39, 40, 41, 39 } },
+  { X86Inst::kIdVsqrtsd         , FORM(RM), 0, { 42, 43, 44, 42 } },
+  { X86Inst::kIdVsqrtss         , FORM(RR), 0, { 31, 32, 33, 34 } },
+  { X86Inst::kIdVsqrtss         , FORM(RM), 0, { 35, 36, 37, 38 } },
+  { X86Inst::kIdVsubpd          , FORM(RR), 0, { 13, 9 , 6 , 14 } },
+  { X86Inst::kIdVsubpd          , FORM(RM), 0, { 15, 16, 17, 17 } },
+  { X86Inst::kIdVsubps          , FORM(RR), 0, { 13, 9 , 6 , 14 } },
+  { X86Inst::kIdVsubps          , FORM(RM), 0, { 15, 16, 17, 17 } },
+  { X86Inst::kIdVsubsd          , FORM(RR), 0, { 13, 9 , 6 , 14 } },
+  { X86Inst::kIdVsubsd          , FORM(RM), 0, { 15, 16, 17, 17 } },
+  { X86Inst::kIdVsubss          , FORM(RR), 0, { 13, 9 , 6 , 14 } },
+  { X86Inst::kIdVsubss          , FORM(RM), 0, { 15, 16, 17, 17 } },
+  { X86Inst::kIdVunpckhpd       , FORM(RR), 0, { 7 , 7 , 7 , 8  } },
+  { X86Inst::kIdVunpckhpd       , FORM(RM), 0, { 10, 11, 11, 18 } },
+  { X86Inst::kIdVunpckhps       , FORM(RR), 0, { 7 , 7 , 7 , 8  } },
+  { X86Inst::kIdVunpckhps       , FORM(RM), 0, { 10, 11, 11, 18 } },
+  { X86Inst::kIdVunpcklpd       , FORM(RR), 0, { 7 , 7 , 7 , 8  } },
+  { X86Inst::kIdVunpcklpd       , FORM(RM), 0, { 10, 11, 11, 18 } },
+  { X86Inst::kIdVunpcklps       , FORM(RR), 0, { 7 , 7 , 7 , 8  } },
+  { X86Inst::kIdVunpcklps       , FORM(RM), 0, { 10, 11, 11, 18 } },
+  { X86Inst::kIdXor             , FORM(RR), 0, { 0 , 0 , 0 , 0  } },
+  { X86Inst::kIdXor             , FORM(RM), 0, { 1 , 2 , 1 , 2  } },
+  { X86Inst::kIdXor             , FORM(MR), 0, { 3 , 3 , 3 , 3  } }
+};
+#undef FORM
+// ----------------------------------------------------------------------------
+// ${costData:End}
+
+bool X86Inst::getCost(uint32_t instId, const Operand_* opArray, uint32_t opCount, uint32_t uarch, Cost* out) noexcept {
+  if (uarch >= kUarchCount)
+    uarch = kUarchGeneric;
+
+  uint32_t form = kCostFormRR;
+  if (isDefinedId(instId)) {
+    const CommonData& commonData = getInst(instId).getCommonData();
+    for (uint32_t i = 0; i < opCount; i++) {
+      if (!opArray[i].isMem())
+        continue;
+
+      form = (i == 0 && (commonData.getFlags() & kFlagUseW)) ? kCostFormMR : kCostFormRM;
+      break;
+    }
+  }
+
+  // Entries are sorted by `instId` and `form`.
+  const CostEntry* base = X86InstDB::costEntryData;
+  size_t count = ASMJIT_ARRAY_SIZE(X86InstDB::costEntryData);
+  uint32_t key = (instId << 8) | form;
+
+  while (count) {
+    size_t half = count / 2;
+    const CostEntry* entry = base + half;
+    uint32_t entryKey = (uint32_t(entry->instId) << 8) | entry->form;
+
+    if (entryKey == key) {
+      *out = X86InstDB::costData[entry->costIndex[uarch]];
+      return true;
+    }
+
+    if (entryKey < key) {
+      base = entry + 1;
+      count -= half + 1;
+    }
+    else {
+      count = half;
+    }
+  }
+
+  out->latency = 1;
+  out->uops = 1;
+  out->throughput = 100;
+  return false;
+}
+#endif // !ASMJIT_DISABLE_COST_MODEL
+
+// ============================================================================
+// [asmjit::X86Inst - Commutative]
+// ============================================================================
+
+bool X86Inst::isCommutative(uint32_t instId) noexcept {
+  switch (instId) {
+    case kIdVandpd   : case kIdVandps   : case kIdVorpd    : case kIdVorps    :
+    case kIdVxorpd   : case kIdVxorps   :
+    case kIdVpand    : case kIdVpandd   : case kIdVpandq   :
+    case kIdVpor     : case kIdVpord    : case kIdVporq    :
+    case kIdVpxor    : case kIdVpxord   : case kIdVpxorq   :
+    case kIdVpaddb   : case kIdVpaddw   : case kIdVpaddd   : case kIdVpaddq   :
+    case kIdVpaddsb  : case kIdVpaddsw  : case kIdVpaddusb : case kIdVpaddusw :
+    case kIdVpavgb   : case kIdVpavgw   :
+    case kIdVpcmpeqb : case kIdVpcmpeqw : case kIdVpcmpeqd : case kIdVpcmpeqq :
+    case kIdVpmaddwd :
+    case kIdVpmaxsb  : case kIdVpmaxsw  : case kIdVpmaxsd  : case kIdVpmaxsq  :
+    case kIdVpmaxub  : case kIdVpmaxuw  : case kIdVpmaxud  : case kIdVpmaxuq  :
+    case kIdVpminsb  : case kIdVpminsw  : case kIdVpminsd  : case kIdVpminsq  :
+    case kIdVpminub  : case kIdVpminuw  : case kIdVpminud  : case kIdVpminuq  :
+    case kIdVpmuldq  : case kIdVpmuludq : case kIdVpmulhw  : case kIdVpmulhuw :
+    case kIdVpmulhrsw: case kIdVpmullw  : case kIdVpmulld  : case kIdVpmullq  :
+      return true;
+
+    default:
+      return false;
+  }
+}
+
 // ============================================================================
 // [asmjit::X86Inst - MiscData]
 // ============================================================================
@@ -3697,6 +4406,48 @@ UNIT(x86_inst_bits) {
 }
 #endif // ASMJIT_TEST
 
+#if defined(ASMJIT_TEST) && !defined(ASMJIT_DISABLE_COST_MODEL)
+UNIT(x86_inst_costs) {
+  using namespace x86;
+  X86Inst::Cost cost;
+
+  INFO("Checking whether the cost table is sorted");
+  for (size_t i = 1; i < ASMJIT_ARRAY_SIZE(X86InstDB::costEntryData); i++) {
+    const X86Inst::CostEntry& a = X86InstDB::costEntryData[i - 1];
+    const X86Inst::CostEntry& b = X86InstDB::costEntryData[i];
+    EXPECT(a.instId < b.instId || (a.instId == b.instId && a.form < b.form),
+      "Cost entry #%u is not sorted", static_cast<unsigned int>(i));
+  }
+
+  INFO("Checking forms of X86Inst::getCost()");
+  Operand rr[] = { eax, ecx };
+  Operand rm[] = { eax, dword_ptr(ecx) };
+  Operand mr[] = { dword_ptr(ecx), eax };
+
+  EXPECT(X86Inst::getCost(X86Inst::kIdAdd, rr, 2, X86Inst::kUarchSkylake, &cost));
+  EXPECT(cost.latency == 1 && cost.uops == 1 && cost.throughput == 25);
+  EXPECT(X86Inst::getCost(X86Inst::kIdAdd, rm, 2, X86Inst::kUarchSkylake, &cost));
+  EXPECT(cost.latency == 6);
+  EXPECT(X86Inst::getCost(X86Inst::kIdAdd, mr, 2, X86Inst::kUarchSkylake, &cost));
+  EXPECT(cost.uops == 2);
+
+  // CMP only reads its first operand, so it's a load.
+  EXPECT(X86Inst::getCost(X86Inst::kIdCmp, mr, 2, X86Inst::kUarchZen, &cost));
+  EXPECT(cost.latency == 5);
+
+  INFO("Checking generic costs of X86Inst::getCost()");
+  Operand vv[] = { xmm0, xmm1 };
+  EXPECT(X86Inst::getCost(X86Inst::kIdMulps, vv, 2, X86Inst::kUarchGeneric, &cost));
+  EXPECT(cost.latency == 5 && cost.throughput == 50);
+  EXPECT(X86Inst::getCost(X86Inst::kIdVdivpd, vv, 2, X86Inst::kUarchCount, &cost));
+  EXPECT(cost.latency == 20 && cost.throughput == 1400);
+
+  INFO("Checking instructions without costs");
+  EXPECT(!X86Inst::getCost(X86Inst::kIdCpuid, nullptr, 0, X86Inst::kUarchSkylake, &cost));
+  EXPECT(cost.latency == 1 && cost.uops == 1 && cost.throughput == 100);
+}
+#endif // ASMJIT_TEST && !ASMJIT_DISABLE_COST_MODEL
+
 #if defined(ASMJIT_TEST) && !defined(ASMJIT_DISABLE_TEXT)
 UNIT(x86_inst_names) {
   // All known instructions should be matched.
@@ -3715,6 +4466,12 @@ UNIT(x86_inst_names) {
   EXPECT(X86Inst::getIdByName("")       == Inst::kIdNone, "Should return Inst::kIdNone for empty string");
   EXPECT(X86Inst::getIdByName("_")      == Inst::kIdNone, "Should return Inst::kIdNone for unknown instruction");
   EXPECT(X86Inst::getIdByName("123xyz") == Inst::kIdNone, "Should return Inst::kIdNone for unknown instruction");
+  EXPECT(X86Inst::getIdByName("ad")     == Inst::kIdNone, "Should return Inst::kIdNone for a prefix of a known instruction");
+  EXPECT(X86Inst::getIdByName("addpsx") == Inst::kIdNone, "Should return Inst::kIdNone for a known instruction followed by junk");
+  EXPECT(X86Inst::getIdByName("ADD")    == Inst::kIdNone, "Should return Inst::kIdNone for an upper-case name");
+
+  INFO("Looking up instructions by name of a given length");
+  EXPECT(X86Inst::getIdByName("addpsx", 5) == X86Inst::kIdAddps, "Should match a name limited by length");
 }
 #endif // ASMJIT_TEST && !ASMJIT_DISABLE_TEXT
 
@@ -2125,6 +2125,32 @@ struct X86Inst {
     uint8_t regMask;                     //!< Mask of possible register IDs.
   };
 
+  //! Cache of operand combinations that matched an \ref ISignature.
+  //!
+  //! Used by emitters that validate each instruction (strict validation), it's
+  //! keyed by the instruction id and operands translated to \ref OSignature,
+  //! so a hit skips the scan of signatures, but not the checks of prefixes,
+  //! registers, and AVX-512 options that depend on operand values.
+  struct ValidationCache {
+    enum {
+      //! Count of cache entries (direct-mapped).
+      kEntryCount = 32
+    };
+
+    //! Cache entry.
+    struct Entry {
+      uint16_t instId;                   //!< Instruction id (zero if the entry is empty).
+      uint8_t archMask;                  //!< Architecture mask.
+      uint8_t opCount;                   //!< Count of operands.
+      OSignature operands[6];            //!< Translated operands.
+    };
+
+    //! Reset all entries.
+    ASMJIT_INLINE void reset() noexcept { ::memset(this, 0, sizeof(*this)); }
+
+    Entry entries[kEntryCount];          //!< Entries.
+  };
+
   //! Common data - aggregated data that is shared across many instructions.
   struct CommonData {
     //! Get all instruction flags, see \ref X86Inst::Flags.
@@ -2283,6 +2309,37 @@ struct X86Inst {
     uint32_t reversedCond[x86::kCondCount];
   };
 
+  //! Microarchitecture of \ref getCost().
+  ASMJIT_ENUM(Uarch) {
+    kUarchGeneric         = 0,           //!< Worst case of all microarchitectures.
+    kUarchHaswell         = 1,           //!< Intel Haswell and Broadwell.
+    kUarchSkylake         = 2,           //!< Intel Skylake and derived cores.
+    kUarchZen             = 3,           //!< AMD Zen and Zen+.
+    kUarchCount           = 4            //!< Count of microarchitectures.
+  };
+
+  //! Operand form of \ref getCost().
+  ASMJIT_ENUM(CostForm) {
+    kCostFormRR           = 0,           //!< Register and immediate operands.
+    kCostFormRM           = 1,           //!< Memory source (a load, or LEA).
+    kCostFormMR           = 2            //!< Memory destination (a store or read-modify-write).
+  };
+
+  //! Cost of an instruction form on a microarchitecture.
+  struct Cost {
+    uint8_t latency;                     //!< Latency in cycles.
+    uint8_t uops;                        //!< Fused-domain uops.
+    uint16_t throughput;                 //!< Reciprocal throughput in hundredths of a cycle.
+  };
+
+  //! Costs of an instruction form, see \ref X86InstDB::costEntryData.
+  struct CostEntry {
+    uint16_t instId;                     //!< Instruction id.
+    uint8_t form;                        //!< Operand form, see \ref CostForm.
+    uint8_t reserved;                    //!< \internal
+    uint8_t costIndex[kUarchCount];      //!< Indexes to `X86InstDB::costData` of each \ref Uarch.
+  };
+
   // --------------------------------------------------------------------------
   // [Accessors]
   // --------------------------------------------------------------------------
@@ -2432,6 +2489,14 @@ struct X86Inst {
     return getMiscData().condToSetcc[cond];
   }
 
+  //! Get if the two source operands of `instId` (RVM form) can be swapped
+  //! without changing the result.
+  //!
+  //! Only bit-exact integer and bitwise instructions are considered, floating
+  //! point arithmetic is excluded as swapping sources can change which NaN
+  //! payload is propagated.
+  ASMJIT_API static bool isCommutative(uint32_t instId) noexcept;
+
   //! Get a 'kmov?' instruction by register `size`.
   static ASMJIT_INLINE uint32_t kmovIdFromSize(uint32_t size) noexcept {
     return size == 1 ? X86Inst::kIdKmovb :
@@ -2456,6 +2521,22 @@ struct X86Inst {
   ASMJIT_API static const char* getNameById(uint32_t instId) noexcept;
 #endif // !ASMJIT_DISABLE_TEXT
 
+  // --------------------------------------------------------------------------
+  // [Cost]
+  // --------------------------------------------------------------------------
+
+#if !defined(ASMJIT_DISABLE_COST_MODEL)
+  //! Get the cost of `instId` used with `opArray` on `uarch`, see \ref Uarch.
+  //!
+  //! The form is `kCostFormMR` if the first operand is a written memory
+  //! operand, `kCostFormRM` if any other operand is memory, and `kCostFormRR`
+  //! otherwise. Returns true if the form is in the cost table, otherwise `out`
+  //! is set to a single-cycle, single-uop cost and false is returned. The table
+  //! covers the most common families (scalar ALU, moves, SSE/AVX arithmetic,
+  //! FMA, integer SIMD, and shuffles).
+  ASMJIT_API static bool getCost(uint32_t instId, const Operand_* opArray, uint32_t opCount, uint32_t uarch, Cost* out) noexcept;
+#endif // !ASMJIT_DISABLE_COST_MODEL
+
   // --------------------------------------------------------------------------
   // [Members]
   // --------------------------------------------------------------------------
@@ -2485,6 +2566,11 @@ struct X86InstDB {
   ASMJIT_API static const X86Inst::ISignature iSignatureData[];
   ASMJIT_API static const X86Inst::OSignature oSignatureData[];
 #endif // ASMJIT_DISABLE_VALIDATION
+
+#if !defined(ASMJIT_DISABLE_COST_MODEL)
+  ASMJIT_API static const X86Inst::Cost costData[];
+  ASMJIT_API static const X86Inst::CostEntry costEntryData[];
+#endif // !ASMJIT_DISABLE_COST_MODEL
 };
 
 ASMJIT_INLINE const X86Inst& X86Inst::getInst(uint32_t instId) noexcept {
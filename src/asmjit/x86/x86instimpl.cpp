@@ -146,7 +146,7 @@ static ASMJIT_INLINE bool x86CheckOSig(const X86Inst::OSignature& op, const X86I
   return true;
 }
 
-ASMJIT_FAVOR_SIZE Error X86InstImpl::validate(uint32_t archType, const Inst::Detail& detail, const Operand_* operands, uint32_t count) noexcept {
+ASMJIT_FAVOR_SIZE Error X86InstImpl::validate(uint32_t archType, const Inst::Detail& detail, const Operand_* operands, uint32_t count, X86Inst::ValidationCache* cache) noexcept {
   uint32_t i;
   uint32_t archMask;
   const X86ValidationData* vd;
@@ -419,6 +419,7 @@ ASMJIT_FAVOR_SIZE Error X86InstImpl::validate(uint32_t archType, const Inst::Det
     X86Inst::OSignature& tod = oSigTranslated[i];
     tod.flags = opFlags;
     tod.memFlags = static_cast<uint16_t>(memFlags);
+    tod.extFlags = 0;
     tod.regMask = static_cast<uint8_t>(regMask & 0xFFU);
     combinedOpFlags |= opFlags;
   }
@@ -450,6 +451,34 @@ ASMJIT_FAVOR_SIZE Error X86InstImpl::validate(uint32_t archType, const Inst::Det
   const X86Inst::ISignature* iSig = X86InstDB::iSignatureData + commonData->_iSignatureIndex;
   const X86Inst::ISignature* iEnd = iSig                      + commonData->_iSignatureCount;
 
+  // The result of the scan depends only on the translated operands, so it can
+  // be cached. Only matches are cached, failures always take the slow path.
+  X86Inst::ValidationCache::Entry* cacheEntry = nullptr;
+  X86Inst::ValidationCache::Entry cacheKey;
+
+  if (cache && iSig != iEnd) {
+    ::memset(&cacheKey, 0, sizeof(cacheKey));
+    cacheKey.instId = static_cast<uint16_t>(instId);
+    cacheKey.archMask = static_cast<uint8_t>(archMask);
+    cacheKey.opCount = static_cast<uint8_t>(count);
+
+    uint32_t hash = instId * 7 + count;
+    for (i = 0; i < count; i++) {
+      const X86Inst::OSignature& tod = oSigTranslated[i];
+      cacheKey.operands[i] = tod;
+      hash = (hash * 31) ^ tod.flags ^ (static_cast<uint32_t>(tod.memFlags) << 8) ^ tod.regMask;
+    }
+
+    hash ^= hash >> 16;
+    hash ^= hash >> 8;
+    cacheEntry = &cache->entries[hash & (X86Inst::ValidationCache::kEntryCount - 1)];
+
+    if (::memcmp(cacheEntry, &cacheKey, sizeof(cacheKey)) == 0) {
+      cacheEntry = nullptr;
+      iSig = iEnd;
+    }
+  }
+
   if (iSig != iEnd) {
     const X86Inst::OSignature* oSigData = X86InstDB::oSignatureData;
 
@@ -507,6 +536,9 @@ Next:
       else
         return DebugUtils::errored(kErrorInvalidInstruction);
     }
+
+    if (cacheEntry)
+      *cacheEntry = cacheKey;
   }
 
   // Validate AVX-512 options:
@@ -725,6 +757,55 @@ ASMJIT_FAVOR_SIZE Error X86InstImpl::checkFeatures(uint32_t archType, const Inst
 }
 #endif
 
+// ============================================================================
+// [asmjit::X86InstImpl - Test]
+// ============================================================================
+
+#if defined(ASMJIT_TEST) && !defined(ASMJIT_DISABLE_VALIDATION)
+static uint32_t X86InstImpl_getCachedCount(const X86Inst::ValidationCache& cache) noexcept {
+  uint32_t count = 0;
+  for (uint32_t i = 0; i < X86Inst::ValidationCache::kEntryCount; i++)
+    count += cache.entries[i].instId != 0;
+  return count;
+}
+
+UNIT(x86_inst_validation_cache) {
+  X86Inst::ValidationCache cache;
+  cache.reset();
+
+  Operand_ rr[2] = { x86::eax, x86::ebx };
+  Operand_ rm[2] = { x86::eax, x86::dword_ptr(x86::ecx) };
+  Operand_ mm[2] = { x86::dword_ptr(x86::ecx), x86::dword_ptr(x86::edx) };
+  Operand_ bad[2] = { x86::rax, x86::ebx };
+  Inst::Detail add(X86Inst::kIdAdd);
+
+  INFO("Checking that matched signatures are cached");
+  EXPECT(X86InstImpl::validate(ArchInfo::kTypeX64, add, rr, 2, &cache) == kErrorOk);
+  EXPECT(X86InstImpl_getCachedCount(cache) == 1);
+  EXPECT(X86InstImpl::validate(ArchInfo::kTypeX64, add, rr, 2, &cache) == kErrorOk);
+  EXPECT(X86InstImpl_getCachedCount(cache) == 1);
+  EXPECT(X86InstImpl::validate(ArchInfo::kTypeX64, add, rm, 2, &cache) == kErrorOk);
+  EXPECT(X86InstImpl_getCachedCount(cache) == 2);
+
+  INFO("Checking that invalid forms are not cached");
+  EXPECT(X86InstImpl::validate(ArchInfo::kTypeX64, add, mm, 2, &cache) == kErrorInvalidInstruction);
+  EXPECT(X86InstImpl::validate(ArchInfo::kTypeX64, add, bad, 2, &cache) == kErrorInvalidInstruction);
+  EXPECT(X86InstImpl::validate(ArchInfo::kTypeX64, add, mm, 2, &cache) == kErrorInvalidInstruction);
+  EXPECT(X86InstImpl_getCachedCount(cache) == 2);
+
+  INFO("Checking that operand values are still validated on a cache hit");
+  Operand_ hi[2] = { x86::ah, x86::bl };
+  Operand_ hiRex[2] = { x86::ah, x86::r8b };
+  EXPECT(X86InstImpl::validate(ArchInfo::kTypeX64, add, hi, 2, &cache) == kErrorOk);
+  EXPECT(X86InstImpl::validate(ArchInfo::kTypeX64, add, hiRex, 2, &cache) != kErrorOk);
+
+  INFO("Checking that the cache is keyed by architecture");
+  Operand_ r64[2] = { x86::rax, x86::rbx };
+  EXPECT(X86InstImpl::validate(ArchInfo::kTypeX64, add, r64, 2, &cache) == kErrorOk);
+  EXPECT(X86InstImpl::validate(ArchInfo::kTypeX86, add, r64, 2, &cache) != kErrorOk);
+}
+#endif // ASMJIT_TEST && !ASMJIT_DISABLE_VALIDATION
+
 } // asmjit namespace
 
 // [Api-End]
@@ -26,7 +26,7 @@ namespace asmjit {
 //! The purpose of `X86InstImpl` is to move most of the logic out of `X86Inst`.
 struct X86InstImpl {
   #if !defined(ASMJIT_DISABLE_VALIDATION)
-  static Error validate(uint32_t archType, const Inst::Detail& detail, const Operand_* operands, uint32_t count) noexcept;
+  static Error validate(uint32_t archType, const Inst::Detail& detail, const Operand_* operands, uint32_t count, X86Inst::ValidationCache* cache = nullptr) noexcept;
   #endif
 
   #if !defined(ASMJIT_DISABLE_EXTENSIONS)
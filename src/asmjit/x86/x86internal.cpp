@@ -12,6 +12,9 @@
 #if defined(ASMJIT_BUILD_X86)
 
 // [Dependencies]
+#include "../base/codebuilder.h"
+#include "../base/runtime.h"
+#include "../x86/x86assembler.h"
 #include "../x86/x86internal_p.h"
 
 // [Api-Begin]
@@ -56,7 +59,7 @@ public:
     uint32_t srcRegs;                    //!< Source registers that need shuffling.
     uint32_t dstRegs;                    //!< Destination registers that need shuffling.
     uint8_t numOps;                      //!< Number of operations to finish.
-    uint8_t numSwaps;                    //!< Number of register swaps.
+    uint8_t numSwaps;                    //!< Number of register cycles (swaps).
     uint8_t numStackArgs;                //!< Number of stack loads.
     uint8_t reserved[9];                 //!< Reserved (only used as padding).
     uint8_t argIndex[32];                //!< Only valid if a corresponding bit in `userRegs` is true.
@@ -144,15 +147,6 @@ ASMJIT_FAVOR_SIZE Error X86FuncArgsContext::initWorkData(const FuncArgsMapper& a
       if (dstRegKind == srcRegKind) {
         // The best case, register is allocated where it is expected to be.
         if (dstRegId == srcRegId) continue;
-
-        // Detect a register swap.
-        if (dstData.usedRegs & srcRegMask) {
-          const SrcArg& ref = func.getArg(dstData.argIndex[srcRegId]);
-          if (ref.byReg() && X86Reg::kindOf(ref.getRegType()) == dstRegKind && ref.getRegId() == dstRegId) {
-            dstData.numSwaps++;
-            _hasRegSwaps = true;
-          }
-        }
         dstData.srcRegs |= srcRegMask;
       }
       else {
@@ -172,6 +166,36 @@ ASMJIT_FAVOR_SIZE Error X86FuncArgsContext::initWorkData(const FuncArgsMapper& a
     dstData.dstRegs |= dstRegMask;
   }
 
+  // Count register cycles (including swaps), each cycle needs a temporary
+  // register (or `xchg`) to be resolved. A cycle is counted once, when it's
+  // reached from its lowest destination register.
+  for (i = 0; i < kMaxVRegKinds; i++) {
+    WorkData& wd = _workData[i];
+    uint32_t regsToCheck = wd.dstRegs;
+
+    while (regsToCheck) {
+      uint32_t startId = Utils::findFirstBit(regsToCheck);
+      uint32_t regId = startId;
+      regsToCheck ^= Utils::mask(startId);
+
+      for (uint32_t n = 0; n < 32; n++) {
+        const SrcArg& srcArg = func.getArg(wd.argIndex[regId]);
+        if (!srcArg.byReg() || X86Reg::kindOf(srcArg.getRegType()) != i)
+          break;
+
+        regId = srcArg.getRegId();
+        if (regId < startId || !(wd.dstRegs & Utils::mask(regId)))
+          break;
+
+        if (regId == startId) {
+          wd.numSwaps++;
+          _hasRegSwaps = true;
+          break;
+        }
+      }
+    }
+  }
+
   return kErrorOk;
 }
 
@@ -461,6 +485,20 @@ ASMJIT_FAVOR_SIZE Error X86Internal::initFuncDetail(FuncDetail& func, const Func
         break;
       }
     }
+
+    // Custom calling conventions can override registers used to return.
+    for (i = 0; i < func.getRetCount(); i++) {
+      FuncDetail::Value& ret = func._rets[i];
+      uint32_t regType = ret.getRegType();
+      uint32_t kind = X86Reg::kindOf(regType);
+
+      if (kind != X86Reg::kKindGp && kind != X86Reg::kKindVec)
+        continue;
+
+      uint32_t regId = cc.getRetOrder(kind)[i];
+      if (regId != 0xFF)
+        ret.initReg(ret.getTypeId(), regType, regId);
+    }
   }
 
   uint32_t stackBase = gpSize;
@@ -685,6 +723,23 @@ ASMJIT_FAVOR_SIZE Error X86Internal::initFrameLayout(FuncFrameLayout& layout, co
   if (dsa)
     layout._stackAdjustment = Utils::alignTo(layout._stackAdjustment, stackAlignment);
 
+  // A leaf function that fits into the red zone (AMD64 SysV) doesn't have to
+  // adjust the stack at all, it uses the stack below ESP|RSP, which is never
+  // clobbered by signal and interrupt handlers. All offsets relative to ESP|RSP
+  // are rebased, so they wrap around (become negative).
+  uint32_t stackAdjustment = layout._stackAdjustment;
+  if (stackAdjustment && stackAdjustment <= func.getRedZoneSize() && !ffi.hasCalls() && !dsa) {
+    layout._redZoneUsed = true;
+    layout._stackAdjustment = 0;
+
+    layout._stackBaseOffset -= stackAdjustment;
+    layout._vecStackOffset -= stackAdjustment;
+    layout._gpStackOffset -= stackAdjustment;
+
+    if (stackArgsRegId == X86Gp::kIdSp)
+      layout._stackArgsOffset -= stackAdjustment;
+  }
+
   // Initialize variables based on CallConv flags.
   if (func.hasFlag(CallConv::kFlagCalleePopsStack))
     layout._calleeStackCleanup = static_cast<uint16_t>(func.getArgStackSize());
@@ -793,6 +848,24 @@ ASMJIT_FAVOR_SIZE Error X86Internal::emitRegMove(X86Emitter* emitter,
         break;
       }
 
+      // Home slots of vectors wider than 16 bytes are only 16-byte aligned
+      // (it avoids dynamic stack alignment), use unaligned moves to access
+      // them. VEX|EVEX encoded unaligned moves are as fast as aligned ones
+      // when the address is aligned.
+      if (memFlags && TypeId::sizeOf(typeId) > 16) {
+        if (elementTypeId == TypeId::kF32)
+          instId = X86Inst::kIdVmovups;
+        else if (elementTypeId == TypeId::kF64)
+          instId = X86Inst::kIdVmovupd;
+        else if (typeId <= TypeId::_kVec256End)
+          instId = X86Inst::kIdVmovdqu;
+        else if (elementTypeId <= TypeId::kU32)
+          instId = X86Inst::kIdVmovdqu32;
+        else
+          instId = X86Inst::kIdVmovdqu64;
+        break;
+      }
+
       if (elementTypeId == TypeId::kF32)
         instId = avxEnabled ? X86Inst::kIdVmovaps : X86Inst::kIdMovaps;
       else if (elementTypeId == TypeId::kF64)
@@ -1023,6 +1096,20 @@ ASMJIT_FAVOR_SIZE Error X86Internal::emitArgMove(X86Emitter* emitter,
 // [asmjit::X86Internal - Emit Prolog & Epilog]
 // ============================================================================
 
+//! \internal
+//!
+//! Record an \ref UnwindOp at the current position, if enabled by
+//! `CodeHolder::setUnwindEnabled()`.
+static ASMJIT_FAVOR_SIZE Error X86Internal_addUnwindOp(X86Emitter* emitter, uint32_t type, uint32_t regId = Globals::kInvalidRegId, int32_t value = 0) {
+  CodeHolder* code = emitter->getCode();
+  if (!code->isUnwindEnabled())
+    return kErrorOk;
+
+  Label label = emitter->newLabel();
+  ASMJIT_PROPAGATE(emitter->bind(label));
+  return code->addUnwindOp(label.getId(), type, regId, value);
+}
+
 ASMJIT_FAVOR_SIZE Error X86Internal::emitProlog(X86Emitter* emitter, const FuncFrameLayout& layout) {
   uint32_t gpSaved = layout.getSavedRegs(X86Reg::kKindGp);
 
@@ -1033,12 +1120,16 @@ ASMJIT_FAVOR_SIZE Error X86Internal::emitProlog(X86Emitter* emitter, const FuncF
   X86Gp gpReg = emitter->zsp(); // General purpose register (temporary).
   X86Gp saReg = emitter->zsp(); // Stack-arguments base register.
 
+  ASMJIT_PROPAGATE(X86Internal_addUnwindOp(emitter, UnwindOp::kTypeFuncBegin));
+
   // Emit: 'push zbp'
   //       'mov  zbp, zsp'.
   if (layout.hasPreservedFP()) {
     gpSaved &= ~Utils::mask(X86Gp::kIdBp);
     ASMJIT_PROPAGATE(emitter->push(zbp));
+    ASMJIT_PROPAGATE(X86Internal_addUnwindOp(emitter, UnwindOp::kTypePush, X86Gp::kIdBp));
     ASMJIT_PROPAGATE(emitter->mov(zbp, zsp));
+    ASMJIT_PROPAGATE(X86Internal_addUnwindOp(emitter, UnwindOp::kTypeSetFrame, X86Gp::kIdBp));
   }
 
   // Emit: 'push gp' sequence.
@@ -1047,6 +1138,7 @@ ASMJIT_FAVOR_SIZE Error X86Internal::emitProlog(X86Emitter* emitter, const FuncF
       if (!(i & 0x1)) continue;
       gpReg.setId(regId);
       ASMJIT_PROPAGATE(emitter->push(gpReg));
+      ASMJIT_PROPAGATE(X86Internal_addUnwindOp(emitter, UnwindOp::kTypePush, regId));
     }
   }
 
@@ -1057,19 +1149,28 @@ ASMJIT_FAVOR_SIZE Error X86Internal::emitProlog(X86Emitter* emitter, const FuncF
     if (!(layout.hasPreservedFP() && stackArgsRegId == X86Gp::kIdBp))
       ASMJIT_PROPAGATE(emitter->mov(saReg, zsp));
   }
+  else {
+    stackArgsRegId = Globals::kInvalidRegId;
+  }
 
   // Emit: 'and zsp, StackAlignment'.
-  if (layout.hasDynamicAlignment())
-    ASMJIT_PROPAGATE(emitter->and_(zsp, -static_cast<int32_t>(layout.getStackAlignment())));
+  if (layout.hasDynamicAlignment()) {
+    int32_t alignment = static_cast<int32_t>(layout.getStackAlignment());
+    ASMJIT_PROPAGATE(emitter->and_(zsp, -alignment));
+    ASMJIT_PROPAGATE(X86Internal_addUnwindOp(emitter, UnwindOp::kTypeAlign, stackArgsRegId, alignment));
+  }
 
   // Emit: 'sub zsp, StackAdjustment'.
-  if (layout.hasStackAdjustment())
+  if (layout.hasStackAdjustment()) {
     ASMJIT_PROPAGATE(emitter->sub(zsp, layout.getStackAdjustment()));
+    ASMJIT_PROPAGATE(X86Internal_addUnwindOp(emitter, UnwindOp::kTypeAlloc, Globals::kInvalidRegId, static_cast<int32_t>(layout.getStackAdjustment())));
+  }
 
   // Emit: 'mov [zsp + dsaSlot], saReg'.
   if (layout.hasDynamicAlignment() && layout.hasDsaSlotUsed()) {
     X86Mem saMem = x86::ptr(zsp, layout._dsaSlot);
     ASMJIT_PROPAGATE(emitter->mov(saMem, saReg));
+    ASMJIT_PROPAGATE(X86Internal_addUnwindOp(emitter, UnwindOp::kTypeSaveSp, saReg.getId(), static_cast<int32_t>(layout._dsaSlot)));
   }
 
   // Emit 'movaps|movups [zsp + X], xmm0..15'.
@@ -1085,14 +1186,15 @@ ASMJIT_FAVOR_SIZE Error X86Internal::emitProlog(X86Emitter* emitter, const FuncF
       if (!(i & 0x1)) continue;
       vecReg.setId(regId);
       ASMJIT_PROPAGATE(emitter->emit(vecInst, vecBase, vecReg));
+      ASMJIT_PROPAGATE(X86Internal_addUnwindOp(emitter, UnwindOp::kTypeSaveVec, regId, vecBase.getOffsetLo32()));
       vecBase.addOffsetLo32(static_cast<int32_t>(vecSize));
     }
   }
 
-  return kErrorOk;
+  return X86Internal_addUnwindOp(emitter, UnwindOp::kTypePrologEnd);
 }
 
-ASMJIT_FAVOR_SIZE Error X86Internal::emitEpilog(X86Emitter* emitter, const FuncFrameLayout& layout) {
+ASMJIT_FAVOR_SIZE Error X86Internal::emitEpilog(X86Emitter* emitter, const FuncFrameLayout& layout, bool tailCall) {
   uint32_t i;
   uint32_t regId;
 
@@ -1108,6 +1210,11 @@ ASMJIT_FAVOR_SIZE Error X86Internal::emitEpilog(X86Emitter* emitter, const FuncF
   // Don't emit 'pop zbp' in the pop sequence, this case is handled separately.
   if (layout.hasPreservedFP()) gpSaved &= ~Utils::mask(X86Gp::kIdBp);
 
+  // Distance from `zsp` to the end of the return address once `zsp` points
+  // to the saved registers.
+  int32_t savedSpOffset = static_cast<int32_t>(layout.getGpStackSize() + gpSize);
+  ASMJIT_PROPAGATE(X86Internal_addUnwindOp(emitter, UnwindOp::kTypeEpilogBegin));
+
   // Emit 'movaps|movups xmm0..15, [zsp + X]'.
   uint32_t xmmSaved = layout.getSavedRegs(X86Reg::kKindVec);
   if (xmmSaved) {
@@ -1136,16 +1243,20 @@ ASMJIT_FAVOR_SIZE Error X86Internal::emitEpilog(X86Emitter* emitter, const FuncF
       ASMJIT_PROPAGATE(emitter->mov(zsp, zbp));
     else
       ASMJIT_PROPAGATE(emitter->lea(zsp, x86::ptr(zbp, -count)));
+    ASMJIT_PROPAGATE(X86Internal_addUnwindOp(emitter, UnwindOp::kTypeRestoreSp, Globals::kInvalidRegId, savedSpOffset));
   }
   else {
     if (layout.hasDynamicAlignment() && layout.hasDsaSlotUsed()) {
       // Emit 'mov zsp, [zsp + DsaSlot]'.
       X86Mem saMem = x86::ptr(zsp, layout._dsaSlot);
       ASMJIT_PROPAGATE(emitter->mov(zsp, saMem));
+      ASMJIT_PROPAGATE(X86Internal_addUnwindOp(emitter, UnwindOp::kTypeRestoreSp, Globals::kInvalidRegId, savedSpOffset));
     }
     else if (layout.hasStackAdjustment()) {
       // Emit 'add zsp, StackAdjustment'.
-      ASMJIT_PROPAGATE(emitter->add(zsp, static_cast<int32_t>(layout.getStackAdjustment())));
+      int32_t adjustment = static_cast<int32_t>(layout.getStackAdjustment());
+      ASMJIT_PROPAGATE(emitter->add(zsp, adjustment));
+      ASMJIT_PROPAGATE(X86Internal_addUnwindOp(emitter, UnwindOp::kTypeFree, Globals::kInvalidRegId, adjustment));
     }
   }
 
@@ -1159,13 +1270,21 @@ ASMJIT_FAVOR_SIZE Error X86Internal::emitEpilog(X86Emitter* emitter, const FuncF
       if (i & 0x8000) {
         gpReg.setId(regId);
         ASMJIT_PROPAGATE(emitter->pop(gpReg));
+        ASMJIT_PROPAGATE(X86Internal_addUnwindOp(emitter, UnwindOp::kTypePop, regId));
       }
       i <<= 1;
     } while (regId != 0);
   }
 
   // Emit 'pop zbp'.
-  if (layout.hasPreservedFP()) ASMJIT_PROPAGATE(emitter->pop(zbp));
+  if (layout.hasPreservedFP()) {
+    ASMJIT_PROPAGATE(emitter->pop(zbp));
+    ASMJIT_PROPAGATE(X86Internal_addUnwindOp(emitter, UnwindOp::kTypePop, X86Gp::kIdBp));
+  }
+
+  // Tail call jumps to the callee instead of 'ret'.
+  if (tailCall)
+    return X86Internal_addUnwindOp(emitter, UnwindOp::kTypeEpilogEnd);
 
   // Emit 'ret' or 'ret x'.
   if (layout.hasCalleeStackCleanup())
@@ -1173,7 +1292,7 @@ ASMJIT_FAVOR_SIZE Error X86Internal::emitEpilog(X86Emitter* emitter, const FuncF
   else
     ASMJIT_PROPAGATE(emitter->emit(X86Inst::kIdRet));
 
-  return kErrorOk;
+  return X86Internal_addUnwindOp(emitter, UnwindOp::kTypeEpilogEnd);
 }
 
 // ============================================================================
@@ -1205,11 +1324,19 @@ ASMJIT_FAVOR_SIZE Error X86Internal::allocArgs(X86Emitter* emitter, const FuncFr
   for (i = 0; i < kMaxVRegKinds; i++)
     freeRegs[i] = ctx._workData[i].workRegs & ~ctx._workData[i].srcRegs;
 
-  // This is an iterative process that runs until there is a work to do. When
-  // one register is moved it can create space for another move. Such moves can
-  // depend on each other so the algorithm may run multiple times before all
-  // arguments are in place. This part does only register-to-register work,
-  // arguments moved from stack-to-register area handled later.
+  // Current source register of each argument passed by register. It changes
+  // when a cycle is broken and the source is moved to a different register.
+  uint8_t srcRegIds[kFuncArgCountLoHi];
+  for (i = 0; i < kFuncArgCountLoHi; i++)
+    srcRegIds[i] = static_cast<uint8_t>(func.getArg(i).getRegId());
+
+  // Register-to-register moves form a parallel copy. Each iteration emits
+  // all moves that have their destination free, which in turn frees their
+  // sources. When nothing can be moved only cycles remain - one register of
+  // a cycle is moved to a free register (or swapped by `xchg` if it's a GP
+  // register and no register is free) and the iteration continues. A cycle
+  // of N registers is resolved by N+1 moves or N-1 swaps. Arguments moved
+  // from stack-to-register are handled later.
   for (;;) {
     bool hasWork = false; // Do we have a work to do?
     bool didWork = false; // If we did something...
@@ -1233,58 +1360,25 @@ ASMJIT_FAVOR_SIZE Error X86Internal::allocArgs(X86Emitter* emitter, const FuncFr
           const DstArg& dstArg = args.getArg(argIndex);
           const SrcArg& srcArg = func.getArg(argIndex);
 
-          if (srcArg.byReg()) {
+          if (srcArg.byReg() && (freeRegs[dstRegKind] & dstRegMask)) {
             uint32_t srcRegType = srcArg.getRegType();
             uint32_t srcRegKind = X86Reg::kindOf(srcRegType);
-
-            if (freeRegs[dstRegKind] & dstRegMask) {
-              X86Reg dstReg(X86Reg::fromTypeAndId(dstArg.getRegType(), dstRegId));
-              X86Reg srcReg(X86Reg::fromTypeAndId(srcRegType, srcArg.getRegId()));
-
-              ASMJIT_PROPAGATE(
-                emitArgMove(emitter,
-                  dstReg, dstArg.getTypeId(),
-                  srcReg, srcArg.getTypeId(), avxEnabled));
-              freeRegs[dstRegKind] ^= dstRegMask;                     // Make the DST reg occupied.
-              freeRegs[srcRegKind] |= Utils::mask(srcArg.getRegId()); // Make the SRC reg free.
-
-              ASMJIT_ASSERT(wd.numOps >= 1);
-              wd.numOps--;
-              didWork = true;
-            }
-            else {
-              // Check if this is a swap operation.
-              if (dstRegKind == srcRegKind) {
-                uint32_t srcRegId = srcArg.getRegId();
-
-                uint32_t otherIndex = wd.argIndex[srcRegId];
-                const DstArg& otherArg = args.getArg(otherIndex);
-
-                if (otherArg.getRegId() == srcRegId && X86Reg::kindOf(otherArg.getRegType()) == dstRegKind) {
-                  // If this is GP reg it can be handled by 'xchg'.
-                  if (dstRegKind == X86Reg::kKindGp) {
-                    uint32_t highestType = std::max(dstArg.getRegType(), srcRegType);
-
-                    X86Reg dstReg = x86::gpd(dstRegId);
-                    X86Reg srcReg = x86::gpd(srcRegId);
-
-                    if (highestType == X86Reg::kRegGpq) {
-                      dstReg.setSignature(X86RegTraits<X86Reg::kRegGpq>::kSignature);
-                      srcReg.setSignature(X86RegTraits<X86Reg::kRegGpq>::kSignature);
-                    }
-                    ASMJIT_PROPAGATE(emitter->emit(X86Inst::kIdXchg, dstReg, srcReg));
-                    regsToDo &= ~Utils::mask(srcRegId);
-                    freeRegs[dstRegKind] &= ~(Utils::mask(srcRegId) | dstRegMask);
-
-                    ASMJIT_ASSERT(wd.numOps >= 2);
-                    ASMJIT_ASSERT(wd.numSwaps >= 1);
-                    wd.numOps-=2;
-                    wd.numSwaps--;
-                    didWork = true;
-                  }
-                }
-              }
-            }
+            uint32_t srcRegId = srcRegIds[argIndex];
+
+            X86Reg dstReg(X86Reg::fromTypeAndId(dstArg.getRegType(), dstRegId));
+            X86Reg srcReg(X86Reg::fromTypeAndId(srcRegType, srcRegId));
+
+            ASMJIT_PROPAGATE(
+              emitArgMove(emitter,
+                dstReg, dstArg.getTypeId(),
+                srcReg, srcArg.getTypeId(), avxEnabled));
+            freeRegs[dstRegKind] ^= dstRegMask;           // Make the DST reg occupied.
+            freeRegs[srcRegKind] |= Utils::mask(srcRegId); // Make the SRC reg free.
+
+            ASMJIT_ASSERT(wd.numOps >= 1);
+            wd.dstRegs ^= dstRegMask;
+            wd.numOps--;
+            didWork = true;
           }
 
           // Clear the reg in `regsToDo` and continue if there are more.
@@ -1296,6 +1390,100 @@ ASMJIT_FAVOR_SIZE Error X86Internal::allocArgs(X86Emitter* emitter, const FuncFr
     if (!hasWork)
       break;
 
+    if (didWork)
+      continue;
+
+    // Only cycles remain, which means that each pending destination register
+    // holds a source of another pending argument. Break the first one found.
+    dstRegKind = kMaxVRegKinds;
+    do {
+      WorkData& wd = ctx._workData[--dstRegKind];
+      if (wd.numOps <= wd.numStackArgs)
+        continue;
+
+      uint32_t regsToDo = wd.dstRegs;
+      while (regsToDo) {
+        uint32_t dstRegId = Utils::findFirstBit(regsToDo);
+        uint32_t dstRegMask = Utils::mask(dstRegId);
+        regsToDo ^= dstRegMask;
+
+        uint32_t argIndex = wd.argIndex[dstRegId];
+        const SrcArg& srcArg = func.getArg(argIndex);
+        if (!srcArg.byReg())
+          continue;
+
+        // Find the pending argument that uses `dstRegId` as its source.
+        uint32_t otherIndex = kFuncArgCountLoHi;
+        for (i = 0; i < kFuncArgCountLoHi; i++) {
+          const SrcArg& otherSrc = func.getArg(i);
+          const DstArg& otherDst = args.getArg(i);
+
+          if (!otherDst.isAssigned() || !otherSrc.byReg() || srcRegIds[i] != dstRegId ||
+              X86Reg::kindOf(otherSrc.getRegType()) != dstRegKind)
+            continue;
+
+          uint32_t otherKind = X86Reg::kindOf(otherDst.getRegType());
+          if (ctx._workData[otherKind].dstRegs & Utils::mask(otherDst.getRegId())) {
+            otherIndex = i;
+            break;
+          }
+        }
+
+        if (otherIndex == kFuncArgCountLoHi)
+          continue;
+
+        const SrcArg& otherSrc = func.getArg(otherIndex);
+        // Prefer registers not used by arguments, but a register that will
+        // be loaded from stack later is fine as well.
+        uint32_t tmpRegs = freeRegs[dstRegKind] & wd.workRegs & ~wd.usedRegs;
+        if (!tmpRegs)
+          tmpRegs = freeRegs[dstRegKind] & wd.workRegs & wd.dstRegs;
+
+        if (tmpRegs) {
+          // Move the source of the other argument to a free register.
+          uint32_t tmpRegId = Utils::findFirstBit(tmpRegs);
+          X86Reg tmpReg(X86Reg::fromTypeAndId(otherSrc.getRegType(), tmpRegId));
+          X86Reg srcReg(X86Reg::fromTypeAndId(otherSrc.getRegType(), dstRegId));
+
+          ASMJIT_PROPAGATE(emitRegMove(emitter, tmpReg, srcReg, otherSrc.getTypeId(), avxEnabled));
+          freeRegs[dstRegKind] ^= Utils::mask(tmpRegId) | dstRegMask;
+          srcRegIds[otherIndex] = static_cast<uint8_t>(tmpRegId);
+        }
+        else if (dstRegKind == X86Reg::kKindGp && X86Reg::kindOf(srcArg.getRegType()) == X86Reg::kKindGp) {
+          // Swap the destination with its source, the other argument's value
+          // is moved to the source register. Swap whole registers so no bits
+          // of the other argument are lost and convert the value afterwards.
+          const DstArg& dstArg = args.getArg(argIndex);
+          uint32_t srcRegId = srcRegIds[argIndex];
+
+          ASMJIT_PROPAGATE(emitter->emit(X86Inst::kIdXchg, emitter->gpz(dstRegId), emitter->gpz(srcRegId)));
+
+          uint32_t dstTypeId = dstArg.getTypeId();
+          if (!dstTypeId)
+            dstTypeId = x86OpData.archRegs.regTypeToTypeId[dstArg.getRegType()];
+
+          if (dstTypeId != srcArg.getTypeId()) {
+            X86Reg dstReg(X86Reg::fromTypeAndId(dstArg.getRegType(), dstRegId));
+            X86Reg srcReg(X86Reg::fromTypeAndId(srcArg.getRegType(), dstRegId));
+            ASMJIT_PROPAGATE(emitArgMove(emitter, dstReg, dstTypeId, srcReg, srcArg.getTypeId(), avxEnabled));
+          }
+
+          srcRegIds[otherIndex] = static_cast<uint8_t>(srcRegId);
+          freeRegs[dstRegKind] &= ~dstRegMask;
+
+          ASMJIT_ASSERT(wd.numOps >= 1);
+          wd.dstRegs ^= dstRegMask;
+          wd.numOps--;
+        }
+        else {
+          continue;
+        }
+
+        didWork = true;
+        break;
+      }
+    } while (!didWork && dstRegKind);
+
     if (!didWork)
       return DebugUtils::errored(kErrorInvalidState);
   }
@@ -1351,6 +1539,154 @@ ASMJIT_FAVOR_SIZE Error X86Internal::allocArgs(X86Emitter* emitter, const FuncFr
   return kErrorOk;
 }
 
+// ============================================================================
+// [asmjit::X86Internal - Serialize]
+// ============================================================================
+
+#if !defined(ASMJIT_DISABLE_BUILDER)
+Error X86Internal::serialize(CodeBuilder* cb, X86Assembler* a) {
+  const Operand_& none = a->_none;
+
+  for (CBNode* node_ = cb->getFirstNode(); node_; node_ = node_->getNext()) {
+    Error err;
+    uint32_t nodeType = node_->getType();
+
+    if (nodeType == CBNode::kNodeInst || nodeType == CBNode::kNodeFuncCall) {
+      // Case jumps only describe edges of a jump table.
+      if (node_->isCase())
+        continue;
+
+      // `X86Assembler::_emit()` resets options, extra register, and inline
+      // comment after each instruction, so only options must always be set.
+      // Reserved options come from global options of `a`, the node could be
+      // created while a logger was attached (see `CodeBuilder::replay()`).
+      CBInst* node = node_->as<CBInst>();
+      a->setOptions(node->getOptions() & ~CodeEmitter::kOptionReservedMask);
+
+      if (node->hasExtraReg())
+        a->setExtraReg(node->getExtraReg());
+
+      if (node->getInlineComment())
+        a->setInlineComment(node->getInlineComment());
+
+      uint32_t instId = node->getInstId();
+      Operand opBuf[CBInst::kMaxPackedOps];
+      const Operand* op = node->getOpArray(opBuf);
+
+      switch (node->getOpCount()) {
+        case 0 : err = a->X86Assembler::_emit(instId, none , none , none , none ); break;
+        case 1 : err = a->X86Assembler::_emit(instId, op[0], none , none , none ); break;
+        case 2 : err = a->X86Assembler::_emit(instId, op[0], op[1], none , none ); break;
+        case 3 : err = a->X86Assembler::_emit(instId, op[0], op[1], op[2], none ); break;
+        case 4 : err = a->X86Assembler::_emit(instId, op[0], op[1], op[2], op[3]); break;
+        default: err = a->Assembler::_emitOpArray(instId, op, node->getOpCount()); break;
+      }
+    }
+    else if (nodeType == CBNode::kNodeLabel || nodeType == CBNode::kNodeFunc) {
+      if (node_->getInlineComment())
+        a->setInlineComment(node_->getInlineComment());
+      err = a->Assembler::bind(static_cast<CBLabel*>(node_)->getLabel());
+    }
+    else {
+      err = cb->serializeNode(a, node_);
+    }
+
+    if (ASMJIT_UNLIKELY(err))
+      return err;
+  }
+
+  return kErrorOk;
+}
+#endif // !ASMJIT_DISABLE_BUILDER
+
+// ============================================================================
+// [asmjit::X86Internal - Test]
+// ============================================================================
+
+#if defined(ASMJIT_TEST) && ASMJIT_ARCH_X64
+// Emits a function that rotates its arguments by one register of the same
+// kind, so `allocArgs()` has to resolve a register cycle.
+template<typename Func>
+static Func X86InternalTest_makeRotated(JitRuntime& rt, const FuncSignature& sign, uint32_t argCount, bool vec) noexcept {
+  using namespace x86;
+
+  CodeHolder code;
+  code.init(rt.getCodeInfo());
+  X86Assembler a(&code);
+
+  FuncDetail func;
+  if (func.init(sign) != kErrorOk)
+    return nullptr;
+
+  FuncFrameInfo ffi;
+  FuncArgsMapper args(&func);
+
+  uint32_t ids[4];
+  for (uint32_t i = 0; i < argCount; i++)
+    ids[i] = func.getArg(i).getRegId();
+
+  for (uint32_t i = 0; i < argCount; i++) {
+    uint32_t id = ids[(i + 1) % argCount];
+    if (vec)
+      args.assign(i, xmm(id), TypeId::kF64x1);
+    else
+      args.assign(i, gpq(id), TypeId::kI64);
+  }
+
+  ffi.addDirtyRegs(X86Reg::kKindGp, Utils::mask(X86Gp::kIdAx));
+  args.updateFrameInfo(ffi);
+
+  FuncFrameLayout layout;
+  if (layout.init(func, ffi) != kErrorOk)
+    return nullptr;
+
+  FuncUtils::emitProlog(a.asEmitter(), layout);
+  if (FuncUtils::allocArgs(a.asEmitter(), layout, args) != kErrorOk)
+    return nullptr;
+
+  // Return `((a0 - a1) * a2) - a3` (without `a3` if there are only 3 args).
+  if (vec) {
+    X86Xmm r = xmm(ids[1]);
+    a.subsd(r, xmm(ids[2]));
+    a.mulsd(r, xmm(ids[3]));
+    a.subsd(r, xmm(ids[0]));
+    a.movapd(xmm0, r);
+  }
+  else {
+    a.mov(rax, gpq(ids[1]));
+    a.sub(rax, gpq(ids[2]));
+    a.imul(rax, gpq(ids[0]));
+  }
+  FuncUtils::emitEpilog(a.asEmitter(), layout);
+
+  Func fn;
+  if (a.getLastError() != kErrorOk || rt.add(&fn, &code) != kErrorOk)
+    return nullptr;
+  return fn;
+}
+
+UNIT(x86_internal_alloc_args) {
+  typedef int64_t (*GpFunc)(int64_t, int64_t, int64_t);
+  typedef double (*VecFunc)(double, double, double, double);
+
+  JitRuntime rt;
+
+  INFO("Resolving a cycle of 3 GP registers");
+  GpFunc gpFn = X86InternalTest_makeRotated<GpFunc>(rt,
+    FuncSignature3<int64_t, int64_t, int64_t, int64_t>(CallConv::kIdHost), 3, false);
+  EXPECT(gpFn != nullptr);
+  EXPECT(gpFn(10, 3, 7) == (10 - 3) * 7);
+  rt.release(gpFn);
+
+  INFO("Resolving a cycle of 4 XMM registers");
+  VecFunc vecFn = X86InternalTest_makeRotated<VecFunc>(rt,
+    FuncSignature4<double, double, double, double, double>(CallConv::kIdHost), 4, true);
+  EXPECT(vecFn != nullptr);
+  EXPECT(vecFn(10.0, 3.0, 7.0, 2.0) == ((10.0 - 3.0) * 7.0) - 2.0);
+  rt.release(vecFn);
+}
+#endif // ASMJIT_TEST && ASMJIT_ARCH_X64
+
 } // asmjit namespace
 
 // [Api-End]
@@ -20,6 +20,9 @@
 
 namespace asmjit {
 
+class CodeBuilder;
+class X86Assembler;
+
 //! \addtogroup asmjit_base
 //! \{
 
@@ -45,8 +48,8 @@ struct X86Internal {
   //! Emit function prolog.
   static Error emitProlog(X86Emitter* emitter, const FuncFrameLayout& layout);
 
-  //! Emit function epilog.
-  static Error emitEpilog(X86Emitter* emitter, const FuncFrameLayout& layout);
+  //! Emit function epilog, without the final `ret` if `tailCall` is true.
+  static Error emitEpilog(X86Emitter* emitter, const FuncFrameLayout& layout, bool tailCall = false);
 
   //! Emit a pure move operation between two registers or the same type or
   //! between a register and its home slot. This function does not handle
@@ -66,6 +69,15 @@ struct X86Internal {
     const Operand_& src_, uint32_t srcTypeId, bool avxEnabled, const char* comment = nullptr);
 
   static Error allocArgs(X86Emitter* emitter, const FuncFrameLayout& layout, const FuncArgsMapper& args);
+
+#if !defined(ASMJIT_DISABLE_BUILDER)
+  //! Serialize all nodes of `cb` into `a`.
+  //!
+  //! Specialized `CodeBuilder::serialize()` that calls `X86Assembler` directly
+  //! instead of through `CodeEmitter` virtuals. Nodes other than instructions
+  //! and labels are passed to `CodeBuilder::serializeNode()`.
+  static Error serialize(CodeBuilder* cb, X86Assembler* a);
+#endif // !ASMJIT_DISABLE_BUILDER
 };
 
 //! \}
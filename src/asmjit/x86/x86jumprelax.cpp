@@ -0,0 +1,324 @@
+// [AsmJit]
+// Complete x86/x64 JIT and Remote Assembler for C++.
+//
+// [License]
+// Zlib - See LICENSE.md file in the package.
+
+// [Export]
+#define ASMJIT_EXPORTS
+
+// [Guard]
+#include "../asmjit_build.h"
+#if defined(ASMJIT_BUILD_X86) && !defined(ASMJIT_DISABLE_BUILDER)
+
+// [Dependencies]
+#include "../x86/x86assembler.h"
+#include "../x86/x86jumprelax.h"
+
+// [Api-Begin]
+#include "../asmjit_apibegin.h"
+
+namespace asmjit {
+
+// ============================================================================
+// [asmjit::X86JumpRelaxPass - Helpers]
+// ============================================================================
+
+//! \internal
+//!
+//! Forward jump that can be shrunk.
+struct X86RelaxJump {
+  CBJump* node;                          //!< Jump node.
+  uint32_t start;                        //!< Offset of the jump.
+  uint32_t end;                          //!< Offset after the jump.
+};
+
+//! \internal
+//!
+//! Place in code that can grow when the code before it shrinks.
+struct X86RelaxGrowth {
+  uint32_t offset;                       //!< Offset where the code can grow.
+  uint32_t size;                         //!< Maximum growth in bytes.
+};
+
+//! \internal
+//!
+//! Maximum growth of a backward jump that was short in a trial assembly.
+static const uint32_t X86JumpRelax_kBackwardGrowth = 4;
+
+#if !defined(ASMJIT_DISABLE_LOGGING)
+//! \internal
+//!
+//! Logger that discards everything, instruction nodes keep the logging option
+//! of the emitter that created them, which requires a logger. It's disabled,
+//! so the trial assemblies don't format anything.
+class X86JumpRelaxLogger : public Logger {
+public:
+  ASMJIT_NONCOPYABLE(X86JumpRelaxLogger)
+
+  X86JumpRelaxLogger() noexcept { setEnabled(false); }
+  virtual ~X86JumpRelaxLogger() noexcept {}
+
+  virtual Error _log(const char* str, size_t len) noexcept override {
+    ASMJIT_UNUSED(str);
+    ASMJIT_UNUSED(len);
+    return kErrorOk;
+  }
+};
+#endif // !ASMJIT_DISABLE_LOGGING
+
+static ASMJIT_INLINE bool X86JumpRelax_isCandidate(CBNode* node_) noexcept {
+  if (node_->getType() != CBNode::kNodeInst || !node_->hasFlag(CBNode::kFlagIsJmp | CBNode::kFlagIsJcc) || node_->isCase())
+    return false;
+
+  CBJump* node = static_cast<CBJump*>(node_);
+  if (node->getOptions() & (X86Inst::kOptionShortForm | X86Inst::kOptionLongForm))
+    return false;
+
+  return node->getOpCount() == 1 && node->getOpArray()[0].isLabel();
+}
+
+//! \internal
+//!
+//! Get the sum of growths in `(from, to]`.
+static uint32_t X86JumpRelax_getGrowth(const ZoneVector<X86RelaxGrowth>& growths, const ZoneVector<uint32_t>& prefix, uint32_t from, uint32_t to) noexcept {
+  size_t count = growths.getLength();
+  size_t lo = 0, hi = 0;
+
+  // Growths are ordered by offset, find the first growth after `from` and the
+  // first growth after `to`.
+  while (lo < count && growths[lo].offset <= from) lo++;
+  hi = lo;
+  while (hi < count && growths[hi].offset <= to) hi++;
+
+  return prefix[hi] - prefix[lo];
+}
+
+// ============================================================================
+// [asmjit::X86JumpRelaxPass - Construction / Destruction]
+// ============================================================================
+
+X86JumpRelaxPass::X86JumpRelaxPass() noexcept
+  : CBPass("JumpRelax"),
+    _shrunkCount(0),
+    _iterationCount(0) {}
+X86JumpRelaxPass::~X86JumpRelaxPass() noexcept {}
+
+// ============================================================================
+// [asmjit::X86JumpRelaxPass - Process]
+// ============================================================================
+
+//! \internal
+//!
+//! Assemble all nodes of `cb` into `scratch`, record offsets of `jumps` and
+//! places that can grow into `growths`. The first trial (`jumps` empty) also
+//! collects all jumps that can be shrunk.
+static Error X86JumpRelax_assemble(
+  CodeBuilder* cb,
+  CodeHolder& scratch,
+  ZoneHeap* heap,
+  ZoneVector<X86RelaxJump>& jumps,
+  ZoneVector<X86RelaxGrowth>& growths,
+  bool collect) noexcept {
+
+  static const uint8_t zeros[Globals::kMaxAlignment] = { 0 };
+
+  CodeHolder* code = cb->getCode();
+  growths.reset();
+
+  scratch.reset(false);
+  ASMJIT_PROPAGATE(scratch.init(code->getCodeInfo()));
+
+#if !defined(ASMJIT_DISABLE_LOGGING)
+  static X86JumpRelaxLogger nullLogger;
+  if (code->getLogger())
+    scratch.setLogger(&nullLogger);
+#endif // !ASMJIT_DISABLE_LOGGING
+
+  // Label ids must match the ids used by `cb`.
+  for (size_t i = 0, count = code->getLabelsCount(); i < count; i++) {
+    uint32_t id;
+    ASMJIT_PROPAGATE(scratch.newLabelId(id));
+  }
+
+  X86Assembler a(&scratch);
+
+  // Alignment depends on where the code starts in the real .text section.
+  code->sync();
+  size_t base = code->getSectionEntry(0)->getBuffer().getLength() & (Globals::kMaxAlignment - 1);
+  if (base)
+    ASMJIT_PROPAGATE(a.embed(zeros, static_cast<uint32_t>(base)));
+
+  size_t jumpIndex = 0;
+  bool hasAlign = false;
+  bool inOtherSection = false;
+
+  for (CBNode* node = cb->getFirstNode(); node; node = node->getNext()) {
+    // Constant pools and jump tables placed into another section don't
+    // affect the code.
+    if ((node->getType() == CBNode::kNodeConstPool && static_cast<CBConstPool*>(node)->getSection()) ||
+        (node->getType() == CBNode::kNodeJumpTable && static_cast<CBJumpTable*>(node)->getSection()))
+      continue;
+
+    // Code switched into another section by `CBSection` is not part of the
+    // .text section, jumps to its labels stay long.
+    if (node->getType() == CBNode::kNodeSection) {
+      inOtherSection = static_cast<CBSection*>(node)->getSection()->getId() != 0;
+      continue;
+    }
+
+    if (inOtherSection)
+      continue;
+
+    uint32_t start = static_cast<uint32_t>(a.getOffset());
+    bool isJump = X86JumpRelax_isCandidate(node);
+    bool isBackward = isJump && scratch.isLabelBound(static_cast<CBJump*>(node)->getOpArray()[0].getId());
+
+    ASMJIT_PROPAGATE(cb->serializeNode(&a, node));
+    uint32_t end = static_cast<uint32_t>(a.getOffset());
+
+    switch (node->getType()) {
+      case CBNode::kNodeAlign: {
+        uint32_t alignment = static_cast<CBAlign*>(node)->getAlignment();
+        if (alignment > 1) {
+          X86RelaxGrowth growth = { start, alignment - 1 };
+          ASMJIT_PROPAGATE(growths.append(heap, growth));
+          hasAlign = true;
+        }
+        break;
+      }
+
+      case CBNode::kNodeConstPool: {
+        uint32_t alignment = static_cast<uint32_t>(static_cast<CBConstPool*>(node)->getConstPool().getAlignment());
+        if (alignment > 1) {
+          X86RelaxGrowth growth = { start, alignment - 1 };
+          ASMJIT_PROPAGATE(growths.append(heap, growth));
+          hasAlign = true;
+        }
+        break;
+      }
+
+      case CBNode::kNodeJumpTable: {
+        uint32_t alignment = a.getGpSize();
+        X86RelaxGrowth growth = { start, alignment - 1 };
+        ASMJIT_PROPAGATE(growths.append(heap, growth));
+        hasAlign = true;
+        break;
+      }
+
+      default:
+        break;
+    }
+
+    if (!collect) {
+      // Jumps shrunk by a previous iteration are not candidates anymore, but
+      // still have to be updated.
+      if (jumpIndex < jumps.getLength() && jumps[jumpIndex].node == node) {
+        jumps[jumpIndex].start = start;
+        jumps[jumpIndex].end = end;
+        jumpIndex++;
+        continue;
+      }
+    }
+
+    if (!isJump)
+      continue;
+
+    if (isBackward) {
+      // The assembler selected the size of a backward jump, a short one can
+      // become long if an alignment between it and its target grows.
+      if (end - start <= 3) {
+        X86RelaxGrowth growth = { start, X86JumpRelax_kBackwardGrowth };
+        ASMJIT_PROPAGATE(growths.append(heap, growth));
+      }
+      continue;
+    }
+
+    if (collect) {
+      X86RelaxJump jump = { static_cast<CBJump*>(node), start, end };
+      ASMJIT_PROPAGATE(jumps.append(heap, jump));
+    }
+  }
+
+  // Without alignments nothing can grow.
+  if (!hasAlign)
+    growths.reset();
+
+  return kErrorOk;
+}
+
+Error X86JumpRelaxPass::process(Zone* zone) noexcept {
+  CodeBuilder* cb = _cb;
+  CodeHolder scratch;
+  ZoneHeap heap(zone);
+
+  ZoneVector<X86RelaxJump> jumps;
+  ZoneVector<X86RelaxGrowth> growths;
+  ZoneVector<uint32_t> prefix;
+
+  _shrunkCount = 0;
+  _iterationCount = 0;
+
+  if (!cb->getFirstNode())
+    return kErrorOk;
+
+  for (uint32_t iteration = 0; iteration < kMaxIterations; iteration++) {
+    _iterationCount++;
+
+    // Trial assembly should never fail as all jumps are shrunk only if their
+    // target is in reach. If it does, the error is reported by serialization.
+    if (X86JumpRelax_assemble(cb, scratch, &heap, jumps, growths, iteration == 0) != kErrorOk)
+      break;
+
+    size_t growthCount = growths.getLength();
+    prefix.reset();
+    ASMJIT_PROPAGATE(prefix.willGrow(&heap, growthCount + 1));
+
+    uint32_t sum = 0;
+    prefix.appendUnsafe(0);
+    for (size_t i = 0; i < growthCount; i++) {
+      sum += growths[i].size;
+      prefix.appendUnsafe(sum);
+    }
+
+    uint32_t shrunk = 0;
+    for (size_t i = 0, count = jumps.getLength(); i < count; i++) {
+      X86RelaxJump& jump = jumps[i];
+      CBJump* node = jump.node;
+
+      if (node->getOptions() & X86Inst::kOptionShortForm)
+        continue;
+
+      intptr_t target = scratch.getLabelOffset(node->getOpArray()[0].as<Label>());
+      if (target < 0 || static_cast<uint32_t>(target) < jump.end)
+        continue;
+
+      // Size of the short form, the long form is 3 (jmp) or 4 (jcc) bytes
+      // longer, prefixes are the same.
+      uint32_t longSize = jump.end - jump.start;
+      uint32_t shortSize = longSize - (node->getInstId() == X86Inst::kIdJmp ? 3 : 4);
+
+      uint32_t disp = static_cast<uint32_t>(target) - (jump.start + shortSize);
+      disp += X86JumpRelax_getGrowth(growths, prefix, jump.start, static_cast<uint32_t>(target));
+
+      if (disp <= 127) {
+        node->addOptions(X86Inst::kOptionShortForm);
+        shrunk++;
+      }
+    }
+
+    _shrunkCount += shrunk;
+    if (!shrunk)
+      break;
+  }
+
+  return kErrorOk;
+}
+
+} // asmjit namespace
+
+// [Api-End]
+#include "../asmjit_apiend.h"
+
+// [Guard]
+#endif // ASMJIT_BUILD_X86 && !ASMJIT_DISABLE_BUILDER
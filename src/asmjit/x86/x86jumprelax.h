@@ -0,0 +1,99 @@
+// [AsmJit]
+// Complete x86/x64 JIT and Remote Assembler for C++.
+//
+// [License]
+// Zlib - See LICENSE.md file in the package.
+
+// [Guard]
+#ifndef _ASMJIT_X86_X86JUMPRELAX_H
+#define _ASMJIT_X86_X86JUMPRELAX_H
+
+#include "../asmjit_build.h"
+#if !defined(ASMJIT_DISABLE_BUILDER)
+
+// [Dependencies]
+#include "../base/codebuilder.h"
+
+// [Api-Begin]
+#include "../asmjit_apibegin.h"
+
+namespace asmjit {
+
+//! \addtogroup asmjit_x86
+//! \{
+
+// ============================================================================
+// [asmjit::X86JumpRelaxPass]
+// ============================================================================
+
+//! Jump relaxation pass.
+//!
+//! `X86Assembler` has to emit a forward jump to a label that is not bound yet
+//! with a 32-bit displacement, unless the jump was emitted by `short_()`. This
+//! pass assembles the code into a scratch \ref CodeHolder, measures distances
+//! of all forward `jmp` and `jcc` instructions, and marks jumps whose target
+//! is within reach of an 8-bit displacement by `X86Inst::kOptionShortForm`.
+//! Shrinking jumps brings other jumps closer to their targets, so this is
+//! repeated until no more jumps can be shrunk (at most `kMaxIterations`).
+//!
+//! Padding of `align` directives and constant pools can grow when the code
+//! before them shrinks, so the maximum padding of each alignment between a
+//! jump and its target is added to the distance, which makes every decision
+//! safe regardless of other jumps shrunk later.
+//!
+//! The pass should run after all passes that change the code, so it has to
+//! be added after `X86Compiler` was attached, which adds its register
+//! allocator pass:
+//!
+//! ~~~
+//! X86Compiler cc(&code);
+//! cc.addPassT<X86JumpRelaxPass>();
+//! ~~~
+class ASMJIT_VIRTAPI X86JumpRelaxPass : public CBPass {
+public:
+  ASMJIT_NONCOPYABLE(X86JumpRelaxPass)
+  typedef CBPass Base;
+
+  //! Maximum number of trial assemblies.
+  enum { kMaxIterations = 8 };
+
+  // --------------------------------------------------------------------------
+  // [Construction / Destruction]
+  // --------------------------------------------------------------------------
+
+  ASMJIT_API X86JumpRelaxPass() noexcept;
+  ASMJIT_API virtual ~X86JumpRelaxPass() noexcept;
+
+  // --------------------------------------------------------------------------
+  // [Interface]
+  // --------------------------------------------------------------------------
+
+  ASMJIT_API virtual Error process(Zone* zone) noexcept override;
+
+  // --------------------------------------------------------------------------
+  // [Accessors]
+  // --------------------------------------------------------------------------
+
+  //! Get the number of jumps shrunk by the last `process()`.
+  ASMJIT_INLINE uint32_t getShrunkCount() const noexcept { return _shrunkCount; }
+  //! Get the number of trial assemblies done by the last `process()`.
+  ASMJIT_INLINE uint32_t getIterationCount() const noexcept { return _iterationCount; }
+
+  // --------------------------------------------------------------------------
+  // [Members]
+  // --------------------------------------------------------------------------
+
+  uint32_t _shrunkCount;                 //!< Jumps shrunk by the last `process()`.
+  uint32_t _iterationCount;              //!< Trial assemblies of the last `process()`.
+};
+
+//! \}
+
+} // asmjit namespace
+
+// [Api-End]
+#include "../asmjit_apiend.h"
+
+// [Guard]
+#endif // !ASMJIT_DISABLE_BUILDER
+#endif // _ASMJIT_X86_X86JUMPRELAX_H
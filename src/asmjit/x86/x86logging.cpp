@@ -115,6 +115,27 @@ static const X86RegFormatInfo x86RegFormatInfo[] = {
   ASMJIT_TABLE_16(ASMJIT_X86_REG_FORMAT, 16)
 };
 
+//! Format a register name described by `fmt` (a prefix, "%u", and a suffix)
+//! without going through `vsnprintf()`. The `id` must be less than 100.
+static ASMJIT_INLINE Error x86FormatRegName(StringBuilder& sb, const char* fmt, uint32_t id) noexcept {
+  ASMJIT_ASSERT(id < 100);
+
+  char buf[16];
+  char* p = buf;
+
+  while (*fmt != '%')
+    *p++ = *fmt++;
+  fmt += 2;
+
+  if (id >= 10)
+    *p++ = static_cast<char>('0' + id / 10);
+  *p++ = static_cast<char>('0' + id % 10);
+
+  while (*fmt)
+    *p++ = *fmt++;
+  return sb.appendString(buf, (size_t)(p - buf));
+}
+
 static const char* x86GetAddressSizeString(uint32_t size) noexcept {
   switch (size) {
     case 1 : return "byte ";
@@ -150,8 +171,10 @@ ASMJIT_FAVOR_SIZE Error X86Logging::formatOperand(
 
     // Segment override prefix.
     uint32_t seg = m.getSegmentId();
-    if (seg != X86Seg::kIdNone && seg < X86Seg::kIdCount)
-      ASMJIT_PROPAGATE(sb.appendFormat("%s:", x86RegFormatStrings + 224 + seg * 4));
+    if (seg != X86Seg::kIdNone && seg < X86Seg::kIdCount) {
+      ASMJIT_PROPAGATE(sb.appendString(x86RegFormatStrings + 224 + seg * 4, 2));
+      ASMJIT_PROPAGATE(sb.appendChar(':'));
+    }
 
     ASMJIT_PROPAGATE(sb.appendChar('['));
     if (m.isAbs())
@@ -171,8 +194,10 @@ ASMJIT_FAVOR_SIZE Error X86Logging::formatOperand(
     if (m.hasIndex()) {
       ASMJIT_PROPAGATE(sb.appendChar('+'));
       ASMJIT_PROPAGATE(formatRegister(sb, logOptions, emitter, archType, m.getIndexType(), m.getIndexId()));
-      if (m.hasShift())
-        ASMJIT_PROPAGATE(sb.appendFormat("*%u", 1 << m.getShift()));
+      if (m.hasShift()) {
+        char scale[2] = { '*', static_cast<char>('0' + (1 << m.getShift())) };
+        ASMJIT_PROPAGATE(sb.appendString(scale, 2));
+      }
     }
 
     uint64_t off = static_cast<uint64_t>(m.getOffset());
@@ -548,8 +573,9 @@ ASMJIT_FAVOR_SIZE Error X86Logging::formatRegister(
         const char* name = vReg->getName();
         if (name && name[0] != '\0')
           return sb.appendString(name);
-        else
-          return sb.appendFormat("v%u", static_cast<unsigned int>(Operand::unpackId(rId)));
+
+        ASMJIT_PROPAGATE(sb.appendChar('v'));
+        return sb.appendUInt(Operand::unpackId(rId));
       }
     }
 #endif // !ASMJIT_DISABLE_COMPILER
@@ -564,7 +590,7 @@ ASMJIT_FAVOR_SIZE Error X86Logging::formatRegister(
         return sb.appendString(x86RegFormatStrings + rfi.specialIndex + rId * 4);
 
       if (rId < rfi.count)
-        return sb.appendFormat(x86RegFormatStrings + rfi.formatIndex, static_cast<unsigned int>(rId));
+        return x86FormatRegName(sb, x86RegFormatStrings + rfi.formatIndex, rId);
     }
 
     return sb.appendFormat("PhysReg<Type=%u Id=%u>", rType, rId);
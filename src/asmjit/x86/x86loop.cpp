@@ -0,0 +1,318 @@
+// [AsmJit]
+// Complete x86/x64 JIT and Remote Assembler for C++.
+//
+// [License]
+// Zlib - See LICENSE.md file in the package.
+
+// [Export]
+#define ASMJIT_EXPORTS
+
+// [Guard]
+#include "../asmjit_build.h"
+#if defined(ASMJIT_BUILD_X86) && !defined(ASMJIT_DISABLE_COMPILER)
+
+// [Dependencies]
+#include "../x86/x86loop.h"
+
+// [Api-Begin]
+#include "../asmjit_apibegin.h"
+
+namespace asmjit {
+
+// ============================================================================
+// [asmjit::X86Loop - Helpers]
+// ============================================================================
+
+//! \internal
+//!
+//! Emit step `t` of the pipeline, which executes stage `s` of iteration
+//! `index + t - s` for each `s` from `sLast` down to `sFirst` (the oldest
+//! iteration first).
+static Error X86Loop_emitStep(X86Loop* self, const X86Gp& index, uint32_t unroll, uint32_t t, uint32_t sFirst, uint32_t sLast) {
+  X86Compiler* cc = self->cc();
+  X86LoopIteration it;
+
+  it.index = index;
+  for (uint32_t s = sLast + 1; s-- > sFirst; ) {
+    uint32_t offset = t - s;
+
+    it.offset = static_cast<int32_t>(offset);
+    it.copy = offset % unroll;
+    it.stage = s;
+    ASMJIT_PROPAGATE(self->onBody(*cc, it));
+  }
+
+  return kErrorOk;
+}
+
+//! \internal
+//!
+//! Emit the prologue, which starts the first `stages - 1` iterations.
+static Error X86Loop_emitPrologue(X86Loop* self, const X86Gp& index, uint32_t unroll, uint32_t stages) {
+  for (uint32_t t = 0; t < stages - 1; t++)
+    ASMJIT_PROPAGATE(X86Loop_emitStep(self, index, unroll, t, 0, t));
+  return kErrorOk;
+}
+
+//! \internal
+//!
+//! Emit the kernel, which starts `unroll` iterations and finishes the same
+//! number of iterations started by the prologue or the previous trip.
+static Error X86Loop_emitKernel(X86Loop* self, const X86Gp& index, uint32_t unroll, uint32_t stages) {
+  for (uint32_t u = 0; u < unroll; u++)
+    ASMJIT_PROPAGATE(X86Loop_emitStep(self, index, unroll, u + stages - 1, 0, stages - 1));
+  return kErrorOk;
+}
+
+//! \internal
+//!
+//! Emit the epilogue, which finishes iterations started by the last trip
+//! without starting new ones.
+static Error X86Loop_emitEpilogue(X86Loop* self, const X86Gp& index, uint32_t unroll, uint32_t stages) {
+  for (uint32_t u = 0; u < stages - 1; u++)
+    ASMJIT_PROPAGATE(X86Loop_emitStep(self, index, unroll, u + stages - 1, u + 1, stages - 1));
+  return kErrorOk;
+}
+
+//! \internal
+//!
+//! Emit all stages of iteration `index + offset` using temporaries of `copy`.
+static Error X86Loop_emitIteration(X86Loop* self, const X86Gp& index, uint32_t offset, uint32_t copy, uint32_t stages) {
+  X86Compiler* cc = self->cc();
+  X86LoopIteration it;
+
+  it.index = index;
+  it.offset = static_cast<int32_t>(offset);
+  it.copy = copy;
+
+  for (uint32_t s = 0; s < stages; s++) {
+    it.stage = s;
+    ASMJIT_PROPAGATE(self->onBody(*cc, it));
+  }
+
+  return kErrorOk;
+}
+
+// ============================================================================
+// [asmjit::X86Loop - Construction / Destruction]
+// ============================================================================
+
+X86Loop::X86Loop(X86Compiler* cc) noexcept
+  : _cc(cc),
+    _unroll(1),
+    _stageCount(1) {
+  reset();
+}
+X86Loop::~X86Loop() noexcept {}
+
+// ============================================================================
+// [asmjit::X86Loop - Temporaries]
+// ============================================================================
+
+X86Reg X86Loop::getTemp(uint32_t copy, uint32_t slot, uint32_t typeId) {
+  ASMJIT_ASSERT(copy < kMaxUnroll);
+  ASMJIT_ASSERT(slot < kMaxTemps);
+
+  X86Compiler* cc = _cc;
+  uint32_t id = _temps[copy][slot];
+
+  if (id) {
+    VirtReg* vreg = cc->getVirtRegById(id);
+    return X86Reg::fromSignature(vreg->getSignature(), id);
+  }
+
+  X86Reg reg;
+  StringBuilderTmp<32> name;
+  name.setFormat("t%u.%u", slot, copy);
+
+  if (cc->_newReg(reg, typeId, name.getData()) == kErrorOk)
+    _temps[copy][slot] = reg.getId();
+  return reg;
+}
+
+uint32_t X86Loop::getTempCount(uint32_t kind) const noexcept {
+  uint32_t count = 0;
+
+  for (uint32_t slot = 0; slot < kMaxTemps; slot++) {
+    for (uint32_t copy = 0; copy < kMaxUnroll; copy++) {
+      uint32_t id = _temps[copy][slot];
+      if (id) {
+        count += _cc->getVirtRegById(id)->getKind() == kind;
+        break;
+      }
+    }
+  }
+
+  return count;
+}
+
+void X86Loop::reset() noexcept {
+  _index.reset();
+  ::memset(_temps, 0, sizeof(_temps));
+}
+
+// ============================================================================
+// [asmjit::X86Loop - Emit]
+// ============================================================================
+
+Error X86Loop::emit(const X86Gp& count) {
+  X86Compiler* cc = _cc;
+
+  if (ASMJIT_UNLIKELY(cc->getLastError()))
+    return cc->getLastError();
+
+  if (ASMJIT_UNLIKELY(!cc->getFunc()))
+    return cc->setLastError(DebugUtils::errored(kErrorInvalidState));
+
+  uint32_t stages = _stageCount;
+  uint32_t unroll = std::max<uint32_t>(_unroll, stages);
+  uint32_t prolog = stages - 1;
+
+  X86Gp index = cc->newIntPtr("loop.i");
+  X86Gp n = cc->newIntPtr("loop.n");
+  _index = index;
+
+  Label L_Remainder = cc->newLabel();
+  Label L_RemainderLoop = cc->newLabel();
+  Label L_Done = cc->newLabel();
+
+  // 32-bit count is zero extended.
+  if (count.getSize() < n.getSize())
+    cc->mov(n.r32(), count.r32());
+  else
+    cc->mov(n, count);
+  cc->xor_(index.r32(), index.r32());
+
+  if (unroll + prolog > 1) {
+    Label L_Kernel = cc->newLabel();
+
+    cc->cmp(n, unroll + prolog);
+    cc->jb(L_Remainder);
+
+    ASMJIT_PROPAGATE(X86Loop_emitPrologue(this, index, unroll, stages));
+    cc->sub(n, unroll + prolog);
+
+    cc->bind(L_Kernel);
+    ASMJIT_PROPAGATE(X86Loop_emitKernel(this, index, unroll, stages));
+    cc->add(index, unroll);
+    cc->sub(n, unroll);
+    cc->jae(L_Kernel);
+    cc->add(n, unroll);
+
+    ASMJIT_PROPAGATE(X86Loop_emitEpilogue(this, index, unroll, stages));
+    if (prolog)
+      cc->add(index, prolog);
+  }
+
+  // Iterations that don't fill a whole trip, `n` is less than the unroll factor.
+  cc->bind(L_Remainder);
+  cc->test(n, n);
+  cc->jz(L_Done);
+
+  cc->bind(L_RemainderLoop);
+  ASMJIT_PROPAGATE(X86Loop_emitIteration(this, index, 0, 0, stages));
+  cc->add(index, 1);
+  cc->sub(n, 1);
+  cc->jnz(L_RemainderLoop);
+
+  cc->bind(L_Done);
+  return cc->getLastError();
+}
+
+Error X86Loop::emit(uint32_t count) {
+  X86Compiler* cc = _cc;
+
+  if (ASMJIT_UNLIKELY(cc->getLastError()))
+    return cc->getLastError();
+
+  if (ASMJIT_UNLIKELY(!cc->getFunc()))
+    return cc->setLastError(DebugUtils::errored(kErrorInvalidState));
+
+  uint32_t stages = _stageCount;
+  uint32_t unroll = std::max<uint32_t>(_unroll, stages);
+  uint32_t prolog = stages - 1;
+
+  uint32_t trips = count >= unroll + prolog ? (count - prolog) / unroll : 0;
+  uint32_t remainder = trips ? count - prolog - trips * unroll : count;
+
+  X86Gp index = cc->newIntPtr("loop.i");
+  _index = index;
+  cc->xor_(index.r32(), index.r32());
+
+  if (trips) {
+    ASMJIT_PROPAGATE(X86Loop_emitPrologue(this, index, unroll, stages));
+
+    if (trips > 1) {
+      X86Gp n = cc->newInt32("loop.n");
+      Label L_Kernel = cc->newLabel();
+
+      cc->mov(n, trips);
+      cc->bind(L_Kernel);
+      ASMJIT_PROPAGATE(X86Loop_emitKernel(this, index, unroll, stages));
+      cc->add(index, unroll);
+      cc->sub(n, 1);
+      cc->jnz(L_Kernel);
+    }
+    else {
+      ASMJIT_PROPAGATE(X86Loop_emitKernel(this, index, unroll, stages));
+      cc->add(index, unroll);
+    }
+
+    ASMJIT_PROPAGATE(X86Loop_emitEpilogue(this, index, unroll, stages));
+    if (prolog)
+      cc->add(index, prolog);
+  }
+
+  // The remainder is known, emit it straight-line and keep copies renamed.
+  for (uint32_t i = 0; i < remainder; i++)
+    ASMJIT_PROPAGATE(X86Loop_emitIteration(this, index, i, i % unroll, stages));
+
+  if (remainder)
+    cc->add(index, remainder);
+
+  return cc->getLastError();
+}
+
+// ============================================================================
+// [asmjit::X86Loop - Unroll Hint]
+// ============================================================================
+
+uint32_t X86Loop::getUnrollHint(const CCFuncReport* report, uint32_t maxUnroll) const noexcept {
+  if (!report)
+    return _unroll;
+
+  // Registers available to the allocator, ESP|RSP is never allocated.
+  uint32_t regCount[Globals::kMaxVRegKinds];
+  bool isX86 = _cc->getArchType() == ArchInfo::kTypeX86;
+
+  regCount[X86Reg::kKindGp ] = isX86 ? 7 : 15;
+  regCount[X86Reg::kKindMm ] = 8;
+  regCount[X86Reg::kKindK  ] = 7;
+  regCount[X86Reg::kKindVec] = isX86 ? 8 : 16;
+
+  uint32_t current = std::max<uint32_t>(_unroll, _stageCount);
+  uint32_t unroll = std::min<uint32_t>(maxUnroll, kMaxUnroll);
+
+  for (uint32_t kind = 0; kind < Globals::kMaxVRegKinds; kind++) {
+    uint32_t temps = getTempCount(kind);
+    if (!temps)
+      continue;
+
+    // Registers live at the same time as the loop, but not used by it.
+    uint32_t live = report->maxLive[kind];
+    uint32_t others = live > temps * current ? live - temps * current : 0;
+    uint32_t fit = regCount[kind] > others ? (regCount[kind] - others) / temps : 0;
+
+    unroll = std::min<uint32_t>(unroll, fit);
+  }
+
+  return std::max<uint32_t>(unroll, 1);
+}
+
+} // asmjit namespace
+
+// [Api-End]
+#include "../asmjit_apiend.h"
+
+// [Guard]
+#endif // ASMJIT_BUILD_X86 && !ASMJIT_DISABLE_COMPILER
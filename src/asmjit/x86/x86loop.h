@@ -0,0 +1,193 @@
+// [AsmJit]
+// Complete x86/x64 JIT and Remote Assembler for C++.
+//
+// [License]
+// Zlib - See LICENSE.md file in the package.
+
+// [Guard]
+#ifndef _ASMJIT_X86_X86LOOP_H
+#define _ASMJIT_X86_X86LOOP_H
+
+#include "../asmjit_build.h"
+#if !defined(ASMJIT_DISABLE_COMPILER)
+
+// [Dependencies]
+#include "../x86/x86compiler.h"
+
+// [Api-Begin]
+#include "../asmjit_apibegin.h"
+
+namespace asmjit {
+
+//! \addtogroup asmjit_x86
+//! \{
+
+// ============================================================================
+// [asmjit::X86LoopIteration]
+// ============================================================================
+
+//! Iteration (or a stage of it) emitted by \ref X86Loop::onBody().
+struct X86LoopIteration {
+  X86Gp index;                           //!< Index variable, see \ref X86Loop::getIndex().
+  int32_t offset;                        //!< Iteration number is `index + offset`.
+  uint32_t copy;                         //!< Copy of temporaries, see \ref X86Loop::getTemp().
+  uint32_t stage;                        //!< Stage to emit, always zero if not pipelined.
+};
+
+// ============================================================================
+// [asmjit::X86Loop]
+// ============================================================================
+
+//! Unrolled and optionally software pipelined loop emitted by \ref X86Compiler.
+//!
+//! The loop body is provided by `onBody()`, which is called once per emitted
+//! copy of the body with the iteration it emits. The body addresses data by
+//! `it.index + it.offset` and keeps its values in temporaries returned by
+//! `getTemp()`, which are renamed per copy, so copies of the unrolled body
+//! don't depend on each other and the register allocator is free to overlap
+//! them.
+//!
+//! `emit()` generates:
+//!
+//!   - Kernel - `getUnroll()` iterations per trip.
+//!
+//!   - Remainder - iterations that don't fill a whole trip are emitted by a
+//!     rolled loop, or straight-line if the trip count is a constant.
+//!
+//!   - Prologue and epilogue - if the body is split into more stages (see
+//!     `setStageCount()`) the kernel executes stage `s` of iteration `i - s`
+//!     together with stage 0 of iteration `i` (modulo scheduling), the
+//!     prologue fills the pipeline and the epilogue drains it. The unroll
+//!     factor is at least the number of stages, so iterations in flight never
+//!     share temporaries.
+//!
+//! Temporaries keep their values between `emit()` calls, they can be
+//! initialized before the loop and combined after it (per-copy accumulators
+//! of a reduction), `reset()` forgets them. The remainder uses copy 0 if it's
+//! a rolled loop.
+//!
+//! The unroll factor can be chosen by the register pressure of the function:
+//! emit it with a small unroll factor and stats enabled (see
+//! `CodeBuilder::setStatsEnabled()`), finalize it, and pass its report (see
+//! \ref CCFunc::getReport()) to `getUnrollHint()`, which returns the largest
+//! unroll factor whose temporaries still fit into physical registers:
+//!
+//! ~~~
+//! class SumLoop : public X86Loop {
+//! public:
+//!   SumLoop(X86Compiler* cc, const X86Gp& src) : X86Loop(cc), _src(src) {}
+//!
+//!   virtual Error onBody(X86Compiler& cc, const X86LoopIteration& it) {
+//!     X86Gp acc = getTemp(it.copy, 0, TypeId::kI32).as<X86Gp>();
+//!     return cc.add(acc, x86::dword_ptr(_src, it.index, 2, it.offset * 4));
+//!   }
+//!
+//!   X86Gp _src;
+//! };
+//! ~~~
+class ASMJIT_VIRTAPI X86Loop {
+public:
+  ASMJIT_NONCOPYABLE(X86Loop)
+
+  enum {
+    //! Maximum unroll factor.
+    kMaxUnroll = 16,
+    //! Maximum number of stages.
+    kMaxStages = 8,
+    //! Maximum number of temporaries per copy.
+    kMaxTemps = 32
+  };
+
+  // --------------------------------------------------------------------------
+  // [Construction / Destruction]
+  // --------------------------------------------------------------------------
+
+  //! Create a new `X86Loop` that emits to `cc`.
+  ASMJIT_API X86Loop(X86Compiler* cc) noexcept;
+  ASMJIT_API virtual ~X86Loop() noexcept;
+
+  // --------------------------------------------------------------------------
+  // [Interface]
+  // --------------------------------------------------------------------------
+
+  //! Emit stage `it.stage` of the iteration `it`.
+  virtual Error onBody(X86Compiler& cc, const X86LoopIteration& it) = 0;
+
+  // --------------------------------------------------------------------------
+  // [Accessors]
+  // --------------------------------------------------------------------------
+
+  //! Get the compiler.
+  ASMJIT_INLINE X86Compiler* cc() const noexcept { return _cc; }
+
+  //! Get the unroll factor (1 to `kMaxUnroll`).
+  ASMJIT_INLINE uint32_t getUnroll() const noexcept { return _unroll; }
+  //! Set the unroll factor (1 to `kMaxUnroll`).
+  ASMJIT_INLINE void setUnroll(uint32_t unroll) noexcept {
+    _unroll = std::min<uint32_t>(std::max<uint32_t>(unroll, 1), kMaxUnroll);
+  }
+
+  //! Get the number of stages of the body (1 to `kMaxStages`), 1 if not pipelined.
+  ASMJIT_INLINE uint32_t getStageCount() const noexcept { return _stageCount; }
+  //! Set the number of stages of the body (1 to `kMaxStages`), 1 if not pipelined.
+  ASMJIT_INLINE void setStageCount(uint32_t count) noexcept {
+    _stageCount = std::min<uint32_t>(std::max<uint32_t>(count, 1), kMaxStages);
+  }
+
+  //! Get the index variable of the last emitted loop, it's equal to the trip
+  //! count after the loop.
+  ASMJIT_INLINE const X86Gp& getIndex() const noexcept { return _index; }
+
+  // --------------------------------------------------------------------------
+  // [Temporaries]
+  // --------------------------------------------------------------------------
+
+  //! Get temporary `slot` of `copy`, created by the first call as a virtual
+  //! register of `typeId`.
+  ASMJIT_API X86Reg getTemp(uint32_t copy, uint32_t slot, uint32_t typeId);
+
+  //! Get the number of temporaries of a single copy of the given register `kind`.
+  ASMJIT_API uint32_t getTempCount(uint32_t kind) const noexcept;
+
+  //! Forget all temporaries.
+  ASMJIT_API void reset() noexcept;
+
+  // --------------------------------------------------------------------------
+  // [Emit]
+  // --------------------------------------------------------------------------
+
+  //! Emit the loop that executes `count` iterations (unsigned).
+  ASMJIT_API Error emit(const X86Gp& count);
+  //! Emit the loop that executes `count` iterations.
+  ASMJIT_API Error emit(uint32_t count);
+
+  // --------------------------------------------------------------------------
+  // [Unroll Hint]
+  // --------------------------------------------------------------------------
+
+  //! Get the unroll factor that fits the register pressure of the function
+  //! described by `report`, which contains the loop emitted with the current
+  //! unroll factor. It's never greater than `maxUnroll` and never less than 1.
+  ASMJIT_API uint32_t getUnrollHint(const CCFuncReport* report, uint32_t maxUnroll = kMaxUnroll) const noexcept;
+
+  // --------------------------------------------------------------------------
+  // [Members]
+  // --------------------------------------------------------------------------
+
+  X86Compiler* _cc;                      //!< Compiler.
+  uint32_t _unroll;                      //!< Unroll factor.
+  uint32_t _stageCount;                  //!< Number of stages.
+  X86Gp _index;                          //!< Index variable of the last loop.
+  uint32_t _temps[kMaxUnroll][kMaxTemps];//!< Virtual register ids of temporaries, zero if not created.
+};
+
+//! \}
+
+} // asmjit namespace
+
+// [Api-End]
+#include "../asmjit_apiend.h"
+
+// [Guard]
+#endif // !ASMJIT_DISABLE_COMPILER
+#endif // _ASMJIT_X86_X86LOOP_H
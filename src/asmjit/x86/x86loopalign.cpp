@@ -0,0 +1,295 @@
+// [AsmJit]
+// Complete x86/x64 JIT and Remote Assembler for C++.
+//
+// [License]
+// Zlib - See LICENSE.md file in the package.
+
+// [Export]
+#define ASMJIT_EXPORTS
+
+// [Guard]
+#include "../asmjit_build.h"
+#if defined(ASMJIT_BUILD_X86) && !defined(ASMJIT_DISABLE_BUILDER)
+
+// [Dependencies]
+#include "../x86/x86assembler.h"
+#include "../x86/x86loopalign.h"
+
+// [Api-Begin]
+#include "../asmjit_apibegin.h"
+
+namespace asmjit {
+
+// ============================================================================
+// [asmjit::X86LoopAlignPass - Helpers]
+// ============================================================================
+
+//! \internal
+//!
+//! Node and its offsets in the scratch assembly.
+struct X86AlignNode {
+  CBNode* node;                          //!< Node.
+  uint32_t start;                        //!< Offset of the node.
+  uint32_t end;                          //!< Offset after the node.
+  uint32_t loopEnd;                      //!< End of the loop if the node is a loop header, otherwise zero.
+};
+
+static ASMJIT_INLINE bool X86LoopAlign_isLabel(const CBNode* node) noexcept {
+  return node->getType() == CBNode::kNodeLabel || node->getType() == CBNode::kNodeFunc;
+}
+
+//! \internal
+//!
+//! Get if `node` is affected by the JCC erratum (jumps, calls, and returns).
+static ASMJIT_INLINE bool X86LoopAlign_isBranch(const CBNode* node) noexcept {
+  if (node->getType() == CBNode::kNodeFuncCall)
+    return true;
+
+  if (node->getType() != CBNode::kNodeInst)
+    return false;
+
+  uint32_t instId = static_cast<const CBInst*>(node)->getInstId();
+  return X86Inst::getInst(instId).getCommonData().doesJump();
+}
+
+//! \internal
+//!
+//! Get if `node` can macro-fuse with a following conditional jump.
+static ASMJIT_INLINE bool X86LoopAlign_isFusible(const CBNode* node) noexcept {
+  if (node->getType() != CBNode::kNodeInst)
+    return false;
+
+  switch (static_cast<const CBInst*>(node)->getInstId()) {
+    case X86Inst::kIdAdd:
+    case X86Inst::kIdAnd:
+    case X86Inst::kIdCmp:
+    case X86Inst::kIdDec:
+    case X86Inst::kIdInc:
+    case X86Inst::kIdSub:
+    case X86Inst::kIdTest:
+      return true;
+
+    default:
+      return false;
+  }
+}
+
+//! \internal
+//!
+//! Get if the previous non-comment node of `node` is an alignment.
+static bool X86LoopAlign_isAligned(const CBNode* node) noexcept {
+  for (node = node->getPrev(); node; node = node->getPrev()) {
+    if (node->getType() == CBNode::kNodeComment)
+      continue;
+    return node->getType() == CBNode::kNodeAlign;
+  }
+  return false;
+}
+
+// ============================================================================
+// [asmjit::X86LoopAlignPass - Construction / Destruction]
+// ============================================================================
+
+X86LoopAlignPass::X86LoopAlignPass(uint32_t options) noexcept
+  : CBPass("LoopAlign"),
+    _options(options),
+    _alignment(kDefaultAlignment),
+    _maxPadding(kDefaultMaxPadding),
+    _budget(kInvalidValue),
+    _alignedLoopCount(0),
+    _alignedJumpCount(0),
+    _paddingSize(0) {}
+X86LoopAlignPass::~X86LoopAlignPass() noexcept {}
+
+// ============================================================================
+// [asmjit::X86LoopAlignPass - Process]
+// ============================================================================
+
+Error X86LoopAlignPass::process(Zone* zone) noexcept {
+  static const uint8_t zeros[Globals::kMaxAlignment] = { 0 };
+
+  CodeBuilder* cb = _cb;
+  CodeHolder* code = cb->getCode();
+
+  _alignedLoopCount = 0;
+  _alignedJumpCount = 0;
+  _paddingSize = 0;
+
+  uint32_t alignment = _alignment;
+  if (!Utils::isPowerOf2(alignment) || alignment > Globals::kMaxAlignment)
+    return DebugUtils::errored(kErrorInvalidArgument);
+
+  size_t nodeCount = 0;
+  for (CBNode* node = cb->getFirstNode(); node; node = node->getNext())
+    nodeCount++;
+
+  if (!nodeCount || !(_options & (kOptionAlignLoops | kOptionJccErratum)))
+    return kErrorOk;
+
+  X86AlignNode* nodes = zone->allocT<X86AlignNode>(nodeCount * sizeof(X86AlignNode));
+  if (ASMJIT_UNLIKELY(!nodes))
+    return DebugUtils::errored(kErrorNoHeapMemory);
+
+  // Assemble all nodes into a scratch `CodeHolder` to get their offsets.
+  CodeHolder scratch;
+  ASMJIT_PROPAGATE(scratch.init(code->getCodeInfo()));
+
+#if !defined(ASMJIT_DISABLE_LOGGING)
+  // Instruction nodes keep the logging option of the emitter that created
+  // them, which requires a logger. It's disabled so nothing is formatted.
+  FileLogger nullLogger(nullptr);
+  nullLogger.setEnabled(false);
+  if (code->getLogger())
+    scratch.setLogger(&nullLogger);
+#endif // !ASMJIT_DISABLE_LOGGING
+
+  // Label ids must match the ids used by `cb`.
+  for (size_t i = 0, count = code->getLabelsCount(); i < count; i++) {
+    uint32_t id;
+    ASMJIT_PROPAGATE(scratch.newLabelId(id));
+  }
+
+  X86Assembler a(&scratch);
+
+  // Alignment depends on where the code starts in the real .text section.
+  code->sync();
+  size_t base = code->getSectionEntry(0)->getBuffer().getLength() & (Globals::kMaxAlignment - 1);
+  if (base)
+    ASMJIT_PROPAGATE(a.embed(zeros, static_cast<uint32_t>(base)));
+
+  X86AlignNode* nodesEnd = nodes;
+  bool inOtherSection = false;
+
+  for (CBNode* node = cb->getFirstNode(); node; node = node->getNext()) {
+    // Constant pools and jump tables placed into another section don't
+    // affect the code.
+    if ((node->getType() == CBNode::kNodeConstPool && static_cast<CBConstPool*>(node)->getSection()) ||
+        (node->getType() == CBNode::kNodeJumpTable && static_cast<CBJumpTable*>(node)->getSection()))
+      continue;
+
+    // Code switched into another section by `CBSection` is not part of the
+    // .text section and is never aligned.
+    if (node->getType() == CBNode::kNodeSection) {
+      inOtherSection = static_cast<CBSection*>(node)->getSection()->getId() != 0;
+      continue;
+    }
+
+    if (inOtherSection)
+      continue;
+
+    X86AlignNode* info = nodesEnd++;
+    info->node = node;
+    info->start = static_cast<uint32_t>(a.getOffset());
+    info->loopEnd = 0;
+
+    // Trial assembly should never fail, if it does the error is reported by
+    // serialization.
+    if (cb->serializeNode(&a, node) != kErrorOk)
+      return kErrorOk;
+
+    info->end = static_cast<uint32_t>(a.getOffset());
+    if (X86LoopAlign_isLabel(node))
+      node->setPassData<X86AlignNode>(info);
+  }
+
+  uint32_t codeSize = nodesEnd != nodes ? nodesEnd[-1].end - static_cast<uint32_t>(base) : 0;
+  uint32_t budget = _budget != kInvalidValue ? _budget : codeSize / 16;
+
+  // Find loop headers, labels targeted by backward jumps.
+  if (_options & kOptionAlignLoops) {
+    for (X86AlignNode* info = nodes; info != nodesEnd; info++) {
+      CBNode* node = info->node;
+      if (node->getType() != CBNode::kNodeInst || !node->isJmpOrJcc())
+        continue;
+
+      CBLabel* target = static_cast<CBJump*>(node)->getTarget();
+      X86AlignNode* header = target ? target->getPassData<X86AlignNode>() : nullptr;
+
+      // Only labels in the node list point to `nodes`.
+      if (header < nodes || header >= nodesEnd || header->node != target)
+        continue;
+
+      if (header->start <= info->start)
+        header->loopEnd = std::max<uint32_t>(header->loopEnd, info->end);
+    }
+  }
+
+  // Insert alignments in the order of offsets, `shift` is the padding that
+  // was inserted before the current node.
+  CBNode* oldCursor = cb->getCursor();
+  uint32_t shift = 0;
+
+  for (X86AlignNode* info = nodes; info != nodesEnd; info++) {
+    CBNode* node = info->node;
+    CBNode* alignBefore = nullptr;
+    bool isLoop = false;
+
+    uint32_t nodeAlignment = 0;
+    uint32_t padding = 0;
+
+    if (info->loopEnd && !X86LoopAlign_isAligned(node)) {
+      uint32_t start = info->start + shift;
+      uint32_t end = info->loopEnd + shift;
+      uint32_t size = end - start;
+
+      // Align only if the loop would straddle fewer blocks.
+      uint32_t blocksNow = (end - 1) / alignment - start / alignment + 1;
+      uint32_t blocksAligned = (size + alignment - 1) / alignment;
+
+      if (blocksAligned < blocksNow) {
+        alignBefore = node;
+        isLoop = true;
+        nodeAlignment = alignment;
+        padding = Utils::alignDiff<uint32_t>(start, alignment);
+      }
+    }
+    else if ((_options & kOptionJccErratum) && X86LoopAlign_isBranch(node)) {
+      X86AlignNode* first = info;
+
+      // A macro-fused pair is decoded as a single instruction.
+      if (node->isJcc() && info != nodes && info[-1].node == node->getPrev() && X86LoopAlign_isFusible(node->getPrev()))
+        first = info - 1;
+
+      uint32_t start = first->start + shift;
+      uint32_t end = info->end + shift;
+      uint32_t boundary = kJccErratumBoundary;
+
+      if (end > start && (start / boundary != (end - 1) / boundary || end % boundary == 0) && !X86LoopAlign_isAligned(first->node)) {
+        alignBefore = first->node;
+        nodeAlignment = boundary;
+        padding = Utils::alignDiff<uint32_t>(start, boundary);
+      }
+    }
+
+    if (!alignBefore || !padding || padding > _maxPadding || padding > budget)
+      continue;
+
+    cb->_setCursor(alignBefore->getPrev());
+    ASMJIT_PROPAGATE(cb->align(kAlignCode, nodeAlignment));
+
+    if (isLoop)
+      _alignedLoopCount++;
+    else
+      _alignedJumpCount++;
+
+    _paddingSize += padding;
+    budget -= padding;
+    shift += padding;
+  }
+
+  cb->_setCursor(oldCursor);
+
+  // Make the padding out of multi-byte NOPs.
+  if (_alignedLoopCount + _alignedJumpCount)
+    code->setGlobalHints(code->getGlobalHints() | CodeEmitter::kHintOptimizedAlign);
+
+  return kErrorOk;
+}
+
+} // asmjit namespace
+
+// [Api-End]
+#include "../asmjit_apiend.h"
+
+// [Guard]
+#endif // ASMJIT_BUILD_X86 && !ASMJIT_DISABLE_BUILDER
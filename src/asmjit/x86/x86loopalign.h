@@ -0,0 +1,147 @@
+// [AsmJit]
+// Complete x86/x64 JIT and Remote Assembler for C++.
+//
+// [License]
+// Zlib - See LICENSE.md file in the package.
+
+// [Guard]
+#ifndef _ASMJIT_X86_X86LOOPALIGN_H
+#define _ASMJIT_X86_X86LOOPALIGN_H
+
+#include "../asmjit_build.h"
+#if !defined(ASMJIT_DISABLE_BUILDER)
+
+// [Dependencies]
+#include "../base/codebuilder.h"
+
+// [Api-Begin]
+#include "../asmjit_apibegin.h"
+
+namespace asmjit {
+
+//! \addtogroup asmjit_x86
+//! \{
+
+// ============================================================================
+// [asmjit::X86LoopAlignPass]
+// ============================================================================
+
+//! Loop and branch alignment pass.
+//!
+//! The pass assembles the code into a scratch \ref CodeHolder to learn the
+//! offset of each node and then inserts \ref CBAlign nodes (`kAlignCode`):
+//!
+//!   - `kOptionAlignLoops` - A loop header (a label targeted by a backward
+//!     jump) is aligned to \ref getAlignment() if the loop body straddles
+//!     more `alignment` sized blocks than it would if it was aligned.
+//!
+//!   - `kOptionJccErratum` - A jump, call, or return (including a preceding
+//!     instruction it macro-fuses with) that crosses or ends at a 32-byte
+//!     boundary is aligned to 32 bytes. Skylake-class cores with the JCC
+//!     erratum microcode update don't cache such instructions in the decoded
+//!     ICache.
+//!
+//! Each alignment is limited to \ref getMaxPadding() bytes and all of them
+//! together to \ref getBudget() bytes (1/16 of the code size by default).
+//! Padding is computed from offsets of the scratch assembly, alignments that
+//! precede it only move the code, so the padding can differ a bit, but the
+//! inserted alignments are always honored. The pass enables
+//! `CodeEmitter::kHintOptimizedAlign` so the padding is made of multi-byte
+//! NOPs.
+//!
+//! The pass should run after all passes that change the code, so it has to
+//! be added after `X86Compiler` was attached, which adds its register
+//! allocator pass:
+//!
+//! ~~~
+//! X86Compiler cc(&code);
+//! cc.addPassT<X86LoopAlignPass>();
+//! ~~~
+class ASMJIT_VIRTAPI X86LoopAlignPass : public CBPass {
+public:
+  ASMJIT_NONCOPYABLE(X86LoopAlignPass)
+  typedef CBPass Base;
+
+  //! Pass options.
+  ASMJIT_ENUM(Options) {
+    kOptionAlignLoops = 0x00000001U,     //!< Align loop headers.
+    kOptionJccErratum = 0x00000002U      //!< Keep jumps off 32-byte boundaries.
+  };
+
+  enum {
+    //! Default alignment of loop headers.
+    kDefaultAlignment = 32,
+    //! Default maximum padding of a single alignment.
+    kDefaultMaxPadding = 15,
+    //! Boundary of the JCC erratum.
+    kJccErratumBoundary = 32
+  };
+
+  // --------------------------------------------------------------------------
+  // [Construction / Destruction]
+  // --------------------------------------------------------------------------
+
+  //! Create a new `X86LoopAlignPass`, see \ref Options.
+  ASMJIT_API X86LoopAlignPass(uint32_t options = kOptionAlignLoops) noexcept;
+  ASMJIT_API virtual ~X86LoopAlignPass() noexcept;
+
+  // --------------------------------------------------------------------------
+  // [Interface]
+  // --------------------------------------------------------------------------
+
+  ASMJIT_API virtual Error process(Zone* zone) noexcept override;
+
+  // --------------------------------------------------------------------------
+  // [Accessors]
+  // --------------------------------------------------------------------------
+
+  //! Get pass options, see \ref Options.
+  ASMJIT_INLINE uint32_t getOptions() const noexcept { return _options; }
+  //! Set pass options, see \ref Options.
+  ASMJIT_INLINE void setOptions(uint32_t options) noexcept { _options = options; }
+
+  //! Get alignment of loop headers (16, 32, or 64).
+  ASMJIT_INLINE uint32_t getAlignment() const noexcept { return _alignment; }
+  //! Set alignment of loop headers (16, 32, or 64).
+  ASMJIT_INLINE void setAlignment(uint32_t alignment) noexcept { _alignment = alignment; }
+
+  //! Get maximum padding of a single alignment.
+  ASMJIT_INLINE uint32_t getMaxPadding() const noexcept { return _maxPadding; }
+  //! Set maximum padding of a single alignment.
+  ASMJIT_INLINE void setMaxPadding(uint32_t maxPadding) noexcept { _maxPadding = maxPadding; }
+
+  //! Get maximum padding of all alignments, `kInvalidValue` means 1/16 of the code size.
+  ASMJIT_INLINE uint32_t getBudget() const noexcept { return _budget; }
+  //! Set maximum padding of all alignments, `kInvalidValue` means 1/16 of the code size.
+  ASMJIT_INLINE void setBudget(uint32_t budget) noexcept { _budget = budget; }
+
+  //! Get the number of loops aligned by the last `process()`.
+  ASMJIT_INLINE uint32_t getAlignedLoopCount() const noexcept { return _alignedLoopCount; }
+  //! Get the number of jumps aligned by the last `process()` (JCC erratum).
+  ASMJIT_INLINE uint32_t getAlignedJumpCount() const noexcept { return _alignedJumpCount; }
+  //! Get the estimated padding in bytes added by the last `process()`.
+  ASMJIT_INLINE uint32_t getPaddingSize() const noexcept { return _paddingSize; }
+
+  // --------------------------------------------------------------------------
+  // [Members]
+  // --------------------------------------------------------------------------
+
+  uint32_t _options;                     //!< Pass options.
+  uint32_t _alignment;                   //!< Alignment of loop headers.
+  uint32_t _maxPadding;                  //!< Maximum padding of a single alignment.
+  uint32_t _budget;                      //!< Maximum padding of all alignments.
+  uint32_t _alignedLoopCount;            //!< Loops aligned by the last `process()`.
+  uint32_t _alignedJumpCount;            //!< Jumps aligned by the last `process()`.
+  uint32_t _paddingSize;                 //!< Padding added by the last `process()`.
+};
+
+//! \}
+
+} // asmjit namespace
+
+// [Api-End]
+#include "../asmjit_apiend.h"
+
+// [Guard]
+#endif // !ASMJIT_DISABLE_BUILDER
+#endif // _ASMJIT_X86_X86LOOPALIGN_H
@@ -0,0 +1,1159 @@
+// [AsmJit]
+// Complete x86/x64 JIT and Remote Assembler for C++.
+//
+// [License]
+// Zlib - See LICENSE.md file in the package.
+
+// [Export]
+#define ASMJIT_EXPORTS
+
+// [Guard]
+#include "../asmjit_build.h"
+#if defined(ASMJIT_BUILD_X86) && !defined(ASMJIT_DISABLE_TEXT)
+
+// [Dependencies]
+#include "../base/misc_p.h"
+#include "../base/utils.h"
+#include "../x86/x86assembler.h"
+#include "../x86/x86inst.h"
+#include "../x86/x86parser.h"
+
+// [Api-Begin]
+#include "../asmjit_apibegin.h"
+
+namespace asmjit {
+
+// ============================================================================
+// [asmjit::X86Parser - Character Classes]
+// ============================================================================
+
+//! \internal
+ASMJIT_ENUM(X86ParserCharClass) {
+  kX86ParserCharSpace   = 0x01,          //!< Whitespace (except new-line).
+  kX86ParserCharIdStart = 0x02,          //!< First character of an identifier.
+  kX86ParserCharId      = 0x04,          //!< Character of an identifier.
+  kX86ParserCharDigit   = 0x08,          //!< Decimal digit.
+  kX86ParserCharEnd     = 0x10           //!< End of a statement (new-line or comment).
+};
+
+template<uint32_t C>
+struct X86ParserCharClass_T {
+  enum {
+    kIsLower = C >= 'a' && C <= 'z',
+    kIsUpper = C >= 'A' && C <= 'Z',
+    kIsDigit = C >= '0' && C <= '9',
+    kIsIdSym = C == '_' || C == '.' || C == '$' || C == '@',
+
+    kValue = (C == ' ' || C == '\t' || C == '\r' || C == '\v' || C == '\f' ? kX86ParserCharSpace   : 0) |
+             (kIsLower || kIsUpper || kIsIdSym                              ? kX86ParserCharIdStart : 0) |
+             (kIsLower || kIsUpper || kIsIdSym || kIsDigit                  ? kX86ParserCharId      : 0) |
+             (kIsDigit                                                      ? kX86ParserCharDigit   : 0) |
+             (C == '\n' || C == ';' || C == '#'                             ? kX86ParserCharEnd     : 0)
+  };
+};
+
+static const uint8_t x86ParserCharClass[256] = {
+  ASMJIT_TABLE_T_256(X86ParserCharClass_T, kValue, 0)
+};
+
+static ASMJIT_INLINE bool X86Parser_isClass(char c, uint32_t mask) noexcept {
+  return (x86ParserCharClass[static_cast<uint8_t>(c)] & mask) != 0;
+}
+
+// ============================================================================
+// [asmjit::X86Parser - Registers]
+// ============================================================================
+
+//! \internal
+//!
+//! Register that has a name not following `<prefix><number>` pattern, sorted
+//! by name so it can be searched by `X86Parser_getReg()`.
+struct X86ParserRegName {
+  char name[4];
+  uint8_t type;
+  uint8_t id;
+};
+
+static const X86ParserRegName x86ParserRegNames[] = {
+  { "ah" , X86Reg::kRegGpbHi, 0 },
+  { "al" , X86Reg::kRegGpbLo, 0 },
+  { "ax" , X86Reg::kRegGpw  , 0 },
+  { "bh" , X86Reg::kRegGpbHi, 3 },
+  { "bl" , X86Reg::kRegGpbLo, 3 },
+  { "bp" , X86Reg::kRegGpw  , 5 },
+  { "bpl", X86Reg::kRegGpbLo, 5 },
+  { "bx" , X86Reg::kRegGpw  , 3 },
+  { "ch" , X86Reg::kRegGpbHi, 1 },
+  { "cl" , X86Reg::kRegGpbLo, 1 },
+  { "cs" , X86Reg::kRegSeg  , 2 },
+  { "cx" , X86Reg::kRegGpw  , 1 },
+  { "dh" , X86Reg::kRegGpbHi, 2 },
+  { "di" , X86Reg::kRegGpw  , 7 },
+  { "dil", X86Reg::kRegGpbLo, 7 },
+  { "dl" , X86Reg::kRegGpbLo, 2 },
+  { "ds" , X86Reg::kRegSeg  , 4 },
+  { "dx" , X86Reg::kRegGpw  , 2 },
+  { "eax", X86Reg::kRegGpd  , 0 },
+  { "ebp", X86Reg::kRegGpd  , 5 },
+  { "ebx", X86Reg::kRegGpd  , 3 },
+  { "ecx", X86Reg::kRegGpd  , 1 },
+  { "edi", X86Reg::kRegGpd  , 7 },
+  { "edx", X86Reg::kRegGpd  , 2 },
+  { "es" , X86Reg::kRegSeg  , 1 },
+  { "esi", X86Reg::kRegGpd  , 6 },
+  { "esp", X86Reg::kRegGpd  , 4 },
+  { "fs" , X86Reg::kRegSeg  , 5 },
+  { "gs" , X86Reg::kRegSeg  , 6 },
+  { "rax", X86Reg::kRegGpq  , 0 },
+  { "rbp", X86Reg::kRegGpq  , 5 },
+  { "rbx", X86Reg::kRegGpq  , 3 },
+  { "rcx", X86Reg::kRegGpq  , 1 },
+  { "rdi", X86Reg::kRegGpq  , 7 },
+  { "rdx", X86Reg::kRegGpq  , 2 },
+  { "rip", X86Reg::kRegRip  , 0 },
+  { "rsi", X86Reg::kRegGpq  , 6 },
+  { "rsp", X86Reg::kRegGpq  , 4 },
+  { "si" , X86Reg::kRegGpw  , 6 },
+  { "sil", X86Reg::kRegGpbLo, 6 },
+  { "sp" , X86Reg::kRegGpw  , 4 },
+  { "spl", X86Reg::kRegGpbLo, 4 },
+  { "ss" , X86Reg::kRegSeg  , 3 },
+  { "st" , X86Reg::kRegFp   , 0 }
+};
+
+//! \internal
+//!
+//! Register that has a name of `<prefix><number>` pattern.
+struct X86ParserRegPrefix {
+  char prefix[4];
+  uint8_t type;
+  uint8_t count;
+};
+
+static const X86ParserRegPrefix x86ParserRegPrefixes[] = {
+  { "r"  , X86Reg::kRegGpq, 16 },
+  { "xmm", X86Reg::kRegXmm, 32 },
+  { "ymm", X86Reg::kRegYmm, 32 },
+  { "zmm", X86Reg::kRegZmm, 32 },
+  { "k"  , X86Reg::kRegK  , 8  },
+  { "mm" , X86Reg::kRegMm , 8  },
+  { "st" , X86Reg::kRegFp , 8  },
+  { "fp" , X86Reg::kRegFp , 8  },
+  { "bnd", X86Reg::kRegBnd, 4  },
+  { "cr" , X86Reg::kRegCr , 16 },
+  { "dr" , X86Reg::kRegDr , 16 }
+};
+
+//! \internal
+//!
+//! Get a register of lower-case `name`, returns false if `name` is not a
+//! register.
+static bool X86Parser_getReg(const char* name, size_t len, X86Reg& out) noexcept {
+  if (len < 2 || len > 5)
+    return false;
+
+  if (len <= 3) {
+    char key[4] = { 0, 0, 0, 0 };
+    ::memcpy(key, name, len);
+
+    size_t lo = 0;
+    size_t hi = ASMJIT_ARRAY_SIZE(x86ParserRegNames);
+
+    while (lo < hi) {
+      size_t mid = (lo + hi) >> 1;
+      int c = ::memcmp(x86ParserRegNames[mid].name, key, 4);
+
+      if (c == 0) {
+        const X86ParserRegName& r = x86ParserRegNames[mid];
+        out.setTypeAndId(r.type, r.id);
+        return true;
+      }
+
+      if (c < 0)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+  }
+
+  // Split `<prefix><number>[suffix]`.
+  size_t prefixLen = 0;
+  while (prefixLen < len && !X86Parser_isClass(name[prefixLen], kX86ParserCharDigit))
+    prefixLen++;
+
+  if (prefixLen == 0 || prefixLen > 3 || prefixLen == len)
+    return false;
+
+  size_t i = prefixLen;
+  uint32_t id = 0;
+
+  while (i < len && X86Parser_isClass(name[i], kX86ParserCharDigit))
+    id = id * 10 + static_cast<uint32_t>(name[i++] - '0');
+
+  // Leading zeros are not allowed, `xmm01` is not a register.
+  if (name[prefixLen] == '0' && i - prefixLen > 1)
+    return false;
+
+  for (size_t j = 0; j < ASMJIT_ARRAY_SIZE(x86ParserRegPrefixes); j++) {
+    const X86ParserRegPrefix& r = x86ParserRegPrefixes[j];
+    if (::strlen(r.prefix) != prefixLen || ::memcmp(r.prefix, name, prefixLen) != 0)
+      continue;
+
+    if (id >= r.count)
+      return false;
+
+    uint32_t type = r.type;
+    if (i != len) {
+      // Only GP registers have a size suffix (r8b, r8w, r8d).
+      if (type != X86Reg::kRegGpq || i + 1 != len)
+        return false;
+
+      switch (name[i]) {
+        case 'b': type = X86Reg::kRegGpbLo; break;
+        case 'w': type = X86Reg::kRegGpw  ; break;
+        case 'd': type = X86Reg::kRegGpd  ; break;
+        default : return false;
+      }
+    }
+
+    out.setTypeAndId(type, id);
+    return true;
+  }
+
+  return false;
+}
+
+// ============================================================================
+// [asmjit::X86Parser - Keywords]
+// ============================================================================
+
+//! \internal
+//!
+//! Get a size of a memory operand of lower-case `name`, zero if `name` is not
+//! a size keyword.
+static uint32_t X86Parser_getMemSize(const char* name, size_t len) noexcept {
+  static const char sizeNames[] =
+    "byte\0" "word\0" "dword\0" "fword\0" "qword\0" "tword\0" "oword\0"
+    "xmmword\0" "yword\0" "ymmword\0" "zword\0" "zmmword\0";
+  static const uint8_t sizeValues[] = { 1, 2, 4, 6, 8, 10, 16, 16, 32, 32, 64, 64 };
+
+  const char* p = sizeNames;
+  for (size_t i = 0; i < ASMJIT_ARRAY_SIZE(sizeValues); i++) {
+    size_t n = ::strlen(p);
+    if (n == len && ::memcmp(p, name, len) == 0)
+      return sizeValues[i];
+    p += n + 1;
+  }
+
+  return 0;
+}
+
+//! \internal
+//!
+//! Get instruction options of a lower-case prefix `name`, zero if `name` is not
+//! a prefix.
+static uint32_t X86Parser_getPrefix(const char* name, size_t len) noexcept {
+  static const char prefixNames[] =
+    "lock\0" "rep\0" "repe\0" "repz\0" "repne\0" "repnz\0" "xacquire\0" "xrelease\0";
+  static const uint32_t prefixValues[] = {
+    X86Inst::kOptionLock,
+    X86Inst::kOptionRep,
+    X86Inst::kOptionRep,
+    X86Inst::kOptionRep,
+    X86Inst::kOptionRepnz,
+    X86Inst::kOptionRepnz,
+    X86Inst::kOptionXAcquire,
+    X86Inst::kOptionXRelease
+  };
+
+  const char* p = prefixNames;
+  for (size_t i = 0; i < ASMJIT_ARRAY_SIZE(prefixValues); i++) {
+    size_t n = ::strlen(p);
+    if (n == len && ::memcmp(p, name, len) == 0)
+      return prefixValues[i];
+    p += n + 1;
+  }
+
+  return 0;
+}
+
+//! \internal
+//!
+//! Get an instruction id of a lower-case string instruction alias `name` that
+//! has an implicit size (`movsb`, `stosd`, ...), `Inst::kIdNone` if `name` is
+//! not such alias.
+static uint32_t X86Parser_getStringInst(const char* name, size_t len, uint32_t& size) noexcept {
+  static const char stringNames[] = "cmps\0" "lods\0" "movs\0" "scas\0" "stos\0";
+  static const uint16_t stringInsts[] = {
+    X86Inst::kIdCmps,
+    X86Inst::kIdLods,
+    X86Inst::kIdMovs,
+    X86Inst::kIdScas,
+    X86Inst::kIdStos
+  };
+
+  if (len != 5)
+    return Inst::kIdNone;
+
+  switch (name[4]) {
+    case 'b': size = 1; break;
+    case 'w': size = 2; break;
+    case 'd': size = 4; break;
+    case 'q': size = 8; break;
+    default : return Inst::kIdNone;
+  }
+
+  for (size_t i = 0; i < ASMJIT_ARRAY_SIZE(stringInsts); i++)
+    if (::memcmp(stringNames + i * 5, name, 4) == 0)
+      return stringInsts[i];
+
+  return Inst::kIdNone;
+}
+
+//! \internal
+//!
+//! Create implicit operands of a string instruction `instId` of `size`.
+static uint32_t X86Parser_initStringOperands(CodeEmitter* emitter, uint32_t instId, uint32_t size, Operand* opArray) noexcept {
+  uint32_t nativeType = emitter->getGpSize() == 8 ? X86Reg::kRegGpq : X86Reg::kRegGpd;
+  uint32_t zaxType = size == 1 ? X86Reg::kRegGpbLo :
+                     size == 2 ? X86Reg::kRegGpw   :
+                     size == 4 ? X86Reg::kRegGpd   : X86Reg::kRegGpq;
+
+  X86Reg zax;
+  zax.setTypeAndId(zaxType, X86Gp::kIdAx);
+
+  X86Mem zsi(Init, nativeType, X86Gp::kIdSi, 0, 0, 0, size, 0);
+  X86Mem zdi(Init, nativeType, X86Gp::kIdDi, 0, 0, 0, size, 0);
+
+  switch (instId) {
+    case X86Inst::kIdCmps: opArray[0] = zsi; opArray[1] = zdi; break;
+    case X86Inst::kIdLods: opArray[0] = zax; opArray[1] = zsi; break;
+    case X86Inst::kIdMovs: opArray[0] = zdi; opArray[1] = zsi; break;
+    case X86Inst::kIdScas: opArray[0] = zax; opArray[1] = zdi; break;
+    default              : opArray[0] = zdi; opArray[1] = zax; break;
+  }
+
+  return 2;
+}
+
+// ============================================================================
+// [asmjit::X86Parser - Cursor]
+// ============================================================================
+
+//! \internal
+//!
+//! Maximum length of an identifier that is matched against keywords.
+static const size_t kX86ParserMaxKeyword = 16;
+
+//! \internal
+//!
+//! Parser state of a single line.
+struct X86ParserCursor {
+  ASMJIT_INLINE void skipSpace() noexcept {
+    while (p != end && X86Parser_isClass(*p, kX86ParserCharSpace))
+      p++;
+  }
+
+  //! Skip whitespace and return the next character, or zero at the end of the
+  //! statement (end of line or comment).
+  ASMJIT_INLINE char peek() noexcept {
+    skipSpace();
+    return (p == end || X86Parser_isClass(*p, kX86ParserCharEnd)) ? '\0' : *p;
+  }
+
+  //! Skip whitespace and consume `c` if it's the next character.
+  ASMJIT_INLINE bool consume(char c) noexcept {
+    if (peek() != c) return false;
+    p++;
+    return true;
+  }
+
+  //! Parse an identifier, `name` points to the input and `lower` is filled by
+  //! its lower-case version if it's not longer than `kX86ParserMaxKeyword`.
+  ASMJIT_INLINE bool parseId(const char*& name, size_t& len) noexcept {
+    skipSpace();
+    if (p == end || !X86Parser_isClass(*p, kX86ParserCharIdStart))
+      return false;
+
+    name = p;
+    while (++p != end && X86Parser_isClass(*p, kX86ParserCharId))
+      continue;
+
+    len = static_cast<size_t>(p - name);
+    size_t n = std::min(len, kX86ParserMaxKeyword);
+
+    for (size_t i = 0; i < n; i++) {
+      char c = name[i];
+      lower[i] = static_cast<char>(c >= 'A' && c <= 'Z' ? c + ('a' - 'A') : c);
+    }
+
+    lowerLen = len <= kX86ParserMaxKeyword ? len : size_t(0);
+    return true;
+  }
+
+  const char* p;                         //!< Current position.
+  const char* end;                       //!< End of the line.
+  const char* start;                     //!< Start of the line (for error column).
+
+  char lower[kX86ParserMaxKeyword];      //!< Lower-case version of the last identifier.
+  size_t lowerLen;                       //!< Length of `lower`, zero if too long.
+};
+
+//! \internal
+//!
+//! Parse an unsigned number, returns false if there is no valid number.
+static bool X86Parser_parseNumber(X86ParserCursor& cur, uint64_t& out) noexcept {
+  cur.skipSpace();
+
+  const char* p = cur.p;
+  const char* end = cur.end;
+
+  if (p == end || !X86Parser_isClass(*p, kX86ParserCharDigit))
+    return false;
+
+  // Scan the whole token first as a trailing 'h' makes it hexadecimal.
+  const char* tokStart = p;
+  while (p != end && X86Parser_isClass(*p, kX86ParserCharId))
+    p++;
+
+  const char* tokEnd = p;
+  uint32_t base = 10;
+
+  if (tokEnd - tokStart > 2 && tokStart[0] == '0' && (tokStart[1] | 0x20) == 'x') {
+    base = 16;
+    tokStart += 2;
+  }
+  else if (tokEnd - tokStart > 2 && tokStart[0] == '0' && (tokStart[1] | 0x20) == 'b') {
+    base = 2;
+    tokStart += 2;
+  }
+  else if ((tokEnd[-1] | 0x20) == 'h') {
+    base = 16;
+    tokEnd--;
+  }
+
+  if (tokStart == tokEnd)
+    return false;
+
+  uint64_t value = 0;
+  for (const char* s = tokStart; s != tokEnd; s++) {
+    uint32_t c = static_cast<uint8_t>(*s);
+    uint32_t digit;
+
+    if (c >= '0' && c <= '9')
+      digit = c - '0';
+    else if ((c | 0x20) >= 'a' && (c | 0x20) <= 'f')
+      digit = (c | 0x20) - 'a' + 10;
+    else
+      return false;
+
+    if (digit >= base)
+      return false;
+
+    uint64_t next = value * base + digit;
+    if (next / base != value)
+      return false;
+    value = next;
+  }
+
+  cur.p = p;
+  out = value;
+  return true;
+}
+
+//! \internal
+//!
+//! Parse a constant expression that is a sum of signed numbers.
+static bool X86Parser_parseConst(X86ParserCursor& cur, int64_t& out) noexcept {
+  uint64_t value = 0;
+  bool first = true;
+
+  for (;;) {
+    char c = cur.peek();
+    bool negate = false;
+
+    if (c == '+' || c == '-') {
+      negate = c == '-';
+      cur.p++;
+    }
+    else if (!first) {
+      break;
+    }
+
+    uint64_t term;
+    if (!X86Parser_parseNumber(cur, term))
+      return false;
+
+    value = negate ? value - term : value + term;
+    first = false;
+  }
+
+  out = static_cast<int64_t>(value);
+  return true;
+}
+
+// ============================================================================
+// [asmjit::X86Parser - Operands]
+// ============================================================================
+
+//! \internal
+//!
+//! Get a label of `name` for a reference, the label is created if it doesn't
+//! exist yet, so it can be bound later.
+static Error X86Parser_getLabel(X86Parser* self, const char* name, size_t len, Label& out) noexcept {
+  CodeEmitter* emitter = self->_emitter;
+
+  uint32_t type = Label::kTypeGlobal;
+  uint32_t parentId = 0;
+
+  if (name[0] == '.') {
+    if (ASMJIT_UNLIKELY(!self->_parentId))
+      return DebugUtils::errored(kErrorInvalidParentLabel);
+
+    type = Label::kTypeLocal;
+    parentId = self->_parentId;
+  }
+
+  out = emitter->getLabelByName(name, len, parentId);
+  if (out.isValid())
+    return kErrorOk;
+
+  out = emitter->newNamedLabel(name, len, type, parentId);
+  if (ASMJIT_UNLIKELY(!emitter->isLabelValid(out)))
+    return emitter->isInErrorState() ? emitter->getLastError() : DebugUtils::errored(kErrorInvalidLabel);
+
+  return kErrorOk;
+}
+
+//! \internal
+//!
+//! Parse the content of a memory operand after '['.
+static Error X86Parser_parseMem(X86Parser* self, X86ParserCursor& cur, uint32_t size, uint32_t segmentId, X86Mem& out) noexcept {
+  X86Reg base;
+  X86Reg index;
+  Label label;
+
+  uint32_t shift = 0;
+  uint64_t disp = 0;
+
+  bool negate = false;
+  bool first = true;
+
+  for (;;) {
+    const char* name;
+    size_t len;
+    X86Reg reg;
+
+    if (cur.parseId(name, len)) {
+      if (cur.lowerLen && X86Parser_getReg(cur.lower, cur.lowerLen, reg)) {
+        if (reg.getType() == X86Reg::kRegSeg) {
+          // Segment override inside of brackets, `[fs:rax]`.
+          if (!first || segmentId || !cur.consume(':'))
+            return DebugUtils::errored(kErrorInvalidSyntax);
+          segmentId = reg.getId();
+          continue;
+        }
+
+        if (negate)
+          return DebugUtils::errored(kErrorInvalidAddress);
+
+        uint64_t scale = 0;
+        if (cur.consume('*')) {
+          if (!X86Parser_parseNumber(cur, scale))
+            return DebugUtils::errored(kErrorInvalidSyntax);
+        }
+
+        if (scale == 0 && !base.isReg() && !label.isValid()) {
+          base = reg;
+        }
+        else if (!index.isReg()) {
+          if (scale == 0) scale = 1;
+          if (!Utils::isPowerOf2(scale) || scale > 8)
+            return DebugUtils::errored(kErrorInvalidAddressScale);
+
+          index = reg;
+          shift = Utils::findFirstBit(static_cast<uint32_t>(scale));
+        }
+        else {
+          return DebugUtils::errored(kErrorInvalidAddress);
+        }
+      }
+      else {
+        if (negate || label.isValid() || (base.isReg() && !base.isRip()))
+          return DebugUtils::errored(kErrorInvalidAddress);
+
+        ASMJIT_PROPAGATE(X86Parser_getLabel(self, name, len, label));
+      }
+    }
+    else {
+      uint64_t value;
+      if (!X86Parser_parseNumber(cur, value))
+        return DebugUtils::errored(kErrorInvalidSyntax);
+
+      // `scale * index` form.
+      if (cur.consume('*')) {
+        if (negate || index.isReg() || !cur.parseId(name, len) ||
+            !cur.lowerLen || !X86Parser_getReg(cur.lower, cur.lowerLen, index))
+          return DebugUtils::errored(kErrorInvalidSyntax);
+
+        if (!Utils::isPowerOf2(value) || value > 8)
+          return DebugUtils::errored(kErrorInvalidAddressScale);
+        shift = Utils::findFirstBit(static_cast<uint32_t>(value));
+      }
+      else {
+        disp = negate ? disp - value : disp + value;
+      }
+    }
+
+    first = false;
+
+    char c = cur.peek();
+    if (c == ']') {
+      cur.p++;
+      break;
+    }
+
+    if (c != '+' && c != '-')
+      return DebugUtils::errored(kErrorInvalidSyntax);
+
+    negate = c == '-';
+    cur.p++;
+  }
+
+  int64_t off = static_cast<int64_t>(disp);
+  bool hasBase = base.isReg() || label.isValid();
+
+  if (hasBase && !Utils::isInt32(off))
+    return DebugUtils::errored(kErrorInvalidDisplacement);
+
+  // RIP-relative label is the same as a label, labels are always relative.
+  if (label.isValid()) {
+    if (index.isReg())
+      out = X86Mem(label, index, shift, static_cast<int32_t>(off), size);
+    else
+      out = X86Mem(label, static_cast<int32_t>(off), size);
+  }
+  else if (base.isReg()) {
+    if (index.isReg())
+      out = X86Mem(base, index, shift, static_cast<int32_t>(off), size);
+    else
+      out = X86Mem(base, static_cast<int32_t>(off), size);
+  }
+  else {
+    if (index.isReg())
+      out = X86Mem(disp, index, shift, size);
+    else
+      out = X86Mem(disp, size);
+  }
+
+  if (segmentId)
+    out.setSegmentId(segmentId);
+  return kErrorOk;
+}
+
+//! \internal
+//!
+//! Parse AVX-512 decorators that follow an operand.
+static Error X86Parser_parseDecorators(X86Parser* self, X86ParserCursor& cur, uint32_t& options) noexcept {
+  while (cur.consume('{')) {
+    const char* name;
+    size_t len;
+
+    if (cur.parseId(name, len)) {
+      X86Reg reg;
+
+      // `{rn-sae}` and friends contain '-', which is not part of identifiers.
+      if (cur.lowerLen == 2 && cur.lower[0] == 'r' && cur.consume('-')) {
+        uint32_t rc;
+        switch (cur.lower[1]) {
+          case 'n': rc = X86Inst::kOptionRN_SAE; break;
+          case 'd': rc = X86Inst::kOptionRD_SAE; break;
+          case 'u': rc = X86Inst::kOptionRU_SAE; break;
+          case 'z': rc = X86Inst::kOptionRZ_SAE; break;
+          default : return DebugUtils::errored(kErrorInvalidSyntax);
+        }
+
+        if (!cur.parseId(name, len) || cur.lowerLen != 3 || ::memcmp(cur.lower, "sae", 3) != 0)
+          return DebugUtils::errored(kErrorInvalidSyntax);
+        options |= X86Inst::kOptionER | rc;
+      }
+      else if (cur.lowerLen == 1 && cur.lower[0] == 'z') {
+        options |= X86Inst::kOptionZMask;
+      }
+      else if (cur.lowerLen == 3 && ::memcmp(cur.lower, "sae", 3) == 0) {
+        options |= X86Inst::kOptionSAE;
+      }
+      else if (cur.lowerLen && X86Parser_getReg(cur.lower, cur.lowerLen, reg) && reg.isK()) {
+        self->_emitter->setExtraReg(reg);
+      }
+      else {
+        return DebugUtils::errored(kErrorInvalidSyntax);
+      }
+    }
+    else {
+      // `{1toN}` - the count is implied by the instruction.
+      uint64_t one;
+      if (!X86Parser_parseNumber(cur, one) || one != 1)
+        return DebugUtils::errored(kErrorInvalidSyntax);
+
+      if (!cur.parseId(name, len) || cur.lowerLen < 3 || ::memcmp(cur.lower, "to", 2) != 0)
+        return DebugUtils::errored(kErrorInvalidSyntax);
+
+      for (size_t i = 2; i < cur.lowerLen; i++)
+        if (!X86Parser_isClass(cur.lower[i], kX86ParserCharDigit))
+          return DebugUtils::errored(kErrorInvalidSyntax);
+      options |= X86Inst::kOption1ToX;
+    }
+
+    if (!cur.consume('}'))
+      return DebugUtils::errored(kErrorInvalidSyntax);
+  }
+
+  return kErrorOk;
+}
+
+//! \internal
+//!
+//! Parse a single instruction operand.
+static Error X86Parser_parseOperand(X86Parser* self, X86ParserCursor& cur, Operand_& out) noexcept {
+  char c = cur.peek();
+
+  if (c == '[') {
+    cur.p++;
+    return X86Parser_parseMem(self, cur, 0, 0, out.as<X86Mem>());
+  }
+
+  if (c == '+' || c == '-' || X86Parser_isClass(c, kX86ParserCharDigit)) {
+    int64_t value;
+    if (!X86Parser_parseConst(cur, value))
+      return DebugUtils::errored(kErrorInvalidSyntax);
+
+    out = Imm(value);
+    return kErrorOk;
+  }
+
+  const char* name;
+  size_t len;
+
+  if (!cur.parseId(name, len))
+    return DebugUtils::errored(kErrorInvalidSyntax);
+
+  if (cur.lowerLen) {
+    uint32_t size = X86Parser_getMemSize(cur.lower, cur.lowerLen);
+    X86Reg reg;
+
+    if (size) {
+      // `size [ptr] [seg:][...]`.
+      const char* save = cur.p;
+      if (!cur.parseId(name, len) || cur.lowerLen != 3 || ::memcmp(cur.lower, "ptr", 3) != 0)
+        cur.p = save;
+
+      uint32_t segmentId = 0;
+      if (cur.parseId(name, len)) {
+        if (!cur.lowerLen || !X86Parser_getReg(cur.lower, cur.lowerLen, reg) || !reg.isSeg() || !cur.consume(':'))
+          return DebugUtils::errored(kErrorInvalidSyntax);
+        segmentId = reg.getId();
+      }
+
+      if (!cur.consume('['))
+        return DebugUtils::errored(kErrorInvalidSyntax);
+      return X86Parser_parseMem(self, cur, size, segmentId, out.as<X86Mem>());
+    }
+
+    if (X86Parser_getReg(cur.lower, cur.lowerLen, reg)) {
+      // `seg:[...]`.
+      if (reg.isSeg() && cur.consume(':')) {
+        if (!cur.consume('['))
+          return DebugUtils::errored(kErrorInvalidSyntax);
+        return X86Parser_parseMem(self, cur, 0, reg.getId(), out.as<X86Mem>());
+      }
+
+      out = reg;
+      return kErrorOk;
+    }
+  }
+
+  Label label;
+  ASMJIT_PROPAGATE(X86Parser_getLabel(self, name, len, label));
+
+  out = label;
+  return kErrorOk;
+}
+
+// ============================================================================
+// [asmjit::X86Parser - Statements]
+// ============================================================================
+
+//! \internal
+//!
+//! Bind a label of `name` defined by `name:`.
+static Error X86Parser_bindLabel(X86Parser* self, const char* name, size_t len) noexcept {
+  Label label;
+  ASMJIT_PROPAGATE(X86Parser_getLabel(self, name, len, label));
+
+  if (name[0] != '.')
+    self->_parentId = label.getId();
+
+  return self->_emitter->bind(label);
+}
+
+//! \internal
+//!
+//! Parse a directive, returns `kErrorInvalidInstruction` if it's not a directive.
+static Error X86Parser_parseDirective(X86Parser* self, X86ParserCursor& cur) noexcept {
+  const char* name = cur.lower;
+  size_t len = cur.lowerLen;
+
+  if (name[0] == '.') {
+    name++;
+    len--;
+  }
+
+  CodeEmitter* emitter = self->_emitter;
+  if (len == 5 && ::memcmp(name, "align", 5) == 0) {
+    uint64_t alignment;
+    if (!X86Parser_parseNumber(cur, alignment) || alignment > 64 || !Utils::isPowerOf2(alignment))
+      return DebugUtils::errored(kErrorInvalidSyntax);
+    return emitter->align(kAlignCode, static_cast<uint32_t>(alignment));
+  }
+
+  if ((len == 2 && ::memcmp(name, "db", 2) == 0) || (len == 4 && ::memcmp(name, "byte", 4) == 0)) {
+    uint8_t buf[64];
+    uint32_t count = 0;
+
+    do {
+      int64_t value;
+      if (!X86Parser_parseConst(cur, value) || value < -128 || value > 255)
+        return DebugUtils::errored(kErrorInvalidSyntax);
+
+      if (count == ASMJIT_ARRAY_SIZE(buf)) {
+        ASMJIT_PROPAGATE(emitter->embed(buf, count));
+        count = 0;
+      }
+      buf[count++] = static_cast<uint8_t>(value);
+    } while (cur.consume(','));
+
+    return emitter->embed(buf, count);
+  }
+
+  return DebugUtils::errored(kErrorInvalidInstruction);
+}
+
+//! \internal
+//!
+//! Parse a single line (without the new-line character).
+static Error X86Parser_parseLine(X86Parser* self, X86ParserCursor& cur) noexcept {
+  CodeEmitter* emitter = self->_emitter;
+  const char* name;
+  size_t len;
+
+  if (!cur.peek())
+    return kErrorOk;
+
+  if (!cur.parseId(name, len))
+    return DebugUtils::errored(kErrorInvalidSyntax);
+
+  // Label definition(s), possibly followed by an instruction.
+  while (cur.consume(':')) {
+    ASMJIT_PROPAGATE(X86Parser_bindLabel(self, name, len));
+
+    if (!cur.peek())
+      return kErrorOk;
+
+    if (!cur.parseId(name, len))
+      return DebugUtils::errored(kErrorInvalidSyntax);
+  }
+
+  if (!cur.lowerLen)
+    return DebugUtils::errored(kErrorInvalidInstruction);
+
+  // Prefixes.
+  uint32_t options = 0;
+  uint32_t prefix;
+
+  while ((prefix = X86Parser_getPrefix(cur.lower, cur.lowerLen)) != 0) {
+    options |= prefix;
+    if (!cur.parseId(name, len) || !cur.lowerLen)
+      return DebugUtils::errored(kErrorInvalidSyntax);
+  }
+
+  // String instruction aliases are only used without operands as some of them
+  // collide with SSE instructions (`movsd` and `cmpsd`).
+  uint32_t stringSize = 0;
+  uint32_t stringInst = X86Parser_getStringInst(cur.lower, cur.lowerLen, stringSize);
+
+  uint32_t instId = X86Inst::getIdByName(cur.lower, cur.lowerLen);
+  if (instId == Inst::kIdNone && stringInst == Inst::kIdNone) {
+    Error err = options ? DebugUtils::errored(kErrorInvalidInstruction)
+                        : X86Parser_parseDirective(self, cur);
+
+    // Report unknown instructions at the mnemonic, not after it.
+    if (err == kErrorInvalidInstruction)
+      cur.p = name;
+
+    ASMJIT_PROPAGATE(err);
+    return cur.peek() ? DebugUtils::errored(kErrorInvalidSyntax) : kErrorOk;
+  }
+
+  // Operands.
+  Operand opArray[6];
+  uint32_t opCount = 0;
+
+  emitter->resetExtraReg();
+  if (cur.peek()) {
+    do {
+      if (opCount == ASMJIT_ARRAY_SIZE(opArray))
+        return DebugUtils::errored(kErrorInvalidSyntax);
+
+      // Decorators such as `{sae}` can also be a standalone operand.
+      if (cur.peek() != '{')
+        ASMJIT_PROPAGATE(X86Parser_parseOperand(self, cur, opArray[opCount++]));
+      ASMJIT_PROPAGATE(X86Parser_parseDecorators(self, cur, options));
+    } while (cur.consume(','));
+
+    if (cur.peek())
+      return DebugUtils::errored(kErrorInvalidSyntax);
+  }
+
+  if (opCount == 0 && stringInst != Inst::kIdNone) {
+    instId = stringInst;
+    opCount = X86Parser_initStringOperands(emitter, instId, stringSize, opArray);
+  }
+  else if (instId == Inst::kIdNone) {
+    cur.p = name;
+    return DebugUtils::errored(kErrorInvalidInstruction);
+  }
+
+  // X86Compiler requires REP prefix to have an explicit counter register and
+  // X86Assembler accepts it, so always provide it.
+  if ((options & (X86Inst::kOptionRep | X86Inst::kOptionRepnz)) && !emitter->hasExtraReg()) {
+    X86Reg zcx;
+    zcx.setTypeAndId(emitter->getGpSize() == 8 ? X86Reg::kRegGpq : X86Reg::kRegGpd, X86Gp::kIdCx);
+    emitter->setExtraReg(zcx);
+  }
+
+  emitter->addOptions(options);
+  return emitter->_emitOpArray(instId, opArray, opCount);
+}
+
+// ============================================================================
+// [asmjit::X86Parser - Construction / Destruction]
+// ============================================================================
+
+X86Parser::X86Parser(CodeEmitter* emitter) noexcept
+  : _emitter(emitter) { reset(); }
+X86Parser::~X86Parser() noexcept {}
+
+// ============================================================================
+// [asmjit::X86Parser - Reset]
+// ============================================================================
+
+void X86Parser::reset() noexcept {
+  _parentId = 0;
+  _lineCount = 0;
+  _errorLine = 0;
+  _errorColumn = 0;
+}
+
+// ============================================================================
+// [asmjit::X86Parser - Parse]
+// ============================================================================
+
+Error X86Parser::parse(const char* input, size_t len) noexcept {
+  if (ASMJIT_UNLIKELY(!_emitter || !_emitter->isInitialized()))
+    return DebugUtils::errored(kErrorNotInitialized);
+
+  if (ASMJIT_UNLIKELY(_emitter->getArchInfo().getType() != ArchInfo::kTypeX86 &&
+                      _emitter->getArchInfo().getType() != ArchInfo::kTypeX64))
+    return DebugUtils::errored(kErrorInvalidArch);
+
+  if (len == Globals::kInvalidIndex)
+    len = ::strlen(input);
+
+  _errorLine = 0;
+  _errorColumn = 0;
+
+  const char* p = input;
+  const char* end = input + len;
+
+  X86ParserCursor cur;
+  while (p != end) {
+    // `memchr()` scans many bytes at once, which is much faster than checking
+    // a byte at a time, especially with long comments.
+    const char* lineEnd = static_cast<const char*>(::memchr(p, '\n', static_cast<size_t>(end - p)));
+    if (!lineEnd) lineEnd = end;
+
+    cur.p = p;
+    cur.end = lineEnd;
+    cur.start = p;
+    _lineCount++;
+
+    Error err = X86Parser_parseLine(this, cur);
+    if (ASMJIT_UNLIKELY(err)) {
+      _errorLine = _lineCount;
+      _errorColumn = static_cast<uint32_t>(cur.p - cur.start) + 1;
+
+      // Don't leave prefixes or a mask register for the next instruction.
+      _emitter->resetOptions();
+      _emitter->resetExtraReg();
+      return err;
+    }
+
+    p = lineEnd;
+    if (p != end) p++;
+  }
+
+  return kErrorOk;
+}
+
+// ============================================================================
+// [asmjit::X86Parser - Test]
+// ============================================================================
+
+#if defined(ASMJIT_TEST)
+//! \internal
+//!
+//! Emit `text` by `X86Parser` and compare with the code in `expected`.
+static bool X86Parser_matches(CodeHolder& expected, const char* text) noexcept {
+  CodeHolder code;
+  code.init(expected.getCodeInfo());
+
+  X86Assembler a(&code);
+  X86Parser p(&a);
+
+  if (p.parse(text) != kErrorOk || a.finalize() != kErrorOk)
+    return false;
+
+  CodeBuffer& bufA = expected.getSectionEntry(0)->getBuffer();
+  CodeBuffer& bufB = code.getSectionEntry(0)->getBuffer();
+
+  return bufA.getLength() == bufB.getLength() &&
+         ::memcmp(bufA.getData(), bufB.getData(), bufA.getLength()) == 0;
+}
+
+UNIT(x86_parser) {
+  using namespace x86;
+
+  CodeHolder code;
+
+  INFO("Parsing registers, immediates, and memory operands");
+  {
+    code.init(CodeInfo(ArchInfo::kTypeX64));
+    X86Assembler a(&code);
+
+    a.mov(eax, 1);
+    a.mov(r10b, -2);
+    a.add(rax, qword_ptr(rcx, rdx, 3, 0x10));
+    a.lea(rsi, ptr(rip, 0x100));
+    a.movzx(ecx, byte_ptr(rsp, -8));
+    a.vaddps(ymm1, ymm2, yword_ptr(rdi, r8, 2));
+    X86Mem m = dword_ptr(0x30);
+    m.setSegment(fs);
+    a.mov(eax, m);
+    a.mov(dword_ptr(rbx, r9, 0, 4), 0xFF);
+    a.vaddps(zmm0, zmm1, zmm31);
+    a.finalize();
+
+    EXPECT(X86Parser_matches(code,
+      "  mov eax, 1\n"
+      "  MOV R10B, -2 ; upper-case and a comment\n"
+      "  add rax, qword ptr [rcx + rdx * 8 + 0x10]\n"
+      "  lea rsi, [rip + 100h]\n"
+      "  movzx ecx, byte [rsp - 8]\n"
+      "\n"
+      "  vaddps ymm1, ymm2, ymmword ptr [rdi + 4*r8]\n"
+      "  mov eax, dword ptr fs:[0x30]\n"
+      "  mov dword ptr [rbx + r9 + 4], 255\n"
+      "  vaddps zmm0, zmm1, zmm31 # another comment\n"));
+    code.reset(false);
+  }
+
+  INFO("Parsing labels");
+  {
+    code.init(CodeInfo(ArchInfo::kTypeX64));
+    X86Assembler a(&code);
+
+    Label L0 = a.newLabel();
+    Label L1 = a.newLabel();
+    Label L2 = a.newLabel();
+
+    a.bind(L0);
+    a.xor_(eax, eax);
+    a.bind(L1);
+    a.dec(ecx);
+    a.jnz(L1);
+    a.jmp(L2);
+    a.mov(eax, dword_ptr(L0));
+    a.bind(L2);
+    a.ret();
+    a.finalize();
+
+    EXPECT(X86Parser_matches(code,
+      "func: xor eax, eax\n"
+      ".loop:\n"
+      "  dec ecx\n"
+      "  jnz .loop\n"
+      "  jmp done\n"
+      "  mov eax, dword ptr [func]\n"
+      "done:\n"
+      "  ret\n"));
+    code.reset(false);
+  }
+
+  INFO("Parsing prefixes, decorators, and directives");
+  {
+    code.init(CodeInfo(ArchInfo::kTypeX64));
+    X86Assembler a(&code);
+
+    a.lock().add(dword_ptr(rax), ecx);
+    a.rep().movsb();
+    a.stosq();
+    a.movsd(xmm0, xmm1);
+    a.setExtraReg(k1);
+    a.z().vaddps(zmm0, zmm1, zmm2);
+    a.rn_sae().vaddps(zmm0, zmm1, zmm2);
+    a.align(kAlignCode, 16);
+    a.db(0x90);
+    a.db(0xCC);
+    a.finalize();
+
+    EXPECT(X86Parser_matches(code,
+      "  lock add dword ptr [rax], ecx\n"
+      "  rep movsb\n"
+      "  stosq\n"
+      "  movsd xmm0, xmm1\n"
+      "  vaddps zmm0 {k1}{z}, zmm1, zmm2\n"
+      "  vaddps zmm0, zmm1, zmm2, {rn-sae}\n"
+      "  align 16\n"
+      "  db 0x90, 0xCC\n"));
+    code.reset(false);
+  }
+
+  INFO("Reporting errors");
+  {
+    code.init(CodeInfo(ArchInfo::kTypeX64));
+    X86Assembler a(&code);
+    X86Parser p(&a);
+
+    EXPECT(p.parse("  nop\n  mov eax, [rax + \n") == kErrorInvalidSyntax);
+    EXPECT(p.getErrorLine() == 2);
+
+    p.reset();
+    EXPECT(p.parse("  foo eax\n") == kErrorInvalidInstruction);
+    EXPECT(p.getErrorLine() == 1 && p.getErrorColumn() == 3);
+
+    p.reset();
+    EXPECT(p.parse("  mov eax, [rax + rcx * 3]\n") == kErrorInvalidAddressScale);
+    EXPECT(p.parse("  mov eax, ebx ebx\n") == kErrorInvalidSyntax);
+    EXPECT(p.parse("  jmp .local\n") == kErrorInvalidParentLabel);
+  }
+}
+#endif // ASMJIT_TEST
+
+} // asmjit namespace
+
+// [Api-End]
+#include "../asmjit_apiend.h"
+
+// [Guard]
+#endif // ASMJIT_BUILD_X86 && !ASMJIT_DISABLE_TEXT
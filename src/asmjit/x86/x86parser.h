@@ -0,0 +1,148 @@
+// [AsmJit]
+// Complete x86/x64 JIT and Remote Assembler for C++.
+//
+// [License]
+// Zlib - See LICENSE.md file in the package.
+
+// [Guard]
+#ifndef _ASMJIT_X86_X86PARSER_H
+#define _ASMJIT_X86_X86PARSER_H
+
+#include "../asmjit_build.h"
+#if !defined(ASMJIT_DISABLE_TEXT)
+
+// [Dependencies]
+#include "../base/codeemitter.h"
+#include "../x86/x86operand.h"
+
+// [Api-Begin]
+#include "../asmjit_apibegin.h"
+
+namespace asmjit {
+
+//! \addtogroup asmjit_x86
+//! \{
+
+// ============================================================================
+// [asmjit::X86Parser]
+// ============================================================================
+
+//! X86/X64 text assembly parser (Intel syntax).
+//!
+//! Parses textual assembly and emits it directly into any \ref CodeEmitter
+//! (\ref X86Assembler, \ref X86Builder, or \ref X86Compiler). The parser
+//! doesn't allocate - it scans the input in place, looks up instructions by
+//! `X86Inst::getIdByName()`, registers by a static table, and labels by
+//! `CodeHolder::getLabelIdByName()`.
+//!
+//! The accepted syntax is a subset of Intel syntax:
+//!
+//!   - One instruction per line, operands separated by a comma. Comments
+//!     start with `;` or `#` and end at the end of the line.
+//!   - Prefixes `lock`, `rep`, `repe`, `repz`, `repne`, `repnz`, `xacquire`,
+//!     and `xrelease` precede the instruction.
+//!   - Memory operands `[base + index * scale + disp]` with an optional size
+//!     (`byte`, `word`, `dword`, `fword`, `qword`, `tword`, `oword`, `xmmword`,
+//!     `yword`, `ymmword`, `zword`, `zmmword`) followed by optional `ptr`, and
+//!     an optional segment override (`fs:[...]` or `[fs:...]`).
+//!   - Immediates are decimal, hexadecimal (`0x` prefix or `h` suffix), or
+//!     binary (`0b` prefix) numbers, possibly combined by `+` and `-`.
+//!   - AVX-512 decorators `{k1}`, `{z}`, `{1toN}`, `{sae}`, and `{rn-sae}`,
+//!     `{rd-sae}`, `{ru-sae}`, `{rz-sae}` can follow any operand.
+//!   - `name:` binds a global label, `.name:` binds a local label that is a
+//!     child of the last global label. Labels can be referenced before they
+//!     are bound, as jump targets or as a base of a memory operand.
+//!   - Directives `align N` and `db N, ...` (also `.align` and `.byte`).
+//!
+//! Mnemonics, registers, and keywords are case insensitive, label names are
+//! case sensitive.
+//!
+//! \code
+//! CodeHolder code;
+//! code.init(CodeInfo(ArchInfo::kTypeX64));
+//!
+//! X86Assembler a(&code);
+//! X86Parser p(&a);
+//!
+//! Error err = p.parse(
+//!   "  xor eax, eax\n"
+//!   "L1:\n"
+//!   "  add eax, dword ptr [rcx + rdx * 4 + 16]\n"
+//!   "  dec rdx\n"
+//!   "  jnz L1\n"
+//!   "  ret\n");
+//!
+//! if (err)
+//!   printf("Error at line %u, column %u\n", p.getErrorLine(), p.getErrorColumn());
+//! \endcode
+class X86Parser {
+public:
+  ASMJIT_NONCOPYABLE(X86Parser)
+
+  // --------------------------------------------------------------------------
+  // [Construction / Destruction]
+  // --------------------------------------------------------------------------
+
+  //! Create a new `X86Parser` that emits into `emitter`.
+  ASMJIT_API X86Parser(CodeEmitter* emitter = nullptr) noexcept;
+  //! Destroy the `X86Parser`.
+  ASMJIT_API ~X86Parser() noexcept;
+
+  // --------------------------------------------------------------------------
+  // [Reset]
+  // --------------------------------------------------------------------------
+
+  //! Reset the line counter, the error location, and the current global label.
+  ASMJIT_API void reset() noexcept;
+
+  // --------------------------------------------------------------------------
+  // [Accessors]
+  // --------------------------------------------------------------------------
+
+  //! Get the emitter the parser emits into.
+  ASMJIT_INLINE CodeEmitter* getEmitter() const noexcept { return _emitter; }
+  //! Set the emitter the parser emits into.
+  ASMJIT_INLINE void setEmitter(CodeEmitter* emitter) noexcept { _emitter = emitter; }
+
+  //! Get the count of lines parsed so far.
+  ASMJIT_INLINE uint32_t getLineCount() const noexcept { return _lineCount; }
+
+  //! Get the line (starting at 1) where the last error happened, zero if none.
+  ASMJIT_INLINE uint32_t getErrorLine() const noexcept { return _errorLine; }
+  //! Get the column (starting at 1) where the last error happened, zero if none.
+  ASMJIT_INLINE uint32_t getErrorColumn() const noexcept { return _errorColumn; }
+
+  // --------------------------------------------------------------------------
+  // [Parse]
+  // --------------------------------------------------------------------------
+
+  //! Parse `input` and emit it into the emitter.
+  //!
+  //! The input can be passed in parts, a part must always end at a line
+  //! boundary. Lines are counted across calls until \ref reset() is called.
+  //! Returns `kErrorInvalidSyntax` if the input is not a valid assembly, or
+  //! an error returned by the emitter. The location of the error is provided
+  //! by \ref getErrorLine() and \ref getErrorColumn().
+  ASMJIT_API Error parse(const char* input, size_t len = Globals::kInvalidIndex) noexcept;
+
+  // --------------------------------------------------------------------------
+  // [Members]
+  // --------------------------------------------------------------------------
+
+  CodeEmitter* _emitter;                 //!< Emitter to emit into.
+  uint32_t _parentId;                    //!< Id of the last global label (parent of local labels).
+  uint32_t _lineCount;                   //!< Count of lines parsed.
+  uint32_t _errorLine;                   //!< Line of the last error.
+  uint32_t _errorColumn;                 //!< Column of the last error.
+};
+
+//! \}
+
+} // asmjit namespace
+
+// [Api-End]
+#include "../asmjit_apiend.h"
+
+// [Guard]
+#endif // !ASMJIT_DISABLE_TEXT
+#endif // _ASMJIT_X86_X86PARSER_H
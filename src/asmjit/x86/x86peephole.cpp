@@ -0,0 +1,518 @@
+// [AsmJit]
+// Complete x86/x64 JIT and Remote Assembler for C++.
+//
+// [License]
+// Zlib - See LICENSE.md file in the package.
+
+// [Export]
+#define ASMJIT_EXPORTS
+
+// [Guard]
+#include "../asmjit_build.h"
+#if defined(ASMJIT_BUILD_X86) && !defined(ASMJIT_DISABLE_BUILDER)
+
+// [Dependencies]
+#include "../x86/x86inst.h"
+#include "../x86/x86operand.h"
+#include "../x86/x86peephole.h"
+
+// [Api-Begin]
+#include "../asmjit_apibegin.h"
+
+namespace asmjit {
+
+// ============================================================================
+// [asmjit::X86PeepholePass - Helpers]
+// ============================================================================
+
+//! \internal
+//!
+//! Options that don't change the encoding of an instruction.
+static const uint32_t X86Peephole_kIgnoredOptions = CodeEmitter::kOptionReservedMask | CodeEmitter::kOptionOverwrite;
+
+//! \internal
+//!
+//! Maximum number of jumps followed by "JumpChain".
+static const uint32_t X86Peephole_kMaxChain = 8;
+
+static ASMJIT_INLINE bool X86Peephole_isPlain(const CBInst* node) noexcept {
+  return (node->getOptions() & ~X86Peephole_kIgnoredOptions) == 0 && !node->hasExtraReg() && !node->hasFlag(CBNode::kFlagIsPatchable);
+}
+
+static ASMJIT_INLINE bool X86Peephole_isReg(const Operand_& op, uint32_t kind, uint32_t id) noexcept {
+  return op.isReg() && op.as<Reg>().getKind() == kind && op.getId() == id;
+}
+
+//! \internal
+//!
+//! Get if `op` is the register of `kind` and `id` or a memory operand using it.
+static bool X86Peephole_refersTo(const Operand_& op, uint32_t kind, uint32_t id) noexcept {
+  if (op.isReg())
+    return op.as<Reg>().getKind() == kind && op.getId() == id;
+
+  if (op.isMem()) {
+    const X86Mem& m = op.as<X86Mem>();
+    if (m.hasBaseReg() && m.getBaseId() == id && X86Reg::kindOf(m.getBaseType()) == kind)
+      return true;
+    if (m.hasIndexReg() && m.getIndexId() == id && X86Reg::kindOf(m.getIndexType()) == kind)
+      return true;
+  }
+
+  return false;
+}
+
+//! \internal
+//!
+//! Get the minimum size of a write that overwrites a whole register of `kind`.
+//!
+//! A write to a 32-bit GP register zero extends to 64 bits, smaller writes
+//! merge. Legacy SSE instructions write either all 128 bits or merge with the
+//! existing value, which is what `getWriteSize()` describes.
+static ASMJIT_INLINE uint32_t X86Peephole_fullWriteSize(uint32_t kind) noexcept {
+  return kind == X86Reg::kKindGp ? 4 : 16;
+}
+
+//! \internal
+//!
+//! Get if the first operand `op` is written completely by an instruction.
+static bool X86Peephole_overwrites(const X86Inst::CommonData& commonData, const Operand_& op, uint32_t kind) noexcept {
+  if (!commonData.isUseW() || commonData.getWriteIndex() != 0)
+    return false;
+
+  uint32_t fullSize = X86Peephole_fullWriteSize(kind);
+  uint32_t writeSize = commonData.getWriteSize();
+  return op.getSize() >= fullSize && (writeSize == 0 || writeSize >= fullSize);
+}
+
+// ============================================================================
+// [asmjit::X86PeepholePass - Rules]
+// ============================================================================
+
+//! \internal
+//!
+//! Remove `mov r, r` and SSE moves of a register to itself.
+static bool ASMJIT_CDECL X86Peephole_removeMov(X86PeepholePass* self, CBInst* node) {
+  if (node->getOpCount() != 2 || !X86Peephole_isPlain(node))
+    return false;
+
+  const Operand* opArray = node->getOpArray();
+  if (!opArray[0].isReg() || !opArray[0].isEqual(opArray[1]))
+    return false;
+
+  // Moves to segment and control registers have side effects.
+  const Reg& r = opArray[0].as<Reg>();
+  if (!r.isGp() && !r.isVec())
+    return false;
+
+  // `mov r32, r32` clears the upper half of the register in 64-bit mode.
+  if (node->getInstId() == X86Inst::kIdMov && X86Reg::isGpd(opArray[0]) && self->cb()->getArchInfo().is64Bit())
+    return false;
+
+  self->_cb->removeNode(node);
+  return true;
+}
+
+//! \internal
+//!
+//! Replace `mov r, 0` by `xor r, r`, which is shorter, but changes flags.
+static bool ASMJIT_CDECL X86Peephole_zeroToXor(X86PeepholePass* self, CBInst* node) {
+  if (node->getOpCount() != 2 || !X86Peephole_isPlain(node))
+    return false;
+
+  Operand* opArray = node->getOpArray();
+  if (!opArray[0].isReg() || !opArray[1].isImm() || opArray[1].as<Imm>().getInt64() != 0)
+    return false;
+
+  // Only 32-bit and 64-bit registers, `xor r32, r32` clears all 64 bits.
+  if (!X86Reg::isGpd(opArray[0]) && !X86Reg::isGpq(opArray[0]))
+    return false;
+
+  if (!self->isFlagsDead(node))
+    return false;
+
+  X86Gp r = x86::gpd(opArray[0].getId());
+  node->setInstId(X86Inst::kIdXor);
+  opArray[0] = r;
+  opArray[1] = r;
+  return true;
+}
+
+//! \internal
+//!
+//! Load that can be folded into the memory operand of an instruction.
+struct X86PeepholeFold {
+  uint16_t loadId;                       //!< Load instruction, `mov r1, [m]`.
+  uint16_t opId;                         //!< Instruction `op r2, r1` that accepts `op r2, [m]`.
+  uint32_t memSize;                      //!< Size of memory operand, zero if it's the size of `r1`.
+};
+
+static const X86PeepholeFold X86Peephole_foldTable[] = {
+  { X86Inst::kIdMov  , X86Inst::kIdAdd    , 0 },
+  { X86Inst::kIdMov  , X86Inst::kIdAdc    , 0 },
+  { X86Inst::kIdMov  , X86Inst::kIdSub    , 0 },
+  { X86Inst::kIdMov  , X86Inst::kIdSbb    , 0 },
+  { X86Inst::kIdMov  , X86Inst::kIdAnd    , 0 },
+  { X86Inst::kIdMov  , X86Inst::kIdOr     , 0 },
+  { X86Inst::kIdMov  , X86Inst::kIdXor    , 0 },
+  { X86Inst::kIdMov  , X86Inst::kIdCmp    , 0 },
+  { X86Inst::kIdMov  , X86Inst::kIdImul   , 0 },
+  { X86Inst::kIdMovsd, X86Inst::kIdAddsd  , 8 },
+  { X86Inst::kIdMovsd, X86Inst::kIdSubsd  , 8 },
+  { X86Inst::kIdMovsd, X86Inst::kIdMulsd  , 8 },
+  { X86Inst::kIdMovsd, X86Inst::kIdDivsd  , 8 },
+  { X86Inst::kIdMovsd, X86Inst::kIdMinsd  , 8 },
+  { X86Inst::kIdMovsd, X86Inst::kIdMaxsd  , 8 },
+  { X86Inst::kIdMovsd, X86Inst::kIdSqrtsd , 8 },
+  { X86Inst::kIdMovsd, X86Inst::kIdComisd , 8 },
+  { X86Inst::kIdMovsd, X86Inst::kIdUcomisd, 8 },
+  { X86Inst::kIdMovss, X86Inst::kIdAddss  , 4 },
+  { X86Inst::kIdMovss, X86Inst::kIdSubss  , 4 },
+  { X86Inst::kIdMovss, X86Inst::kIdMulss  , 4 },
+  { X86Inst::kIdMovss, X86Inst::kIdDivss  , 4 },
+  { X86Inst::kIdMovss, X86Inst::kIdMinss  , 4 },
+  { X86Inst::kIdMovss, X86Inst::kIdMaxss  , 4 },
+  { X86Inst::kIdMovss, X86Inst::kIdSqrtss , 4 },
+  { X86Inst::kIdMovss, X86Inst::kIdComiss , 4 },
+  { X86Inst::kIdMovss, X86Inst::kIdUcomiss, 4 }
+};
+
+//! \internal
+//!
+//! Fold `mov r1, [m]` followed by `op r2, r1` into `op r2, [m]`.
+static bool ASMJIT_CDECL X86Peephole_foldLoad(X86PeepholePass* self, CBInst* node) {
+  if (node->getOpCount() != 2 || !X86Peephole_isPlain(node))
+    return false;
+
+  CBNode* prev = node->getPrev();
+  if (!prev || prev->getType() != CBNode::kNodeInst)
+    return false;
+
+  CBInst* load = static_cast<CBInst*>(prev);
+  if (load->getOpCount() != 2 || !X86Peephole_isPlain(load))
+    return false;
+
+  const X86PeepholeFold* fold = nullptr;
+  for (size_t i = 0; i < ASMJIT_ARRAY_SIZE(X86Peephole_foldTable); i++) {
+    if (X86Peephole_foldTable[i].loadId == load->getInstId() &&
+        X86Peephole_foldTable[i].opId == node->getInstId()) {
+      fold = &X86Peephole_foldTable[i];
+      break;
+    }
+  }
+
+  if (!fold)
+    return false;
+
+  Operand* opArray = node->getOpArray();
+  const Operand* loadArray = load->getOpArray();
+
+  const Operand& r1 = loadArray[0];
+  if (!r1.isReg() || !loadArray[1].isMem() || !opArray[0].isReg() || !opArray[1].isEqual(r1))
+    return false;
+
+  uint32_t kind = r1.as<Reg>().getKind();
+  uint32_t id = r1.getId();
+  if (X86Peephole_isReg(opArray[0], kind, id) || !self->isRegDead(node, kind, id))
+    return false;
+
+  X86Mem m = loadArray[1].as<X86Mem>();
+  m.setSize(fold->memSize ? fold->memSize : r1.getSize());
+
+#if !defined(ASMJIT_DISABLE_VALIDATION)
+  Operand newArray[2] = { opArray[0], m };
+  if (Inst::validate(self->cb()->getArchType(), node->getInstDetail(), newArray, 2) != kErrorOk)
+    return false;
+#endif // !ASMJIT_DISABLE_VALIDATION
+
+  opArray[1] = m;
+  node->_updateMemOp();
+
+  self->_cb->removeNode(load);
+  return true;
+}
+
+//! \internal
+//!
+//! Get the `CBLabel` of label `id` if it's in the node list.
+static CBLabel* X86Peephole_getLabelNode(CodeBuilder* cb, uint32_t id) noexcept {
+  const ZoneVector<CBLabel*>& labels = cb->getLabels();
+  size_t index = Operand::unpackId(id);
+
+  if (index >= labels.getLength())
+    return nullptr;
+
+  // A label bound by `flush()` has an unlinked node, if any.
+  CBLabel* label = labels[index];
+  if (!label || (!label->getPrev() && cb->getFirstNode() != label))
+    return nullptr;
+
+  return label;
+}
+
+//! \internal
+//!
+//! Retarget a jump to a label followed by an unconditional jump to the final
+//! target of the chain.
+static bool ASMJIT_CDECL X86Peephole_jumpChain(X86PeepholePass* self, CBInst* node_) {
+  if (!node_->isJmpOrJcc() || node_->getOpCount() != 1 || !node_->getOpArray()[0].isLabel())
+    return false;
+
+  if (node_->getOptions() & CodeEmitter::kOptionUnfollow)
+    return false;
+
+  CodeBuilder* cb = self->_cb;
+  CBJump* node = static_cast<CBJump*>(node_);
+
+  uint32_t originalId = node->getOpArray()[0].getId();
+  CBLabel* target = nullptr;
+  uint32_t targetId = originalId;
+
+  for (uint32_t i = 0; i < X86Peephole_kMaxChain; i++) {
+    CBLabel* label = X86Peephole_getLabelNode(cb, targetId);
+    if (!label) break;
+
+    CBNode* first = label->getNext();
+    while (first && (first->getType() == CBNode::kNodeLabel || first->getType() == CBNode::kNodeComment))
+      first = first->getNext();
+
+    if (!first || first->getType() != CBNode::kNodeInst)
+      break;
+
+    CBInst* jmp = static_cast<CBInst*>(first);
+    if (jmp->getInstId() != X86Inst::kIdJmp || jmp->isCase() || jmp->getOpCount() != 1 || !jmp->getOpArray()[0].isLabel())
+      break;
+
+    uint32_t nextId = jmp->getOpArray()[0].getId();
+    if (nextId == targetId || nextId == originalId)
+      break;
+
+    CBLabel* nextLabel = X86Peephole_getLabelNode(cb, nextId);
+    if (!nextLabel)
+      break;
+
+    target = nextLabel;
+    targetId = nextId;
+  }
+
+  if (!target)
+    return false;
+
+  // Disconnect from the current target, the jump doesn't have to be in its
+  // list if it was patched by the register allocator.
+  CBLabel* current = node->_target;
+  if (current) {
+    CBJump** pPrev = &current->_from;
+    while (*pPrev) {
+      if (*pPrev == node) {
+        *pPrev = node->_jumpNext;
+        current->subNumRefs();
+        break;
+      }
+      pPrev = &(*pPrev)->_jumpNext;
+    }
+  }
+
+  node->getOpArray()[0] = target->getLabel();
+  node->_target = target;
+  node->_jumpNext = target->_from;
+  target->_from = node;
+  target->addNumRefs();
+
+  // The new target is farther, it may not be in reach of a short jump.
+  node->delOptions(X86Inst::kOptionShortForm);
+  return true;
+}
+
+static const X86PeepholeRule X86Peephole_defaultRules[] = {
+  { "RemoveMov", X86Inst::kIdMov   , X86Peephole_removeMov },
+  { "RemoveMov", X86Inst::kIdMovaps, X86Peephole_removeMov },
+  { "RemoveMov", X86Inst::kIdMovapd, X86Peephole_removeMov },
+  { "RemoveMov", X86Inst::kIdMovups, X86Peephole_removeMov },
+  { "RemoveMov", X86Inst::kIdMovupd, X86Peephole_removeMov },
+  { "RemoveMov", X86Inst::kIdMovdqa, X86Peephole_removeMov },
+  { "RemoveMov", X86Inst::kIdMovdqu, X86Peephole_removeMov },
+  { "ZeroToXor", X86Inst::kIdMov   , X86Peephole_zeroToXor },
+  { "FoldLoad" , X86Inst::kIdNone  , X86Peephole_foldLoad  },
+  { "JumpChain", X86Inst::kIdNone  , X86Peephole_jumpChain }
+};
+
+// ============================================================================
+// [asmjit::X86PeepholePass - Construction / Destruction]
+// ============================================================================
+
+X86PeepholePass::X86PeepholePass(bool defaultRules) noexcept
+  : CBPass("Peephole"),
+    _ruleCount(0),
+    _changeCount(0) {
+
+  if (defaultRules)
+    addDefaultRules();
+}
+X86PeepholePass::~X86PeepholePass() noexcept {}
+
+// ============================================================================
+// [asmjit::X86PeepholePass - Rules]
+// ============================================================================
+
+Error X86PeepholePass::addRule(const X86PeepholeRule& rule) noexcept {
+  if (ASMJIT_UNLIKELY(!rule.handler))
+    return DebugUtils::errored(kErrorInvalidArgument);
+
+  if (ASMJIT_UNLIKELY(_ruleCount >= kMaxRules))
+    return DebugUtils::errored(kErrorInvalidState);
+
+  _rules[_ruleCount] = rule;
+  _hitCount[_ruleCount] = 0;
+  _ruleCount++;
+  return kErrorOk;
+}
+
+Error X86PeepholePass::addDefaultRules() noexcept {
+  for (size_t i = 0; i < ASMJIT_ARRAY_SIZE(X86Peephole_defaultRules); i++)
+    ASMJIT_PROPAGATE(addRule(X86Peephole_defaultRules[i]));
+  return kErrorOk;
+}
+
+void X86PeepholePass::resetRules() noexcept {
+  _ruleCount = 0;
+  _changeCount = 0;
+}
+
+// ============================================================================
+// [asmjit::X86PeepholePass - Liveness]
+// ============================================================================
+
+bool X86PeepholePass::isFlagsDead(CBNode* node, uint32_t flags) const noexcept {
+  node = node->getNext();
+
+  for (uint32_t i = 0; node && i < kMaxLookAhead; node = node->getNext(), i++) {
+    switch (node->getType()) {
+      case CBNode::kNodeComment:
+        continue;
+
+      // Functions don't take flags as arguments.
+      case CBNode::kNodeFuncCall:
+        return true;
+
+      case CBNode::kNodeInst: {
+        uint32_t instId = static_cast<CBInst*>(node)->getInstId();
+        const X86Inst& inst = X86Inst::getInst(instId);
+        const X86Inst::OperationData& operationData = inst.getOperationData();
+
+        if (operationData.getSpecialRegsR() & flags)
+          return false;
+
+        flags &= ~operationData.getSpecialRegsW();
+        if (!flags || instId == X86Inst::kIdRet)
+          return true;
+
+        if (inst.getCommonData().doesJump())
+          return false;
+        continue;
+      }
+
+      default:
+        return false;
+    }
+  }
+
+  return false;
+}
+
+bool X86PeepholePass::isRegDead(CBNode* node, uint32_t kind, uint32_t id) const noexcept {
+  node = node->getNext();
+
+  for (uint32_t i = 0; node && i < kMaxLookAhead; node = node->getNext(), i++) {
+    if (node->getType() == CBNode::kNodeComment)
+      continue;
+
+    // Calls, labels, and data end the basic block.
+    if (node->getType() != CBNode::kNodeInst)
+      return false;
+
+    CBInst* inst = static_cast<CBInst*>(node);
+    const X86Inst::CommonData& commonData = X86Inst::getInst(inst->getInstId()).getCommonData();
+
+    // Registers used implicitly are not part of operands.
+    if (commonData.hasFixedRM() || commonData.doesJump())
+      return false;
+
+    const Operand* opArray = inst->getOpArray();
+    uint32_t opCount = inst->getOpCount();
+
+    if (inst->hasExtraReg() && inst->getExtraReg().getKind() == kind && inst->getExtraReg().getId() == id)
+      return false;
+
+    bool isRead = false;
+    for (uint32_t j = 1; j < opCount; j++)
+      isRead |= X86Peephole_refersTo(opArray[j], kind, id);
+
+    if (opCount == 0 || !X86Peephole_refersTo(opArray[0], kind, id)) {
+      if (isRead) return false;
+      continue;
+    }
+
+    // Instructions like `xor r, r` don't read the register if all operands
+    // are the same.
+    if (commonData.getSingleRegCase() == X86Inst::kSingleRegWO && opCount == 2 && opArray[0].isEqual(opArray[1]))
+      return opArray[0].isReg() && opArray[0].getSize() >= X86Peephole_fullWriteSize(kind);
+
+    return !isRead && opArray[0].isReg() && X86Peephole_overwrites(commonData, opArray[0], kind);
+  }
+
+  return false;
+}
+
+// ============================================================================
+// [asmjit::X86PeepholePass - Process]
+// ============================================================================
+
+Error X86PeepholePass::process(Zone* zone) noexcept {
+  ASMJIT_UNUSED(zone);
+  CodeBuilder* cb = _cb;
+
+  _changeCount = 0;
+  for (uint32_t i = 0; i < _ruleCount; i++)
+    _hitCount[i] = 0;
+
+  for (uint32_t iteration = 0; iteration < kMaxIterations; iteration++) {
+    uint32_t changed = 0;
+    CBNode* next;
+
+    for (CBNode* node = cb->getFirstNode(); node; node = next) {
+      // Rules can remove `node`, but never the nodes after it.
+      next = node->getNext();
+      if (node->getType() != CBNode::kNodeInst)
+        continue;
+
+      CBInst* inst = static_cast<CBInst*>(node);
+      uint32_t instId = inst->getInstId();
+
+      for (uint32_t i = 0; i < _ruleCount; i++) {
+        const X86PeepholeRule& rule = _rules[i];
+        if (rule.instId != X86Inst::kIdNone && rule.instId != instId)
+          continue;
+
+        if (rule.handler(this, inst)) {
+          _hitCount[i]++;
+          changed++;
+          break;
+        }
+      }
+    }
+
+    _changeCount += changed;
+    if (!changed)
+      break;
+  }
+
+  return kErrorOk;
+}
+
+} // asmjit namespace
+
+// [Api-End]
+#include "../asmjit_apiend.h"
+
+// [Guard]
+#endif // ASMJIT_BUILD_X86 && !ASMJIT_DISABLE_BUILDER
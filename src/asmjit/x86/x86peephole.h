@@ -0,0 +1,167 @@
+// [AsmJit]
+// Complete x86/x64 JIT and Remote Assembler for C++.
+//
+// [License]
+// Zlib - See LICENSE.md file in the package.
+
+// [Guard]
+#ifndef _ASMJIT_X86_X86PEEPHOLE_H
+#define _ASMJIT_X86_X86PEEPHOLE_H
+
+#include "../asmjit_build.h"
+#if !defined(ASMJIT_DISABLE_BUILDER)
+
+// [Dependencies]
+#include "../base/codebuilder.h"
+#include "../x86/x86globals.h"
+
+// [Api-Begin]
+#include "../asmjit_apibegin.h"
+
+namespace asmjit {
+
+//! \addtogroup asmjit_x86
+//! \{
+
+// ============================================================================
+// [Forward Declarations]
+// ============================================================================
+
+class X86PeepholePass;
+
+// ============================================================================
+// [asmjit::X86PeepholeRule]
+// ============================================================================
+
+//! Peephole rule, see \ref X86PeepholePass::addRule().
+struct X86PeepholeRule {
+  //! Rule handler, called for every instruction node matching `instId`.
+  //!
+  //! Returns true if the handler changed the code. The handler can modify or
+  //! remove `node` and nodes before it, but it must not remove nodes after it.
+  typedef bool (ASMJIT_CDECL* Handler)(X86PeepholePass* pass, CBInst* node);
+
+  const char* name;                      //!< Name of the rule.
+  uint32_t instId;                       //!< Instruction id, or `X86Inst::kIdNone` to match all.
+  Handler handler;                       //!< Rule handler.
+};
+
+// ============================================================================
+// [asmjit::X86PeepholePass]
+// ============================================================================
+
+//! Peephole optimization pass.
+//!
+//! Matches every instruction node against a table of \ref X86PeepholeRule
+//! rules and lets the first matching rule rewrite it. This is repeated until
+//! no rule matches (at most `kMaxIterations` times). Default rules are:
+//!
+//!   - "RemoveMov" - Removes `mov r, r` and SSE moves of a register to itself.
+//!   - "ZeroToXor" - Replaces `mov r, 0` by `xor r, r` if flags are dead.
+//!   - "FoldLoad" - Folds `mov r1, [m]` followed by `op r2, r1` into
+//!     `op r2, [m]` if `r1` is dead after `op`.
+//!   - "JumpChain" - Retargets a jump to a label followed by `jmp` to the
+//!     final target.
+//!
+//! Liveness of registers and flags is only checked within a basic block, a
+//! register or flag that is not overwritten before the end of the block is
+//! considered live, so the rules never change the semantics of the code.
+//!
+//! The pass works with physical registers, so it has to be added after
+//! `X86Compiler` was attached, which adds its register allocator pass:
+//!
+//! ~~~
+//! X86Compiler cc(&code);
+//! cc.addPassT<X86PeepholePass>();
+//! ~~~
+class ASMJIT_VIRTAPI X86PeepholePass : public CBPass {
+public:
+  ASMJIT_NONCOPYABLE(X86PeepholePass)
+  typedef CBPass Base;
+
+  enum {
+    //! Maximum number of rules.
+    kMaxRules = 32,
+    //! Maximum number of sweeps over all nodes.
+    kMaxIterations = 4,
+    //! Maximum number of nodes visited by the liveness checks.
+    kMaxLookAhead = 32,
+
+    //! Arithmetic flags, the default flags checked by `isFlagsDead()`.
+    kArithFlags = x86::kSpecialReg_FLAGS_CF | x86::kSpecialReg_FLAGS_PF |
+                  x86::kSpecialReg_FLAGS_AF | x86::kSpecialReg_FLAGS_ZF |
+                  x86::kSpecialReg_FLAGS_SF | x86::kSpecialReg_FLAGS_OF
+  };
+
+  // --------------------------------------------------------------------------
+  // [Construction / Destruction]
+  // --------------------------------------------------------------------------
+
+  //! Create a new `X86PeepholePass`, with default rules if `defaultRules` is true.
+  ASMJIT_API X86PeepholePass(bool defaultRules = true) noexcept;
+  ASMJIT_API virtual ~X86PeepholePass() noexcept;
+
+  // --------------------------------------------------------------------------
+  // [Interface]
+  // --------------------------------------------------------------------------
+
+  ASMJIT_API virtual Error process(Zone* zone) noexcept override;
+
+  // --------------------------------------------------------------------------
+  // [Rules]
+  // --------------------------------------------------------------------------
+
+  //! Get the number of rules.
+  ASMJIT_INLINE uint32_t getRuleCount() const noexcept { return _ruleCount; }
+  //! Get the rule at `index`.
+  ASMJIT_INLINE const X86PeepholeRule& getRule(uint32_t index) const noexcept {
+    ASMJIT_ASSERT(index < _ruleCount);
+    return _rules[index];
+  }
+  //! Get how many times the rule at `index` changed the code in the last `process()`.
+  ASMJIT_INLINE uint32_t getRuleHitCount(uint32_t index) const noexcept {
+    ASMJIT_ASSERT(index < _ruleCount);
+    return _hitCount[index];
+  }
+
+  //! Get the number of changes done by all rules in the last `process()`.
+  ASMJIT_INLINE uint32_t getChangeCount() const noexcept { return _changeCount; }
+
+  //! Add `rule`, rules are matched in the order they were added.
+  ASMJIT_API Error addRule(const X86PeepholeRule& rule) noexcept;
+  //! Add all default rules.
+  ASMJIT_API Error addDefaultRules() noexcept;
+  //! Remove all rules.
+  ASMJIT_API void resetRules() noexcept;
+
+  // --------------------------------------------------------------------------
+  // [Liveness]
+  // --------------------------------------------------------------------------
+
+  //! Get if all `flags` (see \ref x86defs::SpecialRegs) are overwritten after
+  //! `node` before they are read.
+  ASMJIT_API bool isFlagsDead(CBNode* node, uint32_t flags = kArithFlags) const noexcept;
+  //! Get if a physical register of `kind` and `id` is overwritten after
+  //! `node` before it's read.
+  ASMJIT_API bool isRegDead(CBNode* node, uint32_t kind, uint32_t id) const noexcept;
+
+  // --------------------------------------------------------------------------
+  // [Members]
+  // --------------------------------------------------------------------------
+
+  uint32_t _ruleCount;                   //!< Number of rules.
+  uint32_t _changeCount;                 //!< Changes done by the last `process()`.
+  X86PeepholeRule _rules[kMaxRules];     //!< Rules.
+  uint32_t _hitCount[kMaxRules];         //!< Changes of each rule done by the last `process()`.
+};
+
+//! \}
+
+} // asmjit namespace
+
+// [Api-End]
+#include "../asmjit_apiend.h"
+
+// [Guard]
+#endif // !ASMJIT_DISABLE_BUILDER
+#endif // _ASMJIT_X86_X86PEEPHOLE_H
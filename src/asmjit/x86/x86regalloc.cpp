@@ -176,6 +176,7 @@ static ASMJIT_INLINE const X86SpecialInst* X86SpecialInst_get(uint32_t instId, c
 X86RAPass::X86RAPass() noexcept : RAPass() {
   _state = &_x86State;
   _varMapToVaListOffset = ASMJIT_OFFSET_OF(X86RAData, tiedArray);
+  _acceptsPackedOps = true;
 }
 X86RAPass::~X86RAPass() noexcept {}
 
@@ -200,13 +201,18 @@ Error X86RAPass::prepare(CCFunc* func) noexcept {
 
   _gaRegs[X86Reg::kKindGp ] = Utils::bits(_regCount.getGp()) & ~Utils::mask(X86Gp::kIdSp);
   _gaRegs[X86Reg::kKindMm ] = Utils::bits(_regCount.getMm());
-  _gaRegs[X86Reg::kKindK  ] = Utils::bits(_regCount.getK());
+  // K0 can't be used as a write-mask as its encoding means "no mask".
+  _gaRegs[X86Reg::kKindK  ] = Utils::bits(_regCount.getK()) & ~Utils::mask(0);
   _gaRegs[X86Reg::kKindVec] = Utils::bits(_regCount.getVec());
 
   _x86State.reset(0);
   _clobberedRegs.reset();
 
-  _avxEnabled = false;
+  // Use VEX encoded moves from the start if the target CPU has AVX, this
+  // avoids mixing legacy SSE spills with AVX code (transition penalties).
+  _avxEnabled = cc()->getCodeInfo().getFeatures().has(CpuInfo::kX86FeatureAVX);
+  if (_avxEnabled)
+    func->getFrameInfo().enableAvx();
 
   _varBaseRegId = Globals::kInvalidRegId; // Used by patcher.
   _varBaseOffset = 0;                     // Used by patcher.
@@ -227,7 +233,8 @@ Error X86RAPass::emitMove(VirtReg* vReg, uint32_t dstId, uint32_t srcId, const c
 
   X86Reg dst(X86Reg::fromSignature(vReg->getSignature(), dstId));
   X86Reg src(X86Reg::fromSignature(vReg->getSignature(), srcId));
-  return X86Internal::emitRegMove(reinterpret_cast<X86Emitter*>(cc()), dst, src, vReg->getTypeId(), _avxEnabled, comment);
+  ASMJIT_PROPAGATE(X86Internal::emitRegMove(reinterpret_cast<X86Emitter*>(cc()), dst, src, vReg->getTypeId(), _avxEnabled, comment));
+  return addReportMove(CCFuncReport::kMoveReg, vReg);
 }
 
 Error X86RAPass::emitLoad(VirtReg* vReg, uint32_t id, const char* reason) {
@@ -237,9 +244,17 @@ Error X86RAPass::emitLoad(VirtReg* vReg, uint32_t id, const char* reason) {
     comment = _stringBuilder.getData();
   }
 
+  if (vReg->isMaterialized()) {
+    ASMJIT_PROPAGATE(emitMaterialize(vReg, id, comment));
+    return addReportMove(CCFuncReport::kMoveRemat, vReg);
+  }
+
+  _stats.loadCount += _statsEnabled;
+
   X86Reg dst(X86Reg::fromSignature(vReg->getSignature(), id));
   X86Mem src(getVarMem(vReg));
-  return X86Internal::emitRegMove(reinterpret_cast<X86Emitter*>(cc()), dst, src, vReg->getTypeId(), _avxEnabled, comment);
+  ASMJIT_PROPAGATE(X86Internal::emitRegMove(reinterpret_cast<X86Emitter*>(cc()), dst, src, vReg->getTypeId(), _avxEnabled, comment));
+  return addReportMove(CCFuncReport::kMoveLoad, vReg);
 }
 
 Error X86RAPass::emitSave(VirtReg* vReg, uint32_t id, const char* reason) {
@@ -249,9 +264,51 @@ Error X86RAPass::emitSave(VirtReg* vReg, uint32_t id, const char* reason) {
     comment = _stringBuilder.getData();
   }
 
+  // Materialized register is recreated by `emitLoad()`, it doesn't need a
+  // memory cell at all.
+  if (vReg->isMaterialized())
+    return kErrorOk;
+
+  _stats.spillCount += _statsEnabled;
+
   X86Mem dst(getVarMem(vReg));
   X86Reg src(X86Reg::fromSignature(vReg->getSignature(), id));
-  return X86Internal::emitRegMove(reinterpret_cast<X86Emitter*>(cc()), dst, src, vReg->getTypeId(), _avxEnabled, comment);
+  ASMJIT_PROPAGATE(X86Internal::emitRegMove(reinterpret_cast<X86Emitter*>(cc()), dst, src, vReg->getTypeId(), _avxEnabled, comment));
+  return addReportMove(CCFuncReport::kMoveSpill, vReg);
+}
+
+Error X86RAPass::emitMaterialize(VirtReg* vReg, uint32_t id, const char* comment) {
+  const CBInst* node = static_cast<const CBInst*>(vReg->getMaterializeNode());
+  Operand opBuf[CBInst::kMaxPackedOps];
+  const Operand* srcArray = node->getOpArray(opBuf);
+  uint32_t opCount = node->getOpCount();
+
+  _stats.rematCount += _statsEnabled;
+
+  // GP zero idiom (`xor r, r` or `sub r, r`) is recreated by `mov r, 0` as
+  // it would clobber flags.
+  if (static_cast<const X86Reg&>(srcArray[0]).isGp() && srcArray[1].isReg()) {
+    Imm zero(0);
+    cc()->setInlineComment(comment);
+    return emitImmToReg(TypeId::kU32, id, &zero);
+  }
+
+  Operand opArray[6];
+  for (uint32_t i = 0; i < opCount; i++) {
+    opArray[i] = srcArray[i];
+    if (opArray[i].isReg())
+      opArray[i].as<X86Reg>().setId(id);
+  }
+
+  // Memory home of a stack register is referenced by its VirtReg id, it's
+  // patched by `X86RAPass_patchFuncMem()` after the function is translated.
+  if (opCount > 1 && opArray[1].isMem() && opArray[1].as<X86Mem>().isRegHome()) {
+    if (!getVarCell(cc()->getVirtRegById(opArray[1].as<X86Mem>().getBaseId())))
+      return DebugUtils::errored(kErrorNoHeapMemory);
+  }
+
+  cc()->setInlineComment(comment);
+  return cc()->emitOpArray(node->getInstId(), opArray, opCount);
 }
 
 Error X86RAPass::emitSwapGp(VirtReg* dstReg, VirtReg* srcReg, uint32_t dstPhysId, uint32_t srcPhysId, const char* reason) noexcept {
@@ -268,7 +325,7 @@ Error X86RAPass::emitSwapGp(VirtReg* dstReg, VirtReg* srcReg, uint32_t dstPhysId
   ASMJIT_PROPAGATE(cc()->emit(X86Inst::kIdXchg, a, b));
   if (_emitComments)
     cc()->getCursor()->setInlineComment(cc()->_cbDataZone.sformat("[%s] %s, %s", reason, dstReg->getName(), srcReg->getName()));
-  return kErrorOk;
+  return addReportMove(CCFuncReport::kMoveReg, dstReg);
 }
 
 Error X86RAPass::emitImmToReg(uint32_t dstTypeId, uint32_t dstPhysId, const Imm* src) noexcept {
@@ -612,6 +669,7 @@ static ASMJIT_INLINE void X86RAPass_checkStateVars(X86RAPass* self) {
 void X86RAPass::_checkState() {
   X86RAPass_checkStateVars<X86Reg::kKindGp >(this);
   X86RAPass_checkStateVars<X86Reg::kKindMm >(this);
+  X86RAPass_checkStateVars<X86Reg::kKindK  >(this);
   X86RAPass_checkStateVars<X86Reg::kKindVec>(this);
 }
 #else
@@ -654,6 +712,7 @@ void X86RAPass::loadState(RAState* src_) {
   // Load allocated variables.
   X86RAPass_loadStateVars<X86Reg::kKindGp >(this, src);
   X86RAPass_loadStateVars<X86Reg::kKindMm >(this, src);
+  X86RAPass_loadStateVars<X86Reg::kKindK  >(this, src);
   X86RAPass_loadStateVars<X86Reg::kKindVec>(this, src);
 
   // Load masks.
@@ -834,9 +893,12 @@ void X86RAPass::switchState(RAState* src_) {
     return;
 
   // Switch variables.
+  _inSwitch = 1;
   X86RAPass_switchStateVars<X86Reg::kKindGp >(this, src);
   X86RAPass_switchStateVars<X86Reg::kKindMm >(this, src);
+  X86RAPass_switchStateVars<X86Reg::kKindK  >(this, src);
   X86RAPass_switchStateVars<X86Reg::kKindVec>(this, src);
+  _inSwitch = 0;
 
   // Calculate changed state.
   VirtReg** vregs = _contextVd.getData();
@@ -968,9 +1030,12 @@ void X86RAPass::intersectStates(RAState* a_, RAState* b_) {
   ASMJIT_ASSERT(a != nullptr);
   ASMJIT_ASSERT(b != nullptr);
 
+  _inSwitch = 1;
   X86RAPass_intersectStateVars<X86Reg::kKindGp >(this, a, b);
   X86RAPass_intersectStateVars<X86Reg::kKindMm >(this, a, b);
+  X86RAPass_intersectStateVars<X86Reg::kKindK  >(this, a, b);
   X86RAPass_intersectStateVars<X86Reg::kKindVec>(this, a, b);
+  _inSwitch = 0;
 
   ASMJIT_X86_CHECK_STATE
 }
@@ -1226,6 +1291,85 @@ static ASMJIT_INLINE Error X86RAPass_insertPushArg(
 // [asmjit::X86RAPass - Fetch]
 // ============================================================================
 
+//! \internal
+//!
+//! Get whether `node` computes a value that doesn't depend on any register
+//! or writable memory, so it can be repeated instead of loading `vreg` from
+//! its memory cell. `flags` are flags of `vreg` in `node`.
+static bool X86RAPass_isMaterializable(X86RAPass* self, VirtReg* vreg, CBNode* node_, uint32_t flags) {
+  if (node_->getType() != CBNode::kNodeInst || vreg->isFixed())
+    return false;
+
+  CBInst* node = static_cast<CBInst*>(node_);
+  uint32_t instId = node->getInstId();
+  uint32_t opCount = node->getOpCount();
+  Operand opBuf[CBInst::kMaxPackedOps];
+  const Operand* opArray = node->getOpArray(opBuf);
+
+  if (opCount < 2 || opCount > 4 || !opArray[0].isReg() || opArray[0].getId() != vreg->getId())
+    return false;
+
+  // Rematerialization would copy operands that are patched later.
+  if ((node->getOptions() & ~CodeEmitter::kOptionReservedMask) || node->hasExtraReg() || node->hasFlag(CBNode::kFlagIsPatchable))
+    return false;
+
+  const X86Inst& inst = X86Inst::getInst(instId);
+  const X86Inst::CommonData& commonData = inst.getCommonData();
+  if (commonData.hasFixedRM())
+    return false;
+
+  // Zero idiom - `xor r, r`, `pxor x, x`, `vxorps y, y, y`, ...
+  if (commonData.getSingleRegCase() == X86Inst::kSingleRegWO) {
+    uint32_t i;
+    for (i = 1; i < opCount; i++)
+      if (!opArray[i].isEqual(opArray[0]))
+        break;
+    if (i == opCount)
+      return static_cast<const X86Reg&>(opArray[0]).isGp() || inst.getOperationData().getSpecialRegsW() == 0;
+  }
+
+  // Any other instruction has to write the register without reading it.
+  if ((flags & (TiedReg::kRAll | TiedReg::kXMem)) != 0 || (flags & TiedReg::kWAll) != TiedReg::kWReg)
+    return false;
+
+  const X86Inst::OperationData& operationData = inst.getOperationData();
+  if (operationData.getSpecialRegsR() || operationData.getSpecialRegsW())
+    return false;
+
+  for (uint32_t i = 1; i < opCount; i++) {
+    const Operand& op = opArray[i];
+    if (op.isImm())
+      continue;
+
+    if (!op.isMem())
+      return false;
+
+    // Only an address of a stack memory or label can be recreated, a content
+    // of a memory can be only if it's a constant pool.
+    const X86Mem& m = static_cast<const X86Mem&>(op);
+    if (m.hasIndex() || m.hasSegment() || m.isArgHome())
+      return false;
+
+    if (m.isRegHome()) {
+      if (instId != X86Inst::kIdLea)
+        return false;
+    }
+    else if (m.hasBaseLabel()) {
+      if (instId != X86Inst::kIdLea) {
+        const ZoneVector<CBLabel*>& labels = self->cc()->getLabels();
+        size_t index = Operand::unpackId(m.getBaseId());
+        if (index >= labels.getLength() || !labels[index] || labels[index]->getType() != CBNode::kNodeConstPool)
+          return false;
+      }
+    }
+    else {
+      return false;
+    }
+  }
+
+  return true;
+}
+
 //! \internal
 //!
 //! Prepare the given function `func`.
@@ -1310,6 +1454,18 @@ Error X86RAPass::fetch() {
         else \
           tied->allocableRegs &= ~inRegs.get(_kind); \
         \
+        /* The first write decides whether the register is materialized, */ \
+        /* any other write or memory access makes it a regular register.  */ \
+        if (!vreg->_materializeNode) { \
+          if (tied->flags & (TiedReg::kWAll | TiedReg::kXMem)) { \
+            vreg->_materializeNode = NODE; \
+            vreg->_isMaterialized = X86RAPass_isMaterializable(this, vreg, NODE, tied->flags); \
+          } \
+        } \
+        else if (tied->flags & (TiedReg::kWAll | TiedReg::kXMem)) { \
+          vreg->_isMaterialized = false; \
+        } \
+        \
         vreg->_tied = nullptr; \
         raData->setTiedAt(_index, *tied); \
         \
@@ -1396,7 +1552,7 @@ _NextGroup:
 
           remain[X86Reg::kKindGp ] = _regCount.getGp() - 1 - func->getFrameInfo().hasPreservedFP();
           remain[X86Reg::kKindMm ] = _regCount.getMm();
-          remain[X86Reg::kKindK  ] = _regCount.getK();
+          remain[X86Reg::kKindK  ] = _regCount.getK() - 1;
           remain[X86Reg::kKindVec] = _regCount.getVec();
 
           // Merge as many alloc-hints as possible.
@@ -1486,7 +1642,8 @@ _NextGroup:
         uint32_t options = node->getOptions();
         uint32_t gpAllowedMask = 0xFFFFFFFF;
 
-        Operand* opArray = node->getOpArray();
+        Operand opBuf[CBInst::kMaxPackedOps];
+        const Operand* opArray = node->getOpArray(opBuf);
         uint32_t opCount = node->getOpCount();
 
         RA_DECLARE();
@@ -1495,6 +1652,14 @@ _NextGroup:
           const X86Inst::CommonData& commonData = inst.getCommonData();
           const X86SpecialInst* special = nullptr;
 
+          // AVX-512 merge-masking {k} keeps destination elements that are not
+          // selected by the mask, so the destination is also read. Zero-masking
+          // {k}{z} and K destinations (compares) are still write-only.
+          bool isMergeMasked = node->hasExtraReg() &&
+                               node->getExtraReg().getType() == X86Reg::kRegK &&
+                               !(options & X86Inst::kOptionZMask) &&
+                               !(opArray[0].isReg() && opArray[0].as<X86Reg>().isK());
+
           // Collect instruction flags and merge all 'TiedReg's.
           if (commonData.isFpu())
             flags |= CBNode::kFlagIsFp;
@@ -1503,7 +1668,7 @@ _NextGroup:
             flags |= CBNode::kFlagIsSpecial;
 
           for (uint32_t i = 0; i < opCount; i++) {
-            Operand* op = &opArray[i];
+            const Operand* op = &opArray[i];
             VirtReg* vreg;
             TiedReg* tied;
 
@@ -1512,8 +1677,8 @@ _NextGroup:
               if (vreg->isFixed()) continue;
 
               RA_MERGE(vreg, tied, 0, gaRegs[vreg->getKind()] & gpAllowedMask);
-              if (static_cast<X86Reg*>(op)->isGpb()) {
-                tied->flags |= static_cast<X86Gp*>(op)->isGpbLo() ? TiedReg::kX86GpbLo : TiedReg::kX86GpbHi;
+              if (static_cast<const X86Reg*>(op)->isGpb()) {
+                tied->flags |= static_cast<const X86Gp*>(op)->isGpbLo() ? TiedReg::kX86GpbLo : TiedReg::kX86GpbHi;
                 if (archType == ArchInfo::kTypeX86) {
                   // If a byte register is accessed in 32-bit mode we have to limit
                   // all allocable registers for that variable to eax/ebx/ecx/edx.
@@ -1527,7 +1692,7 @@ _NextGroup:
                   // half. To do that, we patch 'allocableRegs' of all variables
                   // we collected until now and change the allocable restriction
                   // for variables that come after.
-                  if (static_cast<X86Gp*>(op)->isGpbHi()) {
+                  if (static_cast<const X86Gp*>(op)->isGpbHi()) {
                     tied->allocableRegs &= 0x0F;
                     if (gpAllowedMask != 0xFF) {
                       for (uint32_t j = 0; j < i; j++)
@@ -1575,7 +1740,7 @@ _NextGroup:
                     // Manually forcing write-only.
                     combinedFlags = outFlags;
                   }
-                  else if (commonData.isUseW()) {
+                  else if (commonData.isUseW() && !isMergeMasked) {
                     // Write-only instruction.
                     uint32_t movSize = commonData.getWriteSize();
                     uint32_t regSize = vreg->getSize();
@@ -1631,7 +1796,7 @@ _NextGroup:
               }
             }
             else if (op->isMem()) {
-              X86Mem* m = static_cast<X86Mem*>(op);
+              const X86Mem* m = static_cast<const X86Mem*>(op);
               node->setMemOpIndex(i);
 
               uint32_t specBase = special ? uint32_t(special[i].inReg) : uint32_t(Globals::kInvalidRegId);
@@ -1949,16 +2114,23 @@ _NextGroup:
         Operand_* args = node->_args;
         Operand_* rets = node->_ret;
 
-        func->getFrameInfo().enableCalls();
-        func->getFrameInfo().mergeCallFrameSize(fd.getArgStackSize());
-        // TODO: Each function frame should also define its stack arguments' alignment.
-        // func->getFrameInfo().mergeCallFrameAlignment();
-
         uint32_t i;
         uint32_t argCount = fd.getArgCount();
         uint32_t sArgCount = 0;
         uint32_t gpAllocableMask = gaRegs[X86Reg::kKindGp] & ~node->getDetail().getUsedRegs(X86Reg::kKindGp);
 
+        // A tail call doesn't need a call frame, but its target can't be in
+        // a register restored by the epilog, which precedes the jump.
+        if (node->getInstId() == X86Inst::kIdJmp) {
+          gpAllocableMask &= ~func->getDetail().getPreservedRegs(X86Reg::kKindGp);
+        }
+        else {
+          func->getFrameInfo().enableCalls();
+          func->getFrameInfo().mergeCallFrameSize(fd.getArgStackSize());
+          // TODO: Each function frame should also define its stack arguments' alignment.
+          // func->getFrameInfo().mergeCallFrameAlignment();
+        }
+
         VirtReg* vreg;
         TiedReg* tied;
 
@@ -2093,6 +2265,138 @@ NoMem:
   return DebugUtils::errored(kErrorNoHeapMemory);
 }
 
+// ============================================================================
+// [asmjit::X86RAPass - Coalesce]
+// ============================================================================
+
+bool X86RAPass::isCopy(CBNode* node_, VirtReg** pDst, VirtReg** pSrc) {
+  if (node_->getType() != CBNode::kNodeInst)
+    return false;
+
+  CBInst* node = static_cast<CBInst*>(node_);
+  if (node->getOpCount() != 2 || (node->getOptions() & ~CodeEmitter::kOptionReservedMask) || node->hasExtraReg())
+    return false;
+
+  // Only moves that copy the whole register, `movss` and `movsd` merge.
+  switch (node->getInstId()) {
+    case X86Inst::kIdMov:
+    case X86Inst::kIdMovaps:
+    case X86Inst::kIdMovapd:
+    case X86Inst::kIdMovdqa:
+    case X86Inst::kIdMovups:
+    case X86Inst::kIdMovupd:
+    case X86Inst::kIdMovdqu:
+    case X86Inst::kIdVmovaps:
+    case X86Inst::kIdVmovapd:
+    case X86Inst::kIdVmovdqa:
+    case X86Inst::kIdVmovups:
+    case X86Inst::kIdVmovupd:
+    case X86Inst::kIdVmovdqu:
+      break;
+
+    default:
+      return false;
+  }
+
+  Operand opBuf[CBInst::kMaxPackedOps];
+  const Operand* opArray = node->getOpArray(opBuf);
+  if (!opArray[0].isReg() || !opArray[1].isReg() ||
+      !Operand::isPackedId(opArray[0].getId()) ||
+      !Operand::isPackedId(opArray[1].getId()))
+    return false;
+
+  VirtReg* dst = cc()->getVirtRegById(opArray[0].getId());
+  VirtReg* src = cc()->getVirtRegById(opArray[1].getId());
+
+  // Both operands have to be used as a whole register of the same type.
+  if (dst->isFixed() || dst->isStack() || src->isFixed() || src->isStack() ||
+      dst->getTypeId() != src->getTypeId() ||
+      opArray[0].getSignature() != dst->getSignature() ||
+      opArray[1].getSignature() != src->getSignature())
+    return false;
+
+  *pDst = dst;
+  *pSrc = src;
+  return true;
+}
+
+// ============================================================================
+// [asmjit::X86RAPass - Dead Code]
+// ============================================================================
+
+static const uint32_t X86RAPass_kArithFlags =
+  x86::kSpecialReg_FLAGS_CF | x86::kSpecialReg_FLAGS_PF |
+  x86::kSpecialReg_FLAGS_AF | x86::kSpecialReg_FLAGS_ZF |
+  x86::kSpecialReg_FLAGS_SF | x86::kSpecialReg_FLAGS_OF;
+
+bool X86RAPass::canRemoveDead(CBNode* node_, uint32_t* flagsR, uint32_t* flagsW) {
+  // Nodes other than instructions may read anything.
+  *flagsR = 0xFFFFFFFFU;
+  *flagsW = 0;
+
+  if (node_->getType() != CBNode::kNodeInst)
+    return false;
+
+  CBInst* node = static_cast<CBInst*>(node_);
+  uint32_t instId = node->getInstId();
+
+  const X86Inst& inst = X86Inst::getInst(instId);
+  const X86Inst::CommonData& commonData = inst.getCommonData();
+  const X86Inst::OperationData& operationData = inst.getOperationData();
+
+  uint32_t r = operationData.getSpecialRegsR();
+  uint32_t w = operationData.getSpecialRegsW();
+
+  *flagsR = r;
+  *flagsW = w;
+
+  Operand opBuf[CBInst::kMaxPackedOps];
+  const Operand* opArray = node->getOpArray(opBuf);
+  uint32_t opCount = node->getOpCount();
+
+  // Shifts and rotates don't change flags if the count is zero.
+  switch (instId) {
+    case X86Inst::kIdRcl:
+    case X86Inst::kIdRcr:
+    case X86Inst::kIdRol:
+    case X86Inst::kIdRor:
+    case X86Inst::kIdSal:
+    case X86Inst::kIdSar:
+    case X86Inst::kIdShl:
+    case X86Inst::kIdShr:
+    case X86Inst::kIdShld:
+    case X86Inst::kIdShrd:
+      if (!opCount || !opArray[opCount - 1].isImm() || (static_cast<const Imm&>(opArray[opCount - 1]).getUInt32() & 0x3F) == 0) {
+        *flagsW = 0;
+        return false;
+      }
+      break;
+  }
+
+  if (!opCount || node->isSpecial() || node->isFp() || node->hasExtraReg() ||
+      (node->getOptions() & (X86Inst::kOptionLock | X86Inst::kOptionRep | X86Inst::kOptionRepnz)) ||
+      commonData.doesJump() ||
+      commonData.hasFlag(X86Inst::kFlagUseXX | X86Inst::kFlagFixedRM | X86Inst::kFlagFpu) ||
+      operationData.hasOperationFlag(X86Inst::kOperationPrefetch | X86Inst::kOperationBarrier | X86Inst::kOperationVolatile | X86Inst::kOperationPrivileged) ||
+      ((r | w) & ~X86RAPass_kArithFlags))
+    return false;
+
+  // Memory can only be read and registers must be virtual, otherwise the
+  // node has effects that liveness of virtual registers doesn't describe.
+  for (uint32_t i = 0; i < opCount; i++) {
+    const Operand& op = opArray[i];
+    if (op.isMem()) {
+      if (i == 0) return false;
+    }
+    else if (op.isReg()) {
+      if (!op.isVirtReg() || cc()->getVirtRegById(op.getId())->isFixed())
+        return false;
+    }
+  }
+
+  return true;
+}
+
 // ============================================================================
 // [asmjit::X86RAPass - Annotate]
 // ============================================================================
@@ -2112,12 +2416,13 @@ Error X86RAPass::annotate() {
     if (!node_->hasInlineComment()) {
       if (node_->getType() == CBNode::kNodeInst) {
         CBInst* node = static_cast<CBInst*>(node_);
+        Operand opBuf[CBInst::kMaxPackedOps];
         Logging::formatInstruction(
           sb,
           0,
           cc(),
           cc()->getArchType(),
-          node->getInstDetail(), node->getOpArray(), node->getOpCount());
+          node->getInstDetail(), node->getOpArray(opBuf), node->getOpCount());
 
         node_->setInlineComment(
           static_cast<char*>(dataZone.dup(sb.getData(), sb.getLength(), true)));
@@ -2135,6 +2440,27 @@ Error X86RAPass::annotate() {
   return kErrorOk;
 }
 
+Error X86RAPass::formatInlineComment(StringBuilder& dst, CBNode* node) {
+#if !defined(ASMJIT_DISABLE_LOGGING)
+  if (node->getType() == CBNode::kNodeFunc) {
+    const CCFuncReport* report = static_cast<CCFunc*>(node)->getReport();
+    if (report) {
+      const uint32_t* live = report->maxLive;
+      const uint32_t* n = report->moveCount;
+
+      return dst.appendFormat(
+        "[RA] live gp=%u mm=%u k=%u vec=%u | spill=%u load=%u remat=%u move=%u (switch=%u) | stack=%u",
+        live[X86Reg::kKindGp], live[X86Reg::kKindMm], live[X86Reg::kKindK], live[X86Reg::kKindVec],
+        n[CCFuncReport::kMoveSpill], n[CCFuncReport::kMoveLoad], n[CCFuncReport::kMoveRemat], n[CCFuncReport::kMoveReg],
+        report->switchMoveCount,
+        report->stackSize);
+    }
+  }
+#endif // !ASMJIT_DISABLE_LOGGING
+
+  return Base::formatInlineComment(dst, node);
+}
+
 // ============================================================================
 // [asmjit::X86BaseAlloc]
 // ============================================================================
@@ -2368,6 +2694,13 @@ protected:
   template<int C>
   ASMJIT_INLINE uint32_t guessSpill(VirtReg* vreg, uint32_t allocableRegs);
 
+  //! Pick a register to free from occupied `candidateRegs` (linear-scan).
+  //!
+  //! Returns the register that holds a variable with the furthest end of its
+  //! live range, which is the variable linear-scan would spill.
+  template<int C>
+  ASMJIT_INLINE uint32_t pickVictim(uint32_t candidateRegs);
+
   // --------------------------------------------------------------------------
   // [Modified]
   // --------------------------------------------------------------------------
@@ -2399,22 +2732,26 @@ Error X86VarAlloc::run(CBNode* node_) {
     // Unuse overwritten variables.
     unuseBefore<X86Reg::kKindGp>();
     unuseBefore<X86Reg::kKindMm>();
+    unuseBefore<X86Reg::kKindK>();
     unuseBefore<X86Reg::kKindVec>();
 
     // Plan the allocation. Planner assigns input/output registers for each
     // variable and decides whether to allocate it in register or stack.
     plan<X86Reg::kKindGp>();
     plan<X86Reg::kKindMm>();
+    plan<X86Reg::kKindK>();
     plan<X86Reg::kKindVec>();
 
     // Spill all variables marked by plan().
     spill<X86Reg::kKindGp>();
     spill<X86Reg::kKindMm>();
+    spill<X86Reg::kKindK>();
     spill<X86Reg::kKindVec>();
 
     // Alloc all variables marked by plan().
     alloc<X86Reg::kKindGp>();
     alloc<X86Reg::kKindMm>();
+    alloc<X86Reg::kKindK>();
     alloc<X86Reg::kKindVec>();
 
     // Translate node operands.
@@ -2425,7 +2762,19 @@ Error X86VarAlloc::run(CBNode* node_) {
         ASMJIT_PROPAGATE(X86RAPass_translateOperands(_context, &reg, 1));
         node->setExtraReg(reg);
       }
-      ASMJIT_PROPAGATE(X86RAPass_translateOperands(_context, node->getOpArray(), node->getOpCount()));
+
+      if (node->hasPackedOps()) {
+        // Translated operands are packed again unless some of them became
+        // memory operands, see `CodeBuilder::setOps()`.
+        Operand opBuf[CBInst::kMaxPackedOps];
+        Operand* opArray = const_cast<Operand*>(node->getOpArray(opBuf));
+
+        ASMJIT_PROPAGATE(X86RAPass_translateOperands(_context, opArray, node->getOpCount()));
+        ASMJIT_PROPAGATE(_cc->setOps(node, opArray));
+      }
+      else {
+        ASMJIT_PROPAGATE(X86RAPass_translateOperands(_context, node->getOpArray(), node->getOpCount()));
+      }
     }
     else if (node_->getType() == CBNode::kNodePushArg) {
       CCPushArg* node = static_cast<CCPushArg*>(node_);
@@ -2472,6 +2821,7 @@ Error X86VarAlloc::run(CBNode* node_) {
     // Mark variables as modified.
     modified<X86Reg::kKindGp>();
     modified<X86Reg::kKindMm>();
+    modified<X86Reg::kKindK>();
     modified<X86Reg::kKindVec>();
 
     // Cleanup; disconnect Vd->Va.
@@ -2488,6 +2838,7 @@ Error X86VarAlloc::run(CBNode* node_) {
   if (raData->tiedTotal != 0) {
     unuseAfter<X86Reg::kKindGp>();
     unuseAfter<X86Reg::kKindMm>();
+    unuseAfter<X86Reg::kKindK>();
     unuseAfter<X86Reg::kKindVec>();
   }
 
@@ -2679,7 +3030,10 @@ ASMJIT_INLINE void X86VarAlloc::plan() {
       }
       if (candidateRegs & homeMask) candidateRegs &= homeMask;
 
-      physId = Utils::findFirstBit(candidateRegs);
+      if (_context->_linearScan && (candidateRegs & occupied) == candidateRegs)
+        physId = pickVictim<C>(candidateRegs);
+      else
+        physId = Utils::findFirstBit(candidateRegs);
       regMask = Utils::mask(physId);
 
       if ((vaFlags & TiedReg::kXReg) == TiedReg::kWReg) {
@@ -2935,6 +3289,48 @@ ASMJIT_INLINE uint32_t X86VarAlloc::guessSpill(VirtReg* vreg, uint32_t allocable
   return 0;
 }
 
+template<int C>
+ASMJIT_INLINE uint32_t X86VarAlloc::pickVictim(uint32_t candidateRegs) {
+  ASMJIT_ASSERT(candidateRegs != 0);
+
+  VirtReg** vregs = getState()->getListByKind(C);
+  uint32_t bestId = Utils::findFirstBit(candidateRegs);
+  uint32_t bestEnd = 0;
+
+  if (_context->_globalAlloc) {
+    // Spill the variable with the lowest weight, prefer the one that stays
+    // alive the longest if weights are equal.
+    uint32_t bestWeight = 0xFFFFFFFFU;
+
+    do {
+      uint32_t physId = Utils::findFirstBit(candidateRegs);
+      VirtReg* vreg = vregs[physId];
+
+      candidateRegs &= candidateRegs - 1;
+      if (vreg && (vreg->_spillWeight < bestWeight || (vreg->_spillWeight == bestWeight && vreg->_rangeEnd > bestEnd))) {
+        bestId = physId;
+        bestEnd = vreg->_rangeEnd;
+        bestWeight = vreg->_spillWeight;
+      }
+    } while (candidateRegs);
+
+    return bestId;
+  }
+
+  do {
+    uint32_t physId = Utils::findFirstBit(candidateRegs);
+    VirtReg* vreg = vregs[physId];
+
+    candidateRegs &= candidateRegs - 1;
+    if (vreg && vreg->_rangeEnd > bestEnd) {
+      bestId = physId;
+      bestEnd = vreg->_rangeEnd;
+    }
+  } while (candidateRegs);
+
+  return bestId;
+}
+
 // ============================================================================
 // [asmjit::X86VarAlloc - Modified]
 // ============================================================================
@@ -3075,22 +3471,26 @@ Error X86CallAlloc::run(CCFuncCall* node) {
   // variable. If any variable is used multiple times it will be handled later.
   plan<X86Reg::kKindGp >();
   plan<X86Reg::kKindMm >();
+  plan<X86Reg::kKindK  >();
   plan<X86Reg::kKindVec>();
 
   // Spill.
   spill<X86Reg::kKindGp >();
   spill<X86Reg::kKindMm >();
+  spill<X86Reg::kKindK  >();
   spill<X86Reg::kKindVec>();
 
   // Alloc.
   alloc<X86Reg::kKindGp >();
   alloc<X86Reg::kKindMm >();
+  alloc<X86Reg::kKindK  >();
   alloc<X86Reg::kKindVec>();
 
   // Unuse clobbered registers that are not used to pass function arguments and
   // save variables used to pass function arguments that will be reused later on.
   save<X86Reg::kKindGp >();
   save<X86Reg::kKindMm >();
+  save<X86Reg::kKindK  >();
   save<X86Reg::kKindVec>();
 
   // Allocate immediates in registers and on the stack.
@@ -3099,6 +3499,7 @@ Error X86CallAlloc::run(CCFuncCall* node) {
   // Duplicate.
   duplicate<X86Reg::kKindGp >();
   duplicate<X86Reg::kKindMm >();
+  duplicate<X86Reg::kKindK  >();
   duplicate<X86Reg::kKindVec>();
 
   // Translate call operand.
@@ -3115,6 +3516,7 @@ Error X86CallAlloc::run(CCFuncCall* node) {
   // Clobber.
   clobber<X86Reg::kKindGp >();
   clobber<X86Reg::kKindMm >();
+  clobber<X86Reg::kKindK  >();
   clobber<X86Reg::kKindVec>();
 
   // Return.
@@ -3123,6 +3525,7 @@ Error X86CallAlloc::run(CCFuncCall* node) {
   // Unuse.
   unuseAfter<X86Reg::kKindGp >();
   unuseAfter<X86Reg::kKindMm >();
+  unuseAfter<X86Reg::kKindK  >();
   unuseAfter<X86Reg::kKindVec>();
 
   // Cleanup; disconnect Vd->Va.
@@ -3341,7 +3744,7 @@ ASMJIT_INLINE void X86CallAlloc::alloc() {
         // allocation tasks by a single 'xchg' instruction, swapping
         // two registers required by the instruction/node or one register
         // required with another non-required.
-        if (C == X86Reg::kKindGp) {
+        if (C == X86Reg::kKindGp && sPhysId != Globals::kInvalidRegId) {
           _context->swapGp(aVReg, bVReg);
 
           aTied->flags |= TiedReg::kRDone;
@@ -3596,6 +3999,11 @@ ASMJIT_INLINE void X86CallAlloc::ret() {
         _context->attach<X86Reg::kKindMm>(vreg, regId, true);
         break;
 
+      case X86Reg::kKindK:
+        _context->unuse<X86Reg::kKindK>(vreg);
+        _context->attach<X86Reg::kKindK>(vreg, regId, true);
+        break;
+
       case X86Reg::kKindVec:
         if (X86Reg::kindOf(ret.getRegType()) == X86Reg::kKindVec) {
           _context->unuse<X86Reg::kKindVec>(vreg);
@@ -3718,6 +4126,43 @@ static Error X86RAPass_patchFuncMem(X86RAPass* self, CCFunc* func, CBNode* stop,
   return kErrorOk;
 }
 
+// ============================================================================
+// [asmjit::X86RAPass - Translate - TailCall]
+// ============================================================================
+
+//! \internal
+//!
+//! Insert an epilog without `ret` before each tail call and remove the code
+//! that follows it up to the next label (the return), which is unreachable.
+static Error X86RAPass_translateTailCalls(X86RAPass* self, CCFunc* func, CBNode* stop, FuncFrameLayout& layout) {
+  X86Compiler* cc = self->cc();
+  CBNode* node = func;
+
+  do {
+    if (node->getType() == CBNode::kNodeFuncCall && static_cast<CCFuncCall*>(node)->getInstId() == X86Inst::kIdJmp) {
+      cc->_setCursor(node->getPrev());
+      ASMJIT_PROPAGATE(X86Internal::emitEpilog(reinterpret_cast<X86Emitter*>(cc), layout, true));
+
+      CBNode* next = node->getNext();
+      while (next != stop) {
+        CBNode* after = next->getNext();
+
+        uint32_t type = next->getType();
+        if (type == CBNode::kNodeInst || type == CBNode::kNodeFuncExit || type == CBNode::kNodeHint)
+          cc->removeNode(next);
+        else if (type != CBNode::kNodeComment)
+          break;
+
+        next = after;
+      }
+    }
+
+    node = node->getNext();
+  } while (node != stop);
+
+  return kErrorOk;
+}
+
 // ============================================================================
 // [asmjit::X86RAPass - Translate - Jump]
 // ============================================================================
@@ -3828,6 +4273,42 @@ _EmitRet:
   return kErrorOk;
 }
 
+// ============================================================================
+// [asmjit::X86RAPass - Translate - Loop]
+// ============================================================================
+
+//! \internal
+//!
+//! Spill variables that are alive across `loop`, but not used by it, before
+//! the loop header if the loop has more live variables than registers (global
+//! allocation only). Otherwise the allocator would spill them in the loop and
+//! reload them at each back-edge.
+template<int C>
+static void X86RAPass_spillBeforeLoop(X86RAPass* self, RALoop* loop, RABits* liveness) {
+  if (!liveness) return;
+
+  uint32_t regCount = Utils::bitCount(self->_gaRegs[C]);
+  if (loop->pressure[C] <= regCount) return;
+
+  uint32_t excess = loop->pressure[C] - regCount;
+  VirtReg** vregs = self->getState()->getListByKind(C);
+  uint32_t occupied = self->getState()->_occupied.get(C);
+
+  while (occupied && excess) {
+    uint32_t physId = Utils::findFirstBit(occupied);
+    VirtReg* vreg = vregs[physId];
+    occupied &= occupied - 1;
+
+    if (!vreg || vreg->isFixed()) continue;
+
+    uint32_t raId = vreg->_raId;
+    if (!liveness->getBit(raId) || loop->used->getBit(raId)) continue;
+
+    self->spill<C>(vreg);
+    excess--;
+  }
+}
+
 // ============================================================================
 // [asmjit::X86RAPass - Translate - Func]
 // ============================================================================
@@ -3902,6 +4383,16 @@ _NextGroup:
         case CBNode::kNodeLabel: {
           CBLabel* node = static_cast<CBLabel*>(node_);
           ASMJIT_ASSERT(node->getPassData<RAData>()->state == nullptr);
+
+          RALoop* loop = node->getPassData<RAData>()->loop;
+          if (loop) {
+            cc->_setCursor(node->getPrev());
+            X86RAPass_spillBeforeLoop<X86Reg::kKindGp >(this, loop, node->getPassData<RAData>()->liveness);
+            X86RAPass_spillBeforeLoop<X86Reg::kKindMm >(this, loop, node->getPassData<RAData>()->liveness);
+            X86RAPass_spillBeforeLoop<X86Reg::kKindK  >(this, loop, node->getPassData<RAData>()->liveness);
+            X86RAPass_spillBeforeLoop<X86Reg::kKindVec>(this, loop, node->getPassData<RAData>()->liveness);
+          }
+
           node->getPassData<RAData>()->state = saveState();
 
           if (node == func->getExitNode())
@@ -4042,6 +4533,7 @@ _Done:
     _varBaseOffset = layout._stackBaseOffset;
 
     ASMJIT_PROPAGATE(X86RAPass_patchFuncMem(this, func, stop, layout));
+    ASMJIT_PROPAGATE(X86RAPass_translateTailCalls(this, func, stop, layout));
 
     cc->_setCursor(func);
     ASMJIT_PROPAGATE(FuncUtils::emitProlog(this->cc(), layout));
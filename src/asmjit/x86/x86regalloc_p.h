@@ -189,8 +189,13 @@ struct X86RAState : RAState {
     //! Count of Mm registers.
     kMmCount = 8,
 
+    //! Base index of K registers.
+    kKIndex = kMmIndex + kMmCount,
+    //! Count of K registers.
+    kKCount = 8,
+
     //! Base index of XMM registers.
-    kXmmIndex = kMmIndex + kMmCount,
+    kXmmIndex = kKIndex + kKCount,
     //! Count of XMM registers.
     kXmmCount = 16,
 
@@ -210,6 +215,7 @@ struct X86RAState : RAState {
     switch (kind) {
       case X86Reg::kKindGp : return _listGp;
       case X86Reg::kKindMm : return _listMm;
+      case X86Reg::kKindK  : return _listK;
       case X86Reg::kKindVec: return _listXmm;
 
       default:
@@ -240,6 +246,8 @@ struct X86RAState : RAState {
       VirtReg* _listGp[kGpCount];
       //! Allocated MMX registers.
       VirtReg* _listMm[kMmCount];
+      //! Allocated K registers.
+      VirtReg* _listK[kKCount];
       //! Allocated XMM registers.
       VirtReg* _listXmm[kXmmCount];
     };
@@ -326,6 +334,7 @@ public:
   Error emitMove(VirtReg* vreg, uint32_t dstId, uint32_t srcId, const char* reason);
   Error emitLoad(VirtReg* vreg, uint32_t id, const char* reason);
   Error emitSave(VirtReg* vreg, uint32_t id, const char* reason);
+  Error emitMaterialize(VirtReg* vreg, uint32_t id, const char* comment);
   Error emitSwapGp(VirtReg* aVReg, VirtReg* bVReg, uint32_t aId, uint32_t bId, const char* reason) noexcept;
 
   Error emitImmToReg(uint32_t dstTypeId, uint32_t dstPhysId, const Imm* src) noexcept;
@@ -651,11 +660,24 @@ public:
 
   virtual Error fetch() override;
 
+  // --------------------------------------------------------------------------
+  // [Coalesce]
+  // --------------------------------------------------------------------------
+
+  virtual bool isCopy(CBNode* node, VirtReg** pDst, VirtReg** pSrc) override;
+
+  // --------------------------------------------------------------------------
+  // [Dead Code]
+  // --------------------------------------------------------------------------
+
+  virtual bool canRemoveDead(CBNode* node, uint32_t* flagsR, uint32_t* flagsW) override;
+
   // --------------------------------------------------------------------------
   // [Annotate]
   // --------------------------------------------------------------------------
 
   virtual Error annotate() override;
+  virtual Error formatInlineComment(StringBuilder& dst, CBNode* node) override;
 
   // --------------------------------------------------------------------------
   // [Translate]
@@ -0,0 +1,821 @@
+// [AsmJit]
+// Complete x86/x64 JIT and Remote Assembler for C++.
+//
+// [License]
+// Zlib - See LICENSE.md file in the package.
+
+// [Export]
+#define ASMJIT_EXPORTS
+
+// [Guard]
+#include "../asmjit_build.h"
+#if defined(ASMJIT_BUILD_X86) && !defined(ASMJIT_DISABLE_BUILDER)
+
+// [Dependencies]
+#include "../base/codecompiler.h"
+#include "../x86/x86inst.h"
+#include "../x86/x86operand.h"
+#include "../x86/x86scheduler.h"
+
+// [Api-Begin]
+#include "../asmjit_apibegin.h"
+
+namespace asmjit {
+
+// ============================================================================
+// [asmjit::X86SchedInfo - Data]
+// ============================================================================
+
+//! \internal
+//!
+//! Scheduling info of a single instruction, the table is sorted by `instId`.
+struct X86SchedEntry {
+  uint16_t instId;                       //!< Instruction id.
+  uint8_t latency;                       //!< Latency in cycles.
+  uint8_t ports;                         //!< Execution ports.
+};
+
+// Latencies and ports roughly follow Skylake, instructions that are not in
+// the table are single-cycle ALU instructions.
+#define SCHED(ID, LATENCY, PORTS) { X86Inst::kId##ID, LATENCY, X86SchedInfo::k##PORTS }
+static const X86SchedEntry x86SchedTable[] = {
+  SCHED(Addpd           , 4 , P01 ),
+  SCHED(Addps           , 4 , P01 ),
+  SCHED(Addsd           , 4 , P01 ),
+  SCHED(Addss           , 4 , P01 ),
+  SCHED(Blendvpd        , 2 , P015),
+  SCHED(Blendvps        , 2 , P015),
+  SCHED(Bsf             , 3 , P1  ),
+  SCHED(Bsr             , 3 , P1  ),
+  SCHED(Cmppd           , 4 , P01 ),
+  SCHED(Cmpps           , 4 , P01 ),
+  SCHED(Cmpss           , 4 , P01 ),
+  SCHED(Crc32           , 3 , P1  ),
+  SCHED(Cvtdq2pd        , 4 , P01 ),
+  SCHED(Cvtdq2ps        , 4 , P01 ),
+  SCHED(Cvtpd2dq        , 4 , P01 ),
+  SCHED(Cvtpd2ps        , 4 , P01 ),
+  SCHED(Cvtps2dq        , 4 , P01 ),
+  SCHED(Cvtps2pd        , 4 , P01 ),
+  SCHED(Cvtsd2ss        , 4 , P01 ),
+  SCHED(Cvtss2sd        , 4 , P01 ),
+  SCHED(Cvttpd2dq       , 4 , P01 ),
+  SCHED(Cvttps2dq       , 4 , P01 ),
+  SCHED(Divpd           , 14, P0  ),
+  SCHED(Divps           , 11, P0  ),
+  SCHED(Divsd           , 14, P0  ),
+  SCHED(Divss           , 11, P0  ),
+  SCHED(Dppd            , 9 , P01 ),
+  SCHED(Dpps            , 13, P01 ),
+  SCHED(Haddpd          , 6 , P015),
+  SCHED(Haddps          , 6 , P015),
+  SCHED(Hsubpd          , 6 , P015),
+  SCHED(Hsubps          , 6 , P015),
+  SCHED(Imul            , 3 , P1  ),
+  SCHED(Insertps        , 1 , P5  ),
+  SCHED(Lzcnt           , 3 , P1  ),
+  SCHED(Maxpd           , 4 , P01 ),
+  SCHED(Maxps           , 4 , P01 ),
+  SCHED(Maxsd           , 4 , P01 ),
+  SCHED(Maxss           , 4 , P01 ),
+  SCHED(Minpd           , 4 , P01 ),
+  SCHED(Minps           , 4 , P01 ),
+  SCHED(Minsd           , 4 , P01 ),
+  SCHED(Minss           , 4 , P01 ),
+  SCHED(Movhlps         , 1 , P5  ),
+  SCHED(Movlhps         , 1 , P5  ),
+  SCHED(Mpsadbw         , 3 , P5  ),
+  SCHED(Mulpd           , 4 , P01 ),
+  SCHED(Mulps           , 4 , P01 ),
+  SCHED(Mulsd           , 4 , P01 ),
+  SCHED(Mulss           , 4 , P01 ),
+  SCHED(Mulx            , 4 , P15 ),
+  SCHED(Packssdw        , 1 , P5  ),
+  SCHED(Packsswb        , 1 , P5  ),
+  SCHED(Packusdw        , 1 , P5  ),
+  SCHED(Packuswb        , 1 , P5  ),
+  SCHED(Palignr         , 1 , P5  ),
+  SCHED(Pblendvb        , 2 , P015),
+  SCHED(Pclmulqdq       , 7 , P5  ),
+  SCHED(Pdep            , 3 , P1  ),
+  SCHED(Pext            , 3 , P1  ),
+  SCHED(Phaddd          , 6 , P015),
+  SCHED(Phaddw          , 6 , P015),
+  SCHED(Phsubd          , 6 , P015),
+  SCHED(Phsubw          , 6 , P015),
+  SCHED(Pmaddubsw       , 5 , P01 ),
+  SCHED(Pmaddwd         , 5 , P01 ),
+  SCHED(Pmovsxbw        , 1 , P5  ),
+  SCHED(Pmovsxdq        , 1 , P5  ),
+  SCHED(Pmovsxwd        , 1 , P5  ),
+  SCHED(Pmovzxbw        , 1 , P5  ),
+  SCHED(Pmovzxdq        , 1 , P5  ),
+  SCHED(Pmovzxwd        , 1 , P5  ),
+  SCHED(Pmuldq          , 5 , P01 ),
+  SCHED(Pmulhrsw        , 5 , P01 ),
+  SCHED(Pmulhuw         , 5 , P01 ),
+  SCHED(Pmulhw          , 5 , P01 ),
+  SCHED(Pmulld          , 10, P01 ),
+  SCHED(Pmullw          , 5 , P01 ),
+  SCHED(Pmuludq         , 5 , P01 ),
+  SCHED(Popcnt          , 3 , P1  ),
+  SCHED(Psadbw          , 3 , P5  ),
+  SCHED(Pshufb          , 1 , P5  ),
+  SCHED(Pshufd          , 1 , P5  ),
+  SCHED(Pshufhw         , 1 , P5  ),
+  SCHED(Pshuflw         , 1 , P5  ),
+  SCHED(Pslldq          , 1 , P5  ),
+  SCHED(Psrldq          , 1 , P5  ),
+  SCHED(Ptest           , 3 , P05 ),
+  SCHED(Punpckhbw       , 1 , P5  ),
+  SCHED(Punpckhdq       , 1 , P5  ),
+  SCHED(Punpckhqdq      , 1 , P5  ),
+  SCHED(Punpckhwd       , 1 , P5  ),
+  SCHED(Punpcklbw       , 1 , P5  ),
+  SCHED(Punpckldq       , 1 , P5  ),
+  SCHED(Punpcklqdq      , 1 , P5  ),
+  SCHED(Punpcklwd       , 1 , P5  ),
+  SCHED(Rcpps           , 4 , P01 ),
+  SCHED(Rcpss           , 4 , P01 ),
+  SCHED(Roundpd         , 8 , P01 ),
+  SCHED(Roundps         , 8 , P01 ),
+  SCHED(Roundsd         , 8 , P01 ),
+  SCHED(Roundss         , 8 , P01 ),
+  SCHED(Rsqrtps         , 4 , P01 ),
+  SCHED(Rsqrtss         , 4 , P01 ),
+  SCHED(Shufpd          , 1 , P5  ),
+  SCHED(Shufps          , 1 , P5  ),
+  SCHED(Sqrtpd          , 18, P0  ),
+  SCHED(Sqrtps          , 12, P0  ),
+  SCHED(Sqrtsd          , 18, P0  ),
+  SCHED(Sqrtss          , 12, P0  ),
+  SCHED(Subpd           , 4 , P01 ),
+  SCHED(Subps           , 4 , P01 ),
+  SCHED(Subsd           , 4 , P01 ),
+  SCHED(Subss           , 4 , P01 ),
+  SCHED(Tzcnt           , 3 , P1  ),
+  SCHED(Unpckhpd        , 1 , P5  ),
+  SCHED(Unpckhps        , 1 , P5  ),
+  SCHED(Unpcklpd        , 1 , P5  ),
+  SCHED(Unpcklps        , 1 , P5  ),
+  SCHED(Vaddpd          , 4 , P01 ),
+  SCHED(Vaddps          , 4 , P01 ),
+  SCHED(Vaddsd          , 4 , P01 ),
+  SCHED(Vaddss          , 4 , P01 ),
+  SCHED(Vblendvpd       , 2 , P015),
+  SCHED(Vblendvps       , 2 , P015),
+  SCHED(Vbroadcastsd    , 3 , P5  ),
+  SCHED(Vbroadcastss    , 3 , P5  ),
+  SCHED(Vcmppd          , 4 , P01 ),
+  SCHED(Vcmpps          , 4 , P01 ),
+  SCHED(Vcmpss          , 4 , P01 ),
+  SCHED(Vcvtdq2pd       , 4 , P01 ),
+  SCHED(Vcvtdq2ps       , 4 , P01 ),
+  SCHED(Vcvtpd2dq       , 4 , P01 ),
+  SCHED(Vcvtpd2ps       , 4 , P01 ),
+  SCHED(Vcvtps2dq       , 4 , P01 ),
+  SCHED(Vcvtps2pd       , 4 , P01 ),
+  SCHED(Vcvtsd2ss       , 4 , P01 ),
+  SCHED(Vcvtss2sd       , 4 , P01 ),
+  SCHED(Vcvttpd2dq      , 4 , P01 ),
+  SCHED(Vcvttps2dq      , 4 , P01 ),
+  SCHED(Vdivpd          , 14, P0  ),
+  SCHED(Vdivps          , 11, P0  ),
+  SCHED(Vdivsd          , 14, P0  ),
+  SCHED(Vdivss          , 11, P0  ),
+  SCHED(Vdppd           , 9 , P01 ),
+  SCHED(Vdpps           , 13, P01 ),
+  SCHED(Vextractf128    , 3 , P5  ),
+  SCHED(Vextracti128    , 3 , P5  ),
+  SCHED(Vfmadd132pd     , 4 , P01 ),
+  SCHED(Vfmadd132ps     , 4 , P01 ),
+  SCHED(Vfmadd132sd     , 4 , P01 ),
+  SCHED(Vfmadd132ss     , 4 , P01 ),
+  SCHED(Vfmadd213pd     , 4 , P01 ),
+  SCHED(Vfmadd213ps     , 4 , P01 ),
+  SCHED(Vfmadd213sd     , 4 , P01 ),
+  SCHED(Vfmadd213ss     , 4 , P01 ),
+  SCHED(Vfmadd231pd     , 4 , P01 ),
+  SCHED(Vfmadd231ps     , 4 , P01 ),
+  SCHED(Vfmadd231sd     , 4 , P01 ),
+  SCHED(Vfmadd231ss     , 4 , P01 ),
+  SCHED(Vfmsub132pd     , 4 , P01 ),
+  SCHED(Vfmsub132ps     , 4 , P01 ),
+  SCHED(Vfmsub132sd     , 4 , P01 ),
+  SCHED(Vfmsub132ss     , 4 , P01 ),
+  SCHED(Vfmsub213pd     , 4 , P01 ),
+  SCHED(Vfmsub213ps     , 4 , P01 ),
+  SCHED(Vfmsub213sd     , 4 , P01 ),
+  SCHED(Vfmsub213ss     , 4 , P01 ),
+  SCHED(Vfmsub231pd     , 4 , P01 ),
+  SCHED(Vfmsub231ps     , 4 , P01 ),
+  SCHED(Vfmsub231sd     , 4 , P01 ),
+  SCHED(Vfmsub231ss     , 4 , P01 ),
+  SCHED(Vfnmadd132pd    , 4 , P01 ),
+  SCHED(Vfnmadd132ps    , 4 , P01 ),
+  SCHED(Vfnmadd132sd    , 4 , P01 ),
+  SCHED(Vfnmadd132ss    , 4 , P01 ),
+  SCHED(Vfnmadd213pd    , 4 , P01 ),
+  SCHED(Vfnmadd213ps    , 4 , P01 ),
+  SCHED(Vfnmadd213sd    , 4 , P01 ),
+  SCHED(Vfnmadd213ss    , 4 , P01 ),
+  SCHED(Vfnmadd231pd    , 4 , P01 ),
+  SCHED(Vfnmadd231ps    , 4 , P01 ),
+  SCHED(Vfnmadd231sd    , 4 , P01 ),
+  SCHED(Vfnmadd231ss    , 4 , P01 ),
+  SCHED(Vfnmsub132pd    , 4 , P01 ),
+  SCHED(Vfnmsub132ps    , 4 , P01 ),
+  SCHED(Vfnmsub132sd    , 4 , P01 ),
+  SCHED(Vfnmsub132ss    , 4 , P01 ),
+  SCHED(Vfnmsub213pd    , 4 , P01 ),
+  SCHED(Vfnmsub213ps    , 4 , P01 ),
+  SCHED(Vfnmsub213sd    , 4 , P01 ),
+  SCHED(Vfnmsub213ss    , 4 , P01 ),
+  SCHED(Vfnmsub231pd    , 4 , P01 ),
+  SCHED(Vfnmsub231ps    , 4 , P01 ),
+  SCHED(Vfnmsub231sd    , 4 , P01 ),
+  SCHED(Vfnmsub231ss    , 4 , P01 ),
+  SCHED(Vhaddpd         , 6 , P015),
+  SCHED(Vhaddps         , 6 , P015),
+  SCHED(Vhsubpd         , 6 , P015),
+  SCHED(Vhsubps         , 6 , P015),
+  SCHED(Vinsertf128     , 3 , P5  ),
+  SCHED(Vinserti128     , 3 , P5  ),
+  SCHED(Vinsertps       , 1 , P5  ),
+  SCHED(Vmaxpd          , 4 , P01 ),
+  SCHED(Vmaxps          , 4 , P01 ),
+  SCHED(Vmaxsd          , 4 , P01 ),
+  SCHED(Vmaxss          , 4 , P01 ),
+  SCHED(Vminpd          , 4 , P01 ),
+  SCHED(Vminps          , 4 , P01 ),
+  SCHED(Vminsd          , 4 , P01 ),
+  SCHED(Vminss          , 4 , P01 ),
+  SCHED(Vmovhlps        , 1 , P5  ),
+  SCHED(Vmovlhps        , 1 , P5  ),
+  SCHED(Vmpsadbw        , 3 , P5  ),
+  SCHED(Vmulpd          , 4 , P01 ),
+  SCHED(Vmulps          , 4 , P01 ),
+  SCHED(Vmulsd          , 4 , P01 ),
+  SCHED(Vmulss          , 4 , P01 ),
+  SCHED(Vpackssdw       , 1 , P5  ),
+  SCHED(Vpacksswb       , 1 , P5  ),
+  SCHED(Vpackusdw       , 1 , P5  ),
+  SCHED(Vpackuswb       , 1 , P5  ),
+  SCHED(Vpalignr        , 1 , P5  ),
+  SCHED(Vpblendvb       , 2 , P015),
+  SCHED(Vpbroadcastb    , 3 , P5  ),
+  SCHED(Vpbroadcastd    , 3 , P5  ),
+  SCHED(Vpbroadcastq    , 3 , P5  ),
+  SCHED(Vpbroadcastw    , 3 , P5  ),
+  SCHED(Vpclmulqdq      , 7 , P5  ),
+  SCHED(Vperm2f128      , 3 , P5  ),
+  SCHED(Vperm2i128      , 3 , P5  ),
+  SCHED(Vpermd          , 3 , P5  ),
+  SCHED(Vpermilpd       , 1 , P5  ),
+  SCHED(Vpermilps       , 1 , P5  ),
+  SCHED(Vpermpd         , 3 , P5  ),
+  SCHED(Vpermps         , 3 , P5  ),
+  SCHED(Vpermq          , 3 , P5  ),
+  SCHED(Vphaddd         , 6 , P015),
+  SCHED(Vphaddw         , 6 , P015),
+  SCHED(Vphsubd         , 6 , P015),
+  SCHED(Vphsubw         , 6 , P015),
+  SCHED(Vpmaddubsw      , 5 , P01 ),
+  SCHED(Vpmaddwd        , 5 , P01 ),
+  SCHED(Vpmovsxbw       , 1 , P5  ),
+  SCHED(Vpmovsxdq       , 1 , P5  ),
+  SCHED(Vpmovsxwd       , 1 , P5  ),
+  SCHED(Vpmovzxbw       , 1 , P5  ),
+  SCHED(Vpmovzxdq       , 1 , P5  ),
+  SCHED(Vpmovzxwd       , 1 , P5  ),
+  SCHED(Vpmuldq         , 5 , P01 ),
+  SCHED(Vpmulhrsw       , 5 , P01 ),
+  SCHED(Vpmulhuw        , 5 , P01 ),
+  SCHED(Vpmulhw         , 5 , P01 ),
+  SCHED(Vpmulld         , 10, P01 ),
+  SCHED(Vpmullw         , 5 , P01 ),
+  SCHED(Vpmuludq        , 5 , P01 ),
+  SCHED(Vpsadbw         , 3 , P5  ),
+  SCHED(Vpshufb         , 1 , P5  ),
+  SCHED(Vpshufd         , 1 , P5  ),
+  SCHED(Vpshufhw        , 1 , P5  ),
+  SCHED(Vpshuflw        , 1 , P5  ),
+  SCHED(Vpslldq         , 1 , P5  ),
+  SCHED(Vpsrldq         , 1 , P5  ),
+  SCHED(Vptest          , 3 , P05 ),
+  SCHED(Vpunpckhbw      , 1 , P5  ),
+  SCHED(Vpunpckhdq      , 1 , P5  ),
+  SCHED(Vpunpckhqdq     , 1 , P5  ),
+  SCHED(Vpunpckhwd      , 1 , P5  ),
+  SCHED(Vpunpcklbw      , 1 , P5  ),
+  SCHED(Vpunpckldq      , 1 , P5  ),
+  SCHED(Vpunpcklqdq     , 1 , P5  ),
+  SCHED(Vpunpcklwd      , 1 , P5  ),
+  SCHED(Vrcpps          , 4 , P01 ),
+  SCHED(Vrcpss          , 4 , P01 ),
+  SCHED(Vroundpd        , 8 , P01 ),
+  SCHED(Vroundps        , 8 , P01 ),
+  SCHED(Vroundsd        , 8 , P01 ),
+  SCHED(Vroundss        , 8 , P01 ),
+  SCHED(Vrsqrtps        , 4 , P01 ),
+  SCHED(Vrsqrtss        , 4 , P01 ),
+  SCHED(Vshufpd         , 1 , P5  ),
+  SCHED(Vshufps         , 1 , P5  ),
+  SCHED(Vsqrtpd         , 18, P0  ),
+  SCHED(Vsqrtps         , 12, P0  ),
+  SCHED(Vsqrtsd         , 18, P0  ),
+  SCHED(Vsqrtss         , 12, P0  ),
+  SCHED(Vsubpd          , 4 , P01 ),
+  SCHED(Vsubps          , 4 , P01 ),
+  SCHED(Vsubsd          , 4 , P01 ),
+  SCHED(Vsubss          , 4 , P01 ),
+  SCHED(Vunpckhpd       , 1 , P5  ),
+  SCHED(Vunpckhps       , 1 , P5  ),
+  SCHED(Vunpcklpd       , 1 , P5  ),
+  SCHED(Vunpcklps       , 1 , P5  )
+};
+#undef SCHED
+
+// ============================================================================
+// [asmjit::X86SchedInfo - Get]
+// ============================================================================
+
+X86SchedInfo X86SchedInfo::get(uint32_t instId) noexcept {
+  size_t lo = 0;
+  size_t hi = ASMJIT_ARRAY_SIZE(x86SchedTable);
+
+  while (lo < hi) {
+    size_t mid = (lo + hi) / 2;
+    const X86SchedEntry& entry = x86SchedTable[mid];
+
+    if (entry.instId == instId) {
+      X86SchedInfo info = { entry.latency, entry.ports };
+      return info;
+    }
+
+    if (entry.instId < instId)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+
+  const X86Inst::CommonData& commonData = X86Inst::getInst(instId).getCommonData();
+  X86SchedInfo info = { 1, static_cast<uint8_t>(commonData.hasFlag(X86Inst::kFlagVec) ? kP015 : kP0156) };
+  return info;
+}
+
+// ============================================================================
+// [asmjit::X86SchedulerPass - Helpers]
+// ============================================================================
+
+//! \internal
+//!
+//! Instruction of a region and its scheduling state.
+struct X86SchedNode {
+  enum Flags {
+    kFlagMemR   = 0x01U,                 //!< Reads memory.
+    kFlagMemW   = 0x02U,                 //!< Writes memory.
+    kFlagFlagsR = 0x04U,                 //!< Reads arithmetic flags.
+    kFlagFlagsW = 0x08U,                 //!< Writes arithmetic flags.
+    kFlagDone   = 0x10U                  //!< Already scheduled.
+  };
+
+  enum {
+    kMaxRegR = 8,                        //!< Maximum count of read registers.
+    kMaxRegW = 2                         //!< Maximum count of written registers.
+  };
+
+  CBInst* node;                          //!< Instruction.
+  uint32_t flags;                        //!< Flags, see \ref Flags.
+  uint32_t latency;                      //!< Latency in cycles.
+  uint32_t ports;                        //!< Execution ports.
+
+  uint32_t height;                       //!< Length of the longest path to the end of the region.
+  uint32_t ready;                        //!< The earliest cycle the instruction can issue.
+  uint32_t predCount;                    //!< Count of predecessors not scheduled yet.
+  uint32_t useCount;                     //!< Count of readers of the result not scheduled yet.
+
+  uint32_t regRCount;                    //!< Count of read registers.
+  uint32_t regWCount;                    //!< Count of written registers.
+  uint32_t regR[kMaxRegR];               //!< Read virtual registers.
+  uint32_t regW[kMaxRegW];               //!< Written virtual registers.
+};
+
+// Dependency of two nodes, zero means no dependency.
+enum {
+  kX86SchedDepLatencyMask = 0x7F,        // Latency of the dependency plus one.
+  kX86SchedDepData        = 0x80         // The successor reads a register written by the predecessor.
+};
+
+static const uint32_t X86Scheduler_kArithFlags =
+  x86::kSpecialReg_FLAGS_CF | x86::kSpecialReg_FLAGS_PF |
+  x86::kSpecialReg_FLAGS_AF | x86::kSpecialReg_FLAGS_ZF |
+  x86::kSpecialReg_FLAGS_SF | x86::kSpecialReg_FLAGS_OF;
+
+static ASMJIT_INLINE bool X86Scheduler_hasReg(const uint32_t* regs, uint32_t count, uint32_t id) noexcept {
+  for (uint32_t i = 0; i < count; i++)
+    if (regs[i] == id) return true;
+  return false;
+}
+
+static ASMJIT_INLINE bool X86Scheduler_intersects(const uint32_t* a, uint32_t aCount, const uint32_t* b, uint32_t bCount) noexcept {
+  for (uint32_t i = 0; i < aCount; i++)
+    if (X86Scheduler_hasReg(b, bCount, a[i])) return true;
+  return false;
+}
+
+static ASMJIT_INLINE bool X86Scheduler_isVirtReg(CodeCompiler* cc, uint32_t id) noexcept {
+  return cc && cc->isVirtRegValid(id) && !cc->getVirtRegById(id)->isFixed();
+}
+
+static ASMJIT_INLINE bool X86Scheduler_addReg(uint32_t* regs, uint32_t& count, uint32_t max, uint32_t id) noexcept {
+  if (X86Scheduler_hasReg(regs, count, id))
+    return true;
+
+  if (count >= max)
+    return false;
+
+  regs[count++] = id;
+  return true;
+}
+
+//! \internal
+//!
+//! Fill `sn` from `node`, returns false if the node can't be moved.
+static bool X86Scheduler_analyze(CodeCompiler* cc, CBNode* node_, X86SchedNode* sn) noexcept {
+  if (node_->getType() != CBNode::kNodeInst || node_->isJmpOrJcc() || node_->isSpecial() || node_->isFp())
+    return false;
+
+  CBInst* node = static_cast<CBInst*>(node_);
+  uint32_t instId = node->getInstId();
+  uint32_t opCount = node->getOpCount();
+  const Operand* opArray = node->getOpArray();
+
+  if (!opCount || node->hasExtraReg() ||
+      (node->getOptions() & (X86Inst::kOptionLock | X86Inst::kOptionRep | X86Inst::kOptionRepnz)))
+    return false;
+
+  const X86Inst& inst = X86Inst::getInst(instId);
+  const X86Inst::CommonData& commonData = inst.getCommonData();
+  const X86Inst::OperationData& operationData = inst.getOperationData();
+
+  // Only the single operand IMUL uses fixed registers.
+  bool isImul = instId == X86Inst::kIdImul && opCount >= 2;
+  uint32_t use0 = commonData.getFlags() & X86Inst::kFlagUseX;
+
+  if (isImul)
+    use0 = opCount == 2 ? uint32_t(X86Inst::kFlagUseX) : uint32_t(X86Inst::kFlagUseW);
+  else if (commonData.hasFlag(X86Inst::kFlagUseA | X86Inst::kFlagFixedRM | X86Inst::kFlagFpu | X86Inst::kFlagVsib))
+    return false;
+
+  if (!use0)
+    use0 = X86Inst::kFlagUseX;
+
+  uint32_t specialR = operationData.getSpecialRegsR();
+  uint32_t specialW = operationData.getSpecialRegsW();
+
+  if (commonData.doesJump() ||
+      operationData.hasOperationFlag(X86Inst::kOperationPrefetch | X86Inst::kOperationBarrier | X86Inst::kOperationVolatile | X86Inst::kOperationPrivileged) ||
+      ((specialR | specialW) & ~X86Scheduler_kArithFlags))
+    return false;
+
+  sn->node = node;
+  sn->flags = 0;
+  sn->regRCount = 0;
+  sn->regWCount = 0;
+
+  if (specialR) sn->flags |= X86SchedNode::kFlagFlagsR;
+  if (specialW) sn->flags |= X86SchedNode::kFlagFlagsW;
+
+  for (uint32_t i = 0; i < opCount; i++) {
+    const Operand& op = opArray[i];
+
+    bool isR = true;
+    bool isW = false;
+
+    if (i == 0) {
+      isR = (use0 & X86Inst::kFlagUseR) != 0;
+      isW = (use0 & X86Inst::kFlagUseW) != 0;
+    }
+    else if (i == 1 && commonData.hasFlag(X86Inst::kFlagUseXX)) {
+      isW = true;
+    }
+
+    if (op.isReg()) {
+      uint32_t id = op.getId();
+      if (!X86Scheduler_isVirtReg(cc, id))
+        return false;
+
+      if (isR && !X86Scheduler_addReg(sn->regR, sn->regRCount, X86SchedNode::kMaxRegR, id)) return false;
+      if (isW && !X86Scheduler_addReg(sn->regW, sn->regWCount, X86SchedNode::kMaxRegW, id)) return false;
+    }
+    else if (op.isMem()) {
+      const X86Mem& m = op.as<X86Mem>();
+
+      // Home slots of virtual registers are managed by the register allocator.
+      if (m.isRegHome())
+        return false;
+
+      if (m.hasBaseReg() && (!X86Scheduler_isVirtReg(cc, m.getBaseId()) ||
+          !X86Scheduler_addReg(sn->regR, sn->regRCount, X86SchedNode::kMaxRegR, m.getBaseId())))
+        return false;
+
+      if (m.hasIndexReg() && (!X86Scheduler_isVirtReg(cc, m.getIndexId()) ||
+          !X86Scheduler_addReg(sn->regR, sn->regRCount, X86SchedNode::kMaxRegR, m.getIndexId())))
+        return false;
+
+      // LEA doesn't access memory.
+      if (instId != X86Inst::kIdLea) {
+        if (isR) sn->flags |= X86SchedNode::kFlagMemR;
+        if (isW) sn->flags |= X86SchedNode::kFlagMemW;
+      }
+    }
+  }
+
+  X86SchedInfo info = X86SchedInfo::get(instId);
+  sn->latency = info.latency;
+  sn->ports = info.ports;
+
+  if (sn->flags & X86SchedNode::kFlagMemR)
+    sn->latency += X86SchedInfo::kLoadLatency;
+
+  if (sn->flags & X86SchedNode::kFlagMemW)
+    sn->ports = X86SchedInfo::kP4;
+
+  return true;
+}
+
+//! \internal
+//!
+//! Get the dependency of `b` on `a` (`a` precedes `b` in the original order).
+static uint32_t X86Scheduler_getDep(const X86SchedNode* a, const X86SchedNode* b, bool orderFlags, bool isLastFlagsW) noexcept {
+  uint32_t latency = 0;
+  uint32_t data = 0;
+  bool dep = false;
+
+  // Read after write.
+  if (X86Scheduler_intersects(a->regW, a->regWCount, b->regR, b->regRCount)) {
+    latency = a->latency;
+    data = kX86SchedDepData;
+    dep = true;
+  }
+
+  // Write after read and write after write.
+  if (X86Scheduler_intersects(a->regR, a->regRCount, b->regW, b->regWCount) ||
+      X86Scheduler_intersects(a->regW, a->regWCount, b->regW, b->regWCount))
+    dep = true;
+
+  // Flags. If no instruction of the region reads them, only the last writer
+  // matters as flags may be live after the region.
+  uint32_t af = a->flags;
+  uint32_t bf = b->flags;
+
+  if (orderFlags) {
+    if ((af & X86SchedNode::kFlagFlagsW) && (bf & X86SchedNode::kFlagFlagsR)) {
+      latency = std::max<uint32_t>(latency, a->latency);
+      dep = true;
+    }
+
+    if ((bf & X86SchedNode::kFlagFlagsW) && (af & (X86SchedNode::kFlagFlagsR | X86SchedNode::kFlagFlagsW)))
+      dep = true;
+  }
+  else if (isLastFlagsW && (af & X86SchedNode::kFlagFlagsW)) {
+    dep = true;
+  }
+
+  // Memory, stores are ordered with all other memory accesses.
+  if ((af & X86SchedNode::kFlagMemW) && (bf & X86SchedNode::kFlagMemR)) {
+    latency = std::max<uint32_t>(latency, 1);
+    dep = true;
+  }
+
+  if ((bf & X86SchedNode::kFlagMemW) && (af & (X86SchedNode::kFlagMemR | X86SchedNode::kFlagMemW)))
+    dep = true;
+
+  return dep ? (latency + 1) | data : 0;
+}
+
+// ============================================================================
+// [asmjit::X86SchedulerPass - Construction / Destruction]
+// ============================================================================
+
+X86SchedulerPass::X86SchedulerPass() noexcept
+  : CBPass("Scheduler"),
+    _maxPressure(kDefaultMaxPressure),
+    _regionCount(0),
+    _movedCount(0) {}
+X86SchedulerPass::~X86SchedulerPass() noexcept {}
+
+// ============================================================================
+// [asmjit::X86SchedulerPass - Process]
+// ============================================================================
+
+Error X86SchedulerPass::process(Zone* zone) noexcept {
+  CodeBuilder* cb = _cb;
+  CodeCompiler* cc = cb->isCodeCompiler() ? static_cast<CodeCompiler*>(cb) : nullptr;
+
+  _regionCount = 0;
+  _movedCount = 0;
+
+  // Without virtual registers there is nothing to schedule.
+  if (!cc)
+    return kErrorOk;
+
+  const uint32_t kMax = kMaxRegionSize;
+  X86SchedNode* nodes = zone->allocT<X86SchedNode>(kMax * sizeof(X86SchedNode));
+  uint8_t* deps = zone->allocT<uint8_t>(kMax * kMax);
+  uint32_t* order = zone->allocT<uint32_t>(kMax * sizeof(uint32_t));
+
+  if (ASMJIT_UNLIKELY(!nodes || !deps || !order))
+    return DebugUtils::errored(kErrorNoHeapMemory);
+
+  CBNode* node = cb->getFirstNode();
+  while (node) {
+    // Collect a region.
+    uint32_t n = 0;
+    CBNode* next = node;
+
+    while (next && n < kMax && X86Scheduler_analyze(cc, next, &nodes[n])) {
+      next = next->getNext();
+      n++;
+    }
+
+    if (n < 2) {
+      node = next == node ? node->getNext() : next;
+      continue;
+    }
+
+    // Dependencies, node heights, and counters.
+    uint32_t i, j;
+    bool orderFlags = false;
+    uint32_t lastFlagsW = kInvalidValue;
+
+    for (i = 0; i < n; i++) {
+      if (nodes[i].flags & X86SchedNode::kFlagFlagsR) orderFlags = true;
+      if (nodes[i].flags & X86SchedNode::kFlagFlagsW) lastFlagsW = i;
+
+      nodes[i].ready = 0;
+      nodes[i].predCount = 0;
+      nodes[i].useCount = 0;
+    }
+
+    for (j = 0; j < n; j++) {
+      for (i = 0; i < j; i++) {
+        uint32_t dep = X86Scheduler_getDep(&nodes[i], &nodes[j], orderFlags, j == lastFlagsW);
+        deps[i * kMax + j] = static_cast<uint8_t>(dep);
+
+        if (dep) {
+          nodes[j].predCount++;
+          if (dep & kX86SchedDepData)
+            nodes[i].useCount++;
+        }
+      }
+    }
+
+    i = n;
+    while (i) {
+      X86SchedNode* sn = &nodes[--i];
+      uint32_t height = sn->latency;
+
+      for (j = i + 1; j < n; j++) {
+        uint32_t dep = deps[i * kMax + j];
+        if (dep)
+          height = std::max<uint32_t>(height, (dep & kX86SchedDepLatencyMask) - 1 + nodes[j].height);
+      }
+      sn->height = height;
+    }
+
+    // List scheduling.
+    uint32_t count = 0;
+    uint32_t cycle = 0;
+    uint32_t pressure = 0;
+
+    while (count < n) {
+      uint32_t portsUsed = 0;
+
+      for (uint32_t issued = 0; issued < kIssueWidth; issued++) {
+        uint32_t best = kInvalidValue;
+        uint32_t bestKey = 0;
+        int bestDelta = 0;
+
+        for (j = 0; j < n; j++) {
+          X86SchedNode* sn = &nodes[j];
+          if ((sn->flags & X86SchedNode::kFlagDone) || sn->predCount || sn->ready > cycle || !(sn->ports & ~portsUsed))
+            continue;
+
+          // Change of the count of live values defined by the region.
+          int delta = sn->useCount != 0;
+          for (i = 0; i < j; i++)
+            if ((deps[i * kMax + j] & kX86SchedDepData) && nodes[i].useCount == 1)
+              delta--;
+
+          // Higher is better, when at the pressure limit instructions that
+          // don't increase it are preferred over the critical path.
+          uint32_t key = sn->height;
+          if (pressure < _maxPressure || delta <= 0)
+            key += 0x10000U;
+
+          if (best == kInvalidValue || key > bestKey) {
+            best = j;
+            bestKey = key;
+            bestDelta = delta;
+          }
+        }
+
+        if (best == kInvalidValue)
+          break;
+
+        X86SchedNode* sn = &nodes[best];
+        uint32_t freePorts = sn->ports & ~portsUsed;
+
+        sn->flags |= X86SchedNode::kFlagDone;
+        portsUsed |= freePorts & (0U - freePorts);
+        pressure = static_cast<uint32_t>(static_cast<int>(pressure) + bestDelta);
+        order[count++] = best;
+
+        for (i = 0; i < best; i++)
+          if (deps[i * kMax + best] & kX86SchedDepData)
+            nodes[i].useCount--;
+
+        for (j = best + 1; j < n; j++) {
+          uint32_t dep = deps[best * kMax + j];
+          if (!dep) continue;
+
+          nodes[j].predCount--;
+          nodes[j].ready = std::max<uint32_t>(nodes[j].ready, cycle + (dep & kX86SchedDepLatencyMask) - 1);
+        }
+      }
+
+      cycle++;
+    }
+
+    // Relink the region in the new order.
+    uint32_t moved = 0;
+    for (i = 0; i < n; i++)
+      moved += order[i] != i;
+
+    if (moved) {
+      CBNode* prev = node->getPrev();
+      CBNode* cursor = cb->getCursor();
+      bool cursorInRegion = false;
+
+      for (i = 0; i < n; i++) {
+        CBNode* cur = nodes[order[i]].node;
+        if (cur == cursor) cursorInRegion = true;
+
+        cur->_prev = prev;
+        if (prev)
+          prev->_next = cur;
+        else
+          cb->_firstNode = cur;
+        prev = cur;
+      }
+
+      prev->_next = next;
+      if (next)
+        next->_prev = prev;
+      else
+        cb->_lastNode = prev;
+
+      if (cursorInRegion)
+        cb->_setCursor(prev);
+    }
+
+    _regionCount++;
+    _movedCount += moved;
+    node = next;
+  }
+
+  return kErrorOk;
+}
+
+// ============================================================================
+// [asmjit::X86SchedulerPass - Test]
+// ============================================================================
+
+#if defined(ASMJIT_TEST)
+UNIT(x86_scheduler_table) {
+  INFO("Checking whether the scheduling table is sorted by instruction id");
+  for (size_t i = 1; i < ASMJIT_ARRAY_SIZE(x86SchedTable); i++)
+    EXPECT(x86SchedTable[i - 1].instId < x86SchedTable[i].instId,
+      "Entry #%u is not sorted", static_cast<unsigned int>(i));
+
+  INFO("Checking X86SchedInfo::get()");
+  X86SchedInfo info = X86SchedInfo::get(X86Inst::kIdVfmadd231ps);
+  EXPECT(info.latency == 4 && info.ports == X86SchedInfo::kP01);
+
+  info = X86SchedInfo::get(X86Inst::kIdAdd);
+  EXPECT(info.latency == 1 && info.ports == X86SchedInfo::kP0156);
+
+  info = X86SchedInfo::get(X86Inst::kIdPaddd);
+  EXPECT(info.latency == 1 && info.ports == X86SchedInfo::kP015);
+}
+#endif // ASMJIT_TEST
+
+} // asmjit namespace
+
+// [Api-End]
+#include "../asmjit_apiend.h"
+
+// [Guard]
+#endif // ASMJIT_BUILD_X86 && !ASMJIT_DISABLE_BUILDER
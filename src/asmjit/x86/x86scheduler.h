@@ -0,0 +1,149 @@
+// [AsmJit]
+// Complete x86/x64 JIT and Remote Assembler for C++.
+//
+// [License]
+// Zlib - See LICENSE.md file in the package.
+
+// [Guard]
+#ifndef _ASMJIT_X86_X86SCHEDULER_H
+#define _ASMJIT_X86_X86SCHEDULER_H
+
+#include "../asmjit_build.h"
+#if !defined(ASMJIT_DISABLE_BUILDER)
+
+// [Dependencies]
+#include "../base/codebuilder.h"
+
+// [Api-Begin]
+#include "../asmjit_apibegin.h"
+
+namespace asmjit {
+
+//! \addtogroup asmjit_x86
+//! \{
+
+// ============================================================================
+// [asmjit::X86SchedInfo]
+// ============================================================================
+
+//! Latency and execution ports of an instruction, see \ref X86SchedulerPass.
+struct X86SchedInfo {
+  //! Execution ports (a Skylake-like core).
+  ASMJIT_ENUM(Ports) {
+    kP0    = 0x01U,                      //!< Port 0 (ALU, FP mul/FMA, divider).
+    kP1    = 0x02U,                      //!< Port 1 (ALU, FP add/mul/FMA, slow integer).
+    kP23   = 0x0CU,                      //!< Ports 2 and 3 (loads).
+    kP4    = 0x10U,                      //!< Port 4 (store data).
+    kP5    = 0x20U,                      //!< Port 5 (ALU, shuffles).
+    kP6    = 0x40U,                      //!< Port 6 (ALU, branches).
+
+    kP01   = kP0 | kP1,                  //!< Ports 0 and 1.
+    kP05   = kP0 | kP5,                  //!< Ports 0 and 5.
+    kP15   = kP1 | kP5,                  //!< Ports 1 and 5.
+    kP015  = kP0 | kP1 | kP5,            //!< Vector ALU ports.
+    kP0156 = kP0 | kP1 | kP5 | kP6       //!< Scalar ALU ports.
+  };
+
+  //! Latency of a load, added to instructions that read memory.
+  enum { kLoadLatency = 5 };
+
+  uint8_t latency;                       //!< Latency in cycles.
+  uint8_t ports;                         //!< Execution ports, see \ref Ports.
+
+  //! Get scheduling info of `instId`, instructions not in the table are
+  //! single-cycle and execute on any ALU port of their register kind.
+  static ASMJIT_API X86SchedInfo get(uint32_t instId) noexcept;
+};
+
+// ============================================================================
+// [asmjit::X86SchedulerPass]
+// ============================================================================
+
+//! Instruction scheduling pass.
+//!
+//! The pass reorders straight-line code to hide latencies of long dependency
+//! chains (typically SIMD code written chain by chain). It's a list scheduler
+//! that works on regions - runs of consecutive instructions that don't jump,
+//! don't use fixed or physical registers, and don't touch the FPU stack.
+//! Labels, function nodes, calls, and all other nodes end a region, so the
+//! flow is never changed. In each region:
+//!
+//!   - Dependencies are computed from virtual registers (read-after-write,
+//!     write-after-read, and write-after-write), flags, and memory. Memory is
+//!     not disambiguated, stores are ordered with all other memory accesses.
+//!
+//!   - Instructions are issued cycle by cycle (up to 4 per cycle, each needs
+//!     a free port of \ref X86SchedInfo) in the order of their critical path,
+//!     ties keep the original order.
+//!
+//!   - If \ref getMaxPressure() values defined by the region are live, an
+//!     instruction that doesn't increase their count is preferred, so the pass
+//!     doesn't interleave more chains than registers can hold.
+//!
+//! The pass must run before the register allocator, so it works on virtual
+//! registers and the allocator sees the final order:
+//!
+//! ~~~
+//! X86Compiler cc(&code);
+//! cc.insertPassT<X86SchedulerPass>(cc.getPassByName("RA"));
+//! ~~~
+class ASMJIT_VIRTAPI X86SchedulerPass : public CBPass {
+public:
+  ASMJIT_NONCOPYABLE(X86SchedulerPass)
+  typedef CBPass Base;
+
+  enum {
+    //! Maximum count of instructions of a single region.
+    kMaxRegionSize = 64,
+    //! Default maximum count of live values defined by a region.
+    kDefaultMaxPressure = 12,
+    //! Count of instructions issued per cycle.
+    kIssueWidth = 4
+  };
+
+  // --------------------------------------------------------------------------
+  // [Construction / Destruction]
+  // --------------------------------------------------------------------------
+
+  ASMJIT_API X86SchedulerPass() noexcept;
+  ASMJIT_API virtual ~X86SchedulerPass() noexcept;
+
+  // --------------------------------------------------------------------------
+  // [Interface]
+  // --------------------------------------------------------------------------
+
+  ASMJIT_API virtual Error process(Zone* zone) noexcept override;
+
+  // --------------------------------------------------------------------------
+  // [Accessors]
+  // --------------------------------------------------------------------------
+
+  //! Get maximum count of live values defined by a region.
+  ASMJIT_INLINE uint32_t getMaxPressure() const noexcept { return _maxPressure; }
+  //! Set maximum count of live values defined by a region.
+  ASMJIT_INLINE void setMaxPressure(uint32_t maxPressure) noexcept { _maxPressure = maxPressure; }
+
+  //! Get the number of regions scheduled by the last `process()`.
+  ASMJIT_INLINE uint32_t getRegionCount() const noexcept { return _regionCount; }
+  //! Get the number of instructions moved by the last `process()`.
+  ASMJIT_INLINE uint32_t getMovedCount() const noexcept { return _movedCount; }
+
+  // --------------------------------------------------------------------------
+  // [Members]
+  // --------------------------------------------------------------------------
+
+  uint32_t _maxPressure;                 //!< Maximum count of live values defined by a region.
+  uint32_t _regionCount;                 //!< Regions scheduled by the last `process()`.
+  uint32_t _movedCount;                  //!< Instructions moved by the last `process()`.
+};
+
+//! \}
+
+} // asmjit namespace
+
+// [Api-End]
+#include "../asmjit_apiend.h"
+
+// [Guard]
+#endif // !ASMJIT_DISABLE_BUILDER
+#endif // _ASMJIT_X86_X86SCHEDULER_H
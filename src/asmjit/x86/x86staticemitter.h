@@ -0,0 +1,232 @@
+// [AsmJit]
+// Complete x86/x64 JIT and Remote Assembler for C++.
+//
+// [License]
+// Zlib - See LICENSE.md file in the package.
+
+// [Guard]
+#ifndef _ASMJIT_X86_X86STATICEMITTER_H
+#define _ASMJIT_X86_X86STATICEMITTER_H
+
+// [Dependencies]
+#include "../x86/x86assembler.h"
+
+// [Api-Begin]
+#include "../asmjit_apibegin.h"
+
+namespace asmjit {
+
+//! \addtogroup asmjit_x86
+//! \{
+
+// ============================================================================
+// [asmjit::X86StaticForm]
+// ============================================================================
+
+//! Instruction form known at compile time, see \ref X86StaticEmitter.
+//!
+//! Only valid forms are specialized, so using an instruction with operand
+//! types it doesn't accept (or mixing operands of different sizes) refers to
+//! an undefined specialization and fails to compile.
+template<uint32_t InstId, typename T0, typename T1>
+struct X86StaticForm;
+
+//! \internal
+//!
+//! Kind of \ref X86StaticForm.
+ASMJIT_ENUM(X86StaticFormKind) {
+  kX86StaticFormRR = 0,                  //!< `op reg, reg` - opcode and ModRM.
+  kX86StaticFormRI = 1                   //!< `op reg, imm` - 83 /ext ib or 81 /ext id.
+};
+
+//! \internal
+#define ASMJIT_X86_STATIC_FORM(ID, T0, T1, KIND, REX_W, OPCODE, EXT) \
+  template<> \
+  struct X86StaticForm<X86Inst::kId##ID, T0, T1> { \
+    enum { \
+      kKind = KIND, \
+      kRexW = REX_W, \
+      kOpCode = OPCODE, \
+      kExt = EXT \
+    }; \
+  }
+
+//! \internal
+#define ASMJIT_X86_STATIC_ALU(ID, OPCODE, EXT) \
+  ASMJIT_X86_STATIC_FORM(ID, X86Gpd, X86Gpd , kX86StaticFormRR, 0, OPCODE, 0); \
+  ASMJIT_X86_STATIC_FORM(ID, X86Gpq, X86Gpq , kX86StaticFormRR, 1, OPCODE, 0); \
+  ASMJIT_X86_STATIC_FORM(ID, X86Gpd, int32_t, kX86StaticFormRI, 0, 0, EXT);    \
+  ASMJIT_X86_STATIC_FORM(ID, X86Gpq, int32_t, kX86StaticFormRI, 1, 0, EXT)
+
+ASMJIT_X86_STATIC_ALU(Add, 0x01, 0);
+ASMJIT_X86_STATIC_ALU(Or , 0x09, 1);
+ASMJIT_X86_STATIC_ALU(Adc, 0x11, 2);
+ASMJIT_X86_STATIC_ALU(Sbb, 0x19, 3);
+ASMJIT_X86_STATIC_ALU(And, 0x21, 4);
+ASMJIT_X86_STATIC_ALU(Sub, 0x29, 5);
+ASMJIT_X86_STATIC_ALU(Xor, 0x31, 6);
+ASMJIT_X86_STATIC_ALU(Cmp, 0x39, 7);
+
+ASMJIT_X86_STATIC_FORM(Mov , X86Gpd, X86Gpd, kX86StaticFormRR, 0, 0x89, 0);
+ASMJIT_X86_STATIC_FORM(Mov , X86Gpq, X86Gpq, kX86StaticFormRR, 1, 0x89, 0);
+ASMJIT_X86_STATIC_FORM(Test, X86Gpd, X86Gpd, kX86StaticFormRR, 0, 0x85, 0);
+ASMJIT_X86_STATIC_FORM(Test, X86Gpq, X86Gpq, kX86StaticFormRR, 1, 0x85, 0);
+
+#undef ASMJIT_X86_STATIC_ALU
+#undef ASMJIT_X86_STATIC_FORM
+
+// ============================================================================
+// [asmjit::X86StaticEmitter]
+// ============================================================================
+
+//! Emitter of instruction forms known at compile time.
+//!
+//! A thin layer over \ref X86Assembler for code generators that emit fixed
+//! instruction shapes. Operands are typed by size (\ref X86Gpd, \ref X86Gpq,
+//! and `int32_t` immediates), the form is checked at compile time through
+//! \ref X86StaticForm, and the instruction is encoded inline straight into
+//! the CodeBuffer - no instruction tables, no validation, and no dispatch.
+//!
+//! The inline path is only taken when the instruction doesn't need anything
+//! the encoder does beyond encoding - instruction options, extra register,
+//! inline comment, logging, tracing, statistics, buffer growth, or an error
+//! state. Otherwise, and for registers the target architecture doesn't have,
+//! the instruction is emitted by `X86Assembler::emit()`, so the result never
+//! differs from the generic path.
+//!
+//! \code
+//! X86StaticEmitter s(&a);
+//! s.add(x86::gpd(0), x86::gpd(1));  // add eax, ecx
+//! s.sub(x86::gpq(8), 16);           // sub r8, 16
+//! s.add(x86::gpd(0), x86::gpq(1));  // Compile error.
+//! \endcode
+class X86StaticEmitter {
+public:
+  // --------------------------------------------------------------------------
+  // [Construction / Destruction]
+  // --------------------------------------------------------------------------
+
+  //! Create a new `X86StaticEmitter` that emits to the assembler `a`.
+  explicit ASMJIT_INLINE X86StaticEmitter(X86Assembler* a) noexcept : _a(a) {}
+
+  // --------------------------------------------------------------------------
+  // [Accessors]
+  // --------------------------------------------------------------------------
+
+  //! Get the assembler.
+  ASMJIT_INLINE X86Assembler* getAssembler() const noexcept { return _a; }
+
+  //! Get whether the next instruction can be encoded inline.
+  ASMJIT_INLINE bool canEmitInline() const noexcept {
+    const uint32_t kIgnoredOptions = CodeEmitter::kOptionStrictValidation |
+                                     X86Inst::_kOptionInvalidRex          ;
+    const X86Assembler* a = _a;
+
+    return ((a->_globalOptions | a->_options) & ~kIgnoredOptions) == 0 &&
+           !a->hasExtraReg()                                           &&
+           !a->_inlineComment                                          &&
+           !a->_code->_traceBuffer                                     &&
+           !a->_code->_statsEnabled                                    &&
+           a->getRemainingSpace() >= 16;
+  }
+
+  // --------------------------------------------------------------------------
+  // [Emit]
+  // --------------------------------------------------------------------------
+
+  //! Emit the instruction `InstId` with register operands.
+  template<uint32_t InstId, typename T0, typename T1>
+  ASMJIT_INLINE Error emit(const T0& o0, const T1& o1) noexcept {
+    typedef X86StaticForm<InstId, T0, T1> Form;
+    ASMJIT_ASSERT(static_cast<uint32_t>(Form::kKind) == kX86StaticFormRR);
+
+    uint32_t rm = o0.getId();
+    uint32_t reg = o1.getId();
+    uint32_t rex = (Form::kRexW << 3) | ((reg & 0x8U) >> 1) | ((rm & 0x8U) >> 3);
+
+    if (ASMJIT_UNLIKELY(!canEmitInline() || (rm | reg) > 15 || (rex && _a->getArchType() != ArchInfo::kTypeX64)))
+      return _a->emit(InstId, o0, o1);
+
+    uint8_t* p = _a->_bufferPtr;
+    if (rex) *p++ = static_cast<uint8_t>(0x40U | rex);
+    p[0] = static_cast<uint8_t>(Form::kOpCode);
+    p[1] = static_cast<uint8_t>(0xC0U | ((reg & 0x7U) << 3) | (rm & 0x7U));
+
+    _a->_bufferPtr = p + 2;
+    return kErrorOk;
+  }
+
+  //! Emit the instruction `InstId` with a register and an immediate operand.
+  template<uint32_t InstId, typename T0>
+  ASMJIT_INLINE Error emit(const T0& o0, int32_t o1) noexcept {
+    typedef X86StaticForm<InstId, T0, int32_t> Form;
+    ASMJIT_ASSERT(static_cast<uint32_t>(Form::kKind) == kX86StaticFormRI);
+
+    uint32_t rm = o0.getId();
+    uint32_t rex = (Form::kRexW << 3) | ((rm & 0x8U) >> 3);
+
+    if (ASMJIT_UNLIKELY(!canEmitInline() || rm > 15 || (rex && _a->getArchType() != ArchInfo::kTypeX64)))
+      return _a->emit(InstId, o0, Imm(o1));
+
+    uint8_t* p = _a->_bufferPtr;
+    if (rex) *p++ = static_cast<uint8_t>(0x40U | rex);
+    p[1] = static_cast<uint8_t>(0xC0U | (Form::kExt << 3) | (rm & 0x7U));
+
+    if (Utils::isInt8(o1)) {
+      p[0] = 0x83;
+      p[2] = static_cast<uint8_t>(o1 & 0xFF);
+      p += 3;
+    }
+    else {
+      p[0] = 0x81;
+      Utils::writeI32uLE(p + 2, o1);
+      p += 6;
+    }
+
+    _a->_bufferPtr = p;
+    return kErrorOk;
+  }
+
+  // --------------------------------------------------------------------------
+  // [Instructions]
+  // --------------------------------------------------------------------------
+
+#define ASMJIT_STATIC_INST_RR(NAME, ID) \
+  template<typename T> \
+  ASMJIT_INLINE Error NAME(const T& o0, const T& o1) noexcept { return emit<X86Inst::kId##ID>(o0, o1); }
+
+#define ASMJIT_STATIC_INST_RI(NAME, ID) \
+  ASMJIT_STATIC_INST_RR(NAME, ID) \
+  template<typename T> \
+  ASMJIT_INLINE Error NAME(const T& o0, int32_t o1) noexcept { return emit<X86Inst::kId##ID>(o0, o1); }
+
+  ASMJIT_STATIC_INST_RI(adc , Adc)
+  ASMJIT_STATIC_INST_RI(add , Add)
+  ASMJIT_STATIC_INST_RI(and_, And)
+  ASMJIT_STATIC_INST_RI(cmp , Cmp)
+  ASMJIT_STATIC_INST_RR(mov , Mov)
+  ASMJIT_STATIC_INST_RI(or_ , Or)
+  ASMJIT_STATIC_INST_RI(sbb , Sbb)
+  ASMJIT_STATIC_INST_RI(sub , Sub)
+  ASMJIT_STATIC_INST_RR(test, Test)
+  ASMJIT_STATIC_INST_RI(xor_, Xor)
+
+#undef ASMJIT_STATIC_INST_RI
+#undef ASMJIT_STATIC_INST_RR
+
+  // --------------------------------------------------------------------------
+  // [Members]
+  // --------------------------------------------------------------------------
+
+  X86Assembler* _a;                      //!< Assembler.
+};
+
+//! \}
+
+} // asmjit namespace
+
+// [Api-End]
+#include "../asmjit_apiend.h"
+
+// [Guard]
+#endif // _ASMJIT_X86_X86STATICEMITTER_H
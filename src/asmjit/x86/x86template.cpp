@@ -0,0 +1,437 @@
+// [AsmJit]
+// Complete x86/x64 JIT and Remote Assembler for C++.
+//
+// [License]
+// Zlib - See LICENSE.md file in the package.
+
+// [Export]
+#define ASMJIT_EXPORTS
+
+// [Guard]
+#include "../asmjit_build.h"
+#if defined(ASMJIT_BUILD_X86)
+
+// [Dependencies]
+#include "../x86/x86template.h"
+
+// [Api-Begin]
+#include "../asmjit_apibegin.h"
+
+namespace asmjit {
+
+// ============================================================================
+// [asmjit::X86InstTemplate - Encoder]
+// ============================================================================
+
+//! \internal
+//!
+//! Scratch encoder used by `X86InstTemplate::init()`, it encodes the same
+//! instruction with modified operands at offset zero of its own CodeHolder.
+struct X86InstTemplateEncoder {
+  ASMJIT_INLINE X86InstTemplateEncoder(X86Assembler* a, uint32_t instId, uint32_t options) noexcept
+    : a(a),
+      instId(instId),
+      options(options),
+      memIndex(Globals::kInvalidIndex) {}
+
+  ASMJIT_INLINE X86Mem& mem() noexcept { return ops[memIndex].as<X86Mem>(); }
+
+  //! Encode the instruction into `out`, fails also if the instruction has a
+  //! different size than `expectedSize` (if non-zero).
+  Error encode(uint8_t* out, uint32_t expectedSize) noexcept {
+    a->resetLastError();
+    ASMJIT_PROPAGATE(a->setOffset(0));
+
+    a->setOptions(options | CodeEmitter::kOptionStrictValidation);
+    ASMJIT_PROPAGATE(a->emit(instId, ops[0], ops[1], ops[2], ops[3]));
+
+    size_t size = a->getOffset();
+    if (size == 0 || size > X86InstTemplate::kMaxSize || (expectedSize != 0 && size != expectedSize))
+      return DebugUtils::errored(kErrorInvalidState);
+
+    ::memcpy(out, a->getBufferData(), size);
+    return kErrorOk;
+  }
+
+  void setRegId(uint32_t field, uint32_t id) noexcept {
+    if (field < X86InstTemplate::kFieldBase)
+      ops[field].as<Reg>().setId(id);
+    else if (field == X86InstTemplate::kFieldBase)
+      mem()._setBase(mem().getBaseType(), id);
+    else
+      mem()._setIndex(mem().getIndexType(), id);
+  }
+
+  X86Assembler* a;
+  uint32_t instId;
+  uint32_t options;
+  size_t memIndex;
+  Operand_ ops[X86InstTemplate::kMaxOperands];
+};
+
+//! \internal
+//!
+//! Compare `a` and `b`, return the number of bytes that differ and the offset
+//! of the first one in `first`.
+static uint32_t X86InstTemplate_diff(const uint8_t* a, const uint8_t* b, uint32_t size, uint32_t* first) noexcept {
+  uint32_t count = 0;
+  for (uint32_t i = 0; i < size; i++) {
+    if (a[i] != b[i]) {
+      if (count++ == 0) *first = i;
+    }
+  }
+  return count;
+}
+
+static void X86InstTemplate_initReg(X86InstTemplate* self, X86InstTemplateEncoder& enc, uint32_t field, uint32_t id0) noexcept {
+  X86InstTemplate::RegField& rf = self->_regs[field];
+  uint32_t size = self->_size;
+  uint32_t known = 0;
+
+  uint8_t buf[X86InstTemplate::kBufferSize];
+  uint32_t i, first;
+
+  // Find where each bit of the register id is encoded, a bit is only usable
+  // if flipping it changes a single byte and keeps the instruction length.
+  // If flipping a bit of `id0` is not possible (for example `rax` -> `rsp`
+  // as a base register) try it again from ids reachable through bits that
+  // are already known (`rdx` -> `rsi`).
+  uint32_t pending = 0x1F;
+  while (pending) {
+    uint32_t learned = 0;
+
+    for (i = 0; i < 5; i++) {
+      if (!(pending & (1U << i))) continue;
+
+      for (uint32_t m = 0; m < 32; m++) {
+        if ((m & ~known) != 0) continue;
+
+        uint8_t base[X86InstTemplate::kBufferSize];
+        enc.setRegId(field, id0 ^ m);
+        if (enc.encode(base, size) != kErrorOk) continue;
+
+        enc.setRegId(field, id0 ^ m ^ (1U << i));
+        if (enc.encode(buf, size) != kErrorOk) continue;
+        if (X86InstTemplate_diff(base, buf, size, &first) != 1) continue;
+
+        rf.offset[i] = static_cast<uint8_t>(first);
+        rf.mask[i] = static_cast<uint8_t>(base[first] ^ buf[first]);
+        learned |= 1U << i;
+        break;
+      }
+    }
+
+    if (!learned) break;
+    known |= learned;
+    pending &= ~learned;
+  }
+
+  // Verify all ids reachable through known bits against the encoder. Bits
+  // are not always independent (for example patching `[rdx]` to `[rsp]`
+  // requires SIB), so every id has to be checked.
+  rf.id = static_cast<uint8_t>(id0);
+  rf.validIds = 1U << id0;
+
+  for (uint32_t id = 0; id < 32; id++) {
+    uint32_t diff = id ^ id0;
+    if (diff == 0 || (diff & ~known) != 0) continue;
+
+    uint8_t predicted[X86InstTemplate::kBufferSize];
+    ::memcpy(predicted, self->_data, X86InstTemplate::kBufferSize);
+
+    for (i = 0; i < 5; i++)
+      if (diff & (1U << i))
+        predicted[rf.offset[i]] ^= rf.mask[i];
+
+    enc.setRegId(field, id);
+    if (enc.encode(buf, size) == kErrorOk && ::memcmp(predicted, buf, size) == 0)
+      rf.validIds |= 1U << id;
+  }
+
+  enc.setRegId(field, id0);
+}
+
+static void X86InstTemplate_initDisp(X86InstTemplate* self, X86InstTemplateEncoder& enc) noexcept {
+  X86Mem& mem = enc.mem();
+  int32_t disp0 = mem.getOffsetLo32();
+
+  uint32_t size = self->_size;
+  uint8_t buf[X86InstTemplate::kBufferSize];
+  uint32_t i, first;
+
+  // Find the lowest displacement byte. Compressed disp8*N (AVX-512) only
+  // accepts displacements that are multiples of N, so try all scales.
+  for (i = 0; i <= 6; i++) {
+    mem.setOffset(static_cast<int64_t>(disp0 ^ (1 << i)));
+    if (enc.encode(buf, size) == kErrorOk && X86InstTemplate_diff(self->_data, buf, size, &first) == 1)
+      break;
+  }
+
+  mem.setOffset(static_cast<int64_t>(disp0));
+  if (i > 6) return;
+
+  self->_dispOffset = static_cast<uint8_t>(first);
+  self->_dispShift = static_cast<uint8_t>(i);
+  self->_dispSize = 1;
+
+  // DISP32 if flipping a bit of the second byte keeps the instruction length.
+  uint32_t second;
+  mem.setOffset(static_cast<int64_t>(disp0 ^ (1 << (i + 8))));
+  if (enc.encode(buf, size) == kErrorOk &&
+      X86InstTemplate_diff(self->_data, buf, size, &second) == 1 && second == first + 1) {
+    self->_dispSize = 4;
+  }
+
+  if (first + self->_dispSize > size) {
+    self->_dispSize = 0;
+  }
+  else {
+    // Verify both ends of the range.
+    int32_t lo = self->_dispSize == 1 ? -128 * (1 << i) : static_cast<int32_t>(0x80000000U);
+    int32_t hi = self->_dispSize == 1 ?  127 * (1 << i) : static_cast<int32_t>(0x7FFFFFFF );
+    int32_t values[2] = { lo, hi };
+
+    for (uint32_t j = 0; j < 2; j++) {
+      X86InstTemplate tmp(*self);
+      mem.setOffset(static_cast<int64_t>(values[j]));
+
+      if (tmp.setDisp(values[j]) != kErrorOk ||
+          enc.encode(buf, size) != kErrorOk ||
+          ::memcmp(tmp._data, buf, size) != 0) {
+        self->_dispSize = 0;
+        break;
+      }
+    }
+  }
+
+  mem.setOffset(static_cast<int64_t>(disp0));
+}
+
+static void X86InstTemplate_initImm(X86InstTemplate* self, X86InstTemplateEncoder& enc, uint32_t immIndex) noexcept {
+  Imm& imm = enc.ops[immIndex].as<Imm>();
+  int64_t imm0 = imm.getInt64();
+
+  uint32_t size = self->_size;
+  uint8_t buf[X86InstTemplate::kBufferSize];
+  uint32_t i, first, next;
+
+  imm.setInt64(imm0 ^ 1);
+  Error err = enc.encode(buf, size);
+
+  imm.setInt64(imm0);
+  if (err != kErrorOk || X86InstTemplate_diff(self->_data, buf, size, &first) != 1)
+    return;
+
+  // Find the size of the immediate, which can be 1, 2, 4 or 8.
+  uint32_t immSize = 1;
+  for (i = 8; i < 64; i += 8) {
+    imm.setInt64(imm0 ^ (static_cast<int64_t>(1) << i));
+    err = enc.encode(buf, size);
+
+    if (err != kErrorOk || X86InstTemplate_diff(self->_data, buf, size, &next) != 1 || next != first + immSize)
+      break;
+    immSize++;
+  }
+  imm.setInt64(imm0);
+
+  if ((immSize & (immSize - 1)) != 0 || first + immSize > size)
+    return;
+
+  self->_immOffset = static_cast<uint8_t>(first);
+  self->_immSize = static_cast<uint8_t>(immSize);
+
+  if (immSize == 8) {
+    self->_immMin = static_cast<int64_t>(ASMJIT_UINT64_C(0x8000000000000000));
+    self->_immMax = static_cast<int64_t>(ASMJIT_UINT64_C(0x7FFFFFFFFFFFFFFF));
+    return;
+  }
+
+  // Verify the signed and unsigned ranges, the immediate can be sign-extended
+  // or zero-extended by the instruction and the encoder handles both cases.
+  int64_t lim = static_cast<int64_t>(1) << (immSize * 8 - 1);
+  int64_t values[3] = { -lim, lim - 1, lim * 2 - 1 };
+  bool valid[3];
+
+  self->_immMin = -lim;
+  self->_immMax = lim * 2 - 1;
+
+  for (i = 0; i < 3; i++) {
+    X86InstTemplate tmp(*self);
+    imm.setInt64(values[i]);
+
+    valid[i] = tmp.setImm(values[i]) == kErrorOk &&
+               enc.encode(buf, size) == kErrorOk &&
+               ::memcmp(tmp._data, buf, size) == 0;
+  }
+  imm.setInt64(imm0);
+
+  bool signedOk = valid[0] && valid[1];
+  bool unsignedOk = valid[1] && valid[2];
+
+  if (signedOk || unsignedOk) {
+    self->_immMin = signedOk ? -lim : 0;
+    self->_immMax = unsignedOk ? lim * 2 - 1 : lim - 1;
+  }
+  else {
+    self->_immSize = 0;
+    self->_immMin = 0;
+    self->_immMax = 0;
+  }
+}
+
+// ============================================================================
+// [asmjit::X86InstTemplate - Init / Reset]
+// ============================================================================
+
+Error X86InstTemplate::init(uint32_t archType, uint32_t instId, uint32_t options, const Operand_* opArray, uint32_t opCount) noexcept {
+  reset();
+
+  if (ASMJIT_UNLIKELY(archType != ArchInfo::kTypeX86 && archType != ArchInfo::kTypeX64))
+    return DebugUtils::errored(kErrorInvalidArch);
+
+  if (ASMJIT_UNLIKELY(opCount > kMaxOperands))
+    return DebugUtils::errored(kErrorInvalidArgument);
+
+  CodeHolder code;
+  ASMJIT_PROPAGATE(code.init(CodeInfo(archType)));
+
+  X86Assembler a(&code);
+  X86InstTemplateEncoder enc(&a, instId, options);
+
+  uint32_t i;
+  size_t immIndex = Globals::kInvalidIndex;
+
+  for (i = 0; i < kMaxOperands; i++) {
+    if (i < opCount)
+      enc.ops[i].copyFrom(opArray[i]);
+    else
+      enc.ops[i].reset();
+
+    const Operand_& op = enc.ops[i];
+    if (op.isLabel())
+      return DebugUtils::errored(kErrorInvalidArgument);
+
+    if (op.isReg() && !op.isPhysReg())
+      return DebugUtils::errored(kErrorInvalidArgument);
+
+    if (op.isMem()) {
+      const X86Mem& m = op.as<X86Mem>();
+      if (m.hasBaseLabel() || m.getBaseType() == X86Reg::kRegRip)
+        return DebugUtils::errored(kErrorInvalidArgument);
+      enc.memIndex = i;
+    }
+
+    if (op.isImm() && immIndex == Globals::kInvalidIndex)
+      immIndex = i;
+  }
+
+  Error err = enc.encode(_data, 0);
+  if (ASMJIT_UNLIKELY(err)) {
+    reset();
+    return err;
+  }
+
+  _instId = instId;
+  _archType = static_cast<uint8_t>(archType);
+  _size = static_cast<uint8_t>(a.getOffset());
+
+  for (i = 0; i < kMaxOperands; i++) {
+    if (enc.ops[i].isReg())
+      X86InstTemplate_initReg(this, enc, i, enc.ops[i].getId());
+  }
+
+  if (enc.memIndex != Globals::kInvalidIndex) {
+    const X86Mem& m = enc.mem();
+    if (m.hasBaseReg())
+      X86InstTemplate_initReg(this, enc, kFieldBase, m.getBaseId());
+    if (m.hasIndexReg())
+      X86InstTemplate_initReg(this, enc, kFieldIndex, m.getIndexId());
+    X86InstTemplate_initDisp(this, enc);
+  }
+
+  if (immIndex != Globals::kInvalidIndex)
+    X86InstTemplate_initImm(this, enc, static_cast<uint32_t>(immIndex));
+
+  return kErrorOk;
+}
+
+void X86InstTemplate::reset() noexcept {
+  ::memset(this, 0, sizeof(*this));
+}
+
+// ============================================================================
+// [asmjit::X86InstTemplate - Test]
+// ============================================================================
+
+#if defined(ASMJIT_TEST)
+UNIT(x86_inst_template) {
+  using namespace x86;
+
+  X86InstTemplate t;
+  uint8_t expected[X86InstTemplate::kBufferSize];
+  size_t expectedSize;
+
+  CodeHolder code;
+  code.init(CodeInfo(ArchInfo::kTypeX64));
+  X86Assembler a(&code);
+
+  INFO("Patching registers and displacement of 'add r64, [base + disp32]'");
+  EXPECT(t.init(ArchInfo::kTypeX64, X86Inst::kIdAdd, rax, qword_ptr(rcx, 0x1000)) == kErrorOk);
+  EXPECT(t.hasDisp() && t.getDispSize() == 4 && !t.hasImm());
+  EXPECT(t.canPatchReg(X86InstTemplate::kFieldOp0, r9.getId()),
+    "REX.R is already present, R9 should be patchable");
+  EXPECT(!t.canPatchReg(X86InstTemplate::kFieldBase, rsp.getId()),
+    "[RSP] requires SIB, it should not be patchable");
+
+  EXPECT(t.setReg(X86InstTemplate::kFieldOp0, r9) == kErrorOk);
+  EXPECT(t.setReg(X86InstTemplate::kFieldBase, rbx) == kErrorOk);
+  EXPECT(t.setDisp(0x12345) == kErrorOk);
+  EXPECT(t.setReg(X86InstTemplate::kFieldBase, rsp) != kErrorOk);
+
+  a.add(r9, qword_ptr(rbx, 0x12345));
+  expectedSize = a.getOffset();
+  ::memcpy(expected, a.getBufferData(), expectedSize);
+
+  EXPECT(t.getSize() == expectedSize && ::memcmp(t.getData(), expected, expectedSize) == 0,
+    "Patched template doesn't match the encoder");
+
+  INFO("Patching immediate of 'add r32, imm32'");
+  EXPECT(t.init(ArchInfo::kTypeX64, X86Inst::kIdAdd, edx, imm(1000)) == kErrorOk);
+  EXPECT(t.getImmSize() == 4 && t.getImmMin() <= -2147483647 - 1);
+  EXPECT(t.setImm(70000) == kErrorOk);
+
+  a.setOffset(0);
+  a.add(edx, imm(70000));
+  expectedSize = a.getOffset();
+  ::memcpy(expected, a.getBufferData(), expectedSize);
+
+  EXPECT(t.getSize() == expectedSize && ::memcmp(t.getData(), expected, expectedSize) == 0,
+    "Patched template doesn't match the encoder");
+
+  INFO("Patching immediate of 'add r64, imm8'");
+  EXPECT(t.init(ArchInfo::kTypeX64, X86Inst::kIdAdd, rax, imm(1)) == kErrorOk);
+  EXPECT(t.getImmSize() == 1 && t.getImmMin() == -128 && t.getImmMax() == 127);
+  EXPECT(t.setImm(200) != kErrorOk, "Sign-extended imm8 should not accept 200");
+
+  INFO("Stamping the template into CodeBuffer");
+  a.setOffset(0);
+  for (uint32_t i = 0; i < 1000; i++) {
+    t.setImm(static_cast<int64_t>(i & 0x7F));
+    EXPECT(t.emit(&a) == kErrorOk);
+  }
+  EXPECT(a.getOffset() == 1000 * t.getSize());
+
+  INFO("Templates with labels are not supported");
+  Label L = a.newLabel();
+  EXPECT(t.init(ArchInfo::kTypeX64, X86Inst::kIdJmp, L) != kErrorOk);
+  EXPECT(!t.isInitialized());
+}
+#endif // ASMJIT_TEST
+
+} // asmjit namespace
+
+// [Api-End]
+#include "../asmjit_apiend.h"
+
+// [Guard]
+#endif // ASMJIT_BUILD_X86
@@ -0,0 +1,283 @@
+// [AsmJit]
+// Complete x86/x64 JIT and Remote Assembler for C++.
+//
+// [License]
+// Zlib - See LICENSE.md file in the package.
+
+// [Guard]
+#ifndef _ASMJIT_X86_X86TEMPLATE_H
+#define _ASMJIT_X86_X86TEMPLATE_H
+
+// [Dependencies]
+#include "../x86/x86assembler.h"
+
+// [Api-Begin]
+#include "../asmjit_apibegin.h"
+
+namespace asmjit {
+
+//! \addtogroup asmjit_x86
+//! \{
+
+// ============================================================================
+// [asmjit::X86InstTemplate]
+// ============================================================================
+
+//! X86/X64 instruction template.
+//!
+//! Instruction template is a single instruction that was encoded once by
+//! `X86Assembler` and that can be stamped into the CodeBuffer many times with
+//! different registers, displacement, and immediate value - without going
+//! through instruction tables and the encoder again. It's designed for code
+//! generators that emit the same instruction shapes over and over again.
+//!
+//! \ref init() encodes the instruction and then re-encodes it with single-bit
+//! variations of each field to find out where the field lives within the
+//! instruction (ModRM, SIB, REX/VEX/EVEX prefix bits, displacement, and
+//! immediate). Each field is then verified against the encoder so patching
+//! never changes the length of the instruction or produces an encoding the
+//! encoder wouldn't produce itself (a patched displacement or immediate may
+//! use a longer form than `X86Assembler` would pick for the same value):
+//!
+//!   - Register fields (`kFieldOp0..3`, `kFieldBase`, and `kFieldIndex`) can
+//!     only be patched to register ids returned by \ref getValidIds(). These
+//!     are ids that encode without changing the length of the instruction,
+//!     for example `rax` can't be patched to `r8` if the instruction doesn't
+//!     have a REX prefix already, and `[rax]` can't be patched to `[rsp]` as
+//!     it requires SIB.
+//!   - Displacement has a fixed size, so to make it patchable the template
+//!     should be created with a non-zero displacement that has the required
+//!     size (compressed disp8*N is honored on AVX-512).
+//!   - Immediate has a fixed size and the range of values that can be used
+//!     is returned by \ref getImmMin() and \ref getImmMax().
+//!
+//! Templates that use labels or RIP-relative addressing are not supported as
+//! these require label links or relocations.
+//!
+//! \code
+//! X86InstTemplate t;
+//! t.init(ArchInfo::kTypeX64, X86Inst::kIdAdd, x86::rax, x86::qword_ptr(x86::rcx, 0x100));
+//!
+//! for (uint32_t i = 0; i < n; i++) {
+//!   t.setReg(X86InstTemplate::kFieldOp0, regs[i]);
+//!   t.setDisp(int32_t(i * 8));
+//!   t.emit(&a);
+//! }
+//! \endcode
+class X86InstTemplate {
+public:
+  ASMJIT_ENUM(Limits) {
+    kMaxSize     = 15,                   //!< Maximum size of an instruction.
+    kMaxOperands = 4,                    //!< Maximum number of operands.
+    kBufferSize  = 16                    //!< Size of the template buffer.
+  };
+
+  //! Patchable field.
+  ASMJIT_ENUM(Field) {
+    kFieldOp0    = 0,                    //!< Register operand #0.
+    kFieldOp1    = 1,                    //!< Register operand #1.
+    kFieldOp2    = 2,                    //!< Register operand #2.
+    kFieldOp3    = 3,                    //!< Register operand #3.
+    kFieldBase   = 4,                    //!< Base register of the memory operand.
+    kFieldIndex  = 5,                    //!< Index register of the memory operand.
+    kFieldCount  = 6                     //!< Count of register fields.
+  };
+
+  //! \internal
+  //!
+  //! Location of a register field, each bit of the register id is mapped to a
+  //! byte `offset` and a `mask` to XOR when the bit changes.
+  struct RegField {
+    uint32_t validIds;                   //!< Bit-mask of ids the field can be patched to.
+    uint8_t id;                          //!< Current register id.
+    uint8_t reserved;                    //!< \internal
+    uint8_t offset[5];                   //!< Byte offset of each id bit.
+    uint8_t mask[5];                     //!< XOR mask of each id bit.
+  };
+
+  // --------------------------------------------------------------------------
+  // [Construction / Destruction]
+  // --------------------------------------------------------------------------
+
+  ASMJIT_INLINE X86InstTemplate() noexcept { reset(); }
+
+  // --------------------------------------------------------------------------
+  // [Init / Reset]
+  // --------------------------------------------------------------------------
+
+  //! Encode `instId` with `opArray` and build the template.
+  ASMJIT_API Error init(uint32_t archType, uint32_t instId, uint32_t options, const Operand_* opArray, uint32_t opCount) noexcept;
+
+  //! \overload
+  ASMJIT_INLINE Error init(uint32_t archType, uint32_t instId, const Operand_& o0) noexcept {
+    return init(archType, instId, 0, &o0, 1);
+  }
+  //! \overload
+  ASMJIT_INLINE Error init(uint32_t archType, uint32_t instId, const Operand_& o0, const Operand_& o1) noexcept {
+    Operand_ opArray[2] = { o0, o1 };
+    return init(archType, instId, 0, opArray, 2);
+  }
+  //! \overload
+  ASMJIT_INLINE Error init(uint32_t archType, uint32_t instId, const Operand_& o0, const Operand_& o1, const Operand_& o2) noexcept {
+    Operand_ opArray[3] = { o0, o1, o2 };
+    return init(archType, instId, 0, opArray, 3);
+  }
+  //! \overload
+  ASMJIT_INLINE Error init(uint32_t archType, uint32_t instId, const Operand_& o0, const Operand_& o1, const Operand_& o2, const Operand_& o3) noexcept {
+    Operand_ opArray[4] = { o0, o1, o2, o3 };
+    return init(archType, instId, 0, opArray, 4);
+  }
+
+  //! Reset the template to an uninitialized state.
+  ASMJIT_API void reset() noexcept;
+
+  // --------------------------------------------------------------------------
+  // [Accessors]
+  // --------------------------------------------------------------------------
+
+  //! Get whether the template was successfully initialized.
+  ASMJIT_INLINE bool isInitialized() const noexcept { return _size != 0; }
+  //! Get the architecture the template was encoded for.
+  ASMJIT_INLINE uint32_t getArchType() const noexcept { return _archType; }
+  //! Get the instruction id.
+  ASMJIT_INLINE uint32_t getInstId() const noexcept { return _instId; }
+
+  //! Get the size of the encoded instruction.
+  ASMJIT_INLINE uint32_t getSize() const noexcept { return _size; }
+  //! Get the encoded instruction (with all fields patched).
+  ASMJIT_INLINE const uint8_t* getData() const noexcept { return _data; }
+
+  //! Get register ids the register `field` can be patched to (bit-mask).
+  ASMJIT_INLINE uint32_t getValidIds(uint32_t field) const noexcept {
+    ASMJIT_ASSERT(field < kFieldCount);
+    return _regs[field].validIds;
+  }
+  //! Get whether the register `field` can be patched to `id`.
+  ASMJIT_INLINE bool canPatchReg(uint32_t field, uint32_t id) const noexcept {
+    return id < 32 && (getValidIds(field) & (1U << id)) != 0;
+  }
+
+  //! Get whether the instruction has a patchable displacement.
+  ASMJIT_INLINE bool hasDisp() const noexcept { return _dispSize != 0; }
+  //! Get the size of the displacement (0, 1 or 4).
+  ASMJIT_INLINE uint32_t getDispSize() const noexcept { return _dispSize; }
+  //! Get the displacement scale as a shift (compressed disp8*N used by EVEX).
+  ASMJIT_INLINE uint32_t getDispShift() const noexcept { return _dispShift; }
+
+  //! Get whether the instruction has a patchable immediate.
+  ASMJIT_INLINE bool hasImm() const noexcept { return _immSize != 0; }
+  //! Get the size of the immediate (0, 1, 2, 4 or 8).
+  ASMJIT_INLINE uint32_t getImmSize() const noexcept { return _immSize; }
+  //! Get the minimum immediate value that can be patched.
+  ASMJIT_INLINE int64_t getImmMin() const noexcept { return _immMin; }
+  //! Get the maximum immediate value that can be patched.
+  ASMJIT_INLINE int64_t getImmMax() const noexcept { return _immMax; }
+
+  // --------------------------------------------------------------------------
+  // [Patch]
+  // --------------------------------------------------------------------------
+
+  //! Patch the register `field` to register `id`.
+  ASMJIT_INLINE Error setReg(uint32_t field, uint32_t id) noexcept {
+    if (ASMJIT_UNLIKELY(!canPatchReg(field, id)))
+      return DebugUtils::errored(kErrorInvalidArgument);
+
+    RegField& rf = _regs[field];
+    uint32_t diff = rf.id ^ id;
+
+    for (uint32_t i = 0; diff; i++, diff >>= 1)
+      if (diff & 1)
+        _data[rf.offset[i]] ^= rf.mask[i];
+
+    rf.id = static_cast<uint8_t>(id);
+    return kErrorOk;
+  }
+
+  //! \overload
+  ASMJIT_INLINE Error setReg(uint32_t field, const Reg& reg) noexcept { return setReg(field, reg.getId()); }
+
+  //! Patch the displacement to `disp`.
+  ASMJIT_INLINE Error setDisp(int32_t disp) noexcept {
+    int32_t scaled = disp >> _dispShift;
+
+    if (ASMJIT_UNLIKELY(!hasDisp() || (scaled << _dispShift) != disp || (_dispSize == 1 && !Utils::isInt8(scaled))))
+      return DebugUtils::errored(kErrorInvalidDisplacement);
+
+    uint8_t* p = _data + _dispOffset;
+    uint32_t x = static_cast<uint32_t>(scaled);
+
+    p[0] = static_cast<uint8_t>(x & 0xFFU);
+    if (_dispSize == 4) {
+      p[1] = static_cast<uint8_t>((x >>  8) & 0xFFU);
+      p[2] = static_cast<uint8_t>((x >> 16) & 0xFFU);
+      p[3] = static_cast<uint8_t>((x >> 24) & 0xFFU);
+    }
+    return kErrorOk;
+  }
+
+  //! Patch the immediate value to `imm`.
+  ASMJIT_INLINE Error setImm(int64_t imm) noexcept {
+    if (ASMJIT_UNLIKELY(!hasImm() || imm < _immMin || imm > _immMax))
+      return DebugUtils::errored(kErrorInvalidImmediate);
+
+    uint8_t* p = _data + _immOffset;
+    uint64_t x = static_cast<uint64_t>(imm);
+
+    for (uint32_t i = 0; i < _immSize; i++, x >>= 8)
+      p[i] = static_cast<uint8_t>(x & 0xFFU);
+    return kErrorOk;
+  }
+
+  // --------------------------------------------------------------------------
+  // [Emit]
+  // --------------------------------------------------------------------------
+
+  //! Stamp the template into the CodeBuffer of the assembler `a`.
+  //!
+  //! The fast path is a single check followed by a fixed-size copy. If the
+  //! buffer has to grow, the assembler is in error state, or logging is
+  //! enabled, the instruction is emitted through \ref Assembler::embed().
+  ASMJIT_INLINE Error emit(X86Assembler* a) const noexcept {
+    ASMJIT_ASSERT(isInitialized());
+    ASMJIT_ASSERT(a->getArchType() == _archType);
+
+    const uint32_t kSlowOptions = CodeEmitter::kOptionMaybeFailureCase |
+                                  CodeEmitter::kOptionLoggingEnabled   ;
+
+    if (ASMJIT_UNLIKELY(a->getRemainingSpace() < kBufferSize || (a->_globalOptions & kSlowOptions)))
+      return a->embed(_data, _size);
+
+    ::memcpy(a->_bufferPtr, _data, kBufferSize);
+    a->_bufferPtr += _size;
+    return kErrorOk;
+  }
+
+  // --------------------------------------------------------------------------
+  // [Members]
+  // --------------------------------------------------------------------------
+
+  uint8_t _data[kBufferSize];            //!< Encoded instruction.
+  RegField _regs[kFieldCount];           //!< Register fields.
+  int64_t _immMin;                       //!< Minimum immediate value.
+  int64_t _immMax;                       //!< Maximum immediate value.
+
+  uint32_t _instId;                      //!< Instruction id.
+  uint8_t _archType;                     //!< Architecture type.
+  uint8_t _size;                         //!< Size of the encoded instruction.
+  uint8_t _dispOffset;                   //!< Offset of the displacement.
+  uint8_t _dispSize;                     //!< Size of the displacement (0 if none).
+  uint8_t _dispShift;                    //!< Displacement scale (disp8*N).
+  uint8_t _immOffset;                    //!< Offset of the immediate.
+  uint8_t _immSize;                      //!< Size of the immediate (0 if none).
+  uint8_t _reserved;                     //!< \internal
+};
+
+//! \}
+
+} // asmjit namespace
+
+// [Api-End]
+#include "../asmjit_apiend.h"
+
+// [Guard]
+#endif // _ASMJIT_X86_X86TEMPLATE_H
@@ -0,0 +1,965 @@
+// [AsmJit]
+// Complete x86/x64 JIT and Remote Assembler for C++.
+//
+// [License]
+// Zlib - See LICENSE.md file in the package.
+
+// [Export]
+#define ASMJIT_EXPORTS
+
+// [Guard]
+#include "../asmjit_build.h"
+#if defined(ASMJIT_BUILD_X86) && !defined(ASMJIT_DISABLE_COMPILER)
+
+// [Dependencies]
+#include "../base/utils.h"
+#include "../x86/x86inst.h"
+#include "../x86/x86operand.h"
+#include "../x86/x86valuenumber.h"
+
+// [Api-Begin]
+#include "../asmjit_apibegin.h"
+
+namespace asmjit {
+
+// ============================================================================
+// [asmjit::X86ValueNumber - Helpers]
+// ============================================================================
+
+//! \internal
+//!
+//! Value of a block.
+struct X86VNValue {
+  enum Flags {
+    kFlagConst  = 0x01U,                 //!< Value is a constant `imm`.
+    kFlagZext   = 0x02U                  //!< Upper 32 bits of the value are zero.
+  };
+
+  uint64_t imm;                          //!< Constant, if `kFlagConst` is set.
+  uint32_t flags;                        //!< Flags, see \ref Flags.
+  uint32_t holder;                       //!< Virtual register that was assigned the value last.
+};
+
+//! \internal
+//!
+//! Expression that computes a value, `a`, `b`, and `c` are value numbers or
+//! parts of a memory address, depending on `op`.
+struct X86VNExpr {
+  uint32_t op;                           //!< Instruction id, size, and kind.
+  uint32_t a;                            //!< First operand.
+  uint32_t b;                            //!< Second operand.
+  uint32_t c;                            //!< Third operand.
+  uint64_t imm;                          //!< Immediate or address offset.
+  uint32_t vn;                           //!< Value number.
+};
+
+// Parts of `X86VNExpr::op`.
+enum {
+  kX86VNExprSizeShift = 16,              // Operation size.
+  kX86VNExprImm       = 0x01000000U,     // Second operand is `imm`.
+  kX86VNExprMem       = 0x02000000U,     // Content of memory, forgotten by stores.
+  kX86VNExprConst     = 0x0000FFFEU,     // Constant `imm`.
+  kX86VNExprZext      = 0x0000FFFDU      // Zero extension of `a` from 32 bits.
+};
+
+//! \internal
+//!
+//! State of the pass, all values of a block are numbered from `firstVN`.
+struct X86VNState {
+  CodeCompiler* cc;                      //!< Compiler.
+  uint32_t* regVN;                       //!< Value number of each virtual register.
+  X86VNValue* values;                    //!< Values of the block.
+  X86VNExpr* exprs;                      //!< Expressions of the block.
+  uint32_t firstVN;                      //!< First value number of the block.
+  uint32_t nextVN;                       //!< Next value number.
+  uint32_t exprCount;                    //!< Count of expressions.
+  uint32_t gpSize;                       //!< Size of a general purpose register.
+};
+
+static const uint32_t X86ValueNumber_kArithFlags =
+  x86::kSpecialReg_FLAGS_CF | x86::kSpecialReg_FLAGS_PF |
+  x86::kSpecialReg_FLAGS_AF | x86::kSpecialReg_FLAGS_ZF |
+  x86::kSpecialReg_FLAGS_SF | x86::kSpecialReg_FLAGS_OF;
+
+static ASMJIT_INLINE void X86ValueNumber_resetBlock(X86VNState& s) noexcept {
+  s.firstVN = s.nextVN;
+  s.exprCount = 0;
+}
+
+static ASMJIT_INLINE X86VNValue& X86ValueNumber_getValue(X86VNState& s, uint32_t vn) noexcept {
+  ASMJIT_ASSERT(vn >= s.firstVN && vn < s.nextVN);
+  return s.values[vn - s.firstVN];
+}
+
+static ASMJIT_INLINE uint32_t X86ValueNumber_newValue(X86VNState& s, uint32_t flags, uint64_t imm) noexcept {
+  uint32_t vn = s.nextVN++;
+  X86VNValue& v = X86ValueNumber_getValue(s, vn);
+
+  v.imm = imm;
+  v.flags = flags;
+  v.holder = kInvalidValue;
+  return vn;
+}
+
+//! \internal
+//!
+//! Get the id of `op` if it's a 32-bit or 64-bit general purpose virtual
+//! register, `kInvalidValue` otherwise.
+static ASMJIT_INLINE uint32_t X86ValueNumber_getReg(const X86VNState& s, const Operand_& op) noexcept {
+  if (!X86Reg::isGpd(op) && !X86Reg::isGpq(op))
+    return kInvalidValue;
+
+  uint32_t id = op.getId();
+  if (!s.cc->isVirtRegValid(id) || s.cc->getVirtRegById(id)->isFixed())
+    return kInvalidValue;
+  return id;
+}
+
+//! \internal
+//!
+//! Get the value of the virtual register `id`, a register that was not
+//! assigned in the block gets a new value.
+static uint32_t X86ValueNumber_getRegValue(X86VNState& s, uint32_t id) noexcept {
+  uint32_t& vn = s.regVN[Operand::unpackId(id)];
+  if (vn < s.firstVN) {
+    vn = X86ValueNumber_newValue(s, 0, 0);
+    X86ValueNumber_getValue(s, vn).holder = id;
+  }
+  return vn;
+}
+
+static void X86ValueNumber_setRegValue(X86VNState& s, uint32_t id, uint32_t vn) noexcept {
+  s.regVN[Operand::unpackId(id)] = vn;
+
+  X86VNValue& v = X86ValueNumber_getValue(s, vn);
+  if (v.holder == kInvalidValue || s.regVN[Operand::unpackId(v.holder)] != vn)
+    v.holder = id;
+}
+
+//! \internal
+//!
+//! Get a virtual register of at least `size` bytes that holds `vn`, or
+//! `kInvalidValue`.
+static uint32_t X86ValueNumber_getHolder(X86VNState& s, uint32_t vn, uint32_t size) noexcept {
+  uint32_t id = X86ValueNumber_getValue(s, vn).holder;
+  if (id == kInvalidValue || s.regVN[Operand::unpackId(id)] != vn || s.cc->getVirtRegById(id)->getSize() < size)
+    return kInvalidValue;
+  return id;
+}
+
+static X86VNExpr* X86ValueNumber_findExpr(X86VNState& s, uint32_t op, uint32_t a, uint32_t b, uint32_t c, uint64_t imm) noexcept {
+  X86VNExpr* exprs = s.exprs;
+  for (uint32_t i = 0, count = s.exprCount; i < count; i++) {
+    X86VNExpr* e = &exprs[i];
+    if (e->op == op && e->a == a && e->b == b && e->c == c && e->imm == imm)
+      return e;
+  }
+  return nullptr;
+}
+
+static void X86ValueNumber_addExpr(X86VNState& s, uint32_t op, uint32_t a, uint32_t b, uint32_t c, uint64_t imm, uint32_t vn) noexcept {
+  // Expressions that don't fit are not remembered.
+  if (s.exprCount >= X86ValueNumberPass::kMaxExprs)
+    return;
+
+  X86VNExpr* e = &s.exprs[s.exprCount++];
+  e->op = op;
+  e->a = a;
+  e->b = b;
+  e->c = c;
+  e->imm = imm;
+  e->vn = vn;
+}
+
+//! \internal
+//!
+//! Get the value of an expression, it's a new value if the expression was not
+//! computed in the block yet.
+static uint32_t X86ValueNumber_getExprValue(X86VNState& s, uint32_t op, uint32_t a, uint32_t b, uint32_t c, uint64_t imm, uint32_t flags) noexcept {
+  X86VNExpr* e = X86ValueNumber_findExpr(s, op, a, b, c, imm);
+  if (e)
+    return e->vn;
+
+  uint32_t vn = X86ValueNumber_newValue(s, flags, 0);
+  X86ValueNumber_addExpr(s, op, a, b, c, imm, vn);
+  return vn;
+}
+
+static uint32_t X86ValueNumber_getConstValue(X86VNState& s, uint64_t imm) noexcept {
+  X86VNExpr* e = X86ValueNumber_findExpr(s, kX86VNExprConst, 0, 0, 0, imm);
+  if (e)
+    return e->vn;
+
+  uint32_t flags = X86VNValue::kFlagConst | ((imm >> 32) == 0 ? uint32_t(X86VNValue::kFlagZext) : uint32_t(0));
+  uint32_t vn = X86ValueNumber_newValue(s, flags, imm);
+  X86ValueNumber_addExpr(s, kX86VNExprConst, 0, 0, 0, imm, vn);
+  return vn;
+}
+
+//! \internal
+//!
+//! Get the value of a 32-bit read of `vn` written to a 32-bit register, which
+//! clears the upper half of the register in 64-bit mode.
+static uint32_t X86ValueNumber_getZextValue(X86VNState& s, uint32_t vn) noexcept {
+  const X86VNValue& v = X86ValueNumber_getValue(s, vn);
+  if (s.gpSize == 4 || (v.flags & X86VNValue::kFlagZext))
+    return vn;
+
+  if (v.flags & X86VNValue::kFlagConst)
+    return X86ValueNumber_getConstValue(s, v.imm & 0xFFFFFFFFU);
+
+  return X86ValueNumber_getExprValue(s, kX86VNExprZext, vn, 0, 0, 0, X86VNValue::kFlagZext);
+}
+
+static void X86ValueNumber_killMemory(X86VNState& s) noexcept {
+  X86VNExpr* exprs = s.exprs;
+  uint32_t count = s.exprCount;
+  uint32_t n = 0;
+
+  for (uint32_t i = 0; i < count; i++)
+    if (!(exprs[i].op & kX86VNExprMem))
+      exprs[n++] = exprs[i];
+  s.exprCount = n;
+}
+
+//! \internal
+//!
+//! Get if `value` of an operation of `size` bytes can be an immediate operand.
+static ASMJIT_INLINE bool X86ValueNumber_fitsImm(uint32_t size, uint64_t value) noexcept {
+  return size == 4 || Utils::isInt32(static_cast<int64_t>(value));
+}
+
+static ASMJIT_INLINE Imm X86ValueNumber_toImm(uint32_t size, uint64_t value) noexcept {
+  return size == 4 ? Imm(static_cast<int32_t>(static_cast<uint32_t>(value)))
+                   : Imm(static_cast<int64_t>(value));
+}
+
+//! \internal
+//!
+//! Get a register of the same type as `op`, but with `id`.
+static ASMJIT_INLINE X86Gp X86ValueNumber_regAs(const Operand_& op, uint32_t id) noexcept {
+  X86Gp reg(op.as<X86Gp>());
+  reg.setId(id);
+  return reg;
+}
+
+//! \internal
+//!
+//! Replace `node` by `mov dst, src`.
+static void X86ValueNumber_setMov(CBInst* node, const Operand_& dst, const Operand_& src) noexcept {
+  Operand* opArray = node->getOpArray();
+  uint32_t opCount = node->getOpCount();
+
+  node->setInstId(X86Inst::kIdMov);
+  opArray[0] = dst;
+  opArray[1] = src;
+
+  for (uint32_t i = 2; i < opCount; i++)
+    opArray[i].reset();
+
+  node->_opCount = 2;
+  node->_updateMemOp();
+}
+
+static void X86ValueNumber_removeNode(CodeBuilder* cb, CBNode* node) noexcept {
+  if (cb->getCursor() == node)
+    cb->_setCursor(node->getPrev());
+  cb->removeNode(node);
+}
+
+//! \internal
+//!
+//! Get if arithmetic flags written by `node` are overwritten before they are
+//! read, flags are considered live at the end of a block.
+static bool X86ValueNumber_isFlagsDead(const CBNode* node) noexcept {
+  uint32_t flags = X86ValueNumber_kArithFlags;
+  node = node->getNext();
+
+  for (uint32_t i = 0; node && i < X86ValueNumberPass::kMaxLookAhead; node = node->getNext(), i++) {
+    switch (node->getType()) {
+      case CBNode::kNodeComment:
+        continue;
+
+      // Flags are not preserved by calls and returns.
+      case CBNode::kNodeFuncCall:
+      case CBNode::kNodeFuncExit:
+        return true;
+
+      case CBNode::kNodeInst: {
+        const X86Inst& inst = X86Inst::getInst(static_cast<const CBInst*>(node)->getInstId());
+        const X86Inst::OperationData& operationData = inst.getOperationData();
+
+        if (operationData.getSpecialRegsR() & flags)
+          return false;
+
+        flags &= ~operationData.getSpecialRegsW();
+        if (!flags)
+          return true;
+
+        if (node->isJmpOrJcc() || inst.getCommonData().doesJump())
+          return false;
+        continue;
+      }
+
+      default:
+        return false;
+    }
+  }
+
+  return false;
+}
+
+//! \internal
+//!
+//! Fold an index register that holds a constant into the offset of `m`.
+static bool X86ValueNumber_foldIndex(X86VNState& s, X86Mem& m) noexcept {
+  uint32_t gpType = s.gpSize == 8 ? X86Reg::kRegGpq : X86Reg::kRegGpd;
+  if (!m.hasBaseReg() || !m.hasIndexReg() || m.getIndexType() != gpType)
+    return false;
+
+  uint32_t id = m.getIndexId();
+  if (!s.cc->isVirtRegValid(id) || s.cc->getVirtRegById(id)->isFixed())
+    return false;
+
+  uint32_t vn = s.regVN[Operand::unpackId(id)];
+  if (vn < s.firstVN || !(X86ValueNumber_getValue(s, vn).flags & X86VNValue::kFlagConst))
+    return false;
+
+  int64_t offset = m.getOffset() + static_cast<int64_t>(X86ValueNumber_getValue(s, vn).imm << m.getShift());
+  if (!Utils::isInt32(offset))
+    return false;
+
+  m.resetIndex();
+  m.resetShift();
+  m.setOffsetLo32(static_cast<int32_t>(offset));
+  return true;
+}
+
+//! \internal
+//!
+//! Get the key of the address of `m`, returns false if the address can't be
+//! numbered.
+static bool X86ValueNumber_getMemKey(X86VNState& s, const X86Mem& m, uint32_t& a, uint32_t& b, uint32_t& c) noexcept {
+  // Home slots of virtual registers are managed by the register allocator.
+  if (m.isRegHome() || m.isArgHome())
+    return false;
+
+  a = 0;
+  b = 0;
+
+  if (m.hasBaseReg()) {
+    uint32_t id = m.getBaseId();
+    if (!s.cc->isVirtRegValid(id) || s.cc->getVirtRegById(id)->isFixed())
+      return false;
+    a = X86ValueNumber_getRegValue(s, id);
+  }
+  else if (m.hasBaseLabel()) {
+    a = m.getBaseId();
+  }
+
+  if (m.hasIndex()) {
+    uint32_t id = m.getIndexId();
+    if (!m.hasIndexReg() || !s.cc->isVirtRegValid(id) || s.cc->getVirtRegById(id)->isFixed())
+      return false;
+    b = X86ValueNumber_getRegValue(s, id);
+  }
+
+  c = m.getShift() | (m.getSegmentId() << 2) | (m.getAddrType() << 5) | (m.getBaseType() << 7) | (m.getIndexType() << 12);
+  return true;
+}
+
+//! \internal
+//!
+//! Compute `a op b` of `size` bytes.
+static uint64_t X86ValueNumber_fold(uint32_t instId, uint32_t size, uint64_t a, uint64_t b) noexcept {
+  uint32_t shift = static_cast<uint32_t>(b) & (size == 8 ? 63 : 31);
+  uint64_t x = 0;
+
+  switch (instId) {
+    case X86Inst::kIdAdd : x = a + b; break;
+    case X86Inst::kIdSub : x = a - b; break;
+    case X86Inst::kIdAnd : x = a & b; break;
+    case X86Inst::kIdOr  : x = a | b; break;
+    case X86Inst::kIdXor : x = a ^ b; break;
+    case X86Inst::kIdImul: x = a * b; break;
+    case X86Inst::kIdShl : x = a << shift; break;
+    case X86Inst::kIdShr : x = (size == 8 ? a : (a & 0xFFFFFFFFU)) >> shift; break;
+    case X86Inst::kIdSar : x = size == 8 ? static_cast<uint64_t>(static_cast<int64_t>(a) >> shift)
+                                         : static_cast<uint64_t>(static_cast<uint32_t>(static_cast<int32_t>(static_cast<uint32_t>(a)) >> shift)); break;
+    case X86Inst::kIdNeg : x = 0 - a; break;
+    case X86Inst::kIdNot : x = ~a; break;
+  }
+
+  return size == 4 ? x & 0xFFFFFFFFU : x;
+}
+
+//! \internal
+//!
+//! Get if an instruction doesn't write memory and registers other than its
+//! first operand, unless the first operand is memory.
+static bool X86ValueNumber_isMemorySafe(const CBInst* node) noexcept {
+  uint32_t instId = node->getInstId();
+  uint32_t opCount = node->getOpCount();
+
+  if ((opCount && node->getOpArray()[0].isMem()) ||
+      (node->getOptions() & (X86Inst::kOptionLock | X86Inst::kOptionRep | X86Inst::kOptionRepnz)))
+    return false;
+
+  if ((instId >= X86Inst::kIdCmova && instId <= X86Inst::kIdCmovz) ||
+      (instId >= X86Inst::kIdSeta  && instId <= X86Inst::kIdSetz ))
+    return true;
+
+  switch (instId) {
+    case X86Inst::kIdAdc:
+    case X86Inst::kIdAdd:
+    case X86Inst::kIdAnd:
+    case X86Inst::kIdAndn:
+    case X86Inst::kIdBsf:
+    case X86Inst::kIdBsr:
+    case X86Inst::kIdBswap:
+    case X86Inst::kIdBt:
+    case X86Inst::kIdCmp:
+    case X86Inst::kIdDec:
+    case X86Inst::kIdImul:
+    case X86Inst::kIdInc:
+    case X86Inst::kIdLea:
+    case X86Inst::kIdLzcnt:
+    case X86Inst::kIdMov:
+    case X86Inst::kIdMovsx:
+    case X86Inst::kIdMovsxd:
+    case X86Inst::kIdMovzx:
+    case X86Inst::kIdNeg:
+    case X86Inst::kIdNot:
+    case X86Inst::kIdOr:
+    case X86Inst::kIdPopcnt:
+    case X86Inst::kIdRol:
+    case X86Inst::kIdRor:
+    case X86Inst::kIdSar:
+    case X86Inst::kIdSbb:
+    case X86Inst::kIdShl:
+    case X86Inst::kIdShr:
+    case X86Inst::kIdSub:
+    case X86Inst::kIdTest:
+    case X86Inst::kIdTzcnt:
+    case X86Inst::kIdXor:
+      return true;
+  }
+
+  // SIMD instructions write memory only through their first operand.
+  const X86Inst::CommonData& commonData = X86Inst::getInst(instId).getCommonData();
+  return commonData.hasFlag(X86Inst::kFlagVec) &&
+         !commonData.hasFlag(X86Inst::kFlagUseA | X86Inst::kFlagFixedRM | X86Inst::kFlagVsib | X86Inst::kFlagFpu);
+}
+
+//! \internal
+//!
+//! Forget values of all virtual registers used by `node`.
+static void X86ValueNumber_invalidate(X86VNState& s, CBInst* node) noexcept {
+  const Operand* opArray = node->getOpArray();
+  uint32_t opCount = node->getOpCount();
+
+  for (uint32_t i = 0; i < opCount; i++) {
+    const Operand& op = opArray[i];
+    if (op.isReg() && s.cc->isVirtRegValid(op.getId()))
+      s.regVN[Operand::unpackId(op.getId())] = 0;
+  }
+
+  if (node->hasExtraReg() && s.cc->isVirtRegValid(node->getExtraReg().getId()))
+    s.regVN[Operand::unpackId(node->getExtraReg().getId())] = 0;
+
+  if (!X86ValueNumber_isMemorySafe(node))
+    X86ValueNumber_killMemory(s);
+}
+
+//! \internal
+//!
+//! Assign `result` computed by `node` to `dId`. The node is removed if `dId`
+//! already holds `result`, and replaced by `mov` of a constant or of another
+//! register that holds it, if flags it writes are dead.
+static void X86ValueNumber_setResult(X86ValueNumberPass* self, X86VNState& s, CBInst* node, uint32_t dId, uint32_t result, bool writesFlags) noexcept {
+  const Operand& o0 = node->getOpArray()[0];
+  uint32_t size = o0.getSize();
+
+  if (!writesFlags || X86ValueNumber_isFlagsDead(node)) {
+    if (s.regVN[Operand::unpackId(dId)] == result) {
+      X86ValueNumber_removeNode(self->_cb, node);
+      self->_removedCount++;
+      return;
+    }
+
+    const X86VNValue& v = X86ValueNumber_getValue(s, result);
+    uint32_t holder = X86ValueNumber_getHolder(s, result, size);
+
+    // A 64-bit constant that doesn't fit into imm32 is cheaper to copy.
+    if ((v.flags & X86VNValue::kFlagConst) && (holder == kInvalidValue || X86ValueNumber_fitsImm(size, v.imm))) {
+      Operand dst(o0);
+      X86ValueNumber_setMov(node, dst, X86ValueNumber_toImm(size, v.imm));
+      self->_foldedCount++;
+    }
+    else if (holder != kInvalidValue) {
+      Operand dst(o0);
+      X86ValueNumber_setMov(node, dst, X86ValueNumber_regAs(dst, holder));
+      self->_reusedCount++;
+    }
+  }
+
+  X86ValueNumber_setRegValue(s, dId, result);
+}
+
+// ============================================================================
+// [asmjit::X86ValueNumber - Instructions]
+// ============================================================================
+
+static bool X86ValueNumber_mov(X86ValueNumberPass* self, X86VNState& s, CBInst* node) noexcept {
+  if (node->getOpCount() != 2)
+    return false;
+
+  Operand* opArray = node->getOpArray();
+  Operand& o0 = opArray[0];
+  Operand& o1 = opArray[1];
+
+  // Store.
+  if (o0.isMem()) {
+    X86Mem& m = o0.as<X86Mem>();
+    uint32_t size;
+    uint32_t vn;
+
+    if (o1.isReg()) {
+      uint32_t sId = X86ValueNumber_getReg(s, o1);
+      if (sId == kInvalidValue)
+        return false;
+
+      size = o1.getSize();
+      vn = X86ValueNumber_getRegValue(s, sId);
+      if (size == 4)
+        vn = X86ValueNumber_getZextValue(s, vn);
+
+      const X86VNValue& v = X86ValueNumber_getValue(s, vn);
+      if ((v.flags & X86VNValue::kFlagConst) && X86ValueNumber_fitsImm(size, v.imm)) {
+        m.setSize(size);
+        o1 = X86ValueNumber_toImm(size, v.imm);
+        self->_propagatedCount++;
+      }
+    }
+    else if (o1.isImm()) {
+      size = m.getSize();
+      if (size != 4 && size != 8)
+        return false;
+
+      uint64_t imm = o1.as<Imm>().getUInt64();
+      vn = X86ValueNumber_getConstValue(s, size == 4 ? imm & 0xFFFFFFFFU : imm);
+    }
+    else {
+      return false;
+    }
+
+    if (X86ValueNumber_foldIndex(s, m))
+      self->_propagatedCount++;
+
+    uint32_t a, b, c;
+    X86ValueNumber_killMemory(s);
+
+    if (X86ValueNumber_getMemKey(s, m, a, b, c))
+      X86ValueNumber_addExpr(s, X86Inst::kIdMov | (size << kX86VNExprSizeShift) | kX86VNExprMem, a, b, c, static_cast<uint64_t>(m.getOffset()), vn);
+    return true;
+  }
+
+  uint32_t dId = X86ValueNumber_getReg(s, o0);
+  if (dId == kInvalidValue)
+    return false;
+
+  uint32_t size = o0.getSize();
+  uint32_t result;
+
+  if (o1.isReg()) {
+    // Copy, a copy of a constant becomes an immediate, so the source doesn't
+    // have to stay alive.
+    uint32_t sId = X86ValueNumber_getReg(s, o1);
+    if (sId == kInvalidValue)
+      return false;
+
+    result = X86ValueNumber_getRegValue(s, sId);
+    if (size == 4)
+      result = X86ValueNumber_getZextValue(s, result);
+
+    const X86VNValue& v = X86ValueNumber_getValue(s, result);
+    if ((v.flags & X86VNValue::kFlagConst) && X86ValueNumber_fitsImm(size, v.imm)) {
+      o1 = X86ValueNumber_toImm(size, v.imm);
+      self->_propagatedCount++;
+    }
+  }
+  else if (o1.isImm()) {
+    uint64_t imm = o1.as<Imm>().getUInt64();
+    result = X86ValueNumber_getConstValue(s, size == 4 ? imm & 0xFFFFFFFFU : imm);
+
+    if (!X86ValueNumber_fitsImm(size, imm) && s.regVN[Operand::unpackId(dId)] != result) {
+      uint32_t holder = X86ValueNumber_getHolder(s, result, size);
+      if (holder != kInvalidValue) {
+        o1 = X86ValueNumber_regAs(o0, holder);
+        self->_reusedCount++;
+      }
+    }
+  }
+  else if (o1.isMem()) {
+    // Load.
+    X86Mem& m = o1.as<X86Mem>();
+    if (X86ValueNumber_foldIndex(s, m))
+      self->_propagatedCount++;
+
+    uint32_t op = X86Inst::kIdMov | (size << kX86VNExprSizeShift) | kX86VNExprMem;
+    uint32_t a, b, c;
+    uint64_t offset = static_cast<uint64_t>(m.getOffset());
+    X86VNExpr* e = nullptr;
+
+    bool hasKey = X86ValueNumber_getMemKey(s, m, a, b, c);
+    if (hasKey)
+      e = X86ValueNumber_findExpr(s, op, a, b, c, offset);
+
+    if (e) {
+      result = e->vn;
+      if (s.regVN[Operand::unpackId(dId)] != result) {
+        const X86VNValue& v = X86ValueNumber_getValue(s, result);
+        uint32_t holder = X86ValueNumber_getHolder(s, result, size);
+
+        if (holder != kInvalidValue) {
+          Operand dst(o0);
+          X86ValueNumber_setMov(node, dst, X86ValueNumber_regAs(dst, holder));
+          self->_forwardedCount++;
+        }
+        else if ((v.flags & X86VNValue::kFlagConst) && X86ValueNumber_fitsImm(size, v.imm)) {
+          Operand dst(o0);
+          X86ValueNumber_setMov(node, dst, X86ValueNumber_toImm(size, v.imm));
+          self->_forwardedCount++;
+        }
+      }
+    }
+    else {
+      result = X86ValueNumber_newValue(s, size == 4 ? uint32_t(X86VNValue::kFlagZext) : uint32_t(0), 0);
+      if (hasKey)
+        X86ValueNumber_addExpr(s, op, a, b, c, offset, result);
+    }
+  }
+  else {
+    return false;
+  }
+
+  // The destination already holds the value.
+  if (s.regVN[Operand::unpackId(dId)] == result) {
+    X86ValueNumber_removeNode(self->_cb, node);
+    self->_removedCount++;
+    return true;
+  }
+
+  X86ValueNumber_setRegValue(s, dId, result);
+  return true;
+}
+
+static bool X86ValueNumber_lea(X86ValueNumberPass* self, X86VNState& s, CBInst* node) noexcept {
+  Operand* opArray = node->getOpArray();
+  if (node->getOpCount() != 2 || !opArray[1].isMem())
+    return false;
+
+  uint32_t dId = X86ValueNumber_getReg(s, opArray[0]);
+  if (dId == kInvalidValue)
+    return false;
+
+  X86Mem& m = opArray[1].as<X86Mem>();
+  if (X86ValueNumber_foldIndex(s, m))
+    self->_propagatedCount++;
+
+  uint32_t a, b, c;
+  if (!X86ValueNumber_getMemKey(s, m, a, b, c))
+    return false;
+
+  uint32_t size = opArray[0].getSize();
+  uint32_t gpType = s.gpSize == 8 ? X86Reg::kRegGpq : X86Reg::kRegGpd;
+  uint32_t result;
+
+  // Address of constants, registers must be of the address size.
+  bool isConst = !m.hasBaseLabel() &&
+                 (!m.hasBase() || (m.getBaseType() == gpType && (X86ValueNumber_getValue(s, a).flags & X86VNValue::kFlagConst))) &&
+                 (!m.hasIndex() || (m.getIndexType() == gpType && (X86ValueNumber_getValue(s, b).flags & X86VNValue::kFlagConst)));
+
+  if (isConst) {
+    uint64_t value = static_cast<uint64_t>(m.getOffset());
+    if (m.hasBase()) value += X86ValueNumber_getValue(s, a).imm;
+    if (m.hasIndex()) value += X86ValueNumber_getValue(s, b).imm << m.getShift();
+    result = X86ValueNumber_getConstValue(s, size == 4 ? value & 0xFFFFFFFFU : value);
+  }
+  else {
+    uint32_t flags = size == 4 ? uint32_t(X86VNValue::kFlagZext) : uint32_t(0);
+    result = X86ValueNumber_getExprValue(s, X86Inst::kIdLea | (size << kX86VNExprSizeShift), a, b, c, static_cast<uint64_t>(m.getOffset()), flags);
+  }
+
+  X86ValueNumber_setResult(self, s, node, dId, result, false);
+  return true;
+}
+
+static bool X86ValueNumber_arith(X86ValueNumberPass* self, X86VNState& s, CBInst* node) noexcept {
+  uint32_t instId = node->getInstId();
+  uint32_t opCount = node->getOpCount();
+  Operand* opArray = node->getOpArray();
+
+  uint32_t dId = X86ValueNumber_getReg(s, opArray[0]);
+  if (!opCount || dId == kInvalidValue)
+    return false;
+
+  uint32_t size = opArray[0].getSize();
+  uint32_t srcIndex = 1;
+  uint32_t va;
+
+  if (instId == X86Inst::kIdNeg || instId == X86Inst::kIdNot) {
+    if (opCount != 1)
+      return false;
+    va = X86ValueNumber_getRegValue(s, dId);
+    srcIndex = 0;
+  }
+  else if (instId == X86Inst::kIdImul && opCount == 3) {
+    // `imul d, s, imm` computes the same value as `imul d, imm` from `s`.
+    uint32_t sId = X86ValueNumber_getReg(s, opArray[1]);
+    if (sId == kInvalidValue || !opArray[2].isImm())
+      return false;
+    va = X86ValueNumber_getRegValue(s, sId);
+    srcIndex = 2;
+  }
+  else {
+    if (opCount != 2)
+      return false;
+    va = X86ValueNumber_getRegValue(s, dId);
+  }
+
+  bool isShift = instId == X86Inst::kIdShl || instId == X86Inst::kIdShr || instId == X86Inst::kIdSar;
+  bool hasImm = false;
+  uint32_t vb = 0;
+  uint64_t imm = 0;
+
+  if (srcIndex) {
+    Operand& src = opArray[srcIndex];
+
+    if (src.isImm()) {
+      // The immediate is sign-extended to 64 bits, shift counts are masked.
+      int64_t value = src.as<Imm>().getInt64();
+      imm = isShift ? static_cast<uint64_t>(value & 0xFF) :
+            size == 4 ? static_cast<uint64_t>(static_cast<uint32_t>(value)) :
+                        static_cast<uint64_t>(static_cast<int64_t>(static_cast<int32_t>(value)));
+      hasImm = true;
+    }
+    else {
+      // Shift counts are in `cl`, which is not numbered.
+      uint32_t sId = X86ValueNumber_getReg(s, src);
+      if (sId == kInvalidValue || isShift)
+        return false;
+
+      vb = X86ValueNumber_getRegValue(s, sId);
+      const X86VNValue& v = X86ValueNumber_getValue(s, vb);
+
+      if ((v.flags & X86VNValue::kFlagConst) && X86ValueNumber_fitsImm(size, v.imm)) {
+        src = X86ValueNumber_toImm(size, v.imm);
+        imm = size == 4 ? v.imm & 0xFFFFFFFFU : v.imm;
+        hasImm = true;
+        vb = 0;
+        self->_propagatedCount++;
+      }
+    }
+  }
+
+  const X86VNValue& av = X86ValueNumber_getValue(s, va);
+  bool bConst = !srcIndex || hasImm;
+  uint64_t bImm = hasImm ? imm : uint64_t(0);
+  uint64_t ones = size == 4 ? uint64_t(0xFFFFFFFFU) : ~uint64_t(0);
+  uint32_t mask = size == 8 ? 63 : 31;
+  uint32_t result;
+
+  if ((av.flags & X86VNValue::kFlagConst) && bConst) {
+    result = X86ValueNumber_getConstValue(s, X86ValueNumber_fold(instId, size, av.imm, bImm));
+  }
+  else if (hasImm && ((bImm == 0 && (instId == X86Inst::kIdAdd || instId == X86Inst::kIdSub ||
+                                     instId == X86Inst::kIdOr  || instId == X86Inst::kIdXor)) ||
+                      (isShift && (bImm & mask) == 0) ||
+                      (bImm == ones && instId == X86Inst::kIdAnd) ||
+                      (bImm == 1 && instId == X86Inst::kIdImul))) {
+    // Identity.
+    result = size == 4 ? X86ValueNumber_getZextValue(s, va) : va;
+  }
+  else if (srcIndex && !hasImm && va == vb && (instId == X86Inst::kIdSub || instId == X86Inst::kIdXor)) {
+    result = X86ValueNumber_getConstValue(s, 0);
+  }
+  else if (srcIndex && !hasImm && va == vb && (instId == X86Inst::kIdAnd || instId == X86Inst::kIdOr)) {
+    result = size == 4 ? X86ValueNumber_getZextValue(s, va) : va;
+  }
+  else {
+    uint32_t a = va;
+    uint32_t b = vb;
+
+    bool isCommutative = instId == X86Inst::kIdAdd || instId == X86Inst::kIdAnd ||
+                         instId == X86Inst::kIdOr  || instId == X86Inst::kIdXor ||
+                         instId == X86Inst::kIdImul;
+    if (isCommutative && !hasImm && a > b)
+      std::swap(a, b);
+
+    uint32_t op = instId | (size << kX86VNExprSizeShift) | (hasImm ? uint32_t(kX86VNExprImm) : uint32_t(0));
+    uint32_t flags = size == 4 ? uint32_t(X86VNValue::kFlagZext) : uint32_t(0);
+    result = X86ValueNumber_getExprValue(s, op, a, b, 0, bImm, flags);
+  }
+
+  X86ValueNumber_setResult(self, s, node, dId, result, instId != X86Inst::kIdNot);
+  return true;
+}
+
+static bool X86ValueNumber_compare(X86ValueNumberPass* self, X86VNState& s, CBInst* node) noexcept {
+  // Compares don't write registers or memory.
+  Operand* opArray = node->getOpArray();
+  if (node->getOpCount() != 2 || !opArray[0].isReg() || !opArray[1].isReg())
+    return true;
+
+  uint32_t sId = X86ValueNumber_getReg(s, opArray[1]);
+  if (sId == kInvalidValue || X86ValueNumber_getReg(s, opArray[0]) == kInvalidValue)
+    return true;
+
+  uint32_t size = opArray[1].getSize();
+  uint32_t vn = X86ValueNumber_getRegValue(s, sId);
+  const X86VNValue& v = X86ValueNumber_getValue(s, vn);
+
+  if ((v.flags & X86VNValue::kFlagConst) && X86ValueNumber_fitsImm(size, v.imm)) {
+    opArray[1] = X86ValueNumber_toImm(size, v.imm);
+    self->_propagatedCount++;
+  }
+  return true;
+}
+
+static void X86ValueNumber_processInst(X86ValueNumberPass* self, X86VNState& s, CBInst* node) noexcept {
+  // An instruction creates at most a few values, start a new block before
+  // they don't fit.
+  if (s.nextVN - s.firstVN > X86ValueNumberPass::kMaxValues - 8)
+    X86ValueNumber_resetBlock(s);
+
+  // Operands of patchable instructions change after the pass, their results
+  // are unknown values.
+  if (!node->hasExtraReg() && !node->hasFlag(CBNode::kFlagIsPatchable) && !(node->getOptions() & (X86Inst::kOptionLock | X86Inst::kOptionRep | X86Inst::kOptionRepnz))) {
+    bool handled = false;
+
+    switch (node->getInstId()) {
+      case X86Inst::kIdMov:
+        handled = X86ValueNumber_mov(self, s, node);
+        break;
+
+      case X86Inst::kIdLea:
+        handled = X86ValueNumber_lea(self, s, node);
+        break;
+
+      case X86Inst::kIdAdd:
+      case X86Inst::kIdSub:
+      case X86Inst::kIdAnd:
+      case X86Inst::kIdOr:
+      case X86Inst::kIdXor:
+      case X86Inst::kIdImul:
+      case X86Inst::kIdShl:
+      case X86Inst::kIdShr:
+      case X86Inst::kIdSar:
+      case X86Inst::kIdNeg:
+      case X86Inst::kIdNot:
+        handled = X86ValueNumber_arith(self, s, node);
+        break;
+
+      case X86Inst::kIdCmp:
+      case X86Inst::kIdTest:
+        handled = X86ValueNumber_compare(self, s, node);
+        break;
+    }
+
+    if (handled)
+      return;
+  }
+
+  X86ValueNumber_invalidate(s, node);
+}
+
+// ============================================================================
+// [asmjit::X86ValueNumberPass - Construction / Destruction]
+// ============================================================================
+
+X86ValueNumberPass::X86ValueNumberPass() noexcept
+  : CBPass("ValueNumber"),
+    _foldedCount(0),
+    _propagatedCount(0),
+    _reusedCount(0),
+    _forwardedCount(0),
+    _removedCount(0) {}
+X86ValueNumberPass::~X86ValueNumberPass() noexcept {}
+
+// ============================================================================
+// [asmjit::X86ValueNumberPass - Process]
+// ============================================================================
+
+Error X86ValueNumberPass::process(Zone* zone) noexcept {
+  CodeBuilder* cb = _cb;
+
+  _foldedCount = 0;
+  _propagatedCount = 0;
+  _reusedCount = 0;
+  _forwardedCount = 0;
+  _removedCount = 0;
+
+  // Without virtual registers there is nothing to number.
+  if (!cb->isCodeCompiler())
+    return kErrorOk;
+
+  CodeCompiler* cc = static_cast<CodeCompiler*>(cb);
+  size_t regCount = cc->getVirtRegArray().getLength();
+  if (!regCount)
+    return kErrorOk;
+
+  X86VNState s;
+  s.cc = cc;
+  s.regVN = static_cast<uint32_t*>(zone->allocZeroed(regCount * sizeof(uint32_t)));
+  s.values = zone->allocT<X86VNValue>(kMaxValues * sizeof(X86VNValue));
+  s.exprs = zone->allocT<X86VNExpr>(kMaxExprs * sizeof(X86VNExpr));
+  s.firstVN = 1;
+  s.nextVN = 1;
+  s.exprCount = 0;
+  s.gpSize = cc->getGpSize();
+
+  if (ASMJIT_UNLIKELY(!s.regVN || !s.values || !s.exprs))
+    return DebugUtils::errored(kErrorNoHeapMemory);
+
+  CBNode* node = cb->getFirstNode();
+  while (node) {
+    CBNode* next = node->getNext();
+
+    switch (node->getType()) {
+      case CBNode::kNodeInst: {
+        uint32_t instId = static_cast<CBInst*>(node)->getInstId();
+
+        // The fall-through of a conditional jump continues the block, other
+        // jumps end it.
+        if (node->isJmpOrJcc()) {
+          if (!node->isJcc() || instId < X86Inst::kIdJa || instId > X86Inst::kIdJz || instId == X86Inst::kIdJmp)
+            X86ValueNumber_resetBlock(s);
+        }
+        else {
+          X86ValueNumber_processInst(this, s, static_cast<CBInst*>(node));
+        }
+        break;
+      }
+
+      case CBNode::kNodeComment:
+        break;
+
+      default:
+        X86ValueNumber_resetBlock(s);
+        break;
+    }
+
+    node = next;
+  }
+
+  return kErrorOk;
+}
+
+} // asmjit namespace
+
+// [Api-End]
+#include "../asmjit_apiend.h"
+
+// [Guard]
+#endif // ASMJIT_BUILD_X86 && !ASMJIT_DISABLE_COMPILER
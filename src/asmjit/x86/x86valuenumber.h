@@ -0,0 +1,127 @@
+// [AsmJit]
+// Complete x86/x64 JIT and Remote Assembler for C++.
+//
+// [License]
+// Zlib - See LICENSE.md file in the package.
+
+// [Guard]
+#ifndef _ASMJIT_X86_X86VALUENUMBER_H
+#define _ASMJIT_X86_X86VALUENUMBER_H
+
+#include "../asmjit_build.h"
+#if !defined(ASMJIT_DISABLE_COMPILER)
+
+// [Dependencies]
+#include "../base/codecompiler.h"
+
+// [Api-Begin]
+#include "../asmjit_apibegin.h"
+
+namespace asmjit {
+
+//! \addtogroup asmjit_x86
+//! \{
+
+// ============================================================================
+// [asmjit::X86ValueNumberPass]
+// ============================================================================
+
+//! Local value numbering pass.
+//!
+//! The pass gives a number to each value computed in a block, two virtual
+//! registers that hold the same number hold the same value. Values are
+//! numbered by the instruction and numbers of its operands, so repeated
+//! computations get the same number as the first one. Only 32-bit and 64-bit
+//! general purpose registers are numbered, and only by `mov`, `lea`, `add`,
+//! `sub`, `and`, `or`, `xor`, `imul`, `shl`, `shr`, `sar`, `neg`, and `not`:
+//!
+//!   - Constant folding - an instruction that computes a constant from
+//!     constants is replaced by `mov r, imm`.
+//!   - Constant propagation - a register operand that holds a constant is
+//!     replaced by an immediate if the instruction has such form.
+//!   - Common subexpressions - an instruction that computes a value already
+//!     held by another register is replaced by `mov r, other`, this includes
+//!     address computations by `lea` and 64-bit constants, which take 10
+//!     bytes to materialize.
+//!   - Load forwarding - `mov r, [m]` from memory that was loaded or stored
+//!     before by a register that still holds the value is replaced by `mov`
+//!     from that register. Memory is not disambiguated, any instruction that
+//!     may write memory forgets all loads.
+//!   - Redundant instructions - an instruction that computes the value its
+//!     destination already holds is removed.
+//!
+//! An instruction that writes flags is only replaced if the flags are written
+//! again before they are read. Blocks start at labels and after unconditional
+//! jumps, calls, and all nodes other than instructions, a conditional jump
+//! doesn't end the block as its fall-through can't be entered otherwise.
+//!
+//! The pass must run before the register allocator, so it works on virtual
+//! registers and the allocator sees the shorter live ranges:
+//!
+//! ~~~
+//! X86Compiler cc(&code);
+//! cc.insertPassT<X86ValueNumberPass>(cc.getPassByName("RA"));
+//! ~~~
+class ASMJIT_VIRTAPI X86ValueNumberPass : public CBPass {
+public:
+  ASMJIT_NONCOPYABLE(X86ValueNumberPass)
+  typedef CBPass Base;
+
+  enum {
+    //! Maximum count of values numbered in a single block.
+    kMaxValues = 512,
+    //! Maximum count of expressions remembered in a single block.
+    kMaxExprs = 128,
+    //! Maximum number of nodes visited by the flags liveness check.
+    kMaxLookAhead = 32
+  };
+
+  // --------------------------------------------------------------------------
+  // [Construction / Destruction]
+  // --------------------------------------------------------------------------
+
+  ASMJIT_API X86ValueNumberPass() noexcept;
+  ASMJIT_API virtual ~X86ValueNumberPass() noexcept;
+
+  // --------------------------------------------------------------------------
+  // [Interface]
+  // --------------------------------------------------------------------------
+
+  ASMJIT_API virtual Error process(Zone* zone) noexcept override;
+
+  // --------------------------------------------------------------------------
+  // [Accessors]
+  // --------------------------------------------------------------------------
+
+  //! Get the number of instructions folded into `mov r, imm` by the last `process()`.
+  ASMJIT_INLINE uint32_t getFoldedCount() const noexcept { return _foldedCount; }
+  //! Get the number of register operands replaced by immediates by the last `process()`.
+  ASMJIT_INLINE uint32_t getPropagatedCount() const noexcept { return _propagatedCount; }
+  //! Get the number of computations replaced by `mov` by the last `process()`.
+  ASMJIT_INLINE uint32_t getReusedCount() const noexcept { return _reusedCount; }
+  //! Get the number of loads replaced by `mov` by the last `process()`.
+  ASMJIT_INLINE uint32_t getForwardedCount() const noexcept { return _forwardedCount; }
+  //! Get the number of instructions removed by the last `process()`.
+  ASMJIT_INLINE uint32_t getRemovedCount() const noexcept { return _removedCount; }
+
+  // --------------------------------------------------------------------------
+  // [Members]
+  // --------------------------------------------------------------------------
+
+  uint32_t _foldedCount;                 //!< Instructions folded by the last `process()`.
+  uint32_t _propagatedCount;             //!< Operands propagated by the last `process()`.
+  uint32_t _reusedCount;                 //!< Computations reused by the last `process()`.
+  uint32_t _forwardedCount;              //!< Loads forwarded by the last `process()`.
+  uint32_t _removedCount;                //!< Instructions removed by the last `process()`.
+};
+
+//! \}
+
+} // asmjit namespace
+
+// [Api-End]
+#include "../asmjit_apiend.h"
+
+// [Guard]
+#endif // !ASMJIT_DISABLE_COMPILER
+#endif // _ASMJIT_X86_X86VALUENUMBER_H
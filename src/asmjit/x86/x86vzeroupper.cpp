@@ -0,0 +1,468 @@
+// [AsmJit]
+// Complete x86/x64 JIT and Remote Assembler for C++.
+//
+// [License]
+// Zlib - See LICENSE.md file in the package.
+
+// [Export]
+#define ASMJIT_EXPORTS
+
+// [Guard]
+#include "../asmjit_build.h"
+#if defined(ASMJIT_BUILD_X86) && !defined(ASMJIT_DISABLE_COMPILER)
+
+// [Dependencies]
+#include "../x86/x86inst.h"
+#include "../x86/x86operand.h"
+#include "../x86/x86vzeroupper.h"
+
+// [Api-Begin]
+#include "../asmjit_apibegin.h"
+
+namespace asmjit {
+
+// ============================================================================
+// [asmjit::X86VZeroUpperPass - Helpers]
+// ============================================================================
+
+//! \internal
+//!
+//! Mask of registers affected by `vzeroupper`, upper halves of ZMM16..31 are
+//! never dirty in a sense of AVX-SSE transitions.
+static const uint32_t X86VZeroUpper_kAllRegs = 0xFFFFU;
+
+//! \internal
+enum X86VZeroUpperAction {
+  kX86VZeroUpperNone  = 0,               //!< Doesn't change the upper state.
+  kX86VZeroUpperDirty = 1,               //!< Makes upper halves dirty.
+  kX86VZeroUpperClean = 2,               //!< Makes upper halves clean (`vzeroupper|vzeroall`).
+  kX86VZeroUpperSse   = 3,               //!< Legacy SSE instruction, needs clean upper halves.
+  kX86VZeroUpperCall  = 4,               //!< Function call, needs clean upper halves.
+  kX86VZeroUpperRet   = 5                //!< Function return, needs clean upper halves.
+};
+
+//! \internal
+//!
+//! Effect of a single node on the upper state and on liveness of upper halves.
+struct X86VZeroUpperInfo {
+  uint32_t action;                       //!< Action, see \ref X86VZeroUpperAction.
+  uint32_t use;                          //!< Upper halves read.
+  uint32_t kill;                         //!< Upper halves overwritten or destroyed.
+};
+
+//! \internal
+//!
+//! A basic block of a function.
+struct X86VZeroUpperBlock {
+  CBNode* first;                         //!< First node.
+  CBNode* last;                          //!< Last node (inclusive).
+  X86VZeroUpperBlock* succ[2];           //!< Successors, null if not used.
+  bool isIndirect;                       //!< Ends with a jump to an unknown target.
+  bool isDirtyIn;                        //!< Upper halves can be dirty at the start.
+  bool isDirtyOut;                       //!< Upper halves can be dirty at the end.
+  uint32_t dirtyGen;                     //!< Last action that changes the upper state.
+  uint32_t use;                          //!< Upper halves read before overwritten.
+  uint32_t kill;                         //!< Upper halves overwritten before read.
+  uint32_t liveIn;                       //!< Upper halves live at the start.
+  uint32_t liveOut;                      //!< Upper halves live at the end.
+};
+
+//! \internal
+//!
+//! Get a mask of the register `op` if it's a YMM|ZMM register that can be
+//! affected by `vzeroupper`.
+static ASMJIT_INLINE uint32_t X86VZeroUpper_wideMask(const Operand_& op) noexcept {
+  if (!X86Reg::isVec(op) || op.getSize() < 32 || op.getId() >= 16)
+    return 0;
+  return Utils::mask(op.getId());
+}
+
+//! \internal
+//!
+//! Get a mask of YMM|ZMM registers passed or returned in registers by `values`.
+static uint32_t X86VZeroUpper_valuesMask(const FuncDetail::Value* values, uint32_t count) noexcept {
+  uint32_t mask = 0;
+  for (uint32_t i = 0; i < count; i++) {
+    const FuncDetail::Value& value = values[i];
+    if (!value.byReg()) continue;
+
+    uint32_t regType = value.getRegType();
+    if ((regType == X86Reg::kRegYmm || regType == X86Reg::kRegZmm) && value.getRegId() < 16)
+      mask |= Utils::mask(value.getRegId());
+  }
+  return mask;
+}
+
+static void X86VZeroUpper_analyze(const CBNode* node_, uint32_t retMask, X86VZeroUpperInfo& out) noexcept {
+  out.action = kX86VZeroUpperNone;
+  out.use = 0;
+  out.kill = 0;
+
+  if (node_->getType() == CBNode::kNodeFuncCall) {
+    const CCFuncCall* node = static_cast<const CCFuncCall*>(node_);
+    const FuncDetail& fd = node->getDetail();
+
+    // Vector registers are not preserved by the callee, only arguments
+    // passed in YMM|ZMM registers need their upper halves.
+    out.action = kX86VZeroUpperCall;
+    out.use = fd.getArgCount() ? X86VZeroUpper_valuesMask(&fd.getArg(0), fd.getArgCount()) : 0;
+    out.kill = X86VZeroUpper_kAllRegs;
+    return;
+  }
+
+  if (node_->getType() != CBNode::kNodeInst)
+    return;
+
+  const CBInst* node = static_cast<const CBInst*>(node_);
+  uint32_t instId = node->getInstId();
+
+  if (instId == X86Inst::kIdVzeroupper || instId == X86Inst::kIdVzeroall) {
+    out.action = kX86VZeroUpperClean;
+    out.kill = X86VZeroUpper_kAllRegs;
+    return;
+  }
+
+  const X86Inst::CommonData& commonData = X86Inst::getInst(instId).getCommonData();
+  switch (commonData.getJumpType()) {
+    case Inst::kJumpTypeCall:
+      // Arguments of a call emitted as an instruction are not known, keep
+      // liveness as is so `vzeroupper` is not inserted if anything is live.
+      out.action = kX86VZeroUpperCall;
+      return;
+
+    case Inst::kJumpTypeReturn:
+      out.action = kX86VZeroUpperRet;
+      out.use = retMask;
+      return;
+  }
+
+  if (!commonData.isVec())
+    return;
+
+  const Operand* opArray = node->getOpArray();
+  uint32_t opCount = node->getOpCount();
+
+  bool isAvx = commonData.isVexOrEvex();
+  bool hasVecReg = false;
+  uint32_t wide = 0;
+
+  for (uint32_t i = 0; i < opCount; i++) {
+    const Operand& op = opArray[i];
+
+    if (op.isReg()) {
+      if (!X86Reg::isVec(op)) continue;
+      hasVecReg = true;
+
+      uint32_t mask = X86VZeroUpper_wideMask(op);
+      wide |= mask;
+
+      // The destination of VEX|EVEX instruction is either overwritten
+      // completely or zero extended (XMM destination), legacy SSE doesn't
+      // touch upper halves at all.
+      if (i == commonData.getWriteIndex() && !commonData.isUseR() && isAvx && op.getId() < 16) {
+        bool isMerge = commonData.isUseX() || (node->hasExtraReg() && !(node->getOptions() & X86Inst::kOptionZMask));
+        if (isMerge)
+          out.use |= mask;
+        out.kill |= Utils::mask(op.getId());
+      }
+      else {
+        out.use |= mask;
+      }
+    }
+    else if (op.isMem()) {
+      // VSIB index.
+      const X86Mem& m = op.as<X86Mem>();
+      if (m.hasIndexReg() && m.getIndexType() >= X86Reg::kRegYmm && m.getIndexType() <= X86Reg::kRegZmm && m.getIndexId() < 16)
+        out.use |= Utils::mask(m.getIndexId());
+    }
+  }
+
+  if (isAvx) {
+    if (wide) out.action = kX86VZeroUpperDirty;
+  }
+  else if (hasVecReg) {
+    out.action = kX86VZeroUpperSse;
+  }
+}
+
+//! \internal
+//!
+//! Get upper halves live before `node` by scanning `block` backwards.
+static uint32_t X86VZeroUpper_liveBefore(const X86VZeroUpperBlock* block, const CBNode* node, uint32_t retMask) noexcept {
+  uint32_t live = block->liveOut;
+  const CBNode* cur = block->last;
+
+  for (;;) {
+    X86VZeroUpperInfo info;
+    X86VZeroUpper_analyze(cur, retMask, info);
+    live = info.use | (live & ~info.kill);
+
+    if (cur == node || cur == block->first)
+      return live;
+    cur = cur->getPrev();
+  }
+}
+
+static ASMJIT_INLINE bool X86VZeroUpper_isLabel(const CBNode* node) noexcept {
+  return node->getType() == CBNode::kNodeLabel || node->getType() == CBNode::kNodeFunc;
+}
+
+static ASMJIT_INLINE bool X86VZeroUpper_endsBlock(const CBNode* node) noexcept {
+  if (node->isJmpOrJcc())
+    return true;
+
+  return node->getType() == CBNode::kNodeInst &&
+         static_cast<const CBInst*>(node)->getInstId() == X86Inst::kIdRet;
+}
+
+// ============================================================================
+// [asmjit::X86VZeroUpperPass - Construction / Destruction]
+// ============================================================================
+
+X86VZeroUpperPass::X86VZeroUpperPass() noexcept
+  : CBPass("VZeroUpper"),
+    _insertedCount(0),
+    _unresolvedCount(0),
+    _firstUnresolved(nullptr) {}
+X86VZeroUpperPass::~X86VZeroUpperPass() noexcept {}
+
+// ============================================================================
+// [asmjit::X86VZeroUpperPass - Process]
+// ============================================================================
+
+static Error X86VZeroUpper_processFunc(X86VZeroUpperPass* self, Zone* zone, CCFunc* func) noexcept {
+  CodeBuilder* cb = self->_cb;
+  CBNode* stop = func->getEnd();
+
+  const FuncDetail& fd = func->getDetail();
+  uint32_t retMask = fd.getRetCount() ? X86VZeroUpper_valuesMask(&fd.getRet(0), fd.getRetCount()) : 0;
+
+  // Count basic blocks, skip functions that don't use YMM|ZMM registers.
+  uint32_t blockCount = 0;
+  bool isDirty = false;
+  bool newBlock = true;
+
+  for (CBNode* node = func; node != stop; node = node->getNext()) {
+    if (newBlock || X86VZeroUpper_isLabel(node)) {
+      blockCount++;
+      newBlock = false;
+    }
+    newBlock = X86VZeroUpper_endsBlock(node);
+
+    X86VZeroUpperInfo info;
+    X86VZeroUpper_analyze(node, retMask, info);
+    isDirty |= info.action == kX86VZeroUpperDirty;
+  }
+
+  if (!isDirty)
+    return kErrorOk;
+
+  X86VZeroUpperBlock* blocks = zone->allocT<X86VZeroUpperBlock>(blockCount * sizeof(X86VZeroUpperBlock));
+  if (ASMJIT_UNLIKELY(!blocks))
+    return DebugUtils::errored(kErrorNoHeapMemory);
+
+  // Split into basic blocks and compute their local effects. Labels point to
+  // their blocks through pass data.
+  X86VZeroUpperBlock* block = nullptr;
+  bool hasIndirect = false;
+  newBlock = true;
+
+  for (CBNode* node = func; node != stop; node = node->getNext()) {
+    if (newBlock || X86VZeroUpper_isLabel(node)) {
+      block = block ? block + 1 : blocks;
+      block->first = node;
+      block->succ[0] = nullptr;
+      block->succ[1] = nullptr;
+      block->isIndirect = false;
+      block->isDirtyIn = false;
+      block->isDirtyOut = false;
+      block->dirtyGen = kX86VZeroUpperNone;
+      block->use = 0;
+      block->kill = 0;
+      block->liveIn = 0;
+      block->liveOut = 0;
+      newBlock = false;
+    }
+
+    if (X86VZeroUpper_isLabel(node))
+      node->setPassData<X86VZeroUpperBlock>(block);
+
+    block->last = node;
+    newBlock = X86VZeroUpper_endsBlock(node);
+
+    X86VZeroUpperInfo info;
+    X86VZeroUpper_analyze(node, retMask, info);
+
+    block->use |= info.use & ~block->kill;
+    block->kill |= info.kill;
+
+    if (info.action == kX86VZeroUpperDirty || info.action == kX86VZeroUpperClean)
+      block->dirtyGen = info.action;
+    else if (info.action == kX86VZeroUpperCall)
+      block->dirtyGen = kX86VZeroUpperClean;
+  }
+
+  ASMJIT_ASSERT(block == blocks + blockCount - 1);
+  X86VZeroUpperBlock* blocksEnd = blocks + blockCount;
+
+  // Connect successors.
+  for (block = blocks; block != blocksEnd; block++) {
+    CBNode* last = block->last;
+    X86VZeroUpperBlock* next = block + 1 != blocksEnd ? block + 1 : nullptr;
+
+    if (last->isJmpOrJcc()) {
+      CBLabel* target = static_cast<CBJump*>(last)->getTarget();
+      X86VZeroUpperBlock* targetBlock = target ? target->getPassData<X86VZeroUpperBlock>() : nullptr;
+
+      // Only labels of this function point to its blocks.
+      if (targetBlock >= blocks && targetBlock < blocksEnd && targetBlock->first == target) {
+        block->succ[0] = targetBlock;
+      }
+      else {
+        block->isIndirect = true;
+        hasIndirect = true;
+      }
+
+      if (last->isJcc())
+        block->succ[1] = next;
+    }
+    else if (!X86VZeroUpper_endsBlock(last)) {
+      block->succ[0] = next;
+    }
+  }
+
+  // A jump to an unknown target can reach any label.
+  if (hasIndirect) {
+    for (block = blocks + 1; block != blocksEnd; block++)
+      if (X86VZeroUpper_isLabel(block->first))
+        block->isDirtyIn = true;
+  }
+
+  // Propagate dirty upper state forward and liveness of upper halves
+  // backward until both reach a fixed point.
+  bool changed;
+  do {
+    changed = false;
+
+    for (block = blocks; block != blocksEnd; block++) {
+      bool dirtyOut = block->dirtyGen == kX86VZeroUpperNone ? block->isDirtyIn
+                                                            : block->dirtyGen == kX86VZeroUpperDirty;
+      block->isDirtyOut = dirtyOut;
+
+      for (uint32_t i = 0; i < 2; i++) {
+        X86VZeroUpperBlock* succ = block->succ[i];
+        if (succ && dirtyOut && !succ->isDirtyIn) {
+          succ->isDirtyIn = true;
+          changed = true;
+        }
+      }
+    }
+
+    for (block = blocksEnd; block != blocks; ) {
+      block--;
+
+      uint32_t liveOut = block->isIndirect ? X86VZeroUpper_kAllRegs : 0;
+      for (uint32_t i = 0; i < 2; i++)
+        if (block->succ[i])
+          liveOut |= block->succ[i]->liveIn;
+
+      uint32_t liveIn = block->use | (liveOut & ~block->kill);
+      if (liveIn != block->liveIn || liveOut != block->liveOut) {
+        block->liveIn = liveIn;
+        block->liveOut = liveOut;
+        changed = true;
+      }
+    }
+  } while (changed);
+
+  // Insert `vzeroupper` where upper halves are dirty and dead.
+  bool emitComments = (cb->getGlobalOptions() & CodeEmitter::kOptionLoggingEnabled) != 0;
+  CBNode* oldCursor = cb->getCursor();
+
+  for (block = blocks; block != blocksEnd; block++) {
+    bool dirty = block->isDirtyIn;
+    bool reported = false;
+
+    CBNode* node = block->first;
+    for (;;) {
+      // Inserting before `node` doesn't change `node->getNext()`.
+      CBNode* next = node != block->last ? node->getNext() : nullptr;
+
+      X86VZeroUpperInfo info;
+      X86VZeroUpper_analyze(node, retMask, info);
+
+      switch (info.action) {
+        case kX86VZeroUpperDirty:
+          dirty = true;
+          reported = false;
+          break;
+
+        case kX86VZeroUpperClean:
+          dirty = false;
+          break;
+
+        case kX86VZeroUpperSse:
+        case kX86VZeroUpperCall:
+        case kX86VZeroUpperRet: {
+          if (!dirty)
+            break;
+
+          if (X86VZeroUpper_liveBefore(block, node, retMask) == 0) {
+            cb->_setCursor(node->getPrev());
+            ASMJIT_PROPAGATE(cb->emit(X86Inst::kIdVzeroupper));
+
+            self->_insertedCount++;
+            dirty = false;
+          }
+          else if (info.action == kX86VZeroUpperSse && !reported) {
+            // Upper halves are still needed, the transition stays.
+            if (!self->_firstUnresolved)
+              self->_firstUnresolved = node;
+            if (emitComments && !node->getInlineComment())
+              node->setInlineComment("AVX-SSE transition");
+
+            self->_unresolvedCount++;
+            reported = true;
+          }
+
+          // Upper halves are clean after a call returns.
+          if (info.action == kX86VZeroUpperCall)
+            dirty = false;
+          break;
+        }
+      }
+
+      if (!next) break;
+      node = next;
+    }
+  }
+
+  cb->_setCursor(oldCursor);
+  return kErrorOk;
+}
+
+Error X86VZeroUpperPass::process(Zone* zone) noexcept {
+  _insertedCount = 0;
+  _unresolvedCount = 0;
+  _firstUnresolved = nullptr;
+
+  CBNode* node = cb()->getFirstNode();
+  while (node) {
+    if (node->getType() == CBNode::kNodeFunc) {
+      CCFunc* func = static_cast<CCFunc*>(node);
+      ASMJIT_PROPAGATE(X86VZeroUpper_processFunc(this, zone, func));
+      node = func->getEnd();
+    }
+    node = node->getNext();
+  }
+
+  return kErrorOk;
+}
+
+} // asmjit namespace
+
+// [Api-End]
+#include "../asmjit_apiend.h"
+
+// [Guard]
+#endif // ASMJIT_BUILD_X86 && !ASMJIT_DISABLE_COMPILER
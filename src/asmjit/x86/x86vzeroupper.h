@@ -0,0 +1,99 @@
+// [AsmJit]
+// Complete x86/x64 JIT and Remote Assembler for C++.
+//
+// [License]
+// Zlib - See LICENSE.md file in the package.
+
+// [Guard]
+#ifndef _ASMJIT_X86_X86VZEROUPPER_H
+#define _ASMJIT_X86_X86VZEROUPPER_H
+
+#include "../asmjit_build.h"
+#if !defined(ASMJIT_DISABLE_COMPILER)
+
+// [Dependencies]
+#include "../base/codecompiler.h"
+
+// [Api-Begin]
+#include "../asmjit_apibegin.h"
+
+namespace asmjit {
+
+//! \addtogroup asmjit_x86
+//! \{
+
+// ============================================================================
+// [asmjit::X86VZeroUpperPass]
+// ============================================================================
+
+//! Pass that inserts `vzeroupper` to avoid AVX-SSE transition penalties.
+//!
+//! Upper halves of YMM|ZMM registers become dirty by any VEX|EVEX instruction
+//! that uses a 256-bit or 512-bit register and clean by `vzeroupper` or
+//! `vzeroall`. The pass tracks this state through the control flow of each
+//! function and inserts `vzeroupper` only where the upper state is dirty:
+//!
+//!   - Before a function call and before `ret`, as the ABI expects.
+//!   - Before a legacy SSE instruction, which is the transition itself.
+//!
+//! `vzeroupper` destroys upper halves of all registers, so it's only inserted
+//! where no upper half is read later (calls and returns that pass a 256-bit
+//! or 512-bit vector in a register included). A transition that can't be
+//! resolved is counted by \ref getUnresolvedCount() and, if logging is
+//! enabled, marked by a comment at the instruction.
+//!
+//! The pass works with physical registers, so it has to be added after
+//! `X86Compiler` was attached, which adds its register allocator pass:
+//!
+//! ~~~
+//! X86Compiler cc(&code);
+//! cc.addPassT<X86VZeroUpperPass>();
+//! ~~~
+class ASMJIT_VIRTAPI X86VZeroUpperPass : public CBPass {
+public:
+  ASMJIT_NONCOPYABLE(X86VZeroUpperPass)
+  typedef CBPass Base;
+
+  // --------------------------------------------------------------------------
+  // [Construction / Destruction]
+  // --------------------------------------------------------------------------
+
+  ASMJIT_API X86VZeroUpperPass() noexcept;
+  ASMJIT_API virtual ~X86VZeroUpperPass() noexcept;
+
+  // --------------------------------------------------------------------------
+  // [Interface]
+  // --------------------------------------------------------------------------
+
+  ASMJIT_API virtual Error process(Zone* zone) noexcept override;
+
+  // --------------------------------------------------------------------------
+  // [Accessors]
+  // --------------------------------------------------------------------------
+
+  //! Get the number of `vzeroupper` instructions inserted by the last `process()`.
+  ASMJIT_INLINE uint32_t getInsertedCount() const noexcept { return _insertedCount; }
+  //! Get the number of transitions the last `process()` could not resolve.
+  ASMJIT_INLINE uint32_t getUnresolvedCount() const noexcept { return _unresolvedCount; }
+  //! Get the first instruction the last `process()` could not resolve, or null.
+  ASMJIT_INLINE CBNode* getFirstUnresolved() const noexcept { return _firstUnresolved; }
+
+  // --------------------------------------------------------------------------
+  // [Members]
+  // --------------------------------------------------------------------------
+
+  uint32_t _insertedCount;               //!< Inserted `vzeroupper` instructions.
+  uint32_t _unresolvedCount;             //!< Unresolved transitions.
+  CBNode* _firstUnresolved;              //!< First unresolved transition.
+};
+
+//! \}
+
+} // asmjit namespace
+
+// [Api-End]
+#include "../asmjit_apiend.h"
+
+// [Guard]
+#endif // !ASMJIT_DISABLE_COMPILER
+#endif // _ASMJIT_X86_X86VZEROUPPER_H
@@ -9,6 +9,8 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include <algorithm>
+
 #include "./asmjit.h"
 #include "./asmjit_test_misc.h"
 #include "./asmjit_test_opcode.h"
@@ -19,128 +21,506 @@ using namespace asmjit;
 // [Configuration]
 // ============================================================================
 
-static const uint32_t kNumRepeats = 10;
-static const uint32_t kNumIterations = 5000;
+// Instructions reserved by `X86Assembler::beginTrusted()`, enough for all
+// instructions emitted by `asmtest::generateOpcodes()`.
+static const uint32_t kNumTrustedInsts = 8192;
+
+//! Benchmark configuration, see `BenchConfig::parse()` for command line.
+struct BenchConfig {
+  BenchConfig() noexcept
+    : warmup(20),
+      samples(200),
+      json(false),
+      validation(false),
+      logging(false),
+      compact(false),
+      packed(false) {}
+
+  bool parse(int argc, char* argv[]) noexcept {
+    for (int i = 1; i < argc; i++) {
+      const char* arg = argv[i];
+
+      if (::strcmp(arg, "--json") == 0)
+        json = true;
+      else if (::strcmp(arg, "--validate") == 0)
+        validation = true;
+      else if (::strcmp(arg, "--logging") == 0)
+        logging = true;
+      else if (::strcmp(arg, "--compact") == 0)
+        compact = true;
+      else if (::strcmp(arg, "--packed") == 0)
+        packed = true;
+      else if (::strncmp(arg, "--warmup=", 9) == 0)
+        warmup = static_cast<uint32_t>(::strtoul(arg + 9, nullptr, 10));
+      else if (::strncmp(arg, "--samples=", 10) == 0)
+        samples = static_cast<uint32_t>(::strtoul(arg + 10, nullptr, 10));
+      else
+        return false;
+    }
+
+    if (samples == 0) samples = 1;
+    return true;
+  }
+
+  uint32_t warmup;                       //!< Number of iterations not measured.
+  uint32_t samples;                      //!< Number of iterations measured.
+  bool json;                             //!< Output JSON instead of a table.
+  bool validation;                       //!< Strict validation of each instruction.
+  bool logging;                          //!< Logging to a `StringLogger`.
+  bool compact;                          //!< Compact instruction storage of `X86Compiler`.
+  bool packed;                           //!< Packed operand storage of `X86Compiler`.
+};
 
 // ============================================================================
-// [Performance]
+// [BenchSamples]
 // ============================================================================
 
-struct Performance {
-  static inline uint32_t now() {
-    return OSUtils::getTickCount();
+//! Samples of a single stage, each sample is a time of one iteration in ns.
+struct BenchSamples {
+  explicit BenchSamples(const BenchConfig& config) noexcept
+    : _warmup(config.warmup),
+      _capacity(config.samples),
+      _count(0),
+      _index(0),
+      _bytes(0),
+      _error(kErrorOk) {
+    _data = static_cast<uint64_t*>(::malloc(_capacity * sizeof(uint64_t)));
   }
+  ~BenchSamples() noexcept { ::free(_data); }
+
+  //! Get the total number of iterations (including warmup).
+  inline uint32_t getIterations() const noexcept { return _warmup + _capacity; }
 
-  inline void reset() {
-    tick = 0;
-    best = 0xFFFFFFFF;
+  //! Add a sample of iteration `_index`, warmup iterations are ignored.
+  inline void add(uint64_t time) noexcept {
+    if (_index++ >= _warmup && _count < _capacity)
+      _data[_count++] = time;
   }
 
-  inline uint32_t start() { return (tick = now()); }
-  inline uint32_t diff() const { return now() - tick; }
+  //! Add the size of the output of one iteration (used to report MB/s).
+  inline void setBytes(size_t bytes) noexcept { _bytes = bytes; }
+  //! Remember the first error reported by an iteration.
+  inline void setError(Error err) noexcept { if (!_error) _error = err; }
 
-  inline uint32_t end() {
-    tick = diff();
-    if (best > tick)
-      best = tick;
-    return tick;
+  //! Sort samples, must be called before `percentile()`.
+  inline void sort() noexcept { std::sort(_data, _data + _count); }
+
+  inline uint64_t percentile(uint32_t p) const noexcept {
+    if (!_count) return 0;
+    uint32_t i = static_cast<uint32_t>((uint64_t(_count - 1) * p + 50) / 100);
+    return _data[i];
+  }
+
+  inline double mean() const noexcept {
+    if (!_count) return 0.0;
+
+    double sum = 0.0;
+    for (uint32_t i = 0; i < _count; i++)
+      sum += static_cast<double>(_data[i]);
+    return sum / static_cast<double>(_count);
   }
 
-  uint32_t tick;
-  uint32_t best;
+  uint32_t _warmup;
+  uint32_t _capacity;
+  uint32_t _count;
+  uint32_t _index;
+  size_t _bytes;
+  Error _error;
+  uint64_t* _data;
 };
 
-static double mbps(uint32_t time, size_t outputSize) {
-  if (!time) return 0.0;
+// ============================================================================
+// [BenchReport]
+// ============================================================================
+
+struct BenchReport {
+  explicit BenchReport(const BenchConfig& config) noexcept
+    : _config(config),
+      _count(0) {}
 
-  double bytesTotal = static_cast<double>(outputSize);
-  return (bytesTotal * 1000) / (static_cast<double>(time) * 1024 * 1024);
-}
+  static inline uint64_t now() noexcept { return OSUtils::getHighResTime(); }
+
+  static double mbps(uint64_t time, size_t bytes) noexcept {
+    if (!time) return 0.0;
+    return (static_cast<double>(bytes) * 1e9) / (static_cast<double>(time) * 1024 * 1024);
+  }
+
+  void begin() noexcept {
+    if (_config.json) {
+      printf("{\n");
+      printf("  \"config\": { \"warmup\": %u, \"samples\": %u, \"validation\": %s, \"logging\": %s, \"compact\": %s, \"packed\": %s },\n",
+        _config.warmup,
+        _config.samples,
+        _config.validation ? "true" : "false",
+        _config.logging ? "true" : "false",
+        _config.compact ? "true" : "false",
+        _config.packed ? "true" : "false");
+      printf("  \"results\": [");
+    }
+    else {
+      printf("Warmup: %u | Samples: %u | Validation: %s | Logging: %s | Compact: %s | Packed: %s\n\n",
+        _config.warmup,
+        _config.samples,
+        _config.validation ? "on" : "off",
+        _config.logging ? "on" : "off",
+        _config.compact ? "on" : "off",
+        _config.packed ? "on" : "off");
+      printf("%-18s %-4s | %10s | %10s | %10s | %10s | %10s | %9s\n",
+        "Stage", "Arch", "Min [ns]", "P50 [ns]", "P90 [ns]", "P99 [ns]", "Mean [ns]", "P50 MB/s");
+      printf("---------------------------------------------------------------------------------------------------\n");
+    }
+  }
+
+  void add(const char* arch, const char* stage, BenchSamples& s) noexcept {
+    s.sort();
+
+    uint64_t p50 = s.percentile(50);
+    double speed = s._bytes ? mbps(p50, s._bytes) : 0.0;
+
+    if (_config.json) {
+      printf("%s\n    { \"arch\": \"%s\", \"stage\": \"%s\", \"samples\": %u, \"bytes\": %u, "
+             "\"min\": %llu, \"p50\": %llu, \"p90\": %llu, \"p99\": %llu, \"max\": %llu, \"mean\": %.1f, \"mbps\": %.3f, \"error\": \"%s\" }",
+        _count ? "," : "",
+        arch, stage, s._count, static_cast<unsigned int>(s._bytes),
+        static_cast<unsigned long long>(s.percentile(0)),
+        static_cast<unsigned long long>(p50),
+        static_cast<unsigned long long>(s.percentile(90)),
+        static_cast<unsigned long long>(s.percentile(99)),
+        static_cast<unsigned long long>(s.percentile(100)),
+        s.mean(),
+        speed,
+        s._error ? DebugUtils::errorAsString(s._error) : "");
+    }
+    else {
+      printf("%-18s %-4s | %10llu | %10llu | %10llu | %10llu | %10.0f | ",
+        stage, arch,
+        static_cast<unsigned long long>(s.percentile(0)),
+        static_cast<unsigned long long>(p50),
+        static_cast<unsigned long long>(s.percentile(90)),
+        static_cast<unsigned long long>(s.percentile(99)),
+        s.mean());
+
+      if (s._bytes)
+        printf("%9.3f", speed);
+      else
+        printf("%9s", "-");
+
+      // Errors make the results incomparable, for example strict validation
+      // rejects some instructions emitted by `asmtest::generateOpcodes()`.
+      if (s._error)
+        printf(" (%s)", DebugUtils::errorAsString(s._error));
+      printf("\n");
+    }
+
+    _count++;
+  }
+
+  void end() noexcept {
+    if (_config.json)
+      printf("\n  ]\n}\n");
+  }
+
+  const BenchConfig& _config;
+  uint32_t _count;
+};
 
 // ============================================================================
-// [Main]
+// [BenchEnv]
+// ============================================================================
+
+//! Applies `BenchConfig` to a `CodeHolder` and its emitter.
+struct BenchEnv {
+  explicit BenchEnv(const BenchConfig& config) noexcept
+    : _config(config) {}
+
+  //! Must be called before an emitter is attached to `code`.
+  void initCode(CodeHolder& code) noexcept {
+#if !defined(ASMJIT_DISABLE_LOGGING)
+    if (_config.logging) {
+      _logger.clearString();
+      code.setLogger(&_logger);
+    }
+#endif // !ASMJIT_DISABLE_LOGGING
+  }
+
+  //! Must be called after `emitter` is attached to a `CodeHolder`.
+  void initEmitter(CodeEmitter& emitter) noexcept {
+    // There is no public API to make strict validation global, so the option
+    // is merged directly into global options of the emitter, which are then
+    // combined with options of each instruction.
+    if (_config.validation)
+      emitter._globalOptions |= CodeEmitter::kOptionStrictValidation;
+  }
+
+  const BenchConfig& _config;
+#if !defined(ASMJIT_DISABLE_LOGGING)
+  StringLogger _logger;
+#endif // !ASMJIT_DISABLE_LOGGING
+};
+
+// ============================================================================
+// [Bench - X86]
 // ============================================================================
 
 #if defined(ASMJIT_BUILD_X86)
-static void benchX86(uint32_t archType) {
-  CodeHolder code;
-  Performance perf;
+static CodeInfo benchCodeInfo(uint32_t archType) {
+  // NOTE: Since we don't have JitRuntime we don't know anything about
+  // function calling conventions, which is required by generateAlphaBlend.
+  // So we must setup this manually.
+  CodeInfo ci(archType);
+  ci.setCdeclCallConv(archType == ArchInfo::kTypeX86 ? CallConv::kIdX86CDecl : CallConv::kIdX86SysV64);
+  return ci;
+}
+
+// Stage `emit` and `emit-trusted` - X86Assembler encoding all instructions
+// generated by `asmtest::generateOpcodes()`.
+static void benchX86Emit(BenchReport& report, BenchEnv& env, uint32_t archType, bool trusted) {
+  const char* archName = archType == ArchInfo::kTypeX86 ? "X86" : "X64";
 
+  CodeHolder code;
   X86Assembler a;
-  X86Compiler cc;
+  BenchSamples s(report._config);
+
+  for (uint32_t i = 0, n = s.getIterations(); i < n; i++) {
+    code.init(CodeInfo(archType));
+    env.initCode(code);
+    code.attach(&a);
+    env.initEmitter(a);
 
-  uint32_t r, i;
+    uint64_t t = BenchReport::now();
+    if (trusted) {
+      a.beginTrusted(kNumTrustedInsts);
+      asmtest::generateOpcodes(a);
+      a.endTrusted();
+    }
+    else {
+      asmtest::generateOpcodes(a);
+    }
+    s.add(BenchReport::now() - t);
+    s.setBytes(code.getCodeSize());
+    s.setError(a.getLastError());
+
+    code.reset(false); // Detaches `a`.
+  }
+
+  report.add(archName, trusted ? "emit-trusted" : "emit", s);
+}
+
+#if !defined(ASMJIT_DISABLE_VALIDATION)
+//! Collects instructions decoded by `X86Decoder`.
+struct BenchInstList : public X86DecodeHandler {
+  BenchInstList() noexcept : _data(nullptr), _size(0), _capacity(0) {}
+  ~BenchInstList() noexcept { ::free(_data); }
+
+  virtual Error handleInst(const X86DecodedInst& inst) noexcept {
+    if (_size == _capacity) {
+      size_t capacity = std::max<size_t>(_capacity * 2, 1024);
+      X86DecodedInst* data = static_cast<X86DecodedInst*>(::realloc(_data, capacity * sizeof(X86DecodedInst)));
+      if (!data) return DebugUtils::errored(kErrorNoHeapMemory);
+
+      _data = data;
+      _capacity = capacity;
+    }
+
+    _data[_size++] = inst;
+    return kErrorOk;
+  }
+
+  X86DecodedInst* _data;
+  size_t _size;
+  size_t _capacity;
+};
+
+// Stage `serialize` - `X86Compiler::serialize()` of nodes that contain all
+// instructions generated by `asmtest::generateOpcodes()`, the same stream as
+// the `emit` stage, but added to `X86Compiler` from decoded machine code as
+// the compiler doesn't provide the explicit instruction API. No passes run.
+static void benchX86Serialize(BenchReport& report, BenchEnv& env, uint32_t archType) {
   const char* archName = archType == ArchInfo::kTypeX86 ? "X86" : "X64";
 
-  // --------------------------------------------------------------------------
-  // [Bench - Assembler]
-  // --------------------------------------------------------------------------
+  CodeHolder code;
+  BenchInstList list;
+  BenchSamples s(report._config);
+
+  {
+    code.init(CodeInfo(archType));
+    X86Assembler a(&code);
+    asmtest::generateOpcodes(a);
+    code.sync();
+
+    X86Decoder decoder(archType);
+    s.setError(decoder.decodeAll(&list, code.getSectionEntry(0)->getBuffer()));
+    code.reset(false);
+  }
+
+  X86Compiler cc;
+  X86Assembler a;
+
+  for (uint32_t i = 0, n = s.getIterations(); i < n; i++) {
+    code.init(benchCodeInfo(archType));
+    env.initCode(code);
+    code.attach(&cc);
+    env.initEmitter(cc);
+
+    for (size_t j = 0; j < list._size; j++) {
+      const X86DecodedInst& inst = list._data[j];
+      cc.setOptions(inst.detail.options);
+      if (inst.detail.hasExtraReg())
+        cc.setExtraReg(inst.detail.extraReg);
+      cc.emitOpArray(inst.getInstId(), inst.operands, inst.opCount);
+    }
 
-  size_t asmOutputSize = 0;
-  size_t cmpOutputSize = 0;
+    code.attach(&a);
+    env.initEmitter(a);
 
-  perf.reset();
-  for (r = 0; r < kNumRepeats; r++) {
-    asmOutputSize = 0;
-    perf.start();
-    for (i = 0; i < kNumIterations; i++) {
-      code.init(CodeInfo(archType));
-      code.attach(&a);
+    uint64_t t = BenchReport::now();
+    s.setError(cc.serialize(&a));
+    s.add(BenchReport::now() - t);
+    s.setBytes(code.getCodeSize());
 
-      asmtest::generateOpcodes(a);
-      asmOutputSize += code.getCodeSize();
+    code.reset(false); // Detaches `cc` and `a`.
+  }
+
+  report.add(archName, "serialize", s);
+}
+#endif // !ASMJIT_DISABLE_VALIDATION
 
-      code.reset(false); // Detaches `a`.
+// Stages `compile`, `compile-ra`, `compile-serialize`, and `relocate` - the
+// whole `X86Compiler::finalize()` of `asmtest::generateAlphaBlend()`, split
+// into passes by `CodeBuilder` statistics, followed by `CodeHolder::relocate()`.
+static void benchX86Compile(BenchReport& report, BenchEnv& env, uint32_t archType) {
+  const char* archName = archType == ArchInfo::kTypeX86 ? "X86" : "X64";
+
+  CodeHolder code;
+  X86Compiler cc;
+
+  BenchSamples sAll(report._config);
+  BenchSamples sRA(report._config);
+  BenchSamples sSerialize(report._config);
+  BenchSamples sRelocate(report._config);
+
+  uint8_t* buffer = nullptr;
+  size_t bufferSize = 0;
+
+  for (uint32_t i = 0, n = sAll.getIterations(); i < n; i++) {
+    code.init(benchCodeInfo(archType));
+    env.initCode(code);
+    code.attach(&cc);
+    env.initEmitter(cc);
+    cc.setStatsEnabled(true);
+    cc.setCompactInstStorage(report._config.compact);
+    cc.setPackedOpStorage(report._config.packed);
+
+    asmtest::generateAlphaBlend(cc);
+
+    uint64_t t = BenchReport::now();
+    sAll.setError(cc.finalize());
+    sAll.add(BenchReport::now() - t);
+
+    CBPass* ra = cc.getPassByName("RA");
+    sRA.add(ra ? ra->getStats().totalTime : uint64_t(0));
+    sSerialize.add(cc.getSerializeTime());
+
+    size_t codeSize = code.getCodeSize();
+    if (bufferSize < codeSize) {
+      ::free(buffer);
+      buffer = static_cast<uint8_t*>(::malloc(codeSize));
+      bufferSize = codeSize;
     }
-    perf.end();
+
+    t = BenchReport::now();
+    code.relocate(buffer, 0x10000000);
+    sRelocate.add(BenchReport::now() - t);
+
+    sAll.setBytes(codeSize);
+    sRelocate.setBytes(codeSize);
+
+    code.reset(false); // Detaches `cc`.
   }
 
-  printf("%-12s (%s) | Time: %-6u [ms] | Speed: %7.3f [MB/s]\n",
-    "X86Assembler", archName, perf.best, mbps(perf.best, asmOutputSize));
+  ::free(buffer);
+
+  report.add(archName, "compile", sAll);
+  report.add(archName, "compile-ra", sRA);
+  report.add(archName, "compile-serialize", sSerialize);
+  report.add(archName, "relocate", sRelocate);
+}
 
-  // --------------------------------------------------------------------------
-  // [Bench - CodeBuilder]
-  // --------------------------------------------------------------------------
+// Stages `runtime-add` and `runtime-release` - `JitRuntime::add()` and
+// `JitRuntime::release()` of a compiled `asmtest::generateAlphaBlend()`
+// (host architecture only).
+static void benchX86Runtime(BenchReport& report, BenchEnv& env) {
+  const char* archName = ArchInfo::kTypeHost == ArchInfo::kTypeX86 ? "X86" : "X64";
 
-  // TODO:
+  JitRuntime runtime;
+  CodeHolder code;
+  X86Compiler cc;
 
-  // --------------------------------------------------------------------------
-  // [Bench - CodeCompiler]
-  // --------------------------------------------------------------------------
+  BenchSamples sAdd(report._config);
+  BenchSamples sRelease(report._config);
 
-  perf.reset();
-  for (r = 0; r < kNumRepeats; r++) {
-    cmpOutputSize = 0;
-    perf.start();
-    for (i = 0; i < kNumIterations; i++) {
-      // NOTE: Since we don't have JitRuntime we don't know anything about
-      // function calling conventions, which is required by generateAlphaBlend.
-      // So we must setup this manually.
-      CodeInfo ci(archType);
-      ci.setCdeclCallConv(archType == ArchInfo::kTypeX86 ? CallConv::kIdX86CDecl : CallConv::kIdX86SysV64);
+  for (uint32_t i = 0, n = sAdd.getIterations(); i < n; i++) {
+    code.init(runtime.getCodeInfo());
+    env.initCode(code);
+    code.attach(&cc);
 
-      code.init(ci);
-      code.attach(&cc);
+    asmtest::generateAlphaBlend(cc);
+    cc.finalize();
 
-      asmtest::generateAlphaBlend(cc);
-      cc.finalize();
-      cmpOutputSize += code.getCodeSize();
+    void* func;
+    uint64_t t = BenchReport::now();
+    Error err = runtime.add(&func, &code);
+    sAdd.add(BenchReport::now() - t);
+    sAdd.setBytes(code.getCodeSize());
+    sAdd.setError(err);
 
-      code.reset(false); // Detaches `cc`.
+    if (err == kErrorOk) {
+      t = BenchReport::now();
+      runtime.release(func);
+      sRelease.add(BenchReport::now() - t);
     }
-    perf.end();
+
+    code.reset(false); // Detaches `cc`.
   }
 
-  printf("%-12s (%s) | Time: %-6u [ms] | Speed: %7.3f [MB/s]\n",
-    "X86Compiler", archName, perf.best, mbps(perf.best, cmpOutputSize));
+  report.add(archName, "runtime-add", sAdd);
+  report.add(archName, "runtime-release", sRelease);
 }
-#endif
+
+static void benchX86(BenchReport& report, BenchEnv& env, uint32_t archType) {
+  benchX86Emit(report, env, archType, false);
+  benchX86Emit(report, env, archType, true);
+#if !defined(ASMJIT_DISABLE_VALIDATION)
+  benchX86Serialize(report, env, archType);
+#endif // !ASMJIT_DISABLE_VALIDATION
+  benchX86Compile(report, env, archType);
+
+  if (archType == ArchInfo::kTypeHost)
+    benchX86Runtime(report, env);
+}
+#endif // ASMJIT_BUILD_X86
+
+// ============================================================================
+// [Main]
+// ============================================================================
 
 int main(int argc, char* argv[]) {
+  BenchConfig config;
+
+  if (!config.parse(argc, argv)) {
+    printf("Usage: asmjit_bench_x86 [--json] [--validate] [--logging] [--compact] [--packed] [--warmup=N] [--samples=N]\n");
+    return 1;
+  }
+
+  BenchReport report(config);
+  BenchEnv env(config);
+
+  report.begin();
 #if defined(ASMJIT_BUILD_X86)
-  benchX86(ArchInfo::kTypeX86);
-  benchX86(ArchInfo::kTypeX64);
+  benchX86(report, env, ArchInfo::kTypeX86);
+  benchX86(report, env, ArchInfo::kTypeX64);
 #endif // ASMJIT_BUILD_X86
+  report.end();
 
   return 0;
 }
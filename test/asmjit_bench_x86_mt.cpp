@@ -0,0 +1,199 @@
+// [AsmJit]
+// Complete x86/x64 JIT and Remote Assembler for C++.
+//
+// [License]
+// Zlib - See LICENSE.md file in the package.
+
+// [Dependencies]
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <thread>
+#include <vector>
+
+#include "./asmjit.h"
+#include "./asmjit_test_misc.h"
+
+using namespace asmjit;
+
+// ============================================================================
+// [Configuration]
+// ============================================================================
+
+// Functions kept alive by each thread before they are released, simulates a
+// code cache that is trimmed from time to time.
+static const uint32_t kNumLiveFuncs = 64;
+
+//! Benchmark configuration, see `BenchConfig::parse()` for command line.
+struct BenchConfig {
+  BenchConfig() noexcept
+    : maxThreads(std::thread::hardware_concurrency()),
+      funcsPerThread(2000) {
+    if (maxThreads < 4) maxThreads = 4;
+  }
+
+  bool parse(int argc, char* argv[]) noexcept {
+    for (int i = 1; i < argc; i++) {
+      const char* arg = argv[i];
+
+      if (::strncmp(arg, "--threads=", 10) == 0)
+        maxThreads = static_cast<uint32_t>(::strtoul(arg + 10, nullptr, 10));
+      else if (::strncmp(arg, "--funcs=", 8) == 0)
+        funcsPerThread = static_cast<uint32_t>(::strtoul(arg + 8, nullptr, 10));
+      else
+        return false;
+    }
+
+    if (maxThreads == 0) maxThreads = 1;
+    if (funcsPerThread == 0) funcsPerThread = 1;
+    return true;
+  }
+
+  uint32_t maxThreads;                   //!< Maximum number of threads.
+  uint32_t funcsPerThread;               //!< Functions compiled by each thread.
+};
+
+// ============================================================================
+// [BenchThread]
+// ============================================================================
+
+//! A single thread that owns its `CodeHolder` and `X86Compiler` and adds all
+//! functions it compiles to the shared `JitRuntime`.
+struct BenchThread {
+  BenchThread() noexcept
+    : runtime(nullptr),
+      funcCount(0),
+      error(kErrorOk) {}
+
+  void run() noexcept {
+    CodeHolder code;
+    X86Compiler cc;
+
+    void* live[kNumLiveFuncs];
+    uint32_t liveCount = 0;
+
+    for (uint32_t i = 0; i < funcCount; i++) {
+      code.init(runtime->getCodeInfo());
+      code.attach(&cc);
+
+      asmtest::generateAlphaBlend(cc);
+      Error err = cc.finalize();
+
+      void* func = nullptr;
+      if (err == kErrorOk)
+        err = runtime->add(&func, &code);
+
+      code.reset(false); // Detaches `cc`.
+
+      if (err != kErrorOk) {
+        error = err;
+        break;
+      }
+
+      live[liveCount++] = func;
+      if (liveCount == kNumLiveFuncs) {
+        while (liveCount)
+          runtime->release(live[--liveCount]);
+      }
+    }
+
+    while (liveCount)
+      runtime->release(live[--liveCount]);
+  }
+
+  JitRuntime* runtime;
+  uint32_t funcCount;
+  Error error;
+};
+
+// ============================================================================
+// [Bench]
+// ============================================================================
+
+static bool benchThreads(const BenchConfig& config, uint32_t threadCount, double* baseRate) {
+  JitRuntime runtime;
+  VMemMgr* memMgr = runtime.getMemMgr();
+
+  std::vector<BenchThread> workers(threadCount);
+  std::vector<std::thread> threads;
+
+  for (uint32_t i = 0; i < threadCount; i++) {
+    workers[i].runtime = &runtime;
+    workers[i].funcCount = config.funcsPerThread;
+  }
+
+  uint64_t startTime = OSUtils::getHighResTime();
+  for (uint32_t i = 0; i < threadCount; i++)
+    threads.push_back(std::thread(&BenchThread::run, &workers[i]));
+
+  for (uint32_t i = 0; i < threadCount; i++)
+    threads[i].join();
+  uint64_t elapsed = OSUtils::getHighResTime() - startTime;
+
+  for (uint32_t i = 0; i < threadCount; i++) {
+    if (workers[i].error != kErrorOk) {
+      printf("Thread %u failed: %s\n", i, DebugUtils::errorAsString(workers[i].error));
+      return false;
+    }
+  }
+
+  double seconds = static_cast<double>(elapsed) / 1e9;
+  double funcs = static_cast<double>(threadCount) * config.funcsPerThread;
+  double rate = seconds > 0.0 ? funcs / seconds : 0.0;
+
+  if (threadCount == 1)
+    *baseRate = rate;
+
+  uint64_t lockCount = memMgr->getLockCount();
+  uint64_t contended = memMgr->getLockContendedCount();
+
+  printf("%7u | %10.3f | %12.0f | %7.2fx | %10llu | %9llu (%5.2f%%) | %12.3f\n",
+    threadCount,
+    seconds * 1e3,
+    rate,
+    *baseRate > 0.0 ? rate / *baseRate : 0.0,
+    static_cast<unsigned long long>(lockCount),
+    static_cast<unsigned long long>(contended),
+    lockCount ? static_cast<double>(contended) * 100.0 / static_cast<double>(lockCount) : 0.0,
+    static_cast<double>(memMgr->getLockWaitTime()) / 1e6);
+
+  return true;
+}
+
+// ============================================================================
+// [Main]
+// ============================================================================
+
+int main(int argc, char* argv[]) {
+  BenchConfig config;
+
+  if (!config.parse(argc, argv)) {
+    printf("Usage: asmjit_bench_x86_mt [--threads=N] [--funcs=N]\n");
+    return 1;
+  }
+
+  printf("Functions per thread: %u | Live functions per thread: %u\n\n",
+    config.funcsPerThread, kNumLiveFuncs);
+  printf("%7s | %10s | %12s | %8s | %10s | %19s | %12s\n",
+    "Threads", "Time [ms]", "Funcs/sec", "Scaling", "VMem Locks", "Contended", "Waiting [ms]");
+  printf("---------------------------------------------------------------------------------------------\n");
+
+  // Run 1, 2, 4, ... threads and always finish with `maxThreads`.
+  double baseRate = 0.0;
+  uint32_t threadCount = 1;
+
+  for (;;) {
+    if (!benchThreads(config, threadCount, &baseRate))
+      return 1;
+
+    if (threadCount == config.maxThreads)
+      break;
+
+    threadCount *= 2;
+    if (threadCount > config.maxThreads)
+      threadCount = config.maxThreads;
+  }
+
+  return 0;
+}
@@ -46,6 +46,79 @@ struct TestErrorHandler : public ErrorHandler {
 
 typedef void (*VoidFunc)(void);
 
+#if !defined(ASMJIT_DISABLE_VALIDATION)
+// Encodes every decoded vector instruction again by using equivalent forms
+// (MR/RM, commuted sources, VEX/EVEX) and reports instructions that have a
+// shorter alternative than the one emitted.
+struct ShortestEncodingAudit : public X86DecodeHandler {
+  ShortestEncodingAudit(uint32_t archType) : failures(0) {
+    code.init(CodeInfo(archType));
+    code.attach(&a);
+  }
+
+  uint32_t encodedSize(const X86DecodedInst& inst, const Operand_* opArray, uint32_t options) {
+    a.setOffset(0);
+    a.setOptions(options);
+
+    if (inst.detail.extraReg.isValid())
+      a.setExtraReg(inst.detail.extraReg);
+    else
+      a.resetExtraReg();
+
+    if (a.emitOpArray(inst.getInstId(), opArray, inst.opCount) != kErrorOk) {
+      a.resetLastError();
+      return 0xFFFFFFFFU;
+    }
+
+    return static_cast<uint32_t>(a.getOffset());
+  }
+
+  virtual Error handleInst(const X86DecodedInst& inst) noexcept {
+    // Instructions without operands have nothing to choose from, `vzeroall`
+    // and `vzeroupper` are emitted with an explicit `vex3()` prefix.
+    uint32_t instId = inst.getInstId();
+    if (!X86Inst::getInst(instId).hasFlag(X86Inst::kFlagVec) || inst.opCount == 0)
+      return kErrorOk;
+
+    Operand ops[6];
+    for (uint32_t i = 0; i < inst.opCount; i++)
+      ops[i] = inst.operands[i];
+
+    // VEX3 is reported by the decoder if used, the assembler must not need it.
+    uint32_t options = inst.detail.options & ~X86Inst::kOptionVex3;
+    uint32_t alt[3];
+
+    alt[0] = encodedSize(inst, ops, options ^ X86Inst::kOptionModMR);
+    alt[1] = encodedSize(inst, ops, options & ~X86Inst::kOptionEvex);
+    alt[2] = 0xFFFFFFFFU;
+
+    if (inst.opCount == 3 && ops[1].isReg() && ops[2].isReg() && X86Inst::isCommutative(instId)) {
+      Utils::swap(ops[1], ops[2]);
+      alt[2] = encodedSize(inst, ops, options);
+    }
+
+    uint32_t best = inst.size;
+    for (uint32_t i = 0; i < 3; i++)
+      if (alt[i] < best) best = alt[i];
+
+    if (best < inst.size) {
+      printf("NOT MINIMAL at 0x%08X: %s (%u bytes, %u possible)\n",
+        static_cast<unsigned int>(inst.address),
+        X86Inst::getNameById(instId),
+        static_cast<unsigned int>(inst.size),
+        static_cast<unsigned int>(best));
+      failures++;
+    }
+
+    return kErrorOk;
+  }
+
+  CodeHolder code;
+  X86Assembler a;
+  uint32_t failures;
+};
+#endif // ASMJIT_DISABLE_VALIDATION
+
 int main(int argc, char* argv[]) {
   TestErrorHandler eh;
 
@@ -78,6 +151,16 @@ int main(int argc, char* argv[]) {
     X86Assembler a(&code);
     asmtest::generateOpcodes(a, info.useRex1, info.useRex2);
 
+#if !defined(ASMJIT_DISABLE_VALIDATION)
+    // Every instruction emitted must decode back to the same bytes.
+    code.sync();
+    X86Decoder decoder(info.archType);
+    if (decoder.decodeAll(nullptr, code.getSectionEntry(0)->getBuffer()) != kErrorOk) {
+      printf("DECODER FAILED at offset 0x%08X\n", static_cast<unsigned int>(decoder.getErrorOffset()));
+      return 1;
+    }
+#endif // ASMJIT_DISABLE_VALIDATION
+
     // If this is the host architecture the code generated can be executed
     // for debugging purposes (the first instruction is ret anyway).
     if (code.getArchType() == ArchInfo::kTypeHost) {
@@ -88,5 +171,45 @@ int main(int argc, char* argv[]) {
     }
   }
 
+#if !defined(ASMJIT_DISABLE_VALIDATION)
+  // Emit all X64 opcodes again with `kHintShortestEncoding` and check that
+  // no vector instruction has a shorter equivalent encoding.
+  {
+    size_t sizes[2];
+    ShortestEncodingAudit audit(ArchInfo::kTypeX64);
+
+    for (uint32_t i = 0; i < 2; i++) {
+      CodeHolder code;
+      code.init(CodeInfo(ArchInfo::kTypeX64));
+      code.setErrorHandler(&eh);
+
+      if (i == 1)
+        code.setGlobalHints(code.getGlobalHints() | CodeEmitter::kHintShortestEncoding);
+
+      X86Assembler a(&code);
+      asmtest::generateOpcodes(a, false, true);
+
+      code.sync();
+      sizes[i] = code.getSectionEntry(0)->getBuffer().getLength();
+
+      if (i == 1) {
+        X86Decoder decoder(ArchInfo::kTypeX64);
+        if (decoder.decodeAll(&audit, code.getSectionEntry(0)->getBuffer()) != kErrorOk) {
+          printf("DECODER FAILED at offset 0x%08X\n", static_cast<unsigned int>(decoder.getErrorOffset()));
+          return 1;
+        }
+      }
+    }
+
+    printf("Shortest encoding [ARCH=X64 REX1=false REX2=true]: %u bytes -> %u bytes (%u saved)\n",
+      static_cast<unsigned int>(sizes[0]),
+      static_cast<unsigned int>(sizes[1]),
+      static_cast<unsigned int>(sizes[0] - sizes[1]));
+
+    if (audit.failures != 0)
+      return 1;
+  }
+#endif // ASMJIT_DISABLE_VALIDATION
+
   return 0;
 }
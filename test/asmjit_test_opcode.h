@@ -228,7 +228,7 @@ static void generateOpcodes(asmjit::X86Assembler& a, bool useRex1 = false, bool
   a.inc(intptr_gpA);
   a.int_(13);
   a.int3();
-  a.into();
+  if (!isX64) a.into();
   a.lea(gzA, intptr_gpB);
   a.mov(gLoA, 1);
   a.mov(gHiA, 1);
@@ -411,7 +411,7 @@ static void generateOpcodes(asmjit::X86Assembler& a, bool useRex1 = false, bool
   a.sub(gzA, intptr_gpB);
   a.sub(intptr_gpA, 1);
   a.sub(intptr_gpA, gzB);
-  a.swapgs();
+  if (isX64) a.swapgs();
   a.test(gzA, 1);
   a.test(gzA, gzB);
   a.test(intptr_gpA, 1);
@@ -4937,7 +4937,7 @@ static void generateOpcodes(asmjit::X86Assembler& a, bool useRex1 = false, bool
   a.vpextrd(anyptr_gpA, xmmB, 0);
   if (isX64) a.vpextrd(gzA, xmmB, 0);
   if (isX64) a.vpextrq(gzA, xmmB, 0);
-  a.vpextrq(anyptr_gpA, xmmB, 0);
+  if (isX64) a.vpextrq(anyptr_gpA, xmmB, 0);
   a.vpextrw(gdA, xmmB, 0);
   a.vpextrw(gzA, xmmB, 0);
   a.vpextrw(gdA, xmmB, 0);
@@ -4962,7 +4962,7 @@ static void generateOpcodes(asmjit::X86Assembler& a, bool useRex1 = false, bool
   a.vpinsrd(xmmA, xmmB, anyptr_gpC, 0);
   a.vpinsrd(xmmA, xmmB, gzC, 0);
   if (isX64) a.vpinsrq(xmmA, xmmB, gzC, 0);
-  a.vpinsrq(xmmA, xmmB, anyptr_gpC, 0);
+  if (isX64) a.vpinsrq(xmmA, xmmB, anyptr_gpC, 0);
   a.vpinsrw(xmmA, xmmB, gdC, 0);
   a.vpinsrw(xmmA, xmmB, anyptr_gpC, 0);
   a.vpinsrw(xmmA, xmmB, gzC, 0);
@@ -34,6 +34,16 @@ static void dumpCpu(void) {
   INFO("  Model                   : %u", cpu.getModel());
   INFO("  Stepping                : %u", cpu.getStepping());
   INFO("  HW-Threads Count        : %u", cpu.getHwThreadsCount());
+  INFO("  Cores Count             : %u", cpu.getCoresCount());
+  INFO("  Threads Per Core        : %u", cpu.getThreadsPerCore());
+
+  for (uint32_t i = 0; i < cpu.getCacheCount(); i++) {
+    static const char cacheTypes[] = "?DIU";
+    const CpuInfo::CacheInfo& cache = cpu.getCache(i);
+    INFO("  L%u%c Cache               : %u KB, %u-way, %u B line, shared by %u",
+      cache.getLevel(), cacheTypes[cache.getType()],
+      cache.getSize() / 1024, cache.getWays(), cache.getLineSize(), cache.getSharedBy());
+  }
   INFO("");
 
   // --------------------------------------------------------------------------
@@ -133,6 +143,7 @@ static void dumpCpu(void) {
     { CpuInfo::kX86FeatureRTM             , "RTM"                  },
     { CpuInfo::kX86FeatureTSX             , "TSX"                  },
     { CpuInfo::kX86FeatureERMS            , "ERMS"                 },
+    { CpuInfo::kX86FeatureFSRM            , "FSRM"                 },
     { CpuInfo::kX86FeatureFSGSBASE        , "FSGSBASE"             },
     { CpuInfo::kX86FeatureAVX512_F        , "AVX512-F"             },
     { CpuInfo::kX86FeatureAVX512_CDI      , "AVX512-CDI"           },
@@ -153,6 +164,7 @@ static void dumpCpu(void) {
   INFO("  Brand Index             : %u", cpu.getX86BrandIndex());
   INFO("  CL Flush Cache Line     : %u", cpu.getX86FlushCacheLineSize());
   INFO("  Max logical Processors  : %u", cpu.getX86MaxLogicalProcessors());
+  INFO("  Hybrid (Core Type)      : %s (0x%02X)", cpu.isX86Hybrid() ? "true" : "false", cpu.getX86CoreType());
   INFO("");
 
   INFO("X86 Features:");
@@ -10,6 +10,10 @@
 #include <string.h>
 #include <setjmp.h>
 
+#if defined(__linux__) && (defined(__GNUC__) || defined(__clang__))
+# include <unwind.h>
+#endif
+
 #include "./asmjit.h"
 #include "./asmjit_test_misc.h"
 
@@ -45,6 +49,20 @@ public:
   StringBuilder _name;
 };
 
+// ============================================================================
+// [X86TestPerf]
+// ============================================================================
+
+//! Performance record of a single `X86Test`, see `X86TestManager::_perf`.
+struct X86TestPerf {
+  const char* name;                      //!< Name of the test.
+  uint64_t compileTime;                  //!< Minimum time of `compile()` and `finalize()` in ns.
+  uint64_t runTime;                      //!< Minimum time of `run()` in ns, zero if not measured.
+  uint64_t codeSize;                     //!< Size of the generated code.
+  uint64_t spillCount;                   //!< Registers saved to memory by the register allocator.
+  uint64_t loadCount;                    //!< Registers loaded from memory by the register allocator.
+};
+
 // ============================================================================
 // [X86TestManager]
 // ============================================================================
@@ -66,6 +84,16 @@ public:
 
   int run();
 
+  //! Measure compile time of `test` (without logging and statistics).
+  void measureCompile(X86Test* test, X86TestPerf& perf);
+  //! Print the performance table to `file`.
+  void printPerf(FILE* file);
+  //! Write performance records to `fileName`, which is used as a baseline later.
+  bool recordPerf(const char* fileName);
+  //! Compare performance records with the baseline read from `fileName` and
+  //! print regressions, returns the number of regressions or -1 on error.
+  int comparePerf(FILE* file, const char* fileName);
+
   // --------------------------------------------------------------------------
   // [Members]
   // --------------------------------------------------------------------------
@@ -78,6 +106,32 @@ public:
   int _binSize;
   bool _verbose;
   StringBuilder _output;
+
+  // Performance corpus, enabled by `--perf`:
+  //
+  //   --perf                 - Measure and print compile time, code size, and
+  //                            spills and loads of each test.
+  //   --perf-run             - Measure also the time of `X86Test::run()`.
+  //   --perf-samples=N       - Number of compilations (and runs) measured, the
+  //                            minimum time is used (default 10).
+  //   --perf-record=FILE     - Write the results to FILE (the baseline).
+  //   --perf-baseline=FILE   - Compare the results with FILE and fail if any
+  //                            test regressed beyond the thresholds.
+  //   --perf-time=P          - Threshold of times in percent (default 50),
+  //                            differences below 10us are always ignored.
+  //   --perf-size=P          - Threshold of code size in percent (default 0).
+  //
+  // Code size and spills are deterministic for the same target, so they can
+  // be compared exactly, times depend on the machine and are only comparable
+  // with a baseline recorded by the same machine.
+  bool _perf;
+  bool _perfRun;
+  uint32_t _perfSamples;
+  uint32_t _perfTimeThreshold;
+  uint32_t _perfSizeThreshold;
+  const char* _perfRecord;
+  const char* _perfBaseline;
+  X86TestPerf* _perfData;
 };
 
 X86TestManager::X86TestManager() :
@@ -85,7 +139,15 @@ X86TestManager::X86TestManager() :
   _zoneHeap(&_zone),
   _returnCode(0),
   _binSize(0),
-  _verbose(false) {}
+  _verbose(false),
+  _perf(false),
+  _perfRun(false),
+  _perfSamples(10),
+  _perfTimeThreshold(50),
+  _perfSizeThreshold(0),
+  _perfRecord(nullptr),
+  _perfBaseline(nullptr),
+  _perfData(nullptr) {}
 
 X86TestManager::~X86TestManager() {
   size_t i;
@@ -113,6 +175,11 @@ int X86TestManager::run() {
 
   MyErrorHandler errorHandler;
 
+  if (_perf) {
+    _perfData = static_cast<X86TestPerf*>(_zone.allocZeroed(count * sizeof(X86TestPerf)));
+    if (!_perfData) return 1;
+  }
+
   for (i = 0; i < count; i++) {
     JitRuntime runtime;
 
@@ -132,12 +199,31 @@ int X86TestManager::run() {
 #endif // ASMJIT_DISABLE_LOGGING
 
     X86Compiler cc(&code);
+    cc.setStatsEnabled(true);
+
     X86Test* test = _tests[i];
     test->compile(cc);
 
     Error err = cc.finalize();
     void* func;
 
+    X86TestPerf* perf = _perf ? &_perfData[i] : nullptr;
+    if (perf) {
+      CBPass* ra = cc.getPassByName("RA");
+
+      perf->name = test->getName();
+      perf->codeSize = code.getCodeSize();
+      if (ra) {
+        perf->spillCount = ra->getStats().spillCount;
+        perf->loadCount = ra->getStats().loadCount;
+      }
+    }
+
+#if !defined(ASMJIT_DISABLE_LOGGING)
+    if (_verbose && err == kErrorOk)
+      cc.logStats();
+#endif // ASMJIT_DISABLE_LOGGING
+
     if (err == kErrorOk)
       err = runtime.add(&func, &code);
     if (_verbose) fflush(file);
@@ -148,6 +234,18 @@ int X86TestManager::run() {
 
       if (test->run(func, result, expect)) {
         fprintf(file, "[Success] %s.\n", test->getName());
+
+        if (perf && _perfRun) {
+          for (uint32_t s = 0; s < _perfSamples; s++) {
+            StringBuilder r, e;
+            uint64_t startTime = OSUtils::getHighResTime();
+            test->run(func, r, e);
+            uint64_t time = OSUtils::getHighResTime() - startTime;
+
+            if (s == 0 || time < perf->runTime)
+              perf->runTime = time;
+          }
+        }
       }
       else {
 #if !defined(ASMJIT_DISABLE_LOGGING)
@@ -166,6 +264,9 @@ int X86TestManager::run() {
       }
 
       runtime.release(func);
+
+      if (perf)
+        measureCompile(test, *perf);
     }
     else {
 #if !defined(ASMJIT_DISABLE_LOGGING)
@@ -187,9 +288,168 @@ int X86TestManager::run() {
   fputs(_output.getData(), file);
   fflush(file);
 
+  if (_perf) {
+    printPerf(file);
+
+    if (_perfBaseline) {
+      int regressions = comparePerf(file, _perfBaseline);
+      if (regressions != 0)
+        _returnCode = 1;
+    }
+
+    if (_perfRecord && !recordPerf(_perfRecord)) {
+      fprintf(file, "[Perf] Cannot write '%s'.\n", _perfRecord);
+      _returnCode = 1;
+    }
+  }
+
   return _returnCode;
 }
 
+void X86TestManager::measureCompile(X86Test* test, X86TestPerf& perf) {
+  MyErrorHandler errorHandler;
+
+  for (uint32_t s = 0; s < _perfSamples; s++) {
+    JitRuntime runtime;
+    CodeHolder code;
+
+    code.init(runtime.getCodeInfo());
+    code.setErrorHandler(&errorHandler);
+
+    uint64_t startTime = OSUtils::getHighResTime();
+    X86Compiler cc(&code);
+    test->compile(cc);
+    cc.finalize();
+    uint64_t time = OSUtils::getHighResTime() - startTime;
+
+    if (s == 0 || time < perf.compileTime)
+      perf.compileTime = time;
+  }
+}
+
+void X86TestManager::printPerf(FILE* file) {
+  typedef unsigned long long ULL;
+  size_t count = _tests.getLength();
+
+  fprintf(file, "%-50s %12s %12s %8s %8s %8s\n", "Test", "Compile [ns]", "Run [ns]", "Size", "Spills", "Loads");
+  for (size_t i = 0; i < count; i++) {
+    const X86TestPerf& perf = _perfData[i];
+    if (!perf.name) continue;
+
+    fprintf(file, "%-50s %12llu %12llu %8llu %8llu %8llu\n",
+      perf.name,
+      static_cast<ULL>(perf.compileTime),
+      static_cast<ULL>(perf.runTime),
+      static_cast<ULL>(perf.codeSize),
+      static_cast<ULL>(perf.spillCount),
+      static_cast<ULL>(perf.loadCount));
+  }
+  fflush(file);
+}
+
+bool X86TestManager::recordPerf(const char* fileName) {
+  typedef unsigned long long ULL;
+
+  FILE* f = fopen(fileName, "wb");
+  if (!f) return false;
+
+  // One test per line, fields are separated by tabs as names contain spaces.
+  size_t count = _tests.getLength();
+  for (size_t i = 0; i < count; i++) {
+    const X86TestPerf& perf = _perfData[i];
+    if (!perf.name) continue;
+
+    fprintf(f, "%s\t%llu\t%llu\t%llu\t%llu\t%llu\n",
+      perf.name,
+      static_cast<ULL>(perf.compileTime),
+      static_cast<ULL>(perf.runTime),
+      static_cast<ULL>(perf.codeSize),
+      static_cast<ULL>(perf.spillCount),
+      static_cast<ULL>(perf.loadCount));
+  }
+
+  return fclose(f) == 0;
+}
+
+//! \internal
+//!
+//! Get whether `value` regressed from `base` by more than `threshold` percent
+//! and more than `slack`.
+static bool X86TestPerf_regressed(uint64_t value, uint64_t base, uint32_t threshold, uint64_t slack) {
+  return value > base + slack && (value - base) * 100 > base * threshold;
+}
+
+int X86TestManager::comparePerf(FILE* file, const char* fileName) {
+  typedef unsigned long long ULL;
+
+  FILE* f = fopen(fileName, "rb");
+  if (!f) {
+    fprintf(file, "[Perf] Cannot read '%s'.\n", fileName);
+    return -1;
+  }
+
+  // Times below this difference are noise of short tests.
+  const uint64_t kTimeSlack = 10000;
+
+  int regressions = 0;
+  uint32_t compared = 0;
+  char line[512];
+
+  while (fgets(line, sizeof(line), f)) {
+    char* tab = strchr(line, '\t');
+    if (!tab) continue;
+    *tab = '\0';
+
+    ULL base[5];
+    if (sscanf(tab + 1, "%llu %llu %llu %llu %llu", &base[0], &base[1], &base[2], &base[3], &base[4]) != 5)
+      continue;
+
+    X86Test* test = nullptr;
+    X86TestPerf* perf = nullptr;
+
+    for (size_t i = 0; i < _tests.getLength(); i++) {
+      if (_perfData[i].name && strcmp(_perfData[i].name, line) == 0) {
+        test = _tests[i];
+        perf = &_perfData[i];
+        break;
+      }
+    }
+
+    if (!perf) continue;
+    compared++;
+
+    // Measure the compile time again before reporting it, a single slow
+    // measurement is more likely a noise of the machine than a regression.
+    if (X86TestPerf_regressed(perf->compileTime, base[0], _perfTimeThreshold, kTimeSlack)) {
+      uint64_t previous = perf->compileTime;
+      measureCompile(test, *perf);
+      perf->compileTime = std::min<uint64_t>(perf->compileTime, previous);
+    }
+
+    static const char* const kFieldNames[5] = { "compile time", "run time", "code size", "spills", "loads" };
+    uint64_t value[5] = { perf->compileTime, perf->runTime, perf->codeSize, perf->spillCount, perf->loadCount };
+    bool regressed[5] = {
+      X86TestPerf_regressed(value[0], base[0], _perfTimeThreshold, kTimeSlack),
+      _perfRun && base[1] && X86TestPerf_regressed(value[1], base[1], _perfTimeThreshold, kTimeSlack),
+      X86TestPerf_regressed(value[2], base[2], _perfSizeThreshold, 0),
+      value[3] > base[3],
+      value[4] > base[4]
+    };
+
+    for (uint32_t j = 0; j < 5; j++) {
+      if (!regressed[j]) continue;
+
+      fprintf(file, "[Regress] %s: %s %llu -> %llu\n", perf->name, kFieldNames[j], base[j], static_cast<ULL>(value[j]));
+      regressions++;
+    }
+  }
+
+  fclose(f);
+  fprintf(file, "[Perf] Compared %u tests with '%s', %d regression(s).\n", compared, fileName, regressions);
+  fflush(file);
+  return regressions;
+}
+
 // ============================================================================
 // [X86Test_AlignBase]
 // ============================================================================
@@ -569,6 +829,217 @@ public:
   }
 };
 
+// ============================================================================
+// [X86Test_JumpSwitchTable]
+// ============================================================================
+
+class X86Test_JumpSwitchTable : public X86Test {
+public:
+  X86Test_JumpSwitchTable(bool useSection)
+    : X86Test(useSection ? "[Jump] Switch table (.rodata)" : "[Jump] Switch table"),
+      _useSection(useSection) {}
+
+  static void add(X86TestManager& mgr) {
+    mgr.add(new X86Test_JumpSwitchTable(false));
+    mgr.add(new X86Test_JumpSwitchTable(true));
+  }
+
+  virtual void compile(X86Compiler& cc) {
+    if (_useSection) {
+      SectionEntry* rodata;
+      cc.getCode()->newSection(&rodata, ".rodata", Globals::kInvalidIndex, SectionEntry::kFlagConst, 64);
+      cc.setConstSection(rodata);
+    }
+
+    cc.addFunc(FuncSignature2<int, int, int>(CallConv::kIdHost));
+
+    uint32_t j;
+    X86Gp n = cc.newInt32("n");
+    X86Gp acc = cc.newInt32("acc");
+    X86Gp i = cc.newInt32("i");
+    X86Gp op = cc.newInt32("op");
+    X86Gp e[kExtraCount];
+
+    cc.setArg(0, n);
+    cc.setArg(1, acc);
+    cc.xor_(i, i);
+
+    // Values live across the whole loop, which causes spills.
+    for (j = 0; j < kExtraCount; j++) {
+      e[j] = cc.newInt32("e%u", j);
+      cc.mov(e[j], j * 3 + 1);
+    }
+
+    Label L_Loop = cc.newLabel();
+    Label L_Next = cc.newLabel();
+    Label L_Done = cc.newLabel();
+    Label L_Default = cc.newLabel();
+    Label L_Case[5];
+
+    for (j = 0; j < 5; j++)
+      L_Case[j] = cc.newLabel();
+
+    // Keys 4 and 5 share the target, keys 3 and 7 use the default (the table
+    // has a hole at 3).
+    static const int32_t keys[] = { 1, 0, 6, 2, 4, 5 };
+    Label targets[] = { L_Case[1], L_Case[0], L_Case[3], L_Case[2], L_Case[4], L_Case[4] };
+
+    cc.bind(L_Loop);
+    cc.cmp(i, n);
+    cc.jge(L_Done);
+    cc.mov(op, i);
+    cc.and_(op, 7);
+    cc.switch_(op, keys, targets, 6, L_Default);
+
+    cc.bind(L_Case[0]);
+    cc.add(acc, 1);
+    cc.add(e[0], acc);
+    cc.jmp(L_Next);
+
+    cc.bind(L_Case[1]);
+    cc.add(acc, 10);
+    cc.jmp(L_Next);
+
+    cc.bind(L_Case[2]);
+    cc.shl(acc, 1);
+    cc.add(e[kExtraCount - 1], i);
+    cc.jmp(L_Next);
+
+    cc.bind(L_Case[3]);
+    cc.sub(acc, 3);
+    cc.xor_(e[1], acc);
+    cc.jmp(L_Next);
+
+    cc.bind(L_Case[4]);
+    cc.xor_(acc, i);
+    cc.jmp(L_Next);
+
+    cc.bind(L_Default);
+    cc.add(acc, 100);
+    cc.add(e[2], i);
+
+    cc.bind(L_Next);
+    cc.inc(i);
+    cc.jmp(L_Loop);
+
+    cc.bind(L_Done);
+    for (j = 0; j < kExtraCount; j++)
+      cc.add(acc, e[j]);
+
+    cc.ret(acc);
+    cc.endFunc();
+  }
+
+  virtual bool run(void* _func, StringBuilder& result, StringBuilder& expect) {
+    typedef int (*Func)(int, int);
+    Func func = ptr_as_func<Func>(_func);
+
+    uint32_t e[kExtraCount];
+    uint32_t j, acc = 7;
+
+    for (j = 0; j < kExtraCount; j++)
+      e[j] = j * 3 + 1;
+
+    for (uint32_t i = 0; i < 100; i++) {
+      switch (i & 7) {
+        case 0: acc += 1; e[0] += acc; break;
+        case 1: acc += 10; break;
+        case 2: acc <<= 1; e[kExtraCount - 1] += i; break;
+        case 6: acc -= 3; e[1] ^= acc; break;
+        case 4:
+        case 5: acc ^= i; break;
+        default: acc += 100; e[2] += i; break;
+      }
+    }
+
+    for (j = 0; j < kExtraCount; j++)
+      acc += e[j];
+
+    int resultRet = func(100, 7);
+    int expectRet = static_cast<int>(acc);
+
+    result.setFormat("ret=%d", resultRet);
+    expect.setFormat("ret=%d", expectRet);
+
+    return resultRet == expectRet;
+  }
+
+  enum { kExtraCount = 16 };
+  bool _useSection;
+};
+
+// ============================================================================
+// [X86Test_JumpSwitchSparse]
+// ============================================================================
+
+class X86Test_JumpSwitchSparse : public X86Test {
+public:
+  X86Test_JumpSwitchSparse() : X86Test("[Jump] Switch sparse") {}
+
+  static void add(X86TestManager& mgr) {
+    mgr.add(new X86Test_JumpSwitchSparse());
+  }
+
+  virtual void compile(X86Compiler& cc) {
+    cc.addFunc(FuncSignature1<int, int>(CallConv::kIdHost));
+
+    X86Gp x = cc.newInt32("x");
+    X86Gp r = cc.newInt32("r");
+    cc.setArg(0, x);
+
+    Label L_Done = cc.newLabel();
+    Label L_Default = cc.newLabel();
+    Label targets[kCaseCount];
+
+    uint32_t i;
+    for (i = 0; i < kCaseCount; i++)
+      targets[i] = cc.newLabel();
+
+    cc.switch_(x, getKeys(), targets, kCaseCount, L_Default);
+
+    for (i = 0; i < kCaseCount; i++) {
+      cc.bind(targets[i]);
+      cc.mov(r, static_cast<int>((i + 1) * 11));
+      cc.jmp(L_Done);
+    }
+
+    cc.bind(L_Default);
+    cc.mov(r, -1);
+
+    cc.bind(L_Done);
+    cc.ret(r);
+    cc.endFunc();
+  }
+
+  virtual bool run(void* _func, StringBuilder& result, StringBuilder& expect) {
+    typedef int (*Func)(int);
+    Func func = ptr_as_func<Func>(_func);
+
+    static const int32_t misses[] = { 0, 4, -1001, 1073741823, -2147483647 - 1, 2147483647 };
+    const int32_t* keys = getKeys();
+
+    uint32_t i;
+    for (i = 0; i < kCaseCount; i++) {
+      result.appendFormat("%d ", func(keys[i]));
+      expect.appendFormat("%d ", static_cast<int>((i + 1) * 11));
+    }
+
+    for (i = 0; i < ASMJIT_ARRAY_SIZE(misses); i++) {
+      result.appendFormat("%d ", func(misses[i]));
+      expect.appendString("-1 ");
+    }
+
+    return result.eq(expect);
+  }
+
+  static const int32_t* getKeys() {
+    static const int32_t keys[] = { 4096, -1000, 3, 17, 250, 70000, 1073741824, -5, 99 };
+    return keys;
+  }
+
+  enum { kCaseCount = 9 };
+};
+
 // ============================================================================
 // [X86Test_AllocBase]
 // ============================================================================
@@ -885,345 +1356,407 @@ public:
 };
 
 // ============================================================================
-// [X86Test_AllocImul1]
+// [X86Test_AllocRemat]
 // ============================================================================
 
-class X86Test_AllocImul1 : public X86Test {
+class X86Test_AllocRemat : public X86Test {
 public:
-  X86Test_AllocImul1() : X86Test("[Alloc] IMUL #1") {}
+  X86Test_AllocRemat() : X86Test("[Alloc] Remat") {}
+
+  enum { kCount = 20 };
 
   static void add(X86TestManager& mgr) {
-    mgr.add(new X86Test_AllocImul1());
+    mgr.add(new X86Test_AllocRemat());
   }
 
   virtual void compile(X86Compiler& cc) {
-    cc.addFunc(FuncSignature4<void, int*, int*, int, int>(CallConv::kIdHost));
+    cc.addFunc(FuncSignature1<int, int>(CallConv::kIdHost));
 
-    X86Gp dstHi = cc.newIntPtr("dstHi");
-    X86Gp dstLo = cc.newIntPtr("dstLo");
+    X86Gp n = cc.newInt32("n");
+    X86Gp sum = cc.newInt32("sum");
+    X86Gp ptr = cc.newIntPtr("ptr");
+    X86Gp zero = cc.newInt32("zero");
+    X86Gp x[kCount];
+    X86Xmm k = cc.newXmmSd("k");
 
-    X86Gp vHi = cc.newInt32("vHi");
-    X86Gp vLo = cc.newInt32("vLo");
-    X86Gp src = cc.newInt32("src");
+    cc.setArg(0, n);
 
-    cc.setArg(0, dstHi);
-    cc.setArg(1, dstLo);
-    cc.setArg(2, vLo);
-    cc.setArg(3, src);
+    // More constants than registers, the allocator has to recreate them.
+    uint32_t i;
+    for (i = 0; i < kCount; i++) {
+      x[i] = cc.newInt32("x%u", i);
+      cc.mov(x[i], static_cast<int>(i + 1));
+    }
 
-    cc.imul(vHi, vLo, src);
+    X86Mem stack = cc.newStack(4, 4);
+    cc.lea(ptr, stack);
+    cc.xor_(zero, zero);
+    cc.movsd(k, cc.newDoubleConst(kConstScopeLocal, 2.0));
+    cc.mov(sum, zero);
 
-    cc.mov(x86::dword_ptr(dstHi), vHi);
-    cc.mov(x86::dword_ptr(dstLo), vLo);
+    Label L_Loop = cc.newLabel();
+    cc.bind(L_Loop);
+
+    for (i = 0; i < kCount; i++) {
+      cc.add(sum, x[i]);
+    }
+
+    cc.mov(x86::dword_ptr(ptr), sum);
+    cc.add(sum, zero);
+    cc.dec(n);
+    cc.jnz(L_Loop);
+
+    X86Gp t = cc.newInt32("t");
+    cc.cvttsd2si(t, k);
+    cc.add(t, x86::dword_ptr(ptr));
+
+    cc.ret(t);
     cc.endFunc();
   }
 
   virtual bool run(void* _func, StringBuilder& result, StringBuilder& expect) {
-    typedef void (*Func)(int*, int*, int, int);
+    typedef int (*Func)(int);
     Func func = ptr_as_func<Func>(_func);
 
-    int v0 = 4;
-    int v1 = 4;
-
-    int resultHi;
-    int resultLo;
-
-    int expectHi = 0;
-    int expectLo = v0 * v1;
-
-    func(&resultHi, &resultLo, v0, v1);
+    int resultRet = func(3);
+    int expectRet = 2 + 3 * (kCount * (kCount + 1) / 2);
 
-    result.setFormat("hi=%d, lo=%d", resultHi, resultLo);
-    expect.setFormat("hi=%d, lo=%d", expectHi, expectLo);
+    result.setFormat("ret=%d", resultRet);
+    expect.setFormat("ret=%d", expectRet);
 
-    return resultHi == expectHi && resultLo == expectLo;
+    return resultRet == expectRet;
   }
 };
 
 // ============================================================================
-// [X86Test_AllocImul2]
+// [X86Test_AllocCoalesce]
 // ============================================================================
 
-class X86Test_AllocImul2 : public X86Test {
+class X86Test_AllocCoalesce : public X86Test {
 public:
-  X86Test_AllocImul2() : X86Test("[Alloc] IMUL #2") {}
+  X86Test_AllocCoalesce() : X86Test("[Alloc] Coalesce"), _pass(nullptr) {}
 
   static void add(X86TestManager& mgr) {
-    mgr.add(new X86Test_AllocImul2());
+    mgr.add(new X86Test_AllocCoalesce());
   }
 
   virtual void compile(X86Compiler& cc) {
-    cc.addFunc(FuncSignature2<void, int*, const int*>(CallConv::kIdHost));
+    _pass = cc.getPassByName("RA");
+    cc.addFunc(FuncSignature2<int, int, int>(CallConv::kIdHost));
 
-    X86Gp dst = cc.newIntPtr("dst");
-    X86Gp src = cc.newIntPtr("src");
+    X86Gp n = cc.newInt32("n");
+    X86Gp m = cc.newInt32("m");
+    X86Gp acc = cc.newInt32("acc");
+    X86Gp keep = cc.newInt32("keep");
 
-    cc.setArg(0, dst);
-    cc.setArg(1, src);
+    cc.setArg(0, n);
+    cc.setArg(1, m);
 
-    for (unsigned int i = 0; i < 4; i++) {
-      X86Gp x  = cc.newInt32("x");
-      X86Gp y  = cc.newInt32("y");
-      X86Gp hi = cc.newInt32("hi");
+    cc.xor_(acc, acc);
+    cc.mov(keep, m);
 
-      cc.mov(x, x86::dword_ptr(src, 0));
-      cc.mov(y, x86::dword_ptr(src, 4));
+    Label L_Loop = cc.newLabel();
+    cc.bind(L_Loop);
 
-      cc.imul(hi, x, y);
-      cc.add(x86::dword_ptr(dst, 0), hi);
-      cc.add(x86::dword_ptr(dst, 4), x);
-    }
+    // `t` and `u` don't interfere with `acc`, `keep` interferes with `m`.
+    X86Gp t = cc.newInt32("t");
+    X86Gp u = cc.newInt32("u");
+
+    cc.mov(t, acc);
+    cc.add(t, m);
+    cc.mov(u, t);
+    cc.imul(u, u, 3);
+    cc.mov(acc, u);
+    cc.add(m, keep);
+
+    cc.dec(n);
+    cc.jnz(L_Loop);
 
+    X86Gp r = cc.newInt32("r");
+    cc.mov(r, acc);
+    cc.sub(r, m);
+    cc.ret(r);
     cc.endFunc();
   }
 
   virtual bool run(void* _func, StringBuilder& result, StringBuilder& expect) {
-    typedef void (*Func)(int*, const int*);
+    typedef int (*Func)(int, int);
     Func func = ptr_as_func<Func>(_func);
 
-    int src[2] = { 4, 9 };
-    int resultRet[2] = { 0, 0 };
-    int expectRet[2] = { 0, (4 * 9) * 4 };
+    int acc = 0, m = 2, keep = 2;
+    for (int i = 0; i < 4; i++) {
+      acc = (acc + m) * 3;
+      m += keep;
+    }
 
-    func(resultRet, src);
+    int resultRet = func(4, 2);
+    int expectRet = acc - m;
 
-    result.setFormat("ret={%d, %d}", resultRet[0], resultRet[1]);
-    expect.setFormat("ret={%d, %d}", expectRet[0], expectRet[1]);
+    // Copies to and from `t`, `u`, and `r` are removed, `mov keep, m` stays.
+    uint32_t coalesced = _pass ? static_cast<uint32_t>(_pass->getStats().coalesceCount) : 0;
 
-    return resultRet[0] == expectRet[0] && resultRet[1] == expectRet[1];
+    result.setFormat("ret=%d coalesced=%u", resultRet, coalesced);
+    expect.setFormat("ret=%d coalesced=%u", expectRet, 4U);
+
+    return result.eq(expect);
   }
+
+  CBPass* _pass;
 };
 
 // ============================================================================
-// [X86Test_AllocIdiv1]
+// [X86Test_AllocConstSection]
 // ============================================================================
 
-class X86Test_AllocIdiv1 : public X86Test {
+class X86Test_AllocConstSection : public X86Test {
 public:
-  X86Test_AllocIdiv1() : X86Test("[Alloc] IDIV #1") {}
+  X86Test_AllocConstSection() : X86Test("[Alloc] ConstSection") {}
 
   static void add(X86TestManager& mgr) {
-    mgr.add(new X86Test_AllocIdiv1());
+    mgr.add(new X86Test_AllocConstSection());
   }
 
   virtual void compile(X86Compiler& cc) {
-    cc.addFunc(FuncSignature2<int, int, int>(CallConv::kIdHost));
+    SectionEntry* rodata;
+    cc.getCode()->newSection(&rodata, ".rodata", Globals::kInvalidIndex, SectionEntry::kFlagConst, 64);
+    cc.setConstSection(rodata);
+
+    cc.addFunc(FuncSignature1<int, int>(CallConv::kIdHost));
 
     X86Gp a = cc.newInt32("a");
     X86Gp b = cc.newInt32("b");
-    X86Gp dummy = cc.newInt32("dummy");
-
     cc.setArg(0, a);
-    cc.setArg(1, b);
 
-    cc.xor_(dummy, dummy);
-    cc.idiv(dummy, a, b);
+    // Both constants are the same and end up in the same pool in `.rodata`.
+    cc.mov(b, cc.newInt32Const(kConstScopeLocal, 1000));
+    cc.add(a, b);
+    cc.add(a, cc.newInt32Const(kConstScopeGlobal, 1000));
+    cc.imul(a, cc.newInt32Const(kConstScopeLocal, 3));
 
     cc.ret(a);
     cc.endFunc();
   }
 
   virtual bool run(void* _func, StringBuilder& result, StringBuilder& expect) {
-    typedef int (*Func)(int, int);
+    typedef int (*Func)(int);
     Func func = ptr_as_func<Func>(_func);
 
-    int v0 = 2999;
-    int v1 = 245;
-
-    int resultRet = func(v0, v1);
-    int expectRet = 2999 / 245;
+    int resultRet = func(5);
+    int expectRet = (5 + 2000) * 3;
 
-    result.setFormat("result=%d", resultRet);
-    expect.setFormat("result=%d", expectRet);
+    result.setFormat("ret=%d", resultRet);
+    expect.setFormat("ret=%d", expectRet);
 
     return resultRet == expectRet;
   }
 };
 
 // ============================================================================
-// [X86Test_AllocSetz]
+// [X86Test_AllocSharedConst]
 // ============================================================================
 
-class X86Test_AllocSetz : public X86Test {
+class X86Test_AllocSharedConst : public X86Test {
 public:
-  X86Test_AllocSetz() : X86Test("[Alloc] SETZ") {}
+  X86Test_AllocSharedConst() : X86Test("[Alloc] SharedConst") {}
 
   static void add(X86TestManager& mgr) {
-    mgr.add(new X86Test_AllocSetz());
+    mgr.add(new X86Test_AllocSharedConst());
   }
 
   virtual void compile(X86Compiler& cc) {
-    cc.addFunc(FuncSignature3<void, int, int, char*>(CallConv::kIdHost));
+    // The store allocates the constant from its own runtime, far enough from
+    // the code to require [RIP + REL32] in 64-bit mode, but within 2GB.
+    static JitRuntime storeRuntime;
+    static JitConstStore store(&storeRuntime);
+    static const int32_t data[4] = { 1000, 2000, 3000, 4000 };
 
-    X86Gp src0 = cc.newInt32("src0");
-    X86Gp src1 = cc.newInt32("src1");
-    X86Gp dst0 = cc.newIntPtr("dst0");
+    const void* p;
+    store.intern(&p, data, sizeof(data));
+    if (store.getRefCount(p) > 1)
+      store.release(p);
 
-    cc.setArg(0, src0);
-    cc.setArg(1, src1);
-    cc.setArg(2, dst0);
+    cc.addFunc(FuncSignature1<int, int>(CallConv::kIdHost));
 
-    cc.cmp(src0, src1);
-    cc.setz(x86::byte_ptr(dst0));
+    X86Gp a = cc.newInt32("a");
+    cc.setArg(0, a);
 
+    cc.add(a, x86::dword_ptr(static_cast<uint64_t>((uintptr_t)p) + 4));
+    cc.ret(a);
     cc.endFunc();
   }
 
   virtual bool run(void* _func, StringBuilder& result, StringBuilder& expect) {
-    typedef void (*Func)(int, int, char*);
+    typedef int (*Func)(int);
     Func func = ptr_as_func<Func>(_func);
 
-    char resultBuf[4];
-    char expectBuf[4] = { 1, 0, 0, 1 };
-
-    func(0, 0, &resultBuf[0]); // We are expecting 1 (0 == 0).
-    func(0, 1, &resultBuf[1]); // We are expecting 0 (0 != 1).
-    func(1, 0, &resultBuf[2]); // We are expecting 0 (1 != 0).
-    func(1, 1, &resultBuf[3]); // We are expecting 1 (1 == 1).
+    int resultRet = func(5);
+    int expectRet = 2005;
 
-    result.setFormat("out={%d, %d, %d, %d}", resultBuf[0], resultBuf[1], resultBuf[2], resultBuf[3]);
-    expect.setFormat("out={%d, %d, %d, %d}", expectBuf[0], expectBuf[1], expectBuf[2], expectBuf[3]);
+    result.setFormat("ret=%d", resultRet);
+    expect.setFormat("ret=%d", expectRet);
 
-    return resultBuf[0] == expectBuf[0] &&
-           resultBuf[1] == expectBuf[1] &&
-           resultBuf[2] == expectBuf[2] &&
-           resultBuf[3] == expectBuf[3] ;
+    return resultRet == expectRet;
   }
 };
 
 // ============================================================================
-// [X86Test_AllocShlRor]
+// [X86Test_AllocLinearScan]
 // ============================================================================
 
-class X86Test_AllocShlRor : public X86Test {
+class X86Test_AllocLinearScan : public X86Test {
 public:
-  X86Test_AllocShlRor() : X86Test("[Alloc] SHL/ROR") {}
+  X86Test_AllocLinearScan() : X86Test("[Alloc] Linear-Scan") {}
+
+  enum { kCount = 24 };
 
   static void add(X86TestManager& mgr) {
-    mgr.add(new X86Test_AllocShlRor());
+    mgr.add(new X86Test_AllocLinearScan());
   }
 
   virtual void compile(X86Compiler& cc) {
-    cc.addFunc(FuncSignature4<void, int*, int, int, int>(CallConv::kIdHost));
+    CCFunc* func = cc.addFunc(FuncSignature2<int, int*, int>(CallConv::kIdHost));
+    func->setRAStrategy(kRAStrategyLinearScan);
 
-    X86Gp dst = cc.newIntPtr("dst");
-    X86Gp var = cc.newInt32("var");
-    X86Gp vShlParam = cc.newInt32("vShlParam");
-    X86Gp vRorParam = cc.newInt32("vRorParam");
+    X86Gp a = cc.newIntPtr("a");
+    X86Gp n = cc.newInt32("n");
+    X86Gp t = cc.newInt32("t");
+    X86Gp var[kCount];
 
-    cc.setArg(0, dst);
-    cc.setArg(1, var);
-    cc.setArg(2, vShlParam);
-    cc.setArg(3, vRorParam);
+    cc.setArg(0, a);
+    cc.setArg(1, n);
 
-    cc.shl(var, vShlParam);
-    cc.ror(var, vRorParam);
+    int i;
+    for (i = 0; i < kCount; i++) {
+      var[i] = cc.newInt32("var[%d]", i);
+      cc.mov(var[i], i);
+    }
 
-    cc.mov(x86::dword_ptr(dst), var);
+    // Variables with lower indexes are used last, so they are spilled first.
+    Label L = cc.newLabel();
+    cc.bind(L);
+
+    for (i = kCount - 1; i >= 0; i--) {
+      cc.add(var[i], n);
+    }
+
+    cc.dec(n);
+    cc.jnz(L);
+
+    cc.xor_(t, t);
+    for (i = kCount - 1; i >= 0; i--) {
+      cc.mov(x86::dword_ptr(a, i * 4), var[i]);
+      cc.add(t, var[i]);
+    }
+
+    cc.ret(t);
     cc.endFunc();
   }
 
   virtual bool run(void* _func, StringBuilder& result, StringBuilder& expect) {
-    typedef void (*Func)(int*, int, int, int);
+    typedef int (*Func)(int*, int);
     Func func = ptr_as_func<Func>(_func);
 
-    int v0 = 0x000000FF;
+    int i;
+    int resultBuf[kCount];
+    int expectBuf[kCount];
 
-    int resultRet;
-    int expectRet = 0x0000FF00;
+    int expectRet = 0;
+    for (i = 0; i < kCount; i++) {
+      expectBuf[i] = i + 10 * 11 / 2;
+      expectRet += expectBuf[i];
+    }
 
-    func(&resultRet, v0, 16, 8);
+    int resultRet = func(resultBuf, 10);
+    bool success = resultRet == expectRet;
 
-    result.setFormat("ret=%d", resultRet);
-    expect.setFormat("ret=%d", expectRet);
+    result.appendFormat("ret=%d {", resultRet);
+    expect.appendFormat("ret=%d {", expectRet);
 
-    return resultRet == expectRet;
+    for (i = 0; i < kCount; i++) {
+      result.appendFormat("%s%d", i == 0 ? "" : ", ", resultBuf[i]);
+      expect.appendFormat("%s%d", i == 0 ? "" : ", ", expectBuf[i]);
+
+      success &= (resultBuf[i] == expectBuf[i]);
+    }
+
+    result.appendString("}");
+    expect.appendString("}");
+
+    return success;
   }
 };
 
 // ============================================================================
-// [X86Test_AllocGpLo]
+// [X86Test_AllocGlobal]
 // ============================================================================
 
-class X86Test_AllocGpLo : public X86Test {
+class X86Test_AllocGlobal : public X86Test {
 public:
-  X86Test_AllocGpLo() : X86Test("[Alloc] GPB-LO") {}
+  X86Test_AllocGlobal() : X86Test("[Alloc] Global") {}
 
-  enum { kCount = 32 };
+  enum { kOuterCount = 10, kInnerCount = 12 };
 
   static void add(X86TestManager& mgr) {
-    mgr.add(new X86Test_AllocGpLo());
+    mgr.add(new X86Test_AllocGlobal());
   }
 
   virtual void compile(X86Compiler& cc) {
-    cc.addFunc(FuncSignature1<uint32_t, uint32_t*>(CallConv::kIdHost));
-
-    X86Gp rPtr = cc.newUIntPtr("rPtr");
-    X86Gp rSum = cc.newUInt32("rSum");
+    CCFunc* func = cc.addFunc(FuncSignature1<int, int>(CallConv::kIdHost));
+    func->setRAStrategy(kRAStrategyGlobal);
 
-    cc.setArg(0, rPtr);
+    X86Gp n = cc.newInt32("n");
+    X86Gp t = cc.newInt32("t");
+    X86Gp outer[kOuterCount];
+    X86Gp inner[kInnerCount];
 
-    X86Gp rVar[kCount];
-    uint32_t i;
+    cc.setArg(0, n);
 
-    for (i = 0; i < kCount; i++) {
-      rVar[i] = cc.newUInt32("rVar[%u]", i);
+    // Variables alive across the loop, but not used in it, should be spilled
+    // before the loop, inner variables should stay in registers.
+    int i;
+    for (i = 0; i < kOuterCount; i++) {
+      outer[i] = cc.newInt32("outer[%d]", i);
+      cc.lea(outer[i], x86::ptr(n, i * 3));
     }
 
-    // Init pseudo-regs with values from our array.
-    for (i = 0; i < kCount; i++) {
-      cc.mov(rVar[i], x86::dword_ptr(rPtr, i * 4));
+    for (i = 0; i < kInnerCount; i++) {
+      inner[i] = cc.newInt32("inner[%d]", i);
+      cc.mov(inner[i], i);
     }
 
-    for (i = 2; i < kCount; i++) {
-      // Add and truncate to 8 bit; no purpose, just mess with jit.
-      cc.add  (rVar[i  ], rVar[i-1]);
-      cc.movzx(rVar[i  ], rVar[i  ].r8());
-      cc.movzx(rVar[i-2], rVar[i-1].r8());
-      cc.movzx(rVar[i-1], rVar[i-2].r8());
-    }
+    Label L = cc.newLabel();
+    cc.bind(L);
 
-    // Sum up all computed values.
-    cc.mov(rSum, 0);
-    for (i = 0; i < kCount; i++) {
-      cc.add(rSum, rVar[i]);
+    for (i = 0; i < kInnerCount; i++) {
+      cc.add(inner[i], n);
     }
 
-    // Return the sum.
-    cc.ret(rSum);
+    cc.dec(n);
+    cc.jnz(L);
+
+    cc.xor_(t, t);
+    for (i = 0; i < kOuterCount; i++)
+      cc.add(t, outer[i]);
+    for (i = 0; i < kInnerCount; i++)
+      cc.add(t, inner[i]);
+
+    cc.ret(t);
     cc.endFunc();
   }
 
   virtual bool run(void* _func, StringBuilder& result, StringBuilder& expect) {
-    typedef int (*Func)(uint32_t*);
+    typedef int (*Func)(int);
     Func func = ptr_as_func<Func>(_func);
 
-    unsigned int i;
-
-    uint32_t buf[kCount];
-    uint32_t resultRet;
-    uint32_t expectRet;
-
-    expectRet = 0;
-    for (i = 0; i < kCount; i++) {
-      buf[i] = 1;
-    }
-
-    for (i = 2; i < kCount; i++) {
-      buf[i  ]+= buf[i-1];
-      buf[i  ] = buf[i  ] & 0xFF;
-      buf[i-2] = buf[i-1] & 0xFF;
-      buf[i-1] = buf[i-2] & 0xFF;
-    }
+    int i;
+    int expectRet = 0;
 
-    for (i = 0; i < kCount; i++) {
-      expectRet += buf[i];
-    }
+    for (i = 0; i < kOuterCount; i++)
+      expectRet += 10 + i * 3;
+    for (i = 0; i < kInnerCount; i++)
+      expectRet += i + 10 * 11 / 2;
 
-    for (i = 0; i < kCount; i++) {
-      buf[i] = 1;
-    }
-    resultRet = func(buf);
+    int resultRet = func(10);
 
     result.setFormat("ret=%d", resultRet);
     expect.setFormat("ret=%d", expectRet);
@@ -1233,1633 +1766,3572 @@ public:
 };
 
 // ============================================================================
-// [X86Test_AllocRepMovsb]
+// [X86Test_AllocCompactStorage]
 // ============================================================================
 
-class X86Test_AllocRepMovsb : public X86Test {
+class X86Test_AllocCompactStorage : public X86Test {
 public:
-  X86Test_AllocRepMovsb() : X86Test("[Alloc] REP MOVS") {}
+  X86Test_AllocCompactStorage() : X86Test("[Alloc] Compact Storage") {}
 
   static void add(X86TestManager& mgr) {
-    mgr.add(new X86Test_AllocRepMovsb());
+    mgr.add(new X86Test_AllocCompactStorage());
   }
 
   virtual void compile(X86Compiler& cc) {
-    cc.addFunc(FuncSignature3<void, void*, void*, size_t>(CallConv::kIdHost));
+    cc.setCompactInstStorage(true);
+    cc.addFunc(FuncSignature2<int, int, int>(CallConv::kIdHost));
 
-    X86Gp dst = cc.newIntPtr("dst");
-    X86Gp src = cc.newIntPtr("src");
-    X86Gp cnt = cc.newIntPtr("cnt");
+    X86Gp n = cc.newInt32("n");
+    X86Gp x = cc.newInt32("x");
+    X86Gp sum = cc.newInt32("sum");
 
-    cc.setArg(0, dst);
-    cc.setArg(1, src);
-    cc.setArg(2, cnt);
+    Label L_Loop = cc.newLabel();
+    Label L_Skip = cc.newLabel();
 
-    cc.rep(cnt).movs(x86::byte_ptr(dst), x86::byte_ptr(src));
+    cc.setArg(0, n);
+    cc.setArg(1, x);
+    cc.xor_(sum, sum);
+
+    // Sum of `x * i` for all odd `i` in `[1, n]`.
+    cc.bind(L_Loop);
+    cc.test(n, 1);
+    cc.jz(L_Skip);
+
+    X86Gp t = cc.newInt32("t");
+    cc.mov(t, x);
+    cc.imul(t, n);
+    cc.add(sum, t);
+
+    cc.bind(L_Skip);
+    cc.dec(n);
+    cc.jnz(L_Loop);
+
+    cc.ret(sum);
     cc.endFunc();
   }
 
   virtual bool run(void* _func, StringBuilder& result, StringBuilder& expect) {
-    typedef void (*Func)(void*, void*, size_t);
+    typedef int (*Func)(int, int);
     Func func = ptr_as_func<Func>(_func);
 
-    char dst[20] = { 0 };
-    char src[20] = "Hello AsmJit!";
-    func(dst, src, strlen(src) + 1);
+    int resultRet = func(10, 3);
+    int expectRet = 3 * (1 + 3 + 5 + 7 + 9);
 
-    result.setFormat("ret=\"%s\"", dst);
-    expect.setFormat("ret=\"%s\"", src);
+    result.setFormat("ret=%d", resultRet);
+    expect.setFormat("ret=%d", expectRet);
 
-    return result == expect;
+    return resultRet == expectRet;
   }
 };
 
 // ============================================================================
-// [X86Test_AllocIfElse1]
+// [X86Test_AllocPackedStorage]
 // ============================================================================
 
-class X86Test_AllocIfElse1 : public X86Test {
+class X86Test_AllocPackedStorage : public X86Test {
 public:
-  X86Test_AllocIfElse1() : X86Test("[Alloc] If-Else #1") {}
+  X86Test_AllocPackedStorage(bool peephole)
+    : X86Test(peephole ? "[Alloc] Packed Storage (Peephole)" : "[Alloc] Packed Storage"),
+      _peephole(peephole),
+      _packed(false) {}
 
   static void add(X86TestManager& mgr) {
-    mgr.add(new X86Test_AllocIfElse1());
+    mgr.add(new X86Test_AllocPackedStorage(false));
+    mgr.add(new X86Test_AllocPackedStorage(true));
   }
 
   virtual void compile(X86Compiler& cc) {
-    cc.addFunc(FuncSignature2<int, int, int>(CallConv::kIdHost));
-
-    X86Gp v1 = cc.newInt32("v1");
-    X86Gp v2 = cc.newInt32("v2");
+    cc.setPackedOpStorage(true);
 
-    Label L_1 = cc.newLabel();
-    Label L_2 = cc.newLabel();
+    // The peephole pass runs after RA and requires all operands unpacked.
+    if (_peephole)
+      cc.addPassT<X86PeepholePass>();
 
-    cc.setArg(0, v1);
-    cc.setArg(1, v2);
+    cc.addFunc(FuncSignature3<int, int*, int, int>(CallConv::kIdHost));
 
-    cc.cmp(v1, v2);
-    cc.jg(L_1);
+    X86Gp p = cc.newIntPtr("p");
+    X86Gp n = cc.newInt32("n");
+    X86Gp x = cc.newInt32("x");
+    X86Gp sum = cc.newInt32("sum");
+    X86Gp t = cc.newInt32("t");
 
-    cc.mov(v1, 1);
-    cc.jmp(L_2);
+    Label L_Loop = cc.newLabel();
 
-    cc.bind(L_1);
-    cc.mov(v1, 2);
+    cc.setArg(0, p);
+    cc.setArg(1, n);
+    cc.setArg(2, x);
+    cc.xor_(sum, sum);
 
-    cc.bind(L_2);
-    cc.ret(v1);
-    cc.endFunc();
-  }
+    // Registers and small immediates are packed, the memory operand and the
+    // 64-bit immediate are not.
+    _packed = static_cast<CBInst*>(cc.getCursor())->hasPackedOps();
 
-  virtual bool run(void* _func, StringBuilder& result, StringBuilder& expect)  {
-    typedef int (*Func)(int, int);
+    cc.bind(L_Loop);
+    cc.mov(t, x);
+    cc.imul(t, n);
+    cc.add(t, 1000);
+    cc.add(t, x86::dword_ptr(p));
+    cc.add(sum, t);
+    cc.dec(n);
+    cc.jnz(L_Loop);
+
+    X86Gp big = cc.newInt64("big");
+    cc.mov(big, uint64_t(0x100000007));
+    cc.add(sum, big.r32());
+
+    cc.ret(sum);
+    cc.endFunc();
+  }
+
+  virtual bool run(void* _func, StringBuilder& result, StringBuilder& expect) {
+    typedef int (*Func)(int*, int, int);
     Func func = ptr_as_func<Func>(_func);
 
-    int a = func(0, 1);
-    int b = func(1, 0);
+    int v = 5;
+    int resultRet = func(&v, 4, 3);
+    int expectRet = 3 * (1 + 2 + 3 + 4) + 4 * (1000 + 5) + 7;
 
-    result.appendFormat("ret={%d, %d}", a, b);
-    result.appendFormat("ret={%d, %d}", 1, 2);
+    result.setFormat("ret=%d packed=%d", resultRet, int(_packed));
+    expect.setFormat("ret=%d packed=%d", expectRet, 1);
 
-    return a == 1 && b == 2;
+    return result.eq(expect);
   }
+
+  bool _peephole;
+  bool _packed;
 };
 
 // ============================================================================
-// [X86Test_AllocIfElse2]
+// [X86Test_AllocImul1]
 // ============================================================================
 
-class X86Test_AllocIfElse2 : public X86Test {
+class X86Test_AllocImul1 : public X86Test {
 public:
-  X86Test_AllocIfElse2() : X86Test("[Alloc] If-Else #2") {}
+  X86Test_AllocImul1() : X86Test("[Alloc] IMUL #1") {}
 
   static void add(X86TestManager& mgr) {
-    mgr.add(new X86Test_AllocIfElse2());
+    mgr.add(new X86Test_AllocImul1());
   }
 
   virtual void compile(X86Compiler& cc) {
-    cc.addFunc(FuncSignature2<int, int, int>(CallConv::kIdHost));
-
-    X86Gp v1 = cc.newInt32("v1");
-    X86Gp v2 = cc.newInt32("v2");
-
-    Label L_1 = cc.newLabel();
-    Label L_2 = cc.newLabel();
-    Label L_3 = cc.newLabel();
-    Label L_4 = cc.newLabel();
-
-    cc.setArg(0, v1);
-    cc.setArg(1, v2);
-
-    cc.jmp(L_1);
-    cc.bind(L_2);
-    cc.jmp(L_4);
-    cc.bind(L_1);
+    cc.addFunc(FuncSignature4<void, int*, int*, int, int>(CallConv::kIdHost));
 
-    cc.cmp(v1, v2);
-    cc.jg(L_3);
+    X86Gp dstHi = cc.newIntPtr("dstHi");
+    X86Gp dstLo = cc.newIntPtr("dstLo");
 
-    cc.mov(v1, 1);
-    cc.jmp(L_2);
+    X86Gp vHi = cc.newInt32("vHi");
+    X86Gp vLo = cc.newInt32("vLo");
+    X86Gp src = cc.newInt32("src");
 
-    cc.bind(L_3);
-    cc.mov(v1, 2);
-    cc.jmp(L_2);
+    cc.setArg(0, dstHi);
+    cc.setArg(1, dstLo);
+    cc.setArg(2, vLo);
+    cc.setArg(3, src);
 
-    cc.bind(L_4);
+    cc.imul(vHi, vLo, src);
 
-    cc.ret(v1);
+    cc.mov(x86::dword_ptr(dstHi), vHi);
+    cc.mov(x86::dword_ptr(dstLo), vLo);
     cc.endFunc();
   }
 
-  virtual bool run(void* _func, StringBuilder& result, StringBuilder& expect)  {
-    typedef int (*Func)(int, int);
+  virtual bool run(void* _func, StringBuilder& result, StringBuilder& expect) {
+    typedef void (*Func)(int*, int*, int, int);
     Func func = ptr_as_func<Func>(_func);
 
-    int a = func(0, 1);
-    int b = func(1, 0);
+    int v0 = 4;
+    int v1 = 4;
 
-    result.appendFormat("ret={%d, %d}", a, b);
-    result.appendFormat("ret={%d, %d}", 1, 2);
+    int resultHi;
+    int resultLo;
 
-    return a == 1 && b == 2;
+    int expectHi = 0;
+    int expectLo = v0 * v1;
+
+    func(&resultHi, &resultLo, v0, v1);
+
+    result.setFormat("hi=%d, lo=%d", resultHi, resultLo);
+    expect.setFormat("hi=%d, lo=%d", expectHi, expectLo);
+
+    return resultHi == expectHi && resultLo == expectLo;
   }
 };
 
 // ============================================================================
-// [X86Test_AllocIfElse3]
+// [X86Test_AllocImul2]
 // ============================================================================
 
-class X86Test_AllocIfElse3 : public X86Test {
+class X86Test_AllocImul2 : public X86Test {
 public:
-  X86Test_AllocIfElse3() : X86Test("[Alloc] If-Else #3") {}
+  X86Test_AllocImul2() : X86Test("[Alloc] IMUL #2") {}
 
   static void add(X86TestManager& mgr) {
-    mgr.add(new X86Test_AllocIfElse3());
+    mgr.add(new X86Test_AllocImul2());
   }
 
   virtual void compile(X86Compiler& cc) {
-    cc.addFunc(FuncSignature2<int, int, int>(CallConv::kIdHost));
-
-    X86Gp v1 = cc.newInt32("v1");
-    X86Gp v2 = cc.newInt32("v2");
-    X86Gp counter = cc.newInt32("counter");
-
-    Label L_1 = cc.newLabel();
-    Label L_Loop = cc.newLabel();
-    Label L_Exit = cc.newLabel();
-
-    cc.setArg(0, v1);
-    cc.setArg(1, v2);
+    cc.addFunc(FuncSignature2<void, int*, const int*>(CallConv::kIdHost));
 
-    cc.cmp(v1, v2);
-    cc.jg(L_1);
+    X86Gp dst = cc.newIntPtr("dst");
+    X86Gp src = cc.newIntPtr("src");
 
-    cc.mov(counter, 0);
+    cc.setArg(0, dst);
+    cc.setArg(1, src);
 
-    cc.bind(L_Loop);
-    cc.mov(v1, counter);
+    for (unsigned int i = 0; i < 4; i++) {
+      X86Gp x  = cc.newInt32("x");
+      X86Gp y  = cc.newInt32("y");
+      X86Gp hi = cc.newInt32("hi");
 
-    cc.inc(counter);
-    cc.cmp(counter, 1);
-    cc.jle(L_Loop);
-    cc.jmp(L_Exit);
+      cc.mov(x, x86::dword_ptr(src, 0));
+      cc.mov(y, x86::dword_ptr(src, 4));
 
-    cc.bind(L_1);
-    cc.mov(v1, 2);
+      cc.imul(hi, x, y);
+      cc.add(x86::dword_ptr(dst, 0), hi);
+      cc.add(x86::dword_ptr(dst, 4), x);
+    }
 
-    cc.bind(L_Exit);
-    cc.ret(v1);
     cc.endFunc();
   }
 
-  virtual bool run(void* _func, StringBuilder& result, StringBuilder& expect)  {
-    typedef int (*Func)(int, int);
+  virtual bool run(void* _func, StringBuilder& result, StringBuilder& expect) {
+    typedef void (*Func)(int*, const int*);
     Func func = ptr_as_func<Func>(_func);
 
-    int a = func(0, 1);
-    int b = func(1, 0);
+    int src[2] = { 4, 9 };
+    int resultRet[2] = { 0, 0 };
+    int expectRet[2] = { 0, (4 * 9) * 4 };
 
-    result.appendFormat("ret={%d, %d}", a, b);
-    result.appendFormat("ret={%d, %d}", 1, 2);
+    func(resultRet, src);
 
-    return a == 1 && b == 2;
+    result.setFormat("ret={%d, %d}", resultRet[0], resultRet[1]);
+    expect.setFormat("ret={%d, %d}", expectRet[0], expectRet[1]);
+
+    return resultRet[0] == expectRet[0] && resultRet[1] == expectRet[1];
   }
 };
 
 // ============================================================================
-// [X86Test_AllocIfElse4]
+// [X86Test_AllocIdiv1]
 // ============================================================================
 
-class X86Test_AllocIfElse4 : public X86Test {
+class X86Test_AllocIdiv1 : public X86Test {
 public:
-  X86Test_AllocIfElse4() : X86Test("[Alloc] If-Else #4") {}
+  X86Test_AllocIdiv1() : X86Test("[Alloc] IDIV #1") {}
 
   static void add(X86TestManager& mgr) {
-    mgr.add(new X86Test_AllocIfElse4());
+    mgr.add(new X86Test_AllocIdiv1());
   }
 
   virtual void compile(X86Compiler& cc) {
     cc.addFunc(FuncSignature2<int, int, int>(CallConv::kIdHost));
 
-    X86Gp v1 = cc.newInt32("v1");
-    X86Gp v2 = cc.newInt32("v2");
-    X86Gp counter = cc.newInt32("counter");
-
-    Label L_1 = cc.newLabel();
-    Label L_Loop1 = cc.newLabel();
-    Label L_Loop2 = cc.newLabel();
-    Label L_Exit = cc.newLabel();
-
-    cc.mov(counter, 0);
-
-    cc.setArg(0, v1);
-    cc.setArg(1, v2);
-
-    cc.cmp(v1, v2);
-    cc.jg(L_1);
-
-    cc.bind(L_Loop1);
-    cc.mov(v1, counter);
+    X86Gp a = cc.newInt32("a");
+    X86Gp b = cc.newInt32("b");
+    X86Gp dummy = cc.newInt32("dummy");
 
-    cc.inc(counter);
-    cc.cmp(counter, 1);
-    cc.jle(L_Loop1);
-    cc.jmp(L_Exit);
+    cc.setArg(0, a);
+    cc.setArg(1, b);
 
-    cc.bind(L_1);
-    cc.bind(L_Loop2);
-    cc.mov(v1, counter);
-    cc.inc(counter);
-    cc.cmp(counter, 2);
-    cc.jle(L_Loop2);
+    cc.xor_(dummy, dummy);
+    cc.idiv(dummy, a, b);
 
-    cc.bind(L_Exit);
-    cc.ret(v1);
+    cc.ret(a);
     cc.endFunc();
   }
 
-  virtual bool run(void* _func, StringBuilder& result, StringBuilder& expect)  {
+  virtual bool run(void* _func, StringBuilder& result, StringBuilder& expect) {
     typedef int (*Func)(int, int);
     Func func = ptr_as_func<Func>(_func);
 
-    int a = func(0, 1);
-    int b = func(1, 0);
+    int v0 = 2999;
+    int v1 = 245;
 
-    result.appendFormat("ret={%d, %d}", a, b);
-    result.appendFormat("ret={%d, %d}", 1, 2);
+    int resultRet = func(v0, v1);
+    int expectRet = 2999 / 245;
 
-    return a == 1 && b == 2;
+    result.setFormat("result=%d", resultRet);
+    expect.setFormat("result=%d", expectRet);
+
+    return resultRet == expectRet;
   }
 };
 
 // ============================================================================
-// [X86Test_AllocInt8]
+// [X86Test_AllocSetz]
 // ============================================================================
 
-class X86Test_AllocInt8 : public X86Test {
+class X86Test_AllocSetz : public X86Test {
 public:
-  X86Test_AllocInt8() : X86Test("[Alloc] Int8") {}
+  X86Test_AllocSetz() : X86Test("[Alloc] SETZ") {}
 
   static void add(X86TestManager& mgr) {
-    mgr.add(new X86Test_AllocInt8());
+    mgr.add(new X86Test_AllocSetz());
   }
 
   virtual void compile(X86Compiler& cc) {
-    X86Gp x = cc.newInt8("x");
-    X86Gp y = cc.newInt32("y");
+    cc.addFunc(FuncSignature3<void, int, int, char*>(CallConv::kIdHost));
 
-    cc.addFunc(FuncSignature1<int, char>(CallConv::kIdHost));
-    cc.setArg(0, x);
+    X86Gp src0 = cc.newInt32("src0");
+    X86Gp src1 = cc.newInt32("src1");
+    X86Gp dst0 = cc.newIntPtr("dst0");
 
-    cc.movsx(y, x);
+    cc.setArg(0, src0);
+    cc.setArg(1, src1);
+    cc.setArg(2, dst0);
+
+    cc.cmp(src0, src1);
+    cc.setz(x86::byte_ptr(dst0));
 
-    cc.ret(y);
     cc.endFunc();
   }
 
   virtual bool run(void* _func, StringBuilder& result, StringBuilder& expect) {
-    typedef int (*Func)(char);
+    typedef void (*Func)(int, int, char*);
     Func func = ptr_as_func<Func>(_func);
 
-    int resultRet = func(-13);
-    int expectRet = -13;
+    char resultBuf[4];
+    char expectBuf[4] = { 1, 0, 0, 1 };
 
-    result.setFormat("ret=%d", resultRet);
-    expect.setFormat("ret=%d", expectRet);
+    func(0, 0, &resultBuf[0]); // We are expecting 1 (0 == 0).
+    func(0, 1, &resultBuf[1]); // We are expecting 0 (0 != 1).
+    func(1, 0, &resultBuf[2]); // We are expecting 0 (1 != 0).
+    func(1, 1, &resultBuf[3]); // We are expecting 1 (1 == 1).
 
-    return resultRet == expectRet;
-  }
-};
+    result.setFormat("out={%d, %d, %d, %d}", resultBuf[0], resultBuf[1], resultBuf[2], resultBuf[3]);
+    expect.setFormat("out={%d, %d, %d, %d}", expectBuf[0], expectBuf[1], expectBuf[2], expectBuf[3]);
 
-// ============================================================================
-// [X86Test_AllocArgsIntPtr]
+    return resultBuf[0] == expectBuf[0] &&
+           resultBuf[1] == expectBuf[1] &&
+           resultBuf[2] == expectBuf[2] &&
+           resultBuf[3] == expectBuf[3] ;
+  }
+};
+
+// ============================================================================
+// [X86Test_AllocShlRor]
 // ============================================================================
 
-class X86Test_AllocArgsIntPtr : public X86Test {
+class X86Test_AllocShlRor : public X86Test {
 public:
-  X86Test_AllocArgsIntPtr() : X86Test("[Alloc] Args IntPtr") {}
+  X86Test_AllocShlRor() : X86Test("[Alloc] SHL/ROR") {}
 
   static void add(X86TestManager& mgr) {
-    mgr.add(new X86Test_AllocArgsIntPtr());
+    mgr.add(new X86Test_AllocShlRor());
   }
 
   virtual void compile(X86Compiler& cc) {
-    cc.addFunc(FuncSignature8<void, void*, void*, void*, void*, void*, void*, void*, void*>(CallConv::kIdHost));
-
-    uint32_t i;
-    X86Gp var[8];
+    cc.addFunc(FuncSignature4<void, int*, int, int, int>(CallConv::kIdHost));
 
-    for (i = 0; i < 8; i++) {
-      var[i] = cc.newIntPtr("var%u", i);
-      cc.setArg(i, var[i]);
-    }
+    X86Gp dst = cc.newIntPtr("dst");
+    X86Gp var = cc.newInt32("var");
+    X86Gp vShlParam = cc.newInt32("vShlParam");
+    X86Gp vRorParam = cc.newInt32("vRorParam");
 
-    for (i = 0; i < 8; i++) {
-      cc.add(var[i], static_cast<int>(i + 1));
-    }
+    cc.setArg(0, dst);
+    cc.setArg(1, var);
+    cc.setArg(2, vShlParam);
+    cc.setArg(3, vRorParam);
 
-    // Move some data into buffer provided by arguments so we can verify if it
-    // really works without looking into assembler output.
-    for (i = 0; i < 8; i++) {
-      cc.add(x86::byte_ptr(var[i]), static_cast<int>(i + 1));
-    }
+    cc.shl(var, vShlParam);
+    cc.ror(var, vRorParam);
 
+    cc.mov(x86::dword_ptr(dst), var);
     cc.endFunc();
   }
 
   virtual bool run(void* _func, StringBuilder& result, StringBuilder& expect) {
-    typedef void (*Func)(void*, void*, void*, void*, void*, void*, void*, void*);
+    typedef void (*Func)(int*, int, int, int);
     Func func = ptr_as_func<Func>(_func);
 
-    uint8_t resultBuf[9] = { 0, 0, 0, 0, 0, 0, 0, 0, 0 };
-    uint8_t expectBuf[9] = { 0, 1, 2, 3, 4, 5, 6, 7, 8 };
+    int v0 = 0x000000FF;
 
-    func(resultBuf, resultBuf, resultBuf, resultBuf,
-         resultBuf, resultBuf, resultBuf, resultBuf);
+    int resultRet;
+    int expectRet = 0x0000FF00;
 
-    result.setFormat("buf={%d, %d, %d, %d, %d, %d, %d, %d, %d}",
-      resultBuf[0], resultBuf[1], resultBuf[2], resultBuf[3],
-      resultBuf[4], resultBuf[5], resultBuf[6], resultBuf[7],
-      resultBuf[8]);
-    expect.setFormat("buf={%d, %d, %d, %d, %d, %d, %d, %d, %d}",
-      expectBuf[0], expectBuf[1], expectBuf[2], expectBuf[3],
-      expectBuf[4], expectBuf[5], expectBuf[6], expectBuf[7],
-      expectBuf[8]);
+    func(&resultRet, v0, 16, 8);
 
-    return result == expect;
+    result.setFormat("ret=%d", resultRet);
+    expect.setFormat("ret=%d", expectRet);
+
+    return resultRet == expectRet;
   }
 };
 
 // ============================================================================
-// [X86Test_AllocArgsFloat]
+// [X86Test_AllocGpLo]
 // ============================================================================
 
-class X86Test_AllocArgsFloat : public X86Test {
+class X86Test_AllocGpLo : public X86Test {
 public:
-  X86Test_AllocArgsFloat() : X86Test("[Alloc] Args Float") {}
+  X86Test_AllocGpLo() : X86Test("[Alloc] GPB-LO") {}
+
+  enum { kCount = 32 };
 
   static void add(X86TestManager& mgr) {
-    mgr.add(new X86Test_AllocArgsFloat());
+    mgr.add(new X86Test_AllocGpLo());
   }
 
   virtual void compile(X86Compiler& cc) {
-    cc.addFunc(FuncSignature8<void, float, float, float, float, float, float, float, void*>(CallConv::kIdHost));
+    cc.addFunc(FuncSignature1<uint32_t, uint32_t*>(CallConv::kIdHost));
+
+    X86Gp rPtr = cc.newUIntPtr("rPtr");
+    X86Gp rSum = cc.newUInt32("rSum");
+
+    cc.setArg(0, rPtr);
 
+    X86Gp rVar[kCount];
     uint32_t i;
 
-    X86Gp p = cc.newIntPtr("p");
-    X86Xmm xv[7];
+    for (i = 0; i < kCount; i++) {
+      rVar[i] = cc.newUInt32("rVar[%u]", i);
+    }
 
-    for (i = 0; i < 7; i++) {
-      xv[i] = cc.newXmmSs("xv%u", i);
-      cc.setArg(i, xv[i]);
+    // Init pseudo-regs with values from our array.
+    for (i = 0; i < kCount; i++) {
+      cc.mov(rVar[i], x86::dword_ptr(rPtr, i * 4));
     }
 
-    cc.setArg(7, p);
+    for (i = 2; i < kCount; i++) {
+      // Add and truncate to 8 bit; no purpose, just mess with jit.
+      cc.add  (rVar[i  ], rVar[i-1]);
+      cc.movzx(rVar[i  ], rVar[i  ].r8());
+      cc.movzx(rVar[i-2], rVar[i-1].r8());
+      cc.movzx(rVar[i-1], rVar[i-2].r8());
+    }
 
-    cc.addss(xv[0], xv[1]);
-    cc.addss(xv[0], xv[2]);
-    cc.addss(xv[0], xv[3]);
-    cc.addss(xv[0], xv[4]);
-    cc.addss(xv[0], xv[5]);
-    cc.addss(xv[0], xv[6]);
+    // Sum up all computed values.
+    cc.mov(rSum, 0);
+    for (i = 0; i < kCount; i++) {
+      cc.add(rSum, rVar[i]);
+    }
 
-    cc.movss(x86::ptr(p), xv[0]);
+    // Return the sum.
+    cc.ret(rSum);
     cc.endFunc();
   }
 
   virtual bool run(void* _func, StringBuilder& result, StringBuilder& expect) {
-    typedef void (*Func)(float, float, float, float, float, float, float, float*);
+    typedef int (*Func)(uint32_t*);
     Func func = ptr_as_func<Func>(_func);
 
-    float resultRet;
-    float expectRet = 1.0f + 2.0f + 3.0f + 4.0f + 5.0f + 6.0f + 7.0f;
+    unsigned int i;
 
-    func(1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f, &resultRet);
+    uint32_t buf[kCount];
+    uint32_t resultRet;
+    uint32_t expectRet;
 
-    result.setFormat("ret={%g}", resultRet);
-    expect.setFormat("ret={%g}", expectRet);
+    expectRet = 0;
+    for (i = 0; i < kCount; i++) {
+      buf[i] = 1;
+    }
+
+    for (i = 2; i < kCount; i++) {
+      buf[i  ]+= buf[i-1];
+      buf[i  ] = buf[i  ] & 0xFF;
+      buf[i-2] = buf[i-1] & 0xFF;
+      buf[i-1] = buf[i-2] & 0xFF;
+    }
+
+    for (i = 0; i < kCount; i++) {
+      expectRet += buf[i];
+    }
+
+    for (i = 0; i < kCount; i++) {
+      buf[i] = 1;
+    }
+    resultRet = func(buf);
+
+    result.setFormat("ret=%d", resultRet);
+    expect.setFormat("ret=%d", expectRet);
 
     return resultRet == expectRet;
   }
 };
 
 // ============================================================================
-// [X86Test_AllocArgsDouble]
+// [X86Test_AllocRepMovsb]
 // ============================================================================
 
-class X86Test_AllocArgsDouble : public X86Test {
+class X86Test_AllocRepMovsb : public X86Test {
 public:
-  X86Test_AllocArgsDouble() : X86Test("[Alloc] Args Double") {}
+  X86Test_AllocRepMovsb() : X86Test("[Alloc] REP MOVS") {}
 
   static void add(X86TestManager& mgr) {
-    mgr.add(new X86Test_AllocArgsDouble());
+    mgr.add(new X86Test_AllocRepMovsb());
   }
 
   virtual void compile(X86Compiler& cc) {
-    cc.addFunc(FuncSignature8<void, double, double, double, double, double, double, double, void*>(CallConv::kIdHost));
-
-    uint32_t i;
-
-    X86Gp p = cc.newIntPtr("p");
-    X86Xmm xv[7];
-
-    for (i = 0; i < 7; i++) {
-      xv[i] = cc.newXmmSd("xv%u", i);
-      cc.setArg(i, xv[i]);
-    }
+    cc.addFunc(FuncSignature3<void, void*, void*, size_t>(CallConv::kIdHost));
 
-    cc.setArg(7, p);
+    X86Gp dst = cc.newIntPtr("dst");
+    X86Gp src = cc.newIntPtr("src");
+    X86Gp cnt = cc.newIntPtr("cnt");
 
-    cc.addsd(xv[0], xv[1]);
-    cc.addsd(xv[0], xv[2]);
-    cc.addsd(xv[0], xv[3]);
-    cc.addsd(xv[0], xv[4]);
-    cc.addsd(xv[0], xv[5]);
-    cc.addsd(xv[0], xv[6]);
+    cc.setArg(0, dst);
+    cc.setArg(1, src);
+    cc.setArg(2, cnt);
 
-    cc.movsd(x86::ptr(p), xv[0]);
+    cc.rep(cnt).movs(x86::byte_ptr(dst), x86::byte_ptr(src));
     cc.endFunc();
   }
 
   virtual bool run(void* _func, StringBuilder& result, StringBuilder& expect) {
-    typedef void (*Func)(double, double, double, double, double, double, double, double*);
+    typedef void (*Func)(void*, void*, size_t);
     Func func = ptr_as_func<Func>(_func);
 
-    double resultRet;
-    double expectRet = 1.0 + 2.0 + 3.0 + 4.0 + 5.0 + 6.0 + 7.0;
-
-    func(1.0, 2.0, 3.0, 4.0, 5.0, 6.0, 7.0, &resultRet);
+    char dst[20] = { 0 };
+    char src[20] = "Hello AsmJit!";
+    func(dst, src, strlen(src) + 1);
 
-    result.setFormat("ret={%g}", resultRet);
-    expect.setFormat("ret={%g}", expectRet);
+    result.setFormat("ret=\"%s\"", dst);
+    expect.setFormat("ret=\"%s\"", src);
 
-    return resultRet == expectRet;
+    return result == expect;
   }
 };
 
 // ============================================================================
-// [X86Test_AllocRetFloat1]
+// [X86Test_AllocIfElse1]
 // ============================================================================
 
-class X86Test_AllocRetFloat1 : public X86Test {
+class X86Test_AllocIfElse1 : public X86Test {
 public:
-  X86Test_AllocRetFloat1() : X86Test("[Alloc] Ret Float #1") {}
+  X86Test_AllocIfElse1() : X86Test("[Alloc] If-Else #1") {}
 
   static void add(X86TestManager& mgr) {
-    mgr.add(new X86Test_AllocRetFloat1());
+    mgr.add(new X86Test_AllocIfElse1());
   }
 
   virtual void compile(X86Compiler& cc) {
-    cc.addFunc(FuncSignature1<float, float>(CallConv::kIdHost));
+    cc.addFunc(FuncSignature2<int, int, int>(CallConv::kIdHost));
 
-    X86Xmm a = cc.newXmmSs("a");
-    cc.setArg(0, a);
-    cc.ret(a);
+    X86Gp v1 = cc.newInt32("v1");
+    X86Gp v2 = cc.newInt32("v2");
+
+    Label L_1 = cc.newLabel();
+    Label L_2 = cc.newLabel();
+
+    cc.setArg(0, v1);
+    cc.setArg(1, v2);
+
+    cc.cmp(v1, v2);
+    cc.jg(L_1);
+
+    cc.mov(v1, 1);
+    cc.jmp(L_2);
 
+    cc.bind(L_1);
+    cc.mov(v1, 2);
+
+    cc.bind(L_2);
+    cc.ret(v1);
     cc.endFunc();
   }
 
-  virtual bool run(void* _func, StringBuilder& result, StringBuilder& expect) {
-    typedef float (*Func)(float);
+  virtual bool run(void* _func, StringBuilder& result, StringBuilder& expect)  {
+    typedef int (*Func)(int, int);
     Func func = ptr_as_func<Func>(_func);
 
-    float resultRet = func(2.5f);
-    float expectRet = 2.5f;
+    int a = func(0, 1);
+    int b = func(1, 0);
 
-    result.setFormat("ret={%g}", resultRet);
-    expect.setFormat("ret={%g}", expectRet);
+    result.appendFormat("ret={%d, %d}", a, b);
+    result.appendFormat("ret={%d, %d}", 1, 2);
 
-    return resultRet == expectRet;
+    return a == 1 && b == 2;
   }
 };
 
 // ============================================================================
-// [X86Test_AllocRetFloat2]
+// [X86Test_AllocIfElse2]
 // ============================================================================
 
-class X86Test_AllocRetFloat2 : public X86Test {
+class X86Test_AllocIfElse2 : public X86Test {
 public:
-  X86Test_AllocRetFloat2() : X86Test("[Alloc] Ret Float #2") {}
+  X86Test_AllocIfElse2() : X86Test("[Alloc] If-Else #2") {}
 
   static void add(X86TestManager& mgr) {
-    mgr.add(new X86Test_AllocRetFloat2());
+    mgr.add(new X86Test_AllocIfElse2());
   }
 
   virtual void compile(X86Compiler& cc) {
-    cc.addFunc(FuncSignature2<float, float, float>(CallConv::kIdHost));
+    cc.addFunc(FuncSignature2<int, int, int>(CallConv::kIdHost));
 
-    X86Xmm a = cc.newXmmSs("a");
-    X86Xmm b = cc.newXmmSs("b");
+    X86Gp v1 = cc.newInt32("v1");
+    X86Gp v2 = cc.newInt32("v2");
 
-    cc.setArg(0, a);
-    cc.setArg(1, b);
+    Label L_1 = cc.newLabel();
+    Label L_2 = cc.newLabel();
+    Label L_3 = cc.newLabel();
+    Label L_4 = cc.newLabel();
 
-    cc.addss(a, b);
-    cc.ret(a);
+    cc.setArg(0, v1);
+    cc.setArg(1, v2);
+
+    cc.jmp(L_1);
+    cc.bind(L_2);
+    cc.jmp(L_4);
+    cc.bind(L_1);
+
+    cc.cmp(v1, v2);
+    cc.jg(L_3);
+
+    cc.mov(v1, 1);
+    cc.jmp(L_2);
+
+    cc.bind(L_3);
+    cc.mov(v1, 2);
+    cc.jmp(L_2);
+
+    cc.bind(L_4);
 
+    cc.ret(v1);
     cc.endFunc();
   }
 
-  virtual bool run(void* _func, StringBuilder& result, StringBuilder& expect) {
-    typedef float (*Func)(float, float);
+  virtual bool run(void* _func, StringBuilder& result, StringBuilder& expect)  {
+    typedef int (*Func)(int, int);
     Func func = ptr_as_func<Func>(_func);
 
-    float resultRet = func(1.0f, 2.0f);
-    float expectRet = 1.0f + 2.0f;
+    int a = func(0, 1);
+    int b = func(1, 0);
 
-    result.setFormat("ret={%g}", resultRet);
-    expect.setFormat("ret={%g}", expectRet);
+    result.appendFormat("ret={%d, %d}", a, b);
+    result.appendFormat("ret={%d, %d}", 1, 2);
 
-    return resultRet == expectRet;
+    return a == 1 && b == 2;
   }
 };
 
 // ============================================================================
-// [X86Test_AllocRetDouble1]
+// [X86Test_AllocIfElse3]
 // ============================================================================
 
-class X86Test_AllocRetDouble1 : public X86Test {
+class X86Test_AllocIfElse3 : public X86Test {
 public:
-  X86Test_AllocRetDouble1() : X86Test("[Alloc] Ret Double #1") {}
+  X86Test_AllocIfElse3() : X86Test("[Alloc] If-Else #3") {}
 
   static void add(X86TestManager& mgr) {
-    mgr.add(new X86Test_AllocRetDouble1());
+    mgr.add(new X86Test_AllocIfElse3());
   }
 
   virtual void compile(X86Compiler& cc) {
-    cc.addFunc(FuncSignature1<double, double>(CallConv::kIdHost));
+    cc.addFunc(FuncSignature2<int, int, int>(CallConv::kIdHost));
 
-    X86Xmm a = cc.newXmmSd("a");
-    cc.setArg(0, a);
-    cc.ret(a);
+    X86Gp v1 = cc.newInt32("v1");
+    X86Gp v2 = cc.newInt32("v2");
+    X86Gp counter = cc.newInt32("counter");
+
+    Label L_1 = cc.newLabel();
+    Label L_Loop = cc.newLabel();
+    Label L_Exit = cc.newLabel();
+
+    cc.setArg(0, v1);
+    cc.setArg(1, v2);
+
+    cc.cmp(v1, v2);
+    cc.jg(L_1);
+
+    cc.mov(counter, 0);
+
+    cc.bind(L_Loop);
+    cc.mov(v1, counter);
+
+    cc.inc(counter);
+    cc.cmp(counter, 1);
+    cc.jle(L_Loop);
+    cc.jmp(L_Exit);
+
+    cc.bind(L_1);
+    cc.mov(v1, 2);
 
+    cc.bind(L_Exit);
+    cc.ret(v1);
     cc.endFunc();
   }
 
-  virtual bool run(void* _func, StringBuilder& result, StringBuilder& expect) {
-    typedef double (*Func)(double);
+  virtual bool run(void* _func, StringBuilder& result, StringBuilder& expect)  {
+    typedef int (*Func)(int, int);
     Func func = ptr_as_func<Func>(_func);
 
-    double resultRet = func(2.5);
-    double expectRet = 2.5;
+    int a = func(0, 1);
+    int b = func(1, 0);
 
-    result.setFormat("ret={%g}", resultRet);
-    expect.setFormat("ret={%g}", expectRet);
+    result.appendFormat("ret={%d, %d}", a, b);
+    result.appendFormat("ret={%d, %d}", 1, 2);
 
-    return resultRet == expectRet;
+    return a == 1 && b == 2;
   }
 };
 
 // ============================================================================
-// [X86Test_AllocRetDouble2]
+// [X86Test_AllocIfElse4]
 // ============================================================================
 
-class X86Test_AllocRetDouble2 : public X86Test {
+class X86Test_AllocIfElse4 : public X86Test {
 public:
-  X86Test_AllocRetDouble2() : X86Test("[Alloc] Ret Double #2") {}
+  X86Test_AllocIfElse4() : X86Test("[Alloc] If-Else #4") {}
 
   static void add(X86TestManager& mgr) {
-    mgr.add(new X86Test_AllocRetDouble2());
+    mgr.add(new X86Test_AllocIfElse4());
   }
 
   virtual void compile(X86Compiler& cc) {
-    cc.addFunc(FuncSignature2<double, double, double>(CallConv::kIdHost));
+    cc.addFunc(FuncSignature2<int, int, int>(CallConv::kIdHost));
 
-    X86Xmm a = cc.newXmmSd("a");
-    X86Xmm b = cc.newXmmSd("b");
+    X86Gp v1 = cc.newInt32("v1");
+    X86Gp v2 = cc.newInt32("v2");
+    X86Gp counter = cc.newInt32("counter");
 
-    cc.setArg(0, a);
-    cc.setArg(1, b);
+    Label L_1 = cc.newLabel();
+    Label L_Loop1 = cc.newLabel();
+    Label L_Loop2 = cc.newLabel();
+    Label L_Exit = cc.newLabel();
 
-    cc.addsd(a, b);
-    cc.ret(a);
+    cc.mov(counter, 0);
+
+    cc.setArg(0, v1);
+    cc.setArg(1, v2);
+
+    cc.cmp(v1, v2);
+    cc.jg(L_1);
+
+    cc.bind(L_Loop1);
+    cc.mov(v1, counter);
+
+    cc.inc(counter);
+    cc.cmp(counter, 1);
+    cc.jle(L_Loop1);
+    cc.jmp(L_Exit);
+
+    cc.bind(L_1);
+    cc.bind(L_Loop2);
+    cc.mov(v1, counter);
+    cc.inc(counter);
+    cc.cmp(counter, 2);
+    cc.jle(L_Loop2);
 
+    cc.bind(L_Exit);
+    cc.ret(v1);
     cc.endFunc();
   }
 
-  virtual bool run(void* _func, StringBuilder& result, StringBuilder& expect) {
-    typedef double (*Func)(double, double);
+  virtual bool run(void* _func, StringBuilder& result, StringBuilder& expect)  {
+    typedef int (*Func)(int, int);
     Func func = ptr_as_func<Func>(_func);
 
-    double resultRet = func(1.0, 2.0);
-    double expectRet = 1.0 + 2.0;
+    int a = func(0, 1);
+    int b = func(1, 0);
 
-    result.setFormat("ret={%g}", resultRet);
-    expect.setFormat("ret={%g}", expectRet);
+    result.appendFormat("ret={%d, %d}", a, b);
+    result.appendFormat("ret={%d, %d}", 1, 2);
 
-    return resultRet == expectRet;
+    return a == 1 && b == 2;
   }
 };
 
 // ============================================================================
-// [X86Test_AllocStack1]
+// [X86Test_AllocInt8]
 // ============================================================================
 
-class X86Test_AllocStack1 : public X86Test {
+class X86Test_AllocInt8 : public X86Test {
 public:
-  X86Test_AllocStack1() : X86Test("[Alloc] Stack #1") {}
-
-  enum { kSize = 256 };
+  X86Test_AllocInt8() : X86Test("[Alloc] Int8") {}
 
   static void add(X86TestManager& mgr) {
-    mgr.add(new X86Test_AllocStack1());
+    mgr.add(new X86Test_AllocInt8());
   }
 
   virtual void compile(X86Compiler& cc) {
-    cc.addFunc(FuncSignature0<int>(CallConv::kIdHost));
-
-    X86Mem stack = cc.newStack(kSize, 1);
-    stack.setSize(1);
-
-    X86Gp i = cc.newIntPtr("i");
-    X86Gp a = cc.newInt32("a");
-    X86Gp b = cc.newInt32("b");
-
-    Label L_1 = cc.newLabel();
-    Label L_2 = cc.newLabel();
-
-    // Fill stack by sequence [0, 1, 2, 3 ... 255].
-    cc.xor_(i, i);
-
-    X86Mem stackWithIndex = stack.clone();
-    stackWithIndex.setIndex(i, 0);
-
-    cc.bind(L_1);
-    cc.mov(stackWithIndex, i.r8());
-    cc.inc(i);
-    cc.cmp(i, 255);
-    cc.jle(L_1);
+    X86Gp x = cc.newInt8("x");
+    X86Gp y = cc.newInt32("y");
 
-    // Sum sequence in stack.
-    cc.xor_(i, i);
-    cc.xor_(a, a);
+    cc.addFunc(FuncSignature1<int, char>(CallConv::kIdHost));
+    cc.setArg(0, x);
 
-    cc.bind(L_2);
-    cc.movzx(b, stackWithIndex);
-    cc.add(a, b);
-    cc.inc(i);
-    cc.cmp(i, 255);
-    cc.jle(L_2);
+    cc.movsx(y, x);
 
-    cc.ret(a);
+    cc.ret(y);
     cc.endFunc();
   }
 
   virtual bool run(void* _func, StringBuilder& result, StringBuilder& expect) {
-    typedef int (*Func)(void);
+    typedef int (*Func)(char);
     Func func = ptr_as_func<Func>(_func);
 
-    int resultRet = func();
-    int expectRet = 32640;
+    int resultRet = func(-13);
+    int expectRet = -13;
 
-    result.setInt(resultRet);
-    expect.setInt(expectRet);
+    result.setFormat("ret=%d", resultRet);
+    expect.setFormat("ret=%d", expectRet);
 
     return resultRet == expectRet;
   }
 };
 
 // ============================================================================
-// [X86Test_AllocStack2]
+// [X86Test_AllocArgsIntPtr]
 // ============================================================================
 
-class X86Test_AllocStack2 : public X86Test {
+class X86Test_AllocArgsIntPtr : public X86Test {
 public:
-  X86Test_AllocStack2() : X86Test("[Alloc] Stack #2") {}
-
-  enum { kSize = 256 };
+  X86Test_AllocArgsIntPtr() : X86Test("[Alloc] Args IntPtr") {}
 
   static void add(X86TestManager& mgr) {
-    mgr.add(new X86Test_AllocStack2());
+    mgr.add(new X86Test_AllocArgsIntPtr());
   }
 
   virtual void compile(X86Compiler& cc) {
-    cc.addFunc(FuncSignature0<int>(CallConv::kIdHost));
+    cc.addFunc(FuncSignature8<void, void*, void*, void*, void*, void*, void*, void*, void*>(CallConv::kIdHost));
 
-    const int kTokenSize = 32;
+    uint32_t i;
+    X86Gp var[8];
 
-    X86Mem s1 = cc.newStack(kTokenSize, 32);
-    X86Mem s2 = cc.newStack(kTokenSize, 32);
+    for (i = 0; i < 8; i++) {
+      var[i] = cc.newIntPtr("var%u", i);
+      cc.setArg(i, var[i]);
+    }
 
-    X86Gp p1 = cc.newIntPtr("p1");
-    X86Gp p2 = cc.newIntPtr("p2");
+    for (i = 0; i < 8; i++) {
+      cc.add(var[i], static_cast<int>(i + 1));
+    }
 
-    X86Gp ret = cc.newInt32("ret");
-    Label L_Exit = cc.newLabel();
+    // Move some data into buffer provided by arguments so we can verify if it
+    // really works without looking into assembler output.
+    for (i = 0; i < 8; i++) {
+      cc.add(x86::byte_ptr(var[i]), static_cast<int>(i + 1));
+    }
+
+    cc.endFunc();
+  }
+
+  virtual bool run(void* _func, StringBuilder& result, StringBuilder& expect) {
+    typedef void (*Func)(void*, void*, void*, void*, void*, void*, void*, void*);
+    Func func = ptr_as_func<Func>(_func);
+
+    uint8_t resultBuf[9] = { 0, 0, 0, 0, 0, 0, 0, 0, 0 };
+    uint8_t expectBuf[9] = { 0, 1, 2, 3, 4, 5, 6, 7, 8 };
+
+    func(resultBuf, resultBuf, resultBuf, resultBuf,
+         resultBuf, resultBuf, resultBuf, resultBuf);
+
+    result.setFormat("buf={%d, %d, %d, %d, %d, %d, %d, %d, %d}",
+      resultBuf[0], resultBuf[1], resultBuf[2], resultBuf[3],
+      resultBuf[4], resultBuf[5], resultBuf[6], resultBuf[7],
+      resultBuf[8]);
+    expect.setFormat("buf={%d, %d, %d, %d, %d, %d, %d, %d, %d}",
+      expectBuf[0], expectBuf[1], expectBuf[2], expectBuf[3],
+      expectBuf[4], expectBuf[5], expectBuf[6], expectBuf[7],
+      expectBuf[8]);
+
+    return result == expect;
+  }
+};
+
+// ============================================================================
+// [X86Test_AllocArgsFloat]
+// ============================================================================
+
+class X86Test_AllocArgsFloat : public X86Test {
+public:
+  X86Test_AllocArgsFloat() : X86Test("[Alloc] Args Float") {}
+
+  static void add(X86TestManager& mgr) {
+    mgr.add(new X86Test_AllocArgsFloat());
+  }
+
+  virtual void compile(X86Compiler& cc) {
+    cc.addFunc(FuncSignature8<void, float, float, float, float, float, float, float, void*>(CallConv::kIdHost));
+
+    uint32_t i;
+
+    X86Gp p = cc.newIntPtr("p");
+    X86Xmm xv[7];
+
+    for (i = 0; i < 7; i++) {
+      xv[i] = cc.newXmmSs("xv%u", i);
+      cc.setArg(i, xv[i]);
+    }
+
+    cc.setArg(7, p);
+
+    cc.addss(xv[0], xv[1]);
+    cc.addss(xv[0], xv[2]);
+    cc.addss(xv[0], xv[3]);
+    cc.addss(xv[0], xv[4]);
+    cc.addss(xv[0], xv[5]);
+    cc.addss(xv[0], xv[6]);
+
+    cc.movss(x86::ptr(p), xv[0]);
+    cc.endFunc();
+  }
+
+  virtual bool run(void* _func, StringBuilder& result, StringBuilder& expect) {
+    typedef void (*Func)(float, float, float, float, float, float, float, float*);
+    Func func = ptr_as_func<Func>(_func);
+
+    float resultRet;
+    float expectRet = 1.0f + 2.0f + 3.0f + 4.0f + 5.0f + 6.0f + 7.0f;
+
+    func(1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f, &resultRet);
+
+    result.setFormat("ret={%g}", resultRet);
+    expect.setFormat("ret={%g}", expectRet);
+
+    return resultRet == expectRet;
+  }
+};
+
+// ============================================================================
+// [X86Test_AllocArgsDouble]
+// ============================================================================
+
+class X86Test_AllocArgsDouble : public X86Test {
+public:
+  X86Test_AllocArgsDouble() : X86Test("[Alloc] Args Double") {}
+
+  static void add(X86TestManager& mgr) {
+    mgr.add(new X86Test_AllocArgsDouble());
+  }
+
+  virtual void compile(X86Compiler& cc) {
+    cc.addFunc(FuncSignature8<void, double, double, double, double, double, double, double, void*>(CallConv::kIdHost));
+
+    uint32_t i;
+
+    X86Gp p = cc.newIntPtr("p");
+    X86Xmm xv[7];
+
+    for (i = 0; i < 7; i++) {
+      xv[i] = cc.newXmmSd("xv%u", i);
+      cc.setArg(i, xv[i]);
+    }
+
+    cc.setArg(7, p);
+
+    cc.addsd(xv[0], xv[1]);
+    cc.addsd(xv[0], xv[2]);
+    cc.addsd(xv[0], xv[3]);
+    cc.addsd(xv[0], xv[4]);
+    cc.addsd(xv[0], xv[5]);
+    cc.addsd(xv[0], xv[6]);
+
+    cc.movsd(x86::ptr(p), xv[0]);
+    cc.endFunc();
+  }
+
+  virtual bool run(void* _func, StringBuilder& result, StringBuilder& expect) {
+    typedef void (*Func)(double, double, double, double, double, double, double, double*);
+    Func func = ptr_as_func<Func>(_func);
+
+    double resultRet;
+    double expectRet = 1.0 + 2.0 + 3.0 + 4.0 + 5.0 + 6.0 + 7.0;
+
+    func(1.0, 2.0, 3.0, 4.0, 5.0, 6.0, 7.0, &resultRet);
+
+    result.setFormat("ret={%g}", resultRet);
+    expect.setFormat("ret={%g}", expectRet);
+
+    return resultRet == expectRet;
+  }
+};
+
+// ============================================================================
+// [X86Test_AllocRetFloat1]
+// ============================================================================
+
+class X86Test_AllocRetFloat1 : public X86Test {
+public:
+  X86Test_AllocRetFloat1() : X86Test("[Alloc] Ret Float #1") {}
+
+  static void add(X86TestManager& mgr) {
+    mgr.add(new X86Test_AllocRetFloat1());
+  }
+
+  virtual void compile(X86Compiler& cc) {
+    cc.addFunc(FuncSignature1<float, float>(CallConv::kIdHost));
+
+    X86Xmm a = cc.newXmmSs("a");
+    cc.setArg(0, a);
+    cc.ret(a);
+
+    cc.endFunc();
+  }
+
+  virtual bool run(void* _func, StringBuilder& result, StringBuilder& expect) {
+    typedef float (*Func)(float);
+    Func func = ptr_as_func<Func>(_func);
+
+    float resultRet = func(2.5f);
+    float expectRet = 2.5f;
+
+    result.setFormat("ret={%g}", resultRet);
+    expect.setFormat("ret={%g}", expectRet);
+
+    return resultRet == expectRet;
+  }
+};
+
+// ============================================================================
+// [X86Test_AllocRetFloat2]
+// ============================================================================
+
+class X86Test_AllocRetFloat2 : public X86Test {
+public:
+  X86Test_AllocRetFloat2() : X86Test("[Alloc] Ret Float #2") {}
+
+  static void add(X86TestManager& mgr) {
+    mgr.add(new X86Test_AllocRetFloat2());
+  }
+
+  virtual void compile(X86Compiler& cc) {
+    cc.addFunc(FuncSignature2<float, float, float>(CallConv::kIdHost));
+
+    X86Xmm a = cc.newXmmSs("a");
+    X86Xmm b = cc.newXmmSs("b");
+
+    cc.setArg(0, a);
+    cc.setArg(1, b);
+
+    cc.addss(a, b);
+    cc.ret(a);
+
+    cc.endFunc();
+  }
+
+  virtual bool run(void* _func, StringBuilder& result, StringBuilder& expect) {
+    typedef float (*Func)(float, float);
+    Func func = ptr_as_func<Func>(_func);
+
+    float resultRet = func(1.0f, 2.0f);
+    float expectRet = 1.0f + 2.0f;
+
+    result.setFormat("ret={%g}", resultRet);
+    expect.setFormat("ret={%g}", expectRet);
+
+    return resultRet == expectRet;
+  }
+};
+
+// ============================================================================
+// [X86Test_AllocRetDouble1]
+// ============================================================================
+
+class X86Test_AllocRetDouble1 : public X86Test {
+public:
+  X86Test_AllocRetDouble1() : X86Test("[Alloc] Ret Double #1") {}
+
+  static void add(X86TestManager& mgr) {
+    mgr.add(new X86Test_AllocRetDouble1());
+  }
+
+  virtual void compile(X86Compiler& cc) {
+    cc.addFunc(FuncSignature1<double, double>(CallConv::kIdHost));
+
+    X86Xmm a = cc.newXmmSd("a");
+    cc.setArg(0, a);
+    cc.ret(a);
+
+    cc.endFunc();
+  }
+
+  virtual bool run(void* _func, StringBuilder& result, StringBuilder& expect) {
+    typedef double (*Func)(double);
+    Func func = ptr_as_func<Func>(_func);
+
+    double resultRet = func(2.5);
+    double expectRet = 2.5;
+
+    result.setFormat("ret={%g}", resultRet);
+    expect.setFormat("ret={%g}", expectRet);
+
+    return resultRet == expectRet;
+  }
+};
+
+// ============================================================================
+// [X86Test_AllocRetDouble2]
+// ============================================================================
+
+class X86Test_AllocRetDouble2 : public X86Test {
+public:
+  X86Test_AllocRetDouble2() : X86Test("[Alloc] Ret Double #2") {}
+
+  static void add(X86TestManager& mgr) {
+    mgr.add(new X86Test_AllocRetDouble2());
+  }
+
+  virtual void compile(X86Compiler& cc) {
+    cc.addFunc(FuncSignature2<double, double, double>(CallConv::kIdHost));
+
+    X86Xmm a = cc.newXmmSd("a");
+    X86Xmm b = cc.newXmmSd("b");
+
+    cc.setArg(0, a);
+    cc.setArg(1, b);
+
+    cc.addsd(a, b);
+    cc.ret(a);
+
+    cc.endFunc();
+  }
+
+  virtual bool run(void* _func, StringBuilder& result, StringBuilder& expect) {
+    typedef double (*Func)(double, double);
+    Func func = ptr_as_func<Func>(_func);
+
+    double resultRet = func(1.0, 2.0);
+    double expectRet = 1.0 + 2.0;
+
+    result.setFormat("ret={%g}", resultRet);
+    expect.setFormat("ret={%g}", expectRet);
+
+    return resultRet == expectRet;
+  }
+};
+
+// ============================================================================
+// [X86Test_AllocStack1]
+// ============================================================================
+
+class X86Test_AllocStack1 : public X86Test {
+public:
+  X86Test_AllocStack1() : X86Test("[Alloc] Stack #1") {}
+
+  enum { kSize = 256 };
+
+  static void add(X86TestManager& mgr) {
+    mgr.add(new X86Test_AllocStack1());
+  }
+
+  virtual void compile(X86Compiler& cc) {
+    cc.addFunc(FuncSignature0<int>(CallConv::kIdHost));
+
+    X86Mem stack = cc.newStack(kSize, 1);
+    stack.setSize(1);
+
+    X86Gp i = cc.newIntPtr("i");
+    X86Gp a = cc.newInt32("a");
+    X86Gp b = cc.newInt32("b");
+
+    Label L_1 = cc.newLabel();
+    Label L_2 = cc.newLabel();
+
+    // Fill stack by sequence [0, 1, 2, 3 ... 255].
+    cc.xor_(i, i);
+
+    X86Mem stackWithIndex = stack.clone();
+    stackWithIndex.setIndex(i, 0);
+
+    cc.bind(L_1);
+    cc.mov(stackWithIndex, i.r8());
+    cc.inc(i);
+    cc.cmp(i, 255);
+    cc.jle(L_1);
+
+    // Sum sequence in stack.
+    cc.xor_(i, i);
+    cc.xor_(a, a);
+
+    cc.bind(L_2);
+    cc.movzx(b, stackWithIndex);
+    cc.add(a, b);
+    cc.inc(i);
+    cc.cmp(i, 255);
+    cc.jle(L_2);
+
+    cc.ret(a);
+    cc.endFunc();
+  }
+
+  virtual bool run(void* _func, StringBuilder& result, StringBuilder& expect) {
+    typedef int (*Func)(void);
+    Func func = ptr_as_func<Func>(_func);
+
+    int resultRet = func();
+    int expectRet = 32640;
+
+    result.setInt(resultRet);
+    expect.setInt(expectRet);
+
+    return resultRet == expectRet;
+  }
+};
+
+// ============================================================================
+// [X86Test_AllocStack2]
+// ============================================================================
+
+class X86Test_AllocStack2 : public X86Test {
+public:
+  X86Test_AllocStack2() : X86Test("[Alloc] Stack #2") {}
+
+  enum { kSize = 256 };
+
+  static void add(X86TestManager& mgr) {
+    mgr.add(new X86Test_AllocStack2());
+  }
+
+  virtual void compile(X86Compiler& cc) {
+    cc.addFunc(FuncSignature0<int>(CallConv::kIdHost));
+
+    const int kTokenSize = 32;
+
+    X86Mem s1 = cc.newStack(kTokenSize, 32);
+    X86Mem s2 = cc.newStack(kTokenSize, 32);
+
+    X86Gp p1 = cc.newIntPtr("p1");
+    X86Gp p2 = cc.newIntPtr("p2");
+
+    X86Gp ret = cc.newInt32("ret");
+    Label L_Exit = cc.newLabel();
+
+    static const char token[kTokenSize] = "-+:|abcdefghijklmnopqrstuvwxyz|";
+    CCFuncCall* call;
+
+    cc.lea(p1, s1);
+    cc.lea(p2, s2);
+
+    // Try to corrupt the stack if wrongly allocated.
+    call = cc.call(imm_ptr((void*)memcpy), FuncSignature3<void*, void*, void*, size_t>(CallConv::kIdHostCDecl));
+    call->setArg(0, p1);
+    call->setArg(1, imm_ptr(token));
+    call->setArg(2, imm(kTokenSize));
+    call->setRet(0, p1);
+
+    call = cc.call(imm_ptr((void*)memcpy), FuncSignature3<void*, void*, void*, size_t>(CallConv::kIdHostCDecl));
+    call->setArg(0, p2);
+    call->setArg(1, imm_ptr(token));
+    call->setArg(2, imm(kTokenSize));
+    call->setRet(0, p2);
+
+    call = cc.call(imm_ptr((void*)memcmp), FuncSignature3<int, void*, void*, size_t>(CallConv::kIdHostCDecl));
+    call->setArg(0, p1);
+    call->setArg(1, p2);
+    call->setArg(2, imm(kTokenSize));
+    call->setRet(0, ret);
+
+    // This should be 0 on success, however, if both `p1` and `p2` were
+    // allocated in the same address this check will still pass.
+    cc.cmp(ret, 0);
+    cc.jnz(L_Exit);
+
+    // Checks whether `p1` and `p2` are different (must be).
+    cc.xor_(ret, ret);
+    cc.cmp(p1, p2);
+    cc.setz(ret.r8());
+
+    cc.bind(L_Exit);
+    cc.ret(ret);
+    cc.endFunc();
+  }
+
+  virtual bool run(void* _func, StringBuilder& result, StringBuilder& expect) {
+    typedef int (*Func)(void);
+    Func func = ptr_as_func<Func>(_func);
+
+    int resultRet = func();
+    int expectRet = 0; // Must be zero, stack addresses must be different.
+
+    result.setInt(resultRet);
+    expect.setInt(expectRet);
+
+    return resultRet == expectRet;
+  }
+};
+
+// ============================================================================
+// [X86Test_AllocMemcpy]
+// ============================================================================
+
+class X86Test_AllocMemcpy : public X86Test {
+public:
+  X86Test_AllocMemcpy() : X86Test("[Alloc] Memcpy") {}
+
+  enum { kCount = 32 };
+
+  static void add(X86TestManager& mgr) {
+    mgr.add(new X86Test_AllocMemcpy());
+  }
+
+  virtual void compile(X86Compiler& cc) {
+    X86Gp dst = cc.newIntPtr("dst");
+    X86Gp src = cc.newIntPtr("src");
+    X86Gp cnt = cc.newUIntPtr("cnt");
+
+    Label L_Loop = cc.newLabel();                   // Create base labels we use
+    Label L_Exit = cc.newLabel();                   // in our function.
+
+    cc.addFunc(FuncSignature3<void, uint32_t*, const uint32_t*, size_t>(CallConv::kIdHost));
+    cc.setArg(0, dst);
+    cc.setArg(1, src);
+    cc.setArg(2, cnt);
+
+    cc.alloc(dst);                                  // Allocate all registers now,
+    cc.alloc(src);                                  // because we want to keep them
+    cc.alloc(cnt);                                  // in physical registers only.
+
+    cc.test(cnt, cnt);                              // Exit if length is zero.
+    cc.jz(L_Exit);
+
+    cc.bind(L_Loop);                                // Bind the loop label here.
+
+    X86Gp tmp = cc.newInt32("tmp");              // Copy a single dword (4 bytes).
+    cc.mov(tmp, x86::dword_ptr(src));
+    cc.mov(x86::dword_ptr(dst), tmp);
+
+    cc.add(src, 4);                                 // Increment dst/src pointers.
+    cc.add(dst, 4);
+
+    cc.dec(cnt);                                    // Loop until cnt isn't zero.
+    cc.jnz(L_Loop);
+
+    cc.bind(L_Exit);                                // Bind the exit label here.
+    cc.endFunc();                                   // End of function.
+  }
+
+  virtual bool run(void* _func, StringBuilder& result, StringBuilder& expect) {
+    typedef void (*Func)(uint32_t*, const uint32_t*, size_t);
+    Func func = ptr_as_func<Func>(_func);
+
+    uint32_t i;
+
+    uint32_t dstBuffer[kCount];
+    uint32_t srcBuffer[kCount];
+
+    for (i = 0; i < kCount; i++) {
+      dstBuffer[i] = 0;
+      srcBuffer[i] = i;
+    }
+
+    func(dstBuffer, srcBuffer, kCount);
+
+    result.setString("buf={");
+    expect.setString("buf={");
+
+    for (i = 0; i < kCount; i++) {
+      if (i != 0) {
+        result.appendString(", ");
+        expect.appendString(", ");
+      }
+
+      result.appendFormat("%u", static_cast<unsigned int>(dstBuffer[i]));
+      expect.appendFormat("%u", static_cast<unsigned int>(srcBuffer[i]));
+    }
+
+    result.appendString("}");
+    expect.appendString("}");
+
+    return result == expect;
+  }
+};
+
+// ============================================================================
+// [X86Test_AllocAlphaBlend]
+// ============================================================================
+
+class X86Test_AllocAlphaBlend : public X86Test {
+public:
+  X86Test_AllocAlphaBlend() : X86Test("[Alloc] AlphaBlend") {}
+
+  enum { kCount = 17 };
+
+  static void add(X86TestManager& mgr) {
+    mgr.add(new X86Test_AllocAlphaBlend());
+  }
+
+  static uint32_t blendSrcOver(uint32_t d, uint32_t s) {
+    uint32_t saInv = ~s >> 24;
+
+    uint32_t d_20 = (d     ) & 0x00FF00FF;
+    uint32_t d_31 = (d >> 8) & 0x00FF00FF;
+
+    d_20 *= saInv;
+    d_31 *= saInv;
+
+    d_20 = ((d_20 + ((d_20 >> 8) & 0x00FF00FFU) + 0x00800080U) & 0xFF00FF00U) >> 8;
+    d_31 = ((d_31 + ((d_31 >> 8) & 0x00FF00FFU) + 0x00800080U) & 0xFF00FF00U);
+
+    return d_20 + d_31 + s;
+  }
+
+  virtual void compile(X86Compiler& cc) {
+    asmtest::generateAlphaBlend(cc);
+  }
+
+  virtual bool run(void* _func, StringBuilder& result, StringBuilder& expect) {
+    typedef void (*Func)(void*, const void*, size_t);
+    Func func = ptr_as_func<Func>(_func);
+
+    static const uint32_t dstConstData[] = { 0x00000000, 0x10101010, 0x20100804, 0x30200003, 0x40204040, 0x5000004D, 0x60302E2C, 0x706F6E6D, 0x807F4F2F, 0x90349001, 0xA0010203, 0xB03204AB, 0xC023AFBD, 0xD0D0D0C0, 0xE0AABBCC, 0xFFFFFFFF, 0xF8F4F2F1 };
+    static const uint32_t srcConstData[] = { 0xE0E0E0E0, 0xA0008080, 0x341F1E1A, 0xFEFEFEFE, 0x80302010, 0x49490A0B, 0x998F7798, 0x00000000, 0x01010101, 0xA0264733, 0xBAB0B1B9, 0xFF000000, 0xDAB0A0C1, 0xE0BACFDA, 0x99887766, 0xFFFFFF80, 0xEE0A5FEC };
+
+    uint32_t _dstBuffer[kCount + 3];
+    uint32_t _srcBuffer[kCount + 3];
+
+    // Has to be aligned.
+    uint32_t* dstBuffer = (uint32_t*)Utils::alignTo<intptr_t>((intptr_t)_dstBuffer, 16);
+    uint32_t* srcBuffer = (uint32_t*)Utils::alignTo<intptr_t>((intptr_t)_srcBuffer, 16);
+
+    ::memcpy(dstBuffer, dstConstData, sizeof(dstConstData));
+    ::memcpy(srcBuffer, srcConstData, sizeof(srcConstData));
+
+    uint32_t i;
+    uint32_t expBuffer[kCount];
+
+    for (i = 0; i < kCount; i++) {
+      expBuffer[i] = blendSrcOver(dstBuffer[i], srcBuffer[i]);
+    }
+
+    func(dstBuffer, srcBuffer, kCount);
+
+    result.setString("buf={");
+    expect.setString("buf={");
+
+    for (i = 0; i < kCount; i++) {
+      if (i != 0) {
+        result.appendString(", ");
+        expect.appendString(", ");
+      }
+
+      result.appendFormat("%08X", static_cast<unsigned int>(dstBuffer[i]));
+      expect.appendFormat("%08X", static_cast<unsigned int>(expBuffer[i]));
+    }
+
+    result.appendString("}");
+    expect.appendString("}");
+
+    return result == expect;
+  }
+};
+
+// ============================================================================
+// [X86Test_AllocAvx512Mask]
+// ============================================================================
+
+class X86Test_AllocAvx512Mask : public X86Test {
+public:
+  X86Test_AllocAvx512Mask() : X86Test("[Alloc] AVX-512 Mask") {}
+
+  enum { kMaskCount = 10 };
+
+  static void add(X86TestManager& mgr) {
+    mgr.add(new X86Test_AllocAvx512Mask());
+  }
+
+  virtual void compile(X86Compiler& cc) {
+    cc.addFunc(FuncSignature4<uint32_t, float*, float*, const float*, const float*>(CallConv::kIdHost));
+
+    X86Gp dst0 = cc.newIntPtr("dst0");
+    X86Gp dst1 = cc.newIntPtr("dst1");
+    X86Gp a = cc.newIntPtr("a");
+    X86Gp b = cc.newIntPtr("b");
+
+    cc.setArg(0, dst0);
+    cc.setArg(1, dst1);
+    cc.setArg(2, a);
+    cc.setArg(3, b);
+
+    X86Zmm za = cc.newZmmPs("za");
+    X86Zmm zb = cc.newZmmPs("zb");
+    X86Zmm zc = cc.newZmmPs("zc");
+    X86KReg lt = cc.newKw("lt");
+
+    // Splat constants are folded into {1to16} broadcasts.
+    X86Mem two = cc.newXmmConst(kConstScopeLocal, Data128::fromF32(2.0f));
+
+    cc.vmovups(za, x86::ptr(a));
+    cc.vmovups(zb, x86::ptr(b));
+    cc.vcmpps(lt, za, zb, 1);
+
+    // Zero-masking: dst0 = a < b ? a * 2 : 0.
+    cc.k(lt).z().vmulps(zc, za, two);
+    cc.vmovups(x86::ptr(dst0), zc);
+
+    // Merge-masking: dst1 = a < b ? a + 2 : b.
+    cc.vmovaps(zc, zb);
+    cc.k(lt).vaddps(zc, za, two);
+    cc.vmovups(x86::ptr(dst1), zc);
+
+    // Keep more masks alive than there are K registers to force spills.
+    X86KReg masks[kMaskCount];
+    for (uint32_t i = 0; i < kMaskCount; i++) {
+      masks[i] = cc.newKw("m%u", i);
+      cc.vcmpps(masks[i], za, cc.newXmmConst(kConstScopeLocal, Data128::fromF32(float(i))), 6);
+    }
+
+    X86Gp r = cc.newInt32("r");
+    X86Gp t = cc.newInt32("t");
+    cc.xor_(r, r);
+
+    for (uint32_t i = 0; i < kMaskCount; i++) {
+      cc.kmovw(t, masks[i]);
+      cc.rol(r, 3);
+      cc.xor_(r, t);
+    }
+
+    cc.ret(r);
+    cc.endFunc();
+  }
+
+  virtual bool run(void* _func, StringBuilder& result, StringBuilder& expect) {
+    typedef uint32_t (*Func)(float*, float*, const float*, const float*);
+    Func func = ptr_as_func<Func>(_func);
+
+    // Nothing to verify if the host doesn't support AVX-512, the test still
+    // checks that masks are allocated and spilled without errors.
+    if (!CpuInfo::getHost().hasFeature(CpuInfo::kX86FeatureAVX512_F)) {
+      result.setString("skipped");
+      expect.setString("skipped");
+      return true;
+    }
+
+    float a[16], b[16];
+    float dst0[16], dst1[16];
+
+    for (uint32_t i = 0; i < 16; i++) {
+      a[i] = float(int(i * 7) % 13) - 1.0f;
+      b[i] = float(int(i * 5) % 11);
+    }
+
+    uint32_t resultRet = func(dst0, dst1, a, b);
+    uint32_t expectRet = 0;
+
+    for (uint32_t j = 0; j < kMaskCount; j++) {
+      uint32_t m = 0;
+      for (uint32_t i = 0; i < 16; i++)
+        m |= uint32_t(a[i] > float(j)) << i;
+      expectRet = ((expectRet << 3) | (expectRet >> 29)) ^ m;
+    }
+
+    bool valid = true;
+    for (uint32_t i = 0; i < 16; i++) {
+      valid &= dst0[i] == (a[i] < b[i] ? a[i] * 2.0f : 0.0f);
+      valid &= dst1[i] == (a[i] < b[i] ? a[i] + 2.0f : b[i]);
+    }
+
+    result.setFormat("ret=%08X valid=%d", resultRet, int(valid));
+    expect.setFormat("ret=%08X valid=%d", expectRet, 1);
+
+    return result.eq(expect);
+  }
+};
+
+// ============================================================================
+// [X86Test_CallBase]
+// ============================================================================
+
+class X86Test_CallBase : public X86Test {
+public:
+  X86Test_CallBase() : X86Test("[Call] CDecl") {}
+
+  static void add(X86TestManager& mgr) {
+    mgr.add(new X86Test_CallBase());
+  }
+
+  virtual void compile(X86Compiler& cc) {
+    X86Gp v0 = cc.newInt32("v0");
+    X86Gp v1 = cc.newInt32("v1");
+    X86Gp v2 = cc.newInt32("v2");
+
+    cc.addFunc(FuncSignature3<int, int, int, int>(CallConv::kIdHost));
+    cc.setArg(0, v0);
+    cc.setArg(1, v1);
+    cc.setArg(2, v2);
+
+    // Just do something.
+    cc.shl(v0, 1);
+    cc.shl(v1, 1);
+    cc.shl(v2, 1);
+
+    // Call a function.
+    X86Gp fn = cc.newIntPtr("fn");
+    cc.mov(fn, imm_ptr(calledFunc));
+
+    CCFuncCall* call = cc.call(fn, FuncSignature3<int, int, int, int>(CallConv::kIdHost));
+    call->setArg(0, v2);
+    call->setArg(1, v1);
+    call->setArg(2, v0);
+    call->setRet(0, v0);
+
+    cc.ret(v0);
+    cc.endFunc();
+  }
+
+  virtual bool run(void* _func, StringBuilder& result, StringBuilder& expect) {
+    typedef int (*Func)(int, int, int);
+    Func func = ptr_as_func<Func>(_func);
+
+    int resultRet = func(3, 2, 1);
+    int expectRet = 36;
+
+    result.setFormat("ret=%d", resultRet);
+    expect.setFormat("ret=%d", expectRet);
+
+    return resultRet == expectRet;
+  }
+
+  static int calledFunc(int a, int b, int c) { return (a + b) * c; }
+};
+
+// ============================================================================
+// [X86Test_CallFast]
+// ============================================================================
+
+class X86Test_CallFast : public X86Test {
+public:
+  X86Test_CallFast() : X86Test("[Call] Fastcall") {}
+
+  static void add(X86TestManager& mgr) {
+    mgr.add(new X86Test_CallFast());
+  }
+
+  virtual void compile(X86Compiler& cc) {
+    X86Gp var = cc.newInt32("var");
+    X86Gp fn = cc.newIntPtr("fn");
+
+    cc.addFunc(FuncSignature1<int, int>(CallConv::kIdHost));
+    cc.setArg(0, var);
+
+    cc.mov(fn, imm_ptr(calledFunc));
+    CCFuncCall* call;
+
+    call = cc.call(fn, FuncSignature1<int, int>(CallConv::kIdHostFastCall));
+    call->setArg(0, var);
+    call->setRet(0, var);
+
+    call = cc.call(fn, FuncSignature1<int, int>(CallConv::kIdHostFastCall));
+    call->setArg(0, var);
+    call->setRet(0, var);
+
+    cc.ret(var);
+    cc.endFunc();
+  }
+
+  virtual bool run(void* _func, StringBuilder& result, StringBuilder& expect) {
+    typedef int (*Func)(int);
+    Func func = ptr_as_func<Func>(_func);
+
+    int resultRet = func(9);
+    int expectRet = (9 * 9) * (9 * 9);
+
+    result.setFormat("ret=%d", resultRet);
+    expect.setFormat("ret=%d", expectRet);
+
+    return resultRet == expectRet;
+  }
+
+  // Function that is called inside the generated one. Because this test is
+  // mainly about register arguments, we need to use the fastcall calling
+  // convention when running 32-bit.
+  static int ASMJIT_FASTCALL calledFunc(int a) { return a * a; }
+};
+
+// ============================================================================
+// [X86Test_CallManyArgs]
+// ============================================================================
+
+class X86Test_CallManyArgs : public X86Test {
+public:
+  X86Test_CallManyArgs() : X86Test("[Call] Many Args") {}
+
+  static void add(X86TestManager& mgr) {
+    mgr.add(new X86Test_CallManyArgs());
+  }
+
+  static int calledFunc(int a, int b, int c, int d, int e, int f, int g, int h, int i, int j) {
+    return (a * b * c * d * e) + (f * g * h * i * j);
+  }
+
+  virtual void compile(X86Compiler& cc) {
+    cc.addFunc(FuncSignature0<int>(CallConv::kIdHost));
+
+    // Prepare.
+    X86Gp fn = cc.newIntPtr("fn");
+    X86Gp va = cc.newInt32("va");
+    X86Gp vb = cc.newInt32("vb");
+    X86Gp vc = cc.newInt32("vc");
+    X86Gp vd = cc.newInt32("vd");
+    X86Gp ve = cc.newInt32("ve");
+    X86Gp vf = cc.newInt32("vf");
+    X86Gp vg = cc.newInt32("vg");
+    X86Gp vh = cc.newInt32("vh");
+    X86Gp vi = cc.newInt32("vi");
+    X86Gp vj = cc.newInt32("vj");
+
+    cc.mov(fn, imm_ptr(calledFunc));
+    cc.mov(va, 0x03);
+    cc.mov(vb, 0x12);
+    cc.mov(vc, 0xA0);
+    cc.mov(vd, 0x0B);
+    cc.mov(ve, 0x2F);
+    cc.mov(vf, 0x02);
+    cc.mov(vg, 0x0C);
+    cc.mov(vh, 0x12);
+    cc.mov(vi, 0x18);
+    cc.mov(vj, 0x1E);
+
+    // Call function.
+    CCFuncCall* call = cc.call(fn, FuncSignature10<int, int, int, int, int, int, int, int, int, int, int>(CallConv::kIdHost));
+    call->setArg(0, va);
+    call->setArg(1, vb);
+    call->setArg(2, vc);
+    call->setArg(3, vd);
+    call->setArg(4, ve);
+    call->setArg(5, vf);
+    call->setArg(6, vg);
+    call->setArg(7, vh);
+    call->setArg(8, vi);
+    call->setArg(9, vj);
+    call->setRet(0, va);
+
+    cc.ret(va);
+    cc.endFunc();
+  }
+
+  virtual bool run(void* _func, StringBuilder& result, StringBuilder& expect) {
+    typedef int (*Func)(void);
+    Func func = ptr_as_func<Func>(_func);
+
+    int resultRet = func();
+    int expectRet = calledFunc(0x03, 0x12, 0xA0, 0x0B, 0x2F, 0x02, 0x0C, 0x12, 0x18, 0x1E);
+
+    result.setFormat("ret=%d", resultRet);
+    expect.setFormat("ret=%d", expectRet);
+
+    return resultRet == expectRet;
+  }
+};
+
+// ============================================================================
+// [X86Test_CallDuplicateArgs]
+// ============================================================================
+
+class X86Test_CallDuplicateArgs : public X86Test {
+public:
+  X86Test_CallDuplicateArgs() : X86Test("[Call] Duplicate Args") {}
+
+  static void add(X86TestManager& mgr) {
+    mgr.add(new X86Test_CallDuplicateArgs());
+  }
+
+  static int calledFunc(int a, int b, int c, int d, int e, int f, int g, int h, int i, int j) {
+    return (a * b * c * d * e) + (f * g * h * i * j);
+  }
+
+  virtual void compile(X86Compiler& cc) {
+    cc.addFunc(FuncSignature0<int>(CallConv::kIdHost));
+
+    // Prepare.
+    X86Gp fn = cc.newIntPtr("fn");
+    X86Gp a = cc.newInt32("a");
+
+    cc.mov(fn, imm_ptr(calledFunc));
+    cc.mov(a, 3);
+
+    // Call function.
+    CCFuncCall* call = cc.call(fn, FuncSignature10<int, int, int, int, int, int, int, int, int, int, int>(CallConv::kIdHost));
+    call->setArg(0, a);
+    call->setArg(1, a);
+    call->setArg(2, a);
+    call->setArg(3, a);
+    call->setArg(4, a);
+    call->setArg(5, a);
+    call->setArg(6, a);
+    call->setArg(7, a);
+    call->setArg(8, a);
+    call->setArg(9, a);
+    call->setRet(0, a);
+
+    cc.ret(a);
+    cc.endFunc();
+  }
+
+  virtual bool run(void* _func, StringBuilder& result, StringBuilder& expect) {
+    typedef int (*Func)(void);
+    Func func = ptr_as_func<Func>(_func);
+
+    int resultRet = func();
+    int expectRet = calledFunc(3, 3, 3, 3, 3, 3, 3, 3, 3, 3);
+
+    result.setFormat("ret=%d", resultRet);
+    expect.setFormat("ret=%d", expectRet);
+
+    return resultRet == expectRet;
+  }
+};
+
+// ============================================================================
+// [X86Test_CallImmArgs]
+// ============================================================================
+
+class X86Test_CallImmArgs : public X86Test {
+public:
+  X86Test_CallImmArgs() : X86Test("[Call] Imm Args") {}
+
+  static void add(X86TestManager& mgr) {
+    mgr.add(new X86Test_CallImmArgs());
+  }
+
+  virtual void compile(X86Compiler& cc) {
+    cc.addFunc(FuncSignature0<int>(CallConv::kIdHost));
+
+    // Prepare.
+    X86Gp fn = cc.newIntPtr("fn");
+    X86Gp rv = cc.newInt32("rv");
+
+    cc.mov(fn, imm_ptr(X86Test_CallManyArgs::calledFunc));
+
+    // Call function.
+    CCFuncCall* call = cc.call(fn, FuncSignature10<int, int, int, int, int, int, int, int, int, int, int>(CallConv::kIdHost));
+    call->setArg(0, imm(0x03));
+    call->setArg(1, imm(0x12));
+    call->setArg(2, imm(0xA0));
+    call->setArg(3, imm(0x0B));
+    call->setArg(4, imm(0x2F));
+    call->setArg(5, imm(0x02));
+    call->setArg(6, imm(0x0C));
+    call->setArg(7, imm(0x12));
+    call->setArg(8, imm(0x18));
+    call->setArg(9, imm(0x1E));
+    call->setRet(0, rv);
+
+    cc.ret(rv);
+    cc.endFunc();
+  }
+
+  virtual bool run(void* _func, StringBuilder& result, StringBuilder& expect) {
+    typedef int (*Func)(void);
+    Func func = ptr_as_func<Func>(_func);
+
+    int resultRet = func();
+    int expectRet = X86Test_CallManyArgs::calledFunc(0x03, 0x12, 0xA0, 0x0B, 0x2F, 0x02, 0x0C, 0x12, 0x18, 0x1E);
+
+    result.setFormat("ret=%d", resultRet);
+    expect.setFormat("ret=%d", expectRet);
+
+    return resultRet == expectRet;
+  }
+};
+
+// ============================================================================
+// [X86Test_CallPtrArgs]
+// ============================================================================
+
+class X86Test_CallPtrArgs : public X86Test {
+public:
+  X86Test_CallPtrArgs() : X86Test("[Call] Ptr Args") {}
+
+  static void add(X86TestManager& mgr) {
+    mgr.add(new X86Test_CallPtrArgs());
+  }
+
+  static int calledFunc(void* a, void* b, void* c, void* d, void* e, void* f, void* g, void* h, void* i, void* j) {
+    return static_cast<int>((intptr_t)a) +
+           static_cast<int>((intptr_t)b) +
+           static_cast<int>((intptr_t)c) +
+           static_cast<int>((intptr_t)d) +
+           static_cast<int>((intptr_t)e) +
+           static_cast<int>((intptr_t)f) +
+           static_cast<int>((intptr_t)g) +
+           static_cast<int>((intptr_t)h) +
+           static_cast<int>((intptr_t)i) +
+           static_cast<int>((intptr_t)j) ;
+  }
+
+  virtual void compile(X86Compiler& cc) {
+    cc.addFunc(FuncSignature0<int>(CallConv::kIdHost));
+
+    // Prepare.
+    X86Gp fn = cc.newIntPtr("fn");
+    X86Gp rv = cc.newInt32("rv");
+
+    cc.mov(fn, imm_ptr(calledFunc));
+
+    // Call function.
+    CCFuncCall* call = cc.call(fn, FuncSignature10<int, void*, void*, void*, void*, void*, void*, void*, void*, void*, void*>(CallConv::kIdHost));
+    call->setArg(0, imm(0x01));
+    call->setArg(1, imm(0x02));
+    call->setArg(2, imm(0x03));
+    call->setArg(3, imm(0x04));
+    call->setArg(4, imm(0x05));
+    call->setArg(5, imm(0x06));
+    call->setArg(6, imm(0x07));
+    call->setArg(7, imm(0x08));
+    call->setArg(8, imm(0x09));
+    call->setArg(9, imm(0x0A));
+    call->setRet(0, rv);
+
+    cc.ret(rv);
+    cc.endFunc();
+  }
+
+  virtual bool run(void* _func, StringBuilder& result, StringBuilder& expect) {
+    typedef int (*Func)(void);
+    Func func = ptr_as_func<Func>(_func);
+
+    int resultRet = func();
+    int expectRet = 55;
+
+    result.setFormat("ret=%d", resultRet);
+    expect.setFormat("ret=%d", expectRet);
+
+    return resultRet == expectRet;
+  }
+};
+
+// ============================================================================
+// [X86Test_CallFloatAsXmmRet]
+// ============================================================================
+
+class X86Test_CallFloatAsXmmRet : public X86Test {
+public:
+  X86Test_CallFloatAsXmmRet() : X86Test("[Call] Float As Xmm Ret") {}
+
+  static void add(X86TestManager& mgr) {
+    mgr.add(new X86Test_CallFloatAsXmmRet());
+  }
+
+  static float calledFunc(float a, float b) {
+    return a * b;
+  }
+
+  virtual void compile(X86Compiler& cc) {
+    cc.addFunc(FuncSignature2<float, float, float>(CallConv::kIdHost));
+
+    X86Xmm a = cc.newXmmSs("a");
+    X86Xmm b = cc.newXmmSs("b");
+    X86Xmm ret = cc.newXmmSs("ret");
+
+    cc.setArg(0, a);
+    cc.setArg(1, b);
+
+    // Prepare.
+    X86Gp fn = cc.newIntPtr("fn");
+    cc.mov(fn, imm_ptr(calledFunc));
+
+    // Call function.
+    CCFuncCall* call = cc.call(fn, FuncSignature2<float, float, float>(CallConv::kIdHost));
+
+    call->setArg(0, a);
+    call->setArg(1, b);
+    call->setRet(0, ret);
+
+    cc.ret(ret);
+    cc.endFunc();
+  }
+
+  virtual bool run(void* _func, StringBuilder& result, StringBuilder& expect) {
+    typedef float (*Func)(float, float);
+    Func func = ptr_as_func<Func>(_func);
+
+    float resultRet = func(15.5f, 2.0f);
+    float expectRet = calledFunc(15.5f, 2.0f);
+
+    result.setFormat("ret=%g", resultRet);
+    expect.setFormat("ret=%g", expectRet);
+
+    return resultRet == expectRet;
+  }
+};
+
+// ============================================================================
+// [X86Test_CallDoubleAsXmmRet]
+// ============================================================================
+
+class X86Test_CallDoubleAsXmmRet : public X86Test {
+public:
+  X86Test_CallDoubleAsXmmRet() : X86Test("[Call] Double As Xmm Ret") {}
+
+  static void add(X86TestManager& mgr) {
+    mgr.add(new X86Test_CallDoubleAsXmmRet());
+  }
+
+  static double calledFunc(double a, double b) {
+    return a * b;
+  }
+
+  virtual void compile(X86Compiler& cc) {
+    cc.addFunc(FuncSignature2<double, double, double>(CallConv::kIdHost));
+
+    X86Xmm a = cc.newXmmSd("a");
+    X86Xmm b = cc.newXmmSd("b");
+    X86Xmm ret = cc.newXmmSd("ret");
+
+    cc.setArg(0, a);
+    cc.setArg(1, b);
+
+    X86Gp fn = cc.newIntPtr("fn");
+    cc.mov(fn, imm_ptr(calledFunc));
+
+    CCFuncCall* call = cc.call(fn, FuncSignature2<double, double, double>(CallConv::kIdHost));
+
+    call->setArg(0, a);
+    call->setArg(1, b);
+    call->setRet(0, ret);
+
+    cc.ret(ret);
+    cc.endFunc();
+  }
+
+  virtual bool run(void* _func, StringBuilder& result, StringBuilder& expect) {
+    typedef double (*Func)(double, double);
+    Func func = ptr_as_func<Func>(_func);
+
+    double resultRet = func(15.5, 2.0);
+    double expectRet = calledFunc(15.5, 2.0);
+
+    result.setFormat("ret=%g", resultRet);
+    expect.setFormat("ret=%g", expectRet);
+
+    return resultRet == expectRet;
+  }
+};
+
+// ============================================================================
+// [X86Test_CallConditional]
+// ============================================================================
+
+class X86Test_CallConditional : public X86Test {
+public:
+  X86Test_CallConditional() : X86Test("[Call] Conditional") {}
+
+  static void add(X86TestManager& mgr) {
+    mgr.add(new X86Test_CallConditional());
+  }
+
+  virtual void compile(X86Compiler& cc) {
+    X86Gp x = cc.newInt32("x");
+    X86Gp y = cc.newInt32("y");
+    X86Gp op = cc.newInt32("op");
 
-    static const char token[kTokenSize] = "-+:|abcdefghijklmnopqrstuvwxyz|";
     CCFuncCall* call;
+    X86Gp result;
+
+    cc.addFunc(FuncSignature3<int, int, int, int>(CallConv::kIdHost));
+    cc.setArg(0, x);
+    cc.setArg(1, y);
+    cc.setArg(2, op);
+
+    Label opAdd = cc.newLabel();
+    Label opMul = cc.newLabel();
+
+    cc.cmp(op, 0);
+    cc.jz(opAdd);
+    cc.cmp(op, 1);
+    cc.jz(opMul);
+
+    result = cc.newInt32("result_0");
+    cc.mov(result, 0);
+    cc.ret(result);
+
+    cc.bind(opAdd);
+    result = cc.newInt32("result_1");
+
+    call = cc.call((uint64_t)calledFuncAdd, FuncSignature2<int, int, int>(CallConv::kIdHost));
+    call->setArg(0, x);
+    call->setArg(1, y);
+    call->setRet(0, result);
+    cc.ret(result);
+
+    cc.bind(opMul);
+    result = cc.newInt32("result_2");
+
+    call = cc.call((uint64_t)calledFuncMul, FuncSignature2<int, int, int>(CallConv::kIdHost));
+    call->setArg(0, x);
+    call->setArg(1, y);
+    call->setRet(0, result);
+
+    cc.ret(result);
+    cc.endFunc();
+  }
+
+  virtual bool run(void* _func, StringBuilder& result, StringBuilder& expect) {
+    typedef int (*Func)(int, int, int);
+    Func func = ptr_as_func<Func>(_func);
+
+    int arg1 = 4;
+    int arg2 = 8;
+
+    int resultAdd = func(arg1, arg2, 0);
+    int expectAdd = calledFuncAdd(arg1, arg2);
+
+    int resultMul = func(arg1, arg2, 1);
+    int expectMul = calledFuncMul(arg1, arg2);
+
+    result.setFormat("ret={add=%d, mul=%d}", resultAdd, resultMul);
+    expect.setFormat("ret={add=%d, mul=%d}", expectAdd, expectMul);
+
+    return (resultAdd == expectAdd) && (resultMul == expectMul);
+  }
+
+  static int calledFuncAdd(int x, int y) { return x + y; }
+  static int calledFuncMul(int x, int y) { return x * y; }
+};
+
+// ============================================================================
+// [X86Test_CallMultiple]
+// ============================================================================
+
+class X86Test_CallMultiple : public X86Test {
+public:
+  X86Test_CallMultiple() : X86Test("[Call] Multiple") {}
+
+  static void add(X86TestManager& mgr) {
+    mgr.add(new X86Test_CallMultiple());
+  }
+
+  static int ASMJIT_FASTCALL calledFunc(int* pInt, int index) {
+    return pInt[index];
+  }
+
+  virtual void compile(X86Compiler& cc) {
+    unsigned int i;
+
+    X86Gp buf = cc.newIntPtr("buf");
+    X86Gp acc0 = cc.newInt32("acc0");
+    X86Gp acc1 = cc.newInt32("acc1");
+
+    cc.addFunc(FuncSignature1<int, int*>(CallConv::kIdHost));
+    cc.setArg(0, buf);
+
+    cc.mov(acc0, 0);
+    cc.mov(acc1, 0);
+
+    for (i = 0; i < 4; i++) {
+      X86Gp ret = cc.newInt32("ret");
+      X86Gp ptr = cc.newIntPtr("ptr");
+      X86Gp idx = cc.newInt32("idx");
+      CCFuncCall* call;
+
+      cc.mov(ptr, buf);
+      cc.mov(idx, static_cast<int>(i));
+
+      call = cc.call((uint64_t)calledFunc, FuncSignature2<int, int*, int>(CallConv::kIdHostFastCall));
+      call->setArg(0, ptr);
+      call->setArg(1, idx);
+      call->setRet(0, ret);
+
+      cc.add(acc0, ret);
+
+      cc.mov(ptr, buf);
+      cc.mov(idx, static_cast<int>(i));
+
+      call = cc.call((uint64_t)calledFunc, FuncSignature2<int, int*, int>(CallConv::kIdHostFastCall));
+      call->setArg(0, ptr);
+      call->setArg(1, idx);
+      call->setRet(0, ret);
+
+      cc.sub(acc1, ret);
+    }
+
+    cc.add(acc0, acc1);
+    cc.ret(acc0);
+    cc.endFunc();
+  }
+
+  virtual bool run(void* _func, StringBuilder& result, StringBuilder& expect) {
+    typedef int (*Func)(int*);
+    Func func = ptr_as_func<Func>(_func);
+
+    int buffer[4] = { 127, 87, 23, 17 };
+
+    int resultRet = func(buffer);
+    int expectRet = 0;
+
+    result.setFormat("ret=%d", resultRet);
+    expect.setFormat("ret=%d", expectRet);
+
+    return resultRet == expectRet;
+  }
+};
+
+// ============================================================================
+// [X86Test_CallSameArgs]
+// ============================================================================
+
+class X86Test_CallSameArgs : public X86Test {
+public:
+  X86Test_CallSameArgs() : X86Test("[Call] Same Args") {}
+
+  static void add(X86TestManager& mgr) {
+    mgr.add(new X86Test_CallSameArgs());
+  }
+
+  static int calledInt(int a, int b) { return a - b; }
+  static double calledDouble(int a, int b) { return double(a) * double(b); }
+
+  virtual void compile(X86Compiler& cc) {
+    cc.addFunc(FuncSignature2<int, int, int>(CallConv::kIdHost));
+
+    X86Gp a = cc.newInt32("a");
+    X86Gp b = cc.newInt32("b");
+    X86Gp acc = cc.newInt32("acc");
+
+    cc.setArg(0, a);
+    cc.setArg(1, b);
+    cc.mov(acc, 0);
+
+    // Signatures that only differ in the return type must not share details.
+    for (unsigned int i = 0; i < 2; i++) {
+      X86Gp iRet = cc.newInt32("iRet");
+      X86Xmm dRet = cc.newXmmSd("dRet");
+      X86Gp tmp = cc.newInt32("tmp");
+      CCFuncCall* call;
+
+      call = cc.call(imm_ptr((void*)calledInt), FuncSignature2<int, int, int>(CallConv::kIdHost));
+      call->setArg(0, a);
+      call->setArg(1, b);
+      call->setRet(0, iRet);
+      cc.add(acc, iRet);
+
+      call = cc.call(imm_ptr((void*)calledDouble), FuncSignature2<double, int, int>(CallConv::kIdHost));
+      call->setArg(0, a);
+      call->setArg(1, b);
+      call->setRet(0, dRet);
+      cc.cvttsd2si(tmp, dRet);
+      cc.add(acc, tmp);
+    }
+
+    cc.ret(acc);
+    cc.endFunc();
+  }
+
+  virtual bool run(void* _func, StringBuilder& result, StringBuilder& expect) {
+    typedef int (*Func)(int, int);
+    Func func = ptr_as_func<Func>(_func);
+
+    int resultRet = func(7, 3);
+    int expectRet = 2 * ((7 - 3) + (7 * 3));
+
+    result.setFormat("ret=%d", resultRet);
+    expect.setFormat("ret=%d", expectRet);
+
+    return resultRet == expectRet;
+  }
+};
+
+// ============================================================================
+// [X86Test_CallCustomConv]
+// ============================================================================
+
+class X86Test_CallCustomConv : public X86Test {
+public:
+  X86Test_CallCustomConv() : X86Test("[Call] Custom CallConv") {}
+
+  enum { kMaxArgs = 12 };
+
+  static void add(X86TestManager& mgr) {
+    mgr.add(new X86Test_CallCustomConv());
+  }
+
+  virtual void compile(X86Compiler& cc) {
+    // Pass all arguments in vector registers (12 on X64, more than the ABI
+    // allows), return in a non-default register and preserve no vectors.
+    static const uint8_t x64Order[] = { 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15 };
+    static const uint8_t x86Order[] = { 7, 6, 5, 4, 3, 2, 1, 0 };
+
+    uint32_t i;
+    uint32_t argCount = cc.is64Bit() ? 12 : 8;
+
+    CallConv custom;
+    custom.init(CallConv::kIdHost);
+    custom.setPassedOrder(X86Reg::kKindVec, cc.is64Bit() ? x64Order : x86Order, argCount);
+    custom.setRetOrder(X86Reg::kKindVec, 9);
+    custom.setPreservedRegs(X86Reg::kKindVec, 0);
+
+    FuncSignatureX sign;
+    sign.setRetT<double>();
+    for (i = 0; i < argCount; i++)
+      sign.addArgT<double>();
+    sign.setCustomCallConv(&custom);
+
+    CCFunc* f1 = cc.newFunc(FuncSignature1<double, const double*>(CallConv::kIdHost));
+    CCFunc* f2 = cc.newFunc(sign);
+
+    X86Xmm v[kMaxArgs];
+
+    {
+      X86Gp src = cc.newIntPtr("src");
+      X86Xmm ret = cc.newXmmSd("ret");
+
+      cc.addFunc(f1);
+      cc.setArg(0, src);
+
+      for (i = 0; i < argCount; i++) {
+        v[i] = cc.newXmmSd("v%u", i);
+        cc.movsd(v[i], x86::ptr(src, i * 8));
+      }
+
+      CCFuncCall* call = cc.call(f2->getLabel(), sign);
+      for (i = 0; i < argCount; i++)
+        call->setArg(i, v[i]);
+      call->setRet(0, ret);
+
+      cc.ret(ret);
+      cc.endFunc();
+    }
+
+    {
+      X86Xmm acc = cc.newXmmSd("acc");
+      X86Xmm tmp = cc.newXmmSd("tmp");
+      X86Gp w = cc.newInt32("w");
+
+      cc.addFunc(f2);
+      for (i = 0; i < argCount; i++) {
+        v[i] = cc.newXmmSd("a%u", i);
+        cc.setArg(i, v[i]);
+      }
+
+      // Weighted sum, so arguments passed in a wrong order are detected.
+      cc.xorpd(acc, acc);
+      for (i = 0; i < argCount; i++) {
+        cc.mov(w, i + 1);
+        cc.cvtsi2sd(tmp, w);
+        cc.mulsd(tmp, v[i]);
+        cc.addsd(acc, tmp);
+      }
+
+      cc.ret(acc);
+      cc.endFunc();
+    }
+  }
+
+  virtual bool run(void* _func, StringBuilder& result, StringBuilder& expect) {
+    typedef double (*Func)(const double*);
+    Func func = ptr_as_func<Func>(_func);
+
+    double src[kMaxArgs];
+    for (unsigned int i = 0; i < kMaxArgs; i++)
+      src[i] = double(i) + 0.5;
+
+    unsigned int argCount = sizeof(void*) == 8 ? 12 : 8;
+    double expectRet = 0.0;
+    for (unsigned int i = 0; i < argCount; i++)
+      expectRet += double(i + 1) * src[i];
+
+    double resultRet = func(src);
+
+    result.setFormat("ret=%g", resultRet);
+    expect.setFormat("ret=%g", expectRet);
+
+    return resultRet == expectRet;
+  }
+};
+
+// ============================================================================
+// [X86Test_CallRecursive]
+// ============================================================================
+
+class X86Test_CallRecursive : public X86Test {
+public:
+  X86Test_CallRecursive() : X86Test("[Call] Recursive") {}
+
+  static void add(X86TestManager& mgr) {
+    mgr.add(new X86Test_CallRecursive());
+  }
+
+  virtual void compile(X86Compiler& cc) {
+    X86Gp val = cc.newInt32("val");
+    Label skip = cc.newLabel();
+
+    CCFunc* func = cc.addFunc(FuncSignature1<int, int>(CallConv::kIdHost));
+    cc.setArg(0, val);
+
+    cc.cmp(val, 1);
+    cc.jle(skip);
+
+    X86Gp tmp = cc.newInt32("tmp");
+    cc.mov(tmp, val);
+    cc.dec(tmp);
+
+    CCFuncCall* call = cc.call(func->getLabel(), FuncSignature1<int, int>(CallConv::kIdHost));
+    call->setArg(0, tmp);
+    call->setRet(0, tmp);
+    cc.mul(cc.newInt32(), val, tmp);
+
+    cc.bind(skip);
+    cc.ret(val);
+    cc.endFunc();
+  }
+
+  virtual bool run(void* _func, StringBuilder& result, StringBuilder& expect) {
+    typedef int (*Func)(int);
+    Func func = ptr_as_func<Func>(_func);
+
+    int resultRet = func(5);
+    int expectRet = 1 * 2 * 3 * 4 * 5;
+
+    result.setFormat("ret=%d", resultRet);
+    expect.setFormat("ret=%d", expectRet);
+
+    return resultRet == expectRet;
+  }
+};
+
+// ============================================================================
+// [X86Test_CallMisc1]
+// ============================================================================
+
+class X86Test_CallMisc1 : public X86Test {
+public:
+  X86Test_CallMisc1() : X86Test("[Call] Misc #1") {}
+
+  static void add(X86TestManager& mgr) {
+    mgr.add(new X86Test_CallMisc1());
+  }
+
+  static void dummy(int a, int b) {}
+
+  virtual void compile(X86Compiler& cc) {
+    X86Gp val = cc.newInt32("val");
+    Label skip = cc.newLabel();
+
+    CCFunc* func = cc.addFunc(FuncSignature2<int, int, int>(CallConv::kIdHost));
+
+    X86Gp a = cc.newInt32("a");
+    X86Gp b = cc.newInt32("b");
+    X86Gp r = cc.newInt32("r");
+
+    cc.setArg(0, a);
+    cc.setArg(1, b);
+
+    cc.alloc(a, x86::eax);
+    cc.alloc(b, x86::ebx);
+
+    CCFuncCall* call = cc.call(imm_ptr(dummy), FuncSignature2<void, int, int>(CallConv::kIdHost));
+    call->setArg(0, a);
+    call->setArg(1, b);
+
+    cc.lea(r, x86::ptr(a, b));
+    cc.ret(r);
+
+    cc.endFunc();
+  }
+
+  virtual bool run(void* _func, StringBuilder& result, StringBuilder& expect) {
+    typedef int (*Func)(int, int);
+    Func func = ptr_as_func<Func>(_func);
+
+    int resultRet = func(44, 199);
+    int expectRet = 243;
+
+    result.setFormat("ret=%d", resultRet);
+    expect.setFormat("ret=%d", expectRet);
+
+    return resultRet == expectRet;
+  }
+};
+
+// ============================================================================
+// [X86Test_CallMisc2]
+// ============================================================================
+
+class X86Test_CallMisc2 : public X86Test {
+public:
+  X86Test_CallMisc2() : X86Test("[Call] Misc #2") {}
+
+  static void add(X86TestManager& mgr) {
+    mgr.add(new X86Test_CallMisc2());
+  }
+
+  virtual void compile(X86Compiler& cc) {
+    CCFunc* func = cc.addFunc(FuncSignature1<double, const double*>(CallConv::kIdHost));
+
+    X86Gp p = cc.newIntPtr("p");
+    X86Gp fn = cc.newIntPtr("fn");
+
+    X86Xmm arg = cc.newXmmSd("arg");
+    X86Xmm ret = cc.newXmmSd("ret");
+
+    cc.setArg(0, p);
+    cc.movsd(arg, x86::ptr(p));
+    cc.mov(fn, imm_ptr(op));
+
+    CCFuncCall* call = cc.call(fn, FuncSignature1<double, double>(CallConv::kIdHost));
+    call->setArg(0, arg);
+    call->setRet(0, ret);
+
+    cc.ret(ret);
+    cc.endFunc();
+  }
+
+  virtual bool run(void* _func, StringBuilder& result, StringBuilder& expect) {
+    typedef double (*Func)(const double*);
+    Func func = ptr_as_func<Func>(_func);
+
+    double arg = 2;
+
+    double resultRet = func(&arg);
+    double expectRet = op(arg);
 
-    cc.lea(p1, s1);
-    cc.lea(p2, s2);
+    result.setFormat("ret=%g", resultRet);
+    expect.setFormat("ret=%g", expectRet);
 
-    // Try to corrupt the stack if wrongly allocated.
-    call = cc.call(imm_ptr((void*)memcpy), FuncSignature3<void*, void*, void*, size_t>(CallConv::kIdHostCDecl));
-    call->setArg(0, p1);
-    call->setArg(1, imm_ptr(token));
-    call->setArg(2, imm(kTokenSize));
-    call->setRet(0, p1);
+    return resultRet == expectRet;
+  }
 
-    call = cc.call(imm_ptr((void*)memcpy), FuncSignature3<void*, void*, void*, size_t>(CallConv::kIdHostCDecl));
-    call->setArg(0, p2);
-    call->setArg(1, imm_ptr(token));
-    call->setArg(2, imm(kTokenSize));
-    call->setRet(0, p2);
+  static double op(double a) { return a * a; }
+};
 
-    call = cc.call(imm_ptr((void*)memcmp), FuncSignature3<int, void*, void*, size_t>(CallConv::kIdHostCDecl));
-    call->setArg(0, p1);
-    call->setArg(1, p2);
-    call->setArg(2, imm(kTokenSize));
-    call->setRet(0, ret);
+// ============================================================================
+// [X86Test_CallMisc3]
+// ============================================================================
 
-    // This should be 0 on success, however, if both `p1` and `p2` were
-    // allocated in the same address this check will still pass.
-    cc.cmp(ret, 0);
-    cc.jnz(L_Exit);
+class X86Test_CallMisc3 : public X86Test {
+public:
+  X86Test_CallMisc3() : X86Test("[Call] Misc #3") {}
 
-    // Checks whether `p1` and `p2` are different (must be).
-    cc.xor_(ret, ret);
-    cc.cmp(p1, p2);
-    cc.setz(ret.r8());
+  static void add(X86TestManager& mgr) {
+    mgr.add(new X86Test_CallMisc3());
+  }
 
-    cc.bind(L_Exit);
-    cc.ret(ret);
+  virtual void compile(X86Compiler& cc) {
+    CCFunc* func = cc.addFunc(FuncSignature1<double, const double*>(CallConv::kIdHost));
+
+    X86Gp p = cc.newIntPtr("p");
+    X86Gp fn = cc.newIntPtr("fn");
+
+    X86Xmm arg = cc.newXmmSd("arg");
+    X86Xmm ret = cc.newXmmSd("ret");
+
+    cc.setArg(0, p);
+    cc.movsd(arg, x86::ptr(p));
+    cc.mov(fn, imm_ptr(op));
+
+    CCFuncCall* call = cc.call(fn, FuncSignature1<double, double>(CallConv::kIdHost));
+    call->setArg(0, arg);
+    call->setRet(0, ret);
+
+    cc.xorps(arg, arg);
+    cc.subsd(arg, ret);
+
+    cc.ret(arg);
     cc.endFunc();
   }
 
   virtual bool run(void* _func, StringBuilder& result, StringBuilder& expect) {
-    typedef int (*Func)(void);
+    typedef double (*Func)(const double*);
     Func func = ptr_as_func<Func>(_func);
 
-    int resultRet = func();
-    int expectRet = 0; // Must be zero, stack addresses must be different.
+    double arg = 2;
 
-    result.setInt(resultRet);
-    expect.setInt(expectRet);
+    double resultRet = func(&arg);
+    double expectRet = -op(arg);
+
+    result.setFormat("ret=%g", resultRet);
+    expect.setFormat("ret=%g", expectRet);
 
     return resultRet == expectRet;
   }
+
+  static double op(double a) { return a * a; }
 };
 
 // ============================================================================
-// [X86Test_AllocMemcpy]
+// [X86Test_CallMisc4]
 // ============================================================================
 
-class X86Test_AllocMemcpy : public X86Test {
+class X86Test_CallMisc4 : public X86Test {
 public:
-  X86Test_AllocMemcpy() : X86Test("[Alloc] Memcpy") {}
-
-  enum { kCount = 32 };
+  X86Test_CallMisc4() : X86Test("[Call] Misc #4") {}
 
   static void add(X86TestManager& mgr) {
-    mgr.add(new X86Test_AllocMemcpy());
+    mgr.add(new X86Test_CallMisc4());
   }
 
   virtual void compile(X86Compiler& cc) {
-    X86Gp dst = cc.newIntPtr("dst");
-    X86Gp src = cc.newIntPtr("src");
-    X86Gp cnt = cc.newUIntPtr("cnt");
+    FuncSignatureX funcPrototype;
 
-    Label L_Loop = cc.newLabel();                   // Create base labels we use
-    Label L_Exit = cc.newLabel();                   // in our function.
+    funcPrototype.setCallConv(CallConv::kIdHost);
+    funcPrototype.setRet(TypeId::kF64);
+    CCFunc* func = cc.addFunc(funcPrototype);
 
-    cc.addFunc(FuncSignature3<void, uint32_t*, const uint32_t*, size_t>(CallConv::kIdHost));
-    cc.setArg(0, dst);
-    cc.setArg(1, src);
-    cc.setArg(2, cnt);
+    FuncSignatureX callPrototype;
+    callPrototype.setCallConv(CallConv::kIdHost);
+    callPrototype.setRet(TypeId::kF64);
+    CCFuncCall* call = cc.call(imm_ptr(calledFunc), callPrototype);
 
-    cc.alloc(dst);                                  // Allocate all registers now,
-    cc.alloc(src);                                  // because we want to keep them
-    cc.alloc(cnt);                                  // in physical registers only.
+    X86Xmm ret = cc.newXmmSd("ret");
+    call->setRet(0, ret);
+    cc.ret(ret);
 
-    cc.test(cnt, cnt);                              // Exit if length is zero.
-    cc.jz(L_Exit);
+    cc.endFunc();
+  }
 
-    cc.bind(L_Loop);                                // Bind the loop label here.
+  virtual bool run(void* _func, StringBuilder& result, StringBuilder& expect) {
+    typedef double (*Func)(void);
+    Func func = ptr_as_func<Func>(_func);
 
-    X86Gp tmp = cc.newInt32("tmp");              // Copy a single dword (4 bytes).
-    cc.mov(tmp, x86::dword_ptr(src));
-    cc.mov(x86::dword_ptr(dst), tmp);
+    double resultRet = func();
+    double expectRet = 3.14;
 
-    cc.add(src, 4);                                 // Increment dst/src pointers.
-    cc.add(dst, 4);
+    result.setFormat("ret=%g", resultRet);
+    expect.setFormat("ret=%g", expectRet);
 
-    cc.dec(cnt);                                    // Loop until cnt isn't zero.
-    cc.jnz(L_Loop);
+    return resultRet == expectRet;
+  }
 
-    cc.bind(L_Exit);                                // Bind the exit label here.
-    cc.endFunc();                                   // End of function.
+  static double calledFunc() { return 3.14; }
+};
+
+// ============================================================================
+// [X86Test_CallMisc5]
+// ============================================================================
+
+// The register allocator should clobber the register used by the `call` itself.
+class X86Test_CallMisc5 : public X86Test {
+public:
+  X86Test_CallMisc5() : X86Test("[Call] Misc #5") {}
+
+  static void add(X86TestManager& mgr) {
+    mgr.add(new X86Test_CallMisc5());
   }
 
-  virtual bool run(void* _func, StringBuilder& result, StringBuilder& expect) {
-    typedef void (*Func)(uint32_t*, const uint32_t*, size_t);
-    Func func = ptr_as_func<Func>(_func);
+  virtual void compile(X86Compiler& cc) {
+    CCFunc* func = cc.addFunc(FuncSignature0<int>(CallConv::kIdHost));
 
-    uint32_t i;
+    X86Gp pFn = cc.newIntPtr("pFn");
+    X86Gp vars[16];
 
-    uint32_t dstBuffer[kCount];
-    uint32_t srcBuffer[kCount];
+    uint32_t i, regCount = cc.getGpCount();
+    ASMJIT_ASSERT(regCount <= ASMJIT_ARRAY_SIZE(vars));
 
-    for (i = 0; i < kCount; i++) {
-      dstBuffer[i] = 0;
-      srcBuffer[i] = i;
-    }
+    cc.mov(pFn, imm_ptr(calledFunc));
+    cc.spill(pFn);
 
-    func(dstBuffer, srcBuffer, kCount);
+    for (i = 0; i < regCount; i++) {
+      if (i == X86Gp::kIdBp || i == X86Gp::kIdSp)
+        continue;
 
-    result.setString("buf={");
-    expect.setString("buf={");
+      vars[i] = cc.newInt32("v%u", static_cast<unsigned int>(i));
+      cc.alloc(vars[i], i);
+      cc.mov(vars[i], 1);
+    }
 
-    for (i = 0; i < kCount; i++) {
-      if (i != 0) {
-        result.appendString(", ");
-        expect.appendString(", ");
-      }
+    CCFuncCall* call = cc.call(pFn, FuncSignature0<void>(CallConv::kIdHost));
 
-      result.appendFormat("%u", static_cast<unsigned int>(dstBuffer[i]));
-      expect.appendFormat("%u", static_cast<unsigned int>(srcBuffer[i]));
+    for (i = 1; i < regCount; i++) {
+      if (vars[i].isValid())
+        cc.add(vars[0], vars[i]);
     }
 
-    result.appendString("}");
-    expect.appendString("}");
+    cc.ret(vars[0]);
+    cc.endFunc();
+  }
 
-    return result == expect;
+  virtual bool run(void* _func, StringBuilder& result, StringBuilder& expect) {
+    typedef int (*Func)(void);
+    Func func = ptr_as_func<Func>(_func);
+
+    int resultRet = func();
+    int expectRet = sizeof(void*) == 4 ? 6 : 14;
+
+    result.setFormat("ret=%d", resultRet);
+    expect.setFormat("ret=%d", expectRet);
+
+    return resultRet == expectRet;
   }
+
+  static void calledFunc() {}
 };
 
 // ============================================================================
-// [X86Test_AllocAlphaBlend]
+// [X86Test_CallTail]
 // ============================================================================
 
-class X86Test_AllocAlphaBlend : public X86Test {
+class X86Test_CallTail : public X86Test {
 public:
-  X86Test_AllocAlphaBlend() : X86Test("[Alloc] AlphaBlend") {}
-
-  enum { kCount = 17 };
+  X86Test_CallTail() : X86Test("[Call] Tail") {}
 
   static void add(X86TestManager& mgr) {
-    mgr.add(new X86Test_AllocAlphaBlend());
+    mgr.add(new X86Test_CallTail());
   }
 
-  static uint32_t blendSrcOver(uint32_t d, uint32_t s) {
-    uint32_t saInv = ~s >> 24;
+  virtual void compile(X86Compiler& cc) {
+    cc.addFunc(FuncSignature2<int, int, int>(CallConv::kIdHostFastCall));
 
-    uint32_t d_20 = (d     ) & 0x00FF00FF;
-    uint32_t d_31 = (d >> 8) & 0x00FF00FF;
+    X86Gp a = cc.newInt32("a");
+    X86Gp b = cc.newInt32("b");
+    X86Gp fn = cc.newIntPtr("fn");
 
-    d_20 *= saInv;
-    d_31 *= saInv;
+    cc.setArg(0, a);
+    cc.setArg(1, b);
 
-    d_20 = ((d_20 + ((d_20 >> 8) & 0x00FF00FFU) + 0x00800080U) & 0xFF00FF00U) >> 8;
-    d_31 = ((d_31 + ((d_31 >> 8) & 0x00FF00FFU) + 0x00800080U) & 0xFF00FF00U);
+    // Use enough registers to make the function save and restore some.
+    uint32_t i;
+    X86Gp t[8];
+
+    for (i = 0; i < ASMJIT_ARRAY_SIZE(t); i++) {
+      t[i] = cc.newInt32("t%u", i);
+      cc.lea(t[i], x86::ptr(a, b, 0, static_cast<int32_t>(i)));
+    }
+
+    for (i = 0; i < ASMJIT_ARRAY_SIZE(t); i++)
+      cc.add(a, t[i]);
+
+    cc.mov(fn, imm_ptr(calledFunc));
+    CCFuncCall* call = cc.tailCall(fn, FuncSignature2<int, int, int>(CallConv::kIdHostFastCall));
+    call->setArg(0, a);
+    call->setArg(1, b);
+
+    cc.endFunc();
+  }
+
+  virtual bool run(void* _func, StringBuilder& result, StringBuilder& expect) {
+    typedef int (ASMJIT_FASTCALL *Func)(int, int);
+    Func func = ptr_as_func<Func>(_func);
+
+    // a = 3 + 8 * (3 + 2) + (0 + 1 + ... + 7) = 71.
+    int resultRet = func(3, 2);
+    int expectRet = calledFunc(71, 2);
+
+    result.setFormat("ret=%d", resultRet);
+    expect.setFormat("ret=%d", expectRet);
+
+    return resultRet == expectRet;
+  }
+
+  static int ASMJIT_FASTCALL calledFunc(int a, int b) { return a * 10 + b; }
+};
+
+// ============================================================================
+// [X86Test_MiscConstPool]
+// ============================================================================
+
+class X86Test_MiscConstPool : public X86Test {
+public:
+  X86Test_MiscConstPool() : X86Test("[Misc] ConstPool #1") {}
 
-    return d_20 + d_31 + s;
+  static void add(X86TestManager& mgr) {
+    mgr.add(new X86Test_MiscConstPool());
   }
 
   virtual void compile(X86Compiler& cc) {
-    asmtest::generateAlphaBlend(cc);
+    cc.addFunc(FuncSignature0<int>(CallConv::kIdHost));
+
+    X86Gp v0 = cc.newInt32("v0");
+    X86Gp v1 = cc.newInt32("v1");
+
+    X86Mem c0 = cc.newInt32Const(kConstScopeLocal, 200);
+    X86Mem c1 = cc.newInt32Const(kConstScopeLocal, 33);
+
+    cc.mov(v0, c0);
+    cc.mov(v1, c1);
+    cc.add(v0, v1);
+
+    cc.ret(v0);
+    cc.endFunc();
   }
 
   virtual bool run(void* _func, StringBuilder& result, StringBuilder& expect) {
-    typedef void (*Func)(void*, const void*, size_t);
+    typedef int (*Func)(void);
     Func func = ptr_as_func<Func>(_func);
 
-    static const uint32_t dstConstData[] = { 0x00000000, 0x10101010, 0x20100804, 0x30200003, 0x40204040, 0x5000004D, 0x60302E2C, 0x706F6E6D, 0x807F4F2F, 0x90349001, 0xA0010203, 0xB03204AB, 0xC023AFBD, 0xD0D0D0C0, 0xE0AABBCC, 0xFFFFFFFF, 0xF8F4F2F1 };
-    static const uint32_t srcConstData[] = { 0xE0E0E0E0, 0xA0008080, 0x341F1E1A, 0xFEFEFEFE, 0x80302010, 0x49490A0B, 0x998F7798, 0x00000000, 0x01010101, 0xA0264733, 0xBAB0B1B9, 0xFF000000, 0xDAB0A0C1, 0xE0BACFDA, 0x99887766, 0xFFFFFF80, 0xEE0A5FEC };
+    int resultRet = func();
+    int expectRet = 233;
 
-    uint32_t _dstBuffer[kCount + 3];
-    uint32_t _srcBuffer[kCount + 3];
+    result.setFormat("ret=%d", resultRet);
+    expect.setFormat("ret=%d", expectRet);
 
-    // Has to be aligned.
-    uint32_t* dstBuffer = (uint32_t*)Utils::alignTo<intptr_t>((intptr_t)_dstBuffer, 16);
-    uint32_t* srcBuffer = (uint32_t*)Utils::alignTo<intptr_t>((intptr_t)_srcBuffer, 16);
+    return resultRet == expectRet;
+  }
+};
 
-    ::memcpy(dstBuffer, dstConstData, sizeof(dstConstData));
-    ::memcpy(srcBuffer, srcConstData, sizeof(srcConstData));
+// ============================================================================
+// [X86Test_MiscMultiRet]
+// ============================================================================
 
-    uint32_t i;
-    uint32_t expBuffer[kCount];
+struct X86Test_MiscMultiRet : public X86Test {
+  X86Test_MiscMultiRet() : X86Test("[Misc] MultiRet") {}
 
-    for (i = 0; i < kCount; i++) {
-      expBuffer[i] = blendSrcOver(dstBuffer[i], srcBuffer[i]);
-    }
+  static void add(X86TestManager& mgr) {
+    mgr.add(new X86Test_MiscMultiRet());
+  }
 
-    func(dstBuffer, srcBuffer, kCount);
+  virtual void compile(X86Compiler& cc) {
+    cc.addFunc(FuncSignature3<int, int, int, int>(CallConv::kIdHost));
 
-    result.setString("buf={");
-    expect.setString("buf={");
+    X86Gp op = cc.newInt32("op");
+    X86Gp a = cc.newInt32("a");
+    X86Gp b = cc.newInt32("b");
 
-    for (i = 0; i < kCount; i++) {
-      if (i != 0) {
-        result.appendString(", ");
-        expect.appendString(", ");
-      }
+    Label L_Zero = cc.newLabel();
+    Label L_Add = cc.newLabel();
+    Label L_Sub = cc.newLabel();
+    Label L_Mul = cc.newLabel();
+    Label L_Div = cc.newLabel();
 
-      result.appendFormat("%08X", static_cast<unsigned int>(dstBuffer[i]));
-      expect.appendFormat("%08X", static_cast<unsigned int>(expBuffer[i]));
-    }
+    cc.setArg(0, op);
+    cc.setArg(1, a);
+    cc.setArg(2, b);
 
-    result.appendString("}");
-    expect.appendString("}");
+    cc.cmp(op, 0);
+    cc.jz(L_Add);
 
-    return result == expect;
-  }
-};
+    cc.cmp(op, 1);
+    cc.jz(L_Sub);
 
-// ============================================================================
-// [X86Test_CallBase]
-// ============================================================================
+    cc.cmp(op, 2);
+    cc.jz(L_Mul);
 
-class X86Test_CallBase : public X86Test {
-public:
-  X86Test_CallBase() : X86Test("[Call] CDecl") {}
+    cc.cmp(op, 3);
+    cc.jz(L_Div);
 
-  static void add(X86TestManager& mgr) {
-    mgr.add(new X86Test_CallBase());
-  }
+    cc.bind(L_Zero);
+    cc.xor_(a, a);
+    cc.ret(a);
 
-  virtual void compile(X86Compiler& cc) {
-    X86Gp v0 = cc.newInt32("v0");
-    X86Gp v1 = cc.newInt32("v1");
-    X86Gp v2 = cc.newInt32("v2");
+    cc.bind(L_Add);
+    cc.add(a, b);
+    cc.ret(a);
 
-    cc.addFunc(FuncSignature3<int, int, int, int>(CallConv::kIdHost));
-    cc.setArg(0, v0);
-    cc.setArg(1, v1);
-    cc.setArg(2, v2);
+    cc.bind(L_Sub);
+    cc.sub(a, b);
+    cc.ret(a);
 
-    // Just do something.
-    cc.shl(v0, 1);
-    cc.shl(v1, 1);
-    cc.shl(v2, 1);
+    cc.bind(L_Mul);
+    cc.imul(a, b);
+    cc.ret(a);
 
-    // Call a function.
-    X86Gp fn = cc.newIntPtr("fn");
-    cc.mov(fn, imm_ptr(calledFunc));
+    cc.bind(L_Div);
+    cc.cmp(b, 0);
+    cc.jz(L_Zero);
 
-    CCFuncCall* call = cc.call(fn, FuncSignature3<int, int, int, int>(CallConv::kIdHost));
-    call->setArg(0, v2);
-    call->setArg(1, v1);
-    call->setArg(2, v0);
-    call->setRet(0, v0);
+    X86Gp zero = cc.newInt32("zero");
+    cc.xor_(zero, zero);
+    cc.idiv(zero, a, b);
+    cc.ret(a);
 
-    cc.ret(v0);
     cc.endFunc();
   }
 
   virtual bool run(void* _func, StringBuilder& result, StringBuilder& expect) {
     typedef int (*Func)(int, int, int);
+
     Func func = ptr_as_func<Func>(_func);
 
-    int resultRet = func(3, 2, 1);
-    int expectRet = 36;
+    int a = 44;
+    int b = 3;
 
-    result.setFormat("ret=%d", resultRet);
-    expect.setFormat("ret=%d", expectRet);
+    int r0 = func(0, a, b);
+    int r1 = func(1, a, b);
+    int r2 = func(2, a, b);
+    int r3 = func(3, a, b);
+    int e0 = a + b;
+    int e1 = a - b;
+    int e2 = a * b;
+    int e3 = a / b;
 
-    return resultRet == expectRet;
-  }
+    result.setFormat("ret={%d %d %d %d}", r0, r1, r2, r3);
+    expect.setFormat("ret={%d %d %d %d}", e0, e1, e2, e3);
 
-  static int calledFunc(int a, int b, int c) { return (a + b) * c; }
+    return result.eq(expect);
+  }
 };
 
 // ============================================================================
-// [X86Test_CallFast]
+// [X86Test_MiscMultiFunc]
 // ============================================================================
 
-class X86Test_CallFast : public X86Test {
+class X86Test_MiscMultiFunc : public X86Test {
 public:
-  X86Test_CallFast() : X86Test("[Call] Fastcall") {}
+  X86Test_MiscMultiFunc() : X86Test("[Misc] MultiFunc") {}
 
   static void add(X86TestManager& mgr) {
-    mgr.add(new X86Test_CallFast());
+    mgr.add(new X86Test_MiscMultiFunc());
   }
 
   virtual void compile(X86Compiler& cc) {
-    X86Gp var = cc.newInt32("var");
-    X86Gp fn = cc.newIntPtr("fn");
+    CCFunc* f1 = cc.newFunc(FuncSignature2<int, int, int>(CallConv::kIdHost));
+    CCFunc* f2 = cc.newFunc(FuncSignature2<int, int, int>(CallConv::kIdHost));
 
-    cc.addFunc(FuncSignature1<int, int>(CallConv::kIdHost));
-    cc.setArg(0, var);
+    {
+      X86Gp a = cc.newInt32("a");
+      X86Gp b = cc.newInt32("b");
 
-    cc.mov(fn, imm_ptr(calledFunc));
-    CCFuncCall* call;
+      cc.addFunc(f1);
+      cc.setArg(0, a);
+      cc.setArg(1, b);
 
-    call = cc.call(fn, FuncSignature1<int, int>(CallConv::kIdHostFastCall));
-    call->setArg(0, var);
-    call->setRet(0, var);
+      CCFuncCall* call = cc.call(f2->getLabel(), FuncSignature2<int, int, int>(CallConv::kIdHost));
+      call->setArg(0, a);
+      call->setArg(1, b);
+      call->setRet(0, a);
 
-    call = cc.call(fn, FuncSignature1<int, int>(CallConv::kIdHostFastCall));
-    call->setArg(0, var);
-    call->setRet(0, var);
+      cc.ret(a);
+      cc.endFunc();
+    }
 
-    cc.ret(var);
-    cc.endFunc();
+    {
+      X86Gp a = cc.newInt32("a");
+      X86Gp b = cc.newInt32("b");
+
+      cc.addFunc(f2);
+      cc.setArg(0, a);
+      cc.setArg(1, b);
+
+      cc.add(a, b);
+      cc.ret(a);
+      cc.endFunc();
+    }
   }
 
   virtual bool run(void* _func, StringBuilder& result, StringBuilder& expect) {
-    typedef int (*Func)(int);
+    typedef int (*Func)(int, int);
+
     Func func = ptr_as_func<Func>(_func);
 
-    int resultRet = func(9);
-    int expectRet = (9 * 9) * (9 * 9);
+    int resultRet = func(56, 22);
+    int expectRet = 56 + 22;
 
     result.setFormat("ret=%d", resultRet);
     expect.setFormat("ret=%d", expectRet);
 
-    return resultRet == expectRet;
+    return result.eq(expect);
   }
-
-  // Function that is called inside the generated one. Because this test is
-  // mainly about register arguments, we need to use the fastcall calling
-  // convention when running 32-bit.
-  static int ASMJIT_FASTCALL calledFunc(int a) { return a * a; }
 };
 
 // ============================================================================
-// [X86Test_CallManyArgs]
+// [X86Test_MiscFlush]
 // ============================================================================
 
-class X86Test_CallManyArgs : public X86Test {
+class X86Test_MiscFlush : public X86Test {
 public:
-  X86Test_CallManyArgs() : X86Test("[Call] Many Args") {}
+  X86Test_MiscFlush() : X86Test("[Misc] Flush") {}
 
   static void add(X86TestManager& mgr) {
-    mgr.add(new X86Test_CallManyArgs());
-  }
-
-  static int calledFunc(int a, int b, int c, int d, int e, int f, int g, int h, int i, int j) {
-    return (a * b * c * d * e) + (f * g * h * i * j);
+    mgr.add(new X86Test_MiscFlush());
   }
 
   virtual void compile(X86Compiler& cc) {
-    cc.addFunc(FuncSignature0<int>(CallConv::kIdHost));
+    // The second function is not created yet, it's called through a label
+    // bound after the first function has been flushed.
+    Label L_F2 = cc.newLabel();
 
-    // Prepare.
-    X86Gp fn = cc.newIntPtr("fn");
-    X86Gp va = cc.newInt32("va");
-    X86Gp vb = cc.newInt32("vb");
-    X86Gp vc = cc.newInt32("vc");
-    X86Gp vd = cc.newInt32("vd");
-    X86Gp ve = cc.newInt32("ve");
-    X86Gp vf = cc.newInt32("vf");
-    X86Gp vg = cc.newInt32("vg");
-    X86Gp vh = cc.newInt32("vh");
-    X86Gp vi = cc.newInt32("vi");
-    X86Gp vj = cc.newInt32("vj");
+    {
+      X86Gp a = cc.newInt32("a");
+      X86Gp b = cc.newInt32("b");
+
+      cc.addFunc(FuncSignature2<int, int, int>(CallConv::kIdHost));
+      cc.setArg(0, a);
+      cc.setArg(1, b);
+
+      CCFuncCall* call = cc.call(L_F2, FuncSignature2<int, int, int>(CallConv::kIdHost));
+      call->setArg(0, a);
+      call->setArg(1, b);
+      call->setRet(0, a);
+
+      cc.ret(a);
+      cc.endFunc();
+    }
 
-    cc.mov(fn, imm_ptr(calledFunc));
-    cc.mov(va, 0x03);
-    cc.mov(vb, 0x12);
-    cc.mov(vc, 0xA0);
-    cc.mov(vd, 0x0B);
-    cc.mov(ve, 0x2F);
-    cc.mov(vf, 0x02);
-    cc.mov(vg, 0x0C);
-    cc.mov(vh, 0x12);
-    cc.mov(vi, 0x18);
-    cc.mov(vj, 0x1E);
+    cc.flush();
 
-    // Call function.
-    CCFuncCall* call = cc.call(fn, FuncSignature10<int, int, int, int, int, int, int, int, int, int, int>(CallConv::kIdHost));
-    call->setArg(0, va);
-    call->setArg(1, vb);
-    call->setArg(2, vc);
-    call->setArg(3, vd);
-    call->setArg(4, ve);
-    call->setArg(5, vf);
-    call->setArg(6, vg);
-    call->setArg(7, vh);
-    call->setArg(8, vi);
-    call->setArg(9, vj);
-    call->setRet(0, va);
+    {
+      X86Gp a = cc.newInt32("a");
+      X86Gp b = cc.newInt32("b");
 
-    cc.ret(va);
-    cc.endFunc();
+      cc.bind(L_F2);
+      cc.addFunc(FuncSignature2<int, int, int>(CallConv::kIdHost));
+      cc.setArg(0, a);
+      cc.setArg(1, b);
+
+      cc.sub(a, b);
+      cc.ret(a);
+      cc.endFunc();
+    }
   }
 
   virtual bool run(void* _func, StringBuilder& result, StringBuilder& expect) {
-    typedef int (*Func)(void);
+    typedef int (*Func)(int, int);
+
     Func func = ptr_as_func<Func>(_func);
 
-    int resultRet = func();
-    int expectRet = calledFunc(0x03, 0x12, 0xA0, 0x0B, 0x2F, 0x02, 0x0C, 0x12, 0x18, 0x1E);
+    int resultRet = func(56, 22);
+    int expectRet = 56 - 22;
 
     result.setFormat("ret=%d", resultRet);
     expect.setFormat("ret=%d", expectRet);
 
-    return resultRet == expectRet;
+    return result.eq(expect);
   }
 };
 
 // ============================================================================
-// [X86Test_CallDuplicateArgs]
+// [X86Test_MiscJumpRelax]
 // ============================================================================
 
-class X86Test_CallDuplicateArgs : public X86Test {
+class X86Test_MiscJumpRelax : public X86Test {
 public:
-  X86Test_CallDuplicateArgs() : X86Test("[Call] Duplicate Args") {}
+  X86Test_MiscJumpRelax() : X86Test("[Misc] JumpRelax"), _pass(nullptr) {}
 
   static void add(X86TestManager& mgr) {
-    mgr.add(new X86Test_CallDuplicateArgs());
-  }
-
-  static int calledFunc(int a, int b, int c, int d, int e, int f, int g, int h, int i, int j) {
-    return (a * b * c * d * e) + (f * g * h * i * j);
+    mgr.add(new X86Test_MiscJumpRelax());
   }
 
   virtual void compile(X86Compiler& cc) {
-    cc.addFunc(FuncSignature0<int>(CallConv::kIdHost));
+    cc.addPassT<X86JumpRelaxPass>();
+    _pass = static_cast<X86JumpRelaxPass*>(cc.getPassByName("JumpRelax"));
+
+    cc.addFunc(FuncSignature1<int, int>(CallConv::kIdHost));
 
-    // Prepare.
-    X86Gp fn = cc.newIntPtr("fn");
     X86Gp a = cc.newInt32("a");
+    X86Gp r = cc.newInt32("r");
 
-    cc.mov(fn, imm_ptr(calledFunc));
-    cc.mov(a, 3);
+    Label L_Neg = cc.newLabel();
+    Label L_End = cc.newLabel();
 
-    // Call function.
-    CCFuncCall* call = cc.call(fn, FuncSignature10<int, int, int, int, int, int, int, int, int, int, int>(CallConv::kIdHost));
-    call->setArg(0, a);
-    call->setArg(1, a);
-    call->setArg(2, a);
-    call->setArg(3, a);
-    call->setArg(4, a);
-    call->setArg(5, a);
-    call->setArg(6, a);
-    call->setArg(7, a);
-    call->setArg(8, a);
-    call->setArg(9, a);
-    call->setRet(0, a);
+    cc.setArg(0, a);
+    cc.cmp(a, 0);
+    cc.jl(L_Neg);
 
-    cc.ret(a);
+    cc.mov(r, a);
+    cc.add(r, a);
+    cc.jmp(L_End);
+
+    // Padding of the alignment must be taken into account.
+    cc.align(kAlignCode, 16);
+    cc.bind(L_Neg);
+    cc.xor_(r, r);
+    cc.sub(r, a);
+
+    cc.bind(L_End);
+    cc.ret(r);
     cc.endFunc();
   }
 
   virtual bool run(void* _func, StringBuilder& result, StringBuilder& expect) {
-    typedef int (*Func)(void);
+    typedef int (*Func)(int);
     Func func = ptr_as_func<Func>(_func);
 
-    int resultRet = func();
-    int expectRet = calledFunc(3, 3, 3, 3, 3, 3, 3, 3, 3, 3);
+    int resultRet = func(5) + func(-7);
+    int expectRet = 10 + 7;
+    uint32_t shrunk = _pass ? _pass->getShrunkCount() : 0;
 
-    result.setFormat("ret=%d", resultRet);
-    expect.setFormat("ret=%d", expectRet);
+    result.setFormat("ret=%d shrunk=%s", resultRet, shrunk ? "yes" : "no");
+    expect.setFormat("ret=%d shrunk=%s", expectRet, "yes");
 
-    return resultRet == expectRet;
+    return result.eq(expect);
   }
+
+  X86JumpRelaxPass* _pass;
 };
 
 // ============================================================================
-// [X86Test_CallImmArgs]
+// [X86Test_MiscPeephole]
 // ============================================================================
 
-class X86Test_CallImmArgs : public X86Test {
+class X86Test_MiscPeephole : public X86Test {
 public:
-  X86Test_CallImmArgs() : X86Test("[Call] Imm Args") {}
+  X86Test_MiscPeephole() : X86Test("[Misc] Peephole"), _pass(nullptr) {}
 
   static void add(X86TestManager& mgr) {
-    mgr.add(new X86Test_CallImmArgs());
+    mgr.add(new X86Test_MiscPeephole());
   }
 
   virtual void compile(X86Compiler& cc) {
-    cc.addFunc(FuncSignature0<int>(CallConv::kIdHost));
+    cc.addPassT<X86PeepholePass>();
+    _pass = static_cast<X86PeepholePass*>(cc.getPassByName("Peephole"));
 
-    // Prepare.
-    X86Gp fn = cc.newIntPtr("fn");
-    X86Gp rv = cc.newInt32("rv");
+    cc.addFunc(FuncSignature1<int, const int*>(CallConv::kIdHost));
 
-    cc.mov(fn, imm_ptr(X86Test_CallManyArgs::calledFunc));
+    X86Gp p = cc.newIntPtr("p");
+    X86Gp x = cc.newInt32("x");
+    X86Gp t = cc.newInt32("t");
 
-    // Call function.
-    CCFuncCall* call = cc.call(fn, FuncSignature10<int, int, int, int, int, int, int, int, int, int, int>(CallConv::kIdHost));
-    call->setArg(0, imm(0x03));
-    call->setArg(1, imm(0x12));
-    call->setArg(2, imm(0xA0));
-    call->setArg(3, imm(0x0B));
-    call->setArg(4, imm(0x2F));
-    call->setArg(5, imm(0x02));
-    call->setArg(6, imm(0x0C));
-    call->setArg(7, imm(0x12));
-    call->setArg(8, imm(0x18));
-    call->setArg(9, imm(0x1E));
-    call->setRet(0, rv);
+    Label L_A = cc.newLabel();
+    Label L_B = cc.newLabel();
+    Label L_End = cc.newLabel();
 
-    cc.ret(rv);
+    cc.setArg(0, p);
+
+    // Flags are overwritten by `add`, `mov x, 0` becomes `xor x, x`.
+    cc.mov(x, 0);
+    // The first load is folded into `add` as `t` is overwritten.
+    cc.mov(t, x86::dword_ptr(p));
+    cc.add(x, t);
+    cc.mov(t, x86::dword_ptr(p, 4));
+    cc.add(x, t);
+
+    // Jump to `L_A` is retargeted to `L_B`.
+    cc.jmp(L_A);
+    cc.bind(L_B);
+    cc.add(x, 100);
+    cc.jmp(L_End);
+    cc.bind(L_A);
+    cc.jmp(L_B);
+
+    cc.bind(L_End);
+    cc.ret(x);
     cc.endFunc();
   }
 
+  uint32_t getHitCount(const char* name) const {
+    uint32_t count = 0;
+    for (uint32_t i = 0; _pass && i < _pass->getRuleCount(); i++)
+      if (::strcmp(_pass->getRule(i).name, name) == 0)
+        count += _pass->getRuleHitCount(i);
+    return count;
+  }
+
   virtual bool run(void* _func, StringBuilder& result, StringBuilder& expect) {
-    typedef int (*Func)(void);
+    typedef int (*Func)(const int*);
     Func func = ptr_as_func<Func>(_func);
 
-    int resultRet = func();
-    int expectRet = X86Test_CallManyArgs::calledFunc(0x03, 0x12, 0xA0, 0x0B, 0x2F, 0x02, 0x0C, 0x12, 0x18, 0x1E);
+    static const int data[] = { 3, 39 };
+    int resultRet = func(data);
+    int expectRet = 142;
 
-    result.setFormat("ret=%d", resultRet);
-    expect.setFormat("ret=%d", expectRet);
+    result.setFormat("ret=%d xor=%u fold=%u chain=%u", resultRet,
+      getHitCount("ZeroToXor"), getHitCount("FoldLoad"), getHitCount("JumpChain"));
+    expect.setFormat("ret=%d xor=%u fold=%u chain=%u", expectRet, 1, 1, 1);
 
-    return resultRet == expectRet;
+    return result.eq(expect);
   }
+
+  X86PeepholePass* _pass;
 };
 
 // ============================================================================
-// [X86Test_CallPtrArgs]
+// [X86Test_MiscVZeroUpper]
 // ============================================================================
 
-class X86Test_CallPtrArgs : public X86Test {
+class X86Test_MiscVZeroUpper : public X86Test {
 public:
-  X86Test_CallPtrArgs() : X86Test("[Call] Ptr Args") {}
+  X86Test_MiscVZeroUpper() : X86Test("[Misc] VZeroUpper"), _pass(nullptr) {}
 
   static void add(X86TestManager& mgr) {
-    mgr.add(new X86Test_CallPtrArgs());
-  }
-
-  static int calledFunc(void* a, void* b, void* c, void* d, void* e, void* f, void* g, void* h, void* i, void* j) {
-    return static_cast<int>((intptr_t)a) +
-           static_cast<int>((intptr_t)b) +
-           static_cast<int>((intptr_t)c) +
-           static_cast<int>((intptr_t)d) +
-           static_cast<int>((intptr_t)e) +
-           static_cast<int>((intptr_t)f) +
-           static_cast<int>((intptr_t)g) +
-           static_cast<int>((intptr_t)h) +
-           static_cast<int>((intptr_t)i) +
-           static_cast<int>((intptr_t)j) ;
+    mgr.add(new X86Test_MiscVZeroUpper());
   }
 
   virtual void compile(X86Compiler& cc) {
-    cc.addFunc(FuncSignature0<int>(CallConv::kIdHost));
+    cc.addPassT<X86VZeroUpperPass>();
+    _pass = static_cast<X86VZeroUpperPass*>(cc.getPassByName("VZeroUpper"));
 
-    // Prepare.
-    X86Gp fn = cc.newIntPtr("fn");
-    X86Gp rv = cc.newInt32("rv");
+    cc.addFunc(FuncSignature2<void, float*, const float*>(CallConv::kIdHost));
 
-    cc.mov(fn, imm_ptr(calledFunc));
+    X86Gp dst = cc.newIntPtr("dst");
+    X86Gp src = cc.newIntPtr("src");
+    X86Ymm a = cc.newYmmPs("a");
+    X86Xmm x = cc.newXmmSs("x");
 
-    // Call function.
-    CCFuncCall* call = cc.call(fn, FuncSignature10<int, void*, void*, void*, void*, void*, void*, void*, void*, void*, void*>(CallConv::kIdHost));
-    call->setArg(0, imm(0x01));
-    call->setArg(1, imm(0x02));
-    call->setArg(2, imm(0x03));
-    call->setArg(3, imm(0x04));
-    call->setArg(4, imm(0x05));
-    call->setArg(5, imm(0x06));
-    call->setArg(6, imm(0x07));
-    call->setArg(7, imm(0x08));
-    call->setArg(8, imm(0x09));
-    call->setArg(9, imm(0x0A));
-    call->setRet(0, rv);
+    cc.setArg(0, dst);
+    cc.setArg(1, src);
 
-    cc.ret(rv);
+    // SSE code while `a` is live can't be resolved.
+    cc.vmovups(a, x86::ptr(src));
+    cc.movss(x, x86::ptr(src));
+    cc.addss(x, x);
+    cc.movss(x86::ptr(dst, 32), x);
+    cc.vaddps(a, a, a);
+    cc.vmovups(x86::ptr(dst), a);
+
+    // `a` is dead here, `vzeroupper` is inserted before `movss`.
+    cc.movss(x, x86::ptr(src, 4));
+    cc.addss(x, x);
+    cc.movss(x86::ptr(dst, 36), x);
+
+    // Upper halves are dirty at return, `vzeroupper` is inserted before `ret`.
+    cc.vmovups(a, x86::ptr(src));
+    cc.vmulps(a, a, a);
+    cc.vmovups(x86::ptr(dst, 64), a);
     cc.endFunc();
   }
 
   virtual bool run(void* _func, StringBuilder& result, StringBuilder& expect) {
-    typedef int (*Func)(void);
+    typedef void (*Func)(float*, const float*);
     Func func = ptr_as_func<Func>(_func);
 
-    int resultRet = func();
-    int expectRet = 55;
+    uint32_t inserted = _pass ? _pass->getInsertedCount() : 0;
+    uint32_t unresolved = _pass ? _pass->getUnresolvedCount() : 0;
 
-    result.setFormat("ret=%d", resultRet);
-    expect.setFormat("ret=%d", expectRet);
+    bool valid = true;
+    if (CpuInfo::getHost().hasFeature(CpuInfo::kX86FeatureAVX)) {
+      static const float src[8] = { 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f, 8.0f };
+      float dst[24] = { 0.0f };
 
-    return resultRet == expectRet;
+      func(dst, src);
+      for (uint32_t i = 0; i < 8; i++) {
+        valid &= dst[i] == src[i] * 2.0f;
+        valid &= dst[16 + i] == src[i] * src[i];
+      }
+      valid &= dst[8] == 2.0f && dst[9] == 4.0f;
+    }
+
+    result.setFormat("valid=%d inserted=%u unresolved=%u", int(valid), inserted, unresolved);
+    expect.setFormat("valid=%d inserted=%u unresolved=%u", 1, 2, 1);
+
+    return result.eq(expect);
   }
+
+  X86VZeroUpperPass* _pass;
 };
 
 // ============================================================================
-// [X86Test_CallFloatAsXmmRet]
+// [X86Test_MiscLoopAlign]
 // ============================================================================
 
-class X86Test_CallFloatAsXmmRet : public X86Test {
+class X86Test_MiscLoopAlign : public X86Test {
 public:
-  X86Test_CallFloatAsXmmRet() : X86Test("[Call] Float As Xmm Ret") {}
+  X86Test_MiscLoopAlign() : X86Test("[Misc] LoopAlign"), _pass(nullptr) {}
 
   static void add(X86TestManager& mgr) {
-    mgr.add(new X86Test_CallFloatAsXmmRet());
-  }
-
-  static float calledFunc(float a, float b) {
-    return a * b;
+    mgr.add(new X86Test_MiscLoopAlign());
   }
 
   virtual void compile(X86Compiler& cc) {
-    cc.addFunc(FuncSignature2<float, float, float>(CallConv::kIdHost));
+    cc.addPassT<X86LoopAlignPass>(X86LoopAlignPass::kOptionAlignLoops);
+    _pass = static_cast<X86LoopAlignPass*>(cc.getPassByName("LoopAlign"));
+    _pass->setBudget(64);
 
-    X86Xmm a = cc.newXmmSs("a");
-    X86Xmm b = cc.newXmmSs("b");
-    X86Xmm ret = cc.newXmmSs("ret");
+    cc.addFunc(FuncSignature1<int, int>(CallConv::kIdHost));
 
-    cc.setArg(0, a);
-    cc.setArg(1, b);
+    X86Gp i = cc.newInt32("i");
+    X86Gp r = cc.newInt32("r");
 
-    // Prepare.
-    X86Gp fn = cc.newIntPtr("fn");
-    cc.mov(fn, imm_ptr(calledFunc));
+    Label L_Loop = cc.newLabel();
+    Label L_End = cc.newLabel();
 
-    // Call function.
-    CCFuncCall* call = cc.call(fn, FuncSignature2<float, float, float>(CallConv::kIdHost));
+    cc.setArg(0, i);
+    cc.xor_(r, r);
+    cc.test(i, i);
+    cc.jz(L_End);
 
-    call->setArg(0, a);
-    call->setArg(1, b);
-    call->setRet(0, ret);
+    // Place the loop header 4 bytes before a 32-byte boundary.
+    cc.align(kAlignCode, 32);
+    for (uint32_t j = 0; j < 28; j++)
+      cc.nop();
 
-    cc.ret(ret);
+    cc.bind(L_Loop);
+    cc.add(r, i);
+    cc.dec(i);
+    cc.jnz(L_Loop);
+
+    cc.bind(L_End);
+    cc.ret(r);
     cc.endFunc();
   }
 
   virtual bool run(void* _func, StringBuilder& result, StringBuilder& expect) {
-    typedef float (*Func)(float, float);
+    typedef int (*Func)(int);
     Func func = ptr_as_func<Func>(_func);
 
-    float resultRet = func(15.5f, 2.0f);
-    float expectRet = calledFunc(15.5f, 2.0f);
+    int resultRet = func(10) + func(0);
+    int expectRet = 55;
+    uint32_t aligned = _pass ? _pass->getAlignedLoopCount() : 0;
 
-    result.setFormat("ret=%g", resultRet);
-    expect.setFormat("ret=%g", expectRet);
+    result.setFormat("ret=%d aligned=%u", resultRet, aligned);
+    expect.setFormat("ret=%d aligned=%u", expectRet, 1U);
 
-    return resultRet == expectRet;
+    return result.eq(expect);
   }
+
+  X86LoopAlignPass* _pass;
 };
 
 // ============================================================================
-// [X86Test_CallDoubleAsXmmRet]
+// [X86Test_MiscFlowGraph]
 // ============================================================================
 
-class X86Test_CallDoubleAsXmmRet : public X86Test {
+class X86Test_MiscFlowGraph : public X86Test {
 public:
-  X86Test_CallDoubleAsXmmRet() : X86Test("[Call] Double As Xmm Ret") {}
+  X86Test_MiscFlowGraph() : X86Test("[Misc] FlowGraph"), _pass(nullptr) {}
+
+  // Builds the flow graph of the first function after it was compiled.
+  class FlowGraphPass : public CBPass {
+  public:
+    FlowGraphPass() noexcept
+      : CBPass("FlowGraph"),
+        loopCount(0),
+        maxDepth(0),
+        entryDominates(false) {}
+
+    virtual Error process(Zone* zone) noexcept {
+      CBNode* node = _cb->getFirstNode();
+      while (node && node->getType() != CBNode::kNodeFunc)
+        node = node->getNext();
+
+      if (!node)
+        return kErrorOk;
+
+      CCFunc* func = static_cast<CCFunc*>(node);
+      CBFlowGraph cfg;
+      ASMJIT_PROPAGATE(cfg.build(_cb, zone, func, func->getEnd()->getNext()));
+
+      CBBlock* entry = cfg.getEntryBlock();
+      loopCount = cfg.getLoopCount();
+      entryDominates = true;
+
+      for (uint32_t i = 0; i < cfg.getRPOCount(); i++) {
+        CBBlock* block = cfg.getRPOBlock(i);
+        maxDepth = std::max<uint32_t>(maxDepth, block->getLoopDepth());
+        entryDominates &= cfg.dominates(entry, block);
+      }
 
-  static void add(X86TestManager& mgr) {
-    mgr.add(new X86Test_CallDoubleAsXmmRet());
-  }
+      return kErrorOk;
+    }
 
-  static double calledFunc(double a, double b) {
-    return a * b;
+    uint32_t loopCount;
+    uint32_t maxDepth;
+    bool entryDominates;
+  };
+
+  static void add(X86TestManager& mgr) {
+    mgr.add(new X86Test_MiscFlowGraph());
   }
 
   virtual void compile(X86Compiler& cc) {
-    cc.addFunc(FuncSignature2<double, double, double>(CallConv::kIdHost));
+    cc.addPassT<FlowGraphPass>();
+    _pass = static_cast<FlowGraphPass*>(cc.getPassByName("FlowGraph"));
 
-    X86Xmm a = cc.newXmmSd("a");
-    X86Xmm b = cc.newXmmSd("b");
-    X86Xmm ret = cc.newXmmSd("ret");
+    cc.addFunc(FuncSignature1<int, int>(CallConv::kIdHost));
 
-    cc.setArg(0, a);
-    cc.setArg(1, b);
+    X86Gp n = cc.newInt32("n");
+    X86Gp i = cc.newInt32("i");
+    X86Gp j = cc.newInt32("j");
+    X86Gp r = cc.newInt32("r");
 
-    X86Gp fn = cc.newIntPtr("fn");
-    cc.mov(fn, imm_ptr(calledFunc));
+    Label L_Outer = cc.newLabel();
+    Label L_Inner = cc.newLabel();
+    Label L_End = cc.newLabel();
 
-    CCFuncCall* call = cc.call(fn, FuncSignature2<double, double, double>(CallConv::kIdHost));
+    cc.setArg(0, n);
+    cc.xor_(r, r);
+    cc.mov(i, n);
+    cc.test(i, i);
+    cc.jz(L_End);
 
-    call->setArg(0, a);
-    call->setArg(1, b);
-    call->setRet(0, ret);
+    cc.bind(L_Outer);
+    cc.mov(j, i);
 
-    cc.ret(ret);
+    cc.bind(L_Inner);
+    cc.add(r, j);
+    cc.dec(j);
+    cc.jnz(L_Inner);
+
+    cc.dec(i);
+    cc.jnz(L_Outer);
+
+    cc.bind(L_End);
+    cc.ret(r);
     cc.endFunc();
   }
 
   virtual bool run(void* _func, StringBuilder& result, StringBuilder& expect) {
-    typedef double (*Func)(double, double);
+    typedef int (*Func)(int);
     Func func = ptr_as_func<Func>(_func);
 
-    double resultRet = func(15.5, 2.0);
-    double expectRet = calledFunc(15.5, 2.0);
+    // Sum of `1 + 2 + ... + i` for `i` in `[1, 4]`.
+    int resultRet = func(4) + func(0);
+    int expectRet = 20;
 
-    result.setFormat("ret=%g", resultRet);
-    expect.setFormat("ret=%g", expectRet);
+    result.setFormat("ret=%d loops=%u depth=%u dom=%d", resultRet, _pass->loopCount, _pass->maxDepth, int(_pass->entryDominates));
+    expect.setFormat("ret=%d loops=%u depth=%u dom=%d", expectRet, 2U, 2U, 1);
 
-    return resultRet == expectRet;
+    return result.eq(expect);
   }
+
+  FlowGraphPass* _pass;
 };
 
 // ============================================================================
-// [X86Test_CallConditional]
+// [X86Test_MiscDeadCode]
 // ============================================================================
 
-class X86Test_CallConditional : public X86Test {
+class X86Test_MiscDeadCode : public X86Test {
 public:
-  X86Test_CallConditional() : X86Test("[Call] Conditional") {}
+  X86Test_MiscDeadCode() : X86Test("[Misc] DeadCode"), _pass(nullptr) {}
 
   static void add(X86TestManager& mgr) {
-    mgr.add(new X86Test_CallConditional());
+    mgr.add(new X86Test_MiscDeadCode());
   }
 
   virtual void compile(X86Compiler& cc) {
-    X86Gp x = cc.newInt32("x");
-    X86Gp y = cc.newInt32("y");
-    X86Gp op = cc.newInt32("op");
-
-    CCFuncCall* call;
-    X86Gp result;
-
-    cc.addFunc(FuncSignature3<int, int, int, int>(CallConv::kIdHost));
-    cc.setArg(0, x);
-    cc.setArg(1, y);
-    cc.setArg(2, op);
-
-    Label opAdd = cc.newLabel();
-    Label opMul = cc.newLabel();
-
-    cc.cmp(op, 0);
-    cc.jz(opAdd);
-    cc.cmp(op, 1);
-    cc.jz(opMul);
+    _pass = cc.getPassByName("RA");
+    cc.addFunc(FuncSignature2<int, int, int>(CallConv::kIdHost));
 
-    result = cc.newInt32("result_0");
-    cc.mov(result, 0);
-    cc.ret(result);
+    X86Gp a = cc.newInt32("a");
+    X86Gp b = cc.newInt32("b");
+    X86Gp t = cc.newInt32("t");
+    X86Gp u = cc.newInt32("u");
+    X86Gp r = cc.newInt32("r");
 
-    cc.bind(opAdd);
-    result = cc.newInt32("result_1");
+    cc.setArg(0, a);
+    cc.setArg(1, b);
 
-    call = cc.call((uint64_t)calledFuncAdd, FuncSignature2<int, int, int>(CallConv::kIdHost));
-    call->setArg(0, x);
-    call->setArg(1, y);
-    call->setRet(0, result);
-    cc.ret(result);
+    // Dead chain, `u` is never read.
+    cc.lea(t, x86::ptr(a, a, 1));
+    cc.add(t, b);
+    cc.mov(u, t);
 
-    cc.bind(opMul);
-    result = cc.newInt32("result_2");
+    // Dead flags, overwritten by `add` before `jnz` reads them.
+    cc.cmp(a, b);
 
-    call = cc.call((uint64_t)calledFuncMul, FuncSignature2<int, int, int>(CallConv::kIdHost));
-    call->setArg(0, x);
-    call->setArg(1, y);
-    call->setRet(0, result);
+    Label L = cc.newLabel();
+    cc.mov(r, a);
+    cc.add(r, b);
+    cc.jnz(L);
+    cc.mov(r, -1);
+    cc.bind(L);
 
-    cc.ret(result);
+    cc.ret(r);
     cc.endFunc();
   }
 
   virtual bool run(void* _func, StringBuilder& result, StringBuilder& expect) {
-    typedef int (*Func)(int, int, int);
+    typedef int (*Func)(int, int);
     Func func = ptr_as_func<Func>(_func);
 
-    int arg1 = 4;
-    int arg2 = 8;
-
-    int resultAdd = func(arg1, arg2, 0);
-    int expectAdd = calledFuncAdd(arg1, arg2);
-
-    int resultMul = func(arg1, arg2, 1);
-    int expectMul = calledFuncMul(arg1, arg2);
+    int resultRet = func(3, 4) + func(5, -5);
+    int expectRet = 6;
+    uint32_t dead = _pass ? static_cast<uint32_t>(_pass->getStats().deadCount) : 0;
 
-    result.setFormat("ret={add=%d, mul=%d}", resultAdd, resultMul);
-    expect.setFormat("ret={add=%d, mul=%d}", expectAdd, expectMul);
+    result.setFormat("ret=%d dead=%u", resultRet, dead);
+    expect.setFormat("ret=%d dead=%u", expectRet, 4U);
 
-    return (resultAdd == expectAdd) && (resultMul == expectMul);
+    return result.eq(expect);
   }
 
-  static int calledFuncAdd(int x, int y) { return x + y; }
-  static int calledFuncMul(int x, int y) { return x * y; }
+  CBPass* _pass;
 };
 
 // ============================================================================
-// [X86Test_CallMultiple]
+// [X86Test_MiscSchedule]
 // ============================================================================
 
-class X86Test_CallMultiple : public X86Test {
+class X86Test_MiscSchedule : public X86Test {
 public:
-  X86Test_CallMultiple() : X86Test("[Call] Multiple") {}
+  X86Test_MiscSchedule() : X86Test("[Misc] Schedule"), _pass(nullptr) {}
 
   static void add(X86TestManager& mgr) {
-    mgr.add(new X86Test_CallMultiple());
-  }
-
-  static int ASMJIT_FASTCALL calledFunc(int* pInt, int index) {
-    return pInt[index];
+    mgr.add(new X86Test_MiscSchedule());
   }
 
   virtual void compile(X86Compiler& cc) {
-    unsigned int i;
-
-    X86Gp buf = cc.newIntPtr("buf");
-    X86Gp acc0 = cc.newInt32("acc0");
-    X86Gp acc1 = cc.newInt32("acc1");
-
-    cc.addFunc(FuncSignature1<int, int*>(CallConv::kIdHost));
-    cc.setArg(0, buf);
-
-    cc.mov(acc0, 0);
-    cc.mov(acc1, 0);
+    cc.insertPassT<X86SchedulerPass>(cc.getPassByName("RA"));
+    _pass = static_cast<X86SchedulerPass*>(cc.getPassByName("Scheduler"));
 
-    for (i = 0; i < 4; i++) {
-      X86Gp ret = cc.newInt32("ret");
-      X86Gp ptr = cc.newIntPtr("ptr");
-      X86Gp idx = cc.newInt32("idx");
-      CCFuncCall* call;
-
-      cc.mov(ptr, buf);
-      cc.mov(idx, static_cast<int>(i));
+    cc.addFunc(FuncSignature2<void, float*, const float*>(CallConv::kIdHost));
 
-      call = cc.call((uint64_t)calledFunc, FuncSignature2<int, int*, int>(CallConv::kIdHostFastCall));
-      call->setArg(0, ptr);
-      call->setArg(1, idx);
-      call->setRet(0, ret);
+    X86Gp dst = cc.newIntPtr("dst");
+    X86Gp src = cc.newIntPtr("src");
 
-      cc.add(acc0, ret);
+    cc.setArg(0, dst);
+    cc.setArg(1, src);
 
-      cc.mov(ptr, buf);
-      cc.mov(idx, static_cast<int>(i));
+    X86Xmm a[2];
+    X86Xmm v[2];
+    uint32_t i;
 
-      call = cc.call((uint64_t)calledFunc, FuncSignature2<int, int*, int>(CallConv::kIdHostFastCall));
-      call->setArg(0, ptr);
-      call->setArg(1, idx);
-      call->setRet(0, ret);
+    for (i = 0; i < 2; i++) {
+      a[i] = cc.newXmmPs("a%u", i);
+      v[i] = cc.newXmmPs("v%u", i);
+      cc.movups(a[i], x86::ptr(src, i * 16));
+    }
 
-      cc.sub(acc1, ret);
+    // Two independent chains written one after the other, each computes
+    // `((x * x) + x) * x` of 4 floats.
+    for (i = 0; i < 2; i++) {
+      cc.movaps(v[i], a[i]);
+      cc.mulps(v[i], a[i]);
+      cc.addps(v[i], a[i]);
+      cc.mulps(v[i], a[i]);
     }
 
-    cc.add(acc0, acc1);
-    cc.ret(acc0);
+    for (i = 0; i < 2; i++)
+      cc.movups(x86::ptr(dst, i * 16), v[i]);
+
     cc.endFunc();
   }
 
   virtual bool run(void* _func, StringBuilder& result, StringBuilder& expect) {
-    typedef int (*Func)(int*);
+    typedef void (*Func)(float*, const float*);
     Func func = ptr_as_func<Func>(_func);
 
-    int buffer[4] = { 127, 87, 23, 17 };
+    float src[8] = { 1.0f, 1.5f, 2.0f, 2.5f, 3.0f, 3.5f, 4.0f, 4.5f };
+    float dst[8];
+    func(dst, src);
 
-    int resultRet = func(buffer);
-    int expectRet = 0;
+    bool ok = true;
+    for (uint32_t i = 0; i < 8; i++)
+      ok &= dst[i] == (src[i] * src[i] + src[i]) * src[i];
+    uint32_t moved = _pass ? _pass->getMovedCount() : 0;
 
-    result.setFormat("ret=%d", resultRet);
-    expect.setFormat("ret=%d", expectRet);
+    result.setFormat("ok=%d moved=%d", int(ok), int(moved != 0));
+    expect.setFormat("ok=%d moved=%d", 1, 1);
 
-    return resultRet == expectRet;
+    return result.eq(expect);
   }
+
+  X86SchedulerPass* _pass;
 };
 
 // ============================================================================
-// [X86Test_CallRecursive]
+// [X86Test_MiscInline]
 // ============================================================================
 
-class X86Test_CallRecursive : public X86Test {
+class X86Test_MiscInline : public X86Test {
 public:
-  X86Test_CallRecursive() : X86Test("[Call] Recursive") {}
+  X86Test_MiscInline() : X86Test("[Misc] Inline") {}
 
   static void add(X86TestManager& mgr) {
-    mgr.add(new X86Test_CallRecursive());
+    mgr.add(new X86Test_MiscInline());
   }
 
   virtual void compile(X86Compiler& cc) {
-    X86Gp val = cc.newInt32("val");
-    Label skip = cc.newLabel();
+    // Helper - clamp(x, lo) = max(x, lo) * 2.
+    CCFunc* helper = cc.addFunc(FuncSignature2<int, int, int>(CallConv::kIdHost));
+    {
+      X86Gp x = cc.newInt32("x");
+      X86Gp lo = cc.newInt32("lo");
+      Label L_Done = cc.newLabel();
 
-    CCFunc* func = cc.addFunc(FuncSignature1<int, int>(CallConv::kIdHost));
-    cc.setArg(0, val);
+      cc.setArg(0, x);
+      cc.setArg(1, lo);
 
-    cc.cmp(val, 1);
-    cc.jle(skip);
+      cc.cmp(x, lo);
+      cc.jge(L_Done);
+      cc.mov(x, lo);
 
-    X86Gp tmp = cc.newInt32("tmp");
-    cc.mov(tmp, val);
-    cc.dec(tmp);
+      cc.bind(L_Done);
+      cc.add(x, x);
+      cc.ret(x);
+      cc.endFunc();
+    }
 
-    CCFuncCall* call = cc.call(func->getLabel(), FuncSignature1<int, int>(CallConv::kIdHost));
-    call->setArg(0, tmp);
-    call->setRet(0, tmp);
-    cc.mul(cc.newInt32(), val, tmp);
+    cc.addFunc(FuncSignature2<int, int, int>(CallConv::kIdHost));
+    {
+      X86Gp a = cc.newInt32("a");
+      X86Gp b = cc.newInt32("b");
+      X86Gp r0 = cc.newInt32("r0");
+      X86Gp r1 = cc.newInt32("r1");
 
-    cc.bind(skip);
-    cc.ret(val);
-    cc.endFunc();
+      cc.setArg(0, a);
+      cc.setArg(1, b);
+
+      // The helper is inlined twice, its labels and registers are copied.
+      Operand args0[] = { a, Imm(10) };
+      Operand args1[] = { b, a };
+      cc.inlineFunc(helper, args0, 2, &r0, 1);
+      cc.inlineFunc(helper, args1, 2, &r1, 1);
+
+      cc.add(r0, r1);
+      cc.ret(r0);
+      cc.endFunc();
+    }
+
+    // The helper is not called directly.
+    cc.removeNodes(helper, helper->getEnd());
   }
 
   virtual bool run(void* _func, StringBuilder& result, StringBuilder& expect) {
-    typedef int (*Func)(int);
+    typedef int (*Func)(int, int);
     Func func = ptr_as_func<Func>(_func);
 
-    int resultRet = func(5);
-    int expectRet = 1 * 2 * 3 * 4 * 5;
+    int resultRet = func(3, 7) + func(12, 5);
+    int expectRet = (20 + 14) + (24 + 24);
 
     result.setFormat("ret=%d", resultRet);
     expect.setFormat("ret=%d", expectRet);
@@ -2869,629 +5341,902 @@ public:
 };
 
 // ============================================================================
-// [X86Test_CallMisc1]
+// [X86Test_MiscFastEval]
 // ============================================================================
 
-class X86Test_CallMisc1 : public X86Test {
+class X86Test_MiscFastEval : public X86Test {
 public:
-  X86Test_CallMisc1() : X86Test("[Call] Misc #1") {}
+  X86Test_MiscFastEval() : X86Test("[Misc] FastEval (CConv)") {}
 
   static void add(X86TestManager& mgr) {
-    mgr.add(new X86Test_CallMisc1());
+    mgr.add(new X86Test_MiscFastEval());
   }
 
-  static void dummy(int a, int b) {}
-
   virtual void compile(X86Compiler& cc) {
-    X86Gp val = cc.newInt32("val");
-    Label skip = cc.newLabel();
+    FuncSignature5<void, const void*, const void*, const void*, const void*, void*> funcSig(CallConv::kIdHostCDecl);
+    FuncSignature2<X86Xmm, X86Xmm, X86Xmm> fastSig(CallConv::kIdHostFastEval2);
 
-    CCFunc* func = cc.addFunc(FuncSignature2<int, int, int>(CallConv::kIdHost));
+    CCFunc* func = cc.newFunc(funcSig);
+    CCFunc* fast = cc.newFunc(fastSig);
 
-    X86Gp a = cc.newInt32("a");
-    X86Gp b = cc.newInt32("b");
-    X86Gp r = cc.newInt32("r");
+    {
+      X86Gp aPtr = cc.newIntPtr("aPtr");
+      X86Gp bPtr = cc.newIntPtr("bPtr");
+      X86Gp cPtr = cc.newIntPtr("cPtr");
+      X86Gp dPtr = cc.newIntPtr("dPtr");
+      X86Gp pOut = cc.newIntPtr("pOut");
 
-    cc.setArg(0, a);
-    cc.setArg(1, b);
+      X86Xmm aXmm = cc.newXmm("aXmm");
+      X86Xmm bXmm = cc.newXmm("bXmm");
+      X86Xmm cXmm = cc.newXmm("cXmm");
+      X86Xmm dXmm = cc.newXmm("dXmm");
 
-    cc.alloc(a, x86::eax);
-    cc.alloc(b, x86::ebx);
+      cc.addFunc(func);
 
-    CCFuncCall* call = cc.call(imm_ptr(dummy), FuncSignature2<void, int, int>(CallConv::kIdHost));
-    call->setArg(0, a);
-    call->setArg(1, b);
+      cc.setArg(0, aPtr);
+      cc.setArg(1, bPtr);
+      cc.setArg(2, cPtr);
+      cc.setArg(3, dPtr);
+      cc.setArg(4, pOut);
 
-    cc.lea(r, x86::ptr(a, b));
-    cc.ret(r);
+      cc.movups(aXmm, x86::ptr(aPtr));
+      cc.movups(bXmm, x86::ptr(bPtr));
+      cc.movups(cXmm, x86::ptr(cPtr));
+      cc.movups(dXmm, x86::ptr(dPtr));
 
-    cc.endFunc();
+      X86Xmm xXmm = cc.newXmm("xXmm");
+      X86Xmm yXmm = cc.newXmm("yXmm");
+
+      CCFuncCall* call1 = cc.call(fast->getLabel(), fastSig);
+      call1->setArg(0, aXmm);
+      call1->setArg(1, bXmm);
+      call1->setRet(0, xXmm);
+
+      CCFuncCall* call2 = cc.call(fast->getLabel(), fastSig);
+      call2->setArg(0, cXmm);
+      call2->setArg(1, dXmm);
+      call2->setRet(0, yXmm);
+
+      cc.pmullw(xXmm, yXmm);
+      cc.movups(x86::ptr(pOut), xXmm);
+
+      cc.endFunc();
+    }
+
+    {
+      X86Xmm aXmm = cc.newXmm("aXmm");
+      X86Xmm bXmm = cc.newXmm("bXmm");
+
+      cc.addFunc(fast);
+      cc.setArg(0, aXmm);
+      cc.setArg(1, bXmm);
+      cc.paddw(aXmm, bXmm);
+      cc.ret(aXmm);
+      cc.endFunc();
+    }
   }
 
   virtual bool run(void* _func, StringBuilder& result, StringBuilder& expect) {
-    typedef int (*Func)(int, int);
+    typedef void (*Func)(const void*, const void*, const void*, const void*, void*);
+
     Func func = ptr_as_func<Func>(_func);
 
-    int resultRet = func(44, 199);
-    int expectRet = 243;
+    int16_t a[8] = { 0, 1, 2, 3, 4, 5, 6, 7 };
+    int16_t b[8] = { 7, 6, 5, 4, 3, 2, 1, 0 };
+    int16_t c[8] = { 1, 3, 9, 7, 5, 4, 2, 1 };
+    int16_t d[8] = { 2, 0,-6,-4,-2,-1, 1, 2 };
+
+    int16_t o[8];
+    int oExp = 7 * 3;
 
-    result.setFormat("ret=%d", resultRet);
-    expect.setFormat("ret=%d", expectRet);
+    func(a, b, c, d, o);
 
-    return resultRet == expectRet;
+    result.setFormat("ret={%02X %02X %02X %02X %02X %02X %02X %02X}", o[0], o[1], o[2], o[3], o[4], o[5], o[6], o[7]);
+    expect.setFormat("ret={%02X %02X %02X %02X %02X %02X %02X %02X}", oExp, oExp, oExp, oExp, oExp, oExp, oExp, oExp);
+
+    return result == expect;
   }
 };
 
 // ============================================================================
-// [X86Test_CallMisc2]
+// [X86Test_MiscUnfollow]
 // ============================================================================
 
-class X86Test_CallMisc2 : public X86Test {
+// Global (I didn't find a better way to test this).
+static jmp_buf globalJmpBuf;
+
+class X86Test_MiscUnfollow : public X86Test {
 public:
-  X86Test_CallMisc2() : X86Test("[Call] Misc #2") {}
+  X86Test_MiscUnfollow() : X86Test("[Misc] Unfollow") {}
 
   static void add(X86TestManager& mgr) {
-    mgr.add(new X86Test_CallMisc2());
+    mgr.add(new X86Test_MiscUnfollow());
   }
 
   virtual void compile(X86Compiler& cc) {
-    CCFunc* func = cc.addFunc(FuncSignature1<double, const double*>(CallConv::kIdHost));
+    // NOTE: Fastcall calling convention is the most appropriate here, as all
+    // arguments will be passed by registers and there won't be any stack
+    // misalignment when we call the `handler()`. This was failing on OSX
+    // when targeting 32-bit.
+    cc.addFunc(FuncSignature2<void, int, void*>(CallConv::kIdHostFastCall));
 
-    X86Gp p = cc.newIntPtr("p");
-    X86Gp fn = cc.newIntPtr("fn");
+    X86Gp a = cc.newInt32("a");
+    X86Gp b = cc.newIntPtr("b");
 
-    X86Xmm arg = cc.newXmmSd("arg");
-    X86Xmm ret = cc.newXmmSd("ret");
+    Label tramp = cc.newLabel();
 
-    cc.setArg(0, p);
-    cc.movsd(arg, x86::ptr(p));
-    cc.mov(fn, imm_ptr(op));
+    cc.setArg(0, a);
+    cc.setArg(1, b);
 
-    CCFuncCall* call = cc.call(fn, FuncSignature1<double, double>(CallConv::kIdHost));
-    call->setArg(0, arg);
-    call->setRet(0, ret);
+    cc.cmp(a, 0);
+    cc.jz(tramp);
+
+    cc.ret(a);
+
+    cc.bind(tramp);
+    cc.unfollow().jmp(b);
 
-    cc.ret(ret);
     cc.endFunc();
   }
 
   virtual bool run(void* _func, StringBuilder& result, StringBuilder& expect) {
-    typedef double (*Func)(const double*);
+    typedef int (ASMJIT_FASTCALL *Func)(int, void*);
+
     Func func = ptr_as_func<Func>(_func);
 
-    double arg = 2;
+    int resultRet = 0;
+    int expectRet = 1;
 
-    double resultRet = func(&arg);
-    double expectRet = op(arg);
+    if (!setjmp(globalJmpBuf))
+      resultRet = func(0, (void*)handler);
+    else
+      resultRet = 1;
 
-    result.setFormat("ret=%g", resultRet);
-    expect.setFormat("ret=%g", expectRet);
+    result.setFormat("ret={%d}", resultRet);
+    expect.setFormat("ret={%d}", expectRet);
 
     return resultRet == expectRet;
   }
 
-  static double op(double a) { return a * a; }
+  static void ASMJIT_FASTCALL handler() { longjmp(globalJmpBuf, 1); }
 };
 
 // ============================================================================
-// [X86Test_CallMisc3]
+// [X86Test_MiscBlockLayout]
 // ============================================================================
 
-class X86Test_CallMisc3 : public X86Test {
+class X86Test_MiscBlockLayout : public X86Test {
 public:
-  X86Test_CallMisc3() : X86Test("[Call] Misc #3") {}
+  X86Test_MiscBlockLayout() : X86Test("[Misc] BlockLayout") {}
+
+  enum { kCapacity = 64 };
 
   static void add(X86TestManager& mgr) {
-    mgr.add(new X86Test_CallMisc3());
+    mgr.add(new X86Test_MiscBlockLayout());
   }
 
-  virtual void compile(X86Compiler& cc) {
-    CCFunc* func = cc.addFunc(FuncSignature1<double, const double*>(CallConv::kIdHost));
+  static void generate(X86Compiler& cc) {
+    cc.addFunc(FuncSignature1<int, int>(CallConv::kIdHost));
 
-    X86Gp p = cc.newIntPtr("p");
-    X86Gp fn = cc.newIntPtr("fn");
+    X86Gp a = cc.newInt32("a");
+    X86Gp r = cc.newInt32("r");
 
-    X86Xmm arg = cc.newXmmSd("arg");
-    X86Xmm ret = cc.newXmmSd("ret");
+    Label L_Ok = cc.newLabel();
+    Label L_Even = cc.newLabel();
+    Label L_End = cc.newLabel();
 
-    cc.setArg(0, p);
-    cc.movsd(arg, x86::ptr(p));
-    cc.mov(fn, imm_ptr(op));
+    cc.setArg(0, a);
+    cc.cmp(a, 1000);
+    cc.jle(L_Ok);
 
-    CCFuncCall* call = cc.call(fn, FuncSignature1<double, double>(CallConv::kIdHost));
-    call->setArg(0, arg);
-    call->setRet(0, ret);
+    // Error path, never executed by the profile.
+    cc.mov(r, -1);
+    cc.jmp(L_End);
 
-    cc.xorps(arg, arg);
-    cc.subsd(arg, ret);
+    cc.bind(L_Ok);
+    cc.mov(r, a);
+    cc.test(a, 1);
+    cc.jz(L_Even);
 
-    cc.ret(arg);
+    cc.imul(r, r, 3);
+    cc.jmp(L_End);
+
+    cc.bind(L_Even);
+    cc.shr(r, 1);
+
+    cc.bind(L_End);
+    cc.ret(r);
     cc.endFunc();
   }
 
-  virtual bool run(void* _func, StringBuilder& result, StringBuilder& expect) {
-    typedef double (*Func)(const double*);
-    Func func = ptr_as_func<Func>(_func);
+  virtual void compile(X86Compiler& cc) {
+    generate(cc);
+  }
 
-    double arg = 2;
+  // Compiles the function with counters inserted, or laid out by them.
+  static void* build(JitRuntime& rt, uint64_t* counters, bool layout, uint32_t stats[2]) {
+    CodeHolder code;
+    code.init(rt.getCodeInfo());
 
-    double resultRet = func(&arg);
-    double expectRet = -op(arg);
+    X86Compiler cc(&code);
+    if (layout)
+      cc.addPassT<X86BlockLayoutPass>(static_cast<const uint64_t*>(counters), static_cast<size_t>(kCapacity));
+    else
+      cc.addPassT<X86EdgeCounterPass>(counters, static_cast<size_t>(kCapacity));
 
-    result.setFormat("ret=%g", resultRet);
-    expect.setFormat("ret=%g", expectRet);
+    generate(cc);
+    if (cc.finalize() != kErrorOk)
+      return nullptr;
 
-    return resultRet == expectRet;
+    if (layout) {
+      X86BlockLayoutPass* pass = static_cast<X86BlockLayoutPass*>(cc.getPassByName("BlockLayout"));
+      stats[0] = pass->getColdCount();
+      stats[1] = pass->getInvertedCount();
+    }
+    else {
+      X86EdgeCounterPass* pass = static_cast<X86EdgeCounterPass*>(cc.getPassByName("EdgeCounter"));
+      stats[0] = pass->getInsertedCount();
+      stats[1] = static_cast<uint32_t>(pass->getCounterCount());
+    }
+
+    void* func;
+    if (rt.add(&func, &code) != kErrorOk)
+      return nullptr;
+    return func;
   }
 
-  static double op(double a) { return a * a; }
-};
+  virtual bool run(void* _func, StringBuilder& result, StringBuilder& expect) {
+    typedef int (*Func)(int);
+    Func func = ptr_as_func<Func>(_func);
 
-// ============================================================================
-// [X86Test_CallMisc4]
-// ============================================================================
+    // Counters must be in reach of `[rip + rel32]`, so they are allocated by
+    // the runtime the profiled code is added to.
+    JitRuntime rt;
+    uint64_t* counters = static_cast<uint64_t*>(rt.getMemMgr()->alloc(kCapacity * sizeof(uint64_t)));
 
-class X86Test_CallMisc4 : public X86Test {
-public:
-  X86Test_CallMisc4() : X86Test("[Call] Misc #4") {}
+    uint32_t counterStats[2] = { 0, 0 };
+    uint32_t layoutStats[2] = { 0, 0 };
+    uint64_t entryCount = 0;
 
-  static void add(X86TestManager& mgr) {
-    mgr.add(new X86Test_CallMisc4());
-  }
+    Func profiled = counters ? ptr_as_func<Func>(build(rt, counters, false, counterStats)) : nullptr;
+    Func laidOut = nullptr;
 
-  virtual void compile(X86Compiler& cc) {
-    FuncSignatureX funcPrototype;
+    if (profiled) {
+      // Mostly even numbers, the error path is never taken.
+      for (int i = 0; i < 100; i++)
+        profiled(i % 10 == 0 ? i * 2 + 1 : i * 2);
 
-    funcPrototype.setCallConv(CallConv::kIdHost);
-    funcPrototype.setRet(TypeId::kF64);
-    CCFunc* func = cc.addFunc(funcPrototype);
+      entryCount = counters[0];
+      laidOut = ptr_as_func<Func>(build(rt, counters, true, layoutStats));
+    }
 
-    FuncSignatureX callPrototype;
-    callPrototype.setCallConv(CallConv::kIdHost);
-    callPrototype.setRet(TypeId::kF64);
-    CCFuncCall* call = cc.call(imm_ptr(calledFunc), callPrototype);
+    static const int inputs[] = { 0, 7, 10, 999, 1000, 1001, 5000 };
+    int resultRet = 0;
+    int expectRet = 0;
+    bool same = profiled && laidOut;
 
-    X86Xmm ret = cc.newXmmSd("ret");
-    call->setRet(0, ret);
-    cc.ret(ret);
+    for (uint32_t i = 0; i < ASMJIT_ARRAY_SIZE(inputs); i++) {
+      int x = inputs[i];
+      int ret = func(x);
 
-    cc.endFunc();
-  }
+      resultRet += ret;
+      expectRet += x > 1000 ? -1 : (x & 1) ? x * 3 : x >> 1;
 
-  virtual bool run(void* _func, StringBuilder& result, StringBuilder& expect) {
-    typedef double (*Func)(void);
-    Func func = ptr_as_func<Func>(_func);
+      if (same)
+        same = profiled(x) == ret && laidOut(x) == ret;
+    }
 
-    double resultRet = func();
-    double expectRet = 3.14;
+    if (profiled) rt.release(profiled);
+    if (laidOut) rt.release(laidOut);
+    if (counters) rt.getMemMgr()->release(counters);
 
-    result.setFormat("ret=%g", resultRet);
-    expect.setFormat("ret=%g", expectRet);
+    result.setFormat("ret=%d same=%d entry=%u counted=%d cold=%u inverted=%d",
+      resultRet, int(same), unsigned(entryCount),
+      int(counterStats[0] != 0 && counterStats[1] <= kCapacity),
+      layoutStats[0], int(layoutStats[1] != 0));
+    expect.setFormat("ret=%d same=%d entry=%u counted=%d cold=%u inverted=%d",
+      expectRet, 1, 100U, 1, 1U, 1);
 
-    return resultRet == expectRet;
+    return result.eq(expect);
   }
-
-  static double calledFunc() { return 3.14; }
 };
 
 // ============================================================================
-// [X86Test_CallMisc5]
+// [X86Test_MiscValueNumber]
 // ============================================================================
 
-// The register allocator should clobber the register used by the `call` itself.
-class X86Test_CallMisc5 : public X86Test {
+class X86Test_MiscValueNumber : public X86Test {
 public:
-  X86Test_CallMisc5() : X86Test("[Call] Misc #5") {}
+  X86Test_MiscValueNumber() : X86Test("[Misc] ValueNumber"), _pass(nullptr) {}
 
   static void add(X86TestManager& mgr) {
-    mgr.add(new X86Test_CallMisc5());
+    mgr.add(new X86Test_MiscValueNumber());
   }
 
   virtual void compile(X86Compiler& cc) {
-    CCFunc* func = cc.addFunc(FuncSignature0<int>(CallConv::kIdHost));
+    cc.insertPassT<X86ValueNumberPass>(cc.getPassByName("RA"));
+    _pass = static_cast<X86ValueNumberPass*>(cc.getPassByName("ValueNumber"));
 
-    X86Gp pFn = cc.newIntPtr("pFn");
-    X86Gp vars[16];
+    cc.addFunc(FuncSignature2<int, const int*, intptr_t>(CallConv::kIdHost));
 
-    uint32_t i, regCount = cc.getGpCount();
-    ASMJIT_ASSERT(regCount <= ASMJIT_ARRAY_SIZE(vars));
+    X86Gp p = cc.newIntPtr("p");
+    X86Gp i = cc.newIntPtr("i");
 
-    cc.mov(pFn, imm_ptr(calledFunc));
-    cc.spill(pFn);
+    X86Gp c = cc.newInt32("c");
+    X86Gp d = cc.newInt32("d");
+    X86Gp a0 = cc.newIntPtr("a0");
+    X86Gp a1 = cc.newIntPtr("a1");
+    X86Gp v0 = cc.newInt32("v0");
+    X86Gp v1 = cc.newInt32("v1");
 
-    for (i = 0; i < regCount; i++) {
-      if (i == X86Gp::kIdBp || i == X86Gp::kIdSp)
-        continue;
+    cc.setArg(0, p);
+    cc.setArg(1, i);
 
-      vars[i] = cc.newInt32("v%u", static_cast<unsigned int>(i));
-      cc.alloc(vars[i], i);
-      cc.mov(vars[i], 1);
-    }
+    // Constant `d = 5 * 3 + 1`.
+    cc.mov(c, 5);
+    cc.mov(d, c);
+    cc.imul(d, d, 3);
+    cc.add(d, 1);
 
-    CCFuncCall* call = cc.call(pFn, FuncSignature0<void>(CallConv::kIdHost));
+    // The same address computed twice and loaded twice.
+    cc.lea(a0, x86::ptr(p, i, 2));
+    cc.lea(a1, x86::ptr(p, i, 2));
+    cc.mov(v0, x86::dword_ptr(a0));
+    cc.mov(v1, x86::dword_ptr(a1));
 
-    for (i = 1; i < regCount; i++) {
-      if (vars[i].isValid())
-        cc.add(vars[0], vars[i]);
-    }
+    // Redundant copy.
+    cc.mov(v1, v0);
 
-    cc.ret(vars[0]);
+    cc.add(v0, v1);
+    cc.add(v0, d);
+    cc.ret(v0);
     cc.endFunc();
   }
 
   virtual bool run(void* _func, StringBuilder& result, StringBuilder& expect) {
-    typedef int (*Func)(void);
+    typedef int (*Func)(const int*, intptr_t);
     Func func = ptr_as_func<Func>(_func);
 
-    int resultRet = func();
-    int expectRet = sizeof(void*) == 4 ? 6 : 14;
+    static const int data[4] = { 10, 20, 30, 40 };
+    int resultRet = func(data, 2);
+    int expectRet = 30 + 30 + 16;
 
-    result.setFormat("ret=%d", resultRet);
-    expect.setFormat("ret=%d", expectRet);
+    uint32_t folded = _pass ? _pass->getFoldedCount() : 0;
+    uint32_t reused = _pass ? _pass->getReusedCount() : 0;
+    uint32_t forwarded = _pass ? _pass->getForwardedCount() : 0;
+    uint32_t removed = _pass ? _pass->getRemovedCount() : 0;
 
-    return resultRet == expectRet;
+    result.setFormat("ret=%d folded=%d reused=%d forwarded=%d removed=%d",
+      resultRet, int(folded != 0), int(reused != 0), int(forwarded != 0), int(removed != 0));
+    expect.setFormat("ret=%d folded=%d reused=%d forwarded=%d removed=%d",
+      expectRet, 1, 1, 1, 1);
+
+    return result.eq(expect);
   }
 
-  static void calledFunc() {}
+  X86ValueNumberPass* _pass;
 };
 
 // ============================================================================
-// [X86Test_MiscConstPool]
+// [X86Test_MiscReport]
 // ============================================================================
 
-class X86Test_MiscConstPool : public X86Test {
+class X86Test_MiscReport : public X86Test {
 public:
-  X86Test_MiscConstPool() : X86Test("[Misc] ConstPool #1") {}
+  enum { kCount = 24 };
+
+  X86Test_MiscReport() : X86Test("[Misc] Report"), _func(nullptr) {}
 
   static void add(X86TestManager& mgr) {
-    mgr.add(new X86Test_MiscConstPool());
+    mgr.add(new X86Test_MiscReport());
   }
 
   virtual void compile(X86Compiler& cc) {
-    cc.addFunc(FuncSignature0<int>(CallConv::kIdHost));
+    _func = cc.addFunc(FuncSignature1<int, int>(CallConv::kIdHost));
 
-    X86Gp v0 = cc.newInt32("v0");
-    X86Gp v1 = cc.newInt32("v1");
+    X86Gp a = cc.newInt32("a");
+    X86Gp v[kCount];
+    uint32_t i;
 
-    X86Mem c0 = cc.newInt32Const(kConstScopeLocal, 200);
-    X86Mem c1 = cc.newInt32Const(kConstScopeLocal, 33);
+    cc.setArg(0, a);
 
-    cc.mov(v0, c0);
-    cc.mov(v1, c1);
-    cc.add(v0, v1);
+    // More variables live at once than there are GP registers.
+    for (i = 0; i < kCount; i++) {
+      v[i] = cc.newInt32("v%u", i);
+      cc.lea(v[i], x86::ptr(a, static_cast<int32_t>(i)));
+    }
 
-    cc.ret(v0);
+    for (i = 0; i < kCount; i++)
+      cc.add(a, v[i]);
+
+    cc.ret(a);
     cc.endFunc();
   }
 
-  virtual bool run(void* _func, StringBuilder& result, StringBuilder& expect) {
-    typedef int (*Func)(void);
-    Func func = ptr_as_func<Func>(_func);
+  virtual bool run(void* _func_, StringBuilder& result, StringBuilder& expect) {
+    typedef int (*Func)(int);
+    Func func = ptr_as_func<Func>(_func_);
 
-    int resultRet = func();
-    int expectRet = 233;
+    int resultRet = func(1);
+    int expectRet = 1;
 
-    result.setFormat("ret=%d", resultRet);
-    expect.setFormat("ret=%d", expectRet);
+    for (uint32_t i = 0; i < kCount; i++)
+      expectRet += 1 + static_cast<int>(i);
 
-    return resultRet == expectRet;
-  }
-};
+    const CCFuncReport* report = _func->getReport();
+    uint32_t live = 0, spills = 0, loads = 0, stack = 0, moves = 0;
 
-// ============================================================================
-// [X86Test_MiscMultiRet]
-// ============================================================================
+    if (report) {
+      live = report->maxLive[X86Reg::kKindGp] >= kCount;
+      spills = report->moveCount[CCFuncReport::kMoveSpill] != 0;
+      loads = report->moveCount[CCFuncReport::kMoveLoad] != 0;
+      stack = report->stackSize >= report->varStackSize && report->varStackSize != 0;
 
-struct X86Test_MiscMultiRet : public X86Test {
-  X86Test_MiscMultiRet() : X86Test("[Misc] MultiRet") {}
+      size_t total = 0;
+      for (uint32_t i = 0; i < CCFuncReport::kMoveCount; i++)
+        total += report->moveCount[i];
+      moves = report->moves.getLength() == total;
+    }
 
-  static void add(X86TestManager& mgr) {
-    mgr.add(new X86Test_MiscMultiRet());
+    result.setFormat("ret=%d report=%d live=%u spills=%u loads=%u stack=%u moves=%u",
+      resultRet, int(report != nullptr), live, spills, loads, stack, moves);
+    expect.setFormat("ret=%d report=%d live=%u spills=%u loads=%u stack=%u moves=%u",
+      expectRet, 1, 1, 1, 1, 1, 1);
+
+    return result.eq(expect);
   }
 
-  virtual void compile(X86Compiler& cc) {
-    cc.addFunc(FuncSignature3<int, int, int, int>(CallConv::kIdHost));
+  CCFunc* _func;
+};
 
-    X86Gp op = cc.newInt32("op");
-    X86Gp a = cc.newInt32("a");
-    X86Gp b = cc.newInt32("b");
+// ============================================================================
+// [X86Test_MiscLoop]
+// ============================================================================
 
-    Label L_Zero = cc.newLabel();
-    Label L_Add = cc.newLabel();
-    Label L_Sub = cc.newLabel();
-    Label L_Mul = cc.newLabel();
-    Label L_Div = cc.newLabel();
+class X86Test_MiscLoop : public X86Test {
+public:
+  //! Sum of 32-bit integers, stage 0 loads, stage 1 (if pipelined) adds to
+  //! the accumulator of the copy.
+  class SumLoop : public X86Loop {
+  public:
+    SumLoop(X86Compiler* cc, const X86Gp& src) : X86Loop(cc), _src(src) {}
+
+    virtual Error onBody(X86Compiler& cc, const X86LoopIteration& it) {
+      X86Gp acc = getTemp(it.copy, 0, TypeId::kI32).as<X86Gp>();
+      X86Gp val = getTemp(it.copy, 1, TypeId::kI32).as<X86Gp>();
+
+      if (it.stage == 0)
+        cc.mov(val, x86::dword_ptr(_src, it.index, 2, it.offset * 4));
+      if (it.stage == getStageCount() - 1)
+        cc.add(acc, val);
+      return kErrorOk;
+    }
 
-    cc.setArg(0, op);
-    cc.setArg(1, a);
-    cc.setArg(2, b);
+    X86Gp _src;
+  };
 
-    cc.cmp(op, 0);
-    cc.jz(L_Add);
+  enum { kMaxCount = 24 };
 
-    cc.cmp(op, 1);
-    cc.jz(L_Sub);
+  X86Test_MiscLoop(uint32_t unroll, uint32_t stages, int count)
+    : X86Test(),
+      _unroll(unroll),
+      _stages(stages),
+      _count(count),
+      _loop(nullptr),
+      _func(nullptr) {
+    if (count < 0)
+      _name.setFormat("[Misc] Loop (unroll=%u stages=%u)", unroll, stages);
+    else
+      _name.setFormat("[Misc] Loop (unroll=%u stages=%u count=%d)", unroll, stages, count);
+  }
 
-    cc.cmp(op, 2);
-    cc.jz(L_Mul);
+  virtual ~X86Test_MiscLoop() {
+    delete _loop;
+  }
 
-    cc.cmp(op, 3);
-    cc.jz(L_Div);
+  static void add(X86TestManager& mgr) {
+    mgr.add(new X86Test_MiscLoop(1, 1, -1));
+    mgr.add(new X86Test_MiscLoop(4, 1, -1));
+    mgr.add(new X86Test_MiscLoop(4, 2, -1));
+    mgr.add(new X86Test_MiscLoop(2, 3, -1));
+    mgr.add(new X86Test_MiscLoop(4, 2, 0));
+    mgr.add(new X86Test_MiscLoop(4, 2, 5));
+    mgr.add(new X86Test_MiscLoop(4, 2, 19));
+  }
 
-    cc.bind(L_Zero);
-    cc.xor_(a, a);
-    cc.ret(a);
+  virtual void compile(X86Compiler& cc) {
+    _func = cc.addFunc(FuncSignature2<int, const int*, uint32_t>(CallConv::kIdHost));
 
-    cc.bind(L_Add);
-    cc.add(a, b);
-    cc.ret(a);
+    X86Gp src = cc.newIntPtr("src");
+    X86Gp count = cc.newUInt32("count");
+    X86Gp sum = cc.newInt32("sum");
 
-    cc.bind(L_Sub);
-    cc.sub(a, b);
-    cc.ret(a);
+    cc.setArg(0, src);
+    cc.setArg(1, count);
 
-    cc.bind(L_Mul);
-    cc.imul(a, b);
-    cc.ret(a);
+    // Kept until `run()`, which asks it for the unroll hint.
+    delete _loop;
+    _loop = new SumLoop(&cc, src);
 
-    cc.bind(L_Div);
-    cc.cmp(b, 0);
-    cc.jz(L_Zero);
+    SumLoop& loop = *_loop;
+    loop.setUnroll(_unroll);
+    loop.setStageCount(_stages);
 
-    X86Gp zero = cc.newInt32("zero");
-    cc.xor_(zero, zero);
-    cc.idiv(zero, a, b);
-    cc.ret(a);
+    uint32_t copies = std::max<uint32_t>(_unroll, _stages);
+    uint32_t i;
+
+    for (i = 0; i < copies; i++) {
+      X86Gp acc = loop.getTemp(i, 0, TypeId::kI32).as<X86Gp>();
+      cc.xor_(acc, acc);
+    }
 
+    if (_count < 0)
+      loop.emit(count);
+    else
+      loop.emit(static_cast<uint32_t>(_count));
+
+    cc.mov(sum, loop.getIndex().r32());
+    cc.shl(sum, 16);
+    for (i = 0; i < copies; i++)
+      cc.add(sum, loop.getTemp(i, 0, TypeId::kI32).as<X86Gp>());
+
+    cc.ret(sum);
     cc.endFunc();
   }
 
-  virtual bool run(void* _func, StringBuilder& result, StringBuilder& expect) {
-    typedef int (*Func)(int, int, int);
+  virtual bool run(void* _func_, StringBuilder& result, StringBuilder& expect) {
+    typedef int (*Func)(const int*, uint32_t);
+    Func func = ptr_as_func<Func>(_func_);
 
-    Func func = ptr_as_func<Func>(_func);
+    int data[kMaxCount];
+    for (uint32_t i = 0; i < kMaxCount; i++)
+      data[i] = static_cast<int>(i * 3 + 1);
 
-    int a = 44;
-    int b = 3;
+    uint32_t first = _count < 0 ? 0 : static_cast<uint32_t>(_count);
+    uint32_t last = _count < 0 ? kMaxCount : first;
 
-    int r0 = func(0, a, b);
-    int r1 = func(1, a, b);
-    int r2 = func(2, a, b);
-    int r3 = func(3, a, b);
-    int e0 = a + b;
-    int e1 = a - b;
-    int e2 = a * b;
-    int e3 = a / b;
+    for (uint32_t n = first; n <= last; n++) {
+      int expectSum = static_cast<int>(n << 16);
+      for (uint32_t i = 0; i < n; i++)
+        expectSum += data[i];
 
-    result.setFormat("ret={%d %d %d %d}", r0, r1, r2, r3);
-    expect.setFormat("ret={%d %d %d %d}", e0, e1, e2, e3);
+      int resultSum = func(data, n);
+      result.appendFormat("%d ", resultSum);
+      expect.appendFormat("%d ", expectSum);
+    }
+
+    // Two GP temporaries per copy (the body wasn't emitted if the count is
+    // zero) leave room for more copies on X64.
+    uint32_t temps = _loop->getTempCount(X86Reg::kKindGp);
+    uint32_t expectTemps = _count == 0 ? 1 : 2;
+    uint32_t hint = _loop->getUnrollHint(_func->getReport());
+    uint32_t hintOk = hint >= 1 && hint <= X86Loop::kMaxUnroll;
+
+    if (sizeof(void*) == 8 && _unroll == 1)
+      hintOk &= hint > 1;
+
+    result.appendFormat("temps=%u hint=%u", temps, hintOk);
+    expect.appendFormat("temps=%u hint=%u", expectTemps, 1);
 
     return result.eq(expect);
   }
+
+  uint32_t _unroll;
+  uint32_t _stages;
+  int _count;
+  SumLoop* _loop;
+  CCFunc* _func;
 };
 
 // ============================================================================
-// [X86Test_MiscMultiFunc]
+// [X86Test_MiscReplay]
 // ============================================================================
 
-class X86Test_MiscMultiFunc : public X86Test {
+class X86Test_MiscReplay : public X86Test {
 public:
-  X86Test_MiscMultiFunc() : X86Test("[Misc] MultiFunc") {}
+  X86Test_MiscReplay() : X86Test("[Misc] Replay"), _cc(nullptr), _imm(nullptr), _mem(nullptr) {}
 
   static void add(X86TestManager& mgr) {
-    mgr.add(new X86Test_MiscMultiFunc());
+    mgr.add(new X86Test_MiscReplay());
   }
 
   virtual void compile(X86Compiler& cc) {
-    CCFunc* f1 = cc.newFunc(FuncSignature2<int, int, int>(CallConv::kIdHost));
-    CCFunc* f2 = cc.newFunc(FuncSignature2<int, int, int>(CallConv::kIdHost));
+    // Value numbering must not merge the patchable constant with the other.
+    cc.insertPassT<X86ValueNumberPass>(cc.getPassByName("RA"));
+    _cc = &cc;
 
-    {
-      X86Gp a = cc.newInt32("a");
-      X86Gp b = cc.newInt32("b");
+    cc.addFunc(FuncSignature2<int, int, const int*>(CallConv::kIdHost));
 
-      cc.addFunc(f1);
-      cc.setArg(0, a);
-      cc.setArg(1, b);
+    X86Gp a = cc.newInt32("a");
+    X86Gp p = cc.newIntPtr("p");
+    X86Gp k = cc.newInt32("k");
+    X86Gp m = cc.newInt32("m");
 
-      CCFuncCall* call = cc.call(f2->getLabel(), FuncSignature2<int, int, int>(CallConv::kIdHost));
-      call->setArg(0, a);
-      call->setArg(1, b);
-      call->setRet(0, a);
+    cc.setArg(0, a);
+    cc.setArg(1, p);
 
-      cc.ret(a);
-      cc.endFunc();
-    }
+    cc.mov(k, 100);
+    _imm = cc.getCursor()->as<CBInst>();
+    cc.setPatchable(_imm);
 
-    {
-      X86Gp a = cc.newInt32("a");
-      X86Gp b = cc.newInt32("b");
+    cc.mov(m, 100);
+    cc.add(a, k);
 
-      cc.addFunc(f2);
-      cc.setArg(0, a);
-      cc.setArg(1, b);
+    cc.add(a, x86::dword_ptr(p));
+    _mem = cc.getCursor()->as<CBInst>();
+    cc.setPatchable(_mem);
 
-      cc.add(a, b);
-      cc.ret(a);
-      cc.endFunc();
+    cc.imul(a, m);
+    cc.ret(a);
+    cc.endFunc();
+  }
+
+  int replay(int k, int offset, int a, const int* p, StringBuilder& result) {
+    typedef int (*Func)(int, const int*);
+
+    JitRuntime rt;
+    CodeHolder code;
+    code.init(rt.getCodeInfo());
+    X86Assembler as(&code);
+
+    _cc->patchImm(_imm, 1, k);
+    _cc->patchMem(_mem, 1, offset);
+
+    Error err = _cc->replay(&as);
+    Func func;
+
+    if (err == kErrorOk)
+      err = rt.add(&func, &code);
+
+    if (err != kErrorOk) {
+      result.appendFormat("error=%s ", DebugUtils::errorAsString(err));
+      return 0;
     }
+
+    int ret = func(a, p);
+    rt.release(func);
+    return ret;
   }
 
   virtual bool run(void* _func, StringBuilder& result, StringBuilder& expect) {
-    typedef int (*Func)(int, int);
-
+    typedef int (*Func)(int, const int*);
     Func func = ptr_as_func<Func>(_func);
 
-    int resultRet = func(56, 22);
-    int expectRet = 56 + 22;
+    static const int data[4] = { 1, 2, 3, 4 };
 
-    result.setFormat("ret=%d", resultRet);
-    expect.setFormat("ret=%d", expectRet);
+    size_t regCount = _cc->getVirtRegArray().getLength();
+    uint32_t raRuns = _cc->getPassByName("RA")->getStats().runCount;
+
+    int r0 = func(5, data);
+    int r1 = replay(7, 8, 5, data, result);
+    int r2 = replay(-5000, 12, 5, data, result);
+
+    // Nothing is allocated and no pass runs again.
+    int same = _cc->getVirtRegArray().getLength() == regCount &&
+               _cc->getPassByName("RA")->getStats().runCount == raRuns;
+
+    result.appendFormat("ret={%d %d %d} same=%d", r0, r1, r2, same);
+    expect.appendFormat("ret={%d %d %d} same=%d", (5 + 100 + 1) * 100, (5 + 7 + 3) * 100, (5 - 5000 + 4) * 100, 1);
 
     return result.eq(expect);
   }
+
+  X86Compiler* _cc;
+  CBInst* _imm;
+  CBInst* _mem;
 };
 
 // ============================================================================
-// [X86Test_MiscFastEval]
+// [X86Test_MiscMemInline]
 // ============================================================================
 
-class X86Test_MiscFastEval : public X86Test {
+class X86Test_MiscMemInline : public X86Test {
 public:
-  X86Test_MiscFastEval() : X86Test("[Misc] FastEval (CConv)") {}
+  X86Test_MiscMemInline(bool sse2Only)
+    : X86Test(sse2Only ? "[Misc] MemInline (SSE2)" : "[Misc] MemInline"),
+      _sse2Only(sse2Only) {}
 
   static void add(X86TestManager& mgr) {
-    mgr.add(new X86Test_MiscFastEval());
+    mgr.add(new X86Test_MiscMemInline(false));
+    mgr.add(new X86Test_MiscMemInline(true));
   }
 
   virtual void compile(X86Compiler& cc) {
-    FuncSignature5<void, const void*, const void*, const void*, const void*, void*> funcSig(CallConv::kIdHostCDecl);
-    FuncSignature2<X86Xmm, X86Xmm, X86Xmm> fastSig(CallConv::kIdHostFastEval2);
-
-    CCFunc* func = cc.newFunc(funcSig);
-    CCFunc* fast = cc.newFunc(fastSig);
-
-    {
-      X86Gp aPtr = cc.newIntPtr("aPtr");
-      X86Gp bPtr = cc.newIntPtr("bPtr");
-      X86Gp cPtr = cc.newIntPtr("cPtr");
-      X86Gp dPtr = cc.newIntPtr("dPtr");
-      X86Gp pOut = cc.newIntPtr("pOut");
-
-      X86Xmm aXmm = cc.newXmm("aXmm");
-      X86Xmm bXmm = cc.newXmm("bXmm");
-      X86Xmm cXmm = cc.newXmm("cXmm");
-      X86Xmm dXmm = cc.newXmm("dXmm");
+    // Target a CPU without AVX and ERMS, so large sizes call the C library.
+    if (_sse2Only) {
+      CpuFeatures features;
+      features.add(CpuInfo::kX86FeatureSSE).add(CpuInfo::kX86FeatureSSE2);
+      cc._codeInfo.setFeatures(features);
+    }
 
-      cc.addFunc(func);
+    cc.addFunc(FuncSignature4<void, uint8_t*, const uint8_t*, const uint8_t*, int*>(CallConv::kIdHost));
 
-      cc.setArg(0, aPtr);
-      cc.setArg(1, bPtr);
-      cc.setArg(2, cPtr);
-      cc.setArg(3, dPtr);
-      cc.setArg(4, pOut);
+    X86Gp dst = cc.newIntPtr("dst");
+    X86Gp src = cc.newIntPtr("src");
+    X86Gp cmp = cc.newIntPtr("cmp");
+    X86Gp out = cc.newIntPtr("out");
+    X86Gp p = cc.newIntPtr("p");
+    X86Gp n = cc.newIntPtr("n");
+    X86Gp r = cc.newInt32("r");
 
-      cc.movups(aXmm, x86::ptr(aPtr));
-      cc.movups(bXmm, x86::ptr(bPtr));
-      cc.movups(cXmm, x86::ptr(cPtr));
-      cc.movups(dXmm, x86::ptr(dPtr));
+    cc.setArg(0, dst);
+    cc.setArg(1, src);
+    cc.setArg(2, cmp);
+    cc.setArg(3, out);
 
-      X86Xmm xXmm = cc.newXmm("xXmm");
-      X86Xmm yXmm = cc.newXmm("yXmm");
+    // Copy and fill of known sizes, the last one exceeds the inline limit.
+    cc.inlineMemcpy(dst, src, 37);
+    cc.lea(p, x86::ptr(dst, 64));
+    cc.inlineMemset(p, 0xAB, 23);
+    cc.lea(p, x86::ptr(dst, 128));
+    cc.inlineMemset(p, 0, 300, 16);
 
-      CCFuncCall* call1 = cc.call(fast->getLabel(), fastSig);
-      call1->setArg(0, aXmm);
-      call1->setArg(1, bXmm);
-      call1->setRet(0, xXmm);
+    // Copy of a size known at runtime.
+    cc.lea(p, x86::ptr(dst, 448));
+    cc.mov(n, 100);
+    cc.inlineMemcpy(p, src, n);
 
-      CCFuncCall* call2 = cc.call(fast->getLabel(), fastSig);
-      call2->setArg(0, cXmm);
-      call2->setArg(1, dXmm);
-      call2->setRet(0, yXmm);
+    cc.inlineMemcmp(r, dst, src, 37);
+    cc.mov(x86::dword_ptr(out, 0), r);
 
-      cc.pmullw(xXmm, yXmm);
-      cc.movups(x86::ptr(pOut), xXmm);
+    cc.lea(p, x86::ptr(dst, 64));
+    cc.inlineMemcmp(r, p, src, 23);
+    cc.mov(x86::dword_ptr(out, 4), r);
 
-      cc.endFunc();
-    }
+    cc.inlineMemcmp(r, src, cmp, 45);
+    cc.mov(x86::dword_ptr(out, 8), r);
 
-    {
-      X86Xmm aXmm = cc.newXmm("aXmm");
-      X86Xmm bXmm = cc.newXmm("bXmm");
+    cc.inlineMemcmp(r, src, cmp, 3);
+    cc.mov(x86::dword_ptr(out, 12), r);
 
-      cc.addFunc(fast);
-      cc.setArg(0, aXmm);
-      cc.setArg(1, bXmm);
-      cc.paddw(aXmm, bXmm);
-      cc.ret(aXmm);
-      cc.endFunc();
-    }
+    cc.endFunc();
   }
 
   virtual bool run(void* _func, StringBuilder& result, StringBuilder& expect) {
-    typedef void (*Func)(const void*, const void*, const void*, const void*, void*);
-
+    typedef void (*Func)(uint8_t*, const uint8_t*, const uint8_t*, int*);
     Func func = ptr_as_func<Func>(_func);
 
-    int16_t a[8] = { 0, 1, 2, 3, 4, 5, 6, 7 };
-    int16_t b[8] = { 7, 6, 5, 4, 3, 2, 1, 0 };
-    int16_t c[8] = { 1, 3, 9, 7, 5, 4, 2, 1 };
-    int16_t d[8] = { 2, 0,-6,-4,-2,-1, 1, 2 };
+    uint8_t dst[600];
+    uint8_t src[128];
+    uint8_t cmp[128];
+    int out[4] = { 0 };
+    uint32_t i;
 
-    int16_t o[8];
-    int oExp = 7 * 3;
+    ::memset(dst, 0x55, sizeof(dst));
+    for (i = 0; i < 128; i++)
+      src[i] = static_cast<uint8_t>(i + 1);
+    ::memcpy(cmp, src, sizeof(src));
+    cmp[40]++;
 
-    func(a, b, c, d, o);
+    func(dst, src, cmp, out);
 
-    result.setFormat("ret={%02X %02X %02X %02X %02X %02X %02X %02X}", o[0], o[1], o[2], o[3], o[4], o[5], o[6], o[7]);
-    expect.setFormat("ret={%02X %02X %02X %02X %02X %02X %02X %02X}", oExp, oExp, oExp, oExp, oExp, oExp, oExp, oExp);
+    uint8_t expectDst[600];
+    ::memset(expectDst, 0x55, sizeof(expectDst));
+    ::memcpy(expectDst, src, 37);
+    ::memset(expectDst + 64, 0xAB, 23);
+    ::memset(expectDst + 128, 0, 300);
+    ::memcpy(expectDst + 448, src, 100);
 
-    return result == expect;
+    result.setFormat("dst=%d cmp={%d, %d, %d, %d}",
+      int(::memcmp(dst, expectDst, sizeof(dst)) == 0), out[0], out[1] > 0, out[2] < 0, out[3]);
+    expect.setFormat("dst=%d cmp={%d, %d, %d, %d}", 1, 0, 1, 1, 0);
+
+    return result.eq(expect);
   }
+
+  bool _sse2Only;
 };
 
 // ============================================================================
-// [X86Test_MiscUnfollow]
+// [X86Test_MiscUnwind]
 // ============================================================================
 
-// Global (I didn't find a better way to test this).
-static jmp_buf globalJmpBuf;
+#if defined(__linux__) && (defined(__GNUC__) || defined(__clang__))
+struct X86TestUnwindTrace {
+  const uint8_t* funcStart;              // Start of the generated function.
+  const uint8_t* funcEnd;                // End of the generated function (estimate).
+  int funcFrame;                         // Index of the frame of the generated function.
+  int frameCount;                        // Count of all frames walked.
+};
 
-class X86Test_MiscUnfollow : public X86Test {
+static X86TestUnwindTrace* X86TestUnwind_trace;
+
+static _Unwind_Reason_Code X86TestUnwind_frame(struct _Unwind_Context* ctx, void* data) {
+  X86TestUnwindTrace* trace = static_cast<X86TestUnwindTrace*>(data);
+  const uint8_t* ip = reinterpret_cast<const uint8_t*>(_Unwind_GetIP(ctx));
+
+  if (trace->funcFrame < 0 && ip > trace->funcStart && ip <= trace->funcEnd)
+    trace->funcFrame = trace->frameCount;
+
+  return ++trace->frameCount < 64 ? _URC_NO_REASON : _URC_END_OF_STACK;
+}
+
+static void X86TestUnwind_callback() {
+  _Unwind_Backtrace(X86TestUnwind_frame, X86TestUnwind_trace);
+}
+
+class X86Test_MiscUnwind : public X86Test {
 public:
-  X86Test_MiscUnfollow() : X86Test("[Misc] Unfollow") {}
+  enum Mode {
+    kModeNoFP = 0,
+    kModeFP = 1,
+    kModeAligned = 2
+  };
+
+  X86Test_MiscUnwind(uint32_t mode)
+    : X86Test(mode == kModeNoFP ? "[Misc] Unwind" :
+              mode == kModeFP   ? "[Misc] Unwind (FP)" : "[Misc] Unwind (Aligned)"),
+      _mode(mode) {}
 
   static void add(X86TestManager& mgr) {
-    mgr.add(new X86Test_MiscUnfollow());
+    mgr.add(new X86Test_MiscUnwind(kModeNoFP));
+    mgr.add(new X86Test_MiscUnwind(kModeFP));
+    mgr.add(new X86Test_MiscUnwind(kModeAligned));
   }
 
   virtual void compile(X86Compiler& cc) {
-    // NOTE: Fastcall calling convention is the most appropriate here, as all
-    // arguments will be passed by registers and there won't be any stack
-    // misalignment when we call the `handler()`. This was failing on OSX
-    // when targeting 32-bit.
-    cc.addFunc(FuncSignature2<void, int, void*>(CallConv::kIdHostFastCall));
+    cc.getCode()->setUnwindEnabled(true);
+    cc.addFunc(FuncSignature1<int, int>(CallConv::kIdHost));
 
-    X86Gp a = cc.newInt32("a");
-    X86Gp b = cc.newIntPtr("b");
+    if (_mode == kModeFP)
+      cc.getFunc()->getFrameInfo().enablePreservedFP();
 
-    Label tramp = cc.newLabel();
+    X86Gp x = cc.newInt32("x");
+    X86Gp a = cc.newInt32("a");
+    X86Gp b = cc.newInt32("b");
+    X86Gp c = cc.newInt32("c");
 
-    cc.setArg(0, a);
-    cc.setArg(1, b);
+    cc.setArg(0, x);
 
-    cc.cmp(a, 0);
-    cc.jz(tramp);
+    // Values live across the call are kept in preserved registers, which
+    // makes the prolog push them.
+    cc.lea(a, x86::ptr(x, 1));
+    cc.lea(b, x86::ptr(x, 2));
+    cc.lea(c, x86::ptr(x, 3));
 
-    cc.ret(a);
+    if (_mode == kModeAligned) {
+      X86Mem stack = cc.newStack(64, 64);
+      cc.mov(stack, a);
+      cc.add(b, stack);
+    }
 
-    cc.bind(tramp);
-    cc.unfollow().jmp(b);
+    cc.call(imm_ptr((void*)X86TestUnwind_callback), FuncSignature0<void>(CallConv::kIdHostCDecl));
 
+    cc.add(a, b);
+    cc.add(a, c);
+    cc.add(a, x);
+    cc.ret(a);
     cc.endFunc();
   }
 
   virtual bool run(void* _func, StringBuilder& result, StringBuilder& expect) {
-    typedef int (ASMJIT_FASTCALL *Func)(int, void*);
-
+    typedef int (*Func)(int);
     Func func = ptr_as_func<Func>(_func);
 
-    int resultRet = 0;
-    int expectRet = 1;
+    X86TestUnwindTrace trace;
+    trace.funcStart = static_cast<const uint8_t*>(_func);
+    trace.funcEnd = trace.funcStart + 4096;
+    trace.funcFrame = -1;
+    trace.frameCount = 0;
 
-    if (!setjmp(globalJmpBuf))
-      resultRet = func(0, (void*)handler);
-    else
-      resultRet = 1;
+    X86TestUnwind_trace = &trace;
+    int resultRet = func(10);
+    X86TestUnwind_trace = nullptr;
 
-    result.setFormat("ret={%d}", resultRet);
-    expect.setFormat("ret={%d}", expectRet);
+    int expectB = _mode == kModeAligned ? 23 : 12;
 
-    return resultRet == expectRet;
+    // The generated function must be found and the walk must continue to
+    // `run()` and its callers, which requires a correct CFA of the function.
+    result.setFormat("ret=%d found=%d callers=%d",
+      resultRet, int(trace.funcFrame > 0), int(trace.frameCount - trace.funcFrame > 2));
+    expect.setFormat("ret=%d found=%d callers=%d", 11 + expectB + 13 + 10, 1, 1);
+
+    return result.eq(expect);
   }
 
-  static void ASMJIT_FASTCALL handler() { longjmp(globalJmpBuf, 1); }
+  uint32_t _mode;
 };
+#endif
 
 // ============================================================================
 // [X86Test_Bug100]
@@ -3572,6 +6317,16 @@ public:
     return false;
   }
 
+  //! Get the value of `key=value` argument, or null if not present.
+  const char* getValue(const char* key) {
+    size_t keyLen = ::strlen(key);
+    for (int i = 1; i < _argc; i++) {
+      if (::strncmp(_argv[i], key, keyLen) == 0 && _argv[i][keyLen] == '=')
+        return _argv[i] + keyLen + 1;
+    }
+    return nullptr;
+  }
+
   // --------------------------------------------------------------------------
   // [Members]
   // --------------------------------------------------------------------------
@@ -3593,6 +6348,23 @@ int main(int argc, char* argv[]) {
   if (cmd.hasArg("--verbose"))
     testMgr._verbose = true;
 
+  if (cmd.hasArg("--perf") || cmd.hasArg("--perf-run"))
+    testMgr._perf = true;
+  if (cmd.hasArg("--perf-run"))
+    testMgr._perfRun = true;
+
+  if (const char* value = cmd.getValue("--perf-samples"))
+    testMgr._perfSamples = std::max<uint32_t>(static_cast<uint32_t>(::strtoul(value, nullptr, 10)), 1);
+  if (const char* value = cmd.getValue("--perf-time"))
+    testMgr._perfTimeThreshold = static_cast<uint32_t>(::strtoul(value, nullptr, 10));
+  if (const char* value = cmd.getValue("--perf-size"))
+    testMgr._perfSizeThreshold = static_cast<uint32_t>(::strtoul(value, nullptr, 10));
+
+  testMgr._perfRecord = cmd.getValue("--perf-record");
+  testMgr._perfBaseline = cmd.getValue("--perf-baseline");
+  if (testMgr._perfRecord || testMgr._perfBaseline)
+    testMgr._perf = true;
+
   // Align.
   ADD_TEST(X86Test_AlignBase);
   ADD_TEST(X86Test_AlignNone);
@@ -3603,6 +6375,8 @@ int main(int argc, char* argv[]) {
   ADD_TEST(X86Test_JumpMany);
   ADD_TEST(X86Test_JumpUnreachable1);
   ADD_TEST(X86Test_JumpUnreachable2);
+  ADD_TEST(X86Test_JumpSwitchTable);
+  ADD_TEST(X86Test_JumpSwitchSparse);
 
   // Alloc.
   ADD_TEST(X86Test_AllocBase);
@@ -3610,6 +6384,14 @@ int main(int argc, char* argv[]) {
   ADD_TEST(X86Test_AllocUseMem);
   ADD_TEST(X86Test_AllocMany1);
   ADD_TEST(X86Test_AllocMany2);
+  ADD_TEST(X86Test_AllocRemat);
+  ADD_TEST(X86Test_AllocCoalesce);
+  ADD_TEST(X86Test_AllocConstSection);
+  ADD_TEST(X86Test_AllocSharedConst);
+  ADD_TEST(X86Test_AllocLinearScan);
+  ADD_TEST(X86Test_AllocGlobal);
+  ADD_TEST(X86Test_AllocCompactStorage);
+  ADD_TEST(X86Test_AllocPackedStorage);
   ADD_TEST(X86Test_AllocImul1);
   ADD_TEST(X86Test_AllocImul2);
   ADD_TEST(X86Test_AllocIdiv1);
@@ -3633,6 +6415,7 @@ int main(int argc, char* argv[]) {
   ADD_TEST(X86Test_AllocStack2);
   ADD_TEST(X86Test_AllocMemcpy);
   ADD_TEST(X86Test_AllocAlphaBlend);
+  ADD_TEST(X86Test_AllocAvx512Mask);
 
   // Call.
   ADD_TEST(X86Test_CallBase);
@@ -3645,19 +6428,40 @@ int main(int argc, char* argv[]) {
   ADD_TEST(X86Test_CallDoubleAsXmmRet);
   ADD_TEST(X86Test_CallConditional);
   ADD_TEST(X86Test_CallMultiple);
+  ADD_TEST(X86Test_CallSameArgs);
+  ADD_TEST(X86Test_CallCustomConv);
   ADD_TEST(X86Test_CallRecursive);
   ADD_TEST(X86Test_CallMisc1);
   ADD_TEST(X86Test_CallMisc2);
   ADD_TEST(X86Test_CallMisc3);
   ADD_TEST(X86Test_CallMisc4);
   ADD_TEST(X86Test_CallMisc5);
+  ADD_TEST(X86Test_CallTail);
 
   // Misc.
   ADD_TEST(X86Test_MiscConstPool);
   ADD_TEST(X86Test_MiscMultiRet);
   ADD_TEST(X86Test_MiscMultiFunc);
+  ADD_TEST(X86Test_MiscFlush);
+  ADD_TEST(X86Test_MiscJumpRelax);
+  ADD_TEST(X86Test_MiscPeephole);
+  ADD_TEST(X86Test_MiscVZeroUpper);
+  ADD_TEST(X86Test_MiscLoopAlign);
+  ADD_TEST(X86Test_MiscFlowGraph);
+  ADD_TEST(X86Test_MiscDeadCode);
+  ADD_TEST(X86Test_MiscSchedule);
+  ADD_TEST(X86Test_MiscInline);
   ADD_TEST(X86Test_MiscFastEval);
   ADD_TEST(X86Test_MiscUnfollow);
+  ADD_TEST(X86Test_MiscBlockLayout);
+  ADD_TEST(X86Test_MiscValueNumber);
+  ADD_TEST(X86Test_MiscReport);
+  ADD_TEST(X86Test_MiscLoop);
+  ADD_TEST(X86Test_MiscReplay);
+  ADD_TEST(X86Test_MiscMemInline);
+#if defined(__linux__) && (defined(__GNUC__) || defined(__clang__))
+  ADD_TEST(X86Test_MiscUnwind);
+#endif
 
   // Bugs.
   ADD_TEST(X86Test_Bug100);
@@ -1,12 +1,14 @@
 // [Generate-ARM]
 //
-// NOTE: This script relies on 'asmdb' package. Either install it by using
-// node.js package manager (npm) or by copying/symlinking the whole asmdb
-// directory as [asmjit]/tools/asmdb.
+// NOTE: This script relies on 'generate-base.js', which requires 'asmdb'
+// package. Either install it by using node.js package manager (npm) or by
+// copying/symlinking the whole asmdb directory as [asmjit]/tools/asmdb.
+//
+// The ARM database of asmdb doesn't provide encodings usable by AsmJit yet,
+// thus the AArch64 (A64) subset supported by `ArmAssembler` is listed here.
 "use strict";
 
 const base = require("./generate-base.js");
-const hasOwn = Object.prototype.hasOwnProperty;
 const kIndent = base.kIndent;
 const StringUtils = base.StringUtils;
 
@@ -14,67 +16,165 @@ const StringUtils = base.StringUtils;
 // [ArmDB]
 // ----------------------------------------------------------------------------
 
-// Create the ARM database.
-const arm = base.asmdb.arm;
-const isa = new arm.ISA();
-
-console.log(
-  isa.query({
-    filter: function(inst) {
-      return !!inst.extensions.ASIMD;
-    }
-  })
-);
-
-//console.log(JSON.stringify(isa.instructionMap, null, 2));
-
-// ----------------------------------------------------------------------------
-// [GenUtils]
-// ----------------------------------------------------------------------------
-
-class GenUtils {
-  // Get a list of instructions based on `name` and optional `mode`.
-  static instsOf(name, mode) {
-    const insts = isa.query(name);
-    return !mode ? insts : insts.filter(function(inst) { return inst.arch === mode; });
-  }
-
-  static archOf(group) {
-    var t16Arch = false;
-    var t32Arch = false;
-    var a32Arch = false;
-    var a64Arch = false;
-
-    for (var i = 0; i < group.length; i++) {
-      const inst = group[i];
-      if (inst.encoding === "T16") t16Arch = true;
-      if (inst.encoding === "T32") t32Arch = true;
-      if (inst.encoding === "A32") a32Arch = true;
-      if (inst.encoding === "A64") a64Arch = true;
-    }
-
-    var s = (t16Arch && !t32Arch) ? "T16" :
-            (t32Arch && !t16Arch) ? "T32" :
-            (t16Arch &&  t32Arch) ? "Txx" : "---";
-    s += " ";
-    s += (a32Arch) ? "A32" : "---";
-    s += " ";
-    s += (a64Arch) ? "A64" : "---";
-
-    return `[${s}]`;
+// Instruction | Encoding | OpCode (32-bit variant) | Flags | Jump type
+//
+// Flags:
+//   R  - 1st operand is read.
+//   W  - 1st operand is written.
+//   X  - 1st operand is read and written.
+//   W2 - 2nd operand is written as well.
+//   M  - Move.
+//   S  - Store.
+//   F  - Floating point.
+const kInstList = `
+  adc      | BaseRRR        | 0x1A000000 | W     |
+  adcs     | BaseRRR        | 0x3A000000 | W     |
+  add      | BaseAddSub     | 0x11000000 | W     |
+  adds     | BaseAddSub     | 0x31000000 | W     |
+  adr      | BaseAdr        | 0x10000000 | W     |
+  and      | BaseLogical    | 0x0A000000 | W     |
+  ands     | BaseLogical    | 0x6A000000 | W     |
+  asr      | BaseShift      | 0x1AC02800 | W     |
+  b        | BaseBranch     | 0x14000000 | R     | Direct
+  b.eq     | BaseBranchCond | 0x54000000 | R     | Conditional
+  b.ge     | BaseBranchCond | 0x5400000A | R     | Conditional
+  b.gt     | BaseBranchCond | 0x5400000C | R     | Conditional
+  b.hi     | BaseBranchCond | 0x54000008 | R     | Conditional
+  b.hs     | BaseBranchCond | 0x54000002 | R     | Conditional
+  b.le     | BaseBranchCond | 0x5400000D | R     | Conditional
+  b.lo     | BaseBranchCond | 0x54000003 | R     | Conditional
+  b.ls     | BaseBranchCond | 0x54000009 | R     | Conditional
+  b.lt     | BaseBranchCond | 0x5400000B | R     | Conditional
+  b.mi     | BaseBranchCond | 0x54000004 | R     | Conditional
+  b.ne     | BaseBranchCond | 0x54000001 | R     | Conditional
+  b.pl     | BaseBranchCond | 0x54000005 | R     | Conditional
+  b.vc     | BaseBranchCond | 0x54000007 | R     | Conditional
+  b.vs     | BaseBranchCond | 0x54000006 | R     | Conditional
+  bic      | BaseLogical    | 0x0A200000 | W     |
+  bics     | BaseLogical    | 0x6A200000 | W     |
+  bl       | BaseBranch     | 0x94000000 | R     | Call
+  blr      | BaseBranchReg  | 0xD63F0000 | R     | Call
+  br       | BaseBranchReg  | 0xD61F0000 | R     | Direct
+  brk      | BaseImm16      | 0xD4200000 | R     |
+  cbnz     | BaseCbz        | 0x35000000 | R     | Conditional
+  cbz      | BaseCbz        | 0x34000000 | R     | Conditional
+  cls      | BaseRR         | 0x5AC01400 | W     |
+  clz      | BaseRR         | 0x5AC01000 | W     |
+  cmn      | BaseCmp        | 0x31000000 | R     |
+  cmp      | BaseCmp        | 0x71000000 | R     |
+  csel     | BaseCSel       | 0x1A800000 | W     |
+  cset     | BaseCSet       | 0x1A9F07E0 | W     |
+  csetm    | BaseCSet       | 0x5A9F03E0 | W     |
+  csinc    | BaseCSel       | 0x1A800400 | W     |
+  csinv    | BaseCSel       | 0x5A800000 | W     |
+  csneg    | BaseCSel       | 0x5A800400 | W     |
+  eon      | BaseLogical    | 0x4A200000 | W     |
+  eor      | BaseLogical    | 0x4A000000 | W     |
+  fabs     | FpRR           | 0x1E20C000 | W F   |
+  fadd     | FpRRR          | 0x1E202800 | W F   |
+  fcmp     | FpCmp          | 0x1E202000 | R F   |
+  fcvt     | FpCvt          | 0x1E224000 | W F   |
+  fcvtzs   | FpCvtToGp      | 0x1E380000 | W F   |
+  fcvtzu   | FpCvtToGp      | 0x1E390000 | W F   |
+  fdiv     | FpRRR          | 0x1E201800 | W F   |
+  fmadd    | FpRRRR         | 0x1F000000 | W F   |
+  fmax     | FpRRR          | 0x1E204800 | W F   |
+  fmin     | FpRRR          | 0x1E205800 | W F   |
+  fmov     | FpMov          | 0x1E204000 | W M F |
+  fmsub    | FpRRRR         | 0x1F008000 | W F   |
+  fmul     | FpRRR          | 0x1E200800 | W F   |
+  fneg     | FpRR           | 0x1E214000 | W F   |
+  fsqrt    | FpRR           | 0x1E21C000 | W F   |
+  fsub     | FpRRR          | 0x1E203800 | W F   |
+  hlt      | BaseImm16      | 0xD4400000 | R     |
+  ldp      | BaseLdpStp     | 0x28400000 | W W2  |
+  ldr      | BaseLdSt       | 0x39400000 | W     |
+  ldrb     | BaseLdStSized  | 0x39400000 | W     |
+  ldrh     | BaseLdStSized  | 0x79400000 | W     |
+  ldrsb    | BaseLdStSized  | 0x39800000 | W     |
+  ldrsh    | BaseLdStSized  | 0x79800000 | W     |
+  ldrsw    | BaseLdStSized  | 0xB9800000 | W     |
+  lsl      | BaseShift      | 0x1AC02000 | W     |
+  lsr      | BaseShift      | 0x1AC02400 | W     |
+  madd     | BaseRRRR       | 0x1B000000 | W     |
+  mneg     | BaseRRR        | 0x1B00FC00 | W     |
+  mov      | BaseMov        | 0x00000000 | W M   |
+  movk     | BaseMovWide    | 0x72800000 | X     |
+  movn     | BaseMovWide    | 0x12800000 | W     |
+  movz     | BaseMovWide    | 0x52800000 | W     |
+  msub     | BaseRRRR       | 0x1B008000 | W     |
+  mul      | BaseRRR        | 0x1B007C00 | W     |
+  mvn      | BaseNeg        | 0x2A2003E0 | W     |
+  neg      | BaseNeg        | 0x4B0003E0 | W     |
+  negs     | BaseNeg        | 0x6B0003E0 | W     |
+  nop      | BaseOp         | 0xD503201F |       |
+  orn      | BaseLogical    | 0x2A200000 | W     |
+  orr      | BaseLogical    | 0x2A000000 | W     |
+  rbit     | BaseRR         | 0x5AC00000 | W     |
+  ret      | BaseRet        | 0xD65F0000 | R     | Return
+  rev      | BaseRR         | 0x5AC00800 | W     |
+  rev16    | BaseRR         | 0x5AC00400 | W     |
+  ror      | BaseShift      | 0x1AC02C00 | W     |
+  sbc      | BaseRRR        | 0x5A000000 | W     |
+  sbcs     | BaseRRR        | 0x7A000000 | W     |
+  scvtf    | FpCvtFromGp    | 0x1E220000 | W F   |
+  sdiv     | BaseRRR        | 0x1AC00C00 | W     |
+  smulh    | BaseRRR        | 0x9B407C00 | W     |
+  stp      | BaseLdpStp     | 0x28000000 | R S   |
+  str      | BaseLdSt       | 0x39000000 | R S   |
+  strb     | BaseLdStSized  | 0x39000000 | R S   |
+  strh     | BaseLdStSized  | 0x79000000 | R S   |
+  sub      | BaseAddSub     | 0x51000000 | W     |
+  subs     | BaseAddSub     | 0x71000000 | W     |
+  svc      | BaseImm16      | 0xD4000001 | R     |
+  sxtb     | BaseExtend     | 0x13001C00 | W     |
+  sxth     | BaseExtend     | 0x13003C00 | W     |
+  sxtw     | BaseExtend     | 0x93407C00 | W     |
+  tbnz     | BaseTbz        | 0x37000000 | R     | Conditional
+  tbz      | BaseTbz        | 0x36000000 | R     | Conditional
+  tst      | BaseTst        | 0x6A000000 | R     |
+  ucvtf    | FpCvtFromGp    | 0x1E230000 | W F   |
+  udiv     | BaseRRR        | 0x1AC00800 | W     |
+  umulh    | BaseRRR        | 0x9BC07C00 | W     |
+  uxtb     | BaseExtend     | 0x53001C00 | W     |
+  uxth     | BaseExtend     | 0x53003C00 | W     |
+`;
+
+const kFlagNames = {
+  "R" : "UseR",
+  "W" : "UseW",
+  "X" : "UseX",
+  "W2": "UseW2",
+  "M" : "Move",
+  "S" : "Store",
+  "F" : "Fp"
+};
+
+function parseInstList(s) {
+  const out = [];
+  const lines = s.split(/\n/g);
+
+  for (var i = 0; i < lines.length; i++) {
+    const line = lines[i].trim();
+    if (!line) continue;
+
+    const parts = line.split("|").map(function(p) { return p.trim(); });
+    const flags = parts[3] ? parts[3].split(/\s+/g).map(function(f) {
+      if (!kFlagNames[f])
+        throw new Error(`Unknown flag '${f}' of '${parts[0]}'`);
+      return "F(" + kFlagNames[f] + ")";
+    }) : [];
+
+    out.push({
+      name    : parts[0],
+      encoding: parts[1],
+      opcode0 : parts[2],
+      flags   : flags.length ? flags.join("|") : "0",
+      jumpType: parts[4] || "None"
+    });
   }
 
-  static featuresOf(group) {
-    const exts = Object.create(null);
-    for (var i = 0; i < group.length; i++) {
-      const inst = group[i];
-      for (var k in inst.extensions)
-        exts[k] = true;
-    }
-    const arr =  Object.keys(exts);
-    arr.sort();
-    return arr;
-  }
+  return out;
 }
 
 // ----------------------------------------------------------------------------
@@ -97,28 +197,32 @@ class ArmGenerator extends base.BaseGenerator {
 
   parse() {
     this.addInst({
-      id: 0,
-      name: "",
-      enum: "None"
+      id          : 0,
+      name        : "",
+      enum        : "None",
+      encoding    : "None",
+      opcode0     : "0x00000000",
+      flags       : "0",
+      jumpType    : "None",
+      nameIndex   : -1,
+      commonIndex : -1
     });
 
-    var names = isa.instructionNames;
-    for (var i = 0; i < names.length; i++) {
-      const name = names[i];
-
-      const enum_ = StringUtils.upFirst(name);
-      const insts = GenUtils.instsOf(names[i]);
+    const list = parseInstList(kInstList);
+    for (var i = 0; i < list.length; i++) {
+      const inst = list[i];
 
       this.addInst({
-        id            : 0,             // Instruction id (numeric value).
-        name          : name,          // Instruction name.
-        enum          : enum_,         // Instruction enum without `kId` prefix.
-
-        familyType    : "kFamilyNone", // Family type.
-        familyIndex   : 0,             // Index to a family-specific data.
-
-        nameIndex     : -1,            // Instruction name-index.
-        commonIndex   : -1
+        id          : 0,                 // Instruction id (numeric value).
+        name        : inst.name,         // Instruction name.
+        enum        : StringUtils.upFirst(inst.name.replace(".", "_")),
+        encoding    : inst.encoding,     // Instruction encoding.
+        opcode0     : inst.opcode0,      // Instruction opcode.
+        flags       : inst.flags,        // Instruction flags.
+        jumpType    : inst.jumpType,     // Instruction jump type.
+
+        nameIndex   : -1,                // Instruction name-index.
+        commonIndex : -1                 // Instruction common-index.
       });
     }
 
@@ -150,12 +254,13 @@ class ArmGenerator extends base.BaseGenerator {
     for (var i = 0; i < this.instArray.length; i++) {
       const inst = this.instArray[i];
 
-      const item = "{ " + StringUtils.padLeft("0", 1) + "}";
+      const item = "{ " + StringUtils.padLeft(inst.flags, 24) + ", " +
+                          StringUtils.padLeft("JUMP_TYPE(" + inst.jumpType + ")", 22) + ", 0 }";
       inst.commonIndex = table.addIndexed(item);
     }
 
     var s = `const ArmInst::CommonData ArmInstDB::commonData[] = {\n${StringUtils.format(table, kIndent, true)}\n};\n`;
-    return this.inject("commonData", StringUtils.disclaimer(s), table.length * 12);
+    return this.inject("commonData", StringUtils.disclaimer(s), table.length * 8);
   }
 
   // --------------------------------------------------------------------------
@@ -165,13 +270,13 @@ class ArmGenerator extends base.BaseGenerator {
   generateInstData() {
     var s = StringUtils.format(this.instArray, "", false, function(inst) {
       return "INST(" +
-        StringUtils.padLeft(inst.enum       , 16) + ", " +
-        StringUtils.padLeft(inst.encoding   , 23) + ", " +
-        StringUtils.padLeft(inst.opcode0    , 26) + ", " +
+        StringUtils.padLeft(inst.enum       ,  8) + ", " +
+        StringUtils.padLeft(inst.encoding   , 14) + ", " +
+        StringUtils.padLeft(inst.opcode0    , 10) + ", " +
         StringUtils.padLeft(inst.nameIndex  ,  4) + ", " +
         StringUtils.padLeft(inst.commonIndex,  3) + ")";
     }) + "\n";
-    return this.inject("instData", s, this.instArray.length * 12);
+    return this.inject("instData", s, this.instArray.length * 8);
   }
 
   // --------------------------------------------------------------------------
@@ -179,16 +284,10 @@ class ArmGenerator extends base.BaseGenerator {
   // --------------------------------------------------------------------------
 
   getCommentOf(name) {
-    var insts = GenUtils.instsOf(name);
-    if (!insts) return "";
-
-    var features = GenUtils.featuresOf(insts);
-    var comment = GenUtils.archOf(insts);
-
-    if (features.length)
-      comment += " {" + features.join("|") + "}";
+    const inst = this.instMap[name];
+    if (!inst || !inst.name) return "";
 
-    return comment;
+    return inst.encoding.startsWith("Fp") ? "[A64] {FP}" : "[A64]";
   }
 }
 
@@ -343,6 +343,102 @@ class IndexedString {
 }
 exports.IndexedString = IndexedString;
 
+// ----------------------------------------------------------------------------
+// [NameHash]
+// ----------------------------------------------------------------------------
+
+// Minimal perfect hash of instruction names (hash and displace). Each name is
+// hashed once, the hash selects a bucket and the bucket's seed (displacement)
+// is mixed with the hash to select a unique slot in a table of exactly as many
+// slots as there are names. Must match `???InstNameHash` in C++ code.
+class NameHash {
+  static hash(s) {
+    var h = 0x811C9DC5;
+    for (var i = 0; i < s.length; i++)
+      h = Math.imul(h ^ s.charCodeAt(i), 0x01000193) >>> 0;
+    return h;
+  }
+
+  static mix(h, seed) {
+    h = (h ^ seed) >>> 0;
+    h = Math.imul(h ^ (h >>> 16), 0x85EBCA6B) >>> 0;
+    h = Math.imul(h ^ (h >>> 13), 0xC2B2AE35) >>> 0;
+    return (h ^ (h >>> 16)) >>> 0;
+  }
+
+  // Build the hash from `keys` mapped to `values`, returns an object having
+  // `seeds` (one per bucket) and `table` (values indexed by slot).
+  static build(keys, values, bucketSize) {
+    const count = keys.length;
+    const bucketCount = Math.max(Math.ceil(count / (bucketSize || 4)), 1);
+
+    const hashes = keys.map(NameHash.hash);
+    const buckets = [];
+
+    for (var i = 0; i < bucketCount; i++)
+      buckets.push({ index: i, items: [] });
+
+    for (var i = 0; i < count; i++)
+      buckets[hashes[i] % bucketCount].items.push(i);
+
+    // Place the biggest buckets first, they are the hardest to place.
+    const order = buckets.slice().sort(function(a, b) {
+      return b.items.length - a.items.length || a.index - b.index;
+    });
+
+    const seeds = new Array(bucketCount).fill(0);
+    const table = new Array(count).fill(-1);
+
+    for (var i = 0; i < order.length; i++) {
+      const items = order[i].items;
+      if (!items.length) break;
+
+      for (var seed = 0;; seed++) {
+        if (seed > 0xFFFF)
+          throw new Error(`NameHash.build(): Couldn't find a seed for bucket #${order[i].index}`);
+
+        const slots = [];
+        for (var j = 0; j < items.length; j++) {
+          const slot = NameHash.mix(hashes[items[j]], seed) % count;
+          if (table[slot] !== -1 || slots.indexOf(slot) !== -1) break;
+          slots.push(slot);
+        }
+
+        if (slots.length === items.length) {
+          for (var j = 0; j < items.length; j++)
+            table[slots[j]] = values[items[j]];
+          seeds[order[i].index] = seed;
+          break;
+        }
+      }
+    }
+
+    return { seeds: seeds, table: table };
+  }
+
+  // Format an array of numbers as a C++ initializer justified to `justify`.
+  static formatArray(array, indent, justify) {
+    var s = "";
+    var line = "";
+
+    for (var i = 0; i < array.length; i++) {
+      const item = String(array[i]) + (i !== array.length - 1 ? "," : "");
+      const newl = line + (line ? " " : indent) + item;
+
+      if (newl.length <= justify) {
+        line = newl;
+      }
+      else {
+        s += line + "\n";
+        line = indent + item;
+      }
+    }
+
+    return s + line;
+  }
+}
+exports.NameHash = NameHash;
+
 // ----------------------------------------------------------------------------
 // [BaseGenerator]
 // ----------------------------------------------------------------------------
@@ -452,13 +548,12 @@ class BaseGenerator {
 
   generateNameData() {
     const arch = this.arch;
-    const none = `${arch}Inst::kIdNone`;
 
     const instArray = this.instArray;
     const instNames = new IndexedString();
 
-    const instFirst = new Array(26);
-    const instLast  = new Array(26);
+    const hashKeys = [];
+    const hashValues = [];
 
     var maxLength = 0;
     for (var i = 0; i < instArray.length; i++) {
@@ -471,46 +566,34 @@ class BaseGenerator {
     for (var i = 0; i < instArray.length; i++) {
       const inst = instArray[i];
       const name = inst.name;
-      const nameIndex = instNames.getIndex(name);
-
-      const index = name.charCodeAt(0) - 'a'.charCodeAt(0);
-      if (index < 0 || index >= 26)
-        throw new Error(`BaseGenerator.generateNameData(): Invalid lookup character '${name[0]}' of '${name}'`);
 
-      inst.nameIndex = nameIndex;
-      if (instFirst[index] === undefined)
-        instFirst[index] = `${arch}Inst::kId${inst.enum}`;
-      instLast[index] = `${arch}Inst::kId${inst.enum}`;
+      inst.nameIndex = instNames.getIndex(name);
+      if (name) {
+        hashKeys.push(name);
+        hashValues.push(inst.id);
+      }
     }
 
+    const nameHash = NameHash.build(hashKeys, hashValues);
+    const seeds = nameHash.seeds;
+    const table = nameHash.table;
+
     var s = "";
     s += `const char ${arch}InstDB::nameData[] =\n${instNames.format(kIndent, kJustify)}\n`;
     s += `\n`;
 
     s += `enum {\n`;
-    s += `  k${arch}InstMaxLength = ${maxLength}\n`;
+    s += `  k${arch}InstMaxLength = ${maxLength},\n`;
+    s += `  k${arch}InstNameHashBuckets = ${seeds.length},\n`;
+    s += `  k${arch}InstNameHashSize = ${table.length}\n`;
     s += `};\n`;
     s += `\n`;
 
-    s += `struct InstNameAZ {\n`;
-    s += `  uint16_t start;\n`;
-    s += `  uint16_t end;\n`;
-    s += `};\n`;
+    s += `static const uint16_t ${arch}InstNameHashSeed[] = {\n${NameHash.formatArray(seeds, kIndent, kJustify)}\n};\n`;
     s += `\n`;
+    s += `static const uint16_t ${arch}InstNameHashTable[] = {\n${NameHash.formatArray(table, kIndent, kJustify)}\n};\n`;
 
-    s += `static const InstNameAZ ${arch}InstNameAZ[26] = {\n`;
-    for (var i = 0; i < instFirst.length; i++) {
-      const firstId = instFirst[i] || none;
-      const lastId = instLast[i] || none;
-
-      s += `  { ${StringUtils.padLeft(firstId, 22)}, ${StringUtils.padLeft(lastId , 22)} + 1 }`;
-      if (i !== 26 - 1)
-        s += `,`;
-      s += `\n`;
-    }
-    s += `};\n`;
-
-    return this.inject("nameData", StringUtils.disclaimer(s), instNames.getSize() + 26 * 4);
+    return this.inject("nameData", StringUtils.disclaimer(s), instNames.getSize() + (seeds.length + table.length) * 2);
   }
 
   // --- Reimplement ---
@@ -61,6 +61,117 @@ const NotFixedInsts = MapUtils.arrayToMap([
   "adc", "add", "and", "cmp", "mov", "or", "sbb", "sub", "test", "xchg", "xor"
 ]);
 
+// ----------------------------------------------------------------------------
+// [CostTable]
+// ----------------------------------------------------------------------------
+
+// Microarchitectures that have their own costs, generic costs are the worst
+// case of all of them. Must match `X86Inst::Uarch` (except `kUarchGeneric`).
+const CostUarchs = ["Haswell", "Skylake", "Zen"];
+
+// Latency of a load of a general purpose and vector register, used to derive
+// costs of the `RM` form (memory source) of families that don't list it.
+const CostLoadLatency = {
+  gp : [4, 5, 4],
+  vec: [6, 6, 7]
+};
+
+// Costs of instruction families, a cost is `[latency, reciprocal throughput,
+// uops]` of each microarchitecture in `CostUarchs`. Forms are `RR` (register
+// and immediate operands), `RM` (memory source), and `MR` (memory destination).
+function withAvx(names) {
+  return names.concat(names.map(function(name) { return "v" + name; }));
+}
+
+function withFma(types) {
+  const names = [];
+  ["vfmadd", "vfmsub", "vfnmadd", "vfnmsub"].forEach(function(op) {
+    ["132", "213", "231"].forEach(function(order) {
+      types.forEach(function(type) { names.push(op + order + type); });
+    });
+  });
+  return names;
+}
+
+const CostTable = [
+  { kind: "gp", insts: ["add", "and", "or", "sub", "xor"],
+    RR: [[1, 0.25, 1], [1, 0.25, 1], [1, 0.25, 1]],
+    MR: [[6, 1   , 2], [6, 1   , 2], [6, 1   , 2]] },
+
+  { kind: "gp", insts: ["cmp", "test"],
+    RR: [[1, 0.25, 1], [1, 0.25, 1], [1, 0.25, 1]] },
+
+  { kind: "gp", insts: ["dec", "inc", "neg", "not"],
+    RR: [[1, 0.25, 1], [1, 0.25, 1], [1, 0.25, 1]],
+    MR: [[7, 1   , 3], [7, 1   , 3], [7, 1   , 2]] },
+
+  { kind: "gp", insts: ["mov"],
+    RR: [[1, 0.25, 1], [1, 0.25, 1], [1, 0.25, 1]],
+    RM: [[4, 0.5 , 1], [5, 0.5 , 1], [4, 0.5 , 1]],
+    MR: [[1, 1   , 1], [1, 1   , 1], [1, 1   , 1]] },
+
+  { kind: "gp", insts: ["lea"],
+    RM: [[1, 0.5 , 1], [1, 0.5 , 1], [1, 0.25, 1]] },
+
+  { kind: "gp", insts: ["rol", "ror", "sar", "shl", "shr"],
+    RR: [[1, 0.5 , 1], [1, 0.5 , 1], [1, 0.25, 1]] },
+
+  { kind: "gp", insts: ["imul"],
+    RR: [[3, 1   , 1], [3, 1   , 1], [3, 1   , 1]] },
+
+  { kind: "gp", insts: ["lzcnt", "popcnt", "tzcnt"],
+    RR: [[3, 1   , 1], [3, 1   , 1], [1, 0.25, 1]] },
+
+  { kind: "vec", insts: withAvx(["movapd", "movaps", "movdqa", "movdqu", "movupd", "movups"]),
+    RR: [[1, 0.25, 1], [1, 0.25, 1], [1, 0.25, 1]],
+    RM: [[6, 0.5 , 1], [6, 0.5 , 1], [7, 0.5 , 1]],
+    MR: [[1, 1   , 1], [1, 1   , 1], [1, 1   , 1]] },
+
+  { kind: "vec", insts: withAvx(["addpd", "addps", "addsd", "addss", "subpd", "subps", "subsd", "subss"]),
+    RR: [[3, 1   , 1], [4, 0.5 , 1], [3, 0.5 , 1]] },
+
+  { kind: "vec", insts: withAvx(["maxpd", "maxps", "maxsd", "maxss", "minpd", "minps", "minsd", "minss"]),
+    RR: [[3, 1   , 1], [4, 0.5 , 1], [1, 0.5 , 1]] },
+
+  { kind: "vec", insts: withAvx(["mulpd", "mulps", "mulsd", "mulss"]),
+    RR: [[5, 0.5 , 1], [4, 0.5 , 1], [3, 0.5 , 1]] },
+
+  { kind: "vec", insts: withFma(["pd", "ps", "sd", "ss"]),
+    RR: [[5, 0.5 , 1], [4, 0.5 , 1], [5, 0.5 , 1]] },
+
+  { kind: "vec", insts: withAvx(["divps", "divss"]),
+    RR: [[13, 7  , 1], [11, 3  , 1], [10, 3  , 1]] },
+
+  { kind: "vec", insts: withAvx(["divpd", "divsd"]),
+    RR: [[20, 14 , 1], [14, 4  , 1], [13, 4  , 1]] },
+
+  { kind: "vec", insts: withAvx(["sqrtps", "sqrtss"]),
+    RR: [[11, 7  , 1], [12, 3  , 1], [14, 5  , 1]] },
+
+  { kind: "vec", insts: withAvx(["sqrtpd", "sqrtsd"]),
+    RR: [[16, 8  , 1], [18, 6  , 1], [20, 8  , 1]] },
+
+  { kind: "vec", insts: withAvx(["cvtdq2ps", "cvtps2dq", "cvttps2dq"]),
+    RR: [[3, 1   , 1], [4, 0.5 , 1], [4, 1   , 1]] },
+
+  { kind: "vec", insts: withAvx([
+      "paddb", "paddd", "paddq", "paddw", "pand", "pandn", "pcmpeqb", "pcmpeqd", "pcmpeqw",
+      "pcmpgtb", "pcmpgtd", "pcmpgtw", "por", "psubb", "psubd", "psubq", "psubw", "pxor"]),
+    RR: [[1, 0.5 , 1], [1, 0.33, 1], [1, 0.25, 1]] },
+
+  { kind: "vec", insts: withAvx(["pmaddwd", "pmuldq", "pmulhuw", "pmulhw", "pmullw", "pmuludq"]),
+    RR: [[5, 1   , 1], [5, 0.5 , 1], [3, 1   , 1]] },
+
+  { kind: "vec", insts: withAvx(["pmulld"]),
+    RR: [[10, 1  , 2], [10, 1  , 2], [4, 1   , 1]] },
+
+  { kind: "vec", insts: withAvx([
+      "pshufb", "pshufd", "punpckhbw", "punpckhdq", "punpckhqdq", "punpckhwd", "punpcklbw",
+      "punpckldq", "punpcklqdq", "punpcklwd", "shufpd", "shufps", "unpckhpd", "unpckhps",
+      "unpcklpd", "unpcklps"]),
+    RR: [[1, 1   , 1], [1, 1   , 1], [1, 0.5 , 1]] }
+];
+
 // ----------------------------------------------------------------------------
 // [GenUtils]
 // ----------------------------------------------------------------------------
@@ -1300,6 +1411,7 @@ class X86Generator extends base.BaseGenerator {
     this.generateSseToAvxData();
     this.generateAltOpCodeData();
     this.generateSignatureData();
+    this.generateCostData();
 
     // These must be last, and order matters.
     this.generateCommonData();
@@ -1612,6 +1724,70 @@ class X86Generator extends base.BaseGenerator {
     return this.inject("signatureData", StringUtils.disclaimer(s), opArr.length * 8 + signatureArr.length * 8);
   }
 
+  // --------------------------------------------------------------------------
+  // [Generate - CostData]
+  // --------------------------------------------------------------------------
+
+  generateCostData() {
+    const costs = new base.IndexedArray();
+    const entries = [];
+    const forms = ["RR", "RM", "MR"];
+
+    function costOf(cost) {
+      // Reciprocal throughput is stored in hundredths of a cycle.
+      return "{ " + StringUtils.padLeft(cost[0], 2) + ", " +
+                    StringUtils.padLeft(cost[2], 2) + ", " +
+                    StringUtils.padLeft(Math.round(cost[1] * 100), 4) + " }";
+    }
+
+    for (var i = 0; i < CostTable.length; i++) {
+      const family = CostTable[i];
+      const load = CostLoadLatency[family.kind];
+
+      for (var j = 0; j < family.insts.length; j++) {
+        const inst = this.instMap[family.insts[j]];
+        if (!inst)
+          throw new Error(`X86Generator.generateCostData(): Unknown instruction '${family.insts[j]}'`);
+
+        forms.forEach(function(form) {
+          var list = family[form];
+          if (!list && form === "RM" && family.RR) {
+            list = family.RR.map(function(cost, k) {
+              return [cost[0] + load[k], Math.max(cost[1], 0.5), cost[2]];
+            });
+          }
+          if (!list) return;
+
+          // Generic costs are the worst case of all microarchitectures.
+          const generic = [0, 0, 0];
+          list.forEach(function(cost) {
+            for (var k = 0; k < 3; k++)
+              generic[k] = Math.max(generic[k], cost[k]);
+          });
+
+          const indexes = [generic].concat(list).map(function(cost) {
+            return StringUtils.padLeft(costs.addIndexed(costOf(cost)), 2);
+          });
+
+          entries.push({ id: inst.id, form: form, indexes: indexes, enum: inst.enum });
+        });
+      }
+    }
+
+    entries.sort(function(a, b) {
+      return a.id !== b.id ? a.id - b.id : forms.indexOf(a.form) - forms.indexOf(b.form);
+    });
+
+    var s = `const X86Inst::Cost X86InstDB::costData[] = {\n${StringUtils.format(costs, kIndent, true)}\n};\n` +
+            `\n` +
+            `#define FORM(F) X86Inst::kCostForm##F\n` +
+            `const X86Inst::CostEntry X86InstDB::costEntryData[] = {\n${StringUtils.format(entries, kIndent, false, function(entry) {
+              return "{ " + StringUtils.padLeft("X86Inst::kId" + entry.enum, 28) + ", FORM(" + entry.form + "), 0, { " + entry.indexes.join(", ") + " } }";
+            })}\n};\n` +
+            `#undef FORM\n`;
+    return this.inject("costData", StringUtils.disclaimer(s), costs.length * 4 + entries.length * 8);
+  }
+
   // --------------------------------------------------------------------------
   // [Generate - CommonData]
   // --------------------------------------------------------------------------